@@ -38,5 +38,11 @@ void SetReleaseFreeMemoryFunction(
       release_free_memory_function);
 }
 
+void SetAllocationHooks(thunks::AllocationHookFunction* allocation_hook,
+                        thunks::FreeHookFunction* free_hook) {
+  base::allocator::thunks::SetAllocationHookFunctions(allocation_hook,
+                                                      free_hook);
+}
+
 }  // namespace allocator
 }  // namespace base
@@ -39,6 +39,16 @@ BASE_EXPORT void SetGetStatsFunction(
 
 BASE_EXPORT void SetReleaseFreeMemoryFunction(
     thunks::ReleaseFreeMemoryFunction* release_free_memory_function);
+
+// Installs functions that the allocator shim calls after every successful
+// allocation and before every free.  Unlike the settings above, these are set
+// from base rather than by the allocator, and may be changed at any time;
+// pass NULL to remove them.  The hooks run inside the allocator and must be
+// safe to call from any thread, including recursively from allocations they
+// make themselves.  Only builds that use the allocator shim run the hooks.
+BASE_EXPORT void SetAllocationHooks(
+    thunks::AllocationHookFunction* allocation_hook,
+    thunks::FreeHookFunction* free_hook);
 }  // namespace allocator
 }  // namespace base
 
@@ -19,6 +19,8 @@ namespace thunks {
 
 static GetStatsFunction* g_get_stats_function = NULL;
 static ReleaseFreeMemoryFunction* g_release_free_memory_function = NULL;
+static AllocationHookFunction* g_allocation_hook_function = NULL;
+static FreeHookFunction* g_free_hook_function = NULL;
 
 void SetGetStatsFunction(GetStatsFunction* get_stats_function) {
   g_get_stats_function = get_stats_function;
@@ -37,6 +39,20 @@ ReleaseFreeMemoryFunction* GetReleaseFreeMemoryFunction() {
   return g_release_free_memory_function;
 }
 
+void SetAllocationHookFunctions(AllocationHookFunction* allocation_hook,
+                                FreeHookFunction* free_hook) {
+  g_allocation_hook_function = allocation_hook;
+  g_free_hook_function = free_hook;
+}
+
+AllocationHookFunction* GetAllocationHookFunction() {
+  return g_allocation_hook_function;
+}
+
+FreeHookFunction* GetFreeHookFunction() {
+  return g_free_hook_function;
+}
+
 }  // namespace thunks
 }  // namespace allocator
 }  // namespace base
@@ -6,6 +6,8 @@
 #define BASE_ALLOCATOR_ALLOCATOR_THUNKS_EXTENSION_H
 #pragma once
 
+#include <stddef.h>
+
 namespace base {
 namespace allocator {
 namespace thunks {
@@ -23,6 +25,13 @@ void SetReleaseFreeMemoryFunction(
     ReleaseFreeMemoryFunction* release_free_memory_function);
 ReleaseFreeMemoryFunction* GetReleaseFreeMemoryFunction();
 
+typedef void AllocationHookFunction(const void*, size_t);
+typedef void FreeHookFunction(const void*);
+void SetAllocationHookFunctions(AllocationHookFunction* allocation_hook,
+                                FreeHookFunction* free_hook);
+AllocationHookFunction* GetAllocationHookFunction();
+FreeHookFunction* GetFreeHookFunction();
+
 }  // namespace thunks
 }  // namespace allocator
 }  // namespace base
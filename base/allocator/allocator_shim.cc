@@ -109,6 +109,21 @@ inline bool call_new_handler(bool nothrow) {
 #endif  // (defined(__GNUC__) && !defined(__EXCEPTIONS)) || (defined(_HAS_EXCEPTIONS) && !_HAS_EXCEPTIONS)
 }
 
+// Report allocations to the hooks installed by base, if any.
+inline void run_allocation_hook(const void* ptr, size_t size) {
+  base::allocator::thunks::AllocationHookFunction* hook =
+      base::allocator::thunks::GetAllocationHookFunction();
+  if (hook)
+    hook(ptr, size);
+}
+
+inline void run_free_hook(const void* ptr) {
+  base::allocator::thunks::FreeHookFunction* hook =
+      base::allocator::thunks::GetFreeHookFunction();
+  if (hook)
+    hook(ptr);
+}
+
 void* malloc(size_t size) __THROW {
   void* ptr;
   for (;;) {
@@ -130,8 +145,10 @@ void* malloc(size_t size) __THROW {
     // TCMalloc case.
     ptr = do_malloc(size);
 #endif
-    if (ptr)
+    if (ptr) {
+      run_allocation_hook(ptr, size);
       return ptr;
+    }
 
     if (!new_mode || !call_new_handler(true))
       break;
@@ -140,6 +157,7 @@ void* malloc(size_t size) __THROW {
 }
 
 void free(void* p) __THROW {
+  run_free_hook(p);
 #ifdef ENABLE_DYNAMIC_ALLOCATOR_SWITCHING
   switch (allocator) {
     case JEMALLOC:
@@ -186,8 +204,12 @@ void* realloc(void* ptr, size_t size) __THROW {
     // Subtle warning:  NULL return does not alwas indicate out-of-memory.  If
     // the requested new size is zero, realloc should free the ptr and return
     // NULL.
-    if (new_ptr || !size)
+    if (new_ptr || !size) {
+      run_free_hook(ptr);
+      if (new_ptr)
+        run_allocation_hook(new_ptr, size);
       return new_ptr;
+    }
     if (!new_mode || !call_new_handler(true))
       break;
   }
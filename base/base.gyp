@@ -148,7 +148,9 @@
         'command_line_unittest.cc',
         'cpu_unittest.cc',
         'debug/leak_tracker_unittest.cc',
+        'debug/sampling_heap_profiler_unittest.cc',
         'debug/stack_trace_unittest.cc',
+        'debug/trace_event_binary_unittest.cc',
         'debug/trace_event_unittest.cc',
         'debug/trace_event_win_unittest.cc',
         'dir_reader_posix_unittest.cc',
@@ -176,6 +178,7 @@
         'json/string_escape_unittest.cc',
         'lazy_instance_unittest.cc',
         'linked_list_unittest.cc',
+        'lock_free_task_queue_unittest.cc',
         'logging_unittest.cc',
         'mac/closure_blocks_leopard_compat_unittest.cc',
         'mac/foundation_util_unittest.mm',
@@ -204,6 +207,7 @@
         'metrics/stats_table_unittest.cc',
         'observer_list_unittest.cc',
         'path_service_unittest.cc',
+        'pickle_buffer_pool_unittest.cc',
         'pickle_unittest.cc',
         'platform_file_unittest.cc',
         'pr_time_unittest.cc',
@@ -509,6 +513,8 @@
       ],
       'sources': [
         'perftimer.cc',
+        'test/perf_benchmark.cc',
+        'test/perf_benchmark.h',
         'test/run_all_perftests.cc',
       ],
       'direct_dependent_settings': {
@@ -528,6 +534,23 @@
         }],
       ],
     },
+    {
+      'target_name': 'base_perftests',
+      'type': 'executable',
+      'dependencies': [
+        'base',
+        'test_support_base',
+        'test_support_perf',
+        '../testing/gtest.gyp:gtest',
+      ],
+      'sources': [
+        'json/json_reader_perftest.cc',
+        'message_loop_perftest.cc',
+        'metrics/histogram_perftest.cc',
+        'threading/sequenced_worker_pool_perftest.cc',
+        'utf_string_conversions_perftest.cc',
+      ],
+    },
   ],
   'conditions': [
     ['OS == "android"', {
@@ -0,0 +1,478 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/sampling_heap_profiler.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/allocator/allocator_extension.h"
+#include "base/atomicops.h"
+#include "base/debug/stack_trace.h"
+#include "base/debug/trace_event.h"
+#include "base/format_macros.h"
+#include "base/lazy_instance.h"
+#include "base/stringprintf.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
+#include "base/time.h"
+
+namespace base {
+namespace debug {
+
+// static
+const size_t SamplingHeapProfiler::kMaxStacks;
+// static
+const size_t SamplingHeapProfiler::kMaxLiveSamples;
+
+namespace {
+
+// The profiler runs inside malloc() and free(), so everything it touches
+// while recording is allocated up front.  The only per-thread state is one
+// TLS word holding the number of bytes left until the thread's next sample,
+// shifted left by one, with the low bit set while the thread is inside the
+// profiler.  The hooks ignore allocations made while that bit is set, which
+// keeps the profiler from recursing into itself.
+const intptr_t kBusyBit = 1;
+
+const size_t kMaxFrames = 24;
+// The StackTrace constructor and RecordAlloc().
+const size_t kSkipFrames = 2;
+
+const uint32 kNoStack = kuint32max;
+const size_t kStackIndexSize = 2 * SamplingHeapProfiler::kMaxStacks;
+// A power of two, at least 4/3 of kMaxLiveSamples.
+const size_t kSampleTableSize = 32 * 1024;
+// Counts the live samples per hash of their address, so that RecordFree()
+// can skip the lock for the vast majority of frees, which are unsampled.
+const size_t kFilterSize = 64 * 1024;
+
+struct StackBucket {
+  uint32 hash;
+  uint32 frame_count;
+  const void* frames[kMaxFrames];
+  size_t sampled_count;
+  size_t sampled_bytes;
+  double estimated_count;
+  double estimated_bytes;
+};
+
+struct LiveSample {
+  const void* ptr;  // NULL if the slot is free.
+  uint32 stack;
+  size_t size;
+  // The inverse of the probability of sampling an allocation of |size|.
+  double weight;
+};
+
+uint32 HashPointer(const void* ptr) {
+  uint64 value = reinterpret_cast<uintptr_t>(ptr);
+  return static_cast<uint32>((value * GG_UINT64_C(0x9E3779B97F4A7C15)) >> 32);
+}
+
+uint32 HashFrames(const void* const* frames, size_t count) {
+  uint32 hash = 0;
+  for (size_t i = 0; i < count; ++i)
+    hash = hash * 31 + HashPointer(frames[i]);
+  return hash;
+}
+
+size_t FilterIndex(const void* ptr) {
+  return (HashPointer(ptr) >> 16) & (kFilterSize - 1);
+}
+
+bool CompareEstimatedBytes(const SamplingHeapProfiler::Entry& a,
+                           const SamplingHeapProfiler::Entry& b) {
+  return a.estimated_bytes > b.estimated_bytes;
+}
+
+class ProfilerState {
+ public:
+  ProfilerState();
+
+  // Returns the number of bytes until the calling thread's next sample and
+  // whether it is inside the profiler.
+  intptr_t GetThreadValue() {
+    return reinterpret_cast<intptr_t>(thread_slot_.Get());
+  }
+  void SetThreadValue(intptr_t value) {
+    thread_slot_.Set(reinterpret_cast<void*>(value));
+  }
+
+  // Returns the number of bytes to allocate until the next sample.
+  intptr_t NextSampleDistance(size_t interval);
+
+  // The following require |lock|.
+  void Insert(const void* ptr, size_t size, size_t interval,
+              const void* const* frames, size_t frame_count);
+  void Remove(const void* ptr);
+  void Clear();
+  void GetProfile(std::vector<SamplingHeapProfiler::Entry>* entries) const;
+
+  // Whether |ptr| may have been sampled.  Does not need |lock|.
+  bool MaybeSampled(const void* ptr) const {
+    return subtle::NoBarrier_Load(&filter_[FilterIndex(ptr)]) != 0;
+  }
+
+  Lock lock;
+  size_t dropped_samples;
+
+ private:
+  uint32 FindOrAddStack(const void* const* frames, size_t frame_count);
+  // Returns the slot holding |ptr|, or the free slot where it would go.
+  size_t FindSample(const void* ptr) const;
+  void RemoveFromStack(const LiveSample& sample);
+
+  ThreadLocalStorage::Slot thread_slot_;
+  uint64 random_state_;
+
+  StackBucket* stacks_;
+  size_t stack_count_;
+  uint32* stack_index_;
+  LiveSample* samples_;
+  size_t sample_count_;
+  subtle::Atomic32* filter_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProfilerState);
+};
+
+ProfilerState::ProfilerState()
+    : dropped_samples(0),
+      random_state_(static_cast<uint64>(
+          TimeTicks::Now().ToInternalValue()) | 1),
+      stacks_(new StackBucket[SamplingHeapProfiler::kMaxStacks]),
+      stack_count_(0),
+      stack_index_(new uint32[kStackIndexSize]),
+      samples_(new LiveSample[kSampleTableSize]),
+      sample_count_(0),
+      filter_(new subtle::Atomic32[kFilterSize]) {
+  Clear();
+}
+
+intptr_t ProfilerState::NextSampleDistance(size_t interval) {
+  // xorshift64*, then an exponential distribution with mean |interval|, so
+  // that every byte allocated is equally likely to be sampled.
+  random_state_ ^= random_state_ >> 12;
+  random_state_ ^= random_state_ << 25;
+  random_state_ ^= random_state_ >> 27;
+  uint64 random = random_state_ * GG_UINT64_C(2685821657736338717);
+  double uniform = ((random >> 11) + 1) * (1.0 / 9007199254740992.0);
+  double distance = -log(uniform) * interval;
+  const double kMaxDistance = static_cast<double>(kint32max);
+  return static_cast<intptr_t>(std::min(distance, kMaxDistance)) + 1;
+}
+
+void ProfilerState::Insert(const void* ptr, size_t size, size_t interval,
+                           const void* const* frames, size_t frame_count) {
+  if (sample_count_ >= SamplingHeapProfiler::kMaxLiveSamples) {
+    ++dropped_samples;
+    return;
+  }
+  uint32 stack = FindOrAddStack(frames, frame_count);
+  if (stack == kNoStack) {
+    ++dropped_samples;
+    return;
+  }
+
+  size_t slot = FindSample(ptr);
+  LiveSample& sample = samples_[slot];
+  if (sample.ptr) {
+    // A free we did not see, e.g. one made inside the profiler.
+    RemoveFromStack(sample);
+  } else {
+    ++sample_count_;
+    subtle::NoBarrier_AtomicIncrement(&filter_[FilterIndex(ptr)], 1);
+  }
+  sample.ptr = ptr;
+  sample.stack = stack;
+  sample.size = size;
+  sample.weight = 1.0 / (1.0 - exp(-static_cast<double>(size) / interval));
+
+  StackBucket& bucket = stacks_[stack];
+  ++bucket.sampled_count;
+  bucket.sampled_bytes += size;
+  bucket.estimated_count += sample.weight;
+  bucket.estimated_bytes += sample.weight * size;
+}
+
+void ProfilerState::Remove(const void* ptr) {
+  size_t slot = FindSample(ptr);
+  if (!samples_[slot].ptr)
+    return;
+  RemoveFromStack(samples_[slot]);
+  --sample_count_;
+  subtle::NoBarrier_AtomicIncrement(&filter_[FilterIndex(ptr)], -1);
+
+  // Shift later entries of the probe sequence back into the hole.
+  const size_t kMask = kSampleTableSize - 1;
+  size_t hole = slot;
+  for (size_t next = (hole + 1) & kMask; samples_[next].ptr;
+       next = (next + 1) & kMask) {
+    size_t home = HashPointer(samples_[next].ptr) & kMask;
+    bool home_after_hole = hole <= next ? (hole < home && home <= next)
+                                        : (hole < home || home <= next);
+    if (!home_after_hole) {
+      samples_[hole] = samples_[next];
+      hole = next;
+    }
+  }
+  samples_[hole].ptr = NULL;
+}
+
+void ProfilerState::Clear() {
+  stack_count_ = 0;
+  for (size_t i = 0; i < kStackIndexSize; ++i)
+    stack_index_[i] = kNoStack;
+  sample_count_ = 0;
+  for (size_t i = 0; i < kSampleTableSize; ++i)
+    samples_[i].ptr = NULL;
+  for (size_t i = 0; i < kFilterSize; ++i)
+    subtle::NoBarrier_Store(&filter_[i], 0);
+  dropped_samples = 0;
+}
+
+void ProfilerState::GetProfile(
+    std::vector<SamplingHeapProfiler::Entry>* entries) const {
+  entries->reserve(stack_count_);
+  for (size_t i = 0; i < stack_count_; ++i) {
+    const StackBucket& bucket = stacks_[i];
+    if (!bucket.sampled_count)
+      continue;
+    entries->push_back(SamplingHeapProfiler::Entry());
+    SamplingHeapProfiler::Entry& entry = entries->back();
+    entry.frames.assign(bucket.frames, bucket.frames + bucket.frame_count);
+    entry.sampled_count = bucket.sampled_count;
+    entry.sampled_bytes = bucket.sampled_bytes;
+    entry.estimated_count = static_cast<size_t>(bucket.estimated_count + 0.5);
+    entry.estimated_bytes = static_cast<size_t>(bucket.estimated_bytes + 0.5);
+  }
+}
+
+uint32 ProfilerState::FindOrAddStack(const void* const* frames,
+                                     size_t frame_count) {
+  uint32 hash = HashFrames(frames, frame_count);
+  const size_t kMask = kStackIndexSize - 1;
+  for (size_t i = hash & kMask; ; i = (i + 1) & kMask) {
+    uint32 stack = stack_index_[i];
+    if (stack == kNoStack)
+      break;
+    const StackBucket& bucket = stacks_[stack];
+    if (bucket.hash == hash && bucket.frame_count == frame_count &&
+        memcmp(bucket.frames, frames, frame_count * sizeof(*frames)) == 0) {
+      return stack;
+    }
+  }
+  if (stack_count_ >= SamplingHeapProfiler::kMaxStacks)
+    return kNoStack;
+
+  uint32 stack = static_cast<uint32>(stack_count_++);
+  StackBucket& bucket = stacks_[stack];
+  bucket.hash = hash;
+  bucket.frame_count = static_cast<uint32>(frame_count);
+  memcpy(bucket.frames, frames, frame_count * sizeof(*frames));
+  bucket.sampled_count = 0;
+  bucket.sampled_bytes = 0;
+  bucket.estimated_count = 0;
+  bucket.estimated_bytes = 0;
+  for (size_t i = hash & kMask; ; i = (i + 1) & kMask) {
+    if (stack_index_[i] == kNoStack) {
+      stack_index_[i] = stack;
+      break;
+    }
+  }
+  return stack;
+}
+
+size_t ProfilerState::FindSample(const void* ptr) const {
+  const size_t kMask = kSampleTableSize - 1;
+  size_t slot = HashPointer(ptr) & kMask;
+  while (samples_[slot].ptr && samples_[slot].ptr != ptr)
+    slot = (slot + 1) & kMask;
+  return slot;
+}
+
+void ProfilerState::RemoveFromStack(const LiveSample& sample) {
+  StackBucket& bucket = stacks_[sample.stack];
+  --bucket.sampled_count;
+  bucket.sampled_bytes -= sample.size;
+  bucket.estimated_count -= sample.weight;
+  bucket.estimated_bytes -= sample.weight * sample.size;
+  if (!bucket.sampled_count) {
+    // Do not let rounding errors accumulate.
+    bucket.estimated_count = 0;
+    bucket.estimated_bytes = 0;
+  }
+}
+
+// Marks the calling thread as inside the profiler for its lifetime.
+class ScopedInProfiler {
+ public:
+  explicit ScopedInProfiler(ProfilerState* state)
+      : state_(state),
+        old_value_(state->GetThreadValue()) {
+    state_->SetThreadValue(old_value_ | kBusyBit);
+  }
+  ~ScopedInProfiler() {
+    state_->SetThreadValue(old_value_);
+  }
+
+ private:
+  ProfilerState* state_;
+  intptr_t old_value_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedInProfiler);
+};
+
+LazyInstance<ProfilerState>::Leaky g_state = LAZY_INSTANCE_INITIALIZER;
+
+// Nonzero while profiling.  Set only after |g_state| is created.
+subtle::AtomicWord g_interval = 0;
+
+}  // namespace
+
+SamplingHeapProfiler::Entry::Entry()
+    : sampled_count(0),
+      sampled_bytes(0),
+      estimated_count(0),
+      estimated_bytes(0) {
+}
+
+SamplingHeapProfiler::Entry::~Entry() {
+}
+
+// static
+void SamplingHeapProfiler::SetSamplingInterval(size_t interval) {
+  ProfilerState* state = g_state.Pointer();
+  {
+    AutoLock lock(state->lock);
+    size_t old_interval = subtle::NoBarrier_Load(&g_interval);
+    if (!old_interval != !interval)
+      state->Clear();
+    subtle::Release_Store(&g_interval, interval);
+  }
+  if (interval)
+    base::allocator::SetAllocationHooks(&RecordAlloc, &RecordFree);
+  else
+    base::allocator::SetAllocationHooks(NULL, NULL);
+}
+
+// static
+size_t SamplingHeapProfiler::GetSamplingInterval() {
+  return subtle::NoBarrier_Load(&g_interval);
+}
+
+// static
+void SamplingHeapProfiler::RecordAlloc(const void* ptr, size_t size) {
+  size_t interval = subtle::Acquire_Load(&g_interval);
+  if (!interval || !ptr)
+    return;
+  ProfilerState* state = g_state.Pointer();
+  intptr_t value = state->GetThreadValue();
+  if (value & kBusyBit)
+    return;
+  intptr_t bytes_left = value >> 1;
+  if (bytes_left > 0 && static_cast<size_t>(bytes_left) > size) {
+    state->SetThreadValue((bytes_left - size) << 1);
+    return;
+  }
+
+  state->SetThreadValue(kBusyBit);
+  // A thread's first allocation only starts its countdown.
+  bool take_sample = bytes_left > 0;
+  const void* frames[kMaxFrames];
+  size_t frame_count = 0;
+  if (take_sample) {
+    StackTrace trace;
+    size_t count;
+    const void* const* addresses = trace.Addresses(&count);
+    if (count > kSkipFrames) {
+      frame_count = std::min(count - kSkipFrames, kMaxFrames);
+      std::copy(addresses + kSkipFrames, addresses + kSkipFrames + frame_count,
+                frames);
+    }
+  }
+  {
+    AutoLock lock(state->lock);
+    if (take_sample)
+      state->Insert(ptr, size, interval, frames, frame_count);
+    bytes_left = state->NextSampleDistance(interval);
+  }
+  state->SetThreadValue(bytes_left << 1);
+}
+
+// static
+void SamplingHeapProfiler::RecordFree(const void* ptr) {
+  if (!ptr || !subtle::Acquire_Load(&g_interval))
+    return;
+  ProfilerState* state = g_state.Pointer();
+  if (!state->MaybeSampled(ptr) || (state->GetThreadValue() & kBusyBit))
+    return;
+  ScopedInProfiler in_profiler(state);
+  AutoLock lock(state->lock);
+  state->Remove(ptr);
+}
+
+// static
+void SamplingHeapProfiler::GetProfile(std::vector<Entry>* entries) {
+  entries->clear();
+  if (!GetSamplingInterval())
+    return;
+  ProfilerState* state = g_state.Pointer();
+  {
+    ScopedInProfiler in_profiler(state);
+    AutoLock lock(state->lock);
+    state->GetProfile(entries);
+  }
+  std::sort(entries->begin(), entries->end(), &CompareEstimatedBytes);
+}
+
+// static
+void SamplingHeapProfiler::GetProfileAsText(std::string* output) {
+  std::vector<Entry> entries;
+  GetProfile(&entries);
+  size_t total_bytes = 0;
+  for (size_t i = 0; i < entries.size(); ++i)
+    total_bytes += entries[i].estimated_bytes;
+
+  StringAppendF(output,
+                "Sampling heap profile: %" PRIuS " bytes live in %" PRIuS
+                " stacks, sampling every %" PRIuS " bytes, %" PRIuS
+                " samples dropped\n",
+                total_bytes, entries.size(), GetSamplingInterval(),
+                GetDroppedSampleCount());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const Entry& entry = entries[i];
+    StringAppendF(output,
+                  "\n%" PRIuS " bytes in %" PRIuS " allocations (%" PRIuS
+                  " bytes in %" PRIuS " sampled)\n",
+                  entry.estimated_bytes, entry.estimated_count,
+                  entry.sampled_bytes, entry.sampled_count);
+    if (!entry.frames.empty())
+      output->append(StackTrace(&entry.frames[0], entry.frames.size())
+                         .ToString());
+  }
+}
+
+// static
+void SamplingHeapProfiler::AddProfileToTrace() {
+  std::string profile;
+  GetProfileAsText(&profile);
+  TRACE_EVENT_INSTANT1("memory", "SamplingHeapProfiler::Profile",
+                       "profile", TRACE_STR_COPY(profile.c_str()));
+}
+
+// static
+size_t SamplingHeapProfiler::GetDroppedSampleCount() {
+  if (!GetSamplingInterval())
+    return 0;
+  ProfilerState* state = g_state.Pointer();
+  ScopedInProfiler in_profiler(state);
+  AutoLock lock(state->lock);
+  return state->dropped_samples;
+}
+
+}  // namespace debug
+}  // namespace base
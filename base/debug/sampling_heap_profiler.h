@@ -0,0 +1,93 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// SamplingHeapProfiler finds the call sites responsible for heap growth in
+// long-running processes at a cost low enough to leave on in the field.
+//
+// Rather than recording every allocation, it samples on average one in every
+// |interval| bytes allocated, so large allocations are much more likely to be
+// picked than small ones.  Each sampled allocation records its call stack and
+// stays in the profile until it is freed.  The profile reports, per call
+// stack, the sampled live allocations plus an estimate of the live bytes they
+// stand for, which corrects for the sampling probability of each allocation.
+//
+// Allocations are reported through the allocation hooks of
+// base/allocator/allocator_extension.h, so only builds using the allocator
+// shim are profiled automatically.  Elsewhere RecordAlloc() and RecordFree()
+// can be called directly.
+//
+// Usage:
+//   SamplingHeapProfiler::SetSamplingInterval(128 * 1024);
+//   ...
+//   std::string profile;
+//   SamplingHeapProfiler::GetProfileAsText(&profile);
+
+#ifndef BASE_DEBUG_SAMPLING_HEAP_PROFILER_H_
+#define BASE_DEBUG_SAMPLING_HEAP_PROFILER_H_
+#pragma once
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+
+namespace base {
+namespace debug {
+
+class BASE_EXPORT SamplingHeapProfiler {
+ public:
+  // The live sampled allocations made from one call stack.
+  struct BASE_EXPORT Entry {
+    Entry();
+    ~Entry();
+
+    // Innermost frame first.
+    std::vector<const void*> frames;
+    size_t sampled_count;
+    size_t sampled_bytes;
+    // Corrected for the sampling probability of each allocation.
+    size_t estimated_count;
+    size_t estimated_bytes;
+  };
+
+  // The stack table has room for this many distinct call stacks, and the
+  // profile for this many live samples.  Samples beyond that are dropped.
+  static const size_t kMaxStacks = 4096;
+  static const size_t kMaxLiveSamples = 48 * 1024;
+
+  // Starts sampling on average one in every |interval| bytes allocated, or
+  // stops if |interval| is 0.  May be called at any time; a new interval
+  // takes effect on each thread at its next sample.  Starting or stopping
+  // discards the current profile.
+  static void SetSamplingInterval(size_t interval);
+  static size_t GetSamplingInterval();
+
+  // Allocation hooks.  Safe to call on any thread.
+  static void RecordAlloc(const void* ptr, size_t size);
+  static void RecordFree(const void* ptr);
+
+  // Stores the profile in |entries|, largest estimated_bytes first.
+  static void GetProfile(std::vector<Entry>* entries);
+
+  // Appends the profile, with symbolized stacks, to |output| as text.
+  static void GetProfileAsText(std::string* output);
+
+  // Records the text profile as an instant event in the "memory" category of
+  // the trace.
+  static void AddProfileToTrace();
+
+  // Returns the number of samples dropped because a table was full.
+  static size_t GetDroppedSampleCount();
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(SamplingHeapProfiler);
+};
+
+}  // namespace debug
+}  // namespace base
+
+#endif  // BASE_DEBUG_SAMPLING_HEAP_PROFILER_H_
@@ -0,0 +1,177 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/sampling_heap_profiler.h"
+
+#include <vector>
+
+#include "base/memory/scoped_vector.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+class SamplingHeapProfilerTest : public testing::Test {
+ public:
+  virtual void TearDown() OVERRIDE {
+    SamplingHeapProfiler::SetSamplingInterval(0);
+  }
+
+ protected:
+  // Reports |count| allocations of |size| bytes each, backed by |buffer| so
+  // that no real allocation can share their addresses.
+  void AllocateFake(std::vector<char>* buffer, size_t count, size_t size) {
+    buffer->resize(count * size);
+    for (size_t i = 0; i < count; ++i)
+      SamplingHeapProfiler::RecordAlloc(&(*buffer)[i * size], size);
+  }
+
+  void FreeFake(const std::vector<char>& buffer, size_t count, size_t size) {
+    for (size_t i = 0; i < count; ++i)
+      SamplingHeapProfiler::RecordFree(&buffer[i * size]);
+  }
+
+  size_t GetEstimatedBytes() {
+    std::vector<SamplingHeapProfiler::Entry> entries;
+    SamplingHeapProfiler::GetProfile(&entries);
+    size_t bytes = 0;
+    for (size_t i = 0; i < entries.size(); ++i)
+      bytes += entries[i].estimated_bytes;
+    return bytes;
+  }
+};
+
+class FakeAllocator : public DelegateSimpleThread::Delegate {
+ public:
+  FakeAllocator() : buffer_(64 * 1024) {}
+
+  virtual void Run() OVERRIDE {
+    for (int round = 0; round < 10; ++round) {
+      for (size_t i = 0; i < buffer_.size(); i += 64)
+        SamplingHeapProfiler::RecordAlloc(&buffer_[i], 64);
+      for (size_t i = 0; i < buffer_.size(); i += 64)
+        SamplingHeapProfiler::RecordFree(&buffer_[i]);
+    }
+  }
+
+ private:
+  std::vector<char> buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(FakeAllocator);
+};
+
+}  // namespace
+
+TEST_F(SamplingHeapProfilerTest, Disabled) {
+  EXPECT_EQ(0u, SamplingHeapProfiler::GetSamplingInterval());
+  std::vector<char> buffer;
+  AllocateFake(&buffer, 100, 1024 * 1024);
+  std::vector<SamplingHeapProfiler::Entry> entries;
+  SamplingHeapProfiler::GetProfile(&entries);
+  EXPECT_TRUE(entries.empty());
+}
+
+TEST_F(SamplingHeapProfilerTest, LargeAllocationsAreSampled) {
+  SamplingHeapProfiler::SetSamplingInterval(1024);
+  const size_t kCount = 10;
+  const size_t kSize = 1024 * 1024;
+  std::vector<char> buffer;
+  AllocateFake(&buffer, kCount, kSize);
+
+  // All the allocations come from one call stack, and each one is far
+  // larger than the interval.  Only a thread's first allocation is skipped.
+  std::vector<SamplingHeapProfiler::Entry> entries;
+  SamplingHeapProfiler::GetProfile(&entries);
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_GE(entries[0].sampled_count, kCount - 1);
+  EXPECT_EQ(entries[0].sampled_count * kSize, entries[0].sampled_bytes);
+  EXPECT_EQ(entries[0].sampled_count, entries[0].estimated_count);
+  EXPECT_EQ(entries[0].sampled_bytes, entries[0].estimated_bytes);
+  EXPECT_FALSE(entries[0].frames.empty());
+
+  FreeFake(buffer, kCount, kSize);
+  EXPECT_EQ(0u, GetEstimatedBytes());
+}
+
+TEST_F(SamplingHeapProfilerTest, EstimatesSmallAllocations) {
+  const size_t kInterval = 4096;
+  SamplingHeapProfiler::SetSamplingInterval(kInterval);
+  const size_t kCount = 100000;
+  const size_t kSize = 64;
+  std::vector<char> buffer;
+  AllocateFake(&buffer, kCount, kSize);
+
+  std::vector<SamplingHeapProfiler::Entry> entries;
+  SamplingHeapProfiler::GetProfile(&entries);
+  ASSERT_EQ(1u, entries.size());
+  // About 1560 samples are expected, so the estimate should be well within
+  // 15% of the truth.
+  const double kTotal = kCount * kSize;
+  EXPECT_GT(entries[0].sampled_count, 1000u);
+  EXPECT_LT(entries[0].sampled_count, 2500u);
+  EXPECT_GT(entries[0].estimated_bytes, kTotal * 0.85);
+  EXPECT_LT(entries[0].estimated_bytes, kTotal * 1.15);
+  EXPECT_EQ(0u, SamplingHeapProfiler::GetDroppedSampleCount());
+
+  // Only the frees of sampled allocations can change the profile.
+  FreeFake(buffer, kCount / 2, kSize);
+  size_t half = GetEstimatedBytes();
+  EXPECT_GT(half, kTotal * 0.35);
+  EXPECT_LT(half, kTotal * 0.65);
+  FreeFake(buffer, kCount, kSize);
+  EXPECT_EQ(0u, GetEstimatedBytes());
+}
+
+TEST_F(SamplingHeapProfilerTest, StoppingDiscardsProfile) {
+  SamplingHeapProfiler::SetSamplingInterval(1024);
+  std::vector<char> buffer;
+  AllocateFake(&buffer, 10, 64 * 1024);
+  EXPECT_NE(0u, GetEstimatedBytes());
+
+  // Changing the interval keeps the profile.
+  SamplingHeapProfiler::SetSamplingInterval(2048);
+  EXPECT_EQ(2048u, SamplingHeapProfiler::GetSamplingInterval());
+  EXPECT_NE(0u, GetEstimatedBytes());
+
+  SamplingHeapProfiler::SetSamplingInterval(0);
+  EXPECT_EQ(0u, GetEstimatedBytes());
+  SamplingHeapProfiler::SetSamplingInterval(1024);
+  EXPECT_EQ(0u, GetEstimatedBytes());
+}
+
+TEST_F(SamplingHeapProfilerTest, ProfileAsText) {
+  SamplingHeapProfiler::SetSamplingInterval(1024);
+  std::vector<char> buffer;
+  AllocateFake(&buffer, 10, 64 * 1024);
+  std::string text;
+  SamplingHeapProfiler::GetProfileAsText(&text);
+  EXPECT_EQ(0u, text.find("Sampling heap profile: "));
+  EXPECT_NE(std::string::npos, text.find(" sampled)\n"));
+  FreeFake(buffer, 10, 64 * 1024);
+}
+
+TEST_F(SamplingHeapProfilerTest, ManyThreads) {
+  SamplingHeapProfiler::SetSamplingInterval(512);
+  const int kNumThreads = 4;
+  ScopedVector<FakeAllocator> allocators;
+  ScopedVector<DelegateSimpleThread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    allocators.push_back(new FakeAllocator);
+    threads.push_back(
+        new DelegateSimpleThread(allocators[i], "SamplingHeapProfilerTest"));
+    threads[i]->Start();
+  }
+  for (int i = 0; i < kNumThreads; ++i)
+    threads[i]->Join();
+
+  // Everything was freed, on the thread that allocated it.
+  EXPECT_EQ(0u, GetEstimatedBytes());
+  EXPECT_EQ(0u, SamplingHeapProfiler::GetDroppedSampleCount());
+}
+
+}  // namespace debug
+}  // namespace base
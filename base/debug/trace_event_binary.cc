@@ -0,0 +1,236 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/trace_event_binary.h"
+
+#include "base/debug/trace_event.h"
+#include "base/format_macros.h"
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "base/stringprintf.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+const int kTraceBinaryVersion = 1;
+
+// Each event starts with its phase, flags, argument count and argument types
+// packed into one 32-bit word.
+uint32 PackEventHeader(const TraceEvent& event, int num_args) {
+  uint32 header = static_cast<unsigned char>(event.phase()) |
+                  event.flags() << 8 |
+                  num_args << 16;
+  for (int i = 0; i < num_args; ++i)
+    header |= (event.arg_type(i) & 0xf) << (20 + 4 * i);
+  return header;
+}
+
+bool IsStringType(unsigned char type) {
+  return type == TRACE_VALUE_TYPE_STRING ||
+         type == TRACE_VALUE_TYPE_COPY_STRING;
+}
+
+int CountArgs(const TraceEvent& event) {
+  int num_args = 0;
+  while (num_args < kTraceMaxNumArgs && event.arg_name(num_args))
+    ++num_args;
+  return num_args;
+}
+
+}  // namespace
+
+TraceBinaryWriter::TraceBinaryWriter() : next_sequence_number_(0) {
+}
+
+TraceBinaryWriter::~TraceBinaryWriter() {
+}
+
+void TraceBinaryWriter::WriteEvents(const std::vector<TraceEvent>& events,
+                                    int process_id,
+                                    std::string* output) {
+  // Intern everything first, so the new strings can precede the events.
+  std::vector<const char*> new_strings;
+  std::vector<int> string_ids;
+  string_ids.reserve(events.size() * (2 + kTraceMaxNumArgs));
+  for (size_t i = 0; i < events.size(); ++i) {
+    const TraceEvent& event = events[i];
+    string_ids.push_back(InternString(
+        TraceLog::GetCategoryName(event.category_enabled()), &new_strings));
+    string_ids.push_back(InternString(event.name(), &new_strings));
+    int num_args = CountArgs(event);
+    for (int arg = 0; arg < num_args; ++arg)
+      string_ids.push_back(InternString(event.arg_name(arg), &new_strings));
+  }
+
+  Pickle pickle;
+  pickle.WriteInt(kTraceBinaryVersion);
+  pickle.WriteInt(next_sequence_number_++);
+  pickle.WriteInt(process_id);
+  pickle.WriteInt(static_cast<int>(new_strings.size()));
+  for (size_t i = 0; i < new_strings.size(); ++i)
+    pickle.WriteString(new_strings[i]);
+
+  pickle.WriteInt(static_cast<int>(events.size()));
+  std::vector<int>::const_iterator string_id = string_ids.begin();
+  for (size_t i = 0; i < events.size(); ++i) {
+    const TraceEvent& event = events[i];
+    int num_args = CountArgs(event);
+    pickle.WriteUInt32(PackEventHeader(event, num_args));
+    pickle.WriteInt64(event.timestamp().ToInternalValue());
+    pickle.WriteInt(event.thread_id());
+    pickle.WriteInt(*string_id++);  // Category.
+    pickle.WriteInt(*string_id++);  // Name.
+    if (event.flags() & TRACE_EVENT_FLAG_HAS_ID)
+      pickle.WriteUInt64(event.id());
+    for (int arg = 0; arg < num_args; ++arg) {
+      pickle.WriteInt(*string_id++);
+      TraceEvent::TraceValue value = event.arg_value(arg);
+      if (IsStringType(event.arg_type(arg)))
+        pickle.WriteString(value.as_string ? value.as_string : "NULL");
+      else
+        pickle.WriteUInt64(value.as_uint);
+    }
+  }
+
+  output->append(static_cast<const char*>(pickle.data()), pickle.size());
+}
+
+int TraceBinaryWriter::InternString(const char* str,
+                                    std::vector<const char*>* new_strings) {
+  std::pair<base::hash_map<std::string, int>::iterator, bool> result =
+      string_ids_.insert(std::make_pair(std::string(str),
+                                        static_cast<int>(string_ids_.size())));
+  if (result.second)
+    new_strings->push_back(str);
+  return result.first->second;
+}
+
+TraceBinaryConverter::TraceBinaryConverter() : next_sequence_number_(0) {
+}
+
+TraceBinaryConverter::~TraceBinaryConverter() {
+}
+
+bool TraceBinaryConverter::AppendAsJSON(const std::string& piece,
+                                        std::string* json) {
+  Pickle pickle(piece.data(), static_cast<int>(piece.size()));
+  PickleIterator iter(pickle);
+  int version, sequence_number, process_id;
+  if (!pickle.ReadInt(&iter, &version) ||
+      version != kTraceBinaryVersion ||
+      !pickle.ReadInt(&iter, &sequence_number) ||
+      !pickle.ReadInt(&iter, &process_id)) {
+    return false;
+  }
+  if (sequence_number == 0) {
+    strings_.clear();
+    next_sequence_number_ = 0;
+  }
+  if (sequence_number != next_sequence_number_)
+    return false;
+
+  int num_strings;
+  if (!pickle.ReadLength(&iter, &num_strings))
+    return false;
+  size_t strings_size = strings_.size();
+  for (int i = 0; i < num_strings; ++i) {
+    std::string str;
+    if (!pickle.ReadString(&iter, &str)) {
+      strings_.resize(strings_size);
+      return false;
+    }
+    strings_.push_back(str);
+  }
+
+  // Only append once the whole piece has been read.
+  std::string out;
+  bool ok = true;
+  int num_events;
+  if (!pickle.ReadLength(&iter, &num_events))
+    ok = false;
+  for (int i = 0; ok && i < num_events; ++i) {
+    uint32 header;
+    int64 timestamp;
+    int thread_id, category, name;
+    if (!pickle.ReadUInt32(&iter, &header) ||
+        !pickle.ReadInt64(&iter, &timestamp) ||
+        !pickle.ReadInt(&iter, &thread_id) ||
+        !pickle.ReadInt(&iter, &category) ||
+        !pickle.ReadInt(&iter, &name) ||
+        static_cast<size_t>(category) >= strings_.size() ||
+        static_cast<size_t>(name) >= strings_.size()) {
+      ok = false;
+      break;
+    }
+    char phase = static_cast<char>(header & 0xff);
+    unsigned char flags = static_cast<unsigned char>((header >> 8) & 0xff);
+    int num_args = (header >> 16) & 0xf;
+    uint64 id = 0;
+    if ((flags & TRACE_EVENT_FLAG_HAS_ID) && !pickle.ReadUInt64(&iter, &id)) {
+      ok = false;
+      break;
+    }
+    if (num_args > kTraceMaxNumArgs) {
+      ok = false;
+      break;
+    }
+
+    if (i > 0)
+      out += ",";
+    StringAppendF(&out,
+        "{\"cat\":\"%s\",\"pid\":%i,\"tid\":%i,\"ts\":%" PRId64 ","
+        "\"ph\":\"%c\",\"name\":\"%s\",\"args\":{",
+        strings_[category].c_str(),
+        process_id,
+        thread_id,
+        timestamp,
+        phase,
+        strings_[name].c_str());
+    for (int arg = 0; ok && arg < num_args; ++arg) {
+      unsigned char type =
+          static_cast<unsigned char>((header >> (20 + 4 * arg)) & 0xf);
+      int arg_name;
+      if (!pickle.ReadInt(&iter, &arg_name) ||
+          static_cast<size_t>(arg_name) >= strings_.size()) {
+        ok = false;
+        break;
+      }
+      TraceEvent::TraceValue value;
+      std::string string_value;
+      uint64 raw_value = 0;
+      if (IsStringType(type)) {
+        ok = pickle.ReadString(&iter, &string_value);
+        value.as_string = string_value.c_str();
+      } else {
+        ok = pickle.ReadUInt64(&iter, &raw_value);
+        value.as_uint = raw_value;
+      }
+      if (!ok)
+        break;
+      if (arg > 0)
+        out += ",";
+      out += "\"";
+      out += strings_[arg_name];
+      out += "\":";
+      TraceEvent::AppendValueAsJSON(type, value, &out);
+    }
+    out += "}";
+    if (flags & TRACE_EVENT_FLAG_HAS_ID)
+      StringAppendF(&out, ",\"id\":\"%" PRIx64 "\"", id);
+    out += "}";
+  }
+
+  if (!ok) {
+    strings_.resize(strings_size);
+    return false;
+  }
+  json->append(out);
+  ++next_sequence_number_;
+  return true;
+}
+
+}  // namespace debug
+}  // namespace base
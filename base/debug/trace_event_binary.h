@@ -0,0 +1,74 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A compact binary encoding of TraceEvents, used to stream long captures out
+// of TraceLog without building their JSON in memory.
+//
+// A capture is written as a sequence of pieces, each one a Pickle holding a
+// batch of events.  Category names, event names and argument names are
+// interned: a string is written once, in the first piece that uses it, and
+// referred to by index afterwards.  Pieces therefore have to be converted in
+// the order they were written, by a single TraceBinaryConverter.
+
+#ifndef BASE_DEBUG_TRACE_EVENT_BINARY_H_
+#define BASE_DEBUG_TRACE_EVENT_BINARY_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/hash_tables.h"
+
+namespace base {
+namespace debug {
+
+class TraceEvent;
+
+class BASE_EXPORT TraceBinaryWriter {
+ public:
+  TraceBinaryWriter();
+  ~TraceBinaryWriter();
+
+  // Encodes |events|, logged by process |process_id|, as the next piece of
+  // the stream and appends it to |output|.
+  void WriteEvents(const std::vector<TraceEvent>& events,
+                   int process_id,
+                   std::string* output);
+
+ private:
+  // Returns the index of |str|, adding it to |new_strings| if this writer has
+  // not seen it before.
+  int InternString(const char* str, std::vector<const char*>* new_strings);
+
+  base::hash_map<std::string, int> string_ids_;
+  int next_sequence_number_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceBinaryWriter);
+};
+
+// Converts the pieces written by a TraceBinaryWriter back to the JSON format
+// of TraceEvent::AppendAsJSON, for use with TraceResultBuffer.
+class BASE_EXPORT TraceBinaryConverter {
+ public:
+  TraceBinaryConverter();
+  ~TraceBinaryConverter();
+
+  // Appends the events in |piece| to |json| as a comma-separated JSON
+  // fragment.  The first piece of a capture starts a new stream.  Returns
+  // false if |piece| is malformed or out of order.
+  bool AppendAsJSON(const std::string& piece, std::string* json);
+
+ private:
+  std::vector<std::string> strings_;
+  int next_sequence_number_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceBinaryConverter);
+};
+
+}  // namespace debug
+}  // namespace base
+
+#endif  // BASE_DEBUG_TRACE_EVENT_BINARY_H_
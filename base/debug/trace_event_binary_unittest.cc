@@ -0,0 +1,147 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/trace_event_binary.h"
+
+#include <string>
+#include <vector>
+
+#include "base/debug/trace_event.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+// Builds events covering every argument type, ids and copied strings.
+std::vector<TraceEvent> MakeEvents(const char* name) {
+  const unsigned char* category =
+      TraceLog::GetCategoryEnabled("binary_test");
+  int thread_id = 42;
+  TimeTicks now = TimeTicks::Now();
+  std::vector<TraceEvent> events;
+
+  events.push_back(TraceEvent(thread_id, now, TRACE_EVENT_PHASE_BEGIN,
+                              category, name, 0, 0, NULL, NULL, NULL,
+                              TRACE_EVENT_FLAG_NONE));
+
+  const char* arg_names[] = { "first", "second" };
+  unsigned char arg_types[2];
+  unsigned long long arg_values[2];
+  trace_event_internal::SetTraceValue(true, &arg_types[0], &arg_values[0]);
+  trace_event_internal::SetTraceValue(-7, &arg_types[1], &arg_values[1]);
+  events.push_back(TraceEvent(thread_id, now, TRACE_EVENT_PHASE_INSTANT,
+                              category, name, 0, 2, arg_names, arg_types,
+                              arg_values, TRACE_EVENT_FLAG_NONE));
+
+  trace_event_internal::SetTraceValue(3.5, &arg_types[0], &arg_values[0]);
+  trace_event_internal::SetTraceValue(12345u, &arg_types[1], &arg_values[1]);
+  events.push_back(TraceEvent(thread_id, now, TRACE_EVENT_PHASE_INSTANT,
+                              category, name, 0, 2, arg_names, arg_types,
+                              arg_values, TRACE_EVENT_FLAG_NONE));
+
+  trace_event_internal::SetTraceValue(
+      reinterpret_cast<const void*>(0x1234), &arg_types[0], &arg_values[0]);
+  trace_event_internal::SetTraceValue("quote\"d", &arg_types[1],
+                                      &arg_values[1]);
+  events.push_back(TraceEvent(thread_id, now, TRACE_EVENT_PHASE_INSTANT,
+                              category, name, 0, 2, arg_names, arg_types,
+                              arg_values, TRACE_EVENT_FLAG_COPY));
+
+  const char* null_string = NULL;
+  trace_event_internal::SetTraceValue(null_string, &arg_types[0],
+                                      &arg_values[0]);
+  events.push_back(TraceEvent(thread_id, now, TRACE_EVENT_PHASE_ASYNC_BEGIN,
+                              category, name, 0xfedcba9876543210ull, 1,
+                              arg_names, arg_types, arg_values,
+                              TRACE_EVENT_FLAG_HAS_ID));
+
+  events.push_back(TraceEvent(thread_id, now, TRACE_EVENT_PHASE_END,
+                              category, name, 0, 0, NULL, NULL, NULL,
+                              TRACE_EVENT_FLAG_NONE));
+  return events;
+}
+
+std::string ToJSON(const std::vector<TraceEvent>& events) {
+  std::string json;
+  TraceEvent::AppendEventsAsJSON(events, 0, events.size(), &json);
+  return json;
+}
+
+}  // namespace
+
+TEST(TraceEventBinaryTest, ConvertsToJSON) {
+  TraceBinaryWriter writer;
+  TraceBinaryConverter converter;
+  int process_id = TraceLog::GetInstance()->process_id();
+
+  std::vector<TraceEvent> events = MakeEvents("binary");
+  std::string piece;
+  writer.WriteEvents(events, process_id, &piece);
+  std::string json;
+  ASSERT_TRUE(converter.AppendAsJSON(piece, &json));
+  EXPECT_EQ(ToJSON(events), json);
+
+  // Later pieces refer back to the strings of earlier ones.
+  std::string second_piece;
+  writer.WriteEvents(events, process_id, &second_piece);
+  EXPECT_LT(second_piece.size(), piece.size());
+  json.clear();
+  ASSERT_TRUE(converter.AppendAsJSON(second_piece, &json));
+  EXPECT_EQ(ToJSON(events), json);
+
+  // And is much smaller than the JSON.
+  EXPECT_LT(second_piece.size() * 2, json.size());
+}
+
+TEST(TraceEventBinaryTest, EmptyPiece) {
+  TraceBinaryWriter writer;
+  TraceBinaryConverter converter;
+  std::string piece;
+  writer.WriteEvents(std::vector<TraceEvent>(), 1, &piece);
+  std::string json;
+  EXPECT_TRUE(converter.AppendAsJSON(piece, &json));
+  EXPECT_TRUE(json.empty());
+}
+
+TEST(TraceEventBinaryTest, RejectsOutOfOrderPieces) {
+  TraceBinaryWriter writer;
+  std::vector<TraceEvent> events = MakeEvents("out of order");
+  std::string first_piece, second_piece;
+  writer.WriteEvents(events, 1, &first_piece);
+  writer.WriteEvents(events, 1, &second_piece);
+
+  std::string json;
+  TraceBinaryConverter converter;
+  EXPECT_FALSE(converter.AppendAsJSON(second_piece, &json));
+  EXPECT_TRUE(json.empty());
+
+  // A new stream can start at any time.
+  EXPECT_TRUE(converter.AppendAsJSON(first_piece, &json));
+  EXPECT_TRUE(converter.AppendAsJSON(second_piece, &json));
+  EXPECT_FALSE(converter.AppendAsJSON(second_piece, &json));
+  TraceBinaryWriter new_writer;
+  std::string new_piece;
+  new_writer.WriteEvents(events, 1, &new_piece);
+  EXPECT_TRUE(converter.AppendAsJSON(new_piece, &json));
+}
+
+TEST(TraceEventBinaryTest, RejectsMalformedPieces) {
+  TraceBinaryWriter writer;
+  std::string piece;
+  writer.WriteEvents(MakeEvents("malformed"), 1, &piece);
+
+  TraceBinaryConverter converter;
+  std::string json;
+  EXPECT_FALSE(converter.AppendAsJSON(std::string(), &json));
+  EXPECT_FALSE(converter.AppendAsJSON("not a trace", &json));
+  for (size_t size = 0; size < piece.size(); size += 4)
+    EXPECT_FALSE(converter.AppendAsJSON(piece.substr(0, size), &json));
+  EXPECT_TRUE(json.empty());
+  EXPECT_TRUE(converter.AppendAsJSON(piece, &json));
+}
+
+}  // namespace debug
+}  // namespace base
@@ -8,9 +8,11 @@
 
 #include "base/bind.h"
 #include "base/debug/trace_event.h"
+#include "base/debug/trace_event_binary.h"
 #include "base/file_util.h"
 #include "base/format_macros.h"
 #include "base/lazy_instance.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/memory/singleton.h"
 #include "base/process_util.h"
 #include "base/stringprintf.h"
@@ -42,6 +44,8 @@ namespace debug {
 // before throwing them away.
 const size_t kTraceEventBufferSize = 500000;
 const size_t kTraceEventBatchSize = 1000;
+// The number of events each thread buffers before handing them off.
+const size_t kTraceEventChunkSize = 256;
 
 #define TRACE_EVENT_MAX_CATEGORIES 100
 
@@ -68,9 +72,12 @@ int g_category_index = 3; // skip initial 3 categories
 LazyInstance<ThreadLocalPointer<const char> >::Leaky
     g_current_thread_name = LAZY_INSTANCE_INITIALIZER;
 
-void AppendValueAsJSON(unsigned char type,
-                       TraceEvent::TraceValue value,
-                       std::string* out) {
+}  // namespace
+
+// static
+void TraceEvent::AppendValueAsJSON(unsigned char type,
+                                   TraceEvent::TraceValue value,
+                                   std::string* out) {
   std::string::size_type start_pos;
   switch (type) {
     case TRACE_VALUE_TYPE_BOOL:
@@ -112,8 +119,6 @@ void AppendValueAsJSON(unsigned char type,
   }
 }
 
-}  // namespace
-
 ////////////////////////////////////////////////////////////////////////////////
 //
 // TraceEvent
@@ -310,6 +315,95 @@ void TraceResultBuffer::Finish() {
   output_callback_.Run("]");
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// TraceLog::TraceEventChunk, TraceLog::ThreadLocalEventBuffer
+//
+////////////////////////////////////////////////////////////////////////////////
+
+struct TraceLog::TraceEventChunk {
+  TraceEventChunk() : approximate_size(0) {
+    events.reserve(kTraceEventChunkSize);
+  }
+
+  std::vector<TraceEvent> events;
+
+  // Memory held by |events|, computed when the chunk is handed off.
+  size_t approximate_size;
+};
+
+// The events logged by one thread that have not been handed off yet.  Only
+// the owning thread adds to the buffer, but Flush() may take its events from
+// any thread, so every access goes through lock().
+class TraceLog::ThreadLocalEventBuffer {
+ public:
+  ThreadLocalEventBuffer()
+      : chunk_(new TraceEventChunk),
+        chunk_start_id_(0) {
+  }
+
+  Lock* lock() { return &lock_; }
+
+  // Returns false if an end event for the begin event |begin_id| should not
+  // be logged, either because the begin event has been handed off since or
+  // because less than |threshold| microseconds have passed.  In the latter
+  // case the begin event is dropped too.
+  bool ShouldAddEndEvent(int begin_id, TimeTicks now, long long threshold) {
+    lock_.AssertAcquired();
+    if (begin_id < chunk_start_id_)
+      return false;
+    size_t begin_i = static_cast<size_t>(begin_id - chunk_start_id_);
+    if (begin_i >= chunk_->events.size())
+      return false;
+    TimeDelta elapsed = now - chunk_->events[begin_i].timestamp();
+    if (elapsed < TimeDelta::FromMicroseconds(threshold)) {
+      // This will be expensive if there have been other events in the mean
+      // time (should be rare).
+      chunk_->events.erase(chunk_->events.begin() + begin_i);
+      return false;
+    }
+    return true;
+  }
+
+  // Appends |event| and returns its id.
+  int AddEvent(const TraceEvent& event) {
+    lock_.AssertAcquired();
+    int id = chunk_start_id_ + static_cast<int>(chunk_->events.size());
+    chunk_->events.push_back(event);
+    return id;
+  }
+
+  // Returns the buffered events if there are at least kTraceEventChunkSize
+  // of them, or NULL.
+  TraceEventChunk* TakeChunkIfFull() {
+    if (chunk_->events.size() < kTraceEventChunkSize)
+      return NULL;
+    return TakeChunk();
+  }
+
+  // Returns the buffered events, or NULL if there are none.
+  TraceEventChunk* TakeChunk() {
+    lock_.AssertAcquired();
+    if (chunk_->events.empty())
+      return NULL;
+    // Ids keep counting up across chunks so that an end event can tell its
+    // begin event has been handed off.
+    chunk_start_id_ += static_cast<int>(chunk_->events.size());
+    if (chunk_start_id_ > kint32max / 2)
+      chunk_start_id_ = 0;
+    TraceEventChunk* chunk = chunk_.release();
+    chunk_.reset(new TraceEventChunk);
+    return chunk;
+  }
+
+ private:
+  Lock lock_;
+  scoped_ptr<TraceEventChunk> chunk_;
+  int chunk_start_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadLocalEventBuffer);
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // TraceLog
@@ -323,6 +417,12 @@ TraceLog* TraceLog::GetInstance() {
 
 TraceLog::TraceLog()
     : enabled_(false)
+    , recording_mode_(RECORD_UNTIL_FULL)
+    , max_buffer_bytes_(0)
+    , chunk_event_count_(0)
+    , chunk_bytes_(0)
+    , buffer_full_(false)
+    , thread_local_event_buffer_slot_(&TraceLog::OnThreadExit)
     , dispatching_to_observer_list_(false) {
   // Trace is enabled or disabled on one thread while other threads are
   // accessing the enabled flag. We don't care whether edge-case events are
@@ -343,6 +443,11 @@ TraceLog::TraceLog()
 }
 
 TraceLog::~TraceLog() {
+  // Threads that are still running keep their buffers in TLS; freeing the
+  // slot stops OnThreadExit() from running for them.
+  thread_local_event_buffer_slot_.Free();
+  STLDeleteElements(&thread_local_event_buffers_);
+  STLDeleteElements(&chunks_);
 }
 
 const unsigned char* TraceLog::GetCategoryEnabled(const char* name) {
@@ -447,8 +552,12 @@ void TraceLog::SetEnabled(const std::vector<std::string>& included_categories,
                     OnTraceLogWillEnable());
   dispatching_to_observer_list_ = false;
 
-  logged_events_.reserve(1024);
   enabled_ = true;
+  {
+    // Each capture starts a new binary stream.
+    AutoLock binary_output_lock(binary_output_lock_);
+    binary_writer_.reset();
+  }
   included_categories_ = included_categories;
   excluded_categories_ = excluded_categories;
   // Note that if both included and excluded_categories are empty, the else
@@ -534,8 +643,21 @@ void TraceLog::RemoveEnabledStateObserver(
   enabled_state_observer_list_.RemoveObserver(listener);
 }
 
+void TraceLog::SetRecordingMode(RecordingMode mode, size_t max_buffer_bytes) {
+  AutoLock lock(lock_);
+  recording_mode_ = mode;
+  max_buffer_bytes_ = max_buffer_bytes;
+  if (recording_mode_ == RECORD_CONTINUOUSLY)
+    buffer_full_ = false;
+}
+
 float TraceLog::GetBufferPercentFull() const {
-  return (float)((double)logged_events_.size()/(double)kTraceEventBufferSize);
+  if (recording_mode_ == RECORD_CONTINUOUSLY) {
+    if (!max_buffer_bytes_)
+      return 0.0f;
+    return (float)((double)chunk_bytes_/(double)max_buffer_bytes_);
+  }
+  return (float)((double)chunk_event_count_/(double)kTraceEventBufferSize);
 }
 
 void TraceLog::SetOutputCallback(const TraceLog::OutputCallback& cb) {
@@ -543,34 +665,56 @@ void TraceLog::SetOutputCallback(const TraceLog::OutputCallback& cb) {
   output_callback_ = cb;
 }
 
+void TraceLog::SetBinaryOutputCallback(const TraceLog::OutputCallback& cb) {
+  AutoLock lock(lock_);
+  binary_output_callback_ = cb;
+}
+
 void TraceLog::SetBufferFullCallback(const TraceLog::BufferFullCallback& cb) {
   AutoLock lock(lock_);
   buffer_full_callback_ = cb;
 }
 
 void TraceLog::Flush() {
-  std::vector<TraceEvent> previous_logged_events;
+  std::deque<TraceEventChunk*> previous_chunks;
   OutputCallback output_callback_copy;
+  OutputCallback binary_output_callback_copy;
   {
     AutoLock lock(lock_);
-    previous_logged_events.swap(logged_events_);
+    previous_chunks.swap(chunks_);
+    chunk_event_count_ = 0;
+    chunk_bytes_ = 0;
+    buffer_full_ = false;
+    // Each thread's remaining events are newer than any it handed off.
+    for (size_t i = 0; i < thread_local_event_buffers_.size(); ++i) {
+      ThreadLocalEventBuffer* buffer = thread_local_event_buffers_[i];
+      AutoLock buffer_lock(*buffer->lock());
+      TraceEventChunk* chunk = buffer->TakeChunk();
+      if (chunk)
+        previous_chunks.push_back(chunk);
+    }
     output_callback_copy = output_callback_;
+    binary_output_callback_copy = binary_output_callback_;
   }  // release lock
 
-  if (output_callback_copy.is_null())
-    return;
-
-  for (size_t i = 0;
-       i < previous_logged_events.size();
-       i += kTraceEventBatchSize) {
-    scoped_refptr<RefCountedString> json_events_str_ptr =
-        new RefCountedString();
-    TraceEvent::AppendEventsAsJSON(previous_logged_events,
-                                   i,
-                                   kTraceEventBatchSize,
-                                   &(json_events_str_ptr->data()));
-    output_callback_copy.Run(json_events_str_ptr);
+  if (!binary_output_callback_copy.is_null()) {
+    for (size_t i = 0; i < previous_chunks.size(); ++i)
+      OutputBinaryChunk(*previous_chunks[i], binary_output_callback_copy);
+  } else if (!output_callback_copy.is_null()) {
+    for (size_t chunk_i = 0; chunk_i < previous_chunks.size(); ++chunk_i) {
+      const std::vector<TraceEvent>& events = previous_chunks[chunk_i]->events;
+      for (size_t i = 0; i < events.size(); i += kTraceEventBatchSize) {
+        scoped_refptr<RefCountedString> json_events_str_ptr =
+            new RefCountedString();
+        TraceEvent::AppendEventsAsJSON(events,
+                                       i,
+                                       kTraceEventBatchSize,
+                                       &(json_events_str_ptr->data()));
+        output_callback_copy.Run(json_events_str_ptr);
+      }
+    }
   }
+  STLDeleteElements(&previous_chunks);
 }
 
 int TraceLog::AddTraceEvent(char phase,
@@ -586,83 +730,181 @@ int TraceLog::AddTraceEvent(char phase,
                             unsigned char flags) {
   DCHECK(name);
   TimeTicks now = TimeTicks::NowFromSystemTraceTime();
-  BufferFullCallback buffer_full_callback_copy;
+  // Racy reads: an event that races with enabling or disabling tracing, or
+  // with the buffer filling up, may or may not be recorded.
+  if (!*category_enabled || buffer_full_)
+    return -1;
+
+  int thread_id = static_cast<int>(PlatformThread::CurrentId());
+
+  const char* new_name = PlatformThread::GetName();
+  // Check if the thread name has been set or changed since the previous
+  // call (if any), but don't bother if the new name is empty. Note this will
+  // not detect a thread name change within the same char* buffer address: we
+  // favor common case performance over corner case correctness.
+  if (new_name != g_current_thread_name.Get().Get() &&
+      new_name && *new_name) {
+    g_current_thread_name.Get().Set(new_name);
+    UpdateThreadName(thread_id, new_name);
+  }
+
+  if (flags & TRACE_EVENT_FLAG_MANGLE_ID)
+    id ^= process_id_hash_;
+
+  ThreadLocalEventBuffer* buffer = GetThreadLocalEventBuffer();
+  scoped_ptr<TraceEventChunk> full_chunk;
   int ret_begin_id = -1;
   {
-    AutoLock lock(lock_);
-    if (!*category_enabled)
-      return -1;
-    if (logged_events_.size() >= kTraceEventBufferSize)
-      return -1;
-
-    int thread_id = static_cast<int>(PlatformThread::CurrentId());
-
-    const char* new_name = PlatformThread::GetName();
-    // Check if the thread name has been set or changed since the previous
-    // call (if any), but don't bother if the new name is empty. Note this will
-    // not detect a thread name change within the same char* buffer address: we
-    // favor common case performance over corner case correctness.
-    if (new_name != g_current_thread_name.Get().Get() &&
-        new_name && *new_name) {
-      g_current_thread_name.Get().Set(new_name);
-      base::hash_map<int, std::string>::iterator existing_name =
-          thread_names_.find(thread_id);
-      if (existing_name == thread_names_.end()) {
-        // This is a new thread id, and a new name.
-        thread_names_[thread_id] = new_name;
-      } else {
-        // This is a thread id that we've seen before, but potentially with a
-        // new name.
-        std::vector<base::StringPiece> existing_names;
-        Tokenize(existing_name->second, ",", &existing_names);
-        bool found = std::find(existing_names.begin(),
-                               existing_names.end(),
-                               new_name) != existing_names.end();
-        if (!found) {
-          existing_name->second.push_back(',');
-          existing_name->second.append(new_name);
-        }
-      }
-    }
-
+    AutoLock buffer_lock(*buffer->lock());
     if (threshold_begin_id > -1) {
       DCHECK(phase == TRACE_EVENT_PHASE_END);
-      size_t begin_i = static_cast<size_t>(threshold_begin_id);
-      // Return now if there has been a flush since the begin event was posted.
-      if (begin_i >= logged_events_.size())
+      if (!buffer->ShouldAddEndEvent(threshold_begin_id, now, threshold))
         return -1;
-      // Determine whether to drop the begin/end pair.
-      TimeDelta elapsed = now - logged_events_[begin_i].timestamp();
-      if (elapsed < TimeDelta::FromMicroseconds(threshold)) {
-        // Remove begin event and do not add end event.
-        // This will be expensive if there have been other events in the
-        // mean time (should be rare).
-        logged_events_.erase(logged_events_.begin() + begin_i);
-        return -1;
-      }
     }
 
-    if (flags & TRACE_EVENT_FLAG_MANGLE_ID)
-      id ^= process_id_hash_;
-
-    ret_begin_id = static_cast<int>(logged_events_.size());
-    logged_events_.push_back(
+    ret_begin_id = buffer->AddEvent(
         TraceEvent(thread_id,
                    now, phase, category_enabled, name, id,
                    num_args, arg_names, arg_types, arg_values,
                    flags));
+    full_chunk.reset(buffer->TakeChunkIfFull());
+  }  // release buffer lock
 
-    if (logged_events_.size() == kTraceEventBufferSize) {
+  if (!full_chunk.get())
+    return ret_begin_id;
+
+  BufferFullCallback buffer_full_callback_copy;
+  OutputCallback binary_output_callback_copy;
+  {
+    AutoLock lock(lock_);
+    binary_output_callback_copy = binary_output_callback_;
+    if (binary_output_callback_copy.is_null() &&
+        AddChunkLocked(full_chunk.release())) {
       buffer_full_callback_copy = buffer_full_callback_;
     }
   }  // release lock
 
+  if (!binary_output_callback_copy.is_null())
+    OutputBinaryChunk(*full_chunk, binary_output_callback_copy);
+
   if (!buffer_full_callback_copy.is_null())
     buffer_full_callback_copy.Run();
 
   return ret_begin_id;
 }
 
+void TraceLog::UpdateThreadName(int thread_id, const char* new_name) {
+  AutoLock lock(lock_);
+  base::hash_map<int, std::string>::iterator existing_name =
+      thread_names_.find(thread_id);
+  if (existing_name == thread_names_.end()) {
+    // This is a new thread id, and a new name.
+    thread_names_[thread_id] = new_name;
+  } else {
+    // This is a thread id that we've seen before, but potentially with a
+    // new name.
+    std::vector<base::StringPiece> existing_names;
+    Tokenize(existing_name->second, ",", &existing_names);
+    bool found = std::find(existing_names.begin(),
+                           existing_names.end(),
+                           new_name) != existing_names.end();
+    if (!found) {
+      existing_name->second.push_back(',');
+      existing_name->second.append(new_name);
+    }
+  }
+}
+
+TraceLog::ThreadLocalEventBuffer* TraceLog::GetThreadLocalEventBuffer() {
+  ThreadLocalEventBuffer* buffer = static_cast<ThreadLocalEventBuffer*>(
+      thread_local_event_buffer_slot_.Get());
+  if (!buffer) {
+    buffer = new ThreadLocalEventBuffer;
+    thread_local_event_buffer_slot_.Set(buffer);
+    AutoLock lock(lock_);
+    thread_local_event_buffers_.push_back(buffer);
+  }
+  return buffer;
+}
+
+bool TraceLog::AddChunkLocked(TraceEventChunk* chunk) {
+  lock_.AssertAcquired();
+  chunk->approximate_size = chunk->events.capacity() * sizeof(TraceEvent);
+  for (size_t i = 0; i < chunk->events.size(); ++i) {
+    const RefCountedString* storage =
+        chunk->events[i].parameter_copy_storage();
+    if (storage)
+      chunk->approximate_size += storage->size();
+  }
+  chunks_.push_back(chunk);
+  chunk_event_count_ += chunk->events.size();
+  chunk_bytes_ += chunk->approximate_size;
+
+  if (recording_mode_ == RECORD_CONTINUOUSLY) {
+    // Always keep the newest chunk, however small the buffer.
+    while (chunk_bytes_ > max_buffer_bytes_ && chunks_.size() > 1) {
+      TraceEventChunk* oldest = chunks_.front();
+      chunks_.pop_front();
+      chunk_event_count_ -= oldest->events.size();
+      chunk_bytes_ -= oldest->approximate_size;
+      delete oldest;
+    }
+    return false;
+  }
+
+  // Threads notice |buffer_full_| before their next event, so the buffer can
+  // overshoot by at most one chunk per thread.
+  if (buffer_full_ || chunk_event_count_ < kTraceEventBufferSize)
+    return false;
+  buffer_full_ = true;
+  return true;
+}
+
+void TraceLog::HandOffCurrentThreadEvents() {
+  ThreadLocalEventBuffer* buffer = GetThreadLocalEventBuffer();
+  TraceEventChunk* chunk = NULL;
+  {
+    AutoLock buffer_lock(*buffer->lock());
+    chunk = buffer->TakeChunk();
+  }
+  if (chunk) {
+    AutoLock lock(lock_);
+    AddChunkLocked(chunk);
+  }
+}
+
+void TraceLog::OutputBinaryChunk(const TraceEventChunk& chunk,
+                                 const OutputCallback& cb) {
+  AutoLock binary_output_lock(binary_output_lock_);
+  if (!binary_writer_.get())
+    binary_writer_.reset(new TraceBinaryWriter);
+  scoped_refptr<RefCountedString> binary_events_str_ptr =
+      new RefCountedString();
+  binary_writer_->WriteEvents(chunk.events, process_id_,
+                              &binary_events_str_ptr->data());
+  cb.Run(binary_events_str_ptr);
+}
+
+// static
+void TraceLog::OnThreadExit(void* value) {
+  ThreadLocalEventBuffer* buffer = static_cast<ThreadLocalEventBuffer*>(value);
+  TraceLog* trace_log = GetInstance();
+  if (trace_log) {
+    AutoLock lock(trace_log->lock_);
+    std::vector<ThreadLocalEventBuffer*>& buffers =
+        trace_log->thread_local_event_buffers_;
+    std::vector<ThreadLocalEventBuffer*>::iterator it =
+        std::find(buffers.begin(), buffers.end(), buffer);
+    DCHECK(it != buffers.end());
+    buffers.erase(it);
+    AutoLock buffer_lock(*buffer->lock());
+    TraceEventChunk* chunk = buffer->TakeChunk();
+    if (chunk)
+      trace_log->AddChunkLocked(chunk);
+  }
+  delete buffer;
+}
+
 void TraceLog::AddTraceEventEtw(char phase,
                                 const char* name,
                                 const void* id,
@@ -727,6 +969,7 @@ void TraceLog::AddClockSyncMetadataEvents() {
 
 void TraceLog::AddThreadNameMetadataEvents() {
   lock_.AssertAcquired();
+  TraceEventChunk* chunk = new TraceEventChunk;
   for(base::hash_map<int, std::string>::iterator it = thread_names_.begin();
       it != thread_names_.end();
       it++) {
@@ -736,7 +979,7 @@ void TraceLog::AddThreadNameMetadataEvents() {
       unsigned char arg_type;
       unsigned long long arg_value;
       trace_event_internal::SetTraceValue(it->second, &arg_type, &arg_value);
-      logged_events_.push_back(
+      chunk->events.push_back(
           TraceEvent(it->first,
                      TimeTicks(), TRACE_EVENT_PHASE_METADATA,
                      &g_category_enabled[g_category_metadata],
@@ -745,6 +988,27 @@ void TraceLog::AddThreadNameMetadataEvents() {
                      TRACE_EVENT_FLAG_NONE));
     }
   }
+  if (chunk->events.empty())
+    delete chunk;
+  else
+    AddChunkLocked(chunk);
+}
+
+size_t TraceLog::GetEventsSize() {
+  HandOffCurrentThreadEvents();
+  AutoLock lock(lock_);
+  return chunk_event_count_;
+}
+
+const TraceEvent& TraceLog::GetEventAt(size_t index) {
+  AutoLock lock(lock_);
+  for (size_t i = 0; i < chunks_.size(); ++i) {
+    if (index < chunks_[i]->events.size())
+      return chunks_[i]->events[index];
+    index -= chunks_[i]->events.size();
+  }
+  NOTREACHED();
+  return chunks_.back()->events.back();
 }
 
 void TraceLog::DeleteForTesting() {
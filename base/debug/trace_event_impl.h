@@ -9,15 +9,18 @@
 
 #include "build/build_config.h"
 
+#include <deque>
 #include <string>
 #include <vector>
 
 #include "base/callback.h"
 #include "base/hash_tables.h"
 #include "base/memory/ref_counted_memory.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/observer_list.h"
 #include "base/string_util.h"
 #include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
 #include "base/timer.h"
 
 // Older style trace macros with explicit id and extra data
@@ -44,6 +47,8 @@ namespace base {
 
 namespace debug {
 
+class TraceBinaryWriter;
+
 const int kTraceMaxNumArgs = 2;
 
 // Output records are "Events" and can be obtained via the
@@ -82,7 +87,22 @@ class BASE_EXPORT TraceEvent {
                                  std::string* out);
   void AppendAsJSON(std::string* out) const;
 
+  // Serialize a single argument value to JSON.
+  static void AppendValueAsJSON(unsigned char type,
+                                TraceValue value,
+                                std::string* out);
+
   TimeTicks timestamp() const { return timestamp_; }
+  int thread_id() const { return thread_id_; }
+  char phase() const { return phase_; }
+  unsigned char flags() const { return flags_; }
+  unsigned long long id() const { return id_; }
+  const unsigned char* category_enabled() const { return category_enabled_; }
+
+  // Arguments are stored in order; the first NULL name ends the list.
+  const char* arg_name(int i) const { return arg_names_[i]; }
+  unsigned char arg_type(int i) const { return arg_types_[i]; }
+  TraceValue arg_value(int i) const { return arg_values_[i]; }
 
   // Exposed for unittesting:
 
@@ -153,8 +173,20 @@ class BASE_EXPORT TraceResultBuffer {
 };
 
 
+// TraceLog buffers events per thread, so recording an event normally only
+// takes a lock private to the recording thread.  Each thread fills a chunk of
+// events and hands it to a central list when it is full; whatever is still
+// buffered on each thread is collected when the log is flushed.
 class BASE_EXPORT TraceLog {
  public:
+  enum RecordingMode {
+    // Stop recording once the buffer holds kTraceEventBufferSize events.
+    RECORD_UNTIL_FULL,
+    // Keep recording, discarding the oldest events to stay within the buffer
+    // size given to SetRecordingMode().
+    RECORD_CONTINUOUSLY
+  };
+
   static TraceLog* GetInstance();
 
   // Get set of known categories. This can change as new code paths are reached.
@@ -212,6 +244,13 @@ class BASE_EXPORT TraceLog {
   void AddEnabledStateObserver(EnabledStateChangedObserver* listener);
   void RemoveEnabledStateObserver(EnabledStateChangedObserver* listener);
 
+  // Select what happens when the trace buffer fills up.  In
+  // RECORD_CONTINUOUSLY mode roughly the last |max_buffer_bytes| of events are
+  // kept, and calling Flush() while tracing is enabled outputs them, e.g. to
+  // capture what led up to a jank.  |max_buffer_bytes| is ignored in
+  // RECORD_UNTIL_FULL mode, which is the default.
+  void SetRecordingMode(RecordingMode mode, size_t max_buffer_bytes);
+
   float GetBufferPercentFull() const;
 
   // When enough events are collected, they are handed (in bulk) to
@@ -229,7 +268,17 @@ class BASE_EXPORT TraceLog {
   typedef base::Callback<void(void)> BufferFullCallback;
   void SetBufferFullCallback(const BufferFullCallback& cb);
 
-  // Flushes all logged data to the callback.
+  // Stream events in the binary format of trace_event_binary.h instead of
+  // buffering them for JSON output.  Each chunk of events is written to |cb|
+  // as soon as a thread hands it off, so long captures do not accumulate in
+  // memory, and Flush() writes out whatever is left.  Every piece of a capture
+  // must be passed, in order, to one TraceBinaryConverter to get JSON back.
+  // |cb| is run with an internal lock held and must not call into TraceLog.
+  // Pass a null callback to go back to buffering.
+  void SetBinaryOutputCallback(const OutputCallback& cb);
+
+  // Flushes all logged data, including the events still buffered by each
+  // thread, to the callback.
   void Flush();
 
   // Called by TRACE_EVENT* macros, don't call this directly.
@@ -274,12 +323,10 @@ class BASE_EXPORT TraceLog {
   // Allows resurrecting our singleton instance post-AtExit processing.
   static void Resurrect();
 
-  // Allow tests to inspect TraceEvents.
-  size_t GetEventsSize() const { return logged_events_.size(); }
-  const TraceEvent& GetEventAt(size_t index) const {
-    DCHECK(index < logged_events_.size());
-    return logged_events_[index];
-  }
+  // Allow tests to inspect TraceEvents.  This includes everything logged on
+  // the calling thread, but not events still buffered by other threads.
+  size_t GetEventsSize();
+  const TraceEvent& GetEventAt(size_t index);
 
   void SetProcessID(int process_id);
 
@@ -288,19 +335,57 @@ class BASE_EXPORT TraceLog {
   // by the Singleton class.
   friend struct StaticMemorySingletonTraits<TraceLog>;
 
+  class ThreadLocalEventBuffer;
+  struct TraceEventChunk;
+
   TraceLog();
   ~TraceLog();
   const unsigned char* GetCategoryEnabledInternal(const char* name);
   void AddThreadNameMetadataEvents();
   void AddClockSyncMetadataEvents();
+  void UpdateThreadName(int thread_id, const char* new_name);
+
+  // Returns the calling thread's event buffer, creating it on first use.
+  ThreadLocalEventBuffer* GetThreadLocalEventBuffer();
+
+  // Adds |chunk| to |chunks_|, taking ownership.  Returns true if this filled
+  // up the buffer.  Must be called with |lock_| held.
+  bool AddChunkLocked(TraceEventChunk* chunk);
+
+  // Moves the chunks buffered by the calling thread to |chunks_|.
+  void HandOffCurrentThreadEvents();
+
+  // Writes |chunk| to |cb| in the binary format.
+  void OutputBinaryChunk(const TraceEventChunk& chunk,
+                         const OutputCallback& cb);
+
+  static void OnThreadExit(void* buffer);
 
-  // TODO(nduca): switch to per-thread trace buffers to reduce thread
-  // synchronization.
   Lock lock_;
   bool enabled_;
+  RecordingMode recording_mode_;
+  size_t max_buffer_bytes_;
   OutputCallback output_callback_;
+  OutputCallback binary_output_callback_;
   BufferFullCallback buffer_full_callback_;
-  std::vector<TraceEvent> logged_events_;
+
+  // Chunks handed off by the threads, oldest first, and their totals.
+  std::deque<TraceEventChunk*> chunks_;
+  size_t chunk_event_count_;
+  size_t chunk_bytes_;
+
+  // Set when the buffer fills up in RECORD_UNTIL_FULL mode.  Read without
+  // |lock_|, so that threads stop recording as soon as possible.
+  bool buffer_full_;
+
+  ThreadLocalStorage::Slot thread_local_event_buffer_slot_;
+  std::vector<ThreadLocalEventBuffer*> thread_local_event_buffers_;
+
+  // Serializes the binary stream of the current capture, so that pieces come
+  // out in the order their strings were interned.  Taken after |lock_|.
+  Lock binary_output_lock_;
+  scoped_ptr<TraceBinaryWriter> binary_writer_;
+
   std::vector<std::string> included_categories_;
   std::vector<std::string> excluded_categories_;
   bool dispatching_to_observer_list_;
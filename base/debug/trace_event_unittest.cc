@@ -6,6 +6,7 @@
 
 #include "base/bind.h"
 #include "base/command_line.h"
+#include "base/debug/trace_event_binary.h"
 #include "base/json/json_reader.h"
 #include "base/json/json_writer.h"
 #include "base/memory/ref_counted_memory.h"
@@ -1107,6 +1108,97 @@ TEST_F(TraceEventTestFixture, DataCapturedManyThreads) {
                                            num_threads, num_events);
 }
 
+// Test that events buffered by a thread are gathered by a flush while the
+// thread is still running.
+TEST_F(TraceEventTestFixture, DataCapturedOnRunningThread) {
+  ManualTestSetUp();
+  TraceLog::GetInstance()->SetEnabled(true);
+
+  Thread thread("1");
+  WaitableEvent task_complete_event(false, false);
+  thread.Start();
+  thread.message_loop()->PostTask(
+      FROM_HERE, base::Bind(&TraceManyInstantEvents,
+                            0, 10, &task_complete_event));
+  task_complete_event.Wait();
+
+  TraceLog::GetInstance()->SetEnabled(false);
+  ValidateInstantEventPresentOnEveryThread(trace_parsed_, 1, 10);
+  thread.Stop();
+}
+
+// Test that continuous recording keeps the newest events and can be flushed
+// while tracing is still enabled.
+TEST_F(TraceEventTestFixture, ContinuousRecording) {
+  ManualTestSetUp();
+  TraceLog::GetInstance()->SetRecordingMode(TraceLog::RECORD_CONTINUOUSLY,
+                                            256 * 1024);
+  TraceLog::GetInstance()->SetEnabled(true);
+
+  const int kNumEvents = 20000;
+  TRACE_EVENT_INSTANT0("all", "first");
+  for (int i = 0; i < kNumEvents; ++i)
+    TRACE_EVENT_INSTANT0("all", "filler");
+  TRACE_EVENT_INSTANT0("all", "last");
+  EXPECT_LE(TraceLog::GetInstance()->GetBufferPercentFull(), 1.0f);
+
+  TraceLog::GetInstance()->Flush();
+  EXPECT_TRUE(TraceLog::GetInstance()->IsEnabled());
+  EXPECT_FALSE(FindTraceEntry(trace_parsed_, "first"));
+  EXPECT_TRUE(FindTraceEntry(trace_parsed_, "last"));
+  size_t num_fillers = FindTraceEntries(trace_parsed_, "filler").size();
+  EXPECT_GT(num_fillers, 0u);
+  EXPECT_LT(num_fillers, static_cast<size_t>(kNumEvents));
+
+  // Recording carries on after the snapshot.
+  Clear();
+  TRACE_EVENT_INSTANT0("all", "after snapshot");
+  TraceLog::GetInstance()->SetEnabled(false);
+  EXPECT_TRUE(FindTraceEntry(trace_parsed_, "after snapshot"));
+  EXPECT_FALSE(FindTraceEntry(trace_parsed_, "last"));
+}
+
+void AppendBinaryPiece(std::vector<std::string>* pieces,
+                       const scoped_refptr<base::RefCountedString>& piece) {
+  pieces->push_back(piece->data());
+}
+
+// Test that binary output streams out while tracing is enabled and converts
+// back to the same JSON.
+TEST_F(TraceEventTestFixture, BinaryStreaming) {
+  ManualTestSetUp();
+  std::vector<std::string> pieces;
+  TraceLog::GetInstance()->SetBinaryOutputCallback(
+      base::Bind(&AppendBinaryPiece, base::Unretained(&pieces)));
+  TraceLog::GetInstance()->SetEnabled(true);
+
+  const int kNumEvents = 1000;
+  for (int i = 0; i < kNumEvents; ++i)
+    TRACE_EVENT_INSTANT1("all", "streamed", "i", i);
+  EXPECT_FALSE(pieces.empty());
+  TraceWithAllMacroVariants(NULL);
+  TraceLog::GetInstance()->SetEnabled(false);
+  TraceLog::GetInstance()->SetBinaryOutputCallback(
+      TraceLog::OutputCallback());
+
+  TraceBinaryConverter converter;
+  scoped_refptr<base::RefCountedString> json(new base::RefCountedString);
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    std::string fragment;
+    ASSERT_TRUE(converter.AppendAsJSON(pieces[i], &fragment));
+    if (fragment.empty())
+      continue;
+    if (!json->data().empty())
+      json->data() += ",";
+    json->data() += fragment;
+  }
+  OnTraceDataCollected(json);
+
+  EXPECT_EQ(static_cast<size_t>(kNumEvents),
+            FindTraceEntries(trace_parsed_, "streamed").size());
+  ValidateAllTraceMacrosCreatedData(trace_parsed_);
+}
+
 // Test that thread and process names show up in the trace
 TEST_F(TraceEventTestFixture, ThreadNames) {
   ManualTestSetUp();
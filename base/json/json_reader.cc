@@ -4,6 +4,8 @@
 
 #include "base/json/json_reader.h"
 
+#include <string.h>
+
 #include "base/float_util.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
@@ -122,6 +124,27 @@ Value* JSONReader::ReadAndReturnError(const std::string& json,
   return NULL;
 }
 
+// static
+bool JSONReader::Parse(const std::string& json,
+                       int options,
+                       Delegate* delegate,
+                       int* error_code_out,
+                       std::string* error_msg_out) {
+  JSONReader reader = JSONReader();
+  if (reader.JsonToEvents(json, false,
+                          (options & JSON_ALLOW_TRAILING_COMMAS) != 0,
+                          delegate)) {
+    return true;
+  }
+
+  if (error_code_out)
+    *error_code_out = reader.error_code();
+  if (error_msg_out)
+    *error_msg_out = reader.GetErrorMessage();
+
+  return false;
+}
+
 // static
 std::string JSONReader::ErrorCodeToString(JsonParseError error_code) {
   switch (error_code) {
@@ -156,10 +179,28 @@ std::string JSONReader::GetErrorMessage() const {
 
 Value* JSONReader::JsonToValue(const std::string& json, bool check_root,
                                bool allow_trailing_comma) {
+  if (!StartParsing(json, allow_trailing_comma))
+    return NULL;
+
+  scoped_ptr<Value> root(BuildValue(check_root));
+  if (!FinishParsing(root.get() != NULL))
+    return NULL;
+  return root.release();
+}
+
+bool JSONReader::JsonToEvents(const std::string& json, bool check_root,
+                              bool allow_trailing_comma, Delegate* delegate) {
+  if (!StartParsing(json, allow_trailing_comma))
+    return false;
+  return FinishParsing(EmitValue(check_root, delegate));
+}
+
+bool JSONReader::StartParsing(const std::string& json,
+                              bool allow_trailing_comma) {
   // The input must be in UTF-8.
   if (!IsStringUTF8(json.data())) {
     error_code_ = JSON_UNSUPPORTED_ENCODING;
-    return NULL;
+    return false;
   }
 
   start_pos_ = json.data();
@@ -179,21 +220,21 @@ Value* JSONReader::JsonToValue(const std::string& json, bool check_root,
   allow_trailing_comma_ = allow_trailing_comma;
   stack_depth_ = 0;
   error_code_ = JSON_NO_ERROR;
+  return true;
+}
 
-  scoped_ptr<Value> root(BuildValue(check_root));
-  if (root.get()) {
-    if (ParseToken().type == Token::END_OF_INPUT) {
-      return root.release();
-    } else {
-      SetErrorCode(JSON_UNEXPECTED_DATA_AFTER_ROOT, json_pos_);
-    }
+bool JSONReader::FinishParsing(bool root_parsed) {
+  if (root_parsed) {
+    if (ParseToken().type == Token::END_OF_INPUT)
+      return true;
+    SetErrorCode(JSON_UNEXPECTED_DATA_AFTER_ROOT, json_pos_);
   }
 
   // Default to calling errors "syntax errors".
   if (error_code_ == 0)
     SetErrorCode(JSON_SYNTAX_ERROR, json_pos_);
 
-  return NULL;
+  return false;
 }
 
 // static
@@ -301,14 +342,9 @@ Value* JSONReader::BuildValue(bool is_root) {
             SetErrorCode(JSON_UNQUOTED_DICTIONARY_KEY, json_pos_);
             return NULL;
           }
-          scoped_ptr<Value> dict_key_value(DecodeString(token));
-          if (!dict_key_value.get())
-            return NULL;
-
-          // Convert the key into a wstring.
           std::string dict_key;
-          bool success = dict_key_value->GetAsString(&dict_key);
-          DCHECK(success);
+          if (!DecodeStringInto(token, &dict_key))
+            return NULL;
 
           json_pos_ += token.length;
           token = ParseToken();
@@ -360,6 +396,134 @@ Value* JSONReader::BuildValue(bool is_root) {
   return node.release();
 }
 
+bool JSONReader::EmitValue(bool is_root, Delegate* delegate) {
+  ++stack_depth_;
+  if (stack_depth_ > kStackLimit) {
+    SetErrorCode(JSON_TOO_MUCH_NESTING, json_pos_);
+    return false;
+  }
+
+  Token token = ParseToken();
+  // The root token must be an array or an object.
+  if (is_root && token.type != Token::OBJECT_BEGIN &&
+      token.type != Token::ARRAY_BEGIN) {
+    SetErrorCode(JSON_BAD_ROOT_ELEMENT_TYPE, json_pos_);
+    return false;
+  }
+
+  switch (token.type) {
+    case Token::NULL_TOKEN:
+      delegate->OnNull();
+      break;
+
+    case Token::BOOL_TRUE:
+      delegate->OnBoolean(true);
+      break;
+
+    case Token::BOOL_FALSE:
+      delegate->OnBoolean(false);
+      break;
+
+    case Token::NUMBER:
+      if (!EmitNumber(token, delegate))
+        return false;
+      break;
+
+    case Token::STRING:
+      {
+        StringPiece value;
+        if (!DecodeStringPiece(token, &value))
+          return false;
+        delegate->OnString(value);
+        break;
+      }
+
+    case Token::ARRAY_BEGIN:
+      {
+        json_pos_ += token.length;
+        token = ParseToken();
+
+        delegate->OnArrayBegin();
+        while (token.type != Token::ARRAY_END) {
+          if (!EmitValue(false, delegate))
+            return false;
+
+          // After a list value, we expect a comma or the end of the list.
+          token = ParseToken();
+          if (token.type == Token::LIST_SEPARATOR) {
+            json_pos_ += token.length;
+            token = ParseToken();
+            if (token.type == Token::ARRAY_END) {
+              if (!allow_trailing_comma_) {
+                SetErrorCode(JSON_TRAILING_COMMA, json_pos_);
+                return false;
+              }
+              break;
+            }
+          } else if (token.type != Token::ARRAY_END) {
+            return false;
+          }
+        }
+        delegate->OnArrayEnd();
+        break;
+      }
+
+    case Token::OBJECT_BEGIN:
+      {
+        json_pos_ += token.length;
+        token = ParseToken();
+
+        delegate->OnObjectBegin();
+        while (token.type != Token::OBJECT_END) {
+          if (token.type != Token::STRING) {
+            SetErrorCode(JSON_UNQUOTED_DICTIONARY_KEY, json_pos_);
+            return false;
+          }
+          StringPiece key;
+          if (!DecodeStringPiece(token, &key))
+            return false;
+
+          json_pos_ += token.length;
+          token = ParseToken();
+          if (token.type != Token::OBJECT_PAIR_SEPARATOR)
+            return false;
+          delegate->OnObjectKey(key);
+
+          json_pos_ += token.length;
+          if (!EmitValue(false, delegate))
+            return false;
+
+          // After a key/value pair, we expect a comma or the end of the
+          // object.
+          token = ParseToken();
+          if (token.type == Token::LIST_SEPARATOR) {
+            json_pos_ += token.length;
+            token = ParseToken();
+            if (token.type == Token::OBJECT_END) {
+              if (!allow_trailing_comma_) {
+                SetErrorCode(JSON_TRAILING_COMMA, json_pos_);
+                return false;
+              }
+              break;
+            }
+          } else if (token.type != Token::OBJECT_END) {
+            return false;
+          }
+        }
+        delegate->OnObjectEnd();
+        break;
+      }
+
+    default:
+      // We got a token that's not a value.
+      return false;
+  }
+  json_pos_ += token.length;
+
+  --stack_depth_;
+  return true;
+}
+
 JSONReader::Token JSONReader::ParseNumberToken() {
   // We just grab the number here.  We validate the size in DecodeNumber.
   // According   to RFC4627, a valid number is: [minus] int [frac] [exp]
@@ -411,6 +575,25 @@ Value* JSONReader::DecodeNumber(const Token& token) {
   return NULL;
 }
 
+bool JSONReader::EmitNumber(const Token& token, Delegate* delegate) {
+  int num_int;
+  if (StringToInt(StringPiece(token.begin, token.length), &num_int)) {
+    delegate->OnInteger(num_int);
+    return true;
+  }
+
+  // StringToDouble() only takes a std::string; reuse the scratch buffer.
+  decoded_scratch_.assign(token.begin, token.length);
+  double num_double;
+  if (StringToDouble(decoded_scratch_, &num_double) &&
+      base::IsFinite(num_double)) {
+    delegate->OnDouble(num_double);
+    return true;
+  }
+
+  return false;
+}
+
 JSONReader::Token JSONReader::ParseStringToken() {
   Token token(Token::STRING, json_pos_, 1);
   char c = token.NextChar();
@@ -458,7 +641,29 @@ JSONReader::Token JSONReader::ParseStringToken() {
 
 Value* JSONReader::DecodeString(const Token& token) {
   std::string decoded_str;
-  decoded_str.reserve(token.length - 2);
+  if (!DecodeStringInto(token, &decoded_str))
+    return NULL;
+  return Value::CreateStringValue(decoded_str);
+}
+
+bool JSONReader::DecodeStringPiece(const Token& token, StringPiece* piece) {
+  const char* contents = token.begin + 1;
+  size_t length = token.length - 2;
+  if (!memchr(contents, '\\', length)) {
+    piece->set(contents, length);
+    return true;
+  }
+
+  decoded_scratch_.clear();
+  if (!DecodeStringInto(token, &decoded_scratch_))
+    return false;
+  piece->set(decoded_scratch_.data(), decoded_scratch_.size());
+  return true;
+}
+
+bool JSONReader::DecodeStringInto(const Token& token,
+                                  std::string* decoded_str) {
+  decoded_str->reserve(token.length - 2);
 
   for (int i = 1; i < token.length - 1; ++i) {
     char c = *(token.begin + i);
@@ -469,54 +674,54 @@ Value* JSONReader::DecodeString(const Token& token) {
         case '"':
         case '/':
         case '\\':
-          decoded_str.push_back(c);
+          decoded_str->push_back(c);
           break;
         case 'b':
-          decoded_str.push_back('\b');
+          decoded_str->push_back('\b');
           break;
         case 'f':
-          decoded_str.push_back('\f');
+          decoded_str->push_back('\f');
           break;
         case 'n':
-          decoded_str.push_back('\n');
+          decoded_str->push_back('\n');
           break;
         case 'r':
-          decoded_str.push_back('\r');
+          decoded_str->push_back('\r');
           break;
         case 't':
-          decoded_str.push_back('\t');
+          decoded_str->push_back('\t');
           break;
         case 'v':
-          decoded_str.push_back('\v');
+          decoded_str->push_back('\v');
           break;
 
         case 'x': {
           if (i + 2 >= token.length)
-            return NULL;
+            return false;
           int hex_digit = 0;
           if (!HexStringToInt(StringPiece(token.begin + i + 1, 2), &hex_digit))
-            return NULL;
-          decoded_str.push_back(hex_digit);
+            return false;
+          decoded_str->push_back(hex_digit);
           i += 2;
           break;
         }
         case 'u':
-          if (!ConvertUTF16Units(token, &i, &decoded_str))
-            return NULL;
+          if (!ConvertUTF16Units(token, &i, decoded_str))
+            return false;
           break;
 
         default:
           // We should only have valid strings at this point.  If not,
           // ParseStringToken didn't do its job.
           NOTREACHED();
-          return NULL;
+          return false;
       }
     } else {
       // Not escaped
-      decoded_str.push_back(c);
+      decoded_str->push_back(c);
     }
   }
-  return Value::CreateStringValue(decoded_str);
+  return true;
 }
 
 bool JSONReader::ConvertUTF16Units(const Token& token,
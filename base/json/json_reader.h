@@ -3,7 +3,8 @@
 // found in the LICENSE file.
 //
 // A JSON parser.  Converts strings of JSON into a Value object (see
-// base/values.h).
+// base/values.h), or reports their contents as a stream of events to a
+// JSONReader::Delegate without building any Values.
 // http://www.ietf.org/rfc/rfc4627.txt?number=4627
 //
 // Known limitations/deviations from the RFC:
@@ -33,6 +34,7 @@
 
 #include "base/base_export.h"
 #include "base/basictypes.h"
+#include "base/string_piece.h"
 
 // Chromium and Chromium OS check out gtest to different places, so we're
 // unable to compile on both if we include gtest_prod.h here.  Instead, include
@@ -124,6 +126,26 @@ class BASE_EXPORT JSONReader {
   static const char* kUnsupportedEncoding;
   static const char* kUnquotedDictionaryKey;
 
+  // Receives the contents of a JSON document from Parse(), in document order.
+  // The pieces passed to OnObjectKey() and OnString() are only valid for the
+  // duration of the call.
+  class BASE_EXPORT Delegate {
+   public:
+    virtual void OnObjectBegin() = 0;
+    virtual void OnObjectKey(const StringPiece& key) = 0;
+    virtual void OnObjectEnd() = 0;
+    virtual void OnArrayBegin() = 0;
+    virtual void OnArrayEnd() = 0;
+    virtual void OnNull() = 0;
+    virtual void OnBoolean(bool value) = 0;
+    virtual void OnInteger(int value) = 0;
+    virtual void OnDouble(double value) = 0;
+    virtual void OnString(const StringPiece& value) = 0;
+
+   protected:
+    virtual ~Delegate() {}
+  };
+
   JSONReader();
 
   // Reads and parses |json|, returning a Value. The caller owns the returned
@@ -144,6 +166,17 @@ class BASE_EXPORT JSONReader {
                                    int* error_code_out,
                                    std::string* error_msg_out);
 
+  // Reads and parses |json| like ReadAndReturnError(), but reports its
+  // contents to |delegate| instead of building a Value.  Strings without
+  // escape sequences are passed as pieces of |json| and are never copied.
+  // Returns false if |json| is not properly formed, in which case |delegate|
+  // may already have seen the events for a prefix of it.
+  static bool Parse(const std::string& json,
+                    int options,  // JSONParserOptions
+                    Delegate* delegate,
+                    int* error_code_out,
+                    std::string* error_msg_out);
+
   // Converts a JSON parse error code into a human readable message.
   // Returns an empty string if error_code is JSON_NO_ERROR.
   static std::string ErrorCodeToString(JsonParseError error_code);
@@ -166,6 +199,11 @@ class BASE_EXPORT JSONReader {
   Value* JsonToValue(const std::string& json, bool check_root,
                      bool allow_trailing_comma);
 
+  // Reads and parses |json| like JsonToValue(), reporting its contents to
+  // |delegate|.  Returns false if |json| is not a properly formed JSON string.
+  bool JsonToEvents(const std::string& json, bool check_root,
+                    bool allow_trailing_comma, Delegate* delegate);
+
  private:
   FRIEND_TEST_ALL_PREFIXES(JSONReaderTest, Reading);
   FRIEND_TEST_ALL_PREFIXES(JSONReaderTest, ErrorMessages);
@@ -178,6 +216,18 @@ class BASE_EXPORT JSONReader {
   // an object or an array.
   Value* BuildValue(bool is_root);
 
+  // Sets up the parser state for parsing |json|.  Returns false if |json| is
+  // not UTF-8.
+  bool StartParsing(const std::string& json, bool allow_trailing_comma);
+
+  // Checks that nothing but whitespace follows the root value, and sets the
+  // error code if parsing failed without setting a more specific one.
+  bool FinishParsing(bool root_parsed);
+
+  // Like BuildValue(), but reports the value to |delegate| instead.  Returns
+  // false if we don't have a valid JSON string.
+  bool EmitValue(bool is_root, Delegate* delegate);
+
   // Parses a sequence of characters into a Token::NUMBER. If the sequence of
   // characters is not a valid number, returns a Token::INVALID_TOKEN. Note
   // that DecodeNumber is used to actually convert from a string to an
@@ -188,6 +238,10 @@ class BASE_EXPORT JSONReader {
   // we can (ie., no overflow), return the value, else return NULL.
   Value* DecodeNumber(const Token& token);
 
+  // Reports the number that |token| holds to |delegate| as an int or a double.
+  // Returns false if it is neither.
+  bool EmitNumber(const Token& token, Delegate* delegate);
+
   // Parses a sequence of characters into a Token::STRING. If the sequence of
   // characters is not a valid string, returns a Token::INVALID_TOKEN. Note
   // that DecodeString is used to actually decode the escaped string into an
@@ -198,6 +252,15 @@ class BASE_EXPORT JSONReader {
   // (otherwise ParseStringToken would have failed).
   Value* DecodeString(const Token& token);
 
+  // Decodes the string that |token| holds into |decoded_str|.  Returns false
+  // on an encoding error.
+  bool DecodeStringInto(const Token& token, std::string* decoded_str);
+
+  // Sets |piece| to the string that |token| holds.  The piece points into the
+  // input unless the string has escape sequences, in which case it is decoded
+  // into |decoded_scratch_| and is only valid until the next decode.
+  bool DecodeStringPiece(const Token& token, StringPiece* piece);
+
   // Helper function for DecodeString that consumes UTF16 [0,2] code units and
   // convers them to UTF8 code untis.  |token| is the string token in which the
   // units should be read, |i| is the position in the token at which the first
@@ -247,6 +310,10 @@ class BASE_EXPORT JSONReader {
   int error_line_;
   int error_col_;
 
+  // Holds the last escaped string decoded by DecodeStringPiece(), so that
+  // streaming parses reuse one buffer for all of them.
+  std::string decoded_scratch_;
+
   DISALLOW_COPY_AND_ASSIGN(JSONReader);
 };
 
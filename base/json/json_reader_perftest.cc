@@ -0,0 +1,93 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares the speed of JSONReader::Read(), which builds Values, and
+// JSONReader::Parse(), which reports events to a delegate, on a few megabytes
+// of JSON shaped like a typical large preferences or history file.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/compiler_specific.h"
+#include "base/json/json_reader.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/string_piece.h"
+#include "base/stringprintf.h"
+#include "base/test/perf_benchmark.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const int kNumEntries = 20000;
+
+// Counts the events of a parse, so that the parse can't be optimized away.
+class CountingDelegate : public JSONReader::Delegate {
+ public:
+  CountingDelegate() : events_(0) {}
+  virtual ~CountingDelegate() {}
+
+  int events() const { return events_; }
+
+  virtual void OnObjectBegin() OVERRIDE { ++events_; }
+  virtual void OnObjectKey(const StringPiece& key) OVERRIDE { ++events_; }
+  virtual void OnObjectEnd() OVERRIDE { ++events_; }
+  virtual void OnArrayBegin() OVERRIDE { ++events_; }
+  virtual void OnArrayEnd() OVERRIDE { ++events_; }
+  virtual void OnNull() OVERRIDE { ++events_; }
+  virtual void OnBoolean(bool value) OVERRIDE { ++events_; }
+  virtual void OnInteger(int value) OVERRIDE { ++events_; }
+  virtual void OnDouble(double value) OVERRIDE { ++events_; }
+  virtual void OnString(const StringPiece& value) OVERRIDE { ++events_; }
+
+ private:
+  int events_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingDelegate);
+};
+
+std::string MakeJSON() {
+  std::string json("[");
+  for (int i = 0; i < kNumEntries; ++i) {
+    if (i)
+      json.append(",");
+    StringAppendF(&json,
+        "{\"id\": %d, \"url\": \"http://www.example.com/a/path/%d\", "
+        "\"title\": \"Page \\\"%d\\\"\", \"score\": %d.25, "
+        "\"visited\": true, \"tags\": [\"one\", \"two\", null]}",
+        i, i, i, i);
+  }
+  json.append("]");
+  return json;
+}
+
+void Read(const std::string& json) {
+  scoped_ptr<Value> root(JSONReader::Read(json));
+  CHECK(root.get());
+}
+
+void Parse(const std::string& json) {
+  CountingDelegate delegate;
+  CHECK(JSONReader::Parse(json, JSON_PARSE_RFC, &delegate, NULL, NULL));
+  CHECK_EQ(2 + kNumEntries * 18, delegate.events());
+}
+
+}  // namespace
+
+TEST(JSONReaderPerfTest, Read) {
+  PerfBenchmark benchmark("JSONReader_Read");
+  benchmark.set_runs(10);
+  benchmark.Run(Bind(&Read, MakeJSON()));
+}
+
+TEST(JSONReaderPerfTest, Parse) {
+  PerfBenchmark benchmark("JSONReader_Parse");
+  benchmark.set_runs(10);
+  benchmark.Run(Bind(&Parse, MakeJSON()));
+}
+
+}  // namespace base
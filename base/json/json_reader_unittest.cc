@@ -4,6 +4,8 @@
 
 #include "base/json/json_reader.h"
 
+#include <vector>
+
 #include "base/base_paths.h"
 #include "base/file_util.h"
 #include "base/memory/scoped_ptr.h"
@@ -16,6 +18,107 @@
 
 namespace base {
 
+namespace {
+
+// Rebuilds the Value that JSONReader::Read() would return from the events of
+// a streaming parse.
+class ValueBuildingDelegate : public JSONReader::Delegate {
+ public:
+  ValueBuildingDelegate() {}
+  virtual ~ValueBuildingDelegate() {}
+
+  Value* root() { return root_.get(); }
+
+  virtual void OnObjectBegin() OVERRIDE {
+    Push(new DictionaryValue);
+  }
+  virtual void OnObjectKey(const StringPiece& key) OVERRIDE {
+    key_ = key.as_string();
+  }
+  virtual void OnObjectEnd() OVERRIDE {
+    stack_.pop_back();
+  }
+  virtual void OnArrayBegin() OVERRIDE {
+    Push(new ListValue);
+  }
+  virtual void OnArrayEnd() OVERRIDE {
+    stack_.pop_back();
+  }
+  virtual void OnNull() OVERRIDE {
+    Add(Value::CreateNullValue());
+  }
+  virtual void OnBoolean(bool value) OVERRIDE {
+    Add(Value::CreateBooleanValue(value));
+  }
+  virtual void OnInteger(int value) OVERRIDE {
+    Add(Value::CreateIntegerValue(value));
+  }
+  virtual void OnDouble(double value) OVERRIDE {
+    Add(Value::CreateDoubleValue(value));
+  }
+  virtual void OnString(const StringPiece& value) OVERRIDE {
+    Add(Value::CreateStringValue(value.as_string()));
+  }
+
+ private:
+  void Add(Value* value) {
+    if (stack_.empty()) {
+      root_.reset(value);
+    } else if (stack_.back()->IsType(Value::TYPE_LIST)) {
+      static_cast<ListValue*>(stack_.back())->Append(value);
+    } else {
+      static_cast<DictionaryValue*>(stack_.back())->SetWithoutPathExpansion(
+          key_, value);
+    }
+  }
+
+  void Push(Value* container) {
+    Add(container);
+    stack_.push_back(container);
+  }
+
+  scoped_ptr<Value> root_;
+  std::vector<Value*> stack_;
+  std::string key_;
+
+  DISALLOW_COPY_AND_ASSIGN(ValueBuildingDelegate);
+};
+
+// Counts events and remembers where the strings it was passed live.
+class CountingDelegate : public JSONReader::Delegate {
+ public:
+  CountingDelegate() : events_(0) {}
+  virtual ~CountingDelegate() {}
+
+  int events() const { return events_; }
+  const std::vector<const char*>& string_data() const { return string_data_; }
+
+  virtual void OnObjectBegin() OVERRIDE { ++events_; }
+  virtual void OnObjectKey(const StringPiece& key) OVERRIDE {
+    ++events_;
+    string_data_.push_back(key.data());
+  }
+  virtual void OnObjectEnd() OVERRIDE { ++events_; }
+  virtual void OnArrayBegin() OVERRIDE { ++events_; }
+  virtual void OnArrayEnd() OVERRIDE { ++events_; }
+  virtual void OnNull() OVERRIDE { ++events_; }
+  virtual void OnBoolean(bool value) OVERRIDE { ++events_; }
+  virtual void OnInteger(int value) OVERRIDE { ++events_; }
+  virtual void OnDouble(double value) OVERRIDE { ++events_; }
+  virtual void OnString(const StringPiece& value) OVERRIDE {
+    ++events_;
+    string_data_.push_back(value.data());
+  }
+
+ private:
+  int events_;
+  std::vector<const char*> string_data_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingDelegate);
+};
+
+}  // namespace
+
 TEST(JSONReaderTest, Reading) {
   // some whitespace checking
   scoped_ptr<Value> root;
@@ -607,4 +710,93 @@ TEST(JSONReaderTest, ErrorMessages) {
   EXPECT_EQ(JSONReader::JSON_INVALID_ESCAPE, error_code);
 }
 
+TEST(JSONReaderTest, ParseMatchesRead) {
+  const char* cases[] = {
+    "null",
+    "true",
+    "-42",
+    "4.5e-3",
+    "\"\"",
+    "\"plain\"",
+    "\"esc\\taped \\u00e9\\x41\"",
+    "[]",
+    "{}",
+    "[1, [2, [3, {}]], \"x\", null, false]",
+    "{\"a\": {\"b\\n\": [true, 1.5]}, \"c\": \"d\", \"e\": -0}",
+    "/* comment */ [1, // another\n 2]",
+    "\xEF\xBB\xBF{\"bom\": 1}",
+  };
+  for (size_t i = 0; i < arraysize(cases); ++i) {
+    scoped_ptr<Value> expected(JSONReader::Read(cases[i]));
+    ASSERT_TRUE(expected.get()) << cases[i];
+    ValueBuildingDelegate delegate;
+    EXPECT_TRUE(JSONReader::Parse(cases[i], JSON_PARSE_RFC, &delegate, NULL,
+                                  NULL)) << cases[i];
+    ASSERT_TRUE(delegate.root()) << cases[i];
+    EXPECT_TRUE(expected->Equals(delegate.root())) << cases[i];
+  }
+
+  ValueBuildingDelegate delegate;
+  EXPECT_TRUE(JSONReader::Parse("[1,]", JSON_ALLOW_TRAILING_COMMAS, &delegate,
+                                NULL, NULL));
+}
+
+TEST(JSONReaderTest, ParseErrors) {
+  const char* cases[] = {
+    "",
+    "[1, 2",
+    "{},{}",
+    "[1,]",
+    "{\"foo\":\"bar\",}",
+    "{foo:\"bar\"}",
+    "{\"foo\" \"bar\"}",
+    "[nu]",
+    "[\"xxx\\xq\"]",
+    "[\"\\ud83f\"]",
+    "1e1000",
+    "\"\xff\"",
+  };
+  for (size_t i = 0; i < arraysize(cases); ++i) {
+    int expected_code = 0;
+    std::string expected_message;
+    scoped_ptr<Value> root(JSONReader::ReadAndReturnError(
+        cases[i], JSON_PARSE_RFC, &expected_code, &expected_message));
+    ASSERT_FALSE(root.get()) << cases[i];
+
+    CountingDelegate delegate;
+    int error_code = 0;
+    std::string error_message;
+    EXPECT_FALSE(JSONReader::Parse(cases[i], JSON_PARSE_RFC, &delegate,
+                                   &error_code, &error_message)) << cases[i];
+    EXPECT_EQ(expected_code, error_code) << cases[i];
+    EXPECT_EQ(expected_message, error_message) << cases[i];
+  }
+
+  std::string nested_json;
+  for (int i = 0; i < 101; ++i) {
+    nested_json.insert(nested_json.begin(), '[');
+    nested_json.append(1, ']');
+  }
+  CountingDelegate delegate;
+  int error_code = 0;
+  EXPECT_FALSE(JSONReader::Parse(nested_json, JSON_PARSE_RFC, &delegate,
+                                 &error_code, NULL));
+  EXPECT_EQ(JSONReader::JSON_TOO_MUCH_NESTING, error_code);
+}
+
+TEST(JSONReaderTest, ParseDoesNotCopyPlainStrings) {
+  std::string json("{\"plain\": \"value\", \"esc\\\"aped\": \"\\n\"}");
+  CountingDelegate delegate;
+  ASSERT_TRUE(JSONReader::Parse(json, JSON_PARSE_RFC, &delegate, NULL, NULL));
+  EXPECT_EQ(6, delegate.events());
+  const std::vector<const char*>& data = delegate.string_data();
+  ASSERT_EQ(4u, data.size());
+  const char* begin = json.data();
+  const char* end = begin + json.size();
+  EXPECT_EQ(json.find("plain"), static_cast<size_t>(data[0] - begin));
+  EXPECT_EQ(json.find("value"), static_cast<size_t>(data[1] - begin));
+  EXPECT_TRUE(data[2] < begin || data[2] >= end);
+  EXPECT_TRUE(data[3] < begin || data[3] >= end);
+}
+
 }  // namespace base
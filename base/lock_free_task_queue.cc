@@ -0,0 +1,76 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/lock_free_task_queue.h"
+
+#include "base/logging.h"
+#include "base/third_party/dynamic_annotations/dynamic_annotations.h"
+
+namespace base {
+
+LockFreeTaskQueue::LockFreeTaskQueue() : head_(0) {
+}
+
+LockFreeTaskQueue::~LockFreeTaskQueue() {
+  Node* node = reinterpret_cast<Node*>(
+      subtle::NoBarrier_AtomicExchange(&head_, 0));
+  while (node) {
+    Node* next = node->next;
+    delete node;
+    node = next;
+  }
+}
+
+bool LockFreeTaskQueue::Push(PendingTask* pending_task) {
+  Node* node = new Node(*pending_task);
+  pending_task->task.Reset();
+
+  subtle::AtomicWord new_head = reinterpret_cast<subtle::AtomicWord>(node);
+  subtle::AtomicWord old_head = subtle::NoBarrier_Load(&head_);
+  for (;;) {
+    node->next = reinterpret_cast<Node*>(old_head);
+    // The release barrier publishes |node|'s contents before the node itself.
+    subtle::AtomicWord seen =
+        subtle::Release_CompareAndSwap(&head_, old_head, new_head);
+    if (seen == old_head)
+      break;
+    old_head = seen;
+  }
+  ANNOTATE_HAPPENS_BEFORE(&head_);
+  return old_head == 0;
+}
+
+bool LockFreeTaskQueue::TakeAll(TaskQueue* queue) {
+  DCHECK(queue);
+  Node* node = reinterpret_cast<Node*>(
+      subtle::NoBarrier_AtomicExchange(&head_, 0));
+  if (!node)
+    return false;
+  // Pairs with the release in Push() so the node contents are visible.
+  subtle::MemoryBarrier();
+  ANNOTATE_HAPPENS_AFTER(&head_);
+
+  // The detached list is newest-first; reverse it to restore post order.
+  Node* reversed = NULL;
+  while (node) {
+    Node* next = node->next;
+    node->next = reversed;
+    reversed = node;
+    node = next;
+  }
+
+  while (reversed) {
+    Node* next = reversed->next;
+    queue->push(reversed->task);
+    delete reversed;
+    reversed = next;
+  }
+  return true;
+}
+
+bool LockFreeTaskQueue::IsEmpty() const {
+  return subtle::Acquire_Load(&head_) == 0;
+}
+
+}  // namespace base
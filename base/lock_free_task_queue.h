@@ -0,0 +1,67 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_LOCK_FREE_TASK_QUEUE_H_
+#define BASE_LOCK_FREE_TASK_QUEUE_H_
+#pragma once
+
+#include "base/atomicops.h"
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/pending_task.h"
+
+namespace base {
+
+// A multi-producer, single-consumer queue of PendingTasks that never takes a
+// lock.  Any thread may call Push(); only one thread at a time may call
+// TakeAll().
+//
+// Producers push onto an intrusive singly linked list with a compare-and-swap
+// on the list head.  The consumer detaches the whole list with one atomic
+// exchange and reverses it, so tasks come out in the order in which their
+// pushes were linearized.  Because the consumer never removes individual
+// nodes, the usual ABA hazard of lock-free stacks does not arise.
+class BASE_EXPORT LockFreeTaskQueue {
+ public:
+  LockFreeTaskQueue();
+
+  // Deletes any tasks that were never taken.
+  ~LockFreeTaskQueue();
+
+  // Appends a copy of |pending_task|.  Returns true if the queue was empty
+  // before this push, i.e. if the consumer may need to be woken up.
+  //
+  // The caller's |pending_task->task| is reset before the copy becomes visible
+  // to the consumer, so the posting thread never holds the last reference to
+  // the closure.
+  bool Push(PendingTask* pending_task);
+
+  // Moves every queued task, oldest first, to the back of |queue|.  Returns
+  // false if there was nothing to take.  Must only be called by the consumer.
+  bool TakeAll(TaskQueue* queue);
+
+  // Returns true if no tasks are queued.  This is only a snapshot; producers
+  // may push at any moment.
+  bool IsEmpty() const;
+
+ private:
+  struct Node {
+    explicit Node(const PendingTask& pending_task)
+        : task(pending_task),
+          next(NULL) {
+    }
+
+    PendingTask task;
+    Node* next;
+  };
+
+  // Most recently pushed Node, cast to AtomicWord.  NULL when empty.
+  subtle::AtomicWord head_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockFreeTaskQueue);
+};
+
+}  // namespace base
+
+#endif  // BASE_LOCK_FREE_TASK_QUEUE_H_
@@ -0,0 +1,146 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/lock_free_task_queue.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/memory/scoped_vector.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+void RecordValue(std::vector<int>* values, int value) {
+  values->push_back(value);
+}
+
+void RunAll(TaskQueue* queue) {
+  while (!queue->empty()) {
+    queue->front().task.Run();
+    queue->pop();
+  }
+}
+
+// Pushes |count| tasks, each recording (|producer| * |count| + i), onto a
+// shared queue.
+class Producer : public DelegateSimpleThread::Delegate {
+ public:
+  Producer(LockFreeTaskQueue* queue,
+           std::vector<int>* values,
+           int producer,
+           int count)
+      : queue_(queue),
+        values_(values),
+        producer_(producer),
+        count_(count) {
+  }
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < count_; ++i) {
+      PendingTask pending_task(
+          FROM_HERE, Bind(&RecordValue, values_, producer_ * count_ + i));
+      queue_->Push(&pending_task);
+      EXPECT_TRUE(pending_task.task.is_null());
+    }
+  }
+
+ private:
+  LockFreeTaskQueue* queue_;
+  std::vector<int>* values_;
+  int producer_;
+  int count_;
+};
+
+}  // namespace
+
+TEST(LockFreeTaskQueueTest, Empty) {
+  LockFreeTaskQueue queue;
+  EXPECT_TRUE(queue.IsEmpty());
+
+  TaskQueue work_queue;
+  EXPECT_FALSE(queue.TakeAll(&work_queue));
+  EXPECT_TRUE(work_queue.empty());
+}
+
+TEST(LockFreeTaskQueueTest, PreservesOrder) {
+  LockFreeTaskQueue queue;
+  std::vector<int> values;
+
+  for (int i = 0; i < 10; ++i) {
+    PendingTask pending_task(FROM_HERE, Bind(&RecordValue, &values, i));
+    // Only the first push sees an empty queue.
+    EXPECT_EQ(i == 0, queue.Push(&pending_task));
+  }
+  EXPECT_FALSE(queue.IsEmpty());
+
+  TaskQueue work_queue;
+  EXPECT_TRUE(queue.TakeAll(&work_queue));
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_EQ(10u, work_queue.size());
+
+  RunAll(&work_queue);
+  ASSERT_EQ(10u, values.size());
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(i, values[i]);
+
+  // Once drained, the next push reports an empty queue again.
+  PendingTask pending_task(FROM_HERE, Bind(&RecordValue, &values, 10));
+  EXPECT_TRUE(queue.Push(&pending_task));
+}
+
+TEST(LockFreeTaskQueueTest, DeletesUntakenTasks) {
+  std::vector<int> values;
+  {
+    LockFreeTaskQueue queue;
+    PendingTask pending_task(FROM_HERE, Bind(&RecordValue, &values, 1));
+    queue.Push(&pending_task);
+  }
+  EXPECT_TRUE(values.empty());
+}
+
+TEST(LockFreeTaskQueueTest, MultipleProducers) {
+  const int kProducers = 8;
+  const int kTasksPerProducer = 1000;
+
+  LockFreeTaskQueue queue;
+  std::vector<int> values;
+  ScopedVector<Producer> producers;
+  ScopedVector<DelegateSimpleThread> threads;
+  for (int i = 0; i < kProducers; ++i) {
+    producers.push_back(
+        new Producer(&queue, &values, i, kTasksPerProducer));
+    threads.push_back(
+        new DelegateSimpleThread(producers[i], "LockFreeTaskQueueProducer"));
+  }
+  for (int i = 0; i < kProducers; ++i)
+    threads[i]->Start();
+
+  // Drain concurrently with the producers.
+  TaskQueue work_queue;
+  while (values.size() < static_cast<size_t>(kProducers * kTasksPerProducer)) {
+    queue.TakeAll(&work_queue);
+    RunAll(&work_queue);
+  }
+
+  for (int i = 0; i < kProducers; ++i)
+    threads[i]->Join();
+  EXPECT_TRUE(queue.IsEmpty());
+
+  // Tasks from any one producer must run in the order they were pushed.
+  std::vector<int> last_seen(kProducers, -1);
+  for (size_t i = 0; i < values.size(); ++i) {
+    int producer = values[i] / kTasksPerProducer;
+    int index = values[i] % kTasksPerProducer;
+    EXPECT_EQ(last_seen[producer] + 1, index);
+    last_seen[producer] = index;
+  }
+  for (int i = 0; i < kProducers; ++i)
+    EXPECT_EQ(kTasksPerProducer - 1, last_seen[i]);
+}
+
+}  // namespace base
@@ -11,6 +11,7 @@
 #include "base/debug/alias.h"
 #include "base/debug/trace_event.h"
 #include "base/lazy_instance.h"
+#include "base/lock_free_task_queue.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop_proxy_impl.h"
@@ -86,6 +87,20 @@ const base::LinearHistogram::DescriptionPair event_descriptions_[] = {
 
 bool enable_histogrammer_ = false;
 
+// How often the delayed wakeup rate is recorded.
+const int kWakeupWindowSeconds = 60;
+
+// Rounds |run_time| up to the next multiple of |leeway|. Aligning to a
+// common grid, rather than to each task's own deadline, is what lets
+// unrelated tasks share a wakeup.
+base::TimeTicks AlignToLeeway(base::TimeTicks run_time,
+                              base::TimeDelta leeway) {
+  const int64 granularity = leeway.ToInternalValue();
+  const int64 ticks = run_time.ToInternalValue();
+  return base::TimeTicks::FromInternalValue(
+      (ticks + granularity - 1) / granularity * granularity);
+}
+
 MessageLoop::MessagePumpFactory* message_pump_for_ui_factory_ = NULL;
 
 }  // namespace
@@ -125,11 +140,16 @@ MessageLoop::DestructionObserver::~DestructionObserver() {
 
 //------------------------------------------------------------------------------
 
-MessageLoop::MessageLoop(Type type)
+MessageLoop::MessageLoop(Type type, IncomingQueueType incoming_queue_type)
     : type_(type),
+      waiting_for_delayed_work_(false),
+      delayed_wakeup_count_(0),
+      window_wakeup_count_(0),
       nestable_tasks_allowed_(true),
       exception_restoration_(false),
       message_histogram_(NULL),
+      wakeup_histogram_(NULL),
+      incoming_queue_type_(incoming_queue_type),
       state_(NULL),
 #ifdef OS_WIN
       os_modal_loop_(false),
@@ -140,6 +160,9 @@ MessageLoop::MessageLoop(Type type)
 
   message_loop_proxy_ = new base::MessageLoopProxyImpl();
 
+  if (incoming_queue_type_ == INCOMING_QUEUE_LOCK_FREE)
+    lock_free_incoming_queue_.reset(new base::LockFreeTaskQueue());
+
 // TODO(rvargas): Get rid of the OS guards.
 #if defined(OS_WIN)
 #define MESSAGE_PUMP_UI new base::MessagePumpForUI()
@@ -272,6 +295,20 @@ void MessageLoop::PostDelayedTask(
   PostDelayedTask(from_here, task, delay.InMillisecondsRoundedUp());
 }
 
+void MessageLoop::PostDelayedTaskWithLeeway(
+    const tracked_objects::Location& from_here,
+    const base::Closure& task,
+    base::TimeDelta delay,
+    base::TimeDelta leeway) {
+  DCHECK(!task.is_null()) << from_here.ToString();
+  TimeTicks delayed_run_time =
+      CalculateDelayedRuntime(delay.InMillisecondsRoundedUp());
+  if (!delayed_run_time.is_null() && leeway > TimeDelta())
+    delayed_run_time = AlignToLeeway(delayed_run_time, leeway);
+  PendingTask pending_task(from_here, task, delayed_run_time, true);
+  AddToIncomingQueue(&pending_task);
+}
+
 void MessageLoop::PostNonNestableTask(
     const tracked_objects::Location& from_here, const base::Closure& task) {
   DCHECK(!task.is_null()) << from_here.ToString();
@@ -363,6 +400,10 @@ void MessageLoop::RemoveTaskObserver(TaskObserver* task_observer) {
 
 void MessageLoop::AssertIdle() const {
   // We only check |incoming_queue_|, since we don't want to lock |work_queue_|.
+  if (lock_free_incoming_queue_.get()) {
+    DCHECK(lock_free_incoming_queue_->IsEmpty());
+    return;
+  }
   base::AutoLock lock(incoming_queue_lock_);
   DCHECK(incoming_queue_.empty());
 }
@@ -460,7 +501,7 @@ void MessageLoop::RunTask(const PendingTask& pending_task) {
                     DidProcessTask(pending_task.time_posted));
 
   tracked_objects::ThreadData::TallyRunOnNamedThreadIfTracking(pending_task,
-      start_time, tracked_objects::ThreadData::NowForEndOfRun());
+      start_time, tracked_objects::ThreadData::NowForEndOfRun(start_time));
 
   nestable_tasks_allowed_ = true;
 }
@@ -497,6 +538,12 @@ void MessageLoop::ReloadWorkQueue() {
   if (!work_queue_.empty())
     return;  // Wait till we *really* need to lock and load.
 
+  if (lock_free_incoming_queue_.get()) {
+    // work_queue_ is empty, so appending is equivalent to the swap below.
+    lock_free_incoming_queue_->TakeAll(&work_queue_);
+    return;
+  }
+
   // Acquire all we can from the inter-thread queue with one lock acquisition.
   {
     base::AutoLock lock(incoming_queue_lock_);
@@ -581,6 +628,16 @@ void MessageLoop::AddToIncomingQueue(PendingTask* pending_task) {
   // directly, as it could starve handling of foreign threads.  Put every task
   // into this queue.
 
+  if (lock_free_incoming_queue_.get()) {
+    // There is no lock to hold |this| alive across the push: once the task is
+    // visible it may run and destroy this message loop.  Take the reference
+    // to the pump before publishing the task.
+    scoped_refptr<base::MessagePump> pump(pump_);
+    if (lock_free_incoming_queue_->Push(pending_task))
+      pump->ScheduleWork();
+    return;
+  }
+
   scoped_refptr<base::MessagePump> pump;
   {
     base::AutoLock locked(incoming_queue_lock_);
@@ -618,6 +675,33 @@ void MessageLoop::StartHistogrammer() {
   }
 }
 
+void MessageLoop::RecordDelayedWakeup() {
+  ++delayed_wakeup_count_;
+  if (!message_histogram_)
+    return;
+
+  ++window_wakeup_count_;
+  if (wakeup_window_start_.is_null()) {
+    wakeup_window_start_ = recent_time_;
+    return;
+  }
+  TimeDelta elapsed = recent_time_ - wakeup_window_start_;
+  if (elapsed < TimeDelta::FromSeconds(kWakeupWindowSeconds))
+    return;
+
+  if (!wakeup_histogram_) {
+    wakeup_histogram_ = base::Histogram::FactoryGet(
+        "MsgLoop.DelayedWakeupsPerMinute:" + thread_name_, 1, 100000, 50,
+        base::Histogram::kNoFlags);
+  }
+  // A quiet thread may not wake up again for longer than the window, so
+  // scale the count to a rate.
+  wakeup_histogram_->Add(static_cast<int>(
+      window_wakeup_count_ * 60 / elapsed.InSecondsF()));
+  window_wakeup_count_ = 0;
+  wakeup_window_start_ = recent_time_;
+}
+
 void MessageLoop::HistogramEvent(int event) {
   if (message_histogram_)
     message_histogram_->Add(event);
@@ -672,10 +756,16 @@ bool MessageLoop::DoDelayedWork(TimeTicks* next_delayed_work_time) {
     recent_time_ = TimeTicks::Now();  // Get a better view of Now();
     if (next_run_time > recent_time_) {
       *next_delayed_work_time = next_run_time;
+      waiting_for_delayed_work_ = true;
       return false;
     }
   }
 
+  if (waiting_for_delayed_work_) {
+    waiting_for_delayed_work_ = false;
+    RecordDelayedWakeup();
+  }
+
   PendingTask pending_task = delayed_work_queue_.top();
   delayed_work_queue_.pop();
 
@@ -14,6 +14,7 @@
 #include "base/callback_forward.h"
 #include "base/location.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/message_loop_proxy.h"
 #include "base/message_pump.h"
 #include "base/observer_list.h"
@@ -42,6 +43,7 @@
 
 namespace base {
 class Histogram;
+class LockFreeTaskQueue;
 }
 
 // A MessageLoop is used to process events for a particular thread.  There is
@@ -103,9 +105,29 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
     TYPE_IO
   };
 
+  // Selects how tasks posted from other threads reach the MessageLoop.
+  //
+  // INCOMING_QUEUE_LOCKED
+  //   Posted tasks are appended to a queue guarded by a lock.  This is the
+  //   default, and is cheapest when only a few threads post to the loop.
+  //
+  // INCOMING_QUEUE_LOCK_FREE
+  //   Posted tasks are pushed onto a lock-free multi-producer list (see
+  //   base/lock_free_task_queue.h) which the loop drains with one atomic
+  //   exchange.  Use this for loops that receive posts from many threads at
+  //   once, such as the IO and UI loops.  Task ordering is the same as with
+  //   the locked queue.
+  //
+  enum IncomingQueueType {
+    INCOMING_QUEUE_LOCKED,
+    INCOMING_QUEUE_LOCK_FREE
+  };
+
   // Normally, it is not necessary to instantiate a MessageLoop.  Instead, it
   // is typical to make use of the current thread's MessageLoop instance.
-  explicit MessageLoop(Type type = TYPE_DEFAULT);
+  explicit MessageLoop(
+      Type type = TYPE_DEFAULT,
+      IncomingQueueType incoming_queue_type = INCOMING_QUEUE_LOCKED);
   virtual ~MessageLoop();
 
   // Returns the MessageLoop object for the current thread, or null if none.
@@ -171,6 +193,17 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
       const base::Closure& task,
       base::TimeDelta delay);
 
+  // Like PostDelayedTask, but the task may run up to |leeway| later than
+  // |delay|. The run time is rounded up to a multiple of |leeway|, so that
+  // tasks posted with the same or a larger multiple of leeway, such as
+  // periodic cleanup and polling timers, fall due together and run in one
+  // wakeup instead of waking the thread once each.
+  void PostDelayedTaskWithLeeway(
+      const tracked_objects::Location& from_here,
+      const base::Closure& task,
+      base::TimeDelta delay,
+      base::TimeDelta leeway);
+
   void PostNonNestableTask(
       const tracked_objects::Location& from_here,
       const base::Closure& task);
@@ -244,6 +277,11 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   // Returns the type passed to the constructor.
   Type type() const { return type_; }
 
+  // Returns the incoming queue type passed to the constructor.
+  IncomingQueueType incoming_queue_type() const {
+    return incoming_queue_type_;
+  }
+
   // Optional call to connect the thread name with this loop.
   void set_thread_name(const std::string& thread_name) {
     DCHECK(thread_name_.empty()) << "Should not rename this thread!";
@@ -251,6 +289,10 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   }
   const std::string& thread_name() const { return thread_name_; }
 
+  // Returns how many times the loop has woken up to run delayed tasks, each
+  // wakeup running every task that was due by then.
+  int delayed_wakeup_count() const { return delayed_wakeup_count_; }
+
   // Gets the message loop proxy associated with this message loop.
   scoped_refptr<base::MessageLoopProxy> message_loop_proxy() {
     return message_loop_proxy_.get();
@@ -437,9 +479,10 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   // beyond this function call.
   void AddToIncomingQueue(base::PendingTask* pending_task);
 
-  // Load tasks from the incoming_queue_ into work_queue_ if the latter is
-  // empty.  The former requires a lock to access, while the latter is directly
-  // accessible on this thread.
+  // Load tasks from the incoming_queue_ (or lock_free_incoming_queue_) into
+  // work_queue_ if the latter is empty.  The former requires a lock or an
+  // atomic exchange to access, while the latter is directly accessible on this
+  // thread.
   void ReloadWorkQueue();
 
   // Delete tasks that haven't run yet without running them.  Used in the
@@ -450,6 +493,10 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   // Calculates the time at which a PendingTask should run.
   base::TimeTicks CalculateDelayedRuntime(int64 delay_ms);
 
+  // Counts a wakeup to run delayed tasks and, if histograms are enabled for
+  // this loop, records the wakeup rate about once a minute.
+  void RecordDelayedWakeup();
+
   // Start recording histogram info about events and action IF it was enabled
   // and IF the statistics recorder can accept a registration of our histogram.
   void StartHistogrammer();
@@ -476,6 +523,14 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   // A recent snapshot of Time::Now(), used to check delayed_work_queue_.
   base::TimeTicks recent_time_;
 
+  // True once DoDelayedWork() has found the next delayed task not yet due,
+  // so that running it counts as a wakeup.
+  bool waiting_for_delayed_work_;
+  int delayed_wakeup_count_;
+  // Wakeups counted since |wakeup_window_start_| for |wakeup_histogram_|.
+  int window_wakeup_count_;
+  base::TimeTicks wakeup_window_start_;
+
   // A queue of non-nestable tasks that we had to defer because when it came
   // time to execute them we were in a nested message loop.  They will execute
   // once we're out of nested message loops.
@@ -494,6 +549,8 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   std::string thread_name_;
   // A profiling histogram showing the counts of various messages and events.
   base::Histogram* message_histogram_;
+  // Delayed task wakeups per minute, recorded alongside |message_histogram_|.
+  base::Histogram* wakeup_histogram_;
 
   // A null terminated list which creates an incoming_queue of tasks that are
   // acquired under a mutex for processing on this instance's thread. These
@@ -503,6 +560,12 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   // Protect access to incoming_queue_.
   mutable base::Lock incoming_queue_lock_;
 
+  IncomingQueueType incoming_queue_type_;
+
+  // Used instead of incoming_queue_ when |incoming_queue_type_| is
+  // INCOMING_QUEUE_LOCK_FREE.  NULL otherwise.
+  scoped_ptr<base::LockFreeTaskQueue> lock_free_incoming_queue_;
+
   RunState* state_;
 
 #if defined(OS_WIN)
@@ -0,0 +1,100 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares the locked and lock-free incoming queues of MessageLoop with
+// several threads posting to one loop at once.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/memory/scoped_vector.h"
+#include "base/message_loop.h"
+#include "base/stringprintf.h"
+#include "base/test/perf_benchmark.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kNumPostsPerThread = 10000;
+
+// Runs on the target loop; quits it once |target| tasks have arrived.
+void CountPostedTask(int* count, int target) {
+  if (++(*count) == target)
+    MessageLoop::current()->Quit();
+}
+
+// Floods |loop| with tasks from a separate thread.
+class PostingDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  PostingDelegate(MessageLoop* loop, int* count, int num_posts, int target)
+      : loop_(loop),
+        count_(count),
+        num_posts_(num_posts),
+        target_(target) {
+  }
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < num_posts_; ++i)
+      loop_->PostTask(FROM_HERE, base::Bind(&CountPostedTask, count_, target_));
+  }
+
+ private:
+  MessageLoop* loop_;
+  int* count_;
+  int num_posts_;
+  int target_;
+};
+
+// Posts kNumPostsPerThread tasks from each of |num_threads| threads and runs
+// them all on the current thread.
+void PostFromThreads(MessageLoop::IncomingQueueType incoming_queue_type,
+                     int num_threads) {
+  MessageLoop loop(MessageLoop::TYPE_DEFAULT, incoming_queue_type);
+  const int target = num_threads * kNumPostsPerThread;
+  int count = 0;
+
+  ScopedVector<PostingDelegate> delegates;
+  ScopedVector<base::DelegateSimpleThread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    delegates.push_back(
+        new PostingDelegate(&loop, &count, kNumPostsPerThread, target));
+    threads.push_back(
+        new base::DelegateSimpleThread(delegates[i], "PostingThread"));
+  }
+
+  for (int i = 0; i < num_threads; ++i)
+    threads[i]->Start();
+  loop.Run();
+
+  for (int i = 0; i < num_threads; ++i)
+    threads[i]->Join();
+  CHECK_EQ(target, count);
+}
+
+void RunContentionBenchmarks(
+    const std::string& name,
+    MessageLoop::IncomingQueueType incoming_queue_type) {
+  const int kNumThreads[] = { 1, 4, 8, 16 };
+  for (size_t i = 0; i < arraysize(kNumThreads); ++i) {
+    base::PerfBenchmark benchmark(base::StringPrintf(
+        "MessageLoop_IncomingQueue_%s_%dthreads", name.c_str(),
+        kNumThreads[i]));
+    benchmark.set_runs(10);
+    benchmark.Run(
+        base::Bind(&PostFromThreads, incoming_queue_type, kNumThreads[i]));
+  }
+}
+
+}  // namespace
+
+TEST(MessageLoopPerfTest, IncomingQueueContentionLocked) {
+  RunContentionBenchmarks("Locked", MessageLoop::INCOMING_QUEUE_LOCKED);
+}
+
+TEST(MessageLoopPerfTest, IncomingQueueContentionLockFree) {
+  RunContentionBenchmarks("LockFree", MessageLoop::INCOMING_QUEUE_LOCK_FREE);
+}
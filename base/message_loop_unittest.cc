@@ -10,8 +10,10 @@
 #include "base/eintr_wrapper.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/scoped_vector.h"
 #include "base/message_loop.h"
 #include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
 #include "base/threading/thread.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -80,8 +82,9 @@ class Foo : public base::RefCounted<Foo> {
   std::string result_;
 };
 
-void RunTest_PostTask(MessageLoop::Type message_loop_type) {
-  MessageLoop loop(message_loop_type);
+void RunTest_PostTask(MessageLoop::Type message_loop_type,
+                      MessageLoop::IncomingQueueType incoming_queue_type) {
+  MessageLoop loop(message_loop_type, incoming_queue_type);
 
   // Add tests to message loop
   scoped_refptr<Foo> foo(new Foo());
@@ -207,6 +210,37 @@ void RunTest_PostDelayedTask_InDelayOrder(
   EXPECT_TRUE(run_time2 < run_time1);
 }
 
+void RunTest_PostDelayedTask_WithLeeway(
+    MessageLoop::Type message_loop_type) {
+  MessageLoop loop(message_loop_type);
+
+  // Test that tasks with different delays but a common leeway run in one
+  // wakeup, and none of them early.
+  const TimeDelta kLeeway = TimeDelta::FromMilliseconds(200);
+  int num_tasks = 3;
+  Time run_time1, run_time2, run_time3;
+
+  Time time_before_post = Time::Now();
+  loop.PostDelayedTaskWithLeeway(
+      FROM_HERE, base::Bind(&RecordRunTimeFunc, &run_time1, &num_tasks),
+      TimeDelta::FromMilliseconds(10), kLeeway);
+  loop.PostDelayedTaskWithLeeway(
+      FROM_HERE, base::Bind(&RecordRunTimeFunc, &run_time2, &num_tasks),
+      TimeDelta::FromMilliseconds(30), kLeeway);
+  loop.PostDelayedTaskWithLeeway(
+      FROM_HERE, base::Bind(&RecordRunTimeFunc, &run_time3, &num_tasks),
+      TimeDelta::FromMilliseconds(50), kLeeway);
+
+  loop.Run();
+  EXPECT_EQ(0, num_tasks);
+
+  EXPECT_LE(TimeDelta::FromMilliseconds(10), run_time1 - time_before_post);
+  EXPECT_LE(TimeDelta::FromMilliseconds(30), run_time2 - time_before_post);
+  EXPECT_LE(TimeDelta::FromMilliseconds(50), run_time3 - time_before_post);
+  // The 50ms span of delays crosses at most one boundary of the 200ms grid.
+  EXPECT_GE(2, loop.delayed_wakeup_count());
+}
+
 void RunTest_PostDelayedTask_InPostOrder(
     MessageLoop::Type message_loop_type) {
   MessageLoop loop(message_loop_type);
@@ -1292,9 +1326,19 @@ void RunTest_WaitForIO() {
 // cases, a unit test may only be for a particular type of loop.
 
 TEST(MessageLoopTest, PostTask) {
-  RunTest_PostTask(MessageLoop::TYPE_DEFAULT);
-  RunTest_PostTask(MessageLoop::TYPE_UI);
-  RunTest_PostTask(MessageLoop::TYPE_IO);
+  RunTest_PostTask(MessageLoop::TYPE_DEFAULT,
+                   MessageLoop::INCOMING_QUEUE_LOCKED);
+  RunTest_PostTask(MessageLoop::TYPE_UI, MessageLoop::INCOMING_QUEUE_LOCKED);
+  RunTest_PostTask(MessageLoop::TYPE_IO, MessageLoop::INCOMING_QUEUE_LOCKED);
+}
+
+TEST(MessageLoopTest, PostTask_LockFree) {
+  RunTest_PostTask(MessageLoop::TYPE_DEFAULT,
+                   MessageLoop::INCOMING_QUEUE_LOCK_FREE);
+  RunTest_PostTask(MessageLoop::TYPE_UI,
+                   MessageLoop::INCOMING_QUEUE_LOCK_FREE);
+  RunTest_PostTask(MessageLoop::TYPE_IO,
+                   MessageLoop::INCOMING_QUEUE_LOCK_FREE);
 }
 
 TEST(MessageLoopTest, PostTask_SEH) {
@@ -1315,6 +1359,12 @@ TEST(MessageLoopTest, PostDelayedTask_InDelayOrder) {
   RunTest_PostDelayedTask_InDelayOrder(MessageLoop::TYPE_IO);
 }
 
+TEST(MessageLoopTest, PostDelayedTask_WithLeeway) {
+  RunTest_PostDelayedTask_WithLeeway(MessageLoop::TYPE_DEFAULT);
+  RunTest_PostDelayedTask_WithLeeway(MessageLoop::TYPE_UI);
+  RunTest_PostDelayedTask_WithLeeway(MessageLoop::TYPE_IO);
+}
+
 TEST(MessageLoopTest, PostDelayedTask_InPostOrder) {
   RunTest_PostDelayedTask_InPostOrder(MessageLoop::TYPE_DEFAULT);
   RunTest_PostDelayedTask_InPostOrder(MessageLoop::TYPE_UI);
@@ -1689,3 +1739,71 @@ TEST(MessageLoopTest, DestructionObserverTest) {
   EXPECT_TRUE(task_destroyed);
   EXPECT_TRUE(destruction_observer_called);
 }
+
+namespace {
+
+// Runs on the target loop; quits it once |target| tasks have arrived.
+void CountPostedTask(int* count, int target) {
+  if (++(*count) == target)
+    MessageLoop::current()->Quit();
+}
+
+// Floods |loop| with tasks from a separate thread.
+class PostingDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  PostingDelegate(MessageLoop* loop, int* count, int num_posts, int target)
+      : loop_(loop),
+        count_(count),
+        num_posts_(num_posts),
+        target_(target) {
+  }
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < num_posts_; ++i)
+      loop_->PostTask(FROM_HERE, base::Bind(&CountPostedTask, count_, target_));
+  }
+
+ private:
+  MessageLoop* loop_;
+  int* count_;
+  int num_posts_;
+  int target_;
+};
+
+// Posts |num_posts_per_thread| tasks from each of |num_threads| threads and
+// checks that all of them run on the current thread.
+void RunTest_IncomingQueueContention(
+    MessageLoop::IncomingQueueType incoming_queue_type,
+    int num_threads,
+    int num_posts_per_thread) {
+  MessageLoop loop(MessageLoop::TYPE_DEFAULT, incoming_queue_type);
+  const int target = num_threads * num_posts_per_thread;
+  int count = 0;
+
+  ScopedVector<PostingDelegate> delegates;
+  ScopedVector<base::DelegateSimpleThread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    delegates.push_back(
+        new PostingDelegate(&loop, &count, num_posts_per_thread, target));
+    threads.push_back(
+        new base::DelegateSimpleThread(delegates[i], "PostingThread"));
+  }
+
+  for (int i = 0; i < num_threads; ++i)
+    threads[i]->Start();
+  loop.Run();
+
+  for (int i = 0; i < num_threads; ++i)
+    threads[i]->Join();
+  EXPECT_EQ(target, count);
+}
+
+}  // namespace
+
+// Tasks posted from several threads at once all run, with either incoming
+// queue.
+TEST(MessageLoopTest, IncomingQueueContention) {
+  RunTest_IncomingQueueContention(MessageLoop::INCOMING_QUEUE_LOCKED, 4, 1000);
+  RunTest_IncomingQueueContention(MessageLoop::INCOMING_QUEUE_LOCK_FREE, 4,
+                                  1000);
+}
@@ -10,18 +10,73 @@
 #include "base/metrics/histogram.h"
 
 #include <math.h>
+#include <string.h>
 
 #include <algorithm>
 #include <string>
 
 #include "base/debug/leak_annotations.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/pickle.h"
 #include "base/stringprintf.h"
 #include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
 
 namespace base {
 
+namespace {
+
+// Per-thread state used to keep the recording and lookup paths lock-free.
+struct ThreadHistogramState {
+  ThreadHistogramState() : shard_index(0), generation(0) {}
+
+  // The sample shard this thread accumulates into.
+  size_t shard_index;
+
+  // Histograms this thread has already found by name, valid as long as
+  // |generation| matches StatisticsRecorder's.
+  std::map<std::string, Histogram*> histograms;
+  subtle::Atomic32 generation;
+};
+
+void DeleteThreadHistogramState(void* value) {
+  delete static_cast<ThreadHistogramState*>(value);
+}
+
+class ThreadHistogramStateSlot {
+ public:
+  ThreadHistogramStateSlot()
+      : slot_(&DeleteThreadHistogramState),
+        next_shard_(0) {
+  }
+
+  ThreadHistogramState* Get() {
+    ThreadHistogramState* state =
+        static_cast<ThreadHistogramState*>(slot_.Get());
+    if (!state) {
+      state = new ThreadHistogramState;
+      // Hand out shards round-robin, so that the first threads to record
+      // samples never share one.
+      state->shard_index =
+          subtle::NoBarrier_AtomicIncrement(&next_shard_, 1) - 1;
+      slot_.Set(state);
+    }
+    return state;
+  }
+
+ private:
+  ThreadLocalStorage::Slot slot_;
+  subtle::Atomic32 next_shard_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadHistogramStateSlot);
+};
+
+LazyInstance<ThreadHistogramStateSlot>::Leaky g_thread_state =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
 // Static table of checksums for all possible 8 bit bytes.
 const uint32 Histogram::kCrcTable[256] = {0x0, 0x77073096L, 0xee0e612cL,
 0x990951baL, 0x76dc419L, 0x706af48fL, 0xe963a535L, 0x9e6495a3L, 0xedb8832L,
@@ -74,6 +129,9 @@ typedef Histogram::Count Count;
 // static
 const size_t Histogram::kBucketCount_MAX = 16384u;
 
+// static
+const size_t Histogram::kSampleShardCount;
+
 // Collect the number of histograms created.
 static uint32 number_of_histograms_ = 0;
 // Collect the number of vectors saved because of caching ranges.
@@ -398,6 +456,12 @@ size_t Histogram::bucket_count() const {
 void Histogram::SnapshotSample(SampleSet* sample) const {
   // Note locking not done in this version!!!
   *sample = sample_;
+  for (size_t i = 1; i < kSampleShardCount; ++i) {
+    const SampleSet* shard = reinterpret_cast<const SampleSet*>(
+        subtle::Acquire_Load(&shards_[i]));
+    if (shard)
+      sample->Add(*shard);
+  }
 }
 
 bool Histogram::HasConstructorArguments(Sample minimum,
@@ -429,6 +493,7 @@ Histogram::Histogram(const std::string& name, Sample minimum,
     cached_ranges_(new CachedRanges(bucket_count + 1, 0)),
     range_checksum_(0),
     sample_() {
+  memset(shards_, 0, sizeof(shards_));
   Initialize();
 }
 
@@ -442,6 +507,7 @@ Histogram::Histogram(const std::string& name, TimeDelta minimum,
     cached_ranges_(new CachedRanges(bucket_count + 1, 0)),
     range_checksum_(0),
     sample_() {
+  memset(shards_, 0, sizeof(shards_));
   Initialize();
 }
 
@@ -454,6 +520,9 @@ Histogram::~Histogram() {
 
   // Just to make sure most derived class did this properly...
   DCHECK(ValidateBucketRanges());
+
+  for (size_t i = 1; i < kSampleShardCount; ++i)
+    delete reinterpret_cast<SampleSet*>(shards_[i]);
 }
 
 bool Histogram::SerializeRanges(Pickle* pickle) const {
@@ -553,8 +622,9 @@ const std::string Histogram::GetAsciiBucketRange(size_t i) const {
 
 // Update histogram data with new sample.
 void Histogram::Accumulate(Sample value, Count count, size_t index) {
-  // Note locking not done in this version!!!
-  sample_.Accumulate(value, count, index);
+  // Note locking not done in this version!!!  Threads only race with the
+  // others that share their shard.
+  GetCurrentThreadShard()->Accumulate(value, count, index);
 }
 
 void Histogram::SetBucketRange(size_t i, Sample value) {
@@ -597,6 +667,29 @@ void Histogram::Initialize() {
   cached_ranges_->SetBucketRange(bucket_count_, kSampleType_MAX);
 }
 
+Histogram::SampleSet* Histogram::GetCurrentThreadShard() {
+  size_t shard_index = g_thread_state.Get().Get()->shard_index %
+                       kSampleShardCount;
+  if (shard_index == 0)
+    return &sample_;
+
+  SampleSet* shard = reinterpret_cast<SampleSet*>(
+      subtle::Acquire_Load(&shards_[shard_index]));
+  if (shard)
+    return shard;
+
+  // Several threads may race to create the shard; the first one wins.
+  SampleSet* new_shard = new SampleSet;
+  new_shard->Resize(*this);
+  subtle::AtomicWord previous = subtle::Release_CompareAndSwap(
+      &shards_[shard_index], 0,
+      reinterpret_cast<subtle::AtomicWord>(new_shard));
+  if (!previous)
+    return new_shard;
+  delete new_shard;
+  return reinterpret_cast<SampleSet*>(previous);
+}
+
 // We generate the CRC-32 using the low order bits to select whether to XOR in
 // the reversed polynomial 0xedb88320L.  This is nice and simple, and allows us
 // to keep the quotient in a uint32.  Since we're not concerned about the nature
@@ -1059,6 +1152,7 @@ StatisticsRecorder::StatisticsRecorder() {
   base::AutoLock auto_lock(*lock_);
   histograms_ = new HistogramMap;
   ranges_ = new RangesMap;
+  subtle::Barrier_AtomicIncrement(&generation_, 1);
 }
 
 StatisticsRecorder::~StatisticsRecorder() {
@@ -1075,6 +1169,7 @@ StatisticsRecorder::~StatisticsRecorder() {
     base::AutoLock auto_lock(*lock_);
     histograms = histograms_;
     histograms_ = NULL;
+    subtle::Barrier_AtomicIncrement(&generation_, 1);
   }
   RangesMap* ranges = NULL;
   {
@@ -1270,12 +1365,28 @@ bool StatisticsRecorder::FindHistogram(const std::string& name,
                                        Histogram** histogram) {
   if (lock_ == NULL)
     return false;
+
+  // Histograms are never deleted while a recorder is alive, so a histogram
+  // found once stays valid until the generation changes.
+  ThreadHistogramState* state = g_thread_state.Get().Get();
+  subtle::Atomic32 generation = subtle::Acquire_Load(&generation_);
+  if (state->generation != generation) {
+    state->histograms.clear();
+    state->generation = generation;
+  }
+  HistogramMap::iterator cached = state->histograms.find(name);
+  if (state->histograms.end() != cached) {
+    *histogram = cached->second;
+    return true;
+  }
+
   base::AutoLock auto_lock(*lock_);
   if (!histograms_)
     return false;
   HistogramMap::iterator it = histograms_->find(name);
   if (histograms_->end() == it)
     return false;
+  state->histograms[name] = it->second;
   *histogram = it->second;
   return true;
 }
@@ -1329,5 +1440,7 @@ StatisticsRecorder::RangesMap* StatisticsRecorder::ranges_ = NULL;
 // static
 base::Lock* StatisticsRecorder::lock_ = NULL;
 // static
+subtle::Atomic32 StatisticsRecorder::generation_ = 0;
+// static
 bool StatisticsRecorder::dump_on_exit_ = false;
 }  // namespace base
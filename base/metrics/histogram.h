@@ -518,7 +518,8 @@ class BASE_EXPORT Histogram {
   void set_cached_ranges(CachedRanges* cached_ranges) {
     cached_ranges_ = cached_ranges;
   }
-  // Snapshot the current complete set of sample data.
+  // Snapshot the current complete set of sample data, merging the samples
+  // recorded by every thread.
   // Override with atomic/locked snapshot if needed.
   virtual void SnapshotSample(SampleSet* sample) const;
 
@@ -595,9 +596,18 @@ class BASE_EXPORT Histogram {
 
   friend class StatisticsRecorder;  // To allow it to delete duplicates.
 
+  // Samples are accumulated into one of this many shards, chosen by the
+  // recording thread, so that threads adding to the same histogram do not
+  // contend for the same counts.  SnapshotSample() adds the shards together.
+  static const size_t kSampleShardCount = 8;
+
   // Post constructor initialization.
   void Initialize();
 
+  // Return the shard that samples recorded on the current thread go to,
+  // creating it on first use.
+  SampleSet* GetCurrentThreadShard();
+
   // Checksum function for accumulating range values into a checksum.
   static uint32 Crc32(uint32 sum, Sample range);
 
@@ -654,8 +664,12 @@ class BASE_EXPORT Histogram {
   uint32 range_checksum_;
 
   // Finally, provide the state that changes with the addition of each new
-  // sample.
+  // sample.  |sample_| is shard zero, and also receives any AddSampleSet()
+  // data.  The other shards are allocated lazily, so a histogram that is only
+  // used by one thread holds a single SampleSet.
   SampleSet sample_;
+  // The SampleSet* for shards 1 and up; shards_[0] is unused.
+  base::subtle::AtomicWord shards_[kSampleShardCount];
 
   DISALLOW_COPY_AND_ASSIGN(Histogram);
 };
@@ -821,7 +835,8 @@ class BASE_EXPORT StatisticsRecorder {
 
   // Find a histogram by name. It matches the exact name. This method is thread
   // safe.  If a matching histogram is not found, then the |histogram| is
-  // not changed.
+  // not changed.  Each thread caches the histograms it has found, so repeated
+  // lookups of the same name do not take the lock.
   static bool FindHistogram(const std::string& query, Histogram** histogram);
 
   static bool dump_on_exit() { return dump_on_exit_; }
@@ -851,6 +866,10 @@ class BASE_EXPORT StatisticsRecorder {
   // lock protects access to the above map.
   static base::Lock* lock_;
 
+  // Bumped whenever a recorder is created or destroyed, which invalidates the
+  // per-thread FindHistogram() caches.
+  static base::subtle::Atomic32 generation_;
+
   // Dump all known histograms to log.
   static bool dump_on_exit_;
 
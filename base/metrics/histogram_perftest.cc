@@ -0,0 +1,72 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times Histogram::Add() as more threads record into one histogram.
+
+#include "base/bind.h"
+#include "base/compiler_specific.h"
+#include "base/memory/scoped_vector.h"
+#include "base/metrics/histogram.h"
+#include "base/stringprintf.h"
+#include "base/test/perf_benchmark.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const int kSamplesPerThread = 200000;
+
+// Adds |count| samples of |value| to |histogram|.
+class SampleAdder : public DelegateSimpleThread::Delegate {
+ public:
+  SampleAdder(Histogram* histogram, int value, int count)
+      : histogram_(histogram),
+        value_(value),
+        count_(count) {
+  }
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < count_; ++i)
+      histogram_->Add(value_);
+  }
+
+ private:
+  Histogram* histogram_;
+  int value_;
+  int count_;
+};
+
+// Runs a SampleAdder for |histogram| on each of |thread_count| threads and
+// waits for all of them to finish.
+void AddOnThreads(Histogram* histogram, int thread_count) {
+  ScopedVector<SampleAdder> adders;
+  ScopedVector<DelegateSimpleThread> threads;
+  for (int i = 0; i < thread_count; ++i) {
+    adders.push_back(new SampleAdder(histogram, 1 << i, kSamplesPerThread));
+    threads.push_back(new DelegateSimpleThread(adders[i], "HistogramAdder"));
+  }
+  for (int i = 0; i < thread_count; ++i)
+    threads[i]->Start();
+  for (int i = 0; i < thread_count; ++i)
+    threads[i]->Join();
+}
+
+}  // namespace
+
+TEST(HistogramPerfTest, ConcurrentAdd) {
+  for (int thread_count = 1; thread_count <= 8; thread_count *= 2) {
+    Histogram* histogram(Histogram::FactoryGet(
+        StringPrintf("ConcurrentAddHistogram%d", thread_count),
+        1, 1000, 50, Histogram::kNoFlags));
+
+    PerfBenchmark benchmark(
+        StringPrintf("Histogram_ConcurrentAdd_%dthreads", thread_count));
+    benchmark.set_runs(10);
+    benchmark.Run(Bind(&AddOnThreads, histogram, thread_count));
+  }
+}
+
+}  // namespace base
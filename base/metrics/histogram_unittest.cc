@@ -8,7 +8,9 @@
 #include <vector>
 
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/metrics/histogram.h"
+#include "base/threading/simple_thread.h"
 #include "base/time.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -18,6 +20,42 @@ namespace {
 class HistogramTest : public testing::Test {
 };
 
+// Adds |count| samples of |value| to |histogram|.
+class SampleAdder : public DelegateSimpleThread::Delegate {
+ public:
+  SampleAdder(Histogram* histogram, int value, int count)
+      : histogram_(histogram),
+        value_(value),
+        count_(count) {
+  }
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < count_; ++i)
+      histogram_->Add(value_);
+  }
+
+ private:
+  Histogram* histogram_;
+  int value_;
+  int count_;
+};
+
+// Runs a SampleAdder for |histogram| on each of |thread_count| threads and
+// waits for all of them to finish.
+void AddOnThreads(Histogram* histogram, int thread_count,
+                  int samples_per_thread) {
+  ScopedVector<SampleAdder> adders;
+  ScopedVector<DelegateSimpleThread> threads;
+  for (int i = 0; i < thread_count; ++i) {
+    adders.push_back(new SampleAdder(histogram, 1 << i, samples_per_thread));
+    threads.push_back(new DelegateSimpleThread(adders[i], "HistogramAdder"));
+  }
+  for (int i = 0; i < thread_count; ++i)
+    threads[i]->Start();
+  for (int i = 0; i < thread_count; ++i)
+    threads[i]->Join();
+}
+
 // Check for basic syntax and use.
 TEST(HistogramTest, StartupShutdownTest) {
   // Try basic construction
@@ -347,6 +385,55 @@ TEST(HistogramTest, BucketPlacementTest) {
     EXPECT_EQ(i + 1, sample.counts(i));
 }
 
+// Samples recorded on several threads all show up in a snapshot.
+TEST(HistogramTest, MultithreadedAddTest) {
+  const int kThreads = 4;
+  const int kSamplesPerThread = 1000;
+  Histogram* histogram(Histogram::FactoryGet(
+      "MultithreadedHistogram", 1, 64, 8, Histogram::kNoFlags));
+
+  histogram->Add(0);
+  AddOnThreads(histogram, kThreads, kSamplesPerThread);
+
+  Histogram::SampleSet sample;
+  histogram->SnapshotSample(&sample);
+  EXPECT_EQ(0, histogram->FindCorruption(sample));
+  EXPECT_EQ(1, sample.counts(0));
+  // Thread i adds 2^i, which lands in bucket i + 1.
+  int64 sum = 0;
+  for (int i = 0; i < kThreads; i++) {
+    EXPECT_EQ(kSamplesPerThread, sample.counts(i + 1));
+    sum += kSamplesPerThread << i;
+  }
+  EXPECT_EQ(1 + kThreads * kSamplesPerThread, sample.TotalCount());
+  EXPECT_EQ(sample.TotalCount(), sample.redundant_count());
+  EXPECT_EQ(sum, sample.sum());
+}
+
+// Cached lookups must not outlive the recorder they came from.
+TEST(HistogramTest, FindHistogramTest) {
+  Histogram* histogram = NULL;
+  {
+    StatisticsRecorder recorder;
+    Histogram* registered(Histogram::FactoryGet(
+        "FindHistogram", 1, 64, 8, Histogram::kNoFlags));
+    EXPECT_TRUE(StatisticsRecorder::FindHistogram("FindHistogram",
+                                                  &histogram));
+    EXPECT_EQ(registered, histogram);
+    // The second lookup is served from this thread's cache.
+    histogram = NULL;
+    EXPECT_TRUE(StatisticsRecorder::FindHistogram("FindHistogram",
+                                                  &histogram));
+    EXPECT_EQ(registered, histogram);
+  }
+
+  StatisticsRecorder recorder;
+  histogram = NULL;
+  EXPECT_FALSE(StatisticsRecorder::FindHistogram("FindHistogram",
+                                                 &histogram));
+  EXPECT_EQ(reinterpret_cast<Histogram*>(NULL), histogram);
+}
+
 }  // namespace
 
 //------------------------------------------------------------------------------
@@ -357,12 +444,13 @@ TEST(HistogramTest, CorruptSampleCounts) {
   Histogram* histogram(Histogram::FactoryGet(
       "Histogram", 1, 64, 8, Histogram::kNoFlags));  // As per header file.
 
-  EXPECT_EQ(0, histogram->sample_.redundant_count());
+  Histogram::SampleSet snapshot;
+  histogram->SnapshotSample(&snapshot);
+  EXPECT_EQ(0, snapshot.redundant_count());
   histogram->Add(20);  // Add some samples.
   histogram->Add(40);
-  EXPECT_EQ(2, histogram->sample_.redundant_count());
 
-  Histogram::SampleSet snapshot;
+  snapshot = Histogram::SampleSet();
   histogram->SnapshotSample(&snapshot);
   EXPECT_EQ(Histogram::NO_INCONSISTENCIES, 0);
   EXPECT_EQ(0, histogram->FindCorruption(snapshot));  // No default corruption.
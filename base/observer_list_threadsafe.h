@@ -8,9 +8,12 @@
 
 #include <algorithm>
 #include <map>
+#include <string>
 
 #include "base/basictypes.h"
 #include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/callback.h"
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
@@ -44,6 +47,14 @@
 //   whereas with the non-thread-safe observer_list, notifications happen
 //   synchronously and immediately.
 //
+//   Observers that only care about the latest state, and whose notifier can
+//   fire much faster than their thread runs tasks, can be notified with
+//   NotifyCoalesced() instead.  While a coalesced notification of a method
+//   is waiting to run on a thread, further ones of the same method only
+//   replace its arguments, so a burst posts one task per thread.  A plain
+//   Notify() ends the burst, so notifications are still delivered in the
+//   order they were made.
+//
 //   IMPLEMENTATION NOTES
 //   The ObserverListThreadSafe maintains an ObserverList for each thread
 //   which uses the ThreadSafeObserver.  When Notifying the observers,
@@ -100,8 +111,11 @@ class ObserverListThreadSafe
       NotificationType;
 
   ObserverListThreadSafe()
-      : type_(ObserverListBase<ObserverType>::NOTIFY_ALL) {}
-  explicit ObserverListThreadSafe(NotificationType type) : type_(type) {}
+      : type_(ObserverListBase<ObserverType>::NOTIFY_ALL),
+        coalesced_notification_count_(0) {}
+  explicit ObserverListThreadSafe(NotificationType type)
+      : type_(type),
+        coalesced_notification_count_(0) {}
 
   // Add an observer to the list.  An observer should not be added to
   // the same list more than once.
@@ -202,10 +216,65 @@ class ObserverListThreadSafe
 
   // TODO(mbelshe):  Add more wrappers for Notify() with more arguments.
 
+  // Like Notify(), but if a coalesced notification of |m| has not run yet on
+  // an observer's thread, and no plain Notify() was made since, it is run
+  // with these arguments instead and no new task is posted.  Only use this
+  // for methods where the latest call supersedes the earlier ones.
+  template <class Method>
+  void NotifyCoalesced(Method m) {
+    UnboundMethod<ObserverType, Method, Tuple0> method(m, MakeTuple());
+    NotifyCoalesced<Method, Tuple0>(m, method);
+  }
+
+  template <class Method, class A>
+  void NotifyCoalesced(Method m, const A& a) {
+    UnboundMethod<ObserverType, Method, Tuple1<A> > method(m, MakeTuple(a));
+    NotifyCoalesced<Method, Tuple1<A> >(m, method);
+  }
+
+  template <class Method, class A, class B>
+  void NotifyCoalesced(Method m, const A& a, const B& b) {
+    UnboundMethod<ObserverType, Method, Tuple2<A, B> > method(
+        m, MakeTuple(a, b));
+    NotifyCoalesced<Method, Tuple2<A, B> >(m, method);
+  }
+
+  // Returns how many per-thread tasks NotifyCoalesced() did not have to post
+  // because a notification of the same method was still pending.  The tasks
+  // it does post are tracked under their own location by tracked_objects.
+  int coalesced_notification_count() const {
+    base::AutoLock lock(list_lock_);
+    return coalesced_notification_count_;
+  }
+
  private:
   // See comment above ObserverListThreadSafeTraits' definition.
   friend struct ObserverListThreadSafeTraits<ObserverType>;
 
+  // A notification with its arguments bound, run for each observer.
+  typedef base::Callback<void(ObserverType*)> ObserverCallback;
+
+  // A coalesced notification whose task has not run yet.
+  class PendingNotification
+      : public base::RefCountedThreadSafe<PendingNotification> {
+   public:
+    PendingNotification() {}
+
+    // The latest arguments.  Protected by |list_lock_|.
+    ObserverCallback callback;
+
+   private:
+    friend class base::RefCountedThreadSafe<PendingNotification>;
+    ~PendingNotification() {}
+
+    DISALLOW_COPY_AND_ASSIGN(PendingNotification);
+  };
+
+  // The pending coalesced notifications of a thread which may still take
+  // new arguments, keyed by the bytes of the method pointer.
+  typedef std::map<std::string, scoped_refptr<PendingNotification> >
+      PendingNotificationMap;
+
   struct ObserverListContext {
     explicit ObserverListContext(NotificationType type)
         : loop(base::MessageLoopProxy::current()),
@@ -215,6 +284,9 @@ class ObserverListThreadSafe
     scoped_refptr<base::MessageLoopProxy> loop;
     ObserverList<ObserverType> list;
 
+    // Protected by |list_lock_|.
+    PendingNotificationMap pending_notifications;
+
     DISALLOW_COPY_AND_ASSIGN(ObserverListContext);
   };
 
@@ -231,6 +303,9 @@ class ObserverListThreadSafe
     typename ObserversListMap::iterator it;
     for (it = observer_lists_.begin(); it != observer_lists_.end(); ++it) {
       ObserverListContext* context = (*it).second;
+      // Coalesced notifications made after this one must run after it, so
+      // they need a new task.  The pending ones still run.
+      context->pending_notifications.clear();
       context->loop->PostTask(
           FROM_HERE,
           base::Bind(&ObserverListThreadSafe<ObserverType>::
@@ -238,24 +313,44 @@ class ObserverListThreadSafe
     }
   }
 
+  template <class Method, class Params>
+  void NotifyCoalesced(
+      Method m, const UnboundMethod<ObserverType, Method, Params>& method) {
+    const std::string key(reinterpret_cast<const char*>(&m), sizeof(m));
+    ObserverCallback callback = base::Bind(
+        &UnboundMethod<ObserverType, Method, Params>::Run,
+        base::Owned(new UnboundMethod<ObserverType, Method, Params>(method)));
+
+    base::AutoLock lock(list_lock_);
+    typename ObserversListMap::iterator it;
+    for (it = observer_lists_.begin(); it != observer_lists_.end(); ++it) {
+      ObserverListContext* context = (*it).second;
+      scoped_refptr<PendingNotification>& pending =
+          context->pending_notifications[key];
+      if (pending) {
+        pending->callback = callback;
+        ++coalesced_notification_count_;
+        continue;
+      }
+      pending = new PendingNotification;
+      pending->callback = callback;
+      context->loop->PostTask(
+          FROM_HERE,
+          base::Bind(&ObserverListThreadSafe<ObserverType>::
+              NotifyCoalescedWrapper, this, context, key, pending));
+    }
+  }
+
   // Wrapper which is called to fire the notifications for each thread's
   // ObserverList.  This function MUST be called on the thread which owns
   // the unsafe ObserverList.
   template <class Method, class Params>
   void NotifyWrapper(ObserverListContext* context,
       const UnboundMethod<ObserverType, Method, Params>& method) {
-
     // Check that this list still needs notifications.
     {
       base::AutoLock lock(list_lock_);
-      typename ObserversListMap::iterator it =
-          observer_lists_.find(base::PlatformThread::CurrentId());
-
-      // The ObserverList could have been removed already.  In fact, it could
-      // have been removed and then re-added!  If the master list's loop
-      // does not match this one, then we do not need to finish this
-      // notification.
-      if (it == observer_lists_.end() || it->second != context)
+      if (!IsCurrentContext(context))
         return;
     }
 
@@ -266,6 +361,57 @@ class ObserverListThreadSafe
         method.Run(obs);
     }
 
+    MaybeDeleteContext(context);
+  }
+
+  // Same as NotifyWrapper(), for the latest arguments of |notification|,
+  // which was stored under |key|.
+  void NotifyCoalescedWrapper(
+      ObserverListContext* context,
+      const std::string& key,
+      const scoped_refptr<PendingNotification>& notification) {
+    ObserverCallback callback;
+    {
+      base::AutoLock lock(list_lock_);
+      if (!IsCurrentContext(context))
+        return;
+      callback = notification->callback;
+      // Notifications from now on need a new task.  A plain Notify() may
+      // have done this already.
+      typename PendingNotificationMap::iterator it =
+          context->pending_notifications.find(key);
+      if (it != context->pending_notifications.end() &&
+          it->second == notification) {
+        context->pending_notifications.erase(it);
+      }
+    }
+
+    {
+      typename ObserverList<ObserverType>::Iterator it(context->list);
+      ObserverType* obs;
+      while ((obs = it.GetNext()) != NULL)
+        callback.Run(obs);
+    }
+
+    MaybeDeleteContext(context);
+  }
+
+  // Returns whether |context| is still the list of the current thread.
+  // |list_lock_| must be held.
+  bool IsCurrentContext(ObserverListContext* context) const {
+    list_lock_.AssertAcquired();
+    typename ObserversListMap::const_iterator it =
+        observer_lists_.find(base::PlatformThread::CurrentId());
+
+    // The ObserverList could have been removed already.  In fact, it could
+    // have been removed and then re-added!  If the master list's loop
+    // does not match this one, then we do not need to finish this
+    // notification.
+    return it != observer_lists_.end() && it->second == context;
+  }
+
+  // Called on the thread which owns |context| after notifying it.
+  void MaybeDeleteContext(ObserverListContext* context) {
     // If there are no more observers on the list, we can now delete it.
     if (context->list.size() == 0) {
       {
@@ -292,6 +438,9 @@ class ObserverListThreadSafe
   ObserversListMap observer_lists_;
   const NotificationType type_;
 
+  // Protected by |list_lock_|.
+  int coalesced_notification_count_;
+
   DISALLOW_COPY_AND_ASSIGN(ObserverListThreadSafe);
 };
 
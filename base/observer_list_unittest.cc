@@ -37,6 +37,17 @@ class Adder : public Foo {
   int scaler_;
 };
 
+// Records the values it observes, in order.
+class Recorder : public Foo {
+ public:
+  Recorder() {}
+  virtual void Observe(int x) OVERRIDE {
+    values.push_back(x);
+  }
+  virtual ~Recorder() {}
+  std::vector<int> values;
+};
+
 class Disrupter : public Foo {
  public:
   Disrupter(ObserverList<Foo>* list, Foo* doomed)
@@ -431,6 +442,85 @@ TEST(ObserverListThreadSafeTest, OutlivesMessageLoop) {
   observer_list->Notify(&Foo::Observe, 1);
 }
 
+TEST(ObserverListThreadSafeTest, NotifyCoalesced) {
+  MessageLoop loop;
+  scoped_refptr<ObserverListThreadSafe<Foo> > observer_list(
+      new ObserverListThreadSafe<Foo>);
+  Adder a(1), b(-1);
+  observer_list->AddObserver(&a);
+  observer_list->AddObserver(&b);
+
+  // Only the latest arguments are delivered, in one task.
+  observer_list->NotifyCoalesced(&Foo::Observe, 10);
+  observer_list->NotifyCoalesced(&Foo::Observe, 20);
+  observer_list->NotifyCoalesced(&Foo::Observe, 30);
+  loop.RunAllPending();
+  EXPECT_EQ(30, a.total);
+  EXPECT_EQ(-30, b.total);
+  EXPECT_EQ(2, observer_list->coalesced_notification_count());
+
+  // Once it ran, the next notification posts a new task.
+  observer_list->NotifyCoalesced(&Foo::Observe, 5);
+  loop.RunAllPending();
+  EXPECT_EQ(35, a.total);
+  EXPECT_EQ(-35, b.total);
+  EXPECT_EQ(2, observer_list->coalesced_notification_count());
+
+  // Plain notifications are never merged.
+  observer_list->Notify(&Foo::Observe, 1);
+  observer_list->Notify(&Foo::Observe, 1);
+  loop.RunAllPending();
+  EXPECT_EQ(37, a.total);
+  EXPECT_EQ(2, observer_list->coalesced_notification_count());
+}
+
+TEST(ObserverListThreadSafeTest, NotifyCoalescedKeepsOrder) {
+  MessageLoop loop;
+  scoped_refptr<ObserverListThreadSafe<Foo> > observer_list(
+      new ObserverListThreadSafe<Foo>);
+  Recorder a;
+  observer_list->AddObserver(&a);
+
+  // A plain notification made after a coalesced one that has not run yet
+  // starts a new burst, instead of being overtaken by it.
+  observer_list->NotifyCoalesced(&Foo::Observe, 10);
+  observer_list->NotifyCoalesced(&Foo::Observe, 20);
+  observer_list->Notify(&Foo::Observe, 1);
+  observer_list->NotifyCoalesced(&Foo::Observe, 30);
+  observer_list->NotifyCoalesced(&Foo::Observe, 40);
+  EXPECT_EQ(2, observer_list->coalesced_notification_count());
+
+  loop.RunAllPending();
+  ASSERT_EQ(3u, a.values.size());
+  EXPECT_EQ(20, a.values[0]);
+  EXPECT_EQ(1, a.values[1]);
+  EXPECT_EQ(40, a.values[2]);
+
+  // Each burst ran, so the next notification posts a new task.
+  observer_list->NotifyCoalesced(&Foo::Observe, 5);
+  loop.RunAllPending();
+  ASSERT_EQ(4u, a.values.size());
+  EXPECT_EQ(5, a.values[3]);
+  EXPECT_EQ(2, observer_list->coalesced_notification_count());
+}
+
+TEST(ObserverListThreadSafeTest, NotifyCoalescedAfterRemove) {
+  MessageLoop loop;
+  scoped_refptr<ObserverListThreadSafe<Foo> > observer_list(
+      new ObserverListThreadSafe<Foo>);
+  Adder a(1);
+  observer_list->AddObserver(&a);
+
+  observer_list->NotifyCoalesced(&Foo::Observe, 10);
+  observer_list->RemoveObserver(&a);
+  observer_list->AddObserver(&a);
+  observer_list->NotifyCoalesced(&Foo::Observe, 20);
+  loop.RunAllPending();
+
+  // The notification pending for the removed list is dropped.
+  EXPECT_EQ(20, a.total);
+}
+
 TEST(ObserverListTest, Existing) {
   ObserverList<Foo> observer_list(ObserverList<Foo>::NOTIFY_EXISTING_ONLY);
   Adder a(1);
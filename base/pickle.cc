@@ -8,6 +8,8 @@
 
 #include <algorithm>  // for max()
 
+#include "base/pickle_buffer_pool.h"
+
 //------------------------------------------------------------------------------
 
 // static
@@ -150,27 +152,52 @@ Pickle::Pickle()
     : header_(NULL),
       header_size_(sizeof(Header)),
       capacity_(0),
-      variable_buffer_offset_(0) {
-  Resize(kPayloadUnit);
-  header_->payload_size = 0;
+      variable_buffer_offset_(0),
+      storage_type_(HEAP_STORAGE) {
+  Initialize(0);
 }
 
 Pickle::Pickle(int header_size)
     : header_(NULL),
       header_size_(AlignInt(header_size, sizeof(uint32))),
       capacity_(0),
-      variable_buffer_offset_(0) {
+      variable_buffer_offset_(0),
+      storage_type_(HEAP_STORAGE) {
   DCHECK_GE(static_cast<size_t>(header_size), sizeof(Header));
   DCHECK_LE(header_size, kPayloadUnit);
-  Resize(kPayloadUnit);
-  header_->payload_size = 0;
+  Initialize(0);
+}
+
+Pickle::Pickle(int header_size, size_t payload_capacity)
+    : header_(NULL),
+      header_size_(AlignInt(header_size, sizeof(uint32))),
+      capacity_(0),
+      variable_buffer_offset_(0),
+      storage_type_(HEAP_STORAGE) {
+  DCHECK_GE(static_cast<size_t>(header_size), sizeof(Header));
+  DCHECK_LE(header_size, kPayloadUnit);
+  Initialize(payload_capacity);
+}
+
+Pickle::Pickle(int header_size,
+               size_t payload_capacity,
+               StorageType storage_type)
+    : header_(NULL),
+      header_size_(AlignInt(header_size, sizeof(uint32))),
+      capacity_(0),
+      variable_buffer_offset_(0),
+      storage_type_(storage_type) {
+  DCHECK_GE(static_cast<size_t>(header_size), sizeof(Header));
+  DCHECK_LE(header_size, kPayloadUnit);
+  Initialize(payload_capacity);
 }
 
 Pickle::Pickle(const char* data, int data_len)
     : header_(reinterpret_cast<Header*>(const_cast<char*>(data))),
       header_size_(0),
       capacity_(kCapacityReadOnly),
-      variable_buffer_offset_(0) {
+      variable_buffer_offset_(0),
+      storage_type_(HEAP_STORAGE) {
   if (data_len >= static_cast<int>(sizeof(Header)))
     header_size_ = data_len - header_->payload_size;
 
@@ -189,7 +216,8 @@ Pickle::Pickle(const Pickle& other)
     : header_(NULL),
       header_size_(other.header_size_),
       capacity_(0),
-      variable_buffer_offset_(other.variable_buffer_offset_) {
+      variable_buffer_offset_(other.variable_buffer_offset_),
+      storage_type_(other.storage_type_) {
   size_t payload_size = header_size_ + other.header_->payload_size;
   bool resized = Resize(payload_size);
   CHECK(resized);  // Realloc failed.
@@ -198,7 +226,7 @@ Pickle::Pickle(const Pickle& other)
 
 Pickle::~Pickle() {
   if (capacity_ != kCapacityReadOnly)
-    free(header_);
+    FreeStorage();
 }
 
 Pickle& Pickle::operator=(const Pickle& other) {
@@ -211,8 +239,7 @@ Pickle& Pickle::operator=(const Pickle& other) {
     capacity_ = 0;
   }
   if (header_size_ != other.header_size_) {
-    free(header_);
-    header_ = NULL;
+    FreeStorage();
     header_size_ = other.header_size_;
   }
   bool resized = Resize(other.header_size_ + other.header_->payload_size);
@@ -328,15 +355,54 @@ bool Pickle::Resize(size_t new_capacity) {
   new_capacity = AlignInt(new_capacity, kPayloadUnit);
 
   CHECK_NE(capacity_, kCapacityReadOnly);
-  void* p = realloc(header_, new_capacity);
+  if (storage_type_ == HEAP_STORAGE) {
+    void* p = realloc(header_, new_capacity);
+    if (!p)
+      return false;
+
+    header_ = reinterpret_cast<Header*>(p);
+    capacity_ = new_capacity;
+    return true;
+  }
+
+  // Every block already spans its whole size class.
+  if (header_ &&
+      base::PickleBufferPool::GetBlockSize(new_capacity) == capacity_) {
+    return true;
+  }
+
+  size_t block_capacity;
+  void* p = base::PickleBufferPool::Allocate(new_capacity, &block_capacity);
   if (!p)
     return false;
+  if (header_) {
+    // Only the header and the payload written so far need to move.
+    memcpy(p, header_, std::min(header_size_ + header_->payload_size,
+                                new_capacity));
+    base::PickleBufferPool::Release(header_, capacity_);
+  }
 
   header_ = reinterpret_cast<Header*>(p);
-  capacity_ = new_capacity;
+  capacity_ = block_capacity;
   return true;
 }
 
+void Pickle::Initialize(size_t payload_capacity) {
+  bool resized = Resize(std::max(static_cast<size_t>(kPayloadUnit),
+                                 header_size_ + payload_capacity));
+  CHECK(resized);  // Allocation failed.
+  header_->payload_size = 0;
+}
+
+void Pickle::FreeStorage() {
+  if (storage_type_ == POOLED_STORAGE)
+    base::PickleBufferPool::Release(header_, capacity_);
+  else
+    free(header_);
+  header_ = NULL;
+  capacity_ = 0;
+}
+
 // static
 const char* Pickle::FindNext(size_t header_size,
                              const char* start,
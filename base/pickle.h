@@ -110,6 +110,11 @@ class BASE_EXPORT Pickle {
   // will be rounded up to ensure that the header size is 32bit-aligned.
   explicit Pickle(int header_size);
 
+  // Like Pickle(int), but reserves room for |payload_capacity| bytes of
+  // payload up front, so that a writer that knows its final size does not
+  // have to grow the buffer as it goes.
+  Pickle(int header_size, size_t payload_capacity);
+
   // Initializes a Pickle from a const block of data.  The data is not copied;
   // instead the data is merely referenced by this Pickle.  Only const methods
   // should be used on the Pickle when initialized this way.  The header
@@ -264,6 +269,19 @@ class BASE_EXPORT Pickle {
   }
 
  protected:
+  // Where a writable Pickle keeps its buffer.
+  enum StorageType {
+    // Plain realloc()/free().
+    HEAP_STORAGE,
+    // Size-classed blocks recycled through base::PickleBufferPool.  Suited to
+    // many short-lived Pickles, such as IPC messages.
+    POOLED_STORAGE,
+  };
+
+  // Like Pickle(int, size_t), but keeps the buffer in |storage_type| storage.
+  // Copies of this Pickle use the same kind of storage.
+  Pickle(int header_size, size_t payload_capacity, StorageType storage_type);
+
   char* payload() {
     return reinterpret_cast<char*>(header_) + header_size_;
   }
@@ -317,13 +335,21 @@ class BASE_EXPORT Pickle {
  private:
   friend class PickleIterator;
 
+  // Shared by the writable constructors.
+  void Initialize(size_t payload_capacity);
+
+  // Releases the buffer, which must not be read-only.
+  void FreeStorage();
+
   Header* header_;
   size_t header_size_;  // Supports extra data between header and payload.
   // Allocation size of payload (or -1 if allocation is const).
   size_t capacity_;
   size_t variable_buffer_offset_;  // IF non-zero, then offset to a buffer.
+  StorageType storage_type_;
 
   FRIEND_TEST_ALL_PREFIXES(PickleTest, Resize);
+  FRIEND_TEST_ALL_PREFIXES(PickleTest, ReserveCapacity);
   FRIEND_TEST_ALL_PREFIXES(PickleTest, FindNext);
   FRIEND_TEST_ALL_PREFIXES(PickleTest, FindNextWithIncompleteHeader);
 };
@@ -0,0 +1,154 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/pickle_buffer_pool.h"
+
+#include <stdlib.h>
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/threading/thread_local_storage.h"
+
+namespace base {
+
+// static
+const size_t PickleBufferPool::kMinBlockSize;
+// static
+const size_t PickleBufferPool::kMaxBlockSize;
+// static
+const size_t PickleBufferPool::kMaxCachedBytesPerSizeClass;
+
+namespace {
+
+// One size class per power of two from kMinBlockSize to kMaxBlockSize.
+const int kSizeClassCount = 11;
+
+// A cached block; the link lives in the block's first bytes.
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct FreeLists {
+  FreeBlock* heads[kSizeClassCount];
+  size_t counts[kSizeClassCount];
+};
+
+void FreeAllBlocks(FreeLists* lists) {
+  for (int i = 0; i < kSizeClassCount; ++i) {
+    while (lists->heads[i]) {
+      FreeBlock* block = lists->heads[i];
+      lists->heads[i] = block->next;
+      free(block);
+    }
+    lists->counts[i] = 0;
+  }
+}
+
+void DeleteFreeLists(void* value) {
+  FreeLists* lists = static_cast<FreeLists*>(value);
+  FreeAllBlocks(lists);
+  delete lists;
+}
+
+class FreeListSlot {
+ public:
+  FreeListSlot() : slot_(&DeleteFreeLists) {}
+
+  // Returns the calling thread's freelists, creating them if |create|.
+  FreeLists* Get(bool create) {
+    FreeLists* lists = static_cast<FreeLists*>(slot_.Get());
+    if (!lists && create) {
+      lists = new FreeLists();
+      slot_.Set(lists);
+    }
+    return lists;
+  }
+
+ private:
+  ThreadLocalStorage::Slot slot_;
+
+  DISALLOW_COPY_AND_ASSIGN(FreeListSlot);
+};
+
+LazyInstance<FreeListSlot>::Leaky g_free_list_slot =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Returns the size class serving blocks of exactly |capacity| bytes, or -1 if
+// |capacity| is not a size class.
+int GetSizeClass(size_t capacity) {
+  size_t block_size = PickleBufferPool::kMinBlockSize;
+  for (int i = 0; i < kSizeClassCount; ++i, block_size <<= 1) {
+    if (block_size == capacity)
+      return i;
+  }
+  return -1;
+}
+
+}  // namespace
+
+// static
+void* PickleBufferPool::Allocate(size_t size, size_t* capacity) {
+  size_t block_size = GetBlockSize(size);
+  int size_class = GetSizeClass(block_size);
+  if (size_class >= 0) {
+    FreeLists* lists = g_free_list_slot.Get().Get(false);
+    if (lists && lists->heads[size_class]) {
+      FreeBlock* block = lists->heads[size_class];
+      lists->heads[size_class] = block->next;
+      --lists->counts[size_class];
+      *capacity = block_size;
+      return block;
+    }
+  }
+
+  void* block = malloc(block_size);
+  if (block)
+    *capacity = block_size;
+  return block;
+}
+
+// static
+void PickleBufferPool::Release(void* block, size_t capacity) {
+  if (!block)
+    return;
+  int size_class = GetSizeClass(capacity);
+  if (size_class >= 0) {
+    FreeLists* lists = g_free_list_slot.Get().Get(true);
+    if (lists->counts[size_class] < kMaxCachedBytesPerSizeClass / capacity) {
+      FreeBlock* free_block = static_cast<FreeBlock*>(block);
+      free_block->next = lists->heads[size_class];
+      lists->heads[size_class] = free_block;
+      ++lists->counts[size_class];
+      return;
+    }
+  }
+  free(block);
+}
+
+// static
+size_t PickleBufferPool::GetBlockSize(size_t size) {
+  if (size > kMaxBlockSize)
+    return size;
+  size_t block_size = kMinBlockSize;
+  while (block_size < size)
+    block_size <<= 1;
+  return block_size;
+}
+
+// static
+void PickleBufferPool::TrimCurrentThread() {
+  FreeLists* lists = g_free_list_slot.Get().Get(false);
+  if (lists)
+    FreeAllBlocks(lists);
+}
+
+// static
+size_t PickleBufferPool::GetCachedBlockCountForTesting(size_t capacity) {
+  int size_class = GetSizeClass(capacity);
+  DCHECK_GE(size_class, 0);
+  FreeLists* lists = g_free_list_slot.Get().Get(false);
+  return lists ? lists->counts[size_class] : 0;
+}
+
+}  // namespace base
@@ -0,0 +1,58 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PICKLE_BUFFER_POOL_H_
+#define BASE_PICKLE_BUFFER_POOL_H_
+#pragma once
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+
+namespace base {
+
+// Recycles the storage of short-lived Pickles, such as IPC messages, so that
+// building and destroying them does not go to the heap every time.
+//
+// Requests are rounded up to a power-of-two size class between
+// kMinBlockSize and kMaxBlockSize.  Each thread keeps its own freelist per
+// size class, so allocation and release never take a lock.  Blocks are
+// ordinary malloc() blocks: one may be released on a different thread from
+// the one that allocated it, in which case it joins the releasing thread's
+// freelist.  Each freelist holds at most kMaxCachedBytesPerSizeClass bytes;
+// anything beyond that, and any request larger than kMaxBlockSize, goes
+// straight to malloc() and free().
+class BASE_EXPORT PickleBufferPool {
+ public:
+  static const size_t kMinBlockSize = 64;
+  static const size_t kMaxBlockSize = 64 * 1024;
+  static const size_t kMaxCachedBytesPerSizeClass = 64 * 1024;
+
+  // Returns a block of at least |size| bytes, or NULL on failure.  The
+  // usable size of the block is stored in |capacity| and must be passed back
+  // to Release().
+  static void* Allocate(size_t size, size_t* capacity);
+
+  // Returns |block|, which Allocate() reported as |capacity| bytes, to the
+  // current thread's freelist.
+  static void Release(void* block, size_t capacity);
+
+  // Returns the usable size of a block allocated for |size| bytes.
+  static size_t GetBlockSize(size_t size);
+
+  // Frees every block cached by the current thread.
+  static void TrimCurrentThread();
+
+  // Returns the number of blocks of |capacity| bytes cached by the current
+  // thread.
+  static size_t GetCachedBlockCountForTesting(size_t capacity);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(PickleBufferPool);
+};
+
+}  // namespace base
+
+#endif  // BASE_PICKLE_BUFFER_POOL_H_
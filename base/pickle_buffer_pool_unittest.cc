@@ -0,0 +1,103 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/pickle_buffer_pool.h"
+
+#include <vector>
+
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class PickleBufferPoolTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    PickleBufferPool::TrimCurrentThread();
+  }
+
+  virtual void TearDown() OVERRIDE {
+    PickleBufferPool::TrimCurrentThread();
+  }
+};
+
+// Allocates and releases one block on its own thread.
+class AllocatingThread : public SimpleThread {
+ public:
+  AllocatingThread() : SimpleThread("PickleBufferPoolTest") {}
+
+  virtual void Run() OVERRIDE {
+    size_t capacity;
+    void* block = PickleBufferPool::Allocate(100, &capacity);
+    PickleBufferPool::Release(block, capacity);
+    // Released blocks stay with this thread and are freed when it exits.
+    EXPECT_EQ(1u, PickleBufferPool::GetCachedBlockCountForTesting(128));
+  }
+};
+
+}  // namespace
+
+TEST_F(PickleBufferPoolTest, BlockSizes) {
+  EXPECT_EQ(64u, PickleBufferPool::GetBlockSize(0));
+  EXPECT_EQ(64u, PickleBufferPool::GetBlockSize(64));
+  EXPECT_EQ(128u, PickleBufferPool::GetBlockSize(65));
+  EXPECT_EQ(64u * 1024, PickleBufferPool::GetBlockSize(40000));
+  EXPECT_EQ(64u * 1024 + 1, PickleBufferPool::GetBlockSize(64 * 1024 + 1));
+}
+
+TEST_F(PickleBufferPoolTest, ReusesReleasedBlocks) {
+  size_t capacity;
+  void* block = PickleBufferPool::Allocate(200, &capacity);
+  ASSERT_TRUE(block);
+  EXPECT_EQ(256u, capacity);
+  PickleBufferPool::Release(block, capacity);
+  EXPECT_EQ(1u, PickleBufferPool::GetCachedBlockCountForTesting(256));
+
+  // Any request in the same size class gets the cached block back.
+  size_t reused_capacity;
+  EXPECT_EQ(block, PickleBufferPool::Allocate(129, &reused_capacity));
+  EXPECT_EQ(256u, reused_capacity);
+  EXPECT_EQ(0u, PickleBufferPool::GetCachedBlockCountForTesting(256));
+  PickleBufferPool::Release(block, reused_capacity);
+}
+
+TEST_F(PickleBufferPoolTest, CachesBoundedBytes) {
+  const size_t kBlockSize = 16 * 1024;
+  const size_t kLimit =
+      PickleBufferPool::kMaxCachedBytesPerSizeClass / kBlockSize;
+  std::vector<void*> blocks;
+  for (size_t i = 0; i < kLimit + 2; ++i) {
+    size_t capacity;
+    blocks.push_back(PickleBufferPool::Allocate(kBlockSize, &capacity));
+    EXPECT_EQ(kBlockSize, capacity);
+  }
+  for (size_t i = 0; i < blocks.size(); ++i)
+    PickleBufferPool::Release(blocks[i], kBlockSize);
+  EXPECT_EQ(kLimit,
+            PickleBufferPool::GetCachedBlockCountForTesting(kBlockSize));
+
+  PickleBufferPool::TrimCurrentThread();
+  EXPECT_EQ(0u, PickleBufferPool::GetCachedBlockCountForTesting(kBlockSize));
+}
+
+TEST_F(PickleBufferPoolTest, LargeBlocksAreNotCached) {
+  size_t capacity;
+  void* block = PickleBufferPool::Allocate(1024 * 1024, &capacity);
+  ASSERT_TRUE(block);
+  EXPECT_EQ(1024u * 1024, capacity);
+  PickleBufferPool::Release(block, capacity);
+  EXPECT_EQ(0u, PickleBufferPool::GetCachedBlockCountForTesting(
+      PickleBufferPool::kMaxBlockSize));
+}
+
+TEST_F(PickleBufferPoolTest, FreelistsArePerThread) {
+  AllocatingThread thread;
+  thread.Start();
+  thread.Join();
+  EXPECT_EQ(0u, PickleBufferPool::GetCachedBlockCountForTesting(128));
+}
+
+}  // namespace base
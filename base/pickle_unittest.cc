@@ -7,6 +7,7 @@
 #include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/pickle.h"
+#include "base/pickle_buffer_pool.h"
 #include "base/string16.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -239,14 +240,77 @@ TEST(PickleTest, Resize) {
   EXPECT_EQ(cur_payload, pickle.payload_size());
 }
 
+TEST(PickleTest, ReserveCapacity) {
+  const size_t kPayloadCapacity = 1000;
+  Pickle pickle(sizeof(Pickle::Header), kPayloadCapacity);
+  size_t capacity = pickle.capacity();
+  EXPECT_GE(capacity, sizeof(Pickle::Header) + kPayloadCapacity);
+
+  // Filling the reserved payload does not grow the buffer.
+  std::string data(kPayloadCapacity - sizeof(int), 'R');
+  EXPECT_TRUE(pickle.WriteString(data));
+  EXPECT_EQ(kPayloadCapacity, pickle.payload_size());
+  EXPECT_EQ(capacity, pickle.capacity());
+
+  PickleIterator iter(pickle);
+  std::string result;
+  EXPECT_TRUE(pickle.ReadString(&iter, &result));
+  EXPECT_EQ(data, result);
+}
+
 namespace {
 
 struct CustomHeader : Pickle::Header {
   int blah;
 };
 
+class PooledPickle : public Pickle {
+ public:
+  PooledPickle() : Pickle(sizeof(Header), 0, POOLED_STORAGE) {}
+
+  using Pickle::operator=;
+};
+
 }  // namespace
 
+TEST(PickleTest, PooledStorage) {
+  base::PickleBufferPool::TrimCurrentThread();
+  {
+    PooledPickle pickle;
+    // Grow through several size classes.
+    std::string data(10000, 'P');
+    EXPECT_TRUE(pickle.WriteInt(testint));
+    EXPECT_TRUE(pickle.WriteString(data));
+
+    // Copies and assignments between pooled and heap Pickles keep the data.
+    Pickle copy(pickle);
+    Pickle heap;
+    heap.WriteInt(1);
+    PooledPickle assigned;
+    assigned = heap;
+    assigned = copy;
+
+    PickleIterator iter(assigned);
+    int outint;
+    std::string result;
+    EXPECT_TRUE(assigned.ReadInt(&iter, &outint));
+    EXPECT_EQ(testint, outint);
+    EXPECT_TRUE(assigned.ReadString(&iter, &result));
+    EXPECT_EQ(data, result);
+  }
+  // The blocks outgrown while writing went back to this thread's freelists.
+  EXPECT_EQ(1u, base::PickleBufferPool::GetCachedBlockCountForTesting(
+      base::PickleBufferPool::kMinBlockSize));
+
+  // A new pooled Pickle reuses a cached block.
+  {
+    PooledPickle pickle;
+    EXPECT_EQ(0u, base::PickleBufferPool::GetCachedBlockCountForTesting(
+        base::PickleBufferPool::kMinBlockSize));
+  }
+  base::PickleBufferPool::TrimCurrentThread();
+}
+
 TEST(PickleTest, HeaderPadding) {
   const uint32 kMagic = 0x12345678;
 
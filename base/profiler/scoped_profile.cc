@@ -23,8 +23,8 @@ ScopedProfile::~ScopedProfile() {
 void ScopedProfile::StopClockAndTally() {
   if (!birth_)
     return;
-  ThreadData::TallyRunInAScopedRegionIfTracking(birth_, start_of_run_,
-                                                ThreadData::NowForEndOfRun());
+  ThreadData::TallyRunInAScopedRegionIfTracking(
+      birth_, start_of_run_, ThreadData::NowForEndOfRun(start_of_run_));
   birth_ = NULL;
 }
 
@@ -0,0 +1,113 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/test/perf_benchmark.h"
+
+#include <time.h>
+
+#include <algorithm>
+
+#include "base/callback.h"
+#include "base/logging.h"
+#include "base/perftimer.h"
+
+namespace base {
+
+namespace {
+
+const int kDefaultWarmupRuns = 3;
+const int kDefaultRuns = 30;
+
+// Returns the sample at |percentile| of the sorted |samples|, by the nearest
+// rank method.
+TimeDelta Percentile(const std::vector<TimeDelta>& samples, int percentile) {
+  size_t rank = (samples.size() * percentile + 99) / 100;
+  return samples[std::max<size_t>(rank, 1) - 1];
+}
+
+double InMicrosecondsF(TimeDelta delta) {
+  return delta.InMillisecondsF() * Time::kMicrosecondsPerMillisecond;
+}
+
+}  // namespace
+
+PerfBenchmarkResult::PerfBenchmarkResult() : runs(0) {
+}
+
+PerfBenchmark::PerfBenchmark(const std::string& name)
+    : name_(name),
+      warmup_runs_(kDefaultWarmupRuns),
+      runs_(kDefaultRuns),
+      iterations_per_run_(1) {
+}
+
+PerfBenchmark::~PerfBenchmark() {
+}
+
+PerfBenchmarkResult PerfBenchmark::Run(const Closure& task) {
+  DCHECK_GT(runs_, 0);
+  DCHECK_GT(iterations_per_run_, 0);
+
+  for (int i = 0; i < warmup_runs_; ++i)
+    task.Run();
+
+  std::vector<TimeDelta> samples;
+  samples.reserve(runs_);
+  clock_t cpu_start = clock();
+  for (int i = 0; i < runs_; ++i) {
+    TimeTicks start = TimeTicks::HighResNow();
+    for (int j = 0; j < iterations_per_run_; ++j)
+      task.Run();
+    samples.push_back((TimeTicks::HighResNow() - start) / iterations_per_run_);
+  }
+  clock_t cpu_ticks = clock() - cpu_start;
+
+  PerfBenchmarkResult result = ComputeResult(&samples);
+  result.cpu_time = TimeDelta::FromMicroseconds(
+      static_cast<int64>(cpu_ticks) * Time::kMicrosecondsPerSecond /
+      CLOCKS_PER_SEC / (static_cast<int64>(runs_) * iterations_per_run_));
+  LogResult(result);
+  return result;
+}
+
+// static
+PerfBenchmarkResult PerfBenchmark::ComputeResult(
+    std::vector<TimeDelta>* samples) {
+  PerfBenchmarkResult result;
+  if (samples->empty())
+    return result;
+
+  std::sort(samples->begin(), samples->end());
+  TimeDelta total;
+  for (size_t i = 0; i < samples->size(); ++i)
+    total += (*samples)[i];
+
+  result.runs = static_cast<int>(samples->size());
+  result.min = samples->front();
+  result.median = Percentile(*samples, 50);
+  result.percentile_90 = Percentile(*samples, 90);
+  result.max = samples->back();
+  result.mean = total / result.runs;
+  return result;
+}
+
+void PerfBenchmark::LogResult(const PerfBenchmarkResult& result) const {
+  const struct {
+    const char* suffix;
+    TimeDelta value;
+  } kStatistics[] = {
+    { "_min", result.min },
+    { "_median", result.median },
+    { "_90th_percentile", result.percentile_90 },
+    { "_max", result.max },
+    { "_mean", result.mean },
+    { "_cpu", result.cpu_time },
+  };
+  for (size_t i = 0; i < ARRAYSIZE_UNSAFE(kStatistics); ++i) {
+    LogPerfResult((name_ + kStatistics[i].suffix).c_str(),
+                  InMicrosecondsF(kStatistics[i].value), "us");
+  }
+}
+
+}  // namespace base
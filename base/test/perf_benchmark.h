@@ -0,0 +1,80 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TEST_PERF_BENCHMARK_H_
+#define BASE_TEST_PERF_BENCHMARK_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/callback_forward.h"
+#include "base/time.h"
+
+namespace base {
+
+// Timing statistics of a PerfBenchmark, per iteration of the benchmarked
+// code.
+struct PerfBenchmarkResult {
+  PerfBenchmarkResult();
+
+  int runs;
+  TimeDelta min;
+  TimeDelta median;
+  TimeDelta percentile_90;
+  TimeDelta max;
+  TimeDelta mean;
+
+  // CPU time of the whole process, so it exceeds the wall time when the
+  // benchmarked code keeps other threads busy.
+  TimeDelta cpu_time;
+};
+
+// Runs a piece of code many times and reports statistics about how long it
+// took, where PerfTimeLogger reports a single wall clock sample:
+//
+//   PerfBenchmark benchmark("UTF8ToUTF16_ascii");
+//   benchmark.set_iterations_per_run(100);
+//   benchmark.Run(base::Bind(&ConvertText, text));
+//
+// The first few runs are not timed, so that caches and lazily initialized
+// state are warm. Each statistic is written to the perf log as
+// "<name>_<statistic>", in microseconds per iteration, so that the existing
+// perf log parsers pick it up.
+class PerfBenchmark {
+ public:
+  explicit PerfBenchmark(const std::string& name);
+  ~PerfBenchmark();
+
+  void set_warmup_runs(int warmup_runs) { warmup_runs_ = warmup_runs; }
+  void set_runs(int runs) { runs_ = runs; }
+
+  // How many times |task| is called in each timed run. Use it to bring very
+  // short tasks above the resolution of the clock.
+  void set_iterations_per_run(int iterations) {
+    iterations_per_run_ = iterations;
+  }
+
+  // Runs the benchmark, logs its results and returns them.
+  PerfBenchmarkResult Run(const Closure& task);
+
+  // Returns the statistics of |samples|, which are per-iteration times.
+  // Sorts |samples|.
+  static PerfBenchmarkResult ComputeResult(std::vector<TimeDelta>* samples);
+
+ private:
+  void LogResult(const PerfBenchmarkResult& result) const;
+
+  std::string name_;
+  int warmup_runs_;
+  int runs_;
+  int iterations_per_run_;
+
+  DISALLOW_COPY_AND_ASSIGN(PerfBenchmark);
+};
+
+}  // namespace base
+
+#endif  // BASE_TEST_PERF_BENCHMARK_H_
@@ -30,6 +30,11 @@ class SequencedWorkerPoolOwner : public SequencedWorkerPool::TestingObserver {
   SequencedWorkerPoolOwner(size_t max_threads,
                            const std::string& thread_name_prefix);
 
+  // Like above, but with an explicit scheduler type.
+  SequencedWorkerPoolOwner(size_t max_threads,
+                           const std::string& thread_name_prefix,
+                           SequencedWorkerPool::SchedulerType scheduler_type);
+
   virtual ~SequencedWorkerPoolOwner();
 
   // Don't change the returned pool's testing observer.
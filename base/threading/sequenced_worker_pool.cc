@@ -4,6 +4,7 @@
 
 #include "base/threading/sequenced_worker_pool.h"
 
+#include <deque>
 #include <list>
 #include <map>
 #include <set>
@@ -13,8 +14,10 @@
 #include "base/atomicops.h"
 #include "base/callback.h"
 #include "base/compiler_specific.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/memory/linked_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/message_loop_proxy.h"
 #include "base/metrics/histogram.h"
 #include "base/stl_util.h"
@@ -23,6 +26,7 @@
 #include "base/synchronization/lock.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/simple_thread.h"
+#include "base/threading/thread_local.h"
 #include "base/threading/thread_restrictions.h"
 #include "base/time.h"
 #include "base/tracked_objects.h"
@@ -283,8 +287,11 @@ class SequencedWorkerPool::Worker : public SimpleThread {
     return running_sequence_;
   }
 
+  int thread_number() const { return thread_number_; }
+
  private:
   scoped_refptr<SequencedWorkerPool> worker_pool_;
+  const int thread_number_;
   SequenceToken running_sequence_;
 
   DISALLOW_COPY_AND_ASSIGN(Worker);
@@ -456,6 +463,215 @@ class SequencedWorkerPool::Inner {
   DISALLOW_COPY_AND_ASSIGN(Inner);
 };
 
+// WorkStealingInner ----------------------------------------------------------
+//
+// The SCHEDULER_WORK_STEALING backend. There is no lock shared by all posts:
+//
+//  - Every worker slot owns a deque of work items guarded by its own lock.
+//    Posts from outside the pool go to an idle worker if there is one, and are
+//    otherwise spread round-robin. Posts from a worker go to its own deque.
+//    A worker that runs out of work steals from the back of the other deques
+//    before going to sleep.
+//
+//  - Tasks with a sequence token are appended to a per-sequence FIFO held in
+//    one of several sharded maps. A sequence has at most one "turn" work item
+//    in the deques at a time; the worker that takes the turn runs the oldest
+//    task of that sequence and then re-queues the turn on its own deque if
+//    more tasks are waiting. This keeps a sequence ordered and on one worker
+//    while it stays busy, without ever blocking other sequences behind it.
+//
+//  - Shutdown and flush accounting is done with atomic counters. The locks and
+//    condition variables used to wait for them are only taken when a counter
+//    drops to zero while somebody may be waiting.
+class SequencedWorkerPool::WorkStealingInner {
+ public:
+  // Take a raw pointer to |worker| to avoid cycles (since we're owned
+  // by it).
+  WorkStealingInner(SequencedWorkerPool* worker_pool, size_t max_threads,
+                    const std::string& thread_name_prefix,
+                    TestingObserver* observer);
+
+  ~WorkStealingInner();
+
+  SequenceToken GetSequenceToken();
+
+  SequenceToken GetNamedSequenceToken(const std::string& name);
+
+  // See Inner::PostTask.
+  bool PostTask(const std::string* optional_token_name,
+                SequenceToken sequence_token,
+                WorkerShutdown shutdown_behavior,
+                const tracked_objects::Location& from_here,
+                const Closure& task);
+
+  bool RunsTasksOnCurrentThread() const;
+
+  bool IsRunningSequenceOnCurrentThread(SequenceToken sequence_token) const;
+
+  void FlushForTesting();
+
+  void SignalHasWorkForTesting();
+
+  void Shutdown();
+
+  // Runs the worker loop on the background thread.
+  void ThreadLoop(Worker* this_worker);
+
+ private:
+  // Per-worker state. A slot exists for every potential worker; its thread is
+  // started lazily.
+  struct WorkerSlot {
+    WorkerSlot(WorkStealingInner* inner, size_t index);
+    ~WorkerSlot();
+
+    WorkStealingInner* const inner;
+    const size_t index;
+
+    // Protects |work|, |wake_pending| and the wait on |has_work_cv|.
+    Lock lock;
+    ConditionVariable has_work_cv;
+
+    // Unsequenced tasks and sequence turns (a SequencedTask with a non-zero
+    // |sequence_token_id| and a null |task|). The owner pops from the front;
+    // thieves take from the back.
+    std::deque<SequencedTask> work;
+
+    // Set by wakers so a wakeup that arrives just before the worker waits is
+    // not lost.
+    bool wake_pending;
+
+    // Non-zero while the worker has found nothing to do. Read without |lock|
+    // by posters looking for somewhere to put work.
+    volatile subtle::Atomic32 idle;
+
+    // Sequence token of the task running on this slot's thread. Only touched
+    // from that thread.
+    int running_sequence_token_id;
+
+    // Owned. Set once the thread has been started.
+    scoped_ptr<Worker> worker;
+  };
+
+  // Pending tasks of one sequence, oldest first. A sequence is present in its
+  // shard's map for as long as its turn is queued or running.
+  typedef std::map<int, std::deque<SequencedTask> > SequenceMap;
+
+  struct SequenceShard {
+    Lock lock;
+    SequenceMap sequences;
+  };
+
+  static const size_t kNumSequenceShards = 16;
+
+  SequenceShard* ShardFor(int sequence_token_id);
+
+  // Returns the slot of the calling thread if it is one of our workers.
+  WorkerSlot* CurrentSlot() const;
+
+  int LockedGetNamedTokenID(const std::string& name);
+
+  // Appends |task| to its sequence. Returns true if the sequence had no turn
+  // outstanding, in which case the caller must queue one.
+  bool AddSequencedTask(const SequencedTask& task);
+
+  // Removes the oldest task of |sequence_token_id| into |task|.
+  void TakeSequencedTask(int sequence_token_id, SequencedTask* task);
+
+  // Called when a turn of |sequence_token_id| is done. Returns true if more
+  // tasks are waiting, in which case the caller must queue another turn.
+  bool FinishSequenceTurn(int sequence_token_id);
+
+  // Queues |item| on some worker and makes sure a worker will pick it up.
+  // |preferred_slot| is the slot to use if no worker is idle, or -1.
+  void PushWork(const SequencedTask& item, int preferred_slot);
+
+  // Takes work from |slot_index| or, failing that, steals from another slot.
+  bool TakeWork(size_t slot_index, SequencedTask* item);
+
+  // Runs (or, during shutdown, discards) one work item on |slot_index|.
+  void RunWorkItem(size_t slot_index, const SequencedTask& item);
+
+  // Wakes one idle worker other than |except_slot|. Returns false if no worker
+  // was idle.
+  bool WakeIdleWorker(int except_slot);
+  void WakeSlot(WorkerSlot* slot);
+  void WakeAllWorkers();
+
+  // Reserves a slot for a new worker thread if we are below |max_threads_|
+  // and not shutting down. Returns the slot index, or -1.
+  int ReserveThreadSlot();
+
+  // Starts the worker thread for a slot returned by ReserveThreadSlot().
+  void StartWorker(int slot_index);
+
+  // Counter helpers. The Did* functions wake waiters when a counter they are
+  // interested in drops to zero.
+  void DidDequeueTask(const SequencedTask& task);
+  void DidFinishTask(const SequencedTask& task);
+  void MaybeSignalIdleAndShutdown();
+
+  bool shutdown_called() const {
+    return subtle::Acquire_Load(&shutdown_called_) != 0;
+  }
+
+  SequencedWorkerPool* const worker_pool_;
+
+  // See Inner::last_sequence_number_.
+  volatile subtle::Atomic32 last_sequence_number_;
+
+  const size_t max_threads_;
+
+  const std::string thread_name_prefix_;
+
+  ScopedVector<WorkerSlot> slots_;
+
+  SequenceShard sequence_shards_[kNumSequenceShards];
+
+  // Associates all known sequence token names with their IDs.
+  Lock named_sequence_tokens_lock_;
+  std::map<std::string, int> named_sequence_tokens_;
+
+  // Number of slots whose thread has been (or is being) started. Slots are
+  // used in order, so these are slots [0, started_thread_count_).
+  volatile subtle::Atomic32 started_thread_count_;
+
+  // Counter used to spread posts from outside the pool across workers.
+  volatile subtle::Atomic32 next_slot_;
+
+  // Number of workers currently advertising themselves as idle.
+  volatile subtle::Atomic32 idle_thread_count_;
+
+  // Tasks posted but not yet taken by a worker, including tasks waiting
+  // behind a running task of their sequence.
+  volatile subtle::Atomic32 pending_task_count_;
+
+  // Tasks currently running.
+  volatile subtle::Atomic32 running_task_count_;
+
+  // BLOCK_SHUTDOWN tasks pending and running, respectively.
+  volatile subtle::Atomic32 blocking_shutdown_pending_task_count_;
+  volatile subtle::Atomic32 blocking_shutdown_thread_count_;
+
+  volatile subtle::Atomic32 shutdown_called_;
+
+  // Number of threads blocked in FlushForTesting().
+  volatile subtle::Atomic32 flush_waiter_count_;
+
+  // Protects nothing but the waits below; taken only on the slow path.
+  Lock wait_lock_;
+
+  // Waited on by FlushForTesting() until no tasks are pending or running.
+  ConditionVariable is_idle_cv_;
+
+  // Waited on by Shutdown() until no BLOCK_SHUTDOWN task is pending or
+  // running.
+  ConditionVariable can_shutdown_cv_;
+
+  TestingObserver* const testing_observer_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingInner);
+};
+
 // Worker definitions ---------------------------------------------------------
 
 SequencedWorkerPool::Worker::Worker(
@@ -464,7 +680,8 @@ SequencedWorkerPool::Worker::Worker(
     const std::string& prefix)
     : SimpleThread(
           prefix + StringPrintf("Worker%d", thread_number).c_str()),
-      worker_pool_(worker_pool) {
+      worker_pool_(worker_pool),
+      thread_number_(thread_number) {
   Start();
 }
 
@@ -477,7 +694,10 @@ void SequencedWorkerPool::Worker::Run() {
   // using DelegateSimpleThread and have Inner implement the Delegate to avoid
   // having these worker objects at all, but that method lacks the ability to
   // send thread-specific information easily to the thread loop.
-  worker_pool_->inner_->ThreadLoop(this);
+  if (worker_pool_->work_stealing_inner_.get())
+    worker_pool_->work_stealing_inner_->ThreadLoop(this);
+  else
+    worker_pool_->inner_->ThreadLoop(this);
   // Release our cyclic reference once we're done.
   worker_pool_ = NULL;
 }
@@ -930,6 +1150,573 @@ bool SequencedWorkerPool::Inner::CanShutdown() const {
          blocking_shutdown_pending_task_count_ == 0;
 }
 
+// WorkStealingInner definitions ---------------------------------------------
+
+namespace {
+
+// The WorkerSlot of the current thread, if it is a work-stealing worker. This
+// is deliberately not cleared when the worker exits: the worker's last
+// release of the pool may run SequencedWorkerPool::OnDestruct() on that
+// thread, which must still see it as a pool thread.
+LazyInstance<ThreadLocalPointer<void> > g_current_work_stealing_slot =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+SequencedWorkerPool::WorkStealingInner::WorkerSlot::WorkerSlot(
+    WorkStealingInner* inner,
+    size_t index)
+    : inner(inner),
+      index(index),
+      has_work_cv(&lock),
+      wake_pending(false),
+      idle(0),
+      running_sequence_token_id(0) {
+}
+
+SequencedWorkerPool::WorkStealingInner::WorkerSlot::~WorkerSlot() {
+}
+
+SequencedWorkerPool::WorkStealingInner::WorkStealingInner(
+    SequencedWorkerPool* worker_pool,
+    size_t max_threads,
+    const std::string& thread_name_prefix,
+    TestingObserver* observer)
+    : worker_pool_(worker_pool),
+      last_sequence_number_(0),
+      max_threads_(max_threads),
+      thread_name_prefix_(thread_name_prefix),
+      started_thread_count_(0),
+      next_slot_(0),
+      idle_thread_count_(0),
+      pending_task_count_(0),
+      running_task_count_(0),
+      blocking_shutdown_pending_task_count_(0),
+      blocking_shutdown_thread_count_(0),
+      shutdown_called_(0),
+      flush_waiter_count_(0),
+      is_idle_cv_(&wait_lock_),
+      can_shutdown_cv_(&wait_lock_),
+      testing_observer_(observer) {
+  DCHECK_GT(max_threads_, 0u);
+  for (size_t i = 0; i < max_threads_; ++i)
+    slots_.push_back(new WorkerSlot(this, i));
+}
+
+SequencedWorkerPool::WorkStealingInner::~WorkStealingInner() {
+  // You must call Shutdown() before destroying the pool.
+  DCHECK(shutdown_called());
+
+  // Need to explicitly join with the threads before they're destroyed or else
+  // they will be running when our object is half torn down.
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    if (slots_[i]->worker.get())
+      slots_[i]->worker->Join();
+  }
+  slots_.reset();
+
+  if (testing_observer_)
+    testing_observer_->OnDestruct();
+}
+
+SequencedWorkerPool::SequenceToken
+SequencedWorkerPool::WorkStealingInner::GetSequenceToken() {
+  subtle::Atomic32 result =
+      subtle::NoBarrier_AtomicIncrement(&last_sequence_number_, 1);
+  return SequenceToken(static_cast<int>(result));
+}
+
+SequencedWorkerPool::SequenceToken
+SequencedWorkerPool::WorkStealingInner::GetNamedSequenceToken(
+    const std::string& name) {
+  AutoLock lock(named_sequence_tokens_lock_);
+  return SequenceToken(LockedGetNamedTokenID(name));
+}
+
+bool SequencedWorkerPool::WorkStealingInner::PostTask(
+    const std::string* optional_token_name,
+    SequenceToken sequence_token,
+    WorkerShutdown shutdown_behavior,
+    const tracked_objects::Location& from_here,
+    const Closure& task) {
+  SequencedTask sequenced;
+  sequenced.sequence_token_id = sequence_token.id_;
+  sequenced.shutdown_behavior = shutdown_behavior;
+  sequenced.location = from_here;
+  sequenced.task = task;
+
+  if (optional_token_name) {
+    AutoLock lock(named_sequence_tokens_lock_);
+    sequenced.sequence_token_id = LockedGetNamedTokenID(*optional_token_name);
+  }
+
+  // Count the task before checking for shutdown. Paired with the barrier in
+  // Shutdown(), this guarantees that either we see |shutdown_called_| or
+  // Shutdown() sees our task and waits for it.
+  subtle::Barrier_AtomicIncrement(&pending_task_count_, 1);
+  if (shutdown_behavior == BLOCK_SHUTDOWN)
+    subtle::Barrier_AtomicIncrement(&blocking_shutdown_pending_task_count_, 1);
+  if (shutdown_called()) {
+    DidDequeueTask(sequenced);
+    return false;
+  }
+
+  // Work posted from one of our workers stays on that worker if nobody is
+  // idle, which keeps it close to the data the poster just touched.
+  WorkerSlot* current_slot = CurrentSlot();
+  int preferred_slot =
+      current_slot ? static_cast<int>(current_slot->index) : -1;
+
+  if (!sequenced.sequence_token_id) {
+    PushWork(sequenced, preferred_slot);
+  } else if (AddSequencedTask(sequenced)) {
+    SequencedTask turn;
+    turn.sequence_token_id = sequenced.sequence_token_id;
+    PushWork(turn, preferred_slot);
+  } else {
+    // A worker already holds this sequence's turn and will get to the task.
+  }
+
+  if (testing_observer_)
+    testing_observer_->OnHasWork();
+  return true;
+}
+
+bool SequencedWorkerPool::WorkStealingInner::RunsTasksOnCurrentThread() const {
+  return CurrentSlot() != NULL;
+}
+
+bool SequencedWorkerPool::WorkStealingInner::IsRunningSequenceOnCurrentThread(
+    SequenceToken sequence_token) const {
+  WorkerSlot* slot = CurrentSlot();
+  if (!slot)
+    return false;
+  return slot->running_sequence_token_id == sequence_token.id_;
+}
+
+void SequencedWorkerPool::WorkStealingInner::FlushForTesting() {
+  AutoLock lock(wait_lock_);
+  subtle::Barrier_AtomicIncrement(&flush_waiter_count_, 1);
+  while (subtle::Acquire_Load(&pending_task_count_) != 0 ||
+         subtle::Acquire_Load(&running_task_count_) != 0) {
+    is_idle_cv_.Wait();
+  }
+  subtle::Barrier_AtomicIncrement(&flush_waiter_count_, -1);
+}
+
+void SequencedWorkerPool::WorkStealingInner::SignalHasWorkForTesting() {
+  WakeIdleWorker(-1);
+  if (testing_observer_)
+    testing_observer_->OnHasWork();
+}
+
+void SequencedWorkerPool::WorkStealingInner::Shutdown() {
+  {
+    AutoLock lock(wait_lock_);
+    if (shutdown_called())
+      return;
+    subtle::NoBarrier_Store(&shutdown_called_, 1);
+    subtle::MemoryBarrier();
+  }
+
+  // Wake everybody so that idle workers can exit and busy ones start
+  // discarding non-blocking tasks.
+  WakeAllWorkers();
+
+  {
+    AutoLock lock(wait_lock_);
+    // There are no pending or running tasks blocking shutdown, we're done.
+    if (subtle::Acquire_Load(&blocking_shutdown_pending_task_count_) == 0 &&
+        subtle::Acquire_Load(&blocking_shutdown_thread_count_) == 0) {
+      return;
+    }
+  }
+
+  // If we're here, then something is blocking shutdown. So wait for it.
+  if (testing_observer_)
+    testing_observer_->WillWaitForShutdown();
+
+  TimeTicks shutdown_wait_begin = TimeTicks::Now();
+
+  {
+    base::ThreadRestrictions::ScopedAllowWait allow_wait;
+    AutoLock lock(wait_lock_);
+    while (subtle::Acquire_Load(&blocking_shutdown_pending_task_count_) != 0 ||
+           subtle::Acquire_Load(&blocking_shutdown_thread_count_) != 0) {
+      can_shutdown_cv_.Wait();
+    }
+  }
+  UMA_HISTOGRAM_TIMES("SequencedWorkerPool.ShutdownDelayTime",
+                      TimeTicks::Now() - shutdown_wait_begin);
+}
+
+void SequencedWorkerPool::WorkStealingInner::ThreadLoop(Worker* this_worker) {
+  const size_t slot_index = this_worker->thread_number() - 1;
+  DCHECK_LT(slot_index, slots_.size());
+  WorkerSlot* slot = slots_[slot_index];
+  g_current_work_stealing_slot.Pointer()->Set(slot);
+
+  while (true) {
+#if defined(OS_MACOSX)
+    base::mac::ScopedNSAutoreleasePool autorelease_pool;
+#endif
+
+    SequencedTask item;
+    if (TakeWork(slot_index, &item)) {
+      RunWorkItem(slot_index, item);
+      continue;
+    }
+
+    // Advertise ourselves as idle and then look once more. Every poster
+    // pushes first and only then wakes an idle worker other than its target,
+    // so either it sees our flag and wakes us, or we see its work here.
+    subtle::NoBarrier_Store(&slot->idle, 1);
+    subtle::Barrier_AtomicIncrement(&idle_thread_count_, 1);
+    bool found_work = TakeWork(slot_index, &item);
+    if (!found_work) {
+      // When we're terminating and there's no more work, we can shut down.
+      // You can't get more tasks posted once |shutdown_called_| is set.
+      if (shutdown_called() &&
+          subtle::Acquire_Load(&pending_task_count_) == 0) {
+        subtle::NoBarrier_Store(&slot->idle, 0);
+        subtle::Barrier_AtomicIncrement(&idle_thread_count_, -1);
+        break;
+      }
+
+      MaybeSignalIdleAndShutdown();
+
+      AutoLock lock(slot->lock);
+      while (!slot->wake_pending && slot->work.empty())
+        slot->has_work_cv.Wait();
+      slot->wake_pending = false;
+    }
+    subtle::NoBarrier_Store(&slot->idle, 0);
+    subtle::Barrier_AtomicIncrement(&idle_thread_count_, -1);
+
+    if (found_work)
+      RunWorkItem(slot_index, item);
+  }
+
+  // Possibly unblock shutdown and wake the other workers so they can exit
+  // as well.
+  MaybeSignalIdleAndShutdown();
+  WakeAllWorkers();
+}
+
+SequencedWorkerPool::WorkStealingInner::SequenceShard*
+SequencedWorkerPool::WorkStealingInner::ShardFor(int sequence_token_id) {
+  return &sequence_shards_[static_cast<unsigned>(sequence_token_id) %
+                           kNumSequenceShards];
+}
+
+SequencedWorkerPool::WorkStealingInner::WorkerSlot*
+SequencedWorkerPool::WorkStealingInner::CurrentSlot() const {
+  WorkerSlot* slot =
+      static_cast<WorkerSlot*>(g_current_work_stealing_slot.Pointer()->Get());
+  if (!slot || slot->inner != this)
+    return NULL;
+  return slot;
+}
+
+int SequencedWorkerPool::WorkStealingInner::LockedGetNamedTokenID(
+    const std::string& name) {
+  named_sequence_tokens_lock_.AssertAcquired();
+  DCHECK(!name.empty());
+
+  std::map<std::string, int>::const_iterator found =
+      named_sequence_tokens_.find(name);
+  if (found != named_sequence_tokens_.end())
+    return found->second;  // Got an existing one.
+
+  // Create a new one for this name.
+  SequenceToken result = GetSequenceToken();
+  named_sequence_tokens_.insert(std::make_pair(name, result.id_));
+  return result.id_;
+}
+
+bool SequencedWorkerPool::WorkStealingInner::AddSequencedTask(
+    const SequencedTask& task) {
+  SequenceShard* shard = ShardFor(task.sequence_token_id);
+  AutoLock lock(shard->lock);
+  SequenceMap::iterator found = shard->sequences.find(task.sequence_token_id);
+  if (found != shard->sequences.end()) {
+    found->second.push_back(task);
+    return false;
+  }
+  shard->sequences[task.sequence_token_id].push_back(task);
+  return true;
+}
+
+void SequencedWorkerPool::WorkStealingInner::TakeSequencedTask(
+    int sequence_token_id,
+    SequencedTask* task) {
+  SequenceShard* shard = ShardFor(sequence_token_id);
+  AutoLock lock(shard->lock);
+  SequenceMap::iterator found = shard->sequences.find(sequence_token_id);
+  DCHECK(found != shard->sequences.end());
+  DCHECK(!found->second.empty());
+  *task = found->second.front();
+  found->second.pop_front();
+}
+
+bool SequencedWorkerPool::WorkStealingInner::FinishSequenceTurn(
+    int sequence_token_id) {
+  SequenceShard* shard = ShardFor(sequence_token_id);
+  AutoLock lock(shard->lock);
+  SequenceMap::iterator found = shard->sequences.find(sequence_token_id);
+  DCHECK(found != shard->sequences.end());
+  if (!found->second.empty())
+    return true;
+  shard->sequences.erase(found);
+  return false;
+}
+
+void SequencedWorkerPool::WorkStealingInner::PushWork(
+    const SequencedTask& item,
+    int preferred_slot) {
+  // Prefer handing the item straight to an idle worker, then to a new
+  // worker, and only then to a busy one.
+  int started = subtle::Acquire_Load(&started_thread_count_);
+  int target = -1;
+  for (int i = 0; i < started; ++i) {
+    if (subtle::NoBarrier_Load(&slots_[i]->idle)) {
+      target = i;
+      break;
+    }
+  }
+
+  int new_thread_slot = -1;
+  if (target < 0) {
+    new_thread_slot = ReserveThreadSlot();
+    if (new_thread_slot >= 0) {
+      target = new_thread_slot;
+    } else if (preferred_slot >= 0) {
+      target = preferred_slot;
+    } else {
+      // ReserveThreadSlot() failed, so at least one thread has been started.
+      started = subtle::Acquire_Load(&started_thread_count_);
+      DCHECK_GT(started, 0);
+      target = static_cast<int>(
+          static_cast<unsigned>(
+              subtle::NoBarrier_AtomicIncrement(&next_slot_, 1)) % started);
+    }
+  }
+
+  WorkerSlot* slot = slots_[target];
+  {
+    AutoLock lock(slot->lock);
+    slot->work.push_back(item);
+    slot->wake_pending = true;
+  }
+  slot->has_work_cv.Signal();
+
+  if (new_thread_slot >= 0) {
+    StartWorker(new_thread_slot);
+    return;
+  }
+
+  // Even a target that looked idle may have found other work in the meantime
+  // and be running it, possibly a task that waits for this item. So always
+  // wake somebody else who can steal the item; see the comment in
+  // ThreadLoop() for why this cannot miss a worker going idle.
+  subtle::MemoryBarrier();
+  WakeIdleWorker(target);
+}
+
+bool SequencedWorkerPool::WorkStealingInner::TakeWork(size_t slot_index,
+                                                      SequencedTask* item) {
+  {
+    WorkerSlot* slot = slots_[slot_index];
+    AutoLock lock(slot->lock);
+    if (!slot->work.empty()) {
+      *item = slot->work.front();
+      slot->work.pop_front();
+      return true;
+    }
+  }
+
+  const size_t started =
+      static_cast<size_t>(subtle::Acquire_Load(&started_thread_count_));
+  for (size_t i = 1; i < started; ++i) {
+    WorkerSlot* victim = slots_[(slot_index + i) % started];
+    AutoLock lock(victim->lock);
+    if (!victim->work.empty()) {
+      *item = victim->work.back();
+      victim->work.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+void SequencedWorkerPool::WorkStealingInner::RunWorkItem(
+    size_t slot_index,
+    const SequencedTask& item) {
+  WorkerSlot* slot = slots_[slot_index];
+  const int sequence_token_id = item.sequence_token_id;
+
+  while (true) {
+    SequencedTask task;
+    if (sequence_token_id)
+      TakeSequencedTask(sequence_token_id, &task);
+    else
+      task = item;
+
+    if (shutdown_called() && task.shutdown_behavior != BLOCK_SHUTDOWN) {
+      // We're shutting down and this task isn't blocking shutdown, so delete
+      // it (outside of any lock, since its destructor may post). Tasks behind
+      // it in its sequence are safe to look at now, since nothing in the
+      // sequence is running.
+      DidDequeueTask(task);
+      task.task = Closure();
+    } else {
+      // Count the task as running before we stop counting it as pending so
+      // the idle and shutdown checks never see neither.
+      subtle::Barrier_AtomicIncrement(&running_task_count_, 1);
+      if (task.shutdown_behavior == BLOCK_SHUTDOWN)
+        subtle::Barrier_AtomicIncrement(&blocking_shutdown_thread_count_, 1);
+      DidDequeueTask(task);
+
+      // There may be more work than busy workers; get another one going.
+      if (subtle::Acquire_Load(&pending_task_count_) > 0 &&
+          subtle::Acquire_Load(&idle_thread_count_) == 0) {
+        int new_thread_slot = ReserveThreadSlot();
+        if (new_thread_slot >= 0)
+          StartWorker(new_thread_slot);
+      }
+
+      slot->running_sequence_token_id = sequence_token_id;
+      task.task.Run();
+      slot->running_sequence_token_id = 0;
+
+      // Make sure our task is erased outside of any lock.
+      task.task = Closure();
+      DidFinishTask(task);
+    }
+
+    if (!sequence_token_id || !FinishSequenceTurn(sequence_token_id))
+      return;
+
+    // More tasks are waiting in this sequence. Requeue the turn at the back
+    // of our own deque so the sequence keeps its affinity to this worker but
+    // other work gets a chance to run first. Idle workers may still steal it.
+    // During shutdown we finish discarding the sequence right away instead.
+    if (!shutdown_called()) {
+      {
+        AutoLock lock(slot->lock);
+        slot->work.push_back(item);
+      }
+      subtle::MemoryBarrier();
+      WakeIdleWorker(static_cast<int>(slot_index));
+      return;
+    }
+  }
+}
+
+bool SequencedWorkerPool::WorkStealingInner::WakeIdleWorker(int except_slot) {
+  if (subtle::Acquire_Load(&idle_thread_count_) == 0)
+    return false;
+  const int started = subtle::Acquire_Load(&started_thread_count_);
+  for (int i = 0; i < started; ++i) {
+    if (i != except_slot && subtle::NoBarrier_Load(&slots_[i]->idle)) {
+      WakeSlot(slots_[i]);
+      return true;
+    }
+  }
+  return false;
+}
+
+void SequencedWorkerPool::WorkStealingInner::WakeSlot(WorkerSlot* slot) {
+  {
+    AutoLock lock(slot->lock);
+    slot->wake_pending = true;
+  }
+  slot->has_work_cv.Signal();
+}
+
+void SequencedWorkerPool::WorkStealingInner::WakeAllWorkers() {
+  const int started = subtle::Acquire_Load(&started_thread_count_);
+  for (int i = 0; i < started; ++i)
+    WakeSlot(slots_[i]);
+}
+
+int SequencedWorkerPool::WorkStealingInner::ReserveThreadSlot() {
+  subtle::Atomic32 started = subtle::Acquire_Load(&started_thread_count_);
+  // Once shutdown starts, we refuse to create more threads. The exception is
+  // the very first thread: a post that won the race with Shutdown() must
+  // still have somebody to run it.
+  if (started > 0 && shutdown_called())
+    return -1;
+  while (static_cast<size_t>(started) < max_threads_) {
+    subtle::Atomic32 seen = subtle::Acquire_CompareAndSwap(
+        &started_thread_count_, started, started + 1);
+    if (seen == started)
+      return started;
+    started = seen;
+  }
+  return -1;
+}
+
+void SequencedWorkerPool::WorkStealingInner::StartWorker(int slot_index) {
+  // The slot owns the worker; it is joined in our destructor.
+  slots_[slot_index]->worker.reset(
+      new Worker(worker_pool_, slot_index + 1, thread_name_prefix_));
+}
+
+void SequencedWorkerPool::WorkStealingInner::DidDequeueTask(
+    const SequencedTask& task) {
+  bool blocking_done = false;
+  if (task.shutdown_behavior == BLOCK_SHUTDOWN) {
+    blocking_done = subtle::Barrier_AtomicIncrement(
+        &blocking_shutdown_pending_task_count_, -1) == 0;
+  }
+  bool pending_done =
+      subtle::Barrier_AtomicIncrement(&pending_task_count_, -1) == 0;
+
+  if (blocking_done || pending_done)
+    MaybeSignalIdleAndShutdown();
+
+  // Sleeping workers may be waiting for the last pending task so they can
+  // exit.
+  if (pending_done && shutdown_called())
+    WakeAllWorkers();
+}
+
+void SequencedWorkerPool::WorkStealingInner::DidFinishTask(
+    const SequencedTask& task) {
+  bool blocking_done = false;
+  if (task.shutdown_behavior == BLOCK_SHUTDOWN) {
+    DCHECK_GT(subtle::Acquire_Load(&blocking_shutdown_thread_count_), 0);
+    blocking_done = subtle::Barrier_AtomicIncrement(
+        &blocking_shutdown_thread_count_, -1) == 0;
+  }
+  bool running_done =
+      subtle::Barrier_AtomicIncrement(&running_task_count_, -1) == 0;
+  if (blocking_done || running_done)
+    MaybeSignalIdleAndShutdown();
+}
+
+void SequencedWorkerPool::WorkStealingInner::MaybeSignalIdleAndShutdown() {
+  const bool may_unblock_shutdown =
+      shutdown_called() &&
+      subtle::Acquire_Load(&blocking_shutdown_pending_task_count_) == 0 &&
+      subtle::Acquire_Load(&blocking_shutdown_thread_count_) == 0;
+  const bool may_unblock_flush =
+      subtle::Acquire_Load(&flush_waiter_count_) != 0 &&
+      subtle::Acquire_Load(&pending_task_count_) == 0 &&
+      subtle::Acquire_Load(&running_task_count_) == 0;
+  if (!may_unblock_shutdown && !may_unblock_flush)
+    return;
+
+  // Taking the lock orders us after any waiter's check of the counters, so
+  // the waiter is either already waiting or will see the new values.
+  AutoLock lock(wait_lock_);
+  if (may_unblock_shutdown)
+    can_shutdown_cv_.Broadcast();
+  if (may_unblock_flush)
+    is_idle_cv_.Broadcast();
+}
+
 // SequencedWorkerPool --------------------------------------------------------
 
 SequencedWorkerPool::SequencedWorkerPool(
@@ -949,6 +1736,37 @@ SequencedWorkerPool::SequencedWorkerPool(
                        max_threads, thread_name_prefix, observer)) {
 }
 
+SequencedWorkerPool::SequencedWorkerPool(
+    size_t max_threads,
+    const std::string& thread_name_prefix,
+    SchedulerType scheduler_type)
+    : constructor_message_loop_(MessageLoopProxy::current()),
+      inner_(scheduler_type == SCHEDULER_SHARED_QUEUE ?
+             new Inner(ALLOW_THIS_IN_INITIALIZER_LIST(this),
+                       max_threads, thread_name_prefix, NULL) :
+             NULL),
+      work_stealing_inner_(scheduler_type == SCHEDULER_WORK_STEALING ?
+          new WorkStealingInner(ALLOW_THIS_IN_INITIALIZER_LIST(this),
+                                max_threads, thread_name_prefix, NULL) :
+          NULL) {
+}
+
+SequencedWorkerPool::SequencedWorkerPool(
+    size_t max_threads,
+    const std::string& thread_name_prefix,
+    SchedulerType scheduler_type,
+    TestingObserver* observer)
+    : constructor_message_loop_(MessageLoopProxy::current()),
+      inner_(scheduler_type == SCHEDULER_SHARED_QUEUE ?
+             new Inner(ALLOW_THIS_IN_INITIALIZER_LIST(this),
+                       max_threads, thread_name_prefix, observer) :
+             NULL),
+      work_stealing_inner_(scheduler_type == SCHEDULER_WORK_STEALING ?
+          new WorkStealingInner(ALLOW_THIS_IN_INITIALIZER_LIST(this),
+                                max_threads, thread_name_prefix, observer) :
+          NULL) {
+}
+
 SequencedWorkerPool::~SequencedWorkerPool() {}
 
 void SequencedWorkerPool::OnDestruct() const {
@@ -963,11 +1781,15 @@ void SequencedWorkerPool::OnDestruct() const {
 }
 
 SequencedWorkerPool::SequenceToken SequencedWorkerPool::GetSequenceToken() {
+  if (work_stealing_inner_.get())
+    return work_stealing_inner_->GetSequenceToken();
   return inner_->GetSequenceToken();
 }
 
 SequencedWorkerPool::SequenceToken SequencedWorkerPool::GetNamedSequenceToken(
     const std::string& name) {
+  if (work_stealing_inner_.get())
+    return work_stealing_inner_->GetNamedSequenceToken(name);
   return inner_->GetNamedSequenceToken(name);
 }
 
@@ -992,7 +1814,7 @@ SequencedWorkerPool::GetTaskRunnerWithShutdownBehavior(
 bool SequencedWorkerPool::PostWorkerTask(
     const tracked_objects::Location& from_here,
     const Closure& task) {
-  return inner_->PostTask(NULL, SequenceToken(), BLOCK_SHUTDOWN,
+  return PostTaskInternal(NULL, SequenceToken(), BLOCK_SHUTDOWN,
                           from_here, task);
 }
 
@@ -1000,7 +1822,7 @@ bool SequencedWorkerPool::PostWorkerTaskWithShutdownBehavior(
     const tracked_objects::Location& from_here,
     const Closure& task,
     WorkerShutdown shutdown_behavior) {
-  return inner_->PostTask(NULL, SequenceToken(), shutdown_behavior,
+  return PostTaskInternal(NULL, SequenceToken(), shutdown_behavior,
                           from_here, task);
 }
 
@@ -1008,7 +1830,7 @@ bool SequencedWorkerPool::PostSequencedWorkerTask(
     SequenceToken sequence_token,
     const tracked_objects::Location& from_here,
     const Closure& task) {
-  return inner_->PostTask(NULL, sequence_token, BLOCK_SHUTDOWN,
+  return PostTaskInternal(NULL, sequence_token, BLOCK_SHUTDOWN,
                           from_here, task);
 }
 
@@ -1017,7 +1839,7 @@ bool SequencedWorkerPool::PostNamedSequencedWorkerTask(
     const tracked_objects::Location& from_here,
     const Closure& task) {
   DCHECK(!token_name.empty());
-  return inner_->PostTask(&token_name, SequenceToken(), BLOCK_SHUTDOWN,
+  return PostTaskInternal(&token_name, SequenceToken(), BLOCK_SHUTDOWN,
                           from_here, task);
 }
 
@@ -1026,7 +1848,7 @@ bool SequencedWorkerPool::PostSequencedWorkerTaskWithShutdownBehavior(
     const tracked_objects::Location& from_here,
     const Closure& task,
     WorkerShutdown shutdown_behavior) {
-  return inner_->PostTask(NULL, sequence_token, shutdown_behavior,
+  return PostTaskInternal(NULL, sequence_token, shutdown_behavior,
                           from_here, task);
 }
 
@@ -1049,25 +1871,54 @@ bool SequencedWorkerPool::PostDelayedTask(
 }
 
 bool SequencedWorkerPool::RunsTasksOnCurrentThread() const {
+  if (work_stealing_inner_.get())
+    return work_stealing_inner_->RunsTasksOnCurrentThread();
   return inner_->RunsTasksOnCurrentThread();
 }
 
 bool SequencedWorkerPool::IsRunningSequenceOnCurrentThread(
     SequenceToken sequence_token) const {
+  if (work_stealing_inner_.get()) {
+    return work_stealing_inner_->IsRunningSequenceOnCurrentThread(
+        sequence_token);
+  }
   return inner_->IsRunningSequenceOnCurrentThread(sequence_token);
 }
 
 void SequencedWorkerPool::FlushForTesting() {
-  inner_->FlushForTesting();
+  if (work_stealing_inner_.get())
+    work_stealing_inner_->FlushForTesting();
+  else
+    inner_->FlushForTesting();
 }
 
 void SequencedWorkerPool::SignalHasWorkForTesting() {
-  inner_->SignalHasWorkForTesting();
+  if (work_stealing_inner_.get())
+    work_stealing_inner_->SignalHasWorkForTesting();
+  else
+    inner_->SignalHasWorkForTesting();
 }
 
 void SequencedWorkerPool::Shutdown() {
   DCHECK(constructor_message_loop_->BelongsToCurrentThread());
-  inner_->Shutdown();
+  if (work_stealing_inner_.get())
+    work_stealing_inner_->Shutdown();
+  else
+    inner_->Shutdown();
+}
+
+bool SequencedWorkerPool::PostTaskInternal(
+    const std::string* optional_token_name,
+    SequenceToken sequence_token,
+    WorkerShutdown shutdown_behavior,
+    const tracked_objects::Location& from_here,
+    const Closure& task) {
+  if (work_stealing_inner_.get()) {
+    return work_stealing_inner_->PostTask(optional_token_name, sequence_token,
+                                          shutdown_behavior, from_here, task);
+  }
+  return inner_->PostTask(optional_token_name, sequence_token,
+                          shutdown_behavior, from_here, task);
 }
 
 }  // namespace base
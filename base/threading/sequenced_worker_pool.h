@@ -101,6 +101,22 @@ class BASE_EXPORT SequencedWorkerPool : public TaskRunner {
     BLOCK_SHUTDOWN,
   };
 
+  // Selects how tasks are handed to worker threads.
+  enum SchedulerType {
+    // All tasks go through one queue protected by a single lock. This is
+    // simple and fair, and is the default.
+    SCHEDULER_SHARED_QUEUE,
+
+    // Each worker has its own deque of work, and idle workers steal from busy
+    // ones. Tasks with a sequence token queue up behind their sequence and tend
+    // to stay on the worker that last ran the sequence. Posting takes only a
+    // per-worker lock (and a per-sequence shard lock for sequenced tasks), so
+    // this scales better with many worker threads and many posting threads.
+    // Task ordering, SequenceToken and WorkerShutdown semantics are the same
+    // as with SCHEDULER_SHARED_QUEUE.
+    SCHEDULER_WORK_STEALING,
+  };
+
   // Opaque identifier that defines sequencing of tasks posted to the worker
   // pool.
   class SequenceToken {
@@ -144,6 +160,18 @@ class BASE_EXPORT SequencedWorkerPool : public TaskRunner {
                       const std::string& thread_name_prefix,
                       TestingObserver* observer);
 
+  // Like the first constructor, but with an explicit |scheduler_type|.
+  SequencedWorkerPool(size_t max_threads,
+                      const std::string& thread_name_prefix,
+                      SchedulerType scheduler_type);
+
+  // Like above, but with |observer| for testing.  Does not take
+  // ownership of |observer|.
+  SequencedWorkerPool(size_t max_threads,
+                      const std::string& thread_name_prefix,
+                      SchedulerType scheduler_type,
+                      TestingObserver* observer);
+
   // Returns a unique token that can be used to sequence tasks posted to
   // PostSequencedWorkerTask(). Valid tokens are alwys nonzero.
   SequenceToken GetSequenceToken();
@@ -271,13 +299,23 @@ class BASE_EXPORT SequencedWorkerPool : public TaskRunner {
   friend class DeleteHelper<SequencedWorkerPool>;
 
   class Inner;
+  class WorkStealingInner;
   class Worker;
 
+  // Forwards to whichever of |inner_| and |work_stealing_inner_| is in use.
+  bool PostTaskInternal(const std::string* optional_token_name,
+                        SequenceToken sequence_token,
+                        WorkerShutdown shutdown_behavior,
+                        const tracked_objects::Location& from_here,
+                        const Closure& task);
+
   const scoped_refptr<MessageLoopProxy> constructor_message_loop_;
 
   // Avoid pulling in too many headers by putting (almost) everything
-  // into |inner_|.
+  // into |inner_|. Exactly one of these is non-NULL, depending on the
+  // SchedulerType.
   const scoped_ptr<Inner> inner_;
+  const scoped_ptr<WorkStealingInner> work_stealing_inner_;
 
   DISALLOW_COPY_AND_ASSIGN(SequencedWorkerPool);
 };
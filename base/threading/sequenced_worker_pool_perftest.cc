@@ -0,0 +1,119 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares the throughput of the SequencedWorkerPool schedulers for trivial
+// tasks posted from several threads at once.
+
+#include <string>
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/compiler_specific.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_vector.h"
+#include "base/message_loop.h"
+#include "base/stringprintf.h"
+#include "base/test/perf_benchmark.h"
+#include "base/test/sequenced_worker_pool_owner.h"
+#include "base/threading/sequenced_worker_pool.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const size_t kNumWorkerThreads = 16;
+const int kNumPosters = 8;
+const int kTasksPerPoster = 5000;
+
+void IncrementCounter(subtle::Atomic32* counter) {
+  subtle::NoBarrier_AtomicIncrement(counter, 1);
+}
+
+// Posts |num_tasks| trivial tasks to |pool|, spreading them across
+// |num_sequences| sequence tokens (or none if |num_sequences| is 0).
+class PoolFlooder : public DelegateSimpleThread::Delegate {
+ public:
+  PoolFlooder(SequencedWorkerPool* pool,
+              subtle::Atomic32* counter,
+              int num_tasks,
+              int num_sequences)
+      : pool_(pool),
+        counter_(counter),
+        num_tasks_(num_tasks) {
+    for (int i = 0; i < num_sequences; ++i)
+      tokens_.push_back(pool->GetSequenceToken());
+  }
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < num_tasks_; ++i) {
+      Closure task = Bind(&IncrementCounter, counter_);
+      if (tokens_.empty()) {
+        pool_->PostWorkerTask(FROM_HERE, task);
+      } else {
+        pool_->PostSequencedWorkerTask(tokens_[i % tokens_.size()],
+                                       FROM_HERE, task);
+      }
+    }
+  }
+
+ private:
+  SequencedWorkerPool* pool_;
+  subtle::Atomic32* counter_;
+  const int num_tasks_;
+  std::vector<SequencedWorkerPool::SequenceToken> tokens_;
+};
+
+// Posts from kNumPosters threads at once and waits for every task to run.
+void FloodPool(const scoped_refptr<SequencedWorkerPool>& pool,
+               int num_sequences) {
+  subtle::Atomic32 counter = 0;
+  ScopedVector<PoolFlooder> flooders;
+  ScopedVector<DelegateSimpleThread> posters;
+  for (int i = 0; i < kNumPosters; ++i) {
+    flooders.push_back(new PoolFlooder(pool.get(), &counter, kTasksPerPoster,
+                                       num_sequences));
+    posters.push_back(new DelegateSimpleThread(flooders[i], "poster"));
+  }
+
+  for (int i = 0; i < kNumPosters; ++i)
+    posters[i]->Start();
+  for (int i = 0; i < kNumPosters; ++i)
+    posters[i]->Join();
+  pool->FlushForTesting();
+
+  CHECK_EQ(kNumPosters * kTasksPerPoster, subtle::NoBarrier_Load(&counter));
+}
+
+void RunThroughputBenchmarks(const std::string& name,
+                             SequencedWorkerPool::SchedulerType type) {
+  MessageLoop message_loop;
+  SequencedWorkerPoolOwner pool_owner(kNumWorkerThreads, "throughput", type);
+
+  const int kNumSequences[] = { 0, 4, 64 };
+  for (size_t i = 0; i < arraysize(kNumSequences); ++i) {
+    PerfBenchmark benchmark(StringPrintf("SequencedWorkerPool_%s_%dsequences",
+                                         name.c_str(), kNumSequences[i]));
+    benchmark.set_runs(10);
+    benchmark.Run(Bind(&FloodPool, pool_owner.pool(), kNumSequences[i]));
+  }
+
+  pool_owner.pool()->Shutdown();
+}
+
+}  // namespace
+
+TEST(SequencedWorkerPoolPerfTest, SharedQueue) {
+  RunThroughputBenchmarks("SharedQueue",
+                          SequencedWorkerPool::SCHEDULER_SHARED_QUEUE);
+}
+
+TEST(SequencedWorkerPoolPerfTest, WorkStealing) {
+  RunThroughputBenchmarks("WorkStealing",
+                          SequencedWorkerPool::SCHEDULER_WORK_STEALING);
+}
+
+}  // namespace base
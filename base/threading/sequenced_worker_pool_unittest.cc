@@ -6,10 +6,12 @@
 
 #include <algorithm>
 
+#include "base/atomicops.h"
 #include "base/bind.h"
 #include "base/compiler_specific.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/message_loop.h"
 #include "base/message_loop_proxy.h"
 #include "base/synchronization/condition_variable.h"
@@ -18,6 +20,7 @@
 #include "base/test/sequenced_task_runner_test_template.h"
 #include "base/test/task_runner_test_template.h"
 #include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
 #include "base/tracked_objects.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -151,10 +154,12 @@ class TestTracker : public base::RefCountedThreadSafe<TestTracker> {
   size_t started_events_;
 };
 
-class SequencedWorkerPoolTest : public testing::Test {
+// Runs every test against each SchedulerType.
+class SequencedWorkerPoolTest
+    : public testing::TestWithParam<SequencedWorkerPool::SchedulerType> {
  public:
   SequencedWorkerPoolTest()
-      : pool_owner_(kNumWorkerThreads, "test"),
+      : pool_owner_(kNumWorkerThreads, "test", GetParam()),
         tracker_(new TestTracker) {
   }
 
@@ -234,7 +239,7 @@ void EnsureTasksToCompleteCountAndUnblock(scoped_refptr<TestTracker> tracker,
 }
 
 // Tests that same-named tokens have the same ID.
-TEST_F(SequencedWorkerPoolTest, NamedTokens) {
+TEST_P(SequencedWorkerPoolTest, NamedTokens) {
   const std::string name1("hello");
   SequencedWorkerPool::SequenceToken token1 =
       pool()->GetNamedSequenceToken(name1);
@@ -262,7 +267,7 @@ TEST_F(SequencedWorkerPoolTest, NamedTokens) {
 
 // Tests that posting a bunch of tasks (many more than the number of worker
 // threads) runs them all.
-TEST_F(SequencedWorkerPoolTest, LotsOfTasks) {
+TEST_P(SequencedWorkerPoolTest, LotsOfTasks) {
   pool()->PostWorkerTask(FROM_HERE,
                          base::Bind(&TestTracker::SlowTask, tracker(), 0));
 
@@ -280,9 +285,9 @@ TEST_F(SequencedWorkerPoolTest, LotsOfTasks) {
 // worker threads) to two pools simultaneously runs them all twice.
 // This test is meant to shake out any concurrency issues between
 // pools (like histograms).
-TEST_F(SequencedWorkerPoolTest, LotsOfTasksTwoPools) {
-  SequencedWorkerPoolOwner pool1(kNumWorkerThreads, "test1");
-  SequencedWorkerPoolOwner pool2(kNumWorkerThreads, "test2");
+TEST_P(SequencedWorkerPoolTest, LotsOfTasksTwoPools) {
+  SequencedWorkerPoolOwner pool1(kNumWorkerThreads, "test1", GetParam());
+  SequencedWorkerPoolOwner pool2(kNumWorkerThreads, "test2", GetParam());
 
   base::Closure slow_task = base::Bind(&TestTracker::SlowTask, tracker(), 0);
   pool1.pool()->PostWorkerTask(FROM_HERE, slow_task);
@@ -306,7 +311,7 @@ TEST_F(SequencedWorkerPoolTest, LotsOfTasksTwoPools) {
 
 // Test that tasks with the same sequence token are executed in order but don't
 // affect other tasks.
-TEST_F(SequencedWorkerPoolTest, Sequence) {
+TEST_P(SequencedWorkerPoolTest, Sequence) {
   // Fill all the worker threads except one.
   const size_t kNumBackgroundTasks = kNumWorkerThreads - 1;
   ThreadBlocker background_blocker;
@@ -367,7 +372,7 @@ TEST_F(SequencedWorkerPoolTest, Sequence) {
 
 // Tests that unrun tasks are discarded properly according to their shutdown
 // mode.
-TEST_F(SequencedWorkerPoolTest, DiscardOnShutdown) {
+TEST_P(SequencedWorkerPoolTest, DiscardOnShutdown) {
   // Start tasks to take all the threads and block them.
   EnsureAllWorkersCreated();
   ThreadBlocker blocker;
@@ -412,7 +417,7 @@ TEST_F(SequencedWorkerPoolTest, DiscardOnShutdown) {
 }
 
 // Tests that CONTINUE_ON_SHUTDOWN tasks don't block shutdown.
-TEST_F(SequencedWorkerPoolTest, ContinueOnShutdown) {
+TEST_P(SequencedWorkerPoolTest, ContinueOnShutdown) {
   scoped_refptr<TaskRunner> runner(pool()->GetTaskRunnerWithShutdownBehavior(
       SequencedWorkerPool::CONTINUE_ON_SHUTDOWN));
   scoped_refptr<SequencedTaskRunner> sequenced_runner(
@@ -461,7 +466,7 @@ TEST_F(SequencedWorkerPoolTest, ContinueOnShutdown) {
 // Ensure all worker threads are created, and then trigger a spurious
 // work signal. This shouldn't cause any other work signals to be
 // triggered. This is a regression test for http://crbug.com/117469.
-TEST_F(SequencedWorkerPoolTest, SpuriousWorkSignal) {
+TEST_P(SequencedWorkerPoolTest, SpuriousWorkSignal) {
   EnsureAllWorkersCreated();
   int old_has_work_call_count = has_work_call_count();
   pool()->SignalHasWorkForTesting();
@@ -470,6 +475,37 @@ TEST_F(SequencedWorkerPoolTest, SpuriousWorkSignal) {
   EXPECT_EQ(old_has_work_call_count + 1, has_work_call_count());
 }
 
+void UnblockTask(ThreadBlocker* blocker) {
+  blocker->Unblock(1);
+}
+
+// Posts a task that unblocks |blocker| and waits for it to run.
+void PostAndBlockTask(const scoped_refptr<SequencedWorkerPool>& pool,
+                      const scoped_refptr<TestTracker>& tracker,
+                      int id,
+                      ThreadBlocker* blocker) {
+  pool->PostWorkerTask(FROM_HERE, base::Bind(&UnblockTask, blocker));
+  blocker->Block();
+  tracker->FastTask(id);
+}
+
+// A running task that waits for a task it posted while other workers sit idle
+// must not hang, even when the new task lands on a worker that was idle a
+// moment ago but picked up other work, or on the waiting worker itself.
+TEST_P(SequencedWorkerPoolTest, PostedTaskRunsWhileWorkerBlocks) {
+  EnsureAllWorkersCreated();
+  const size_t kIterations = 100;
+  ThreadBlocker blocker;
+  for (size_t i = 0; i < kIterations; ++i) {
+    pool()->PostWorkerTask(FROM_HERE,
+                           base::Bind(&PostAndBlockTask, pool(),
+                                      make_scoped_refptr(tracker()),
+                                      static_cast<int>(i), &blocker));
+    // Wait for each one so that the other workers are idle again.
+    EXPECT_EQ(i + 1, tracker()->WaitUntilTasksComplete(i + 1).size());
+  }
+}
+
 void IsRunningOnCurrentThreadTask(
     SequencedWorkerPool::SequenceToken test_positive_token,
     SequencedWorkerPool::SequenceToken test_negative_token,
@@ -486,13 +522,13 @@ void IsRunningOnCurrentThreadTask(
 }
 
 // Verify correctness of the IsRunningSequenceOnCurrentThread method.
-TEST_F(SequencedWorkerPoolTest, IsRunningOnCurrentThread) {
+TEST_P(SequencedWorkerPoolTest, IsRunningOnCurrentThread) {
   SequencedWorkerPool::SequenceToken token1 = pool()->GetSequenceToken();
   SequencedWorkerPool::SequenceToken token2 = pool()->GetSequenceToken();
   SequencedWorkerPool::SequenceToken unsequenced_token;
 
   scoped_refptr<SequencedWorkerPool> unused_pool =
-      new SequencedWorkerPool(2, "unused_pool");
+      new SequencedWorkerPool(2, "unused_pool", GetParam());
   EXPECT_TRUE(token1.Equals(unused_pool->GetSequenceToken()));
   EXPECT_TRUE(token2.Equals(unused_pool->GetSequenceToken()));
 
@@ -522,6 +558,14 @@ TEST_F(SequencedWorkerPoolTest, IsRunningOnCurrentThread) {
   unused_pool->Shutdown();
 }
 
+INSTANTIATE_TEST_CASE_P(
+    SharedQueue, SequencedWorkerPoolTest,
+    testing::Values(SequencedWorkerPool::SCHEDULER_SHARED_QUEUE));
+INSTANTIATE_TEST_CASE_P(
+    WorkStealing, SequencedWorkerPoolTest,
+    testing::Values(SequencedWorkerPool::SCHEDULER_WORK_STEALING));
+
+template <SequencedWorkerPool::SchedulerType kSchedulerType>
 class SequencedWorkerPoolTaskRunnerTestDelegate {
  public:
   SequencedWorkerPoolTaskRunnerTestDelegate() {}
@@ -530,7 +574,8 @@ class SequencedWorkerPoolTaskRunnerTestDelegate {
 
   void StartTaskRunner() {
     pool_owner_.reset(
-        new SequencedWorkerPoolOwner(10, "SequencedWorkerPoolTaskRunnerTest"));
+        new SequencedWorkerPoolOwner(10, "SequencedWorkerPoolTaskRunnerTest",
+                                     kSchedulerType));
   }
 
   scoped_refptr<SequencedWorkerPool> GetTaskRunner() {
@@ -556,7 +601,13 @@ class SequencedWorkerPoolTaskRunnerTestDelegate {
 
 INSTANTIATE_TYPED_TEST_CASE_P(
     SequencedWorkerPool, TaskRunnerTest,
-    SequencedWorkerPoolTaskRunnerTestDelegate);
+    SequencedWorkerPoolTaskRunnerTestDelegate<
+        SequencedWorkerPool::SCHEDULER_SHARED_QUEUE>);
+
+INSTANTIATE_TYPED_TEST_CASE_P(
+    WorkStealingSequencedWorkerPool, TaskRunnerTest,
+    SequencedWorkerPoolTaskRunnerTestDelegate<
+        SequencedWorkerPool::SCHEDULER_WORK_STEALING>);
 
 class SequencedWorkerPoolTaskRunnerWithShutdownBehaviorTestDelegate {
  public:
@@ -599,6 +650,7 @@ INSTANTIATE_TYPED_TEST_CASE_P(
     SequencedWorkerPoolTaskRunner, TaskRunnerTest,
     SequencedWorkerPoolTaskRunnerWithShutdownBehaviorTestDelegate);
 
+template <SequencedWorkerPool::SchedulerType kSchedulerType>
 class SequencedWorkerPoolSequencedTaskRunnerTestDelegate {
  public:
   SequencedWorkerPoolSequencedTaskRunnerTestDelegate() {}
@@ -608,7 +660,7 @@ class SequencedWorkerPoolSequencedTaskRunnerTestDelegate {
 
   void StartTaskRunner() {
     pool_owner_.reset(new SequencedWorkerPoolOwner(
-        10, "SequencedWorkerPoolSequencedTaskRunnerTest"));
+        10, "SequencedWorkerPoolSequencedTaskRunnerTest", kSchedulerType));
     task_runner_ = pool_owner_->pool()->GetSequencedTaskRunner(
         pool_owner_->pool()->GetSequenceToken());
   }
@@ -638,11 +690,96 @@ class SequencedWorkerPoolSequencedTaskRunnerTestDelegate {
 
 INSTANTIATE_TYPED_TEST_CASE_P(
     SequencedWorkerPoolSequencedTaskRunner, TaskRunnerTest,
-    SequencedWorkerPoolSequencedTaskRunnerTestDelegate);
+    SequencedWorkerPoolSequencedTaskRunnerTestDelegate<
+        SequencedWorkerPool::SCHEDULER_SHARED_QUEUE>);
 
 INSTANTIATE_TYPED_TEST_CASE_P(
     SequencedWorkerPoolSequencedTaskRunner, SequencedTaskRunnerTest,
-    SequencedWorkerPoolSequencedTaskRunnerTestDelegate);
+    SequencedWorkerPoolSequencedTaskRunnerTestDelegate<
+        SequencedWorkerPool::SCHEDULER_SHARED_QUEUE>);
+
+INSTANTIATE_TYPED_TEST_CASE_P(
+    WorkStealingSequencedWorkerPoolSequencedTaskRunner, TaskRunnerTest,
+    SequencedWorkerPoolSequencedTaskRunnerTestDelegate<
+        SequencedWorkerPool::SCHEDULER_WORK_STEALING>);
+
+INSTANTIATE_TYPED_TEST_CASE_P(
+    WorkStealingSequencedWorkerPoolSequencedTaskRunner,
+    SequencedTaskRunnerTest,
+    SequencedWorkerPoolSequencedTaskRunnerTestDelegate<
+        SequencedWorkerPool::SCHEDULER_WORK_STEALING>);
+
+void IncrementCounter(subtle::Atomic32* counter) {
+  subtle::NoBarrier_AtomicIncrement(counter, 1);
+}
+
+// Posts |num_tasks| trivial tasks to |pool|, spreading them across
+// |num_sequences| sequence tokens (or none if |num_sequences| is 0).
+class PoolFlooder : public DelegateSimpleThread::Delegate {
+ public:
+  PoolFlooder(SequencedWorkerPool* pool,
+              subtle::Atomic32* counter,
+              int num_tasks,
+              int num_sequences)
+      : pool_(pool),
+        counter_(counter),
+        num_tasks_(num_tasks) {
+    for (int i = 0; i < num_sequences; ++i)
+      tokens_.push_back(pool->GetSequenceToken());
+  }
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < num_tasks_; ++i) {
+      Closure task = Bind(&IncrementCounter, counter_);
+      if (tokens_.empty()) {
+        pool_->PostWorkerTask(FROM_HERE, task);
+      } else {
+        pool_->PostSequencedWorkerTask(tokens_[i % tokens_.size()],
+                                       FROM_HERE, task);
+      }
+    }
+  }
+
+ private:
+  SequencedWorkerPool* pool_;
+  subtle::Atomic32* counter_;
+  const int num_tasks_;
+  std::vector<SequencedWorkerPool::SequenceToken> tokens_;
+};
+
+// Posts from several threads at once, with and without sequence tokens, and
+// checks that the work-stealing scheduler runs every task.
+TEST(SequencedWorkerPoolWorkStealingTest, TasksFromSeveralThreadsAllRun) {
+  const int kNumPosters = 4;
+  const int kTasksPerPoster = 200;
+
+  MessageLoop message_loop;
+  SequencedWorkerPoolOwner pool_owner(
+      kNumWorkerThreads, "stealing",
+      SequencedWorkerPool::SCHEDULER_WORK_STEALING);
+
+  const int kNumSequences[] = { 0, 4 };
+  for (size_t i = 0; i < arraysize(kNumSequences); ++i) {
+    subtle::Atomic32 counter = 0;
+    ScopedVector<PoolFlooder> flooders;
+    ScopedVector<DelegateSimpleThread> posters;
+    for (int j = 0; j < kNumPosters; ++j) {
+      flooders.push_back(new PoolFlooder(pool_owner.pool(), &counter,
+                                         kTasksPerPoster, kNumSequences[i]));
+      posters.push_back(new DelegateSimpleThread(flooders[j], "poster"));
+    }
+    for (int j = 0; j < kNumPosters; ++j)
+      posters[j]->Start();
+    for (int j = 0; j < kNumPosters; ++j)
+      posters[j]->Join();
+    pool_owner.pool()->FlushForTesting();
+
+    EXPECT_EQ(kNumPosters * kTasksPerPoster,
+              subtle::NoBarrier_Load(&counter));
+  }
+
+  pool_owner.pool()->Shutdown();
+}
 
 }  // namespace
 
@@ -31,13 +31,22 @@ namespace base {
 class BASE_EXPORT Thread : PlatformThread::Delegate {
  public:
   struct Options {
-    Options() : message_loop_type(MessageLoop::TYPE_DEFAULT), stack_size(0) {}
+    Options()
+        : message_loop_type(MessageLoop::TYPE_DEFAULT),
+          incoming_queue_type(MessageLoop::INCOMING_QUEUE_LOCKED),
+          stack_size(0) {}
     Options(MessageLoop::Type type, size_t size)
-        : message_loop_type(type), stack_size(size) {}
+        : message_loop_type(type),
+          incoming_queue_type(MessageLoop::INCOMING_QUEUE_LOCKED),
+          stack_size(size) {}
 
     // Specifies the type of message loop that will be allocated on the thread.
     MessageLoop::Type message_loop_type;
 
+    // Specifies how the thread's message loop queues tasks posted from other
+    // threads.  See MessageLoop::IncomingQueueType.
+    MessageLoop::IncomingQueueType incoming_queue_type;
+
     // Specifies the maximum stack size that the thread is allowed to use.
     // This does not necessarily correspond to the thread's initial stack size.
     // A value of 0 indicates that the default maximum should be used.
@@ -35,7 +35,7 @@ DWORD CALLBACK WorkItemCallback(void* param) {
   tracked_objects::ThreadData::TallyRunOnWorkerThreadIfTracking(
       pending_task->birth_tally,
       tracked_objects::TrackedTime(pending_task->time_posted), start_time,
-      tracked_objects::ThreadData::NowForEndOfRun());
+      tracked_objects::ThreadData::NowForEndOfRun(start_time));
 
   delete pending_task;
   return 0;
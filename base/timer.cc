@@ -129,9 +129,14 @@ void Timer::PostNewScheduledTask(TimeDelta delay) {
   DCHECK(scheduled_task_ == NULL);
   is_running_ = true;
   scheduled_task_ = new BaseTimerTaskInternal(this);
-  MessageLoop::current()->PostDelayedTask(posted_from_,
-      base::Bind(&BaseTimerTaskInternal::Run, base::Owned(scheduled_task_)),
-      delay);
+  base::Closure task =
+      base::Bind(&BaseTimerTaskInternal::Run, base::Owned(scheduled_task_));
+  if (leeway_ > TimeDelta()) {
+    MessageLoop::current()->PostDelayedTaskWithLeeway(posted_from_, task,
+                                                      delay, leeway_);
+  } else {
+    MessageLoop::current()->PostDelayedTask(posted_from_, task, delay);
+  }
   scheduled_run_time_ = desired_run_time_ = TimeTicks::Now() + delay;
   // Remember the thread ID that posts the first task -- this will be verified
   // later when the task is abandoned to detect misuse from multiple threads.
@@ -93,6 +93,12 @@ class BASE_EXPORT Timer {
     return delay_;
   }
 
+  // Allows the timer to fire up to |leeway| late so that the MessageLoop can
+  // run it in the same wakeup as other timers. See
+  // MessageLoop::PostDelayedTaskWithLeeway(). Takes effect from the next time
+  // the timer is scheduled.
+  void set_leeway(TimeDelta leeway) { leeway_ = leeway; }
+
   // Start the timer to run at the given |delay| from now. If the timer is
   // already running, it will be replaced to call the given |user_task|.
   void Start(const tracked_objects::Location& posted_from,
@@ -146,6 +152,8 @@ class BASE_EXPORT Timer {
   tracked_objects::Location posted_from_;
   // Delay requested by user.
   TimeDelta delay_;
+  // How late the scheduled task may run; zero for no coalescing.
+  TimeDelta leeway_;
   // user_task_ is what the user wants to be run at desired_run_time_.
   base::Closure user_task_;
 
@@ -48,6 +48,24 @@ const ThreadData::Status kInitialStartupState =
 // problem with its presence).
 static const bool kAllowAlternateTimeSourceHandling = true;
 
+// Hashes for the direct-mapped tally caches in ThreadData.
+size_t HashLocation(const Location& location) {
+  return (reinterpret_cast<uintptr_t>(location.file_name()) >> 2) ^
+         (location.line_number() * 31);
+}
+
+size_t HashBirth(const Births* birth) {
+  uintptr_t value = reinterpret_cast<uintptr_t>(birth);
+  return (value >> 4) ^ (value >> 10);
+}
+
+// Matches the equivalence defined by Location::operator<.
+bool IsSameLocation(const Location& a, const Location& b) {
+  return a.line_number() == b.line_number() &&
+         a.file_name() == b.file_name() &&
+         a.function_name() == b.function_name();
+}
+
 }  // namespace
 
 //------------------------------------------------------------------------------
@@ -75,9 +93,16 @@ DeathData::DeathData(int count) {
 void DeathData::RecordDeath(const int32 queue_duration,
                             const int32 run_duration,
                             int32 random_number) {
+  RecordSampledDeath(queue_duration, run_duration, random_number, 1);
+}
+
+void DeathData::RecordSampledDeath(const int32 queue_duration,
+                                   const int32 run_duration,
+                                   int32 random_number,
+                                   int sample_weight) {
   ++count_;
-  queue_duration_sum_ += queue_duration;
-  run_duration_sum_ += run_duration;
+  queue_duration_sum_ += queue_duration * sample_weight;
+  run_duration_sum_ += run_duration * sample_weight;
 
   if (queue_duration_max_ < queue_duration)
     queue_duration_max_ = queue_duration;
@@ -85,16 +110,24 @@ void DeathData::RecordDeath(const int32 queue_duration,
     run_duration_max_ = run_duration;
 
   // Take a uniformly distributed sample over all durations ever supplied.
-  // The probability that we (instead) use this new sample is 1/count_.  This
-  // results in a completely uniform selection of the sample.
+  // The probability that we (instead) use this new sample is
+  // sample_weight/count_, which (up to the randomness of which runs were
+  // timed) results in a uniform selection of the sample among all runs.
   // We ignore the fact that we correlated our selection of a sample of run
   // and queue times.
-  if (0 == (random_number % count_)) {
+  int32 slot = random_number % count_;
+  if (slot < 0)
+    slot += count_;
+  if (slot < sample_weight) {
     queue_duration_sample_ = queue_duration;
     run_duration_sample_ = run_duration;
   }
 }
 
+void DeathData::RecordUntimedDeath() {
+  ++count_;
+}
+
 int DeathData::count() const { return count_; }
 
 int32 DeathData::run_duration_sum() const { return run_duration_sum_; }
@@ -229,10 +262,19 @@ base::LazyInstance<base::Lock>::Leaky
 // static
 ThreadData::Status ThreadData::status_ = ThreadData::UNINITIALIZED;
 
+// static
+int ThreadData::timing_sampling_interval_ = 1;
+
+// static
+const int ThreadData::kTallyCacheSize;
+
 ThreadData::ThreadData(const std::string& suggested_name)
     : next_(NULL),
       next_retired_worker_(NULL),
       worker_thread_number_(0),
+      birth_cache_(),
+      death_cache_(),
+      runs_until_timed_run_(0),
       incarnation_count_for_pool_(-1) {
   DCHECK_GE(suggested_name.size(), 0u);
   thread_name_ = suggested_name;
@@ -243,6 +285,9 @@ ThreadData::ThreadData(int thread_number)
     : next_(NULL),
       next_retired_worker_(NULL),
       worker_thread_number_(thread_number),
+      birth_cache_(),
+      death_cache_(),
+      runs_until_timed_run_(0),
       incarnation_count_for_pool_(-1)  {
   CHECK_GT(thread_number, 0);
   base::StringAppendF(&thread_name_, "WorkerThread-%d", thread_number);
@@ -367,17 +412,25 @@ void ThreadData::Snapshot(bool reset_max, ProcessDataSnapshot* process_data) {
 }
 
 Births* ThreadData::TallyABirth(const Location& location) {
-  BirthMap::iterator it = birth_map_.find(location);
+  Births*& cached_child =
+      birth_cache_[HashLocation(location) & (kTallyCacheSize - 1)];
   Births* child;
-  if (it != birth_map_.end()) {
-    child =  it->second;
+  if (cached_child && IsSameLocation(cached_child->location(), location)) {
+    child = cached_child;
     child->RecordBirth();
   } else {
-    child = new Births(location, *this);  // Leak this.
-    // Lock since the map may get relocated now, and other threads sometimes
-    // snapshot it (but they lock before copying it).
-    base::AutoLock lock(map_lock_);
-    birth_map_[location] = child;
+    BirthMap::iterator it = birth_map_.find(location);
+    if (it != birth_map_.end()) {
+      child =  it->second;
+      child->RecordBirth();
+    } else {
+      child = new Births(location, *this);  // Leak this.
+      // Lock since the map may get relocated now, and other threads sometimes
+      // snapshot it (but they lock before copying it).
+      base::AutoLock lock(map_lock_);
+      birth_map_[location] = child;
+    }
+    cached_child = child;
   }
 
   if (kTrackParentChildLinks && status_ > PROFILING_ACTIVE &&
@@ -396,6 +449,7 @@ Births* ThreadData::TallyABirth(const Location& location) {
 }
 
 void ThreadData::TallyADeath(const Births& birth,
+                             bool timed,
                              int32 queue_duration,
                              int32 run_duration) {
   // Stir in some randomness, plus add constant in case durations are zero.
@@ -410,15 +464,28 @@ void ThreadData::TallyADeath(const Births& birth,
   if (kAllowAlternateTimeSourceHandling && now_function_)
     queue_duration = 0;
 
-  DeathMap::iterator it = death_map_.find(&birth);
+  DeathCacheEntry& cached =
+      death_cache_[HashBirth(&birth) & (kTallyCacheSize - 1)];
   DeathData* death_data;
-  if (it != death_map_.end()) {
-    death_data = &it->second;
+  if (cached.birth == &birth) {
+    death_data = cached.death_data;
   } else {
-    base::AutoLock lock(map_lock_);  // Lock as the map may get relocated now.
-    death_data = &death_map_[&birth];
-  }  // Release lock ASAP.
-  death_data->RecordDeath(queue_duration, run_duration, random_number_);
+    DeathMap::iterator it = death_map_.find(&birth);
+    if (it != death_map_.end()) {
+      death_data = &it->second;
+    } else {
+      base::AutoLock lock(map_lock_);  // Lock as the map may get relocated now.
+      death_data = &death_map_[&birth];
+    }  // Release lock ASAP.
+    cached.birth = &birth;
+    cached.death_data = death_data;
+  }
+  if (timed) {
+    death_data->RecordSampledDeath(queue_duration, run_duration,
+                                   random_number_, timing_sampling_interval_);
+  } else {
+    death_data->RecordUntimedDeath();
+  }
 
   if (!kTrackParentChildLinks)
     return;
@@ -481,7 +548,8 @@ void ThreadData::TallyRunOnNamedThreadIfTracking(
     if (!end_of_run.is_null())
       run_duration = (end_of_run - start_of_run).InMilliseconds();
   }
-  current_thread_data->TallyADeath(*birth, queue_duration, run_duration);
+  current_thread_data->TallyADeath(*birth, !start_of_run.is_null(),
+                                   queue_duration, run_duration);
 }
 
 // static
@@ -519,7 +587,8 @@ void ThreadData::TallyRunOnWorkerThreadIfTracking(
     if (!end_of_run.is_null())
       run_duration = (end_of_run - start_of_run).InMilliseconds();
   }
-  current_thread_data->TallyADeath(*birth, queue_duration, run_duration);
+  current_thread_data->TallyADeath(*birth, !start_of_run.is_null(),
+                                   queue_duration, run_duration);
 }
 
 // static
@@ -544,7 +613,8 @@ void ThreadData::TallyRunInAScopedRegionIfTracking(
   int32 run_duration = 0;
   if (!start_of_run.is_null() && !end_of_run.is_null())
     run_duration = (end_of_run - start_of_run).InMilliseconds();
-  current_thread_data->TallyADeath(*birth, queue_duration, run_duration);
+  current_thread_data->TallyADeath(*birth, !start_of_run.is_null(),
+                                   queue_duration, run_duration);
 }
 
 const std::string ThreadData::thread_name() const { return thread_name_; }
@@ -738,6 +808,11 @@ TrackedTime ThreadData::NowForStartOfRun(const Births* parent) {
     if (current_thread_data)
       current_thread_data->parent_stack_.push(parent);
   }
+  if (timing_sampling_interval_ > 1 && TrackingStatus()) {
+    ThreadData* current_thread_data = Get();
+    if (current_thread_data && !current_thread_data->ShouldTimeRun())
+      return TrackedTime();
+  }
   return Now();
 }
 
@@ -746,6 +821,35 @@ TrackedTime ThreadData::NowForEndOfRun() {
   return Now();
 }
 
+// static
+TrackedTime ThreadData::NowForEndOfRun(const TrackedTime& start_of_run) {
+  if (start_of_run.is_null())
+    return TrackedTime();  // The run was not timed.
+  return Now();
+}
+
+// static
+void ThreadData::SetTimingSamplingInterval(int interval) {
+  DCHECK_GE(interval, 1);
+  timing_sampling_interval_ = interval;
+}
+
+// static
+int ThreadData::timing_sampling_interval() {
+  return timing_sampling_interval_;
+}
+
+bool ThreadData::ShouldTimeRun() {
+  if (--runs_until_timed_run_ > 0)
+    return false;
+  // Space the timed runs randomly, between 1 and 2 * interval - 1 runs apart,
+  // so that we do not lock onto periodic patterns of tasks.
+  uint32 spread = 2 * timing_sampling_interval_ - 1;
+  runs_until_timed_run_ =
+      1 + static_cast<int>(static_cast<uint32>(random_number_) % spread);
+  return true;
+}
+
 // static
 void ThreadData::SetAlternateTimeSource(NowFunction* now_function) {
   DCHECK(now_function);
@@ -798,6 +902,7 @@ void ThreadData::ShutdownSingleThreadedCleanup(bool leak) {
 
   // Put most global static back in pristine shape.
   worker_thread_data_creation_count_ = 0;
+  timing_sampling_interval_ = 1;
   cleanup_count_ = 0;
   tls_index_.Set(NULL);
   status_ = DORMANT_DURING_TESTS;  // Almost UNINITIALIZED.
@@ -273,6 +273,17 @@ class BASE_EXPORT DeathData {
                    const int32 run_duration,
                    int random_number);
 
+  // Update stats for a task destruction that was timed as a sample of
+  // |sample_weight| runs.  Sums are scaled by the weight, so that averages
+  // still cover all counted runs.
+  void RecordSampledDeath(const int32 queue_duration,
+                          const int32 run_duration,
+                          int random_number,
+                          int sample_weight);
+
+  // Update stats for a task destruction that was counted but not timed.
+  void RecordUntimedDeath();
+
   // Metrics accessors, used only for serialization and in tests.
   int count() const;
   int32 run_duration_sum() const;
@@ -463,8 +474,19 @@ class BASE_EXPORT ThreadData {
   // accumulated outside of execution of tracked runs.
   // The task that will be tracked is passed in as |parent| so that parent-child
   // relationships can be (optionally) calculated.
+  // When timing is sampled (see SetTimingSamplingInterval()),
+  // NowForStartOfRun() returns a null time for runs that will not be timed,
+  // and NowForEndOfRun(start_of_run) then skips reading the clock as well.
   static TrackedTime NowForStartOfRun(const Births* parent);
   static TrackedTime NowForEndOfRun();
+  static TrackedTime NowForEndOfRun(const TrackedTime& start_of_run);
+
+  // Time only about one in every |interval| runs on each thread, while still
+  // counting all of them.  The durations of timed runs are scaled up by
+  // |interval| in the sums, so that averages remain representative.  An
+  // |interval| of 1 (the default) times every run.
+  static void SetTimingSamplingInterval(int interval);
+  static int timing_sampling_interval();
 
   // Provide a time function that does nothing (runs fast) when we don't have
   // the profiler enabled.  It will generally be optimized away when it is
@@ -519,8 +541,16 @@ class BASE_EXPORT ThreadData {
   // In this thread's data, record a new birth.
   Births* TallyABirth(const Location& location);
 
-  // Find a place to record a death on this thread.
-  void TallyADeath(const Births& birth, int32 queue_duration, int32 duration);
+  // Find a place to record a death on this thread.  A death is untimed when
+  // its run was not picked as a timing sample, in which case the durations
+  // are ignored.
+  void TallyADeath(const Births& birth,
+                   bool timed,
+                   int32 queue_duration,
+                   int32 duration);
+
+  // Returns true if the run about to start on this thread should be timed.
+  bool ShouldTimeRun();
 
   // Snapshot (under a lock) the profiled data for the tasks in each ThreadData
   // instance.  Also updates the |birth_counts| tally for each task to keep
@@ -616,6 +646,18 @@ class BASE_EXPORT ThreadData {
   // We set status_ to SHUTDOWN when we shut down the tracking service.
   static Status status_;
 
+  // Time one in this many runs.  See SetTimingSamplingInterval().
+  static int timing_sampling_interval_;
+
+  // The size of the direct-mapped caches in front of birth_map_ and
+  // death_map_.
+  static const int kTallyCacheSize = 64;
+
+  struct DeathCacheEntry {
+    const Births* birth;
+    DeathData* death_data;
+  };
+
   // Link to next instance (null terminated list). Used to globally track all
   // registered instances (corresponds to all registered threads where we keep
   // data).
@@ -671,6 +713,18 @@ class BASE_EXPORT ThreadData {
   // significant additional cost).
   ParentStack parent_stack_;
 
+  // Recently used entries of birth_map_ and death_map_, indexed by a hash of
+  // their key, so that most births and deaths skip the map lookup.  Entries of
+  // the maps are never removed and std::map nodes never move, so the cached
+  // pointers stay valid for the life of this instance.  Only accessed on this
+  // thread.
+  Births* birth_cache_[kTallyCacheSize];
+  DeathCacheEntry death_cache_[kTallyCacheSize];
+
+  // The number of runs to start on this thread until the next timed one,
+  // when timing is sampled.
+  int runs_until_timed_run_;
+
   // A random number that we used to select decide which sample to keep as a
   // representative sample in each DeathData instance.  We can't start off with
   // much randomness (because we can't call RandInt() on all our threads), so
@@ -266,6 +266,33 @@ TEST_F(TrackedObjectsTest, DeathDataTest) {
   EXPECT_EQ(queue_ms, snapshot.queue_duration_sample);
 }
 
+TEST_F(TrackedObjectsTest, SampledDeathDataTest) {
+  if (!ThreadData::InitializeAndSetTrackingStatus(
+          ThreadData::PROFILING_CHILDREN_ACTIVE))
+    return;
+
+  DeathData data;
+  int32 run_ms = 42;
+  int32 queue_ms = 8;
+  const int kUnrandomInt = 0;  // Fake random int that ensure we sample data.
+  const int kSampleWeight = 10;
+  data.RecordSampledDeath(queue_ms, run_ms, kUnrandomInt, kSampleWeight);
+  EXPECT_EQ(1, data.count());
+  EXPECT_EQ(kSampleWeight * run_ms, data.run_duration_sum());
+  EXPECT_EQ(run_ms, data.run_duration_max());
+  EXPECT_EQ(run_ms, data.run_duration_sample());
+  EXPECT_EQ(kSampleWeight * queue_ms, data.queue_duration_sum());
+  EXPECT_EQ(queue_ms, data.queue_duration_max());
+  EXPECT_EQ(queue_ms, data.queue_duration_sample());
+
+  // Untimed deaths only count.
+  for (int i = 1; i < kSampleWeight; ++i)
+    data.RecordUntimedDeath();
+  EXPECT_EQ(kSampleWeight, data.count());
+  EXPECT_EQ(kSampleWeight * run_ms, data.run_duration_sum());
+  EXPECT_EQ(run_ms, data.run_duration_sample());
+}
+
 TEST_F(TrackedObjectsTest, DeactivatedBirthOnlyToSnapshotWorkerThread) {
   // Start in the deactivated state.
   if (!ThreadData::InitializeAndSetTrackingStatus(ThreadData::DEACTIVATED))
@@ -578,4 +605,116 @@ TEST_F(TrackedObjectsTest, DifferentLives) {
   EXPECT_EQ(base::GetCurrentProcId(), process_data.process_id);
 }
 
+TEST_F(TrackedObjectsTest, SampledTimingScalesSums) {
+  if (!ThreadData::InitializeAndSetTrackingStatus(
+          ThreadData::PROFILING_CHILDREN_ACTIVE))
+    return;
+
+  const int kInterval = 4;
+  ThreadData::SetTimingSamplingInterval(kInterval);
+  ThreadData::InitializeThreadContext(kMainThreadName);
+  const char kFunction[] = "SampledTimingScalesSums";
+  Location location(kFunction, kFile, kLineNumber, NULL);
+
+  const base::TimeTicks kTimePosted = base::TimeTicks() +
+      base::TimeDelta::FromMilliseconds(1);
+  const base::TimeTicks kDelayedStartTime = base::TimeTicks();
+  const TrackedTime kStartOfRun = TrackedTime() +
+      Duration::FromMilliseconds(5);
+  const TrackedTime kEndOfRun = TrackedTime() + Duration::FromMilliseconds(7);
+  // One timed run stands for |kInterval| runs, the rest are only counted.
+  for (int i = 0; i < kInterval; ++i) {
+    // TrackingInfo will call TallyABirth() during construction.
+    base::TrackingInfo pending_task(location, kDelayedStartTime);
+    pending_task.time_posted = kTimePosted;  // Overwrite implied Now().
+    if (i == 0) {
+      ThreadData::TallyRunOnNamedThreadIfTracking(pending_task,
+          kStartOfRun, kEndOfRun);
+    } else {
+      ThreadData::TallyRunOnNamedThreadIfTracking(pending_task,
+          TrackedTime(), ThreadData::NowForEndOfRun(TrackedTime()));
+    }
+  }
+
+  ProcessDataSnapshot process_data;
+  ThreadData::Snapshot(false, &process_data);
+  ASSERT_EQ(1u, process_data.tasks.size());
+  EXPECT_EQ(kInterval, process_data.tasks[0].death_data.count);
+  EXPECT_EQ(kInterval * 2, process_data.tasks[0].death_data.run_duration_sum);
+  EXPECT_EQ(2, process_data.tasks[0].death_data.run_duration_max);
+  EXPECT_EQ(2, process_data.tasks[0].death_data.run_duration_sample);
+  EXPECT_EQ(kInterval * 4,
+            process_data.tasks[0].death_data.queue_duration_sum);
+  EXPECT_EQ(4, process_data.tasks[0].death_data.queue_duration_max);
+}
+
+TEST_F(TrackedObjectsTest, SampledTimingTimesSomeRuns) {
+  if (!ThreadData::InitializeAndSetTrackingStatus(
+          ThreadData::PROFILING_CHILDREN_ACTIVE))
+    return;
+
+  ThreadData::SetTimingSamplingInterval(4);
+  ThreadData::InitializeThreadContext(kMainThreadName);
+  Location location("SampledTimingTimesSomeRuns", kFile, kLineNumber, NULL);
+
+  const int kRuns = 400;
+  int timed_runs = 0;
+  for (int i = 0; i < kRuns; ++i) {
+    base::TrackingInfo pending_task(location, base::TimeTicks());
+    TrackedTime start_of_run =
+        ThreadData::NowForStartOfRun(pending_task.birth_tally);
+    TrackedTime end_of_run = ThreadData::NowForEndOfRun(start_of_run);
+    if (!start_of_run.is_null()) {
+      ++timed_runs;
+      EXPECT_FALSE(end_of_run.is_null());
+    } else {
+      EXPECT_TRUE(end_of_run.is_null());
+    }
+    ThreadData::TallyRunOnNamedThreadIfTracking(pending_task, start_of_run,
+                                                end_of_run);
+  }
+  // Timed runs are between 1 and 7 runs apart, 4 on average.
+  EXPECT_GE(timed_runs, kRuns / 7);
+  EXPECT_LE(timed_runs, kRuns / 2);
+
+  ProcessDataSnapshot process_data;
+  ThreadData::Snapshot(false, &process_data);
+  ASSERT_EQ(1u, process_data.tasks.size());
+  EXPECT_EQ(kRuns, process_data.tasks[0].death_data.count);
+
+  // Going back to an interval of 1 times every run.
+  ThreadData::SetTimingSamplingInterval(1);
+  for (int i = 0; i < 10; ++i)
+    EXPECT_FALSE(ThreadData::NowForStartOfRun(NULL).is_null());
+}
+
+TEST_F(TrackedObjectsTest, ManyLocations) {
+  if (!ThreadData::InitializeAndSetTrackingStatus(
+          ThreadData::PROFILING_CHILDREN_ACTIVE))
+    return;
+
+  // More locations than the tally caches hold, so that entries get evicted.
+  ThreadData::InitializeThreadContext(kMainThreadName);
+  const char kFunction[] = "ManyLocations";
+  const int kLocations = 300;
+  const int kBirthsPerLocation = 3;
+  for (int round = 0; round < kBirthsPerLocation; ++round) {
+    for (int line = 1; line <= kLocations; ++line) {
+      Location location(kFunction, kFile, line, NULL);
+      Births* birth = ThreadData::TallyABirthIfActive(location);
+      ASSERT_NE(reinterpret_cast<Births*>(NULL), birth);
+      EXPECT_EQ(line, birth->location().line_number());
+      EXPECT_EQ(round + 1, birth->birth_count());
+    }
+  }
+
+  ProcessDataSnapshot process_data;
+  ThreadData::Snapshot(false, &process_data);
+  ASSERT_EQ(static_cast<size_t>(kLocations), process_data.tasks.size());
+  for (size_t i = 0; i < process_data.tasks.size(); ++i) {
+    EXPECT_EQ(kBirthsPerLocation, process_data.tasks[i].death_data.count);
+    EXPECT_EQ(kStillAlive, process_data.tasks[i].death_thread_name);
+  }
+}
+
 }  // namespace tracked_objects
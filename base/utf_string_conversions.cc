@@ -15,6 +15,38 @@ using base::WriteUnicodeCharacter;
 
 namespace {
 
+// ASCII fast path -------------------------------------------------------------
+
+// Returns the number of leading characters of |src| that are ASCII.
+template<typename CHAR>
+size_t ASCIIPrefixLength(const CHAR* src, size_t src_len) {
+  size_t i = 0;
+  while (i < src_len && static_cast<uint32>(src[i]) < 0x80)
+    i++;
+  return i;
+}
+
+// UTF-8 is checked a machine word at a time, once |src| is aligned.
+template<>
+size_t ASCIIPrefixLength(const char* src, size_t src_len) {
+  const uintptr_t kNonASCIIMask =
+      static_cast<uintptr_t>(GG_UINT64_C(0x8080808080808080));
+  size_t i = 0;
+  while (i < src_len &&
+         reinterpret_cast<uintptr_t>(src + i) & (sizeof(uintptr_t) - 1)) {
+    if (static_cast<uint8>(src[i]) >= 0x80)
+      return i;
+    i++;
+  }
+  for (; i + sizeof(uintptr_t) <= src_len; i += sizeof(uintptr_t)) {
+    if (*reinterpret_cast<const uintptr_t*>(src + i) & kNonASCIIMask)
+      break;
+  }
+  while (i < src_len && static_cast<uint8>(src[i]) < 0x80)
+    i++;
+  return i;
+}
+
 // Generalized Unicode converter -----------------------------------------------
 
 // Converts the given source Unicode character type to the given destination
@@ -29,6 +61,17 @@ bool ConvertUnicode(const SRC_CHAR* src,
   bool success = true;
   int32 src_len32 = static_cast<int32>(src_len);
   for (int32 i = 0; i < src_len32; i++) {
+    // ASCII needs no decoding and is the same in every encoding, so runs of
+    // it are copied as they are.
+    int32 ascii_length =
+        static_cast<int32>(ASCIIPrefixLength(src + i, src_len32 - i));
+    if (ascii_length) {
+      output->append(src + i, src + i + ascii_length);
+      i += ascii_length;
+      if (i == src_len32)
+        break;
+    }
+
     uint32 code_point;
     if (ReadUnicodeCharacter(src, src_len32, &i, &code_point)) {
       WriteUnicodeCharacter(code_point, output);
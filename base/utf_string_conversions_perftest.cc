@@ -0,0 +1,68 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/string16.h"
+#include "base/test/perf_benchmark.h"
+#include "base/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Roughly the size of a history or bookmark title, and of a JSON message.
+const size_t kShortTextLength = 64;
+const size_t kLongTextLength = 64 * 1024;
+
+// Builds |length| bytes of UTF-8 text by repeating |sample|.
+std::string MakeText(const char* sample, size_t length) {
+  std::string text;
+  while (text.size() < length)
+    text += sample;
+  return text;
+}
+
+void ConvertRoundTrip(const std::string& utf8) {
+  string16 utf16 = UTF8ToUTF16(utf8);
+  std::string result = UTF16ToUTF8(utf16);
+  CHECK_EQ(utf8.size(), result.size());
+}
+
+void RunConversionBenchmarks(const std::string& name, const char* sample) {
+  PerfBenchmark short_benchmark("UTF8ToUTF16_RoundTrip_short_" + name);
+  short_benchmark.set_iterations_per_run(10000);
+  short_benchmark.Run(
+      Bind(&ConvertRoundTrip, MakeText(sample, kShortTextLength)));
+
+  PerfBenchmark long_benchmark("UTF8ToUTF16_RoundTrip_long_" + name);
+  long_benchmark.set_iterations_per_run(10);
+  long_benchmark.Run(
+      Bind(&ConvertRoundTrip, MakeText(sample, kLongTextLength)));
+}
+
+}  // namespace
+
+TEST(UTFStringConversionsPerfTest, ASCII) {
+  RunConversionBenchmarks(
+      "ascii", "http://www.example.com/path/to/page.html?q=search+terms ");
+}
+
+TEST(UTFStringConversionsPerfTest, Latin1) {
+  // "Crème brûlée à la française "
+  RunConversionBenchmarks(
+      "latin1", "Cr\xc3\xa8me br\xc3\xbbl\xc3\xa9" "e \xc3\xa0 la "
+                "fran\xc3\xa7" "aise ");
+}
+
+TEST(UTFStringConversionsPerfTest, CJK) {
+  // "网页 图片 资讯更多 "
+  RunConversionBenchmarks(
+      "cjk", "\xe7\xbd\x91\xe9\xa1\xb5 \xe5\x9b\xbe\xe7\x89\x87 "
+             "\xe8\xb5\x84\xe8\xae\xaf\xe6\x9b\xb4\xe5\xa4\x9a ");
+}
+
+}  // namespace base
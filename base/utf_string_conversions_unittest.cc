@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+
 #include "base/basictypes.h"
 #include "base/logging.h"
 #include "base/string_piece.h"
@@ -208,4 +210,29 @@ TEST(UTFStringConversionsTest, ConvertMultiString) {
   EXPECT_EQ(expected, converted);
 }
 
+// Long ASCII runs are copied a word at a time; check that non-ASCII and
+// invalid bytes are still found at every position and alignment.
+TEST(UTFStringConversionsTest, ConvertASCIIRuns) {
+  const std::string kASCII(37, 'a');
+  const char* const kInserts[] = { "\xe4\xbd\xa0", "\xff", "\x7f" };
+  const char* const kExpected16[] = { "\xe4\xbd\xa0", "\xef\xbf\xbd", "\x7f" };
+  for (size_t i = 0; i < arraysize(kInserts); ++i) {
+    for (size_t offset = 0; offset <= kASCII.size(); ++offset) {
+      std::string utf8(kASCII);
+      utf8.insert(offset, kInserts[i]);
+      // Start at an odd address too, unless that would cut |kInserts[i]|.
+      for (size_t start = 0; start < std::min<size_t>(offset + 1, 2);
+           ++start) {
+        std::string input = utf8.substr(start);
+        string16 utf16;
+        EXPECT_EQ(i != 1, UTF8ToUTF16(input.data(), input.size(), &utf16));
+
+        std::string expected(kASCII);
+        expected.insert(offset, kExpected16[i]);
+        EXPECT_EQ(expected.substr(start), UTF16ToUTF8(utf16));
+      }
+    }
+  }
+}
+
 }  // base
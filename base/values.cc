@@ -6,13 +6,91 @@
 
 #include <algorithm>
 
+#include "base/atomicops.h"
 #include "base/float_util.h"
+#include "base/hash_tables.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/string_piece.h"
 #include "base/string_util.h"
+#include "base/synchronization/lock.h"
 #include "base/utf_string_conversions.h"
 
 namespace {
 
+using base::internal::DictionaryKey;
+
+// Interns the keys of all the DictionaryValues in the process.  A key stays in
+// the table while any dictionary holds a reference to it.  Once its count
+// drops to zero it is never handed out again, so exactly one thread deletes
+// it; interning the same string later creates a fresh key.
+class DictionaryKeyTable {
+ public:
+  DictionaryKeyTable() {}
+
+  // Returns |key| with a reference added for the caller.
+  const DictionaryKey* Intern(const std::string& key) {
+    base::AutoLock lock(lock_);
+    KeyMap::iterator it = keys_.find(key);
+    if (it != keys_.end()) {
+      if (AddRefIfAlive(it->second))
+        return it->second;
+      keys_.erase(it);
+    }
+    DictionaryKey* interned = new DictionaryKey(key);
+    interned->ref_count = 1;
+    keys_.insert(std::make_pair(base::StringPiece(interned->value), interned));
+    return interned;
+  }
+
+  static void AddRef(const DictionaryKey* key) {
+    base::AtomicRefCountInc(&key->ref_count);
+  }
+
+  void Release(const DictionaryKey* key) {
+    if (base::AtomicRefCountDec(&key->ref_count))
+      return;
+    {
+      base::AutoLock lock(lock_);
+      KeyMap::iterator it = keys_.find(key->value);
+      if (it != keys_.end() && it->second == key)
+        keys_.erase(it);
+    }
+    delete key;
+  }
+
+ private:
+  typedef base::hash_map<base::StringPiece, const DictionaryKey*> KeyMap;
+
+  static bool AddRefIfAlive(const DictionaryKey* key) {
+    base::AtomicRefCount count = base::subtle::NoBarrier_Load(&key->ref_count);
+    while (count) {
+      base::AtomicRefCount previous = base::subtle::NoBarrier_CompareAndSwap(
+          &key->ref_count, count, count + 1);
+      if (previous == count)
+        return true;
+      count = previous;
+    }
+    return false;
+  }
+
+  base::Lock lock_;
+  KeyMap keys_;
+
+  DISALLOW_COPY_AND_ASSIGN(DictionaryKeyTable);
+};
+
+// Values can outlive the AtExitManager, so the table is never destroyed.
+base::LazyInstance<DictionaryKeyTable>::Leaky g_dictionary_keys =
+    LAZY_INSTANCE_INITIALIZER;
+
+struct EntryKeyLess {
+  bool operator()(const base::internal::DictionaryEntry& entry,
+                  const std::string& key) const {
+    return entry.key->value < key;
+  }
+};
+
 // Make a deep copy of |node|, but don't include empty lists or dictionaries
 // in the copy. It's possible for this function to return NULL and it
 // expects |node| to always be non-NULL.
@@ -345,6 +423,15 @@ BinaryValue::BinaryValue(char* buffer, size_t size)
 
 ///////////////////// DictionaryValue ////////////////////
 
+namespace internal {
+
+DictionaryKey::DictionaryKey(const std::string& in_value)
+    : ref_count(0),
+      value(in_value) {
+}
+
+}  // namespace internal
+
 DictionaryValue::DictionaryValue()
     : Value(TYPE_DICTIONARY) {
 }
@@ -367,19 +454,20 @@ bool DictionaryValue::GetAsDictionary(const DictionaryValue** out_value) const {
 
 bool DictionaryValue::HasKey(const std::string& key) const {
   DCHECK(IsStringUTF8(key));
-  ValueMap::const_iterator current_entry = dictionary_.find(key);
-  DCHECK((current_entry == dictionary_.end()) || current_entry->second);
-  return current_entry != dictionary_.end();
+  size_t index = Find(key);
+  DCHECK(index == entries_.size() || entries_[index].value);
+  return index != entries_.size();
 }
 
 void DictionaryValue::Clear() {
-  ValueMap::iterator dict_iterator = dictionary_.begin();
-  while (dict_iterator != dictionary_.end()) {
-    delete dict_iterator->second;
-    ++dict_iterator;
+  DictionaryKeyTable* keys = g_dictionary_keys.Pointer();
+  for (DictionaryEntries::iterator it = entries_.begin(); it != entries_.end();
+       ++it) {
+    delete it->value;
+    keys->Release(it->key);
   }
 
-  dictionary_.clear();
+  entries_.clear();
 }
 
 void DictionaryValue::Set(const std::string& path, Value* in_value) {
@@ -432,13 +520,18 @@ void DictionaryValue::SetWithoutPathExpansion(const std::string& key,
                                               Value* in_value) {
   // If there's an existing value here, we need to delete it, because
   // we own all our children.
-  std::pair<ValueMap::iterator, bool> ins_res =
-      dictionary_.insert(std::make_pair(key, in_value));
-  if (!ins_res.second) {
-    DCHECK_NE(ins_res.first->second, in_value);  // This would be bogus
-    delete ins_res.first->second;
-    ins_res.first->second = in_value;
+  size_t index = LowerBound(key);
+  if (index != entries_.size() && entries_[index].key->value == key) {
+    DCHECK_NE(entries_[index].value, in_value);  // This would be bogus
+    delete entries_[index].value;
+    entries_[index].value = in_value;
+    return;
   }
+
+  internal::DictionaryEntry entry;
+  entry.key = g_dictionary_keys.Get().Intern(key);
+  entry.value = in_value;
+  entries_.insert(entries_.begin() + index, entry);
 }
 
 bool DictionaryValue::Get(const std::string& path, Value** out_value) const {
@@ -562,11 +655,11 @@ bool DictionaryValue::GetList(const std::string& path,
 bool DictionaryValue::GetWithoutPathExpansion(const std::string& key,
                                               Value** out_value) const {
   DCHECK(IsStringUTF8(key));
-  ValueMap::const_iterator entry_iterator = dictionary_.find(key);
-  if (entry_iterator == dictionary_.end())
+  size_t index = Find(key);
+  if (index == entries_.size())
     return false;
 
-  Value* entry = entry_iterator->second;
+  Value* entry = entries_[index].value;
   if (out_value)
     *out_value = entry;
   return true;
@@ -656,16 +749,17 @@ bool DictionaryValue::Remove(const std::string& path, Value** out_value) {
 bool DictionaryValue::RemoveWithoutPathExpansion(const std::string& key,
                                                  Value** out_value) {
   DCHECK(IsStringUTF8(key));
-  ValueMap::iterator entry_iterator = dictionary_.find(key);
-  if (entry_iterator == dictionary_.end())
+  size_t index = Find(key);
+  if (index == entries_.size())
     return false;
 
-  Value* entry = entry_iterator->second;
+  Value* entry = entries_[index].value;
   if (out_value)
     *out_value = entry;
   else
     delete entry;
-  dictionary_.erase(entry_iterator);
+  g_dictionary_keys.Get().Release(entries_[index].key);
+  entries_.erase(entries_.begin() + index);
   return true;
 }
 
@@ -697,10 +791,15 @@ void DictionaryValue::MergeDictionary(const DictionaryValue* dictionary) {
 DictionaryValue* DictionaryValue::DeepCopy() const {
   DictionaryValue* result = new DictionaryValue;
 
-  for (ValueMap::const_iterator current_entry(dictionary_.begin());
-       current_entry != dictionary_.end(); ++current_entry) {
-    result->SetWithoutPathExpansion(current_entry->first,
-                                    current_entry->second->DeepCopy());
+  // The copy shares the keys, and is already sorted.
+  result->entries_.reserve(entries_.size());
+  for (DictionaryEntries::const_iterator it = entries_.begin();
+       it != entries_.end(); ++it) {
+    internal::DictionaryEntry entry;
+    entry.key = it->key;
+    DictionaryKeyTable::AddRef(entry.key);
+    entry.value = it->value->DeepCopy();
+    result->entries_.push_back(entry);
   }
 
   return result;
@@ -712,26 +811,38 @@ bool DictionaryValue::Equals(const Value* other) const {
 
   const DictionaryValue* other_dict =
       static_cast<const DictionaryValue*>(other);
-  key_iterator lhs_it(begin_keys());
-  key_iterator rhs_it(other_dict->begin_keys());
-  while (lhs_it != end_keys() && rhs_it != other_dict->end_keys()) {
-    Value* lhs;
-    Value* rhs;
-    if (*lhs_it != *rhs_it ||
-        !GetWithoutPathExpansion(*lhs_it, &lhs) ||
-        !other_dict->GetWithoutPathExpansion(*rhs_it, &rhs) ||
-        !lhs->Equals(rhs)) {
+  if (entries_.size() != other_dict->entries_.size())
+    return false;
+
+  // Both are sorted by key, and equal keys are usually the same interned one.
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    const internal::DictionaryEntry& lhs = entries_[i];
+    const internal::DictionaryEntry& rhs = other_dict->entries_[i];
+    if ((lhs.key != rhs.key && lhs.key->value != rhs.key->value) ||
+        !lhs.value->Equals(rhs.value)) {
       return false;
     }
-    ++lhs_it;
-    ++rhs_it;
   }
-  if (lhs_it != end_keys() || rhs_it != other_dict->end_keys())
-    return false;
 
   return true;
 }
 
+size_t DictionaryValue::LowerBound(const std::string& key) const {
+  // Dictionaries are mostly built in key order, e.g. from JSON written by
+  // JSONWriter, so check for appending first.
+  if (entries_.empty() || entries_.back().key->value < key)
+    return entries_.size();
+  return std::lower_bound(entries_.begin(), entries_.end(), key,
+                          EntryKeyLess()) - entries_.begin();
+}
+
+size_t DictionaryValue::Find(const std::string& key) const {
+  size_t index = LowerBound(key);
+  if (index != entries_.size() && entries_[index].key->value != key)
+    return entries_.size();
+  return index;
+}
+
 ///////////////////// ListValue ////////////////////
 
 ListValue::ListValue() : Value(TYPE_LIST) {
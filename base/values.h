@@ -27,6 +27,7 @@
 #include <string>
 #include <vector>
 
+#include "base/atomic_ref_count.h"
 #include "base/base_export.h"
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
@@ -47,7 +48,27 @@ class StringValue;
 class Value;
 
 typedef std::vector<Value*> ValueVector;
-typedef std::map<std::string, Value*> ValueMap;
+
+namespace internal {
+
+// A dictionary key.  Keys are interned, so every DictionaryValue holding a
+// given key shares one reference-counted copy of it; see values.cc.
+struct BASE_EXPORT DictionaryKey {
+  explicit DictionaryKey(const std::string& in_value);
+
+  mutable AtomicRefCount ref_count;
+  const std::string value;
+};
+
+struct DictionaryEntry {
+  const DictionaryKey* key;
+  Value* value;
+};
+
+}  // namespace internal
+
+// The entries of a DictionaryValue, sorted by key.
+typedef std::vector<internal::DictionaryEntry> DictionaryEntries;
 
 // The Value class is the base class for Values. A Value can be instantiated
 // via the Create*Value() factory methods, or by directly creating instances of
@@ -212,6 +233,11 @@ class BASE_EXPORT BinaryValue: public Value {
 // DictionaryValue provides a key-value dictionary with (optional) "path"
 // parsing for recursive access; see the comment at the top of the file. Keys
 // are |std::string|s and should be UTF-8 encoded.
+//
+// The entries are kept in one flat vector sorted by key rather than in a
+// node-based map, and the keys themselves are interned, which keeps large
+// trees of small dictionaries (preferences, policy, manifests) compact.  As
+// with std::map, adding or removing keys invalidates iterators.
 class BASE_EXPORT DictionaryValue : public Value {
  public:
   DictionaryValue();
@@ -226,10 +252,10 @@ class BASE_EXPORT DictionaryValue : public Value {
   bool HasKey(const std::string& key) const;
 
   // Returns the number of Values in this dictionary.
-  size_t size() const { return dictionary_.size(); }
+  size_t size() const { return entries_.size(); }
 
   // Returns whether the dictionary is empty.
-  bool empty() const { return dictionary_.empty(); }
+  bool empty() const { return entries_.empty(); }
 
   // Clears any current contents of this dictionary.
   void Clear();
@@ -321,7 +347,7 @@ class BASE_EXPORT DictionaryValue : public Value {
 
   // Swaps contents with the |other| dictionary.
   void Swap(DictionaryValue* other) {
-    dictionary_.swap(other->dictionary_);
+    entries_.swap(other->entries_);
   }
 
   // This class provides an iterator for the keys in the dictionary.
@@ -333,38 +359,40 @@ class BASE_EXPORT DictionaryValue : public Value {
   class key_iterator
       : private std::iterator<std::input_iterator_tag, const std::string> {
    public:
-    explicit key_iterator(ValueMap::const_iterator itr) { itr_ = itr; }
+    explicit key_iterator(DictionaryEntries::const_iterator itr) {
+      itr_ = itr;
+    }
     key_iterator operator++() {
       ++itr_;
       return *this;
     }
-    const std::string& operator*() { return itr_->first; }
+    const std::string& operator*() { return itr_->key->value; }
     bool operator!=(const key_iterator& other) { return itr_ != other.itr_; }
     bool operator==(const key_iterator& other) { return itr_ == other.itr_; }
 
    private:
-    ValueMap::const_iterator itr_;
+    DictionaryEntries::const_iterator itr_;
   };
 
-  key_iterator begin_keys() const { return key_iterator(dictionary_.begin()); }
-  key_iterator end_keys() const { return key_iterator(dictionary_.end()); }
+  key_iterator begin_keys() const { return key_iterator(entries_.begin()); }
+  key_iterator end_keys() const { return key_iterator(entries_.end()); }
 
   // This class provides an iterator over both keys and values in the
   // dictionary.  It can't be used to modify the dictionary.
   class Iterator {
    public:
     explicit Iterator(const DictionaryValue& target)
-        : target_(target), it_(target.dictionary_.begin()) {}
+        : target_(target), it_(target.entries_.begin()) {}
 
-    bool HasNext() const { return it_ != target_.dictionary_.end(); }
+    bool HasNext() const { return it_ != target_.entries_.end(); }
     void Advance() { ++it_; }
 
-    const std::string& key() const { return it_->first; }
-    const Value& value() const { return *it_->second; }
+    const std::string& key() const { return it_->key->value; }
+    const Value& value() const { return *it_->value; }
 
    private:
     const DictionaryValue& target_;
-    ValueMap::const_iterator it_;
+    DictionaryEntries::const_iterator it_;
   };
 
   // Overridden from Value:
@@ -372,7 +400,13 @@ class BASE_EXPORT DictionaryValue : public Value {
   virtual bool Equals(const Value* other) const OVERRIDE;
 
  private:
-  ValueMap dictionary_;
+  // Returns the index of the first entry whose key is not less than |key|.
+  size_t LowerBound(const std::string& key) const;
+
+  // Returns the index of the entry for |key|, or size() if there is none.
+  size_t Find(const std::string& key) const;
+
+  DictionaryEntries entries_;
 
   DISALLOW_COPY_AND_ASSIGN(DictionaryValue);
 };
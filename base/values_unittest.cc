@@ -6,6 +6,7 @@
 
 #include "base/memory/scoped_ptr.h"
 #include "base/string16.h"
+#include "base/string_number_conversions.h"
 #include "base/utf_string_conversions.h"
 #include "base/values.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -755,4 +756,67 @@ TEST(ValuesTest, DictionaryIterator) {
   EXPECT_TRUE(seen2);
 }
 
+TEST(ValuesTest, DictionaryKeyOrder) {
+  // Insert in a scrambled order; iteration is always in key order.
+  DictionaryValue dict;
+  const int kCount = 500;
+  for (int i = 0; i < kCount; ++i) {
+    int n = (i * 7919) % kCount;
+    dict.SetWithoutPathExpansion(IntToString(n), Value::CreateIntegerValue(n));
+  }
+  EXPECT_EQ(static_cast<size_t>(kCount), dict.size());
+
+  std::string previous;
+  int count = 0;
+  for (DictionaryValue::Iterator it(dict); it.HasNext(); it.Advance()) {
+    if (count++)
+      EXPECT_LT(previous, it.key());
+    previous = it.key();
+    int value = 0;
+    EXPECT_TRUE(it.value().GetAsInteger(&value));
+    EXPECT_EQ(IntToString(value), it.key());
+  }
+  EXPECT_EQ(kCount, count);
+
+  // Replacing keeps one entry per key.
+  dict.SetInteger("42", -1);
+  EXPECT_EQ(static_cast<size_t>(kCount), dict.size());
+  int value = 0;
+  EXPECT_TRUE(dict.GetInteger("42", &value));
+  EXPECT_EQ(-1, value);
+
+  for (int i = 0; i < kCount; i += 2)
+    EXPECT_TRUE(dict.RemoveWithoutPathExpansion(IntToString(i), NULL));
+  EXPECT_EQ(static_cast<size_t>(kCount / 2), dict.size());
+  for (int i = 0; i < kCount; ++i)
+    EXPECT_EQ(i % 2 == 1, dict.HasKey(IntToString(i))) << i;
+}
+
+TEST(ValuesTest, DictionaryKeysAreShared) {
+  const std::string kKey("http://www.example.com/a/key/too/long/to/be/inline");
+  DictionaryValue first;
+  first.SetWithoutPathExpansion(kKey, Value::CreateBooleanValue(true));
+  DictionaryValue second;
+  second.SetWithoutPathExpansion(kKey, Value::CreateBooleanValue(false));
+  scoped_ptr<DictionaryValue> copy(first.DeepCopy());
+
+  // Every dictionary holding a key shares its storage.
+  EXPECT_EQ(&*first.begin_keys(), &*second.begin_keys());
+  EXPECT_EQ(&*first.begin_keys(), &*copy->begin_keys());
+  EXPECT_TRUE(first.Equals(copy.get()));
+  EXPECT_FALSE(first.Equals(&second));
+
+  // Keys outlive the dictionary they were first added to.
+  first.Clear();
+  copy.reset();
+  EXPECT_EQ(kKey, *second.begin_keys());
+  EXPECT_TRUE(second.HasKey(kKey));
+
+  // And can be interned again once every dictionary has dropped them.
+  second.Clear();
+  DictionaryValue third;
+  third.SetWithoutPathExpansion(kKey, Value::CreateNullValue());
+  EXPECT_EQ(kKey, *third.begin_keys());
+}
+
 }  // namespace base
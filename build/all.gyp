@@ -253,6 +253,21 @@
         '../chrome/chrome.gyp:ui_tests',
       ],
     }, # target_name: chromium_builder_perf
+    {
+      # Every gtest-based perf test binary, so that they can be built and run
+      # together to track regressions.
+      'target_name': 'chromium_perftests',
+      'type': 'none',
+      'dependencies': [
+        '../base/base.gyp:base_perftests',
+        '../chrome/chrome.gyp:perf_tests',
+        '../courgette/courgette.gyp:courgette_perftests',
+        '../crypto/crypto.gyp:crypto_perftests',
+        '../ipc/ipc.gyp:ipc_perftests',
+        '../jingle/jingle.gyp:jingle_perftests',
+        '../net/net.gyp:net_perftests',
+      ],
+    }, # target_name: chromium_perftests
     {
       'target_name': 'chromium_gpu_builder',
       'type': 'none',
@@ -552,6 +552,10 @@ void AutocompleteProvider::Stop() {
   done_ = true;
 }
 
+base::TimeDelta AutocompleteProvider::GetDeadline() const {
+  return base::TimeDelta();
+}
+
 void AutocompleteProvider::DeleteMatch(const AutocompleteMatch& match) {
   DLOG(WARNING) << "The AutocompleteProvider '" << name()
                 << "' has not implemented DeleteMatch.";
@@ -842,6 +846,29 @@ const int AutocompleteController::kNoItemSelected = -1;
 // they initiate a query.
 static const int kExpireTimeMS = 500;
 
+namespace {
+
+// Adds |elapsed| to the histogram |prefix| + the name of |provider|.
+void RecordProviderTime(const std::string& prefix,
+                        const AutocompleteProvider* provider,
+                        base::TimeDelta elapsed) {
+  base::Histogram* counter = base::Histogram::FactoryGet(
+      prefix + provider->name(), 1, 1000, 50,
+      base::Histogram::kUmaTargetedHistogramFlag);
+  counter->Add(static_cast<int>(elapsed.InMilliseconds()));
+}
+
+// Records whether |provider| was stopped for missing its deadline.
+void RecordProviderTimedOut(const AutocompleteProvider* provider,
+                            bool timed_out) {
+  base::Histogram* counter = base::BooleanHistogram::FactoryGet(
+      std::string("Omnibox.ProviderTimedOut.") + provider->name(),
+      base::Histogram::kUmaTargetedHistogramFlag);
+  counter->AddBoolean(timed_out);
+}
+
+}  // namespace
+
 AutocompleteController::AutocompleteController(
     Profile* profile,
     AutocompleteControllerDelegate* delegate)
@@ -918,15 +945,24 @@ void AutocompleteController::Start(
       (input_.matches_requested() == old_matches_requested);
 
   expire_timer_.Stop();
+  deadline_timer_.Stop();
+  pending_providers_.clear();
 
   // Start the new query.
   in_start_ = true;
-  base::TimeTicks start_time = base::TimeTicks::Now();
+  start_time_ = base::TimeTicks::Now();
   for (ACProviders::iterator i(providers_.begin()); i != providers_.end();
        ++i) {
+    base::TimeTicks provider_start_time = base::TimeTicks::Now();
     (*i)->Start(input_, minimal_changes);
-    if (matches_requested != AutocompleteInput::ALL_MATCHES)
+    if (matches_requested != AutocompleteInput::ALL_MATCHES) {
       DCHECK((*i)->done());
+      continue;
+    }
+    RecordProviderTime("Omnibox.ProviderTime.", *i,
+                       base::TimeTicks::Now() - provider_start_time);
+    if (!(*i)->done())
+      pending_providers_.insert(*i);
   }
   if (matches_requested == AutocompleteInput::ALL_MATCHES &&
       (text.length() < 6)) {
@@ -935,14 +971,16 @@ void AutocompleteController::Start(
         InstantFieldTrial::GetGroupName(profile_);
     base::Histogram* counter = base::Histogram::FactoryGet(
         name, 1, 1000, 50, base::Histogram::kUmaTargetedHistogramFlag);
-    counter->Add(static_cast<int>((end_time - start_time).InMilliseconds()));
+    counter->Add(static_cast<int>((end_time - start_time_).InMilliseconds()));
   }
   in_start_ = false;
   CheckIfDone();
   UpdateResult(true);
 
-  if (!done_)
+  if (!done_) {
     StartExpireTimer();
+    StartDeadlineTimer();
+  }
 }
 
 void AutocompleteController::Stop(bool clear_result) {
@@ -952,6 +990,8 @@ void AutocompleteController::Stop(bool clear_result) {
   }
 
   expire_timer_.Stop();
+  deadline_timer_.Stop();
+  pending_providers_.clear();
   done_ = true;
   if (clear_result && !result_.empty()) {
     result_.Reset();
@@ -982,6 +1022,7 @@ void AutocompleteController::ExpireCopiedEntries() {
 }
 
 void AutocompleteController::OnProviderUpdate(bool updated_matches) {
+  UpdatePendingProviders();
   CheckIfDone();
   // Multiple providers may provide synchronous results, so we only update the
   // results if we're not in Start().
@@ -1126,6 +1167,57 @@ void AutocompleteController::StartExpireTimer() {
                         this, &AutocompleteController::ExpireCopiedEntries);
 }
 
+void AutocompleteController::UpdatePendingProviders() {
+  for (std::set<AutocompleteProvider*>::iterator i(pending_providers_.begin());
+       i != pending_providers_.end(); ) {
+    if (!(*i)->done()) {
+      ++i;
+      continue;
+    }
+    RecordProviderTime("Omnibox.ProviderAsyncTime.", *i,
+                       base::TimeTicks::Now() - start_time_);
+    RecordProviderTimedOut(*i, false);
+    pending_providers_.erase(i++);
+  }
+  if (pending_providers_.empty())
+    deadline_timer_.Stop();
+}
+
+void AutocompleteController::StartDeadlineTimer() {
+  base::TimeDelta first_deadline;
+  for (std::set<AutocompleteProvider*>::const_iterator i(
+           pending_providers_.begin()); i != pending_providers_.end(); ++i) {
+    base::TimeDelta deadline((*i)->GetDeadline());
+    if (deadline > base::TimeDelta() &&
+        (first_deadline == base::TimeDelta() || deadline < first_deadline))
+      first_deadline = deadline;
+  }
+  if (first_deadline == base::TimeDelta())
+    return;
+  base::TimeDelta delay(first_deadline -
+                        (base::TimeTicks::Now() - start_time_));
+  deadline_timer_.Start(FROM_HERE, std::max(delay, base::TimeDelta()), this,
+                        &AutocompleteController::OnDeadline);
+}
+
+void AutocompleteController::OnDeadline() {
+  base::TimeDelta elapsed(base::TimeTicks::Now() - start_time_);
+  for (std::set<AutocompleteProvider*>::iterator i(pending_providers_.begin());
+       i != pending_providers_.end(); ) {
+    base::TimeDelta deadline((*i)->GetDeadline());
+    if (deadline == base::TimeDelta() || elapsed < deadline) {
+      ++i;
+      continue;
+    }
+    (*i)->Stop();
+    RecordProviderTimedOut(*i, true);
+    pending_providers_.erase(i++);
+  }
+  StartDeadlineTimer();
+  CheckIfDone();
+  UpdateResult(false);
+}
+
 // AutocompleteLog ---------------------------------------------------------
 
 AutocompleteLog::AutocompleteLog(
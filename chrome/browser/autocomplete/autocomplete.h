@@ -7,6 +7,7 @@
 #pragma once
 
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -412,6 +413,11 @@ class AutocompleteProvider
   // Returns the name of this provider.
   const char* name() const { return name_; }
 
+  // Returns how long the controller lets this provider work on a query
+  // asynchronously before it Stop()s the provider and finishes the query
+  // without it.  The default of zero means the provider is never stopped.
+  virtual base::TimeDelta GetDeadline() const;
+
   // Called to delete a match and the backing data that produced it.  This
   // match should not appear again in this or future queries.  This can only be
   // called for matches the provider marks as deletable.  This should only be
@@ -736,6 +742,18 @@ class AutocompleteController : public ACProviderListener {
   // Starts the expire timer.
   void StartExpireTimer();
 
+  // Removes the providers which have finished the current query from
+  // |pending_providers_|, logging how long they took.
+  void UpdatePendingProviders();
+
+  // Starts the deadline timer for the earliest deadline of the
+  // |pending_providers_|, if any have one.
+  void StartDeadlineTimer();
+
+  // Stops the pending providers which are past their deadline and updates the
+  // result without them.
+  void OnDeadline();
+
   AutocompleteControllerDelegate* delegate_;
 
   // A list of all providers.
@@ -755,6 +773,16 @@ class AutocompleteController : public ACProviderListener {
   // invokes |ExpireCopiedEntries|.
   base::OneShotTimer<AutocompleteController> expire_timer_;
 
+  // When the current query was started.
+  base::TimeTicks start_time_;
+
+  // The providers still working on the current query asynchronously.
+  std::set<AutocompleteProvider*> pending_providers_;
+
+  // Timer used to stop the pending providers which are past their deadline.
+  // When run invokes |OnDeadline|.
+  base::OneShotTimer<AutocompleteController> deadline_timer_;
+
   // True if a query is not currently running.
   bool done_;
 
@@ -40,16 +40,24 @@ class TestProvider : public AutocompleteProvider {
   TestProvider(int relevance, const string16& prefix)
       : AutocompleteProvider(NULL, NULL, ""),
         relevance_(relevance),
-        prefix_(prefix) {
+        prefix_(prefix),
+        hangs_(false) {
   }
 
   virtual void Start(const AutocompleteInput& input,
                      bool minimal_changes);
 
+  virtual base::TimeDelta GetDeadline() const { return deadline_; }
+
   void set_listener(ACProviderListener* listener) {
     listener_ = listener;
   }
 
+  void set_deadline(base::TimeDelta deadline) { deadline_ = deadline; }
+
+  // Makes the provider never finish its asynchronous pass.
+  void set_hangs(bool hangs) { hangs_ = hangs; }
+
  private:
   ~TestProvider() {}
 
@@ -59,6 +67,8 @@ class TestProvider : public AutocompleteProvider {
 
   int relevance_;
   const string16 prefix_;
+  base::TimeDelta deadline_;
+  bool hangs_;
 };
 
 void TestProvider::Start(const AutocompleteInput& input,
@@ -73,8 +83,10 @@ void TestProvider::Start(const AutocompleteInput& input,
 
   if (input.matches_requested() == AutocompleteInput::ALL_MATCHES) {
     done_ = false;
-    MessageLoop::current()->PostTask(FROM_HERE, base::Bind(&TestProvider::Run,
-                                                           this));
+    if (!hangs_) {
+      MessageLoop::current()->PostTask(FROM_HERE,
+                                       base::Bind(&TestProvider::Run, this));
+    }
   }
 }
 
@@ -337,6 +349,24 @@ TEST_F(AutocompleteProviderTest, Query) {
   EXPECT_EQ(providers_[1], result_.default_match()->provider);
 }
 
+// Tests that a provider which misses its deadline is stopped and the query
+// finishes with the matches of the other providers.
+TEST_F(AutocompleteProviderTest, ProviderDeadline) {
+  ResetControllerWithTestProviders(false);
+  TestProvider* slow_provider = static_cast<TestProvider*>(providers_[1]);
+  slow_provider->set_deadline(base::TimeDelta::FromMilliseconds(1));
+  slow_provider->set_hangs(true);
+  RunTest();
+
+  EXPECT_TRUE(controller_->done());
+  EXPECT_TRUE(slow_provider->done());
+  // All of the first provider's matches, but only the synchronous match of
+  // the second.
+  EXPECT_EQ(kResultsPerProvider + 1, result_.size());
+  ASSERT_NE(result_.end(), result_.default_match());
+  EXPECT_EQ(providers_[1], result_.default_match()->provider);
+}
+
 TEST_F(AutocompleteProviderTest, RemoveDuplicates) {
   ResetControllerWithTestProviders(true);
   RunTest();
@@ -16,6 +16,14 @@
 #include "chrome/common/url_constants.h"
 #include "googleurl/src/url_util.h"
 
+namespace {
+
+// How long the history providers may take to finish a query asynchronously.
+// Slow history backends shouldn't hold up the rest of the popup any longer.
+const int kHistoryDeadlineMS = 500;
+
+}  // namespace
+
 HistoryProvider::HistoryProvider(ACProviderListener* listener,
                                  Profile* profile,
                                  const char* name)
@@ -25,6 +33,10 @@ HistoryProvider::HistoryProvider(ACProviderListener* listener,
 
 HistoryProvider::~HistoryProvider() {}
 
+base::TimeDelta HistoryProvider::GetDeadline() const {
+  return base::TimeDelta::FromMilliseconds(kHistoryDeadlineMS);
+}
+
 void HistoryProvider::DeleteMatch(const AutocompleteMatch& match) {
   DCHECK(done_);
   DCHECK(profile_);
@@ -14,6 +14,7 @@
 class HistoryProvider : public AutocompleteProvider {
  public:
   virtual void DeleteMatch(const AutocompleteMatch& match) OVERRIDE;
+  virtual base::TimeDelta GetDeadline() const OVERRIDE;
 
  protected:
   HistoryProvider(ACProviderListener* listener,
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/i18n/break_iterator.h"
 #include "base/logging.h"
@@ -104,6 +105,8 @@ HistoryQuickProvider::HistoryQuickProvider(ACProviderListener* listener,
 
 void HistoryQuickProvider::Start(const AutocompleteInput& input,
                                  bool minimal_changes) {
+  CancelScoringJob();
+  done_ = true;
   matches_.clear();
   if (disabled_)
     return;
@@ -124,28 +127,38 @@ void HistoryQuickProvider::Start(const AutocompleteInput& input,
   // autocomplete behavior here.
   if (GetIndex()) {
     base::TimeTicks start_time = base::TimeTicks::Now();
-    DoAutocomplete();
-    if (input.text().length() < 6) {
-      base::TimeTicks end_time = base::TimeTicks::Now();
-      std::string name = "HistoryQuickProvider.QueryIndexTime." +
-          base::IntToString(input.text().length());
-      base::Histogram* counter = base::Histogram::FactoryGet(
-          name, 1, 1000, 50, base::Histogram::kUmaTargetedHistogramFlag);
-      counter->Add(static_cast<int>((end_time - start_time).InMilliseconds()));
+    scoped_refptr<history::URLIndexScoringJob> job(
+        GetIndex()->ScoringJobForTerms(autocomplete_input_.text()));
+    // Only score on the blocking pool when the caller can wait for the
+    // matches and there are enough candidates for it to pay off.
+    if (input.matches_requested() == AutocompleteInput::ALL_MATCHES &&
+        job->ShouldStart()) {
+      done_ = false;
+      scoring_job_ = job;
+      scoring_job_->Start(base::Bind(&HistoryQuickProvider::OnScoringDone,
+                                     this, start_time));
+      return;
     }
+    DoAutocomplete(job->Run());
+    RecordQueryIndexTime(start_time);
     UpdateStarredStateOfMatches();
   }
 }
 
+void HistoryQuickProvider::Stop() {
+  CancelScoringJob();
+  AutocompleteProvider::Stop();
+}
+
 // TODO(mrossetti): Implement this function. (Will happen in next CL.)
 void HistoryQuickProvider::DeleteMatch(const AutocompleteMatch& match) {}
 
-HistoryQuickProvider::~HistoryQuickProvider() {}
+HistoryQuickProvider::~HistoryQuickProvider() {
+  CancelScoringJob();
+}
 
-void HistoryQuickProvider::DoAutocomplete() {
-  // Get the matching URLs from the DB.
-  string16 term_string = autocomplete_input_.text();
-  ScoredHistoryMatches matches = GetIndex()->HistoryItemsForTerms(term_string);
+void HistoryQuickProvider::DoAutocomplete(
+    const ScoredHistoryMatches& matches) {
   if (matches.empty())
     return;
 
@@ -185,6 +198,37 @@ void HistoryQuickProvider::DoAutocomplete() {
   }
 }
 
+void HistoryQuickProvider::OnScoringDone(
+    base::TimeTicks start_time,
+    const ScoredHistoryMatches& matches) {
+  DCHECK(scoring_job_.get());
+  scoring_job_ = NULL;
+  DoAutocomplete(matches);
+  RecordQueryIndexTime(start_time);
+  UpdateStarredStateOfMatches();
+  done_ = true;
+  listener_->OnProviderUpdate(true);
+}
+
+void HistoryQuickProvider::RecordQueryIndexTime(base::TimeTicks start_time) {
+  size_t length = autocomplete_input_.text().length();
+  if (length >= 6)
+    return;
+  base::TimeTicks end_time = base::TimeTicks::Now();
+  std::string name = "HistoryQuickProvider.QueryIndexTime." +
+      base::IntToString(length);
+  base::Histogram* counter = base::Histogram::FactoryGet(
+      name, 1, 1000, 50, base::Histogram::kUmaTargetedHistogramFlag);
+  counter->Add(static_cast<int>((end_time - start_time).InMilliseconds()));
+}
+
+void HistoryQuickProvider::CancelScoringJob() {
+  if (!scoring_job_.get())
+    return;
+  scoring_job_->Cancel();
+  scoring_job_ = NULL;
+}
+
 AutocompleteMatch HistoryQuickProvider::QuickMatchToACMatch(
     const ScoredHistoryMatch& history_match,
     int score) {
@@ -8,10 +8,13 @@
 
 #include <string>
 
+#include "base/memory/ref_counted.h"
+#include "base/time.h"
 #include "chrome/browser/autocomplete/autocomplete_match.h"
 #include "chrome/browser/autocomplete/history_provider.h"
 #include "chrome/browser/history/history_types.h"
 #include "chrome/browser/history/in_memory_url_index.h"
+#include "chrome/browser/history/url_index_scoring_job.h"
 
 class Profile;
 class TermMatches;
@@ -24,10 +27,13 @@ class HistoryQuickProvider : public HistoryProvider {
  public:
   HistoryQuickProvider(ACProviderListener* listener, Profile* profile);
 
-  // AutocompleteProvider. |minimal_changes| is ignored since there
-  // is no asynch completion performed.
+  // AutocompleteProvider. |minimal_changes| is ignored since the index keeps
+  // its own cache of the candidates for each prefix of the input. When all
+  // matches are requested and there are many candidates, they are scored
+  // asynchronously on the blocking pool.
   virtual void Start(const AutocompleteInput& input,
                      bool minimal_changes) OVERRIDE;
+  virtual void Stop() OVERRIDE;
 
   virtual void DeleteMatch(const AutocompleteMatch& match) OVERRIDE;
 
@@ -45,8 +51,20 @@ class HistoryQuickProvider : public HistoryProvider {
 
   virtual ~HistoryQuickProvider();
 
-  // Performs the autocomplete matching and scoring.
-  void DoAutocomplete();
+  // Fills |matches_| with the scored |matches| from the index.
+  void DoAutocomplete(const history::ScoredHistoryMatches& matches);
+
+  // Called when |scoring_job_| finishes scoring the candidates of an
+  // asynchronous query which was started at |start_time|.
+  void OnScoringDone(base::TimeTicks start_time,
+                     const history::ScoredHistoryMatches& matches);
+
+  // Records how long the query for |autocomplete_input_| which was started at
+  // |start_time| took.
+  void RecordQueryIndexTime(base::TimeTicks start_time);
+
+  // Cancels |scoring_job_|, if any.
+  void CancelScoringJob();
 
   // Creates an AutocompleteMatch from |history_match|, assigning it
   // the score |score|.
@@ -72,6 +90,9 @@ class HistoryQuickProvider : public HistoryProvider {
   AutocompleteInput autocomplete_input_;
   std::string languages_;
 
+  // The job scoring the candidates of an asynchronous query, if any.
+  scoped_refptr<history::URLIndexScoringJob> scoring_job_;
+
   // Only used for testing.
   scoped_ptr<history::InMemoryURLIndex> index_for_testing_;
 
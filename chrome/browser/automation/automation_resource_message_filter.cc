@@ -7,6 +7,7 @@
 #include "base/bind.h"
 #include "base/metrics/histogram.h"
 #include "base/path_service.h"
+#include "base/process_util.h"
 #include "base/stl_util.h"
 #include "chrome/browser/automation/url_request_automation_job.h"
 #include "chrome/browser/content_settings/tab_specific_content_settings.h"
@@ -60,7 +61,8 @@ struct AutomationResourceMessageFilter::CookieCompletionInfo {
 };
 
 AutomationResourceMessageFilter::AutomationResourceMessageFilter()
-    : channel_(NULL) {
+    : channel_(NULL),
+      peer_handle_(base::kNullProcessHandle) {
   // Ensure that an instance of the callback map is created.
   completion_callback_map_.Get();
   // Ensure that an instance of the render view map is created.
@@ -72,6 +74,8 @@ AutomationResourceMessageFilter::AutomationResourceMessageFilter()
 }
 
 AutomationResourceMessageFilter::~AutomationResourceMessageFilter() {
+  if (peer_handle_ != base::kNullProcessHandle)
+    base::CloseProcessHandle(peer_handle_);
 }
 
 // Called on the IPC thread:
@@ -86,6 +90,12 @@ void AutomationResourceMessageFilter::OnFilterRemoved() {
 
 // Called on the IPC thread:
 void AutomationResourceMessageFilter::OnChannelConnected(int32 peer_pid) {
+  DCHECK_EQ(base::kNullProcessHandle, peer_handle_);
+  // Without the handle, requests send their data in messages.
+  if (!base::OpenProcessHandleWithAccess(
+          peer_pid, base::kProcessAccessDuplicateHandle, &peer_handle_)) {
+    peer_handle_ = base::kNullProcessHandle;
+  }
 }
 
 // Called on the IPC thread:
@@ -93,6 +103,11 @@ void AutomationResourceMessageFilter::OnChannelClosing() {
   channel_ = NULL;
   request_map_.clear();
 
+  if (peer_handle_ != base::kNullProcessHandle) {
+    base::CloseProcessHandle(peer_handle_);
+    peer_handle_ = base::kNullProcessHandle;
+  }
+
   // Only erase RenderViews which are associated with this
   // AutomationResourceMessageFilter instance.
   RenderViewMap::iterator index = filtered_render_views_.Get().begin();
@@ -12,6 +12,7 @@
 
 #include "base/atomicops.h"
 #include "base/lazy_instance.h"
+#include "base/process.h"
 #include "ipc/ipc_channel_proxy.h"
 #include "net/base/completion_callback.h"
 
@@ -72,6 +73,11 @@ class AutomationResourceMessageFilter
   // ResourceDispatcherHost::Receiver methods:
   virtual bool Send(IPC::Message* message);
 
+  // Returns a handle to the process at the other end of the automation
+  // channel, or base::kNullProcessHandle if it is not connected. Called on
+  // the IPC thread.
+  base::ProcessHandle peer_handle() const { return peer_handle_; }
+
   // Add request to the list of outstanding requests.
   virtual bool RegisterRequest(URLRequestAutomationJob* job);
 
@@ -184,6 +190,10 @@ class AutomationResourceMessageFilter
   // owned by this class.
   IPC::Channel* channel_;
 
+  // The process of the external host, which the shared memory used by
+  // requests is duplicated into.
+  base::ProcessHandle peer_handle_;
+
   // A unique request id per process.
   static int unique_request_id_;
 
@@ -108,6 +108,7 @@ bool ChromeFrameAutomationProvider::IsValidMessage(uint32 type) {
     case AutomationMsg_HandleMessageFromExternalHost::ID:
     case AutomationMsg_RequestStarted::ID:
     case AutomationMsg_RequestData::ID:
+    case AutomationMsg_RequestDataWritten::ID:
     case AutomationMsg_RequestEnd::ID:
     case AutomationMsg_SaveAsAsync::ID:
     case AutomationMsg_RemoveBrowsingData::ID:
@@ -9,6 +9,7 @@
 #include "base/message_loop.h"
 #include "base/time.h"
 #include "chrome/browser/automation/automation_resource_message_filter.h"
+#include "chrome/common/automation_data_ring.h"
 #include "chrome/common/automation_messages.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/render_view_host.h"
@@ -27,6 +28,13 @@ using base::TimeDelta;
 using content::BrowserThread;
 using content::ResourceRequestInfo;
 
+// Responses whose length is unknown or at least this large have their body
+// written to a shared memory ring of kDataRingSize bytes. Smaller ones fit in
+// a few AutomationMsg_RequestData messages, which is cheaper than setting up
+// the ring.
+static const int64 kMinDataRingContentLength = 64 * 1024;
+static const size_t kDataRingSize = 256 * 1024;
+
 // The list of filtered headers that are removed from requests sent via
 // StartAsync(). These must be lower case.
 static const char* const kFilteredHeaderStrings[] = {
@@ -63,6 +71,7 @@ URLRequestAutomationJob::URLRequestAutomationJob(
       redirect_status_(0),
       request_id_(request_id),
       is_pending_(is_pending),
+      data_ring_unread_(0),
       ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
   DVLOG(1) << "URLRequestAutomationJob create. Count: " << ++instance_count_;
   DCHECK(message_filter_ != NULL);
@@ -159,6 +168,13 @@ bool URLRequestAutomationJob::ReadRawData(
   // We should not receive a read request for a pending job.
   DCHECK(!is_pending());
 
+  // Data the external host wrote ahead of time is read without waiting for
+  // it, even after the request ended.
+  if (data_ring_unread_) {
+    *bytes_read = ReadFromDataRing(buf, buf_size);
+    return true;
+  }
+
   pending_buf_ = buf;
   pending_buf_size_ = buf_size;
 
@@ -250,6 +266,7 @@ bool URLRequestAutomationJob::MayFilterMessage(const IPC::Message& message,
   switch (message.type()) {
     case AutomationMsg_RequestStarted::ID:
     case AutomationMsg_RequestData::ID:
+    case AutomationMsg_RequestDataWritten::ID:
     case AutomationMsg_RequestEnd::ID: {
       PickleIterator iter(message);
       if (message.ReadInt(&iter, request_id))
@@ -275,6 +292,7 @@ void URLRequestAutomationJob::OnMessage(const IPC::Message& message) {
                            deserialize_success)
     IPC_MESSAGE_HANDLER(AutomationMsg_RequestStarted, OnRequestStarted)
     IPC_MESSAGE_HANDLER(AutomationMsg_RequestData, OnDataAvailable)
+    IPC_MESSAGE_HANDLER(AutomationMsg_RequestDataWritten, OnDataWritten)
     IPC_MESSAGE_HANDLER(AutomationMsg_RequestEnd, OnRequestEnd)
   IPC_END_MESSAGE_MAP_EX()
 
@@ -301,6 +319,11 @@ void URLRequestAutomationJob::OnRequestStarted(
                                           response.headers.size()));
   }
   socket_address_ = response.socket_address;
+
+  // The ring has to be handed out before the first read is requested.
+  if (redirect_url_.empty())
+    MaybeCreateDataRing(response.content_length);
+
   NotifyHeadersComplete();
 }
 
@@ -328,6 +351,30 @@ void URLRequestAutomationJob::OnDataAvailable(
   }
 }
 
+void URLRequestAutomationJob::OnDataWritten(int id, uint32 bytes_written) {
+  DVLOG(1) << "URLRequestAutomationJob: " << request_->url().spec()
+           << " - data written to ring, Size: " << bytes_written;
+  // Reading zero bytes would look like the end of the body.
+  if (!data_ring_.get() || !bytes_written ||
+      bytes_written > data_ring_->size() - data_ring_unread_) {
+    NOTREACHED() << "Received unexpected ring data of length:"
+                 << bytes_written;
+    return;
+  }
+  data_ring_unread_ += bytes_written;
+
+  if (pending_buf_ && pending_buf_->data()) {
+    // Clear the IO pending status of the read.
+    SetStatus(net::URLRequestStatus());
+
+    int bytes_read = ReadFromDataRing(pending_buf_, pending_buf_size_);
+    pending_buf_ = NULL;
+    pending_buf_size_ = 0;
+
+    NotifyReadComplete(bytes_read);
+  }
+}
+
 void URLRequestAutomationJob::OnRequestEnd(
     int id, const net::URLRequestStatus& status) {
 #ifndef NDEBUG
@@ -386,6 +433,9 @@ void URLRequestAutomationJob::Cleanup() {
 
   pending_buf_ = NULL;
   pending_buf_size_ = 0;
+
+  data_ring_.reset();
+  data_ring_unread_ = 0;
 }
 
 void URLRequestAutomationJob::StartAsync() {
@@ -493,3 +543,39 @@ void URLRequestAutomationJob::NotifyJobCompletionTask() {
     NotifyReadComplete(0);
   }
 }
+
+void URLRequestAutomationJob::MaybeCreateDataRing(int64 content_length) {
+  DCHECK(!data_ring_.get());
+  if (!message_filter_ ||
+      message_filter_->peer_handle() == base::kNullProcessHandle)
+    return;
+  if (content_length >= 0 && content_length < kMinDataRingContentLength)
+    return;
+
+  scoped_ptr<AutomationDataRing> ring(new AutomationDataRing);
+  base::SharedMemoryHandle handle;
+  if (!ring->Create(kDataRingSize) ||
+      !ring->ShareToProcess(message_filter_->peer_handle(), &handle)) {
+    return;
+  }
+  data_ring_.reset(ring.release());
+  message_filter_->Send(new AutomationMsg_RequestDataRing(
+      tab_, id_, handle, static_cast<uint32>(kDataRingSize)));
+}
+
+int URLRequestAutomationJob::ReadFromDataRing(net::IOBuffer* buf,
+                                              int buf_size) {
+  DCHECK_GT(buf_size, 0);
+  size_t bytes_read = std::min(data_ring_unread_,
+                               static_cast<size_t>(buf_size));
+  data_ring_->Read(buf->data(), bytes_read);
+  data_ring_unread_ -= bytes_read;
+
+  // Once the request ended nothing more is written, so there is no one left
+  // to tell.
+  if (message_filter_) {
+    message_filter_->Send(new AutomationMsg_RequestDataConsumed(
+        tab_, id_, static_cast<uint32>(bytes_read)));
+  }
+  return bytes_read;
+}
@@ -7,11 +7,13 @@
 #define CHROME_BROWSER_AUTOMATION_URL_REQUEST_AUTOMATION_JOB_H_
 #pragma once
 
+#include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "chrome/common/ref_counted_util.h"
 #include "net/url_request/url_request.h"
 #include "net/url_request/url_request_job.h"
 
+class AutomationDataRing;
 class AutomationResourceMessageFilter;
 struct AutomationURLResponse;
 
@@ -86,6 +88,7 @@ class URLRequestAutomationJob : public net::URLRequestJob {
   // IPC message handlers.
   void OnRequestStarted(int id, const AutomationURLResponse& response);
   void OnDataAvailable(int id, const std::string& bytes);
+  void OnDataWritten(int id, uint32 bytes_written);
   void OnRequestEnd(int id, const net::URLRequestStatus& status);
 
  private:
@@ -95,6 +98,14 @@ class URLRequestAutomationJob : public net::URLRequestJob {
   // function, which completes the job.
   void NotifyJobCompletionTask();
 
+  // Hands the external host a ring to write the body of a response of
+  // |content_length| bytes to, if it is large enough to be worth it.
+  void MaybeCreateDataRing(int64 content_length);
+
+  // Copies up to |buf_size| unread bytes from |data_ring_| to |buf| and lets
+  // the external host reuse their room. Returns how many were copied.
+  int ReadFromDataRing(net::IOBuffer* buf, int buf_size);
+
   int id_;
   int tab_;
   scoped_refptr<AutomationResourceMessageFilter> message_filter_;
@@ -128,6 +139,11 @@ class URLRequestAutomationJob : public net::URLRequestJob {
   // Contains the ip address and port of the destination host.
   net::HostPortPair socket_address_;
 
+  // The ring the external host writes the body to, if any, and how many of
+  // the bytes written to it were not read yet.
+  scoped_ptr<AutomationDataRing> data_ring_;
+  size_t data_ring_unread_;
+
   base::WeakPtrFactory<URLRequestAutomationJob> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(URLRequestAutomationJob);
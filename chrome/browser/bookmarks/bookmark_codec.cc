@@ -5,9 +5,15 @@
 #include "chrome/browser/bookmarks/bookmark_codec.h"
 
 #include <algorithm>
+#include <vector>
 
+#include "base/compiler_specific.h"
+#include "base/json/json_reader.h"
+#include "base/json/string_escape.h"
 #include "base/string_number_conversions.h"
+#include "base/string_piece.h"
 #include "base/string_util.h"
+#include "base/utf_string_conversions.h"
 #include "base/values.h"
 #include "chrome/browser/bookmarks/bookmark_model.h"
 #include "googleurl/src/gurl.h"
@@ -36,6 +42,397 @@ const char* BookmarkCodec::kTypeFolder = "folder";
 // Current version of the file.
 static const int kCurrentVersion = 1;
 
+namespace {
+
+#if defined(OS_WIN)
+const char kPrettyPrintLineEnding[] = "\r\n";
+#else
+const char kPrettyPrintLineEnding[] = "\n";
+#endif
+
+// Appends the indentation JSONWriter uses for pretty printing at |depth|.
+void AppendIndent(int depth, std::string* json) {
+  json->append(depth * 3, ' ');
+}
+
+// Appends the start of the dictionary member |key| at |depth|.
+void AppendKey(const char* key, int depth, std::string* json) {
+  AppendIndent(depth, json);
+  base::JsonDoubleQuote(key, true, json);
+  json->append(": ");
+}
+
+// Appends the separator between two dictionary members.
+void AppendMemberSeparator(std::string* json) {
+  json->append(",");
+  json->append(kPrettyPrintLineEnding);
+}
+
+// Appends the bytes of |str| the way BookmarkCodec::UpdateChecksum hashes
+// them.
+void AppendChecksumData(const string16& str, std::string* data) {
+  data->append(reinterpret_cast<const char*>(str.data()),
+               str.length() * sizeof(str[0]));
+}
+
+base::Time DateAddedFromString(const std::string& date_added_string) {
+  int64 internal_time;
+  base::StringToInt64(date_added_string, &internal_time);
+  base::Time date_added = base::Time::FromInternalValue(internal_time);
+#if !defined(OS_WIN)
+  // We changed the epoch for dates on Mac & Linux from 1970 to the Windows
+  // one of 1601. We assume any number we encounter from before 1970 is using
+  // the old format, so we need to add the delta to it.
+  //
+  // This code should be removed at some point:
+  // http://code.google.com/p/chromium/issues/detail?id=20264
+  if (date_added.ToInternalValue() <
+      base::Time::kWindowsEpochDeltaMicroseconds) {
+    date_added = base::Time::FromInternalValue(date_added.ToInternalValue() +
+        base::Time::kWindowsEpochDeltaMicroseconds);
+  }
+#endif
+  return date_added;
+}
+
+// Removes and deletes all the children of |node|.
+void RemoveChildren(BookmarkNode* node) {
+  while (node->child_count())
+    delete node->Remove(node->GetChild(node->child_count() - 1));
+}
+
+}  // namespace
+
+// Builds the nodes from the contents of a bookmarks file as JSONReader::Parse
+// reports them. A bookmark is decoded when its dictionary ends, or in the
+// case of a folder whose id, name and type come before its children, as
+// EncodeToString writes them, when its children begin. The checksum has to
+// cover the nodes in the order Decode visits them, so the checksum data of
+// the nodes in a folder that hasn't been decoded yet is held until it is.
+class BookmarkCodec::StreamingDecoder : public base::JSONReader::Delegate {
+ public:
+  StreamingDecoder(BookmarkCodec* codec,
+                   BookmarkNode* bb_node,
+                   BookmarkNode* other_folder_node,
+                   BookmarkNode* mobile_folder_node)
+      : codec_(codec),
+        bb_node_(bb_node),
+        other_folder_node_(other_folder_node),
+        mobile_folder_node_(mobile_folder_node),
+        skip_depth_(0),
+        version_(0),
+        decoded_bb_node_(false),
+        decoded_other_folder_node_(false),
+        decoded_mobile_folder_node_(false) {
+  }
+  virtual ~StreamingDecoder() {}
+
+  // Returns true if the file had the current version and both the bookmark
+  // bar and other folders.
+  bool Succeeded() const {
+    return version_ == kCurrentVersion && decoded_bb_node_ &&
+        decoded_other_folder_node_;
+  }
+
+  bool decoded_mobile_folder() const { return decoded_mobile_folder_node_; }
+
+  // base::JSONReader::Delegate:
+  virtual void OnObjectBegin() OVERRIDE {
+    if (skip_depth_) {
+      ++skip_depth_;
+      return;
+    }
+    if (frames_.empty()) {
+      frames_.push_back(Frame(FILE_FRAME, NULL, false));
+      return;
+    }
+    Frame& frame = frames_.back();
+    if (frame.type == FILE_FRAME && key_ == kRootsKey) {
+      frames_.push_back(Frame(ROOTS_FRAME, NULL, false));
+    } else if (frame.type == ROOTS_FRAME) {
+      BeginPermanentNode();
+    } else if (frame.type == CHILDREN_FRAME) {
+      frames_.push_back(Frame(NODE_FRAME, NULL, false));
+    } else {
+      skip_depth_ = 1;
+    }
+  }
+
+  virtual void OnObjectKey(const base::StringPiece& key) OVERRIDE {
+    if (!skip_depth_)
+      key.CopyToString(&key_);
+  }
+
+  virtual void OnObjectEnd() OVERRIDE {
+    if (skip_depth_) {
+      --skip_depth_;
+      return;
+    }
+    if (frames_.back().type == NODE_FRAME)
+      EndNode();
+    frames_.pop_back();
+  }
+
+  virtual void OnArrayBegin() OVERRIDE {
+    if (skip_depth_) {
+      ++skip_depth_;
+      return;
+    }
+    if (!frames_.empty() && frames_.back().type == NODE_FRAME &&
+        key_ == kChildrenKey) {
+      BeginChildren();
+    } else {
+      skip_depth_ = 1;
+    }
+  }
+
+  virtual void OnArrayEnd() OVERRIDE {
+    if (skip_depth_) {
+      --skip_depth_;
+      return;
+    }
+    DCHECK_EQ(CHILDREN_FRAME, frames_.back().type);
+    frames_.pop_back();
+  }
+
+  virtual void OnNull() OVERRIDE {}
+  virtual void OnBoolean(bool value) OVERRIDE {}
+
+  virtual void OnInteger(int value) OVERRIDE {
+    if (!skip_depth_ && !frames_.empty() &&
+        frames_.back().type == FILE_FRAME && key_ == kVersionKey) {
+      version_ = value;
+    }
+  }
+
+  virtual void OnDouble(double value) OVERRIDE {}
+
+  virtual void OnString(const base::StringPiece& value) OVERRIDE {
+    if (skip_depth_ || frames_.empty())
+      return;
+    Frame& frame = frames_.back();
+    if (frame.type == FILE_FRAME) {
+      if (key_ == kChecksumKey)
+        value.CopyToString(&codec_->stored_checksum_);
+      return;
+    }
+    if (frame.type != NODE_FRAME)
+      return;
+    if (key_ == kIdKey) {
+      value.CopyToString(&frame.id_string);
+      frame.has_id = true;
+    } else if (key_ == kNameKey) {
+      UTF8ToUTF16(value.data(), value.size(), &frame.title);
+      frame.has_name = true;
+    } else if (key_ == kDateAddedKey) {
+      value.CopyToString(&frame.date_added);
+    } else if (key_ == kDateModifiedKey) {
+      value.CopyToString(&frame.date_modified);
+    } else if (key_ == kTypeKey) {
+      value.CopyToString(&frame.type_string);
+    } else if (key_ == kURLKey) {
+      value.CopyToString(&frame.url_string);
+    }
+  }
+
+ private:
+  enum FrameType {
+    FILE_FRAME,      // The dictionary of the whole file.
+    ROOTS_FRAME,     // The dictionary of the permanent folders.
+    NODE_FRAME,      // The dictionary of a bookmark.
+    CHILDREN_FRAME,  // The list of the children of a folder.
+  };
+
+  // A dictionary or list being parsed.
+  struct Frame {
+    Frame(FrameType type, BookmarkNode* node, bool permanent)
+        : type(type),
+          node(node),
+          permanent(permanent),
+          has_id(false),
+          has_name(false),
+          has_children(false),
+          decoded(false) {
+    }
+
+    FrameType type;
+
+    // For a NODE_FRAME, the permanent node or the folder created once its
+    // children begin, and NULL until then otherwise. For a CHILDREN_FRAME,
+    // the folder the children are added to.
+    BookmarkNode* node;
+    bool permanent;
+
+    // The members of a NODE_FRAME read so far.
+    std::string id_string;
+    bool has_id;
+    string16 title;
+    bool has_name;
+    std::string date_added;
+    std::string date_modified;
+    std::string type_string;
+    std::string url_string;
+    bool has_children;
+
+    // Whether the node has been decoded and its checksum data added.
+    bool decoded;
+
+    // The checksum data of the nodes in this folder, held until it has been
+    // decoded.
+    std::string held_checksum_data;
+  };
+
+  void BeginPermanentNode() {
+    BookmarkNode* node = NULL;
+    if (key_ == kRootFolderNameKey && !decoded_bb_node_) {
+      node = bb_node_;
+      decoded_bb_node_ = true;
+    } else if (key_ == kOtherBookmarkFolderNameKey &&
+               !decoded_other_folder_node_) {
+      node = other_folder_node_;
+      decoded_other_folder_node_ = true;
+    } else if (key_ == kMobileBookmarkFolderNameKey &&
+               !decoded_mobile_folder_node_) {
+      node = mobile_folder_node_;
+      decoded_mobile_folder_node_ = true;
+    }
+    if (node)
+      frames_.push_back(Frame(NODE_FRAME, node, true));
+    else
+      skip_depth_ = 1;
+  }
+
+  void BeginChildren() {
+    Frame& frame = frames_.back();
+    if (frame.type_string == kTypeURL) {
+      // Only folders have children.
+      skip_depth_ = 1;
+      return;
+    }
+    frame.has_children = true;
+    if (!frame.node) {
+      // Create the folder now, even if it turns out not to be one, so there
+      // is something to add the children to.
+      frame.node = new BookmarkNode(0, GURL());
+      BookmarkNode* parent = GetParent();
+      parent->Add(frame.node, parent->child_count());
+    }
+    if (!frame.decoded && frame.has_id && frame.has_name &&
+        frame.type_string == kTypeFolder) {
+      DecodeNode();
+    }
+    BookmarkNode* folder = frame.node;
+    frames_.push_back(Frame(CHILDREN_FRAME, folder, false));
+  }
+
+  void EndNode() {
+    Frame& frame = frames_.back();
+    if (!frame.decoded && !DecodeNode()) {
+      if (frame.node && !frame.permanent)
+        delete GetParent()->Remove(frame.node);
+      return;
+    }
+    BookmarkNode* node = frame.node;
+    if (node->is_folder()) {
+      if (frame.date_modified.empty()) {
+        frame.date_modified =
+            base::Int64ToString(Time::Now().ToInternalValue());
+      }
+      int64 internal_time;
+      base::StringToInt64(frame.date_modified, &internal_time);
+      node->set_date_folder_modified(Time::FromInternalValue(internal_time));
+    }
+    if (frame.date_added.empty())
+      frame.date_added = base::Int64ToString(Time::Now().ToInternalValue());
+    node->SetTitle(frame.title);
+    node->set_date_added(DateAddedFromString(frame.date_added));
+  }
+
+  // Decodes the id and type of the innermost node and adds its checksum
+  // data, creating it if it's a url. Returns false if the node is invalid.
+  bool DecodeNode() {
+    Frame& frame = frames_.back();
+    int64 id = 0;
+    if (codec_->ids_valid_) {
+      if (!frame.has_id || !base::StringToInt64(frame.id_string, &id) ||
+          codec_->ids_.count(id) != 0) {
+        codec_->ids_valid_ = false;
+      } else {
+        codec_->ids_.insert(id);
+      }
+    }
+    codec_->maximum_id_ = std::max(codec_->maximum_id_, id);
+
+    std::string checksum_data(frame.id_string);
+    AppendChecksumData(frame.title, &checksum_data);
+    if (frame.type_string == kTypeURL) {
+      GURL url(frame.url_string);
+      if (frame.permanent || !url.is_valid())
+        return false;
+      frame.node = new BookmarkNode(id, url);
+      frame.node->set_type(BookmarkNode::URL);
+      BookmarkNode* parent = GetParent();
+      parent->Add(frame.node, parent->child_count());
+      checksum_data.append(kTypeURL);
+      checksum_data.append(frame.url_string);
+    } else if (frame.type_string == kTypeFolder) {
+      if (!frame.has_children)
+        return false;
+      frame.node->set_id(id);
+      frame.node->set_type(BookmarkNode::FOLDER);
+      checksum_data.append(kTypeFolder);
+    } else {
+      return false;  // Unknown type.
+    }
+    frame.decoded = true;
+    checksum_data.append(frame.held_checksum_data);
+    frame.held_checksum_data.clear();
+    AddChecksumData(checksum_data);
+    return true;
+  }
+
+  // Adds |data| to the checksum, or holds it in the innermost enclosing
+  // folder that hasn't been decoded yet.
+  void AddChecksumData(const std::string& data) {
+    for (size_t i = frames_.size() - 1; i-- > 0; ) {
+      if (frames_[i].type == NODE_FRAME && !frames_[i].decoded) {
+        frames_[i].held_checksum_data.append(data);
+        return;
+      }
+    }
+    codec_->UpdateChecksum(data);
+  }
+
+  // Returns the folder the innermost node is in.
+  BookmarkNode* GetParent() const {
+    DCHECK_GE(frames_.size(), 2u);
+    const Frame& parent = frames_[frames_.size() - 2];
+    DCHECK_EQ(CHILDREN_FRAME, parent.type);
+    return parent.node;
+  }
+
+  BookmarkCodec* codec_;
+  BookmarkNode* bb_node_;
+  BookmarkNode* other_folder_node_;
+  BookmarkNode* mobile_folder_node_;
+
+  // The dictionaries and lists being parsed, outermost first.
+  std::vector<Frame> frames_;
+
+  // The last key read in a dictionary that isn't being skipped.
+  std::string key_;
+
+  // The nesting depth of the value being skipped, or 0.
+  int skip_depth_;
+
+  int version_;
+  bool decoded_bb_node_;
+  bool decoded_other_folder_node_;
+  bool decoded_mobile_folder_node_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamingDecoder);
+};
+
 BookmarkCodec::BookmarkCodec()
     : ids_reassigned_(false),
       ids_valid_(true),
@@ -76,20 +473,79 @@ bool BookmarkCodec::Decode(BookmarkNode* bb_node,
                            BookmarkNode* mobile_folder_node,
                            int64* max_id,
                            const Value& value) {
-  ids_.clear();
-  ids_reassigned_ = false;
-  ids_valid_ = true;
-  maximum_id_ = 0;
-  stored_checksum_.clear();
-  InitializeChecksum();
+  InitializeDecoding();
   bool success = DecodeHelper(bb_node, other_folder_node, mobile_folder_node,
                               value);
+  FinalizeDecoding(bb_node, other_folder_node, mobile_folder_node, max_id);
+  return success;
+}
+
+void BookmarkCodec::EncodeToString(BookmarkModel* model, std::string* json) {
+  EncodeToString(model->bookmark_bar_node(), model->other_node(),
+                 model->mobile_node(), json);
+}
+
+void BookmarkCodec::EncodeToString(const BookmarkNode* bookmark_bar_node,
+                                   const BookmarkNode* other_folder_node,
+                                   const BookmarkNode* mobile_folder_node,
+                                   std::string* json) {
+  ids_reassigned_ = false;
+  InitializeChecksum();
+  json->clear();
+  // The roots go first, as the checksum is only known once they are written.
+  json->append("{");
+  json->append(kPrettyPrintLineEnding);
+  AppendKey(kRootsKey, 1, json);
+  json->append("{");
+  json->append(kPrettyPrintLineEnding);
+  AppendKey(kRootFolderNameKey, 2, json);
+  EncodeNodeToString(bookmark_bar_node, 2, json);
+  json->append(",");
+  json->append(kPrettyPrintLineEnding);
+  AppendKey(kOtherBookmarkFolderNameKey, 2, json);
+  EncodeNodeToString(other_folder_node, 2, json);
+  json->append(",");
+  json->append(kPrettyPrintLineEnding);
+  AppendKey(kMobileBookmarkFolderNameKey, 2, json);
+  EncodeNodeToString(mobile_folder_node, 2, json);
+  json->append(kPrettyPrintLineEnding);
+  AppendIndent(1, json);
+  json->append("},");
+  json->append(kPrettyPrintLineEnding);
+
   FinalizeChecksum();
-  // If either the checksums differ or some IDs were missing/not unique,
-  // reassign IDs.
-  if (!ids_valid_ || computed_checksum() != stored_checksum())
-    ReassignIDs(bb_node, other_folder_node, mobile_folder_node);
-  *max_id = maximum_id_ + 1;
+  stored_checksum_ = computed_checksum_;
+  AppendKey(kChecksumKey, 1, json);
+  base::JsonDoubleQuote(computed_checksum_, true, json);
+  json->append(",");
+  json->append(kPrettyPrintLineEnding);
+  AppendKey(kVersionKey, 1, json);
+  json->append(base::IntToString(kCurrentVersion));
+  json->append(kPrettyPrintLineEnding);
+  json->append("}");
+  json->append(kPrettyPrintLineEnding);
+}
+
+bool BookmarkCodec::DecodeString(BookmarkNode* bb_node,
+                                 BookmarkNode* other_folder_node,
+                                 BookmarkNode* mobile_folder_node,
+                                 int64* max_id,
+                                 const std::string& json) {
+  InitializeDecoding();
+  StreamingDecoder decoder(this, bb_node, other_folder_node,
+                           mobile_folder_node);
+  bool success = base::JSONReader::Parse(json, base::JSON_PARSE_RFC, &decoder,
+                                         NULL, NULL) &&
+      decoder.Succeeded();
+  if (success) {
+    ResetPermanentNodes(bb_node, other_folder_node, mobile_folder_node,
+                        decoder.decoded_mobile_folder());
+  } else {
+    RemoveChildren(bb_node);
+    RemoveChildren(other_folder_node);
+    RemoveChildren(mobile_folder_node);
+  }
+  FinalizeDecoding(bb_node, other_folder_node, mobile_folder_node, max_id);
   return success;
 }
 
@@ -121,6 +577,58 @@ Value* BookmarkCodec::EncodeNode(const BookmarkNode* node) {
   return value;
 }
 
+void BookmarkCodec::EncodeNodeToString(const BookmarkNode* node,
+                                       int depth,
+                                       std::string* json) {
+  std::string id = base::Int64ToString(node->id());
+  const string16& title = node->GetTitle();
+  json->append("{");
+  json->append(kPrettyPrintLineEnding);
+  AppendKey(kDateAddedKey, depth + 1, json);
+  base::JsonDoubleQuote(
+      base::Int64ToString(node->date_added().ToInternalValue()), true, json);
+  AppendMemberSeparator(json);
+  if (!node->is_url()) {
+    AppendKey(kDateModifiedKey, depth + 1, json);
+    base::JsonDoubleQuote(
+        base::Int64ToString(node->date_folder_modified().ToInternalValue()),
+        true, json);
+    AppendMemberSeparator(json);
+  }
+  AppendKey(kIdKey, depth + 1, json);
+  base::JsonDoubleQuote(id, true, json);
+  AppendMemberSeparator(json);
+  AppendKey(kNameKey, depth + 1, json);
+  base::JsonDoubleQuote(title, true, json);
+  AppendMemberSeparator(json);
+  AppendKey(kTypeKey, depth + 1, json);
+  if (node->is_url()) {
+    base::JsonDoubleQuote(kTypeURL, true, json);
+    AppendMemberSeparator(json);
+    std::string url = node->url().possibly_invalid_spec();
+    AppendKey(kURLKey, depth + 1, json);
+    base::JsonDoubleQuote(UTF8ToUTF16(url), true, json);
+    UpdateChecksumWithUrlNode(id, title, url);
+  } else {
+    base::JsonDoubleQuote(kTypeFolder, true, json);
+    AppendMemberSeparator(json);
+    UpdateChecksumWithFolderNode(id, title);
+
+    // The children go last so the folder can be decoded before them.
+    AppendKey(kChildrenKey, depth + 1, json);
+    json->append("[ ");
+    for (int i = 0; i < node->child_count(); ++i) {
+      if (i != 0)
+        json->append(", ");
+      EncodeNodeToString(node->GetChild(i), depth + 1, json);
+    }
+    json->append(" ]");
+  }
+  json->append(kPrettyPrintLineEnding);
+  AppendIndent(depth, json);
+  json->append("}");
+}
+
 bool BookmarkCodec::DecodeHelper(BookmarkNode* bb_node,
                                  BookmarkNode* other_folder_node,
                                  BookmarkNode* mobile_folder_node,
@@ -169,20 +677,31 @@ bool BookmarkCodec::DecodeHelper(BookmarkNode* bb_node,
   // them to exist in order to be backwards-compatible with older versions of
   // chrome.
   Value* mobile_folder_value;
+  bool decoded_mobile_folder = false;
   if (roots_d_value->Get(kMobileBookmarkFolderNameKey, &mobile_folder_value) &&
       mobile_folder_value->GetType() == Value::TYPE_DICTIONARY) {
     DecodeNode(*static_cast<DictionaryValue*>(mobile_folder_value), NULL,
                mobile_folder_node);
-  } else {
-    // If we didn't find the mobile folder, we're almost guaranteed to have a
-    // duplicate id when we add the mobile folder. Consequently, if we don't
-    // intend to reassign ids in the future (ids_valid_ is still true), then at
-    // least reassign the mobile bookmarks to avoid it colliding with anything
-    // else.
-    if (ids_valid_)
-      ReassignIDsHelper(mobile_folder_node);
+    decoded_mobile_folder = true;
   }
 
+  ResetPermanentNodes(bb_node, other_folder_node, mobile_folder_node,
+                      decoded_mobile_folder);
+  return true;
+}
+
+void BookmarkCodec::ResetPermanentNodes(BookmarkNode* bb_node,
+                                        BookmarkNode* other_folder_node,
+                                        BookmarkNode* mobile_folder_node,
+                                        bool decoded_mobile_folder) {
+  // If we didn't find the mobile folder, we're almost guaranteed to have a
+  // duplicate id when we add the mobile folder. Consequently, if we don't
+  // intend to reassign ids in the future (ids_valid_ is still true), then at
+  // least reassign the mobile bookmarks to avoid it colliding with anything
+  // else.
+  if (!decoded_mobile_folder && ids_valid_)
+    ReassignIDsHelper(mobile_folder_node);
+
   // Need to reset the type as decoding resets the type to FOLDER. Similarly
   // we need to reset the title as the title is persisted and restored from
   // the file.
@@ -194,8 +713,6 @@ bool BookmarkCodec::DecodeHelper(BookmarkNode* bb_node,
       l10n_util::GetStringUTF16(IDS_BOOKMARK_BAR_OTHER_FOLDER_NAME));
   mobile_folder_node->SetTitle(
         l10n_util::GetStringUTF16(IDS_BOOKMARK_BAR_MOBILE_FOLDER_NAME));
-
-  return true;
 }
 
 bool BookmarkCodec::DecodeChildren(const ListValue& child_value_list,
@@ -243,22 +760,7 @@ bool BookmarkCodec::DecodeNode(const DictionaryValue& value,
   std::string date_added_string;
   if (!value.GetString(kDateAddedKey, &date_added_string))
     date_added_string = base::Int64ToString(Time::Now().ToInternalValue());
-  int64 internal_time;
-  base::StringToInt64(date_added_string, &internal_time);
-  base::Time date_added = base::Time::FromInternalValue(internal_time);
-#if !defined(OS_WIN)
-  // We changed the epoch for dates on Mac & Linux from 1970 to the Windows
-  // one of 1601. We assume any number we encounter from before 1970 is using
-  // the old format, so we need to add the delta to it.
-  //
-  // This code should be removed at some point:
-  // http://code.google.com/p/chromium/issues/detail?id=20264
-  if (date_added.ToInternalValue() <
-      base::Time::kWindowsEpochDeltaMicroseconds) {
-    date_added = base::Time::FromInternalValue(date_added.ToInternalValue() +
-        base::Time::kWindowsEpochDeltaMicroseconds);
-  }
-#endif
+  base::Time date_added = DateAddedFromString(date_added_string);
 
   std::string type_string;
   if (!value.GetString(kTypeKey, &type_string))
@@ -320,6 +822,27 @@ bool BookmarkCodec::DecodeNode(const DictionaryValue& value,
   return true;
 }
 
+void BookmarkCodec::InitializeDecoding() {
+  ids_.clear();
+  ids_reassigned_ = false;
+  ids_valid_ = true;
+  maximum_id_ = 0;
+  stored_checksum_.clear();
+  InitializeChecksum();
+}
+
+void BookmarkCodec::FinalizeDecoding(BookmarkNode* bb_node,
+                                     BookmarkNode* other_folder_node,
+                                     BookmarkNode* mobile_folder_node,
+                                     int64* max_id) {
+  FinalizeChecksum();
+  // If either the checksums differ or some IDs were missing/not unique,
+  // reassign IDs.
+  if (!ids_valid_ || computed_checksum() != stored_checksum())
+    ReassignIDs(bb_node, other_folder_node, mobile_folder_node);
+  *max_id = maximum_id_ + 1;
+}
+
 void BookmarkCodec::ReassignIDs(BookmarkNode* bb_node,
                                 BookmarkNode* other_node,
                                 BookmarkNode* mobile_node) {
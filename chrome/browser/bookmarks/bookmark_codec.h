@@ -3,8 +3,8 @@
 // found in the LICENSE file.
 
 // BookmarkCodec is responsible for encoding and decoding the BookmarkModel
-// into JSON values. The encoded values are written to disk via the
-// BookmarkService.
+// into JSON values, or straight to and from JSON text. The encoded values are
+// written to disk via the BookmarkService.
 
 #ifndef CHROME_BROWSER_BOOKMARKS_BOOKMARK_CODEC_H_
 #define CHROME_BROWSER_BOOKMARKS_BOOKMARK_CODEC_H_
@@ -63,6 +63,26 @@ class BookmarkCodec {
               int64* max_node_id,
               const base::Value& value);
 
+  // Encodes the model as pretty printed JSON to |json| the way serializing
+  // the value from Encode() would, but without building the value first. The
+  // children of each folder are written last so that DecodeString can
+  // checksum the file as it reads it.
+  void EncodeToString(BookmarkModel* model, std::string* json);
+  void EncodeToString(const BookmarkNode* bookmark_bar_node,
+                      const BookmarkNode* other_folder_node,
+                      const BookmarkNode* mobile_folder_node,
+                      std::string* json);
+
+  // Decodes JSON written by EncodeToString, or by serializing the value from
+  // Encode(), straight to the specified nodes without building a value. This
+  // is otherwise the same as Decode, except that if |json| can't be parsed or
+  // has an unexpected version all children are removed from the nodes.
+  bool DecodeString(BookmarkNode* bb_node,
+                    BookmarkNode* other_folder_node,
+                    BookmarkNode* mobile_folder_node,
+                    int64* max_node_id,
+                    const std::string& json);
+
   // Returns the checksum computed during last encoding/decoding call.
   const std::string& computed_checksum() const { return computed_checksum_; }
 
@@ -97,10 +117,36 @@ class BookmarkCodec {
   static const char* kTypeFolder;
 
  private:
+  // Receives the contents of the JSON passed to DecodeString.
+  class StreamingDecoder;
+
   // Encodes node and all its children into a Value object and returns it.
   // The caller takes ownership of the returned object.
   base::Value* EncodeNode(const BookmarkNode* node);
 
+  // Appends node and all its children to |json|, indented for |depth|.
+  void EncodeNodeToString(const BookmarkNode* node,
+                          int depth,
+                          std::string* json);
+
+  // Resets the decoding state before Decode or DecodeString.
+  void InitializeDecoding();
+
+  // Finalizes the checksum, reassigns the IDs if need be and sets |max_id|
+  // after Decode or DecodeString.
+  void FinalizeDecoding(BookmarkNode* bb_node,
+                        BookmarkNode* other_folder_node,
+                        BookmarkNode* mobile_folder_node,
+                        int64* max_id);
+
+  // Restores the types and titles of the permanent nodes, which decoding
+  // resets. If the file had no mobile folder, gives it an id which won't
+  // collide with the decoded ones.
+  void ResetPermanentNodes(BookmarkNode* bb_node,
+                           BookmarkNode* other_folder_node,
+                           BookmarkNode* mobile_folder_node,
+                           bool decoded_mobile_folder);
+
   // Helper to perform decoding.
   bool DecodeHelper(BookmarkNode* bb_node,
                     BookmarkNode* other_folder_node,
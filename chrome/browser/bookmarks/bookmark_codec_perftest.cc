@@ -0,0 +1,134 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares saving and loading bookmarks by way of a Value tree, as
+// BookmarkStorage used to, with encoding and decoding the JSON directly.
+
+#include <string>
+
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/perftimer.h"
+#include "base/process_util.h"
+#include "base/stringprintf.h"
+#include "base/utf_string_conversions.h"
+#include "base/values.h"
+#include "chrome/browser/bookmarks/bookmark_codec.h"
+#include "chrome/browser/bookmarks/bookmark_model.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kNumBookmarks = 100000;
+const int kBookmarksPerFolder = 100;
+
+// Returns the working set of this process, in bytes.
+size_t GetWorkingSetSize() {
+#if defined(OS_MACOSX)
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle(), NULL));
+#else
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle()));
+#endif
+  return metrics->GetWorkingSetSize();
+}
+
+BookmarkNode* AsMutable(const BookmarkNode* node) {
+  return const_cast<BookmarkNode*>(node);
+}
+
+}  // namespace
+
+class BookmarkCodecPerfTest : public testing::Test {
+ protected:
+  BookmarkCodecPerfTest() : model_(NULL) {}
+
+  virtual void SetUp() {
+    const BookmarkNode* folder = NULL;
+    for (int i = 0; i < kNumBookmarks; ++i) {
+      if (i % kBookmarksPerFolder == 0) {
+        const BookmarkNode* parent = model_.bookmark_bar_node();
+        folder = model_.AddFolder(parent, parent->child_count(),
+            UTF8ToUTF16(base::StringPrintf("Folder %d", i)));
+      }
+      model_.AddURL(folder, folder->child_count(),
+          UTF8ToUTF16(base::StringPrintf("News site%d article %d", i % 1000,
+                                         i)),
+          GURL(base::StringPrintf("http://www.site%d.com/article%d.html",
+                                  i % 1000, i)));
+    }
+  }
+
+  // Logs the growth of the working set since |before| as |name|.
+  void LogWorkingSet(const std::string& name, size_t before) {
+    LogPerfResult(name.c_str(),
+                  (static_cast<double>(GetWorkingSetSize()) - before) / 1024,
+                  "kb");
+  }
+
+  bool DecodeValue(BookmarkModel* model, const std::string& json) {
+    scoped_ptr<Value> value(base::JSONReader::Read(json));
+    if (!value.get())
+      return false;
+    BookmarkCodec codec;
+    int64 max_id;
+    return codec.Decode(AsMutable(model->bookmark_bar_node()),
+                        AsMutable(model->other_node()),
+                        AsMutable(model->mobile_node()), &max_id,
+                        *value.get());
+  }
+
+  bool DecodeString(BookmarkModel* model, const std::string& json) {
+    BookmarkCodec codec;
+    int64 max_id;
+    return codec.DecodeString(AsMutable(model->bookmark_bar_node()),
+                              AsMutable(model->other_node()),
+                              AsMutable(model->mobile_node()), &max_id, json);
+  }
+
+  BookmarkModel model_;
+};
+
+TEST_F(BookmarkCodecPerfTest, Value) {
+  std::string json;
+  size_t before = GetWorkingSetSize();
+  {
+    PerfTimeLogger timer("BookmarkCodec_value_save");
+    BookmarkCodec codec;
+    scoped_ptr<Value> value(codec.Encode(&model_));
+    base::JSONWriter::WriteWithOptions(
+        value.get(), base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+    LogWorkingSet("BookmarkCodec_value_save_working_set", before);
+  }
+
+  BookmarkModel model(NULL);
+  before = GetWorkingSetSize();
+  PerfTimeLogger timer("BookmarkCodec_value_load");
+  ASSERT_TRUE(DecodeValue(&model, json));
+  timer.Done();
+  LogWorkingSet("BookmarkCodec_value_load_working_set", before);
+}
+
+TEST_F(BookmarkCodecPerfTest, String) {
+  std::string json;
+  size_t before = GetWorkingSetSize();
+  {
+    PerfTimeLogger timer("BookmarkCodec_string_save");
+    BookmarkCodec codec;
+    codec.EncodeToString(&model_, &json);
+    LogWorkingSet("BookmarkCodec_string_save_working_set", before);
+  }
+
+  BookmarkModel model(NULL);
+  before = GetWorkingSetSize();
+  PerfTimeLogger timer("BookmarkCodec_string_load");
+  ASSERT_TRUE(DecodeString(&model, json));
+  timer.Done();
+  LogWorkingSet("BookmarkCodec_string_load_working_set", before);
+}
@@ -5,6 +5,8 @@
 #include "base/file_path.h"
 #include "base/file_util.h"
 #include "base/json/json_file_value_serializer.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/path_service.h"
 #include "base/string_util.h"
@@ -154,6 +156,18 @@ class BookmarkCodecTest : public testing::Test {
     return model.release();
   }
 
+  bool DecodeString(BookmarkCodec* codec,
+                    BookmarkModel* model,
+                    const std::string& json) {
+    int64 max_id;
+    bool result = codec->DecodeString(AsMutable(model->bookmark_bar_node()),
+                                      AsMutable(model->other_node()),
+                                      AsMutable(model->mobile_node()),
+                                      &max_id, json);
+    model->set_next_node_id(max_id);
+    return result;
+  }
+
   void CheckIDs(const BookmarkNode* node, std::set<int64>* assigned_ids) {
     DCHECK(node);
     int64 node_id = node->id();
@@ -336,3 +350,88 @@ TEST_F(BookmarkCodecTest, CanDecodeModelWithoutMobileBookmarks) {
 
   ASSERT_TRUE(decoded_model.mobile_node() != NULL);
 }
+
+TEST_F(BookmarkCodecTest, EncodeToStringMatchesEncode) {
+  scoped_ptr<BookmarkModel> model(CreateTestModel3());
+  BookmarkCodec encoder;
+  scoped_ptr<Value> value(encoder.Encode(model.get()));
+
+  BookmarkCodec string_encoder;
+  std::string json;
+  string_encoder.EncodeToString(model.get(), &json);
+  EXPECT_EQ(encoder.computed_checksum(), string_encoder.computed_checksum());
+  EXPECT_EQ(string_encoder.computed_checksum(),
+            string_encoder.stored_checksum());
+
+  scoped_ptr<Value> read_value(base::JSONReader::Read(json));
+  ASSERT_TRUE(read_value.get() != NULL);
+  EXPECT_TRUE(value->Equals(read_value.get()));
+}
+
+TEST_F(BookmarkCodecTest, DecodeString) {
+  scoped_ptr<BookmarkModel> model_to_encode(CreateTestModel3());
+  BookmarkCodec encoder;
+  std::string json;
+  encoder.EncodeToString(model_to_encode.get(), &json);
+
+  BookmarkModel decoded_model(NULL);
+  BookmarkCodec decoder;
+  ASSERT_TRUE(DecodeString(&decoder, &decoded_model, json));
+  EXPECT_EQ(encoder.computed_checksum(), decoder.stored_checksum());
+  EXPECT_EQ(decoder.stored_checksum(), decoder.computed_checksum());
+  EXPECT_FALSE(decoder.ids_reassigned());
+  BookmarkModelTestUtils::AssertModelsEqual(model_to_encode.get(),
+                                            &decoded_model,
+                                            true);
+}
+
+// Files written from the value have the children of each folder before its
+// id, name and type, which DecodeString has to checksum in the same order.
+TEST_F(BookmarkCodecTest, DecodeStringWrittenFromValue) {
+  scoped_ptr<BookmarkModel> model_to_encode(CreateTestModel3());
+  std::string enc_checksum;
+  scoped_ptr<Value> value(EncodeHelper(model_to_encode.get(), &enc_checksum));
+  std::string json;
+  base::JSONWriter::WriteWithOptions(value.get(),
+                                     base::JSONWriter::OPTIONS_PRETTY_PRINT,
+                                     &json);
+
+  BookmarkModel decoded_model(NULL);
+  BookmarkCodec decoder;
+  ASSERT_TRUE(DecodeString(&decoder, &decoded_model, json));
+  EXPECT_EQ(enc_checksum, decoder.stored_checksum());
+  EXPECT_EQ(enc_checksum, decoder.computed_checksum());
+  EXPECT_FALSE(decoder.ids_reassigned());
+  BookmarkModelTestUtils::AssertModelsEqual(model_to_encode.get(),
+                                            &decoded_model,
+                                            true);
+
+  // A changed title changes the checksum, as with Decode.
+  DictionaryValue* child_value;
+  GetBookmarksBarChildValue(value.get(), 0, &child_value);
+  child_value->SetString(BookmarkCodec::kNameKey, "changed");
+  base::JSONWriter::WriteWithOptions(value.get(),
+                                     base::JSONWriter::OPTIONS_PRETTY_PRINT,
+                                     &json);
+  BookmarkModel changed_model(NULL);
+  BookmarkCodec changed_decoder;
+  ASSERT_TRUE(DecodeString(&changed_decoder, &changed_model, json));
+  EXPECT_NE(changed_decoder.stored_checksum(),
+            changed_decoder.computed_checksum());
+  ExpectIDsUnique(&changed_model);
+}
+
+TEST_F(BookmarkCodecTest, DecodeStringRejectsTruncatedFile) {
+  scoped_ptr<BookmarkModel> model_to_encode(CreateTestModel3());
+  BookmarkCodec encoder;
+  std::string json;
+  encoder.EncodeToString(model_to_encode.get(), &json);
+
+  BookmarkModel decoded_model(NULL);
+  BookmarkCodec decoder;
+  EXPECT_FALSE(DecodeString(&decoder, &decoded_model,
+                            json.substr(0, json.size() / 2)));
+  EXPECT_EQ(0, decoded_model.bookmark_bar_node()->child_count());
+  EXPECT_EQ(0, decoded_model.other_node()->child_count());
+  EXPECT_EQ(0, decoded_model.mobile_node()->child_count());
+}
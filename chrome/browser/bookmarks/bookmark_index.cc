@@ -5,10 +5,9 @@
 #include "chrome/browser/bookmarks/bookmark_index.h"
 
 #include <algorithm>
-#include <iterator>
-#include <list>
 
 #include "base/i18n/case_conversion.h"
+#include "base/logging.h"
 #include "base/string16.h"
 #include "chrome/browser/bookmarks/bookmark_model.h"
 #include "chrome/browser/bookmarks/bookmark_utils.h"
@@ -17,40 +16,28 @@
 #include "chrome/browser/profiles/profile.h"
 #include "ui/base/l10n/l10n_util.h"
 
-// Used when finding the set of bookmarks that match a query. Each match
-// represents a set of terms (as an interator into the Index) matching the
-// query as well as the set of nodes that contain those terms in their titles.
-struct BookmarkIndex::Match {
-  // List of terms matching the query.
-  std::list<Index::const_iterator> terms;
+namespace {
 
-  // The set of nodes matching the terms. As an optimization this is empty
-  // when we match only one term, and is filled in when we get more than one
-  // term. We can do this as when we have only one matching term we know
-  // the set of matching nodes is terms.front()->second.
-  //
-  // Use nodes_begin() and nodes_end() to get an iterator over the set as
-  // it handles the necessary switching between nodes and terms.front().
-  NodeSet nodes;
-
-  // Returns an iterator to the beginning of the matching nodes. See
-  // description of nodes for why this should be used over nodes.begin().
-  NodeSet::const_iterator nodes_begin() const;
-
-  // Returns an iterator to the beginning of the matching nodes. See
-  // description of nodes for why this should be used over nodes.end().
-  NodeSet::const_iterator nodes_end() const;
-};
-
-BookmarkIndex::NodeSet::const_iterator
-    BookmarkIndex::Match::nodes_begin() const {
-  return nodes.empty() ? terms.front()->second.begin() : nodes.begin();
+// Adds |id| to |bitset|, which must be big enough to hold it.
+void AddToBitset(uint32 id, std::vector<uint64>* bitset) {
+  (*bitset)[id / 64] |= GG_UINT64_C(1) << (id % 64);
 }
 
-BookmarkIndex::NodeSet::const_iterator BookmarkIndex::Match::nodes_end() const {
-  return nodes.empty() ? terms.front()->second.end() : nodes.end();
+// Sets |bitset| to its intersection with |other|, which is the same size.
+// Returns true if the intersection isn't empty.
+bool IntersectBitsets(const std::vector<uint64>& other,
+                      std::vector<uint64>* bitset) {
+  DCHECK_EQ(other.size(), bitset->size());
+  uint64 any = 0;
+  for (size_t i = 0; i < bitset->size(); ++i) {
+    (*bitset)[i] &= other[i];
+    any |= (*bitset)[i];
+  }
+  return any != 0;
 }
 
+}  // namespace
+
 BookmarkIndex::BookmarkIndex(Profile* profile) : profile_(profile) {
 }
 
@@ -61,17 +48,36 @@ void BookmarkIndex::Add(const BookmarkNode* node) {
   if (!node->is_url())
     return;
   std::vector<string16> terms = ExtractQueryWords(node->GetTitle());
+  if (terms.empty() || node_ids_.count(node))
+    return;
+
+  NodeID id;
+  if (free_node_ids_.empty()) {
+    id = static_cast<NodeID>(nodes_.size());
+    nodes_.push_back(node);
+  } else {
+    id = free_node_ids_.back();
+    free_node_ids_.pop_back();
+    nodes_[id] = node;
+  }
+  node_ids_[node] = id;
   for (size_t i = 0; i < terms.size(); ++i)
-    RegisterNode(terms[i], node);
+    RegisterNode(terms[i], id);
 }
 
 void BookmarkIndex::Remove(const BookmarkNode* node) {
   if (!node->is_url())
     return;
+  std::map<const BookmarkNode*, NodeID>::iterator id = node_ids_.find(node);
+  if (id == node_ids_.end())
+    return;
 
   std::vector<string16> terms = ExtractQueryWords(node->GetTitle());
   for (size_t i = 0; i < terms.size(); ++i)
-    UnregisterNode(terms[i], node);
+    UnregisterNode(terms[i], id->second);
+  nodes_[id->second] = NULL;
+  free_node_ids_.push_back(id->second);
+  node_ids_.erase(id);
 }
 
 void BookmarkIndex::GetBookmarksWithTitlesMatching(
@@ -82,9 +88,14 @@ void BookmarkIndex::GetBookmarksWithTitlesMatching(
   if (terms.empty())
     return;
 
-  Matches matches;
+  NodeBitset matches;
   for (size_t i = 0; i < terms.size(); ++i) {
-    if (!GetBookmarksWithTitleMatchingTerm(terms[i], i == 0, &matches))
+    NodeBitset term_matches;
+    if (!GetBookmarksWithTitleMatchingTerm(terms[i], &term_matches))
+      return;
+    if (i == 0)
+      matches.swap(term_matches);
+    else if (!IntersectBitsets(term_matches, &matches))
       return;
   }
 
@@ -108,7 +119,7 @@ void BookmarkIndex::GetBookmarksWithTitlesMatching(
     AddMatchToResults(i->first, &parser, query_nodes.get(), results);
 }
 
-void BookmarkIndex::SortMatches(const Matches& matches,
+void BookmarkIndex::SortMatches(const NodeBitset& matches,
                                 NodeTypedCountPairs* node_typed_counts) const {
   HistoryService* const history_service = profile_ ?
       profile_->GetHistoryService(Profile::EXPLICIT_ACCESS) : NULL;
@@ -116,28 +127,24 @@ void BookmarkIndex::SortMatches(const Matches& matches,
   history::URLDatabase* url_db = history_service ?
       history_service->InMemoryDatabase() : NULL;
 
-  for (Matches::const_iterator i = matches.begin(); i != matches.end(); ++i)
-    ExtractBookmarkNodePairs(url_db, *i, node_typed_counts);
+  for (size_t i = 0; i < matches.size(); ++i) {
+    if (!matches[i])
+      continue;
+    for (size_t bit = 0; bit < 64; ++bit) {
+      if (!(matches[i] & (GG_UINT64_C(1) << bit)))
+        continue;
+      const BookmarkNode* node = nodes_[i * 64 + bit];
+      history::URLRow url;
+      if (url_db)
+        url_db->GetRowForURL(node->url(), &url);
+      node_typed_counts->push_back(NodeTypedCountPair(node, url.typed_count()));
+    }
+  }
 
   std::sort(node_typed_counts->begin(), node_typed_counts->end(),
             &NodeTypedCountPairSortFunc);
 }
 
-void BookmarkIndex::ExtractBookmarkNodePairs(
-    history::URLDatabase* url_db,
-    const Match& match,
-    NodeTypedCountPairs* node_typed_counts) const {
-
-  for (NodeSet::const_iterator i = match.nodes_begin();
-       i != match.nodes_end(); ++i) {
-    history::URLRow url;
-    if (url_db)
-      url_db->GetRowForURL((*i)->url(), &url);
-    NodeTypedCountPair pair(*i, url.typed_count());
-    node_typed_counts->push_back(pair);
-  }
-}
-
 void BookmarkIndex::AddMatchToResults(
     const BookmarkNode* node,
     QueryParser* parser,
@@ -156,86 +163,36 @@ void BookmarkIndex::AddMatchToResults(
   }
 }
 
-bool BookmarkIndex::GetBookmarksWithTitleMatchingTerm(const string16& term,
-                                                      bool first_term,
-                                                      Matches* matches) {
+bool BookmarkIndex::GetBookmarksWithTitleMatchingTerm(
+    const string16& term,
+    NodeBitset* nodes) const {
   Index::const_iterator i = index_.lower_bound(term);
   if (i == index_.end())
     return false;
 
+  nodes->assign((nodes_.size() + 63) / 64, 0);
   if (!QueryParser::IsWordLongEnoughForPrefixSearch(term)) {
     // Term is too short for prefix match, compare using exact match.
     if (i->first != term)
       return false;  // No bookmarks with this term.
-
-    if (first_term) {
-      Match match;
-      match.terms.push_back(i);
-      matches->push_back(match);
-      return true;
-    }
-    CombineMatchesInPlace(i, matches);
-  } else if (first_term) {
-    // This is the first term and we're doing a prefix match. Loop through
-    // index adding all entries that start with term to matches.
-    while (i != index_.end() &&
-           i->first.size() >= term.size() &&
-           term.compare(0, term.size(), i->first, 0, term.size()) == 0) {
-      Match match;
-      match.terms.push_back(i);
-      matches->push_back(match);
-      ++i;
-    }
-  } else {
-    // Prefix match and not the first term. Loop through index combining
-    // current matches in matches with term, placing result in result.
-    Matches result;
-    while (i != index_.end() &&
-           i->first.size() >= term.size() &&
-           term.compare(0, term.size(), i->first, 0, term.size()) == 0) {
-      CombineMatches(i, *matches, &result);
-      ++i;
-    }
-    matches->swap(result);
+    for (NodeIDs::const_iterator j = i->second.begin(); j != i->second.end();
+         ++j)
+      AddToBitset(*j, nodes);
+    return true;
   }
-  return !matches->empty();
-}
 
-void BookmarkIndex::CombineMatchesInPlace(const Index::const_iterator& index_i,
-                                          Matches* matches) {
-  for (size_t i = 0; i < matches->size(); ) {
-    Match* match = &((*matches)[i]);
-    NodeSet intersection;
-    std::set_intersection(match->nodes_begin(), match->nodes_end(),
-                          index_i->second.begin(), index_i->second.end(),
-                          std::inserter(intersection, intersection.begin()));
-    if (intersection.empty()) {
-      matches->erase(matches->begin() + i);
-    } else {
-      match->terms.push_back(index_i);
-      match->nodes.swap(intersection);
-      ++i;
-    }
-  }
-}
-
-void BookmarkIndex::CombineMatches(const Index::const_iterator& index_i,
-                                   const Matches& current_matches,
-                                   Matches* result) {
-  for (size_t i = 0; i < current_matches.size(); ++i) {
-    const Match& match = current_matches[i];
-    NodeSet intersection;
-    std::set_intersection(match.nodes_begin(), match.nodes_end(),
-                          index_i->second.begin(), index_i->second.end(),
-                          std::inserter(intersection, intersection.begin()));
-    if (!intersection.empty()) {
-      result->push_back(Match());
-      Match& combined_match = result->back();
-      combined_match.terms = match.terms;
-      combined_match.terms.push_back(index_i);
-      combined_match.nodes.swap(intersection);
-    }
+  // Prefix match. Add the nodes of all entries that start with term.
+  bool found = false;
+  while (i != index_.end() &&
+         i->first.size() >= term.size() &&
+         term.compare(0, term.size(), i->first, 0, term.size()) == 0) {
+    for (NodeIDs::const_iterator j = i->second.begin(); j != i->second.end();
+         ++j)
+      AddToBitset(*j, nodes);
+    found = true;
+    ++i;
   }
+  return found;
 }
 
 std::vector<string16> BookmarkIndex::ExtractQueryWords(const string16& query) {
@@ -249,25 +206,27 @@ std::vector<string16> BookmarkIndex::ExtractQueryWords(const string16& query) {
   return terms;
 }
 
-void BookmarkIndex::RegisterNode(const string16& term,
-                                 const BookmarkNode* node) {
-  if (std::find(index_[term].begin(), index_[term].end(), node) !=
-      index_[term].end()) {
+void BookmarkIndex::RegisterNode(const string16& term, NodeID id) {
+  NodeIDs& ids = index_[term];
+  NodeIDs::iterator i = std::lower_bound(ids.begin(), ids.end(), id);
+  if (i != ids.end() && *i == id) {
     // We've already added node for term.
     return;
   }
-  index_[term].insert(node);
+  ids.insert(i, id);
 }
 
-void BookmarkIndex::UnregisterNode(const string16& term,
-                                   const BookmarkNode* node) {
+void BookmarkIndex::UnregisterNode(const string16& term, NodeID id) {
   Index::iterator i = index_.find(term);
   if (i == index_.end()) {
     // We can get here if the node has the same term more than once. For
     // example, a bookmark with the title 'foo foo' would end up here.
     return;
   }
-  i->second.erase(node);
+  NodeIDs::iterator j = std::lower_bound(i->second.begin(), i->second.end(),
+                                         id);
+  if (j != i->second.end() && *j == id)
+    i->second.erase(j);
   if (i->second.empty())
     index_.erase(i);
 }
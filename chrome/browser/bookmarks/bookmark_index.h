@@ -7,7 +7,6 @@
 #pragma once
 
 #include <map>
-#include <set>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -30,9 +29,11 @@ class URLDatabase;
 // look up. BookmarkIndex is owned and maintained by BookmarkModel, you
 // shouldn't need to interact directly with BookmarkIndex.
 //
-// BookmarkIndex maintains the index (index_) as a map of sets. The map (type
-// Index) maps from a lower case string to the set (type NodeSet) of
-// BookmarkNodes that contain that string in their title.
+// Each indexed BookmarkNode is given a small integer id. The index (index_)
+// maps from a lower case word to the sorted ids (type NodeIDs) of the
+// BookmarkNodes that contain that word in their title. A query finds the
+// nodes matching each of its terms as a bitset over the ids, and intersects
+// the bitsets of the terms.
 
 class BookmarkIndex {
  public:
@@ -52,30 +53,25 @@ class BookmarkIndex {
       std::vector<bookmark_utils::TitleMatch>* results);
 
  private:
-  typedef std::set<const BookmarkNode*> NodeSet;
-  typedef std::map<string16, NodeSet> Index;
+  typedef uint32 NodeID;
+  typedef std::vector<NodeID> NodeIDs;
+  typedef std::map<string16, NodeIDs> Index;
 
-  struct Match;
-  typedef std::vector<Match> Matches;
+  // A set of NodeIDs, with bit |id % 64| of element |id / 64| set for each id
+  // in the set.
+  typedef std::vector<uint64> NodeBitset;
 
   // Pairs BookmarkNodes and the number of times the nodes' URLs were typed.
-  // Used to sort Matches in decreasing order of typed count.
+  // Used to sort the matching nodes in decreasing order of typed count.
   typedef std::pair<const BookmarkNode*, int> NodeTypedCountPair;
   typedef std::vector<NodeTypedCountPair> NodeTypedCountPairs;
 
-  // Extracts |matches.nodes| into NodeTypedCountPairs and sorts the pairs in
-  // decreasing order of typed count.
-  void SortMatches(const Matches& matches,
+  // Extracts the nodes in |matches| into NodeTypedCountPairs, retrieving the
+  // typed count of each node from the in-memory database, and sorts the pairs
+  // in decreasing order of typed count.
+  void SortMatches(const NodeBitset& matches,
                    NodeTypedCountPairs* node_typed_counts) const;
 
-  // Extracts BookmarkNodes from |match| and retrieves typed counts for each
-  // node from the in-memory database. Inserts pairs containing the node and
-  // typed count into the vector |node_typed_counts|. |node_typed_counts| is
-  // sorted in decreasing order of typed count.
-  void ExtractBookmarkNodePairs(history::URLDatabase* url_db,
-                                const Match& match,
-                                NodeTypedCountPairs* node_typed_counts) const;
-
   // Sort function for NodeTypedCountPairs. We sort in decreasing order of typed
   // count so that the best matches will always be added to the results.
   static bool NodeTypedCountPairSortFunc(const NodeTypedCountPair& a,
@@ -89,45 +85,29 @@ class BookmarkIndex {
                          const std::vector<QueryNode*>& query_nodes,
                          std::vector<bookmark_utils::TitleMatch>* results);
 
-  // Populates |matches| for the specified term. If |first_term| is true, this
-  // is the first term in the query. Returns true if there is at least one node
-  // matching the term.
+  // Sets |nodes| to the nodes with a word in their title matching |term|:
+  // equal to it if it is too short for a prefix search, otherwise starting
+  // with it. Returns true if there is at least one such node.
   bool GetBookmarksWithTitleMatchingTerm(const string16& term,
-                                         bool first_term,
-                                         Matches* matches);
-
-  // Iterates over |matches| updating each Match's nodes to contain the
-  // intersection of the Match's current nodes and the nodes at |index_i|.
-  // If the intersection is empty, the Match is removed.
-  //
-  // This is invoked from GetBookmarksWithTitleMatchingTerm.
-  void CombineMatchesInPlace(const Index::const_iterator& index_i,
-                             Matches* matches);
-
-  // Iterates over |current_matches| calculating the intersection between the
-  // Match's nodes and the nodes at |index_i|. If the intersection between the
-  // two is non-empty, a new match is added to |result|.
-  //
-  // This differs from CombineMatchesInPlace in that if the intersection is
-  // non-empty the result is added to result, not combined in place. This
-  // variant is used for prefix matching.
-  //
-  // This is invoked from GetBookmarksWithTitleMatchingTerm.
-  void CombineMatches(const Index::const_iterator& index_i,
-                      const Matches& current_matches,
-                      Matches* result);
+                                         NodeBitset* nodes) const;
 
   // Returns the set of query words from |query|.
   std::vector<string16> ExtractQueryWords(const string16& query);
 
-  // Adds |node| to |index_|.
-  void RegisterNode(const string16& term, const BookmarkNode* node);
+  // Adds |id| to the nodes of |term| in |index_|.
+  void RegisterNode(const string16& term, NodeID id);
 
-  // Removes |node| from |index_|.
-  void UnregisterNode(const string16& term, const BookmarkNode* node);
+  // Removes |id| from the nodes of |term| in |index_|.
+  void UnregisterNode(const string16& term, NodeID id);
 
   Index index_;
 
+  // The node each id was given to, indexed by NodeID. Ids which are not in use
+  // map to NULL, and are listed in |free_node_ids_| to be given out again.
+  std::vector<const BookmarkNode*> nodes_;
+  std::map<const BookmarkNode*, NodeID> node_ids_;
+  std::vector<NodeID> free_node_ids_;
+
   Profile* profile_;
 
   DISALLOW_COPY_AND_ASSIGN(BookmarkIndex);
@@ -0,0 +1,170 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares the BookmarkIndex, which keeps sorted node ids per word and
+// intersects bitsets, with the map of node sets it used to keep, which merged
+// and intersected temporary sets for every query.
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/i18n/case_conversion.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/perftimer.h"
+#include "base/process_util.h"
+#include "base/stringprintf.h"
+#include "base/utf_string_conversions.h"
+#include "chrome/browser/bookmarks/bookmark_index.h"
+#include "chrome/browser/bookmarks/bookmark_model.h"
+#include "chrome/browser/bookmarks/bookmark_utils.h"
+#include "chrome/browser/history/query_parser.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kNumBookmarks = 200000;
+const size_t kMaxMatches = 50;
+
+const char* kQueries[] = { "art", "article 12", "topic4", "news site3",
+                           "site12 topic7 article", "xyz" };
+
+// Returns the working set of this process, in bytes.
+size_t GetWorkingSetSize() {
+#if defined(OS_MACOSX)
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle(), NULL));
+#else
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle()));
+#endif
+  return metrics->GetWorkingSetSize();
+}
+
+std::vector<string16> ExtractWords(const string16& text) {
+  std::vector<string16> words;
+  QueryParser parser;
+  parser.ParseQueryWords(base::i18n::ToLower(text), &words);
+  return words;
+}
+
+// The index as BookmarkIndex used to keep it: a map from each word to the set
+// of nodes with the word in their title.
+class MapOfSetsIndex {
+ public:
+  MapOfSetsIndex() {}
+
+  void Add(const BookmarkNode* node) {
+    std::vector<string16> words(ExtractWords(node->GetTitle()));
+    for (size_t i = 0; i < words.size(); ++i)
+      index_[words[i]].insert(node);
+  }
+
+  // Adds up to |max_count| nodes matching |query| to |results|, matching each
+  // term as a prefix like BookmarkIndex.
+  void GetBookmarksWithTitlesMatching(
+      const string16& query,
+      size_t max_count,
+      std::vector<bookmark_utils::TitleMatch>* results) const {
+    std::vector<string16> terms(ExtractWords(query));
+    NodeSet matches;
+    for (size_t i = 0; i < terms.size(); ++i) {
+      NodeSet term_matches;
+      for (Index::const_iterator j = index_.lower_bound(terms[i]);
+           j != index_.end() && j->first.compare(0, terms[i].size(),
+                                                 terms[i]) == 0; ++j) {
+        term_matches.insert(j->second.begin(), j->second.end());
+      }
+      if (i == 0) {
+        matches.swap(term_matches);
+      } else {
+        NodeSet intersection;
+        std::set_intersection(
+            matches.begin(), matches.end(), term_matches.begin(),
+            term_matches.end(),
+            std::inserter(intersection, intersection.begin()));
+        matches.swap(intersection);
+      }
+      if (matches.empty())
+        return;
+    }
+
+    QueryParser parser;
+    ScopedVector<QueryNode> query_nodes;
+    parser.ParseQueryNodes(query, &query_nodes.get());
+    for (NodeSet::const_iterator i = matches.begin();
+         i != matches.end() && results->size() < max_count; ++i) {
+      bookmark_utils::TitleMatch title_match;
+      if (parser.DoesQueryMatch((*i)->GetTitle(), query_nodes.get(),
+                                &(title_match.match_positions))) {
+        title_match.node = *i;
+        results->push_back(title_match);
+      }
+    }
+  }
+
+ private:
+  typedef std::set<const BookmarkNode*> NodeSet;
+  typedef std::map<string16, NodeSet> Index;
+
+  Index index_;
+
+  DISALLOW_COPY_AND_ASSIGN(MapOfSetsIndex);
+};
+
+}  // namespace
+
+class BookmarkIndexPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    for (int i = 0; i < kNumBookmarks; ++i) {
+      BookmarkNode* node = new BookmarkNode(i + 1, GURL(base::StringPrintf(
+          "http://www.site%d.com/article%d.html", i % 1000, i)));
+      node->SetTitle(UTF8ToUTF16(base::StringPrintf(
+          "News site%d article %d about topic%d", i % 1000, i, i % 500)));
+      nodes_.push_back(node);
+    }
+  }
+
+  // Times adding all the nodes to |index| and the memory it takes as |name|,
+  // then times the queries.
+  template <class Index>
+  void TimeIndex(Index* index, const std::string& name) {
+    size_t before = GetWorkingSetSize();
+    {
+      PerfTimeLogger timer((name + "_add").c_str());
+      for (size_t i = 0; i < nodes_.size(); ++i)
+        index->Add(nodes_[i]);
+    }
+    LogPerfResult((name + "_working_set").c_str(),
+                  (static_cast<double>(GetWorkingSetSize()) - before) / 1024,
+                  "kb");
+
+    PerfTimeLogger timer((name + "_queries").c_str());
+    for (size_t i = 0; i < arraysize(kQueries); ++i) {
+      std::vector<bookmark_utils::TitleMatch> matches;
+      index->GetBookmarksWithTitlesMatching(ASCIIToUTF16(kQueries[i]),
+                                            kMaxMatches, &matches);
+    }
+  }
+
+  ScopedVector<BookmarkNode> nodes_;
+};
+
+TEST_F(BookmarkIndexPerfTest, MapOfSets) {
+  MapOfSetsIndex index;
+  TimeIndex(&index, "BookmarkIndex_map_of_sets");
+}
+
+TEST_F(BookmarkIndexPerfTest, NodeIDs) {
+  BookmarkIndex index(NULL);
+  TimeIndex(&index, "BookmarkIndex_node_ids");
+}
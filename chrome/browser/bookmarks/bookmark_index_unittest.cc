@@ -184,6 +184,25 @@ TEST_F(BookmarkIndexTest, Remove) {
   ExpectMatches("A", NULL, 0U);
 }
 
+// Makes sure the nodes added after others were removed are found, and the
+// removed ones aren't.
+TEST_F(BookmarkIndexTest, AddAfterRemove) {
+  const char* input[] = { "abcd", "abce", "abcf" };
+  AddBookmarksWithTitles(input, ARRAYSIZE_UNSAFE(input));
+
+  model_->Remove(model_->other_node(), 1);
+  model_->Remove(model_->other_node(), 0);
+  const char* more_input[] = { "abcg", "xyz abch" };
+  AddBookmarksWithTitles(more_input, ARRAYSIZE_UNSAFE(more_input));
+
+  ExpectMatches("abcd", NULL, 0U);
+  ExpectMatches("abce", NULL, 0U);
+  const char* expected[] = { "abcf", "abcg", "xyz abch" };
+  ExpectMatches("abc", expected, ARRAYSIZE_UNSAFE(expected));
+  const char* expected_xyz[] = { "xyz abch" };
+  ExpectMatches("xyz abc", expected_xyz, ARRAYSIZE_UNSAFE(expected_xyz));
+}
+
 // Makes sure index is updated when a node's title is changed.
 TEST_F(BookmarkIndexTest, ChangeTitle) {
   const char* input[] = { "a", "b" };
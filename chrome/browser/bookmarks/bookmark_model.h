@@ -501,4 +501,24 @@ class BookmarkModel : public content::NotificationObserver,
   DISALLOW_COPY_AND_ASSIGN(BookmarkModel);
 };
 
+// Brackets its lifetime with BeginExtensiveChanges() and EndExtensiveChanges()
+// on |model|, so that a batch of changes that may return early still ends the
+// extensive changes it began.
+class ScopedExtensiveBookmarkChanges {
+ public:
+  explicit ScopedExtensiveBookmarkChanges(BookmarkModel* model)
+      : model_(model) {
+    model_->BeginExtensiveChanges();
+  }
+
+  ~ScopedExtensiveBookmarkChanges() {
+    model_->EndExtensiveChanges();
+  }
+
+ private:
+  BookmarkModel* model_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedExtensiveBookmarkChanges);
+};
+
 #endif  // CHROME_BROWSER_BOOKMARKS_BOOKMARK_MODEL_H_
@@ -1163,4 +1163,17 @@ TEST_F(BookmarkModelTest, MultipleExtensiveChangesObserver) {
   AssertExtensiveChangesObserverCount(1, 1);
 }
 
+TEST_F(BookmarkModelTest, ScopedExtensiveChanges) {
+  {
+    ScopedExtensiveBookmarkChanges extensive_changes(&model_);
+    EXPECT_TRUE(model_.IsDoingExtensiveChanges());
+    AssertExtensiveChangesObserverCount(1, 0);
+    model_.AddURL(model_.bookmark_bar_node(), 0, ASCIIToUTF16("foo"),
+                  GURL("http://foo.com"));
+    AssertExtensiveChangesObserverCount(1, 0);
+  }
+  EXPECT_FALSE(model_.IsDoingExtensiveChanges());
+  AssertExtensiveChangesObserverCount(1, 1);
+}
+
 }  // namespace
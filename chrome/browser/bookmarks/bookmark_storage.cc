@@ -8,8 +8,6 @@
 #include "base/compiler_specific.h"
 #include "base/file_util.h"
 #include "base/file_util_proxy.h"
-#include "base/json/json_file_value_serializer.h"
-#include "base/json/json_string_value_serializer.h"
 #include "base/metrics/histogram.h"
 #include "base/time.h"
 #include "chrome/browser/bookmarks/bookmark_codec.h"
@@ -52,18 +50,16 @@ void LoadCallback(const FilePath& path,
                   BookmarkStorage* storage,
                   BookmarkLoadDetails* details) {
   bool bookmark_file_exists = file_util::PathExists(path);
-  if (bookmark_file_exists) {
-    JSONFileValueSerializer serializer(path);
-    scoped_ptr<Value> root(serializer.Deserialize(NULL, NULL));
-
-    if (root.get()) {
-      // Building the index can take a while, so we do it on the background
-      // thread.
-      int64 max_node_id = 0;
-      BookmarkCodec codec;
-      TimeTicks start_time = TimeTicks::Now();
-      codec.Decode(details->bb_node(), details->other_folder_node(),
-                   details->mobile_folder_node(), &max_node_id, *root.get());
+  std::string contents;
+  if (bookmark_file_exists && file_util::ReadFileToString(path, &contents)) {
+    // The nodes are decoded straight from the file contents, without building
+    // a Value for the whole file first.
+    int64 max_node_id = 0;
+    BookmarkCodec codec;
+    TimeTicks start_time = TimeTicks::Now();
+    if (codec.DecodeString(details->bb_node(), details->other_folder_node(),
+                           details->mobile_folder_node(), &max_node_id,
+                           contents)) {
       details->set_max_id(std::max(max_node_id, details->max_id()));
       details->set_computed_checksum(codec.computed_checksum());
       details->set_stored_checksum(codec.stored_checksum());
@@ -71,6 +67,8 @@ void LoadCallback(const FilePath& path,
       UMA_HISTOGRAM_TIMES("Bookmarks.DecodeTime",
                           TimeTicks::Now() - start_time);
 
+      // Building the index can take a while, so we do it on the background
+      // thread.
       start_time = TimeTicks::Now();
       AddBookmarksToIndex(details, details->bb_node());
       AddBookmarksToIndex(details, details->other_folder_node());
@@ -183,10 +181,8 @@ void BookmarkStorage::BookmarkModelDeleted() {
 
 bool BookmarkStorage::SerializeData(std::string* output) {
   BookmarkCodec codec;
-  scoped_ptr<Value> value(codec.Encode(model_));
-  JSONStringValueSerializer serializer(output);
-  serializer.set_pretty_print(true);
-  return serializer.Serialize(*(value.get()));
+  codec.EncodeToString(model_, output);
+  return true;
 }
 
 void BookmarkStorage::OnLoadFinished(bool file_exists, const FilePath& path) {
@@ -41,11 +41,11 @@ class TabCloseableStateWatcher;
 class ThumbnailGenerator;
 class WatchDogThread;
 
-#if defined(OS_CHROMEOS)
+#if !defined(OS_ANDROID)
 namespace browser {
 class OomPriorityManager;
 }
-#endif  // defined(OS_CHROMEOS)
+#endif  // !defined(OS_ANDROID)
 
 namespace net {
 class URLRequestContextGetter;
@@ -97,10 +97,10 @@ class BrowserProcess {
   virtual ui::Clipboard* clipboard() = 0;
   virtual net::URLRequestContextGetter* system_request_context() = 0;
 
-#if defined(OS_CHROMEOS)
+#if !defined(OS_ANDROID)
   // Returns the out-of-memory priority manager.
   virtual browser::OomPriorityManager* oom_priority_manager() = 0;
-#endif  // defined(OS_CHROMEOS)
+#endif  // !defined(OS_ANDROID)
 
   virtual ExtensionEventRouterForwarder*
       extension_event_router_forwarder() = 0;
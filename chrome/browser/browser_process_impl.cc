@@ -13,6 +13,7 @@
 #include "base/command_line.h"
 #include "base/debug/alias.h"
 #include "base/file_util.h"
+#include "base/metrics/field_trial.h"
 #include "base/path_service.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/threading/thread.h"
@@ -91,9 +92,9 @@
 #include "ui/aura/env.h"
 #endif
 
-#if defined(OS_CHROMEOS)
+#if !defined(OS_ANDROID)
 #include "chrome/browser/oom_priority_manager.h"
-#endif  // defined(OS_CHROMEOS)
+#endif  // !defined(OS_ANDROID)
 
 #if (defined(OS_WIN) || defined(OS_LINUX)) && !defined(OS_CHROMEOS)
 // How often to check if the persistent instance of Chrome needs to restart
@@ -396,14 +397,14 @@ net::URLRequestContextGetter* BrowserProcessImpl::system_request_context() {
   return io_thread()->system_url_request_context_getter();
 }
 
-#if defined(OS_CHROMEOS)
+#if !defined(OS_ANDROID)
 browser::OomPriorityManager* BrowserProcessImpl::oom_priority_manager() {
   DCHECK(CalledOnValidThread());
   if (!oom_priority_manager_.get())
     oom_priority_manager_.reset(new browser::OomPriorityManager());
   return oom_priority_manager_.get();
 }
-#endif  // defined(OS_CHROMEOS)
+#endif  // !defined(OS_ANDROID)
 
 ExtensionEventRouterForwarder*
 BrowserProcessImpl::extension_event_router_forwarder() {
@@ -664,6 +665,9 @@ void BrowserProcessImpl::ResourceDispatcherHostCreated() {
       new ChromeResourceDispatcherHostDelegate(prerender_tracker()));
   ResourceDispatcherHost::Get()->SetDelegate(
       resource_dispatcher_host_delegate_.get());
+  // See ChromeBrowserMainParts::ResourceSchedulerFieldTrial().
+  ResourceDispatcherHost::Get()->SetResourceSchedulingEnabled(
+      base::FieldTrialList::FindFullName("ResourceScheduler") != "disabled");
 
   pref_change_registrar_.Add(prefs::kAllowCrossOriginAuthPrompt, this);
   ApplyAllowCrossOriginAuthPromptPolicy();
@@ -70,9 +70,9 @@ class BrowserProcessImpl : public BrowserProcess,
   virtual PrefService* local_state() OVERRIDE;
   virtual ui::Clipboard* clipboard() OVERRIDE;
   virtual net::URLRequestContextGetter* system_request_context() OVERRIDE;
-#if defined(OS_CHROMEOS)
+#if !defined(OS_ANDROID)
   virtual browser::OomPriorityManager* oom_priority_manager() OVERRIDE;
-#endif  // defined(OS_CHROMEOS)
+#endif  // !defined(OS_ANDROID)
   virtual ExtensionEventRouterForwarder*
         extension_event_router_forwarder() OVERRIDE;
   virtual NotificationUIManager* notification_ui_manager() OVERRIDE;
@@ -254,7 +254,7 @@ class BrowserProcessImpl : public BrowserProcess,
   void RestartBackgroundInstance();
 #endif  // defined(OS_WIN) || defined(OS_LINUX)
 
-#if defined(OS_CHROMEOS)
+#if !defined(OS_ANDROID)
   scoped_ptr<browser::OomPriorityManager> oom_priority_manager_;
 #endif
 
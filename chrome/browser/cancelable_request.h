@@ -559,6 +559,12 @@ class CancelableRequestBase
     return canceled_.IsSet();
   }
 
+  // The flag behind canceled(), for long-running work which wants to check it
+  // as it goes.
+  const base::CancellationFlag* canceled_flag() const {
+    return &canceled_;
+  }
+
  protected:
   friend class base::RefCountedThreadSafe<CancelableRequestBase>;
   virtual ~CancelableRequestBase();
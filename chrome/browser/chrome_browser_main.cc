@@ -61,6 +61,7 @@
 #include "chrome/browser/net/predictor.h"
 #include "chrome/browser/notifications/desktop_notification_service.h"
 #include "chrome/browser/notifications/desktop_notification_service_factory.h"
+#include "chrome/browser/oom_priority_manager.h"
 #include "chrome/browser/plugin_prefs.h"
 #include "chrome/browser/prefs/pref_service.h"
 #include "chrome/browser/prefs/pref_value_store.h"
@@ -78,6 +79,7 @@
 #include "chrome/browser/search_engines/template_url_service_factory.h"
 #include "chrome/browser/service/service_process_control.h"
 #include "chrome/browser/shell_integration.h"
+#include "chrome/browser/startup_task_scheduler.h"
 #include "chrome/browser/translate/translate_manager.h"
 #include "chrome/browser/ui/browser.h"
 #include "chrome/browser/ui/browser_init.h"
@@ -107,6 +109,8 @@
 #include "grit/chromium_strings.h"
 #include "grit/generated_resources.h"
 #include "grit/platform_locale_settings.h"
+#include "grit/theme_resources.h"
+#include "grit/theme_resources_standard.h"
 #include "net/base/net_module.h"
 #include "net/base/sdch_manager.h"
 #include "net/base/ssl_config_service.h"
@@ -120,6 +124,7 @@
 #include "net/spdy/spdy_session_pool.h"
 #include "net/url_request/url_request.h"
 #include "net/websockets/websocket_job.h"
+#include "sql/connection.h"
 #include "ui/base/l10n/l10n_util.h"
 #include "ui/base/resource/resource_bundle.h"
 #include "ui/base/resource/resource_handle.h"
@@ -186,6 +191,11 @@ using content::BrowserThread;
 
 namespace {
 
+// The heap all the SQLite databases of the browser process may use together,
+// most of it for page caches.  The history database alone asks for a 24MB
+// cache.
+const int64 kSqliteMemoryBudget = 32 * 1024 * 1024;
+
 // This function provides some ways to test crash and assertion handling
 // behavior of the program.
 void HandleTestParameters(const CommandLine& command_line) {
@@ -509,6 +519,26 @@ bool HasImportSwitch(const CommandLine& command_line) {
           command_line.HasSwitch(switches::kImportFromFile));
 }
 
+#if !defined(OS_MACOSX)
+// The images painted in the toolbar of the first browser window.
+const int kStartupImageIds[] = {
+  IDR_BACK,
+  IDR_BACK_D,
+  IDR_FORWARD,
+  IDR_FORWARD_D,
+  IDR_RELOAD,
+  IDR_HOME,
+  IDR_TOOLS,
+  IDR_CONTENT_TOP_CENTER,
+};
+
+void PreloadStartupImages() {
+  std::vector<int> resource_ids(
+      kStartupImageIds, kStartupImageIds + arraysize(kStartupImageIds));
+  ResourceBundle::GetSharedInstance().PreloadImages(resource_ids);
+}
+#endif
+
 }  // namespace
 
 namespace chrome_browser {
@@ -1038,6 +1068,19 @@ void ChromeBrowserMainParts::DomainBoundCertsFieldTrial() {
   }
 }
 
+// The resource dispatcher host reads the group when it is created, and the
+// renderers split their time to first paint histograms by it.
+void ChromeBrowserMainParts::ResourceSchedulerFieldTrial() {
+  const base::FieldTrial::Probability kDivisor = 100;
+  // 10% probability of being in the disabled group.
+  const base::FieldTrial::Probability kDisableProbability = 10;
+  // After January 30, 2013 builds, it will always be in default group.
+  scoped_refptr<base::FieldTrial> trial(
+      base::FieldTrialList::FactoryGetFieldTrial(
+          "ResourceScheduler", kDivisor, "enabled", 2013, 1, 30, NULL));
+  trial->AppendGroup("disabled", kDisableProbability);
+}
+
 void ChromeBrowserMainParts::SetupUniformityFieldTrials() {
   // One field trial will be created for each entry in this array. The i'th
   // field trial will have |trial_sizes[i]| groups in it, including the default
@@ -1090,6 +1133,7 @@ void ChromeBrowserMainParts::SetupFieldTrials(bool metrics_recording_enabled,
   DefaultAppsFieldTrial();
   AutoLaunchChromeFieldTrial();
   DomainBoundCertsFieldTrial();
+  ResourceSchedulerFieldTrial();
   SetupUniformityFieldTrials();
   AutocompleteFieldTrial::Activate();
   NewTabUI::SetupFieldTrials();
@@ -1213,6 +1257,11 @@ int ChromeBrowserMainParts::PreCreateThreadsImpl() {
   // unlocked in PostBrowserStart().
   process_singleton_->Lock(NULL);
 
+  // Share one budget between the page caches of all databases, so that idle
+  // databases give their memory to busy ones.  This must happen before any
+  // database is opened.
+  sql::Connection::SetSharedCacheLimit(kSqliteMemoryBudget);
+
   is_first_run_ =
       (first_run::IsChromeFirstRun() ||
           parsed_command_line().HasSwitch(switches::kFirstRun)) &&
@@ -1427,6 +1476,12 @@ void ChromeBrowserMainParts::PostProfileInit() {
 void ChromeBrowserMainParts::PreBrowserStart() {
   for (size_t i = 0; i < chrome_extra_parts_.size(); ++i)
     chrome_extra_parts_[i]->PreBrowserStart();
+
+#if !defined(OS_CHROMEOS) && !defined(OS_ANDROID)
+  // Chrome OS always starts the OomPriorityManager itself.
+  if (parsed_command_line().HasSwitch(switches::kEnableTabDiscarding))
+    g_browser_process->oom_priority_manager()->Start();
+#endif
 }
 
 void ChromeBrowserMainParts::PostBrowserStart() {
@@ -1436,6 +1491,66 @@ void ChromeBrowserMainParts::PostBrowserStart() {
   process_singleton_->Unlock();
 }
 
+void ChromeBrowserMainParts::AddDeferredStartupTasks() {
+  startup_task_scheduler_->AddTask(
+      "StartGoogleServices", StartupTaskScheduler::AFTER_FIRST_PAINT,
+      StartupTaskScheduler::UI_THREAD,
+      base::Bind(&ChromeBrowserMainParts::StartGoogleServices,
+                 base::Unretained(this)));
+  startup_task_scheduler_->AddTask(
+      "RecordStartupMetrics", StartupTaskScheduler::AFTER_FIRST_PAINT,
+      StartupTaskScheduler::UI_THREAD,
+      base::Bind(&ChromeBrowserMainParts::RecordStartupMetrics,
+                 base::Unretained(this)));
+
+  // Create the instance of the cloud print proxy service so that it can launch
+  // the service process if needed. This is needed because the service process
+  // might have shutdown because an update was available.
+  // TODO(torne): this should maybe be done with
+  // ProfileKeyedServiceFactory::ServiceIsCreatedWithProfile() instead?
+#if !defined(OS_ANDROID)
+  startup_task_scheduler_->AddTask(
+      "CreateCloudPrintProxyService", StartupTaskScheduler::IDLE,
+      StartupTaskScheduler::UI_THREAD,
+      base::Bind(
+          base::IgnoreResult(&CloudPrintProxyServiceFactory::GetForProfile),
+          profile_));
+#endif
+}
+
+void ChromeBrowserMainParts::StartGoogleServices() {
+  // In unittest mode, this will do nothing.  In normal mode, this will create
+  // the global GoogleURLTracker and IntranetRedirectDetector instances, which
+  // will promptly go to sleep for five and seven seconds, respectively (to
+  // avoid slowing startup), and wake up afterwards to see if they should do
+  // anything else.
+  //
+  // These can't be created in the BrowserProcessImpl constructor because they
+  // need to read prefs that get set after that runs.
+  browser_process_->google_url_tracker();
+  browser_process_->intranet_redirect_detector();
+}
+
+void ChromeBrowserMainParts::RecordStartupMetrics() {
+  RecordBreakpadStatusUMA(browser_process_->metrics_service());
+#if !defined(OS_ANDROID)
+  about_flags::RecordUMAStatistics(local_state_);
+#endif
+  LanguageUsageMetrics::RecordAcceptLanguages(
+      profile_->GetPrefs()->GetString(prefs::kAcceptLanguages));
+  LanguageUsageMetrics::RecordApplicationLanguage(
+      browser_process_->GetApplicationLocale());
+}
+
+void ChromeBrowserMainParts::FetchTranslateLanguageList() {
+  // If we're running tests (ui_task is non-null), then we don't want to
+  // call FetchLanguageListFromTranslateServer
+  if (parameters().ui_task == NULL && translate_manager_ != NULL) {
+    translate_manager_->FetchLanguageListFromTranslateServer(
+        profile_->GetPrefs());
+  }
+}
+
 int ChromeBrowserMainParts::PreMainMessageLoopRunImpl() {
   // Now that the file thread has been started, start recording.
   StartMetricsRecording();
@@ -1448,6 +1563,16 @@ int ChromeBrowserMainParts::PreMainMessageLoopRunImpl() {
   // running.
   browser_process_->PreMainMessageLoopRun();
 
+#if !defined(OS_MACOSX)
+  // Decode the toolbar images on the file thread while the profile loads,
+  // rather than on the UI thread as the first browser window is painted. Mac
+  // loads them as NSImages instead.
+  if (!parameters().ui_task) {
+    BrowserThread::PostTask(BrowserThread::FILE, FROM_HERE,
+                            base::Bind(&PreloadStartupImages));
+  }
+#endif
+
   // Record last shutdown time into a histogram.
   browser_shutdown::ReadLastShutdownInfo();
 
@@ -1676,20 +1801,11 @@ int ChromeBrowserMainParts::PreMainMessageLoopRunImpl() {
   // Configure modules that need access to resources.
   net::NetModule::SetResourceProvider(chrome_common_net::NetResourceProvider);
 
-  // In unittest mode, this will do nothing.  In normal mode, this will create
-  // the global GoogleURLTracker and IntranetRedirectDetector instances, which
-  // will promptly go to sleep for five and seven seconds, respectively (to
-  // avoid slowing startup), and wake up afterwards to see if they should do
-  // anything else.
-  //
-  // A simpler way of doing all this would be to have some function which could
-  // give the time elapsed since startup, and simply have these objects check
-  // that when asked to initialize themselves, but this doesn't seem to exist.
-  //
-  // These can't be created in the BrowserProcessImpl constructor because they
-  // need to read prefs that get set after that runs.
-  browser_process_->google_url_tracker();
-  browser_process_->intranet_redirect_detector();
+  // Work that the first window does not need is added here and started by
+  // Start() below, once the initial browser windows are open.
+  startup_task_scheduler_.reset(new StartupTaskScheduler());
+  AddDeferredStartupTasks();
+
   GoogleSearchCounter::RegisterForNotifications();
 
   // Disable SDCH filtering if switches::kEnableSdch is 0.
@@ -1731,14 +1847,6 @@ int ChromeBrowserMainParts::PreMainMessageLoopRunImpl() {
 #endif
 
   HandleTestParameters(parsed_command_line());
-  RecordBreakpadStatusUMA(browser_process_->metrics_service());
-#if !defined(OS_ANDROID)
-  about_flags::RecordUMAStatistics(local_state_);
-#endif
-  LanguageUsageMetrics::RecordAcceptLanguages(
-      profile_->GetPrefs()->GetString(prefs::kAcceptLanguages));
-  LanguageUsageMetrics::RecordApplicationLanguage(
-      browser_process_->GetApplicationLocale());
 
   // The extension service may be available at this point. If the command line
   // specifies --uninstall-extension, attempt the uninstall extension startup
@@ -1764,15 +1872,6 @@ int ChromeBrowserMainParts::PreMainMessageLoopRunImpl() {
   record_search_engine_ = is_first_run_ && !profile_->IsOffTheRecord();
 #endif
 
-  // Create the instance of the cloud print proxy service so that it can launch
-  // the service process if needed. This is needed because the service process
-  // might have shutdown because an update was available.
-  // TODO(torne): this should maybe be done with
-  // ProfileKeyedServiceFactory::ServiceIsCreatedWithProfile() instead?
-#if !defined(OS_ANDROID)
-  CloudPrintProxyServiceFactory::GetForProfile(profile_);
-#endif
-
   // Load GPU Blacklist.
   InitializeGpuDataManager(parsed_command_line());
 
@@ -1825,8 +1924,13 @@ int ChromeBrowserMainParts::PreMainMessageLoopRunImpl() {
       upgrade_util::SaveLastModifiedTimeOfExe();
 #endif
 
-      // Record now as the last successful chrome start.
-      GoogleUpdateSettings::SetLastRunTime();
+      // Record now as the last successful chrome start. This writes to the
+      // registry on Windows, so keep it off the UI thread.
+      startup_task_scheduler_->AddTask(
+          "SetLastRunTime", StartupTaskScheduler::AFTER_FIRST_PAINT,
+          StartupTaskScheduler::FILE_THREAD,
+          base::Bind(
+              base::IgnoreResult(&GoogleUpdateSettings::SetLastRunTime)));
 
 #if defined(OS_MACOSX)
       // Call Recycle() here as late as possible, before going into the loop
@@ -1841,12 +1945,12 @@ int ChromeBrowserMainParts::PreMainMessageLoopRunImpl() {
       // TODO(mad): Move this call in a proper place on CrOS.
       // http://crosbug.com/17687
 #if !defined(OS_CHROMEOS)
-      // If we're running tests (ui_task is non-null), then we don't want to
-      // call FetchLanguageListFromTranslateServer
-      if (parameters().ui_task == NULL && translate_manager_ != NULL) {
-        translate_manager_->FetchLanguageListFromTranslateServer(
-            profile_->GetPrefs());
-      }
+      startup_task_scheduler_->AddTask(
+          "FetchTranslateLanguageList",
+          StartupTaskScheduler::AFTER_FIRST_PAINT,
+          StartupTaskScheduler::UI_THREAD,
+          base::Bind(&ChromeBrowserMainParts::FetchTranslateLanguageList,
+                     base::Unretained(this)));
 #endif
 
       run_message_loop_ = true;
@@ -1855,6 +1959,7 @@ int ChromeBrowserMainParts::PreMainMessageLoopRunImpl() {
     }
   browser_init_.reset();
 
+  startup_task_scheduler_->Start();
   PostBrowserStart();
 
   if (parameters().ui_task) {
@@ -1901,6 +2006,15 @@ void ChromeBrowserMainParts::PostMainMessageLoopRun() {
   for (size_t i = 0; i < chrome_extra_parts_.size(); ++i)
     chrome_extra_parts_[i]->PostMainMessageLoopRun();
 
+  // Drop any deferred startup tasks that have not run yet; they refer to
+  // |profile_|.
+  startup_task_scheduler_.reset();
+
+#if !defined(OS_CHROMEOS) && !defined(OS_ANDROID)
+  if (parsed_command_line().HasSwitch(switches::kEnableTabDiscarding))
+    g_browser_process->oom_priority_manager()->Stop();
+#endif
+
 #if defined(OS_WIN)
   // Log the search engine chosen on first run. Do this at shutdown, after any
   // changes are made from the first run bubble link, etc.
@@ -27,6 +27,7 @@ class HistogramSynchronizer;
 class MetricsService;
 class PrefService;
 class Profile;
+class StartupTaskScheduler;
 class StartupTimeBomb;
 class ShutdownWatcherHelper;
 class TranslateManager;
@@ -129,6 +130,10 @@ class ChromeBrowserMainParts : public content::BrowserMainParts {
   // Field trial for testing domain bound certs.
   void DomainBoundCertsFieldTrial();
 
+  // A/B test for delaying images and the requests of hidden tabs while more
+  // important requests are in flight.
+  void ResourceSchedulerFieldTrial();
+
   // A collection of field trials intended to test the uniformity and
   // correctness of the field trial control, bucketing and reporting systems.
   void SetupUniformityFieldTrials();
@@ -148,6 +153,20 @@ class ChromeBrowserMainParts : public content::BrowserMainParts {
   // thread.
   void StartMetricsRecording();
 
+  // Methods for |PreMainMessageLoopRunImpl()| -------------------------------
+
+  // Adds the startup work that the first window does not need to
+  // |startup_task_scheduler_|.
+  void AddDeferredStartupTasks();
+
+  // Creates the GoogleURLTracker and IntranetRedirectDetector.
+  void StartGoogleServices();
+
+  // Records the startup-time breakpad, about:flags and language histograms.
+  void RecordStartupMetrics();
+
+  void FetchTranslateLanguageList();
+
   // Returns true if the user opted in to sending metric reports.
   bool IsMetricsReportingEnabled();
 
@@ -197,6 +216,7 @@ class ChromeBrowserMainParts : public content::BrowserMainParts {
   Profile* profile_;
   bool run_message_loop_;
   ProcessSingleton::NotifyResult notify_result_;
+  scoped_ptr<StartupTaskScheduler> startup_task_scheduler_;
 
   // Initialized in SetupMetricsAndFieldTrials.
   scoped_refptr<FieldTrialSynchronizer> field_trial_synchronizer_;
@@ -1079,7 +1079,7 @@ std::string LoginUtilsImpl::GetOffTheRecordCommandLine(
       ash::switches::kAuraNoShadows,
       ash::switches::kAuraPanelManager,
       ash::switches::kAuraWindowAnimationsDisabled,
-      switches::kUIEnablePartialSwap,
+      switches::kUIDisablePartialSwap,
       switches::kUIUseGPUProcess,
       switches::kUseGL,
       switches::kUserDataDir,
@@ -4,6 +4,7 @@
 
 #include "chrome/browser/extensions/api/declarative/substring_set_matcher.h"
 
+#include <algorithm>
 #include <queue>
 
 #include "base/logging.h"
@@ -11,6 +12,14 @@
 
 namespace extensions {
 
+namespace {
+
+bool EdgeLabelLess(const std::pair<char, uint32>& edge, char c) {
+  return edge.first < c;
+}
+
+}  // namespace
+
 //
 // SubstringPattern
 //
@@ -31,7 +40,8 @@ bool SubstringPattern::operator<(const SubstringPattern& rhs) const {
 // SubstringSetMatcher
 //
 
-SubstringSetMatcher::SubstringSetMatcher() {
+SubstringSetMatcher::SubstringSetMatcher()
+    : num_unregistered_since_rebuild_(0) {
   RebuildAhoCorasickTree();
 }
 
@@ -57,15 +67,27 @@ void SubstringSetMatcher::RegisterAndUnregisterPatterns(
       to_register.begin(); i != to_register.end(); ++i) {
     DCHECK(patterns_.find((*i)->id()) == patterns_.end());
     patterns_[(*i)->id()] = *i;
+    InsertPatternIntoAhoCorasickTree(*i);
   }
 
   // Unregister patterns
   for (std::vector<const SubstringPattern*>::const_iterator i =
       to_unregister.begin(); i != to_unregister.end(); ++i) {
-    patterns_.erase((*i)->id());
+    if (patterns_.erase((*i)->id())) {
+      RemovePatternFromAhoCorasickTree(*i);
+      ++num_unregistered_since_rebuild_;
+    }
   }
 
-  RebuildAhoCorasickTree();
+  if (num_unregistered_since_rebuild_ > patterns_.size()) {
+    RebuildAhoCorasickTree();
+    return;
+  }
+
+  // New nodes may be the targets of the failure edges of existing ones, and
+  // patterns ending at existing nodes change their output edges.
+  if (!to_register.empty())
+    CreateFailureEdges();
 }
 
 bool SubstringSetMatcher::Match(const std::string& text,
@@ -75,17 +97,23 @@ bool SubstringSetMatcher::Match(const std::string& text,
   // Handle patterns matching the empty string.
   matches->insert(tree_[0].matches().begin(), tree_[0].matches().end());
 
-  int current_node = 0;
+  uint32 current_node = 0;
   size_t text_length = text.length();
   for (size_t i = 0; i < text_length; ++i) {
-    while (!tree_[current_node].HasEdge(text[i]) && current_node != 0)
+    uint32 edge = tree_[current_node].GetEdge(text[i]);
+    while (edge == AhoCorasickNode::kNoSuchEdge && current_node != 0) {
       current_node = tree_[current_node].failure();
-    if (tree_[current_node].HasEdge(text[i])) {
-      current_node = tree_[current_node].GetEdge(text[i]);
-      matches->insert(tree_[current_node].matches().begin(),
-                      tree_[current_node].matches().end());
-    } else {
-      DCHECK_EQ(0, current_node);
+      edge = tree_[current_node].GetEdge(text[i]);
+    }
+    if (edge == AhoCorasickNode::kNoSuchEdge) {
+      DCHECK_EQ(0u, current_node);
+      continue;
+    }
+    current_node = edge;
+    for (uint32 node = current_node; node != AhoCorasickNode::kNoSuchEdge;
+         node = tree_[node].output()) {
+      matches->insert(tree_[node].matches().begin(),
+                      tree_[node].matches().end());
     }
   }
 
@@ -99,6 +127,7 @@ bool SubstringSetMatcher::IsEmpty() const {
 
 void SubstringSetMatcher::RebuildAhoCorasickTree() {
   tree_.clear();
+  num_unregistered_since_rebuild_ = 0;
 
   // Initialize root note of tree.
   AhoCorasickNode root;
@@ -120,13 +149,15 @@ void SubstringSetMatcher::InsertPatternIntoAhoCorasickTree(
   size_t text_length = text.length();
 
   // Iterators on the tree and the text.
-  int current_node = 0;
+  uint32 current_node = 0;
   size_t text_pos = 0;
 
   // Follow existing paths for as long as possible.
-  while (text_pos < text_length &&
-         tree_[current_node].HasEdge(text[text_pos])) {
-    current_node = tree_[current_node].GetEdge(text[text_pos]);
+  while (text_pos < text_length) {
+    uint32 edge = tree_[current_node].GetEdge(text[text_pos]);
+    if (edge == AhoCorasickNode::kNoSuchEdge)
+      break;
+    current_node = edge;
     ++text_pos;
   }
 
@@ -143,18 +174,31 @@ void SubstringSetMatcher::InsertPatternIntoAhoCorasickTree(
   tree_[current_node].AddMatch(pattern->id());
 }
 
+void SubstringSetMatcher::RemovePatternFromAhoCorasickTree(
+    const SubstringPattern* pattern) {
+  const std::string& text = pattern->pattern();
+  uint32 current_node = 0;
+  for (size_t i = 0; i < text.length(); ++i) {
+    current_node = tree_[current_node].GetEdge(text[i]);
+    DCHECK_NE(AhoCorasickNode::kNoSuchEdge, current_node);
+  }
+  tree_[current_node].RemoveMatch(pattern->id());
+}
+
 void SubstringSetMatcher::CreateFailureEdges() {
   typedef AhoCorasickNode::Edges Edges;
 
-  std::queue<int> queue;
+  std::queue<uint32> queue;
 
   AhoCorasickNode& root = tree_[0];
   root.set_failure(0);
+  root.set_output(AhoCorasickNode::kNoSuchEdge);
   const AhoCorasickNode::Edges& root_edges = root.edges();
   for (Edges::const_iterator e = root_edges.begin(); e != root_edges.end();
        ++e) {
-    int leads_to = e->second;
+    uint32 leads_to = e->second;
     tree_[leads_to].set_failure(0);
+    tree_[leads_to].set_output(AhoCorasickNode::kNoSuchEdge);
     queue.push(leads_to);
   }
 
@@ -164,23 +208,37 @@ void SubstringSetMatcher::CreateFailureEdges() {
     for (Edges::const_iterator e = current_node.edges().begin();
          e != current_node.edges().end(); ++e) {
       char edge_label = e->first;
-      int leads_to = e->second;
+      uint32 leads_to = e->second;
       queue.push(leads_to);
 
-      int failure = current_node.failure();
-      while (!tree_[failure].HasEdge(edge_label) && failure != 0)
+      uint32 failure = current_node.failure();
+      uint32 edge = tree_[failure].GetEdge(edge_label);
+      while (edge == AhoCorasickNode::kNoSuchEdge && failure != 0) {
         failure = tree_[failure].failure();
+        edge = tree_[failure].GetEdge(edge_label);
+      }
 
-      int follow_in_case_of_failure = tree_[failure].HasEdge(e->first) ?
-          tree_[failure].GetEdge(edge_label) : 0;
+      uint32 follow_in_case_of_failure =
+          edge == AhoCorasickNode::kNoSuchEdge ? 0 : edge;
       tree_[leads_to].set_failure(follow_in_case_of_failure);
-      tree_[leads_to].AddMatches(tree_[follow_in_case_of_failure].matches());
+
+      const AhoCorasickNode& failure_node = tree_[follow_in_case_of_failure];
+      if (follow_in_case_of_failure == 0)
+        tree_[leads_to].set_output(AhoCorasickNode::kNoSuchEdge);
+      else if (!failure_node.matches().empty())
+        tree_[leads_to].set_output(follow_in_case_of_failure);
+      else
+        tree_[leads_to].set_output(failure_node.output());
     }
   }
 }
 
+// static
+const uint32 SubstringSetMatcher::AhoCorasickNode::kNoSuchEdge = 0xFFFFFFFF;
+
 SubstringSetMatcher::AhoCorasickNode::AhoCorasickNode()
-    : failure_(-1) {}
+    : failure_(kNoSuchEdge),
+      output_(kNoSuchEdge) {}
 
 SubstringSetMatcher::AhoCorasickNode::~AhoCorasickNode() {}
 
@@ -188,6 +246,7 @@ SubstringSetMatcher::AhoCorasickNode::AhoCorasickNode(
     const SubstringSetMatcher::AhoCorasickNode& other)
     : edges_(other.edges_),
       failure_(other.failure_),
+      output_(other.output_),
       matches_(other.matches_) {}
 
 SubstringSetMatcher::AhoCorasickNode&
@@ -195,30 +254,34 @@ SubstringSetMatcher::AhoCorasickNode::operator=(
     const SubstringSetMatcher::AhoCorasickNode& other) {
   edges_ = other.edges_;
   failure_ = other.failure_;
+  output_ = other.output_;
   matches_ = other.matches_;
   return *this;
 }
 
-bool SubstringSetMatcher::AhoCorasickNode::HasEdge(char c) const {
-  return edges_.find(c) != edges_.end();
-}
-
-int SubstringSetMatcher::AhoCorasickNode::GetEdge(char c) const {
-  std::map<char, int>::const_iterator i = edges_.find(c);
-  return i == edges_.end() ? -1 : i->second;
+uint32 SubstringSetMatcher::AhoCorasickNode::GetEdge(char c) const {
+  Edges::const_iterator i =
+      std::lower_bound(edges_.begin(), edges_.end(), c, EdgeLabelLess);
+  return i == edges_.end() || i->first != c ? kNoSuchEdge : i->second;
 }
 
-void SubstringSetMatcher::AhoCorasickNode::SetEdge(char c, int node) {
-  edges_[c] = node;
+void SubstringSetMatcher::AhoCorasickNode::SetEdge(char c, uint32 node) {
+  Edges::iterator i =
+      std::lower_bound(edges_.begin(), edges_.end(), c, EdgeLabelLess);
+  if (i != edges_.end() && i->first == c)
+    i->second = node;
+  else
+    edges_.insert(i, std::make_pair(c, node));
 }
 
 void SubstringSetMatcher::AhoCorasickNode::AddMatch(SubstringPattern::ID id) {
-  matches_.insert(id);
+  matches_.push_back(id);
 }
 
-void SubstringSetMatcher::AhoCorasickNode::AddMatches(
-    const SubstringSetMatcher::AhoCorasickNode::Matches& matches) {
-  matches_.insert(matches.begin(), matches.end());
+void SubstringSetMatcher::AhoCorasickNode::RemoveMatch(
+    SubstringPattern::ID id) {
+  matches_.erase(std::remove(matches_.begin(), matches_.end(), id),
+                 matches_.end());
 }
 
 }  // namespace extensions
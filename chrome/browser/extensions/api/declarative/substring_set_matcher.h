@@ -58,6 +58,12 @@ class SubstringSetMatcher {
 
   // Analogous to RegisterPatterns and UnregisterPatterns but executes both
   // operations in one step, which is cheaper in the execution.
+  //
+  // The Aho-Corasick tree is updated in place: registering inserts the paths
+  // of the new patterns and relinks the failure edges, and unregistering only
+  // drops the patterns' IDs from their nodes. The tree is rebuilt from scratch
+  // once more patterns have been unregistered since the last rebuild than
+  // remain registered, to free the nodes nobody needs anymore.
   void RegisterAndUnregisterPatterns(
       const std::vector<const SubstringPattern*>& to_register,
       const std::vector<const SubstringPattern*>& to_unregister);
@@ -102,27 +108,39 @@ class SubstringSetMatcher {
   // If your brain thinks "Forget it, let's go shopping.", don't worry.
   // Take a nap and read an introductory text on the Aho Corasick algorithm.
   // It will make sense. Eventually.
+  //
+  // Rather than copying the matches of the node a failure edge leads to into
+  // every node, as the slides do, each node keeps the IDs of the patterns
+  // ending there and an output edge to the next node along its failure edges
+  // at which a pattern ends. This keeps the matches of each pattern in a
+  // single node, so that patterns can be unregistered without touching the
+  // rest of the tree.
   class AhoCorasickNode {
    public:
-    // Key: label of the edge, value: node index in |tree_| of parent class.
-    typedef std::map<char, int> Edges;
-    typedef std::set<SubstringPattern::ID> Matches;
+    // Edges sorted by label. The node index is into |tree_| of parent class.
+    typedef std::vector<std::pair<char, uint32> > Edges;
+    typedef std::vector<SubstringPattern::ID> Matches;
+
+    static const uint32 kNoSuchEdge;  // Represents an invalid node index.
 
     AhoCorasickNode();
     ~AhoCorasickNode();
     AhoCorasickNode(const AhoCorasickNode& other);
     AhoCorasickNode& operator=(const AhoCorasickNode& other);
 
-    bool HasEdge(char c) const;
-    int GetEdge(char c) const;
-    void SetEdge(char c, int node);
+    // Returns kNoSuchEdge if there is no edge labeled |c|.
+    uint32 GetEdge(char c) const;
+    void SetEdge(char c, uint32 node);
     const Edges& edges() const { return edges_; }
 
-    int failure() const { return failure_; }
-    void set_failure(int failure) { failure_ = failure; }
+    uint32 failure() const { return failure_; }
+    void set_failure(uint32 failure) { failure_ = failure; }
+
+    uint32 output() const { return output_; }
+    void set_output(uint32 output) { output_ = output; }
 
     void AddMatch(SubstringPattern::ID id);
-    void AddMatches(const Matches& matches);
+    void RemoveMatch(SubstringPattern::ID id);
     const Matches& matches() const { return matches_; }
 
    private:
@@ -130,9 +148,14 @@ class SubstringSetMatcher {
     Edges edges_;
 
     // Node index that failure edge leads to.
-    int failure_;
+    uint32 failure_;
 
-    // Identifiers of matches.
+    // Index of the closest node along the failure edges with matches, or
+    // kNoSuchEdge. The root is never an output, its matches are reported
+    // for every text.
+    uint32 output_;
+
+    // Identifiers of the patterns ending at this node.
     Matches matches_;
   };
 
@@ -142,6 +165,12 @@ class SubstringSetMatcher {
   // |pattern->id()| to the set of matches. Ownership of |pattern| remains with
   // the caller.
   void InsertPatternIntoAhoCorasickTree(const SubstringPattern* pattern);
+
+  // Removes |pattern->id()| from the matches of the node for
+  // |pattern->pattern()|. The path of the pattern stays in the tree.
+  void RemovePatternFromAhoCorasickTree(const SubstringPattern* pattern);
+
+  // Sets the failure and output edges of all nodes.
   void CreateFailureEdges();
 
   // Set of all registered SubstringPatterns. Used to regenerate the
@@ -153,6 +182,10 @@ class SubstringSetMatcher {
   // The nodes of a Aho-Corasick tree.
   std::vector<AhoCorasickNode> tree_;
 
+  // The number of patterns unregistered since the tree was last rebuilt.
+  // Their paths are still in |tree_|.
+  size_t num_unregistered_since_rebuild_;
+
   DISALLOW_COPY_AND_ASSIGN(SubstringSetMatcher);
 };
 
@@ -0,0 +1,157 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times building, matching and updating a SubstringSetMatcher of 50k
+// patterns, and updating a URLMatcher with as many condition sets, as the
+// WebRequestRulesRegistry does when an extension adds or removes rules.
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/perftimer.h"
+#include "base/process_util.h"
+#include "base/stringprintf.h"
+#include "chrome/browser/extensions/api/declarative/substring_set_matcher.h"
+#include "chrome/browser/extensions/api/declarative/url_matcher.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace extensions {
+
+namespace {
+
+const int kNumPatterns = 50000;
+const int kNumURLs = 1000;
+
+// The number of patterns or condition sets added and removed at a time, as
+// when an extension updates a few of its rules.
+const int kUpdateSize = 10;
+const int kNumUpdates = 100;
+
+// Returns the working set of this process, in bytes.
+size_t GetWorkingSetSize() {
+#if defined(OS_MACOSX)
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle(), NULL));
+#else
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle()));
+#endif
+  return metrics->GetWorkingSetSize();
+}
+
+// Returns a URL-like pattern, such as a rule blocking an ad server would use.
+std::string PatternString(int i) {
+  return base::StringPrintf("ads%d.example%d.com/banner%d", i % 97, i % 1013,
+                            i);
+}
+
+}  // namespace
+
+class SubstringSetMatcherPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    for (int i = 0; i < kNumPatterns + kUpdateSize; ++i)
+      patterns_.push_back(new SubstringPattern(PatternString(i), i));
+    for (int i = 0; i < kNumURLs; ++i) {
+      texts_.push_back(base::StringPrintf(
+          "www.site%d.com/news/article%d.html?ref=ads%d.example%d.com", i % 50,
+          i, i % 97, i % 1013));
+    }
+  }
+
+  ScopedVector<SubstringPattern> patterns_;
+  std::vector<std::string> texts_;
+};
+
+TEST_F(SubstringSetMatcherPerfTest, Build) {
+  std::vector<const SubstringPattern*> patterns(
+      patterns_.begin(), patterns_.begin() + kNumPatterns);
+  SubstringSetMatcher matcher;
+  size_t before = GetWorkingSetSize();
+  {
+    PerfTimeLogger timer("SubstringSetMatcher_register");
+    matcher.RegisterPatterns(patterns);
+  }
+  LogPerfResult("SubstringSetMatcher_working_set",
+                (static_cast<double>(GetWorkingSetSize()) - before) / 1024,
+                "kb");
+
+  size_t matches = 0;
+  PerfTimeLogger timer("SubstringSetMatcher_match");
+  for (size_t i = 0; i < texts_.size(); ++i) {
+    std::set<SubstringPattern::ID> ids;
+    matcher.Match(texts_[i], &ids);
+    matches += ids.size();
+  }
+  timer.Done();
+  EXPECT_GT(matches, 0u);
+}
+
+TEST_F(SubstringSetMatcherPerfTest, Update) {
+  std::vector<const SubstringPattern*> patterns(
+      patterns_.begin(), patterns_.begin() + kNumPatterns);
+  SubstringSetMatcher matcher;
+  matcher.RegisterPatterns(patterns);
+
+  // Alternately add the spare patterns and remove them again.
+  std::vector<const SubstringPattern*> update(
+      patterns_.begin() + kNumPatterns, patterns_.end());
+  PerfTimeLogger timer("SubstringSetMatcher_update");
+  for (int i = 0; i < kNumUpdates; ++i) {
+    if (i % 2)
+      matcher.UnregisterPatterns(update);
+    else
+      matcher.RegisterPatterns(update);
+  }
+}
+
+TEST(URLMatcherPerfTest, Update) {
+  URLMatcher matcher;
+  URLMatcherConditionFactory* factory = matcher.condition_factory();
+
+  URLMatcherConditionSet::Vector condition_sets;
+  for (int i = 0; i < kNumPatterns; ++i) {
+    URLMatcherConditionSet::Conditions conditions;
+    conditions.insert(factory->CreateHostSuffixPathPrefixCondition(
+        base::StringPrintf("example%d.com", i % 1013),
+        base::StringPrintf("/banner%d", i)));
+    condition_sets.push_back(new URLMatcherConditionSet(i, conditions));
+  }
+  {
+    PerfTimeLogger timer("URLMatcher_add_all");
+    matcher.AddConditionSets(condition_sets);
+  }
+
+  PerfTimer timer;
+  for (int i = 0; i < kNumUpdates; ++i) {
+    URLMatcherConditionSet::Vector added;
+    std::vector<URLMatcherConditionSet::ID> ids;
+    for (int j = 0; j < kUpdateSize; ++j) {
+      int id = kNumPatterns + i * kUpdateSize + j;
+      URLMatcherConditionSet::Conditions conditions;
+      conditions.insert(factory->CreateHostSuffixPathPrefixCondition(
+          base::StringPrintf("update%d.com", id), "/"));
+      added.push_back(new URLMatcherConditionSet(id, conditions));
+      ids.push_back(id);
+    }
+    matcher.AddConditionSets(added);
+    matcher.RemoveConditionSets(ids);
+  }
+  LogPerfResult("URLMatcher_update",
+                timer.Elapsed().InMillisecondsF() / kNumUpdates, "ms");
+
+  PerfTimeLogger match_timer("URLMatcher_match");
+  for (int i = 0; i < kNumURLs; ++i) {
+    matcher.MatchURL(GURL(base::StringPrintf(
+        "http://www.example%d.com/banner%d", i % 1013, i)));
+  }
+}
+
+}  // namespace extensions
@@ -177,3 +177,58 @@ TEST(SubstringSetMatcherTest, TestEmptyMatcher) {
   matcher.Match("abd", &matches);
   EXPECT_TRUE(matches.empty());
 }
+
+TEST(SubstringSetMatcherTest, RegisterIncrementally) {
+  SubstringSetMatcher matcher;
+
+  SubstringPattern pattern_1("xab", 1);
+  SubstringPattern pattern_2("ab", 2);
+  SubstringPattern pattern_3("xa", 3);
+  SubstringPattern pattern_4("b", 4);
+
+  std::vector<const SubstringPattern*> patterns;
+  patterns.push_back(&pattern_1);
+  matcher.RegisterPatterns(patterns);
+
+  // "ab" becomes the failure target of the existing "xab".
+  patterns.clear();
+  patterns.push_back(&pattern_2);
+  matcher.RegisterPatterns(patterns);
+
+  std::set<int> matches;
+  matcher.Match("xxab", &matches);
+  EXPECT_EQ(2u, matches.size());
+  EXPECT_TRUE(matches.end() != matches.find(1));
+  EXPECT_TRUE(matches.end() != matches.find(2));
+
+  // "xa" ends at an existing node, and "b" is an output of "ab" and "xab".
+  patterns.clear();
+  patterns.push_back(&pattern_3);
+  patterns.push_back(&pattern_4);
+  matcher.RegisterPatterns(patterns);
+
+  matches.clear();
+  matcher.Match("xab", &matches);
+  EXPECT_EQ(4u, matches.size());
+
+  patterns.clear();
+  patterns.push_back(&pattern_2);
+  matcher.UnregisterPatterns(patterns);
+
+  matches.clear();
+  matcher.Match("xab", &matches);
+  EXPECT_EQ(3u, matches.size());
+  EXPECT_TRUE(matches.end() == matches.find(2));
+
+  matches.clear();
+  matcher.Match("cab", &matches);
+  EXPECT_EQ(1u, matches.size());
+  EXPECT_TRUE(matches.end() != matches.find(4));
+
+  patterns.clear();
+  patterns.push_back(&pattern_1);
+  patterns.push_back(&pattern_3);
+  patterns.push_back(&pattern_4);
+  matcher.UnregisterPatterns(patterns);
+  EXPECT_TRUE(matcher.IsEmpty());
+}
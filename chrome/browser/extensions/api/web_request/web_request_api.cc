@@ -266,6 +266,7 @@ void ClearCacheOnNavigationOnUI() {
 // parameters and extra_info_spec were specified at the time the listener was
 // added.
 struct ExtensionWebRequestEventRouter::EventListener {
+  int id;  // Identifies the listener's URL filter in |url_matchers_|.
   std::string extension_id;
   std::string extension_name;
   std::string sub_event_name;
@@ -284,7 +285,7 @@ struct ExtensionWebRequestEventRouter::EventListener {
     return false;
   }
 
-  EventListener() : extra_info_spec(0) {}
+  EventListener() : id(0), extra_info_spec(0) {}
 };
 
 // Contains info about requests that are blocked waiting for a response from
@@ -454,7 +455,8 @@ ExtensionWebRequestEventRouter* ExtensionWebRequestEventRouter::GetInstance() {
 }
 
 ExtensionWebRequestEventRouter::ExtensionWebRequestEventRouter()
-    : request_time_tracker_(new ExtensionWebRequestTimeTracker) {
+    : next_listener_id_(1),
+      request_time_tracker_(new ExtensionWebRequestTimeTracker) {
 }
 
 ExtensionWebRequestEventRouter::~ExtensionWebRequestEventRouter() {
@@ -966,6 +968,7 @@ void ExtensionWebRequestEventRouter::AddEventListener(
     return;
 
   EventListener listener;
+  listener.id = next_listener_id_++;
   listener.extension_id = extension_id;
   listener.extension_name = extension_name;
   listener.sub_event_name = sub_event_name;
@@ -976,6 +979,8 @@ void ExtensionWebRequestEventRouter::AddEventListener(
   CHECK_EQ(listeners_[profile][event_name].count(listener), 0u) <<
       "extension=" << extension_id << " event=" << event_name;
   listeners_[profile][event_name].insert(listener);
+  if (!filter.urls.is_empty())
+    url_matchers_[profile][event_name].AddPatterns(listener.id, filter.urls);
 }
 
 void ExtensionWebRequestEventRouter::RemoveEventListener(
@@ -1009,6 +1014,8 @@ void ExtensionWebRequestEventRouter::RemoveEventListener(
     DecrementBlockCount(profile, extension_id, event_name, *it, NULL);
   }
 
+  if (!found->filter.urls.is_empty())
+    url_matchers_[profile][event_name].RemovePatterns(found->id);
   listeners_[profile][event_name].erase(listener);
 
   BrowserThread::PostTask(BrowserThread::UI, FROM_HERE,
@@ -1072,6 +1079,13 @@ void ExtensionWebRequestEventRouter::GetMatchingListenersImpl(
     std::vector<const ExtensionWebRequestEventRouter::EventListener*>*
         matching_listeners) {
   std::set<EventListener>& listeners = listeners_[profile][event_name];
+  if (listeners.empty())
+    return;
+
+  // Match the URL against every listener's URL filter at once.
+  std::set<int> url_matches;
+  url_matchers_[profile][event_name].MatchURL(url, &url_matches);
+
   for (std::set<EventListener>::iterator it = listeners.begin();
        it != listeners.end(); ++it) {
     if (!it->ipc_sender.get()) {
@@ -1080,7 +1094,7 @@ void ExtensionWebRequestEventRouter::GetMatchingListenersImpl(
       continue;
     }
 
-    if (!it->filter.urls.is_empty() && !it->filter.urls.MatchesURL(url))
+    if (!it->filter.urls.is_empty() && !url_matches.count(it->id))
       continue;
     if (it->filter.tab_id != -1 && tab_id != it->filter.tab_id)
       continue;
@@ -18,6 +18,7 @@
 #include "chrome/browser/extensions/api/web_request/web_request_api_helpers.h"
 #include "chrome/browser/extensions/extension_function.h"
 #include "chrome/browser/profiles/profile.h"
+#include "chrome/common/extensions/url_pattern_matcher.h"
 #include "chrome/common/extensions/url_pattern_set.h"
 #include "ipc/ipc_message.h"
 #include "net/base/completion_callback.h"
@@ -262,6 +263,8 @@ class ExtensionWebRequestEventRouter {
   struct EventListener;
   typedef std::map<std::string, std::set<EventListener> > ListenerMapForProfile;
   typedef std::map<void*, ListenerMapForProfile> ListenerMap;
+  typedef std::map<std::string, URLPatternMatcher> URLMatcherMapForProfile;
+  typedef std::map<void*, URLMatcherMapForProfile> URLMatcherMap;
   typedef std::map<uint64, BlockedRequest> BlockedRequestMap;
   // Map of request_id -> bit vector of EventTypes already signaled
   typedef std::map<uint64, int> SignaledRequestMap;
@@ -352,6 +355,13 @@ class ExtensionWebRequestEventRouter {
   // are listening to that event.
   ListenerMap listeners_;
 
+  // The URL filters of the listeners in |listeners_|, by profile and event
+  // name, keyed by listener id. Listeners without URL filters are left out.
+  URLMatcherMap url_matchers_;
+
+  // The id to give the next listener added.
+  int next_listener_id_;
+
   // A map of network requests that are waiting for at least one event handler
   // to respond.
   BlockedRequestMap blocked_requests_;
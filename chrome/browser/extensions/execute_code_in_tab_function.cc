@@ -12,13 +12,13 @@
 #include "chrome/browser/extensions/extension_tabs_module.h"
 #include "chrome/browser/extensions/extension_tabs_module_constants.h"
 #include "chrome/browser/extensions/file_reader.h"
+#include "chrome/browser/extensions/message_bundle_cache.h"
 #include "chrome/browser/profiles/profile.h"
 #include "chrome/browser/ui/browser.h"
 #include "chrome/browser/ui/tab_contents/tab_contents_wrapper.h"
 #include "chrome/common/extensions/extension.h"
 #include "chrome/common/extensions/extension_constants.h"
 #include "chrome/common/extensions/extension_error_utils.h"
-#include "chrome/common/extensions/extension_file_util.h"
 #include "chrome/common/extensions/extension_l10n_util.h"
 #include "chrome/common/extensions/extension_manifest_constants.h"
 #include "chrome/common/extensions/extension_message_bundle.h"
@@ -204,7 +204,7 @@ void ExecuteCodeInTabFunction::LocalizeCSS(
     const FilePath& extension_path,
     const std::string& extension_default_locale) {
   scoped_ptr<SubstitutionMap> localization_messages(
-      extension_file_util::LoadExtensionMessageBundleSubstitutionMap(
+      extensions::MessageBundleCache::GetInstance()->GetSubstitutionMap(
           extension_path, extension_id, extension_default_locale));
 
   // We need to do message replacement on the data, so it has to be mutable.
@@ -4,6 +4,7 @@
 
 #include "chrome/browser/extensions/installed_loader.h"
 
+#include "base/debug/trace_event.h"
 #include "base/file_path.h"
 #include "base/metrics/histogram.h"
 #include "base/stringprintf.h"
@@ -116,9 +117,12 @@ void InstalledLoader::LoadAllExtensions() {
 
   std::vector<int> reload_reason_counts(NUM_MANIFEST_RELOAD_REASONS, 0);
   bool should_write_prefs = false;
+  // Time spent on each extension, including any manifest reload.
+  std::vector<base::TimeDelta> load_times(extensions_info->size());
 
   for (size_t i = 0; i < extensions_info->size(); ++i) {
     ExtensionInfo* info = extensions_info->at(i).get();
+    base::TimeTicks reload_start_time = base::TimeTicks::Now();
 
     ManifestReloadReason reload_reason = ShouldReloadExtensionManifest(*info);
     ++reload_reason_counts[reload_reason];
@@ -152,11 +156,21 @@ void InstalledLoader::LoadAllExtensions() {
           static_cast<DictionaryValue*>(
               extension->manifest()->value()->DeepCopy()));
       should_write_prefs = true;
+      load_times[i] = base::TimeTicks::Now() - reload_start_time;
     }
   }
 
   for (size_t i = 0; i < extensions_info->size(); ++i) {
-    Load(*extensions_info->at(i), should_write_prefs);
+    const ExtensionInfo& info = *extensions_info->at(i);
+    TRACE_EVENT1("startup", "InstalledLoader::Load",
+                 "extension_id", TRACE_STR_COPY(info.extension_id.c_str()));
+    base::TimeTicks load_start_time = base::TimeTicks::Now();
+    Load(info, should_write_prefs);
+    load_times[i] += base::TimeTicks::Now() - load_start_time;
+
+    UMA_HISTOGRAM_TIMES("Extensions.LoadTimePerExtension", load_times[i]);
+    VLOG(1) << "Loading extension " << info.extension_id << " took "
+            << load_times[i].InMilliseconds() << " ms";
   }
 
   extension_service_->OnLoadedInstalledExtensions();
@@ -0,0 +1,113 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/extensions/message_bundle_cache.h"
+
+#include "base/file_util.h"
+#include "base/lazy_instance.h"
+#include "base/metrics/histogram.h"
+#include "base/platform_file.h"
+#include "chrome/common/extensions/extension.h"
+#include "chrome/common/extensions/extension_file_util.h"
+#include "chrome/common/extensions/extension_l10n_util.h"
+#include "content/public/browser/browser_thread.h"
+#include "ui/base/l10n/l10n_util.h"
+
+using content::BrowserThread;
+
+namespace extensions {
+
+namespace {
+
+base::LazyInstance<MessageBundleCache> g_message_bundle_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+MessageBundleCache::Entry::Entry() {
+}
+
+MessageBundleCache::Entry::~Entry() {
+}
+
+MessageBundleCache::MessageBundleCache() {
+}
+
+MessageBundleCache::~MessageBundleCache() {
+}
+
+// static
+MessageBundleCache* MessageBundleCache::GetInstance() {
+  return g_message_bundle_cache.Pointer();
+}
+
+ExtensionMessageBundle::SubstitutionMap*
+MessageBundleCache::GetSubstitutionMap(const FilePath& extension_path,
+                                       const std::string& extension_id,
+                                       const std::string& default_locale) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
+
+  // Non-localized extensions only get @@extension_id, which needs no disk
+  // access.
+  if (default_locale.empty()) {
+    return extension_file_util::LoadExtensionMessageBundleSubstitutionMap(
+        extension_path, extension_id, default_locale);
+  }
+
+  std::string application_locale =
+      extension_l10n_util::CurrentLocaleOrDefault();
+  std::vector<base::Time> file_times =
+      GetMessageFileTimes(extension_path, default_locale, application_locale);
+
+  EntryMap::iterator it = entries_.find(extension_id);
+  bool hit = it != entries_.end() &&
+      it->second.extension_path == extension_path &&
+      it->second.default_locale == default_locale &&
+      it->second.application_locale == application_locale &&
+      it->second.file_times == file_times;
+  UMA_HISTOGRAM_BOOLEAN("Extensions.MessageBundleCacheHit", hit);
+  if (hit)
+    return new ExtensionMessageBundle::SubstitutionMap(
+        it->second.substitution_map);
+
+  ExtensionMessageBundle::SubstitutionMap* substitution_map =
+      extension_file_util::LoadExtensionMessageBundleSubstitutionMap(
+          extension_path, extension_id, default_locale);
+
+  Entry& entry = entries_[extension_id];
+  entry.extension_path = extension_path;
+  entry.default_locale = default_locale;
+  entry.application_locale = application_locale;
+  entry.file_times.swap(file_times);
+  entry.substitution_map = *substitution_map;
+  return substitution_map;
+}
+
+// static
+std::vector<base::Time> MessageBundleCache::GetMessageFileTimes(
+    const FilePath& extension_path,
+    const std::string& default_locale,
+    const std::string& application_locale) {
+  // The same fallback order as extension_l10n_util::LoadMessageCatalogs().
+  std::vector<std::string> locales;
+  if (!application_locale.empty() && application_locale != default_locale)
+    l10n_util::GetParentLocales(application_locale, &locales);
+  locales.push_back(default_locale);
+
+  FilePath locale_path = extension_path.Append(Extension::kLocaleFolder);
+  std::vector<base::Time> file_times;
+  for (size_t i = 0; i < locales.size(); ++i) {
+    base::PlatformFileInfo file_info;
+    if (file_util::GetFileInfo(locale_path.AppendASCII(locales[i])
+                                   .Append(Extension::kMessagesFilename),
+                               &file_info)) {
+      file_times.push_back(file_info.last_modified);
+    } else {
+      file_times.push_back(base::Time());
+    }
+  }
+  return file_times;
+}
+
+}  // namespace extensions
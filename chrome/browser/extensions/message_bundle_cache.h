@@ -0,0 +1,74 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CHROME_BROWSER_EXTENSIONS_MESSAGE_BUNDLE_CACHE_H_
+#define CHROME_BROWSER_EXTENSIONS_MESSAGE_BUNDLE_CACHE_H_
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/file_path.h"
+#include "base/time.h"
+#include "chrome/common/extensions/extension_message_bundle.h"
+
+namespace extensions {
+
+// Caches the localized message substitution maps of extensions, so that
+// each renderer, content script reload and insertCSS call does not read and
+// parse the extension's messages.json files again. An entry is reused only
+// while the message files it was built from keep their modification times,
+// so edits to unpacked extensions are still picked up.
+//
+// Must be used on the FILE thread.
+class MessageBundleCache {
+ public:
+  MessageBundleCache();
+  ~MessageBundleCache();
+
+  // Returns the cache shared by the browser.
+  static MessageBundleCache* GetInstance();
+
+  // Same as extension_file_util::LoadExtensionMessageBundleSubstitutionMap(),
+  // but serves the map from the cache when it is still valid. The caller
+  // owns the returned map.
+  ExtensionMessageBundle::SubstitutionMap* GetSubstitutionMap(
+      const FilePath& extension_path,
+      const std::string& extension_id,
+      const std::string& default_locale);
+
+ private:
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    FilePath extension_path;
+    std::string default_locale;
+    std::string application_locale;
+    // Modification times of the message files that were looked up, in
+    // fallback order. A null time means the file did not exist.
+    std::vector<base::Time> file_times;
+    ExtensionMessageBundle::SubstitutionMap substitution_map;
+  };
+
+  // Keyed by extension id, so that an update replaces the old version.
+  typedef std::map<std::string, Entry> EntryMap;
+
+  // Returns the modification times of the message files that a bundle for
+  // |application_locale| would be built from.
+  static std::vector<base::Time> GetMessageFileTimes(
+      const FilePath& extension_path,
+      const std::string& default_locale,
+      const std::string& application_locale);
+
+  EntryMap entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(MessageBundleCache);
+};
+
+}  // namespace extensions
+
+#endif  // CHROME_BROWSER_EXTENSIONS_MESSAGE_BUNDLE_CACHE_H_
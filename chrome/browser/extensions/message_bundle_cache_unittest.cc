@@ -0,0 +1,95 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/extensions/message_bundle_cache.h"
+
+#include <string>
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/scoped_temp_dir.h"
+#include "base/time.h"
+#include "chrome/common/extensions/extension.h"
+#include "content/test/test_browser_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using content::BrowserThread;
+
+namespace extensions {
+
+namespace {
+
+const char kExtensionId[] = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa";
+
+class MessageBundleCacheTest : public testing::Test {
+ protected:
+  MessageBundleCacheTest()
+      : file_thread_(BrowserThread::FILE, &message_loop_) {
+  }
+
+  virtual void SetUp() {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    FilePath locale_dir = temp_dir_.path()
+        .Append(Extension::kLocaleFolder).AppendASCII("en");
+    ASSERT_TRUE(file_util::CreateDirectory(locale_dir));
+    messages_file_ = locale_dir.Append(Extension::kMessagesFilename);
+    file_time_ = base::Time::Now() - base::TimeDelta::FromHours(1);
+  }
+
+  // Writes a messages.json defining "greeting" as |greeting|, with
+  // |file_time_| as its modification time.
+  void WriteMessages(const std::string& greeting) {
+    std::string data =
+        "{ \"greeting\": { \"message\": \"" + greeting + "\" } }";
+    ASSERT_EQ(static_cast<int>(data.size()),
+              file_util::WriteFile(messages_file_, data.data(), data.size()));
+    ASSERT_TRUE(file_util::SetLastModifiedTime(messages_file_, file_time_));
+  }
+
+  std::string GetGreeting() {
+    scoped_ptr<ExtensionMessageBundle::SubstitutionMap> map(
+        cache_.GetSubstitutionMap(temp_dir_.path(), kExtensionId, "en"));
+    EXPECT_EQ(kExtensionId,
+              (*map)[ExtensionMessageBundle::kExtensionIdKey]);
+    return (*map)["greeting"];
+  }
+
+  MessageLoop message_loop_;
+  content::TestBrowserThread file_thread_;
+  ScopedTempDir temp_dir_;
+  FilePath messages_file_;
+  base::Time file_time_;
+  MessageBundleCache cache_;
+};
+
+}  // namespace
+
+TEST_F(MessageBundleCacheTest, ReusesBundleWhileFilesAreUnchanged) {
+  WriteMessages("hello");
+  EXPECT_EQ("hello", GetGreeting());
+
+  // Same modification time, so the cached bundle is still used.
+  WriteMessages("bye");
+  EXPECT_EQ("hello", GetGreeting());
+}
+
+TEST_F(MessageBundleCacheTest, ReloadsChangedFiles) {
+  WriteMessages("hello");
+  EXPECT_EQ("hello", GetGreeting());
+
+  file_time_ += base::TimeDelta::FromMinutes(1);
+  WriteMessages("bye");
+  EXPECT_EQ("bye", GetGreeting());
+}
+
+TEST_F(MessageBundleCacheTest, NonLocalizedExtension) {
+  scoped_ptr<ExtensionMessageBundle::SubstitutionMap> map(
+      cache_.GetSubstitutionMap(temp_dir_.path(), kExtensionId, ""));
+  EXPECT_EQ(1U, map->size());
+  EXPECT_EQ(kExtensionId, (*map)[ExtensionMessageBundle::kExtensionIdKey]);
+}
+
+}  // namespace extensions
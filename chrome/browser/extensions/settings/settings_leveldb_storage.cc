@@ -12,6 +12,7 @@
 #include "base/logging.h"
 #include "base/sys_string_conversions.h"
 #include "content/public/browser/browser_thread.h"
+#include "third_party/leveldatabase/env_chromium.h"
 #include "third_party/leveldatabase/src/include/leveldb/iterator.h"
 #include "third_party/leveldatabase/src/include/leveldb/write_batch.h"
 
@@ -62,6 +63,8 @@ SettingsStorage* SettingsLeveldbStorage::Factory::Create(
 
   leveldb::Options options;
   options.create_if_missing = true;
+  // There is a database per extension, so share one cache between them.
+  options.block_cache = leveldb_env::SharedBlockCache();
   leveldb::DB* db;
   leveldb::Status status = leveldb::DB::Open(options, os_path, &db);
   if (!status.ok()) {
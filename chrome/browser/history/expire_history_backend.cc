@@ -11,6 +11,7 @@
 #include "base/compiler_specific.h"
 #include "base/file_util.h"
 #include "base/message_loop.h"
+#include "base/metrics/histogram.h"
 #include "chrome/browser/bookmarks/bookmark_service.h"
 #include "chrome/browser/history/archived_database.h"
 #include "chrome/browser/history/history_database.h"
@@ -22,6 +23,7 @@
 
 using base::Time;
 using base::TimeDelta;
+using base::TimeTicks;
 
 namespace history {
 
@@ -143,6 +145,16 @@ const int kIndexExpirationDelayMin = 2;
 // the history index files.
 const int kStoreHistoryIndexesForMonths = 3;
 
+// The most time a slice of a sliced expiration spends deleting batches of
+// visits before letting the other history requests run.
+const int kExpireSliceBudgetMs = 5;
+
+// The bounds on the number of visits deleted by each batch of a sliced
+// expiration. The batch size starts at kNumExpirePerIteration and is adjusted
+// to how long the batches take, so that one batch fits in a slice's budget.
+const int kMinExpirePerBatch = 8;
+const int kMaxExpirePerBatch = 512;
+
 }  // namespace
 
 struct ExpireHistoryBackend::DeleteDependencies {
@@ -171,6 +183,25 @@ struct ExpireHistoryBackend::DeleteDependencies {
   TextDatabaseManager::ChangeSet text_db_changes;
 };
 
+struct ExpireHistoryBackend::SlicedExpiration {
+  SlicedExpiration();
+  ~SlicedExpiration();
+
+  std::set<GURL> restrict_urls;
+  base::Time begin_time, end_time;
+  ExpireProgressCallback progress;
+
+  // The number of visits removed so far.
+  int visits_expired;
+};
+
+ExpireHistoryBackend::SlicedExpiration::SlicedExpiration()
+    : visits_expired(0) {
+}
+
+ExpireHistoryBackend::SlicedExpiration::~SlicedExpiration() {
+}
+
 ExpireHistoryBackend::ExpireHistoryBackend(
     BroadcastNotificationDelegate* delegate,
     BookmarkService* bookmark_service)
@@ -180,7 +211,8 @@ ExpireHistoryBackend::ExpireHistoryBackend(
       thumb_db_(NULL),
       text_db_(NULL),
       ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)),
-      bookmark_service_(bookmark_service) {
+      bookmark_service_(bookmark_service),
+      expire_batch_size_(kNumExpirePerIteration) {
 }
 
 ExpireHistoryBackend::~ExpireHistoryBackend() {
@@ -249,26 +281,53 @@ void ExpireHistoryBackend::ExpireHistoryBetween(
   if (text_db_)
     text_db_->DeleteFromUncommitted(restrict_urls, begin_time, end_time);
 
-  // Find the affected visits and delete them.
-  // TODO(brettw): bug 1171164: We should query the archived database here, too.
   VisitVector visits;
-  main_db_->GetAllVisitsInRange(begin_time, end_time, 0, &visits);
-  if (!restrict_urls.empty()) {
-    std::set<URLID> url_ids;
-    for (std::set<GURL>::const_iterator url = restrict_urls.begin();
-        url != restrict_urls.end(); ++url)
-      url_ids.insert(main_db_->GetRowForURL(*url, NULL));
-    VisitVector all_visits;
-    all_visits.swap(visits);
-    for (VisitVector::iterator visit = all_visits.begin();
-         visit != all_visits.end(); ++visit) {
-      if (url_ids.find(visit->url_id) != url_ids.end())
-        visits.push_back(*visit);
-    }
-  }
+  GetVisitsBetween(restrict_urls, begin_time, end_time, &visits);
   ExpireVisits(visits);
 }
 
+void ExpireHistoryBackend::ExpireHistoryBetweenInSlices(
+    const std::set<GURL>& restrict_urls,
+    Time begin_time,
+    Time end_time,
+    const ExpireProgressCallback& progress) {
+  // There may be stuff in the text database manager's temporary cache.
+  if (text_db_)
+    text_db_->DeleteFromUncommitted(restrict_urls, begin_time, end_time);
+
+  SlicedExpiration expiration;
+  expiration.restrict_urls = restrict_urls;
+  expiration.begin_time = begin_time;
+  expiration.end_time = end_time;
+  expiration.progress = progress;
+  sliced_expirations_.push(expiration);
+  if (sliced_expirations_.size() == 1)
+    ScheduleExpireSlice();
+}
+
+void ExpireHistoryBackend::GetVisitsBetween(
+    const std::set<GURL>& restrict_urls,
+    Time begin_time,
+    Time end_time,
+    VisitVector* visits) {
+  // TODO(brettw): bug 1171164: We should query the archived database here, too.
+  main_db_->GetAllVisitsInRange(begin_time, end_time, 0, visits);
+  if (restrict_urls.empty())
+    return;
+
+  std::set<URLID> url_ids;
+  for (std::set<GURL>::const_iterator url = restrict_urls.begin();
+      url != restrict_urls.end(); ++url)
+    url_ids.insert(main_db_->GetRowForURL(*url, NULL));
+  VisitVector all_visits;
+  all_visits.swap(*visits);
+  for (VisitVector::iterator visit = all_visits.begin();
+       visit != all_visits.end(); ++visit) {
+    if (url_ids.find(visit->url_id) != url_ids.end())
+      visits->push_back(*visit);
+  }
+}
+
 void ExpireHistoryBackend::ExpireVisits(const VisitVector& visits) {
   if (visits.empty())
     return;
@@ -576,6 +635,64 @@ void ExpireHistoryBackend::ArchiveURLsAndVisits(
   }
 }
 
+void ExpireHistoryBackend::ScheduleExpireSlice() {
+  // Posting each slice to the back of the queue lets the requests made since
+  // the last one run first.
+  MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&ExpireHistoryBackend::DoExpireSlice,
+                 weak_factory_.GetWeakPtr()));
+}
+
+void ExpireHistoryBackend::DoExpireSlice() {
+  DCHECK(!sliced_expirations_.empty());
+  SlicedExpiration& expiration = sliced_expirations_.front();
+  TimeTicks slice_start = TimeTicks::Now();
+  bool done = !main_db_;
+
+  if (!done && !expiration.restrict_urls.empty()) {
+    // The visits to a few URLs aren't worth slicing.
+    VisitVector visits;
+    GetVisitsBetween(expiration.restrict_urls, expiration.begin_time,
+                     expiration.end_time, &visits);
+    ExpireVisits(visits);
+    expiration.visits_expired += static_cast<int>(visits.size());
+    done = true;
+  }
+
+  // Delete the oldest visits left in the range until the budget is used up.
+  TimeDelta budget = TimeDelta::FromMilliseconds(kExpireSliceBudgetMs);
+  while (!done && TimeTicks::Now() - slice_start < budget) {
+    TimeTicks batch_start = TimeTicks::Now();
+    VisitVector visits;
+    main_db_->GetAllVisitsInRange(expiration.begin_time, expiration.end_time,
+                                  expire_batch_size_, &visits);
+    ExpireVisits(visits);
+    expiration.visits_expired += static_cast<int>(visits.size());
+    done = static_cast<int>(visits.size()) < expire_batch_size_;
+
+    // Keep each batch well within the budget.
+    TimeDelta batch_time = TimeTicks::Now() - batch_start;
+    if (batch_time > budget / 2)
+      expire_batch_size_ = std::max(expire_batch_size_ / 2, kMinExpirePerBatch);
+    else if (batch_time < budget / 8)
+      expire_batch_size_ = std::min(expire_batch_size_ * 2, kMaxExpirePerBatch);
+  }
+  UMA_HISTOGRAM_TIMES("History.ExpireSliceTime",
+                      TimeTicks::Now() - slice_start);
+
+  ExpireProgressCallback progress(expiration.progress);
+  int visits_expired = expiration.visits_expired;
+  if (done) {
+    UMA_HISTOGRAM_COUNTS("History.ExpireSlicedVisits", visits_expired);
+    sliced_expirations_.pop();
+  }
+  if (!sliced_expirations_.empty())
+    ScheduleExpireSlice();
+  if (!progress.is_null())
+    progress.Run(visits_expired, done);
+}
+
 void ExpireHistoryBackend::ScheduleArchive() {
   TimeDelta delay;
   if (work_queue_.empty()) {
@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/callback.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
@@ -61,6 +62,11 @@ typedef std::vector<const ExpiringVisitsReader*> ExpiringVisitsReaders;
 // StartArchivingOldStuff().
 class ExpireHistoryBackend {
  public:
+  // Run after each slice of a sliced expiration with the number of visits it
+  // has removed so far, and whether it is done.
+  typedef base::Callback<void(int visits_expired, bool done)>
+      ExpireProgressCallback;
+
   // The delegate pointer must be non-NULL. We will NOT take ownership of it.
   // BookmarkService may be NULL. The BookmarkService is used when expiring
   // URLs so that we don't remove any URLs or favicons that are bookmarked
@@ -90,6 +96,17 @@ class ExpireHistoryBackend {
   void ExpireHistoryBetween(const std::set<GURL>& restrict_urls,
                             base::Time begin_time, base::Time end_time);
 
+  // Like ExpireHistoryBetween(), but removes the visits a batch at a time in
+  // short slices, each posted to the current message loop, so that removing
+  // years of history doesn't hold up the requests made meanwhile. |progress|
+  // (which may be null) is run after every slice. Expirations started while
+  // one is under way are queued behind it, and any left are dropped when this
+  // object is deleted.
+  void ExpireHistoryBetweenInSlices(const std::set<GURL>& restrict_urls,
+                                    base::Time begin_time,
+                                    base::Time end_time,
+                                    const ExpireProgressCallback& progress);
+
   // Removes the given list of visits, updating the URLs accordingly (similar to
   // ExpireHistoryBetween(), but affecting a specific set of visits).
   void ExpireVisits(const VisitVector& visits);
@@ -115,6 +132,14 @@ class ExpireHistoryBackend {
   friend class ::TestingProfile;
 
   struct DeleteDependencies;
+  struct SlicedExpiration;
+
+  // Fills |visits| with the visits to |restrict_urls| (or all URLs if empty)
+  // in the given time range.
+  void GetVisitsBetween(const std::set<GURL>& restrict_urls,
+                        base::Time begin_time,
+                        base::Time end_time,
+                        VisitVector* visits);
 
   // Deletes the visit-related stuff for all the visits in the given list, and
   // adds the rows for unique URLs affected to the affected_urls list in
@@ -198,6 +223,14 @@ class ExpireHistoryBackend {
   // Broadcast the URL deleted notification.
   void BroadcastDeleteNotifications(DeleteDependencies* dependencies);
 
+  // Schedules a call to DoExpireSlice.
+  void ScheduleExpireSlice();
+
+  // Removes batches of visits for the first of |sliced_expirations_| until the
+  // slice's time budget is used up, reports its progress, and schedules the
+  // next slice if there is more to do.
+  void DoExpireSlice();
+
   // Schedules a call to DoArchiveIteration.
   void ScheduleArchive();
 
@@ -278,6 +311,14 @@ class ExpireHistoryBackend {
   // loaded.
   BookmarkService* bookmark_service_;
 
+  // The expirations started by ExpireHistoryBetweenInSlices() which haven't
+  // finished, in the order they were started.
+  std::queue<SlicedExpiration> sliced_expirations_;
+
+  // The number of visits removed by each batch of a sliced expiration, adapted
+  // to how long the previous batches took.
+  int expire_batch_size_;
+
   DISALLOW_COPY_AND_ASSIGN(ExpireHistoryBackend);
 };
 
@@ -7,6 +7,7 @@
 #include <utility>
 
 #include "base/basictypes.h"
+#include "base/bind.h"
 #include "base/compiler_specific.h"
 #include "base/file_path.h"
 #include "base/file_util.h"
@@ -775,6 +776,83 @@ TEST_F(ExpireHistoryTest, FlushRecentURLsStarred) {
   // EXPECT_TRUE(HasThumbnail(new_url_row2.id()));
 }
 
+// Records the progress reported by a sliced expiration.
+class ExpireProgressRecorder {
+ public:
+  ExpireProgressRecorder() : slices_(0), visits_expired_(0), done_(false) {}
+
+  void OnProgress(int visits_expired, bool done) {
+    EXPECT_FALSE(done_);
+    EXPECT_GE(visits_expired, visits_expired_);
+    ++slices_;
+    visits_expired_ = visits_expired;
+    done_ = done;
+  }
+
+  int slices() const { return slices_; }
+  int visits_expired() const { return visits_expired_; }
+  bool done() const { return done_; }
+
+ private:
+  int slices_;
+  int visits_expired_;
+  bool done_;
+
+  DISALLOW_COPY_AND_ASSIGN(ExpireProgressRecorder);
+};
+
+// Expires many visits in slices, queued behind a restricted expiration.
+TEST_F(ExpireHistoryTest, FlushRecentURLsInSlices) {
+  URLID url_ids[3];
+  Time visit_times[4];
+  AddExampleData(url_ids, visit_times);
+
+  URLRow url_row1, url_row2;
+  ASSERT_TRUE(main_db_->GetURLRow(url_ids[1], &url_row1));
+  ASSERT_TRUE(main_db_->GetURLRow(url_ids[2], &url_row2));
+
+  // Give the last URL more visits than fit in a batch.
+  const int kExtraVisits = 1000;
+  for (int i = 0; i < kExtraVisits; ++i) {
+    VisitRow visit(url_ids[2],
+                   visit_times[2] + TimeDelta::FromMilliseconds(i + 1), 0,
+                   content::PAGE_TRANSITION_LINK, 0);
+    main_db_->AddVisit(&visit, SOURCE_BROWSED);
+  }
+
+  // Neither expiration does anything until the message loop runs.
+  std::set<GURL> restrict_urls;
+  restrict_urls.insert(url_row1.url());
+  ExpireProgressRecorder restricted_progress;
+  expirer_.ExpireHistoryBetweenInSlices(
+      restrict_urls, visit_times[2], Time(),
+      base::Bind(&ExpireProgressRecorder::OnProgress,
+                 base::Unretained(&restricted_progress)));
+  ExpireProgressRecorder progress;
+  expirer_.ExpireHistoryBetweenInSlices(
+      std::set<GURL>(), visit_times[2], Time(),
+      base::Bind(&ExpireProgressRecorder::OnProgress,
+                 base::Unretained(&progress)));
+  VisitVector visits;
+  main_db_->GetVisitsForURL(url_ids[2], &visits);
+  EXPECT_EQ(static_cast<size_t>(kExtraVisits + 1), visits.size());
+
+  while (!progress.done())
+    message_loop_.RunAllPending();
+
+  // The restricted expiration took a single slice and finished first.
+  EXPECT_TRUE(restricted_progress.done());
+  EXPECT_EQ(1, restricted_progress.slices());
+  EXPECT_EQ(1, restricted_progress.visits_expired());
+  EXPECT_EQ(kExtraVisits + 1, progress.visits_expired());
+
+  // The middle URL lost its last visit, and the last URL was deleted.
+  visits.clear();
+  main_db_->GetVisitsForURL(url_ids[1], &visits);
+  EXPECT_EQ(1U, visits.size());
+  EnsureURLInfoGone(url_row2);
+}
+
 TEST_F(ExpireHistoryTest, ArchiveHistoryBeforeUnstarred) {
   URLID url_ids[3];
   Time visit_times[4];
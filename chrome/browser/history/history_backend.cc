@@ -217,6 +217,11 @@ HistoryBackend::~HistoryBackend() {
   DCHECK(!scheduled_commit_) << "Deleting without cleanup";
   ReleaseDBTasks();
 
+  // Pages waiting to be full-text indexed look up their visits in the main
+  // database, so write them before it goes away.
+  if (text_database_.get())
+    text_database_->FlushPendingPages();
+
   // First close the databases before optionally running the "destroy" task.
   if (db_.get()) {
     // Commit the long-running transaction.
@@ -1237,7 +1242,8 @@ void HistoryBackend::QueryHistory(scoped_refptr<QueryHistoryRequest> request,
       //     expirer_.GetCurrentArchiveTime() - TimeDelta::FromDays(7)) {
     } else {
       // Full text history query.
-      QueryHistoryFTS(text_query, options, &request->value);
+      QueryHistoryFTS(text_query, options, request->canceled_flag(),
+                      &request->value);
     }
   }
 
@@ -1299,16 +1305,18 @@ void HistoryBackend::QueryHistoryBasic(URLDatabase* url_db,
     result->set_reached_beginning(true);
 }
 
-void HistoryBackend::QueryHistoryFTS(const string16& text_query,
-                                     const QueryOptions& options,
-                                     QueryResults* result) {
+void HistoryBackend::QueryHistoryFTS(
+    const string16& text_query,
+    const QueryOptions& options,
+    const base::CancellationFlag* cancel_flag,
+    QueryResults* result) {
   if (!text_database_.get())
     return;
 
   // Full text query, first get all the FTS results in the time range.
   std::vector<TextDatabase::Match> fts_matches;
   Time first_time_searched;
-  text_database_->GetTextMatches(text_query, options,
+  text_database_->GetTextMatches(text_query, options, cancel_flag,
                                  &fts_matches, &first_time_searched);
 
   URLQuerier querier(db_.get(), archived_db_.get(), true);
@@ -2176,15 +2184,46 @@ void HistoryBackend::ExpireHistoryBetween(
       // possibility of an information leak.
       DeleteAllHistory();
     } else {
-      // Clearing parts of history, have the expirer do the depend
-      expirer_.ExpireHistoryBetween(restrict_urls, begin_time, end_time);
-
-      // Force a commit, if the user is deleting something for privacy reasons,
-      // we want to get it on disk ASAP.
-      Commit();
+      // Clearing parts of history, have the expirer do the depend. It works in
+      // slices so that a large deletion doesn't hold up the lookups made
+      // meanwhile, and the request is answered once it is done. The expirer
+      // drops its pending work when it is deleted along with us.
+      expirer_.ExpireHistoryBetweenInSlices(
+          restrict_urls, begin_time, end_time,
+          base::Bind(&HistoryBackend::OnExpireHistoryProgress,
+                     base::Unretained(this), request, restrict_urls,
+                     begin_time, end_time));
+      return;
     }
   }
 
+  FinishExpireHistoryBetween(request, restrict_urls, begin_time, end_time);
+}
+
+void HistoryBackend::OnExpireHistoryProgress(
+    scoped_refptr<CancelableRequest<base::Closure> > request,
+    const std::set<GURL>& restrict_urls,
+    Time begin_time,
+    Time end_time,
+    int visits_expired,
+    bool done) {
+  if (!done) {
+    // Write what has been deleted so far soon, without a commit every slice.
+    ScheduleCommit();
+    return;
+  }
+
+  // Force a commit, if the user is deleting something for privacy reasons,
+  // we want to get it on disk ASAP.
+  Commit();
+  FinishExpireHistoryBetween(request, restrict_urls, begin_time, end_time);
+}
+
+void HistoryBackend::FinishExpireHistoryBetween(
+    scoped_refptr<CancelableRequest<base::Closure> > request,
+    const std::set<GURL>& restrict_urls,
+    Time begin_time,
+    Time end_time) {
   if (begin_time <= first_recorded_time_)
     db_->GetStartDate(&first_recorded_time_);
 
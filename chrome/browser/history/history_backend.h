@@ -344,7 +344,8 @@ class HistoryBackend : public base::RefCountedThreadSafe<HistoryBackend>,
 
   virtual void DeleteURL(const GURL& url);
 
-  // Calls ExpireHistoryBackend::ExpireHistoryBetween and commits the change.
+  // Calls ExpireHistoryBackend::ExpireHistoryBetweenInSlices and commits the
+  // change when it is done.
   void ExpireHistoryBetween(
       scoped_refptr<CancelableRequest<base::Closure> > request,
       const std::set<GURL>& restrict_urls,
@@ -469,12 +470,14 @@ class HistoryBackend : public base::RefCountedThreadSafe<HistoryBackend>,
 
   // Backends for QueryHistory. *Basic() handles queries that are not FTS (full
   // text search) queries and can just be given directly to the history DB).
-  // The FTS version queries the text_database, then merges with the history DB.
-  // Both functions assume QueryHistory already checked the DB for validity.
+  // The FTS version queries the text_database, then merges with the history DB,
+  // giving up early if |cancel_flag| is set. Both functions assume
+  // QueryHistory already checked the DB for validity.
   void QueryHistoryBasic(URLDatabase* url_db, VisitDatabase* visit_db,
                          const QueryOptions& options, QueryResults* result);
   void QueryHistoryFTS(const string16& text_query,
                        const QueryOptions& options,
+                       const base::CancellationFlag* cancel_flag,
                        QueryResults* result);
 
   // Committing ----------------------------------------------------------------
@@ -564,6 +567,25 @@ class HistoryBackend : public base::RefCountedThreadSafe<HistoryBackend>,
   // so we need to handle this type of operation to keep the pointers in sync.
   void DeleteAllHistory();
 
+  // Called by the expirer after each slice of the expiration started by
+  // ExpireHistoryBetween(). Schedules a commit of the slice, and when |done|,
+  // commits and calls FinishExpireHistoryBetween().
+  void OnExpireHistoryProgress(
+      scoped_refptr<CancelableRequest<base::Closure> > request,
+      const std::set<GURL>& restrict_urls,
+      base::Time begin_time,
+      base::Time end_time,
+      int visits_expired,
+      bool done);
+
+  // Updates the first recorded time after history was expired, answers the
+  // request and tells the history publisher.
+  void FinishExpireHistoryBetween(
+      scoped_refptr<CancelableRequest<base::Closure> > request,
+      const std::set<GURL>& restrict_urls,
+      base::Time begin_time,
+      base::Time end_time);
+
   // Given a vector of all URLs that we will keep, removes all thumbnails
   // referenced by any URL, and also all favicons that aren't used by those
   // URLs. The favicon IDs will change, so this will update the url rows in the
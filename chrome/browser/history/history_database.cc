@@ -57,6 +57,12 @@ void ComputeDatabaseMetrics(const FilePath& history_name,
   if (!visit_count.Step())
     return;
   UMA_HISTOGRAM_COUNTS("History.VisitTableCount", visit_count.ColumnInt(0));
+
+  sql::Connection::MemoryUsage memory_usage;
+  if (!db.GetMemoryUsage(&memory_usage))
+    return;
+  UMA_HISTOGRAM_MEMORY_KB("History.DatabaseCacheKB",
+                          memory_usage.page_cache / 1024);
 }
 
 }  // namespace
@@ -4,15 +4,37 @@
 
 #include "chrome/browser/history/in_memory_database.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "base/file_path.h"
 #include "base/logging.h"
 #include "base/metrics/histogram.h"
 #include "base/time.h"
 #include "base/utf_string_conversions.h"
 #include "build/build_config.h"
+#include "googleurl/src/gurl.h"
 
 namespace history {
 
+namespace {
+
+// Orders autocomplete results like the SQL query of
+// URLDatabase::AutocompleteForPrefix().
+bool MoreRelevantForAutocomplete(const URLRow* a, const URLRow* b) {
+  if (a->typed_count() != b->typed_count())
+    return a->typed_count() > b->typed_count();
+  if (a->visit_count() != b->visit_count())
+    return a->visit_count() > b->visit_count();
+  return a->last_visit() > b->last_visit();
+}
+
+bool StartsWith(const std::string& str, const std::string& prefix) {
+  return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+}  // namespace
+
 InMemoryDatabase::InMemoryDatabase() : URLDatabase() {
 }
 
@@ -141,11 +163,132 @@ bool InMemoryDatabase::InitFromDisk(const FilePath& history_name) {
   CreateMainURLIndex();
   CreateKeywordSearchTermsIndices();
 
+  begin_load = base::TimeTicks::Now();
+  URLEnumerator enumerator;
+  if (InitURLEnumeratorForEverything(&enumerator)) {
+    URLRow row;
+    while (enumerator.GetNextURL(&row))
+      IndexRow(row);
+  }
+  UMA_HISTOGRAM_TIMES("History.InMemoryDBIndexPopulate",
+                      base::TimeTicks::Now() - begin_load);
+
   return true;
 }
 
+bool InMemoryDatabase::GetURLRow(URLID url_id, URLRow* info) {
+  URLIDMap::const_iterator url = urls_by_id_.find(url_id);
+  if (url == urls_by_id_.end())
+    return false;
+  *info = rows_[url->second];
+  return true;
+}
+
+URLID InMemoryDatabase::GetRowForURL(const GURL& url, URLRow* info) {
+  URLRowMap::const_iterator row = rows_.find(GURLToDatabaseURL(url));
+  if (row == rows_.end())
+    return 0;
+  if (info)
+    *info = row->second;
+  return row->second.id();
+}
+
+bool InMemoryDatabase::UpdateURLRow(URLID url_id, const URLRow& info) {
+  if (!URLDatabase::UpdateURLRow(url_id, info))
+    return false;
+
+  // Like the table, the index keeps the URL of the row.
+  URLIDMap::const_iterator url = urls_by_id_.find(url_id);
+  if (url != urls_by_id_.end()) {
+    URLRow& row = rows_[url->second];
+    row.set_title(info.title());
+    row.set_visit_count(info.visit_count());
+    row.set_typed_count(info.typed_count());
+    row.set_last_visit(info.last_visit());
+    row.set_hidden(info.hidden());
+  }
+  return true;
+}
+
+bool InMemoryDatabase::DeleteURLRow(URLID id) {
+  URLIDMap::iterator url = urls_by_id_.find(id);
+  if (url != urls_by_id_.end()) {
+    rows_.erase(url->second);
+    urls_by_id_.erase(url);
+  }
+  return URLDatabase::DeleteURLRow(id);
+}
+
+bool InMemoryDatabase::AutocompleteForPrefix(const std::string& prefix,
+                                             size_t max_results,
+                                             bool typed_only,
+                                             URLRows* results) {
+  results->clear();
+  std::vector<const URLRow*> matches;
+  for (URLRowMap::const_iterator i = rows_.lower_bound(prefix);
+       i != rows_.end() && StartsWith(i->first, prefix); ++i) {
+    const URLRow& row = i->second;
+    if (!row.hidden() && (!typed_only || row.typed_count() > 0))
+      matches.push_back(&row);
+  }
+
+  size_t count = std::min(matches.size(), max_results);
+  std::partial_sort(matches.begin(), matches.begin() + count, matches.end(),
+                    &MoreRelevantForAutocomplete);
+  for (size_t i = 0; i < count; ++i) {
+    if (matches[i]->url().is_valid())
+      results->push_back(*matches[i]);
+  }
+  return !results->empty();
+}
+
+bool InMemoryDatabase::FindShortestURLFromBase(const std::string& base,
+                                               const std::string& url,
+                                               int min_visits,
+                                               int min_typed,
+                                               bool allow_base,
+                                               URLRow* info) {
+  // The shortest prefix of |url| sorts first, so the first match wins.
+  URLRowMap::const_iterator i =
+      allow_base ? rows_.lower_bound(base) : rows_.upper_bound(base);
+  for (; i != rows_.end() && i->first < url; ++i) {
+    const URLRow& row = i->second;
+    if (StartsWith(url, i->first) && !row.hidden() &&
+        row.visit_count() >= min_visits && row.typed_count() >= min_typed) {
+      DCHECK(info);
+      *info = row;
+      return true;
+    }
+  }
+  return false;
+}
+
 sql::Connection& InMemoryDatabase::GetDB() {
   return db_;
 }
 
+URLID InMemoryDatabase::AddURLInternal(const URLRow& info, bool is_temporary) {
+  URLID id = URLDatabase::AddURLInternal(info, is_temporary);
+  if (id && !is_temporary) {
+    // Index the row the way it reads back from the table.
+    URLRow row(GURL(GURLToDatabaseURL(info.url())), id);
+    row.set_title(info.title());
+    row.set_visit_count(info.visit_count());
+    row.set_typed_count(info.typed_count());
+    row.set_last_visit(info.last_visit());
+    row.set_hidden(info.hidden());
+    IndexRow(row);
+  }
+  return id;
+}
+
+void InMemoryDatabase::IndexRow(const URLRow& row) {
+  const std::string& url = row.url().possibly_invalid_spec();
+  URLRowMap::iterator old_row = rows_.find(url);
+  if (old_row != rows_.end())
+    urls_by_id_.erase(old_row->second.id());
+  rows_[url] = row;
+  urls_by_id_[row.id()] = url;
+}
+
 }  // namespace history
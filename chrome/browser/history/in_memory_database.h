@@ -6,7 +6,11 @@
 #define CHROME_BROWSER_HISTORY_IN_MEMORY_DATABASE_H_
 #pragma once
 
+#include <map>
+#include <string>
+
 #include "base/basictypes.h"
+#include "base/hash_tables.h"
 #include "chrome/browser/history/url_database.h"
 #include "sql/connection.h"
 
@@ -17,6 +21,11 @@ namespace history {
 // Class used for a fast in-memory cache of typed URLs. Used for inline
 // autocomplete since it is fast enough to be called synchronously as the user
 // is typing.
+//
+// The urls table is mirrored in an index sorted by URL, with a hash from row
+// ID to URL, and the URL lookups done while the user types are answered from
+// that index without running any SQL. The table itself is still kept for the
+// keyword search term queries, which join with it.
 class InMemoryDatabase : public URLDatabase {
  public:
   InMemoryDatabase();
@@ -31,17 +40,44 @@ class InMemoryDatabase : public URLDatabase {
   // much slower.
   bool InitFromDisk(const FilePath& history_name);
 
+  // URLDatabase overrides, served from or kept in sync with the index.
+  virtual bool GetURLRow(URLID url_id, URLRow* info) OVERRIDE;
+  virtual URLID GetRowForURL(const GURL& url, URLRow* info) OVERRIDE;
+  virtual bool UpdateURLRow(URLID url_id, const URLRow& info) OVERRIDE;
+  virtual bool DeleteURLRow(URLID id) OVERRIDE;
+  virtual bool AutocompleteForPrefix(const std::string& prefix,
+                                     size_t max_results,
+                                     bool typed_only,
+                                     URLRows* results) OVERRIDE;
+  virtual bool FindShortestURLFromBase(const std::string& base,
+                                       const std::string& url,
+                                       int min_visits,
+                                       int min_typed,
+                                       bool allow_base,
+                                       URLRow* info) OVERRIDE;
+
  protected:
   // Implemented for URLDatabase.
   virtual sql::Connection& GetDB() OVERRIDE;
+  virtual URLID AddURLInternal(const URLRow& info, bool is_temporary) OVERRIDE;
 
  private:
+  // Rows keyed by their URL as stored in the database.
+  typedef std::map<std::string, URLRow> URLRowMap;
+  typedef base::hash_map<URLID, std::string> URLIDMap;
+
   // Initializes the database connection, this is the shared code between
   // InitFromScratch() and InitFromDisk() above. Returns true on success.
   bool InitDB();
 
+  // Adds |row| to the index, replacing any row with the same URL.
+  void IndexRow(const URLRow& row);
+
   sql::Connection db_;
 
+  URLRowMap rows_;
+  URLIDMap urls_by_id_;
+
   DISALLOW_COPY_AND_ASSIGN(InMemoryDatabase);
 };
 
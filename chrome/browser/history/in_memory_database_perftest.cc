@@ -0,0 +1,97 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times the URL lookups inline autocomplete makes for every keystroke, once
+// answered by the index of InMemoryDatabase and once by its SQL table.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/stringprintf.h"
+#include "base/test/perf_benchmark.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "chrome/browser/history/in_memory_database.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace history {
+
+namespace {
+
+const int kNumURLs = 2000;
+
+// What a user typing "http://www.site42.com/page" queries, one keystroke at a
+// time, starting after the scheme.
+const char kTypedURL[] = "http://www.site42.com/page";
+const size_t kFirstTypedPrefix = 8;
+
+void AutocompleteWithIndex(InMemoryDatabase* db) {
+  std::string typed(kTypedURL);
+  URLRows results;
+  for (size_t i = kFirstTypedPrefix; i <= typed.size(); ++i)
+    db->AutocompleteForPrefix(typed.substr(0, i), 3, true, &results);
+}
+
+void AutocompleteWithSQL(InMemoryDatabase* db) {
+  std::string typed(kTypedURL);
+  URLRows results;
+  for (size_t i = kFirstTypedPrefix; i <= typed.size(); ++i) {
+    db->URLDatabase::AutocompleteForPrefix(typed.substr(0, i), 3, true,
+                                           &results);
+  }
+}
+
+void GetRowsWithIndex(InMemoryDatabase* db) {
+  for (int i = 0; i < 100; ++i) {
+    db->GetRowForURL(
+        GURL(base::StringPrintf("http://www.site%d.com/page%d", i, i)), NULL);
+  }
+}
+
+void GetRowsWithSQL(InMemoryDatabase* db) {
+  for (int i = 0; i < 100; ++i) {
+    db->URLDatabase::GetRowForURL(
+        GURL(base::StringPrintf("http://www.site%d.com/page%d", i, i)), NULL);
+  }
+}
+
+}  // namespace
+
+class InMemoryDatabasePerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_TRUE(db_.InitFromScratch());
+    base::Time now = base::Time::Now();
+    for (int i = 0; i < kNumURLs; ++i) {
+      URLRow row(GURL(base::StringPrintf("http://www.site%d.com/page%d",
+                                         i % 200, i)));
+      row.set_title(UTF8ToUTF16(base::StringPrintf("Page %d", i)));
+      row.set_visit_count(i % 13 + 1);
+      row.set_typed_count(i % 4);
+      row.set_last_visit(now - base::TimeDelta::FromMinutes(i));
+      ASSERT_TRUE(db_.AddURL(row));
+    }
+  }
+
+  InMemoryDatabase db_;
+};
+
+TEST_F(InMemoryDatabasePerfTest, AutocompleteForPrefix) {
+  base::PerfBenchmark index_benchmark("InMemoryDatabase_autocomplete_index");
+  index_benchmark.Run(base::Bind(&AutocompleteWithIndex, &db_));
+
+  base::PerfBenchmark sql_benchmark("InMemoryDatabase_autocomplete_sql");
+  sql_benchmark.Run(base::Bind(&AutocompleteWithSQL, &db_));
+}
+
+TEST_F(InMemoryDatabasePerfTest, GetRowForURL) {
+  base::PerfBenchmark index_benchmark("InMemoryDatabase_get_row_index");
+  index_benchmark.Run(base::Bind(&GetRowsWithIndex, &db_));
+
+  base::PerfBenchmark sql_benchmark("InMemoryDatabase_get_row_sql");
+  sql_benchmark.Run(base::Bind(&GetRowsWithSQL, &db_));
+}
+
+}  // namespace history
@@ -0,0 +1,154 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "chrome/browser/history/in_memory_database.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::Time;
+using base::TimeDelta;
+
+namespace history {
+
+class InMemoryDatabaseTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    now_ = Time::Now();
+    ASSERT_TRUE(db_.InitFromScratch());
+  }
+
+  URLID AddURL(const std::string& spec, int visit_count, int typed_count,
+               bool hidden, int hours_ago) {
+    URLRow row((GURL(spec)));
+    row.set_title(UTF8ToUTF16(spec));
+    row.set_visit_count(visit_count);
+    row.set_typed_count(typed_count);
+    row.set_hidden(hidden);
+    row.set_last_visit(now_ - TimeDelta::FromHours(hours_ago));
+    return db_.AddURL(row);
+  }
+
+  // Adds rows whose order is fully determined by the autocomplete sort keys.
+  void AddManyURLs() {
+    for (int i = 0; i < 60; ++i) {
+      AddURL(base::StringPrintf("http://www.site%d.com/page%d", i % 7, i),
+             i % 5 + 1, i % 3, i % 11 == 0, i);
+    }
+    AddURL("http://www.site1.com/", 1, 1, false, 100);
+    AddURL("http://www.site1.com/page", 2, 0, false, 101);
+  }
+
+  // Expects the index and the SQL table to answer |prefix| the same way.
+  void ExpectSameAutocomplete(const std::string& prefix, size_t max_results,
+                              bool typed_only) {
+    URLRows indexed, from_sql;
+    bool found = db_.AutocompleteForPrefix(prefix, max_results, typed_only,
+                                           &indexed);
+    EXPECT_EQ(db_.URLDatabase::AutocompleteForPrefix(prefix, max_results,
+                                                     typed_only, &from_sql),
+              found) << prefix;
+    ASSERT_EQ(from_sql.size(), indexed.size()) << prefix;
+    for (size_t i = 0; i < indexed.size(); ++i) {
+      EXPECT_EQ(from_sql[i].id(), indexed[i].id()) << prefix;
+      EXPECT_EQ(from_sql[i].url(), indexed[i].url()) << prefix;
+    }
+  }
+
+  // Expects the index and the SQL table to find the same shortest URL.
+  void ExpectSameShortestURL(const std::string& base, const std::string& url,
+                             int min_visits, int min_typed, bool allow_base) {
+    URLRow indexed, from_sql;
+    bool found = db_.FindShortestURLFromBase(base, url, min_visits, min_typed,
+                                             allow_base, &indexed);
+    EXPECT_EQ(db_.URLDatabase::FindShortestURLFromBase(
+                  base, url, min_visits, min_typed, allow_base, &from_sql),
+              found) << url;
+    if (found)
+      EXPECT_EQ(from_sql.id(), indexed.id()) << url;
+  }
+
+  Time now_;
+  InMemoryDatabase db_;
+};
+
+TEST_F(InMemoryDatabaseTest, AddUpdateDelete) {
+  const GURL url("http://www.google.com/");
+  URLID id = AddURL(url.spec(), 3, 1, false, 1);
+  ASSERT_TRUE(id);
+
+  URLRow row;
+  EXPECT_EQ(id, db_.GetRowForURL(url, &row));
+  EXPECT_EQ(url, row.url());
+  EXPECT_EQ(3, row.visit_count());
+  EXPECT_TRUE(db_.GetURLRow(id, &row));
+  EXPECT_EQ(url, row.url());
+
+  row.set_typed_count(5);
+  row.set_title(UTF8ToUTF16("Google"));
+  EXPECT_TRUE(db_.UpdateURLRow(id, row));
+  URLRow updated;
+  EXPECT_EQ(id, db_.GetRowForURL(url, &updated));
+  EXPECT_EQ(5, updated.typed_count());
+  EXPECT_EQ(UTF8ToUTF16("Google"), updated.title());
+
+  // Updates never change the URL of a row.
+  URLRow moved(GURL("http://www.example.com/"));
+  moved.set_visit_count(7);
+  EXPECT_TRUE(db_.UpdateURLRow(id, moved));
+  EXPECT_EQ(id, db_.GetRowForURL(url, &updated));
+  EXPECT_EQ(url, updated.url());
+  EXPECT_EQ(7, updated.visit_count());
+  EXPECT_EQ(0, db_.GetRowForURL(GURL("http://www.example.com/"), NULL));
+
+  EXPECT_TRUE(db_.DeleteURLRow(id));
+  EXPECT_EQ(0, db_.GetRowForURL(url, NULL));
+  EXPECT_FALSE(db_.GetURLRow(id, &row));
+  EXPECT_EQ(0, db_.URLDatabase::GetRowForURL(url, NULL));
+}
+
+TEST_F(InMemoryDatabaseTest, AutocompleteMatchesSQL) {
+  AddManyURLs();
+  const char* kPrefixes[] = {
+    "", "http://", "http://www.site1.com/", "http://www.site1.com/page",
+    "http://www.site3.com/page2", "http://www.nosuchsite.com/",
+  };
+  for (size_t i = 0; i < arraysize(kPrefixes); ++i) {
+    ExpectSameAutocomplete(kPrefixes[i], 1, false);
+    ExpectSameAutocomplete(kPrefixes[i], 1, true);
+    ExpectSameAutocomplete(kPrefixes[i], 5, false);
+    ExpectSameAutocomplete(kPrefixes[i], 5, true);
+    ExpectSameAutocomplete(kPrefixes[i], 100, true);
+  }
+
+  EXPECT_TRUE(db_.IsTypedHost("www.site1.com"));
+  EXPECT_FALSE(db_.IsTypedHost("www.nosuchsite.com"));
+}
+
+TEST_F(InMemoryDatabaseTest, FindShortestURLMatchesSQL) {
+  AddManyURLs();
+  const std::string base("http://www.site1.com/");
+  ExpectSameShortestURL(base, "http://www.site1.com/page8", 1, 0, true);
+  ExpectSameShortestURL(base, "http://www.site1.com/page8", 1, 0, false);
+  ExpectSameShortestURL(base, "http://www.site1.com/page8", 2, 0, false);
+  ExpectSameShortestURL(base, "http://www.site1.com/page8", 1, 1, false);
+  ExpectSameShortestURL(base, "http://www.site1.com/", 1, 0, true);
+  ExpectSameShortestURL(base, "http://www.site2.com/page9", 1, 0, true);
+}
+
+TEST_F(InMemoryDatabaseTest, DeletedRowsAreNotFound) {
+  AddManyURLs();
+  URLID id = db_.GetRowForURL(GURL("http://www.site1.com/"), NULL);
+  ASSERT_TRUE(id);
+  EXPECT_TRUE(db_.DeleteURLRow(id));
+  ExpectSameAutocomplete("http://www.site1.com/", 100, false);
+  ExpectSameShortestURL("http://www.site1.com/", "http://www.site1.com/page8",
+                        1, 0, true);
+}
+
+}  // namespace history
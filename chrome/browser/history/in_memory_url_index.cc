@@ -156,6 +156,11 @@ ScoredHistoryMatches InMemoryURLIndex::HistoryItemsForTerms(
   return private_data_->HistoryItemsForTerms(term_string);
 }
 
+scoped_refptr<URLIndexScoringJob> InMemoryURLIndex::ScoringJobForTerms(
+    const string16& term_string) {
+  return private_data_->ScoringJobForTerms(term_string);
+}
+
 // Updating --------------------------------------------------------------------
 
 void InMemoryURLIndex::Observe(int notification_type,
@@ -24,6 +24,7 @@
 #include "chrome/browser/history/history.h"
 #include "chrome/browser/history/history_types.h"
 #include "chrome/browser/history/in_memory_url_index_types.h"
+#include "chrome/browser/history/url_index_scoring_job.h"
 #include "content/public/browser/notification_observer.h"
 #include "content/public/browser/notification_registrar.h"
 #include "sql/connection.h"
@@ -138,6 +139,11 @@ class InMemoryURLIndex : public content::NotificationObserver,
   // refer to that class.
   ScoredHistoryMatches HistoryItemsForTerms(const string16& term_string);
 
+  // Like HistoryItemsForTerms() but leaves the scoring to the returned job,
+  // which the caller can run on the blocking pool. See URLIndexScoringJob.
+  scoped_refptr<URLIndexScoringJob> ScoringJobForTerms(
+      const string16& term_string);
+
   // Sets the optional observers for completion of restoral and saving of the
   // index's private data.
   void set_restore_cache_observer(
@@ -0,0 +1,129 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares restoring the InMemoryURLIndex from the protobuf cache, which
+// rebuilds all of its maps, with mapping the flat URLIndexCacheFile.
+
+#include <set>
+#include <string>
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/perftimer.h"
+#include "base/process_util.h"
+#include "base/scoped_temp_dir.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "chrome/browser/history/url_index_private_data.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace history {
+
+namespace {
+
+const int kNumURLs = 20000;
+const char kLanguages[] = "en";
+
+// Returns the working set of this process, in bytes.
+size_t GetWorkingSetSize() {
+#if defined(OS_MACOSX)
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle(), NULL));
+#else
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle()));
+#endif
+  return metrics->GetWorkingSetSize();
+}
+
+}  // namespace
+
+class InMemoryURLIndexPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    std::set<std::string> scheme_whitelist;
+    scheme_whitelist.insert("http");
+    data_ = new URLIndexPrivateData;
+    base::Time now = base::Time::Now();
+    for (int i = 1; i <= kNumURLs; ++i) {
+      URLRow row(GURL(base::StringPrintf(
+          "http://www.site%d.com/section%d/article%d.html", i % 1000, i % 37,
+          i)), i);
+      row.set_title(UTF8ToUTF16(base::StringPrintf(
+          "Article %d about topic%d in section %d", i, i % 500, i % 37)));
+      row.set_visit_count(i % 20 + 1);
+      row.set_typed_count(i % 3);
+      row.set_last_visit(now - base::TimeDelta::FromHours(i % 1000));
+      data_->IndexRow(row, kLanguages, scheme_whitelist);
+    }
+  }
+
+  // URLIndexPrivateData only lets the fixture, not the tests, save caches.
+  bool SaveLegacyCache(const FilePath& path) {
+    return data_->SaveToLegacyFile(path);
+  }
+
+  bool SaveCacheFile(const FilePath& path) {
+    return data_->SaveToFile(path);
+  }
+
+  // Restores the cache at |path| and logs the time and memory it took as
+  // |name|, then times a few searches of it.
+  void TimeRestore(const FilePath& path, const std::string& name) {
+    data_ = NULL;
+    size_t before = GetWorkingSetSize();
+    scoped_refptr<URLIndexPrivateData> restored(new URLIndexPrivateData);
+    {
+      PerfTimeLogger timer((name + "_restore").c_str());
+      ASSERT_TRUE(restored->RestoreFromFile(path, kLanguages));
+    }
+    size_t after = GetWorkingSetSize();
+    LogPerfResult((name + "_restore_working_set").c_str(),
+                  (static_cast<double>(after) - before) / 1024, "kb");
+
+    PerfTimeLogger timer((name + "_first_searches").c_str());
+    const char* kSearches[] = { "a", "ar", "art", "article 12", "site3 topic4",
+                                "section 11" };
+    for (size_t i = 0; i < arraysize(kSearches); ++i)
+      restored->HistoryItemsForTerms(ASCIIToUTF16(kSearches[i]));
+    timer.Done();
+    LogPerfResult((name + "_working_set_after_searches").c_str(),
+                  (static_cast<double>(GetWorkingSetSize()) - before) / 1024,
+                  "kb");
+  }
+
+  ScopedTempDir temp_dir_;
+  scoped_refptr<URLIndexPrivateData> data_;
+};
+
+TEST_F(InMemoryURLIndexPerfTest, RestoreLegacyCache) {
+  FilePath path = temp_dir_.path().AppendASCII("History Provider Cache");
+  ASSERT_TRUE(SaveLegacyCache(path));
+  int64 size = 0;
+  ASSERT_TRUE(file_util::GetFileSize(path, &size));
+  LogPerfResult("InMemoryURLIndex_legacy_cache_size",
+                static_cast<double>(size) / 1024, "kb");
+  TimeRestore(path, "InMemoryURLIndex_legacy_cache");
+}
+
+TEST_F(InMemoryURLIndexPerfTest, RestoreCacheFile) {
+  FilePath path = temp_dir_.path().AppendASCII("History Provider Cache");
+  {
+    PerfTimeLogger timer("InMemoryURLIndex_cache_file_save");
+    ASSERT_TRUE(SaveCacheFile(path));
+  }
+  int64 size = 0;
+  ASSERT_TRUE(file_util::GetFileSize(path, &size));
+  LogPerfResult("InMemoryURLIndex_cache_file_size",
+                static_cast<double>(size) / 1024, "kb");
+  TimeRestore(path, "InMemoryURLIndex_cache_file");
+}
+
+}  // namespace history
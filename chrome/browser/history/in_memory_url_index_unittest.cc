@@ -9,9 +9,11 @@
 #include "base/file_util.h"
 #include "base/message_loop.h"
 #include "base/path_service.h"
+#include "base/perftimer.h"
 #include "base/scoped_temp_dir.h"
 #include "base/string_util.h"
 #include "base/string16.h"
+#include "base/stringprintf.h"
 #include "base/utf_string_conversions.h"
 #include "chrome/browser/autocomplete/autocomplete.h"
 #include "chrome/browser/history/history.h"
@@ -21,6 +23,7 @@
 #include "chrome/browser/history/in_memory_url_index_types.h"
 #include "chrome/browser/history/in_memory_url_index.h"
 #include "chrome/browser/history/url_index_private_data.h"
+#include "chrome/browser/history/url_index_scoring_job.h"
 #include "chrome/common/chrome_notification_types.h"
 #include "chrome/common/chrome_paths.h"
 #include "content/public/browser/notification_details.h"
@@ -631,6 +634,70 @@ TEST_F(InMemoryURLIndexTest, HugeResultSet) {
             private_data.post_scoring_item_count_);
 }
 
+// Types a query one character at a time into an index with thousands of
+// candidates and logs how long each keystroke's search takes.
+TEST_F(InMemoryURLIndexTest, KeystrokeLatency) {
+  base::Time now = base::Time::Now();
+  for (URLID row_id = 5000; row_id < 8000; ++row_id) {
+    URLRow new_row(GURL(base::StringPrintf("http://www.site%d.com/page%d.html",
+                                           row_id % 200, row_id)), row_id);
+    new_row.set_title(UTF8ToUTF16(base::StringPrintf(
+        "Page %d of site %d", row_id, row_id % 200)));
+    new_row.set_visit_count(row_id % 20 + 1);
+    new_row.set_typed_count(row_id % 3);
+    new_row.set_last_visit(now - base::TimeDelta::FromHours(row_id % 72));
+    EXPECT_TRUE(UpdateURL(new_row));
+  }
+
+  URLIndexPrivateData& private_data(*GetPrivateData());
+  const std::string query("site12 page");
+  for (size_t i = 1; i <= query.size(); ++i) {
+    string16 prefix(ASCIIToUTF16(query.substr(0, i)));
+    PerfTimer timer;
+    scoped_refptr<URLIndexScoringJob> job(
+        url_index_->ScoringJobForTerms(prefix));
+    ScoredHistoryMatches matches(job->Run());
+    base::TimeDelta elapsed = timer.Elapsed();
+    std::string name(base::StringPrintf("InMemoryURLIndex_keystroke_%d",
+                                        static_cast<int>(i)));
+    LogPerfResult(name.c_str(), elapsed.InMillisecondsF(), "ms");
+    LogPerfResult((name + "_scored").c_str(),
+                  static_cast<double>(job->scored_count()), "candidates");
+
+    EXPECT_LE(job->scored_count(), private_data.post_filter_item_count_);
+    EXPECT_LE(matches.size(), AutocompleteProvider::kMaxMatches);
+    for (size_t j = 1; j < matches.size(); ++j)
+      EXPECT_GE(matches[j - 1].raw_score, matches[j].raw_score);
+  }
+
+  // Stopping early must find the same best matches as scoring every row.
+  String16Vector terms(Make1Term("site12"));
+  URLIndexScoringJob::Candidates candidates;
+  for (HistoryInfoMap::const_iterator iter =
+       private_data.history_info_map_.begin();
+       iter != private_data.history_info_map_.end(); ++iter) {
+    URLIndexScoringJob::Candidate candidate;
+    candidate.row = iter->second;
+    candidate.word_starts = private_data.word_starts_map_[iter->first];
+    candidate.max_score = URLIndexPrivateData::MaxRawScoreForRow(iter->second);
+    candidates.push_back(candidate);
+  }
+  URLIndexScoringJob::Candidates all_candidates(candidates);
+  size_t candidate_count = candidates.size();
+  scoped_refptr<URLIndexScoringJob> job(new URLIndexScoringJob(
+      terms[0], terms, &candidates, AutocompleteProvider::kMaxMatches));
+  ScoredHistoryMatches matches(job->Run());
+  scoped_refptr<URLIndexScoringJob> full_job(new URLIndexScoringJob(
+      terms[0], terms, &all_candidates, candidate_count));
+  ScoredHistoryMatches all_matches(full_job->Run());
+  EXPECT_EQ(candidate_count, full_job->scored_count());
+  EXPECT_LT(job->scored_count(), candidate_count);
+  ASSERT_EQ(AutocompleteProvider::kMaxMatches, matches.size());
+  ASSERT_LE(matches.size(), all_matches.size());
+  for (size_t i = 0; i < matches.size(); ++i)
+    EXPECT_EQ(all_matches[i].raw_score, matches[i].raw_score);
+}
+
 TEST_F(InMemoryURLIndexTest, TitleSearch) {
   // Signal if someone has changed the test DB.
   EXPECT_EQ(28U, GetPrivateData()->history_info_map_.size());
@@ -1001,6 +1068,128 @@ TEST_F(InMemoryURLIndexTest, CacheSaveRestore) {
 
   URLIndexPrivateData& new_data(*GetPrivateData());
 
+  // The restored items are served from the mapped cache file rather than the
+  // maps, so compare them through the lookups.
+  ASSERT_TRUE(new_data.cache_file_.get());
+  EXPECT_TRUE(new_data.history_info_map_.empty());
+  EXPECT_EQ(old_data->history_info_map_.size(),
+            new_data.cache_file_->history_count());
+  EXPECT_EQ(old_data->word_map_.size(), new_data.cache_file_->word_count());
+  EXPECT_EQ(old_data->char_word_map_.size(),
+            new_data.cache_file_->char_count());
+
+  for (HistoryInfoMap::const_iterator expected =
+       old_data->history_info_map_.begin();
+       expected != old_data->history_info_map_.end(); ++expected) {
+    URLRow actual_row;
+    RowWordStarts actual_starts;
+    ASSERT_TRUE(new_data.GetHistoryInfo(expected->first, &actual_row,
+                                        &actual_starts));
+    const URLRow& expected_row(expected->second);
+    EXPECT_EQ(expected_row.visit_count(), actual_row.visit_count());
+    EXPECT_EQ(expected_row.typed_count(), actual_row.typed_count());
+    EXPECT_EQ(expected_row.last_visit(), actual_row.last_visit());
+    EXPECT_EQ(expected_row.url(), actual_row.url());
+    EXPECT_EQ(expected_row.title(), actual_row.title());
+    const RowWordStarts& expected_starts(
+        old_data->word_starts_map_.find(expected->first)->second);
+    EXPECT_TRUE(expected_starts.url_word_starts_ ==
+                actual_starts.url_word_starts_);
+    EXPECT_TRUE(expected_starts.title_word_starts_ ==
+                actual_starts.title_word_starts_);
+  }
+
+  // Every word, and every prefix of one, must find the same items.
+  for (WordMap::const_iterator iter = old_data->word_map_.begin();
+       iter != old_data->word_map_.end(); ++iter) {
+    for (size_t length = 1; length <= iter->first.length(); ++length) {
+      string16 term(iter->first.substr(0, length));
+      EXPECT_TRUE(old_data->HistoryIDsForTerm(term) ==
+                  new_data.HistoryIDsForTerm(term)) << term;
+    }
+  }
+}
+
+TEST_F(InMemoryURLIndexTest, CacheUpdateAfterRestore) {
+  ScopedTempDir temp_directory;
+  ASSERT_TRUE(temp_directory.CreateUniqueTempDir());
+  set_history_dir(temp_directory.path());
+
+  CacheFileSaverObserver save_observer(&message_loop_);
+  url_index_->set_save_cache_observer(&save_observer);
+  PostSaveToCacheFileTask();
+  message_loop_.Run();
+  EXPECT_TRUE(save_observer.succeeded_);
+
+  ClearPrivateData();
+  CacheFileReaderObserver read_observer(&message_loop_);
+  url_index_->set_restore_cache_observer(&read_observer);
+  PostRestoreFromCacheFileTask();
+  message_loop_.Run();
+  ASSERT_TRUE(read_observer.succeeded_);
+  ASSERT_TRUE(GetPrivateData()->cache_file_.get());
+
+  // Retitle a restored item.
+  string16 original_terms =
+      ASCIIToUTF16("lebronomics could high taxes influence");
+  ScoredHistoryMatches matches =
+      url_index_->HistoryItemsForTerms(original_terms);
+  ASSERT_EQ(1U, matches.size());
+  URLRow old_row(matches[0].url_info);
+  EXPECT_FALSE(UpdateURL(old_row));
+  string16 new_terms = ASCIIToUTF16("does eat oats little lambs ivy");
+  old_row.set_title(ASCIIToUTF16("Does eat oats and little lambs eat ivy"));
+  EXPECT_TRUE(UpdateURL(old_row));
+  matches = url_index_->HistoryItemsForTerms(new_terms);
+  ASSERT_EQ(1U, matches.size());
+  EXPECT_EQ(old_row.id(), matches[0].url_info.id());
+  EXPECT_TRUE(url_index_->HistoryItemsForTerms(original_terms).empty());
+
+  // Delete a restored item.
+  matches = url_index_->HistoryItemsForTerms(ASCIIToUTF16("DrudgeReport"));
+  ASSERT_EQ(1U, matches.size());
+  EXPECT_TRUE(DeleteURL(matches[0].url_info.url()));
+  EXPECT_FALSE(DeleteURL(matches[0].url_info.url()));
+  EXPECT_TRUE(url_index_->HistoryItemsForTerms(
+      ASCIIToUTF16("DrudgeReport")).empty());
+
+  // Both changes survive saving and restoring again.
+  PostSaveToCacheFileTask();
+  message_loop_.Run();
+  EXPECT_TRUE(save_observer.succeeded_);
+  ClearPrivateData();
+  PostRestoreFromCacheFileTask();
+  message_loop_.Run();
+  ASSERT_TRUE(read_observer.succeeded_);
+  EXPECT_EQ(1U, url_index_->HistoryItemsForTerms(new_terms).size());
+  EXPECT_TRUE(url_index_->HistoryItemsForTerms(original_terms).empty());
+  EXPECT_TRUE(url_index_->HistoryItemsForTerms(
+      ASCIIToUTF16("DrudgeReport")).empty());
+}
+
+TEST_F(InMemoryURLIndexTest, LegacyCacheRestore) {
+  ScopedTempDir temp_directory;
+  ASSERT_TRUE(temp_directory.CreateUniqueTempDir());
+  set_history_dir(temp_directory.path());
+
+  URLIndexPrivateData& private_data(*GetPrivateData());
+  scoped_refptr<URLIndexPrivateData> old_data(private_data.Duplicate());
+
+  // A cache written in the protobuf format is still restored, into the maps.
+  FilePath path;
+  ASSERT_TRUE(GetCacheFilePath(&path));
+  ASSERT_TRUE(private_data.SaveToLegacyFile(path));
+  EXPECT_FALSE(URLIndexCacheFile::HasCacheFileMagic(path));
+  ClearPrivateData();
+
+  CacheFileReaderObserver read_observer(&message_loop_);
+  url_index_->set_restore_cache_observer(&read_observer);
+  PostRestoreFromCacheFileTask();
+  message_loop_.Run();
+  EXPECT_TRUE(read_observer.succeeded_);
+
+  URLIndexPrivateData& new_data(*GetPrivateData());
+  EXPECT_FALSE(new_data.cache_file_.get());
   // Compare the captured and restored for equality.
   EXPECT_EQ(old_data->word_list_.size(), new_data.word_list_.size());
   EXPECT_EQ(old_data->word_map_.size(), new_data.word_map_.size());
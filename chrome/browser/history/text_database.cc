@@ -13,6 +13,7 @@
 #include "base/metrics/histogram.h"
 #include "base/string_number_conversions.h"
 #include "base/stringprintf.h"
+#include "base/synchronization/cancellation_flag.h"
 #include "base/utf_string_conversions.h"
 #include "chrome/browser/diagnostics/sqlite_diagnostics.h"
 #include "sql/statement.h"
@@ -284,6 +285,7 @@ void TextDatabase::Optimize() {
 
 void TextDatabase::GetTextMatches(const std::string& query,
                                   const QueryOptions& options,
+                                  const base::CancellationFlag* cancel_flag,
                                   std::vector<Match>* results,
                                   URLSet* found_urls,
                                   base::Time* first_time_searched) {
@@ -312,9 +314,8 @@ void TextDatabase::GetTextMatches(const std::string& query,
   statement.BindInt(3, effective_max_count);
 
   while (statement.Step()) {
-    // TODO(brettw) allow canceling the query in the middle.
-    // if (canceled_or_something)
-    //   break;
+    if (cancel_flag && cancel_flag->IsSet())
+      break;
 
     GURL url(statement.ColumnString(0));
     URLSet::const_iterator found_url = found_urls->find(url);
@@ -17,6 +17,10 @@
 #include "sql/connection.h"
 #include "sql/meta_table.h"
 
+namespace base {
+class CancellationFlag;
+}
+
 namespace history {
 
 // Encapsulation of a full-text indexed database file.
@@ -132,8 +136,12 @@ class TextDatabase {
   //
   // Callers must run QueryParser on the user text and pass the results of the
   // QueryParser to this method as the query string.
+  //
+  // The search stops early, with incomplete results, once the optional
+  // |cancel_flag| is set.
   void GetTextMatches(const std::string& query,
                       const QueryOptions& options,
+                      const base::CancellationFlag* cancel_flag,
                       std::vector<Match>* results,
                       URLSet* unique_urls,
                       base::Time* first_time_searched);
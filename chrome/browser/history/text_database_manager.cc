@@ -11,6 +11,8 @@
 #include "base/logging.h"
 #include "base/message_loop.h"
 #include "base/string_util.h"
+#include "base/synchronization/cancellation_flag.h"
+#include "base/threading/worker_pool.h"
 #include "base/utf_string_conversions.h"
 #include "chrome/browser/history/history_publisher.h"
 #include "chrome/browser/history/visit_database.h"
@@ -35,6 +37,28 @@ std::string ConvertStringForIndexer(const string16& input) {
 // haven't gotten a title and/or body.
 const int kExpirationSeconds = 20;
 
+// Complete pages are indexed in batches of up to this many pages, or after
+// this long if not enough pages come in to fill a batch.
+const size_t kIndexBatchSize = 50;
+const int kIndexBatchDelayMS = 2000;
+
+// A database is optimized once this many pages were indexed into it and no
+// pages have been indexed for this long.
+const int kMinPagesToMerge = 100;
+const int kMergeIdleSeconds = 60;
+
+// Returns true if the uncommitted page of |url| visited at |visit_time| should
+// be dropped by DeleteFromUncommitted().
+bool ShouldDeleteUncommitted(const std::set<GURL>& restrict_urls,
+                             Time begin,
+                             Time end,
+                             const GURL& url,
+                             Time visit_time) {
+  if (visit_time < begin || (!end.is_null() && visit_time >= end))
+    return false;
+  return restrict_urls.empty() || restrict_urls.find(url) != restrict_urls.end();
+}
+
 }  // namespace
 
 // TextDatabaseManager::ChangeSet ----------------------------------------------
@@ -74,6 +98,34 @@ bool TextDatabaseManager::PageInfo::Expired(TimeTicks now) const {
   return now - added_time_ > base::TimeDelta::FromSeconds(kExpirationSeconds);
 }
 
+// TextDatabaseManager::PendingPage --------------------------------------------
+
+TextDatabaseManager::PendingPage::PendingPage()
+    : url_id(0),
+      visit_id(0),
+      deleted(false) {
+}
+
+TextDatabaseManager::PendingPage::~PendingPage() {}
+
+// TextDatabaseManager::IndexBatch ---------------------------------------------
+
+TextDatabaseManager::IndexBatch::IndexBatch()
+    : converted(false),
+      written(false) {
+}
+
+TextDatabaseManager::IndexBatch::~IndexBatch() {}
+
+void TextDatabaseManager::IndexBatch::ConvertText() {
+  titles.resize(pages.size());
+  bodies.resize(pages.size());
+  for (size_t i = 0; i < pages.size(); ++i) {
+    titles[i] = ConvertStringForIndexer(pages[i].title);
+    bodies[i] = ConvertStringForIndexer(pages[i].body);
+  }
+}
+
 // TextDatabaseManager ---------------------------------------------------------
 
 TextDatabaseManager::TextDatabaseManager(const FilePath& dir,
@@ -87,10 +139,12 @@ TextDatabaseManager::TextDatabaseManager(const FilePath& dir,
       db_cache_(DBCache::NO_AUTO_EVICT),
       present_databases_loaded_(false),
       ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)),
+      ALLOW_THIS_IN_INITIALIZER_LIST(index_weak_factory_(this)),
       history_publisher_(NULL) {
 }
 
 TextDatabaseManager::~TextDatabaseManager() {
+  FlushPendingPages();
   if (transaction_nesting_)
     CommitTransaction();
 }
@@ -213,16 +267,16 @@ void TextDatabaseManager::AddPageTitle(const GURL& url,
       return;
     }
 
-    AddPageData(url, url_row.id(), visit.visit_id, visit.visit_time,
-                title, string16());
+    QueuePage(url, url_row.id(), visit.visit_id, visit.visit_time,
+              title, string16());
     return;  // We don't know about this page, give up.
   }
 
   PageInfo& info = found->second;
   if (info.has_body()) {
-    // This info is complete, write to the database.
-    AddPageData(url, info.url_id(), info.visit_id(), info.visit_time(),
-                title, info.body());
+    // This info is complete, queue it for the database.
+    QueuePage(url, info.url_id(), info.visit_id(), info.visit_time(),
+              title, info.body());
     recent_changes_.Erase(found);
     return;
   }
@@ -249,16 +303,16 @@ void TextDatabaseManager::AddPageContents(const GURL& url,
       return;  // No recent visit, give up.
 
     // Use the title from the URL row as the title for the indexing.
-    AddPageData(url, url_row.id(), visit.visit_id, visit.visit_time,
-                url_row.title(), body);
+    QueuePage(url, url_row.id(), visit.visit_id, visit.visit_time,
+              url_row.title(), body);
     return;
   }
 
   PageInfo& info = found->second;
   if (info.has_title()) {
-    // This info is complete, write to the database.
-    AddPageData(url, info.url_id(), info.visit_id(), info.visit_time(),
-                info.title(), body);
+    // This info is complete, queue it for the database.
+    QueuePage(url, info.url_id(), info.visit_id(), info.visit_time(),
+              info.title(), body);
     recent_changes_.Erase(found);
     return;
   }
@@ -272,7 +326,22 @@ bool TextDatabaseManager::AddPageData(const GURL& url,
                                       Time visit_time,
                                       const string16& title,
                                       const string16& body) {
-  TextDatabase* db = GetDBForTime(visit_time, true);
+  PendingPage page;
+  page.url = url;
+  page.url_id = url_id;
+  page.visit_id = visit_id;
+  page.visit_time = visit_time;
+  page.title = title;
+  page.body = body;
+  return WritePageData(page, ConvertStringForIndexer(title),
+                       ConvertStringForIndexer(body));
+}
+
+bool TextDatabaseManager::WritePageData(const PendingPage& page,
+                                        const std::string& indexed_title,
+                                        const std::string& indexed_body) {
+  const GURL& url = page.url;
+  TextDatabase* db = GetDBForTime(page.visit_time, true);
   if (!db)
     return false;
 
@@ -282,26 +351,26 @@ bool TextDatabaseManager::AddPageData(const GURL& url,
   // anything in the main database, but we don't bother looking through the
   // archived database.
   VisitVector visits;
-  visit_database_->GetIndexedVisitsForURL(url_id, &visits);
+  visit_database_->GetIndexedVisitsForURL(page.url_id, &visits);
   for (size_t i = 0; i < visits.size(); i++) {
     visits[i].is_indexed = false;
     visit_database_->UpdateVisitRow(visits[i]);
     DeletePageData(visits[i].visit_time, url, NULL);
   }
 
-  if (visit_id) {
+  if (page.visit_id) {
     // We're supposed to update the visit database, so load the visit.
     VisitRow row;
-    if (!visit_database_->GetRowForVisit(visit_id, &row)) {
+    if (!visit_database_->GetRowForVisit(page.visit_id, &row)) {
       // This situation can occur if Chrome's history is in the process of
       // being updated, and then the browsing history is deleted before all
       // updates have been completely performed.  In this case, a stale update
       // to the database is attempted, leading to the warning below.
-      DLOG(WARNING) << "Could not find requested visit #" << visit_id;
+      DLOG(WARNING) << "Could not find requested visit #" << page.visit_id;
       return false;
     }
 
-    DCHECK(visit_time == row.visit_time);
+    DCHECK(page.visit_time == row.visit_time);
 
     // Update the visit database to reference our addition.
     row.is_indexed = true;
@@ -311,15 +380,16 @@ bool TextDatabaseManager::AddPageData(const GURL& url,
 
   // Now index the data.
   std::string url_str = URLDatabase::GURLToDatabaseURL(url);
-  bool success = db->AddPageData(visit_time, url_str,
-                                 ConvertStringForIndexer(title),
-                                 ConvertStringForIndexer(body));
+  bool success = db->AddPageData(page.visit_time, url_str, indexed_title,
+                                 indexed_body);
 
   UMA_HISTOGRAM_TIMES("History.AddFTSData",
                       TimeTicks::Now() - beginning_time);
 
-  if (history_publisher_)
-    history_publisher_->PublishPageContent(visit_time, url, title, body);
+  if (history_publisher_) {
+    history_publisher_->PublishPageContent(page.visit_time, url, page.title,
+                                           page.body);
+  }
 
   return success;
 }
@@ -370,6 +440,25 @@ void TextDatabaseManager::DeleteFromUncommitted(
         ++cur;
     }
   }
+
+  // Complete pages which haven't been written yet are uncommitted too.
+  for (PendingPages::iterator i = pending_pages_.begin();
+       i != pending_pages_.end(); ) {
+    if (ShouldDeleteUncommitted(restrict_urls, begin, end, i->url,
+                                i->visit_time))
+      i = pending_pages_.erase(i);
+    else
+      ++i;
+  }
+  for (IndexBatches::iterator batch = index_batches_.begin();
+       batch != index_batches_.end(); ++batch) {
+    PendingPages& pages = (*batch)->pages;
+    for (PendingPages::iterator i = pages.begin(); i != pages.end(); ++i) {
+      if (ShouldDeleteUncommitted(restrict_urls, begin, end, i->url,
+                                  i->visit_time))
+        i->deleted = true;
+    }
+  }
 }
 
 void TextDatabaseManager::DeleteAll() {
@@ -379,6 +468,14 @@ void TextDatabaseManager::DeleteAll() {
 
   // Delete uncommitted entries.
   recent_changes_.Clear();
+  pending_pages_.clear();
+  index_timer_.Stop();
+  for (IndexBatches::iterator i = index_batches_.begin();
+       i != index_batches_.end(); ++i)
+    (*i)->written = true;
+  index_batches_.clear();
+  pages_since_merge_.clear();
+  merge_timer_.Stop();
 
   // Close all open databases.
   db_cache_.Clear();
@@ -410,13 +507,40 @@ void TextDatabaseManager::OptimizeChangedDatabases(
   }
 }
 
+void TextDatabaseManager::FlushPendingPages() {
+  index_timer_.Stop();
+  IndexBatches batches;
+  batches.swap(index_batches_);
+  if (!pending_pages_.empty()) {
+    scoped_refptr<IndexBatch> batch(new IndexBatch);
+    batch->pages.swap(pending_pages_);
+    batches.push_back(batch);
+  }
+  for (IndexBatches::iterator i = batches.begin(); i != batches.end(); ++i)
+    WriteIndexBatch(*i);
+}
+
 void TextDatabaseManager::GetTextMatches(
     const string16& query,
     const QueryOptions& options,
     std::vector<TextDatabase::Match>* results,
     Time* first_time_searched) {
+  GetTextMatches(query, options, NULL, results, first_time_searched);
+}
+
+void TextDatabaseManager::GetTextMatches(
+    const string16& query,
+    const QueryOptions& options,
+    const base::CancellationFlag* cancel_flag,
+    std::vector<TextDatabase::Match>* results,
+    Time* first_time_searched) {
   results->clear();
 
+  // Make sure every complete page can be found.
+  FlushPendingPages();
+
+  TimeTicks beginning_time = TimeTicks::Now();
+
   InitDBList();
   if (present_databases_.empty()) {
     // Nothing to search.
@@ -448,9 +572,8 @@ void TextDatabaseManager::GetTextMatches(
   for (DBIdentSet::reverse_iterator i = present_databases_.rbegin();
        i != present_databases_.rend();
        ++i) {
-    // TODO(brettw) allow canceling the query in the middle.
-    // if (canceled_or_something)
-    //   break;
+    if (cancel_flag && cancel_flag->IsSet())
+      break;
 
     // This code is stupid, we just loop until we find the correct starting
     // time range rather than search in an intelligent way. Users will have a
@@ -473,7 +596,7 @@ void TextDatabaseManager::GetTextMatches(
     // Since we are going backwards in time, it is always OK to pass the
     // current first_time_searched, since it will always be smaller than
     // any previous set.
-    cur_db->GetTextMatches(fts_query, cur_options,
+    cur_db->GetTextMatches(fts_query, cur_options, cancel_flag,
                            results, &found_urls, first_time_searched);
     checked_one = true;
 
@@ -487,6 +610,9 @@ void TextDatabaseManager::GetTextMatches(
   // When there were no databases in the range, we need to fix up the min time.
   if (!checked_one)
     *first_time_searched = options.begin_time;
+
+  UMA_HISTOGRAM_TIMES("History.GetFTSMatches",
+                      TimeTicks::Now() - beginning_time);
 }
 
 TextDatabase* TextDatabaseManager::GetDB(TextDatabase::DBIdent id,
@@ -550,12 +676,121 @@ void TextDatabaseManager::FlushOldChangesForTime(TimeTicks now) {
   // things until we get something too new.
   RecentChangeList::reverse_iterator i = recent_changes_.rbegin();
   while (i != recent_changes_.rend() && i->second.Expired(now)) {
-    AddPageData(i->first, i->second.url_id(), i->second.visit_id(),
-                i->second.visit_time(), i->second.title(), i->second.body());
+    QueuePage(i->first, i->second.url_id(), i->second.visit_id(),
+              i->second.visit_time(), i->second.title(), i->second.body());
     i = recent_changes_.Erase(i);
   }
 
   ScheduleFlushOldChanges();
 }
 
+void TextDatabaseManager::QueuePage(const GURL& url,
+                                    URLID url_id,
+                                    VisitID visit_id,
+                                    Time visit_time,
+                                    const string16& title,
+                                    const string16& body) {
+  pending_pages_.push_back(PendingPage());
+  PendingPage& page = pending_pages_.back();
+  page.url = url;
+  page.url_id = url_id;
+  page.visit_id = visit_id;
+  page.visit_time = visit_time;
+  page.title = title;
+  page.body = body;
+
+  if (pending_pages_.size() >= kIndexBatchSize) {
+    StartIndexBatch();
+  } else if (!index_timer_.IsRunning()) {
+    index_timer_.Start(FROM_HERE,
+                       TimeDelta::FromMilliseconds(kIndexBatchDelayMS),
+                       this, &TextDatabaseManager::StartIndexBatch);
+  }
+}
+
+void TextDatabaseManager::StartIndexBatch() {
+  index_timer_.Stop();
+  if (pending_pages_.empty())
+    return;
+
+  scoped_refptr<IndexBatch> batch(new IndexBatch);
+  batch->pages.swap(pending_pages_);
+  index_batches_.push_back(batch);
+  if (!base::WorkerPool::PostTaskAndReply(
+          FROM_HERE,
+          base::Bind(&IndexBatch::ConvertText, batch),
+          base::Bind(&TextDatabaseManager::OnIndexBatchConverted,
+                     index_weak_factory_.GetWeakPtr(), batch),
+          false)) {
+    // Write everything that is waiting here rather than lose it.
+    FlushPendingPages();
+  }
+}
+
+void TextDatabaseManager::OnIndexBatchConverted(
+    scoped_refptr<IndexBatch> batch) {
+  batch->converted = true;
+  // Later batches wait for the earlier ones so that the pages are written in
+  // the order they came in.
+  while (!index_batches_.empty() && index_batches_.front()->converted) {
+    scoped_refptr<IndexBatch> next(index_batches_.front());
+    index_batches_.erase(index_batches_.begin());
+    WriteIndexBatch(next);
+  }
+}
+
+void TextDatabaseManager::WriteIndexBatch(IndexBatch* batch) {
+  if (batch->written)
+    return;
+  batch->written = true;
+
+  TimeTicks beginning_time = TimeTicks::Now();
+  int written_pages = 0;
+  BeginTransaction();
+  for (size_t i = 0; i < batch->pages.size(); ++i) {
+    const PendingPage& page = batch->pages[i];
+    if (page.deleted)
+      continue;
+    // The worker thread may still be converting a batch which is flushed
+    // early, so convert its text again here.
+    if (batch->converted) {
+      WritePageData(page, batch->titles[i], batch->bodies[i]);
+    } else {
+      WritePageData(page, ConvertStringForIndexer(page.title),
+                    ConvertStringForIndexer(page.body));
+    }
+    pages_since_merge_[TimeToID(page.visit_time)]++;
+    written_pages++;
+  }
+  CommitTransaction();
+
+  if (!written_pages)
+    return;
+  UMA_HISTOGRAM_TIMES("History.AddFTSBatch",
+                      TimeTicks::Now() - beginning_time);
+  UMA_HISTOGRAM_COUNTS_100("History.FTSBatchSize", written_pages);
+
+  // Indexing isn't idle yet.
+  merge_timer_.Stop();
+  merge_timer_.Start(FROM_HERE, TimeDelta::FromSeconds(kMergeIdleSeconds),
+                     this, &TextDatabaseManager::MergeIdleDatabases);
+}
+
+void TextDatabaseManager::MergeIdleDatabases() {
+  for (std::map<TextDatabase::DBIdent, int>::iterator i =
+           pages_since_merge_.begin(); i != pages_since_merge_.end(); ) {
+    if (i->second < kMinPagesToMerge) {
+      ++i;
+      continue;
+    }
+    // Only optimize databases which still exist; see OptimizeChangedDatabases.
+    TextDatabase* db = GetDB(i->first, false);
+    if (db)
+      db = GetDB(i->first, true);
+    if (db)
+      db->Optimize();
+    pages_since_merge_.erase(i++);
+  }
+}
+
 }  // namespace history
@@ -6,20 +6,28 @@
 #define CHROME_BROWSER_HISTORY_TEXT_DATABASE_MANAGER_H_
 #pragma once
 
+#include <map>
 #include <set>
+#include <string>
 #include <vector>
 
 #include "base/basictypes.h"
 #include "base/file_path.h"
 #include "base/gtest_prod_util.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
 #include "base/string16.h"
 #include "base/memory/mru_cache.h"
+#include "base/timer.h"
 #include "chrome/browser/history/history_types.h"
 #include "chrome/browser/history/text_database.h"
 #include "chrome/browser/history/query_parser.h"
 #include "chrome/browser/history/url_database.h"
 
+namespace base {
+class CancellationFlag;
+}
+
 namespace history {
 
 class HistoryPublisher;
@@ -37,6 +45,12 @@ class VisitDatabase;
 // This allows us to minimize inserts and modifications, which are slow for the
 // full text database, since each page's information is added exactly once.
 //
+// Complete pages are then indexed in batches: their text is converted for the
+// indexer on a worker thread, and each batch is written in one transaction.
+// The databases which were written to are optimized, merging their index
+// segments, once no pages have been indexed for a while. Queries first write
+// any complete pages which are still waiting so that they find them.
+//
 // Note: be careful to delete the relevant entries from this uncommitted list
 // when clearing history or this information may get added to the database soon
 // after the clear.
@@ -107,10 +121,10 @@ class TextDatabaseManager {
   void AddPageTitle(const GURL& url, const string16& title);
   void AddPageContents(const GURL& url, const string16& body);
 
-  // Adds the given data to the appropriate database file, returning true on
-  // success. The visit database row identified by |visit_id| will be updated
-  // to refer to the full text index entry. If the visit ID is 0, the visit
-  // database will not be updated.
+  // Adds the given data to the appropriate database file right away, returning
+  // true on success. The visit database row identified by |visit_id| will be
+  // updated to refer to the full text index entry. If the visit ID is 0, the
+  // visit database will not be updated.
   bool AddPageData(const GURL& url,
                    URLID url_id,
                    VisitID visit_id,
@@ -146,6 +160,11 @@ class TextDatabaseManager {
   // will be removed rather than marked unused.
   void OptimizeChangedDatabases(const ChangeSet& change_set);
 
+  // Writes the complete pages which are still waiting to be indexed, converting
+  // their text on this thread. This must be called before the URL and visit
+  // databases go away.
+  void FlushPendingPages();
+
   // Executes the given query. See QueryOptions for more info on input.
   //
   // The results are filled into |results|, and the first time considered for
@@ -158,10 +177,21 @@ class TextDatabaseManager {
                       std::vector<TextDatabase::Match>* results,
                       base::Time* first_time_searched);
 
+  // Like GetTextMatches() above, but gives up as soon as |cancel_flag| is set,
+  // in which case |results| are incomplete. |cancel_flag| can be NULL.
+  void GetTextMatches(const string16& query,
+                      const QueryOptions& options,
+                      const base::CancellationFlag* cancel_flag,
+                      std::vector<TextDatabase::Match>* results,
+                      base::Time* first_time_searched);
+
  private:
   // These tests call ExpireRecentChangesForTime to force expiration.
   FRIEND_TEST_ALL_PREFIXES(TextDatabaseManagerTest, InsertPartial);
   FRIEND_TEST_ALL_PREFIXES(TextDatabaseManagerTest, PartialComplete);
+  FRIEND_TEST_ALL_PREFIXES(TextDatabaseManagerTest, BatchedInsert);
+  FRIEND_TEST_ALL_PREFIXES(TextDatabaseManagerTest, MergeWhenIdle);
+  friend class TextDatabaseManagerPerfTest;
   FRIEND_TEST_ALL_PREFIXES(ExpireHistoryTest, DeleteURLAndFavicon);
   FRIEND_TEST_ALL_PREFIXES(ExpireHistoryTest, FlushRecentURLsUnstarred);
   FRIEND_TEST_ALL_PREFIXES(ExpireHistoryTest,
@@ -213,6 +243,54 @@ class TextDatabaseManager {
     string16 body_;
   };
 
+  // A page whose title and body are known, waiting to be indexed.
+  struct PendingPage {
+    PendingPage();
+    ~PendingPage();
+
+    GURL url;
+    URLID url_id;
+    VisitID visit_id;
+    base::Time visit_time;
+    string16 title;
+    string16 body;
+
+    // Set when the history of the page is deleted before it is indexed.
+    bool deleted;
+  };
+  typedef std::vector<PendingPage> PendingPages;
+
+  // A batch of pages whose text is being converted for the indexer on a worker
+  // thread. Only ConvertText() runs on the worker thread, everything else is
+  // done on the thread of the manager.
+  class IndexBatch : public base::RefCountedThreadSafe<IndexBatch> {
+   public:
+    IndexBatch();
+
+    // Fills in |titles| and |bodies| from |pages|.
+    void ConvertText();
+
+    PendingPages pages;
+
+    // The text of |pages| as it is given to the indexer.
+    std::vector<std::string> titles;
+    std::vector<std::string> bodies;
+
+    // Set on the thread of the manager once ConvertText() has finished.
+    bool converted;
+
+    // Set once the batch has been written to the databases, or dropped.
+    bool written;
+
+   private:
+    friend class base::RefCountedThreadSafe<IndexBatch>;
+
+    ~IndexBatch();
+
+    DISALLOW_COPY_AND_ASSIGN(IndexBatch);
+  };
+  typedef std::vector<scoped_refptr<IndexBatch> > IndexBatches;
+
   // Converts the given time to a database identifier or vice-versa.
   static TextDatabase::DBIdent TimeToID(base::Time time);
   static base::Time IDToTime(TextDatabase::DBIdent id);
@@ -247,6 +325,34 @@ class TextDatabaseManager {
   // by the unit tests with fake times.
   void FlushOldChangesForTime(base::TimeTicks now);
 
+  // Queues the complete page to be indexed with the next batch.
+  void QueuePage(const GURL& url,
+                 URLID url_id,
+                 VisitID visit_id,
+                 base::Time visit_time,
+                 const string16& title,
+                 const string16& body);
+
+  // Sends the queued pages to a worker thread to have their text converted.
+  void StartIndexBatch();
+
+  // Called when a worker thread has converted the text of |batch|. Writes the
+  // converted batches in the order they were started.
+  void OnIndexBatchConverted(scoped_refptr<IndexBatch> batch);
+
+  // Writes the pages of |batch| in one transaction, converting their text
+  // here if the worker thread hasn't.
+  void WriteIndexBatch(IndexBatch* batch);
+
+  // Adds |page| to its database, given its text converted for the indexer.
+  bool WritePageData(const PendingPage& page,
+                     const std::string& indexed_title,
+                     const std::string& indexed_body);
+
+  // Optimizes the databases which had enough pages indexed since they were
+  // last optimized. Run once indexing has been idle for a while.
+  void MergeIdleDatabases();
+
   // Directory holding our index files.
   const FilePath dir_;
 
@@ -265,6 +371,23 @@ class TextDatabaseManager {
   typedef base::MRUCache<GURL, PageInfo> RecentChangeList;
   RecentChangeList recent_changes_;
 
+  // Complete pages waiting for the next batch, oldest first.
+  PendingPages pending_pages_;
+
+  // Batches whose text is being converted, or which are waiting for an older
+  // batch to be converted, oldest first.
+  IndexBatches index_batches_;
+
+  // Starts a batch for the pending pages if not enough come in to fill one.
+  base::OneShotTimer<TextDatabaseManager> index_timer_;
+
+  // The number of pages indexed into each database since it was last
+  // optimized.
+  std::map<TextDatabase::DBIdent, int> pages_since_merge_;
+
+  // Optimizes the databases once indexing is idle.
+  base::OneShotTimer<TextDatabaseManager> merge_timer_;
+
   // Nesting levels of transactions. Since sqlite only allows one open
   // transaction, we simulate nested transactions by mapping the outermost one
   // to a real transaction. Since this object never needs to do ROLLBACK, losing
@@ -298,6 +421,9 @@ class TextDatabaseManager {
   // Generates tasks for our periodic checking of expired "recent changes".
   base::WeakPtrFactory<TextDatabaseManager> weak_factory_;
 
+  // Generates the replies of the text conversion tasks.
+  base::WeakPtrFactory<TextDatabaseManager> index_weak_factory_;
+
   // This object is created and managed by the history backend. We maintain an
   // opaque pointer to the object for our use.
   // This can be NULL if there are no indexers registered to receive indexing
@@ -0,0 +1,145 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares writing full-text history one page at a time with writing it in
+// batches, and times queries of the result.
+
+#include <string>
+#include <vector>
+
+#include "base/file_path.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/perftimer.h"
+#include "base/scoped_temp_dir.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "chrome/browser/history/text_database_manager.h"
+#include "chrome/browser/history/visit_database.h"
+#include "googleurl/src/gurl.h"
+#include "sql/connection.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::Time;
+using base::TimeDelta;
+
+namespace history {
+
+namespace {
+
+const int kNumPages = 2000;
+
+// An in-memory URL+VisitDatabase for the manager to update.
+class InMemDB : public URLDatabase, public VisitDatabase {
+ public:
+  InMemDB() {
+    EXPECT_TRUE(db_.OpenInMemory());
+    CreateURLTable(false);
+    InitVisitTable();
+  }
+
+ private:
+  virtual sql::Connection& GetDB() { return db_; }
+
+  sql::Connection db_;
+
+  DISALLOW_COPY_AND_ASSIGN(InMemDB);
+};
+
+}  // namespace
+
+class TextDatabaseManagerPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    manager_.reset(new TextDatabaseManager(temp_dir_.path(), &visit_db_,
+                                           &visit_db_));
+    ASSERT_TRUE(manager_->Init(NULL));
+
+    // Spread the pages over a few months so that several databases are used.
+    Time now = Time::Now();
+    for (int i = 0; i < kNumPages; ++i) {
+      VisitRow visit;
+      visit.url_id = i + 1;
+      visit.visit_time = now - TimeDelta::FromHours(i);
+      visit.transition = content::PAGE_TRANSITION_LINK;
+      visit_db_.AddVisit(&visit, SOURCE_BROWSED);
+      visits_.push_back(visit);
+    }
+  }
+
+  GURL URLForPage(int i) const {
+    return GURL(base::StringPrintf("http://www.site%d.com/article%d.html",
+                                   i % 100, i));
+  }
+
+  string16 TitleForPage(int i) const {
+    return UTF8ToUTF16(base::StringPrintf("Article %d about topic%d", i,
+                                          i % 50));
+  }
+
+  string16 BodyForPage(int i) const {
+    std::string body;
+    for (int j = 0; j < 50; ++j)
+      body += base::StringPrintf("word%d  paragraph\n\t%d ", (i + j) % 300, j);
+    return UTF8ToUTF16(body);
+  }
+
+  // Queues page |i| to be indexed with the next batch.
+  void QueuePage(int i) {
+    manager_->QueuePage(URLForPage(i), visits_[i].url_id, visits_[i].visit_id,
+                        visits_[i].visit_time, TitleForPage(i),
+                        BodyForPage(i));
+  }
+
+  // Logs the indexing rate of |seconds| for all the pages as |name|.
+  void LogPagesPerSecond(const std::string& name, double seconds) {
+    LogPerfResult(name.c_str(), kNumPages / seconds, "pages/s");
+  }
+
+  // Times a few queries of the indexed pages.
+  void TimeQueries(const std::string& name) {
+    const char* kQueries[] = { "article", "topic7", "word12 paragraph",
+                               "site3" };
+    PerfTimeLogger timer(name.c_str());
+    for (size_t i = 0; i < arraysize(kQueries); ++i) {
+      QueryOptions options;
+      std::vector<TextDatabase::Match> results;
+      Time first_time_searched;
+      manager_->GetTextMatches(ASCIIToUTF16(kQueries[i]), options,
+                               &results, &first_time_searched);
+    }
+  }
+
+  MessageLoop message_loop_;
+  ScopedTempDir temp_dir_;
+  InMemDB visit_db_;
+  scoped_ptr<TextDatabaseManager> manager_;
+  VisitVector visits_;
+};
+
+TEST_F(TextDatabaseManagerPerfTest, IndexOneAtATime) {
+  PerfTimer timer;
+  for (int i = 0; i < kNumPages; ++i) {
+    manager_->AddPageData(URLForPage(i), visits_[i].url_id,
+                          visits_[i].visit_id, visits_[i].visit_time,
+                          TitleForPage(i), BodyForPage(i));
+  }
+  LogPagesPerSecond("TextDatabaseManager_index_one_at_a_time",
+                    timer.Elapsed().InSecondsF());
+  TimeQueries("TextDatabaseManager_query_one_at_a_time");
+}
+
+TEST_F(TextDatabaseManagerPerfTest, IndexBatched) {
+  PerfTimer timer;
+  for (int i = 0; i < kNumPages; ++i)
+    QueuePage(i);
+  manager_->FlushPendingPages();
+  LogPagesPerSecond("TextDatabaseManager_index_batched",
+                    timer.Elapsed().InSecondsF());
+  TimeQueries("TextDatabaseManager_query_batched");
+}
+
+}  // namespace history
@@ -5,6 +5,9 @@
 #include "base/file_path.h"
 #include "base/file_util.h"
 #include "base/message_loop.h"
+#include "base/stringprintf.h"
+#include "base/synchronization/cancellation_flag.h"
+#include "base/threading/platform_thread.h"
 #include "base/utf_string_conversions.h"
 #include "chrome/browser/history/text_database_manager.h"
 #include "chrome/browser/history/visit_database.h"
@@ -144,6 +147,28 @@ bool ResultsHaveURL(const std::vector<TextDatabase::Match>& results,
   return false;
 }
 
+// Adds complete pages numbered [first, first + count), each with a visit, one
+// second apart starting at |start|. The visits are filled into |*visits|.
+void AddCompletePages(TextDatabaseManager* manager, VisitDatabase* visit_db,
+                      Time start, int first, int count, VisitVector* visits) {
+  for (int i = first; i < first + count; i++) {
+    VisitRow visit;
+    visit.url_id = i + 1;
+    visit.visit_time = start + TimeDelta::FromSeconds(i - first);
+    visit.referring_visit = 0;
+    visit.transition = content::PAGE_TRANSITION_LINK;
+    visit.segment_id = 0;
+    visit.is_indexed = false;
+    visit_db->AddVisit(&visit, SOURCE_BROWSED);
+    visits->push_back(visit);
+
+    const GURL url(base::StringPrintf("http://www.google.com/%d", i));
+    manager->AddPageURL(url, visit.url_id, visit.visit_id, visit.visit_time);
+    manager->AddPageTitle(url, UTF8ToUTF16(base::StringPrintf("Page %d", i)));
+    manager->AddPageContents(url, UTF8ToUTF16(kBody1));
+  }
+}
+
 }  // namespace
 
 class TextDatabaseManagerTest : public testing::Test {
@@ -534,4 +559,121 @@ TEST_F(TextDatabaseManagerTest, QueryBackwards) {
   EXPECT_EQ(0U, results.size());
 }
 
+// Tests that complete pages are indexed in a batch once enough of them came in,
+// without waiting for a query.
+TEST_F(TextDatabaseManagerTest, BatchedInsert) {
+  ASSERT_TRUE(Init());
+  InMemDB visit_db;
+  TextDatabaseManager manager(dir_, &visit_db, &visit_db);
+  ASSERT_TRUE(manager.Init(NULL));
+
+  // Pages are not written as soon as they are complete.
+  VisitVector visits;
+  AddCompletePages(&manager, &visit_db, Time::Now(), 0, 1, &visits);
+  EXPECT_EQ(1U, manager.pending_pages_.size());
+  EXPECT_TRUE(manager.index_timer_.IsRunning());
+
+  // Filling a batch sends it off to be converted.
+  AddCompletePages(&manager, &visit_db, Time::Now(), 1, 49, &visits);
+  EXPECT_TRUE(manager.pending_pages_.empty());
+  ASSERT_EQ(1U, manager.index_batches_.size());
+
+  // Wait for the batch to come back and be written.
+  for (int i = 0; i < 500 && !manager.index_batches_.empty(); i++) {
+    base::PlatformThread::Sleep(TimeDelta::FromMilliseconds(10));
+    message_loop_.RunAllPending();
+  }
+  ASSERT_TRUE(manager.index_batches_.empty());
+  for (size_t i = 0; i < visits.size(); i++) {
+    VisitRow row;
+    ASSERT_TRUE(visit_db.GetRowForVisit(visits[i].visit_id, &row));
+    EXPECT_TRUE(row.is_indexed);
+  }
+  EXPECT_TRUE(manager.merge_timer_.IsRunning());
+
+  QueryOptions options;
+  std::vector<TextDatabase::Match> results;
+  Time first_time_searched;
+  manager.GetTextMatches(UTF8ToUTF16("FOO"), options,
+                         &results, &first_time_searched);
+  EXPECT_EQ(50U, results.size());
+}
+
+// Tests that complete pages which haven't been written yet can be deleted.
+TEST_F(TextDatabaseManagerTest, DeleteUnwritten) {
+  ASSERT_TRUE(Init());
+  InMemDB visit_db;
+  TextDatabaseManager manager(dir_, &visit_db, &visit_db);
+  ASSERT_TRUE(manager.Init(NULL));
+
+  // A full batch, which is being converted, and one waiting page.
+  VisitVector visits;
+  AddCompletePages(&manager, &visit_db, Time::Now(), 0, 51, &visits);
+  manager.DeleteFromUncommitted(std::set<GURL>(), Time(), Time());
+
+  QueryOptions options;
+  std::vector<TextDatabase::Match> results;
+  Time first_time_searched;
+  manager.GetTextMatches(UTF8ToUTF16("FOO"), options,
+                         &results, &first_time_searched);
+  EXPECT_EQ(0U, results.size());
+}
+
+// Tests that a canceled query stops without searching.
+TEST_F(TextDatabaseManagerTest, CanceledQuery) {
+  ASSERT_TRUE(Init());
+  InMemDB visit_db;
+  TextDatabaseManager manager(dir_, &visit_db, &visit_db);
+  ASSERT_TRUE(manager.Init(NULL));
+
+  std::vector<Time> times;
+  AddAllPages(manager, &visit_db, &times);
+
+  QueryOptions options;
+  options.begin_time = times[0] - TimeDelta::FromDays(100);
+  options.end_time = times[times.size() - 1] + TimeDelta::FromDays(100);
+  std::vector<TextDatabase::Match> results;
+  Time first_time_searched;
+  base::CancellationFlag cancel_flag;
+  cancel_flag.Set();
+  manager.GetTextMatches(UTF8ToUTF16("FOO"), options, &cancel_flag,
+                         &results, &first_time_searched);
+  EXPECT_EQ(0U, results.size());
+
+  // The pages were still written.
+  manager.GetTextMatches(UTF8ToUTF16("FOO"), options, NULL,
+                         &results, &first_time_searched);
+  EXPECT_EQ(6U, results.size());
+}
+
+// Tests that only databases which got enough new pages are optimized.
+TEST_F(TextDatabaseManagerTest, MergeWhenIdle) {
+  ASSERT_TRUE(Init());
+  InMemDB visit_db;
+  TextDatabaseManager manager(dir_, &visit_db, &visit_db);
+  ASSERT_TRUE(manager.Init(NULL));
+
+  Time::Exploded exploded;
+  memset(&exploded, 0, sizeof(Time::Exploded));
+  exploded.year = 2008;
+  exploded.month = 1;
+  exploded.day_of_month = 3;
+  Time january = Time::FromUTCExploded(exploded);
+  exploded.month = 2;
+  Time february = Time::FromUTCExploded(exploded);
+
+  VisitVector visits;
+  AddCompletePages(&manager, &visit_db, january, 0, 100, &visits);
+  AddCompletePages(&manager, &visit_db, february, 100, 10, &visits);
+  manager.FlushPendingPages();
+  ASSERT_EQ(2U, manager.pages_since_merge_.size());
+  EXPECT_EQ(100, manager.pages_since_merge_[
+      TextDatabaseManager::TimeToID(january)]);
+
+  manager.MergeIdleDatabases();
+  ASSERT_EQ(1U, manager.pages_since_merge_.size());
+  EXPECT_EQ(10, manager.pages_since_merge_[
+      TextDatabaseManager::TimeToID(february)]);
+}
+
 }  // namespace history
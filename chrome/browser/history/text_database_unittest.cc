@@ -57,7 +57,7 @@ int RowCount(TextDatabase* db) {
   std::vector<TextDatabase::Match> results;
   Time first_time_searched;
   TextDatabase::URLSet unique_urls;
-  db->GetTextMatches("COUNTTAG", options, &results, &unique_urls,
+  db->GetTextMatches("COUNTTAG", options, NULL, &results, &unique_urls,
                      &first_time_searched);
   return static_cast<int>(results.size());
 }
@@ -196,7 +196,7 @@ TEST_F(TextDatabaseTest, Query) {
   std::vector<TextDatabase::Match> results;
   Time first_time_searched;
   TextDatabase::URLSet unique_urls;
-  db->GetTextMatches("COUNTTAG", options, &results, &unique_urls,
+  db->GetTextMatches("COUNTTAG", options, NULL, &results, &unique_urls,
                      &first_time_searched);
   EXPECT_TRUE(unique_urls.empty()) << "Didn't ask for unique URLs";
 
@@ -247,7 +247,7 @@ TEST_F(TextDatabaseTest, TimeRange) {
   std::vector<TextDatabase::Match> results;
   Time first_time_searched;
   TextDatabase::URLSet unique_urls;
-  db->GetTextMatches("COUNTTAG", options, &results,  &unique_urls,
+  db->GetTextMatches("COUNTTAG", options, NULL, &results,  &unique_urls,
                      &first_time_searched);
   EXPECT_TRUE(unique_urls.empty()) << "Didn't ask for unique URLs";
 
@@ -265,7 +265,7 @@ TEST_F(TextDatabaseTest, TimeRange) {
   options.begin_time = Time::FromInternalValue((kTime2 - kTime1) / 2 + kTime1);
   options.end_time = Time::FromInternalValue(kTime3 + 1);
   results.clear();  // GetTextMatches does *not* clear the results.
-  db->GetTextMatches("COUNTTAG", options, &results, &unique_urls,
+  db->GetTextMatches("COUNTTAG", options, NULL, &results, &unique_urls,
                      &first_time_searched);
   EXPECT_TRUE(unique_urls.empty()) << "Didn't ask for unique URLs";
   EXPECT_EQ(options.begin_time.ToInternalValue(),
@@ -281,7 +281,7 @@ TEST_F(TextDatabaseTest, TimeRange) {
   options.begin_time = Time::FromInternalValue(kTime3 + 1);
   options.end_time = Time::FromInternalValue(kTime3 * 100);
   results.clear();
-  db->GetTextMatches("COUNTTAG", options, &results, &unique_urls,
+  db->GetTextMatches("COUNTTAG", options, NULL, &results, &unique_urls,
                      &first_time_searched);
   EXPECT_EQ(options.begin_time.ToInternalValue(),
             first_time_searched.ToInternalValue());
@@ -305,7 +305,7 @@ TEST_F(TextDatabaseTest, MaxCount) {
   std::vector<TextDatabase::Match> results;
   Time first_time_searched;
   TextDatabase::URLSet unique_urls;
-  db->GetTextMatches("google", options, &results, &unique_urls,
+  db->GetTextMatches("google", options, NULL, &results, &unique_urls,
                      &first_time_searched);
   EXPECT_TRUE(unique_urls.empty()) << "Didn't ask for unique URLs";
 
@@ -10,8 +10,10 @@
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/logging.h"
+#include "base/command_line.h"
 #include "base/md5.h"
 #include "base/memory/ref_counted_memory.h"
+#include "base/metrics/histogram.h"
 #include "base/string_util.h"
 #include "base/utf_string_conversions.h"
 #include "base/values.h"
@@ -26,6 +28,7 @@
 #include "chrome/browser/ui/webui/ntp/most_visited_handler.h"
 #include "chrome/browser/ui/webui/ntp/new_tab_ui.h"
 #include "chrome/common/chrome_notification_types.h"
+#include "chrome/common/chrome_switches.h"
 #include "chrome/common/pref_names.h"
 #include "chrome/common/thumbnail_score.h"
 #include "content/public/browser/browser_thread.h"
@@ -66,6 +69,16 @@ static const int64 kMaxUpdateIntervalMinutes = 60;
 // artifacts for these small sized, highly detailed images.
 static const int kTopSitesImageQuality = 100;
 
+// WebP at this quality looks like JPEG at 100, at about a third of the size.
+static const int kTopSitesWebPImageQuality = 90;
+
+// The thumbnails of this many of the top sites, which fill the first page of
+// the new tab page, are always kept in memory. The thumbnails of the other
+// sites are kept as long as all the thumbnails take no more than
+// kMaxThumbnailBytes, and are read from the database when needed otherwise.
+static const size_t kResidentThumbnails = 8;
+static const size_t kMaxThumbnailBytes = 256 * 1024;
+
 const TopSites::PrepopulatedPage kPrepopulatedPages[] = {
   { IDS_CHROME_WELCOME_URL, IDS_NEW_TAB_CHROME_WELCOME_PAGE_TITLE,
     IDR_PRODUCT_LOGO_16, IDR_NEWTAB_CHROME_WELCOME_PAGE_THUMBNAIL,
@@ -262,6 +275,21 @@ bool TopSites::GetPageThumbnail(const GURL& url,
   return false;
 }
 
+bool TopSites::LoadEvictedPageThumbnail(
+    const GURL& url,
+    const LoadThumbnailCallback& callback) {
+  // WARNING: this may be invoked on any thread.
+  GURL canonical_url;
+  {
+    base::AutoLock lock(lock_);
+    if (!backend_.get() || !thread_safe_cache_->IsThumbnailEvicted(url))
+      return false;
+    canonical_url = thread_safe_cache_->GetCanonicalURL(url);
+  }
+  backend_->GetPageThumbnail(canonical_url, callback);
+  return true;
+}
+
 bool TopSites::GetPageThumbnailScore(const GURL& url,
                                      ThumbnailScore* score) {
   // WARNING: this may be invoked on any thread.
@@ -519,9 +547,10 @@ bool TopSites::SetPageThumbnailNoDB(const GURL& url,
   new_score_with_redirects.redirect_hops_from_dest =
       GetRedirectDistanceForURL(most_visited, url);
 
+  // A thumbnail which was dropped from memory is still in the database.
   if (!ShouldReplaceThumbnailWith(image->thumbnail_score,
                                   new_score_with_redirects) &&
-      image->thumbnail.get())
+      (image->thumbnail.get() || cache_->IsThumbnailEvicted(url)))
     return false;  // The one we already have is better.
 
   image->thumbnail = const_cast<base::RefCountedBytes*>(thumbnail_data);
@@ -543,9 +572,12 @@ bool TopSites::SetPageThumbnailEncoded(const GURL& url,
 
   size_t index = cache_->GetURLIndex(url);
   const MostVisitedURL& most_visited = cache_->top_sites()[index];
-  backend_->SetPageThumbnail(most_visited,
-                             index,
-                             *(cache_->GetImage(most_visited.url)));
+  // The cache may already have dropped the new thumbnail from memory, so don't
+  // write its copy.
+  Images image;
+  image.thumbnail = const_cast<base::RefCountedBytes*>(thumbnail);
+  image.thumbnail_score = cache_->GetImage(most_visited.url)->thumbnail_score;
+  backend_->SetPageThumbnail(most_visited, index, image);
   return true;
 }
 
@@ -556,8 +588,22 @@ bool TopSites::EncodeBitmap(gfx::Image* bitmap,
     return false;
   *bytes = new base::RefCountedBytes();
   std::vector<unsigned char> data;
-  if (!gfx::JPEGEncodedDataFromImage(*bitmap, kTopSitesImageQuality, &data))
-    return false;
+  base::TimeTicks start_time = base::TimeTicks::Now();
+  if (CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kEnableWebPThumbnails)) {
+    if (!gfx::WebPEncodedDataFromImage(*bitmap, kTopSitesWebPImageQuality,
+                                       &data))
+      return false;
+    UMA_HISTOGRAM_TIMES("TopSites.EncodeThumbnailTime.WebP",
+                        base::TimeTicks::Now() - start_time);
+    UMA_HISTOGRAM_COUNTS_10000("TopSites.ThumbnailSize.WebP", data.size());
+  } else {
+    if (!gfx::JPEGEncodedDataFromImage(*bitmap, kTopSitesImageQuality, &data))
+      return false;
+    UMA_HISTOGRAM_TIMES("TopSites.EncodeThumbnailTime.JPEG",
+                        base::TimeTicks::Now() - start_time);
+    UMA_HISTOGRAM_COUNTS_10000("TopSites.ThumbnailSize.JPEG", data.size());
+  }
 
   // As we're going to cache this data, make sure the vector is only as big as
   // it needs to be, as JPEGCodec::Encode() over-allocates data.capacity().
@@ -817,8 +863,14 @@ void TopSites::ResetThreadSafeCache() {
 }
 
 void TopSites::ResetThreadSafeImageCache() {
+  size_t thumbnail_bytes =
+      cache_->TrimThumbnails(kResidentThumbnails, kMaxThumbnailBytes);
+  UMA_HISTOGRAM_MEMORY_KB("TopSites.ThumbnailMemoryKB",
+                          static_cast<int>(thumbnail_bytes / 1024));
+
   base::AutoLock lock(lock_);
   thread_safe_cache_->SetThumbnails(cache_->images());
+  thread_safe_cache_->SetEvictedThumbnails(cache_->evicted_thumbnails());
 }
 
 void TopSites::NotifyTopSitesChanged() {
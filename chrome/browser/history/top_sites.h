@@ -84,6 +84,19 @@ class TopSites
   bool GetPageThumbnail(const GURL& url,
                         scoped_refptr<base::RefCountedMemory>* bytes);
 
+  // Callback for LoadEvictedPageThumbnail. The thumbnail is NULL if it could
+  // not be read.
+  typedef base::Callback<void(scoped_refptr<base::RefCountedBytes>)>
+      LoadThumbnailCallback;
+
+  // Only the thumbnails of the best ranked sites are always kept in memory, so
+  // GetPageThumbnail may not have a thumbnail which is in the database. If so,
+  // this reads it and runs |callback| with it on the calling thread, and
+  // returns true. Otherwise returns false without running |callback|.
+  // This may be invoked on any thread with a message loop.
+  bool LoadEvictedPageThumbnail(const GURL& url,
+                                const LoadThumbnailCallback& callback);
+
   // Get a thumbnail score for a given page. Returns true iff we have the
   // thumbnail score.  This may be invoked on any thread. The score will
   // be copied to |score|.
@@ -225,8 +238,9 @@ class TopSites
                                const base::RefCountedBytes* thumbnail,
                                const ThumbnailScore& score);
 
-  // Encodes the bitmap to bytes for storage to the db. Returns true if the
-  // bitmap was successfully encoded.
+  // Encodes the bitmap to bytes for storage to the db, as WebP if
+  // --enable-webp-thumbnails is given and as JPEG otherwise. Returns true if
+  // the bitmap was successfully encoded.
   static bool EncodeBitmap(gfx::Image* bitmap,
                            scoped_refptr<base::RefCountedBytes>* bytes);
 
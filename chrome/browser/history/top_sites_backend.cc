@@ -8,6 +8,7 @@
 #include "base/file_path.h"
 #include "base/file_util.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
 #include "chrome/browser/history/top_sites_database.h"
 #include "content/public/browser/browser_thread.h"
 
@@ -15,6 +16,19 @@ using content::BrowserThread;
 
 namespace history {
 
+namespace {
+
+void RunGetPageThumbnailCallback(
+    const TopSitesBackend::GetPageThumbnailCallback& callback,
+    Images* thumbnail) {
+  // The database stores a missing thumbnail as an empty one.
+  if (thumbnail->thumbnail.get() && !thumbnail->thumbnail->size())
+    thumbnail->thumbnail = NULL;
+  callback.Run(thumbnail->thumbnail);
+}
+
+}  // namespace
+
 TopSitesBackend::TopSitesBackend()
     : db_(new TopSitesDatabase()) {
 }
@@ -46,6 +60,20 @@ TopSitesBackend::Handle TopSitesBackend::GetMostVisitedThumbnails(
   return request->handle();
 }
 
+void TopSitesBackend::GetPageThumbnail(
+    const GURL& url,
+    const GetPageThumbnailCallback& callback) {
+  Images* thumbnail = new Images;
+  if (!BrowserThread::PostTaskAndReply(
+          BrowserThread::DB, FROM_HERE,
+          base::Bind(&TopSitesBackend::GetPageThumbnailOnDBThread, this, url,
+                     thumbnail),
+          base::Bind(&RunGetPageThumbnailCallback, callback,
+                     base::Owned(thumbnail)))) {
+    callback.Run(NULL);
+  }
+}
+
 void TopSitesBackend::UpdateTopSites(const TopSitesDelta& delta) {
   BrowserThread::PostTask(
       BrowserThread::DB, FROM_HERE,
@@ -114,6 +142,13 @@ void TopSitesBackend::GetMostVisitedThumbnailsOnDBThread(
                          may_need_history_migration);
 }
 
+void TopSitesBackend::GetPageThumbnailOnDBThread(const GURL& url,
+                                                 Images* thumbnail) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::DB));
+  if (db_.get())
+    db_->GetPageThumbnail(url, thumbnail);
+}
+
 void TopSitesBackend::UpdateTopSitesOnDBThread(const TopSitesDelta& delta) {
   if (!db_.get())
     return;
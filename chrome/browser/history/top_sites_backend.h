@@ -14,6 +14,11 @@
 #include "chrome/browser/history/history_types.h"
 
 class FilePath;
+class GURL;
+
+namespace base {
+class RefCountedBytes;
+}
 
 namespace history {
 
@@ -47,6 +52,15 @@ class TopSitesBackend
       CancelableRequestConsumerBase* consumer,
       const GetMostVisitedThumbnailsCallback& callback);
 
+  typedef base::Callback<void(scoped_refptr<base::RefCountedBytes>)>
+      GetPageThumbnailCallback;
+
+  // Reads the thumbnail of |url| and runs |callback| with it, or with NULL if
+  // there is none, on the calling thread. Unlike the other methods this may
+  // be invoked on any thread with a message loop.
+  void GetPageThumbnail(const GURL& url,
+                        const GetPageThumbnailCallback& callback);
+
   // Updates top sites database from the specified delta.
   void UpdateTopSites(const TopSitesDelta& delta);
 
@@ -83,6 +97,9 @@ class TopSitesBackend
   void GetMostVisitedThumbnailsOnDBThread(
       scoped_refptr<GetMostVisitedThumbnailsRequest> request);
 
+  // Reads the thumbnail of |url| into |thumbnail|.
+  void GetPageThumbnailOnDBThread(const GURL& url, Images* thumbnail);
+
   // Updates top sites.
   void UpdateTopSitesOnDBThread(const TopSitesDelta& delta);
 
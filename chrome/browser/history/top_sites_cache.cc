@@ -24,6 +24,41 @@ void TopSitesCache::SetThumbnails(const URLToImagesMap& images) {
   images_ = images;
 }
 
+size_t TopSitesCache::TrimThumbnails(size_t resident_count,
+                                     size_t max_bytes) {
+  std::set<GURL> evicted;
+  size_t total_bytes = 0;
+  for (size_t i = 0; i < top_sites_.size(); ++i) {
+    const GURL& url = top_sites_[i].url;
+    URLToImagesMap::iterator found = images_.find(url);
+    if (found == images_.end() || !found->second.thumbnail.get()) {
+      // Still evicted, unless the site got a new thumbnail since.
+      if (evicted_thumbnails_.count(url))
+        evicted.insert(url);
+      continue;
+    }
+    size_t size = found->second.thumbnail->size();
+    if (i >= resident_count && total_bytes + size > max_bytes) {
+      // Keep the score so that a worse thumbnail doesn't replace this one.
+      found->second.thumbnail = NULL;
+      evicted.insert(url);
+      continue;
+    }
+    total_bytes += size;
+  }
+  // Sites which are no longer top sites are forgotten.
+  evicted_thumbnails_.swap(evicted);
+  return total_bytes;
+}
+
+void TopSitesCache::SetEvictedThumbnails(const std::set<GURL>& urls) {
+  evicted_thumbnails_ = urls;
+}
+
+bool TopSitesCache::IsThumbnailEvicted(const GURL& url) {
+  return evicted_thumbnails_.count(GetCanonicalURL(url)) > 0;
+}
+
 Images* TopSitesCache::GetImage(const GURL& url) {
   return &images_[GetCanonicalURL(url)];
 }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <map>
+#include <set>
 #include <utility>
 
 #include "base/memory/ref_counted.h"
@@ -28,6 +29,23 @@ class TopSitesCache {
   void SetThumbnails(const URLToImagesMap& images);
   const URLToImagesMap& images() const { return images_; }
 
+  // Drops the thumbnails of the lower ranked top sites from memory until the
+  // remaining ones take at most |max_bytes|. The thumbnails of the first
+  // |resident_count| top sites, which the new tab page shows first, are always
+  // kept. Dropped thumbnails are only in the database from then on, until the
+  // site gets a new one. Returns the size of the thumbnails kept.
+  size_t TrimThumbnails(size_t resident_count, size_t max_bytes);
+
+  // The canonical urls of the top sites whose thumbnails were dropped by
+  // TrimThumbnails().
+  void SetEvictedThumbnails(const std::set<GURL>& urls);
+  const std::set<GURL>& evicted_thumbnails() const {
+    return evicted_thumbnails_;
+  }
+
+  // Returns true if the thumbnail for |url| was dropped by TrimThumbnails().
+  bool IsThumbnailEvicted(const GURL& url);
+
   // Returns the thumbnail as an Image for the specified url. This adds an entry
   // for |url| if one has not yet been added.
   Images* GetImage(const GURL& url);
@@ -90,6 +108,9 @@ class TopSitesCache {
   // The images. These map from canonical url to image.
   URLToImagesMap images_;
 
+  // See evicted_thumbnails().
+  std::set<GURL> evicted_thumbnails_;
+
   // Generated from the redirects to and from the most visited pages. See
   // description above typedef for details.
   CanonicalURLs canonical_urls_;
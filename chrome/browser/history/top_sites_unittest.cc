@@ -9,6 +9,7 @@
 #include "base/path_service.h"
 #include "base/scoped_temp_dir.h"
 #include "base/string_util.h"
+#include "base/stringprintf.h"
 #include "base/utf_string_conversions.h"
 #include "base/values.h"
 #include "chrome/browser/history/history_backend.h"
@@ -590,6 +591,49 @@ TEST_F(TopSitesTest, GetPageThumbnail) {
   EXPECT_TRUE(ThumbnailEqualsBytes(thumbnail, result.get()));
 }
 
+// Tests that TopSitesCache only drops the thumbnails of the lower ranked sites
+// from memory, and only those which don't fit.
+TEST_F(TopSitesTest, TrimThumbnails) {
+  TopSitesCache cache;
+  MostVisitedURLList list;
+  URLToImagesMap images;
+  for (int i = 0; i < 4; ++i) {
+    GURL url(base::StringPrintf("http://site%d.com/", i));
+    AppendMostVisitedURL(&list, url);
+    std::vector<unsigned char> data(100, i);
+    images[url].thumbnail = base::RefCountedBytes::TakeVector(&data);
+  }
+  cache.SetTopSites(list);
+  cache.SetThumbnails(images);
+
+  // The first two are always kept, even if they are too big.
+  EXPECT_EQ(200u, cache.TrimThumbnails(2, 50));
+  EXPECT_EQ(2u, cache.evicted_thumbnails().size());
+
+  // The third one fits.
+  cache.SetThumbnails(images);
+  EXPECT_EQ(300u, cache.TrimThumbnails(2, 300));
+  scoped_refptr<base::RefCountedMemory> result;
+  EXPECT_TRUE(cache.GetPageThumbnail(list[2].url, &result));
+  EXPECT_FALSE(cache.IsThumbnailEvicted(list[2].url));
+  EXPECT_FALSE(cache.GetPageThumbnail(list[3].url, &result));
+  EXPECT_TRUE(cache.IsThumbnailEvicted(list[3].url));
+
+  // Evicted thumbnails stay evicted until the site gets a new one.
+  EXPECT_EQ(300u, cache.TrimThumbnails(2, 1000));
+  EXPECT_TRUE(cache.IsThumbnailEvicted(list[3].url));
+  cache.GetImage(list[3].url)->thumbnail = images[list[3].url].thumbnail;
+  EXPECT_EQ(400u, cache.TrimThumbnails(2, 1000));
+  EXPECT_FALSE(cache.IsThumbnailEvicted(list[3].url));
+
+  // Sites which are no longer top sites are forgotten.
+  EXPECT_EQ(300u, cache.TrimThumbnails(2, 300));
+  list.pop_back();
+  cache.SetTopSites(list);
+  cache.TrimThumbnails(2, 300);
+  EXPECT_TRUE(cache.evicted_thumbnails().empty());
+}
+
 // Tests GetMostVisitedURLs.
 TEST_F(TopSitesTest, GetMostVisited) {
   GURL news("http://news.google.com/");
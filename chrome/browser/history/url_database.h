@@ -50,10 +50,13 @@ class URLDatabase {
   static std::string GURLToDatabaseURL(const GURL& url);
 
   // URL table functions -------------------------------------------------------
+  //
+  // The functions that read or write single rows are virtual so that the
+  // in-memory database can keep its own index of the table up to date.
 
   // Looks up a url given an id. Fills info with the data. Returns true on
   // success and false otherwise.
-  bool GetURLRow(URLID url_id, URLRow* info);
+  virtual bool GetURLRow(URLID url_id, URLRow* info);
 
   // Looks up all urls that were typed in manually. Fills info with the data.
   // Returns true on success and false otherwise.
@@ -63,14 +66,14 @@ class URLDatabase {
   // associated info and returns the ID of that URL. If the info pointer is
   // NULL, no information about the URL will be filled in, only the ID will be
   // returned. Returns 0 if the URL was not found.
-  URLID GetRowForURL(const GURL& url, URLRow* info);
+  virtual URLID GetRowForURL(const GURL& url, URLRow* info);
 
   // Given an already-existing row in the URL table, updates that URL's stats.
   // This can not change the URL.  Returns true on success.
   //
   // This will NOT update the title used for full text indexing. If you are
   // setting the title, call SetPageIndexedData with the new title.
-  bool UpdateURLRow(URLID url_id, const URLRow& info);
+  virtual bool UpdateURLRow(URLID url_id, const URLRow& info);
 
   // Adds a line to the URL database with the given information and returns the
   // row ID. A row with the given URL must not exist. Returns 0 on error.
@@ -84,7 +87,7 @@ class URLDatabase {
   // Delete the row of the corresponding URL. Only the row in the URL table
   // will be deleted, not any other data that may refer to it. Returns true if
   // the row existed and was deleted.
-  bool DeleteURLRow(URLID id);
+  virtual bool DeleteURLRow(URLID id);
 
   // URL mass-deleting ---------------------------------------------------------
 
@@ -169,10 +172,10 @@ class URLDatabase {
   // first) up to the given maximum number.  If |typed_only| is true, only urls
   // that have been typed once are returned.  For caller convenience, returns
   // whether any results were found.
-  bool AutocompleteForPrefix(const std::string& prefix,
-                             size_t max_results,
-                             bool typed_only,
-                             URLRows* results);
+  virtual bool AutocompleteForPrefix(const std::string& prefix,
+                                     size_t max_results,
+                                     bool typed_only,
+                                     URLRows* results);
 
   // Returns true if the database holds some past typed navigation to a URL on
   // the provided hostname.
@@ -183,12 +186,12 @@ class URLDatabase {
   // If found, fills in |info| and returns true; otherwise returns false,
   // leaving |info| unchanged.
   // We allow matches of exactly |base| iff |allow_base| is true.
-  bool FindShortestURLFromBase(const std::string& base,
-                               const std::string& url,
-                               int min_visits,
-                               int min_typed,
-                               bool allow_base,
-                               history::URLRow* info);
+  virtual bool FindShortestURLFromBase(const std::string& base,
+                                       const std::string& url,
+                                       int min_visits,
+                                       int min_typed,
+                                       bool allow_base,
+                                       history::URLRow* info);
 
   // Keyword Search Terms ------------------------------------------------------
 
@@ -275,7 +278,7 @@ class URLDatabase {
   // if is_temporary is false, or the temporary URL table if is temporary is
   // true. The temporary table may only be used in between
   // CreateTemporaryURLTable() and CommitTemporaryURLTable().
-  URLID AddURLInternal(const URLRow& info, bool is_temporary);
+  virtual URLID AddURLInternal(const URLRow& info, bool is_temporary);
 
   // Convenience to fill a history::URLRow. Must be in sync with the fields in
   // kHistoryURLRowFields.
@@ -0,0 +1,509 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/history/url_index_cache_file.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "base/file_path.h"
+#include "base/logging.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "googleurl/src/gurl.h"
+
+namespace history {
+
+namespace {
+
+// "IMUI" in a little-endian file.
+const uint32 kCacheFileMagic = 0x49554D49;
+const uint32 kCacheFileVersion = 1;
+
+// Tables are padded to this many bytes, so that they are aligned for any of
+// the types they hold when the file is mapped.
+const size_t kTableAlignment = 8;
+
+// Appends the |count| items at |items| to |data| and pads it for the next
+// table.
+template <typename T>
+void AppendTable(const T* items, size_t count, std::string* data) {
+  if (count)
+    data->append(reinterpret_cast<const char*>(items), count * sizeof(T));
+  data->append((kTableAlignment - data->size() % kTableAlignment) %
+               kTableAlignment, '\0');
+}
+
+template <typename T>
+void AppendTable(const std::vector<T>& items, std::string* data) {
+  AppendTable(items.empty() ? NULL : &items[0], items.size(), data);
+}
+
+// Returns the table of |count| items at |*offset| in the |length| bytes of
+// |data| and moves |*offset| past it, or returns NULL if the table doesn't
+// fit.
+template <typename T>
+const T* TableAt(const uint8* data, size_t length, uint64 count,
+                 uint64* offset) {
+  uint64 end = *offset + count * sizeof(T);
+  if (end > length)
+    return NULL;
+  const T* table = reinterpret_cast<const T*>(data + *offset);
+  *offset = (end + kTableAlignment - 1) / kTableAlignment * kTableAlignment;
+  return table;
+}
+
+// Appends |value| to |strings| and sets |*offset| and |*length| to where it
+// is.
+void AppendString(const std::string& value,
+                  std::string* strings,
+                  uint32* offset,
+                  uint32* length) {
+  *offset = strings->size();
+  *length = value.size();
+  strings->append(value);
+}
+
+// Returns true if the |count| offsets at |offsets| start at 0, never
+// decrease and end at |limit|.
+bool OffsetsValid(const uint32* offsets, size_t count, uint32 limit) {
+  if (offsets[0] != 0 || offsets[count - 1] != limit)
+    return false;
+  for (size_t i = 1; i < count; ++i) {
+    if (offsets[i] < offsets[i - 1])
+      return false;
+  }
+  return true;
+}
+
+// Returns true if [|offset|, |offset| + |length|) is within |limit|.
+bool RangeValid(uint32 offset, uint32 length, uint32 limit) {
+  return static_cast<uint64>(offset) + length <= limit;
+}
+
+}  // namespace
+
+struct URLIndexCacheFile::Header {
+  uint32 magic;
+  uint32 version;
+  uint32 word_count;
+  uint32 word_char_count;
+  uint32 char_count;
+  uint32 char_word_id_count;
+  uint32 posting_count;
+  uint32 history_count;
+  uint32 word_start_count;
+  uint32 string_size;
+};
+
+struct URLIndexCacheFile::HistoryRecord {
+  int64 history_id;
+  int64 last_visit;
+  int32 visit_count;
+  int32 typed_count;
+  uint32 url_offset;
+  uint32 url_length;
+  uint32 title_offset;
+  uint32 title_length;
+  uint32 url_starts_offset;
+  uint32 url_starts_count;
+  uint32 title_starts_offset;
+  uint32 title_starts_count;
+};
+
+struct URLIndexCacheFile::CharEntry {
+  uint32 character;
+  uint32 begin;  // Index of the first word in |char_word_ids_|.
+};
+
+namespace {
+
+// Orders cache file entries by key, for binary searches.
+struct RecordIDLess {
+  template <typename Record>
+  bool operator()(const Record& record, int64 history_id) const {
+    return record.history_id < history_id;
+  }
+};
+
+struct CharEntryLess {
+  template <typename Entry>
+  bool operator()(const Entry& entry, uint32 character) const {
+    return entry.character < character;
+  }
+};
+
+}  // namespace
+
+URLIndexCacheFile::URLIndexCacheFile()
+    : header_(NULL),
+      postings_(NULL),
+      records_(NULL),
+      word_offsets_(NULL),
+      posting_offsets_(NULL),
+      chars_(NULL),
+      char_word_ids_(NULL),
+      word_starts_(NULL),
+      word_chars_(NULL),
+      strings_(NULL) {
+}
+
+URLIndexCacheFile::~URLIndexCacheFile() {}
+
+// static
+bool URLIndexCacheFile::Write(const FilePath& path,
+                              const WordHistoryMap& words,
+                              const HistoryInfoMap& history_info_map,
+                              const WordStartsMap& word_starts_map) {
+  COMPILE_ASSERT(sizeof(Header) % kTableAlignment == 0, header_is_padded);
+  COMPILE_ASSERT(sizeof(HistoryRecord) % kTableAlignment == 0,
+                 record_is_padded);
+
+  // The words are numbered in order, which keeps each character's list of
+  // words sorted as it is built.
+  std::vector<uint32> word_offsets(1, 0);
+  std::vector<uint32> posting_offsets(1, 0);
+  string16 word_chars;
+  std::vector<int64> postings;
+  std::map<char16, std::vector<uint32> > char_words;
+  uint32 word_id = 0;
+  for (WordHistoryMap::const_iterator iter = words.begin();
+       iter != words.end(); ++iter, ++word_id) {
+    word_chars.append(iter->first);
+    word_offsets.push_back(word_chars.size());
+    postings.insert(postings.end(), iter->second.begin(), iter->second.end());
+    posting_offsets.push_back(postings.size());
+    Char16Set characters = Char16SetFromString16(iter->first);
+    for (Char16Set::iterator char_iter = characters.begin();
+         char_iter != characters.end(); ++char_iter)
+      char_words[*char_iter].push_back(word_id);
+  }
+
+  std::vector<CharEntry> chars;
+  std::vector<uint32> char_word_ids;
+  for (std::map<char16, std::vector<uint32> >::const_iterator iter =
+       char_words.begin(); iter != char_words.end(); ++iter) {
+    CharEntry entry = { iter->first,
+                        static_cast<uint32>(char_word_ids.size()) };
+    chars.push_back(entry);
+    char_word_ids.insert(char_word_ids.end(), iter->second.begin(),
+                         iter->second.end());
+  }
+  CharEntry end_entry = { 0, static_cast<uint32>(char_word_ids.size()) };
+  chars.push_back(end_entry);
+
+  std::vector<HistoryRecord> records;
+  std::vector<uint32> word_starts;
+  std::string strings;
+  for (HistoryInfoMap::const_iterator iter = history_info_map.begin();
+       iter != history_info_map.end(); ++iter) {
+    const URLRow& row(iter->second);
+    HistoryRecord record;
+    memset(&record, 0, sizeof(record));
+    record.history_id = iter->first;
+    record.last_visit = row.last_visit().ToInternalValue();
+    record.visit_count = row.visit_count();
+    record.typed_count = row.typed_count();
+    AppendString(row.url().spec(), &strings, &record.url_offset,
+                 &record.url_length);
+    AppendString(UTF16ToUTF8(row.title()), &strings, &record.title_offset,
+                 &record.title_length);
+    WordStartsMap::const_iterator starts = word_starts_map.find(iter->first);
+    if (starts != word_starts_map.end()) {
+      const RowWordStarts& row_starts(starts->second);
+      record.url_starts_offset = word_starts.size();
+      record.url_starts_count = row_starts.url_word_starts_.size();
+      word_starts.insert(word_starts.end(), row_starts.url_word_starts_.begin(),
+                         row_starts.url_word_starts_.end());
+      record.title_starts_offset = word_starts.size();
+      record.title_starts_count = row_starts.title_word_starts_.size();
+      word_starts.insert(word_starts.end(),
+                         row_starts.title_word_starts_.begin(),
+                         row_starts.title_word_starts_.end());
+    }
+    records.push_back(record);
+  }
+
+  Header header;
+  memset(&header, 0, sizeof(header));
+  header.magic = kCacheFileMagic;
+  header.version = kCacheFileVersion;
+  header.word_count = words.size();
+  header.word_char_count = word_chars.size();
+  header.char_count = char_words.size();
+  header.char_word_id_count = char_word_ids.size();
+  header.posting_count = postings.size();
+  header.history_count = records.size();
+  header.word_start_count = word_starts.size();
+  header.string_size = strings.size();
+
+  std::string data;
+  AppendTable(&header, 1, &data);
+  AppendTable(postings, &data);
+  AppendTable(records, &data);
+  AppendTable(word_offsets, &data);
+  AppendTable(posting_offsets, &data);
+  AppendTable(chars, &data);
+  AppendTable(char_word_ids, &data);
+  AppendTable(word_starts, &data);
+  AppendTable(word_chars.data(), word_chars.size(), &data);
+  AppendTable(strings.data(), strings.size(), &data);
+  if (data.size() > static_cast<size_t>(kint32max))
+    return false;
+
+  // The old file may still be mapped, so write the new one next to it and
+  // swap it in rather than writing over it.
+  FilePath temp_path;
+  if (!file_util::CreateTemporaryFileInDir(path.DirName(), &temp_path))
+    return false;
+  int size = data.size();
+  if (file_util::WriteFile(temp_path, data.data(), size) != size ||
+      !file_util::ReplaceFile(temp_path, path)) {
+    LOG(WARNING) << "Failed to write " << path.value();
+    file_util::Delete(temp_path, false);
+    return false;
+  }
+  return true;
+}
+
+// static
+scoped_refptr<URLIndexCacheFile> URLIndexCacheFile::Open(
+    const FilePath& path) {
+  scoped_refptr<URLIndexCacheFile> cache_file(new URLIndexCacheFile);
+  if (!cache_file->Init(path))
+    return NULL;
+  return cache_file;
+}
+
+// static
+bool URLIndexCacheFile::HasCacheFileMagic(const FilePath& path) {
+  uint32 magic = 0;
+  return file_util::ReadFile(path, reinterpret_cast<char*>(&magic),
+                             sizeof(magic)) == sizeof(magic) &&
+      magic == kCacheFileMagic;
+}
+
+bool URLIndexCacheFile::Init(const FilePath& path) {
+  if (!file_.Initialize(path))
+    return false;
+  const uint8* data = file_.data();
+  size_t length = file_.length();
+  uint64 offset = 0;
+  header_ = TableAt<Header>(data, length, 1, &offset);
+  if (!header_ || header_->magic != kCacheFileMagic ||
+      header_->version != kCacheFileVersion)
+    return false;
+
+  postings_ = TableAt<int64>(data, length, header_->posting_count, &offset);
+  records_ = TableAt<HistoryRecord>(data, length, header_->history_count,
+                                    &offset);
+  word_offsets_ = TableAt<uint32>(data, length,
+                                  static_cast<uint64>(header_->word_count) + 1,
+                                  &offset);
+  posting_offsets_ = TableAt<uint32>(
+      data, length, static_cast<uint64>(header_->word_count) + 1, &offset);
+  chars_ = TableAt<CharEntry>(data, length,
+                              static_cast<uint64>(header_->char_count) + 1,
+                              &offset);
+  char_word_ids_ = TableAt<uint32>(data, length, header_->char_word_id_count,
+                                   &offset);
+  word_starts_ = TableAt<uint32>(data, length, header_->word_start_count,
+                                 &offset);
+  word_chars_ = TableAt<char16>(data, length, header_->word_char_count,
+                                &offset);
+  strings_ = TableAt<char>(data, length, header_->string_size, &offset);
+  if (!postings_ || !records_ || !word_offsets_ || !posting_offsets_ ||
+      !chars_ || !char_word_ids_ || !word_starts_ || !word_chars_ ||
+      !strings_ || offset != length)
+    return false;
+
+  return Validate();
+}
+
+bool URLIndexCacheFile::Validate() const {
+  if (!OffsetsValid(word_offsets_, header_->word_count + 1,
+                    header_->word_char_count) ||
+      !OffsetsValid(posting_offsets_, header_->word_count + 1,
+                    header_->posting_count))
+    return false;
+
+  if (chars_[0].begin != 0 ||
+      chars_[header_->char_count].begin != header_->char_word_id_count)
+    return false;
+  for (size_t i = 0; i < header_->char_count; ++i) {
+    if (chars_[i + 1].begin < chars_[i].begin ||
+        (i > 0 && chars_[i].character <= chars_[i - 1].character))
+      return false;
+  }
+  for (size_t i = 0; i < header_->char_word_id_count; ++i) {
+    if (char_word_ids_[i] >= header_->word_count)
+      return false;
+  }
+
+  for (size_t i = 0; i < header_->history_count; ++i) {
+    const HistoryRecord& record(records_[i]);
+    if ((i > 0 && record.history_id <= records_[i - 1].history_id) ||
+        !RangeValid(record.url_offset, record.url_length,
+                    header_->string_size) ||
+        !RangeValid(record.title_offset, record.title_length,
+                    header_->string_size) ||
+        !RangeValid(record.url_starts_offset, record.url_starts_count,
+                    header_->word_start_count) ||
+        !RangeValid(record.title_starts_offset, record.title_starts_count,
+                    header_->word_start_count))
+      return false;
+  }
+  return true;
+}
+
+size_t URLIndexCacheFile::history_count() const {
+  return header_->history_count;
+}
+
+size_t URLIndexCacheFile::word_count() const {
+  return header_->word_count;
+}
+
+size_t URLIndexCacheFile::char_count() const {
+  return header_->char_count;
+}
+
+WordIDSet URLIndexCacheFile::WordIDSetForTermChars(
+    const Char16Set& term_chars) const {
+  const CharEntry* chars_end = chars_ + header_->char_count;
+  std::vector<uint32> word_ids;
+  for (Char16Set::const_iterator c_iter = term_chars.begin();
+       c_iter != term_chars.end(); ++c_iter) {
+    const CharEntry* entry =
+        std::lower_bound(chars_, chars_end, *c_iter, CharEntryLess());
+    if (entry == chars_end || entry->character != *c_iter)
+      return WordIDSet();  // A character was not found: no results.
+    const uint32* begin = char_word_ids_ + entry->begin;
+    const uint32* end = char_word_ids_ + (entry + 1)->begin;
+    if (c_iter == term_chars.begin()) {
+      word_ids.assign(begin, end);
+    } else {
+      std::vector<uint32> new_word_ids;
+      std::set_intersection(word_ids.begin(), word_ids.end(), begin, end,
+                            std::back_inserter(new_word_ids));
+      word_ids.swap(new_word_ids);
+    }
+    if (word_ids.empty())
+      break;
+  }
+  return WordIDSet(word_ids.begin(), word_ids.end());
+}
+
+HistoryIDSet URLIndexCacheFile::HistoryIDsForTerm(const string16& term) const {
+  HistoryIDSet history_ids;
+  if (term.empty())
+    return history_ids;
+  WordIDSet word_ids(WordIDSetForTermChars(Char16SetFromString16(term)));
+  for (WordIDSet::const_iterator iter = word_ids.begin();
+       iter != word_ids.end(); ++iter) {
+    // Words with all of the characters of the term don't necessarily contain
+    // the term itself.
+    const char16* word_begin = word_chars_ + word_offsets_[*iter];
+    const char16* word_end = word_chars_ + word_offsets_[*iter + 1];
+    if (term.length() > 1 &&
+        std::search(word_begin, word_end, term.begin(), term.end()) ==
+            word_end)
+      continue;
+    AddHistoryIDsForWord(*iter, &history_ids);
+  }
+  return history_ids;
+}
+
+string16 URLIndexCacheFile::WordAt(WordID word_id) const {
+  DCHECK_LT(word_id, header_->word_count);
+  return string16(word_chars_ + word_offsets_[word_id],
+                  word_chars_ + word_offsets_[word_id + 1]);
+}
+
+void URLIndexCacheFile::AddHistoryIDsForWord(WordID word_id,
+                                             HistoryIDSet* history_ids) const {
+  DCHECK_LT(word_id, header_->word_count);
+  history_ids->insert(postings_ + posting_offsets_[word_id],
+                      postings_ + posting_offsets_[word_id + 1]);
+}
+
+HistoryID URLIndexCacheFile::HistoryIDAt(size_t index) const {
+  DCHECK_LT(index, history_count());
+  return records_[index].history_id;
+}
+
+bool URLIndexCacheFile::HasHistoryID(HistoryID history_id) const {
+  return FindRecord(history_id) != NULL;
+}
+
+bool URLIndexCacheFile::GetHistoryInfo(HistoryID history_id,
+                                       URLRow* row,
+                                       RowWordStarts* word_starts) const {
+  const HistoryRecord* record = FindRecord(history_id);
+  if (!record)
+    return false;
+  if (row) {
+    *row = URLRow(GURL(std::string(strings_ + record->url_offset,
+                                   record->url_length)),
+                  history_id);
+    row->set_visit_count(record->visit_count);
+    row->set_typed_count(record->typed_count);
+    row->set_last_visit(base::Time::FromInternalValue(record->last_visit));
+    row->set_title(UTF8ToUTF16(std::string(strings_ + record->title_offset,
+                                           record->title_length)));
+  }
+  if (word_starts) {
+    const uint32* url_starts = word_starts_ + record->url_starts_offset;
+    word_starts->url_word_starts_.assign(
+        url_starts, url_starts + record->url_starts_count);
+    const uint32* title_starts = word_starts_ + record->title_starts_offset;
+    word_starts->title_word_starts_.assign(
+        title_starts, title_starts + record->title_starts_count);
+  }
+  return true;
+}
+
+bool URLIndexCacheFile::GetVisitInfo(HistoryID history_id,
+                                     int* typed_count,
+                                     int* visit_count,
+                                     base::Time* last_visit) const {
+  const HistoryRecord* record = FindRecord(history_id);
+  if (!record)
+    return false;
+  *typed_count = record->typed_count;
+  *visit_count = record->visit_count;
+  *last_visit = base::Time::FromInternalValue(record->last_visit);
+  return true;
+}
+
+bool URLIndexCacheFile::FindURL(const GURL& url,
+                                HistoryID* history_id) const {
+  const std::string& spec(url.spec());
+  for (size_t i = 0; i < header_->history_count; ++i) {
+    const HistoryRecord& record(records_[i]);
+    if (record.url_length == spec.size() &&
+        spec.compare(0, spec.size(), strings_ + record.url_offset,
+                     record.url_length) == 0) {
+      *history_id = record.history_id;
+      return true;
+    }
+  }
+  return false;
+}
+
+const URLIndexCacheFile::HistoryRecord* URLIndexCacheFile::FindRecord(
+    HistoryID history_id) const {
+  const HistoryRecord* records_end = records_ + header_->history_count;
+  const HistoryRecord* record =
+      std::lower_bound(records_, records_end, history_id, RecordIDLess());
+  if (record == records_end || record->history_id != history_id)
+    return NULL;
+  return record;
+}
+
+}  // namespace history
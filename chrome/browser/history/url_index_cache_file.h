@@ -0,0 +1,166 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CHROME_BROWSER_HISTORY_URL_INDEX_CACHE_FILE_H_
+#define CHROME_BROWSER_HISTORY_URL_INDEX_CACHE_FILE_H_
+#pragma once
+
+#include <map>
+
+#include "base/basictypes.h"
+#include "base/file_util.h"
+#include "base/memory/ref_counted.h"
+#include "base/string16.h"
+#include "chrome/browser/history/in_memory_url_index_types.h"
+
+class FilePath;
+class GURL;
+
+namespace base {
+class Time;
+}
+
+namespace history {
+
+// A read-only copy of the InMemoryURLIndex's private data, laid out so that
+// it can be searched directly from a memory-mapped file. Restoring the index
+// from it only needs the file to be mapped and its tables checked, instead of
+// parsing it and rebuilding the word, character and history maps, so the
+// HistoryQuickProvider has results right after startup. The mapped pages are
+// shared with the OS file cache and only the ones a search touches are read.
+//
+// The file starts with a Header giving the size of each table. The tables
+// follow in this order, each padded to 8 bytes:
+//   int64 postings[posting_count]
+//     The history IDs of each word, sorted, word after word.
+//   HistoryRecord records[history_count]
+//     The visit data of each history item and the position of its URL,
+//     title and word starts in the tables below, sorted by history ID.
+//   uint32 word_offsets[word_count + 1]
+//     Where each word starts in |word_chars|. The words are sorted, and the
+//     position of a word in this table is its WordID in this file.
+//   uint32 posting_offsets[word_count + 1]
+//     Where the history IDs of each word start in |postings|.
+//   CharEntry chars[char_count + 1]
+//     Each character and where its words start in |char_word_ids|, sorted by
+//     character.
+//   uint32 char_word_ids[char_word_id_count]
+//     The IDs of the words containing each character, sorted, character
+//     after character.
+//   uint32 word_starts[word_start_count]
+//     The URL and title word starts of each history item.
+//   char16 word_chars[word_char_count]
+//     The characters of the words, back to back.
+//   char strings[string_size]
+//     The URLs and titles of the history items, in UTF-8.
+//
+// Numbers are stored in the native byte order, since the cache never leaves
+// the profile, and a mismatch just fails the magic number check.
+class URLIndexCacheFile : public base::RefCountedThreadSafe<URLIndexCacheFile> {
+ public:
+  // The indexed words, each with the history items it occurs in.
+  typedef std::map<string16, HistoryIDSet> WordHistoryMap;
+
+  // Writes the index given by |words|, |history_info_map| and
+  // |word_starts_map| to |path|, replacing any file there only once the new
+  // one is complete. Returns false on failure.
+  static bool Write(const FilePath& path,
+                    const WordHistoryMap& words,
+                    const HistoryInfoMap& history_info_map,
+                    const WordStartsMap& word_starts_map);
+
+  // Maps the cache file at |path|. Returns NULL if there is no such file, it
+  // is not in this format, or it is damaged.
+  static scoped_refptr<URLIndexCacheFile> Open(const FilePath& path);
+
+  // Returns true if the file at |path| starts with the magic number of this
+  // format, to tell it from older caches.
+  static bool HasCacheFileMagic(const FilePath& path);
+
+  size_t history_count() const;
+  size_t word_count() const;
+  size_t char_count() const;
+
+  // The size of the mapped file, in bytes.
+  size_t file_size() const { return file_.length(); }
+
+  // Returns the IDs of the words containing all of |term_chars|. WordIDs are
+  // positions in this file's word table and have nothing to do with the ones
+  // in URLIndexPrivateData.
+  WordIDSet WordIDSetForTermChars(const Char16Set& term_chars) const;
+
+  // Returns the IDs of the history items with a word containing |term|, like
+  // URLIndexPrivateData::HistoryIDsForTerm() does for its maps.
+  HistoryIDSet HistoryIDsForTerm(const string16& term) const;
+
+  // Returns the word with the ID |word_id|.
+  string16 WordAt(WordID word_id) const;
+
+  // Inserts the history IDs of the word |word_id| into |history_ids|.
+  void AddHistoryIDsForWord(WordID word_id, HistoryIDSet* history_ids) const;
+
+  // Returns the ID of the |index|th history item, in increasing order.
+  HistoryID HistoryIDAt(size_t index) const;
+
+  // Returns true if the item |history_id| is in the file.
+  bool HasHistoryID(HistoryID history_id) const;
+
+  // Fills in |row| and |word_starts| for the item |history_id|. Either may be
+  // NULL. Returns false if the item isn't in the file.
+  bool GetHistoryInfo(HistoryID history_id,
+                      URLRow* row,
+                      RowWordStarts* word_starts) const;
+
+  // Like GetHistoryInfo() but only gets the counts used to rank candidates,
+  // without decoding the URL and title.
+  bool GetVisitInfo(HistoryID history_id,
+                    int* typed_count,
+                    int* visit_count,
+                    base::Time* last_visit) const;
+
+  // Finds the item with the URL |url|, which is slow as there is no index by
+  // URL. Returns false if there is none.
+  bool FindURL(const GURL& url, HistoryID* history_id) const;
+
+ private:
+  friend class base::RefCountedThreadSafe<URLIndexCacheFile>;
+
+  struct Header;
+  struct HistoryRecord;
+  struct CharEntry;
+
+  URLIndexCacheFile();
+  ~URLIndexCacheFile();
+
+  // Maps |path| and points the table members at it. Returns false if the
+  // file is not a valid cache file.
+  bool Init(const FilePath& path);
+
+  // Checks that every offset in the tables stays within them, so that the
+  // accessors don't have to.
+  bool Validate() const;
+
+  // Returns the record for |history_id| or NULL.
+  const HistoryRecord* FindRecord(HistoryID history_id) const;
+
+  file_util::MemoryMappedFile file_;
+
+  // Point into |file_|.
+  const Header* header_;
+  const int64* postings_;
+  const HistoryRecord* records_;
+  const uint32* word_offsets_;
+  const uint32* posting_offsets_;
+  const CharEntry* chars_;
+  const uint32* char_word_ids_;
+  const uint32* word_starts_;
+  const char16* word_chars_;
+  const char* strings_;
+
+  DISALLOW_COPY_AND_ASSIGN(URLIndexCacheFile);
+};
+
+}  // namespace history
+
+#endif  // CHROME_BROWSER_HISTORY_URL_INDEX_CACHE_FILE_H_
@@ -0,0 +1,185 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/scoped_temp_dir.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "chrome/browser/history/url_index_cache_file.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace history {
+
+namespace {
+
+class URLIndexCacheFileTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.path().AppendASCII("History Provider Cache");
+
+    AddRow(1, "http://www.google.com/", "Google", 3, 1);
+    AddRow(5, "http://www.example.com/foo", "Example Foo", 1, 0);
+    AddRow(9, "http://foo.bar.org/", "Bar", 7, 2);
+    AddWord("bar", 9);
+    AddWord("com", 1);
+    AddWord("com", 5);
+    AddWord("example", 5);
+    AddWord("foo", 5);
+    AddWord("foo", 9);
+    AddWord("google", 1);
+    AddWord("org", 9);
+    AddWord("www", 1);
+    AddWord("www", 5);
+  }
+
+  void AddRow(HistoryID history_id, const char* url, const char* title,
+              int visit_count, int typed_count) {
+    URLRow row(GURL(url), history_id);
+    row.set_title(ASCIIToUTF16(title));
+    row.set_visit_count(visit_count);
+    row.set_typed_count(typed_count);
+    row.set_last_visit(base::Time::FromInternalValue(history_id * 1000));
+    history_info_map_[history_id] = row;
+    RowWordStarts& starts(word_starts_map_[history_id]);
+    starts.url_word_starts_.push_back(0);
+    starts.url_word_starts_.push_back(history_id);
+    starts.title_word_starts_.push_back(0);
+  }
+
+  void AddWord(const char* word, HistoryID history_id) {
+    words_[ASCIIToUTF16(word)].insert(history_id);
+  }
+
+  HistoryIDSet IDs(HistoryID a, HistoryID b) {
+    HistoryIDSet ids;
+    ids.insert(a);
+    ids.insert(b);
+    return ids;
+  }
+
+  // Overwrites the 4 bytes at |offset| of the written file with |value|.
+  void Patch(size_t offset, uint32 value) {
+    std::string data;
+    ASSERT_TRUE(file_util::ReadFileToString(path_, &data));
+    ASSERT_LE(offset + sizeof(value), data.size());
+    data.replace(offset, sizeof(value), reinterpret_cast<const char*>(&value),
+                 sizeof(value));
+    ASSERT_EQ(static_cast<int>(data.size()),
+              file_util::WriteFile(path_, data.data(), data.size()));
+  }
+
+  ScopedTempDir temp_dir_;
+  FilePath path_;
+  URLIndexCacheFile::WordHistoryMap words_;
+  HistoryInfoMap history_info_map_;
+  WordStartsMap word_starts_map_;
+};
+
+TEST_F(URLIndexCacheFileTest, RoundTrip) {
+  ASSERT_TRUE(URLIndexCacheFile::Write(path_, words_, history_info_map_,
+                                       word_starts_map_));
+  EXPECT_TRUE(URLIndexCacheFile::HasCacheFileMagic(path_));
+  scoped_refptr<URLIndexCacheFile> cache_file(URLIndexCacheFile::Open(path_));
+  ASSERT_TRUE(cache_file.get());
+  EXPECT_EQ(3U, cache_file->history_count());
+  EXPECT_EQ(words_.size(), cache_file->word_count());
+
+  for (HistoryInfoMap::const_iterator iter = history_info_map_.begin();
+       iter != history_info_map_.end(); ++iter) {
+    URLRow row;
+    RowWordStarts starts;
+    ASSERT_TRUE(cache_file->GetHistoryInfo(iter->first, &row, &starts));
+    EXPECT_EQ(iter->second.url(), row.url());
+    EXPECT_EQ(iter->second.title(), row.title());
+    EXPECT_EQ(iter->second.visit_count(), row.visit_count());
+    EXPECT_EQ(iter->second.typed_count(), row.typed_count());
+    EXPECT_EQ(iter->second.last_visit(), row.last_visit());
+    EXPECT_TRUE(word_starts_map_[iter->first].url_word_starts_ ==
+                starts.url_word_starts_);
+    EXPECT_TRUE(word_starts_map_[iter->first].title_word_starts_ ==
+                starts.title_word_starts_);
+
+    HistoryID history_id = 0;
+    EXPECT_TRUE(cache_file->FindURL(iter->second.url(), &history_id));
+    EXPECT_EQ(iter->first, history_id);
+  }
+  EXPECT_FALSE(cache_file->HasHistoryID(2));
+  EXPECT_FALSE(cache_file->GetHistoryInfo(2, NULL, NULL));
+  HistoryID history_id = 0;
+  EXPECT_FALSE(cache_file->FindURL(GURL("http://www.bar.com/"), &history_id));
+
+  // Words are found by any of their substrings.
+  EXPECT_TRUE(IDs(5, 9) == cache_file->HistoryIDsForTerm(ASCIIToUTF16("fo")));
+  EXPECT_TRUE(IDs(1, 5) == cache_file->HistoryIDsForTerm(ASCIIToUTF16("w")));
+  HistoryIDSet google_ids(cache_file->HistoryIDsForTerm(ASCIIToUTF16("ogl")));
+  EXPECT_EQ(1U, google_ids.size());
+  EXPECT_EQ(1U, google_ids.count(1));
+  EXPECT_TRUE(IDs(1, 9) == cache_file->HistoryIDsForTerm(ASCIIToUTF16("g")));
+  // All the characters of "oof" are in "foo" but it doesn't contain it.
+  EXPECT_TRUE(cache_file->HistoryIDsForTerm(ASCIIToUTF16("oof")).empty());
+  EXPECT_TRUE(cache_file->HistoryIDsForTerm(ASCIIToUTF16("z")).empty());
+}
+
+TEST_F(URLIndexCacheFileTest, Empty) {
+  ASSERT_TRUE(URLIndexCacheFile::Write(path_,
+                                       URLIndexCacheFile::WordHistoryMap(),
+                                       HistoryInfoMap(), WordStartsMap()));
+  scoped_refptr<URLIndexCacheFile> cache_file(URLIndexCacheFile::Open(path_));
+  ASSERT_TRUE(cache_file.get());
+  EXPECT_EQ(0U, cache_file->history_count());
+  EXPECT_TRUE(cache_file->HistoryIDsForTerm(ASCIIToUTF16("a")).empty());
+}
+
+TEST_F(URLIndexCacheFileTest, RejectsDamagedFiles) {
+  EXPECT_FALSE(URLIndexCacheFile::Open(path_).get());
+
+  // Not in this format.
+  std::string junk("not a cache file");
+  ASSERT_EQ(static_cast<int>(junk.size()),
+            file_util::WriteFile(path_, junk.data(), junk.size()));
+  EXPECT_FALSE(URLIndexCacheFile::HasCacheFileMagic(path_));
+  EXPECT_FALSE(URLIndexCacheFile::Open(path_).get());
+
+  // Truncated.
+  ASSERT_TRUE(URLIndexCacheFile::Write(path_, words_, history_info_map_,
+                                       word_starts_map_));
+  int64 size = 0;
+  ASSERT_TRUE(file_util::GetFileSize(path_, &size));
+  std::string data;
+  ASSERT_TRUE(file_util::ReadFileToString(path_, &data));
+  ASSERT_EQ(static_cast<int>(size - 8),
+            file_util::WriteFile(path_, data.data(), size - 8));
+  EXPECT_TRUE(URLIndexCacheFile::HasCacheFileMagic(path_));
+  EXPECT_FALSE(URLIndexCacheFile::Open(path_).get());
+
+  // Wrong version.
+  ASSERT_TRUE(URLIndexCacheFile::Write(path_, words_, history_info_map_,
+                                       word_starts_map_));
+  Patch(4, 1000);
+  EXPECT_FALSE(URLIndexCacheFile::Open(path_).get());
+
+  // Table sizes which don't add up to the file size.
+  ASSERT_TRUE(URLIndexCacheFile::Write(path_, words_, history_info_map_,
+                                       word_starts_map_));
+  Patch(8, 0xFFFFFFF0);
+  EXPECT_FALSE(URLIndexCacheFile::Open(path_).get());
+
+  // A posting offset out of order. The posting offsets follow the 40 byte
+  // header, the 10 postings, the 3 records of 56 bytes and the offsets of the
+  // 7 words.
+  ASSERT_TRUE(URLIndexCacheFile::Write(path_, words_, history_info_map_,
+                                       word_starts_map_));
+  const size_t kPostingOffsets = 40 + 10 * 8 + 3 * 56 + 8 * 4;
+  Patch(kPostingOffsets + 4, 100);
+  EXPECT_FALSE(URLIndexCacheFile::Open(path_).get());
+}
+
+}  // namespace
+
+}  // namespace history
@@ -139,10 +139,14 @@ void URLIndexPrivateData::Clear() {
   history_id_word_map_.clear();
   history_info_map_.clear();
   word_starts_map_.clear();
+  cache_file_ = NULL;
+  cache_file_overrides_.clear();
 }
 
 bool URLIndexPrivateData::Empty() const {
-  return history_info_map_.empty();
+  return history_info_map_.empty() &&
+      (!cache_file_ ||
+       cache_file_overrides_.size() == cache_file_->history_count());
 }
 
 scoped_refptr<URLIndexPrivateData> URLIndexPrivateData::Duplicate() const {
@@ -154,6 +158,9 @@ scoped_refptr<URLIndexPrivateData> URLIndexPrivateData::Duplicate() const {
   data_copy->word_id_history_map_ = word_id_history_map_;
   data_copy->history_id_word_map_ = history_id_word_map_;
   data_copy->history_info_map_ = history_info_map_;
+  data_copy->word_starts_map_ = word_starts_map_;
+  data_copy->cache_file_ = cache_file_;
+  data_copy->cache_file_overrides_ = cache_file_overrides_;
   return data_copy;
   // Not copied:
   //    search_term_cache_
@@ -162,6 +169,46 @@ scoped_refptr<URLIndexPrivateData> URLIndexPrivateData::Duplicate() const {
   //    post_scoring_item_count_
 };
 
+bool URLIndexPrivateData::InCacheFile(HistoryID history_id) const {
+  return cache_file_ && !cache_file_overrides_.count(history_id) &&
+      cache_file_->HasHistoryID(history_id);
+}
+
+bool URLIndexPrivateData::GetHistoryInfo(HistoryID history_id,
+                                         URLRow* row,
+                                         RowWordStarts* word_starts) const {
+  HistoryInfoMap::const_iterator hist_pos = history_info_map_.find(history_id);
+  if (hist_pos != history_info_map_.end()) {
+    if (row)
+      *row = hist_pos->second;
+    if (word_starts) {
+      WordStartsMap::const_iterator starts_pos =
+          word_starts_map_.find(history_id);
+      DCHECK(starts_pos != word_starts_map_.end());
+      *word_starts = starts_pos->second;
+    }
+    return true;
+  }
+  return cache_file_ && !cache_file_overrides_.count(history_id) &&
+      cache_file_->GetHistoryInfo(history_id, row, word_starts);
+}
+
+bool URLIndexPrivateData::GetVisitInfo(HistoryID history_id,
+                                       int* typed_count,
+                                       int* visit_count,
+                                       base::Time* last_visit) const {
+  HistoryInfoMap::const_iterator hist_pos = history_info_map_.find(history_id);
+  if (hist_pos != history_info_map_.end()) {
+    *typed_count = hist_pos->second.typed_count();
+    *visit_count = hist_pos->second.visit_count();
+    *last_visit = hist_pos->second.last_visit();
+    return true;
+  }
+  return cache_file_ && !cache_file_overrides_.count(history_id) &&
+      cache_file_->GetVisitInfo(history_id, typed_count, visit_count,
+                                last_visit);
+}
+
 // Cache Updating --------------------------------------------------------------
 
 bool URLIndexPrivateData::IndexRow(
@@ -345,7 +392,27 @@ bool URLIndexPrivateData::UpdateURL(
   bool row_was_updated = false;
   URLID row_id = row.id();
   HistoryInfoMap::iterator row_pos = history_info_map_.find(row_id);
-  if (row_pos == history_info_map_.end()) {
+  if (row_pos == history_info_map_.end() && InCacheFile(row_id)) {
+    // The row was restored from the cache file, which can't be changed. If
+    // anything changed, stop serving the row from the file and index the new
+    // version of it in the maps instead.
+    URLRow cached_row;
+    cache_file_->GetHistoryInfo(row_id, &cached_row, NULL);
+    if (RowQualifiesAsSignificant(row, base::Time())) {
+      if (cached_row.visit_count() == row.visit_count() &&
+          cached_row.typed_count() == row.typed_count() &&
+          cached_row.last_visit() == row.last_visit() &&
+          cached_row.title() == row.title())
+        return false;
+      cache_file_overrides_.insert(row_id);
+      URLRow new_row(row);
+      new_row.set_id(row_id);
+      IndexRow(new_row, languages, scheme_whitelist);
+    } else {
+      cache_file_overrides_.insert(row_id);
+    }
+    row_was_updated = true;
+  } else if (row_pos == history_info_map_.end()) {
     // This new row should be indexed if it qualifies.
     URLRow new_row(row);
     new_row.set_id(row_id);
@@ -406,9 +473,16 @@ bool URLIndexPrivateData::DeleteURL(const GURL& url) {
       history_info_map_.begin(),
       history_info_map_.end(),
       HistoryInfoMapItemHasURL(url));
-  if (pos == history_info_map_.end())
-    return false;
-  RemoveRowFromIndex(pos->second);
+  if (pos != history_info_map_.end()) {
+    RemoveRowFromIndex(pos->second);
+  } else {
+    // Otherwise the item may only be in the cache file, from which it can
+    // only be hidden.
+    HistoryID history_id;
+    if (!cache_file_ || !cache_file_->FindURL(url, &history_id) ||
+        !cache_file_overrides_.insert(history_id).second)
+      return false;
+  }
   search_term_cache_.clear();  // This invalidates the cache.
   return true;
 }
@@ -416,8 +490,8 @@ bool URLIndexPrivateData::DeleteURL(const GURL& url) {
 // URLIndexPrivateData::HistoryItemFactorGreater -------------------------------
 
 URLIndexPrivateData::HistoryItemFactorGreater::HistoryItemFactorGreater(
-    const HistoryInfoMap& history_info_map)
-    : history_info_map_(history_info_map) {
+    const URLIndexPrivateData& private_data)
+    : private_data_(private_data) {
 }
 
 URLIndexPrivateData::HistoryItemFactorGreater::~HistoryItemFactorGreater() {}
@@ -425,23 +499,23 @@ URLIndexPrivateData::HistoryItemFactorGreater::~HistoryItemFactorGreater() {}
 bool URLIndexPrivateData::HistoryItemFactorGreater::operator()(
     const HistoryID h1,
     const HistoryID h2) {
-  HistoryInfoMap::const_iterator entry1(history_info_map_.find(h1));
-  if (entry1 == history_info_map_.end())
+  int typed_count1, visit_count1, typed_count2, visit_count2;
+  base::Time last_visit1, last_visit2;
+  if (!private_data_.GetVisitInfo(h1, &typed_count1, &visit_count1,
+                                  &last_visit1))
     return false;
-  HistoryInfoMap::const_iterator entry2(history_info_map_.find(h2));
-  if (entry2 == history_info_map_.end())
+  if (!private_data_.GetVisitInfo(h2, &typed_count2, &visit_count2,
+                                  &last_visit2))
     return true;
-  const URLRow& r1(entry1->second);
-  const URLRow& r2(entry2->second);
   // First cut: typed count, visit count, recency.
   // TODO(mrossetti): This is too simplistic. Consider an approach which ranks
   // recently visited (within the last 12/24 hours) as highly important. Get
   // input from mpearson.
-  if (r1.typed_count() != r2.typed_count())
-    return (r1.typed_count() > r2.typed_count());
-  if (r1.visit_count() != r2.visit_count())
-    return (r1.visit_count() > r2.visit_count());
-  return (r1.last_visit() > r2.last_visit());
+  if (typed_count1 != typed_count2)
+    return (typed_count1 > typed_count2);
+  if (visit_count1 != visit_count2)
+    return (visit_count1 > visit_count2);
+  return (last_visit1 > last_visit2);
 }
 
 // Cache Searching -------------------------------------------------------------
@@ -449,6 +523,14 @@ bool URLIndexPrivateData::HistoryItemFactorGreater::operator()(
 // NOTE: This is the main public search function.
 ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
     const string16& search_string) {
+  ScoredHistoryMatches scored_items =
+      ScoringJobForTerms(search_string)->Run();
+  post_scoring_item_count_ = scored_items.size();
+  return scored_items;
+}
+
+scoped_refptr<URLIndexScoringJob> URLIndexPrivateData::ScoringJobForTerms(
+    const string16& search_string) {
   pre_filter_item_count_ = 0;
   post_filter_item_count_ = 0;
   post_scoring_item_count_ = 0;
@@ -465,13 +547,22 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
   // four 'words': "colspec", "id", "mstone" and "release".
   String16Vector lower_words(
       history::String16VectorFromString16(lower_unescaped_string, false, NULL));
-  ScoredHistoryMatches scored_items;
+
+  // We call these 'terms' (as opposed to 'words'; see below) as in this case
+  // we only want to break up the search string on 'true' whitespace rather than
+  // escaped whitespace. When the user types "colspec=ID%20Mstone Release" we
+  // get two 'terms': "colspec=id%20mstone" and "release".
+  history::String16Vector lower_raw_terms;
+  Tokenize(lower_raw_string, kWhitespaceUTF16, &lower_raw_terms);
+  URLIndexScoringJob::Candidates candidates;
 
   // Do nothing if we have indexed no words (probably because we've not been
   // initialized yet) or the search string has no words.
-  if (word_list_.empty() || lower_words.empty()) {
+  if ((word_list_.empty() && !cache_file_) || lower_words.empty()) {
     search_term_cache_.clear();  // Invalidate the term cache.
-    return scored_items;
+    return new URLIndexScoringJob(lower_raw_string, lower_raw_terms,
+                                  &candidates,
+                                  AutocompleteProvider::kMaxMatches);
   }
 
   // Reset used_ flags for search_term_cache_. We use a basic mark-and-sweep
@@ -496,8 +587,7 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
               std::back_inserter(history_ids));
     // Trim down the set by sorting by typed-count, visit-count, and last
     // visit.
-    HistoryItemFactorGreater
-        item_factor_functor(history_info_map_);
+    HistoryItemFactorGreater item_factor_functor(*this);
     std::partial_sort(history_ids.begin(),
                       history_ids.begin() + kItemsToScoreLimit,
                       history_ids.end(),
@@ -508,36 +598,24 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
     post_filter_item_count_ = history_id_set.size();
   }
 
-  // Pass over all of the candidates filtering out any without a proper
-  // substring match, inserting those which pass in order by score. Note that
-  // in this step we are using the raw search string complete with escaped
+  // Copy out what is needed to score each candidate. The job filters out any
+  // without a proper substring match and keeps the best by score. Note that
+  // in that step we are using the raw search string complete with escaped
   // URL elements. When the user has specifically typed something akin to
   // "sort=pri&colspec=ID%20Mstone%20Release" we want to make sure that that
   // specific substring appears in the URL or page title.
-
-  // We call these 'terms' (as opposed to 'words'; see above) as in this case
-  // we only want to break up the search string on 'true' whitespace rather than
-  // escaped whitespace. When the user types "colspec=ID%20Mstone Release" we
-  // get two 'terms': "colspec=id%20mstone" and "release".
-  history::String16Vector lower_raw_terms;
-  Tokenize(lower_raw_string, kWhitespaceUTF16, &lower_raw_terms);
-  scored_items = std::for_each(history_id_set.begin(), history_id_set.end(),
-      AddHistoryMatch(*this, lower_raw_string,
-                      lower_raw_terms)).ScoredMatches();
-
-  // Select and sort only the top kMaxMatches results.
-  if (scored_items.size() > AutocompleteProvider::kMaxMatches) {
-    std::partial_sort(scored_items.begin(),
-                      scored_items.begin() +
-                          AutocompleteProvider::kMaxMatches,
-                      scored_items.end(),
-                      ScoredHistoryMatch::MatchScoreGreater);
-      scored_items.resize(AutocompleteProvider::kMaxMatches);
-  } else {
-    std::sort(scored_items.begin(), scored_items.end(),
-              ScoredHistoryMatch::MatchScoreGreater);
+  // Note that a history_id may be present in the word_id_history_map_ yet not
+  // be found in the history_info_map_. This occurs when an item has been
+  // deleted by the user or the item no longer qualifies as a quick result.
+  candidates.reserve(history_id_set.size());
+  for (HistoryIDSet::const_iterator iter = history_id_set.begin();
+       iter != history_id_set.end(); ++iter) {
+    URLIndexScoringJob::Candidate candidate;
+    if (!GetHistoryInfo(*iter, &candidate.row, &candidate.word_starts))
+      continue;
+    candidate.max_score = MaxRawScoreForRow(candidate.row);
+    candidates.push_back(candidate);
   }
-  post_scoring_item_count_ = scored_items.size();
 
   if (was_trimmed) {
     search_term_cache_.clear();  // Invalidate the term cache.
@@ -552,39 +630,8 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
     }
   }
 
-  return scored_items;
-}
-
-// URLIndexPrivateData::AddHistoryMatch ----------------------------------------
-
-URLIndexPrivateData::AddHistoryMatch::AddHistoryMatch(
-    const URLIndexPrivateData& private_data,
-    const string16& lower_string,
-    const String16Vector& lower_terms)
-  : private_data_(private_data),
-    lower_string_(lower_string),
-    lower_terms_(lower_terms) {}
-
-URLIndexPrivateData::AddHistoryMatch::~AddHistoryMatch() {}
-
-void URLIndexPrivateData::AddHistoryMatch::operator()(
-    const HistoryID history_id) {
-  HistoryInfoMap::const_iterator hist_pos =
-      private_data_.history_info_map_.find(history_id);
-  // Note that a history_id may be present in the word_id_history_map_ yet not
-  // be found in the history_info_map_. This occurs when an item has been
-  // deleted by the user or the item no longer qualifies as a quick result.
-  if (hist_pos != private_data_.history_info_map_.end()) {
-    const URLRow& hist_item = hist_pos->second;
-    WordStartsMap::const_iterator starts_pos =
-        private_data_.word_starts_map_.find(history_id);
-    DCHECK(starts_pos != private_data_.word_starts_map_.end());
-    ScoredHistoryMatch match(ScoredMatchForURL(hist_item, lower_string_,
-                                               lower_terms_,
-                                               starts_pos->second));
-    if (match.raw_score > 0)
-      scored_matches_.push_back(match);
-  }
+  return new URLIndexScoringJob(lower_raw_string, lower_raw_terms,
+                                &candidates, AutocompleteProvider::kMaxMatches);
 }
 
 // static
@@ -653,6 +700,12 @@ ScoredHistoryMatch URLIndexPrivateData::ScoredMatchForURL(
   if (term_score == 0)
     return match;
 
+  match.raw_score = RawScoreForRow(row, term_score);
+  return match;
+}
+
+// static
+int URLIndexPrivateData::RawScoreForRow(const URLRow& row, int term_score) {
   // Determine scoring factors for the recency of visit, visit count and typed
   // count attributes of the URLRow.
   const int kDaysAgoLevel[] = { 1, 10, 20, 30 };
@@ -674,15 +727,19 @@ ScoredHistoryMatch URLIndexPrivateData::ScoredMatchForURL(
   const int kTypedCountRelevance = 5;
   int effective_visit_count_value =
       std::max(0, visit_count_value - typed_count_value);
-  match.raw_score = term_score * kTermScoreRelevance +
-                    days_ago_value * kDaysAgoRelevance +
-                    effective_visit_count_value * kVisitCountRelevance +
-                    typed_count_value * kTypedCountRelevance;
-  match.raw_score /= (kTermScoreRelevance + kDaysAgoRelevance +
-                      kVisitCountRelevance + kTypedCountRelevance);
-  match.raw_score = std::min(kMaxTotalScore, match.raw_score);
+  int raw_score = term_score * kTermScoreRelevance +
+                  days_ago_value * kDaysAgoRelevance +
+                  effective_visit_count_value * kVisitCountRelevance +
+                  typed_count_value * kTypedCountRelevance;
+  raw_score /= (kTermScoreRelevance + kDaysAgoRelevance +
+                kVisitCountRelevance + kTypedCountRelevance);
+  return std::min(kMaxTotalScore, raw_score);
+}
 
-  return match;
+// static
+int URLIndexPrivateData::MaxRawScoreForRow(const URLRow& row) {
+  // ScoreComponentForMatches() never scores above the top rank.
+  return RawScoreForRow(row, kScoreRank[0]);
 }
 
 int URLIndexPrivateData::ScoreComponentForMatches(const TermMatches& matches,
@@ -841,12 +898,8 @@ HistoryIDSet URLIndexPrivateData::HistoryIDsForTerm(
     // Reduce the word set with any leftover, unprocessed characters.
     if (!unique_chars.empty()) {
       WordIDSet leftover_set(WordIDSetForTermChars(unique_chars));
-      // We might come up empty on the leftovers.
-      if (leftover_set.empty()) {
-        search_term_cache_[term] = SearchTermCacheItem();
-        return HistoryIDSet();
-      }
-      // Or there may not have been a prefix from which to start.
+      // We might come up empty on the leftovers, or there may not have been a
+      // prefix from which to start.
       if (prefix_chars.empty()) {
         word_id_set.swap(leftover_set);
       } else {
@@ -888,6 +941,15 @@ HistoryIDSet URLIndexPrivateData::HistoryIDsForTerm(
     }
   }
 
+  // Add in the items restored from the cache file which haven't changed since.
+  if (cache_file_) {
+    HistoryIDSet file_history_ids(cache_file_->HistoryIDsForTerm(term));
+    std::set_difference(file_history_ids.begin(), file_history_ids.end(),
+                        cache_file_overrides_.begin(),
+                        cache_file_overrides_.end(),
+                        std::inserter(history_id_set, history_id_set.end()));
+  }
+
   // Record a new cache entry for this word if the term is longer than
   // a single character.
   if (term_length > 1)
@@ -945,6 +1007,48 @@ void URLIndexPrivateData::WritePrivateDataToCacheFileTask(
 
 bool URLIndexPrivateData::SaveToFile(const FilePath& file_path) {
   base::TimeTicks beginning_time = base::TimeTicks::Now();
+  // Merge the items still served from the cache file with those in the maps.
+  URLIndexCacheFile::WordHistoryMap words;
+  HistoryInfoMap history_info_map;
+  WordStartsMap word_starts_map;
+  if (cache_file_) {
+    for (size_t i = 0; i < cache_file_->history_count(); ++i) {
+      HistoryID history_id = cache_file_->HistoryIDAt(i);
+      if (cache_file_overrides_.count(history_id))
+        continue;
+      cache_file_->GetHistoryInfo(history_id, &history_info_map[history_id],
+                                  &word_starts_map[history_id]);
+    }
+    for (WordID word_id = 0; word_id < cache_file_->word_count(); ++word_id) {
+      HistoryIDSet history_ids;
+      cache_file_->AddHistoryIDsForWord(word_id, &history_ids);
+      HistoryIDSet& word_history_ids(words[cache_file_->WordAt(word_id)]);
+      std::set_difference(history_ids.begin(), history_ids.end(),
+                          cache_file_overrides_.begin(),
+                          cache_file_overrides_.end(),
+                          std::inserter(word_history_ids,
+                                        word_history_ids.end()));
+      if (word_history_ids.empty())
+        words.erase(cache_file_->WordAt(word_id));
+    }
+  }
+  history_info_map.insert(history_info_map_.begin(), history_info_map_.end());
+  word_starts_map.insert(word_starts_map_.begin(), word_starts_map_.end());
+  for (WordIDHistoryMap::const_iterator iter = word_id_history_map_.begin();
+       iter != word_id_history_map_.end(); ++iter) {
+    HistoryIDSet& word_history_ids(words[word_list_[iter->first]]);
+    word_history_ids.insert(iter->second.begin(), iter->second.end());
+  }
+
+  if (!URLIndexCacheFile::Write(file_path, words, history_info_map,
+                                word_starts_map))
+    return false;
+  UMA_HISTOGRAM_TIMES("History.InMemoryURLIndexSaveCacheTime",
+                      base::TimeTicks::Now() - beginning_time);
+  return true;
+}
+
+bool URLIndexPrivateData::SaveToLegacyFile(const FilePath& file_path) {
   InMemoryURLIndexCacheItem index_cache;
   SavePrivateData(&index_cache);
   std::string data;
@@ -958,8 +1062,6 @@ bool URLIndexPrivateData::SaveToFile(const FilePath& file_path) {
     LOG(WARNING) << "Failed to write " << file_path.value();
     return false;
   }
-  UMA_HISTOGRAM_TIMES("History.InMemoryURLIndexSaveCacheTime",
-                      base::TimeTicks::Now() - beginning_time);
   return true;
 }
 
@@ -1095,45 +1197,66 @@ void URLIndexPrivateData::RestoreFromFileTask(
     const FilePath& file_path,
     scoped_refptr<URLIndexPrivateData> private_data,
     std::string languages) {
-  private_data = URLIndexPrivateData::RestoreFromFile(file_path, languages);
+  // |private_data| is the object handed to OnCacheLoadDone() so it has to be
+  // filled in place.
+  private_data->RestoreFromFile(file_path, languages);
 }
 
-// static
-scoped_refptr<URLIndexPrivateData> URLIndexPrivateData::RestoreFromFile(
-    const FilePath& file_path,
-    const std::string& languages) {
+bool URLIndexPrivateData::RestoreFromFile(const FilePath& file_path,
+                                          const std::string& languages) {
   base::TimeTicks beginning_time = base::TimeTicks::Now();
-  if (!file_util::PathExists(file_path))
-    return NULL;
-  std::string data;
+  Clear();
   // If there is no cache file then simply give up. This will cause us to
   // attempt to rebuild from the history database.
-  if (!file_util::ReadFileToString(file_path, &data))
-    return NULL;
+  if (!file_util::PathExists(file_path))
+    return false;
 
-  scoped_refptr<URLIndexPrivateData> restored_data(new URLIndexPrivateData);
-  InMemoryURLIndexCacheItem index_cache;
-  if (!index_cache.ParseFromArray(data.c_str(), data.size())) {
-    LOG(WARNING) << "Failed to parse URLIndexPrivateData cache data read from "
-                 << file_path.value();
-    return restored_data;
-  }
+  if (URLIndexCacheFile::HasCacheFileMagic(file_path)) {
+    cache_file_ = URLIndexCacheFile::Open(file_path);
+    if (!cache_file_) {
+      LOG(WARNING) << "Failed to map URLIndexPrivateData cache file "
+                   << file_path.value();
+      return false;
+    }
+    restored_cache_version_ = kCurrentCacheFileVersion;
+    UMA_HISTOGRAM_TIMES("History.InMemoryURLIndexRestoreCacheTime",
+                        base::TimeTicks::Now() - beginning_time);
+    UMA_HISTOGRAM_COUNTS("History.InMemoryURLHistoryItems",
+                         cache_file_->history_count());
+    UMA_HISTOGRAM_COUNTS("History.InMemoryURLCacheSize",
+                         cache_file_->file_size());
+    UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLWords",
+                               cache_file_->word_count());
+    UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLChars",
+                               cache_file_->char_count());
+  } else {
+    std::string data;
+    if (!file_util::ReadFileToString(file_path, &data))
+      return false;
 
-  if (!restored_data->RestorePrivateData(index_cache, languages))
-    return NULL;
+    InMemoryURLIndexCacheItem index_cache;
+    if (!index_cache.ParseFromArray(data.c_str(), data.size())) {
+      LOG(WARNING) << "Failed to parse URLIndexPrivateData cache data read "
+                   << "from " << file_path.value();
+      return false;
+    }
 
-  UMA_HISTOGRAM_TIMES("History.InMemoryURLIndexRestoreCacheTime",
-                      base::TimeTicks::Now() - beginning_time);
-  UMA_HISTOGRAM_COUNTS("History.InMemoryURLHistoryItems",
-                       restored_data->history_id_word_map_.size());
-  UMA_HISTOGRAM_COUNTS("History.InMemoryURLCacheSize", data.size());
-  UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLWords",
-                             restored_data->word_map_.size());
-  UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLChars",
-                             restored_data->char_word_map_.size());
-  if (restored_data->Empty())
-    return NULL;  // 'No data' is the same as a failed reload.
-  return restored_data;
+    if (!RestorePrivateData(index_cache, languages)) {
+      Clear();
+      return false;
+    }
+
+    UMA_HISTOGRAM_TIMES("History.InMemoryURLIndexRestoreCacheTime",
+                        base::TimeTicks::Now() - beginning_time);
+    UMA_HISTOGRAM_COUNTS("History.InMemoryURLHistoryItems",
+                         history_id_word_map_.size());
+    UMA_HISTOGRAM_COUNTS("History.InMemoryURLCacheSize", data.size());
+    UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLWords", word_map_.size());
+    UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLChars",
+                               char_word_map_.size());
+  }
+  // 'No data' is the same as a failed reload.
+  return !Empty();
 }
 
 // static
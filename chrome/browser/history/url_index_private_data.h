@@ -14,6 +14,8 @@
 #include "base/memory/ref_counted.h"
 #include "chrome/browser/history/in_memory_url_index_types.h"
 #include "chrome/browser/history/in_memory_url_index_cache.pb.h"
+#include "chrome/browser/history/url_index_cache_file.h"
+#include "chrome/browser/history/url_index_scoring_job.h"
 #include "content/public/browser/notification_details.h"
 
 class HistoryQuickProviderTest;
@@ -44,12 +46,16 @@ class URLIndexPrivateData
   friend class base::RefCountedThreadSafe<URLIndexPrivateData>;
   ~URLIndexPrivateData();
 
-  friend class AddHistoryMatch;
   friend class ::HistoryQuickProviderTest;
   friend class InMemoryURLIndex;
   friend class InMemoryURLIndexTest;
+  friend class InMemoryURLIndexPerfTest;
+  friend class URLIndexScoringJob;
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, CacheSaveRestore);
+  FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, CacheUpdateAfterRestore);
+  FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, LegacyCacheRestore);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, HugeResultSet);
+  FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, KeystrokeLatency);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, Scoring);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, TitleSearch);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, TypedCharacterCaching);
@@ -87,39 +93,18 @@ class URLIndexPrivateData
   };
   typedef std::map<string16, SearchTermCacheItem> SearchTermCacheMap;
 
-  // A helper class which performs the final filter on each candidate
-  // history URL match, inserting accepted matches into |scored_matches_|
-  // and trimming the maximum number of matches to 10.
-  class AddHistoryMatch : public std::unary_function<HistoryID, void> {
-   public:
-    AddHistoryMatch(const URLIndexPrivateData& private_data,
-                    const string16& lower_string,
-                    const String16Vector& lower_terms);
-    ~AddHistoryMatch();
-
-    void operator()(const HistoryID history_id);
-
-    ScoredHistoryMatches ScoredMatches() const { return scored_matches_; }
-
-   private:
-    const URLIndexPrivateData& private_data_;
-    ScoredHistoryMatches scored_matches_;
-    const string16& lower_string_;
-    const String16Vector& lower_terms_;
-  };
-
   // A helper predicate class used to filter excess history items when the
   // candidate results set is too large.
   class HistoryItemFactorGreater
       : public std::binary_function<HistoryID, HistoryID, void> {
    public:
-    explicit HistoryItemFactorGreater(const HistoryInfoMap& history_info_map);
+    explicit HistoryItemFactorGreater(const URLIndexPrivateData& private_data);
     ~HistoryItemFactorGreater();
 
     bool operator()(const HistoryID h1, const HistoryID h2);
 
    private:
-    const history::HistoryInfoMap& history_info_map_;
+    const URLIndexPrivateData& private_data_;
   };
 
   // Given a string16 in |term_string|, scans the history index and returns a
@@ -139,22 +124,27 @@ class URLIndexPrivateData
   // to this function.
   ScoredHistoryMatches HistoryItemsForTerms(const string16& term_string);
 
-  // Creates a new URLIndexPrivateData object, populates it from the contents
-  // of the cache file stored in |file_path|, and assigns it to |private_data|.
-  // |languages| will be used to break URLs and page titles into words and is
-  // deliberately passed by value.
+  // Does the index lookups of HistoryItemsForTerms() and returns a job which
+  // scores the candidates found, either right away or on the blocking pool.
+  // The job holds copies of the candidates so the index can change while it
+  // runs.
+  scoped_refptr<URLIndexScoringJob> ScoringJobForTerms(
+      const string16& term_string);
+
+  // Populates |private_data| from the contents of the cache file stored in
+  // |file_path|. |languages| will be used to break URLs and page titles into
+  // words and is deliberately passed by value.
   static void RestoreFromFileTask(
       const FilePath& file_path,
       scoped_refptr<URLIndexPrivateData> private_data,
       std::string languages);
 
-  // Constructs a new object by restoring its contents from the file at |path|.
-  // Returns the new URLIndexPrivateData which on success will contain the
-  // restored data but upon failure will be empty.  |languages| will be used to
-  // break URLs and page titles into words
-  static scoped_refptr<URLIndexPrivateData> RestoreFromFile(
-      const FilePath& path,
-      const std::string& languages);
+  // Restores our contents from the cache file at |path|. A cache in the
+  // URLIndexCacheFile format is mapped and searched in place; an older
+  // protobuf cache is parsed into the maps, and replaced by the new format the
+  // next time the cache is saved. Returns false, leaving us empty, on failure.
+  // |languages| will be used to break URLs and page titles into words.
+  bool RestoreFromFile(const FilePath& path, const std::string& languages);
 
   // Constructs a new object by rebuilding its contents from the history
   // database in |history_db|. Returns the new URLIndexPrivateData which on
@@ -174,9 +164,15 @@ class URLIndexPrivateData
       scoped_refptr<RefCountedBool> succeeded);
 
   // Caches the index private data and writes the cache file to the profile
-  // directory.  Called by WritePrivateDataToCacheFileTask.
+  // directory in the URLIndexCacheFile format, merging the items restored from
+  // |cache_file_| with those indexed since.  Called by
+  // WritePrivateDataToCacheFileTask.
   bool SaveToFile(const FilePath& file_path);
 
+  // Writes the cache file in the older protobuf format. For testing the
+  // upgrade of such caches only.
+  bool SaveToLegacyFile(const FilePath& file_path);
+
   // Initializes all index data members in preparation for restoring the index
   // from the cache or a complete rebuild from the history database.
   void Clear();
@@ -187,6 +183,24 @@ class URLIndexPrivateData
   // Creates a copy of ourself.
   scoped_refptr<URLIndexPrivateData> Duplicate() const;
 
+  // Returns true if the item |history_id| is served from |cache_file_|, i.e.
+  // it is in the file and has not been updated or deleted since.
+  bool InCacheFile(HistoryID history_id) const;
+
+  // Fills in |row| and |word_starts| for the indexed item |history_id|, from
+  // the maps or |cache_file_|. Either may be NULL. Returns false if the item
+  // is not indexed.
+  bool GetHistoryInfo(HistoryID history_id,
+                      URLRow* row,
+                      RowWordStarts* word_starts) const;
+
+  // Like GetHistoryInfo() but only gets the factors used to trim large
+  // candidate sets.
+  bool GetVisitInfo(HistoryID history_id,
+                    int* typed_count,
+                    int* visit_count,
+                    base::Time* last_visit) const;
+
   // Adds |word_id| to |history_id|'s entry in the history/word map,
   // creating a new entry if one does not already exist.
   void AddToHistoryIDWordMap(HistoryID history_id, WordID word_id);
@@ -274,6 +288,14 @@ class URLIndexPrivateData
       const String16Vector& terms_vector,
       const RowWordStarts& word_starts);
 
+  // Combines a |term_score| with the recency, visit count and typed count of
+  // |row| into the final raw score of ScoredMatchForURL(). Passing the
+  // highest possible term score gives the best score |row| can get.
+  static int RawScoreForRow(const URLRow& row, int term_score);
+
+  // The best raw score |row| could get for any search.
+  static int MaxRawScoreForRow(const URLRow& row);
+
   // Calculates a component score based on position, ordering and total
   // substring match size using metrics recorded in |matches|. |max_length|
   // is the length of the string against which the terms are being searched.
@@ -358,6 +380,13 @@ class URLIndexPrivateData
 
   // End of data members that are cached ---------------------------------------
 
+  // The mapped cache file this instance was restored from, if any. Its items
+  // are searched in place rather than being loaded into the maps above. Items
+  // updated or deleted since are listed in |cache_file_overrides_|; updated
+  // ones are indexed in the maps like any new item.
+  scoped_refptr<URLIndexCacheFile> cache_file_;
+  HistoryIDSet cache_file_overrides_;
+
   // For unit testing only. Specifies the version of the cache file to be saved.
   // Used only for testing upgrading of an older version of the cache upon
   // restore.
@@ -0,0 +1,144 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/history/url_index_scoring_job.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/sys_info.h"
+#include "chrome/browser/history/url_index_private_data.h"
+#include "content/public/browser/browser_thread.h"
+
+using content::BrowserThread;
+
+namespace history {
+
+namespace {
+
+bool MaxScoreGreater(const URLIndexScoringJob::Candidate& a,
+                     const URLIndexScoringJob::Candidate& b) {
+  return a.max_score > b.max_score;
+}
+
+}  // namespace
+
+URLIndexScoringJob::Candidate::Candidate() : max_score(0) {}
+
+URLIndexScoringJob::Candidate::~Candidate() {}
+
+URLIndexScoringJob::URLIndexScoringJob(const string16& lower_string,
+                                       const String16Vector& lower_terms,
+                                       Candidates* candidates,
+                                       size_t max_matches)
+    : lower_string_(lower_string),
+      lower_terms_(lower_terms),
+      max_matches_(max_matches),
+      next_candidate_(0),
+      pending_chunks_(0) {
+  candidates_.swap(*candidates);
+  std::stable_sort(candidates_.begin(), candidates_.end(), MaxScoreGreater);
+}
+
+URLIndexScoringJob::~URLIndexScoringJob() {}
+
+ScoredHistoryMatches URLIndexScoringJob::Run() {
+  DCHECK(callback_.is_null());
+  while (!IsComplete()) {
+    ScoredHistoryMatches matches;
+    ScoreChunk(next_candidate_, next_candidate_ + 1, &matches);
+    ++next_candidate_;
+    AddMatches(matches);
+  }
+  return top_matches_;
+}
+
+void URLIndexScoringJob::Start(const DoneCallback& callback) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  DCHECK(callback_.is_null());
+  callback_ = callback;
+  StartRound();
+}
+
+void URLIndexScoringJob::Cancel() {
+  cancel_flag_.Set();
+  // Drop the callback's references now rather than when the last chunk
+  // comes back.
+  callback_.Reset();
+}
+
+void URLIndexScoringJob::ScoreChunk(size_t begin,
+                                    size_t end,
+                                    ScoredHistoryMatches* matches) const {
+  for (size_t i = begin; i < end && !cancel_flag_.IsSet(); ++i) {
+    const Candidate& candidate(candidates_[i]);
+    ScoredHistoryMatch match(URLIndexPrivateData::ScoredMatchForURL(
+        candidate.row, lower_string_, lower_terms_, candidate.word_starts));
+    DCHECK_LE(match.raw_score, candidate.max_score);
+    if (match.raw_score > 0)
+      matches->push_back(match);
+  }
+}
+
+void URLIndexScoringJob::StartRound() {
+  DCHECK(!pending_chunks_);
+  if (cancel_flag_.IsSet())
+    return;
+  if (IsComplete()) {
+    DoneCallback callback(callback_);
+    callback_.Reset();
+    callback.Run(top_matches_);
+    return;
+  }
+  // Score as many chunks at once as there are processors, then check whether
+  // the remaining candidates can still make it.
+  int chunks = std::max(base::SysInfo::NumberOfProcessors(), 1);
+  for (int i = 0; i < chunks && next_candidate_ < candidates_.size(); ++i) {
+    size_t end = std::min(next_candidate_ + kChunkSize, candidates_.size());
+    ScoredHistoryMatches* matches = new ScoredHistoryMatches;
+    BrowserThread::PostBlockingPoolTaskAndReply(FROM_HERE,
+        base::Bind(&URLIndexScoringJob::ScoreChunk, this, next_candidate_,
+                   end, matches),
+        base::Bind(&URLIndexScoringJob::OnChunkScored, this,
+                   base::Owned(matches)));
+    next_candidate_ = end;
+    ++pending_chunks_;
+  }
+}
+
+void URLIndexScoringJob::OnChunkScored(ScoredHistoryMatches* matches) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  --pending_chunks_;
+  if (cancel_flag_.IsSet())
+    return;
+  AddMatches(*matches);
+  if (!pending_chunks_)
+    StartRound();
+}
+
+void URLIndexScoringJob::AddMatches(const ScoredHistoryMatches& matches) {
+  if (matches.empty())
+    return;
+  top_matches_.insert(top_matches_.end(), matches.begin(), matches.end());
+  if (top_matches_.size() > max_matches_) {
+    std::partial_sort(top_matches_.begin(),
+                      top_matches_.begin() + max_matches_,
+                      top_matches_.end(),
+                      ScoredHistoryMatch::MatchScoreGreater);
+    top_matches_.resize(max_matches_);
+  } else {
+    std::sort(top_matches_.begin(), top_matches_.end(),
+              ScoredHistoryMatch::MatchScoreGreater);
+  }
+}
+
+bool URLIndexScoringJob::IsComplete() const {
+  if (next_candidate_ == candidates_.size())
+    return true;
+  return !top_matches_.empty() && top_matches_.size() >= max_matches_ &&
+      top_matches_.back().raw_score >= candidates_[next_candidate_].max_score;
+}
+
+}  // namespace history
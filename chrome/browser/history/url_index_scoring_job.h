@@ -0,0 +1,124 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CHROME_BROWSER_HISTORY_URL_INDEX_SCORING_JOB_H_
+#define CHROME_BROWSER_HISTORY_URL_INDEX_SCORING_JOB_H_
+#pragma once
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/string16.h"
+#include "base/synchronization/cancellation_flag.h"
+#include "chrome/browser/history/in_memory_url_index_types.h"
+
+namespace history {
+
+// Scores the candidate history items found by the InMemoryURLIndex for a
+// search and keeps the best of them.
+//
+// The candidates are scored in order of the best score each could possibly
+// get, given its visit counts and recency, so scoring stops as soon as the
+// matches found so far are full and none of the remaining candidates could
+// beat them. A job can either be Run() on the calling thread, or Start()ed to
+// score chunks of candidates in parallel on the blocking pool, in which case
+// the next keystroke's search can Cancel() it.
+class URLIndexScoringJob
+    : public base::RefCountedThreadSafe<URLIndexScoringJob> {
+ public:
+  typedef base::Callback<void(const ScoredHistoryMatches&)> DoneCallback;
+
+  // A history item to be scored.
+  struct Candidate {
+    Candidate();
+    ~Candidate();
+
+    URLRow row;
+    RowWordStarts word_starts;
+    int max_score;  // The best raw score |row| could get.
+  };
+  typedef std::vector<Candidate> Candidates;
+
+  // The number of candidates scored by each blocking pool task. Jobs with no
+  // more candidates than this are not worth starting.
+  static const size_t kChunkSize = 50;
+
+  // Creates a job keeping the best |max_matches| matches of |lower_string|,
+  // which was broken into |lower_terms|. Takes the contents of |candidates|.
+  URLIndexScoringJob(const string16& lower_string,
+                     const String16Vector& lower_terms,
+                     Candidates* candidates,
+                     size_t max_matches);
+
+  // True if there are enough candidates to be worth scoring with Start().
+  bool ShouldStart() const { return candidates_.size() > kChunkSize; }
+
+  // Scores the candidates on this thread and returns the best matches, sorted
+  // by descending score.
+  ScoredHistoryMatches Run();
+
+  // Scores the candidates on the blocking pool and calls |callback| with the
+  // best matches, sorted by descending score, on the UI thread. Must be called
+  // on the UI thread.
+  void Start(const DoneCallback& callback);
+
+  // Stops a started job. Its callback will not be called.
+  void Cancel();
+
+  // The number of candidates scored so far. For testing.
+  size_t scored_count() const { return next_candidate_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<URLIndexScoringJob>;
+
+  ~URLIndexScoringJob();
+
+  // Scores the candidates [begin, end) and appends those which match to
+  // |matches|. Called on any thread.
+  void ScoreChunk(size_t begin, size_t end,
+                  ScoredHistoryMatches* matches) const;
+
+  // Posts the next round of chunks to the blocking pool, or calls the
+  // callback if there is nothing left to score.
+  void StartRound();
+
+  // Called on the UI thread with the matches of a chunk.
+  void OnChunkScored(ScoredHistoryMatches* matches);
+
+  // Merges |matches| into |top_matches_|.
+  void AddMatches(const ScoredHistoryMatches& matches);
+
+  // True once no unscored candidate can make it into |top_matches_|.
+  bool IsComplete() const;
+
+  const string16 lower_string_;
+  const String16Vector lower_terms_;
+
+  // Sorted by descending |max_score|.
+  Candidates candidates_;
+
+  const size_t max_matches_;
+
+  // The first candidate which hasn't been scored or handed to a task.
+  size_t next_candidate_;
+
+  // The number of chunks being scored on the blocking pool.
+  int pending_chunks_;
+
+  // The best matches so far, sorted by descending score.
+  ScoredHistoryMatches top_matches_;
+
+  // Set by Cancel(), and checked by the scoring tasks between candidates.
+  base::CancellationFlag cancel_flag_;
+
+  DoneCallback callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(URLIndexScoringJob);
+};
+
+}  // namespace history
+
+#endif  // CHROME_BROWSER_HISTORY_URL_INDEX_SCORING_JOB_H_
@@ -1,18 +1,150 @@
-// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
 #include "chrome/browser/image_decoder.h"
 
+#include <deque>
+
 #include "base/bind.h"
+#include "base/memory/weak_ptr.h"
+#include "base/metrics/histogram.h"
+#include "base/timer.h"
 #include "chrome/browser/browser_process.h"
 #include "chrome/common/chrome_utility_messages.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/utility_process_host.h"
+#include "content/public/browser/utility_process_host_client.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 
 using content::BrowserThread;
 using content::UtilityProcessHost;
 
+namespace {
+
+// How long the utility process is kept after it decoded its last image.
+const int kProcessIdleTimeoutSeconds = 5;
+
+}  // namespace
+
+// Sends the images of all the decoders to one utility process in batch mode,
+// instead of starting a process for every image. The process handles the
+// images in the order they were sent, so each result belongs to the oldest
+// decoder still waiting.
+class ImageDecoder::Service : public content::UtilityProcessHostClient {
+ public:
+  Service() {}
+
+  static Service* GetInstance() {
+    DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+    static Service* instance = NULL;
+    if (!instance) {
+      instance = new Service;
+      // Leaked on purpose, like the IO thread globals.
+      instance->AddRef();
+    }
+    return instance;
+  }
+
+  void Decode(ImageDecoder* decoder,
+              const std::vector<unsigned char>& image_data) {
+    DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+    idle_timer_.Stop();
+    if (!utility_host_) {
+      utility_host_ =
+          UtilityProcessHost::Create(this, BrowserThread::IO)->AsWeakPtr();
+      utility_host_->EnableZygote();
+      if (!utility_host_->StartBatchMode()) {
+        utility_host_.reset();
+        PostResult(decoder, NULL);
+        return;
+      }
+    }
+    pending_decoders_.push_back(make_scoped_refptr(decoder));
+    utility_host_->Send(new ChromeUtilityMsg_DecodeImage(image_data));
+  }
+
+  // content::UtilityProcessHostClient implementation.
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    bool handled = true;
+    IPC_BEGIN_MESSAGE_MAP(Service, message)
+      IPC_MESSAGE_HANDLER(ChromeUtilityHostMsg_DecodeImage_Succeeded,
+                          OnDecodeImageSucceeded)
+      IPC_MESSAGE_HANDLER(ChromeUtilityHostMsg_DecodeImage_Failed,
+                          OnDecodeImageFailed)
+      IPC_MESSAGE_UNHANDLED(handled = false)
+    IPC_END_MESSAGE_MAP()
+    return handled;
+  }
+
+  virtual void OnProcessCrashed(int exit_code) OVERRIDE {
+    // The images that were not decoded yet are lost with the process. The
+    // host deletes itself.
+    utility_host_.reset();
+    idle_timer_.Stop();
+    while (!pending_decoders_.empty()) {
+      PostResult(pending_decoders_.front(), NULL);
+      pending_decoders_.pop_front();
+    }
+  }
+
+ private:
+  virtual ~Service() {}
+
+  void OnDecodeImageSucceeded(const SkBitmap& decoded_image) {
+    FinishFrontDecoder(&decoded_image);
+  }
+
+  void OnDecodeImageFailed() {
+    FinishFrontDecoder(NULL);
+  }
+
+  void FinishFrontDecoder(const SkBitmap* decoded_image) {
+    DCHECK(!pending_decoders_.empty());
+    if (pending_decoders_.empty())
+      return;
+    PostResult(pending_decoders_.front(), decoded_image);
+    pending_decoders_.pop_front();
+
+    if (pending_decoders_.empty()) {
+      idle_timer_.Start(
+          FROM_HERE, base::TimeDelta::FromSeconds(kProcessIdleTimeoutSeconds),
+          this, &Service::EndProcess);
+    }
+  }
+
+  // Reports the result to |decoder| on its thread. A NULL |decoded_image|
+  // means that the image could not be decoded.
+  void PostResult(ImageDecoder* decoder, const SkBitmap* decoded_image) {
+    if (decoded_image) {
+      BrowserThread::PostTask(
+          decoder->target_thread_id_, FROM_HERE,
+          base::Bind(&ImageDecoder::OnDecodeImageSucceeded, decoder,
+                     *decoded_image));
+    } else {
+      BrowserThread::PostTask(
+          decoder->target_thread_id_, FROM_HERE,
+          base::Bind(&ImageDecoder::OnDecodeImageFailed, decoder));
+    }
+  }
+
+  void EndProcess() {
+    DCHECK(pending_decoders_.empty());
+    if (utility_host_)
+      utility_host_->EndBatchMode();
+    utility_host_.reset();
+  }
+
+  base::WeakPtr<UtilityProcessHost> utility_host_;
+
+  // The decoders whose image was sent to the process, oldest first.
+  std::deque<scoped_refptr<ImageDecoder> > pending_decoders_;
+
+  base::OneShotTimer<Service> idle_timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(Service);
+};
+
 ImageDecoder::ImageDecoder(Delegate* delegate,
                            const std::string& image_data)
     : delegate_(delegate),
@@ -27,25 +159,16 @@ void ImageDecoder::Start() {
     NOTREACHED();
     return;
   }
+  start_time_ = base::TimeTicks::Now();
   BrowserThread::PostTask(
      BrowserThread::IO, FROM_HERE,
      base::Bind(&ImageDecoder::DecodeImageInSandbox, this, image_data_));
 }
 
-bool ImageDecoder::OnMessageReceived(const IPC::Message& message) {
-  bool handled = true;
-  IPC_BEGIN_MESSAGE_MAP(ImageDecoder, message)
-    IPC_MESSAGE_HANDLER(ChromeUtilityHostMsg_DecodeImage_Succeeded,
-                        OnDecodeImageSucceeded)
-    IPC_MESSAGE_HANDLER(ChromeUtilityHostMsg_DecodeImage_Failed,
-                        OnDecodeImageFailed)
-    IPC_MESSAGE_UNHANDLED(handled = false)
-  IPC_END_MESSAGE_MAP()
-  return handled;
-}
-
 void ImageDecoder::OnDecodeImageSucceeded(const SkBitmap& decoded_image) {
   DCHECK(BrowserThread::CurrentlyOn(target_thread_id_));
+  UMA_HISTOGRAM_TIMES("ImageDecoder.DecodeTime",
+                      base::TimeTicks::Now() - start_time_);
   if (delegate_)
     delegate_->OnImageDecoded(this, decoded_image);
 }
@@ -59,8 +182,5 @@ void ImageDecoder::OnDecodeImageFailed() {
 void ImageDecoder::DecodeImageInSandbox(
     const std::vector<unsigned char>& image_data) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
-  UtilityProcessHost* utility_process_host = UtilityProcessHost::Create(
-      this, target_thread_id_);
-  utility_process_host->EnableZygote();
-  utility_process_host->Send(new ChromeUtilityMsg_DecodeImage(image_data));
+  Service::GetInstance()->Decode(this, image_data);
 }
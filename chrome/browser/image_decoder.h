@@ -1,4 +1,4 @@
-// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
@@ -9,14 +9,16 @@
 #include <string>
 #include <vector>
 
-#include "base/compiler_specific.h"
+#include "base/memory/ref_counted.h"
+#include "base/time.h"
 #include "content/public/browser/browser_thread.h"
-#include "content/public/browser/utility_process_host_client.h"
 
 class SkBitmap;
 
-// Decodes an image in a sandboxed process.
-class ImageDecoder : public content::UtilityProcessHostClient {
+// Decodes an image in a sandboxed process. All the images are decoded by one
+// utility process, which is kept around for a little while after it decoded
+// its last image so that images requested one after another share it.
+class ImageDecoder : public base::RefCountedThreadSafe<ImageDecoder> {
  public:
   class Delegate {
    public:
@@ -41,23 +43,28 @@ class ImageDecoder : public content::UtilityProcessHostClient {
   void Start();
 
  private:
-  // It's a reference counted object, so destructor is private.
-  virtual ~ImageDecoder();
+  friend class base::RefCountedThreadSafe<ImageDecoder>;
+
+  // The utility process shared by all the decoders, on the IO thread.
+  class Service;
 
-  // Overidden from UtilityProcessHostClient:
-  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE;
+  // It's a reference counted object, so destructor is private.
+  ~ImageDecoder();
 
-  // IPC message handlers.
+  // Called by the Service on the thread Start() was called on.
   void OnDecodeImageSucceeded(const SkBitmap& decoded_image);
   void OnDecodeImageFailed();
 
-  // Launches sandboxed process that will decode the image.
+  // Hands the image to the Service.
   void DecodeImageInSandbox(const std::vector<unsigned char>& image_data);
 
   Delegate* delegate_;
   std::vector<unsigned char> image_data_;
   content::BrowserThread::ID target_thread_id_;
 
+  // When Start() was called.
+  base::TimeTicks start_time_;
+
   DISALLOW_COPY_AND_ASSIGN(ImageDecoder);
 };
 
@@ -4,11 +4,13 @@
 
 #include "chrome/browser/nacl_host/nacl_process_host.h"
 
+#include <list>
 #include <string>
 #include <vector>
 
 #include "base/bind.h"
 #include "base/command_line.h"
+#include "base/lazy_instance.h"
 #include "base/memory/mru_cache.h"
 #include "base/memory/singleton.h"
 #include "base/message_loop.h"
@@ -34,6 +36,7 @@
 #include "chrome/common/render_messages.h"
 #include "chrome/common/url_constants.h"
 #include "content/public/browser/browser_child_process_host.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/browser/child_process_data.h"
 #include "content/public/common/child_process_host.h"
 #include "ipc/ipc_switches.h"
@@ -61,6 +64,14 @@ using content::ChildProcessHost;
 
 namespace {
 
+// How long after startup the spare loaders are launched, so that they don't
+// compete with the first pages for the CPU.
+const int kSpareLoaderDelaySeconds = 10;
+
+// Loaders launched ahead of time, waiting for a plugin.
+base::LazyInstance<std::list<NaClProcessHost*> > g_spare_hosts =
+    LAZY_INSTANCE_INITIALIZER;
+
 #if defined(OS_WIN)
 bool RunningOnWOW64() {
   return (base::win::OSInfo::GetInstance()->wow64_status() ==
@@ -307,6 +318,8 @@ struct NaClProcessHost::NaClInternal {
 
 NaClProcessHost::NaClProcessHost(const GURL& manifest_url)
     : manifest_url_(manifest_url),
+      process_launched_(false),
+      was_spare_(false),
 #if defined(OS_WIN)
       process_launched_by_broker_(false),
 #elif defined(OS_LINUX)
@@ -338,6 +351,9 @@ NaClProcessHost::NaClProcessHost(const GURL& manifest_url)
 }
 
 NaClProcessHost::~NaClProcessHost() {
+  if (was_spare_)
+    g_spare_hosts.Get().remove(this);
+
   int exit_code;
   process_->GetTerminationStatus(&exit_code);
   std::string message =
@@ -373,6 +389,20 @@ NaClProcessHost::~NaClProcessHost() {
 #endif
 }
 
+// static
+NaClProcessHost* NaClProcessHost::Create(const GURL& manifest_url) {
+  std::list<NaClProcessHost*>& spare_hosts = g_spare_hosts.Get();
+  if (spare_hosts.empty())
+    return new NaClProcessHost(manifest_url);
+
+  NaClProcessHost* host = spare_hosts.front();
+  spare_hosts.pop_front();
+  host->manifest_url_ = manifest_url;
+  host->process_->SetName(net::FormatUrl(manifest_url, std::string()));
+  FillSpareProcessPool();
+  return host;
+}
+
 // This is called at browser startup.
 // static
 void NaClProcessHost::EarlyStartup() {
@@ -381,6 +411,45 @@ void NaClProcessHost::EarlyStartup() {
   // under us by autoupdate.
   NaClBrowser::GetInstance()->EnsureIrtAvailable();
 #endif
+  BrowserThread::PostDelayedTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&NaClProcessHost::FillSpareProcessPool),
+      base::TimeDelta::FromSeconds(kSpareLoaderDelaySeconds));
+}
+
+// static
+void NaClProcessHost::FillSpareProcessPool() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  // Loaders run under a wrapper or a debugger are set up per plugin.
+  if (command_line.HasSwitch(switches::kNaClLoaderCmdPrefix) ||
+      command_line.HasSwitch(switches::kNaClGdb)) {
+    return;
+  }
+  int pool_size = 0;
+  if (!base::StringToInt(command_line.GetSwitchValueASCII(
+          switches::kNaClLoaderPoolSize), &pool_size))
+    return;
+
+  std::list<NaClProcessHost*>& spare_hosts = g_spare_hosts.Get();
+  while (static_cast<int>(spare_hosts.size()) < pool_size) {
+    NaClProcessHost* host = CreateSpareHost();
+    if (!host)
+      return;
+    spare_hosts.push_back(host);
+  }
+}
+
+// static
+NaClProcessHost* NaClProcessHost::CreateSpareHost() {
+  NaClProcessHost* host = new NaClProcessHost(GURL());
+  host->was_spare_ = true;
+  host->process_->SetName(ASCIIToUTF16("Spare Native Client loader"));
+  if (!host->LaunchSelLdr()) {
+    delete host;
+    return NULL;
+  }
+  return host;
 }
 
 void NaClProcessHost::Launch(
@@ -391,6 +460,7 @@ void NaClProcessHost::Launch(
   chrome_render_message_filter_ = chrome_render_message_filter;
   reply_msg_ = reply_msg;
   extension_info_map_ = extension_info_map;
+  launch_time_ = base::TimeTicks::Now();
 
   // Place an arbitrary limit on the number of sockets to limit
   // exposure in case the renderer is compromised.  We can increase
@@ -430,6 +500,13 @@ void NaClProcessHost::Launch(
     SetCloseOnExec(pair[1]);
   }
 
+  // A spare loader that is still starting carries on from OnProcessLaunched.
+  if (was_spare_) {
+    if (process_launched_ && !StartWithLaunchedProcess())
+      delete this;
+    return;
+  }
+
   // Launch the process
   if (!LaunchSelLdr()) {
     delete this;
@@ -469,8 +546,7 @@ void NaClProcessHost::OnChannelConnected(int32 peer_pid) {
 void NaClProcessHost::OnProcessLaunchedByBroker(base::ProcessHandle handle) {
   process_launched_by_broker_ = true;
   process_->SetHandle(handle);
-  if (!StartWithLaunchedProcess())
-    delete this;
+  OnProcessLaunched();
 }
 
 void NaClProcessHost::OnDebugExceptionHandlerLaunchedByBroker(bool success) {
@@ -725,6 +801,11 @@ void NaClProcessHost::OnProcessCrashed(int exit_code) {
 }
 
 void NaClProcessHost::OnProcessLaunched() {
+  // A spare loader has no plugin to start yet.
+  if (!reply_msg_) {
+    process_launched_ = true;
+    return;
+  }
   if (!StartWithLaunchedProcess())
     delete this;
 }
@@ -844,7 +925,15 @@ bool NaClProcessHost::StartNaClExecution() {
 }
 
 bool NaClProcessHost::SendStart() {
-  return ReplyToRenderer() && StartNaClExecution();
+  if (!ReplyToRenderer() || !StartNaClExecution())
+    return false;
+
+  base::TimeDelta time_to_start = base::TimeTicks::Now() - launch_time_;
+  if (was_spare_)
+    UMA_HISTOGRAM_TIMES("NaCl.LoaderStartTime.SpareProcess", time_to_start);
+  else
+    UMA_HISTOGRAM_TIMES("NaCl.LoaderStartTime.NewProcess", time_to_start);
+  return true;
 }
 
 bool NaClProcessHost::StartWithLaunchedProcess() {
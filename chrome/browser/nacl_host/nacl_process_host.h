@@ -14,6 +14,7 @@
 #include "base/memory/weak_ptr.h"
 #include "base/message_loop.h"
 #include "base/process.h"
+#include "base/time.h"
 #include "chrome/common/nacl_types.h"
 #include "content/public/browser/browser_child_process_host_delegate.h"
 #include "googleurl/src/gurl.h"
@@ -39,9 +40,17 @@ class NaClProcessHost : public content::BrowserChildProcessHostDelegate {
   explicit NaClProcessHost(const GURL& manifest_url);
   virtual ~NaClProcessHost();
 
+  // Returns a host for the plugin at |manifest_url|: a spare loader from the
+  // pool when there is one, otherwise a new host. Call Launch() on the result.
+  static NaClProcessHost* Create(const GURL& manifest_url);
+
   // Do any minimal work that must be done at browser startup.
   static void EarlyStartup();
 
+  // Launches loaders until the pool holds as many spare ones as the
+  // --nacl-loader-pool-size switch asks for. Must be called on the IO thread.
+  static void FillSpareProcessPool();
+
   // Initialize the new NaCl process. Result is returned by sending ipc
   // message reply_msg.
   void Launch(ChromeRenderMessageFilter* chrome_render_message_filter,
@@ -113,8 +122,21 @@ class NaClProcessHost : public content::BrowserChildProcessHostDelegate {
                                    IPC::Message* reply_msg);
 #endif
 
+  // Launches a loader for the pool, to be given a plugin later.
+  static NaClProcessHost* CreateSpareHost();
+
   GURL manifest_url_;
 
+  // True once the loader process has launched. Only tracked for spare
+  // loaders, which must wait for Launch() before they can be started.
+  bool process_launched_;
+
+  // True if this loader was launched ahead of time for the pool.
+  bool was_spare_;
+
+  // When Launch() was called, for measuring how long the plugin waited.
+  base::TimeTicks launch_time_;
+
 #if defined(OS_WIN)
   // This field becomes true when the broker successfully launched
   // the NaCl loader.
@@ -6,15 +6,27 @@
 
 #include <stdio.h>
 
+#include "base/bind.h"
+#include "base/bind_helpers.h"
 #include "base/file_util.h"
 #include "base/json/json_writer.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/message_loop_proxy.h"
 #include "base/threading/thread_restrictions.h"
 #include "base/values.h"
 #include "chrome/browser/ui/webui/net_internals/net_internals_ui.h"
 
-NetLogLogger::NetLogLogger(const FilePath &log_path) {
+NetLogLogger::Entry::Entry()
+    : type(net::NetLog::TYPE_CANCELLED),
+      phase(net::NetLog::PHASE_NONE) {
+}
+
+NetLogLogger::Entry::~Entry() {
+}
+
+NetLogLogger::NetLogLogger(const FilePath &log_path)
+    : thread_("NetLogLogger") {
   if (!log_path.empty()) {
     base::ThreadRestrictions::ScopedAllowIO allow_io;
     file_.Set(file_util::OpenFile(log_path, "w"));
@@ -28,9 +40,15 @@ NetLogLogger::NetLogLogger(const FilePath &log_path) {
     fprintf(file_.get(), "{\"constants\": %s,\n", json.c_str());
     fprintf(file_.get(), "\"events\": [\n");
   }
+  thread_.Start();
 }
 
 NetLogLogger::~NetLogLogger() {
+  // Stopping the thread runs the writes already posted to it. The ones queued
+  // after that are written here.
+  thread_.Stop();
+  base::ThreadRestrictions::ScopedAllowIO allow_io;
+  WriteEntries();
 }
 
 void NetLogLogger::StartObserving(net::NetLog* net_log) {
@@ -42,18 +60,47 @@ void NetLogLogger::OnAddEntry(net::NetLog::EventType type,
                               const net::NetLog::Source& source,
                               net::NetLog::EventPhase phase,
                               net::NetLog::EventParameters* params) {
-  scoped_ptr<Value> value(
-      net::NetLog::EntryToDictionaryValue(
-          type, time, source, phase, params, false));
-  // Don't pretty print, so each JSON value occupies a single line, with no
-  // breaks (Line breaks in any text field will be escaped).  Using strings
-  // instead of integer identifiers allows logs from older versions to be
-  // loaded, though a little extra parsing has to be done when loading a log.
-  std::string json;
-  base::JSONWriter::Write(value.get(), &json);
-  if (!file_.get()) {
-    VLOG(1) << json;
-  } else {
-    fprintf(file_.get(), "%s,\n", json.c_str());
+  base::AutoLock lock(lock_);
+  pending_entries_.push_back(Entry());
+  Entry& entry = pending_entries_.back();
+  entry.type = type;
+  entry.time = time;
+  entry.source = source;
+  entry.phase = phase;
+  entry.params = params;
+
+  // A single write is in flight for any number of queued entries.
+  if (pending_entries_.size() == 1 && thread_.IsRunning()) {
+    thread_.message_loop_proxy()->PostTask(
+        FROM_HERE,
+        base::Bind(&NetLogLogger::WriteEntries, base::Unretained(this)));
+  }
+}
+
+void NetLogLogger::WriteEntries() {
+  std::vector<Entry> entries;
+  {
+    base::AutoLock lock(lock_);
+    entries.swap(pending_entries_);
+  }
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const Entry& entry = entries[i];
+    scoped_ptr<Value> value(
+        net::NetLog::EntryToDictionaryValue(
+            entry.type, entry.time, entry.source, entry.phase,
+            entry.params.get(), false));
+    // Don't pretty print, so each JSON value occupies a single line, with no
+    // breaks (Line breaks in any text field will be escaped).  Using strings
+    // instead of integer identifiers allows logs from older versions to be
+    // loaded, though a little extra parsing has to be done when loading a
+    // log.
+    std::string json;
+    base::JSONWriter::Write(value.get(), &json);
+    if (!file_.get()) {
+      VLOG(1) << json;
+    } else {
+      fprintf(file_.get(), "%s,\n", json.c_str());
+    }
   }
 }
@@ -6,7 +6,12 @@
 #define CHROME_BROWSER_NET_NET_LOG_LOGGER_H_
 #pragma once
 
+#include <vector>
+
 #include "base/memory/scoped_handle.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread.h"
+#include "base/time.h"
 #include "net/base/net_log.h"
 
 class FilePath;
@@ -19,8 +24,9 @@ class FilePath;
 // contain a single JSON object, with an extra comma on the end and missing
 // a terminal "]}".
 //
-// Relies on ChromeNetLog only calling an Observer once at a time for
-// thread-safety.
+// Entries are only queued on the thread that logged them. Their parameters
+// are converted to JSON and written out on a thread of the logger's own, so
+// that logging everything does not slow down the IO thread.
 class NetLogLogger : public net::NetLog::ThreadSafeObserver {
  public:
   // If |log_path| is empty or file creation fails, writes to VLOG(1).
@@ -41,8 +47,31 @@ class NetLogLogger : public net::NetLog::ThreadSafeObserver {
                           net::NetLog::EventParameters* params) OVERRIDE;
 
  private:
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    net::NetLog::EventType type;
+    base::TimeTicks time;
+    net::NetLog::Source source;
+    net::NetLog::EventPhase phase;
+    scoped_refptr<net::NetLog::EventParameters> params;
+  };
+
+  // Writes out the queued entries. Runs on |thread_|, or on the destroying
+  // thread once |thread_| has been stopped.
+  void WriteEntries();
+
   ScopedStdioHandle file_;
 
+  // The thread the entries are written on.
+  base::Thread thread_;
+
+  // |lock_| protects |pending_entries_|, which may be appended to from any
+  // thread.
+  base::Lock lock_;
+  std::vector<Entry> pending_entries_;
+
   DISALLOW_COPY_AND_ASSIGN(NetLogLogger);
 };
 
@@ -0,0 +1,54 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/net/net_log_logger.h"
+
+#include <string>
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/scoped_temp_dir.h"
+#include "base/string_util.h"
+#include "net/base/net_log.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+class NetLogLoggerTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    log_path_ = temp_dir_.path().AppendASCII("net_log.json");
+  }
+
+  ScopedTempDir temp_dir_;
+  FilePath log_path_;
+};
+
+// Entries still queued when the logger goes away are written out too.
+TEST_F(NetLogLoggerTest, WritesAllEntries) {
+  const int kEntries = 1000;
+  scoped_ptr<NetLogLogger> logger(new NetLogLogger(log_path_));
+  for (int i = 0; i < kEntries; ++i) {
+    logger->OnAddEntry(net::NetLog::TYPE_CANCELLED, base::TimeTicks::Now(),
+                       net::NetLog::Source(net::NetLog::SOURCE_NONE, i + 1),
+                       net::NetLog::PHASE_NONE, NULL);
+  }
+  logger.reset();
+
+  std::string contents;
+  ASSERT_TRUE(file_util::ReadFileToString(log_path_, &contents));
+  EXPECT_TRUE(StartsWithASCII(contents, "{\"constants\": ", true));
+
+  // One line per entry, after the constants and the start of the list.
+  size_t num_lines = 0;
+  for (size_t i = 0; i < contents.size(); ++i) {
+    if (contents[i] == '\n')
+      ++num_lines;
+  }
+  EXPECT_EQ(static_cast<size_t>(kEntries + 2), num_lines);
+}
+
+}  // namespace
@@ -8,6 +8,7 @@
 #include <map>
 #include <set>
 #include <utility>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/bind.h"
@@ -18,6 +19,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/metrics/histogram.h"
+#include "base/stl_util.h"
 #include "base/string_util.h"
 #include "base/synchronization/lock.h"
 #include "base/threading/thread.h"
@@ -55,7 +57,10 @@ using content::BrowserThread;
 // Subsequent to loading, mutations may be queued by any thread using
 // AddCookie, UpdateCookieAccessTime, and DeleteCookie. These are flushed to
 // disk on the DB thread every 30 seconds, 512 operations, or call to Flush(),
-// whichever occurs first.
+// whichever occurs first.  Access time updates don't count toward the 512
+// operations, and operations on a cookie that is already in the batch are
+// merged with the pending one, so that only the last state of each cookie is
+// written.
 class SQLitePersistentCookieStore::Backend
     : public base::RefCountedThreadSafe<SQLitePersistentCookieStore::Backend> {
  public:
@@ -63,6 +68,7 @@ class SQLitePersistentCookieStore::Backend
       : path_(path),
         db_(NULL),
         num_pending_(0),
+        num_pending_writes_(0),
         clear_local_state_on_exit_(false),
         initialized_(false),
         restore_old_session_cookies_(restore_old_session_cookies),
@@ -102,7 +108,8 @@ class SQLitePersistentCookieStore::Backend
   // You should call Close() before destructing this object.
   ~Backend() {
     DCHECK(!db_.get()) << "Close should have already been called.";
-    DCHECK(num_pending_ == 0 && pending_.empty());
+    DCHECK(num_pending_ == 0 && pending_.empty() &&
+           pending_by_creation_time_.empty());
   }
 
   // Database upgrade statements.
@@ -121,7 +128,9 @@ class SQLitePersistentCookieStore::Backend
         : op_(op), cc_(cc) { }
 
     OperationType op() const { return op_; }
+    void set_op(OperationType op) { op_ = op; }
     const net::CookieMonster::CanonicalCookie& cc() const { return cc_; }
+    void set_cc(const net::CookieMonster::CanonicalCookie& cc) { cc_ = cc; }
 
    private:
     OperationType op_;
@@ -138,11 +147,17 @@ class SQLitePersistentCookieStore::Backend
                                   const LoadedCallback& loaded_callback,
                                   const base::Time& posted_at);
 
-  // Notifies the CookieMonster when loading completes for a specific domain key
-  // or for all domain keys. Triggers the callback and passes it all cookies
-  // that have been loaded from DB since last IO notification.
+  // Notifies the CookieMonster when loading completes for all domain keys.
+  // Triggers the callback and passes it all cookies that have been loaded from
+  // DB since last IO notification.
   void Notify(const LoadedCallback& loaded_callback, bool load_success);
 
+  // Notifies the CookieMonster when loading completes for the domain key |key|.
+  // Triggers the callback and passes it the cookies of |key| only, so that the
+  // request isn't held up by the cookies of the background load.
+  void NotifyForKey(const std::string& key,
+                    const LoadedCallback& loaded_callback);
+
   // Sends notification when the entire store is loaded, and reports metrics
   // for the total time to load and aggregated results from any priority loads
   // that occurred.
@@ -151,7 +166,8 @@ class SQLitePersistentCookieStore::Backend
 
   // Sends notification when a single priority load completes. Updates priority
   // load metric data. The data is sent only after the final load completes.
-  void CompleteLoadForKeyOnIOThread(const LoadedCallback& loaded_callback,
+  void CompleteLoadForKeyOnIOThread(const std::string& key,
+                                    const LoadedCallback& loaded_callback,
                                     bool load_success);
 
   // Sends all metrics, including posting a ReportMetricsOnDBThread task.
@@ -170,14 +186,20 @@ class SQLitePersistentCookieStore::Backend
   // domains are loaded).
   void ChainLoadCookies(const LoadedCallback& loaded_callback);
 
-  // Load all cookies for a set of domains/hosts
-  bool LoadCookiesForDomains(const std::set<std::string>& key);
+  // Load all cookies for a set of domains/hosts of the domain key |key|.
+  bool LoadCookiesForDomains(const std::string& key,
+                             const std::set<std::string>& domains);
 
   // Batch a cookie operation (add or delete)
   void BatchOperation(PendingOperation::OperationType op,
                       const net::CookieMonster::CanonicalCookie& cc);
   // Commit our pending operations to the database.
   void Commit();
+  // Writes operations on distinct cookies to the database, using multi-row
+  // statements where possible.  Returns false if a statement failed.
+  bool WriteOperations(const std::vector<PendingOperation*>& deletes,
+                       const std::vector<PendingOperation*>& adds,
+                       const std::vector<PendingOperation*>& updates);
   // Close() executed on the background thread.
   void InternalBackgroundClose();
 
@@ -190,15 +212,26 @@ class SQLitePersistentCookieStore::Backend
   typedef std::list<PendingOperation*> PendingOperationsList;
   PendingOperationsList pending_;
   PendingOperationsList::size_type num_pending_;
+  // The newest operation of |pending_| on each cookie, by creation time.
+  typedef std::map<int64, PendingOperationsList::iterator>
+      PendingOperationsMap;
+  PendingOperationsMap pending_by_creation_time_;
+  // The number of operations in |pending_| that aren't access time updates.
+  PendingOperationsList::size_type num_pending_writes_;
   // True if the persistent store should be deleted upon destruction.
   bool clear_local_state_on_exit_;
-  // Guard |cookies_|, |pending_|, |num_pending_|, |clear_local_state_on_exit_|
+  // Guard |cookies_|, |pending_|, |num_pending_|, |pending_by_creation_time_|,
+  // |num_pending_writes_|, |clear_local_state_on_exit_|
   base::Lock lock_;
 
-  // Temporary buffer for cookies loaded from DB. Accumulates cookies to reduce
-  // the number of messages sent to the IO thread. Sent back in response to
-  // individual load requests for domain keys or when all loading completes.
-  std::vector<net::CookieMonster::CanonicalCookie*> cookies_;
+  // Temporary buffer for cookies loaded from DB, by domain key. Accumulates
+  // cookies to reduce the number of messages sent to the IO thread. The
+  // cookies of a key are sent back in response to a load request for it, and
+  // all the others when all loading completes.
+  typedef std::map<std::string,
+                   std::vector<net::CookieMonster::CanonicalCookie*> >
+      CookiesPerKeyMap;
+  CookiesPerKeyMap cookies_;
 
   // Map of domain keys(eTLD+1) to domains/hosts that are to be loaded from DB.
   std::map<std::string, std::set<std::string> > keys_to_load_;
@@ -250,6 +283,11 @@ class SQLitePersistentCookieStore::Backend
 static const int kCurrentVersionNumber = 5;
 static const int kCompatibleVersionNumber = 5;
 
+// The number of cookies written by each multi-row INSERT or DELETE statement.
+// Inserts bind 11 values per cookie, this stays well below the 999 variables
+// SQLite allows in a statement.
+static const size_t kCookiesPerStatement = 32;
+
 namespace {
 
 // Increments a specified TimeDelta by the duration between this object's
@@ -304,6 +342,26 @@ bool InitTable(sql::Connection* db) {
   return true;
 }
 
+
+// Binds the columns of |cc| for the cookies INSERT statements, starting at
+// column |first_column| of |statement|.
+void BindAddCookie(sql::Statement* statement,
+                   int first_column,
+                   const net::CookieMonster::CanonicalCookie& cc) {
+  statement->BindInt64(first_column, cc.CreationDate().ToInternalValue());
+  statement->BindString(first_column + 1, cc.Domain());
+  statement->BindString(first_column + 2, cc.Name());
+  statement->BindString(first_column + 3, cc.Value());
+  statement->BindString(first_column + 4, cc.Path());
+  statement->BindInt64(first_column + 5, cc.ExpiryDate().ToInternalValue());
+  statement->BindInt(first_column + 6, cc.IsSecure());
+  statement->BindInt(first_column + 7, cc.IsHttpOnly());
+  statement->BindInt64(first_column + 8,
+                       cc.LastAccessDate().ToInternalValue());
+  statement->BindInt(first_column + 9, cc.DoesExpire());
+  statement->BindInt(first_column + 10, cc.IsPersistent());
+}
+
 }  // namespace
 
 void SQLitePersistentCookieStore::Backend::Load(
@@ -374,9 +432,11 @@ void SQLitePersistentCookieStore::Backend::LoadKeyAndNotifyOnDBThread(
     std::map<std::string, std::set<std::string> >::iterator
       it = keys_to_load_.find(key);
     if (it != keys_to_load_.end()) {
-      success = LoadCookiesForDomains(it->second);
+      success = LoadCookiesForDomains(it->first, it->second);
       keys_to_load_.erase(it);
     } else {
+      // Either the key has no cookies, or the background load already read
+      // them and they are still buffered.
       success = true;
     }
   }
@@ -385,13 +445,14 @@ void SQLitePersistentCookieStore::Backend::LoadKeyAndNotifyOnDBThread(
     BrowserThread::IO, FROM_HERE,
     base::Bind(
         &SQLitePersistentCookieStore::Backend::CompleteLoadForKeyOnIOThread,
-        this, loaded_callback, success));
+        this, key, loaded_callback, success));
 }
 
 void SQLitePersistentCookieStore::Backend::CompleteLoadForKeyOnIOThread(
+    const std::string& key,
     const LoadedCallback& loaded_callback,
     bool load_success) {
-  Notify(loaded_callback, load_success);
+  NotifyForKey(key, loaded_callback);
 
   {
     base::AutoLock locked(metrics_lock_);
@@ -450,7 +511,29 @@ void SQLitePersistentCookieStore::Backend::Notify(
   std::vector<net::CookieMonster::CanonicalCookie*> cookies;
   {
     base::AutoLock locked(lock_);
-    cookies.swap(cookies_);
+    for (CookiesPerKeyMap::iterator it = cookies_.begin();
+         it != cookies_.end(); ++it) {
+      cookies.insert(cookies.end(), it->second.begin(), it->second.end());
+    }
+    cookies_.clear();
+  }
+
+  loaded_callback.Run(cookies);
+}
+
+void SQLitePersistentCookieStore::Backend::NotifyForKey(
+    const std::string& key,
+    const LoadedCallback& loaded_callback) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+
+  std::vector<net::CookieMonster::CanonicalCookie*> cookies;
+  {
+    base::AutoLock locked(lock_);
+    CookiesPerKeyMap::iterator it = cookies_.find(key);
+    if (it != cookies_.end()) {
+      cookies.swap(it->second);
+      cookies_.erase(it);
+    }
   }
 
   loaded_callback.Run(cookies);
@@ -548,7 +631,7 @@ void SQLitePersistentCookieStore::Backend::ChainLoadCookies(
     // Load cookies for the first domain key.
     std::map<std::string, std::set<std::string> >::iterator
       it = keys_to_load_.begin();
-    load_success = LoadCookiesForDomains(it->second);
+    load_success = LoadCookiesForDomains(it->first, it->second);
     keys_to_load_.erase(it);
   }
 
@@ -570,6 +653,7 @@ void SQLitePersistentCookieStore::Backend::ChainLoadCookies(
 }
 
 bool SQLitePersistentCookieStore::Backend::LoadCookiesForDomains(
+  const std::string& key,
   const std::set<std::string>& domains) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::DB));
 
@@ -624,7 +708,9 @@ bool SQLitePersistentCookieStore::Backend::LoadCookiesForDomains(
   }
   {
     base::AutoLock locked(lock_);
-    cookies_.insert(cookies_.end(), cookies.begin(), cookies.end());
+    std::vector<net::CookieMonster::CanonicalCookie*>& key_cookies =
+        cookies_[key];
+    key_cookies.insert(key_cookies.end(), cookies.begin(), cookies.end());
   }
   return true;
 }
@@ -756,7 +842,8 @@ void SQLitePersistentCookieStore::Backend::BatchOperation(
     const net::CookieMonster::CanonicalCookie& cc) {
   // Commit every 30 seconds.
   static const int kCommitIntervalMs = 30 * 1000;
-  // Commit right away if we have more than 512 outstanding operations.
+  // Commit right away if we have more than 512 outstanding additions and
+  // deletions.
   static const size_t kCommitAfterBatchSize = 512;
   DCHECK(!BrowserThread::CurrentlyOn(BrowserThread::DB));
 
@@ -764,19 +851,60 @@ void SQLitePersistentCookieStore::Backend::BatchOperation(
   scoped_ptr<PendingOperation> po(new PendingOperation(op, cc));
 
   PendingOperationsList::size_type num_pending;
+  PendingOperationsList::size_type num_pending_writes;
+  bool appended = false;
   {
     base::AutoLock locked(lock_);
-    pending_.push_back(po.release());
-    num_pending = ++num_pending_;
+    // CookieMonster gives every cookie a distinct creation time, which is the
+    // primary key of the table.
+    const int64 creation_time = cc.CreationDate().ToInternalValue();
+    PendingOperationsMap::iterator found =
+        pending_by_creation_time_.find(creation_time);
+    if (found != pending_by_creation_time_.end()) {
+      PendingOperation* previous = *found->second;
+      if (op == PendingOperation::COOKIE_UPDATEACCESS &&
+          previous->op() != PendingOperation::COOKIE_DELETE) {
+        // The pending add or update writes the newer access time instead.
+        previous->set_cc(cc);
+        return;
+      }
+      if (op == PendingOperation::COOKIE_DELETE &&
+          previous->op() == PendingOperation::COOKIE_ADD) {
+        // The cookie never needs to reach the database.
+        delete previous;
+        pending_.erase(found->second);
+        pending_by_creation_time_.erase(found);
+        --num_pending_;
+        --num_pending_writes_;
+        return;
+      }
+      if (op == PendingOperation::COOKIE_DELETE &&
+          previous->op() == PendingOperation::COOKIE_UPDATEACCESS) {
+        // Deleting the row makes the pending update moot.
+        previous->set_op(PendingOperation::COOKIE_DELETE);
+        po.reset();
+      }
+    }
+    if (po.get()) {
+      pending_.push_back(po.release());
+      pending_by_creation_time_[creation_time] = --pending_.end();
+      ++num_pending_;
+      appended = true;
+    }
+    if (op != PendingOperation::COOKIE_UPDATEACCESS)
+      ++num_pending_writes_;
+    num_pending = num_pending_;
+    num_pending_writes = num_pending_writes_;
   }
 
-  if (num_pending == 1) {
+  if (appended && num_pending == 1) {
     // We've gotten our first entry for this batch, fire off the timer.
     BrowserThread::PostDelayedTask(
         BrowserThread::DB, FROM_HERE,
         base::Bind(&Backend::Commit, this),
         base::TimeDelta::FromMilliseconds(kCommitIntervalMs));
-  } else if (num_pending == kCommitAfterBatchSize) {
+  } else if (op != PendingOperation::COOKIE_UPDATEACCESS &&
+             num_pending_writes == kCommitAfterBatchSize) {
     // We've reached a big enough batch, fire off a commit now.
     BrowserThread::PostTask(
         BrowserThread::DB, FROM_HERE,
@@ -791,84 +919,179 @@ void SQLitePersistentCookieStore::Backend::Commit() {
   {
     base::AutoLock locked(lock_);
     pending_.swap(ops);
+    pending_by_creation_time_.clear();
     num_pending_ = 0;
+    num_pending_writes_ = 0;
   }
 
   // Maybe an old timer fired or we are already Close()'ed.
-  if (!db_.get() || ops.empty())
-    return;
-
-  sql::Statement add_smt(db_->GetCachedStatement(SQL_FROM_HERE,
-      "INSERT INTO cookies (creation_utc, host_key, name, value, path, "
-      "expires_utc, secure, httponly, last_access_utc, has_expires, "
-      "persistent) "
-      "VALUES (?,?,?,?,?,?,?,?,?,?,?)"));
-  if (!add_smt.is_valid())
-    return;
-
-  sql::Statement update_access_smt(db_->GetCachedStatement(SQL_FROM_HERE,
-      "UPDATE cookies SET last_access_utc=? WHERE creation_utc=?"));
-  if (!update_access_smt.is_valid())
-    return;
-
-  sql::Statement del_smt(db_->GetCachedStatement(SQL_FROM_HERE,
-                         "DELETE FROM cookies WHERE creation_utc=?"));
-  if (!del_smt.is_valid())
+  if (!db_.get() || ops.empty()) {
+    STLDeleteElements(&ops);
     return;
+  }
 
   sql::Transaction transaction(db_.get());
-  if (!transaction.Begin())
+  if (!transaction.Begin()) {
+    STLDeleteElements(&ops);
     return;
+  }
 
+  // Operations on different cookies can be written in any order, so they are
+  // grouped by type to be written with multi-row statements.  Each group
+  // deletes rows first, then adds and updates the others.  A cookie that is
+  // deleted and added again can be part of one group; any other operation on
+  // a cookie that is already in the group starts a new one.
+  bool written = true;
+  std::vector<PendingOperation*> deletes;
+  std::vector<PendingOperation*> adds;
+  std::vector<PendingOperation*> updates;
+  std::map<int64, PendingOperation::OperationType> group_ops;
   for (PendingOperationsList::iterator it = ops.begin();
        it != ops.end(); ++it) {
-    // Free the cookies as we commit them to the database.
-    scoped_ptr<PendingOperation> po(*it);
+    PendingOperation* po = *it;
+    const int64 creation_time = po->cc().CreationDate().ToInternalValue();
+    std::map<int64, PendingOperation::OperationType>::iterator in_group =
+        group_ops.find(creation_time);
+    if (in_group != group_ops.end() &&
+        !(in_group->second == PendingOperation::COOKIE_DELETE &&
+          po->op() == PendingOperation::COOKIE_ADD)) {
+      written &= WriteOperations(deletes, adds, updates);
+      deletes.clear();
+      adds.clear();
+      updates.clear();
+      group_ops.clear();
+    }
+    group_ops[creation_time] = po->op();
     switch (po->op()) {
       case PendingOperation::COOKIE_ADD:
-        add_smt.Reset(true);
-        add_smt.BindInt64(0, po->cc().CreationDate().ToInternalValue());
-        add_smt.BindString(1, po->cc().Domain());
-        add_smt.BindString(2, po->cc().Name());
-        add_smt.BindString(3, po->cc().Value());
-        add_smt.BindString(4, po->cc().Path());
-        add_smt.BindInt64(5, po->cc().ExpiryDate().ToInternalValue());
-        add_smt.BindInt(6, po->cc().IsSecure());
-        add_smt.BindInt(7, po->cc().IsHttpOnly());
-        add_smt.BindInt64(8, po->cc().LastAccessDate().ToInternalValue());
-        add_smt.BindInt(9, po->cc().DoesExpire());
-        add_smt.BindInt(10, po->cc().IsPersistent());
-        if (!add_smt.Run())
-          NOTREACHED() << "Could not add a cookie to the DB.";
+        adds.push_back(po);
         break;
-
       case PendingOperation::COOKIE_UPDATEACCESS:
-        update_access_smt.Reset(true);
-        update_access_smt.BindInt64(0,
-            po->cc().LastAccessDate().ToInternalValue());
-        update_access_smt.BindInt64(1,
-            po->cc().CreationDate().ToInternalValue());
-        if (!update_access_smt.Run())
-          NOTREACHED() << "Could not update cookie last access time in the DB.";
+        updates.push_back(po);
         break;
-
       case PendingOperation::COOKIE_DELETE:
-        del_smt.Reset(true);
-        del_smt.BindInt64(0, po->cc().CreationDate().ToInternalValue());
-        if (!del_smt.Run())
-          NOTREACHED() << "Could not delete a cookie from the DB.";
+        deletes.push_back(po);
         break;
-
       default:
         NOTREACHED();
         break;
     }
   }
+  written &= WriteOperations(deletes, adds, updates);
+  // Free the cookies now that they are committed to the database.
+  STLDeleteElements(&ops);
+  if (!written)
+    return;
+
   bool succeeded = transaction.Commit();
   UMA_HISTOGRAM_ENUMERATION("Cookie.BackingStoreUpdateResults",
                             succeeded ? 0 : 1, 2);
 }
 
+bool SQLitePersistentCookieStore::Backend::WriteOperations(
+    const std::vector<PendingOperation*>& deletes,
+    const std::vector<PendingOperation*>& adds,
+    const std::vector<PendingOperation*>& updates) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::DB));
+
+  static const char kAddCookieSql[] =
+      "INSERT INTO cookies (creation_utc, host_key, name, value, path, "
+      "expires_utc, secure, httponly, last_access_utc, has_expires, "
+      "persistent) ";
+  static const char kAddCookieValuesSql[] = "SELECT ?,?,?,?,?,?,?,?,?,?,?";
+  static const int kAddCookieColumns = 11;
+
+  size_t i = 0;
+  if (deletes.size() >= kCookiesPerStatement) {
+    std::string sql("DELETE FROM cookies WHERE creation_utc IN (?");
+    for (size_t j = 1; j < kCookiesPerStatement; ++j)
+      sql.append(",?");
+    sql.append(")");
+    sql::Statement del_smt(db_->GetCachedStatement(SQL_FROM_HERE,
+                                                   sql.c_str()));
+    if (!del_smt.is_valid())
+      return false;
+    for (; i + kCookiesPerStatement <= deletes.size();
+         i += kCookiesPerStatement) {
+      del_smt.Reset(true);
+      for (size_t j = 0; j < kCookiesPerStatement; ++j) {
+        del_smt.BindInt64(static_cast<int>(j),
+            deletes[i + j]->cc().CreationDate().ToInternalValue());
+      }
+      if (!del_smt.Run())
+        NOTREACHED() << "Could not delete cookies from the DB.";
+    }
+  }
+  if (i < deletes.size()) {
+    sql::Statement del_smt(db_->GetCachedStatement(SQL_FROM_HERE,
+                           "DELETE FROM cookies WHERE creation_utc=?"));
+    if (!del_smt.is_valid())
+      return false;
+    for (; i < deletes.size(); ++i) {
+      del_smt.Reset(true);
+      del_smt.BindInt64(0, deletes[i]->cc().CreationDate().ToInternalValue());
+      if (!del_smt.Run())
+        NOTREACHED() << "Could not delete a cookie from the DB.";
+    }
+  }
+
+  // SQLite doesn't support multiple rows in VALUES before 3.7.11, so the
+  // multi-row insert selects each row instead.
+  i = 0;
+  if (adds.size() >= kCookiesPerStatement) {
+    std::string sql(kAddCookieSql);
+    sql.append(kAddCookieValuesSql);
+    for (size_t j = 1; j < kCookiesPerStatement; ++j) {
+      sql.append(" UNION ALL ");
+      sql.append(kAddCookieValuesSql);
+    }
+    sql::Statement add_smt(db_->GetCachedStatement(SQL_FROM_HERE,
+                                                   sql.c_str()));
+    if (!add_smt.is_valid())
+      return false;
+    for (; i + kCookiesPerStatement <= adds.size();
+         i += kCookiesPerStatement) {
+      add_smt.Reset(true);
+      for (size_t j = 0; j < kCookiesPerStatement; ++j)
+        BindAddCookie(&add_smt, static_cast<int>(j) * kAddCookieColumns,
+                      adds[i + j]->cc());
+      if (!add_smt.Run())
+        NOTREACHED() << "Could not add cookies to the DB.";
+    }
+  }
+  if (i < adds.size()) {
+    std::string sql(kAddCookieSql);
+    sql.append("VALUES (?,?,?,?,?,?,?,?,?,?,?)");
+    sql::Statement add_smt(db_->GetCachedStatement(SQL_FROM_HERE,
+                                                   sql.c_str()));
+    if (!add_smt.is_valid())
+      return false;
+    for (; i < adds.size(); ++i) {
+      add_smt.Reset(true);
+      BindAddCookie(&add_smt, 0, adds[i]->cc());
+      if (!add_smt.Run())
+        NOTREACHED() << "Could not add a cookie to the DB.";
+    }
+  }
+
+  if (!updates.empty()) {
+    sql::Statement update_access_smt(db_->GetCachedStatement(SQL_FROM_HERE,
+        "UPDATE cookies SET last_access_utc=? WHERE creation_utc=?"));
+    if (!update_access_smt.is_valid())
+      return false;
+    for (i = 0; i < updates.size(); ++i) {
+      update_access_smt.Reset(true);
+      update_access_smt.BindInt64(0,
+          updates[i]->cc().LastAccessDate().ToInternalValue());
+      update_access_smt.BindInt64(1,
+          updates[i]->cc().CreationDate().ToInternalValue());
+      if (!update_access_smt.Run())
+        NOTREACHED() << "Could not update cookie last access time in the DB.";
+    }
+  }
+  return true;
+}
+
 void SQLitePersistentCookieStore::Backend::Flush(
     const base::Closure& callback) {
   DCHECK(!BrowserThread::CurrentlyOn(BrowserThread::DB));
@@ -6,6 +6,7 @@
 #include "base/message_loop.h"
 #include "base/perftimer.h"
 #include "base/scoped_temp_dir.h"
+#include "base/stl_util.h"
 #include "base/stringprintf.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/test/thread_test_helper.h"
@@ -49,7 +50,7 @@ class SQLitePersistentCookieStorePerfTest : public testing::Test {
     io_thread_.Start();
     ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
     store_ = new SQLitePersistentCookieStore(
-      temp_dir_.path().Append(chrome::kCookieFilename));
+      temp_dir_.path().Append(chrome::kCookieFilename), false);
     std::vector<net::CookieMonster::CanonicalCookie*> cookies;
     Load();
     ASSERT_EQ(0u, cookies_.size());
@@ -64,7 +65,7 @@ class SQLitePersistentCookieStorePerfTest : public testing::Test {
           net::CookieMonster::CanonicalCookie(gurl,
             base::StringPrintf("Cookie_%d", cookie_num), "1",
             domain_name, "/", std::string(), std::string(),
-            t, t, t, false, false, true));
+            t, t, t, false, false, true, true));
       }
     }
     // Replace the store effectively destroying the current one and forcing it
@@ -77,7 +78,7 @@ class SQLitePersistentCookieStorePerfTest : public testing::Test {
     ASSERT_TRUE(helper->Run());
 
     store_ = new SQLitePersistentCookieStore(
-      temp_dir_.path().Append(chrome::kCookieFilename));
+      temp_dir_.path().Append(chrome::kCookieFilename), false);
   }
 
  protected:
@@ -114,3 +115,40 @@ TEST_F(SQLitePersistentCookieStorePerfTest, TestLoadPerformance) {
 
   ASSERT_EQ(15000U, cookies_.size());
 }
+
+// Test the performance of committing a batch where busy cookies are touched
+// many times, as happens when sites are reloaded; only the last access time of
+// each cookie has to be written.
+TEST_F(SQLitePersistentCookieStorePerfTest, TestCommitPerformance) {
+  Load();
+  ASSERT_EQ(15000U, cookies_.size());
+
+  PerfTimeLogger timer("Commit repeated access time updates");
+  base::Time t = base::Time::Now();
+  for (int round = 0; round < 10; ++round) {
+    t += base::TimeDelta::FromMinutes(1);
+    for (size_t i = 0; i < cookies_.size(); ++i) {
+      cookies_[i]->SetLastAccessDate(t);
+      store_->UpdateCookieAccessTime(*cookies_[i]);
+    }
+  }
+  store_->Flush(base::Closure());
+  scoped_refptr<base::ThreadTestHelper> helper(
+      new base::ThreadTestHelper(
+          BrowserThread::GetMessageLoopProxyForThread(BrowserThread::DB)));
+  ASSERT_TRUE(helper->Run());
+  timer.Done();
+
+  // Deleting and adding the same cookies again goes through the multi-row
+  // statements.
+  PerfTimeLogger timer2("Commit deleted and added cookies");
+  for (size_t i = 0; i < cookies_.size(); ++i) {
+    store_->DeleteCookie(*cookies_[i]);
+    store_->AddCookie(*cookies_[i]);
+  }
+  store_->Flush(base::Closure());
+  ASSERT_TRUE(helper->Run());
+  timer2.Done();
+
+  STLDeleteElements(&cookies_);
+}
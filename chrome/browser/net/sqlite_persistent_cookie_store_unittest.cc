@@ -9,6 +9,7 @@
 #include "base/message_loop.h"
 #include "base/scoped_temp_dir.h"
 #include "base/stl_util.h"
+#include "base/stringprintf.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/test/thread_test_helper.h"
 #include "base/time.h"
@@ -208,6 +209,66 @@ TEST_F(SQLitePersistentCookieStoreTest, TestPersistance) {
   ASSERT_EQ(0U, cookies.size());
 }
 
+// Test that operations on the same cookie within a batch are merged, and that
+// the multi-row statements write the same rows as single operations would.
+TEST_F(SQLitePersistentCookieStoreTest, TestCoalescedOperations) {
+  InitializeStore(false);
+  base::Time t = base::Time::Now();
+  base::Time later = t + base::TimeDelta::FromMinutes(10);
+
+  // Enough cookies for a few multi-row statements and some single rows.
+  const int kNumCookies = 75;
+  std::vector<net::CookieMonster::CanonicalCookie> cookies;
+  for (int i = 0; i < kNumCookies; ++i) {
+    base::Time creation = t + base::TimeDelta::FromMicroseconds(i);
+    cookies.push_back(net::CookieMonster::CanonicalCookie(
+        GURL(), base::StringPrintf("C%d", i), "V", "http://foo.bar", "/",
+        std::string(), std::string(), creation, creation, creation,
+        false, false, true, true));
+    store_->AddCookie(cookies.back());
+  }
+  // Added and deleted in the same batch: never written.
+  for (int i = 0; i < 5; ++i)
+    store_->DeleteCookie(cookies[i]);
+  // Added and updated in the same batch: written with the newest access time.
+  for (int i = 5; i < 10; ++i) {
+    net::CookieMonster::CanonicalCookie updated(cookies[i]);
+    updated.SetLastAccessDate(later);
+    store_->UpdateCookieAccessTime(updated);
+  }
+  store_->Flush(base::Closure());
+
+  // In the next batch, updated and then deleted, or deleted and added again.
+  for (int i = 10; i < 15; ++i) {
+    net::CookieMonster::CanonicalCookie updated(cookies[i]);
+    updated.SetLastAccessDate(later);
+    store_->UpdateCookieAccessTime(updated);
+    store_->DeleteCookie(updated);
+  }
+  for (int i = 15; i < 55; ++i) {
+    store_->DeleteCookie(cookies[i]);
+    store_->AddCookie(cookies[i]);
+  }
+  DestroyStore();
+
+  std::vector<net::CookieMonster::CanonicalCookie*> loaded;
+  CreateAndLoad(false, &loaded);
+  ASSERT_EQ(static_cast<size_t>(kNumCookies - 10), loaded.size());
+  std::set<std::string> names;
+  for (size_t i = 0; i < loaded.size(); ++i) {
+    names.insert(loaded[i]->Name());
+    if (loaded[i]->CreationDate() < t + base::TimeDelta::FromMicroseconds(10))
+      EXPECT_TRUE(later == loaded[i]->LastAccessDate());
+    else
+      EXPECT_TRUE(loaded[i]->CreationDate() == loaded[i]->LastAccessDate());
+  }
+  for (int i = 0; i < kNumCookies; ++i) {
+    bool expected = i >= 15 || (i >= 5 && i < 10);
+    EXPECT_EQ(expected, names.count(base::StringPrintf("C%d", i)) == 1) << i;
+  }
+  STLDeleteContainerPointers(loaded.begin(), loaded.end());
+}
+
 // Test that priority load of cookies for a specfic domain key could be
 // completed before the entire store is loaded
 TEST_F(SQLitePersistentCookieStoreTest, TestLoadCookiesForKey) {
@@ -255,6 +316,9 @@ TEST_F(SQLitePersistentCookieStoreTest, TestLoadCookiesForKey) {
        it = cookies_.begin(); it != cookies_.end(); ++it)
     cookies_loaded.insert((*it)->Domain().c_str());
   ASSERT_GT(4U, cookies_loaded.size());
+  // Only the cookies of the requested key are handed over; the ones of the
+  // background load wait for its completion.
+  ASSERT_EQ(2U, cookies_.size());
   ASSERT_EQ(cookies_loaded.find("www.aaa.com") != cookies_loaded.end(), true);
   ASSERT_EQ(cookies_loaded.find("travel.aaa.com") != cookies_loaded.end(),
             true);
@@ -17,28 +17,33 @@
 #include "base/string16.h"
 #include "base/string_number_conversions.h"
 #include "base/synchronization/lock.h"
+#include "base/sys_info.h"
 #include "base/threading/thread.h"
 #include "base/timer.h"
 #include "base/utf_string_conversions.h"
 #include "build/build_config.h"
 #include "chrome/browser/browser_process.h"
-#include "chrome/browser/low_memory_observer.h"
 #include "chrome/browser/memory_details.h"
+#include "chrome/browser/memory_purger.h"
 #include "chrome/browser/tabs/tab_strip_model.h"
 #include "chrome/browser/ui/browser_list.h"
 #include "chrome/browser/ui/tab_contents/tab_contents_wrapper.h"
 #include "chrome/common/chrome_constants.h"
 #include "chrome/common/chrome_switches.h"
+#include "content/public/browser/browser_child_process_host.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/notification_service.h"
 #include "content/public/browser/notification_types.h"
 #include "content/public/browser/render_process_host.h"
 #include "content/public/browser/render_widget_host.h"
 #include "content/public/browser/web_contents.h"
-#include "content/public/browser/zygote_host_linux.h"
 
-#if !defined(OS_CHROMEOS)
-#error This file only meant to be compiled on ChromeOS
+#if defined(OS_CHROMEOS)
+#include "chrome/browser/low_memory_observer.h"
+#endif
+
+#if defined(OS_LINUX)
+#include "content/public/browser/zygote_host_linux.h"
 #endif
 
 using base::ProcessHandle;
@@ -84,6 +89,10 @@ const int kSuspendThresholdSeconds = kAdjustmentIntervalSeconds * 4;
 // currently focused tab.
 const int kFocusedTabScoreAdjustIntervalMs = 500;
 
+// Share of physical memory the renderers may use privately before memory
+// is reclaimed from them.
+const int kRendererMemoryThresholdPercent = 60;
+
 // Returns a unique ID for a WebContents.  Do not cast back to a pointer, as
 // the WebContents could be deleted if the user closed the tab.
 int64 IdFromTabContents(WebContents* web_contents) {
@@ -135,6 +144,7 @@ void OomMemoryDetails::OnDetailsAvailable() {
 OomPriorityManager::TabStats::TabStats()
   : is_pinned(false),
     is_selected(false),
+    restore_count(0),
     renderer_handle(0),
     sudden_termination_allowed(false),
     tab_contents_id(0) {
@@ -145,10 +155,18 @@ OomPriorityManager::TabStats::~TabStats() {
 
 OomPriorityManager::OomPriorityManager()
     : focused_tab_pid_(0),
+      discard_enabled_(true),
+      memory_threshold_mb_(base::SysInfo::AmountOfPhysicalMemoryMB() *
+                           kRendererMemoryThresholdPercent / 100),
+      reclaim_level_(RECLAIM_NONE),
       discard_count_(0) {
+#if defined(OS_CHROMEOS)
+  discard_enabled_ =
+      !CommandLine::ForCurrentProcess()->HasSwitch(switches::kNoDiscardTabs);
   // We only need the low memory observer if we want to discard tabs.
-  if (!CommandLine::ForCurrentProcess()->HasSwitch(switches::kNoDiscardTabs))
+  if (discard_enabled_)
     low_memory_observer_.reset(new LowMemoryObserver);
+#endif
 
   registrar_.Add(this,
       content::NOTIFICATION_RENDERER_PROCESS_CLOSED,
@@ -172,15 +190,19 @@ void OomPriorityManager::Start() {
                  this,
                  &OomPriorityManager::AdjustOomPriorities);
   }
+#if defined(OS_CHROMEOS)
   if (low_memory_observer_.get())
     low_memory_observer_->Start();
+#endif
   start_time_ = TimeTicks::Now();
 }
 
 void OomPriorityManager::Stop() {
   timer_.Stop();
+#if defined(OS_CHROMEOS)
   if (low_memory_observer_.get())
     low_memory_observer_->Stop();
+#endif
 }
 
 std::vector<string16> OomPriorityManager::GetTabTitles() {
@@ -242,7 +264,16 @@ bool OomPriorityManager::DiscardTabById(int64 target_web_contents_id) {
         // Record statistics before discarding because we want to capture the
         // memory state that lead to the discard.
         RecordDiscardStatistics();
-        model->DiscardTabContentsAt(idx);
+        TabContentsWrapper* null_contents = model->DiscardTabContentsAt(idx);
+        int64 null_contents_id =
+            IdFromTabContents(null_contents->web_contents());
+        discarded_tab_ids_.insert(null_contents_id);
+        std::map<int64, int>::iterator count =
+            restore_counts_.find(web_contents_id);
+        if (count != restore_counts_.end()) {
+          restore_counts_[null_contents_id] = count->second;
+          restore_counts_.erase(count);
+        }
         return true;
       }
     }
@@ -311,6 +342,11 @@ bool OomPriorityManager::CompareTabStats(TabStats first,
   if (first.is_pinned != second.is_pinned)
     return first.is_pinned == true;
 
+  // Tabs the user went back to after a discard cost a reload each time,
+  // so discard them last.
+  if (first.restore_count != second.restore_count)
+    return first.restore_count > second.restore_count;
+
   // TODO(jamescook): Incorporate sudden_termination_allowed into the sort
   // order.  We don't do this now because pages with unload handlers set
   // sudden_termination_allowed false, and that covers too many common pages
@@ -324,10 +360,12 @@ bool OomPriorityManager::CompareTabStats(TabStats first,
 
 void OomPriorityManager::AdjustFocusedTabScoreOnFileThread() {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
+#if defined(OS_LINUX)
   base::AutoLock pid_to_oom_score_autolock(pid_to_oom_score_lock_);
   content::ZygoteHost::GetInstance()->AdjustRendererOOMScore(
       focused_tab_pid_, chrome::kLowestRendererOomScore);
   pid_to_oom_score_[focused_tab_pid_] = chrome::kLowestRendererOomScore;
+#endif
 }
 
 void OomPriorityManager::OnFocusTabScoreAdjustmentTimeout() {
@@ -426,26 +464,52 @@ OomPriorityManager::TabStatsList OomPriorityManager::GetTabStatsOnUIThread() {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
   TabStatsList stats_list;
   stats_list.reserve(32);  // 99% of users have < 30 tabs open
+  std::set<int64> open_tab_ids;
   for (BrowserList::const_iterator browser_iterator = BrowserList::begin();
        browser_iterator != BrowserList::end(); ++browser_iterator) {
     Browser* browser = *browser_iterator;
     const TabStripModel* model = browser->tabstrip_model();
     for (int i = 0; i < model->count(); i++) {
       WebContents* contents = model->GetTabContentsAt(i)->web_contents();
+      int64 contents_id = IdFromTabContents(contents);
+      open_tab_ids.insert(contents_id);
+      // Selecting a discarded tab reloads it in place.
+      if (!model->IsTabDiscarded(i) && discarded_tab_ids_.erase(contents_id))
+        ++restore_counts_[contents_id];
       if (!contents->IsCrashed()) {
         TabStats stats;
         stats.is_pinned = model->IsTabPinned(i);
         stats.is_selected = model->IsTabSelected(i);
+        std::map<int64, int>::const_iterator count =
+            restore_counts_.find(contents_id);
+        if (count != restore_counts_.end())
+          stats.restore_count = count->second;
         stats.last_selected = contents->GetLastSelectedTime();
         stats.renderer_handle = contents->GetRenderProcessHost()->GetHandle();
         stats.sudden_termination_allowed =
             contents->GetRenderProcessHost()->SuddenTerminationAllowed();
         stats.title = contents->GetTitle();
-        stats.tab_contents_id = IdFromTabContents(contents);
+        stats.tab_contents_id = contents_id;
         stats_list.push_back(stats);
       }
     }
   }
+
+  // Forget closed tabs, whose IDs may be reused.
+  for (std::set<int64>::iterator it = discarded_tab_ids_.begin();
+       it != discarded_tab_ids_.end();) {
+    if (open_tab_ids.count(*it))
+      ++it;
+    else
+      discarded_tab_ids_.erase(it++);
+  }
+  for (std::map<int64, int>::iterator it = restore_counts_.begin();
+       it != restore_counts_.end();) {
+    if (open_tab_ids.count(it->first))
+      ++it;
+    else
+      restore_counts_.erase(it++);
+  }
   // Sort the data we collected so that least desirable to be
   // killed is first, most desirable is last.
   std::sort(stats_list.begin(), stats_list.end(), CompareTabStats);
@@ -455,6 +519,15 @@ OomPriorityManager::TabStatsList OomPriorityManager::GetTabStatsOnUIThread() {
 void OomPriorityManager::AdjustOomPrioritiesOnFileThread(
     TabStatsList stats_list) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
+  if (discard_enabled_) {
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(&OomPriorityManager::OnRendererMemoryMeasured,
+                   base::Unretained(this),
+                   GetRendererPrivateMemoryMB(stats_list)));
+  }
+
+#if defined(OS_LINUX)
   base::AutoLock pid_to_oom_score_autolock(pid_to_oom_score_lock_);
 
   // Now we assign priorities based on the sorted list.  We're
@@ -496,6 +569,80 @@ void OomPriorityManager::AdjustOomPrioritiesOnFileThread(
       priority += priority_increment;
     }
   }
+#endif  // defined(OS_LINUX)
+}
+
+// static
+int OomPriorityManager::GetRendererPrivateMemoryMB(
+    const TabStatsList& stats_list) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
+  std::set<base::ProcessHandle> already_seen;
+  size_t private_kb = 0;
+  for (TabStatsList::const_iterator it = stats_list.begin();
+       it != stats_list.end(); ++it) {
+    // Discarded tabs have no renderer.
+    if (!it->renderer_handle ||
+        !already_seen.insert(it->renderer_handle).second) {
+      continue;
+    }
+    scoped_ptr<ProcessMetrics> metrics(
+#if !defined(OS_MACOSX)
+        ProcessMetrics::CreateProcessMetrics(it->renderer_handle));
+#else
+        ProcessMetrics::CreateProcessMetrics(
+            it->renderer_handle,
+            content::BrowserChildProcessHost::GetPortProvider()));
+#endif
+    base::WorkingSetKBytes working_set;
+    if (metrics->GetWorkingSetKBytes(&working_set))
+      private_kb += working_set.priv;
+  }
+  return static_cast<int>(private_kb / 1024);
+}
+
+void OomPriorityManager::OnRendererMemoryMeasured(int private_memory_mb) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  UMA_HISTOGRAM_MEMORY_MB("Tabs.Discard.RendererPrivateMemoryMB",
+                          private_memory_mb);
+
+  reclaim_level_ = NextReclaimLevel(
+      reclaim_level_, private_memory_mb > memory_threshold_mb_);
+  switch (reclaim_level_) {
+    case RECLAIM_NONE:
+      break;
+    case RECLAIM_PURGE_CACHES:
+      LOG(WARNING) << "Renderers use " << private_memory_mb
+                   << " MB, purging their caches";
+      MemoryPurger::PurgeRenderers();
+      break;
+    case RECLAIM_DROP_BACKING_STORES:
+      LOG(WARNING) << "Renderers use " << private_memory_mb
+                   << " MB, dropping backing stores";
+      content::RenderWidgetHost::RemoveAllBackingStores();
+      break;
+    case RECLAIM_DISCARD_TABS:
+      DiscardTab();
+      break;
+  }
+}
+
+// static
+OomPriorityManager::ReclaimLevel OomPriorityManager::NextReclaimLevel(
+    ReclaimLevel level,
+    bool over_threshold) {
+  if (!over_threshold)
+    return RECLAIM_NONE;
+  switch (level) {
+    case RECLAIM_NONE:
+      return RECLAIM_PURGE_CACHES;
+    case RECLAIM_PURGE_CACHES:
+      return RECLAIM_DROP_BACKING_STORES;
+    case RECLAIM_DROP_BACKING_STORES:
+    case RECLAIM_DISCARD_TABS:
+      return RECLAIM_DISCARD_TABS;
+  }
+  NOTREACHED();
+  return RECLAIM_NONE;
 }
 
 }  // namespace browser
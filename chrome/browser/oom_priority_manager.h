@@ -6,6 +6,8 @@
 #ifndef CHROME_BROWSER_OOM_PRIORITY_MANAGER_H_
 #define CHROME_BROWSER_OOM_PRIORITY_MANAGER_H_
 
+#include <map>
+#include <set>
 #include <vector>
 
 #include "base/compiler_specific.h"
@@ -26,13 +28,20 @@ class LowMemoryObserver;
 
 // The OomPriorityManager periodically checks (see
 // ADJUSTMENT_INTERVAL_SECONDS in the source) the status of renderers
-// and adjusts the out of memory (OOM) adjustment value (in
+// and, on Linux, adjusts the out of memory (OOM) adjustment value (in
 // /proc/<pid>/oom_score_adj) of the renderers so that they match the
 // algorithm embedded here for priority in being killed upon OOM
 // conditions.
 //
 // The algorithm used favors killing tabs that are not selected, not pinned,
-// and have been idle for longest, in that order of priority.
+// have not been reloaded after an earlier discard, and have been idle for
+// longest, in that order of priority.
+//
+// Each check also adds up the private memory of the renderers. While that
+// is over a share of physical memory, every check reclaims a bit more:
+// first it purges the renderers' caches, then it drops the backing stores,
+// then it discards one tab per check. On Chrome OS the kernel's low memory
+// signal also discards a tab.
 class OomPriorityManager : public content::NotificationObserver {
  public:
   OomPriorityManager();
@@ -57,12 +66,25 @@ class OomPriorityManager : public content::NotificationObserver {
 
  private:
   FRIEND_TEST_ALL_PREFIXES(OomPriorityManagerTest, Comparator);
+  FRIEND_TEST_ALL_PREFIXES(OomPriorityManagerTest, ComparatorRestoreCount);
+  FRIEND_TEST_ALL_PREFIXES(OomPriorityManagerTest, ReclaimsGradually);
+
+  // How far reclamation has gone while the renderers stay over the memory
+  // threshold.
+  enum ReclaimLevel {
+    RECLAIM_NONE,
+    RECLAIM_PURGE_CACHES,
+    RECLAIM_DROP_BACKING_STORES,
+    RECLAIM_DISCARD_TABS,
+  };
 
   struct TabStats {
     TabStats();
     ~TabStats();
     bool is_pinned;
     bool is_selected;
+    // Number of times the tab was discarded and then reloaded by the user.
+    int restore_count;
     base::TimeTicks last_selected;
     base::ProcessHandle renderer_handle;
     bool sudden_termination_allowed;
@@ -90,6 +112,17 @@ class OomPriorityManager : public content::NotificationObserver {
   // Called by AdjustOomPriorities.
   void AdjustOomPrioritiesOnFileThread(TabStatsList stats_list);
 
+  // Returns the total private memory of the renderers in |stats_list|.
+  static int GetRendererPrivateMemoryMB(const TabStatsList& stats_list);
+
+  // Takes the next reclamation step if |private_memory_mb| is over the
+  // threshold, or resets the steps if it is not.
+  void OnRendererMemoryMeasured(int private_memory_mb);
+
+  // Returns the step to take next, given the step taken last.
+  static ReclaimLevel NextReclaimLevel(ReclaimLevel level,
+                                       bool over_threshold);
+
   // Posts AdjustFocusedTabScore task to the file thread.
   void OnFocusTabScoreAdjustmentTimeout();
 
@@ -113,9 +146,24 @@ class OomPriorityManager : public content::NotificationObserver {
   ProcessScoreMap pid_to_oom_score_;
   base::ProcessHandle focused_tab_pid_;
 
+  // False if tab discarding is disabled.
+  bool discard_enabled_;
+
+#if defined(OS_CHROMEOS)
   // Observer for the kernel low memory signal.  NULL if tab discarding is
   // disabled.
   scoped_ptr<LowMemoryObserver> low_memory_observer_;
+#endif
+
+  // Renderer private memory above which memory is reclaimed.
+  int memory_threshold_mb_;
+  ReclaimLevel reclaim_level_;
+
+  // IDs of the tabs we discarded that have not been reloaded yet, and the
+  // number of times each tab was reloaded after a discard. A discarded tab
+  // keeps its restore count under the ID of its replacement contents.
+  std::set<int64> discarded_tab_ids_;
+  std::map<int64, int> restore_counts_;
 
   // Wall-clock time when the priority manager started running.
   base::TimeTicks start_time_;
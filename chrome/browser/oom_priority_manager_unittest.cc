@@ -116,4 +116,41 @@ TEST_F(OomPriorityManagerTest, Comparator) {
   EXPECT_EQ(test_list[6].renderer_handle, kReallyOld);
 }
 
+// Tests that a tab reloaded after a discard ranks above tabs that were used
+// more recently, but not above selected or pinned tabs.
+TEST_F(OomPriorityManagerTest, ComparatorRestoreCount) {
+  const base::TimeTicks now = base::TimeTicks::Now();
+
+  OomPriorityManager::TabStats recent;
+  recent.last_selected = now;
+
+  OomPriorityManager::TabStats restored;
+  restored.last_selected = now - base::TimeDelta::FromDays(1);
+  restored.restore_count = 1;
+
+  OomPriorityManager::TabStats pinned;
+  pinned.is_pinned = true;
+  pinned.last_selected = now - base::TimeDelta::FromDays(2);
+
+  EXPECT_TRUE(OomPriorityManager::CompareTabStats(restored, recent));
+  EXPECT_FALSE(OomPriorityManager::CompareTabStats(recent, restored));
+  EXPECT_TRUE(OomPriorityManager::CompareTabStats(pinned, restored));
+}
+
+// Tests that each check over the threshold takes the next reclamation step,
+// and that dropping below the threshold starts over.
+TEST_F(OomPriorityManagerTest, ReclaimsGradually) {
+  OomPriorityManager::ReclaimLevel level = OomPriorityManager::RECLAIM_NONE;
+  level = OomPriorityManager::NextReclaimLevel(level, true);
+  EXPECT_EQ(OomPriorityManager::RECLAIM_PURGE_CACHES, level);
+  level = OomPriorityManager::NextReclaimLevel(level, true);
+  EXPECT_EQ(OomPriorityManager::RECLAIM_DROP_BACKING_STORES, level);
+  level = OomPriorityManager::NextReclaimLevel(level, true);
+  EXPECT_EQ(OomPriorityManager::RECLAIM_DISCARD_TABS, level);
+  level = OomPriorityManager::NextReclaimLevel(level, true);
+  EXPECT_EQ(OomPriorityManager::RECLAIM_DISCARD_TABS, level);
+  level = OomPriorityManager::NextReclaimLevel(level, false);
+  EXPECT_EQ(OomPriorityManager::RECLAIM_NONE, level);
+}
+
 }  // namespace browser
@@ -4,7 +4,6 @@
 
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop.h"
-#include "base/stl_util.h"
 #include "chrome/browser/policy/cloud_policy_constants.h"
 #include "chrome/browser/policy/device_management_service.h"
 #include "chrome/test/base/in_process_browser_test.h"
@@ -50,7 +49,9 @@ class CannedResponseInterceptor : public net::URLRequest::Interceptor {
         upload != NULL &&
         upload->elements()->size() == 1) {
       std::string response_data;
-      ConstructResponse(upload->elements()->at(0).bytes(), &response_data);
+      const net::UploadData::Element& element = upload->elements()->at(0);
+      ConstructResponse(element.bytes(), element.bytes_length(),
+                        &response_data);
       return new net::URLRequestTestJob(request,
                                         net::URLRequestTestJob::test_headers(),
                                         response_data,
@@ -61,11 +62,12 @@ class CannedResponseInterceptor : public net::URLRequest::Interceptor {
   }
 
  private:
-  void ConstructResponse(const std::vector<char>& request_data,
+  void ConstructResponse(const char* request_data,
+                         uint64 request_data_length,
                          std::string* response_data) {
     em::DeviceManagementRequest request;
-    ASSERT_TRUE(request.ParseFromArray(vector_as_array(&request_data),
-                                       request_data.size()));
+    ASSERT_TRUE(request.ParseFromArray(request_data,
+                                       static_cast<int>(request_data_length)));
     em::DeviceManagementResponse response;
     if (request.has_register_request()) {
       response.mutable_register_response()->set_device_management_token(
@@ -17,6 +17,10 @@ struct Config {
   // Maximum memory use for a prerendered page until it is killed.
   size_t max_bytes;
 
+  // Maximum CPU time the renderer of a prerendered page may use until it is
+  // killed.
+  base::TimeDelta max_cpu_time;
+
   // Number of simultaneous prendered pages allowed.
   unsigned int max_elements;
 
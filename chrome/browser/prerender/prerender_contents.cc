@@ -249,6 +249,7 @@ PrerenderContents::PrerenderContents(
       prerendering_has_started_(false),
       match_complete_status_(MATCH_COMPLETE_DEFAULT),
       prerendering_has_been_cancelled_(false),
+      peak_private_bytes_(0),
       child_id_(-1),
       route_id_(-1),
       origin_(origin),
@@ -400,6 +401,11 @@ PrerenderContents::~PrerenderContents() {
       experiment_id_,
       match_complete_status_,
       final_status_);
+  if (process_metrics_.get()) {
+    prerender_manager_->RecordResourceUsage(
+        origin_, experiment_id_, final_status_ == FINAL_STATUS_USED,
+        cpu_time_, peak_private_bytes_);
+  }
 
   if (child_id_ != -1 && route_id_ != -1) {
     prerender_tracker_->OnPrerenderingFinished(child_id_, route_id_);
@@ -656,11 +662,27 @@ void PrerenderContents::DestroyWhenUsingTooManyResources() {
   if (metrics == NULL)
     return;
 
+  // GetCPUUsage() returns the percentage of one core used since it was last
+  // called, so the first sample only starts the measurement.
+  base::TimeTicks now = base::TimeTicks::Now();
+  double cpu_usage = metrics->GetCPUUsage();
+  if (!last_resource_check_time_.is_null()) {
+    cpu_time_ += base::TimeDelta::FromMicroseconds(static_cast<int64>(
+        (now - last_resource_check_time_).InMicroseconds() * cpu_usage / 100));
+  }
+  last_resource_check_time_ = now;
+
   size_t private_bytes, shared_bytes;
-  if (metrics->GetMemoryBytes(&private_bytes, &shared_bytes) &&
-      private_bytes > prerender_manager_->config().max_bytes) {
+  if (metrics->GetMemoryBytes(&private_bytes, &shared_bytes)) {
+    peak_private_bytes_ = std::max(peak_private_bytes_, private_bytes);
+    if (private_bytes > prerender_manager_->config().max_bytes) {
       Destroy(FINAL_STATUS_MEMORY_LIMIT_EXCEEDED);
+      return;
+    }
   }
+
+  if (cpu_time_ > prerender_manager_->config().max_cpu_time)
+    Destroy(FINAL_STATUS_CPU_LIMIT_EXCEEDED);
 }
 
 TabContentsWrapper* PrerenderContents::ReleasePrerenderContents() {
@@ -106,8 +106,8 @@ class PrerenderContents : public content::NotificationObserver,
       const content::RenderViewHost* source_render_view_host,
       content::SessionStorageNamespace* session_storage_namespace);
 
-  // Verifies that the prerendering is not using too many resources, and kills
-  // it if not.
+  // Verifies that the prerendering is not using too much memory or CPU time,
+  // and kills it if not.
   void DestroyWhenUsingTooManyResources();
 
   content::RenderViewHost* GetRenderViewHostMutable();
@@ -319,6 +319,12 @@ class PrerenderContents : public content::NotificationObserver,
   // RenderViewHost for this object.
   scoped_ptr<base::ProcessMetrics> process_metrics_;
 
+  // Resources used by the render process so far, as sampled by
+  // DestroyWhenUsingTooManyResources(), and when they were last sampled.
+  base::TimeDelta cpu_time_;
+  size_t peak_private_bytes_;
+  base::TimeTicks last_resource_check_time_;
+
   // The prerendered TabContentsWrapper; may be null.
   scoped_ptr<TabContentsWrapper> prerender_contents_;
 
@@ -53,6 +53,7 @@ const char* kFinalStatusNames[] = {
   "Duplicate",
   "OpenURL",
   "WouldHaveBeenUsed",
+  "CPU Limit Exceeded",
   "Max",
 };
 COMPILE_ASSERT(arraysize(kFinalStatusNames) == FINAL_STATUS_MAX + 1,
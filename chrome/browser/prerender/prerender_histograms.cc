@@ -355,6 +355,31 @@ void PrerenderHistograms::RecordFinalStatus(
   }
 }
 
+void PrerenderHistograms::RecordResourceUsage(Origin origin,
+                                              uint8 experiment_id,
+                                              bool was_used,
+                                              base::TimeDelta cpu_time,
+                                              size_t peak_private_bytes) const {
+  int peak_private_mb = static_cast<int>(peak_private_bytes / (1024 * 1024));
+  // Each histogram needs its own call site, as the macros cache the histogram
+  // they first record to.
+  if (was_used) {
+    PREFIXED_HISTOGRAM_ORIGIN_EXPERIMENT(
+        "CpuTimeUsed", origin, experiment_id,
+        UMA_HISTOGRAM_TIMES(name, cpu_time));
+    PREFIXED_HISTOGRAM_ORIGIN_EXPERIMENT(
+        "PeakPrivateMemoryUsed", origin, experiment_id,
+        UMA_HISTOGRAM_MEMORY_MB(name, peak_private_mb));
+  } else {
+    PREFIXED_HISTOGRAM_ORIGIN_EXPERIMENT(
+        "CpuTimeNotUsed", origin, experiment_id,
+        UMA_HISTOGRAM_TIMES(name, cpu_time));
+    PREFIXED_HISTOGRAM_ORIGIN_EXPERIMENT(
+        "PeakPrivateMemoryNotUsed", origin, experiment_id,
+        UMA_HISTOGRAM_MEMORY_MB(name, peak_private_mb));
+  }
+}
+
 uint8 PrerenderHistograms::GetCurrentExperimentId() const {
   if (!WithinWindow())
     return kNoExperiment;
@@ -63,6 +63,14 @@ class PrerenderHistograms {
                          PrerenderContents::MatchCompleteStatus mc_status,
                          FinalStatus final_status) const;
 
+  // Record the CPU time and peak private memory used by the renderer of a
+  // prerendered page, in separate histograms for used and unused prerenders.
+  void RecordResourceUsage(Origin origin,
+                           uint8 experiment_id,
+                           bool was_used,
+                           base::TimeDelta cpu_time,
+                           size_t peak_private_bytes) const;
+
   // To be called when a new prerender is added.
   void RecordPrerender(Origin origin, const GURL& url);
 
@@ -772,6 +772,15 @@ void PrerenderManager::RecordFinalStatusWithMatchCompleteStatus(
                                  final_status);
 }
 
+void PrerenderManager::RecordResourceUsage(Origin origin,
+                                           uint8 experiment_id,
+                                           bool was_used,
+                                           base::TimeDelta cpu_time,
+                                           size_t peak_private_bytes) const {
+  histograms_->RecordResourceUsage(origin, experiment_id, was_used, cpu_time,
+                                   peak_private_bytes);
+}
+
 void PrerenderManager::AddCondition(const PrerenderCondition* condition) {
   prerender_conditions_.push_back(condition);
 }
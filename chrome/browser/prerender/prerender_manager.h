@@ -216,6 +216,15 @@ class PrerenderManager : public base::SupportsWeakPtr<PrerenderManager>,
       PrerenderContents::MatchCompleteStatus mc_status,
       FinalStatus final_status) const;
 
+  // Records the resources the render process of a prerendered page used,
+  // split by whether the page was swapped in, so that the cost of prerenders
+  // can be weighed against their hit rate.
+  void RecordResourceUsage(Origin origin,
+                           uint8 experiment_id,
+                           bool was_used,
+                           base::TimeDelta cpu_time,
+                           size_t peak_private_bytes) const;
+
   const Config& config() const { return config_; }
   Config& mutable_config() { return config_; }
 
@@ -418,6 +418,9 @@ void ProfileImplIOData::LazyInitializeInternal(
   net::HttpCache* media_cache =
       new net::HttpCache(main_network_session, media_backend);
 
+  main_cache->set_async_revalidation_enabled(
+      command_line.HasSwitch(switches::kEnableStaleWhileRevalidate));
+
   if (record_mode || playback_mode) {
     main_cache->set_mode(
         record_mode ? net::HttpCache::RECORD : net::HttpCache::PLAYBACK);
@@ -19,6 +19,7 @@
 #include "chrome/browser/extensions/extension_process_manager.h"
 #include "chrome/browser/extensions/extension_service.h"
 #include "chrome/browser/extensions/extension_system.h"
+#include "chrome/browser/extensions/message_bundle_cache.h"
 #include "chrome/browser/metrics/histogram_synchronizer.h"
 #include "chrome/browser/nacl_host/nacl_process_host.h"
 #include "chrome/browser/net/chrome_url_request_context.h"
@@ -27,7 +28,6 @@
 #include "chrome/browser/task_manager/task_manager.h"
 #include "chrome/common/chrome_notification_types.h"
 #include "chrome/common/chrome_switches.h"
-#include "chrome/common/extensions/extension_file_util.h"
 #include "chrome/common/extensions/extension_message_bundle.h"
 #include "chrome/common/extensions/extension_messages.h"
 #include "chrome/common/render_messages.h"
@@ -156,7 +156,7 @@ void ChromeRenderMessageFilter::OverrideThreadForMessage(
 void ChromeRenderMessageFilter::OnLaunchNaCl(const GURL& manifest_url,
                                              int socket_count,
                                              IPC::Message* reply_msg) {
-  NaClProcessHost* host = new NaClProcessHost(manifest_url);
+  NaClProcessHost* host = NaClProcessHost::Create(manifest_url);
   host->Launch(this, socket_count, reply_msg, extension_info_map_);
 }
 #endif
@@ -328,7 +328,7 @@ void ChromeRenderMessageFilter::OnGetExtensionMessageBundleOnFileThread(
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
 
   scoped_ptr<ExtensionMessageBundle::SubstitutionMap> dictionary_map(
-      extension_file_util::LoadExtensionMessageBundleSubstitutionMap(
+      extensions::MessageBundleCache::GetInstance()->GetSubstitutionMap(
           extension_path,
           extension_id,
           default_locale));
@@ -1,4 +1,4 @@
-// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
@@ -7,9 +7,11 @@
 #include <algorithm>
 #include <math.h>
 
+#include "base/bits.h"
 #include "base/file_util.h"
 #include "base/logging.h"
 #include "base/md5.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/metrics/histogram.h"
 
 namespace {
@@ -20,19 +22,56 @@ namespace {
 static uint32 kMagic = 0x864088dd;
 
 // Current version the code writes out.
-static uint32 kVersion = 0x1;
+static uint32 kVersion = 0x2;
 
 typedef struct {
   uint32 magic;
   uint32 version;
-  uint32 index_size;
-  uint32 deltas_size;
+  uint32 size;
+  uint32 low_bits;
+  uint32 low_size;
+  uint32 high_size;
 } FileHeader;
 
-// For |std::upper_bound()| to find a prefix w/in a vector of pairs.
-bool PrefixLess(const std::pair<SBPrefix,size_t>& a,
-                const std::pair<SBPrefix,size_t>& b) {
-  return a.first < b.first;
+// |SBPrefix| is signed, flipping the sign bit maps it to an unsigned
+// value with the same ordering.
+const uint32 kSignBit = 0x80000000;
+
+uint32 PrefixToValue(SBPrefix prefix) {
+  return static_cast<uint32>(prefix) ^ kSignBit;
+}
+
+SBPrefix ValueToPrefix(uint32 value) {
+  return static_cast<SBPrefix>(value ^ kSignBit);
+}
+
+// Returns the number of 1 bits in |bits|.
+int CountBits(uint32 bits) {
+  bits = bits - ((bits >> 1) & 0x55555555);
+  bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+  return static_cast<int>((((bits + (bits >> 4)) & 0x0F0F0F0F) *
+                           0x01010101) >> 24);
+}
+
+// Returns the position of the lowest 1 bit in |bits|, which must not
+// be 0.
+int LowestBit(uint32 bits) {
+  DCHECK_NE(bits, 0u);
+  return CountBits((bits & (~bits + 1)) - 1);
+}
+
+// Returns the number of low bits to store for each of |count|
+// prefixes, which minimizes the total size: floor(log2(2^32 / count)).
+int ChooseLowBits(size_t count) {
+  if (count <= 2)
+    return 31;
+  return base::bits::Log2Floor(
+      static_cast<uint32>(GG_UINT64_C(0x100000000) / count));
+}
+
+// The number of 32-bit words needed to hold |bits| bits.
+size_t WordsFor(uint64 bits) {
+  return static_cast<size_t>((bits + 31) / 32);
 }
 
 }  // namespace
@@ -40,127 +79,126 @@ bool PrefixLess(const std::pair<SBPrefix,size_t>& a,
 namespace safe_browsing {
 
 PrefixSet::PrefixSet(const std::vector<SBPrefix>& sorted_prefixes)
-    : checksum_(0) {
+    : size_(0),
+      low_bits_(0),
+      checksum_(0) {
   if (sorted_prefixes.size()) {
-    // Estimate the resulting vector sizes.  There will be strictly
-    // more than |min_runs| entries in |index_|, but there generally
-    // aren't many forced breaks.
-    const size_t min_runs = sorted_prefixes.size() / kMaxRun;
-    index_.reserve(min_runs);
-    deltas_.reserve(sorted_prefixes.size() - min_runs);
-
-    // Lead with the first prefix.
-    SBPrefix prev_prefix = sorted_prefixes[0];
-    size_t run_length = 0;
-    index_.push_back(std::make_pair(prev_prefix, deltas_.size()));
+    size_ = 1;
+    for (size_t i = 1; i < sorted_prefixes.size(); ++i) {
+      // Skip duplicates.
+      if (sorted_prefixes[i] != sorted_prefixes[i - 1])
+        ++size_;
+    }
+    low_bits_ = ChooseLowBits(size_);
+    low_.resize(WordsFor(static_cast<uint64>(size_) * low_bits_));
+    high_.resize(WordsFor(static_cast<uint64>(size_) + BucketCount()));
+
+    const uint32 low_mask = (1u << low_bits_) - 1;
+    size_t index = 0;
+    for (size_t i = 0; i < sorted_prefixes.size(); ++i) {
+      if (i > 0 && sorted_prefixes[i] == sorted_prefixes[i - 1])
+        continue;
+      DCHECK(i == 0 || sorted_prefixes[i] > sorted_prefixes[i - 1]);
+
+      // The prefix is the |index|th 1 bit, |bucket| 0 bits in.
+      const uint32 value = PrefixToValue(sorted_prefixes[i]);
+      const size_t bucket = value >> low_bits_;
+      const size_t high_bit = bucket + index;
+      high_[high_bit / 32] |= 1u << (high_bit % 32);
+
+      // The low bits may straddle two words.
+      const uint32 low = value & low_mask;
+      const uint64 low_bit = static_cast<uint64>(index) * low_bits_;
+      const size_t word = static_cast<size_t>(low_bit / 32);
+      const int shift = static_cast<int>(low_bit % 32);
+      low_[word] |= low << shift;
+      if (shift + low_bits_ > 32)
+        low_[word + 1] |= low >> (32 - shift);
+
+      ++index;
+    }
+    DCHECK_EQ(index, size_);
+    BuildBucketIndex();
 
     // Used to build a checksum from the data used to construct the
     // structures.  Since the data is a bunch of uniform hashes, it
     // seems reasonable to just xor most of it in, rather than trying
     // to use a more complicated algorithm.
-    uint32 checksum = static_cast<uint32>(sorted_prefixes[0]);
-    checksum ^= static_cast<uint32>(deltas_.size());
-
-    for (size_t i = 1; i < sorted_prefixes.size(); ++i) {
-      // Skip duplicates.
-      if (sorted_prefixes[i] == prev_prefix)
-        continue;
-
-      // Calculate the delta.  |unsigned| is mandatory, because the
-      // sorted_prefixes could be more than INT_MAX apart.
-      DCHECK_GT(sorted_prefixes[i], prev_prefix);
-      const unsigned delta = sorted_prefixes[i] - prev_prefix;
-      const uint16 delta16 = static_cast<uint16>(delta);
-
-      // New index ref if the delta doesn't fit, or if too many
-      // consecutive deltas have been encoded.
-      if (delta != static_cast<unsigned>(delta16) || run_length >= kMaxRun) {
-        checksum ^= static_cast<uint32>(sorted_prefixes[i]);
-        checksum ^= static_cast<uint32>(deltas_.size());
-        index_.push_back(std::make_pair(sorted_prefixes[i], deltas_.size()));
-        run_length = 0;
-      } else {
-        checksum ^= static_cast<uint32>(delta16);
-        // Continue the run of deltas.
-        deltas_.push_back(delta16);
-        DCHECK_EQ(static_cast<unsigned>(deltas_.back()), delta);
-        ++run_length;
-      }
-
-      prev_prefix = sorted_prefixes[i];
-    }
+    uint32 checksum = static_cast<uint32>(size_);
+    for (size_t i = 0; i < low_.size(); ++i)
+      checksum ^= low_[i];
+    for (size_t i = 0; i < high_.size(); ++i)
+      checksum ^= high_[i];
     checksum_ = checksum;
     DCHECK(CheckChecksum());
+    DCHECK(CheckEncoding());
 
     // Send up some memory-usage stats.  Bits because fractional bytes
     // are weird.
-    const size_t bits_used = index_.size() * sizeof(index_[0]) * CHAR_BIT +
-        deltas_.size() * sizeof(deltas_[0]) * CHAR_BIT;
-    const size_t unique_prefixes = index_.size() + deltas_.size();
+    const size_t bits_used =
+        (low_.size() + high_.size() + bucket_index_.size()) *
+        sizeof(uint32) * CHAR_BIT;
     static const size_t kMaxBitsPerPrefix = sizeof(SBPrefix) * CHAR_BIT;
     UMA_HISTOGRAM_ENUMERATION("SB2.PrefixSetBitsPerPrefix",
-                              bits_used / unique_prefixes,
+                              bits_used / size_,
                               kMaxBitsPerPrefix);
   }
 }
 
-PrefixSet::PrefixSet(std::vector<std::pair<SBPrefix,size_t> > *index,
-                     std::vector<uint16> *deltas)
-    : checksum_(0) {
-  DCHECK(index && deltas);
-  index_.swap(*index);
-  deltas_.swap(*deltas);
+PrefixSet::PrefixSet(size_t size, int low_bits,
+                     std::vector<uint32>* low, std::vector<uint32>* high)
+    : size_(size),
+      low_bits_(low_bits),
+      checksum_(0) {
+  DCHECK(low && high);
+  low_.swap(*low);
+  high_.swap(*high);
 }
 
 PrefixSet::~PrefixSet() {}
 
 bool PrefixSet::Exists(SBPrefix prefix) const {
-  if (index_.empty())
-    return false;
-
-  // Find the first position after |prefix| in |index_|.
-  std::vector<std::pair<SBPrefix,size_t> >::const_iterator
-      iter = std::upper_bound(index_.begin(), index_.end(),
-                              std::pair<SBPrefix,size_t>(prefix, 0),
-                              PrefixLess);
-
-  // |prefix| comes before anything that's in the set.
-  if (iter == index_.begin())
+  if (!size_)
     return false;
 
-  // Capture the upper bound of our target entry's deltas.
-  const size_t bound = (iter == index_.end() ? deltas_.size() : iter->second);
-
-  // Back up to the entry our target is in.
-  --iter;
+  const uint32 value = PrefixToValue(prefix);
+  const size_t bucket = value >> low_bits_;
+  const size_t position =
+      SkipBuckets(bucket_index_[bucket / kBucketsPerIndex],
+                  bucket % kBucketsPerIndex);
+  return BucketContains(bucket, position, value & ((1u << low_bits_) - 1));
+}
 
-  // All prefixes in |index_| are in the set.
-  SBPrefix current = iter->first;
-  if (current == prefix)
-    return true;
+void PrefixSet::FindPrefixes(const std::vector<SBPrefix>& prefixes,
+                             std::vector<SBPrefix>* hits) const {
+  if (!size_)
+    return;
 
-  // Scan forward accumulating deltas while a match is possible.
-  for (size_t di = iter->second; di < bound && current < prefix; ++di) {
-    current += deltas_[di];
+  const size_t old_size = hits->size();
+  for (size_t i = 0; i < prefixes.size(); ++i) {
+    if (Exists(prefixes[i]))
+      hits->push_back(prefixes[i]);
   }
 
-  return current == prefix;
+  // Hits are rare, so sorting them is cheaper than sorting |prefixes|.
+  std::sort(hits->begin() + old_size, hits->end());
+  hits->erase(std::unique(hits->begin() + old_size, hits->end()),
+              hits->end());
 }
 
 void PrefixSet::GetPrefixes(std::vector<SBPrefix>* prefixes) const {
-  prefixes->reserve(index_.size() + deltas_.size());
-
-  for (size_t ii = 0; ii < index_.size(); ++ii) {
-    // The deltas for this |index_| entry run to the next index entry,
-    // or the end of the deltas.
-    const size_t deltas_end =
-        (ii + 1 < index_.size()) ? index_[ii + 1].second : deltas_.size();
-
-    SBPrefix current = index_[ii].first;
-    prefixes->push_back(current);
-    for (size_t di = index_[ii].second; di < deltas_end; ++di) {
-      current += deltas_[di];
-      prefixes->push_back(current);
+  prefixes->reserve(size_);
+
+  // The |index|th 1 bit of |high_| is at the position of its bucket
+  // plus |index|.
+  size_t index = 0;
+  for (size_t word = 0; word < high_.size(); ++word) {
+    for (uint32 bits = high_[word]; bits; bits &= bits - 1) {
+      const size_t position = word * 32 + LowestBit(bits);
+      const uint32 bucket = static_cast<uint32>(position - index);
+      const uint32 value = (bucket << low_bits_) | LowBitsAt(index);
+      prefixes->push_back(ValueToPrefix(value));
+      ++index;
     }
   }
 }
@@ -186,15 +224,15 @@ PrefixSet* PrefixSet::LoadFile(const FilePath& filter_name) {
   if (header.magic != kMagic || header.version != kVersion)
     return NULL;
 
-  std::vector<std::pair<SBPrefix,size_t> > index;
-  const size_t index_bytes = sizeof(index[0]) * header.index_size;
+  std::vector<uint32> low;
+  const size_t low_bytes = sizeof(uint32) * header.low_size;
 
-  std::vector<uint16> deltas;
-  const size_t deltas_bytes = sizeof(deltas[0]) * header.deltas_size;
+  std::vector<uint32> high;
+  const size_t high_bytes = sizeof(uint32) * header.high_size;
 
   // Check for bogus sizes before allocating any space.
   const size_t expected_bytes =
-      sizeof(header) + index_bytes + deltas_bytes + sizeof(MD5Digest);
+      sizeof(header) + low_bytes + high_bytes + sizeof(MD5Digest);
   if (static_cast<int64>(expected_bytes) != size_64)
     return NULL;
 
@@ -204,25 +242,29 @@ PrefixSet* PrefixSet::LoadFile(const FilePath& filter_name) {
   base::MD5Update(&context, base::StringPiece(reinterpret_cast<char*>(&header),
                                               sizeof(header)));
 
-  // Read the index vector.  Herb Sutter indicates that vectors are
+  // Read the low bits.  Herb Sutter indicates that vectors are
   // guaranteed to be contiuguous, so reading to where element 0 lives
   // is valid.
-  index.resize(header.index_size);
-  read = fread(&(index[0]), sizeof(index[0]), index.size(), file.get());
-  if (read != index.size())
-    return NULL;
-  base::MD5Update(&context,
-                  base::StringPiece(reinterpret_cast<char*>(&(index[0])),
-                                    index_bytes));
-
-  // Read vector of deltas.
-  deltas.resize(header.deltas_size);
-  read = fread(&(deltas[0]), sizeof(deltas[0]), deltas.size(), file.get());
-  if (read != deltas.size())
-    return NULL;
-  base::MD5Update(&context,
-                  base::StringPiece(reinterpret_cast<char*>(&(deltas[0])),
-                                    deltas_bytes));
+  if (header.low_size) {
+    low.resize(header.low_size);
+    read = fread(&(low[0]), sizeof(low[0]), low.size(), file.get());
+    if (read != low.size())
+      return NULL;
+    base::MD5Update(&context,
+                    base::StringPiece(reinterpret_cast<char*>(&(low[0])),
+                                      low_bytes));
+  }
+
+  // Read the bucket sizes.
+  if (header.high_size) {
+    high.resize(header.high_size);
+    read = fread(&(high[0]), sizeof(high[0]), high.size(), file.get());
+    if (read != high.size())
+      return NULL;
+    base::MD5Update(&context,
+                    base::StringPiece(reinterpret_cast<char*>(&(high[0])),
+                                      high_bytes));
+  }
 
   base::MD5Digest calculated_digest;
   base::MD5Final(&calculated_digest, &context);
@@ -235,20 +277,33 @@ PrefixSet* PrefixSet::LoadFile(const FilePath& filter_name) {
   if (0 != memcmp(&file_digest, &calculated_digest, sizeof(file_digest)))
     return NULL;
 
-  // Steals contents of |index| and |deltas| via swap().
-  return new PrefixSet(&index, &deltas);
+  // Steals contents of |low| and |high| via swap().
+  scoped_ptr<PrefixSet> prefix_set(
+      new PrefixSet(header.size, static_cast<int>(header.low_bits),
+                    &low, &high));
+
+  // Lookups depend on the bucket structure being consistent, check it
+  // before trusting it.
+  if (!prefix_set->CheckEncoding())
+    return NULL;
+  if (prefix_set->size_)
+    prefix_set->BuildBucketIndex();
+  return prefix_set.release();
 }
 
 bool PrefixSet::WriteFile(const FilePath& filter_name) const {
   FileHeader header;
   header.magic = kMagic;
   header.version = kVersion;
-  header.index_size = static_cast<uint32>(index_.size());
-  header.deltas_size = static_cast<uint32>(deltas_.size());
+  header.size = static_cast<uint32>(size_);
+  header.low_bits = static_cast<uint32>(low_bits_);
+  header.low_size = static_cast<uint32>(low_.size());
+  header.high_size = static_cast<uint32>(high_.size());
 
   // Sanity check that the 32-bit values never mess things up.
-  if (static_cast<size_t>(header.index_size) != index_.size() ||
-      static_cast<size_t>(header.deltas_size) != deltas_.size()) {
+  if (static_cast<size_t>(header.size) != size_ ||
+      static_cast<size_t>(header.low_size) != low_.size() ||
+      static_cast<size_t>(header.high_size) != high_.size()) {
     NOTREACHED();
     return false;
   }
@@ -270,23 +325,27 @@ bool PrefixSet::WriteFile(const FilePath& filter_name) const {
 
   // As for reads, the standard guarantees the ability to access the
   // contents of the vector by a pointer to an element.
-  const size_t index_bytes = sizeof(index_[0]) * index_.size();
-  written = fwrite(&(index_[0]), sizeof(index_[0]), index_.size(), file.get());
-  if (written != index_.size())
-    return false;
-  base::MD5Update(&context,
-                  base::StringPiece(reinterpret_cast<const char*>(&(index_[0])),
-                                    index_bytes));
-
-  const size_t deltas_bytes = sizeof(deltas_[0]) * deltas_.size();
-  written = fwrite(&(deltas_[0]), sizeof(deltas_[0]), deltas_.size(),
-                   file.get());
-  if (written != deltas_.size())
-    return false;
-  base::MD5Update(&context,
-                  base::StringPiece(
-                      reinterpret_cast<const char*>(&(deltas_[0])),
-                      deltas_bytes));
+  if (!low_.empty()) {
+    const size_t low_bytes = sizeof(low_[0]) * low_.size();
+    written = fwrite(&(low_[0]), sizeof(low_[0]), low_.size(), file.get());
+    if (written != low_.size())
+      return false;
+    base::MD5Update(&context,
+                    base::StringPiece(reinterpret_cast<const char*>(&(low_[0])),
+                                      low_bytes));
+  }
+
+  if (!high_.empty()) {
+    const size_t high_bytes = sizeof(high_[0]) * high_.size();
+    written = fwrite(&(high_[0]), sizeof(high_[0]), high_.size(),
+                     file.get());
+    if (written != high_.size())
+      return false;
+    base::MD5Update(&context,
+                    base::StringPiece(
+                        reinterpret_cast<const char*>(&(high_[0])),
+                        high_bytes));
+  }
 
   base::MD5Digest digest;
   base::MD5Final(&digest, &context);
@@ -300,70 +359,119 @@ bool PrefixSet::WriteFile(const FilePath& filter_name) const {
   return true;
 }
 
-size_t PrefixSet::IndexBinFor(size_t target_index) const {
-  // The items in |index_| have the logical index of each previous
-  // item in |index_| plus the count of deltas between the items.
-  // Since the indices into |deltas_| are absolute, the logical index
-  // is then the sum of the two indices.
-  size_t lo = 0;
-  size_t hi = index_.size();
-
-  // Binary search because linear search was too slow (really, the
-  // unit test sucked).  Inline because the elements can't be compared
-  // in isolation (their position matters).
-  while (hi - lo > 1) {
-    const size_t i = (lo + hi) / 2;
-
-    if (target_index < i + index_[i].second) {
-      DCHECK_LT(i, hi);  // Always making progress.
-      hi = i;
-    } else {
-      DCHECK_GT(i, lo);  // Always making progress.
-      lo = i;
-    }
-  }
-  return lo;
-}
-
 size_t PrefixSet::GetSize() const {
-  return index_.size() + deltas_.size();
+  return size_;
 }
 
-bool PrefixSet::IsDeltaAt(size_t target_index) const {
-  CHECK_LT(target_index, GetSize());
+bool PrefixSet::CheckChecksum() const {
+  uint32 checksum = static_cast<uint32>(size_);
 
-  const size_t i = IndexBinFor(target_index);
-  return target_index > i + index_[i].second;
-}
+  for (size_t i = 0; i < low_.size(); ++i) {
+    checksum ^= low_[i];
+  }
 
-uint16 PrefixSet::DeltaAt(size_t target_index) const {
-  CHECK_LT(target_index, GetSize());
+  for (size_t i = 0; i < high_.size(); ++i) {
+    checksum ^= high_[i];
+  }
 
-  // Find the |index_| entry which contains |target_index|.
-  const size_t i = IndexBinFor(target_index);
+  return checksum == checksum_;
+}
 
-  // Exactly on the |index_| entry means no delta.
-  CHECK_GT(target_index, i + index_[i].second);
+size_t PrefixSet::BucketCount() const {
+  return static_cast<size_t>(GG_UINT64_C(1) << (32 - low_bits_));
+}
 
-  // -i backs out the |index_| entries, -1 gets the delta that lead to
-  // the value at |target_index|.
-  CHECK_LT(target_index - i - 1, deltas_.size());
-  return deltas_[target_index - i - 1];
+uint32 PrefixSet::LowBitsAt(size_t index) const {
+  if (!low_bits_)
+    return 0;
+
+  const uint64 low_bit = static_cast<uint64>(index) * low_bits_;
+  const size_t word = static_cast<size_t>(low_bit / 32);
+  const int shift = static_cast<int>(low_bit % 32);
+  uint64 bits = low_[word];
+  if (shift + low_bits_ > 32)
+    bits |= static_cast<uint64>(low_[word + 1]) << 32;
+  return static_cast<uint32>(bits >> shift) & ((1u << low_bits_) - 1);
 }
 
-bool PrefixSet::CheckChecksum() const {
-  uint32 checksum = 0;
+size_t PrefixSet::SkipBuckets(size_t position, size_t count) const {
+  if (!count)
+    return position;
+
+  // Count the 0 bits a word at a time until the word containing the
+  // |count|th one, then find it within the word.
+  size_t word = position / 32;
+  uint32 zero_bits = ~high_[word] & (~0u << (position % 32));
+  int zeros = CountBits(zero_bits);
+  while (static_cast<size_t>(zeros) < count) {
+    count -= zeros;
+    zero_bits = ~high_[++word];
+    zeros = CountBits(zero_bits);
+  }
+  for (; count > 1; --count)
+    zero_bits &= zero_bits - 1;
+  return word * 32 + LowestBit(zero_bits) + 1;
+}
+
+bool PrefixSet::BucketContains(size_t bucket, size_t position,
+                               uint32 low) const {
+  // The prefixes in the bucket are the 1 bits up to the next 0 bit,
+  // in ascending order.
+  for (; high_[position / 32] & (1u << (position % 32)); ++position) {
+    const uint32 candidate = LowBitsAt(position - bucket);
+    if (candidate >= low)
+      return candidate == low;
+  }
+  return false;
+}
 
-  for (size_t ii = 0; ii < index_.size(); ++ii) {
-    checksum ^= static_cast<uint32>(index_[ii].first);
-    checksum ^= static_cast<uint32>(index_[ii].second);
+void PrefixSet::BuildBucketIndex() {
+  const size_t buckets = BucketCount();
+  bucket_index_.clear();
+  bucket_index_.reserve((buckets + kBucketsPerIndex - 1) / kBucketsPerIndex);
+  bucket_index_.push_back(0);
+
+  // Bucket b starts after the bth 0 bit.
+  size_t zeros = 0;
+  size_t next_entry = kBucketsPerIndex;
+  for (size_t word = 0; word < high_.size() && next_entry < buckets; ++word) {
+    uint32 zero_bits = ~high_[word];
+    const size_t word_zeros = CountBits(zero_bits);
+    if (zeros + word_zeros < next_entry) {
+      zeros += word_zeros;
+      continue;
+    }
+    for (; zero_bits && next_entry < buckets; zero_bits &= zero_bits - 1) {
+      if (++zeros == next_entry) {
+        bucket_index_.push_back(
+            static_cast<uint32>(word * 32 + LowestBit(zero_bits) + 1));
+        next_entry += kBucketsPerIndex;
+      }
+    }
   }
+  DCHECK_EQ(bucket_index_.size(),
+            (buckets + kBucketsPerIndex - 1) / kBucketsPerIndex);
+}
 
-  for (size_t di = 0; di < deltas_.size(); ++di) {
-    checksum ^= static_cast<uint32>(deltas_[di]);
+bool PrefixSet::CheckEncoding() const {
+  if (!size_)
+    return low_.empty() && high_.empty();
+
+  if (low_bits_ < 1 || low_bits_ > 31 ||
+      low_.size() != WordsFor(static_cast<uint64>(size_) * low_bits_) ||
+      high_.size() != WordsFor(static_cast<uint64>(size_) + BucketCount())) {
+    return false;
   }
 
-  return checksum == checksum_;
+  // Every prefix must have a 1 bit, and the bits past the end of the
+  // buckets must be clear, which leaves exactly one 0 bit per bucket.
+  const size_t high_bits = size_ + BucketCount();
+  if (high_bits % 32 && (high_.back() >> (high_bits % 32)) != 0)
+    return false;
+  size_t ones = 0;
+  for (size_t i = 0; i < high_.size(); ++i)
+    ones += CountBits(high_[i]);
+  return ones == size_;
 }
 
 }  // namespace safe_browsing
@@ -1,19 +1,28 @@
-// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 //
 // A read-only set implementation for |SBPrefix| items.  Prefixes are
-// sorted and stored as 16-bit deltas from the previous prefix.  An
-// index structure provides quick random access, and also handles
-// cases where 16 bits cannot encode a delta.
+// sorted and each is split into high and low bits (Elias-Fano
+// coding).  The low |low_bits_| bits of every prefix are packed in
+// |low_|.  Prefixes sharing the same high bits form a bucket, and the
+// size of each bucket is written in unary to |high_|: a 1 bit per
+// prefix, followed by a 0 bit.  This is the same as Rice-coding the
+// deltas, but with the unary and binary parts stored separately so
+// that both can be accessed directly.  |bucket_index_| records where
+// every |kBucketsPerIndex|th bucket starts in |high_|.
 //
-// For example, the sequence {20, 25, 41, 65432, 150000, 160000} would
-// be stored as:
-//  A pair {20, 0} in |index_|.
-//  5, 16, 65391 in |deltas_|.
-//  A pair {150000, 3} in |index_|.
-//  10000 in |deltas_|.
-// |index_.size()| will be 2, |deltas_.size()| will be 4.
+// For example, with 4 low bits the sequence {20, 25, 41, 45, 100}
+// has high bits {1, 1, 2, 2, 6} and low bits {4, 9, 9, 13, 4}.  It
+// would be stored as:
+//  4, 9, 9, 13, 4 in |low_|.
+//  0 110 110 0 0 0 10 in |high_|, for buckets 0 through 6, followed
+//  by a 0 bit for each of the remaining buckets.
+//
+// The prefix i in bucket b is at bit b + i of |high_|, so |Exists()|
+// finds the bucket for a prefix by skipping at most
+// |kBucketsPerIndex| 0 bits from the nearest |bucket_index_| entry,
+// then compares the low bits of the few prefixes in the bucket.
 //
 // This structure is intended for storage of sparse uniform sets of
 // prefixes of a certain size.  As of this writing, my safe-browsing
@@ -23,28 +32,24 @@
 //   24301 w/in 2^8 of the prior prefix
 //   622337 w/in 2^16 of the prior prefix
 //   47 further than 2^16 from the prior prefix
-// For this input, the memory usage is approximately 2 bytes per
-// prefix, a bit over 1.2M.  The bloom filter used 25 bits per prefix,
-// a bit over 1.9M on this data.
-//
-// Experimenting with random selections of the above data, storage
-// size drops almost linearly as prefix count drops, until the index
-// overhead starts to become a problem a bit under 200k prefixes.  The
-// memory footprint gets worse than storing the raw prefix data around
-// 75k prefixes.  Fortunately, the actual memory footprint also falls.
-// If the prefix count increases the memory footprint should increase
-// approximately linearly.  The worst-case would be 2^16 items all
-// 2^16 apart, which would need 512k (versus 256k to store the raw
-// data).
+// With n unique prefixes, |low_bits_| is floor(log2(2^32 / n)), 12
+// for this input.  |high_| takes n + 2^20 bits, about 2.6 bits per
+// prefix, and |bucket_index_| about 0.2 bits, so the set uses a bit
+// under 15 bits per prefix, approximately 1.2M.  Storing 16-bit
+// deltas from an index took about 17 bits per prefix, and the bloom
+// filter used 25 bits per prefix, a bit over 1.9M on this data.
 //
 // The on-disk format looks like:
 //         4 byte magic number
 //         4 byte version number
-//         4 byte |index_.size()|
-//         4 byte |deltas_.size()|
-//     n * 8 byte |&index_[0]..&index_[n]|
-//     m * 2 byte |&deltas_[0]..&deltas_[m]|
+//         4 byte |size_|
+//         4 byte |low_bits_|
+//         4 byte |low_.size()|
+//         4 byte |high_.size()|
+//     n * 4 byte |&low_[0]..&low_[n]|
+//     m * 4 byte |&high_[0]..&high_[m]|
 //        16 byte digest
+// |bucket_index_| is rebuilt from |high_| when loading.
 
 #ifndef CHROME_BROWSER_SAFE_BROWSING_PREFIX_SET_H_
 #define CHROME_BROWSER_SAFE_BROWSING_PREFIX_SET_H_
@@ -66,6 +71,12 @@ class PrefixSet {
   // |true| if |prefix| was in |prefixes| passed to the constructor.
   bool Exists(SBPrefix prefix) const;
 
+  // Appends the items of |prefixes| which are in the set to |hits|,
+  // in sorted order without duplicates, for checking the several
+  // prefixes generated for a URL at once.
+  void FindPrefixes(const std::vector<SBPrefix>& prefixes,
+                    std::vector<SBPrefix>* hits) const;
+
   // Persist the set on disk.
   static PrefixSet* LoadFile(const FilePath& filter_name);
   bool WriteFile(const FilePath& filter_name) const;
@@ -74,49 +85,61 @@ class PrefixSet {
   // |prefixes|.  Prefixes will be added in sorted order.
   void GetPrefixes(std::vector<SBPrefix>* prefixes) const;
 
-  // TODO(shess): The following are debugging accessors.  Delete once
-  // the encoding problem is figured out.
-
-  size_t IndexBinFor(size_t target_index) const;
-
   // The number of prefixes represented.
   size_t GetSize() const;
 
-  // Returns |true| if the element at |target_index| is between items in the
-  // |index_| array.
-  bool IsDeltaAt(size_t target_index) const;
-
-  // Returns the delta used to calculate the element at
-  // |target_index|.  Only call if |IsDeltaAt()| returned |true|.
-  uint16 DeltaAt(size_t target_index) const;
-
-  // Check whether |index_| and |deltas_| still match the CRC
-  // generated during construction.
+  // Check whether |low_| and |high_| still match the CRC generated
+  // during construction.
   bool CheckChecksum() const;
 
  private:
-  // Maximum number of consecutive deltas to encode before generating
-  // a new index entry.  This helps keep the worst-case performance
-  // for |Exists()| under control.
-  static const size_t kMaxRun = 100;
-
-  // Helper for |LoadFile()|.  Steals the contents of |index| and
-  // |deltas| using |swap()|.
-  PrefixSet(std::vector<std::pair<SBPrefix,size_t> > *index,
-            std::vector<uint16> *deltas);
-
-  // Top-level index of prefix to offset in |deltas_|.  Each pair
-  // indicates a base prefix and where the deltas from that prefix
-  // begin in |deltas_|.  The deltas for a pair end at the next pair's
-  // index into |deltas_|.
-  std::vector<std::pair<SBPrefix,size_t> > index_;
-
-  // Deltas which are added to the prefix in |index_| to generate
-  // prefixes.  Deltas are only valid between consecutive items from
-  // |index_|, or the end of |deltas_| for the last |index_| pair.
-  std::vector<uint16> deltas_;
-
-  // For debugging, used to verify that |index_| and |deltas| were not
+  // Number of buckets between |bucket_index_| entries.  This keeps
+  // the worst-case performance for |Exists()| under control.
+  static const size_t kBucketsPerIndex = 256;
+
+  // Helper for |LoadFile()|.  Steals the contents of |low| and |high|
+  // using |swap()|.
+  PrefixSet(size_t size, int low_bits,
+            std::vector<uint32>* low, std::vector<uint32>* high);
+
+  // The number of buckets, 2^(32 - |low_bits_|).
+  size_t BucketCount() const;
+
+  // The low bits of the |index|th prefix.
+  uint32 LowBitsAt(size_t index) const;
+
+  // Returns the position in |high_| of the start of the bucket
+  // |count| buckets after the one starting at |position|.
+  size_t SkipBuckets(size_t position, size_t count) const;
+
+  // Returns |true| if the prefix with |low| bits is in the bucket
+  // |bucket|, which starts at |position| in |high_|.
+  bool BucketContains(size_t bucket, size_t position, uint32 low) const;
+
+  // Regenerates |bucket_index_| from |high_|.
+  void BuildBucketIndex();
+
+  // Returns |false| if |high_| does not hold exactly |size_| 1 bits
+  // and |BucketCount()| 0 bits, or |low_| is the wrong size.
+  bool CheckEncoding() const;
+
+  // The number of prefixes in the set.
+  size_t size_;
+
+  // The number of low bits of each prefix stored in |low_|.
+  int low_bits_;
+
+  // The low bits of the prefixes, packed least-significant bit first.
+  std::vector<uint32> low_;
+
+  // The bucket sizes in unary, least-significant bit first.
+  std::vector<uint32> high_;
+
+  // Bit position in |high_| where each |kBucketsPerIndex|th bucket
+  // starts.
+  std::vector<uint32> bucket_index_;
+
+  // For debugging, used to verify that |low_| and |high_| were not
   // changed after generation during construction.  |checksum_| is
   // calculated from the data used to construct those vectors.
   uint32 checksum_;
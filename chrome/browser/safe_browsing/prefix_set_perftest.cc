@@ -0,0 +1,98 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Reports the size of a PrefixSet about as large as the real browse list, and
+// the time taken to build it and to look prefixes up in it.
+
+#include "chrome/browser/safe_browsing/prefix_set.h"
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/perftimer.h"
+#include "base/rand_util.h"
+#include "base/scoped_temp_dir.h"
+#include "base/test/perf_benchmark.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const size_t kPrefixes = 650000;
+const size_t kLookups = 200000;
+const size_t kPrefixesPerUrl = 10;
+
+void Build(const std::vector<SBPrefix>* prefixes) {
+  safe_browsing::PrefixSet prefix_set(*prefixes);
+}
+
+void LookUpWithExists(const safe_browsing::PrefixSet* prefix_set,
+                      const std::vector<SBPrefix>* lookups) {
+  size_t found = 0;
+  for (size_t i = 0; i < lookups->size(); ++i) {
+    if (prefix_set->Exists((*lookups)[i]))
+      ++found;
+  }
+  CHECK_GE(found, lookups->size() / 2);
+}
+
+// Looks up |kPrefixesPerUrl| prefixes at a time, as for the prefixes of the
+// host and path combinations of a URL.
+void LookUpWithFindPrefixes(const safe_browsing::PrefixSet* prefix_set,
+                            const std::vector<SBPrefix>* lookups) {
+  std::vector<SBPrefix> hits;
+  for (size_t i = 0; i + kPrefixesPerUrl <= lookups->size();
+       i += kPrefixesPerUrl) {
+    std::vector<SBPrefix> url_prefixes(lookups->begin() + i,
+                                       lookups->begin() + i + kPrefixesPerUrl);
+    prefix_set->FindPrefixes(url_prefixes, &hits);
+  }
+}
+
+}  // namespace
+
+TEST(PrefixSetPerfTest, BrowseListSize) {
+  std::vector<SBPrefix> prefixes;
+  for (size_t i = 0; i < kPrefixes; ++i)
+    prefixes.push_back(static_cast<SBPrefix>(base::RandUint64()));
+  std::sort(prefixes.begin(), prefixes.end());
+
+  base::PerfBenchmark build_benchmark("PrefixSet_Build");
+  build_benchmark.set_runs(10);
+  build_benchmark.Run(base::Bind(&Build, &prefixes));
+
+  safe_browsing::PrefixSet prefix_set(prefixes);
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath filename = temp_dir.path().AppendASCII("PrefixSetPerfTest");
+  ASSERT_TRUE(prefix_set.WriteFile(filename));
+  int64 file_size = 0;
+  ASSERT_TRUE(file_util::GetFileSize(filename, &file_size));
+  LogPerfResult("PrefixSet_BitsPerPrefix",
+                static_cast<double>(file_size) * CHAR_BIT / kPrefixes,
+                "bits");
+
+  // Half of the lookups hit.
+  std::vector<SBPrefix> lookups;
+  for (size_t i = 0; i < kLookups; ++i) {
+    if (i % 2) {
+      lookups.push_back(
+          prefixes[static_cast<size_t>(base::RandGenerator(prefixes.size()))]);
+    } else {
+      lookups.push_back(static_cast<SBPrefix>(base::RandUint64()));
+    }
+  }
+
+  base::PerfBenchmark exists_benchmark("PrefixSet_Exists");
+  exists_benchmark.set_runs(10);
+  exists_benchmark.Run(base::Bind(&LookUpWithExists, &prefix_set, &lookups));
+
+  base::PerfBenchmark find_benchmark("PrefixSet_FindPrefixes");
+  find_benchmark.set_runs(10);
+  find_benchmark.Run(
+      base::Bind(&LookUpWithFindPrefixes, &prefix_set, &lookups));
+}
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <set>
 
 #include "base/file_util.h"
 #include "base/logging.h"
@@ -20,12 +21,14 @@ namespace {
 
 class PrefixSetTest : public PlatformTest {
  protected:
-  // Constants for the v1 format.
+  // Constants for the v2 format.
   static const size_t kMagicOffset = 0 * sizeof(uint32);
   static const size_t kVersionOffset = 1 * sizeof(uint32);
-  static const size_t kIndexSizeOffset = 2 * sizeof(uint32);
-  static const size_t kDeltasSizeOffset = 3 * sizeof(uint32);
-  static const size_t kPayloadOffset = 4 * sizeof(uint32);
+  static const size_t kSizeOffset = 2 * sizeof(uint32);
+  static const size_t kLowBitsOffset = 3 * sizeof(uint32);
+  static const size_t kLowSizeOffset = 4 * sizeof(uint32);
+  static const size_t kHighSizeOffset = 5 * sizeof(uint32);
+  static const size_t kPayloadOffset = 6 * sizeof(uint32);
 
   // Generate a set of random prefixes to share between tests.  For
   // most tests this generation was a large fraction of the test time.
@@ -239,8 +242,8 @@ TEST_F(PrefixSetTest, AllBig) {
 // Items before the lowest item aren't present.  Items after the
 // largest item aren't present.  Create a sequence of items with
 // deltas above and below 2^16, and make sure they're all present.
-// Create a very long sequence with deltas below 2^16 to test crossing
-// |kMaxRun|.
+// Create a very long sequence with deltas below 2^16 to test crowded
+// buckets.
 TEST_F(PrefixSetTest, EdgeCases) {
   std::vector<SBPrefix> prefixes;
 
@@ -324,7 +327,7 @@ TEST_F(PrefixSetTest, CorruptionHelpers) {
   FilePath filename;
   ASSERT_TRUE(GetPrefixSetFile(&filename));
 
-  // This will modify data in |index_|, which will fail the digest check.
+  // This will modify data in |low_|, which will fail the digest check.
   file_util::ScopedFILE file(file_util::OpenFile(filename, "r+b"));
   IncrementIntAt(file.get(), kPayloadOffset, 1);
   file.reset();
@@ -365,25 +368,49 @@ TEST_F(PrefixSetTest, CorruptionVersion) {
   ASSERT_FALSE(prefix_set.get());
 }
 
-// Bad |index_| size is caught by the sanity check.
-TEST_F(PrefixSetTest, CorruptionIndexSize) {
+// Bad prefix count is caught by the encoding check.
+TEST_F(PrefixSetTest, CorruptionSize) {
+  FilePath filename;
+  ASSERT_TRUE(GetPrefixSetFile(&filename));
+
+  ASSERT_NO_FATAL_FAILURE(
+      ModifyAndCleanChecksum(filename, kSizeOffset, 1));
+  scoped_ptr<safe_browsing::PrefixSet>
+      prefix_set(safe_browsing::PrefixSet::LoadFile(filename));
+  ASSERT_FALSE(prefix_set.get());
+}
+
+// Bad low bit count is caught by the encoding check.
+TEST_F(PrefixSetTest, CorruptionLowBits) {
+  FilePath filename;
+  ASSERT_TRUE(GetPrefixSetFile(&filename));
+
+  ASSERT_NO_FATAL_FAILURE(
+      ModifyAndCleanChecksum(filename, kLowBitsOffset, 1));
+  scoped_ptr<safe_browsing::PrefixSet>
+      prefix_set(safe_browsing::PrefixSet::LoadFile(filename));
+  ASSERT_FALSE(prefix_set.get());
+}
+
+// Bad |low_| size is caught by the sanity check.
+TEST_F(PrefixSetTest, CorruptionLowSize) {
   FilePath filename;
   ASSERT_TRUE(GetPrefixSetFile(&filename));
 
   ASSERT_NO_FATAL_FAILURE(
-      ModifyAndCleanChecksum(filename, kIndexSizeOffset, 1));
+      ModifyAndCleanChecksum(filename, kLowSizeOffset, 1));
   scoped_ptr<safe_browsing::PrefixSet>
       prefix_set(safe_browsing::PrefixSet::LoadFile(filename));
   ASSERT_FALSE(prefix_set.get());
 }
 
-// Bad |deltas_| size is caught by the sanity check.
-TEST_F(PrefixSetTest, CorruptionDeltasSize) {
+// Bad |high_| size is caught by the sanity check.
+TEST_F(PrefixSetTest, CorruptionHighSize) {
   FilePath filename;
   ASSERT_TRUE(GetPrefixSetFile(&filename));
 
   ASSERT_NO_FATAL_FAILURE(
-      ModifyAndCleanChecksum(filename, kDeltasSizeOffset, 1));
+      ModifyAndCleanChecksum(filename, kHighSizeOffset, 1));
   scoped_ptr<safe_browsing::PrefixSet>
       prefix_set(safe_browsing::PrefixSet::LoadFile(filename));
   ASSERT_FALSE(prefix_set.get());
@@ -434,24 +461,48 @@ TEST_F(PrefixSetTest, CorruptionExcess) {
   ASSERT_FALSE(prefix_set.get());
 }
 
-// TODO(shess): Remove once the problem is debugged.  But, until then,
-// make sure the accessors work!
-TEST_F(PrefixSetTest, DebuggingAccessors) {
+// |FindPrefixes()| returns the same hits as |Exists()|, sorted and
+// without duplicates.
+TEST_F(PrefixSetTest, FindPrefixes) {
+  safe_browsing::PrefixSet prefix_set(shared_prefixes_);
+
+  // Unsorted, with duplicates and misses.
   std::vector<SBPrefix> prefixes;
-  std::unique_copy(shared_prefixes_.begin(), shared_prefixes_.end(),
-                   std::back_inserter(prefixes));
-  safe_browsing::PrefixSet prefix_set(prefixes);
+  for (size_t i = 0; i < shared_prefixes_.size(); i += 1000) {
+    prefixes.push_back(shared_prefixes_[i] + 1);
+    prefixes.push_back(shared_prefixes_[i]);
+    prefixes.push_back(shared_prefixes_[i]);
+  }
+  std::reverse(prefixes.begin(), prefixes.end());
 
-  EXPECT_EQ(prefixes.size(), prefix_set.GetSize());
-  EXPECT_FALSE(prefix_set.IsDeltaAt(0));
-  for (size_t i = 1; i < prefixes.size(); ++i) {
-    const int delta = prefixes[i] - prefixes[i - 1];
-    if (delta > 0xFFFF) {
-      EXPECT_FALSE(prefix_set.IsDeltaAt(i));
-    } else {
-      ASSERT_TRUE(prefix_set.IsDeltaAt(i));
-      EXPECT_EQ(delta, prefix_set.DeltaAt(i));
-    }
+  std::set<SBPrefix> check(shared_prefixes_.begin(), shared_prefixes_.end());
+  std::set<SBPrefix> expected;
+  for (size_t i = 0; i < prefixes.size(); ++i) {
+    if (check.count(prefixes[i]))
+      expected.insert(prefixes[i]);
+  }
+
+  std::vector<SBPrefix> hits;
+  prefix_set.FindPrefixes(prefixes, &hits);
+  EXPECT_EQ(expected.size(), hits.size());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), hits.begin()));
+
+  // Nothing is found in the empty set.
+  safe_browsing::PrefixSet empty_set((std::vector<SBPrefix>()));
+  hits.clear();
+  empty_set.FindPrefixes(prefixes, &hits);
+  EXPECT_TRUE(hits.empty());
+}
+
+// Sets of every size have a consistent encoding, including sizes
+// where the low bits straddle words and very sparse sets.
+TEST_F(PrefixSetTest, Sizes) {
+  const size_t kSizes[] = { 2, 3, 5, 31, 33, 1000, 4097 };
+  for (size_t i = 0; i < arraysize(kSizes); ++i) {
+    std::vector<SBPrefix> prefixes(shared_prefixes_.begin(),
+                                   shared_prefixes_.begin() + kSizes[i]);
+    safe_browsing::PrefixSet prefix_set(prefixes);
+    CheckPrefixes(&prefix_set, prefixes);
   }
 }
 
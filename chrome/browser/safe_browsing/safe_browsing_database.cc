@@ -246,6 +246,7 @@ enum PrefixSetEvent {
   PREFIX_SET_SBPREFIX_WAS_BROKEN,
   PREFIX_SET_GETPREFIXES_BROKEN_SORTING,
   PREFIX_SET_GETPREFIXES_BROKEN_DUPLICATION,
+  // No longer recorded, the prefix set does not store deltas.
   PREFIX_SET_GETPREFIX_UNSORTED_IS_DELTA,
   PREFIX_SET_GETPREFIX_UNSORTED_IS_INDEX,
   PREFIX_SET_GETPREFIX_CHECKSUM_MISMATCH,
@@ -336,18 +337,6 @@ safe_browsing::PrefixSet* PrefixSetFromAddPrefixes(
         UMA_HISTOGRAM_COUNTS("SB2.PrefixSetUnsortedSize", restored.size());
         UMA_HISTOGRAM_PERCENTAGE("SB2.PrefixSetUnsortedPercent",
                                  i * 100 / restored.size());
-
-        if (prefix_set->IsDeltaAt(i)) {
-          RecordPrefixSetInfo(PREFIX_SET_GETPREFIX_UNSORTED_IS_DELTA);
-
-          // Histograms require memory on the order of the number of
-          // buckets, making high-precision logging expensive.  For
-          // now aim for a sense of the range of the problem.
-          UMA_HISTOGRAM_CUSTOM_COUNTS("SB2.PrefixSetUnsortedDelta",
-                                      prefix_set->DeltaAt(i), 1, 0xFFFF, 50);
-        } else {
-          RecordPrefixSetInfo(PREFIX_SET_GETPREFIX_UNSORTED_IS_INDEX);
-        }
       }
       if (prev == restored[i])
         duplicates = true;
@@ -396,6 +385,47 @@ safe_browsing::PrefixSet* PrefixSetFromAddPrefixes(
   return prefix_set.release();
 }
 
+// Generate a |PrefixSet| instance holding the prefixes of
+// |prefix_set| and those of |additions| which are in |add_prefixes|.
+// Additions can be missing if a sub seen in an earlier update knocked
+// them out.  The existing prefixes are already sorted, so only
+// |additions| needs to be sorted (in place) and merged.
+safe_browsing::PrefixSet* PrefixSetWithAdditions(
+    const safe_browsing::PrefixSet& prefix_set,
+    const SBAddPrefixes& add_prefixes,
+    std::vector<SBPrefix>* additions) {
+  std::sort(additions->begin(), additions->end());
+  additions->erase(std::unique(additions->begin(), additions->end()),
+                   additions->end());
+
+  std::vector<bool> present(additions->size(), false);
+  for (SBAddPrefixes::const_iterator iter = add_prefixes.begin();
+       iter != add_prefixes.end(); ++iter) {
+    std::vector<SBPrefix>::const_iterator addition =
+        std::lower_bound(additions->begin(), additions->end(), iter->prefix);
+    if (addition != additions->end() && *addition == iter->prefix)
+      present[addition - additions->begin()] = true;
+  }
+
+  std::vector<SBPrefix> added;
+  for (size_t i = 0; i < additions->size(); ++i) {
+    if (present[i])
+      added.push_back((*additions)[i]);
+  }
+
+  std::vector<SBPrefix> existing;
+  prefix_set.GetPrefixes(&existing);
+
+  std::vector<SBPrefix> prefixes;
+  prefixes.reserve(existing.size() + added.size());
+  std::merge(existing.begin(), existing.end(), added.begin(), added.end(),
+             std::back_inserter(prefixes));
+  prefixes.erase(std::unique(prefixes.begin(), prefixes.end()),
+                 prefixes.end());
+
+  return new safe_browsing::PrefixSet(prefixes);
+}
+
 }  // namespace
 
 // The default SafeBrowsingDatabaseFactory.
@@ -515,7 +545,8 @@ SafeBrowsingDatabaseNew::SafeBrowsingDatabaseNew(
       csd_whitelist_store_(csd_whitelist_store),
       download_whitelist_store_(download_whitelist_store),
       ALLOW_THIS_IN_INITIALIZER_LIST(reset_factory_(this)),
-      corruption_detected_(false) {
+      corruption_detected_(false),
+      browse_update_add_only_(false) {
   DCHECK(browse_store_.get());
 }
 
@@ -650,12 +681,22 @@ bool SafeBrowsingDatabaseNew::ContainsBrowseUrl(
     return false;
   DCHECK(prefix_set_.get());
 
+  // Check all of the prefixes against the prefix set in one pass.
+  std::vector<SBPrefix> prefixes;
+  prefixes.reserve(full_hashes.size());
+  for (size_t i = 0; i < full_hashes.size(); ++i)
+    prefixes.push_back(full_hashes[i].prefix);
+  std::vector<SBPrefix> prefix_set_hits;
+  prefix_set_->FindPrefixes(prefixes, &prefix_set_hits);
+
   // Used to double-check in case of a hit mis-match.
   std::vector<SBPrefix> restored;
 
   size_t miss_count = 0;
   for (size_t i = 0; i < full_hashes.size(); ++i) {
-    bool found = prefix_set_->Exists(full_hashes[i].prefix);
+    bool found = std::binary_search(prefix_set_hits.begin(),
+                                    prefix_set_hits.end(),
+                                    full_hashes[i].prefix);
 
     if (browse_bloom_filter_->Exists(full_hashes[i].prefix)) {
       RecordPrefixSetInfo(PREFIX_SET_EVENT_BLOOM_HIT);
@@ -808,17 +849,25 @@ void SafeBrowsingDatabaseNew::InsertAdd(int chunk_id, SBPrefix host,
   const int encoded_chunk_id = EncodeChunkId(chunk_id, list_id);
   const int count = entry->prefix_count();
 
+  // Collect browse prefixes for |UpdateBrowseStore()|.
+  std::vector<SBPrefix>* update_prefixes =
+      store == browse_store_.get() ? &browse_update_prefixes_ : NULL;
+
   DCHECK(!entry->IsSub());
   if (!count) {
     // No prefixes, use host instead.
     STATS_COUNTER("SB.PrefixAdd", 1);
     store->WriteAddPrefix(encoded_chunk_id, host);
+    if (update_prefixes)
+      update_prefixes->push_back(host);
   } else if (entry->IsPrefix()) {
     // Prefixes only.
     for (int i = 0; i < count; i++) {
       const SBPrefix prefix = entry->PrefixAt(i);
       STATS_COUNTER("SB.PrefixAdd", 1);
       store->WriteAddPrefix(encoded_chunk_id, prefix);
+      if (update_prefixes)
+        update_prefixes->push_back(prefix);
     }
   } else {
     // Prefixes and hashes.
@@ -829,6 +878,8 @@ void SafeBrowsingDatabaseNew::InsertAdd(int chunk_id, SBPrefix host,
 
       STATS_COUNTER("SB.PrefixAdd", 1);
       store->WriteAddPrefix(encoded_chunk_id, prefix);
+      if (update_prefixes)
+        update_prefixes->push_back(prefix);
 
       STATS_COUNTER("SB.PrefixAddFull", 1);
       store->WriteAddHash(encoded_chunk_id, receive_time, full_hash);
@@ -953,6 +1004,8 @@ void SafeBrowsingDatabaseNew::InsertChunks(const std::string& list_name,
   if (!store) return;
 
   change_detected_ = true;
+  if (!chunks.front().is_add && store == browse_store_.get())
+    browse_update_add_only_ = false;
 
   store->BeginChunk();
   if (chunks.front().is_add) {
@@ -979,6 +1032,8 @@ void SafeBrowsingDatabaseNew::DeleteChunks(
   if (!store) return;
 
   change_detected_ = true;
+  if (store == browse_store_.get())
+    browse_update_add_only_ = false;
 
   for (size_t i = 0; i < chunk_deletes.size(); ++i) {
     std::vector<int> chunk_numbers;
@@ -1096,6 +1151,8 @@ bool SafeBrowsingDatabaseNew::UpdateStarted(
 
   corruption_detected_ = false;
   change_detected_ = false;
+  browse_update_add_only_ = true;
+  std::vector<SBPrefix>().swap(browse_update_prefixes_);
   return true;
 }
 
@@ -1272,8 +1329,19 @@ void SafeBrowsingDatabaseNew::UpdateBrowseStore() {
     filter->Insert(iter->prefix);
   }
 
-  scoped_ptr<safe_browsing::PrefixSet>
-      prefix_set(PrefixSetFromAddPrefixes(add_prefixes));
+  // If the update only added prefixes, merge them into the existing
+  // prefix set rather than sorting all of |add_prefixes|.  Only this
+  // thread changes |prefix_set_|, so there is no need to lock.
+  const bool incremental = browse_update_add_only_ && prefix_set_.get();
+  UMA_HISTOGRAM_BOOLEAN("SB2.PrefixSetIncremental", incremental);
+  scoped_ptr<safe_browsing::PrefixSet> prefix_set;
+  if (incremental) {
+    prefix_set.reset(PrefixSetWithAdditions(*prefix_set_, add_prefixes,
+                                            &browse_update_prefixes_));
+  } else {
+    prefix_set.reset(PrefixSetFromAddPrefixes(add_prefixes));
+  }
+  std::vector<SBPrefix>().swap(browse_update_prefixes_);
 
   // This needs to be in sorted order by prefix for efficient access.
   std::sort(add_full_hashes.begin(), add_full_hashes.end(),
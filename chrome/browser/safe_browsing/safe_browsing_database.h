@@ -379,6 +379,13 @@ class SafeBrowsingDatabaseNew : public SafeBrowsingDatabase {
 
   // Used to check if a prefix was in the database.
   scoped_ptr<safe_browsing::PrefixSet> prefix_set_;
+
+  // The prefixes added to |browse_store_| during an update.  If
+  // |browse_update_add_only_| is still set when the update finishes,
+  // no subs or chunk deletions were seen, so |prefix_set_| can be
+  // extended with these rather than rebuilt.
+  std::vector<SBPrefix> browse_update_prefixes_;
+  bool browse_update_add_only_;
 };
 
 #endif  // CHROME_BROWSER_SAFE_BROWSING_SAFE_BROWSING_DATABASE_H_
@@ -12,7 +12,19 @@ namespace {
 // NOTE(shess): kFileMagic should not be a byte-wise palindrome, so
 // that byte-order changes force corruption.
 const int32 kFileMagic = 0x600D71FE;
-const int32 kFileVersion = 7;  // SQLite storage was 6...
+const int32 kFileVersion = 8;  // SQLite storage was 6...
+
+// Marks the start of each update segment.
+const int32 kSegmentMagic = 0x5E61E27D;
+
+// Updates are appended to the file as segments until there are
+// |kMaxSegments| of them, or until they would add up to more than
+// 1/|kCompactRatio| of the base section.  Then everything is compacted
+// into a new base section.  Each segment costs a pass of
+// |SBProcessSubs()| whenever the store is read, so this bounds both
+// the extra work and the extra space.
+const int kMaxSegments = 4;
+const int64 kCompactRatio = 4;
 
 // Header at the front of the main database file.
 struct FileHeader {
@@ -22,6 +34,15 @@ struct FileHeader {
   uint32 add_hash_count, sub_hash_count;
 };
 
+// Header for each update segment appended to the main database file.
+struct SegmentHeader {
+  int32 magic;
+  uint32 add_chunk_count, sub_chunk_count;
+  uint32 add_del_count, sub_del_count;
+  uint32 add_prefix_count, sub_prefix_count;
+  uint32 add_hash_count, sub_hash_count;
+};
+
 // Header for each chunk in the chunk-accumulation file.
 struct ChunkHeader {
   uint32 add_prefix_count, sub_prefix_count;
@@ -36,18 +57,6 @@ bool FileRewind(FILE* fp) {
   return rv == 0;
 }
 
-// Move file read pointer forward by |bytes| relative to current position.
-bool FileSkip(size_t bytes, FILE* fp) {
-  // Although fseek takes negative values, for this case, we only want
-  // to skip forward.
-  DCHECK(static_cast<long>(bytes) >= 0);
-  if (static_cast<long>(bytes) < 0)
-    return false;
-  int rv = fseek(fp, static_cast<long>(bytes), SEEK_CUR);
-  DCHECK_EQ(rv, 0);
-  return rv == 0;
-}
-
 // Read from |fp| into |item|, and fold the input data into the
 // checksum in |context|, if non-NULL.  Return true on success.
 template <class T>
@@ -129,24 +138,48 @@ void DeleteChunksFromSet(const base::hash_set<int32>& deleted,
   }
 }
 
+// The size of the base section described by |header|, including the
+// header and the checksum.
+int64 BaseSize(const FileHeader& header) {
+  int64 size = sizeof(FileHeader);
+  size += header.add_chunk_count * sizeof(int32);
+  size += header.sub_chunk_count * sizeof(int32);
+  size += header.add_prefix_count * sizeof(SBAddPrefix);
+  size += header.sub_prefix_count * sizeof(SBSubPrefix);
+  size += header.add_hash_count * sizeof(SBAddFullHash);
+  size += header.sub_hash_count * sizeof(SBSubFullHash);
+  size += sizeof(base::MD5Digest);
+  return size;
+}
+
+// The size of the segment described by |header|, including the header
+// and the checksum.
+int64 SegmentSize(const SegmentHeader& header) {
+  int64 size = sizeof(SegmentHeader);
+  size += header.add_chunk_count * sizeof(int32);
+  size += header.sub_chunk_count * sizeof(int32);
+  size += header.add_del_count * sizeof(int32);
+  size += header.sub_del_count * sizeof(int32);
+  size += header.add_prefix_count * sizeof(SBAddPrefix);
+  size += header.sub_prefix_count * sizeof(SBSubPrefix);
+  size += header.add_hash_count * sizeof(SBAddFullHash);
+  size += header.sub_hash_count * sizeof(SBSubFullHash);
+  size += sizeof(base::MD5Digest);
+  return size;
+}
+
 // Sanity-check the header against the file's size to make sure our
 // vectors aren't gigantic.  This doubles as a cheap way to detect
-// corruption without having to checksum the entire file.
+// corruption without having to checksum the entire file.  The base
+// section may be followed by segments, which are checked as they are
+// read.
 bool FileHeaderSanityCheck(const FilePath& filename,
                            const FileHeader& header) {
   int64 size = 0;
   if (!file_util::GetFileSize(filename, &size))
     return false;
 
-  int64 expected_size = sizeof(FileHeader);
-  expected_size += header.add_chunk_count * sizeof(int32);
-  expected_size += header.sub_chunk_count * sizeof(int32);
-  expected_size += header.add_prefix_count * sizeof(SBAddPrefix);
-  expected_size += header.sub_prefix_count * sizeof(SBSubPrefix);
-  expected_size += header.add_hash_count * sizeof(SBAddFullHash);
-  expected_size += header.sub_hash_count * sizeof(SBSubFullHash);
-  expected_size += sizeof(base::MD5Digest);
-  if (size != expected_size)
+  if (size < BaseSize(header))
     return false;
 
   return true;
@@ -167,6 +200,85 @@ bool ReadAndVerifyHeader(const FilePath& filename,
   return true;
 }
 
+// Read the segment at the current position of |fp| into the given
+// containers, and verify it against its checksum.  |bytes_left| is the
+// amount of file remaining, to make sure the vectors aren't gigantic.
+// Returns false if the segment is truncated or corrupt.
+bool ReadSegment(FILE* fp, int64 bytes_left,
+                 SegmentHeader* header,
+                 std::set<int32>* add_chunks,
+                 std::set<int32>* sub_chunks,
+                 std::vector<int32>* add_del,
+                 std::vector<int32>* sub_del,
+                 SBAddPrefixes* add_prefixes,
+                 std::vector<SBSubPrefix>* sub_prefixes,
+                 std::vector<SBAddFullHash>* add_full_hashes,
+                 std::vector<SBSubFullHash>* sub_full_hashes) {
+  base::MD5Context context;
+  base::MD5Init(&context);
+
+  if (!ReadItem(header, fp, &context))
+    return false;
+  if (header->magic != kSegmentMagic || SegmentSize(*header) > bytes_left)
+    return false;
+
+  if (!ReadToContainer(add_chunks, header->add_chunk_count, fp, &context) ||
+      !ReadToContainer(sub_chunks, header->sub_chunk_count, fp, &context) ||
+      !ReadToContainer(add_del, header->add_del_count, fp, &context) ||
+      !ReadToContainer(sub_del, header->sub_del_count, fp, &context) ||
+      !ReadToContainer(add_prefixes, header->add_prefix_count,
+                       fp, &context) ||
+      !ReadToContainer(sub_prefixes, header->sub_prefix_count,
+                       fp, &context) ||
+      !ReadToContainer(add_full_hashes, header->add_hash_count,
+                       fp, &context) ||
+      !ReadToContainer(sub_full_hashes, header->sub_hash_count,
+                       fp, &context))
+    return false;
+
+  base::MD5Digest calculated_digest;
+  base::MD5Final(&calculated_digest, &context);
+
+  base::MD5Digest file_digest;
+  if (!ReadItem(&file_digest, fp, NULL))
+    return false;
+
+  return 0 == memcmp(&file_digest, &calculated_digest, sizeof(file_digest));
+}
+
+// Write a segment described by |header| to |fp|, followed by its
+// checksum.  Returns true on success.
+bool WriteSegment(const SegmentHeader& header,
+                  const std::set<int32>& add_chunks,
+                  const std::set<int32>& sub_chunks,
+                  const base::hash_set<int32>& add_del,
+                  const base::hash_set<int32>& sub_del,
+                  const SBAddPrefixes& add_prefixes,
+                  const std::vector<SBSubPrefix>& sub_prefixes,
+                  const std::vector<SBAddFullHash>& add_full_hashes,
+                  const std::vector<SBSubFullHash>& sub_full_hashes,
+                  FILE* fp) {
+  base::MD5Context context;
+  base::MD5Init(&context);
+
+  if (!WriteItem(header, fp, &context))
+    return false;
+
+  if (!WriteContainer(add_chunks, fp, &context) ||
+      !WriteContainer(sub_chunks, fp, &context) ||
+      !WriteContainer(add_del, fp, &context) ||
+      !WriteContainer(sub_del, fp, &context) ||
+      !WriteContainer(add_prefixes, fp, &context) ||
+      !WriteContainer(sub_prefixes, fp, &context) ||
+      !WriteContainer(add_full_hashes, fp, &context) ||
+      !WriteContainer(sub_full_hashes, fp, &context))
+    return false;
+
+  base::MD5Digest digest;
+  base::MD5Final(&digest, &context);
+  return WriteItem(digest, fp, NULL);
+}
+
 }  // namespace
 
 // static
@@ -254,19 +366,21 @@ bool SafeBrowsingStoreFile::CheckValidity() {
   if (!FileRewind(file_.get()))
     return OnCorruptDatabase();
 
-  int64 size = 0;
-  if (!file_util::GetFileSize(filename_, &size))
+  // Only the base section is checked.  Damaged segments are ignored
+  // when the store is read, so they cannot make it invalid.
+  FileHeader header;
+  if (!ReadItem(&header, file_.get(), NULL) ||
+      !FileHeaderSanityCheck(filename_, header) ||
+      !FileRewind(file_.get()))
     return OnCorruptDatabase();
 
   base::MD5Context context;
   base::MD5Init(&context);
 
-  // Read everything except the final digest.
+  // Read everything except the base section's digest.
+  const int64 size = BaseSize(header) - sizeof(base::MD5Digest);
   size_t bytes_left = static_cast<size_t>(size);
   CHECK(size == static_cast<int64>(bytes_left));
-  if (bytes_left < sizeof(base::MD5Digest))
-    return OnCorruptDatabase();
-  bytes_left -= sizeof(base::MD5Digest);
 
   // Fold the contents of the file into the checksum.
   while (bytes_left > 0) {
@@ -320,17 +434,20 @@ bool SafeBrowsingStoreFile::GetAddPrefixes(SBAddPrefixes* add_prefixes) {
   file_util::ScopedFILE file(file_util::OpenFile(filename_, "rb"));
   if (file.get() == NULL) return false;
 
-  FileHeader header;
-  if (!ReadAndVerifyHeader(filename_, file.get(), &header, NULL))
+  // The subs and full hashes are needed to fold in the segments.
+  std::set<int32> add_chunks;
+  std::set<int32> sub_chunks;
+  std::vector<SBSubPrefix> sub_prefixes;
+  std::vector<SBAddFullHash> add_full_hashes;
+  std::vector<SBSubFullHash> sub_full_hashes;
+  bool checksum_failure = false;
+  if (!ReadStore(file.get(), &add_chunks, &sub_chunks,
+                 add_prefixes, &sub_prefixes,
+                 &add_full_hashes, &sub_full_hashes,
+                 NULL, NULL, NULL, &checksum_failure)) {
+    add_prefixes->clear();
     return OnCorruptDatabase();
-
-  size_t add_prefix_offset = header.add_chunk_count * sizeof(int32) +
-      header.sub_chunk_count * sizeof(int32);
-  if (!FileSkip(add_prefix_offset, file.get()))
-    return false;
-
-  if (!ReadToContainer(add_prefixes, header.add_prefix_count, file.get(), NULL))
-    return false;
+  }
 
   return true;
 }
@@ -342,22 +459,150 @@ bool SafeBrowsingStoreFile::GetAddFullHashes(
   file_util::ScopedFILE file(file_util::OpenFile(filename_, "rb"));
   if (file.get() == NULL) return false;
 
-  FileHeader header;
-  if (!ReadAndVerifyHeader(filename_, file.get(), &header, NULL))
+  std::set<int32> add_chunks;
+  std::set<int32> sub_chunks;
+  SBAddPrefixes add_prefixes;
+  std::vector<SBSubPrefix> sub_prefixes;
+  std::vector<SBSubFullHash> sub_full_hashes;
+  bool checksum_failure = false;
+  if (!ReadStore(file.get(), &add_chunks, &sub_chunks,
+                 &add_prefixes, &sub_prefixes,
+                 add_full_hashes, &sub_full_hashes,
+                 NULL, NULL, NULL, &checksum_failure)) {
+    add_full_hashes->clear();
     return OnCorruptDatabase();
+  }
+
+  return true;
+}
+
+bool SafeBrowsingStoreFile::ReadStore(
+    FILE* fp,
+    std::set<int32>* add_chunks,
+    std::set<int32>* sub_chunks,
+    SBAddPrefixes* add_prefixes,
+    std::vector<SBSubPrefix>* sub_prefixes,
+    std::vector<SBAddFullHash>* add_full_hashes,
+    std::vector<SBSubFullHash>* sub_full_hashes,
+    int* segment_count,
+    int64* base_size,
+    int64* end_offset,
+    bool* checksum_failure) {
+  *checksum_failure = false;
+
+  if (!FileRewind(fp))
+    return false;
 
-  size_t offset =
-      header.add_chunk_count * sizeof(int32) +
-      header.sub_chunk_count * sizeof(int32) +
-      header.add_prefix_count * sizeof(SBAddPrefix) +
-      header.sub_prefix_count * sizeof(SBSubPrefix);
-  if (!FileSkip(offset, file.get()))
+  int64 size = 0;
+  if (!file_util::GetFileSize(filename_, &size))
     return false;
 
-  return ReadToContainer(add_full_hashes,
-                         header.add_hash_count,
-                         file.get(),
-                         NULL);
+  base::MD5Context context;
+  base::MD5Init(&context);
+
+  // Read the file header and make sure it looks right.
+  FileHeader header;
+  if (!ReadAndVerifyHeader(filename_, fp, &header, &context))
+    return false;
+
+  if (!ReadToContainer(add_chunks, header.add_chunk_count, fp, &context) ||
+      !ReadToContainer(sub_chunks, header.sub_chunk_count, fp, &context) ||
+      !ReadToContainer(add_prefixes, header.add_prefix_count,
+                       fp, &context) ||
+      !ReadToContainer(sub_prefixes, header.sub_prefix_count,
+                       fp, &context) ||
+      !ReadToContainer(add_full_hashes, header.add_hash_count,
+                       fp, &context) ||
+      !ReadToContainer(sub_full_hashes, header.sub_hash_count,
+                       fp, &context))
+    return false;
+
+  // Calculate the digest to this point.
+  base::MD5Digest calculated_digest;
+  base::MD5Final(&calculated_digest, &context);
+
+  // Read the stored checksum and verify it.
+  base::MD5Digest file_digest;
+  if (!ReadItem(&file_digest, fp, NULL))
+    return false;
+
+  if (0 != memcmp(&file_digest, &calculated_digest, sizeof(file_digest))) {
+    *checksum_failure = true;
+    return false;
+  }
+
+  if (base_size)
+    *base_size = BaseSize(header);
+
+  ReadSegments(fp, BaseSize(header), size, add_chunks, sub_chunks,
+               add_prefixes, sub_prefixes, add_full_hashes, sub_full_hashes,
+               segment_count, end_offset);
+  return true;
+}
+
+void SafeBrowsingStoreFile::ReadSegments(
+    FILE* fp, int64 offset, int64 size,
+    std::set<int32>* add_chunks,
+    std::set<int32>* sub_chunks,
+    SBAddPrefixes* add_prefixes,
+    std::vector<SBSubPrefix>* sub_prefixes,
+    std::vector<SBAddFullHash>* add_full_hashes,
+    std::vector<SBSubFullHash>* sub_full_hashes,
+    int* segment_count,
+    int64* end_offset) {
+  int count = 0;
+  while (offset < size) {
+    // Read into temporaries, so that a damaged segment leaves the
+    // data as of the previous segment.
+    SegmentHeader header;
+    std::set<int32> segment_add_chunks;
+    std::set<int32> segment_sub_chunks;
+    std::vector<int32> add_del;
+    std::vector<int32> sub_del;
+    SBAddPrefixes segment_add_prefixes;
+    std::vector<SBSubPrefix> segment_sub_prefixes;
+    std::vector<SBAddFullHash> segment_add_full_hashes;
+    std::vector<SBSubFullHash> segment_sub_full_hashes;
+    if (fseek(fp, static_cast<long>(offset), SEEK_SET) != 0 ||
+        !ReadSegment(fp, size - offset, &header,
+                     &segment_add_chunks, &segment_sub_chunks,
+                     &add_del, &sub_del,
+                     &segment_add_prefixes, &segment_sub_prefixes,
+                     &segment_add_full_hashes, &segment_sub_full_hashes)) {
+      RecordFormatEvent(FORMAT_EVENT_SEGMENT_DROPPED);
+      break;
+    }
+
+    add_chunks->swap(segment_add_chunks);
+    sub_chunks->swap(segment_sub_chunks);
+
+    if (add_prefixes) {
+      add_prefixes->insert(add_prefixes->end(),
+                           segment_add_prefixes.begin(),
+                           segment_add_prefixes.end());
+      sub_prefixes->insert(sub_prefixes->end(),
+                           segment_sub_prefixes.begin(),
+                           segment_sub_prefixes.end());
+      add_full_hashes->insert(add_full_hashes->end(),
+                              segment_add_full_hashes.begin(),
+                              segment_add_full_hashes.end());
+      sub_full_hashes->insert(sub_full_hashes->end(),
+                              segment_sub_full_hashes.begin(),
+                              segment_sub_full_hashes.end());
+      SBProcessSubs(add_prefixes, sub_prefixes,
+                    add_full_hashes, sub_full_hashes,
+                    base::hash_set<int32>(add_del.begin(), add_del.end()),
+                    base::hash_set<int32>(sub_del.begin(), sub_del.end()));
+    }
+
+    offset += SegmentSize(header);
+    ++count;
+  }
+
+  if (segment_count)
+    *segment_count = count;
+  if (end_offset)
+    *end_offset = offset;
 }
 
 bool SafeBrowsingStoreFile::WriteAddHash(int32 chunk_id,
@@ -469,6 +714,14 @@ bool SafeBrowsingStoreFile::BeginUpdate() {
                        file.get(), NULL))
     return OnCorruptDatabase();
 
+  // Each segment carries the chunks-seen data as of its update.
+  int64 size = 0;
+  if (!file_util::GetFileSize(filename_, &size))
+    return OnCorruptDatabase();
+  ReadSegments(file.get(), BaseSize(header), size,
+               &add_chunks_cache_, &sub_chunks_cache_,
+               NULL, NULL, NULL, NULL, NULL, NULL);
+
   file_.swap(file);
   new_file_.swap(new_file);
   return true;
@@ -514,51 +767,27 @@ bool SafeBrowsingStoreFile::DoUpdate(
   std::vector<SBAddFullHash> add_full_hashes;
   std::vector<SBSubFullHash> sub_full_hashes;
 
+  // Where the base section and the segments end in |file_|.
+  int segment_count = 0;
+  int64 base_size = 0;
+  int64 end_offset = 0;
+
   // Read original data into the vectors.
   if (!empty_) {
     DCHECK(file_.get());
 
-    if (!FileRewind(file_.get()))
-      return OnCorruptDatabase();
-
-    base::MD5Context context;
-    base::MD5Init(&context);
-
-    // Read the file header and make sure it looks right.
-    FileHeader header;
-    if (!ReadAndVerifyHeader(filename_, file_.get(), &header, &context))
-      return OnCorruptDatabase();
-
-    // Re-read the chunks-seen data to get to the later data in the
-    // file and calculate the checksum.  No new elements should be
-    // added to the sets.
-    if (!ReadToContainer(&add_chunks_cache_, header.add_chunk_count,
-                         file_.get(), &context) ||
-        !ReadToContainer(&sub_chunks_cache_, header.sub_chunk_count,
-                         file_.get(), &context))
-      return OnCorruptDatabase();
-
-    if (!ReadToContainer(&add_prefixes, header.add_prefix_count,
-                         file_.get(), &context) ||
-        !ReadToContainer(&sub_prefixes, header.sub_prefix_count,
-                         file_.get(), &context) ||
-        !ReadToContainer(&add_full_hashes, header.add_hash_count,
-                         file_.get(), &context) ||
-        !ReadToContainer(&sub_full_hashes, header.sub_hash_count,
-                         file_.get(), &context))
-      return OnCorruptDatabase();
-
-    // Calculate the digest to this point.
-    base::MD5Digest calculated_digest;
-    base::MD5Final(&calculated_digest, &context);
-
-    // Read the stored checksum and verify it.
-    base::MD5Digest file_digest;
-    if (!ReadItem(&file_digest, file_.get(), NULL))
-      return OnCorruptDatabase();
-
-    if (0 != memcmp(&file_digest, &calculated_digest, sizeof(file_digest))) {
-      RecordFormatEvent(FORMAT_EVENT_UPDATE_CHECKSUM_FAILURE);
+    // The chunks-seen data was read by |BeginUpdate()|, and may have
+    // been changed since.
+    std::set<int32> add_chunks;
+    std::set<int32> sub_chunks;
+    bool checksum_failure = false;
+    if (!ReadStore(file_.get(), &add_chunks, &sub_chunks,
+                   &add_prefixes, &sub_prefixes,
+                   &add_full_hashes, &sub_full_hashes,
+                   &segment_count, &base_size, &end_offset,
+                   &checksum_failure)) {
+      if (checksum_failure)
+        RecordFormatEvent(FORMAT_EVENT_UPDATE_CHECKSUM_FAILURE);
       return OnCorruptDatabase();
     }
 
@@ -582,7 +811,12 @@ bool SafeBrowsingStoreFile::DoUpdate(
   UMA_HISTOGRAM_COUNTS("SB2.DatabaseUpdateKilobytes",
                        std::max(static_cast<int>(size / 1024), 1));
 
-  // Append the accumulated chunks onto the vectors read from |file_|.
+  // Read the accumulated chunks, which are kept apart from the
+  // vectors read from |file_| in case they are appended as a segment.
+  SBAddPrefixes update_add_prefixes;
+  std::vector<SBSubPrefix> update_sub_prefixes;
+  std::vector<SBAddFullHash> update_add_full_hashes;
+  std::vector<SBSubFullHash> update_sub_full_hashes;
   for (int i = 0; i < chunks_written_; ++i) {
     ChunkHeader header;
 
@@ -610,20 +844,32 @@ bool SafeBrowsingStoreFile::DoUpdate(
     // some sort of recursive binary merge might be in order (merge
     // chunks pairwise, merge those chunks pairwise, and so on, then
     // merge the result with the main list).
-    if (!ReadToContainer(&add_prefixes, header.add_prefix_count,
+    if (!ReadToContainer(&update_add_prefixes, header.add_prefix_count,
                          new_file_.get(), NULL) ||
-        !ReadToContainer(&sub_prefixes, header.sub_prefix_count,
+        !ReadToContainer(&update_sub_prefixes, header.sub_prefix_count,
                          new_file_.get(), NULL) ||
-        !ReadToContainer(&add_full_hashes, header.add_hash_count,
+        !ReadToContainer(&update_add_full_hashes, header.add_hash_count,
                          new_file_.get(), NULL) ||
-        !ReadToContainer(&sub_full_hashes, header.sub_hash_count,
+        !ReadToContainer(&update_sub_full_hashes, header.sub_hash_count,
                          new_file_.get(), NULL))
       return false;
   }
 
   // Append items from |pending_adds|.
+  update_add_full_hashes.insert(update_add_full_hashes.end(),
+                                pending_adds.begin(), pending_adds.end());
+
+  // Append the update onto the vectors read from |file_|.
+  add_prefixes.insert(add_prefixes.end(),
+                      update_add_prefixes.begin(), update_add_prefixes.end());
+  sub_prefixes.insert(sub_prefixes.end(),
+                      update_sub_prefixes.begin(), update_sub_prefixes.end());
   add_full_hashes.insert(add_full_hashes.end(),
-                         pending_adds.begin(), pending_adds.end());
+                         update_add_full_hashes.begin(),
+                         update_add_full_hashes.end());
+  sub_full_hashes.insert(sub_full_hashes.end(),
+                         update_sub_full_hashes.begin(),
+                         update_sub_full_hashes.end());
 
   // Check how often a prefix was checked which wasn't in the
   // database.
@@ -638,54 +884,98 @@ bool SafeBrowsingStoreFile::DoUpdate(
   DeleteChunksFromSet(add_del_cache_, &add_chunks_cache_);
   DeleteChunksFromSet(sub_del_cache_, &sub_chunks_cache_);
 
-  // Write the new data to new_file_.
-  if (!FileRewind(new_file_.get()))
-    return false;
+  SegmentHeader segment_header;
+  segment_header.magic = kSegmentMagic;
+  segment_header.add_chunk_count = add_chunks_cache_.size();
+  segment_header.sub_chunk_count = sub_chunks_cache_.size();
+  segment_header.add_del_count = add_del_cache_.size();
+  segment_header.sub_del_count = sub_del_cache_.size();
+  segment_header.add_prefix_count = update_add_prefixes.size();
+  segment_header.sub_prefix_count = update_sub_prefixes.size();
+  segment_header.add_hash_count = update_add_full_hashes.size();
+  segment_header.sub_hash_count = update_sub_full_hashes.size();
+
+  // Small updates are appended to the file, rather than rewriting all
+  // of it.  Anything past |end_offset| is a damaged segment which
+  // |ReadStore()| ignored, and is overwritten.
+  const int64 segments_size =
+      end_offset - base_size + SegmentSize(segment_header);
+  const bool append = !empty_ && segment_count < kMaxSegments &&
+      segments_size * kCompactRatio <= base_size;
+  UMA_HISTOGRAM_BOOLEAN("SB2.DatabaseUpdateAppended", append);
+  if (append) {
+    file_util::ScopedFILE file(file_util::OpenFile(filename_, "rb+"));
+    if (file.get() == NULL)
+      return false;
 
-  base::MD5Context context;
-  base::MD5Init(&context);
+    if (fseek(file.get(), static_cast<long>(end_offset), SEEK_SET) != 0)
+      return false;
 
-  // Write a file header.
-  FileHeader header;
-  header.magic = kFileMagic;
-  header.version = kFileVersion;
-  header.add_chunk_count = add_chunks_cache_.size();
-  header.sub_chunk_count = sub_chunks_cache_.size();
-  header.add_prefix_count = add_prefixes.size();
-  header.sub_prefix_count = sub_prefixes.size();
-  header.add_hash_count = add_full_hashes.size();
-  header.sub_hash_count = sub_full_hashes.size();
-  if (!WriteItem(header, new_file_.get(), &context))
-    return false;
+    if (!WriteSegment(segment_header,
+                      add_chunks_cache_, sub_chunks_cache_,
+                      add_del_cache_, sub_del_cache_,
+                      update_add_prefixes, update_sub_prefixes,
+                      update_add_full_hashes, update_sub_full_hashes,
+                      file.get()))
+      return false;
 
-  // Write all the chunk data.
-  if (!WriteContainer(add_chunks_cache_, new_file_.get(), &context) ||
-      !WriteContainer(sub_chunks_cache_, new_file_.get(), &context) ||
-      !WriteContainer(add_prefixes, new_file_.get(), &context) ||
-      !WriteContainer(sub_prefixes, new_file_.get(), &context) ||
-      !WriteContainer(add_full_hashes, new_file_.get(), &context) ||
-      !WriteContainer(sub_full_hashes, new_file_.get(), &context))
-    return false;
+    if (!file_util::TruncateFile(file.get()))
+      return false;
+    file.reset();
 
-  // Write the checksum at the end.
-  base::MD5Digest digest;
-  base::MD5Final(&digest, &context);
-  if (!WriteItem(digest, new_file_.get(), NULL))
-    return false;
+    // The temporary file is not needed to commit.
+    new_file_.reset();
+    file_util::Delete(TemporaryFileForFilename(filename_), false);
+  } else {
+    // Write the new data to new_file_.
+    if (!FileRewind(new_file_.get()))
+      return false;
 
-  // Trim any excess left over from the temporary chunk data.
-  if (!file_util::TruncateFile(new_file_.get()))
-    return false;
+    base::MD5Context context;
+    base::MD5Init(&context);
 
-  // Close the file handle and swizzle the file into place.
-  new_file_.reset();
-  if (!file_util::Delete(filename_, false) &&
-      file_util::PathExists(filename_))
-    return false;
+    // Write a file header.
+    FileHeader header;
+    header.magic = kFileMagic;
+    header.version = kFileVersion;
+    header.add_chunk_count = add_chunks_cache_.size();
+    header.sub_chunk_count = sub_chunks_cache_.size();
+    header.add_prefix_count = add_prefixes.size();
+    header.sub_prefix_count = sub_prefixes.size();
+    header.add_hash_count = add_full_hashes.size();
+    header.sub_hash_count = sub_full_hashes.size();
+    if (!WriteItem(header, new_file_.get(), &context))
+      return false;
 
-  const FilePath new_filename = TemporaryFileForFilename(filename_);
-  if (!file_util::Move(new_filename, filename_))
-    return false;
+    // Write all the chunk data.
+    if (!WriteContainer(add_chunks_cache_, new_file_.get(), &context) ||
+        !WriteContainer(sub_chunks_cache_, new_file_.get(), &context) ||
+        !WriteContainer(add_prefixes, new_file_.get(), &context) ||
+        !WriteContainer(sub_prefixes, new_file_.get(), &context) ||
+        !WriteContainer(add_full_hashes, new_file_.get(), &context) ||
+        !WriteContainer(sub_full_hashes, new_file_.get(), &context))
+      return false;
+
+    // Write the checksum at the end.
+    base::MD5Digest digest;
+    base::MD5Final(&digest, &context);
+    if (!WriteItem(digest, new_file_.get(), NULL))
+      return false;
+
+    // Trim any excess left over from the temporary chunk data.
+    if (!file_util::TruncateFile(new_file_.get()))
+      return false;
+
+    // Close the file handle and swizzle the file into place.
+    new_file_.reset();
+    if (!file_util::Delete(filename_, false) &&
+        file_util::PathExists(filename_))
+      return false;
+
+    const FilePath new_filename = TemporaryFileForFilename(filename_);
+    if (!file_util::Move(new_filename, filename_))
+      return false;
+  }
 
   // Record counts before swapping to caller.
   UMA_HISTOGRAM_COUNTS("SB2.AddPrefixes", add_prefixes.size());
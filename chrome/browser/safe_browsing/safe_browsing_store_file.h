@@ -15,7 +15,7 @@
 #include "base/file_util.h"
 
 // Implement SafeBrowsingStore in terms of a flat file.  The file
-// format is pretty literal:
+// format is pretty literal.  It starts with a base section:
 //
 // int32 magic;             // magic number "validating" file
 // int32 version;           // format version
@@ -54,6 +54,44 @@
 // }
 // MD5Digest checksum;      // Checksum over preceeding data.
 //
+// The base section is followed by zero or more update segments, each
+// holding the data of one update which was appended to the file
+// rather than merged into the base section:
+//
+// int32 magic;             // segment magic number
+//
+// uint32 add_chunk_count;   // Chunks seen after the update.
+// uint32 sub_chunk_count;
+// uint32 add_del_count;     // Chunks deleted by the update.
+// uint32 sub_del_count;
+// uint32 add_prefix_count;  // Data added by the update.
+// uint32 sub_prefix_count;
+// uint32 add_hash_count;
+// uint32 sub_hash_count;
+//
+// array[add_chunk_count] {
+//   int32 chunk_id;
+// }
+// array[sub_chunk_count] {
+//   int32 chunk_id;
+// }
+// array[add_del_count] {
+//   int32 chunk_id;
+// }
+// array[sub_del_count] {
+//   int32 chunk_id;
+// }
+// ... prefix and hash arrays as in the base section ...
+// MD5Digest checksum;      // Checksum over the segment.
+//
+// The chunks-seen data is small, so each segment carries all of it
+// rather than the changes.  When reading, each segment is folded into
+// the data with SBProcessSubs() exactly as the update which appended
+// it did.  Segments are appended without an fsync(), so a segment
+// which is truncated or fails its checksum is taken to be the remains
+// of an interrupted update.  It and any later segments are ignored,
+// and the chunks they held will be requested again.
+//
 // During the course of an update, uncommitted data is stored in a
 // temporary file (which is later re-used to commit).  This is an
 // array of chunks, with the count kept in memory until the end of the
@@ -91,12 +129,16 @@
 // - Open a temp file for storing new chunk info.
 // - Write new chunks to the temp file.
 // - When the transaction is finished:
-//   - Read the rest of the original file's data into buffers.
+//   - Read the rest of the original file's data into buffers, folding
+//     in its segments.
 //   - Rewind the temp file and merge the new data into buffers.
 //   - Process buffers for deletions and apply subs.
-//   - Rewind and write the buffers out to temp file.
-//   - Delete original file.
-//   - Rename temp file to original filename.
+//   - If the segments are still small compared to the base section,
+//     append the new data to the original file as a segment.
+//   - Otherwise compact:
+//     - Rewind and write the buffers out to temp file.
+//     - Delete original file.
+//     - Rename temp file to original filename.
 
 // TODO(shess): By using a checksum, this code can avoid doing an
 // fsync(), at the possible cost of more frequently retrieving the
@@ -200,6 +242,10 @@ class SafeBrowsingStoreFile : public SafeBrowsingStore {
     FORMAT_EVENT_VALIDITY_CHECKSUM_FAILURE,
     FORMAT_EVENT_UPDATE_CHECKSUM_FAILURE,
 
+    // An update segment was truncated or failed its checksum, and was
+    // ignored along with any later segments.
+    FORMAT_EVENT_SEGMENT_DROPPED,
+
     // Memory space for histograms is determined by the max.  ALWAYS
     // ADD NEW VALUES BEFORE THIS ONE.
     FORMAT_EVENT_MAX
@@ -216,6 +262,43 @@ class SafeBrowsingStoreFile : public SafeBrowsingStore {
   // practically speaking that code doesn't touch files directly.
   static void CheckForOriginalAndDelete(const FilePath& filename);
 
+  // Read the store from |fp|: the base section, with each update
+  // segment folded in after it.  |add_chunks| and |sub_chunks|
+  // receive the chunks seen as of the last segment.  If non-NULL,
+  // |segment_count| receives the number of segments read, and
+  // |base_size| and |end_offset| the offsets at which the base section
+  // and the last segment end.  Returns false if the base section is
+  // corrupt, setting |*checksum_failure| if its checksum did not
+  // match.
+  bool ReadStore(FILE* fp,
+                 std::set<int32>* add_chunks,
+                 std::set<int32>* sub_chunks,
+                 SBAddPrefixes* add_prefixes,
+                 std::vector<SBSubPrefix>* sub_prefixes,
+                 std::vector<SBAddFullHash>* add_full_hashes,
+                 std::vector<SBSubFullHash>* sub_full_hashes,
+                 int* segment_count,
+                 int64* base_size,
+                 int64* end_offset,
+                 bool* checksum_failure);
+
+  // Read the update segments from |offset| to the end of |fp|, which
+  // is |size| bytes long, replacing |add_chunks| and |sub_chunks| with
+  // each segment's chunks-seen data.  If |add_prefixes| is non-NULL,
+  // each segment's data is also folded into the data vectors.  Reading
+  // stops at the first damaged segment.  If non-NULL, |segment_count|
+  // and |end_offset| receive the number of segments read and the offset
+  // at which the last one ends.
+  void ReadSegments(FILE* fp, int64 offset, int64 size,
+                    std::set<int32>* add_chunks,
+                    std::set<int32>* sub_chunks,
+                    SBAddPrefixes* add_prefixes,
+                    std::vector<SBSubPrefix>* sub_prefixes,
+                    std::vector<SBAddFullHash>* add_full_hashes,
+                    std::vector<SBSubFullHash>* sub_full_hashes,
+                    int* segment_count,
+                    int64* end_offset);
+
   // Close all files and clear all buffers.
   bool Close();
 
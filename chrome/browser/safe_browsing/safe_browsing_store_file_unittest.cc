@@ -44,6 +44,55 @@ class SafeBrowsingStoreFileTest : public PlatformTest {
     corruption_detected_ = true;
   }
 
+  // Run an update which adds |count| prefixes in add chunk |chunk_id|,
+  // and, if |sub_prefix| is non-zero, subs it from |sub_add_chunk_id|
+  // in sub chunk |chunk_id|.
+  void UpdateStore(int32 chunk_id, int count,
+                   int32 sub_add_chunk_id, SBPrefix sub_prefix) {
+    ASSERT_TRUE(store_->BeginUpdate());
+    EXPECT_TRUE(store_->BeginChunk());
+    store_->SetAddChunk(chunk_id);
+    for (int i = 0; i < count; ++i) {
+      EXPECT_TRUE(store_->WriteAddPrefix(chunk_id, chunk_id * 1000 + i));
+    }
+    if (sub_prefix) {
+      store_->SetSubChunk(chunk_id);
+      EXPECT_TRUE(store_->WriteSubPrefix(chunk_id, sub_add_chunk_id,
+                                         sub_prefix));
+    }
+    EXPECT_TRUE(store_->FinishChunk());
+
+    std::vector<SBAddFullHash> pending_adds;
+    std::set<SBPrefix> prefix_misses;
+    SBAddPrefixes add_prefixes;
+    std::vector<SBAddFullHash> add_hashes;
+    EXPECT_TRUE(store_->FinishUpdate(pending_adds, prefix_misses,
+                                     &add_prefixes, &add_hashes));
+  }
+
+  // The add-prefix count in the header of the base section.
+  uint32 BaseAddPrefixCount() {
+    file_util::ScopedFILE file(file_util::OpenFile(filename_, "rb"));
+    const long kAddPrefixCountOffset = 4 * sizeof(int32);
+    uint32 count = 0;
+    EXPECT_EQ(0, fseek(file.get(), kAddPrefixCountOffset, SEEK_SET));
+    EXPECT_EQ(1U, fread(&count, sizeof(count), 1, file.get()));
+    return count;
+  }
+
+  // The add prefixes and add chunks a fresh store reads from the file.
+  void ReadStore(SBAddPrefixes* add_prefixes, std::vector<int32>* chunks) {
+    store_.reset(new SafeBrowsingStoreFile());
+    store_->Init(filename_,
+                 base::Bind(&SafeBrowsingStoreFileTest::OnCorruptionDetected,
+                            base::Unretained(this)));
+    EXPECT_TRUE(store_->GetAddPrefixes(add_prefixes));
+    EXPECT_TRUE(store_->BeginUpdate());
+    store_->GetAddChunks(chunks);
+    EXPECT_TRUE(store_->CheckValidity());
+    EXPECT_TRUE(store_->CancelUpdate());
+  }
+
   ScopedTempDir temp_dir_;
   FilePath filename_;
   scoped_ptr<SafeBrowsingStoreFile> store_;
@@ -193,4 +242,80 @@ TEST_F(SafeBrowsingStoreFileTest, CheckValidityChecksum) {
   EXPECT_TRUE(store_->CancelUpdate());
 }
 
+// Small updates are appended to the file, and read back along with
+// the base section.
+TEST_F(SafeBrowsingStoreFileTest, AppendsSegments) {
+  const int kBaseCount = 100;
+  UpdateStore(1, kBaseCount, 0, 0);
+  EXPECT_EQ(static_cast<uint32>(kBaseCount), BaseAddPrefixCount());
+
+  // Adds a prefix and knocks one out of the base section.
+  UpdateStore(2, 1, 1, 1000);
+  EXPECT_EQ(static_cast<uint32>(kBaseCount), BaseAddPrefixCount());
+  EXPECT_FALSE(file_util::PathExists(
+      SafeBrowsingStoreFile::TemporaryFileForFilename(filename_)));
+
+  SBAddPrefixes add_prefixes;
+  std::vector<int32> chunks;
+  ReadStore(&add_prefixes, &chunks);
+  EXPECT_EQ(static_cast<size_t>(kBaseCount), add_prefixes.size());
+  for (size_t i = 0; i < add_prefixes.size(); ++i)
+    EXPECT_NE(1000, add_prefixes[i].prefix);
+  ASSERT_EQ(2U, chunks.size());
+  EXPECT_EQ(1, chunks[0]);
+  EXPECT_EQ(2, chunks[1]);
+  EXPECT_FALSE(corruption_detected_);
+}
+
+// A truncated segment is dropped, leaving the store as it was before
+// that update, and later updates overwrite it.
+TEST_F(SafeBrowsingStoreFileTest, DropsTornSegment) {
+  UpdateStore(1, 100, 0, 0);
+  int64 base_size = 0;
+  ASSERT_TRUE(file_util::GetFileSize(filename_, &base_size));
+
+  UpdateStore(2, 1, 0, 0);
+  int64 size = 0;
+  ASSERT_TRUE(file_util::GetFileSize(filename_, &size));
+  ASSERT_GT(size, base_size);
+  {
+    file_util::ScopedFILE file(file_util::OpenFile(filename_, "rb+"));
+    ASSERT_EQ(0, fseek(file.get(), static_cast<long>(size - 1), SEEK_SET));
+    ASSERT_TRUE(file_util::TruncateFile(file.get()));
+  }
+
+  SBAddPrefixes add_prefixes;
+  std::vector<int32> chunks;
+  ReadStore(&add_prefixes, &chunks);
+  EXPECT_EQ(100U, add_prefixes.size());
+  ASSERT_EQ(1U, chunks.size());
+  EXPECT_EQ(1, chunks[0]);
+
+  UpdateStore(3, 1, 0, 0);
+  ReadStore(&add_prefixes, &chunks);
+  EXPECT_EQ(101U, add_prefixes.size());
+  ASSERT_EQ(2U, chunks.size());
+  EXPECT_EQ(1, chunks[0]);
+  EXPECT_EQ(3, chunks[1]);
+  EXPECT_FALSE(corruption_detected_);
+}
+
+// Enough small updates get compacted into a new base section.
+TEST_F(SafeBrowsingStoreFileTest, CompactsSegments) {
+  UpdateStore(1, 100, 0, 0);
+
+  const int kUpdates = 10;
+  for (int i = 0; i < kUpdates; ++i) {
+    UpdateStore(i + 2, 1, 0, 0);
+  }
+  EXPECT_GT(BaseAddPrefixCount(), 100U);
+
+  SBAddPrefixes add_prefixes;
+  std::vector<int32> chunks;
+  ReadStore(&add_prefixes, &chunks);
+  EXPECT_EQ(static_cast<size_t>(100 + kUpdates), add_prefixes.size());
+  EXPECT_EQ(static_cast<size_t>(1 + kUpdates), chunks.size());
+  EXPECT_FALSE(corruption_detected_);
+}
+
 }  // namespace
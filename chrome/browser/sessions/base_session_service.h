@@ -70,6 +70,11 @@ class BaseSessionService : public CancelableRequestProvider,
         : CancelableRequest<InternalGetCommandsCallback>(callback) {
     }
 
+    // Invoked on the backend thread once the backend has filled in
+    // |commands|, before the result is forwarded. Subclasses can override
+    // this to decode the commands without tying up the UI thread.
+    virtual void OnCommandsRead() {}
+
     // The commands. The backend fills this in for us.
     std::vector<SessionCommand*> commands;
 
@@ -134,21 +139,21 @@ class BaseSessionService : public CancelableRequestProvider,
   // Converts a SessionCommand previously created by
   // CreateUpdateTabNavigationCommand into a TabNavigation. Returns true
   // on success. If successful |tab_id| is set to the id of the restored tab.
-  bool RestoreUpdateTabNavigationCommand(const SessionCommand& command,
-                                         TabNavigation* navigation,
-                                         SessionID::id_type* tab_id);
+  static bool RestoreUpdateTabNavigationCommand(const SessionCommand& command,
+                                                TabNavigation* navigation,
+                                                SessionID::id_type* tab_id);
 
   // Extracts a SessionCommand as previously created by
   // CreateSetTabExtensionAppIDCommand into the tab id and application
   // extension id.
-  bool RestoreSetTabExtensionAppIDCommand(
+  static bool RestoreSetTabExtensionAppIDCommand(
       const SessionCommand& command,
       SessionID::id_type* tab_id,
       std::string* extension_app_id);
 
   // Extracts a SessionCommand as previously created by
   // CreateSetWindowAppNameCommand into the window id and application name.
-  bool RestoreSetWindowAppNameCommand(
+  static bool RestoreSetWindowAppNameCommand(
       const SessionCommand& command,
       SessionID::id_type* window_id,
       std::string* app_name);
@@ -13,10 +13,18 @@
 #include "net/base/file_stream.h"
 #include "net/base/net_errors.h"
 
+#if defined(USE_SYSTEM_ZLIB)
+#include <zlib.h>
+#else
+#include "third_party/zlib/zlib.h"
+#endif
+
 using base::TimeTicks;
 
-// File version number.
-static const int32 kFileCurrentVersion = 1;
+// File version numbers. Version 1 files hold a plain sequence of commands,
+// version 2 files a sequence of checksummed segments of commands.
+static const int32 kFileVersionWithoutSegments = 1;
+static const int32 kFileCurrentVersion = 2;
 
 // The signature at the beginning of the file = SSNS (Sessions).
 static const int32 kFileSignature = 0x53534E53;
@@ -30,6 +38,64 @@ struct FileHeader {
   int32 version;
 };
 
+// Each AppendCommands() writes its commands as a single segment: this header
+// followed by the commands. A write cut short by a crash leaves a segment whose
+// checksum doesn't match, which is dropped as a whole when reading.
+struct SegmentHeader {
+  // The number of bytes of commands following the header.
+  uint32 payload_size;
+  // CRC-32 of the commands.
+  uint32 checksum;
+  // Combination of the kSegment* flags.
+  uint32 flags;
+};
+
+// Set on segments which replace all the commands before them, written when the
+// file is reset without being compacted.
+const uint32 kSegmentResetsSession = 1 << 0;
+
+// Segments bigger than this are taken to be corrupt.
+const uint32 kMaxSegmentSize = 16 * 1024 * 1024;
+
+uint32 SegmentChecksum(const std::string& payload) {
+  uLong crc = crc32(0L, Z_NULL, 0);
+  return static_cast<uint32>(crc32(
+      crc, reinterpret_cast<const Bytef*>(payload.data()),
+      static_cast<uInt>(payload.size())));
+}
+
+// Appends the commands encoded in |payload| to |commands|. Returns false if
+// |payload| doesn't hold a whole number of commands.
+bool DecodeSegment(const std::string& payload,
+                   std::vector<SessionCommand*>* commands) {
+  typedef SessionCommand::id_type id_type;
+  typedef SessionCommand::size_type size_type;
+  size_t position = 0;
+  while (position < payload.size()) {
+    size_type command_size;
+    if (payload.size() - position < sizeof(command_size))
+      return false;
+    memcpy(&command_size, &(payload[position]), sizeof(command_size));
+    position += sizeof(command_size);
+    // NOTE: command_size includes the size of the id, which is not part of
+    // the contents of the SessionCommand.
+    if (command_size < sizeof(id_type) ||
+        command_size > payload.size() - position) {
+      return false;
+    }
+    const id_type command_id = payload[position];
+    SessionCommand* command =
+        new SessionCommand(command_id, command_size - sizeof(id_type));
+    if (command_size > sizeof(id_type)) {
+      memcpy(command->contents(), &(payload[position + sizeof(id_type)]),
+             command_size - sizeof(id_type));
+    }
+    commands->push_back(command);
+    position += command_size;
+  }
+  return true;
+}
+
 // SessionFileReader ----------------------------------------------------------
 
 // SessionFileReader is responsible for reading the set of SessionCommands that
@@ -58,6 +124,12 @@ class SessionFileReader {
             std::vector<SessionCommand*>* commands);
 
  private:
+  // Reads the segments of a version 2 file, adding the commands of those
+  // after the last one which resets the session to |commands|. Reading stops
+  // at the first incomplete or corrupt segment, keeping the commands before it.
+  void ReadSegments(BaseSessionService::SessionType type,
+                    std::vector<SessionCommand*>* commands);
+
   // Reads a single command, returning it. A return value of NULL indicates
   // either there are no commands, or there was an error. Use errored_ to
   // distinguish the two. If NULL is returned, and there is no error, it means
@@ -98,13 +170,18 @@ bool SessionFileReader::Read(BaseSessionService::SessionType type,
   read_count = file_->ReadUntilComplete(reinterpret_cast<char*>(&header),
                                         sizeof(header));
   if (read_count != sizeof(header) || header.signature != kFileSignature ||
-      header.version != kFileCurrentVersion)
+      (header.version != kFileCurrentVersion &&
+       header.version != kFileVersionWithoutSegments))
     return false;
 
   ScopedVector<SessionCommand> read_commands;
-  SessionCommand* command;
-  while ((command = ReadCommand()) && !errored_)
-    read_commands->push_back(command);
+  if (header.version == kFileCurrentVersion) {
+    ReadSegments(type, &(read_commands.get()));
+  } else {
+    SessionCommand* command;
+    while ((command = ReadCommand()) && !errored_)
+      read_commands->push_back(command);
+  }
   if (!errored_)
     read_commands->swap(*commands);
   if (type == BaseSessionService::TAB_RESTORE) {
@@ -117,6 +194,59 @@ bool SessionFileReader::Read(BaseSessionService::SessionType type,
   return !errored_;
 }
 
+void SessionFileReader::ReadSegments(BaseSessionService::SessionType type,
+                                     std::vector<SessionCommand*>* commands) {
+  // Only the segments after the last reset are decoded.
+  std::vector<std::string> live_payloads;
+  bool torn = false;
+  for (;;) {
+    SegmentHeader header;
+    int read_count = file_->ReadUntilComplete(
+        reinterpret_cast<char*>(&header), sizeof(header));
+    if (read_count == 0)
+      break;
+    if (read_count < 0) {
+      errored_ = true;
+      return;
+    }
+    if (read_count != sizeof(header) || header.payload_size > kMaxSegmentSize) {
+      torn = true;
+      break;
+    }
+    std::string payload(header.payload_size, 0);
+    if (header.payload_size > 0) {
+      read_count = file_->ReadUntilComplete(&(payload[0]),
+                                            header.payload_size);
+      if (read_count < 0) {
+        errored_ = true;
+        return;
+      }
+      if (static_cast<uint32>(read_count) != header.payload_size) {
+        torn = true;
+        break;
+      }
+    }
+    if (SegmentChecksum(payload) != header.checksum) {
+      torn = true;
+      break;
+    }
+    if (header.flags & kSegmentResetsSession)
+      live_payloads.clear();
+    live_payloads.push_back(std::string());
+    live_payloads.back().swap(payload);
+  }
+
+  if (type == BaseSessionService::TAB_RESTORE)
+    UMA_HISTOGRAM_BOOLEAN("TabRestore.read_torn_segment", torn);
+  else
+    UMA_HISTOGRAM_BOOLEAN("SessionRestore.read_torn_segment", torn);
+
+  for (size_t i = 0; i < live_payloads.size(); ++i) {
+    if (!DecodeSegment(live_payloads[i], commands))
+      return;
+  }
+}
+
 SessionCommand* SessionFileReader::ReadCommand() {
   // Make sure there is enough in the buffer for the size of the next command.
   if (available_count_ < sizeof(size_type)) {
@@ -198,13 +328,17 @@ static const char* kLastSessionFileName = "Last Session";
 // static
 const int SessionBackend::kFileReadBufferSize = 1024;
 
+// static
+const int SessionBackend::kCompactFileSize = 512 * 1024;
+
 SessionBackend::SessionBackend(BaseSessionService::SessionType type,
                                const FilePath& path_to_dir)
     : type_(type),
       path_to_dir_(path_to_dir),
       last_session_valid_(false),
       inited_(false),
-      empty_file_(true) {
+      empty_file_(true),
+      current_file_size_(0) {
   // NOTE: this is invoked on the main thread, don't do file access here.
 }
 
@@ -226,13 +360,18 @@ void SessionBackend::AppendCommands(
   Init();
   // Make sure and check current_session_file_, if opening the file failed
   // current_session_file_ will be NULL.
-  if ((reset_first && !empty_file_) || !current_session_file_.get() ||
-      !current_session_file_->IsOpen()) {
+  //
+  // A reset is normally appended as a segment superseding those before it,
+  // which leaves the previous commands readable should the reset not get
+  // completely written. Once the file gets big the reset compacts it instead.
+  if ((reset_first && !empty_file_ && current_file_size_ >= kCompactFileSize) ||
+      !current_session_file_.get() || !current_session_file_->IsOpen()) {
     ResetFile();
   }
   // Need to check current_session_file_ again, ResetFile may fail.
   if (current_session_file_.get() && current_session_file_->IsOpen() &&
-      !AppendCommandsToFile(current_session_file_.get(), *commands)) {
+      !AppendCommandsToFile(current_session_file_.get(), *commands,
+                            reset_first)) {
     current_session_file_.reset(NULL);
   }
   empty_file_ = false;
@@ -246,6 +385,7 @@ void SessionBackend::ReadLastSessionCommands(
     return;
   Init();
   ReadLastSessionCommandsImpl(&(request->commands));
+  request->OnCommandsRead();
   request->ForwardResult(request->handle(), request);
 }
 
@@ -297,6 +437,7 @@ void SessionBackend::ReadCurrentSessionCommands(
     return;
   Init();
   ReadCurrentSessionCommandsImpl(&(request->commands));
+  request->OnCommandsRead();
   request->ForwardResult(request->handle(), request);
 }
 
@@ -308,38 +449,40 @@ bool SessionBackend::ReadCurrentSessionCommandsImpl(
 }
 
 bool SessionBackend::AppendCommandsToFile(net::FileStream* file,
-    const std::vector<SessionCommand*>& commands) {
+    const std::vector<SessionCommand*>& commands,
+    bool resets_session) {
+  // Build the segment, then write it with a single call.
+  std::string payload;
   for (std::vector<SessionCommand*>::const_iterator i = commands.begin();
        i != commands.end(); ++i) {
-    int wrote;
     const size_type content_size = static_cast<size_type>((*i)->size());
     const size_type total_size =  content_size + sizeof(id_type);
     if (type_ == BaseSessionService::TAB_RESTORE)
       UMA_HISTOGRAM_COUNTS("TabRestore.command_size", total_size);
     else
       UMA_HISTOGRAM_COUNTS("SessionRestore.command_size", total_size);
-    wrote = file->WriteSync(reinterpret_cast<const char*>(&total_size),
-                            sizeof(total_size));
-    if (wrote != sizeof(total_size)) {
-      NOTREACHED() << "error writing";
-      return false;
-    }
+    payload.append(reinterpret_cast<const char*>(&total_size),
+                   sizeof(total_size));
     id_type command_id = (*i)->id();
-    wrote = file->WriteSync(reinterpret_cast<char*>(&command_id),
-                            sizeof(command_id));
-    if (wrote != sizeof(command_id)) {
-      NOTREACHED() << "error writing";
-      return false;
-    }
-    if (content_size > 0) {
-      wrote = file->WriteSync(reinterpret_cast<char*>((*i)->contents()),
-                              content_size);
-      if (wrote != content_size) {
-        NOTREACHED() << "error writing";
-        return false;
-      }
-    }
+    payload.append(reinterpret_cast<const char*>(&command_id),
+                   sizeof(command_id));
+    if (content_size > 0)
+      payload.append((*i)->contents(), content_size);
+  }
+
+  SegmentHeader header;
+  header.payload_size = static_cast<uint32>(payload.size());
+  header.checksum = SegmentChecksum(payload);
+  header.flags = resets_session ? kSegmentResetsSession : 0;
+  std::string segment(reinterpret_cast<const char*>(&header), sizeof(header));
+  segment.append(payload);
+
+  int wrote = file->WriteSync(segment.data(), static_cast<int>(segment.size()));
+  if (wrote != static_cast<int>(segment.size())) {
+    NOTREACHED() << "error writing";
+    return false;
   }
+  current_file_size_ += wrote;
   file->Flush();
   return true;
 }
@@ -366,6 +509,7 @@ void SessionBackend::ResetFile() {
   if (!current_session_file_.get())
     current_session_file_.reset(OpenAndWriteHeader(GetCurrentSessionPath()));
   empty_file_ = true;
+  current_file_size_ = sizeof(FileHeader);
 }
 
 net::FileStream* SessionBackend::OpenAndWriteHeader(const FilePath& path) {
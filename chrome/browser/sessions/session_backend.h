@@ -29,7 +29,9 @@ class FileStream;
 // Each file contains an arbitrary set of commands supplied from
 // BaseSessionService. A command consists of a unique id and a stream of bytes.
 // SessionBackend does not use the id in anyway, that is used by
-// BaseSessionService.
+// BaseSessionService. The commands of each AppendCommands call are written as
+// one checksummed segment, so that a partially written segment is dropped as a
+// whole when the file is read back.
 class SessionBackend : public base::RefCountedThreadSafe<SessionBackend> {
  public:
   typedef SessionCommand::id_type id_type;
@@ -39,6 +41,11 @@ class SessionBackend : public base::RefCountedThreadSafe<SessionBackend> {
   // for testing.
   static const int kFileReadBufferSize;
 
+  // Size of the current file from which resetting it truncates it rather than
+  // appending a segment superseding the previous ones. This is exposed for
+  // testing.
+  static const int kCompactFileSize;
+
   // Creates a SessionBackend. This method is invoked on the MAIN thread,
   // and does no IO. The real work is done from Init, which is invoked on
   // the file thread.
@@ -56,7 +63,8 @@ class SessionBackend : public base::RefCountedThreadSafe<SessionBackend> {
   void Init();
 
   // Appends the specified commands to the current file. If reset_first is
-  // true the the current file is recreated.
+  // true the commands replace those already in the current file, which is
+  // truncated first if it has grown past kCompactFileSize.
   //
   // NOTE: this deletes SessionCommands in commands as well as the supplied
   // vector.
@@ -110,9 +118,11 @@ class SessionBackend : public base::RefCountedThreadSafe<SessionBackend> {
   // the file is returned.
   net::FileStream* OpenAndWriteHeader(const FilePath& path);
 
-  // Appends the specified commands to the specified file.
+  // Appends the specified commands to the specified file as one segment,
+  // marked as replacing the commands before it if |resets_session| is true.
   bool AppendCommandsToFile(net::FileStream* file,
-                            const std::vector<SessionCommand*>& commands);
+                            const std::vector<SessionCommand*>& commands,
+                            bool resets_session);
 
   const BaseSessionService::SessionType type_;
 
@@ -138,6 +148,9 @@ class SessionBackend : public base::RefCountedThreadSafe<SessionBackend> {
   // If true, the file is empty (no commands have been added to it).
   bool empty_file_;
 
+  // The number of bytes written to the current file, including its header.
+  int64 current_file_size_;
+
   DISALLOW_COPY_AND_ASSIGN(SessionBackend);
 };
 
@@ -45,6 +45,30 @@ class SessionBackendTest : public testing::Test {
         memcmp(command->contents(), data.data.c_str(), command->size()) == 0);
   }
 
+  // Returns the path of the file the backend writes the current session to.
+  FilePath GetCurrentSessionPath() {
+    return path_.AppendASCII("Current Session");
+  }
+
+  // Writes two segments of one command each to the current session file and
+  // returns its contents.
+  std::string WriteTwoSegments(const TestData& first, const TestData& second) {
+    scoped_refptr<SessionBackend> backend(
+        new SessionBackend(BaseSessionService::SESSION_RESTORE, path_));
+    SessionCommands commands;
+    commands.push_back(CreateCommandFromData(first));
+    backend->AppendCommands(new SessionCommands(commands), false);
+    commands.clear();
+    commands.push_back(CreateCommandFromData(second));
+    backend->AppendCommands(new SessionCommands(commands), false);
+    backend = NULL;
+
+    std::string contents;
+    EXPECT_TRUE(file_util::ReadFileToString(GetCurrentSessionPath(),
+                                            &contents));
+    return contents;
+  }
+
   // Path used in testing.
   FilePath path_;
   ScopedTempDir temp_dir_;
@@ -201,3 +225,105 @@ TEST_F(SessionBackendTest, Truncate) {
 
   STLDeleteElements(&commands);
 }
+
+// A segment cut short by a crash is dropped, keeping the ones before it.
+TEST_F(SessionBackendTest, DropTornSegment) {
+  struct TestData first_data = { 1,  "a" };
+  struct TestData second_data = { 2,  "bcd" };
+  std::string contents(WriteTwoSegments(first_data, second_data));
+  ASSERT_EQ(static_cast<int>(contents.size() - 1),
+            file_util::WriteFile(GetCurrentSessionPath(), contents.data(),
+                                 contents.size() - 1));
+
+  scoped_refptr<SessionBackend> backend(
+      new SessionBackend(BaseSessionService::SESSION_RESTORE, path_));
+  std::vector<SessionCommand*> commands;
+  EXPECT_TRUE(backend->ReadLastSessionCommandsImpl(&commands));
+  ASSERT_EQ(1U, commands.size());
+  AssertCommandEqualsData(first_data, commands[0]);
+  STLDeleteElements(&commands);
+}
+
+// A segment whose checksum doesn't match is dropped, keeping the ones before
+// it.
+TEST_F(SessionBackendTest, DropCorruptSegment) {
+  struct TestData first_data = { 1,  "a" };
+  struct TestData second_data = { 2,  "bcd" };
+  std::string contents(WriteTwoSegments(first_data, second_data));
+  contents[contents.size() - 1] = 'x';
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            file_util::WriteFile(GetCurrentSessionPath(), contents.data(),
+                                 contents.size()));
+
+  scoped_refptr<SessionBackend> backend(
+      new SessionBackend(BaseSessionService::SESSION_RESTORE, path_));
+  std::vector<SessionCommand*> commands;
+  EXPECT_TRUE(backend->ReadLastSessionCommandsImpl(&commands));
+  ASSERT_EQ(1U, commands.size());
+  AssertCommandEqualsData(first_data, commands[0]);
+  STLDeleteElements(&commands);
+}
+
+// Files written before commands were put in segments can still be read.
+TEST_F(SessionBackendTest, ReadFileWithoutSegments) {
+  struct TestData data = { 3,  "abc" };
+  const int32 header[] = { 0x53534E53, 1 };
+  std::string contents(reinterpret_cast<const char*>(header), sizeof(header));
+  const SessionCommand::size_type size =
+      static_cast<SessionCommand::size_type>(data.data.size() + 1);
+  contents.append(reinterpret_cast<const char*>(&size), sizeof(size));
+  contents.push_back(static_cast<char>(data.command_id));
+  contents.append(data.data);
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            file_util::WriteFile(GetCurrentSessionPath(), contents.data(),
+                                 contents.size()));
+
+  scoped_refptr<SessionBackend> backend(
+      new SessionBackend(BaseSessionService::SESSION_RESTORE, path_));
+  std::vector<SessionCommand*> commands;
+  EXPECT_TRUE(backend->ReadLastSessionCommandsImpl(&commands));
+  ASSERT_EQ(1U, commands.size());
+  AssertCommandEqualsData(data, commands[0]);
+  STLDeleteElements(&commands);
+}
+
+// Resetting a small file appends to it, while resetting a big one compacts it.
+TEST_F(SessionBackendTest, CompactBigFile) {
+  scoped_refptr<SessionBackend> backend(
+      new SessionBackend(BaseSessionService::SESSION_RESTORE, path_));
+  struct TestData data = { 1,  "a" };
+  SessionCommands commands;
+  commands.push_back(CreateCommandFromData(data));
+  backend->AppendCommands(new SessionCommands(commands), false);
+  commands.clear();
+  int64 small_size = 0;
+  ASSERT_TRUE(file_util::GetFileSize(GetCurrentSessionPath(), &small_size));
+
+  commands.push_back(CreateCommandFromData(data));
+  backend->AppendCommands(new SessionCommands(commands), true);
+  commands.clear();
+  int64 size = 0;
+  ASSERT_TRUE(file_util::GetFileSize(GetCurrentSessionPath(), &size));
+  EXPECT_GT(size, small_size);
+
+  const SessionCommand::size_type big_size = 60000;
+  while (size < SessionBackend::kCompactFileSize) {
+    commands.push_back(new SessionCommand(2, big_size));
+    backend->AppendCommands(new SessionCommands(commands), false);
+    commands.clear();
+    ASSERT_TRUE(file_util::GetFileSize(GetCurrentSessionPath(), &size));
+  }
+
+  commands.push_back(CreateCommandFromData(data));
+  backend->AppendCommands(new SessionCommands(commands), true);
+  commands.clear();
+  ASSERT_TRUE(file_util::GetFileSize(GetCurrentSessionPath(), &size));
+  EXPECT_EQ(small_size, size);
+
+  backend = NULL;
+  backend = new SessionBackend(BaseSessionService::SESSION_RESTORE, path_);
+  backend->ReadLastSessionCommandsImpl(&commands);
+  ASSERT_EQ(1U, commands.size());
+  AssertCommandEqualsData(data, commands[0]);
+  STLDeleteElements(&commands);
+}
@@ -91,9 +91,21 @@ class InternalSessionRequest
         real_callback(real_callback) {
   }
 
+  // Converts the commands to SessionWindows on the backend thread, as
+  // restoring a large session has many to go through.
+  virtual void OnCommandsRead() OVERRIDE {
+    base::TimeTicks start_time = base::TimeTicks::Now();
+    SessionService::RestoreSessionFromCommands(commands, &(windows.get()));
+    UMA_HISTOGRAM_TIMES("SessionRestore.decode_commands_time",
+                        base::TimeTicks::Now() - start_time);
+  }
+
   // The callback supplied to GetLastSession.
   SessionService::SessionCallback real_callback;
 
+  // The windows restored from the commands.
+  ScopedVector<SessionWindow> windows;
+
  private:
   ~InternalSessionRequest() {}
 
@@ -838,11 +850,10 @@ void SessionService::OnGotSessionCommands(
   if (request->canceled())
     return;
 
-  ScopedVector<SessionWindow> valid_windows;
-  RestoreSessionFromCommands(
-      request->commands, &(valid_windows.get()));
-  static_cast<InternalSessionRequest*>(request.get())->
-      real_callback.Run(request->handle(), &(valid_windows.get()));
+  InternalSessionRequest* session_request =
+      static_cast<InternalSessionRequest*>(request.get());
+  session_request->real_callback.Run(request->handle(),
+                                     &(session_request->windows.get()));
 }
 
 void SessionService::RestoreSessionFromCommands(
@@ -180,12 +180,21 @@ class SessionService : public BaseSessionService,
   // done. If the callback is supplied an empty vector of SessionWindows
   // it means the session could not be restored.
   //
-  // The created request does NOT directly invoke the callback, rather the
-  // callback invokes OnGotSessionCommands from which we map the
-  // SessionCommands to browser state, then notify the callback.
+  // The created request does NOT directly invoke the callback. The
+  // SessionCommands are mapped to browser state on the backend thread by
+  // RestoreSessionFromCommands, and OnGotSessionCommands then notifies the
+  // callback.
   Handle GetLastSession(CancelableRequestConsumerBase* consumer,
                         const SessionCallback& callback);
 
+  // Converts the commands into SessionWindows. On return any valid
+  // windows are added to valid_windows. It is up to the caller to delete
+  // the windows added to valid_windows. This only looks at its arguments, so
+  // it may be called on any thread.
+  static void RestoreSessionFromCommands(
+      const std::vector<SessionCommand*>& commands,
+      std::vector<SessionWindow*>* valid_windows);
+
   // Overridden from BaseSessionService because we want some UMA reporting on
   // session update activities.
   virtual void Save() OVERRIDE;
@@ -251,40 +260,32 @@ class SessionService : public BaseSessionService,
                                            bool is_pinned);
 
   // Callback from the backend for getting the commands from the save file.
-  // Converts the commands in SessionWindows and notifies the real callback.
+  // Notifies the real callback of the SessionWindows the commands were
+  // converted into.
   void OnGotSessionCommands(
       Handle handle,
       scoped_refptr<InternalGetCommandsRequest> request);
 
-  // Converts the commands into SessionWindows. On return any valid
-  // windows are added to valid_windows. It is up to the caller to delete
-  // the windows added to valid_windows.
-  //
-  // If ignore_recent_closes is true, any window/tab closes within in a certain
-  // time frame are ignored.
-  void RestoreSessionFromCommands(const std::vector<SessionCommand*>& commands,
-                                  std::vector<SessionWindow*>* valid_windows);
-
   // Iterates through the vector updating the selected_tab_index of each
   // SessionWindow based on the actual tabs that were restored.
-  void UpdateSelectedTabIndex(std::vector<SessionWindow*>* windows);
+  static void UpdateSelectedTabIndex(std::vector<SessionWindow*>* windows);
 
   // Returns the window in windows with the specified id. If a window does
   // not exist, one is created.
-  SessionWindow* GetWindow(SessionID::id_type window_id,
-                           IdToSessionWindow* windows);
+  static SessionWindow* GetWindow(SessionID::id_type window_id,
+                                  IdToSessionWindow* windows);
 
   // Returns the tab with the specified id in tabs. If a tab does not exist,
   // it is created.
-  SessionTab* GetTab(SessionID::id_type tab_id,
-                     IdToSessionTab* tabs);
+  static SessionTab* GetTab(SessionID::id_type tab_id,
+                            IdToSessionTab* tabs);
 
   // Returns an iterator into navigations pointing to the navigation whose
   // index matches |index|. If no navigation index matches |index|, the first
   // navigation with an index > |index| is returned.
   //
   // This assumes the navigations are ordered by index in ascending order.
-  std::vector<TabNavigation>::iterator FindClosestNavigationWithIndex(
+  static std::vector<TabNavigation>::iterator FindClosestNavigationWithIndex(
       std::vector<TabNavigation>* navigations,
       int index);
 
@@ -295,14 +296,14 @@ class SessionService : public BaseSessionService,
   //   out constrained windows (aka popups that have been dragged out).
   // . Sorts the tabs in windows with valid tabs based on the tabs
   //   visual order, and adds the valid windows to windows.
-  void SortTabsBasedOnVisualOrderAndPrune(
+  static void SortTabsBasedOnVisualOrderAndPrune(
       std::map<int, SessionWindow*>* windows,
       std::vector<SessionWindow*>* valid_windows);
 
   // Adds tabs to their parent window based on the tab's window_id. This
   // ignores tabs with no navigations.
-  void AddTabsToWindows(std::map<int, SessionTab*>* tabs,
-                        std::map<int, SessionWindow*>* windows);
+  static void AddTabsToWindows(std::map<int, SessionTab*>* tabs,
+                               std::map<int, SessionWindow*>* windows);
 
   // Creates tabs and windows from the specified commands. The created tabs
   // and windows are added to |tabs| and |windows| respectively. It is up to
@@ -310,9 +311,9 @@ class SessionService : public BaseSessionService,
   //
   // This does NOT add any created SessionTabs to SessionWindow.tabs, that is
   // done by AddTabsToWindows.
-  bool CreateTabsAndWindows(const std::vector<SessionCommand*>& data,
-                            std::map<int, SessionTab*>* tabs,
-                            std::map<int, SessionWindow*>* windows);
+  static bool CreateTabsAndWindows(const std::vector<SessionCommand*>& data,
+                                   std::map<int, SessionTab*>* tabs,
+                                   std::map<int, SessionWindow*>* windows);
 
   // Adds commands to commands that will recreate the state of the specified
   // tab. This adds at most kMaxNavigationCountToPersist navigations (in each
@@ -0,0 +1,281 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/startup_task_scheduler.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/format_macros.h"
+#include "base/logging.h"
+#include "base/message_loop.h"
+#include "base/metrics/histogram.h"
+#include "base/stringprintf.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/notification_service.h"
+#include "content/public/browser/notification_types.h"
+
+using content::BrowserThread;
+
+namespace {
+
+// How long to wait for a first paint before starting the AFTER_FIRST_PAINT
+// tasks anyway, e.g. when the browser starts without a window.
+const int kFirstPaintTimeoutSeconds = 10;
+
+// How long after the first paint the IDLE tasks start.
+const int kIdleDelaySeconds = 5;
+
+void RunTracedTask(const std::string& name, const base::Closure& task) {
+  TRACE_EVENT1("startup", "StartupTaskScheduler::RunTask",
+               "name", TRACE_STR_COPY(name.c_str()));
+  task.Run();
+}
+
+}  // namespace
+
+StartupTaskScheduler::Task::Task()
+    : priority(CRITICAL),
+      runner(UI_THREAD),
+      pending_prerequisites(0),
+      started(false),
+      done(false) {
+}
+
+StartupTaskScheduler::Task::~Task() {
+}
+
+StartupTaskScheduler::StartupTaskScheduler()
+    : reached_priority_(-1),
+      pending_critical_tasks_(0),
+      critical_path_reported_(false),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
+}
+
+StartupTaskScheduler::~StartupTaskScheduler() {
+}
+
+void StartupTaskScheduler::AddTask(const std::string& name,
+                                   Priority priority,
+                                   Runner runner,
+                                   const base::Closure& task) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  DCHECK(tasks_.find(name) == tasks_.end()) << name;
+
+  Task& new_task = tasks_[name];
+  new_task.priority = priority;
+  new_task.runner = runner;
+  new_task.closure = task;
+  if (priority == CRITICAL)
+    ++pending_critical_tasks_;
+
+  // Let the caller add dependencies before a task added after Start() runs.
+  if (reached_priority_ >= 0) {
+    MessageLoop::current()->PostTask(
+        FROM_HERE, base::Bind(&StartupTaskScheduler::MaybeRunTask,
+                              weak_factory_.GetWeakPtr(), name));
+  }
+}
+
+void StartupTaskScheduler::AddDependency(const std::string& name,
+                                         const std::string& prerequisite) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  TaskMap::iterator task = tasks_.find(name);
+  TaskMap::iterator prerequisite_task = tasks_.find(prerequisite);
+  DCHECK(task != tasks_.end()) << name;
+  DCHECK(prerequisite_task != tasks_.end()) << prerequisite;
+  DCHECK(!task->second.started) << name;
+  // Otherwise |name| would hold back its own priority class.
+  DCHECK_LE(prerequisite_task->second.priority, task->second.priority)
+      << name << " depends on " << prerequisite;
+
+  task->second.prerequisites.push_back(prerequisite);
+  if (!prerequisite_task->second.done) {
+    ++task->second.pending_prerequisites;
+    prerequisite_task->second.dependents.push_back(name);
+  }
+}
+
+void StartupTaskScheduler::Start() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  DCHECK_EQ(-1, reached_priority_);
+
+  start_time_ = base::TimeTicks::Now();
+  reached_priority_ = CRITICAL;
+
+  registrar_.Add(this, content::NOTIFICATION_RENDER_WIDGET_HOST_DID_PAINT,
+                 content::NotificationService::AllSources());
+  first_paint_timer_.Start(
+      FROM_HERE, base::TimeDelta::FromSeconds(kFirstPaintTimeoutSeconds),
+      this, &StartupTaskScheduler::OnFirstPaint);
+
+  RunReadyTasks(CRITICAL);
+  MaybeReportCriticalPath();
+}
+
+void StartupTaskScheduler::OnFirstPaint() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  if (IsPriorityReached(AFTER_FIRST_PAINT))
+    return;
+
+  registrar_.RemoveAll();
+  if (first_paint_timer_.IsRunning()) {
+    first_paint_timer_.Stop();
+    UMA_HISTOGRAM_LONG_TIMES("Startup.TimeToFirstPaint",
+                             base::TimeTicks::Now() - start_time_);
+  }
+
+  reached_priority_ = AFTER_FIRST_PAINT;
+  idle_timer_.Start(FROM_HERE, base::TimeDelta::FromSeconds(kIdleDelaySeconds),
+                    this, &StartupTaskScheduler::OnIdle);
+  RunReadyTasks(AFTER_FIRST_PAINT);
+}
+
+void StartupTaskScheduler::OnIdle() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  if (IsPriorityReached(IDLE))
+    return;
+  if (!IsPriorityReached(AFTER_FIRST_PAINT))
+    OnFirstPaint();
+
+  idle_timer_.Stop();
+  reached_priority_ = IDLE;
+  RunReadyTasks(IDLE);
+}
+
+std::string StartupTaskScheduler::GetCriticalPathForTesting() const {
+  if (pending_critical_tasks_ > 0)
+    return std::string();
+  return BuildCriticalPath();
+}
+
+void StartupTaskScheduler::Observe(
+    int type,
+    const content::NotificationSource& source,
+    const content::NotificationDetails& details) {
+  DCHECK_EQ(content::NOTIFICATION_RENDER_WIDGET_HOST_DID_PAINT, type);
+  OnFirstPaint();
+}
+
+void StartupTaskScheduler::MaybeRunTask(const std::string& name) {
+  TaskMap::iterator it = tasks_.find(name);
+  DCHECK(it != tasks_.end());
+  Task& task = it->second;
+  if (task.started || task.pending_prerequisites > 0 ||
+      !IsPriorityReached(task.priority)) {
+    return;
+  }
+
+  task.started = true;
+  task.start_time = base::TimeTicks::Now();
+  base::Closure traced_task = base::Bind(&RunTracedTask, name, task.closure);
+  base::Closure reply = base::Bind(&StartupTaskScheduler::OnTaskDone,
+                                   weak_factory_.GetWeakPtr(), name);
+  switch (task.runner) {
+    case UI_THREAD:
+      traced_task.Run();
+      OnTaskDone(name);
+      break;
+    case FILE_THREAD:
+      BrowserThread::PostTaskAndReply(BrowserThread::FILE, FROM_HERE,
+                                      traced_task, reply);
+      break;
+    case DB_THREAD:
+      BrowserThread::PostTaskAndReply(BrowserThread::DB, FROM_HERE,
+                                      traced_task, reply);
+      break;
+    case BLOCKING_POOL:
+      BrowserThread::PostBlockingPoolTaskAndReply(FROM_HERE, traced_task,
+                                                  reply);
+      break;
+  }
+}
+
+void StartupTaskScheduler::RunReadyTasks(Priority priority) {
+  // Collect the names first: running a task may add more.
+  std::vector<std::string> names;
+  for (TaskMap::const_iterator it = tasks_.begin(); it != tasks_.end(); ++it) {
+    if (it->second.priority == priority)
+      names.push_back(it->first);
+  }
+  for (size_t i = 0; i < names.size(); ++i)
+    MaybeRunTask(names[i]);
+}
+
+void StartupTaskScheduler::OnTaskDone(const std::string& name) {
+  Task& task = tasks_[name];
+  DCHECK(task.started && !task.done);
+  task.done = true;
+  task.end_time = base::TimeTicks::Now();
+  task.closure.Reset();
+
+  if (task.priority == CRITICAL)
+    --pending_critical_tasks_;
+
+  std::vector<std::string> dependents;
+  dependents.swap(task.dependents);
+  for (size_t i = 0; i < dependents.size(); ++i) {
+    --tasks_[dependents[i]].pending_prerequisites;
+    MaybeRunTask(dependents[i]);
+  }
+
+  if (task.priority == CRITICAL)
+    MaybeReportCriticalPath();
+}
+
+void StartupTaskScheduler::MaybeReportCriticalPath() {
+  if (critical_path_reported_ || pending_critical_tasks_ > 0 ||
+      !IsPriorityReached(CRITICAL)) {
+    return;
+  }
+  critical_path_reported_ = true;
+
+  UMA_HISTOGRAM_LONG_TIMES("Startup.CriticalTasksTime",
+                           base::TimeTicks::Now() - start_time_);
+  VLOG(1) << "Startup critical path: " << BuildCriticalPath();
+}
+
+std::string StartupTaskScheduler::BuildCriticalPath() const {
+  // Start from the critical task that finished last, and repeatedly step to
+  // the prerequisite that finished last, which is what it waited for.
+  const Task* last = NULL;
+  std::string last_name;
+  for (TaskMap::const_iterator it = tasks_.begin(); it != tasks_.end(); ++it) {
+    if (it->second.priority == CRITICAL &&
+        (!last || it->second.end_time > last->end_time)) {
+      last = &it->second;
+      last_name = it->first;
+    }
+  }
+
+  std::vector<std::string> path;
+  while (last) {
+    path.push_back(base::StringPrintf(
+        "%s (%" PRId64 " ms)", last_name.c_str(),
+        (last->end_time - last->start_time).InMilliseconds()));
+    const Task* prerequisite = NULL;
+    for (size_t i = 0; i < last->prerequisites.size(); ++i) {
+      const Task& candidate = tasks_.find(last->prerequisites[i])->second;
+      if (!prerequisite || candidate.end_time > prerequisite->end_time) {
+        prerequisite = &candidate;
+        last_name = last->prerequisites[i];
+      }
+    }
+    last = prerequisite;
+  }
+
+  std::reverse(path.begin(), path.end());
+  std::string result;
+  for (size_t i = 0; i < path.size(); ++i) {
+    if (i > 0)
+      result += ", ";
+    result += path[i];
+  }
+  return result;
+}
+
+bool StartupTaskScheduler::IsPriorityReached(Priority priority) const {
+  return reached_priority_ >= priority;
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CHROME_BROWSER_STARTUP_TASK_SCHEDULER_H_
+#define CHROME_BROWSER_STARTUP_TASK_SCHEDULER_H_
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/compiler_specific.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time.h"
+#include "base/timer.h"
+#include "content/public/browser/notification_observer.h"
+#include "content/public/browser/notification_registrar.h"
+
+// Runs the browser's startup initialization as named tasks, so that only
+// the work needed for the first window competes with it for the UI thread.
+//
+// Each task has a priority, which says when it may start, and a thread to
+// run on. A task may also depend on other tasks, and does not start until
+// they have finished, so independent tasks on the FILE and DB threads or
+// the blocking pool run in parallel with the UI thread.
+//
+// When the critical tasks are done, the chain of tasks that determined when
+// they finished is logged (with --vmodule=startup_task_scheduler=1) as the
+// startup critical path. Each task is also a trace event in the "startup"
+// category.
+//
+// Must be used on the UI thread.
+class StartupTaskScheduler : public content::NotificationObserver {
+ public:
+  enum Priority {
+    // Runs as soon as Start() is called and its dependencies are done.
+    CRITICAL,
+    // Runs once a renderer has first painted, or after a timeout if none
+    // does, for services the first window does not need.
+    AFTER_FIRST_PAINT,
+    // Runs a while after the first paint, once startup has settled.
+    IDLE,
+  };
+
+  enum Runner {
+    UI_THREAD,
+    FILE_THREAD,
+    DB_THREAD,
+    BLOCKING_POOL,
+  };
+
+  StartupTaskScheduler();
+  virtual ~StartupTaskScheduler();
+
+  // Adds a task called |name|, which must be unique. Tasks may be added
+  // before or after Start(), but a task's dependencies must be added first.
+  void AddTask(const std::string& name,
+               Priority priority,
+               Runner runner,
+               const base::Closure& task);
+
+  // Makes the task |name| wait for the task |prerequisite|, which must not
+  // have a later priority. Call before Start() or right after AddTask().
+  void AddDependency(const std::string& name,
+                     const std::string& prerequisite);
+
+  // Starts running the critical tasks and waits for the first paint.
+  void Start();
+
+  // Starts the AFTER_FIRST_PAINT tasks. Called when a renderer first
+  // paints, or by the fallback timer.
+  void OnFirstPaint();
+
+  // Starts the IDLE tasks.
+  void OnIdle();
+
+  // Returns the critical path as "name (ms), name (ms), ...", or an empty
+  // string if the critical tasks are not done.
+  std::string GetCriticalPathForTesting() const;
+
+  // content::NotificationObserver implementation.
+  virtual void Observe(int type,
+                       const content::NotificationSource& source,
+                       const content::NotificationDetails& details) OVERRIDE;
+
+ private:
+  struct Task {
+    Task();
+    ~Task();
+
+    Priority priority;
+    Runner runner;
+    base::Closure closure;
+    std::vector<std::string> prerequisites;
+    // Number of prerequisites that have not finished.
+    int pending_prerequisites;
+    std::vector<std::string> dependents;
+    bool started;
+    bool done;
+    base::TimeTicks start_time;
+    base::TimeTicks end_time;
+  };
+  typedef std::map<std::string, Task> TaskMap;
+
+  // Starts |name| if its priority has been reached and its prerequisites
+  // are done.
+  void MaybeRunTask(const std::string& name);
+
+  // Starts every task of |priority| that is ready.
+  void RunReadyTasks(Priority priority);
+
+  void OnTaskDone(const std::string& name);
+
+  // Records the startup histograms and logs the critical path once all
+  // critical tasks are done.
+  void MaybeReportCriticalPath();
+
+  std::string BuildCriticalPath() const;
+
+  bool IsPriorityReached(Priority priority) const;
+
+  content::NotificationRegistrar registrar_;
+
+  TaskMap tasks_;
+
+  // The latest priority whose tasks may start, or -1 before Start().
+  int reached_priority_;
+
+  base::TimeTicks start_time_;
+
+  int pending_critical_tasks_;
+  bool critical_path_reported_;
+
+  base::OneShotTimer<StartupTaskScheduler> first_paint_timer_;
+  base::OneShotTimer<StartupTaskScheduler> idle_timer_;
+
+  base::WeakPtrFactory<StartupTaskScheduler> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(StartupTaskScheduler);
+};
+
+#endif  // CHROME_BROWSER_STARTUP_TASK_SCHEDULER_H_
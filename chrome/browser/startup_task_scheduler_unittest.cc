@@ -0,0 +1,103 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/startup_task_scheduler.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/message_loop.h"
+#include "content/test/test_browser_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using content::BrowserThread;
+
+namespace {
+
+void AppendName(std::vector<std::string>* order, const std::string& name) {
+  order->push_back(name);
+}
+
+class StartupTaskSchedulerTest : public testing::Test {
+ protected:
+  StartupTaskSchedulerTest()
+      : ui_thread_(BrowserThread::UI, &message_loop_),
+        file_thread_(BrowserThread::FILE, &message_loop_) {
+  }
+
+  void AddTask(const std::string& name,
+               StartupTaskScheduler::Priority priority,
+               StartupTaskScheduler::Runner runner) {
+    scheduler_.AddTask(name, priority, runner,
+                       base::Bind(&AppendName, &order_, name));
+  }
+
+  MessageLoopForUI message_loop_;
+  content::TestBrowserThread ui_thread_;
+  content::TestBrowserThread file_thread_;
+  StartupTaskScheduler scheduler_;
+  std::vector<std::string> order_;
+};
+
+TEST_F(StartupTaskSchedulerTest, DefersUntilFirstPaintAndIdle) {
+  AddTask("idle", StartupTaskScheduler::IDLE,
+          StartupTaskScheduler::UI_THREAD);
+  AddTask("deferred", StartupTaskScheduler::AFTER_FIRST_PAINT,
+          StartupTaskScheduler::UI_THREAD);
+  AddTask("critical", StartupTaskScheduler::CRITICAL,
+          StartupTaskScheduler::UI_THREAD);
+
+  scheduler_.Start();
+  ASSERT_EQ(1U, order_.size());
+  EXPECT_EQ("critical", order_[0]);
+
+  scheduler_.OnFirstPaint();
+  ASSERT_EQ(2U, order_.size());
+  EXPECT_EQ("deferred", order_[1]);
+
+  scheduler_.OnIdle();
+  ASSERT_EQ(3U, order_.size());
+  EXPECT_EQ("idle", order_[2]);
+}
+
+TEST_F(StartupTaskSchedulerTest, WaitsForPrerequisitesOnOtherThreads) {
+  AddTask("load", StartupTaskScheduler::CRITICAL,
+          StartupTaskScheduler::FILE_THREAD);
+  AddTask("init", StartupTaskScheduler::CRITICAL,
+          StartupTaskScheduler::UI_THREAD);
+  AddTask("independent", StartupTaskScheduler::CRITICAL,
+          StartupTaskScheduler::UI_THREAD);
+  scheduler_.AddDependency("init", "load");
+
+  scheduler_.Start();
+  ASSERT_EQ(1U, order_.size());
+  EXPECT_EQ("independent", order_[0]);
+  EXPECT_EQ("", scheduler_.GetCriticalPathForTesting());
+
+  message_loop_.RunAllPending();
+  ASSERT_EQ(3U, order_.size());
+  EXPECT_EQ("load", order_[1]);
+  EXPECT_EQ("init", order_[2]);
+
+  std::string path = scheduler_.GetCriticalPathForTesting();
+  EXPECT_EQ(0U, path.find("load ("));
+  EXPECT_NE(std::string::npos, path.find(", init ("));
+  EXPECT_EQ(std::string::npos, path.find("independent"));
+}
+
+TEST_F(StartupTaskSchedulerTest, FirstPaintRunsReadyDeferredTasksOnce) {
+  AddTask("deferred", StartupTaskScheduler::AFTER_FIRST_PAINT,
+          StartupTaskScheduler::UI_THREAD);
+
+  scheduler_.Start();
+  EXPECT_TRUE(order_.empty());
+
+  scheduler_.OnFirstPaint();
+  scheduler_.OnFirstPaint();
+  ASSERT_EQ(1U, order_.size());
+  EXPECT_EQ("deferred", order_[0]);
+}
+
+}  // namespace
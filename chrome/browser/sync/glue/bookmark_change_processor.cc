@@ -431,6 +431,10 @@ void BookmarkChangeProcessor::ApplyChangesFromSyncModel(
   // changes.
   model->RemoveObserver(this);
 
+  // Let the UI observers of the model update once for the whole batch rather
+  // than for each node; an initial sync can add tens of thousands of them.
+  ScopedExtensiveBookmarkChanges extensive_changes(model);
+
   // A parent to hold nodes temporarily orphaned by parent deletion.  It is
   // lazily created inside the loop.
   const BookmarkNode* foster_parent = NULL;
@@ -9,6 +9,8 @@
 #include "base/compiler_specific.h"
 #include "base/logging.h"
 #include "base/message_loop.h"
+#include "base/metrics/histogram.h"
+#include "base/time.h"
 #include "chrome/browser/password_manager/password_store.h"
 #include "chrome/browser/password_manager/password_store_factory.h"
 #include "chrome/browser/profiles/profile.h"
@@ -19,6 +21,7 @@
 #include "chrome/browser/sync/glue/ui_model_worker.h"
 #include "content/public/browser/browser_thread.h"
 #include "sync/engine/passive_model_worker.h"
+#include "sync/util/data_type_histogram.h"
 
 using content::BrowserThread;
 
@@ -216,7 +219,15 @@ void SyncBackendRegistrar::OnChangesApplied(
   if (!processor)
     return;
 
+  // This runs on the native thread of |model_type|, which for most types is
+  // the UI thread.
+  base::TimeTicks start_time = base::TimeTicks::Now();
   processor->ApplyChangesFromSyncModel(trans, changes);
+  base::TimeDelta time = base::TimeTicks::Now() - start_time;
+#define PER_DATA_TYPE_MACRO(type_str) \
+    UMA_HISTOGRAM_TIMES("Sync." type_str "ApplyChangesTime", time);
+  SYNC_DATA_TYPE_HISTOGRAM(model_type);
+#undef PER_DATA_TYPE_MACRO
 }
 
 void SyncBackendRegistrar::OnChangesComplete(
@@ -1493,6 +1493,29 @@ TEST_F(ProfileSyncServiceBookmarkTest, AssociationState) {
   model_->RemoveObserver(&observer);
 }
 
+// Verify that a batch of server changes is applied to the bookmark model as a
+// single set of extensive changes.
+TEST_F(ProfileSyncServiceBookmarkTest, ServerChangesAreBatched) {
+  LoadBookmarkModel(DELETE_EXISTING_STORAGE, DONT_SAVE_TO_STORAGE);
+  StartSync();
+
+  ExtensiveChangesBookmarkModelObserver observer;
+  model_->AddObserver(&observer);
+
+  sync_api::WriteTransaction trans(FROM_HERE, test_user_share_.user_share());
+  FakeServerChange adds(&trans);
+  int64 f1 = adds.AddFolder(L"Server Folder", bookmark_bar_id(), 0);
+  int64 u1 = adds.AddURL(L"u1", "http://www.google.com/", f1, 0);
+  adds.AddURL(L"u2", "http://www.google.com/2", f1, u1);
+  adds.ApplyPendingChanges(change_processor_.get());
+  ExpectModelMatch(&trans);
+
+  EXPECT_EQ(1, observer.get_started());
+  EXPECT_EQ(1, observer.get_completed());
+
+  model_->RemoveObserver(&observer);
+}
+
 }  // namespace
 
 }  // namespace browser_sync
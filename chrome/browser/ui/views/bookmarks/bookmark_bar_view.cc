@@ -383,6 +383,7 @@ BookmarkBarView::BookmarkBarView(Browser* browser)
       bookmark_bar_state_(BookmarkBar::SHOW),
       animating_detached_(false) {
   set_id(VIEW_ID_BOOKMARK_BAR);
+  SetPaintCacheEnabled(true);
   Init();
 
   size_animation_->Reset(1);
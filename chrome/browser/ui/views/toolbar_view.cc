@@ -105,6 +105,8 @@ ToolbarView::ToolbarView(Browser* browser)
       browser_(browser),
       profiles_menu_contents_(NULL) {
   set_id(VIEW_ID_TOOLBAR);
+  // The toolbar rarely changes while the page and tabs around it repaint.
+  SetPaintCacheEnabled(true);
 
   browser_->command_updater()->AddCommandObserver(IDC_BACK, this);
   browser_->command_updater()->AddCommandObserver(IDC_FORWARD, this);
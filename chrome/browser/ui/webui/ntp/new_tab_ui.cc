@@ -193,6 +193,13 @@ void NewTabUI::PaintTimeout() {
         content::Source<Profile>(GetProfile()),
         content::Details<int>(&load_time_ms));
     UMA_HISTOGRAM_TIMES("NewTabUI load", load_time);
+    // Compares how the thumbnail formats affect painting the page.
+    if (CommandLine::ForCurrentProcess()->HasSwitch(
+            switches::kEnableWebPThumbnails)) {
+      UMA_HISTOGRAM_TIMES("NewTabUI load.WebPThumbnails", load_time);
+    } else {
+      UMA_HISTOGRAM_TIMES("NewTabUI load.JPEGThumbnails", load_time);
+    }
   } else {
     // Not enough quiet time has elapsed.
     // Some more paints must've occurred since we set the timeout.
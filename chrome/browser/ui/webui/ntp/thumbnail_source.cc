@@ -4,6 +4,7 @@
 
 #include "chrome/browser/ui/webui/ntp/thumbnail_source.h"
 
+#include "base/bind.h"
 #include "base/callback.h"
 #include "base/memory/ref_counted_memory.h"
 #include "chrome/browser/history/top_sites.h"
@@ -29,7 +30,10 @@ void ThumbnailSource::StartDataRequest(const std::string& path,
   if (top_sites_->GetPageThumbnail(GURL(path), &data)) {
     // We have the thumbnail.
     SendResponse(request_id, data.get());
-  } else {
+  } else if (!top_sites_->LoadEvictedPageThumbnail(
+                 GURL(path),
+                 base::Bind(&ThumbnailSource::OnThumbnailLoaded, this,
+                            request_id))) {
     SendDefaultThumbnail(request_id);
   }
 }
@@ -46,6 +50,15 @@ MessageLoop* ThumbnailSource::MessageLoopForRequestPath(
   return top_sites_.get() ? NULL : DataSource::MessageLoopForRequestPath(path);
 }
 
+void ThumbnailSource::OnThumbnailLoaded(
+    int request_id,
+    scoped_refptr<base::RefCountedBytes> data) {
+  if (data.get())
+    SendResponse(request_id, data.get());
+  else
+    SendDefaultThumbnail(request_id);
+}
+
 void ThumbnailSource::SendDefaultThumbnail(int request_id) {
   SendResponse(request_id, default_thumbnail_);
 }
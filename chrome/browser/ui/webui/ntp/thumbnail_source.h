@@ -18,6 +18,10 @@ namespace base {
 class RefCountedMemory;
 }
 
+namespace base {
+class RefCountedBytes;
+}
+
 namespace history {
 class TopSites;
 }
@@ -42,6 +46,10 @@ class ThumbnailSource : public ChromeURLDataManager::DataSource {
  private:
   virtual ~ThumbnailSource();
 
+  // Called with a thumbnail TopSites had to read from its database.
+  void OnThumbnailLoaded(int request_id,
+                         scoped_refptr<base::RefCountedBytes> data);
+
   // Send the default thumbnail when we are missing a real one.
   void SendDefaultThumbnail(int request_id);
 
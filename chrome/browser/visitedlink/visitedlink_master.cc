@@ -17,6 +17,7 @@
 #include "base/bind_helpers.h"
 #include "base/file_util.h"
 #include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/message_loop.h"
 #include "base/path_service.h"
 #include "base/process_util.h"
@@ -52,6 +53,8 @@ const unsigned VisitedLinkMaster::kDefaultTableSize = 16381;
 
 const size_t VisitedLinkMaster::kBigDeleteThreshold = 64;
 
+const int32 VisitedLinkMaster::kBackgroundResizeThreshold = 100000;
+
 namespace {
 
 // Fills the given salt structure with some quasi-random values
@@ -148,6 +151,70 @@ class VisitedLinkMaster::TableBuilder
   VisitedLinkCommon::Fingerprints fingerprints_;
 };
 
+// TableResizer ---------------------------------------------------------------
+
+// How resizing in the background works
+// -------------------------------------
+//
+// Growing a table of a million URLs means rehashing every fingerprint into
+// a new table of tens of megabytes, which would stall the UI thread. So for
+// big tables, the master allocates the new shared memory, copies the used
+// fingerprints out of the current table and hands both to a TableResizer,
+// which fills the new table on the blocking pool.
+//
+// Meanwhile the master and the renderers keep using the current table.
+// Additions still go into it (and are sent to the renderers as usual), and
+// additions and deletions are also tracked in the same sets a rebuild uses.
+// When the resizer is done, the master swaps the new table in, applies the
+// tracked changes, and the renderers remap once.
+//
+// Like the TableBuilder, the resizer may outlive the master, in which case
+// the master disowns it and the new table is thrown away.
+class VisitedLinkMaster::TableResizer
+    : public base::RefCountedThreadSafe<TableResizer> {
+ public:
+  // Takes ownership of |table|, which must be mapped and hold |length|
+  // entries after its SharedHeader. Swaps the contents of |fingerprints|.
+  TableResizer(VisitedLinkMaster* master,
+               base::SharedMemory* table,
+               int32 length,
+               Fingerprints* fingerprints);
+
+  // Called on the main thread when the master is being destroyed or the
+  // resize is no longer wanted.
+  void DisownMaster();
+
+  // Fills the new table. Runs on the blocking pool.
+  void Rehash();
+
+  // Gives up ownership of the new table, on the main thread once done.
+  base::SharedMemory* ReleaseTable();
+
+  int32 length() const { return length_; }
+  int32 used_items() const { return used_items_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<TableResizer>;
+
+  ~TableResizer() {}
+
+  // Rehash marshals to this function on the main thread to do the
+  // notification.
+  void OnCompleteMainThread();
+
+  // Owner of this object. MAY ONLY BE ACCESSED ON THE MAIN THREAD!
+  VisitedLinkMaster* master_;
+
+  // The new table and its length. Nobody else touches it until the main
+  // thread takes it back.
+  scoped_ptr<base::SharedMemory> table_;
+  int32 length_;
+
+  // The fingerprints to insert, and the number inserted.
+  Fingerprints fingerprints_;
+  int32 used_items_;
+};
+
 // VisitedLinkMaster ----------------------------------------------------------
 
 VisitedLinkMaster::VisitedLinkMaster(Listener* listener,
@@ -176,6 +243,7 @@ VisitedLinkMaster::~VisitedLinkMaster() {
     // builder will destroy itself when it finds we are gone.
     table_builder_->DisownMaster();
   }
+  CancelBackgroundResize();
   FreeURLTable();
 }
 
@@ -190,6 +258,7 @@ void VisitedLinkMaster::InitMembers(Listener* listener, Profile* profile) {
   table_size_override_ = 0;
   history_service_override_ = NULL;
   suppress_rebuild_ = false;
+  background_resize_threshold_ = kBackgroundResizeThreshold;
   profile_ = profile;
   sequence_token_ = BrowserThread::GetBlockingPool()->GetSequenceToken();
 
@@ -221,15 +290,15 @@ VisitedLinkMaster::Hash VisitedLinkMaster::TryToAddURL(const GURL& url) {
   Fingerprint fingerprint = ComputeURLFingerprint(url.spec().data(),
                                                   url.spec().size(),
                                                   salt_);
-  if (table_builder_) {
+  if (table_builder_ || table_resizer_) {
     // If we have a pending delete for this fingerprint, cancel it.
     std::set<Fingerprint>::iterator found =
         deleted_since_rebuild_.find(fingerprint);
     if (found != deleted_since_rebuild_.end())
         deleted_since_rebuild_.erase(found);
 
-    // A rebuild is in progress, save this addition in the temporary list so
-    // it can be added once rebuild is complete.
+    // A rebuild or resize is in progress, save this addition in the temporary
+    // list so it can be added to the new table once it is complete.
     added_since_rebuild_.insert(fingerprint);
   }
 
@@ -273,6 +342,9 @@ void VisitedLinkMaster::AddURLs(const std::vector<GURL>& url) {
 }
 
 void VisitedLinkMaster::DeleteAllURLs() {
+  // A table being resized would bring back the old URLs.
+  CancelBackgroundResize();
+
   // Any pending modifications are invalid.
   added_since_rebuild_.clear();
   deleted_since_rebuild_.clear();
@@ -297,9 +369,9 @@ void VisitedLinkMaster::DeleteURLs(const history::URLRows& rows) {
 
   listener_->Reset();
 
-  if (table_builder_) {
-    // A rebuild is in progress, save this deletion in the temporary list so
-    // it can be added once rebuild is complete.
+  if (table_builder_ || table_resizer_) {
+    // A rebuild or resize is in progress, save this deletion in the temporary
+    // list so it can be applied once it is complete.
     for (history::URLRows::const_iterator i = rows.begin(); i != rows.end();
          ++i) {
       const GURL& url(i->url());
@@ -710,6 +782,17 @@ bool VisitedLinkMaster::ResizeTableIfNecessary() {
 
 void VisitedLinkMaster::ResizeTable(int32 new_size) {
   DCHECK(shared_memory_ && shared_memory_->memory() && hash_table_);
+
+  // A pending resize checks the load again once it completes.
+  if (table_resizer_)
+    return;
+
+  // A rebuild replaces the table when it completes, so it has to be resized
+  // right away.
+  if (!table_builder_ && used_items_ > background_resize_threshold_ &&
+      BeginBackgroundResize(new_size))
+    return;
+
   shared_memory_serial_++;
 
 #ifndef NDEBUG
@@ -778,6 +861,80 @@ uint32 VisitedLinkMaster::NewTableSizeForCount(int32 item_count) const {
   return item_count * 2 - 1;
 }
 
+// See the TableResizer definition above for how this works.
+bool VisitedLinkMaster::BeginBackgroundResize(int32 new_size) {
+  DCHECK(!table_resizer_);
+
+  // Allocate the new table here, since the salt and the header need to be
+  // filled in like for any other table. The resizer does the zeroing.
+  uint32 alloc_size = new_size * sizeof(Fingerprint) + sizeof(SharedHeader);
+  scoped_ptr<base::SharedMemory> table(new base::SharedMemory());
+  if (!table->CreateAndMapAnonymous(alloc_size))
+    return false;
+  SharedHeader* header = static_cast<SharedHeader*>(table->memory());
+  header->length = new_size;
+  memcpy(header->salt, salt_, LINK_SALT_LENGTH);
+
+  Fingerprints fingerprints;
+  fingerprints.reserve(used_items_);
+  for (int32 i = 0; i < table_length_; i++) {
+    if (hash_table_[i])
+      fingerprints.push_back(hash_table_[i]);
+  }
+
+  table_resizer_ = new TableResizer(this, table.release(), new_size,
+                                    &fingerprints);
+  BrowserThread::GetBlockingPool()->PostWorkerTask(
+      FROM_HERE, base::Bind(&TableResizer::Rehash, table_resizer_));
+  return true;
+}
+
+void VisitedLinkMaster::OnTableResizeComplete() {
+  DCHECK(table_resizer_);
+  scoped_refptr<TableResizer> resizer;
+  resizer.swap(table_resizer_);
+
+  // Replace the old table with the new one.
+  shared_memory_serial_++;
+  delete shared_memory_;
+  shared_memory_ = resizer->ReleaseTable();
+  hash_table_ = reinterpret_cast<Fingerprint*>(
+      static_cast<char*>(shared_memory_->memory()) + sizeof(SharedHeader));
+  table_length_ = resizer->length();
+  used_items_ = resizer->used_items();
+
+  // Apply what changed while the new table was being filled. The renderers
+  // were already told about the additions.
+  for (std::set<Fingerprint>::iterator i = added_since_rebuild_.begin();
+       i != added_since_rebuild_.end(); ++i)
+    AddFingerprint(*i, false);
+  added_since_rebuild_.clear();
+  DeleteFingerprintsFromCurrentTable(deleted_since_rebuild_);
+  deleted_since_rebuild_.clear();
+
+#ifndef NDEBUG
+  DebugValidate();
+#endif
+
+  // The contents didn't change, the renderers just need to map the new table.
+  listener_->NewTable(shared_memory_);
+
+  WriteFullTable();
+
+  // Notify the unit test that the resize is complete (will be NULL in prod.)
+  if (!resize_complete_task_.is_null()) {
+    resize_complete_task_.Run();
+    resize_complete_task_.Reset();
+  }
+}
+
+void VisitedLinkMaster::CancelBackgroundResize() {
+  if (!table_resizer_)
+    return;
+  table_resizer_->DisownMaster();
+  table_resizer_ = NULL;
+}
+
 // See the TableBuilder definition in the header file for how this works.
 bool VisitedLinkMaster::RebuildTableFromHistory() {
   DCHECK(!table_builder_);
@@ -955,3 +1112,52 @@ void VisitedLinkMaster::TableBuilder::OnCompleteMainThread() {
   // VisitedLinkMaster::RebuildTableFromHistory.
   Release();
 }
+
+// TableResizer ---------------------------------------------------------------
+
+VisitedLinkMaster::TableResizer::TableResizer(VisitedLinkMaster* master,
+                                              base::SharedMemory* table,
+                                              int32 length,
+                                              Fingerprints* fingerprints)
+    : master_(master),
+      table_(table),
+      length_(length),
+      used_items_(0) {
+  fingerprints_.swap(*fingerprints);
+}
+
+void VisitedLinkMaster::TableResizer::DisownMaster() {
+  master_ = NULL;
+}
+
+// See VisitedLinkMaster::AddFingerprint, which this must match.
+void VisitedLinkMaster::TableResizer::Rehash() {
+  Fingerprint* hash_table = reinterpret_cast<Fingerprint*>(
+      static_cast<char*>(table_->memory()) + sizeof(SharedHeader));
+  memset(hash_table, 0, length_ * sizeof(Fingerprint));
+
+  // The fingerprints come from a valid table, so they are all different.
+  for (size_t i = 0; i < fingerprints_.size(); i++) {
+    Hash cur_hash = HashFingerprint(fingerprints_[i], length_);
+    while (hash_table[cur_hash] != null_fingerprint_) {
+      if (++cur_hash == length_)
+        cur_hash = 0;  // Wrap around.
+    }
+    hash_table[cur_hash] = fingerprints_[i];
+  }
+  used_items_ = static_cast<int32>(fingerprints_.size());
+  Fingerprints().swap(fingerprints_);
+
+  BrowserThread::PostTask(
+      BrowserThread::UI, FROM_HERE,
+      base::Bind(&TableResizer::OnCompleteMainThread, this));
+}
+
+base::SharedMemory* VisitedLinkMaster::TableResizer::ReleaseTable() {
+  return table_.release();
+}
+
+void VisitedLinkMaster::TableResizer::OnCompleteMainThread() {
+  if (master_)
+    master_->OnTableResizeComplete();
+}
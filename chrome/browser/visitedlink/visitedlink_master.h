@@ -110,6 +110,24 @@ class VisitedLinkMaster : public VisitedLinkCommon {
     rebuild_complete_task_ = task;
   }
 
+  // Sets a task to execute when the next background resize is complete, like
+  // set_rebuild_complete_task() above.
+  void set_resize_complete_task(const base::Closure& task) {
+    DCHECK(resize_complete_task_.is_null());
+    resize_complete_task_ = task;
+  }
+
+  // Returns true while the table is being rehashed on the blocking pool.
+  bool resize_pending() const {
+    return table_resizer_.get() != NULL;
+  }
+
+  // Overrides the number of URLs above which the table is resized on the
+  // blocking pool rather than on the calling thread.
+  void set_background_resize_threshold(int32 threshold) {
+    background_resize_threshold_ = threshold;
+  }
+
   // returns the number of items in the table for testing verification
   int32 GetUsedCount() const {
     return used_items_;
@@ -130,6 +148,9 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // Object to rebuild the table on the history thread (see the .cc file).
   class TableBuilder;
 
+  // Object to rehash the table on the blocking pool (see the .cc file).
+  class TableResizer;
+
   // Byte offsets of values in the header.
   static const int32 kFileHeaderSignatureOffset;
   static const int32 kFileHeaderVersionOffset;
@@ -154,6 +175,10 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // we will write the whole table to disk at once instead of individual items.
   static const size_t kBigDeleteThreshold;
 
+  // Rehashing a big table takes long enough to be noticed, so when the table
+  // holds more URLs than this it is resized on the blocking pool instead.
+  static const int32 kBackgroundResizeThreshold;
+
   // Backend for the constructors initializing the members.
   void InitMembers(Listener* listener, Profile* profile);
 
@@ -262,9 +287,21 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   bool ResizeTableIfNecessary();
 
   // Resizes the table (growing or shrinking) as necessary to accomodate the
-  // current count.
+  // current count. Big tables are handed to BeginBackgroundResize().
   void ResizeTable(int32 new_size);
 
+  // Starts rehashing the current fingerprints into a new table of |new_size|
+  // entries on the blocking pool. Until OnTableResizeComplete() swaps it in,
+  // the old table stays in use and changes are tracked the same way as
+  // during a rebuild. Returns false if the new table couldn't be allocated.
+  bool BeginBackgroundResize(int32 new_size);
+
+  // Callback that the table resizer uses when the new table is filled.
+  void OnTableResizeComplete();
+
+  // Abandons a pending background resize, if any.
+  void CancelBackgroundResize();
+
   // Returns the desired table size for |item_count| URLs.
   uint32 NewTableSizeForCount(int32 item_count) const;
 
@@ -327,7 +364,13 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // history query is running. We must only delete it when the query is done.
   scoped_refptr<TableBuilder> table_builder_;
 
-  // Indicates URLs added and deleted since we started rebuilding the table.
+  // When non-NULL, indicates the table is being rehashed into a bigger or
+  // smaller one on the blocking pool. Like |table_builder_|, it must outlive
+  // the task using it, so we only disown it if we go away first.
+  scoped_refptr<TableResizer> table_resizer_;
+
+  // Indicates URLs added and deleted since we started rebuilding or resizing
+  // the table.
   std::set<Fingerprint> added_since_rebuild_;
   std::set<Fingerprint> deleted_since_rebuild_;
 
@@ -373,6 +416,14 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // history is complete.
   base::Closure rebuild_complete_task_;
 
+  // When set, indicates the task that should be run after the next background
+  // resize is complete.
+  base::Closure resize_complete_task_;
+
+  // Number of URLs above which we resize on the blocking pool, normally
+  // kBackgroundResizeThreshold.
+  int32 background_resize_threshold_;
+
   // Set to prevent us from attempting to rebuild the database from global
   // history if we have an error opening the file. This is used for testing,
   // will be false in production.
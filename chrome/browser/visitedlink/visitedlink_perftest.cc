@@ -8,20 +8,25 @@
 
 #include "base/file_path.h"
 #include "base/file_util.h"
+#include "base/message_loop.h"
 #include "base/perftimer.h"
+#include "base/process_util.h"
 #include "base/shared_memory.h"
 #include "base/stringprintf.h"
 #include "base/test/test_file_util.h"
 #include "chrome/browser/visitedlink/visitedlink_master.h"
+#include "content/test/test_browser_thread.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 using base::TimeDelta;
+using content::BrowserThread;
 
 namespace {
 
 // how we generate URLs, note that the two strings should be the same length
 const int add_count = 10000;
 const int load_test_add_count = 250000;
+const int big_table_add_count = 1000000;
 const char added_prefix[] = "http://www.google.com/stuff/something/foo?session=85025602345625&id=1345142319023&seq=";
 const char unadded_prefix[] = "http://www.google.org/stuff/something/foo?session=39586739476365&id=2347624314402&seq=";
 
@@ -44,6 +49,32 @@ class DummyVisitedLinkEventListener : public VisitedLinkMaster::Listener {
   }
 };
 
+// Maps every new table the way a renderer does, and times it.
+class RemappingVisitedLinkEventListener : public VisitedLinkMaster::Listener {
+ public:
+  RemappingVisitedLinkEventListener() {}
+  virtual void NewTable(base::SharedMemory* table) {
+    PerfTimer timer;
+    base::SharedMemoryHandle handle = base::SharedMemory::NULLHandle();
+    table->ShareToProcess(base::GetCurrentProcessHandle(), &handle);
+    base::SharedMemory renderer_table(handle, true);
+    // The table starts with its length, then the salt.
+    const size_t header_size = sizeof(uint32) + LINK_SALT_LENGTH;
+    ASSERT_TRUE(renderer_table.Map(header_size));
+    uint32 length = *static_cast<uint32*>(renderer_table.memory());
+    renderer_table.Unmap();
+    ASSERT_TRUE(renderer_table.Map(
+        header_size + length * sizeof(VisitedLinkCommon::Fingerprint)));
+    remap_times_.push_back(timer.Elapsed().InMillisecondsF());
+  }
+  virtual void Add(VisitedLinkCommon::Fingerprint) {}
+  virtual void Reset() {}
+
+  const std::vector<double>& remap_times() const { return remap_times_; }
+
+ private:
+  std::vector<double> remap_times_;
+};
 
 // this checks IsVisited for the URLs starting with the given prefix and
 // within the given range
@@ -61,8 +92,22 @@ void FillTable(VisitedLinkMaster& master, const char* prefix,
     master.AddURL(TestURL(prefix, i));
 }
 
+// Waits for the table to be swapped in if it's being resized in the
+// background.
+void WaitForResize(VisitedLinkMaster& master) {
+  while (master.resize_pending()) {
+    master.set_resize_complete_task(MessageLoop::QuitClosure());
+    MessageLoop::current()->Run();
+  }
+}
+
 class VisitedLink : public testing::Test {
  protected:
+  VisitedLink() : ui_thread_(BrowserThread::UI, &message_loop_) {}
+
+  // Big tables are resized on the blocking pool, which replies here.
+  MessageLoop message_loop_;
+  content::TestBrowserThread ui_thread_;
   FilePath db_path_;
   virtual void SetUp() {
     ASSERT_TRUE(file_util::CreateTemporaryFile(&db_path_));
@@ -126,6 +171,7 @@ TEST_F(VisitedLink, TestLoad) {
     // many time and this is the actual bottleneck of this test. The file should
     // only get written that the end of the FillTable call, not 4169(!) times.
     FillTable(master, added_prefix, 0, load_test_add_count);
+    WaitForResize(master);
 
     // time writing the file out out
     PerfTimeLogger flushTimer("Visited_link_database_flush");
@@ -195,3 +241,53 @@ TEST_F(VisitedLink, TestLoad) {
   LogPerfResult("Visited_link_hot_load_time",
                 hot_sum / hot_load_times.size(), "ms");
 }
+
+// Tests how long the master stalls while adding URLs to a table that grows
+// past a million entries, since growing the table means rehashing it.
+TEST_F(VisitedLink, TestAddToBigTable) {
+  VisitedLinkMaster master(DummyVisitedLinkEventListener::GetInstance(),
+                           NULL, true, db_path_, 0);
+  ASSERT_TRUE(master.Init());
+
+  double max_add_time = 0;
+  {
+    PerfTimeLogger timer("Visited_link_add_1M");
+    for (int i = 0; i < big_table_add_count; i++) {
+      PerfTimer add_timer;
+      master.AddURL(TestURL(added_prefix, i));
+      max_add_time = std::max(max_add_time,
+                              add_timer.Elapsed().InMillisecondsF());
+    }
+    WaitForResize(master);
+  }
+  LogPerfResult("Visited_link_add_1M_max_stall", max_add_time, "ms");
+
+  PerfTimeLogger query_timer("Visited_link_query_1M");
+  CheckVisited(master, added_prefix, 0, big_table_add_count);
+  CheckVisited(master, unadded_prefix, 0, big_table_add_count);
+  query_timer.Done();
+  EXPECT_EQ(big_table_add_count, master.GetUsedCount());
+}
+
+// Tests how long a renderer takes to map each new table as the master grows
+// it past a million entries.
+TEST_F(VisitedLink, TestRemapLatency) {
+  RemappingVisitedLinkEventListener listener;
+  VisitedLinkMaster master(&listener, NULL, true, db_path_, 0);
+  ASSERT_TRUE(master.Init());
+
+  FillTable(master, added_prefix, 0, big_table_add_count);
+  WaitForResize(master);
+
+  const std::vector<double>& remap_times = listener.remap_times();
+  ASSERT_FALSE(remap_times.empty());
+  double sum = 0;
+  for (size_t i = 0; i < remap_times.size(); i++)
+    sum += remap_times[i];
+  LogPerfResult("Visited_link_remap_count",
+                static_cast<double>(remap_times.size()), "tables");
+  LogPerfResult("Visited_link_remap_time", sum / remap_times.size(), "ms");
+  LogPerfResult("Visited_link_max_remap_time",
+                *std::max_element(remap_times.begin(), remap_times.end()),
+                "ms");
+}
@@ -373,6 +373,55 @@ TEST_F(VisitedLinkTest, Resizing) {
   Reload();
 }
 
+// Tests resizing on the blocking pool: URLs added and deleted while the new
+// table is being filled must make it in, and the slaves only remap.
+TEST_F(VisitedLinkTest, BackgroundResizing) {
+  const int32 initial_size = 17;
+  ASSERT_TRUE(InitHistory());
+  ASSERT_TRUE(InitVisited(initial_size, true));
+  master_->set_background_resize_threshold(0);
+
+  VisitedLinkSlave slave;
+  base::SharedMemoryHandle new_handle = base::SharedMemory::NULLHandle();
+  master_->shared_memory()->ShareToProcess(
+      base::GetCurrentProcessHandle(), &new_handle);
+  slave.OnUpdateVisitedLinks(new_handle);
+  g_slaves.push_back(&slave);
+
+  // Add one more and delete it while the resize is likely pending.
+  for (int i = 0; i <= g_test_count; i++)
+    master_->AddURL(TestURL(i));
+  history::URLRows deleted_urls;
+  deleted_urls.push_back(history::URLRow(TestURL(g_test_count)));
+  master_->DeleteURLs(deleted_urls);
+
+  // Completing a resize may start another one if the table is still too full.
+  while (master_->resize_pending()) {
+    master_->set_resize_complete_task(MessageLoop::QuitClosure());
+    MessageLoop::current()->Run();
+  }
+
+  ASSERT_EQ(g_test_count, master_->GetUsedCount());
+  EXPECT_FALSE(master_->IsVisited(TestURL(g_test_count)));
+  // Only the deletion resets the visited state.
+  EXPECT_EQ(1, listener_.reset_count());
+
+  int32 table_size;
+  VisitedLinkCommon::Fingerprint* table;
+  master_->GetUsageStatistics(&table_size, &table);
+  int32 child_table_size;
+  VisitedLinkCommon::Fingerprint* child_table;
+  slave.GetUsageStatistics(&child_table_size, &child_table);
+  ASSERT_EQ(table_size, child_table_size);
+  for (int32 i = 0; i < table_size; i++)
+    ASSERT_EQ(table[i], child_table[i]);
+
+  master_->DebugValidate();
+  g_slaves.clear();
+
+  Reload();
+}
+
 // Tests that if the database doesn't exist, it will be rebuilt from history.
 TEST_F(VisitedLinkTest, Rebuild) {
   ASSERT_TRUE(InitHistory());
@@ -33,6 +33,7 @@
 #include "content/public/browser/notification_source.h"
 #include "grit/chromium_strings.h"
 #include "grit/generated_resources.h"
+#include "sql/batching_transaction.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "webkit/forms/form_field.h"
 
@@ -50,6 +51,12 @@ using webkit_glue::WebIntentServiceData;
 
 namespace {
 
+// Writes are committed at most this long after they are made, or once this
+// many have been made, so that a burst of writes, such as sync adding
+// autofill entries, costs one commit.
+const int kCommitIntervalSeconds = 1;
+const int kMaxWritesPerCommit = 100;
+
 // A task used by WebDataService (for Sync mainly) to inform the
 // PersonalDataManager living on the UI thread that it needs to refresh.
 void NotifyOfMultipleAutofillChangesTask(
@@ -80,10 +87,10 @@ WDKeywordsResult::~WDKeywordsResult() {}
 WebDataService::WebDataService()
   : is_running_(false),
     db_(NULL),
+    commit_batch_(NULL),
     autocomplete_syncable_service_(NULL),
     autofill_profile_syncable_service_(NULL),
     failed_init_(false),
-    should_commit_(false),
     next_request_handle_(1),
     main_loop_(MessageLoop::current()) {
 }
@@ -663,7 +670,11 @@ void WebDataService::InitializeDatabaseIfNecessary() {
       base::Bind(&WebDataService::NotifyDatabaseLoadedOnUIThread, this));
 
   db_ = db;
-  db_->BeginTransaction();
+  commit_batch_ = new sql::BatchingTransaction(
+      db_->GetSQLConnection(),
+      base::TimeDelta::FromSeconds(kCommitIntervalSeconds),
+      kMaxWritesPerCommit);
+  commit_batch_->Begin();
 }
 
 void WebDataService::InitializeSyncableServices() {
@@ -684,10 +695,10 @@ void WebDataService::NotifyDatabaseLoadedOnUIThread() {
 }
 
 void WebDataService::ShutdownDatabase() {
-  should_commit_ = false;
-
   if (db_) {
-    db_->CommitTransaction();
+    // Commits the pending writes.
+    delete commit_batch_;
+    commit_batch_ = NULL;
     delete db_;
     db_ = NULL;
   }
@@ -702,17 +713,6 @@ void WebDataService::ShutdownSyncableServices() {
   autofill_profile_syncable_service_ = NULL;
 }
 
-void WebDataService::Commit() {
-  if (should_commit_) {
-    should_commit_ = false;
-
-    if (db_) {
-      db_->CommitTransaction();
-      db_->BeginTransaction();
-    }
-  }
-}
-
 void WebDataService::ScheduleTask(const tracked_objects::Location& from_here,
                                   const base::Closure& task) {
   if (is_running_)
@@ -722,10 +722,8 @@ void WebDataService::ScheduleTask(const tracked_objects::Location& from_here,
 }
 
 void WebDataService::ScheduleCommit() {
-  if (should_commit_ == false) {
-    should_commit_ = true;
-    ScheduleTask(FROM_HERE, Bind(&WebDataService::Commit, this));
-  }
+  if (commit_batch_)
+    commit_batch_->DidWrite();
 }
 
 int WebDataService::GetNextRequestHandle() {
@@ -45,6 +45,10 @@ namespace base {
 class Thread;
 }
 
+namespace sql {
+class BatchingTransaction;
+}
+
 namespace webkit {
 namespace forms {
 struct FormField;
@@ -579,14 +583,12 @@ class WebDataService
   // Deletes the syncable services.
   void ShutdownSyncableServices();
 
-  // Commit the current transaction and creates a new one.
-  void Commit();
-
   // Schedule a task on our worker thread.
   void ScheduleTask(const tracked_objects::Location& from_here,
                     const base::Closure& task);
 
-  // Schedule a commit if one is not already pending.
+  // Notes a write to the database, which will be committed with the current
+  // batch.
   void ScheduleCommit();
 
   // Return the next request handle.
@@ -692,6 +694,10 @@ class WebDataService
   // |db_| lifetime must be managed on the database thread.
   WebDatabase* db_;
 
+  // Batches the writes to |db_| into as few commits as possible.  Owned and
+  // managed on the database thread, like |db_|.
+  sql::BatchingTransaction* commit_batch_;
+
   // Syncable services for the database data.  We own the services, but don't
   // use |scoped_ptr|s because the lifetimes must be managed on the database
   // thread.
@@ -704,9 +710,6 @@ class WebDataService
   // continually trying to reinit.
   bool failed_init_;
 
-  // Whether we should commit the database.
-  bool should_commit_;
-
   // A lock to protect pending requests and next request handle.
   base::Lock pending_lock_;
 
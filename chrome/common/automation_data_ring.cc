@@ -0,0 +1,64 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/common/automation_data_ring.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+AutomationDataRing::AutomationDataRing() : size_(0), position_(0) {
+}
+
+AutomationDataRing::~AutomationDataRing() {
+}
+
+bool AutomationDataRing::Create(size_t size) {
+  DCHECK(!memory_.get());
+  memory_.reset(new base::SharedMemory);
+  if (!size || !memory_->CreateAndMapAnonymous(size)) {
+    memory_.reset();
+    return false;
+  }
+  size_ = size;
+  return true;
+}
+
+bool AutomationDataRing::Map(base::SharedMemoryHandle handle, size_t size) {
+  DCHECK(!memory_.get());
+  // The SharedMemory owns |handle| from here on, even if mapping fails.
+  memory_.reset(new base::SharedMemory(handle, false));
+  if (!size || !memory_->Map(size)) {
+    memory_.reset();
+    return false;
+  }
+  size_ = size;
+  return true;
+}
+
+bool AutomationDataRing::ShareToProcess(base::ProcessHandle process,
+                                        base::SharedMemoryHandle* new_handle) {
+  DCHECK(memory_.get());
+  return memory_->ShareToProcess(process, new_handle);
+}
+
+void AutomationDataRing::Write(const char* data, size_t size) {
+  DCHECK_LE(size, size_);
+  char* base = static_cast<char*>(memory_->memory());
+  size_t first = std::min(size, size_ - position_);
+  memcpy(base + position_, data, first);
+  memcpy(base, data + first, size - first);
+  position_ = (position_ + size) % size_;
+}
+
+void AutomationDataRing::Read(char* buffer, size_t size) {
+  DCHECK_LE(size, size_);
+  const char* base = static_cast<const char*>(memory_->memory());
+  size_t first = std::min(size, size_ - position_);
+  memcpy(buffer, base + position_, first);
+  memcpy(buffer + first, base, size - first);
+  position_ = (position_ + size) % size_;
+}
@@ -0,0 +1,55 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CHROME_COMMON_AUTOMATION_DATA_RING_H_
+#define CHROME_COMMON_AUTOMATION_DATA_RING_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/process.h"
+#include "base/shared_memory.h"
+
+// A ring buffer in shared memory through which Chrome Frame hands the body of
+// a response fetched by the host browser to Chrome, instead of copying it into
+// automation messages. Chrome creates the ring and reads from it; Chrome Frame
+// maps it and writes to it. Each side only keeps its own position. How many
+// bytes were written and consumed is sent over the automation channel, which
+// is how the writer knows how much room is left.
+class AutomationDataRing {
+ public:
+  AutomationDataRing();
+  ~AutomationDataRing();
+
+  // Creates and maps a new ring of |size| bytes. Used by the reader.
+  bool Create(size_t size);
+
+  // Maps the ring of |size| bytes created by the reader. Used by the writer.
+  bool Map(base::SharedMemoryHandle handle, size_t size);
+
+  // Duplicates the handle of the ring into |process|.
+  bool ShareToProcess(base::ProcessHandle process,
+                      base::SharedMemoryHandle* new_handle);
+
+  // Copies |size| bytes after the ones written before. The caller must know
+  // that the reader consumed enough bytes for them to fit.
+  void Write(const char* data, size_t size);
+
+  // Copies the next |size| bytes to |buffer|. The caller must know that the
+  // writer wrote them.
+  void Read(char* buffer, size_t size);
+
+  size_t size() const { return size_; }
+
+ private:
+  scoped_ptr<base::SharedMemory> memory_;
+  size_t size_;
+
+  // Offset of the next byte this side writes or reads.
+  size_t position_;
+
+  DISALLOW_COPY_AND_ASSIGN(AutomationDataRing);
+};
+
+#endif  // CHROME_COMMON_AUTOMATION_DATA_RING_H_
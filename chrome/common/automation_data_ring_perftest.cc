@@ -0,0 +1,83 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times how fast the body of a large download crosses from Chrome Frame to
+// Chrome, once in AutomationMsg_RequestData messages and once through an
+// AutomationDataRing. Only the copies are timed, not the channel itself,
+// which the messages also have to cross.
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/bind.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/process_util.h"
+#include "base/test/perf_benchmark.h"
+#include "chrome/common/automation_data_ring.h"
+#include "chrome/common/automation_messages.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const size_t kDownloadSize = 32 * 1024 * 1024;
+
+// What URLRequestAutomationJob asks for at a time.
+const size_t kReadSize = 32 * 1024;
+
+// What Chrome Frame reads from the host stack at a time when it fills a ring.
+const size_t kRingSize = 256 * 1024;
+
+// Sends |chunk| until |kDownloadSize| bytes were sent, the way reads were
+// answered before the ring existed.
+void TransferInMessages(const std::string* chunk, char* buffer) {
+  for (size_t sent = 0; sent < kDownloadSize; sent += chunk->size()) {
+    AutomationMsg_RequestData message(1, 1, *chunk);
+    AutomationMsg_RequestData::Param param;
+    CHECK(AutomationMsg_RequestData::Read(&message, &param));
+    memcpy(buffer, param.b.data(), param.b.size());
+  }
+}
+
+// Writes |chunk| to the ring as long as it has room, and reads it back in
+// |kReadSize| pieces.
+void TransferInRing(const std::string* chunk, AutomationDataRing* writer,
+                    AutomationDataRing* reader, char* buffer) {
+  size_t unread = 0;
+  for (size_t sent = 0; sent < kDownloadSize; ) {
+    if (writer->size() - unread >= chunk->size()) {
+      writer->Write(chunk->data(), chunk->size());
+      unread += chunk->size();
+      sent += chunk->size();
+    }
+    while (unread) {
+      size_t bytes = std::min(unread, kReadSize);
+      reader->Read(buffer, bytes);
+      unread -= bytes;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(AutomationDataRingPerfTest, LargeDownload) {
+  scoped_array<char> buffer(new char[kRingSize]);
+
+  std::string read_size_chunk(kReadSize, 'x');
+  base::PerfBenchmark message_benchmark("AutomationDataRing_messages");
+  message_benchmark.Run(
+      base::Bind(&TransferInMessages, &read_size_chunk, buffer.get()));
+
+  AutomationDataRing reader, writer;
+  base::SharedMemoryHandle handle;
+  ASSERT_TRUE(reader.Create(kRingSize));
+  ASSERT_TRUE(reader.ShareToProcess(base::GetCurrentProcessHandle(), &handle));
+  ASSERT_TRUE(writer.Map(handle, kRingSize));
+
+  std::string ring_size_chunk(kRingSize, 'x');
+  base::PerfBenchmark ring_benchmark("AutomationDataRing_ring");
+  ring_benchmark.Run(base::Bind(&TransferInRing, &ring_size_chunk, &writer,
+                                &reader, buffer.get()));
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/common/automation_data_ring.h"
+
+#include <string>
+
+#include "base/process_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const size_t kRingSize = 4096;
+
+// Maps |reader|'s ring into |writer| the way Chrome Frame gets it.
+bool MapRing(AutomationDataRing* reader, AutomationDataRing* writer) {
+  base::SharedMemoryHandle handle;
+  return reader->ShareToProcess(base::GetCurrentProcessHandle(), &handle) &&
+      writer->Map(handle, reader->size());
+}
+
+std::string MakeData(size_t size, char first) {
+  std::string data(size, 0);
+  for (size_t i = 0; i < size; ++i)
+    data[i] = static_cast<char>(first + i % 61);
+  return data;
+}
+
+}  // namespace
+
+TEST(AutomationDataRingTest, WriteThenRead) {
+  AutomationDataRing reader, writer;
+  ASSERT_TRUE(reader.Create(kRingSize));
+  ASSERT_TRUE(MapRing(&reader, &writer));
+  EXPECT_EQ(kRingSize, writer.size());
+
+  std::string data = MakeData(kRingSize, 'a');
+  writer.Write(data.data(), data.size());
+  std::string read(kRingSize, 0);
+  reader.Read(&read[0], read.size());
+  EXPECT_EQ(data, read);
+}
+
+TEST(AutomationDataRingTest, WrapsAround) {
+  AutomationDataRing reader, writer;
+  ASSERT_TRUE(reader.Create(kRingSize));
+  ASSERT_TRUE(MapRing(&reader, &writer));
+
+  // Chunks that do not divide the ring size end up split across its end.
+  const size_t kChunkSizes[] = { 1000, 3000, 1, 4095, 2048, 4096, 7 };
+  for (size_t i = 0; i < arraysize(kChunkSizes); ++i) {
+    std::string data = MakeData(kChunkSizes[i], 'A' + i);
+    writer.Write(data.data(), data.size());
+
+    // Read back in two pieces, like reads with a smaller buffer.
+    std::string read(data.size(), 0);
+    size_t first = read.size() / 3;
+    reader.Read(&read[0], first);
+    reader.Read(&read[first], read.size() - first);
+    EXPECT_EQ(data, read) << i;
+  }
+}
+
+TEST(AutomationDataRingTest, WritesAheadOfReads) {
+  AutomationDataRing reader, writer;
+  ASSERT_TRUE(reader.Create(kRingSize));
+  ASSERT_TRUE(MapRing(&reader, &writer));
+
+  std::string first = MakeData(kRingSize / 2, 'x');
+  std::string second = MakeData(kRingSize / 2, 'y');
+  writer.Write(first.data(), first.size());
+  writer.Write(second.data(), second.size());
+
+  std::string read(kRingSize, 0);
+  reader.Read(&read[0], read.size());
+  EXPECT_EQ(first + second, read);
+}
+
+TEST(AutomationDataRingTest, InvalidSizes) {
+  AutomationDataRing reader;
+  EXPECT_FALSE(reader.Create(0));
+
+  AutomationDataRing writer;
+  EXPECT_FALSE(writer.Map(base::SharedMemory::NULLHandle(), kRingSize));
+}
@@ -1511,6 +1511,26 @@ IPC_SYNC_MESSAGE_CONTROL2_1(AutomationMsg_AppendBackgroundTab,
 IPC_SYNC_MESSAGE_CONTROL0_1(AutomationMsg_GetMachPortCount,
                             int /* number of Mach ports */)
 
+// Hands the external host a shared memory ring (see AutomationDataRing) to
+// write the body of a URL request to, instead of sending it in
+// AutomationMsg_RequestData messages.
+IPC_MESSAGE_ROUTED3(AutomationMsg_RequestDataRing,
+                    int /* request_id */,
+                    base::SharedMemoryHandle /* ring */,
+                    uint32 /* ring_size */)
+
+// Sent by the external host after it wrote more of the body of a URL request
+// to its ring.
+IPC_MESSAGE_ROUTED2(AutomationMsg_RequestDataWritten,
+                    int /* request_id */,
+                    uint32 /* bytes_written */)
+
+// Sent to the external host after bytes were read from the ring of a URL
+// request, so that it can write more.
+IPC_MESSAGE_ROUTED2(AutomationMsg_RequestDataConsumed,
+                    int /* request_id */,
+                    uint32 /* bytes_consumed */)
+
 // Browser -> renderer messages.
 
 // Requests a snapshot.
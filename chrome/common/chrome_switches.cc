@@ -604,6 +604,10 @@ const char kEnableStackedTabStrip[]         = "enable-stacked-tab-strip";
 // Enables experimental suggestions pane in New Tab page.
 const char kEnableSuggestionsTabPage[]      = "enable-suggestions-ntp";
 
+// Enables serving cached resources within their stale-while-revalidate
+// window right away, while revalidating them in the background.
+const char kEnableStaleWhileRevalidate[]    = "enable-stale-while-revalidate";
+
 // Enables the new Sync Signin flow, i.e., chrome:signin for all signins.
 const char kEnableSyncSignin[]              = "enable-sync-signin";
 
@@ -617,6 +621,10 @@ const char kDisableSyncTabs[]               = "disable-sync-tabs";
 const char kEnableSyncTabsForOtherClients[] =
     "enable-sync-tabs-for-other-clients";
 
+// Enables discarding background tabs when the renderers use too much memory.
+// Always on for Chrome OS, see kNoDiscardTabs.
+const char kEnableTabDiscarding[]           = "enable-tab-discarding";
+
 // Enables context menu for selecting groups of tabs.
 const char kEnableTabGroupsContextMenu[]    = "enable-tab-groups-context-menu";
 
@@ -638,6 +646,9 @@ const char kEnableWebSocketOverSpdy[]       = "enable-websocket-over-spdy";
 // Enables the web store link experiment.
 const char kEnableWebStoreLink[]            = "enable-webstore-link";
 
+// Stores new Top Sites thumbnails as WebP rather than JPEG.
+const char kEnableWebPThumbnails[]          = "enable-webp-thumbnails";
+
 // Enables experimental features for Spellchecker. Right now, the first
 // experimental feature is auto spell correct, which corrects words which are
 // misspelled by typing the word with two consecutive letters swapped. The
@@ -854,6 +865,10 @@ const char kNaClGdb[]                       = "nacl-gdb";
 // command line. Useful values might be "valgrind" or "xterm -e gdb --args".
 const char kNaClLoaderCmdPrefix[]           = "nacl-loader-cmd-prefix";
 
+// The number of idle NaCl loader processes to keep launched, so that starting
+// a NaCl module doesn't wait for a new process. None by default.
+const char kNaClLoaderPoolSize[]            = "nacl-loader-pool-size";
+
 // Sets the base logging level for the net log. Log 0 logs the most data.
 // Intended primarily for use with --log-net-log.
 const char kNetLogLevel[]                   = "net-log-level";
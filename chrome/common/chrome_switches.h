@@ -172,16 +172,19 @@ extern const char kEnableSdch[];
 extern const char kEnableSpdy3[];
 extern const char kEnableSpdyFlowControl[];
 extern const char kEnableStackedTabStrip[];
+extern const char kEnableStaleWhileRevalidate[];
 extern const char kEnableSuggestionsTabPage[];
 extern const char kEnableSyncSignin[];
 extern const char kEnableSyncTabs[];
 extern const char kDisableSyncTabs[];
 extern const char kEnableSyncTabsForOtherClients[];
+extern const char kEnableTabDiscarding[];
 extern const char kEnableTabGroupsContextMenu[];
 extern const char kEnableWatchdog[];
 extern const char kEnableWebsiteSettings[];
 extern const char kEnableWebSocketOverSpdy[];
 extern const char kEnableWebStoreLink[];
+extern const char kEnableWebPThumbnails[];
 extern const char kEventPageIdleTime[];
 extern const char kEventPageUnloadingTime[];
 extern const char kExperimentalSpellcheckerFeatures[];
@@ -235,6 +238,7 @@ extern const char kMetricsRecordingOnly[];
 extern const char kMultiProfiles[];
 extern const char kNaClGdb[];
 extern const char kNaClLoaderCmdPrefix[];
+extern const char kNaClLoaderPoolSize[];
 extern const char kNetLogLevel[];
 extern const char kNoDefaultBrowserCheck[];
 extern const char kNoDisplayingInsecureContent[];
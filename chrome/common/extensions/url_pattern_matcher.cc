@@ -0,0 +1,185 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/common/extensions/url_pattern_matcher.h"
+
+#include <algorithm>
+
+#include "base/string_split.h"
+#include "base/string_util.h"
+#include "chrome/common/extensions/url_pattern_set.h"
+#include "chrome/common/url_constants.h"
+#include "googleurl/src/gurl.h"
+
+namespace {
+
+// Returns the labels of |host| from the top level domain down, and none for
+// the empty host.
+std::vector<std::string> GetHostLabels(const std::string& host) {
+  std::vector<std::string> labels;
+  if (host.empty())
+    return labels;
+  base::SplitString(host, '.', &labels);
+  std::reverse(labels.begin(), labels.end());
+  return labels;
+}
+
+}  // namespace
+
+URLPatternMatcher::Entry::Entry(int id, const URLPattern& pattern)
+    : id(id),
+      pattern(pattern) {
+  // <all_urls> matches without looking at the path.
+  if (!pattern.match_all_urls())
+    path_prefix = pattern.path().substr(0, pattern.path().find('*'));
+}
+
+URLPatternMatcher::Entry::~Entry() {}
+
+URLPatternMatcher::HostNode::HostNode() {}
+
+URLPatternMatcher::HostNode::~HostNode() {}
+
+URLPatternMatcher::URLPatternMatcher() {}
+
+URLPatternMatcher::~URLPatternMatcher() {}
+
+void URLPatternMatcher::AddPatterns(int id, const URLPatternSet& patterns) {
+  for (URLPatternSet::const_iterator i = patterns.begin();
+       i != patterns.end(); ++i) {
+    AddPattern(id, *i);
+  }
+}
+
+void URLPatternMatcher::AddPattern(int id, const URLPattern& pattern) {
+  entries_.push_back(Entry(id, pattern));
+  IndexEntry(entries_.size() - 1);
+}
+
+void URLPatternMatcher::RemovePatterns(int id) {
+  std::vector<Entry> entries;
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    if (entries_[i].id != id)
+      entries.push_back(entries_[i]);
+  }
+  if (entries.size() == entries_.size())
+    return;
+
+  // Entries are referred to by index, so reindex them all.
+  Clear();
+  entries_.swap(entries);
+  for (size_t i = 0; i < entries_.size(); ++i)
+    IndexEntry(i);
+}
+
+void URLPatternMatcher::Clear() {
+  entries_.clear();
+  nodes_.clear();
+  scheme_roots_.clear();
+}
+
+void URLPatternMatcher::MatchURL(const GURL& url, std::set<int>* ids) const {
+  if (entries_.empty())
+    return;
+
+  // Look at the inner URL of filesystem URLs, as URLPattern::MatchesURL()
+  // does.
+  const GURL* test_url = &url;
+  std::string path = url.PathForRequest();
+  if (url.inner_url()) {
+    if (!url.SchemeIsFileSystem())
+      return;
+    test_url = url.inner_url();
+    path = test_url->path() + path;
+  }
+
+  std::vector<std::string> host_labels(GetHostLabels(test_url->host()));
+  std::vector<size_t> candidates;
+  CollectCandidates(test_url->scheme(), host_labels, &candidates);
+  CollectCandidates("*", host_labels, &candidates);
+
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    const Entry& entry = entries_[candidates[i]];
+    if (ids->count(entry.id))
+      continue;
+    if (!StartsWithASCII(path, entry.path_prefix, true))
+      continue;
+    if (entry.pattern.MatchesURL(url))
+      ids->insert(entry.id);
+  }
+}
+
+void URLPatternMatcher::IndexEntry(size_t index) {
+  const URLPattern& pattern = entries_[index].pattern;
+
+  std::map<std::string, size_t>::const_iterator found =
+      scheme_roots_.find(pattern.scheme());
+  size_t root;
+  if (found != scheme_roots_.end()) {
+    root = found->second;
+  } else {
+    root = nodes_.size();
+    nodes_.push_back(HostNode());
+    scheme_roots_[pattern.scheme()] = root;
+  }
+
+  // File patterns ignore the host, and <all_urls> matches any.
+  if (pattern.match_all_urls() || pattern.scheme() == chrome::kFileScheme) {
+    nodes_[root].subdomain_entries.push_back(index);
+    return;
+  }
+
+  size_t node = GetOrAddNode(root, pattern.host());
+  if (pattern.match_subdomains())
+    nodes_[node].subdomain_entries.push_back(index);
+  else
+    nodes_[node].host_entries.push_back(index);
+}
+
+size_t URLPatternMatcher::GetOrAddNode(size_t root, const std::string& host) {
+  std::vector<std::string> labels(GetHostLabels(host));
+  size_t node = root;
+  for (size_t i = 0; i < labels.size(); ++i) {
+    std::map<std::string, size_t>::const_iterator child =
+        nodes_[node].children.find(labels[i]);
+    if (child != nodes_[node].children.end()) {
+      node = child->second;
+      continue;
+    }
+    // Adding a node may move the others, so they are only kept by index.
+    size_t new_node = nodes_.size();
+    nodes_.push_back(HostNode());
+    nodes_[node].children[labels[i]] = new_node;
+    node = new_node;
+  }
+  return node;
+}
+
+void URLPatternMatcher::CollectCandidates(
+    const std::string& scheme,
+    const std::vector<std::string>& host_labels,
+    std::vector<size_t>* candidates) const {
+  std::map<std::string, size_t>::const_iterator root =
+      scheme_roots_.find(scheme);
+  if (root == scheme_roots_.end())
+    return;
+
+  // Every domain on the way down is a parent of the host, or the host itself,
+  // so its subdomain patterns may match. URLPattern::MatchesURL() checks the
+  // cases where they don't, such as IP addresses.
+  const HostNode* node = &nodes_[root->second];
+  candidates->insert(candidates->end(), node->subdomain_entries.begin(),
+                     node->subdomain_entries.end());
+  for (size_t i = 0; i < host_labels.size(); ++i) {
+    std::map<std::string, size_t>::const_iterator child =
+        node->children.find(host_labels[i]);
+    if (child == node->children.end())
+      return;
+    node = &nodes_[child->second];
+    candidates->insert(candidates->end(), node->subdomain_entries.begin(),
+                       node->subdomain_entries.end());
+  }
+  candidates->insert(candidates->end(), node->host_entries.begin(),
+                     node->host_entries.end());
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CHROME_COMMON_EXTENSIONS_URL_PATTERN_MATCHER_H_
+#define CHROME_COMMON_EXTENSIONS_URL_PATTERN_MATCHER_H_
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "chrome/common/extensions/url_pattern.h"
+
+class GURL;
+class URLPatternSet;
+
+// Matches a URL against many URLPatternSets at once, and returns the ids of
+// all the sets with a pattern that matches it.
+//
+// Rather than trying every pattern in turn, the patterns are indexed by
+// scheme, then in a trie of their host's labels from the top level domain
+// down. A lookup walks the URL's host down the trie of its scheme (and that of
+// the patterns matching any scheme), collecting the patterns for the host
+// itself and those matching subdomains of each of its parent domains. Only
+// the collected patterns whose path's literal prefix matches the URL are then
+// checked with URLPattern::MatchesURL(), so the results are exactly those of
+// URLPatternSet::MatchesURL().
+class URLPatternMatcher {
+ public:
+  URLPatternMatcher();
+  ~URLPatternMatcher();
+
+  // Adds the patterns of |patterns| under |id|. An id can be added more than
+  // once.
+  void AddPatterns(int id, const URLPatternSet& patterns);
+  void AddPattern(int id, const URLPattern& pattern);
+
+  // Removes all the patterns added under |id|.
+  void RemovePatterns(int id);
+
+  void Clear();
+
+  bool IsEmpty() const { return entries_.empty(); }
+
+  // Adds the id of every pattern matching |url| to |ids|.
+  void MatchURL(const GURL& url, std::set<int>* ids) const;
+
+ private:
+  struct Entry {
+    Entry(int id, const URLPattern& pattern);
+    ~Entry();
+
+    int id;
+    URLPattern pattern;
+
+    // The part of the pattern's path before its first wildcard, which the
+    // path of any URL it matches starts with.
+    std::string path_prefix;
+  };
+
+  // A node of a host trie, for a domain. The root node of each trie is for
+  // the empty host.
+  struct HostNode {
+    HostNode();
+    ~HostNode();
+
+    // The child domains, by their first label.
+    std::map<std::string, size_t> children;
+
+    // The entries whose host is this domain.
+    std::vector<size_t> host_entries;
+
+    // The entries matching this domain and its subdomains.
+    std::vector<size_t> subdomain_entries;
+  };
+
+  // Indexes |entries_[index]|.
+  void IndexEntry(size_t index);
+
+  // Returns the node for |host| in the trie under |root|, adding it if needed.
+  size_t GetOrAddNode(size_t root, const std::string& host);
+
+  // Adds the entries under the trie of |scheme| which could match |host| to
+  // |candidates|.
+  void CollectCandidates(const std::string& scheme,
+                         const std::vector<std::string>& host_labels,
+                         std::vector<size_t>* candidates) const;
+
+  std::vector<Entry> entries_;
+
+  // The nodes of all the tries.
+  std::vector<HostNode> nodes_;
+
+  // The root of the host trie for each pattern scheme, including "*".
+  std::map<std::string, size_t> scheme_roots_;
+};
+
+#endif  // CHROME_COMMON_EXTENSIONS_URL_PATTERN_MATCHER_H_
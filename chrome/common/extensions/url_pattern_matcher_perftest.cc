@@ -0,0 +1,123 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares matching URLs against the content script and webRequest patterns
+// of a few dozen extensions one URLPatternSet at a time with the
+// URLPatternMatcher.
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "chrome/common/extensions/url_pattern_matcher.h"
+#include "chrome/common/extensions/url_pattern_set.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kNumExtensions = 30;
+const int kPatternsPerExtension = 20;
+const int kNumURLs = 1000;
+const int kIterations = 100;
+
+// Sites which extensions commonly target, and which pages commonly visit.
+const char* kSites[] = {
+  "google.com", "facebook.com", "youtube.com", "twitter.com", "amazon.com",
+  "wikipedia.org", "reddit.com", "github.com", "ebay.com", "bbc.co.uk",
+  "nytimes.com", "linkedin.com", "yahoo.com", "stackoverflow.com",
+  "netflix.com", "imdb.com", "pinterest.com", "tumblr.com", "cnn.com",
+  "craigslist.org"
+};
+
+}  // namespace
+
+class URLPatternMatcherPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    for (int i = 0; i < kNumExtensions; ++i) {
+      URLPatternSet set;
+      // A few extensions, such as ad blockers, run everywhere.
+      if (i % 10 == 0)
+        AddPattern(&set, "<all_urls>");
+      if (i % 10 == 1)
+        AddPattern(&set, "http://*/*");
+      for (int j = 0; j < kPatternsPerExtension; ++j) {
+        const char* site = kSites[(i * 7 + j) % arraysize(kSites)];
+        switch (j % 4) {
+          case 0:
+            AddPattern(&set, base::StringPrintf("*://*.%s/*", site));
+            break;
+          case 1:
+            AddPattern(&set, base::StringPrintf("http://www.%s/*", site));
+            break;
+          case 2:
+            AddPattern(&set, base::StringPrintf("https://%s/watch*", site));
+            break;
+          case 3:
+            AddPattern(&set, base::StringPrintf("*://mail.%s/mail/u/%d/*",
+                                                site, i));
+            break;
+        }
+      }
+      sets_.push_back(set);
+    }
+
+    for (int i = 0; i < kNumURLs; ++i) {
+      const char* site = kSites[i % arraysize(kSites)];
+      // Half of the pages are on sites no extension targets.
+      std::string host = i % 2 ?
+          base::StringPrintf("www.%s", site) :
+          base::StringPrintf("www.site%d.com", i);
+      urls_.push_back(GURL(base::StringPrintf(
+          "%s://%s/watch?v=%d", i % 3 ? "http" : "https", host.c_str(), i)));
+    }
+  }
+
+  void AddPattern(URLPatternSet* set, const std::string& pattern) {
+    set->AddPattern(URLPattern(URLPattern::SCHEME_ALL, pattern));
+  }
+
+  std::vector<URLPatternSet> sets_;
+  std::vector<GURL> urls_;
+};
+
+TEST_F(URLPatternMatcherPerfTest, URLPatternSets) {
+  size_t matches = 0;
+  PerfTimeLogger timer("URLPatternMatcher_url_pattern_sets");
+  for (int i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < urls_.size(); ++j) {
+      for (size_t k = 0; k < sets_.size(); ++k) {
+        if (sets_[k].MatchesURL(urls_[j]))
+          ++matches;
+      }
+    }
+  }
+  timer.Done();
+  EXPECT_GT(matches, 0u);
+}
+
+TEST_F(URLPatternMatcherPerfTest, Matcher) {
+  URLPatternMatcher matcher;
+  {
+    PerfTimeLogger timer("URLPatternMatcher_build");
+    for (size_t i = 0; i < sets_.size(); ++i)
+      matcher.AddPatterns(i, sets_[i]);
+  }
+
+  size_t matches = 0;
+  PerfTimeLogger timer("URLPatternMatcher_matcher");
+  for (int i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < urls_.size(); ++j) {
+      std::set<int> ids;
+      matcher.MatchURL(urls_[j], &ids);
+      matches += ids.size();
+    }
+  }
+  timer.Done();
+  EXPECT_GT(matches, 0u);
+}
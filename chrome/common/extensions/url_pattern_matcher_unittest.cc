@@ -0,0 +1,183 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/common/extensions/url_pattern_matcher.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "chrome/common/extensions/url_pattern_set.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+URLPattern Pattern(const std::string& pattern) {
+  return URLPattern(URLPattern::SCHEME_ALL, pattern);
+}
+
+// Returns the ids of the patterns in |matcher| matching |url|.
+std::set<int> Match(const URLPatternMatcher& matcher, const std::string& url) {
+  std::set<int> ids;
+  matcher.MatchURL(GURL(url), &ids);
+  return ids;
+}
+
+std::set<int> Ids(int id) {
+  std::set<int> ids;
+  ids.insert(id);
+  return ids;
+}
+
+std::set<int> Ids(int id1, int id2) {
+  std::set<int> ids(Ids(id1));
+  ids.insert(id2);
+  return ids;
+}
+
+}  // namespace
+
+TEST(URLPatternMatcherTest, Empty) {
+  URLPatternMatcher matcher;
+  EXPECT_TRUE(matcher.IsEmpty());
+  EXPECT_TRUE(Match(matcher, "http://www.google.com/").empty());
+  EXPECT_TRUE(Match(matcher, "invalid").empty());
+}
+
+TEST(URLPatternMatcherTest, Hosts) {
+  URLPatternMatcher matcher;
+  matcher.AddPattern(1, Pattern("http://www.google.com/*"));
+  matcher.AddPattern(2, Pattern("http://*.google.com/*"));
+  matcher.AddPattern(3, Pattern("http://google.com/*"));
+  EXPECT_FALSE(matcher.IsEmpty());
+
+  EXPECT_EQ(Ids(1, 2), Match(matcher, "http://www.google.com/"));
+  EXPECT_EQ(Ids(2, 3), Match(matcher, "http://google.com/foo"));
+  EXPECT_EQ(Ids(2), Match(matcher, "http://a.b.google.com/"));
+  EXPECT_TRUE(Match(matcher, "http://wwwgoogle.com/").empty());
+  EXPECT_TRUE(Match(matcher, "http://google.com.au/").empty());
+  EXPECT_TRUE(Match(matcher, "http://com/").empty());
+}
+
+TEST(URLPatternMatcherTest, Schemes) {
+  URLPatternMatcher matcher;
+  matcher.AddPattern(1, Pattern("http://www.google.com/*"));
+  matcher.AddPattern(2, Pattern("*://www.google.com/*"));
+  matcher.AddPattern(3, Pattern("file:///foo/*"));
+
+  EXPECT_EQ(Ids(1, 2), Match(matcher, "http://www.google.com/"));
+  EXPECT_EQ(Ids(2), Match(matcher, "https://www.google.com/"));
+  EXPECT_TRUE(Match(matcher, "ftp://www.google.com/").empty());
+  EXPECT_EQ(Ids(3), Match(matcher, "file:///foo/bar"));
+  EXPECT_TRUE(Match(matcher, "file:///bar").empty());
+}
+
+TEST(URLPatternMatcherTest, Paths) {
+  URLPatternMatcher matcher;
+  matcher.AddPattern(1, Pattern("http://www.google.com/foo/*"));
+  matcher.AddPattern(2, Pattern("http://www.google.com/*bar"));
+  matcher.AddPattern(3, Pattern("http://www.google.com/a?b"));
+
+  EXPECT_EQ(Ids(1), Match(matcher, "http://www.google.com/foo/baz"));
+  EXPECT_EQ(Ids(1, 2), Match(matcher, "http://www.google.com/foo/bar"));
+  EXPECT_EQ(Ids(2), Match(matcher, "http://www.google.com/bar"));
+  EXPECT_EQ(Ids(3), Match(matcher, "http://www.google.com/a?b"));
+  EXPECT_TRUE(Match(matcher, "http://www.google.com/axb").empty());
+  EXPECT_TRUE(Match(matcher, "http://www.google.com/fo").empty());
+}
+
+TEST(URLPatternMatcherTest, AllHosts) {
+  URLPatternMatcher matcher;
+  matcher.AddPattern(1, Pattern("<all_urls>"));
+  matcher.AddPattern(2, Pattern("http://*/*"));
+  matcher.AddPattern(3, Pattern("http://*.google.com/*"));
+
+  EXPECT_EQ(Ids(1, 2), Match(matcher, "http://127.0.0.1/"));
+  EXPECT_EQ(Ids(1), Match(matcher, "https://www.yahoo.com/"));
+  EXPECT_EQ(Ids(1), Match(matcher, "file:///foo"));
+
+  // Subdomains of IP addresses are never matched.
+  URLPatternMatcher ip_matcher;
+  ip_matcher.AddPattern(1, Pattern("http://*.0.0.1/*"));
+  EXPECT_TRUE(Match(ip_matcher, "http://127.0.0.1/").empty());
+}
+
+TEST(URLPatternMatcherTest, Ports) {
+  URLPatternMatcher matcher;
+  matcher.AddPattern(1, Pattern("http://www.google.com:8080/*"));
+  matcher.AddPattern(2, Pattern("http://www.google.com/*"));
+
+  EXPECT_EQ(Ids(1, 2), Match(matcher, "http://www.google.com:8080/"));
+  EXPECT_EQ(Ids(2), Match(matcher, "http://www.google.com/"));
+}
+
+TEST(URLPatternMatcherTest, FileSystem) {
+  URLPatternMatcher matcher;
+  matcher.AddPattern(1, Pattern("http://www.google.com/foo/*"));
+
+  EXPECT_EQ(Ids(1),
+            Match(matcher, "filesystem:http://www.google.com/foo/bar"));
+  EXPECT_TRUE(Match(matcher, "filesystem:http://www.google.com/bar").empty());
+}
+
+TEST(URLPatternMatcherTest, Sets) {
+  URLPatternSet set1;
+  set1.AddPattern(Pattern("http://www.google.com/*"));
+  set1.AddPattern(Pattern("http://www.yahoo.com/*"));
+  URLPatternSet set2;
+  set2.AddPattern(Pattern("http://*.yahoo.com/*"));
+
+  URLPatternMatcher matcher;
+  matcher.AddPatterns(1, set1);
+  matcher.AddPatterns(2, set2);
+
+  EXPECT_EQ(Ids(1), Match(matcher, "http://www.google.com/"));
+  EXPECT_EQ(Ids(1, 2), Match(matcher, "http://www.yahoo.com/"));
+  EXPECT_EQ(Ids(2), Match(matcher, "http://mail.yahoo.com/"));
+
+  matcher.RemovePatterns(1);
+  EXPECT_TRUE(Match(matcher, "http://www.google.com/").empty());
+  EXPECT_EQ(Ids(2), Match(matcher, "http://www.yahoo.com/"));
+
+  matcher.RemovePatterns(2);
+  EXPECT_TRUE(matcher.IsEmpty());
+  EXPECT_TRUE(Match(matcher, "http://www.yahoo.com/").empty());
+}
+
+// The matcher should agree with URLPatternSet::MatchesURL().
+TEST(URLPatternMatcherTest, MatchesURLPatternSet) {
+  const char* kPatterns[] = {
+    "http://www.google.com/*", "*://*.google.com/*",
+    "https://mail.google.com/a*", "http://*/foo*", "file:///*", "<all_urls>",
+    "http://127.0.0.1/*", "*://*.co.uk/*", "ftp://ftp.mozilla.org/*"
+  };
+  const char* kURLs[] = {
+    "http://www.google.com/", "https://mail.google.com/about",
+    "https://mail.google.com/", "http://bbc.co.uk/foo",
+    "ftp://ftp.mozilla.org/", "file:///etc/hosts", "http://127.0.0.1/foo",
+    "chrome://settings/",
+    "filesystem:https://mail.google.com/temporary/a", "about:blank", ""
+  };
+
+  URLPatternMatcher matcher;
+  std::vector<URLPatternSet> sets(arraysize(kPatterns));
+  for (size_t i = 0; i < arraysize(kPatterns); ++i) {
+    // Each set has one pattern of its own and one shared with the next.
+    sets[i].AddPattern(Pattern(kPatterns[i]));
+    sets[i].AddPattern(Pattern(kPatterns[(i + 1) % arraysize(kPatterns)]));
+    matcher.AddPatterns(i, sets[i]);
+  }
+
+  for (size_t i = 0; i < arraysize(kURLs); ++i) {
+    GURL url(kURLs[i]);
+    std::set<int> ids;
+    matcher.MatchURL(url, &ids);
+    for (size_t j = 0; j < sets.size(); ++j) {
+      EXPECT_EQ(sets[j].MatchesURL(url), ids.count(j) == 1)
+          << kURLs[i] << " " << kPatterns[j];
+    }
+  }
+}
@@ -86,6 +86,18 @@ void WriteToDiskTask(const FilePath& path, const std::string& data) {
   }
 }
 
+void SerializeAndWriteToDiskTask(
+    const FilePath& path,
+    const ImportantFileWriter::DataProducer& producer) {
+  std::string data;
+  if (!producer.Run(&data)) {
+    DLOG(WARNING) << "failed to serialize data to be saved in "
+                  << path.value();
+    return;
+  }
+  WriteToDiskTask(path, data);
+}
+
 }  // namespace
 
 ImportantFileWriter::ImportantFileWriter(
@@ -94,6 +106,7 @@ ImportantFileWriter::ImportantFileWriter(
     : path_(path),
       blocking_task_runner_(blocking_task_runner),
       serializer_(NULL),
+      background_serializer_(NULL),
       commit_interval_(TimeDelta::FromMilliseconds(
           kDefaultCommitIntervalMs)) {
   DCHECK(CalledOnValidThread());
@@ -138,6 +151,21 @@ void ImportantFileWriter::ScheduleWrite(DataSerializer* serializer) {
 
   DCHECK(serializer);
   serializer_ = serializer;
+  background_serializer_ = NULL;
+
+  if (!timer_.IsRunning()) {
+    timer_.Start(FROM_HERE, commit_interval_, this,
+                 &ImportantFileWriter::DoScheduledWrite);
+  }
+}
+
+void ImportantFileWriter::ScheduleWriteWithBackgroundSerializer(
+    BackgroundDataSerializer* serializer) {
+  DCHECK(CalledOnValidThread());
+
+  DCHECK(serializer);
+  background_serializer_ = serializer;
+  serializer_ = NULL;
 
   if (!timer_.IsRunning()) {
     timer_.Start(FROM_HERE, commit_interval_, this,
@@ -146,6 +174,21 @@ void ImportantFileWriter::ScheduleWrite(DataSerializer* serializer) {
 }
 
 void ImportantFileWriter::DoScheduledWrite() {
+  if (background_serializer_) {
+    if (HasPendingWrite())
+      timer_.Stop();
+    DataProducer producer = background_serializer_->GetSerializedDataProducer();
+    background_serializer_ = NULL;
+    if (!blocking_task_runner_->PostTask(
+        FROM_HERE, base::Bind(&SerializeAndWriteToDiskTask, path_, producer))) {
+      // See WriteNow().
+      NOTREACHED();
+
+      SerializeAndWriteToDiskTask(path_, producer);
+    }
+    return;
+  }
+
   DCHECK(serializer_);
   std::string data;
   if (serializer_->SerializeData(&data)) {
@@ -9,6 +9,7 @@
 #include <string>
 
 #include "base/basictypes.h"
+#include "base/callback.h"
 #include "base/file_path.h"
 #include "base/memory/ref_counted.h"
 #include "base/threading/non_thread_safe.h"
@@ -50,6 +51,24 @@ class ImportantFileWriter : public base::NonThreadSafe {
     virtual bool SerializeData(std::string* data) = 0;
   };
 
+  // Puts serialized data in its argument and returns true on success.
+  typedef base::Callback<bool(std::string*)> DataProducer;
+
+  // Used by ScheduleWriteWithBackgroundSerializer for data that is costly to
+  // serialize. Only a snapshot of the data is taken on this thread; the
+  // serialization itself runs on the blocking task runner, just before the
+  // write.
+  class BackgroundDataSerializer {
+   public:
+    virtual ~BackgroundDataSerializer() {}
+
+    // Returns a callback that serializes a snapshot of the current data.
+    // Will be called on the same thread on which ImportantFileWriter has been
+    // created, but the callback is run on the blocking task runner, so it
+    // must not refer to anything this thread may change or destroy.
+    virtual DataProducer GetSerializedDataProducer() = 0;
+  };
+
   // Initialize the writer.
   // |path| is the name of file to write.
   // |file_message_loop_proxy| is the MessageLoopProxy for a thread on which
@@ -80,6 +99,11 @@ class ImportantFileWriter : public base::NonThreadSafe {
   // ImportantFileWriter.
   void ScheduleWrite(DataSerializer* serializer);
 
+  // Like ScheduleWrite(), but the data is serialized on the blocking task
+  // runner rather than on this thread.
+  void ScheduleWriteWithBackgroundSerializer(
+      BackgroundDataSerializer* serializer);
+
   // Serialize data pending to be saved and execute write on backend thread.
   void DoScheduledWrite();
 
@@ -101,8 +125,10 @@ class ImportantFileWriter : public base::NonThreadSafe {
   // Timer used to schedule commit after ScheduleWrite.
   base::OneShotTimer<ImportantFileWriter> timer_;
 
-  // Serializer which will provide the data to be saved.
+  // Serializer which will provide the data to be saved. At most one of these
+  // is set.
   DataSerializer* serializer_;
+  BackgroundDataSerializer* background_serializer_;
 
   // Time delta after which scheduled data will be written to disk.
   base::TimeDelta commit_interval_;
@@ -10,11 +10,17 @@
 #include "base/callback.h"
 #include "base/file_util.h"
 #include "base/json/json_file_value_serializer.h"
-#include "base/json/json_string_value_serializer.h"
+#include "base/json/json_writer.h"
+#include "base/json/string_escape.h"
 #include "base/memory/ref_counted.h"
 #include "base/message_loop_proxy.h"
+#include "base/metrics/histogram.h"
 #include "base/sequenced_task_runner.h"
+#include "base/string_util.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
 #include "base/values.h"
+#include "build/build_config.h"
 
 namespace {
 
@@ -134,8 +140,53 @@ void FileThreadDeserializer::HandleErrors(
   }
 }
 
+// How JSONWriter pretty-prints: it indents each level by this many spaces,
+// and ends lines with kLineEnding.
+const int kIndentSpaces = 3;
+#if defined(OS_WIN)
+const char kLineEnding[] = "\r\n";
+#else
+const char kLineEnding[] = "\n";
+#endif
+
 }  // namespace
 
+class JsonPrefStore::Subtree : public base::RefCountedThreadSafe<Subtree> {
+ public:
+  // Takes ownership of |value|, which must not change afterwards.
+  explicit Subtree(base::Value* value) : value_(value) {}
+
+  // Returns |value_| pretty-printed as a top-level entry of the preferences
+  // dictionary.  Serializes it on the first call only.  Must only be called on
+  // the blocking task runner.
+  const std::string& GetJSON() {
+    if (json_.empty()) {
+      std::string json;
+      base::JSONWriter::WriteWithOptions(
+          value_.get(), base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+      // Drop the final line ending, and indent every non-empty line after the
+      // first by one more level.
+      size_t end = json.find_last_not_of("\r\n") + 1;
+      json_.reserve(end + end / 8);
+      for (size_t i = 0; i < end; ++i) {
+        json_.push_back(json[i]);
+        if (json[i] == '\n' && json[i + 1] != '\r' && json[i + 1] != '\n')
+          json_.append(kIndentSpaces, ' ');
+      }
+    }
+    return json_;
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<Subtree>;
+  ~Subtree() {}
+
+  const scoped_ptr<const base::Value> value_;
+  std::string json_;
+
+  DISALLOW_COPY_AND_ASSIGN(Subtree);
+};
+
 JsonPrefStore::JsonPrefStore(const FilePath& filename,
                              base::SequencedTaskRunner* blocking_task_runner)
     : path_(filename),
@@ -145,7 +196,8 @@ JsonPrefStore::JsonPrefStore(const FilePath& filename,
       writer_(filename, blocking_task_runner),
       error_delegate_(NULL),
       initialized_(false),
-      read_error_(PREF_READ_ERROR_OTHER) {
+      read_error_(PREF_READ_ERROR_OTHER),
+      all_dirty_(true) {
 }
 
 PrefStore::ReadResult JsonPrefStore::GetValue(const std::string& key,
@@ -177,7 +229,11 @@ bool JsonPrefStore::IsInitializationComplete() const {
 
 PrefStore::ReadResult JsonPrefStore::GetMutableValue(const std::string& key,
                                                      Value** result) {
-  return prefs_->Get(key, result) ? READ_OK : READ_NO_VALUE;
+  if (!prefs_->Get(key, result))
+    return READ_NO_VALUE;
+  // The caller may change the value without reporting it.
+  MarkDirty(key);
+  return READ_OK;
 }
 
 void JsonPrefStore::SetValue(const std::string& key, Value* value) {
@@ -198,8 +254,9 @@ void JsonPrefStore::SetValueSilently(const std::string& key, Value* value) {
   prefs_->Get(key, &old_value);
   if (!old_value || !value->Equals(old_value)) {
     prefs_->Set(key, new_value.release());
+    MarkDirty(key);
     if (!read_only_)
-      writer_.ScheduleWrite(this);
+      writer_.ScheduleWriteWithBackgroundSerializer(this);
   }
 }
 
@@ -210,6 +267,7 @@ void JsonPrefStore::RemoveValue(const std::string& key) {
 
 void JsonPrefStore::MarkNeedsEmptyValue(const std::string& key) {
   keys_need_empty_value_.insert(key);
+  MarkDirty(key);
 }
 
 bool JsonPrefStore::ReadOnly() const {
@@ -254,9 +312,10 @@ void JsonPrefStore::CommitPendingWrite() {
 }
 
 void JsonPrefStore::ReportValueChanged(const std::string& key) {
+  MarkDirty(key);
   FOR_EACH_OBSERVER(PrefStore::Observer, observers_, OnPrefValueChanged(key));
   if (!read_only_)
-    writer_.ScheduleWrite(this);
+    writer_.ScheduleWriteWithBackgroundSerializer(this);
 }
 
 void JsonPrefStore::OnFileRead(Value* value_owned,
@@ -284,6 +343,7 @@ void JsonPrefStore::OnFileRead(Value* value_owned,
     case PREF_READ_ERROR_NONE:
       DCHECK(value.get());
       prefs_.reset(static_cast<DictionaryValue*>(value.release()));
+      all_dirty_ = true;
       break;
     case PREF_READ_ERROR_NO_FILE:
       // If the file just doesn't exist, maybe this is first run.  In any case
@@ -308,35 +368,100 @@ JsonPrefStore::~JsonPrefStore() {
   CommitPendingWrite();
 }
 
-bool JsonPrefStore::SerializeData(std::string* output) {
+ImportantFileWriter::DataProducer JsonPrefStore::GetSerializedDataProducer() {
+  if (all_dirty_) {
+    subtrees_.clear();
+    dirty_keys_.clear();
+    for (DictionaryValue::key_iterator it = prefs_->begin_keys();
+         it != prefs_->end_keys(); ++it) {
+      dirty_keys_.insert(*it);
+    }
+    all_dirty_ = false;
+  }
+
+  for (std::set<std::string>::const_iterator it = dirty_keys_.begin();
+       it != dirty_keys_.end(); ++it) {
+    Value* copy = CopyForWriting(*it);
+    if (copy)
+      subtrees_[*it] = new Subtree(copy);
+    else
+      subtrees_.erase(*it);
+  }
+  dirty_keys_.clear();
+
+  return base::Bind(&JsonPrefStore::SerializeSubtrees, subtrees_);
+}
+
+// static
+bool JsonPrefStore::SerializeSubtrees(const SubtreeMap& subtrees,
+                                      std::string* output) {
+  base::TimeTicks start = base::TimeTicks::Now();
+
+  // This matches what JSONWriter would write for the whole dictionary.
+  output->append("{");
+  output->append(kLineEnding);
+  for (SubtreeMap::const_iterator it = subtrees.begin(); it != subtrees.end();
+       ++it) {
+    if (it != subtrees.begin()) {
+      output->append(",");
+      output->append(kLineEnding);
+    }
+    output->append(kIndentSpaces, ' ');
+    base::JsonDoubleQuote(UTF8ToUTF16(it->first), true, output);
+    output->append(": ");
+    output->append(it->second->GetJSON());
+  }
+  output->append(kLineEnding);
+  output->append("}");
+  output->append(kLineEnding);
+
+  UMA_HISTOGRAM_TIMES("PrefService.SerializeTime",
+                      base::TimeTicks::Now() - start);
+  UMA_HISTOGRAM_COUNTS("PrefService.BytesWrittenPerCommit", output->size());
+  return true;
+}
+
+void JsonPrefStore::MarkDirty(const std::string& path) {
+  dirty_keys_.insert(path.substr(0, path.find('.')));
+}
+
+Value* JsonPrefStore::CopyForWriting(const std::string& key) const {
+  Value* value = NULL;
+  if (!prefs_->GetWithoutPathExpansion(key, &value))
+    return NULL;
+
   // TODO(tc): Do we want to prune webkit preferences that match the default
   // value?
-  JSONStringValueSerializer serializer(output);
-  serializer.set_pretty_print(true);
-  scoped_ptr<DictionaryValue> copy(prefs_->DeepCopyWithoutEmptyChildren());
+  DictionaryValue wrapper;
+  wrapper.SetWithoutPathExpansion(key, value->DeepCopy());
+  scoped_ptr<DictionaryValue> copy(wrapper.DeepCopyWithoutEmptyChildren());
 
-  // Iterates |keys_need_empty_value_| and if the key exists in |prefs_|,
-  // ensure its empty ListValue or DictonaryValue is preserved.
+  // Iterates the paths in |keys_need_empty_value_| under |key|, and if the
+  // path exists in |prefs_|, ensure its empty ListValue or DictonaryValue is
+  // preserved.
   for (std::set<std::string>::const_iterator
-       it = keys_need_empty_value_.begin();
-       it != keys_need_empty_value_.end();
+       it = keys_need_empty_value_.lower_bound(key);
+       it != keys_need_empty_value_.end() && StartsWithASCII(*it, key, true);
        ++it) {
-    const std::string& key = *it;
+    const std::string& path = *it;
+    if (path.size() != key.size() && path[key.size()] != '.')
+      continue;
 
-    base::Value* value = NULL;
-    if (!prefs_->Get(key, &value))
+    if (!prefs_->Get(path, &value))
       continue;
 
     if (value->IsType(base::Value::TYPE_LIST)) {
       const base::ListValue* list = NULL;
       if (value->GetAsList(&list) && list->empty())
-        copy->Set(key, new base::ListValue);
+        copy->Set(path, new base::ListValue);
     } else if (value->IsType(base::Value::TYPE_DICTIONARY)) {
       const base::DictionaryValue* dict = NULL;
       if (value->GetAsDictionary(&dict) && dict->empty())
-        copy->Set(key, new base::DictionaryValue);
+        copy->Set(path, new base::DictionaryValue);
     }
   }
 
-  return serializer.Serialize(*(copy.get()));
+  Value* result = NULL;
+  copy->RemoveWithoutPathExpansion(key, &result);
+  return result;
 }
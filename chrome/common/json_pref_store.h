@@ -6,12 +6,14 @@
 #define CHROME_COMMON_JSON_PREF_STORE_H_
 #pragma once
 
+#include <map>
 #include <set>
 #include <string>
 
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
 #include "base/file_path.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/observer_list.h"
 #include "chrome/common/important_file_writer.h"
@@ -26,8 +28,13 @@ class Value;
 class FilePath;
 
 // A writable PrefStore implementation that is used for user preferences.
+//
+// Writes are serialized on |blocking_task_runner|, from a snapshot of the
+// preferences.  The snapshot is taken per top-level preference, and only the
+// top-level preferences that changed since the last write are copied and
+// serialized again.
 class JsonPrefStore : public PersistentPrefStore,
-                      public ImportantFileWriter::DataSerializer {
+                      public ImportantFileWriter::BackgroundDataSerializer {
  public:
   // |blocking_task_runner| is the SequencedTaskRunner on which file
   // I/O can be done.
@@ -64,10 +71,29 @@ class JsonPrefStore : public PersistentPrefStore,
   void OnFileRead(base::Value* value_owned, PrefReadError error, bool no_dir);
 
  private:
+  // A top-level preference as it will be written.  Shared with the
+  // serialization running on |blocking_task_runner_|.
+  class Subtree;
+  typedef std::map<std::string, scoped_refptr<Subtree> > SubtreeMap;
+
   virtual ~JsonPrefStore();
 
-  // ImportantFileWriter::DataSerializer overrides:
-  virtual bool SerializeData(std::string* output) OVERRIDE;
+  // ImportantFileWriter::BackgroundDataSerializer overrides:
+  virtual ImportantFileWriter::DataProducer GetSerializedDataProducer()
+      OVERRIDE;
+
+  // Writes |subtrees| to |output| as a pretty-printed JSON dictionary.  Runs
+  // on |blocking_task_runner_|.
+  static bool SerializeSubtrees(const SubtreeMap& subtrees,
+                                std::string* output);
+
+  // Records that the top-level preference containing |path| has changed.
+  void MarkDirty(const std::string& path);
+
+  // Returns a copy of the top-level preference |key| without its empty
+  // children, except those in |keys_need_empty_value_|, or NULL if nothing is
+  // left to write.
+  base::Value* CopyForWriting(const std::string& key) const;
 
   FilePath path_;
   scoped_refptr<base::SequencedTaskRunner> blocking_task_runner_;
@@ -88,6 +114,13 @@ class JsonPrefStore : public PersistentPrefStore,
 
   std::set<std::string> keys_need_empty_value_;
 
+  // The snapshot of every top-level preference as of the last write, except
+  // the ones changed since, which are listed in |dirty_keys_|.  If
+  // |all_dirty_| is set, |prefs_| has been replaced since the last write.
+  SubtreeMap subtrees_;
+  std::set<std::string> dirty_keys_;
+  bool all_dirty_;
+
   DISALLOW_COPY_AND_ASSIGN(JsonPrefStore);
 };
 
@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include "base/file_util.h"
+#include "base/json/json_writer.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop.h"
@@ -291,3 +292,52 @@ TEST_F(JsonPrefStoreTest, NeedsEmptyValue) {
   ASSERT_TRUE(file_util::PathExists(golden_output_file));
   EXPECT_TRUE(file_util::TextContentsEqual(golden_output_file, pref_file));
 }
+
+// Tests that writes after small changes, which only reserialize what changed,
+// produce the same file as serializing everything.
+TEST_F(JsonPrefStoreTest, IncrementalWrites) {
+  FilePath pref_file = temp_dir_.path().AppendASCII("write.json");
+  scoped_refptr<JsonPrefStore> pref_store =
+      new JsonPrefStore(pref_file, message_loop_proxy_.get());
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NO_FILE,
+            pref_store->ReadPrefs());
+
+  DictionaryValue expected;
+  const char* kPaths[] = {
+    "homepage", "tabs.max_tabs", "tabs.new_windows_in_tabs",
+    "extensions.settings.abc.state", "extensions.settings.def.state",
+    "profile.name", "unicode.\xE2\x82\xAC",
+  };
+  for (size_t i = 0; i < arraysize(kPaths); ++i) {
+    pref_store->SetValue(kPaths[i], Value::CreateIntegerValue(i));
+    expected.SetInteger(kPaths[i], i);
+  }
+  pref_store->SetValue("empty", new DictionaryValue);
+
+  for (int round = 0; round < 3; ++round) {
+    pref_store->CommitPendingWrite();
+    MessageLoop::current()->RunAllPending();
+
+    std::string expected_json;
+    base::JSONWriter::WriteWithOptions(
+        &expected, base::JSONWriter::OPTIONS_PRETTY_PRINT, &expected_json);
+    std::string actual_json;
+    ASSERT_TRUE(file_util::ReadFileToString(pref_file, &actual_json));
+    EXPECT_EQ(expected_json, actual_json) << round;
+
+    // Change one subtree in place, as ScopedUserPrefUpdate does, and replace
+    // another.
+    Value* settings = NULL;
+    ASSERT_EQ(PrefStore::READ_OK,
+              pref_store->GetMutableValue("extensions.settings.abc",
+                                          &settings));
+    static_cast<DictionaryValue*>(settings)->SetInteger("state", round + 10);
+    pref_store->ReportValueChanged("extensions.settings.abc");
+    expected.SetInteger("extensions.settings.abc.state", round + 10);
+    pref_store->SetValue("profile.name", Value::CreateStringValue("x"));
+    expected.SetString("profile.name", "x");
+    pref_store->RemoveValue("homepage");
+    expected.Remove("homepage", NULL);
+  }
+}
+
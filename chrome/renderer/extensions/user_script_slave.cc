@@ -132,7 +132,9 @@ void UserScriptSlave::GetActiveExtensions(
 }
 
 bool UserScriptSlave::UpdateScripts(base::SharedMemoryHandle shared_memory) {
+  script_sources_.clear();
   scripts_.clear();
+  script_matcher_.Clear();
 
   bool only_inject_incognito =
       ChromeRenderProcessObserver::is_incognito_process();
@@ -192,6 +194,9 @@ bool UserScriptSlave::UpdateScripts(base::SharedMemoryHandle shared_memory) {
     }
   }
 
+  for (size_t i = 0; i < scripts_.size(); ++i)
+    script_matcher_.AddPatterns(i, scripts_[i]->url_patterns());
+
   // Push user styles down into WebCore
   RenderThread::Get()->EnsureWebKitInitialized();
   WebView::removeAllUserContent();
@@ -230,6 +235,28 @@ bool UserScriptSlave::UpdateScripts(base::SharedMemoryHandle shared_memory) {
   return true;
 }
 
+WebString UserScriptSlave::GetScriptSource(const UserScript& script,
+                                           const UserScript::File& file) {
+  ScriptSourceMap::const_iterator it = script_sources_.find(&file);
+  if (it != script_sources_.end())
+    return it->second;
+
+  std::string content = file.GetContent().as_string();
+
+  // We add this dumb function wrapper for standalone user script to
+  // emulate what Greasemonkey does.
+  // TODO(aa): I think that maybe "is_standalone" scripts don't exist
+  // anymore. Investigate.
+  if (script.is_standalone() || script.emulate_greasemonkey()) {
+    content.insert(0, kUserScriptHead);
+    content += kUserScriptTail;
+  }
+
+  WebString source = WebString::fromUTF8(content);
+  script_sources_[&file] = source;
+  return source;
+}
+
 GURL UserScriptSlave::GetDataSourceURLForFrame(WebFrame* frame) {
   // Normally we would use frame->document().url() to determine the document's
   // URL, but to decide whether to inject a content script, we use the URL from
@@ -259,6 +286,11 @@ void UserScriptSlave::InjectScripts(WebFrame* frame,
   int num_css = 0;
   int num_scripts = 0;
 
+  // Find the scripts whose URL patterns match the page in one go, rather
+  // than checking each script's patterns in turn.
+  std::set<int> matching_scripts;
+  script_matcher_.MatchURL(data_source_url, &matching_scripts);
+
   for (size_t i = 0; i < scripts_.size(); ++i) {
     std::vector<WebScriptSource> sources;
     UserScript* script = scripts_[i];
@@ -266,6 +298,9 @@ void UserScriptSlave::InjectScripts(WebFrame* frame,
     if (frame->parent() && !script->match_all_frames())
       continue;  // Only match subframes if the script declared it wanted to.
 
+    if (!script->url_patterns().is_empty() && !matching_scripts.count(i))
+      continue;
+
     const Extension* extension = extensions_->GetByID(script->extension_id());
 
     // Since extension info is sent separately from user script info, they can
@@ -284,19 +319,9 @@ void UserScriptSlave::InjectScripts(WebFrame* frame,
     if (script->run_location() == location) {
       num_scripts += script->js_scripts().size();
       for (size_t j = 0; j < script->js_scripts().size(); ++j) {
-        UserScript::File &file = script->js_scripts()[j];
-        std::string content = file.GetContent().as_string();
-
-        // We add this dumb function wrapper for standalone user script to
-        // emulate what Greasemonkey does.
-        // TODO(aa): I think that maybe "is_standalone" scripts don't exist
-        // anymore. Investigate.
-        if (script->is_standalone() || script->emulate_greasemonkey()) {
-          content.insert(0, kUserScriptHead);
-          content += kUserScriptTail;
-        }
+        const UserScript::File& file = script->js_scripts()[j];
         sources.push_back(
-            WebScriptSource(WebString::fromUTF8(content), file.url()));
+            WebScriptSource(GetScriptSource(*script, file), file.url()));
       }
     }
 
@@ -306,8 +331,9 @@ void UserScriptSlave::InjectScripts(WebFrame* frame,
       // Emulate Greasemonkey API for scripts that were converted to extensions
       // and "standalone" user scripts.
       if (script->is_standalone() || script->emulate_greasemonkey()) {
-        sources.insert(sources.begin(),
-            WebScriptSource(WebString::fromUTF8(api_js_.as_string())));
+        if (api_js_source_.isNull())
+          api_js_source_ = WebString::fromUTF8(api_js_.as_string());
+        sources.insert(sources.begin(), WebScriptSource(api_js_source_));
       }
 
       // TODO(aa): Can extension_id() ever be empty anymore?
@@ -15,8 +15,10 @@
 #include "base/shared_memory.h"
 #include "base/stl_util.h"
 #include "base/string_piece.h"
+#include "chrome/common/extensions/url_pattern_matcher.h"
 #include "chrome/common/extensions/user_script.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/WebScriptSource.h"
+#include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebString.h"
 
 class Extension;
 class ExtensionSet;
@@ -66,6 +68,11 @@ class UserScriptSlave {
   static void InitializeIsolatedWorld(int isolated_world_id,
                                       const Extension* extension);
 
+  // Returns the source to execute for |file| of |script|, converting it from
+  // the UTF-8 in shared memory only the first time it is injected.
+  WebKit::WebString GetScriptSource(const UserScript& script,
+                                    const UserScript::File& file);
+
   // Shared memory containing raw script data.
   scoped_ptr<base::SharedMemory> shared_memory_;
 
@@ -73,8 +80,18 @@ class UserScriptSlave {
   std::vector<UserScript*> scripts_;
   STLElementDeleter<std::vector<UserScript*> > script_deleter_;
 
+  // The URL patterns of |scripts_|, by script index.
+  URLPatternMatcher script_matcher_;
+
   // Greasemonkey API source that is injected with the scripts.
   base::StringPiece api_js_;
+  WebKit::WebString api_js_source_;
+
+  // Converted sources of the js files of |scripts_|. WebStrings share their
+  // buffer, so each page load reuses the same copy of a script instead of
+  // making a new one.
+  typedef std::map<const UserScript::File*, WebKit::WebString> ScriptSourceMap;
+  ScriptSourceMap script_sources_;
 
   // Extension metadata.
   const ExtensionSet* extensions_;
@@ -254,6 +254,21 @@ void PageLoadHistograms::Dump(WebFrame* frame) {
     }
     DCHECK(commit <= first_paint);
     PLT_HISTOGRAM("PLT.CommitToFirstPaint", first_paint - commit);
+
+    // Histograms to determine the impact of the resource scheduler, which
+    // delays images and the requests of hidden tabs in the browser.
+    static const bool use_resource_scheduler_histogram =
+        base::FieldTrialList::TrialExists("ResourceScheduler");
+    if (use_resource_scheduler_histogram) {
+      if (begin <= first_paint) {
+        PLT_HISTOGRAM(base::FieldTrial::MakeName(
+            "PLT.BeginToFirstPaint", "ResourceScheduler"),
+            first_paint - begin);
+      }
+      PLT_HISTOGRAM(base::FieldTrial::MakeName(
+          "PLT.CommitToFirstPaint", "ResourceScheduler"),
+          first_paint - commit);
+    }
   }
   if (!first_paint_after_load.is_null()) {
     // 'first_paint_after_load' can be before 'begin' for an unknown reason.
@@ -51,6 +51,15 @@ WebVector<WebTextCheckingResult> ToWebResultList(
 }
 } // namespace spellcheck
 
+namespace {
+
+// The maximum number of words kept in SpellCheck::word_result_cache_. The
+// cache is simply dropped when it grows past this, which is rare enough
+// not to need an LRU.
+const size_t kMaxCachedWordResults = 10000;
+
+}  // namespace
+
 class SpellCheck::SpellCheckRequestParam
     : public base::RefCountedThreadSafe<SpellCheck::SpellCheckRequestParam> {
  public:
@@ -133,6 +142,8 @@ void SpellCheck::OnWordAdded(const std::string& word) {
     custom_words_.push_back(word);
   } else {
     AddWordToHunspell(word);
+    // The new word may also make other forms of it valid.
+    word_result_cache_.clear();
   }
 }
 
@@ -146,6 +157,7 @@ void SpellCheck::Init(base::PlatformFile file,
   initialized_ = true;
   hunspell_.reset();
   bdict_file_.reset();
+  word_result_cache_.clear();
   file_ = file;
   is_using_platform_spelling_engine_ =
       file == base::kInvalidPlatformFileValue && !language.empty();
@@ -337,9 +349,7 @@ void SpellCheck::RequestTextChecking(
     return;
   }
 
-  requested_params_.push(new SpellCheckRequestParam(text, offset, completion));
-  base::MessageLoopProxy::current()->PostTask(FROM_HERE,
-      base::Bind(&SpellCheck::PerformSpellCheck, AsWeakPtr()));
+  EnqueueRequest(new SpellCheckRequestParam(text, offset, completion));
 #else
   NOTREACHED();
 #endif
@@ -409,9 +419,18 @@ bool SpellCheck::CheckSpelling(const string16& word_to_check, int tag) {
     // Hunspell shouldn't let us exceed its max, but check just in case
     if (word_to_check_utf8.length() < MAXWORDUTF8LEN) {
       if (hunspell_.get()) {
+        WordResultCache::const_iterator cached =
+            word_result_cache_.find(word_to_check);
+        if (cached != word_result_cache_.end())
+          return cached->second;
+
         // |hunspell_->spell| returns 0 if the word is spelled correctly and
         // non-zero otherwsie.
         word_correct = (hunspell_->spell(word_to_check_utf8.c_str()) != 0);
+
+        if (word_result_cache_.size() >= kMaxCachedWordResults)
+          word_result_cache_.clear();
+        word_result_cache_[word_to_check] = word_correct;
       } else {
         // If |hunspell_| is NULL here, an error has occurred, but it's better
         // to check rather than crash.
@@ -430,25 +449,34 @@ void SpellCheck::PostDelayedSpellCheckTask() {
   if (file_ == base::kInvalidPlatformFileValue) {
     pending_request_param_->completion()->didCancelCheckingText();
   } else {
-    requested_params_.push(pending_request_param_);
-    base::MessageLoopProxy::current()->PostTask(FROM_HERE,
-        base::Bind(&SpellCheck::PerformSpellCheck, AsWeakPtr()));
+    EnqueueRequest(pending_request_param_);
   }
 
   pending_request_param_ = NULL;
 }
 
+void SpellCheck::EnqueueRequest(SpellCheckRequestParam* param) {
+  requested_params_.push(param);
+  if (requested_params_.size() == 1) {
+    base::MessageLoopProxy::current()->PostTask(FROM_HERE,
+        base::Bind(&SpellCheck::PerformSpellCheck, AsWeakPtr()));
+  }
+}
+
 void SpellCheck::PerformSpellCheck() {
 #if !defined(OS_MACOSX)
-  DCHECK(!requested_params_.empty());
-  scoped_refptr<SpellCheckRequestParam> param = requested_params_.front();
-  DCHECK(param);
-  requested_params_.pop();
-
-  std::vector<SpellCheckResult> results;
-  SpellCheckParagraph(param->text(), &results);
-  param->completion()->didFinishCheckingText(
-      spellcheck::ToWebResultList(param->offset(), results));
+  // A completion may queue a new request, which is then handled in this
+  // batch and leaves the task it posted with nothing to do.
+  while (!requested_params_.empty()) {
+    scoped_refptr<SpellCheckRequestParam> param = requested_params_.front();
+    DCHECK(param);
+    requested_params_.pop();
+
+    std::vector<SpellCheckResult> results;
+    SpellCheckParagraph(param->text(), &results);
+    param->completion()->didFinishCheckingText(
+        spellcheck::ToWebResultList(param->offset(), results));
+  }
 #else
   // SpellCheck::SpellCheckParagraph is not implemented on Mac,
   // so we return without spellchecking. Note that Mac uses its own
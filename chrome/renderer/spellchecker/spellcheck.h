@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "base/gtest_prod_util.h"
+#include "base/hash_tables.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
@@ -107,6 +108,7 @@ class SpellCheck : public content::RenderProcessObserver,
   FRIEND_TEST_ALL_PREFIXES(SpellCheckTest, GetAutoCorrectionWord_EN_US);
   FRIEND_TEST_ALL_PREFIXES(SpellCheckTest,
       RequestSpellCheckMultipleTimesWithoutInitialization);
+  FRIEND_TEST_ALL_PREFIXES(SpellCheckTest, AddedWordInvalidatesCachedResults);
 
   class SpellCheckRequestParam;
 
@@ -140,7 +142,12 @@ class SpellCheck : public content::RenderProcessObserver,
   // Posts delayed spellcheck task and clear it if any.
   void PostDelayedSpellCheckTask();
 
-  // Performs spell checking from the request queue.
+  // Queues |param| and posts a task to run PerformSpellCheck() unless one is
+  // already pending for the queue.
+  void EnqueueRequest(SpellCheckRequestParam* param);
+
+  // Performs spell checking for every request in the queue, so that requests
+  // arriving while the renderer is busy are answered in one batch.
   void PerformSpellCheck();
 
   // When called, relays the request to fill the list with suggestions to
@@ -161,6 +168,12 @@ class SpellCheck : public content::RenderProcessObserver,
   // The hunspell dictionary in use.
   scoped_ptr<Hunspell> hunspell_;
 
+  // Hunspell results of recently checked words, so that re-checking a
+  // paragraph as the user types does not look up every word again. Cleared
+  // whenever the dictionary or the custom words change.
+  typedef base::hash_map<string16, bool> WordResultCache;
+  WordResultCache word_result_cache_;
+
   base::PlatformFile file_;
   std::vector<std::string> custom_words_;
 
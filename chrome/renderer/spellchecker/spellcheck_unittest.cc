@@ -972,3 +972,21 @@ TEST_F(SpellCheckTest, RequestSpellCheckMultipleTimesWithoutInitialization) {
 }
 
 #endif
+
+// Makes sure a custom word is accepted even after its misspelling has been
+// cached.
+TEST_F(SpellCheckTest, AddedWordInvalidatesCachedResults) {
+  const string16 word = ASCIIToUTF16("zzzzz");
+  int misspelling_start = 0;
+  int misspelling_length = 0;
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_FALSE(spell_check()->SpellCheckWord(
+        word.c_str(), static_cast<int>(word.length()), 0,
+        &misspelling_start, &misspelling_length, NULL));
+  }
+
+  spell_check()->OnWordAdded("zzzzz");
+  EXPECT_TRUE(spell_check()->SpellCheckWord(
+      word.c_str(), static_cast<int>(word.length()), 0,
+      &misspelling_start, &misspelling_length, NULL));
+}
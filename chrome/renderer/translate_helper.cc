@@ -9,6 +9,8 @@
 #include "base/logging.h"
 #include "base/message_loop.h"
 #include "base/metrics/histogram.h"
+#include "base/task_runner_util.h"
+#include "base/threading/worker_pool.h"
 #include "base/utf_string_conversions.h"
 #include "chrome/common/chrome_constants.h"
 #include "chrome/common/render_messages.h"
@@ -44,6 +46,15 @@ static const int kTranslateStatusCheckDelayMs = 400;
 // Language name passed to the Translate element for it to detect the language.
 static const char* const kAutoDetectionLanguage = "auto";
 
+// The number of characters the CLD looks at in one go. Pages with no more text
+// than this are detected synchronously, as it is cheaper than a thread hop.
+static const size_t kLanguageDetectionChunkChars = 4096;
+
+// The maximum number of characters of the page text used for language
+// detection. The start of a page is enough to tell its language.
+static const size_t kMaxLanguageDetectionChars =
+    16 * kLanguageDetectionChunkChars;
+
 ////////////////////////////////////////////////////////////////////////////////
 // TranslateHelper, public:
 //
@@ -51,7 +62,8 @@ TranslateHelper::TranslateHelper(content::RenderView* render_view)
     : content::RenderViewObserver(render_view),
       translation_pending_(false),
       page_id_(-1),
-      ALLOW_THIS_IN_INITIALIZER_LIST(weak_method_factory_(this)) {
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_method_factory_(this)),
+      ALLOW_THIS_IN_INITIALIZER_LIST(detection_weak_factory_(this)) {
 }
 
 TranslateHelper::~TranslateHelper() {
@@ -59,21 +71,35 @@ TranslateHelper::~TranslateHelper() {
 }
 
 void TranslateHelper::PageCaptured(const string16& contents) {
+  // A newer capture supersedes any detection still running for an older one.
+  detection_weak_factory_.InvalidateWeakPtrs();
+
   WebDocument document = render_view()->GetWebView()->mainFrame()->document();
   // If the page explicitly specifies a language, use it, otherwise we'll
   // determine it based on the text content using the CLD.
   std::string language = GetPageLanguageFromMetaTag(&document);
+  bool translatable = IsPageTranslatable(&document);
   if (language.empty()) {
-    base::TimeTicks begin_time = base::TimeTicks::Now();
-    language = DetermineTextLanguage(contents);
-    UMA_HISTOGRAM_MEDIUM_TIMES("Renderer4.LanguageDetection",
-                               base::TimeTicks::Now() - begin_time);
+    if (contents.size() > kLanguageDetectionChunkChars) {
+      // Running the CLD over a large page takes tens of milliseconds, so do it
+      // off the render thread.
+      base::PostTaskAndReplyWithResult(
+          base::WorkerPool::GetTaskRunner(false),
+          FROM_HERE,
+          base::Bind(&TranslateHelper::DetermineSampledTextLanguage,
+                     contents.substr(0, kMaxLanguageDetectionChars)),
+          base::Bind(&TranslateHelper::OnTextLanguageDetermined,
+                     detection_weak_factory_.GetWeakPtr(),
+                     render_view()->GetPageId(), translatable));
+      return;
+    }
+    language = DetermineSampledTextLanguage(contents);
   } else {
     VLOG(1) << "PageLanguageFromMetaTag: " << language;
   }
 
   Send(new ChromeViewHostMsg_TranslateLanguageDetermined(
-      routing_id(), language, IsPageTranslatable(&document)));
+      routing_id(), language, translatable));
 }
 
 void TranslateHelper::CancelPendingTranslation() {
@@ -165,6 +191,49 @@ std::string TranslateHelper::DetermineTextLanguage(const string16& text) {
   return language;
 }
 
+// static
+std::string TranslateHelper::DetermineSampledTextLanguage(
+    const string16& text) {
+  base::TimeTicks begin_time = base::TimeTicks::Now();
+  string16 sample = text.substr(0, kMaxLanguageDetectionChars);
+
+  std::string language;
+  bool early_exit = false;
+  if (sample.size() > kLanguageDetectionChunkChars) {
+    std::string previous_language;
+    for (size_t offset = 0; offset < sample.size();
+         offset += kLanguageDetectionChunkChars) {
+      std::string chunk_language = DetermineTextLanguage(
+          sample.substr(offset, kLanguageDetectionChunkChars));
+      if (chunk_language != chrome::kUnknownLanguageCode &&
+          chunk_language == previous_language) {
+        language = chunk_language;
+        early_exit = true;
+        break;
+      }
+      previous_language = chunk_language;
+    }
+    UMA_HISTOGRAM_BOOLEAN("Renderer4.LanguageDetectionEarlyExit", early_exit);
+  }
+  // The chunks disagreed or were too short to be reliable on their own.
+  if (!early_exit)
+    language = DetermineTextLanguage(sample);
+
+  UMA_HISTOGRAM_MEDIUM_TIMES("Renderer4.LanguageDetection",
+                             base::TimeTicks::Now() - begin_time);
+  return language;
+}
+
+void TranslateHelper::OnTextLanguageDetermined(int page_id,
+                                               bool translatable,
+                                               std::string language) {
+  if (render_view()->GetPageId() != page_id)
+    return;  // We navigated away, the language is stale.
+
+  Send(new ChromeViewHostMsg_TranslateLanguageDetermined(
+      routing_id(), language, translatable));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // TranslateHelper, protected:
 //
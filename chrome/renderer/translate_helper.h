@@ -82,6 +82,18 @@ class TranslateHelper : public content::RenderViewObserver {
   // if it failed.
   static std::string DetermineTextLanguage(const string16& text);
 
+  // Same as DetermineTextLanguage(), but only looks at a bounded prefix of
+  // |text|, chunk by chunk, and stops as soon as two consecutive chunks are
+  // reliably detected as the same language. Records the detection time.
+  // Safe to call on any thread.
+  static std::string DetermineSampledTextLanguage(const string16& text);
+
+  // Called on the render thread when the language of the text captured for
+  // |page_id| has been determined on a worker thread.
+  void OnTextLanguageDetermined(int page_id,
+                                bool translatable,
+                                std::string language);
+
   // RenderViewObserver implementation.
   virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE;
 
@@ -133,6 +145,10 @@ class TranslateHelper : public content::RenderViewObserver {
   // Method factory used to make calls to TranslatePageImpl.
   base::WeakPtrFactory<TranslateHelper> weak_method_factory_;
 
+  // Used for language detection replies, which must not be dropped when a
+  // translation is cancelled.
+  base::WeakPtrFactory<TranslateHelper> detection_weak_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(TranslateHelper);
 };
 
@@ -116,11 +116,11 @@ net::URLRequestContextGetter* TestingBrowserProcess::system_request_context() {
   return NULL;
 }
 
-#if defined(OS_CHROMEOS)
+#if !defined(OS_ANDROID)
 browser::OomPriorityManager* TestingBrowserProcess::oom_priority_manager() {
   return NULL;
 }
-#endif  // defined(OS_CHROMEOS)
+#endif  // !defined(OS_ANDROID)
 
 ui::Clipboard* TestingBrowserProcess::clipboard() {
   if (!clipboard_.get()) {
@@ -67,9 +67,9 @@ class TestingBrowserProcess : public BrowserProcess {
       safe_browsing_detection_service() OVERRIDE;
   virtual net::URLRequestContextGetter* system_request_context() OVERRIDE;
 
-#if defined(OS_CHROMEOS)
+#if !defined(OS_ANDROID)
   virtual browser::OomPriorityManager* oom_priority_manager() OVERRIDE;
-#endif  // defined(OS_CHROMEOS)
+#endif  // !defined(OS_ANDROID)
 
   virtual ui::Clipboard* clipboard() OVERRIDE;
   virtual ExtensionEventRouterForwarder*
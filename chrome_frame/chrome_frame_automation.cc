@@ -4,6 +4,8 @@
 
 #include "chrome_frame/chrome_frame_automation.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/callback.h"
@@ -23,6 +25,7 @@
 #include "base/sys_info.h"
 #include "base/utf_string_conversions.h"
 #include "chrome/app/client_util.h"
+#include "chrome/common/automation_data_ring.h"
 #include "chrome/common/automation_messages.h"
 #include "chrome/common/chrome_constants.h"
 #include "chrome/common/chrome_switches.h"
@@ -537,6 +540,17 @@ bool ProxyFactory::ReleaseAutomationServer(void* server_id,
 static base::LazyInstance<ProxyFactory>::Leaky
     g_proxy_factory = LAZY_INSTANCE_INITIALIZER;
 
+// The ring of a request, and what the client knows about the data in it.
+struct ChromeFrameAutomationClient::DataRing {
+  DataRing() : bytes_unconsumed(0), read_pending(false) {}
+
+  AutomationDataRing ring;
+  // Bytes written to the ring that Chrome did not report as consumed yet.
+  size_t bytes_unconsumed;
+  // Whether a read of the request is under way.
+  bool read_pending;
+};
+
 ChromeFrameAutomationClient::ChromeFrameAutomationClient()
     : chrome_frame_delegate_(NULL),
       chrome_window_(NULL),
@@ -983,8 +997,8 @@ bool ChromeFrameAutomationClient::ProcessUrlRequestMessage(TabProxy* tab,
     case AutomationMsg_RequestRead::ID:
       if (ui_thread || (url_fetcher_flags_ &
                             PluginUrlRequestManager::READ_REQUEST_THREADSAFE)) {
-        AutomationMsg_RequestRead::Dispatch(&msg, url_fetcher_, this,
-            &PluginUrlRequestManager::ReadUrlRequest);
+        AutomationMsg_RequestRead::Dispatch(&msg, this, this,
+            &ChromeFrameAutomationClient::OnRequestRead);
         return true;
       }
       break;
@@ -992,12 +1006,24 @@ bool ChromeFrameAutomationClient::ProcessUrlRequestMessage(TabProxy* tab,
     case AutomationMsg_RequestEnd::ID:
       if (ui_thread || (url_fetcher_flags_ &
                             PluginUrlRequestManager::STOP_REQUEST_THREADSAFE)) {
-        AutomationMsg_RequestEnd::Dispatch(&msg, url_fetcher_, this,
-            &PluginUrlRequestManager::EndUrlRequest);
+        AutomationMsg_RequestEnd::Dispatch(&msg, this, this,
+            &ChromeFrameAutomationClient::OnRequestEnd);
         return true;
       }
       break;
 
+    // These only touch |data_rings_| and post the reads they start to the UI
+    // thread, so they are handled on any thread.
+    case AutomationMsg_RequestDataRing::ID:
+      AutomationMsg_RequestDataRing::Dispatch(&msg, this, this,
+          &ChromeFrameAutomationClient::OnRequestDataRing);
+      return true;
+
+    case AutomationMsg_RequestDataConsumed::ID:
+      AutomationMsg_RequestDataConsumed::Dispatch(&msg, this, this,
+          &ChromeFrameAutomationClient::OnRequestDataConsumed);
+      return true;
+
     case AutomationMsg_DownloadRequestInHost::ID:
       if (ui_thread || (url_fetcher_flags_ &
                         PluginUrlRequestManager::DOWNLOAD_REQUEST_THREADSAFE)) {
@@ -1035,6 +1061,94 @@ bool ChromeFrameAutomationClient::ProcessUrlRequestMessage(TabProxy* tab,
   return true;
 }
 
+void ChromeFrameAutomationClient::OnRequestRead(int request_id,
+                                                int bytes_to_read) {
+  bool has_data_ring = false;
+  {
+    base::AutoLock lock(data_rings_lock_);
+    has_data_ring = data_rings_.find(request_id) != data_rings_.end();
+  }
+  // The ring is kept as full as Chrome allows, so all Chrome asks for then is
+  // that data is read if it is not already.
+  if (has_data_ring)
+    ReadIntoDataRing(request_id);
+  else
+    url_fetcher_->ReadUrlRequest(request_id, bytes_to_read);
+}
+
+void ChromeFrameAutomationClient::OnRequestEnd(
+    int request_id, const net::URLRequestStatus& status) {
+  {
+    base::AutoLock lock(data_rings_lock_);
+    data_rings_.erase(request_id);
+  }
+  url_fetcher_->EndUrlRequest(request_id, status);
+}
+
+void ChromeFrameAutomationClient::OnRequestDataRing(
+    int request_id, base::SharedMemoryHandle ring, uint32 ring_size) {
+  linked_ptr<DataRing> data_ring(new DataRing);
+  if (!data_ring->ring.Map(ring, ring_size)) {
+    // Chrome still accepts the data in AutomationMsg_RequestData messages.
+    DLOG(ERROR) << __FUNCTION__ << " failed to map ring of request "
+                << request_id;
+    return;
+  }
+  {
+    base::AutoLock lock(data_rings_lock_);
+    data_rings_[request_id] = data_ring;
+  }
+  PostReadIntoDataRing(request_id);
+}
+
+void ChromeFrameAutomationClient::OnRequestDataConsumed(int request_id,
+                                                        uint32 bytes_consumed) {
+  {
+    base::AutoLock lock(data_rings_lock_);
+    DataRingMap::iterator it = data_rings_.find(request_id);
+    if (it == data_rings_.end())
+      return;
+    DataRing* data_ring = it->second.get();
+    DCHECK_LE(bytes_consumed, data_ring->bytes_unconsumed);
+    data_ring->bytes_unconsumed -= std::min(
+        static_cast<size_t>(bytes_consumed), data_ring->bytes_unconsumed);
+    if (data_ring->read_pending)
+      return;
+  }
+  PostReadIntoDataRing(request_id);
+}
+
+void ChromeFrameAutomationClient::ReadIntoDataRing(int request_id) {
+  if (!url_fetcher_)
+    return;
+
+  size_t bytes_to_read = 0;
+  {
+    base::AutoLock lock(data_rings_lock_);
+    DataRingMap::iterator it = data_rings_.find(request_id);
+    if (it == data_rings_.end())
+      return;
+    DataRing* data_ring = it->second.get();
+    if (data_ring->read_pending)
+      return;
+    // If the ring is full, the next AutomationMsg_RequestDataConsumed
+    // reads more.
+    bytes_to_read = data_ring->ring.size() - data_ring->bytes_unconsumed;
+    if (!bytes_to_read)
+      return;
+    data_ring->read_pending = true;
+  }
+  url_fetcher_->ReadUrlRequest(request_id, bytes_to_read);
+}
+
+void ChromeFrameAutomationClient::PostReadIntoDataRing(int request_id) {
+  // Reads of a request are issued on the UI thread, and not from within
+  // OnReadComplete.
+  PostTask(FROM_HERE,
+           base::Bind(&ChromeFrameAutomationClient::ReadIntoDataRing,
+                      base::Unretained(this), request_id));
+}
+
 void ChromeFrameAutomationClient::InitializeFieldTrials() {
   static base::FieldTrial* trial = NULL;
   if (!trial) {
@@ -1323,6 +1437,31 @@ void ChromeFrameAutomationClient::OnResponseStarted(int request_id,
 
 void ChromeFrameAutomationClient::OnReadComplete(int request_id,
                                                  const std::string& data) {
+  bool written_to_ring = false;
+  {
+    base::AutoLock lock(data_rings_lock_);
+    DataRingMap::iterator it = data_rings_.find(request_id);
+    if (it != data_rings_.end()) {
+      DataRing* data_ring = it->second.get();
+      data_ring->read_pending = false;
+      // Reads never ask for more than the room left in the ring.
+      size_t room = data_ring->ring.size() - data_ring->bytes_unconsumed;
+      DCHECK_LE(data.size(), room);
+      if (data.size() <= room) {
+        data_ring->ring.Write(data.data(), data.size());
+        data_ring->bytes_unconsumed += data.size();
+        written_to_ring = true;
+      }
+    }
+  }
+
+  if (written_to_ring) {
+    automation_server_->Send(new AutomationMsg_RequestDataWritten(
+        tab_->handle(), request_id, static_cast<uint32>(data.size())));
+    PostReadIntoDataRing(request_id);
+    return;
+  }
+
   automation_server_->Send(new AutomationMsg_RequestData(
       tab_->handle(), request_id, data));
 }
@@ -1330,6 +1469,10 @@ void ChromeFrameAutomationClient::OnReadComplete(int request_id,
 void ChromeFrameAutomationClient::OnResponseEnd(
     int request_id,
     const net::URLRequestStatus& status) {
+  {
+    base::AutoLock lock(data_rings_lock_);
+    data_rings_.erase(request_id);
+  }
   automation_server_->Send(new AutomationMsg_RequestEnd(
       tab_->handle(), request_id, status));
 }
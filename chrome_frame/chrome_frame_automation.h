@@ -11,8 +11,10 @@
 #include <string>
 #include <vector>
 
+#include "base/memory/linked_ptr.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_handle.h"
+#include "base/shared_memory.h"
 #include "base/stack_container.h"
 #include "base/synchronization/lock.h"
 #include "base/threading/thread.h"
@@ -455,6 +457,19 @@ class ChromeFrameAutomationClient
   bool ProcessUrlRequestMessage(TabProxy* tab, const IPC::Message& msg,
                                 bool ui_thread);
 
+  // Network requests Chrome sends to the host network stack. They keep the
+  // shared memory ring of a request, if Chrome handed one out, up to date.
+  void OnRequestRead(int request_id, int bytes_to_read);
+  void OnRequestEnd(int request_id, const net::URLRequestStatus& status);
+  void OnRequestDataRing(int request_id, base::SharedMemoryHandle ring,
+                         uint32 ring_size);
+  void OnRequestDataConsumed(int request_id, uint32 bytes_consumed);
+
+  // Reads as much of the response of |request_id| as fits in its ring, unless
+  // a read is already under way.
+  void ReadIntoDataRing(int request_id);
+  void PostReadIntoDataRing(int request_id);
+
   // PluginUrlRequestDelegate implementation. Simply adds tab's handle
   // as parameter and forwards to Chrome via IPC.
   virtual void OnResponseStarted(int request_id, const char* mime_type,
@@ -519,6 +534,13 @@ class ChromeFrameAutomationClient
   PluginUrlRequestManager* url_fetcher_;
   PluginUrlRequestManager::ThreadSafeFlags url_fetcher_flags_;
 
+  // The shared memory rings the response bodies of requests are written to,
+  // by request id. Chrome creates one for each large response.
+  struct DataRing;
+  typedef std::map<int, linked_ptr<DataRing> > DataRingMap;
+  DataRingMap data_rings_;
+  base::Lock data_rings_lock_;
+
   // set to true if the host needs to get notified of all top level navigations
   // in this page. This typically applies to hosts which would render the new
   // page without chrome frame. Defaults to false.
@@ -26,6 +26,8 @@ bool ChromeFrameDelegateImpl::IsTabMessage(const IPC::Message& message) {
         AutomationMsg_ForwardContextMenuToExternalHost, NO_CODE)
     IPC_MESSAGE_HANDLER_GENERIC(AutomationMsg_RequestStart, NO_CODE)
     IPC_MESSAGE_HANDLER_GENERIC(AutomationMsg_RequestRead, NO_CODE)
+    IPC_MESSAGE_HANDLER_GENERIC(AutomationMsg_RequestDataRing, NO_CODE)
+    IPC_MESSAGE_HANDLER_GENERIC(AutomationMsg_RequestDataConsumed, NO_CODE)
     IPC_MESSAGE_HANDLER_GENERIC(AutomationMsg_RequestEnd, NO_CODE)
     IPC_MESSAGE_HANDLER_GENERIC(AutomationMsg_DownloadRequestInHost, NO_CODE)
     IPC_MESSAGE_HANDLER_GENERIC(AutomationMsg_SetCookieAsync, NO_CODE)
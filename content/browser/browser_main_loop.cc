@@ -311,6 +311,13 @@ void BrowserMainLoop::MainMessageLoopStart() {
 
   InitializeMainThread();
 
+#if defined(USE_NSS)
+  // Opening the NSS databases and loading the root certificates takes long
+  // enough on a cold start to hold up the first HTTPS request, so do it on a
+  // worker thread while the rest of the browser starts.
+  crypto::PreinitializeNSSInBackground();
+#endif
+
   // Start tracing to a file if needed.
   if (base::debug::TraceLog::GetInstance()->IsEnabled()) {
     TraceControllerImpl::GetInstance()->InitStartupTracing(
@@ -234,6 +234,8 @@ void DevToolsHttpHandlerImpl::OnHttpRequest(
         server_->Send200(connection_id,
                          data.as_string(),
                          GetMimeType(filename));
+      } else {
+        server_->Send404(connection_id);
       }
       return;
     }
@@ -480,12 +482,7 @@ void DevToolsHttpHandlerImpl::OnResponseStarted(net::URLRequest* request) {
   request->GetMimeType(&content_type);
 
   if (request->status().is_success()) {
-    server_->Send(connection_id,
-                  base::StringPrintf("HTTP/1.1 200 OK\r\n"
-                                     "Content-Type:%s\r\n"
-                                     "Transfer-Encoding: chunked\r\n"
-                                     "\r\n",
-                                     content_type.c_str()));
+    server_->StartChunkedResponse(connection_id, content_type);
   } else {
     server_->Send404(connection_id);
   }
@@ -513,16 +510,13 @@ void DevToolsHttpHandlerImpl::OnReadCompleted(net::URLRequest* request,
   do {
     if (!request->status().is_success() || bytes_read <= 0)
       break;
-    std::string chunk_size = base::StringPrintf("%X\r\n", bytes_read);
-    server_->Send(connection_id, chunk_size);
-    server_->Send(connection_id, buffer->data(), bytes_read);
-    server_->Send(connection_id, "\r\n");
+    server_->SendChunk(connection_id, buffer->data(), bytes_read);
   } while (request->Read(buffer, kBufferSize, &bytes_read));
 
 
   // See comments re: HEAD requests in OnResponseStarted().
   if (!request->status().is_io_pending()) {
-    server_->Send(connection_id, "0\r\n\r\n");
+    server_->FinishChunkedResponse(connection_id);
     RequestCompleted(request);
   }
 }
@@ -4,11 +4,13 @@
 
 #include "content/browser/download/base_file.h"
 
+#include "base/bind.h"
 #include "base/file_util.h"
 #include "base/format_macros.h"
 #include "base/logging.h"
 #include "base/pickle.h"
 #include "base/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
 #include "base/threading/thread_restrictions.h"
 #include "base/utf_string_conversions.h"
 #include "content/browser/download/download_net_log_parameters.h"
@@ -196,6 +198,15 @@ net::Error RenameFileAndResetSecurityDescriptor(
 
 #endif
 
+// Adds |data| to |secure_hash| on the blocking pool and signals |done|.
+void UpdateHash(crypto::SecureHash* secure_hash,
+                const char* data,
+                size_t data_len,
+                base::WaitableEvent* done) {
+  secure_hash->Update(data, data_len);
+  done->Signal();
+}
+
 }  // namespace
 
 // This will initialize the entire array to zero.
@@ -227,6 +238,7 @@ BaseFile::BaseFile(const FilePath& full_path,
 
   if (calculate_hash_) {
     secure_hash_.reset(crypto::SecureHash::Create(crypto::SecureHash::SHA256));
+    hash_sequence_token_ = BrowserThread::GetBlockingPool()->GetSequenceToken();
     if ((bytes_so_far_ > 0) &&  // Not starting at the beginning.
         (hash_state != "") &&  // Reasonably sure we have a hash state.
         (!IsEmptyHash(hash_state))) {
@@ -286,6 +298,40 @@ net::Error BaseFile::AppendDataToFile(const char* data, size_t data_len) {
   if (data_len == 0)
     return net::OK;
 
+  base::TimeTicks start_time = base::TimeTicks::Now();
+
+  // Hash large chunks on the blocking pool while they are written. The hash is
+  // still only used by one thread at a time, as this waits for it to finish.
+  base::WaitableEvent hash_done(false, false);
+  std::string hash_state;
+  bool hashing = false;
+  if (calculate_hash_ && data_len >= kMinOverlappedHashSize) {
+    hash_state = GetHashState();
+    hashing = BrowserThread::GetBlockingPool()->PostSequencedWorkerTask(
+        hash_sequence_token_, FROM_HERE,
+        base::Bind(&UpdateHash, secure_hash_.get(), data, data_len,
+                   &hash_done));
+  }
+
+  net::Error result = WriteData(data, data_len);
+
+  if (hashing) {
+    hash_done.Wait();
+    // Leave the hash as it was if the chunk couldn't be written.
+    if (result != net::OK)
+      SetHashState(hash_state);
+  } else if (calculate_hash_ && result == net::OK) {
+    secure_hash_->Update(data, data_len);
+  }
+
+  if (result == net::OK) {
+    download_stats::RecordDownloadWriteBandwidth(
+        data_len, base::TimeTicks::Now() - start_time);
+  }
+  return result;
+}
+
+net::Error BaseFile::WriteData(const char* data, size_t data_len) {
   // The Write call below is not guaranteed to write all the data.
   size_t write_count = 0;
   size_t len = data_len;
@@ -317,9 +363,6 @@ net::Error BaseFile::AppendDataToFile(const char* data, size_t data_len) {
   download_stats::RecordDownloadWriteSize(data_len);
   download_stats::RecordDownloadWriteLoopCount(write_count);
 
-  if (calculate_hash_)
-    secure_hash_->Update(data, data_len);
-
   return net::OK;
 }
 
@@ -12,6 +12,7 @@
 #include "base/gtest_prod_util.h"
 #include "base/memory/linked_ptr.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/threading/sequenced_worker_pool.h"
 #include "base/time.h"
 #include "content/common/content_export.h"
 #include "googleurl/src/gurl.h"
@@ -43,7 +44,9 @@ class CONTENT_EXPORT BaseFile {
   // Returns net::OK on success, or a network error code on failure.
   net::Error Initialize();
 
-  // Write a new chunk of data to the file.
+  // Write a new chunk of data to the file. Chunks of at least
+  // kMinOverlappedHashSize bytes are hashed on the blocking pool while they
+  // are written.
   // Returns net::OK on success (all bytes written to the file),
   // or a network error code on failure.
   net::Error AppendDataToFile(const char* data, size_t data_len);
@@ -85,6 +88,8 @@ class CONTENT_EXPORT BaseFile {
 
   virtual std::string DebugString() const;
 
+  static const size_t kMinOverlappedHashSize = 64 * 1024;
+
  protected:
   virtual void CreateFileStream();  // For testing.
   // Returns net::OK on success, or a network error code on failure.
@@ -104,6 +109,10 @@ class CONTENT_EXPORT BaseFile {
   // Resets the current state of the hash to the contents of |hash_state_bytes|.
   virtual bool SetHashState(const std::string& hash_state_bytes);
 
+  // Writes all of |data| to |file_stream_|, without hashing it.
+  // Returns net::OK on success, or a network error code on failure.
+  net::Error WriteData(const char* data, size_t data_len);
+
   net::Error ClearStream(net::Error error);
 
   static const size_t kSha256HashLen = 32;
@@ -131,6 +140,9 @@ class CONTENT_EXPORT BaseFile {
   // is set.
   scoped_ptr<crypto::SecureHash> secure_hash_;
 
+  // The blocking pool sequence large chunks are hashed on.
+  base::SequencedWorkerPool::SequenceToken hash_sequence_token_;
+
   unsigned char sha256_hash_[kSha256HashLen];
 
   // Indicates that this class no longer owns the associated file, and so
@@ -381,6 +381,29 @@ TEST_F(BaseFileTest, MultipleWritesWithHash) {
   EXPECT_EQ(expected_hash_hex, base::HexEncode(hash.data(), hash.size()));
 }
 
+// Chunks large enough to be hashed on the blocking pool while they are written
+// give the same hash as smaller ones.
+TEST_F(BaseFileTest, LargeWritesWithHash) {
+  std::string large_data(BaseFile::kMinOverlappedHashSize, 'x');
+  ResetHash();
+  UpdateHash(large_data.data(), large_data.size());
+  UpdateHash(kTestData1, kTestDataLength1);
+  UpdateHash(large_data.data(), large_data.size());
+  std::string expected_hash = GetFinalHash();
+
+  MakeFileWithHash();
+  ASSERT_EQ(net::OK, base_file_->Initialize());
+  ASSERT_EQ(net::OK, AppendDataToFile(large_data));
+  ASSERT_EQ(net::OK, AppendDataToFile(kTestData1));
+  ASSERT_EQ(net::OK, AppendDataToFile(large_data));
+  base_file_->Finish();
+
+  std::string hash;
+  EXPECT_TRUE(base_file_->GetHash(&hash));
+  EXPECT_EQ(base::HexEncode(expected_hash.data(), expected_hash.size()),
+            base::HexEncode(hash.data(), hash.size()));
+}
+
 // Write data to the file multiple times, interrupt it, and continue using
 // another file.  Calculate the resulting combined sha256 hash.
 TEST_F(BaseFileTest, MultipleWritesInterruptedWithHash) {
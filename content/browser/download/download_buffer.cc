@@ -52,14 +52,20 @@ DownloadBuffer::~DownloadBuffer() {
 
 size_t DownloadBuffer::AddData(net::IOBuffer* io_buffer, size_t byte_count) {
   base::AutoLock auto_lock(lock_);
+  if (contents_.empty())
+    first_data_time_ = base::TimeTicks::Now();
   contents_.push_back(std::make_pair(io_buffer, byte_count));
   return contents_.size();
 }
 
-ContentVector* DownloadBuffer::ReleaseContents() {
+ContentVector* DownloadBuffer::ReleaseContents(
+    base::TimeTicks* first_data_time) {
   base::AutoLock auto_lock(lock_);
   ContentVector* other_contents = new ContentVector;
   other_contents->swap(contents_);
+  if (first_data_time)
+    *first_data_time = first_data_time_;
+  first_data_time_ = base::TimeTicks();
   return other_contents;
 }
 
@@ -11,6 +11,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/synchronization/lock.h"
+#include "base/time.h"
 #include "content/common/content_export.h"
 
 namespace net {
@@ -48,8 +49,10 @@ class CONTENT_EXPORT DownloadBuffer :
   size_t AddData(net::IOBuffer* io_buffer, size_t byte_count);
 
   // Retrieves the ContentVector of buffers, clearing the contents.
-  // The caller takes ownership.
-  ContentVector* ReleaseContents();
+  // The caller takes ownership. If |first_data_time| is not NULL, it is set
+  // to when the first of the buffers was added, or to a null time if there
+  // were none.
+  ContentVector* ReleaseContents(base::TimeTicks* first_data_time);
 
   // Gets the number of |IOBuffers| we have.
   size_t size() const;
@@ -63,6 +66,9 @@ class CONTENT_EXPORT DownloadBuffer :
   mutable base::Lock lock_;
   ContentVector contents_;
 
+  // When the first buffer in |contents_| was added.
+  base::TimeTicks first_data_time_;
+
   DISALLOW_COPY_AND_ASSIGN(DownloadBuffer);
 };
 
@@ -68,7 +68,7 @@ TEST_F(DownloadBufferTest, CreateDownloadBuffer) {
     net::StringIOBuffer* io_buffer = new net::StringIOBuffer(kTestData[i]);
     EXPECT_EQ(i + 1, content_buffer->AddData(io_buffer, io_buffer->size()));
   }
-  scoped_ptr<ContentVector> contents(content_buffer->ReleaseContents());
+  scoped_ptr<ContentVector> contents(content_buffer->ReleaseContents(NULL));
 
   EXPECT_EQ(0u, content_buffer->size());
   EXPECT_EQ(kTestDataQty, contents->size());
@@ -80,6 +80,27 @@ TEST_F(DownloadBufferTest, CreateDownloadBuffer) {
   }
 }
 
+TEST_F(DownloadBufferTest, ReleaseContentsFirstDataTime) {
+  scoped_refptr<DownloadBuffer> content_buffer(new DownloadBuffer);
+  base::TimeTicks before = base::TimeTicks::Now();
+  for (size_t i = 0; i < kTestDataQty; ++i) {
+    net::StringIOBuffer* io_buffer = new net::StringIOBuffer(kTestData[i]);
+    content_buffer->AddData(io_buffer, io_buffer->size());
+  }
+
+  base::TimeTicks first_data_time;
+  scoped_ptr<ContentVector> contents(
+      content_buffer->ReleaseContents(&first_data_time));
+  EXPECT_FALSE(first_data_time.is_null());
+  EXPECT_LE(before, first_data_time);
+  EXPECT_GE(base::TimeTicks::Now(), first_data_time);
+
+  // The time is reset along with the contents.
+  contents.reset(content_buffer->ReleaseContents(&first_data_time));
+  EXPECT_TRUE(contents->empty());
+  EXPECT_TRUE(first_data_time.is_null());
+}
+
 TEST_F(DownloadBufferTest, AssembleData) {
   CreateBuffer();
 
@@ -182,49 +182,61 @@ void DownloadFileManager::StartDownload(
 void DownloadFileManager::UpdateDownload(
     DownloadId global_id, content::DownloadBuffer* buffer) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
-  scoped_ptr<content::ContentVector> contents(buffer->ReleaseContents());
+  base::TimeTicks first_data_time;
+  scoped_ptr<content::ContentVector> contents(
+      buffer->ReleaseContents(&first_data_time));
 
   download_stats::RecordFileThreadReceiveBuffers(contents->size());
+  if (!first_data_time.is_null()) {
+    download_stats::RecordFileThreadQueueTime(
+        base::TimeTicks::Now() - first_data_time);
+  }
 
   DownloadFile* download_file = GetDownloadFile(global_id);
-  bool had_error = false;
-  for (size_t i = 0; i < contents->size(); ++i) {
-    net::IOBuffer* data = (*contents)[i].first;
-    const int data_len = (*contents)[i].second;
-    if (!had_error && download_file) {
-      net::Error write_result =
-          download_file->AppendDataToFile(data->data(), data_len);
-      if (write_result != net::OK) {
-        // Write failed: interrupt the download.
-        DownloadManager* download_manager =
-            download_file->GetDownloadManager();
-        had_error = true;
-
-        int64 bytes_downloaded = download_file->BytesSoFar();
-        std::string hash_state(download_file->GetHashState());
-
-        // Calling this here in case we get more data, to avoid
-        // processing data after an error.  That could lead to
-        // files that are corrupted if the later processing succeeded.
-        CancelDownload(global_id);
-        download_file = NULL;  // Was deleted in |CancelDownload|.
-
-        if (download_manager) {
-          BrowserThread::PostTask(
-              BrowserThread::UI, FROM_HERE,
-              base::Bind(&DownloadManager::OnDownloadInterrupted,
-                         download_manager,
-                         global_id.local(),
-                         bytes_downloaded,
-                         hash_state,
-                         content::ConvertNetErrorToInterruptReason(
-                             write_result,
-                             content::DOWNLOAD_INTERRUPT_FROM_DISK)));
-        }
+  if (download_file && !contents->empty()) {
+    // Write all the buffers with one call, so that they take fewer writes and
+    // are large enough to be hashed while they are written.
+    scoped_refptr<net::IOBuffer> data;
+    size_t data_len = 0;
+    if (contents->size() == 1) {
+      data = contents->front().first;
+      data_len = contents->front().second;
+    } else {
+      data = content::AssembleData(*contents, &data_len);
+    }
+    net::Error write_result = data ?
+        download_file->AppendDataToFile(data->data(), data_len) : net::OK;
+    if (write_result != net::OK) {
+      // Write failed: interrupt the download.
+      DownloadManager* download_manager = download_file->GetDownloadManager();
+
+      int64 bytes_downloaded = download_file->BytesSoFar();
+      std::string hash_state(download_file->GetHashState());
+
+      // Calling this here in case we get more data, to avoid
+      // processing data after an error.  That could lead to
+      // files that are corrupted if the later processing succeeded.
+      CancelDownload(global_id);
+      download_file = NULL;  // Was deleted in |CancelDownload|.
+
+      if (download_manager) {
+        BrowserThread::PostTask(
+            BrowserThread::UI, FROM_HERE,
+            base::Bind(&DownloadManager::OnDownloadInterrupted,
+                       download_manager,
+                       global_id.local(),
+                       bytes_downloaded,
+                       hash_state,
+                       content::ConvertNetErrorToInterruptReason(
+                           write_result,
+                           content::DOWNLOAD_INTERRUPT_FROM_DISK)));
       }
     }
-    data->Release();
   }
+
+  // Drop the references the IO thread passed along with the buffers.
+  for (size_t i = 0; i < contents->size(); ++i)
+    (*contents)[i].first->Release();
 }
 
 void DownloadFileManager::OnResponseCompleted(
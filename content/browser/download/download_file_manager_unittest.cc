@@ -35,6 +35,11 @@ using ::testing::StrEq;
 
 namespace {
 
+// Matches data which starts with the bytes of |expected|.
+MATCHER_P(DataStartsWith, expected, "") {
+  return memcmp(arg, expected.data(), expected.size()) == 0;
+}
+
 class MockDownloadFileFactory :
     public DownloadFileManager::DownloadFileFactory {
 
@@ -494,6 +499,31 @@ TEST_F(DownloadFileManagerTest, CancelBeforeFinished) {
   CleanUp(dummy_id);
 }
 
+// Buffers which pile up before the FILE thread gets to them are written with
+// a single call.
+TEST_F(DownloadFileManagerTest, CoalesceBuffers) {
+  DownloadCreateInfo* info = new DownloadCreateInfo;
+  DownloadId dummy_id(download_manager_.get(), kDummyDownloadId);
+
+  StartDownload(info, dummy_id);
+
+  EXPECT_TRUE(UpdateBuffer(kTestData1, strlen(kTestData1)));
+  EXPECT_TRUE(UpdateBuffer(kTestData2, strlen(kTestData2)));
+  std::string expected_data(std::string(kTestData1) + kTestData2);
+  byte_count_[dummy_id] += expected_data.size();
+  MockDownloadFile* file = download_file_factory_->GetExistingFile(dummy_id);
+  ASSERT_TRUE(file != NULL);
+  EXPECT_CALL(*file, AppendDataToFile(DataStartsWith(expected_data),
+                                      expected_data.size()))
+      .Times(1)
+      .WillOnce(Return(net::OK));
+
+  download_file_manager_->UpdateDownload(dummy_id, download_buffer_.get());
+  ClearExpectations(dummy_id);
+
+  CleanUp(dummy_id);
+}
+
 TEST_F(DownloadFileManagerTest, DownloadWithError) {
   // Same as StartDownload, at first.
   DownloadCreateInfo* info = new DownloadCreateInfo;
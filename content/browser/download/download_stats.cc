@@ -259,6 +259,21 @@ void RecordFileThreadReceiveBuffers(size_t num_buffers) {
       DownloadResourceHandler::kLoadsToWrite);
 }
 
+void RecordFileThreadQueueTime(const base::TimeDelta& queue_time) {
+  UMA_HISTOGRAM_TIMES("Download.FileThreadQueueTime", queue_time);
+}
+
+void RecordDownloadWriteBandwidth(size_t data_len,
+                                  const base::TimeDelta& elapsed) {
+  // Writes that take less time than the clock can measure would have an
+  // infinite rate.
+  double seconds = elapsed.InSecondsF();
+  if (seconds <= 0)
+    return;
+  UMA_HISTOGRAM_CUSTOM_COUNTS(
+      "Download.WriteBandwidth", data_len / seconds, 1, 1000000000, 50);
+}
+
 void RecordBandwidth(double actual_bandwidth, double potential_bandwidth) {
   UMA_HISTOGRAM_CUSTOM_COUNTS(
       "Download.ActualBandwidth", actual_bandwidth, 1, 1000000000, 50);
@@ -16,6 +16,7 @@
 
 namespace base {
 class Time;
+class TimeDelta;
 class TimeTicks;
 }
 
@@ -116,6 +117,14 @@ void RecordDownloadWriteLoopCount(int count);
 // before the file thread gets to draining them.
 void RecordFileThreadReceiveBuffers(size_t num_buffers);
 
+// Record how long the first of those buffers waited for the file thread.
+void RecordFileThreadQueueTime(const base::TimeDelta& queue_time);
+
+// Record the rate at which |data_len| bytes were written and hashed in
+// |elapsed| time, in bytes/second.
+void RecordDownloadWriteBandwidth(size_t data_len,
+                                  const base::TimeDelta& elapsed);
+
 // Record the bandwidth seen in DownloadResourceHandler
 // |actual_bandwidth| and |potential_bandwidth| are in bytes/second.
 void RecordBandwidth(double actual_bandwidth, double potential_bandwidth);
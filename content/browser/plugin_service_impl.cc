@@ -48,6 +48,10 @@ using content::PluginServiceFilter;
 
 namespace {
 
+// How long after startup the spare PPAPI plugin processes are launched, so
+// that they don't compete with the first pages for the CPU.
+const int kSparePpapiProcessDelaySeconds = 10;
+
 // A callback for GetPlugins() that then gets the freshly loaded plugin groups
 // and runs the callback for GetPluginGroups().
 static void GetPluginsForGroupsCallback(
@@ -152,6 +156,11 @@ void PluginServiceImpl::Init() {
 
   RegisterPepperPlugins();
 
+  BrowserThread::PostDelayedTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&PpapiPluginProcessHost::FillSpareProcessPool),
+      base::TimeDelta::FromSeconds(kSparePpapiProcessDelaySeconds));
+
   content::GetContentClient()->AddNPAPIPlugins(plugin_list_);
 
   // Load any specified on the command line as well.
@@ -4,18 +4,23 @@
 
 #include "content/browser/ppapi_plugin_process_host.h"
 
+#include <list>
 #include <string>
 
 #include "base/base_switches.h"
 #include "base/command_line.h"
 #include "base/file_path.h"
+#include "base/lazy_instance.h"
+#include "base/metrics/histogram.h"
 #include "base/process_util.h"
+#include "base/string_number_conversions.h"
 #include "base/utf_string_conversions.h"
 #include "content/browser/browser_child_process_host_impl.h"
 #include "content/browser/plugin_service_impl.h"
 #include "content/browser/renderer_host/render_message_filter.h"
 #include "content/common/child_process_host_impl.h"
 #include "content/common/child_process_messages.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/common/content_switches.h"
 #include "content/public/common/pepper_plugin_info.h"
 #include "content/public/common/process_type.h"
@@ -24,9 +29,18 @@
 #include "ppapi/proxy/ppapi_messages.h"
 #include "webkit/plugins/plugin_switches.h"
 
+using content::BrowserThread;
 using content::ChildProcessHost;
 using content::ChildProcessHostImpl;
 
+namespace {
+
+// The spare plugin process hosts, oldest first. Only used on the IO thread.
+base::LazyInstance<std::list<PpapiPluginProcessHost*> > g_spare_hosts =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
 class PpapiPluginProcessHost::PluginNetworkObserver
     : public net::NetworkChangeNotifier::IPAddressObserver,
       public net::NetworkChangeNotifier::OnlineStateObserver {
@@ -66,13 +80,26 @@ PpapiPluginProcessHost::~PpapiPluginProcessHost() {
   DVLOG(1) << "PpapiPluginProcessHost" << (is_broker_ ? "[broker]" : "")
            << "~PpapiPluginProcessHost()";
   CancelRequests();
+  if (plugin_path_.empty() && !is_broker_)
+    g_spare_hosts.Get().remove(this);
 }
 
 PpapiPluginProcessHost* PpapiPluginProcessHost::CreatePluginHost(
     const content::PepperPluginInfo& info,
     net::HostResolver* host_resolver) {
+  // Spare processes are sandboxed, and never run a plugin launcher.
+  std::list<PpapiPluginProcessHost*>& spare_hosts = g_spare_hosts.Get();
+  if (info.is_sandboxed && !spare_hosts.empty()) {
+    PpapiPluginProcessHost* plugin_host = spare_hosts.front();
+    spare_hosts.pop_front();
+    plugin_host->AssignPlugin(info, host_resolver);
+    FillSpareProcessPool();
+    return plugin_host;
+  }
+
   PpapiPluginProcessHost* plugin_host =
       new PpapiPluginProcessHost(host_resolver);
+  plugin_host->start_time_ = base::TimeTicks::Now();
   if (plugin_host->Init(info))
     return plugin_host;
 
@@ -91,6 +118,26 @@ PpapiPluginProcessHost* PpapiPluginProcessHost::CreateBrokerHost(
   return NULL;
 }
 
+// static
+void PpapiPluginProcessHost::FillSpareProcessPool() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  if (command_line.HasSwitch(switches::kPpapiPluginLauncher))
+    return;
+  int pool_size = 0;
+  if (!base::StringToInt(command_line.GetSwitchValueASCII(
+          switches::kPpapiPluginProcessPoolSize), &pool_size))
+    return;
+
+  std::list<PpapiPluginProcessHost*>& spare_hosts = g_spare_hosts.Get();
+  while (static_cast<int>(spare_hosts.size()) < pool_size) {
+    PpapiPluginProcessHost* plugin_host = CreateSpareHost();
+    if (!plugin_host)
+      return;
+    spare_hosts.push_back(plugin_host);
+  }
+}
+
 bool PpapiPluginProcessHost::Send(IPC::Message* message) {
   return process_->Send(message);
 }
@@ -109,29 +156,71 @@ void PpapiPluginProcessHost::OpenChannelToPlugin(Client* client) {
 }
 
 PpapiPluginProcessHost::PpapiPluginProcessHost(net::HostResolver* host_resolver)
-    : filter_(new PepperMessageFilter(PepperMessageFilter::PLUGIN,
-                                      host_resolver)),
-      network_observer_(new PluginNetworkObserver(this)),
-      is_broker_(false) {
+    : network_observer_(new PluginNetworkObserver(this)),
+      is_broker_(false),
+      peer_pid_(0),
+      was_spare_(false) {
   process_.reset(new BrowserChildProcessHostImpl(
       content::PROCESS_TYPE_PPAPI_PLUGIN, this));
-  process_->GetHost()->AddFilter(filter_.get());
+  if (host_resolver) {
+    filter_ = new PepperMessageFilter(PepperMessageFilter::PLUGIN,
+                                      host_resolver);
+    process_->GetHost()->AddFilter(filter_.get());
+  }
 }
 
 PpapiPluginProcessHost::PpapiPluginProcessHost()
-    : is_broker_(true) {
+    : is_broker_(true),
+      peer_pid_(0),
+      was_spare_(false) {
   process_.reset(new BrowserChildProcessHostImpl(
       content::PROCESS_TYPE_PPAPI_BROKER, this));
 }
 
 bool PpapiPluginProcessHost::Init(const content::PepperPluginInfo& info) {
+  SetPluginInfo(info);
+  return Launch(info.is_sandboxed);
+}
+
+// static
+PpapiPluginProcessHost* PpapiPluginProcessHost::CreateSpareHost() {
+  PpapiPluginProcessHost* plugin_host = new PpapiPluginProcessHost(NULL);
+  plugin_host->was_spare_ = true;
+  plugin_host->process_->SetName(ASCIIToUTF16("Spare Pepper plugin"));
+  if (plugin_host->Launch(true))
+    return plugin_host;
+  delete plugin_host;
+  return NULL;
+}
+
+void PpapiPluginProcessHost::AssignPlugin(
+    const content::PepperPluginInfo& info,
+    net::HostResolver* host_resolver) {
+  DCHECK(plugin_path_.empty());
+  start_time_ = base::TimeTicks::Now();
+  SetPluginInfo(info);
+
+  filter_ = new PepperMessageFilter(PepperMessageFilter::PLUGIN,
+                                    host_resolver);
+  process_->GetHost()->AddFilter(filter_.get());
+  if (peer_pid_) {
+    // The filter missed the connection, and so did the plugin.
+    filter_->OnChannelConnected(peer_pid_);
+    Send(new PpapiMsg_LoadPlugin(plugin_path_));
+  }
+}
+
+void PpapiPluginProcessHost::SetPluginInfo(
+    const content::PepperPluginInfo& info) {
   plugin_path_ = info.path;
   if (info.name.empty()) {
     process_->SetName(plugin_path_.BaseName().LossyDisplayName());
   } else {
     process_->SetName(UTF8ToUTF16(info.name));
   }
+}
 
+bool PpapiPluginProcessHost::Launch(bool is_sandboxed) {
   std::string channel_id = process_->GetHost()->CreateChannel();
   if (channel_id.empty())
     return false;
@@ -184,8 +273,8 @@ bool PpapiPluginProcessHost::Init(const content::PepperPluginInfo& info) {
   // plugin launcher means we need to use another process instead of just
   // forking the zygote.
 #if defined(OS_POSIX)
-  bool use_zygote = !is_broker_ && plugin_launcher.empty() && info.is_sandboxed;
-  if (!info.is_sandboxed)
+  bool use_zygote = !is_broker_ && plugin_launcher.empty() && is_sandboxed;
+  if (!is_sandboxed)
     cmd_line->AppendSwitchASCII(switches::kNoSandbox, "");
 #endif  // OS_POSIX
   process_->Launch(
@@ -233,6 +322,13 @@ bool PpapiPluginProcessHost::OnMessageReceived(const IPC::Message& msg) {
 
 // Called when the browser <--> plugin channel has been established.
 void PpapiPluginProcessHost::OnChannelConnected(int32 peer_pid) {
+  peer_pid_ = peer_pid;
+
+  // A spare process has no plugin to load, nor any requests, until it is
+  // assigned one.
+  if (plugin_path_.empty())
+    return;
+
   // This will actually load the plugin. Errors will actually not be reported
   // back at this point. Instead, the plugin will fail to establish the
   // connections when we request them on behalf of the renderer(s).
@@ -283,6 +379,18 @@ void PpapiPluginProcessHost::OnRendererPluginChannelCreated(
   Client* client = sent_requests_.front();
   sent_requests_.pop();
 
+  if (!start_time_.is_null()) {
+    base::TimeDelta time_to_ready = base::TimeTicks::Now() - start_time_;
+    if (was_spare_) {
+      UMA_HISTOGRAM_TIMES("Plugin.PpapiTimeToFirstChannel.SpareProcess",
+                          time_to_ready);
+    } else {
+      UMA_HISTOGRAM_TIMES("Plugin.PpapiTimeToFirstChannel.NewProcess",
+                          time_to_ready);
+    }
+    start_time_ = base::TimeTicks();
+  }
+
   // Prepare the handle to send to the renderer.
   base::ProcessHandle plugin_process = process_->GetHandle();
 #if defined(OS_WIN)
@@ -12,6 +12,7 @@
 #include "base/file_path.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/ref_counted.h"
+#include "base/time.h"
 #include "content/browser/renderer_host/pepper_message_filter.h"
 #include "content/public/browser/browser_child_process_host_delegate.h"
 #include "content/public/browser/browser_child_process_host_iterator.h"
@@ -64,12 +65,20 @@ class PpapiPluginProcessHost : public content::BrowserChildProcessHostDelegate,
 
   virtual ~PpapiPluginProcessHost();
 
+  // Sandboxed plugins get one of the spare processes, if there are any.
   static PpapiPluginProcessHost* CreatePluginHost(
       const content::PepperPluginInfo& info,
       net::HostResolver* host_resolver);
   static PpapiPluginProcessHost* CreateBrokerHost(
       const content::PepperPluginInfo& info);
 
+  // Launches sandboxed plugin processes which don't load a plugin until
+  // CreatePluginHost() hands them out, so that there are as many idle ones as
+  // --ppapi-plugin-process-pool-size asks for. On Linux they are forked from
+  // the zygote like the other plugin processes. Must be called on the IO
+  // thread.
+  static void FillSpareProcessPool();
+
   // IPC::Message::Sender implementation:
   virtual bool Send(IPC::Message* message) OVERRIDE;
 
@@ -93,6 +102,19 @@ class PpapiPluginProcessHost : public content::BrowserChildProcessHostDelegate,
   // on success (the process was spawned).
   bool Init(const content::PepperPluginInfo& info);
 
+  // Creates and launches a plugin process with no plugin, or returns NULL.
+  static PpapiPluginProcessHost* CreateSpareHost();
+
+  // Gives a spare host the plugin |info| to load.
+  void AssignPlugin(const content::PepperPluginInfo& info,
+                    net::HostResolver* host_resolver);
+
+  void SetPluginInfo(const content::PepperPluginInfo& info);
+
+  // Launches the process, which loads the plugin once it is known and the
+  // channel is connected.
+  bool Launch(bool is_sandboxed);
+
   void RequestPluginChannel(Client* client);
 
   virtual void OnProcessLaunched() OVERRIDE;
@@ -106,7 +128,8 @@ class PpapiPluginProcessHost : public content::BrowserChildProcessHostDelegate,
   // IPC message handlers.
   void OnRendererPluginChannelCreated(const IPC::ChannelHandle& handle);
 
-  // Handles most requests from the plugin. May be NULL.
+  // Handles most requests from the plugin. May be NULL, and is NULL for a
+  // spare plugin host until it is assigned a plugin.
   scoped_refptr<PepperMessageFilter> filter_;
 
   // Observes network changes. May be NULL.
@@ -120,11 +143,21 @@ class PpapiPluginProcessHost : public content::BrowserChildProcessHostDelegate,
   // haven't heard back about yet.
   std::queue<Client*> sent_requests_;
 
-  // Path to the plugin library.
+  // Path to the plugin library. Empty for a spare plugin host.
   FilePath plugin_path_;
 
   const bool is_broker_;
 
+  // The ID of the plugin process once the channel is connected, or 0.
+  int32 peer_pid_;
+
+  // When the plugin was asked for, until its first channel to a renderer is
+  // created. Null for brokers.
+  base::TimeTicks start_time_;
+
+  // Whether the process was a spare one.
+  bool was_spare_;
+
   scoped_ptr<BrowserChildProcessHostImpl> process_;
 
   DISALLOW_COPY_AND_ASSIGN(PpapiPluginProcessHost);
@@ -104,6 +104,8 @@ bool DatabaseMessageFilter::OnMessageReceived(
                                     OnDatabaseGetFileAttributes)
     IPC_MESSAGE_HANDLER_DELAY_REPLY(DatabaseHostMsg_GetFileSize,
                                     OnDatabaseGetFileSize)
+    IPC_MESSAGE_HANDLER_DELAY_REPLY(DatabaseHostMsg_GetFileInfo,
+                                    OnDatabaseGetFileInfo)
     IPC_MESSAGE_HANDLER_DELAY_REPLY(DatabaseHostMsg_GetSpaceAvailable,
                                     OnDatabaseGetSpaceAvailable)
     IPC_MESSAGE_HANDLER(DatabaseHostMsg_Opened, OnDatabaseOpened)
@@ -247,6 +249,22 @@ void DatabaseMessageFilter::OnDatabaseGetFileSize(
   Send(reply_msg);
 }
 
+void DatabaseMessageFilter::OnDatabaseGetFileInfo(
+    const string16& vfs_file_name, IPC::Message* reply_msg) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
+  int32 attributes = -1;
+  int64 size = 0;
+  FilePath db_file =
+      DatabaseUtil::GetFullFilePathForVfsFile(db_tracker_, vfs_file_name);
+  if (!db_file.empty()) {
+    attributes = VfsBackend::GetFileAttributes(db_file);
+    size = VfsBackend::GetFileSize(db_file);
+  }
+
+  DatabaseHostMsg_GetFileInfo::WriteReplyParams(reply_msg, attributes, size);
+  Send(reply_msg);
+}
+
 void DatabaseMessageFilter::OnDatabaseGetSpaceAvailable(
     const string16& origin_identifier, IPC::Message* reply_msg) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
@@ -50,6 +50,8 @@ class DatabaseMessageFilter
                                    IPC::Message* reply_msg);
   void OnDatabaseGetFileSize(const string16& vfs_file_name,
                              IPC::Message* reply_msg);
+  void OnDatabaseGetFileInfo(const string16& vfs_file_name,
+                             IPC::Message* reply_msg);
 
   // Quota message handler (io thread)
   void OnDatabaseGetSpaceAvailable(const string16& origin_identifier,
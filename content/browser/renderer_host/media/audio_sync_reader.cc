@@ -6,22 +6,35 @@
 
 #include <algorithm>
 
+#include "base/metrics/histogram.h"
 #include "base/process_util.h"
 #include "base/shared_memory.h"
 #include "base/threading/platform_thread.h"
+#include "media/audio/audio_buffer_ring.h"
 #include "media/audio/audio_buffers_state.h"
 #include "media/audio/audio_util.h"
 
 const int kMinIntervalBetweenReadCallsInMs = 10;
 
 AudioSyncReader::AudioSyncReader(base::SharedMemory* shared_memory)
-    : shared_memory_(shared_memory) {
+    : shared_memory_(shared_memory),
+      ring_(media::CreateAudioBufferRing(
+          shared_memory,
+          media::PacketSizeSizeInBytes(shared_memory->created_size()))) {
 }
 
 AudioSyncReader::~AudioSyncReader() {
+  if (UsesRing())
+    UMA_HISTOGRAM_COUNTS("Media.AudioRendererUnderruns", ring_->underruns());
+}
+
+bool AudioSyncReader::UsesRing() const {
+  return ring_.get() && ring_->depth() > 0;
 }
 
 bool AudioSyncReader::DataReady() {
+  if (UsesRing())
+    return ring_->CanRead();
   return !media::IsUnknownDataSize(
       shared_memory_,
       media::PacketSizeSizeInBytes(shared_memory_->created_size()));
@@ -29,7 +42,13 @@ bool AudioSyncReader::DataReady() {
 
 // media::AudioOutputController::SyncReader implementations.
 void AudioSyncReader::UpdatePendingBytes(uint32 bytes) {
-  if (bytes != static_cast<uint32>(media::AudioOutputController::kPauseMark)) {
+  if (UsesRing()) {
+    // The renderer fills the ring whenever it is woken up below, so buffers
+    // queued before a pause would be played late on resume.
+    if (bytes == static_cast<uint32>(media::AudioOutputController::kPauseMark))
+      ring_->DropQueuedBuffers();
+  } else if (bytes !=
+             static_cast<uint32>(media::AudioOutputController::kPauseMark)) {
     // Store unknown length of data into buffer, so we later
     // can find out if data became available.
     media::SetUnknownDataSize(
@@ -43,6 +62,11 @@ void AudioSyncReader::UpdatePendingBytes(uint32 bytes) {
 }
 
 uint32 AudioSyncReader::Read(void* data, uint32 size) {
+  // The renderer keeps buffers queued ahead, so there is no need to wait for
+  // it; an empty ring is played as silence.
+  if (UsesRing())
+    return ring_->Read(data, size);
+
   uint32 max_size = media::PacketSizeSizeInBytes(
       shared_memory_->created_size());
 
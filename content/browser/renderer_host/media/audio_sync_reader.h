@@ -7,6 +7,7 @@
 #pragma once
 
 #include "base/file_descriptor_posix.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/process.h"
 #include "base/sync_socket.h"
 #include "base/synchronization/lock.h"
@@ -17,6 +18,10 @@ namespace base {
 class SharedMemory;
 }
 
+namespace media {
+class AudioBufferRing;
+}
+
 // A AudioOutputController::SyncReader implementation using SyncSocket. This
 // is used by AudioOutputController to provide a low latency data source for
 // transmitting audio packets between the browser process and the renderer
@@ -42,9 +47,17 @@ class AudioSyncReader : public media::AudioOutputController::SyncReader {
 #endif
 
  private:
+  // Returns true if the renderer queues its buffers in |ring_| rather than
+  // writing a single packet at the start of |shared_memory_|.
+  bool UsesRing() const;
+
   base::SharedMemory* shared_memory_;
   base::Time previous_call_time_;
 
+  // The ring of buffers behind the packet in |shared_memory_|, NULL if the
+  // packet size does not allow for one.
+  scoped_ptr<media::AudioBufferRing> ring_;
+
   // Socket for transmitting audio data.
   scoped_ptr<base::CancelableSyncSocket> socket_;
 
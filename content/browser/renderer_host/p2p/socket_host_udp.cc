@@ -15,6 +15,11 @@ namespace {
 // UDP packets cannot be bigger than 64k.
 const int kReadBufferSize = 65536;
 
+// The most packets read or sent with one system call. Every read buffer can
+// hold the largest packet, but the kernel only touches the pages that a
+// packet fills, so the untouched parts of the buffers cost no memory.
+const int kPacketBatchSize = 16;
+
 }  // namespace
 
 namespace content {
@@ -70,7 +75,11 @@ bool P2PSocketHostUdp::Init(const net::IPEndPoint& local_address,
 
   message_sender_->Send(new P2PMsg_OnSocketCreated(routing_id_, id_, address));
 
-  recv_buffer_ = new net::IOBuffer(kReadBufferSize);
+  recv_packets_.resize(kPacketBatchSize);
+  for (size_t i = 0; i < recv_packets_.size(); ++i) {
+    recv_packets_[i].buf = new net::IOBuffer(kReadBufferSize);
+    recv_packets_[i].buf_len = kReadBufferSize;
+  }
   DoRead();
 
   return true;
@@ -89,9 +98,9 @@ void P2PSocketHostUdp::OnError() {
 void P2PSocketHostUdp::DoRead() {
   int result;
   do {
-    result = socket_->RecvFrom(recv_buffer_, kReadBufferSize, &recv_address_,
-                               base::Bind(&P2PSocketHostUdp::OnRecv,
-                                          base::Unretained(this)));
+    result = socket_->RecvMultipleFrom(
+        &recv_packets_,
+        base::Bind(&P2PSocketHostUdp::OnRecv, base::Unretained(this)));
     DidCompleteRead(result);
   } while (result > 0);
 }
@@ -107,29 +116,37 @@ void P2PSocketHostUdp::DidCompleteRead(int result) {
   DCHECK_EQ(state_, STATE_OPEN);
 
   if (result > 0) {
-    std::vector<char> data(recv_buffer_->data(), recv_buffer_->data() + result);
-
-    if (connected_peers_.find(recv_address_) == connected_peers_.end()) {
-      P2PSocketHost::StunMessageType type;
-      bool stun = GetStunPacketType(&*data.begin(), data.size(), &type);
-      if (stun && IsRequestOrResponse(type)) {
-        connected_peers_.insert(recv_address_);
-      } else if (!stun || type == STUN_DATA_INDICATION) {
-        LOG(ERROR) << "Received unexpected data packet from "
-                   << recv_address_.ToString()
-                   << " before STUN binding is finished.";
-        return;
-      }
+    for (int i = 0; i < result; ++i) {
+      if (recv_packets_[i].received_len > 0)
+        DidReceivePacket(recv_packets_[i]);
     }
-
-    message_sender_->Send(new P2PMsg_OnDataReceived(routing_id_, id_,
-                                                    recv_address_, data));
   } else if (result < 0 && result != net::ERR_IO_PENDING) {
     LOG(ERROR) << "Error when reading from UDP socket: " << result;
     OnError();
   }
 }
 
+void P2PSocketHostUdp::DidReceivePacket(const net::DatagramPacket& packet) {
+  std::vector<char> data(packet.buf->data(),
+                         packet.buf->data() + packet.received_len);
+
+  if (connected_peers_.find(packet.address) == connected_peers_.end()) {
+    P2PSocketHost::StunMessageType type;
+    bool stun = GetStunPacketType(&*data.begin(), data.size(), &type);
+    if (stun && IsRequestOrResponse(type)) {
+      connected_peers_.insert(packet.address);
+    } else if (!stun || type == STUN_DATA_INDICATION) {
+      LOG(ERROR) << "Received unexpected data packet from "
+                 << packet.address.ToString()
+                 << " before STUN binding is finished.";
+      return;
+    }
+  }
+
+  message_sender_->Send(new P2PMsg_OnDataReceived(routing_id_, id_,
+                                                  packet.address, data));
+}
+
 void P2PSocketHostUdp::Send(const net::IPEndPoint& to,
                             const std::vector<char>& data) {
   if (!socket_.get()) {
@@ -185,13 +202,55 @@ void P2PSocketHostUdp::OnSend(int result) {
     return;
   }
 
+  SendQueuedPackets();
+}
+
+void P2PSocketHostUdp::SendQueuedPackets() {
   while (!send_queue_.empty() && !send_pending_) {
-    DoSend(send_queue_.front());
+    send_batch_.clear();
+    for (std::deque<PendingPacket>::const_iterator it = send_queue_.begin();
+         it != send_queue_.end() &&
+             send_batch_.size() < static_cast<size_t>(kPacketBatchSize);
+         ++it) {
+      send_batch_.push_back(net::DatagramPacket(it->data, it->size, it->to));
+    }
+
+    int result = socket_->SendMultipleTo(
+        send_batch_,
+        base::Bind(&P2PSocketHostUdp::OnSendMultiple, base::Unretained(this)));
+    if (result == net::ERR_IO_PENDING) {
+      send_pending_ = true;
+    } else if (result < 0) {
+      LOG(ERROR) << "Error when sending data in UDP socket: " << result;
+      OnError();
+    } else {
+      DidSendQueuedPackets(result);
+    }
+  }
+}
+
+void P2PSocketHostUdp::DidSendQueuedPackets(int count) {
+  DCHECK_LE(count, static_cast<int>(send_queue_.size()));
+  for (int i = 0; i < count; ++i) {
     send_queue_bytes_ -= send_queue_.front().size;
     send_queue_.pop_front();
   }
 }
 
+void P2PSocketHostUdp::OnSendMultiple(int result) {
+  DCHECK(send_pending_);
+  DCHECK_NE(result, net::ERR_IO_PENDING);
+
+  send_pending_ = false;
+  if (result < 0) {
+    OnError();
+    return;
+  }
+
+  DidSendQueuedPackets(result);
+  SendQueuedPackets();
+}
+
 P2PSocketHost* P2PSocketHostUdp::AcceptIncomingTcpConnection(
     const net::IPEndPoint& remote_address, int id) {
   NOTREACHED();
@@ -52,19 +52,27 @@ class CONTENT_EXPORT P2PSocketHostUdp : public P2PSocketHost {
   void DoRead();
   void DoSend(const PendingPacket& packet);
   void DidCompleteRead(int result);
+  void DidReceivePacket(const net::DatagramPacket& packet);
 
-  // Callbacks for RecvFrom() and SendTo().
+  // Sends the queued packets in batches until the socket would block.
+  void SendQueuedPackets();
+  void DidSendQueuedPackets(int count);
+
+  // Callbacks for RecvMultipleFrom(), SendTo() and SendMultipleTo().
   void OnRecv(int result);
   void OnSend(int result);
+  void OnSendMultiple(int result);
 
   scoped_ptr<net::DatagramServerSocket> socket_;
-  scoped_refptr<net::IOBuffer> recv_buffer_;
-  net::IPEndPoint recv_address_;
+  std::vector<net::DatagramPacket> recv_packets_;
 
   std::deque<PendingPacket> send_queue_;
   int send_queue_bytes_;
   bool send_pending_;
 
+  // The batch of |send_queue_| being sent by SendMultipleTo().
+  std::vector<net::DatagramPacket> send_batch_;
+
   // Set of peer for which we have received STUN binding request or
   // response or relay allocation request or response.
   ConnectedPeerSet connected_peers_;
@@ -30,7 +30,8 @@ class FakeDatagramServerSocket : public net::DatagramServerSocket {
   // P2PSocketHostUdp destroyes a socket on errors so sent packets
   // need to be stored outside of this object.
   explicit FakeDatagramServerSocket(std::deque<UDPPacket>* sent_packets)
-      : sent_packets_(sent_packets) {
+      : sent_packets_(sent_packets),
+        recv_packets_(NULL) {
   }
 
   virtual void Close() OVERRIDE {
@@ -81,6 +82,36 @@ class FakeDatagramServerSocket : public net::DatagramServerSocket {
     return buf_len;
   }
 
+  virtual int RecvMultipleFrom(
+      std::vector<net::DatagramPacket>* packets,
+      const net::CompletionCallback& callback) OVERRIDE {
+    CHECK(recv_callback_.is_null());
+    if (incoming_packets_.size() > 0) {
+      size_t count = 0;
+      for (; count < packets->size() && incoming_packets_.size() > 0; ++count) {
+        CopyPacket(incoming_packets_.front(), &(*packets)[count]);
+        incoming_packets_.pop_front();
+      }
+      return count;
+    } else {
+      recv_callback_ = callback;
+      recv_packets_ = packets;
+      return net::ERR_IO_PENDING;
+    }
+  }
+
+  virtual int SendMultipleTo(
+      const std::vector<net::DatagramPacket>& packets,
+      const net::CompletionCallback& callback) OVERRIDE {
+    for (size_t i = 0; i < packets.size(); ++i) {
+      const net::DatagramPacket& packet = packets[i];
+      std::vector<char> data_vector(packet.buf->data(),
+                                    packet.buf->data() + packet.buf_len);
+      sent_packets_->push_back(UDPPacket(packet.address, data_vector));
+    }
+    return packets.size();
+  }
+
   virtual bool SetReceiveBufferSize(int32 size) OVERRIDE {
     return true;
   }
@@ -90,7 +121,13 @@ class FakeDatagramServerSocket : public net::DatagramServerSocket {
   }
 
   void ReceivePacket(const net::IPEndPoint& address, std::vector<char> data) {
-    if (!recv_callback_.is_null()) {
+    if (!recv_callback_.is_null() && recv_packets_) {
+      CopyPacket(UDPPacket(address, data), &recv_packets_->front());
+      net::CompletionCallback cb = recv_callback_;
+      recv_callback_.Reset();
+      recv_packets_ = NULL;
+      cb.Run(1);
+    } else if (!recv_callback_.is_null()) {
       int size = std::min(recv_size_, static_cast<int>(data.size()));
       memcpy(recv_buffer_->data(), &*data.begin(), size);
       *recv_address_ = address;
@@ -108,6 +145,13 @@ class FakeDatagramServerSocket : public net::DatagramServerSocket {
   }
 
  private:
+  static void CopyPacket(const UDPPacket& from, net::DatagramPacket* to) {
+    int size = std::min(static_cast<int>(from.second.size()), to->buf_len);
+    memcpy(to->buf->data(), &*from.second.begin(), size);
+    to->address = from.first;
+    to->received_len = size;
+  }
+
   net::IPEndPoint address_;
   std::deque<UDPPacket>* sent_packets_;
   std::deque<UDPPacket> incoming_packets_;
@@ -116,6 +160,7 @@ class FakeDatagramServerSocket : public net::DatagramServerSocket {
   scoped_refptr<net::IOBuffer> recv_buffer_;
   net::IPEndPoint* recv_address_;
   int recv_size_;
+  std::vector<net::DatagramPacket>* recv_packets_;
   net::CompletionCallback recv_callback_;
 };
 
@@ -424,6 +424,8 @@ bool RenderProcessHostImpl::Init() {
     AppendRendererCommandLine(cmd_line);
     cmd_line->AppendSwitchASCII(switches::kProcessChannelID, channel_id);
 
+    launch_time_ = base::TimeTicks::Now();
+
     // Spawn the child process asynchronously to avoid blocking the UI thread.
     // As long as there's no renderer prefix, we can use the zygote process
     // at this stage.
@@ -940,6 +942,12 @@ bool RenderProcessHostImpl::OnMessageReceived(const IPC::Message& msg) {
 }
 
 void RenderProcessHostImpl::OnChannelConnected(int32 peer_pid) {
+  if (!launch_time_.is_null()) {
+    UMA_HISTOGRAM_TIMES("MPArch.RPH_TimeToFirstIPC",
+                        base::TimeTicks::Now() - launch_time_);
+    launch_time_ = base::TimeTicks();
+  }
+
 #if defined(IPC_MESSAGE_LOG_ENABLED)
   Send(new ChildProcessMsg_SetIPCLoggingEnabled(
       IPC::Logging::GetInstance()->Enabled()));
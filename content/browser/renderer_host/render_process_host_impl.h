@@ -264,6 +264,9 @@ class CONTENT_EXPORT RenderProcessHostImpl
   // Records the last time we regarded the child process active.
   base::TimeTicks child_process_activity_time_;
 
+  // When the child process was last launched, until its channel connects.
+  base::TimeTicks launch_time_;
+
   DISALLOW_COPY_AND_ASSIGN(RenderProcessHostImpl);
 };
 
@@ -113,7 +113,9 @@ class SandboxIPCProcess  {
     // error for a maximum length message.
     char buf[FontConfigInterface::kMaxFontFamilyLength + 128];
 
-    const ssize_t len = UnixDomainSocket::RecvMsg(fd, buf, sizeof(buf), &fds);
+    base::ProcessId sender_pid;
+    const ssize_t len = UnixDomainSocket::RecvMsgWithPid(fd, buf, sizeof(buf),
+                                                         &fds, &sender_pid);
     if (len == -1) {
       // TODO: should send an error reply, or the sender might block forever.
       NOTREACHED()
@@ -140,6 +142,8 @@ class SandboxIPCProcess  {
       HandleLocaltime(fd, pickle, iter, fds);
     } else if (kind == LinuxSandbox::METHOD_GET_CHILD_WITH_INODE) {
       HandleGetChildWithInode(fd, pickle, iter, fds);
+    } else if (kind == LinuxSandbox::METHOD_GET_GLOBAL_PID) {
+      HandleGetGlobalPid(fds, sender_pid);
     } else if (kind == LinuxSandbox::METHOD_GET_STYLE_FOR_STRIKE) {
       HandleGetStyleForStrike(fd, pickle, iter, fds);
     } else if (kind == LinuxSandbox::METHOD_MAKE_SHARED_MEMORY_SEGMENT) {
@@ -368,6 +372,15 @@ class SandboxIPCProcess  {
     SendRendererReply(fds, reply, -1);
   }
 
+  void HandleGetGlobalPid(const std::vector<int>& fds,
+                          base::ProcessId sender_pid) {
+    // The other side of this call is in zygote_main_linux.cc. The kernel
+    // supplies |sender_pid|, so a process can only learn its own PID.
+    Pickle reply;
+    reply.WriteInt(sender_pid);
+    SendRendererReply(fds, reply, -1);
+  }
+
   void HandleMakeSharedMemorySegment(int fd, const Pickle& pickle,
                                      PickleIterator iter,
                                      std::vector<int>& fds) {
@@ -702,6 +715,10 @@ void RenderSandboxHostLinux::Init(const std::string& sandbox_path) {
 
   renderer_socket_ = fds[0];
   const int browser_socket = fds[1];
+  // Lets forked children learn their PID outside the SUID sandbox's PID
+  // namespace without a /proc scan; see METHOD_GET_GLOBAL_PID.
+  if (!UnixDomainSocket::EnableReceiveProcessId(browser_socket))
+    DPLOG(ERROR) << "setsockopt(SO_PASSCRED)";
 
   int pipefds[2];
   CHECK(0 == pipe(pipefds));
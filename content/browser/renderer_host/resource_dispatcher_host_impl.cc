@@ -41,6 +41,7 @@
 #include "content/browser/renderer_host/resource_message_filter.h"
 #include "content/public/browser/resource_request_details.h"
 #include "content/browser/renderer_host/resource_request_info_impl.h"
+#include "content/browser/renderer_host/resource_scheduler.h"
 #include "content/browser/renderer_host/sync_resource_handler.h"
 #include "content/browser/renderer_host/throttling_resource_handler.h"
 #include "content/browser/resource_context_impl.h"
@@ -343,6 +344,10 @@ ResourceDispatcherHostImpl::ResourceDispatcherHostImpl()
 
   update_load_states_timer_.reset(
       new base::RepeatingTimer<ResourceDispatcherHostImpl>());
+
+  scheduler_.reset(new ResourceScheduler(
+      base::Bind(&ResourceDispatcherHostImpl::OnScheduledRequestReady,
+                 base::Unretained(this))));
 }
 
 ResourceDispatcherHostImpl::~ResourceDispatcherHostImpl() {
@@ -367,6 +372,10 @@ void ResourceDispatcherHostImpl::SetDelegate(
   delegate_ = delegate;
 }
 
+void ResourceDispatcherHostImpl::SetResourceSchedulingEnabled(bool enabled) {
+  scheduler_->set_enabled(enabled);
+}
+
 void ResourceDispatcherHostImpl::SetAllowCrossOriginAuthPrompt(bool value) {
   allow_cross_origin_auth_prompt_ = value;
 }
@@ -749,6 +758,7 @@ void ResourceDispatcherHostImpl::BeginRequest(
   if (iter != transferred_navigations_.end()) {
     deferred_request = iter->second;
     pending_requests_.erase(old_request_id);
+    scheduler_->RemoveRequest(old_request_id);
     transferred_navigations_.erase(iter);
   }
 
@@ -1229,7 +1239,7 @@ void ResourceDispatcherHostImpl::StartDeferredRequest(int child_id,
   // TODO(eroman): are there other considerations for paused or blocked
   //               requests?
 
-  StartRequest(i->second);
+  ScheduleRequest(i->second);
 }
 
 bool ResourceDispatcherHostImpl::WillSendData(int child_id,
@@ -1371,6 +1381,15 @@ void ResourceDispatcherHostImpl::CancelRequestsForRoute(int child_id,
       CancelBlockedRequestsForRoute(child_id, *iter);
     }
   }
+
+  // Requests are only cancelled for a route when it goes away.
+  scheduler_->OnRouteDeleted(child_id, route_id);
+}
+
+void ResourceDispatcherHostImpl::OnRouteVisibilityChanged(int child_id,
+                                                          int route_id,
+                                                          bool visible) {
+  scheduler_->OnRouteVisibilityChanged(child_id, route_id, visible);
 }
 
 // Cancels the request and removes it from the list.
@@ -1402,6 +1421,7 @@ void ResourceDispatcherHostImpl::RemovePendingRequest(
     info->ssl_client_auth_handler()->OnRequestCancelled();
   transferred_navigations_.erase(
       GlobalRequestID(info->GetChildID(), info->GetRequestID()));
+  scheduler_->RemoveRequest(iter->first);
 
   delete iter->second;
   pending_requests_.erase(iter);
@@ -1763,7 +1783,53 @@ void ResourceDispatcherHostImpl::BeginRequestInternal(
   }
 
   if (!defer_start)
+    ScheduleRequest(request);
+}
+
+void ResourceDispatcherHostImpl::ScheduleRequest(net::URLRequest* request) {
+  ResourceRequestInfoImpl* info = ResourceRequestInfoImpl::ForRequest(request);
+
+  // Downloads belong to the browser rather than to a tab, so they don't wait.
+  // Neither do synchronous loads, which block the renderer's main thread and
+  // with it every tab in that renderer, nor media, whose requests stay in
+  // flight for as long as the media plays.
+  if (info->is_download() ||
+      (request->load_flags() & net::LOAD_IGNORE_LIMITS) ||
+      info->GetResourceType() == ResourceType::MEDIA) {
+    StartRequest(request);
+    return;
+  }
+
+  GlobalRequestID global_id(info->GetChildID(), info->GetRequestID());
+  if (scheduler_->ScheduleRequest(global_id, info->GetRouteID(),
+                                  request->url().host(),
+                                  request->priority())) {
     StartRequest(request);
+  }
+}
+
+void ResourceDispatcherHostImpl::OnScheduledRequestReady(
+    const GlobalRequestID& request_id) {
+  // The scheduler lets requests start while others are being removed, so
+  // start them from a fresh stack.
+  MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&ResourceDispatcherHostImpl::StartScheduledRequest,
+                 weak_factory_.GetWeakPtr(),
+                 request_id));
+}
+
+void ResourceDispatcherHostImpl::StartScheduledRequest(
+    const GlobalRequestID& request_id) {
+  PendingRequestList::iterator i = pending_requests_.find(request_id);
+  if (i == pending_requests_.end())  // The request may have been destroyed
+    return;
+
+  // A request cancelled while it waited is completed by CancelRequest().
+  if (!i->second->status().is_success())
+    return;
+
+  StartRequest(i->second);
 }
 
 void ResourceDispatcherHostImpl::StartRequest(net::URLRequest* request) {
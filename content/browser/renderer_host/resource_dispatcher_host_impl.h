@@ -55,6 +55,7 @@ namespace content {
 class ResourceContext;
 class ResourceDispatcherHostDelegate;
 class ResourceRequestInfoImpl;
+class ResourceScheduler;
 struct DownloadSaveInfo;
 struct GlobalRequestID;
 
@@ -83,6 +84,7 @@ class CONTENT_EXPORT ResourceDispatcherHostImpl
       const DownloadStartedCallback& started_callback) OVERRIDE;
   virtual void ClearLoginDelegateForRequest(net::URLRequest* request) OVERRIDE;
   virtual void MarkAsTransferredNavigation(net::URLRequest* request) OVERRIDE;
+  virtual void SetResourceSchedulingEnabled(bool enabled) OVERRIDE;
 
   // Puts the resource dispatcher host in an inactive state (unable to begin
   // new requests).  Cancels all pending requests.
@@ -183,6 +185,10 @@ class CONTENT_EXPORT ResourceDispatcherHostImpl
   // acts like CancelRequestsForProcess when route_id is -1.
   void CancelRequestsForRoute(int child_id, int route_id);
 
+  // Called when the tab of the given route is hidden or shown, so that the
+  // requests of hidden tabs can wait for those of the visible ones.
+  void OnRouteVisibilityChanged(int child_id, int route_id, bool visible);
+
   // net::URLRequest::Delegate:
   virtual void OnReceivedRedirect(net::URLRequest* request,
                                   const GURL& new_url,
@@ -286,6 +292,13 @@ class CONTENT_EXPORT ResourceDispatcherHostImpl
   // this method with the proper value for the timed_out parameter.
   void HandleSwapOutACK(const ViewMsg_SwapOut_Params& params, bool timed_out);
 
+  // Starts |request| once the scheduler lets it.
+  void ScheduleRequest(net::URLRequest* request);
+
+  // Starts a request that the scheduler had delayed, if it still exists.
+  void OnScheduledRequestReady(const GlobalRequestID& request_id);
+  void StartScheduledRequest(const GlobalRequestID& request_id);
+
   void StartRequest(net::URLRequest* request);
 
   // Returns true if the request is paused.
@@ -440,6 +453,10 @@ class CONTENT_EXPORT ResourceDispatcherHostImpl
 
   PendingRequestList pending_requests_;
 
+  // Delays the requests of child processes which are less important than
+  // others in flight.
+  scoped_ptr<ResourceScheduler> scheduler_;
+
   // Collection of temp files downloaded for child processes via
   // the download_to_file mechanism. We avoid deleting them until
   // the client no longer needs them.
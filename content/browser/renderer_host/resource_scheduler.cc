@@ -0,0 +1,193 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/renderer_host/resource_scheduler.h"
+
+#include <vector>
+
+#include "base/logging.h"
+#include "base/metrics/histogram.h"
+
+namespace content {
+
+namespace {
+
+// The most delayable requests a route may have in flight to a host, matching
+// the network stack's default limit of sockets per group.
+const int kMaxDelayableRequestsPerHost = 6;
+
+// The most delayable requests a route may have in flight to a host while any
+// critical request of the route is in flight.
+const int kMaxDelayableRequestsPerHostWhileCritical = 1;
+
+}  // namespace
+
+ResourceScheduler::Request::Request()
+    : route_id(-1),
+      priority(net::IDLE),
+      started(false),
+      critical(false),
+      delayable(false) {
+}
+
+ResourceScheduler::Request::~Request() {}
+
+ResourceScheduler::ResourceScheduler(const StartCallback& start_callback)
+    : start_callback_(start_callback),
+      enabled_(true) {
+}
+
+ResourceScheduler::~ResourceScheduler() {}
+
+bool ResourceScheduler::ScheduleRequest(const GlobalRequestID& id,
+                                        int route_id,
+                                        const std::string& host,
+                                        net::RequestPriority priority) {
+  if (!enabled_)
+    return true;
+
+  DCHECK(requests_.find(id) == requests_.end());
+  Request& request = requests_[id];
+  request.route_id = route_id;
+  request.host = host;
+  request.priority = priority;
+  request.queue_time = base::TimeTicks::Now();
+
+  // No queued request could start either, or it would have, so one which can
+  // start now doesn't overtake a queued request to the same host.
+  if (CanStart(id, request)) {
+    StartRequest(id, &request);
+    return true;
+  }
+
+  // Queue behind the requests of the same or higher priority.
+  PendingRequestList::iterator insert_before = pending_requests_.begin();
+  while (insert_before != pending_requests_.end() &&
+         requests_[*insert_before].priority >= priority) {
+    ++insert_before;
+  }
+  pending_requests_.insert(insert_before, id);
+  return false;
+}
+
+void ResourceScheduler::RemoveRequest(const GlobalRequestID& id) {
+  RequestMap::iterator it = requests_.find(id);
+  if (it == requests_.end())
+    return;
+
+  const Request& request = it->second;
+  if (request.started) {
+    ProcessRouteIDs route(id.child_id, request.route_id);
+    if (request.critical) {
+      std::map<ProcessRouteIDs, int>::iterator critical =
+          critical_requests_in_flight_.find(route);
+      DCHECK(critical != critical_requests_in_flight_.end());
+      if (--critical->second == 0)
+        critical_requests_in_flight_.erase(critical);
+    }
+    if (request.delayable) {
+      std::map<RouteHost, int>::iterator host =
+          delayable_requests_in_flight_.find(RouteHost(route, request.host));
+      DCHECK(host != delayable_requests_in_flight_.end());
+      if (--host->second == 0)
+        delayable_requests_in_flight_.erase(host);
+    }
+  } else {
+    pending_requests_.remove(id);
+  }
+  requests_.erase(it);
+
+  LoadPendingRequests();
+}
+
+void ResourceScheduler::OnRouteVisibilityChanged(int child_id,
+                                                 int route_id,
+                                                 bool visible) {
+  ProcessRouteIDs route(child_id, route_id);
+  if (!visible) {
+    hidden_routes_.insert(route);
+    return;
+  }
+  if (hidden_routes_.erase(route))
+    LoadPendingRequests();
+}
+
+void ResourceScheduler::OnRouteDeleted(int child_id, int route_id) {
+  if (route_id != -1) {
+    hidden_routes_.erase(ProcessRouteIDs(child_id, route_id));
+    return;
+  }
+  hidden_routes_.erase(hidden_routes_.lower_bound(ProcessRouteIDs(child_id, 0)),
+                       hidden_routes_.lower_bound(
+                           ProcessRouteIDs(child_id + 1, 0)));
+}
+
+bool ResourceScheduler::IsRouteVisible(int child_id, int route_id) const {
+  return hidden_routes_.find(ProcessRouteIDs(child_id, route_id)) ==
+      hidden_routes_.end();
+}
+
+bool ResourceScheduler::IsCritical(const GlobalRequestID& id,
+                                   const Request& request) const {
+  return request.priority >= net::MEDIUM &&
+      IsRouteVisible(id.child_id, request.route_id);
+}
+
+bool ResourceScheduler::IsDelayable(const GlobalRequestID& id,
+                                    const Request& request) const {
+  if (request.priority < net::LOW)
+    return true;
+  // Hidden tabs still navigate promptly, but wait for their subresources.
+  return request.priority < net::HIGHEST &&
+      !IsRouteVisible(id.child_id, request.route_id);
+}
+
+bool ResourceScheduler::CanStart(const GlobalRequestID& id,
+                                 const Request& request) const {
+  if (!IsDelayable(id, request))
+    return true;
+
+  ProcessRouteIDs route(id.child_id, request.route_id);
+  int limit = critical_requests_in_flight_.count(route) ?
+      kMaxDelayableRequestsPerHostWhileCritical : kMaxDelayableRequestsPerHost;
+  std::map<RouteHost, int>::const_iterator host =
+      delayable_requests_in_flight_.find(RouteHost(route, request.host));
+  return host == delayable_requests_in_flight_.end() || host->second < limit;
+}
+
+void ResourceScheduler::StartRequest(const GlobalRequestID& id,
+                                     Request* request) {
+  DCHECK(!request->started);
+  request->started = true;
+  request->critical = IsCritical(id, *request);
+  request->delayable = IsDelayable(id, *request);
+  ProcessRouteIDs route(id.child_id, request->route_id);
+  if (request->critical)
+    ++critical_requests_in_flight_[route];
+  if (request->delayable)
+    ++delayable_requests_in_flight_[RouteHost(route, request->host)];
+}
+
+void ResourceScheduler::LoadPendingRequests() {
+  std::vector<GlobalRequestID> started;
+  PendingRequestList::iterator it = pending_requests_.begin();
+  while (it != pending_requests_.end()) {
+    Request& request = requests_[*it];
+    if (!CanStart(*it, request)) {
+      ++it;
+      continue;
+    }
+    StartRequest(*it, &request);
+    UMA_HISTOGRAM_TIMES("Net.ResourceScheduler.QueueTime",
+                        base::TimeTicks::Now() - request.queue_time);
+    started.push_back(*it);
+    it = pending_requests_.erase(it);
+  }
+
+  // Run the callbacks last, in case they schedule or remove requests.
+  for (size_t i = 0; i < started.size(); ++i)
+    start_callback_.Run(started[i]);
+}
+
+}  // namespace content
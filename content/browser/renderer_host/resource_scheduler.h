@@ -0,0 +1,128 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_BROWSER_RENDERER_HOST_RESOURCE_SCHEDULER_H_
+#define CONTENT_BROWSER_RENDERER_HOST_RESOURCE_SCHEDULER_H_
+#pragma once
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/time.h"
+#include "content/common/content_export.h"
+#include "content/public/browser/global_request_id.h"
+#include "net/base/request_priority.h"
+
+namespace content {
+
+// Decides when the resource requests of child processes may start, so that
+// the requests which block rendering of the visible tabs are not slowed down
+// by less important ones.
+//
+// Requests for stylesheets, scripts and frames of visible tabs are critical
+// and always start right away. Images, prefetches and the subresources of
+// hidden tabs are delayable: only a few of them may be in flight per host for
+// each route, and only one while any critical request of that route is in
+// flight. All other requests start right away. Lives on the IO thread.
+class CONTENT_EXPORT ResourceScheduler {
+ public:
+  // Run with the ID of a delayed request once it may start.
+  typedef base::Callback<void(const GlobalRequestID&)> StartCallback;
+
+  explicit ResourceScheduler(const StartCallback& start_callback);
+  ~ResourceScheduler();
+
+  // When disabled, every request starts right away. Must be set before any
+  // request is scheduled.
+  void set_enabled(bool enabled) { enabled_ = enabled; }
+  bool enabled() const { return enabled_; }
+
+  // Called when the request |id| of |route_id| for a URL on |host| is ready
+  // to start. Returns true if it may start now. Otherwise the request is
+  // queued, and |start_callback| is run once it may start; this may happen
+  // from within any of the methods below.
+  bool ScheduleRequest(const GlobalRequestID& id,
+                       int route_id,
+                       const std::string& host,
+                       net::RequestPriority priority);
+
+  // Called when a scheduled request completes or is cancelled, whether or not
+  // it has started. Unknown IDs are ignored.
+  void RemoveRequest(const GlobalRequestID& id);
+
+  // Called when the tab of the given route is hidden or shown. Routes are
+  // visible until they are hidden.
+  void OnRouteVisibilityChanged(int child_id, int route_id, bool visible);
+
+  // Forgets the visibility of a deleted route, or of all the routes of
+  // |child_id| if |route_id| is -1.
+  void OnRouteDeleted(int child_id, int route_id);
+
+  // The number of requests that are waiting to start. For unit tests.
+  size_t pending_request_count() const { return pending_requests_.size(); }
+
+ private:
+  struct Request {
+    Request();
+    ~Request();
+
+    int route_id;
+    std::string host;
+    net::RequestPriority priority;
+    base::TimeTicks queue_time;
+
+    // Whether the request has started, and which limits it counted against
+    // when it did.
+    bool started;
+    bool critical;
+    bool delayable;
+  };
+  typedef std::map<GlobalRequestID, Request> RequestMap;
+  typedef std::list<GlobalRequestID> PendingRequestList;
+  typedef std::pair<int, int> ProcessRouteIDs;
+  typedef std::pair<ProcessRouteIDs, std::string> RouteHost;
+
+  bool IsRouteVisible(int child_id, int route_id) const;
+  bool IsCritical(const GlobalRequestID& id, const Request& request) const;
+  bool IsDelayable(const GlobalRequestID& id, const Request& request) const;
+
+  // Returns true if |request| may start now.
+  bool CanStart(const GlobalRequestID& id, const Request& request) const;
+
+  // Marks |request| as started and counts it against the limits.
+  void StartRequest(const GlobalRequestID& id, Request* request);
+
+  // Starts the queued requests which may now start, in priority order.
+  void LoadPendingRequests();
+
+  StartCallback start_callback_;
+  bool enabled_;
+
+  // All the scheduled requests, started or not.
+  RequestMap requests_;
+
+  // The requests which have not started, highest priority first.
+  PendingRequestList pending_requests_;
+
+  std::set<ProcessRouteIDs> hidden_routes_;
+
+  // Maps routes to the number of their critical requests in flight. Routes
+  // with none in flight have no entry.
+  std::map<ProcessRouteIDs, int> critical_requests_in_flight_;
+
+  // Maps routes and hosts to the number of delayable requests the route has
+  // in flight to the host. Pairs with none in flight have no entry.
+  std::map<RouteHost, int> delayable_requests_in_flight_;
+
+  DISALLOW_COPY_AND_ASSIGN(ResourceScheduler);
+};
+
+}  // namespace content
+
+#endif  // CONTENT_BROWSER_RENDERER_HOST_RESOURCE_SCHEDULER_H_
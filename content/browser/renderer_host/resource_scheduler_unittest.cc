@@ -0,0 +1,184 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/renderer_host/resource_scheduler.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace content {
+
+namespace {
+
+const int kChildId = 30;
+const int kRouteId = 75;
+const int kHiddenRouteId = 76;
+const int kOtherRouteId = 77;
+
+}  // namespace
+
+class ResourceSchedulerTest : public testing::Test {
+ protected:
+  ResourceSchedulerTest()
+      : scheduler_(base::Bind(&ResourceSchedulerTest::OnRequestStarted,
+                              base::Unretained(this))) {
+  }
+
+  bool Schedule(int request_id,
+                int route_id,
+                const std::string& host,
+                net::RequestPriority priority) {
+    return scheduler_.ScheduleRequest(GlobalRequestID(kChildId, request_id),
+                                      route_id, host, priority);
+  }
+
+  void Remove(int request_id) {
+    scheduler_.RemoveRequest(GlobalRequestID(kChildId, request_id));
+  }
+
+  void OnRequestStarted(const GlobalRequestID& id) {
+    EXPECT_EQ(kChildId, id.child_id);
+    started_.push_back(id.request_id);
+  }
+
+  std::vector<int> started_;
+  ResourceScheduler scheduler_;
+};
+
+TEST_F(ResourceSchedulerTest, NonDelayableRequestsStart) {
+  EXPECT_TRUE(Schedule(1, kRouteId, "a.com", net::HIGHEST));
+  EXPECT_TRUE(Schedule(2, kRouteId, "a.com", net::MEDIUM));
+  for (int i = 3; i < 20; ++i)
+    EXPECT_TRUE(Schedule(i, kRouteId, "a.com", net::LOW));
+  EXPECT_EQ(0u, scheduler_.pending_request_count());
+}
+
+TEST_F(ResourceSchedulerTest, DelayableRequestsLimitedPerHost) {
+  for (int i = 1; i <= 6; ++i)
+    EXPECT_TRUE(Schedule(i, kRouteId, "a.com", net::LOWEST));
+  EXPECT_FALSE(Schedule(7, kRouteId, "a.com", net::LOWEST));
+  EXPECT_TRUE(Schedule(8, kRouteId, "b.com", net::LOWEST));
+  EXPECT_EQ(1u, scheduler_.pending_request_count());
+
+  Remove(8);
+  EXPECT_TRUE(started_.empty());
+  Remove(3);
+  ASSERT_EQ(1u, started_.size());
+  EXPECT_EQ(7, started_[0]);
+  EXPECT_EQ(0u, scheduler_.pending_request_count());
+}
+
+TEST_F(ResourceSchedulerTest, DelayableRequestsWaitForCritical) {
+  EXPECT_TRUE(Schedule(1, kRouteId, "a.com", net::MEDIUM));
+  EXPECT_TRUE(Schedule(2, kRouteId, "b.com", net::LOWEST));
+  EXPECT_FALSE(Schedule(3, kRouteId, "b.com", net::LOWEST));
+  EXPECT_TRUE(Schedule(4, kRouteId, "c.com", net::IDLE));
+
+  Remove(1);
+  ASSERT_EQ(1u, started_.size());
+  EXPECT_EQ(3, started_[0]);
+}
+
+TEST_F(ResourceSchedulerTest, LimitsArePerRoute) {
+  // A critical request only slows down delayable requests of its own route.
+  EXPECT_TRUE(Schedule(1, kRouteId, "a.com", net::MEDIUM));
+  EXPECT_TRUE(Schedule(2, kRouteId, "b.com", net::LOWEST));
+  EXPECT_FALSE(Schedule(3, kRouteId, "b.com", net::LOWEST));
+  for (int i = 4; i <= 9; ++i)
+    EXPECT_TRUE(Schedule(i, kOtherRouteId, "b.com", net::LOWEST));
+  EXPECT_FALSE(Schedule(10, kOtherRouteId, "b.com", net::LOWEST));
+  EXPECT_EQ(2u, scheduler_.pending_request_count());
+
+  Remove(4);
+  ASSERT_EQ(1u, started_.size());
+  EXPECT_EQ(10, started_[0]);
+  Remove(1);
+  ASSERT_EQ(2u, started_.size());
+  EXPECT_EQ(3, started_[1]);
+}
+
+TEST_F(ResourceSchedulerTest, PendingRequestsStartInPriorityOrder) {
+  EXPECT_TRUE(Schedule(1, kRouteId, "a.com", net::MEDIUM));
+  EXPECT_TRUE(Schedule(2, kRouteId, "b.com", net::LOWEST));
+  EXPECT_FALSE(Schedule(3, kRouteId, "b.com", net::IDLE));
+  EXPECT_FALSE(Schedule(4, kRouteId, "b.com", net::LOWEST));
+  EXPECT_FALSE(Schedule(5, kRouteId, "b.com", net::LOWEST));
+
+  // Only one may be in flight to b.com while the critical request is.
+  Remove(2);
+  ASSERT_EQ(1u, started_.size());
+  EXPECT_EQ(4, started_[0]);
+  Remove(4);
+  ASSERT_EQ(2u, started_.size());
+  EXPECT_EQ(5, started_[1]);
+
+  Remove(1);
+  ASSERT_EQ(3u, started_.size());
+  EXPECT_EQ(3, started_[2]);
+}
+
+TEST_F(ResourceSchedulerTest, CancelPendingRequest) {
+  EXPECT_TRUE(Schedule(1, kRouteId, "a.com", net::MEDIUM));
+  EXPECT_TRUE(Schedule(2, kRouteId, "b.com", net::LOWEST));
+  EXPECT_FALSE(Schedule(3, kRouteId, "b.com", net::LOWEST));
+  EXPECT_FALSE(Schedule(4, kRouteId, "b.com", net::LOWEST));
+
+  Remove(3);
+  EXPECT_EQ(1u, scheduler_.pending_request_count());
+  Remove(2);
+  ASSERT_EQ(1u, started_.size());
+  EXPECT_EQ(4, started_[0]);
+
+  // Unknown requests are ignored.
+  Remove(3);
+  Remove(100);
+}
+
+TEST_F(ResourceSchedulerTest, HiddenRouteRequestsAreDelayable) {
+  scheduler_.OnRouteVisibilityChanged(kChildId, kHiddenRouteId, false);
+
+  // Hidden tabs still navigate, but their stylesheets are limited.
+  EXPECT_TRUE(Schedule(1, kHiddenRouteId, "b.com", net::HIGHEST));
+  for (int i = 2; i <= 7; ++i)
+    EXPECT_TRUE(Schedule(i, kHiddenRouteId, "b.com", net::MEDIUM));
+  EXPECT_FALSE(Schedule(8, kHiddenRouteId, "b.com", net::MEDIUM));
+  EXPECT_FALSE(Schedule(9, kHiddenRouteId, "b.com", net::LOW));
+
+  // Showing the tab lets its requests go.
+  scheduler_.OnRouteVisibilityChanged(kChildId, kHiddenRouteId, true);
+  ASSERT_EQ(2u, started_.size());
+  EXPECT_EQ(8, started_[0]);
+  EXPECT_EQ(9, started_[1]);
+}
+
+TEST_F(ResourceSchedulerTest, HiddenRouteRequestsAreNotCritical) {
+  scheduler_.OnRouteVisibilityChanged(kChildId, kHiddenRouteId, false);
+  EXPECT_TRUE(Schedule(1, kHiddenRouteId, "a.com", net::HIGHEST));
+  for (int i = 2; i <= 7; ++i)
+    EXPECT_TRUE(Schedule(i, kHiddenRouteId, "b.com", net::LOWEST));
+}
+
+TEST_F(ResourceSchedulerTest, DeletedRoutesBecomeVisible) {
+  scheduler_.OnRouteVisibilityChanged(kChildId, kRouteId, false);
+  scheduler_.OnRouteVisibilityChanged(kChildId, kHiddenRouteId, false);
+  scheduler_.OnRouteDeleted(kChildId, -1);
+
+  EXPECT_TRUE(Schedule(1, kRouteId, "a.com", net::MEDIUM));
+  EXPECT_TRUE(Schedule(2, kHiddenRouteId, "a.com", net::MEDIUM));
+  EXPECT_TRUE(Schedule(3, kHiddenRouteId, "a.com", net::LOW));
+}
+
+TEST_F(ResourceSchedulerTest, Disabled) {
+  scheduler_.set_enabled(false);
+  EXPECT_TRUE(Schedule(1, kRouteId, "a.com", net::MEDIUM));
+  for (int i = 2; i < 20; ++i)
+    EXPECT_TRUE(Schedule(i, kRouteId, "a.com", net::IDLE));
+  Remove(1);
+  EXPECT_TRUE(started_.empty());
+}
+
+}  // namespace content
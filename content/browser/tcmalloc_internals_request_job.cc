@@ -5,11 +5,13 @@
 #include "content/browser/tcmalloc_internals_request_job.h"
 
 #include "base/allocator/allocator_extension.h"
+#include "base/debug/sampling_heap_profiler.h"
 #include "content/common/child_process_messages.h"
 #include "content/public/browser/browser_child_process_host_iterator.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/render_process_host.h"
 #include "content/public/common/process_type.h"
+#include "net/base/escape.h"
 
 namespace content {
 
@@ -90,7 +92,15 @@ void AboutTcmalloc(std::string* data) {
   char buffer[1024 * 32];
   base::allocator::GetStats(buffer, sizeof(buffer));
   std::string browser("Browser");
-  AboutTcmallocOutputs::GetInstance()->SetOutput(browser, buffer);
+  std::string browser_output(buffer);
+  if (base::debug::SamplingHeapProfiler::GetSamplingInterval()) {
+    // Symbolized stacks may contain template arguments.
+    std::string profile;
+    base::debug::SamplingHeapProfiler::GetProfileAsText(&profile);
+    browser_output.append("\n");
+    browser_output.append(net::EscapeForHTML(profile));
+  }
+  AboutTcmallocOutputs::GetInstance()->SetOutput(browser, browser_output);
 
   for (BrowserChildProcessHostIterator iter; !iter.Done(); ++iter) {
     iter.Send(new ChildProcessMsg_GetTcmallocStats);
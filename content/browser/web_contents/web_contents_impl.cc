@@ -62,6 +62,7 @@
 #include "net/base/net_util.h"
 #include "net/base/network_change_notifier.h"
 #include "net/url_request/url_request_context_getter.h"
+#include "third_party/leveldatabase/env_chromium.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/WebView.h"
 #include "ui/base/ui_base_switches.h"
 #include "ui/gfx/monitor.h"
@@ -164,6 +165,19 @@ const int kSyncWaitDelay = 40;
 
 const char kDotGoogleDotCom[] = ".google.com";
 
+// The number of WebContents which are loading. Database compactions are
+// throttled while there are any, to leave the disk to loading pages.
+int g_loading_web_contents_count = 0;
+
+void UpdateLoadingWebContentsCount(int delta) {
+  bool was_loading = g_loading_web_contents_count > 0;
+  g_loading_web_contents_count += delta;
+  DCHECK_GE(g_loading_web_contents_count, 0);
+  bool is_loading = g_loading_web_contents_count > 0;
+  if (is_loading != was_loading)
+    leveldb_env::SetBackgroundWorkThrottled(is_loading);
+}
+
 #if defined(OS_WIN)
 
 BOOL CALLBACK InvalidateWindow(HWND hwnd, LPARAM lparam) {
@@ -332,6 +346,9 @@ WebContentsImpl::WebContentsImpl(
 WebContentsImpl::~WebContentsImpl() {
   is_being_destroyed_ = true;
 
+  if (is_loading_)
+    UpdateLoadingWebContentsCount(-1);
+
   // Clear out any JavaScript state.
   if (dialog_creator_)
     dialog_creator_->ResetJavaScriptState(this);
@@ -1842,6 +1859,7 @@ void WebContentsImpl::SetIsLoading(bool is_loading,
   render_manager_.SetIsLoading(is_loading);
 
   is_loading_ = is_loading;
+  UpdateLoadingWebContentsCount(is_loading ? 1 : -1);
   waiting_for_response_ = is_loading;
 
   if (delegate_)
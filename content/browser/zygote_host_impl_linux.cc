@@ -269,6 +269,7 @@ pid_t ZygoteHostImpl::ForkRequest(
   pid_t pid;
   {
     base::AutoLock lock(control_lock_);
+    const base::TimeTicks fork_start = base::TimeTicks::Now();
     if (!UnixDomainSocket::SendMsg(control_fd_, pickle.data(), pickle.size(),
                                    fds))
       return base::kNullProcessHandle;
@@ -282,6 +283,10 @@ pid_t ZygoteHostImpl::ForkRequest(
     PickleIterator iter(reply_pickle);
     if (len <= 0 || !reply_pickle.ReadInt(&iter, &pid))
       return base::kNullProcessHandle;
+    // Includes setting up the child's sandbox, such as finding its PID
+    // outside the SUID sandbox.
+    UMA_HISTOGRAM_TIMES("Linux.ZygoteForkTime",
+                        base::TimeTicks::Now() - fork_start);
 
     // If there is a nonempty UMA name string, then there is a UMA
     // enumeration to record.
@@ -279,6 +279,8 @@ class Zygote {
     if (!(use_helper || g_suid_sandbox_active)) {
       return fork();
     }
+    if (!use_helper)
+      return ForkInPidNamespace();
 
     int dummy_fd;
     ino_t dummy_inode;
@@ -324,15 +326,7 @@ class Zygote {
       if (real_pid <= 0) {
         LOG(FATAL) << "Invalid pid from parent zygote";
       }
-#if defined(OS_LINUX)
-      // Sandboxed processes need to send the global, non-namespaced PID when
-      // setting up an IPC channel to their parent.
-      IPC::Channel::SetGlobalPid(real_pid);
-      // Force the real PID so chrome event data have a PID that corresponds
-      // to system trace event data.
-      base::debug::TraceLog::GetInstance()->SetProcessID(
-          static_cast<int>(real_pid));
-#endif
+      SetRealPid(real_pid);
       close(pipe_fds[0]);
       close(dummy_fd);
       return 0;
@@ -400,6 +394,88 @@ class Zygote {
     return -1;
   }
 
+  // Forks a child in the SUID sandbox's PID namespace, like ForkWithRealPid.
+  // Rather than have the sandbox binary scan /proc for the child, the child
+  // asks the sandbox host for its own PID, which the kernel translates for
+  // the host, and passes it back to us.
+  int ForkInPidNamespace() {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+      LOG(ERROR) << "Failed to create pipe";
+      return -1;
+    }
+
+    base::ProcessId pid = fork();
+    if (pid < 0) {
+      close(pipe_fds[0]);
+      close(pipe_fds[1]);
+      return -1;
+    }
+
+    if (pid == 0) {
+      // In the child process.
+      close(pipe_fds[0]);
+      base::ProcessId real_pid = GetPidOutsideSandbox();
+      if (real_pid <= 0)
+        LOG(FATAL) << "Failed to get pid outside the sandbox";
+      if (HANDLE_EINTR(write(pipe_fds[1], &real_pid, sizeof(real_pid))) !=
+          static_cast<ssize_t>(sizeof(real_pid))) {
+        LOG(FATAL) << "Failed to synchronise with parent zygote process";
+      }
+      close(pipe_fds[1]);
+      SetRealPid(real_pid);
+      return 0;
+    }
+
+    // In the parent process.
+    close(pipe_fds[1]);
+    base::ProcessId real_pid;
+    const bool read_pid = file_util::ReadFromFD(
+        pipe_fds[0], reinterpret_cast<char*>(&real_pid), sizeof(real_pid));
+    close(pipe_fds[0]);
+    if (!read_pid || real_pid <= 0) {
+      LOG(ERROR) << "Failed to get child process's real PID";
+      if (waitpid(pid, NULL, WNOHANG) == -1)
+        LOG(ERROR) << "Failed to wait for process";
+      return -1;
+    }
+    real_pids_to_sandbox_pids[real_pid] = pid;
+    return real_pid;
+  }
+
+  // Returns the PID of this process as the browser sees it, or -1 on error.
+  static base::ProcessId GetPidOutsideSandbox() {
+    Pickle request;
+    request.WriteInt(LinuxSandbox::METHOD_GET_GLOBAL_PID);
+
+    uint8_t reply_buf[64];
+    const ssize_t r = UnixDomainSocket::SendRecvMsg(
+        kMagicSandboxIPCDescriptor, reply_buf, sizeof(reply_buf), NULL,
+        request);
+    if (r == -1)
+      return -1;
+
+    Pickle reply(reinterpret_cast<char*>(reply_buf), r);
+    PickleIterator iter(reply);
+    base::ProcessId pid;
+    if (!reply.ReadInt(&iter, &pid))
+      return -1;
+    return pid;
+  }
+
+  // Called in a new child with its PID outside the sandbox.
+  static void SetRealPid(base::ProcessId real_pid) {
+#if defined(OS_LINUX)
+    // Sandboxed processes need to send the global, non-namespaced PID when
+    // setting up an IPC channel to their parent.
+    IPC::Channel::SetGlobalPid(real_pid);
+    // Force the real PID so chrome event data have a PID that corresponds
+    // to system trace event data.
+    base::debug::TraceLog::GetInstance()->SetProcessID(
+        static_cast<int>(real_pid));
+#endif
+  }
+
   // Unpacks process type and arguments from |pickle| and forks a new process.
   // Returns -1 on error, otherwise returns twice, returning 0 to the child
   // process and the child process ID to the parent process, like fork().
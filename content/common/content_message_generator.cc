@@ -38,6 +38,12 @@ struct ParamTraits<gfx::PluginWindowHandle> {
 }  // namespace IPC
 #endif
 
+// Generate param traits size methods.
+#include "ipc/param_traits_size_macros.h"
+namespace IPC {
+#include "content/common/content_message_generator.h"
+}  // namespace IPC
+
 // Generate param traits write methods.
 #include "ipc/param_traits_write_macros.h"
 namespace IPC {
@@ -56,6 +56,13 @@ IPC_SYNC_MESSAGE_CONTROL1_1(DatabaseHostMsg_GetFileSize,
                             string16 /* vfs file name */,
                             int64 /* the size of the given DB file */)
 
+// Asks the browser process to return both the attributes and the size of a
+// DB file, in one round trip
+IPC_SYNC_MESSAGE_CONTROL1_2(DatabaseHostMsg_GetFileInfo,
+                            string16 /* vfs file name */,
+                            int32 /* the attributes for the given DB file */,
+                            int64 /* the size of the given DB file */)
+
 // Asks the browser process for the amount of space available to an origin
 IPC_SYNC_MESSAGE_CONTROL1_1(DatabaseHostMsg_GetSpaceAvailable,
                             string16 /* origin identifier */,
@@ -1,54 +1,191 @@
-// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
 #include "content/common/database_util.h"
 
+#include <map>
+
+#include "base/lazy_instance.h"
+#include "base/metrics/histogram.h"
+#include "base/synchronization/lock.h"
+#include "base/time.h"
 #include "content/common/child_thread.h"
 #include "content/common/database_messages.h"
 #include "ipc/ipc_sync_message_filter.h"
 #include "third_party/sqlite/sqlite3.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebString.h"
+#include "webkit/database/database_util.h"
 
 using WebKit::WebKitPlatformSupport;
 using WebKit::WebString;
 
+namespace {
+
+// Remembers the attributes and size of the main files of the databases used
+// by this process, so that SQLite and WebKit asking for them again does not
+// cost a synchronous round trip to the browser each time. Journals and other
+// files SQLite creates next to a database are never cached: another process
+// may create or delete them at any time, and SQLite relies on seeing that to
+// recover from a crash.
+class DatabaseFileInfoCache {
+ public:
+  DatabaseFileInfoCache() {}
+
+  // Returns true and fills in |attributes| and |size| if they are known for
+  // |vfs_file_name|.
+  bool Get(const string16& vfs_file_name, int32* attributes, int64* size) {
+    base::AutoLock lock(lock_);
+    FileInfoMap::const_iterator it = files_.find(vfs_file_name);
+    if (it == files_.end())
+      return false;
+    *attributes = it->second.attributes;
+    *size = it->second.size;
+    return true;
+  }
+
+  void Set(const string16& vfs_file_name, int32 attributes, int64 size) {
+    base::AutoLock lock(lock_);
+    FileInfo& info = files_[vfs_file_name];
+    info.attributes = attributes;
+    info.size = size;
+  }
+
+  void Remove(const string16& vfs_file_name) {
+    base::AutoLock lock(lock_);
+    files_.erase(vfs_file_name);
+  }
+
+ private:
+  struct FileInfo {
+    int32 attributes;
+    int64 size;
+  };
+  typedef std::map<string16, FileInfo> FileInfoMap;
+
+  base::Lock lock_;
+  FileInfoMap files_;
+
+  DISALLOW_COPY_AND_ASSIGN(DatabaseFileInfoCache);
+};
+
+base::LazyInstance<DatabaseFileInfoCache>::Leaky g_file_info_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Returns true if |vfs_file_name| names the main file of a database, which
+// is the only kind of file whose information is cached.
+bool IsMainDatabaseFile(const string16& vfs_file_name) {
+  string16 sqlite_suffix;
+  return !vfs_file_name.empty() &&
+         webkit_database::DatabaseUtil::CrackVfsFileName(
+             vfs_file_name, NULL, NULL, &sqlite_suffix) &&
+         sqlite_suffix.empty();
+}
+
+// Returns the VFS file name of the main file of a database, as built by
+// WebKit.
+string16 MainDatabaseFileName(const string16& origin_identifier,
+                              const string16& database_name) {
+  string16 vfs_file_name(origin_identifier);
+  vfs_file_name.push_back('/');
+  vfs_file_name.append(database_name);
+  vfs_file_name.push_back('#');
+  return vfs_file_name;
+}
+
+// Gets the attributes and size of a main database file, from the cache when
+// possible and with a single round trip to the browser otherwise.
+void GetMainDatabaseFileInfo(const string16& vfs_file_name,
+                             int32* attributes,
+                             int64* size) {
+  bool cache_hit = g_file_info_cache.Get().Get(vfs_file_name, attributes, size);
+  UMA_HISTOGRAM_BOOLEAN("websql.Vfs.FileInfoCacheHit", cache_hit);
+  if (cache_hit)
+    return;
+
+  *attributes = -1;
+  *size = 0LL;
+  base::TimeTicks start = base::TimeTicks::Now();
+  scoped_refptr<IPC::SyncMessageFilter> filter(
+      ChildThread::current()->sync_message_filter());
+  if (!filter->Send(new DatabaseHostMsg_GetFileInfo(vfs_file_name,
+                                                    attributes, size))) {
+    return;
+  }
+  UMA_HISTOGRAM_TIMES("websql.Vfs.GetFileInfoTime",
+                      base::TimeTicks::Now() - start);
+
+  g_file_info_cache.Get().Set(vfs_file_name, *attributes, *size);
+}
+
+}  // namespace
+
 WebKitPlatformSupport::FileHandle DatabaseUtil::DatabaseOpenFile(
     const WebString& vfs_file_name, int desired_flags) {
+  // Opening may create the file.
+  if (desired_flags & SQLITE_OPEN_CREATE)
+    g_file_info_cache.Get().Remove(vfs_file_name);
+
   IPC::PlatformFileForTransit file_handle =
       IPC::InvalidPlatformFileForTransit();
 
+  base::TimeTicks start = base::TimeTicks::Now();
   scoped_refptr<IPC::SyncMessageFilter> filter(
       ChildThread::current()->sync_message_filter());
   filter->Send(new DatabaseHostMsg_OpenFile(
       vfs_file_name, desired_flags, &file_handle));
+  UMA_HISTOGRAM_TIMES("websql.Vfs.OpenFileTime",
+                      base::TimeTicks::Now() - start);
 
   return IPC::PlatformFileForTransitToPlatformFile(file_handle);
 }
 
 int DatabaseUtil::DatabaseDeleteFile(
     const WebString& vfs_file_name, bool sync_dir) {
+  g_file_info_cache.Get().Remove(vfs_file_name);
+
   int rv = SQLITE_IOERR_DELETE;
+  base::TimeTicks start = base::TimeTicks::Now();
   scoped_refptr<IPC::SyncMessageFilter> filter(
       ChildThread::current()->sync_message_filter());
   filter->Send(new DatabaseHostMsg_DeleteFile(
       vfs_file_name, sync_dir, &rv));
+  UMA_HISTOGRAM_TIMES("websql.Vfs.DeleteFileTime",
+                      base::TimeTicks::Now() - start);
   return rv;
 }
 
 long DatabaseUtil::DatabaseGetFileAttributes(const WebString& vfs_file_name) {
   int32 rv = -1;
+  if (IsMainDatabaseFile(vfs_file_name)) {
+    int64 size;
+    GetMainDatabaseFileInfo(vfs_file_name, &rv, &size);
+    return rv;
+  }
+
+  base::TimeTicks start = base::TimeTicks::Now();
   scoped_refptr<IPC::SyncMessageFilter> filter(
       ChildThread::current()->sync_message_filter());
   filter->Send(new DatabaseHostMsg_GetFileAttributes(vfs_file_name, &rv));
+  UMA_HISTOGRAM_TIMES("websql.Vfs.GetFileAttributesTime",
+                      base::TimeTicks::Now() - start);
   return rv;
 }
 
 long long DatabaseUtil::DatabaseGetFileSize(const WebString& vfs_file_name) {
   int64 rv = 0LL;
+  if (IsMainDatabaseFile(vfs_file_name)) {
+    int32 attributes;
+    GetMainDatabaseFileInfo(vfs_file_name, &attributes, &rv);
+    return rv;
+  }
+
+  base::TimeTicks start = base::TimeTicks::Now();
   scoped_refptr<IPC::SyncMessageFilter> filter(
       ChildThread::current()->sync_message_filter());
   filter->Send(new DatabaseHostMsg_GetFileSize(vfs_file_name, &rv));
+  UMA_HISTOGRAM_TIMES("websql.Vfs.GetFileSizeTime",
+                      base::TimeTicks::Now() - start);
   return rv;
 }
 
@@ -60,3 +197,11 @@ long long DatabaseUtil::DatabaseGetSpaceAvailable(
   filter->Send(new DatabaseHostMsg_GetSpaceAvailable(origin_identifier, &rv));
   return rv;
 }
+
+// static
+void DatabaseUtil::InvalidateDatabaseFileInfo(
+    const string16& origin_identifier,
+    const string16& database_name) {
+  g_file_info_cache.Get().Remove(
+      MainDatabaseFileName(origin_identifier, database_name));
+}
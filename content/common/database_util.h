@@ -6,6 +6,7 @@
 #define CONTENT_COMMON_DATABASE_UTIL_H_
 #pragma once
 
+#include "base/string16.h"
 #include "webkit/glue/webkitplatformsupport_impl.h"
 
 // A class of utility functions used by RendererWebKitPlatformSupportImpl and
@@ -22,6 +23,11 @@ class DatabaseUtil {
       const WebKit::WebString& vfs_file_name);
   static long long DatabaseGetSpaceAvailable(
       const WebKit::WebString& origin_identifier);
+
+  // Drops what is cached about the files of a database. Called whenever the
+  // database may have changed, in this process or in another one.
+  static void InvalidateDatabaseFileInfo(const string16& origin_identifier,
+                                         const string16& database_name);
 };
 
 #endif  // CONTENT_COMMON_DATABASE_UTIL_H_
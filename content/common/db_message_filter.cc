@@ -5,6 +5,7 @@
 #include "content/common/db_message_filter.h"
 
 #include "content/common/database_messages.h"
+#include "content/common/database_util.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/WebDatabase.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebString.h"
 
@@ -29,6 +30,8 @@ bool DBMessageFilter::OnMessageReceived(const IPC::Message& message) {
 void DBMessageFilter::OnDatabaseUpdateSize(const string16& origin_identifier,
                                            const string16& database_name,
                                            int64 database_size) {
+  // The database changed, possibly in another process.
+  DatabaseUtil::InvalidateDatabaseFileInfo(origin_identifier, database_name);
   WebKit::WebDatabase::updateDatabaseSize(
       origin_identifier, database_name, database_size);
 }
@@ -48,6 +51,7 @@ void DBMessageFilter::OnDatabaseResetSpaceAvailable(
 void DBMessageFilter::OnDatabaseCloseImmediately(
     const string16& origin_identifier,
     const string16& database_name) {
+  DatabaseUtil::InvalidateDatabaseFileInfo(origin_identifier, database_name);
   WebKit::WebDatabase::closeDatabaseImmediately(
       origin_identifier, database_name);
 }
@@ -10,14 +10,42 @@
 #include <sys/socket.h>
 #include <sys/uio.h>
 
+#include "base/eintr_wrapper.h"
+#include "base/metrics/histogram.h"
 #include "base/pickle.h"
+#include "base/time.h"
 #include "content/common/unix_domain_socket_posix.h"
 
+namespace {
+
+// Text with many scripts can ask for a lot of distinct fallbacks; the cache
+// starts over rather than grow without bound.
+const size_t kMaxCachedMatches = 1024;
+
+// Each cached font file holds a descriptor open.
+const size_t kMaxCachedFiles = 64;
+
+}  // namespace
+
+FontConfigIPC::MatchResult::MatchResult()
+    : success(false),
+      filefaceid(0),
+      is_bold(false),
+      is_italic(false) {
+}
+
+FontConfigIPC::MatchResult::~MatchResult() {
+}
+
 FontConfigIPC::FontConfigIPC(int fd)
     : fd_(fd) {
 }
 
 FontConfigIPC::~FontConfigIPC() {
+  for (FileCache::iterator it = file_cache_.begin(); it != file_cache_.end();
+       ++it) {
+    close(it->second);
+  }
   close(fd_);
 }
 
@@ -37,7 +65,7 @@ bool FontConfigIPC::Match(std::string* result_family,
     request.WriteUInt32(filefaceid);
 
   request.WriteBool(is_bold && *is_bold);
-  request.WriteBool(is_bold && *is_italic);
+  request.WriteBool(is_italic && *is_italic);
 
   request.WriteUInt32(characters_bytes);
   if (characters_bytes)
@@ -45,53 +73,93 @@ bool FontConfigIPC::Match(std::string* result_family,
 
   request.WriteString(family);
 
+  std::string key(static_cast<const char*>(request.data()), request.size());
+  MatchResult result;
+  bool cached;
+  {
+    base::AutoLock lock(lock_);
+    MatchCache::const_iterator it = match_cache_.find(key);
+    cached = it != match_cache_.end();
+    if (cached)
+      result = it->second;
+  }
+  UMA_HISTOGRAM_BOOLEAN("Linux.FontConfigIPC.MatchCacheHit", cached);
+
+  if (!cached) {
+    if (!SendMatchRequest(request, &result))
+      return false;
+
+    base::AutoLock lock(lock_);
+    if (match_cache_.size() >= kMaxCachedMatches)
+      match_cache_.clear();
+    match_cache_[key] = result;
+  }
+
+  if (!result.success)
+    return false;
+
+  *result_filefaceid = result.filefaceid;
+  if (result_family)
+    *result_family = result.family;
+
+  if (is_bold)
+    *is_bold = result.is_bold;
+  if (is_italic)
+    *is_italic = result.is_italic;
+
+  return true;
+}
+
+bool FontConfigIPC::SendMatchRequest(const Pickle& request,
+                                     MatchResult* result) {
+  base::TimeTicks start = base::TimeTicks::Now();
   uint8_t reply_buf[512];
   const ssize_t r = UnixDomainSocket::SendRecvMsg(fd_, reply_buf,
                                                   sizeof(reply_buf), NULL,
                                                   request);
+  UMA_HISTOGRAM_TIMES("Linux.FontConfigIPC.MatchTime",
+                      base::TimeTicks::Now() - start);
   if (r == -1)
     return false;
 
   Pickle reply(reinterpret_cast<char*>(reply_buf), r);
   PickleIterator iter(reply);
-  bool result;
-  if (!reply.ReadBool(&iter, &result))
-    return false;
-  if (!result)
+  if (!reply.ReadBool(&iter, &result->success))
     return false;
+  if (!result->success)
+    return true;
 
   uint32_t reply_filefaceid;
-  std::string reply_family;
-  bool resulting_bold, resulting_italic;
   if (!reply.ReadUInt32(&iter, &reply_filefaceid) ||
-      !reply.ReadString(&iter, &reply_family) ||
-      !reply.ReadBool(&iter, &resulting_bold) ||
-      !reply.ReadBool(&iter, &resulting_italic)) {
+      !reply.ReadString(&iter, &result->family) ||
+      !reply.ReadBool(&iter, &result->is_bold) ||
+      !reply.ReadBool(&iter, &result->is_italic)) {
     return false;
   }
-
-  *result_filefaceid = reply_filefaceid;
-  if (result_family)
-    *result_family = reply_family;
-
-  if (is_bold)
-    *is_bold = resulting_bold;
-  if (is_italic)
-    *is_italic = resulting_italic;
-
+  result->filefaceid = reply_filefaceid;
   return true;
 }
 
 int FontConfigIPC::Open(unsigned filefaceid) {
+  {
+    base::AutoLock lock(lock_);
+    FileCache::const_iterator it = file_cache_.find(filefaceid);
+    if (it != file_cache_.end())
+      return HANDLE_EINTR(dup(it->second));
+  }
+
   Pickle request;
   request.WriteInt(METHOD_OPEN);
   request.WriteUInt32(filefaceid);
 
+  base::TimeTicks start = base::TimeTicks::Now();
   int result_fd = -1;
   uint8_t reply_buf[256];
   const ssize_t r = UnixDomainSocket::SendRecvMsg(fd_, reply_buf,
                                                   sizeof(reply_buf),
                                                   &result_fd, request);
+  UMA_HISTOGRAM_TIMES("Linux.FontConfigIPC.OpenTime",
+                      base::TimeTicks::Now() - start);
 
   if (r == -1)
     return -1;
@@ -106,5 +174,15 @@ int FontConfigIPC::Open(unsigned filefaceid) {
     return -1;
   }
 
+  // Keep a duplicate, so that opening the same font again needs no IPC. The
+  // duplicates share a file offset, which is fine as Skia mmap()s them.
+  base::AutoLock lock(lock_);
+  if (file_cache_.size() < kMaxCachedFiles &&
+      file_cache_.find(filefaceid) == file_cache_.end()) {
+    int cached_fd = HANDLE_EINTR(dup(result_fd));
+    if (cached_fd >= 0)
+      file_cache_[filefaceid] = cached_fd;
+  }
+
   return result_fd;
 }
@@ -6,13 +6,22 @@
 #define CONTENT_COMMON_FONT_CONFIG_IPC_LINUX_H_
 #pragma once
 
+#include <map>
+#include <string>
+
 #include "base/compiler_specific.h"
+#include "base/synchronization/lock.h"
 #include "skia/ext/SkFontHost_fontconfig_impl.h"
 
-#include <string>
+class Pickle;
 
 // FontConfig implementation for Skia that proxies out of process to get out
 // of the sandbox. See http://code.google.com/p/chromium/wiki/LinuxSandboxIPC
+//
+// Each request blocks the calling thread on the browser, so the answers are
+// cached for the life of the renderer: the same fallback lookups come up
+// over and over while laying out text, and the installed fonts do not
+// change under a running renderer.
 class FontConfigIPC : public FontConfigInterface {
  public:
   explicit FontConfigIPC(int fd);
@@ -35,7 +44,36 @@ class FontConfigIPC : public FontConfigInterface {
   };
 
  private:
+  struct MatchResult {
+    MatchResult();
+    ~MatchResult();
+
+    bool success;
+    std::string family;
+    unsigned filefaceid;
+    bool is_bold;
+    bool is_italic;
+  };
+
+  // The request pickled by Match() identifies a lookup, so it is also the
+  // key of its cached result.
+  typedef std::map<std::string, MatchResult> MatchCache;
+  typedef std::map<unsigned, int> FileCache;
+
+  // Sends |request| to the browser and parses the reply into |result|.
+  // Returns false if the request failed, as opposed to finding no match.
+  bool SendMatchRequest(const Pickle& request, MatchResult* result);
+
   const int fd_;
+
+  // |lock_| protects the caches, as Skia may look up fonts from several
+  // threads.
+  base::Lock lock_;
+  MatchCache match_cache_;
+
+  // A descriptor of each opened font file. Open() returns duplicates of them,
+  // since the caller owns the returned descriptor.
+  FileCache file_cache_;
 };
 
 #endif  // CONTENT_COMMON_FONT_CONFIG_IPC_LINUX_H_
@@ -37,12 +37,14 @@ const int64 kHandleMoreWorkPeriodBusyMs = 1;
 GpuChannel::GpuChannel(GpuChannelManager* gpu_channel_manager,
                        GpuWatchdog* watchdog,
                        gfx::GLShareGroup* share_group,
+                       gpu::gles2::MailboxManager* mailbox_manager,
                        int client_id,
                        bool software)
     : gpu_channel_manager_(gpu_channel_manager),
       client_id_(client_id),
       share_group_(share_group ? share_group : new gfx::GLShareGroup),
-      mailbox_manager_(new gpu::gles2::MailboxManager),
+      mailbox_manager_(mailbox_manager ? mailbox_manager :
+                                         new gpu::gles2::MailboxManager),
       watchdog_(watchdog),
       software_(software),
       handle_messages_scheduled_(false),
@@ -154,6 +156,26 @@ bool GpuChannel::Send(IPC::Message* message) {
   return channel_->Send(message);
 }
 
+GpuChannelSchedulerClient::Priority GpuChannel::GetSchedulingPriority() {
+  if (deferred_messages_.empty())
+    return PRIORITY_BACKGROUND;
+  GpuCommandBufferStub* stub =
+      stubs_.Lookup(deferred_messages_.front()->routing_id());
+  if (!stub)
+    return PRIORITY_VISIBLE;
+  // Onscreen command buffers are the compositors, which put the pages and the
+  // browser UI on screen.
+  if (stub->has_surface_state()) {
+    return stub->surface_state().visible ? PRIORITY_COMPOSITOR :
+                                           PRIORITY_BACKGROUND;
+  }
+  return HasVisibleSurface() ? PRIORITY_VISIBLE : PRIORITY_BACKGROUND;
+}
+
+void GpuChannel::RunScheduledWork() {
+  HandleMessage();
+}
+
 void GpuChannel::AppendAllCommandBufferStubs(
     std::vector<GpuCommandBufferStubBase*>& stubs) {
   for (StubMap::Iterator<GpuCommandBufferStub> it(&stubs_);
@@ -165,14 +187,13 @@ void GpuChannel::AppendAllCommandBufferStubs(
 void GpuChannel::OnScheduled() {
   if (handle_messages_scheduled_)
     return;
-  // Post a task to handle any deferred messages. The deferred message queue is
-  // not emptied here, which ensures that OnMessageReceived will continue to
-  // defer newly received messages until the ones in the queue have all been
-  // handled by HandleMessage. HandleMessage is invoked as a
-  // task to prevent reentrancy.
-  MessageLoop::current()->PostTask(
-      FROM_HERE,
-      base::Bind(&GpuChannel::HandleMessage, weak_factory_.GetWeakPtr()));
+  // Ask the scheduler to handle any deferred messages. The deferred message
+  // queue is not emptied here, which ensures that OnMessageReceived will
+  // continue to defer newly received messages until the ones in the queue have
+  // all been handled by HandleMessage. The scheduler invokes HandleMessage
+  // from a task to prevent reentrancy, once the channels with more urgent
+  // messages have been served.
+  gpu_channel_manager_->channel_scheduler()->Schedule(this);
   handle_messages_scheduled_ = true;
 }
 
@@ -239,7 +260,19 @@ bool GpuChannel::ShouldPreferDiscreteGpu() const {
   return num_contexts_preferring_discrete_gpu_ > 0;
 }
 
-GpuChannel::~GpuChannel() {}
+bool GpuChannel::HasVisibleSurface() {
+  for (StubMap::Iterator<GpuCommandBufferStub> it(&stubs_);
+      !it.IsAtEnd(); it.Advance()) {
+    GpuCommandBufferStub* stub = it.GetCurrentValue();
+    if (stub->has_surface_state() && stub->surface_state().visible)
+      return true;
+  }
+  return false;
+}
+
+GpuChannel::~GpuChannel() {
+  gpu_channel_manager_->channel_scheduler()->Unschedule(this);
+}
 
 void GpuChannel::OnDestroy() {
   TRACE_EVENT0("gpu", "GpuChannel::OnDestroy");
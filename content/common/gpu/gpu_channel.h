@@ -15,6 +15,7 @@
 #include "base/memory/weak_ptr.h"
 #include "base/process.h"
 #include "build/build_config.h"
+#include "content/common/gpu/gpu_channel_scheduler.h"
 #include "content/common/gpu/gpu_command_buffer_stub.h"
 #include "content/common/gpu/gpu_memory_manager.h"
 #include "content/common/message_router.h"
@@ -37,12 +38,16 @@ class WaitableEvent;
 // process. On the renderer side there's a corresponding GpuChannelHost.
 class GpuChannel : public IPC::Channel::Listener,
                    public IPC::Message::Sender,
+                   public GpuChannelSchedulerClient,
                    public base::RefCountedThreadSafe<GpuChannel> {
  public:
-  // Takes ownership of the renderer process handle.
+  // Takes ownership of the renderer process handle. If |share_group| or
+  // |mailbox_manager| is NULL, the channel creates its own. Texture mailboxes
+  // can only be shared by channels whose contexts are in the same share group.
   GpuChannel(GpuChannelManager* gpu_channel_manager,
              GpuWatchdog* watchdog,
              gfx::GLShareGroup* share_group,
+             gpu::gles2::MailboxManager* mailbox_manager,
              int client_id,
              bool software);
 
@@ -70,6 +75,10 @@ class GpuChannel : public IPC::Channel::Listener,
   // IPC::Message::Sender implementation:
   virtual bool Send(IPC::Message* msg) OVERRIDE;
 
+  // GpuChannelSchedulerClient implementation:
+  virtual Priority GetSchedulingPriority() OVERRIDE;
+  virtual void RunScheduledWork() OVERRIDE;
+
   virtual void AppendAllCommandBufferStubs(
       std::vector<GpuCommandBufferStubBase*>& stubs);
 
@@ -105,6 +114,10 @@ class GpuChannel : public IPC::Channel::Listener,
   // discrete GPU even if they would otherwise use the integrated GPU.
   bool ShouldPreferDiscreteGpu() const;
 
+  // Whether any of the onscreen command buffers of the channel draws to a
+  // visible surface.
+  bool HasVisibleSurface();
+
  protected:
   virtual ~GpuChannel();
 
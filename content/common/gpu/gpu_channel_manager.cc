@@ -5,10 +5,14 @@
 #include "content/common/gpu/gpu_channel_manager.h"
 
 #include "base/bind.h"
+#include "base/command_line.h"
 #include "content/common/child_thread.h"
 #include "content/common/gpu/gpu_channel.h"
 #include "content/common/gpu/gpu_messages.h"
 #include "content/common/gpu/gpu_memory_manager.h"
+#include "gpu/command_buffer/service/gpu_switches.h"
+#include "gpu/command_buffer/service/mailbox_manager.h"
+#include "gpu/command_buffer/service/program_cache.h"
 #include "ui/gfx/gl/gl_share_group.h"
 
 GpuChannelManager::GpuChannelManager(ChildThread* gpu_child_thread,
@@ -25,6 +29,11 @@ GpuChannelManager::GpuChannelManager(ChildThread* gpu_child_thread,
   DCHECK(gpu_child_thread);
   DCHECK(io_message_loop);
   DCHECK(shutdown_event);
+  if (!CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kDisableGpuProgramCache)) {
+    program_cache_.reset(new gpu::gles2::ProgramCache(
+        gpu::gles2::ProgramCache::kDefaultMaxCacheSizeBytes));
+  }
 }
 
 GpuChannelManager::~GpuChannelManager() {
@@ -87,15 +96,21 @@ void GpuChannelManager::OnEstablishChannel(int client_id, bool share_context) {
   IPC::ChannelHandle channel_handle;
 
   gfx::GLShareGroup* share_group = NULL;
+  gpu::gles2::MailboxManager* mailbox_manager = NULL;
   if (share_context) {
-    if (!share_group_)
+    if (!share_group_) {
       share_group_ = new gfx::GLShareGroup;
+      DCHECK(!mailbox_manager_);
+      mailbox_manager_ = new gpu::gles2::MailboxManager;
+    }
     share_group = share_group_;
+    mailbox_manager = mailbox_manager_;
   }
 
   scoped_refptr<GpuChannel> channel = new GpuChannel(this,
                                                      watchdog_,
                                                      share_group,
+                                                     mailbox_manager,
                                                      client_id,
                                                      false);
   if (channel->Init(io_message_loop_, shutdown_event_)) {
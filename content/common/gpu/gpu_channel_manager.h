@@ -8,9 +8,11 @@
 
 #include "base/hash_tables.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/message_loop_proxy.h"
 #include "build/build_config.h"
+#include "content/common/gpu/gpu_channel_scheduler.h"
 #include "content/common/gpu/gpu_memory_manager.h"
 #include "ipc/ipc_channel.h"
 #include "ipc/ipc_message.h"
@@ -24,6 +26,13 @@ namespace gfx {
 class GLShareGroup;
 }
 
+namespace gpu {
+namespace gles2 {
+class MailboxManager;
+class ProgramCache;
+}
+}
+
 namespace IPC {
 struct ChannelHandle;
 }
@@ -76,8 +85,14 @@ class GpuChannelManager : public IPC::Channel::Listener,
 
   GpuMemoryManager* gpu_memory_manager() { return &gpu_memory_manager_; }
 
+  // Orders the messages of all the channels.
+  GpuChannelScheduler* channel_scheduler() { return &channel_scheduler_; }
+
   GpuChannel* LookupChannel(int32 client_id);
 
+  // Shared by the context groups of all channels. NULL if disabled.
+  gpu::gles2::ProgramCache* program_cache() { return program_cache_.get(); }
+
  private:
   // Message handlers.
   void OnEstablishChannel(int client_id, bool share_context);
@@ -98,12 +113,21 @@ class GpuChannelManager : public IPC::Channel::Listener,
   // Used to send and receive IPC messages from the browser process.
   ChildThread* gpu_child_thread_;
 
+  // Declared before |gpu_channels_| so it outlives the context groups.
+  scoped_ptr<gpu::gles2::ProgramCache> program_cache_;
+
+  // Declared before |gpu_channels_| so it outlives the channels.
+  GpuChannelScheduler channel_scheduler_;
+
   // These objects manage channels to individual renderer processes there is
   // one channel for each renderer process that has connected to this GPU
   // process.
   typedef base::hash_map<int, scoped_refptr<GpuChannel> > GpuChannelMap;
   GpuChannelMap gpu_channels_;
   scoped_refptr<gfx::GLShareGroup> share_group_;
+  // Shared by the channels that use |share_group_|, so that their contexts can
+  // pass textures to each other through mailboxes without copies.
+  scoped_refptr<gpu::gles2::MailboxManager> mailbox_manager_;
   GpuMemoryManager gpu_memory_manager_;
   GpuWatchdog* watchdog_;
 
@@ -0,0 +1,109 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/common/gpu/gpu_channel_scheduler.h"
+
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/message_loop.h"
+
+GpuChannelScheduler::GpuChannelScheduler()
+    : run_next_posted_(false),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
+}
+
+GpuChannelScheduler::~GpuChannelScheduler() {
+  DCHECK(clients_.empty());
+}
+
+void GpuChannelScheduler::Schedule(GpuChannelSchedulerClient* client) {
+  if (IsScheduled(client))
+    return;
+  ScheduledClient scheduled;
+  scheduled.client = client;
+  scheduled.scheduled_time = base::TimeTicks::Now();
+  clients_.push_back(scheduled);
+  TRACE_COUNTER1("gpu", "GpuChannelScheduler::QueueLength", clients_.size());
+  PostRunNext();
+}
+
+void GpuChannelScheduler::Unschedule(GpuChannelSchedulerClient* client) {
+  for (ClientList::iterator it = clients_.begin(); it != clients_.end();
+       ++it) {
+    if (it->client == client) {
+      clients_.erase(it);
+      return;
+    }
+  }
+}
+
+bool GpuChannelScheduler::IsScheduled(
+    GpuChannelSchedulerClient* client) const {
+  for (ClientList::const_iterator it = clients_.begin(); it != clients_.end();
+       ++it) {
+    if (it->client == client)
+      return true;
+  }
+  return false;
+}
+
+void GpuChannelScheduler::PostRunNext() {
+  if (run_next_posted_)
+    return;
+  // Run as a task so that clients are not reentered and so that other tasks
+  // on the GPU thread, like fence polling, are interleaved with the messages.
+  MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&GpuChannelScheduler::RunNext, weak_factory_.GetWeakPtr()));
+  run_next_posted_ = true;
+}
+
+void GpuChannelScheduler::RunNext() {
+  run_next_posted_ = false;
+
+  GpuChannelSchedulerClient* client = TakeNextClient(base::TimeTicks::Now());
+  if (client)
+    client->RunScheduledWork();
+
+  if (!clients_.empty())
+    PostRunNext();
+}
+
+GpuChannelSchedulerClient* GpuChannelScheduler::TakeNextClient(
+    base::TimeTicks now) {
+  if (clients_.empty())
+    return NULL;
+
+  // The list is in scheduling order, so the first client that has waited too
+  // long is the one that has waited longest, and ties in priority go to the
+  // earliest client.
+  const base::TimeDelta max_delay =
+      base::TimeDelta::FromMilliseconds(kMaxSchedulingDelayMs);
+  ClientList::iterator next = clients_.end();
+  GpuChannelSchedulerClient::Priority next_priority =
+      GpuChannelSchedulerClient::PRIORITY_BACKGROUND;
+  for (ClientList::iterator it = clients_.begin(); it != clients_.end();
+       ++it) {
+    if (now - it->scheduled_time > max_delay) {
+      next = it;
+      next_priority = it->client->GetSchedulingPriority();
+      break;
+    }
+    GpuChannelSchedulerClient::Priority priority =
+        it->client->GetSchedulingPriority();
+    if (next == clients_.end() || priority > next_priority) {
+      next = it;
+      next_priority = priority;
+    }
+  }
+
+  GpuChannelSchedulerClient* client = next->client;
+  TRACE_EVENT_INSTANT2("gpu", "GpuChannelScheduler::RunNext",
+                       "priority", static_cast<int>(next_priority),
+                       "latency_us", static_cast<int>(
+                           (now - next->scheduled_time).InMicroseconds()));
+  clients_.erase(next);
+  TRACE_COUNTER1("gpu", "GpuChannelScheduler::QueueLength", clients_.size());
+  return client;
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_COMMON_GPU_GPU_CHANNEL_SCHEDULER_H_
+#define CONTENT_COMMON_GPU_GPU_CHANNEL_SCHEDULER_H_
+#pragma once
+
+#include <list>
+
+#include "base/basictypes.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time.h"
+#include "content/common/content_export.h"
+
+class CONTENT_EXPORT GpuChannelSchedulerClient {
+ public:
+  // Higher values are run first.
+  enum Priority {
+    PRIORITY_BACKGROUND,
+    PRIORITY_VISIBLE,
+    PRIORITY_COMPOSITOR,
+  };
+
+  virtual ~GpuChannelSchedulerClient() {}
+
+  // The priority of the next message the client would handle.
+  virtual Priority GetSchedulingPriority() = 0;
+
+  // Handles a single message. The client calls Schedule again if it has more.
+  virtual void RunScheduledWork() = 0;
+};
+
+// Decides which of the GPU channels with pending messages runs next. Channels
+// used to post a task per message, so the contexts of all the renderers were
+// served in the order their messages arrived and a busy WebGL page could delay
+// the frames of the compositors. Work is now handed out one message (for
+// command buffers, one flush) at a time, to the channel whose next message
+// has the highest priority. Channels that have waited for longer than
+// kMaxSchedulingDelayMs are run first regardless of priority so that
+// background pages still make progress.
+class CONTENT_EXPORT GpuChannelScheduler {
+ public:
+  enum { kMaxSchedulingDelayMs = 100 };
+
+  GpuChannelScheduler();
+  ~GpuChannelScheduler();
+
+  // Queues |client| to run once. Does nothing if it is already queued.
+  void Schedule(GpuChannelSchedulerClient* client);
+
+  // Removes |client| from the queue. Must be called before it is destroyed.
+  void Unschedule(GpuChannelSchedulerClient* client);
+
+  bool IsScheduled(GpuChannelSchedulerClient* client) const;
+
+ private:
+  friend class GpuChannelSchedulerTest;
+
+  struct ScheduledClient {
+    GpuChannelSchedulerClient* client;
+    base::TimeTicks scheduled_time;
+  };
+  typedef std::list<ScheduledClient> ClientList;
+
+  void PostRunNext();
+  void RunNext();
+
+  // Returns the client that should run at |now|, removed from the queue.
+  // Returns NULL if the queue is empty.
+  GpuChannelSchedulerClient* TakeNextClient(base::TimeTicks now);
+
+  // In the order they were scheduled.
+  ClientList clients_;
+  bool run_next_posted_;
+  base::WeakPtrFactory<GpuChannelScheduler> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(GpuChannelScheduler);
+};
+
+#endif  // CONTENT_COMMON_GPU_GPU_CHANNEL_SCHEDULER_H_
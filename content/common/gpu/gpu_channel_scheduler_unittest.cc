@@ -0,0 +1,123 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "base/message_loop.h"
+#include "content/common/gpu/gpu_channel_scheduler.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+class FakeSchedulerClient : public GpuChannelSchedulerClient {
+ public:
+  FakeSchedulerClient(Priority priority, std::vector<int>* runs, int id)
+      : priority_(priority),
+        runs_(runs),
+        id_(id) {
+  }
+
+  virtual Priority GetSchedulingPriority() {
+    return priority_;
+  }
+  virtual void RunScheduledWork() {
+    runs_->push_back(id_);
+  }
+
+ private:
+  Priority priority_;
+  std::vector<int>* runs_;
+  int id_;
+};
+
+class GpuChannelSchedulerTest : public testing::Test {
+ protected:
+  GpuChannelSchedulerClient* TakeNextClient(base::TimeTicks now) {
+    return scheduler_.TakeNextClient(now);
+  }
+
+  void SetScheduledTime(GpuChannelSchedulerClient* client,
+                        base::TimeTicks time) {
+    for (GpuChannelScheduler::ClientList::iterator it =
+             scheduler_.clients_.begin();
+         it != scheduler_.clients_.end(); ++it) {
+      if (it->client == client)
+        it->scheduled_time = time;
+    }
+  }
+
+  MessageLoop message_loop_;
+  GpuChannelScheduler scheduler_;
+};
+
+TEST_F(GpuChannelSchedulerTest, RunsHighestPriorityFirst) {
+  std::vector<int> runs;
+  FakeSchedulerClient background(
+      GpuChannelSchedulerClient::PRIORITY_BACKGROUND, &runs, 1);
+  FakeSchedulerClient visible(
+      GpuChannelSchedulerClient::PRIORITY_VISIBLE, &runs, 2);
+  FakeSchedulerClient compositor(
+      GpuChannelSchedulerClient::PRIORITY_COMPOSITOR, &runs, 3);
+
+  scheduler_.Schedule(&background);
+  scheduler_.Schedule(&visible);
+  scheduler_.Schedule(&compositor);
+  // Scheduling twice does not queue the client twice.
+  scheduler_.Schedule(&background);
+  message_loop_.RunAllPending();
+
+  ASSERT_EQ(3u, runs.size());
+  EXPECT_EQ(3, runs[0]);
+  EXPECT_EQ(2, runs[1]);
+  EXPECT_EQ(1, runs[2]);
+  EXPECT_FALSE(scheduler_.IsScheduled(&background));
+}
+
+TEST_F(GpuChannelSchedulerTest, EqualPriorityRunsInOrder) {
+  std::vector<int> runs;
+  FakeSchedulerClient first(
+      GpuChannelSchedulerClient::PRIORITY_VISIBLE, &runs, 1);
+  FakeSchedulerClient second(
+      GpuChannelSchedulerClient::PRIORITY_VISIBLE, &runs, 2);
+
+  scheduler_.Schedule(&first);
+  scheduler_.Schedule(&second);
+  message_loop_.RunAllPending();
+
+  ASSERT_EQ(2u, runs.size());
+  EXPECT_EQ(1, runs[0]);
+  EXPECT_EQ(2, runs[1]);
+}
+
+TEST_F(GpuChannelSchedulerTest, StarvedClientRunsFirst) {
+  std::vector<int> runs;
+  FakeSchedulerClient background(
+      GpuChannelSchedulerClient::PRIORITY_BACKGROUND, &runs, 1);
+  FakeSchedulerClient compositor(
+      GpuChannelSchedulerClient::PRIORITY_COMPOSITOR, &runs, 2);
+
+  base::TimeTicks now = base::TimeTicks::Now();
+  scheduler_.Schedule(&background);
+  scheduler_.Schedule(&compositor);
+  SetScheduledTime(&background, now);
+  SetScheduledTime(&compositor, now);
+
+  base::TimeTicks later = now + base::TimeDelta::FromMilliseconds(
+      GpuChannelScheduler::kMaxSchedulingDelayMs + 1);
+  EXPECT_EQ(&background, TakeNextClient(later));
+  EXPECT_EQ(&compositor, TakeNextClient(later));
+  EXPECT_TRUE(TakeNextClient(later) == NULL);
+}
+
+TEST_F(GpuChannelSchedulerTest, UnscheduledClientDoesNotRun) {
+  std::vector<int> runs;
+  FakeSchedulerClient client(
+      GpuChannelSchedulerClient::PRIORITY_VISIBLE, &runs, 1);
+
+  scheduler_.Schedule(&client);
+  EXPECT_TRUE(scheduler_.IsScheduled(&client));
+  scheduler_.Unschedule(&client);
+  EXPECT_FALSE(scheduler_.IsScheduled(&client));
+  message_loop_.RunAllPending();
+  EXPECT_TRUE(runs.empty());
+}
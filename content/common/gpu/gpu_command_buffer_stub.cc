@@ -4,11 +4,15 @@
 
 #if defined(ENABLE_GPU)
 
+#include <algorithm>
+#include <limits>
+
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/command_line.h"
 #include "base/debug/trace_event.h"
 #include "base/shared_memory.h"
+#include "base/stringprintf.h"
 #include "base/time.h"
 #include "build/build_config.h"
 #include "content/common/gpu/gpu_channel.h"
@@ -20,6 +24,8 @@
 #include "content/common/gpu/image_transport_surface.h"
 #include "gpu/command_buffer/common/constants.h"
 #include "gpu/command_buffer/common/gles2_cmd_utils.h"
+#include "gpu/command_buffer/service/command_buffer_recorder.h"
+#include "gpu/command_buffer/service/gpu_switches.h"
 #include "ui/gfx/gl/gl_bindings.h"
 #include "ui/gfx/gl/gl_switches.h"
 
@@ -27,6 +33,29 @@
 #include "content/public/common/sandbox_init.h"
 #endif
 
+// GL_NVX_gpu_memory_info
+#ifndef GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX
+#define GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX 0x9047
+#endif
+
+namespace {
+
+// Returns the dedicated video memory of the GPU in bytes, or 0 if the driver
+// does not say. |context| must be current.
+size_t GetTotalGpuMemory(gfx::GLContext* context) {
+  if (!context->HasExtension("GL_NVX_gpu_memory_info"))
+    return 0;
+  GLint dedicated_kb = 0;
+  glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &dedicated_kb);
+  if (dedicated_kb <= 0)
+    return 0;
+  uint64 bytes = static_cast<uint64>(dedicated_kb) * 1024;
+  return static_cast<size_t>(
+      std::min(bytes, static_cast<uint64>(std::numeric_limits<size_t>::max())));
+}
+
+}  // anonymous namespace
+
 GpuCommandBufferStub::SurfaceState::SurfaceState(int32 surface_id,
                                                  bool visible,
                                                  base::TimeTicks last_used_time)
@@ -69,7 +98,10 @@ GpuCommandBufferStub::GpuCommandBufferStub(
   if (share_group) {
     context_group_ = share_group->context_group_;
   } else {
-    context_group_ = new gpu::gles2::ContextGroup(mailbox_manager, true);
+    context_group_ = new gpu::gles2::ContextGroup(
+        mailbox_manager,
+        channel->gpu_channel_manager()->program_cache(),
+        true);
   }
   if (surface_id != 0)
     surface_state_.reset(new GpuCommandBufferStubBase::SurfaceState(
@@ -222,6 +254,7 @@ void GpuCommandBufferStub::Destroy() {
   }
 
   command_buffer_.reset();
+  recorder_.reset();
 
   context_ = NULL;
   surface_ = NULL;
@@ -317,6 +350,29 @@ void GpuCommandBufferStub::OnInitialize(
     decoder_->set_log_commands(true);
   }
 
+  FilePath record_dir = CommandLine::ForCurrentProcess()->GetSwitchValuePath(
+      switches::kRecordGPUCommandBuffers);
+  if (!record_dir.empty()) {
+    recorder_.reset(gpu::CommandBufferRecorder::Create(
+        record_dir.AppendASCII(base::StringPrintf(
+            "command_buffer_%d_%d.gcbr",
+            static_cast<int>(channel_->renderer_pid()),
+            route_id_))));
+    if (recorder_.get()) {
+      recorder_->RecordInitialize(!surface_id(),
+                                  context_group_->bind_generates_resource(),
+                                  initial_size_,
+                                  allowed_extensions_,
+                                  requested_attribs_);
+    }
+  }
+
+  size_t total_gpu_memory = GetTotalGpuMemory(context_.get());
+  if (total_gpu_memory) {
+    channel_->gpu_channel_manager()->gpu_memory_manager()->SetTotalGpuMemory(
+        total_gpu_memory);
+  }
+
   decoder_->SetMsgCallback(
       base::Bind(&GpuCommandBufferStub::SendConsoleMessage,
                  base::Unretained(this)));
@@ -354,6 +410,8 @@ void GpuCommandBufferStub::OnInitialize(
 void GpuCommandBufferStub::OnSetGetBuffer(
     int32 shm_id, IPC::Message* reply_message) {
   if (command_buffer_.get()) {
+    if (recorder_.get())
+      recorder_->RecordSetGetBuffer(shm_id);
     command_buffer_->SetGetBuffer(shm_id);
   } else {
     DLOG(ERROR) << "no command_buffer.";
@@ -442,6 +500,8 @@ void GpuCommandBufferStub::OnAsyncFlush(int32 put_offset,
   DCHECK(command_buffer_.get());
   if (flush_count - last_flush_count_ < 0x8000000U) {
     last_flush_count_ = flush_count;
+    if (recorder_.get())
+      recorder_->RecordFlush(command_buffer_.get(), put_offset);
     command_buffer_->Flush(put_offset);
   } else {
     // We received this message out-of-order. This should not happen but is here
@@ -466,6 +526,8 @@ void GpuCommandBufferStub::OnCreateTransferBuffer(int32 size,
                                                   IPC::Message* reply_message) {
   if (command_buffer_.get()) {
     int32 id = command_buffer_->CreateTransferBuffer(size, id_request);
+    if (recorder_.get() && id >= 0)
+      recorder_->RecordCreateTransferBuffer(id, size);
     GpuCommandBufferMsg_CreateTransferBuffer::WriteReplyParams(
         reply_message, id);
   } else {
@@ -485,6 +547,8 @@ void GpuCommandBufferStub::OnRegisterTransferBuffer(
     int32 id = command_buffer_->RegisterTransferBuffer(&shared_memory,
                                                        size,
                                                        id_request);
+    if (recorder_.get() && id >= 0)
+      recorder_->RecordCreateTransferBuffer(id, size);
     GpuCommandBufferMsg_RegisterTransferBuffer::WriteReplyParams(reply_message,
                                                                  id);
   } else {
@@ -498,6 +562,8 @@ void GpuCommandBufferStub::OnDestroyTransferBuffer(
     int32 id,
     IPC::Message* reply_message) {
   if (command_buffer_.get()) {
+    if (recorder_.get())
+      recorder_->RecordDestroyTransferBuffer(id);
     command_buffer_->DestroyTransferBuffer(id);
   } else {
     reply_message->set_reply_error();
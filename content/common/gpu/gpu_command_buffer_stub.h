@@ -40,6 +40,7 @@ struct GpuMemoryAllocation;
 class GpuWatchdog;
 
 namespace gpu {
+class CommandBufferRecorder;
 namespace gles2 {
 class MailboxManager;
 }
@@ -243,6 +244,9 @@ class GpuCommandBufferStub
   scoped_refptr<gfx::GLContext> context_;
   scoped_refptr<gfx::GLSurface> surface_;
 
+  // Set if the commands are being recorded with --record-gpu-command-buffers.
+  scoped_ptr<gpu::CommandBufferRecorder> recorder_;
+
   // SetParent may be called before Initialize, in which case we need to keep
   // around the parent stub, so that Initialize can set the parent correctly.
   base::WeakPtr<GpuCommandBufferStub> parent_stub_for_initialization_;
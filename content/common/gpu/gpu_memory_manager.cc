@@ -42,6 +42,7 @@ GpuMemoryManager::GpuMemoryManager(GpuMemoryManagerClient* client,
       manage_scheduled_(false),
       max_surfaces_with_frontbuffer_soft_limit_(
           max_surfaces_with_frontbuffer_soft_limit),
+      total_gpu_memory_(0),
       weak_factory_(ALLOW_THIS_IN_INITIALIZER_LIST(this)) {
 }
 
@@ -60,6 +61,18 @@ bool GpuMemoryManager::StubWithSurfaceComparator::operator()(
     return !rhs_ss.visible && (lhs_ss.last_used_time > rhs_ss.last_used_time);
 };
 
+void GpuMemoryManager::SetTotalGpuMemory(size_t bytes) {
+  total_gpu_memory_ = bytes;
+}
+
+size_t GpuMemoryManager::GetTotalBudget() const {
+  if (!total_gpu_memory_)
+    return kMaximumAllocationForTabs;
+  return std::max(
+      total_gpu_memory_ / 100 * kBudgetPercentOfGpuMemory,
+      static_cast<size_t>(kMinimumAllocationForTab));
+}
+
 void GpuMemoryManager::ScheduleManage() {
   if (manage_scheduled_)
     return;
@@ -98,6 +111,16 @@ void GpuMemoryManager::ScheduleManage() {
 // As such, the rule for categorizing contexts without a surface is:
 //  1. Find the most visible context-with-a-surface within each
 //     context-without-a-surface's share group, and inherit its visibilty.
+//
+// The byte budget from GetTotalBudget is then handed out:
+//  1. Foreground contexts, and contexts without a surface that are not
+//     hibernated, get kMinimumAllocationForTab each.
+//  2. If the size of the GPU memory is known, background contexts with a
+//     surface are given up to kMinimumAllocationForTab each from half of the
+//     rest, most recently used first, so that the compositor can keep their
+//     textures resident. As the budget runs out the older ones get less and
+//     then nothing, which tells them to discard incrementally.
+//  3. Foreground contexts with a surface share what is left equally.
 void GpuMemoryManager::Manage() {
   manage_scheduled_ = false;
 
@@ -168,11 +191,27 @@ void GpuMemoryManager::Manage() {
                               stubs_without_surface_foreground.size() +
                               stubs_without_surface_background.size();
   size_t base_allocation_size = kMinimumAllocationForTab * num_stubs_need_mem;
+  size_t total_budget = GetTotalBudget();
+  size_t remaining_budget = 0;
+  if (base_allocation_size < total_budget)
+    remaining_budget = total_budget - base_allocation_size;
+
+  std::vector<size_t> background_allocations(
+      stubs_with_surface_background.size(), 0);
+  if (total_gpu_memory_) {
+    size_t background_budget = remaining_budget / 2;
+    for (size_t i = 0; i < stubs_with_surface_background.size(); ++i) {
+      size_t allocation = std::min(
+          background_budget, static_cast<size_t>(kMinimumAllocationForTab));
+      background_allocations[i] = allocation;
+      background_budget -= allocation;
+      remaining_budget -= allocation;
+    }
+  }
+
   size_t bonus_allocation = 0;
-  if (base_allocation_size < kMaximumAllocationForTabs &&
-      !stubs_with_surface_foreground.empty())
-    bonus_allocation = (kMaximumAllocationForTabs - base_allocation_size) /
-                           stubs_with_surface_foreground.size();
+  if (!stubs_with_surface_foreground.empty())
+    bonus_allocation = remaining_budget / stubs_with_surface_foreground.size();
 
   // Now give out allocations to everyone.
   AssignMemoryAllocations(stubs_with_surface_foreground,
@@ -180,8 +219,11 @@ void GpuMemoryManager::Manage() {
           GpuMemoryAllocation::kHasFrontbuffer |
           GpuMemoryAllocation::kHasBackbuffer));
 
-  AssignMemoryAllocations(stubs_with_surface_background,
-      GpuMemoryAllocation(0, GpuMemoryAllocation::kHasFrontbuffer));
+  for (size_t i = 0; i < stubs_with_surface_background.size(); ++i) {
+    stubs_with_surface_background[i]->SetMemoryAllocation(
+        GpuMemoryAllocation(background_allocations[i],
+                            GpuMemoryAllocation::kHasFrontbuffer));
+  }
 
   AssignMemoryAllocations(stubs_with_surface_hibernated,
       GpuMemoryAllocation(0, GpuMemoryAllocation::kHasNoBuffers));
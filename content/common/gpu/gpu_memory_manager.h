@@ -45,12 +45,23 @@ class CONTENT_EXPORT GpuMemoryManager {
 #endif
   };
 
+  // When the size of the GPU memory is known, this percentage of it is shared
+  // by all the tabs instead of kMaximumAllocationForTabs.
+  enum { kBudgetPercentOfGpuMemory = 75 };
+
   GpuMemoryManager(GpuMemoryManagerClient* client,
                    size_t max_surfaces_with_frontbuffer_soft_limit);
   ~GpuMemoryManager();
 
   void ScheduleManage();
 
+  // Sets the amount of dedicated GPU memory in bytes, or 0 if it is unknown.
+  // Takes effect on the next Manage.
+  void SetTotalGpuMemory(size_t bytes);
+
+  // The number of bytes shared by all the tabs.
+  size_t GetTotalBudget() const;
+
  private:
   friend class GpuMemoryManagerTest;
   void Manage();
@@ -64,6 +75,7 @@ class CONTENT_EXPORT GpuMemoryManager {
   GpuMemoryManagerClient* client_;
   bool manage_scheduled_;
   size_t max_surfaces_with_frontbuffer_soft_limit_;
+  size_t total_gpu_memory_;
   base::WeakPtrFactory<GpuMemoryManager> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(GpuMemoryManager);
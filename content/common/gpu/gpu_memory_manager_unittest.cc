@@ -561,3 +561,38 @@ TEST_F(GpuMemoryManagerTest, GpuMemoryAllocationCompareTests) {
     }
   }
 }
+
+// Test GpuMemoryManager::Manage functionality: Test the byte budget when the
+// size of the GPU memory is known.
+// Expect background stubs with surface to keep some memory, most recently used
+// first, and to lose it when the budget is tight.
+TEST_F(GpuMemoryManagerTest, TestManageWithKnownGpuMemory) {
+  FakeCommandBufferStub stub1(GenerateUniqueSurfaceId(), true, newest_),
+                        stub2(GenerateUniqueSurfaceId(), false, newer_),
+                        stub3(GenerateUniqueSurfaceId(), false, older_);
+  client_.stubs_.push_back(&stub1);
+  client_.stubs_.push_back(&stub2);
+  client_.stubs_.push_back(&stub3);
+
+  // Plenty of memory.
+  memory_manager_.SetTotalGpuMemory(1024 * 1024 * 1024);
+  Manage();
+  EXPECT_TRUE(IsAllocationForegroundForSurfaceYes(stub1.allocation_));
+  EXPECT_GT(stub1.allocation_.gpu_resource_size_in_bytes,
+            static_cast<size_t>(GpuMemoryManager::kMinimumAllocationForTab));
+  EXPECT_TRUE(stub2.allocation_.suggest_have_frontbuffer);
+  EXPECT_EQ(static_cast<size_t>(GpuMemoryManager::kMinimumAllocationForTab),
+            stub2.allocation_.gpu_resource_size_in_bytes);
+  EXPECT_EQ(static_cast<size_t>(GpuMemoryManager::kMinimumAllocationForTab),
+            stub3.allocation_.gpu_resource_size_in_bytes);
+
+  // Little memory: the older background stub has to discard everything.
+  memory_manager_.SetTotalGpuMemory(
+      4 * GpuMemoryManager::kMinimumAllocationForTab);
+  Manage();
+  EXPECT_TRUE(IsAllocationForegroundForSurfaceYes(stub1.allocation_));
+  EXPECT_GT(stub2.allocation_.gpu_resource_size_in_bytes, 0u);
+  EXPECT_LT(stub2.allocation_.gpu_resource_size_in_bytes,
+            static_cast<size_t>(GpuMemoryManager::kMinimumAllocationForTab));
+  EXPECT_TRUE(IsAllocationBackgroundForSurfaceYes(stub3.allocation_));
+}
@@ -237,7 +237,8 @@ PassThroughImageTransportSurface::PassThroughImageTransportSurface(
     bool transport)
     : GLSurfaceAdapter(surface),
       transport_(transport),
-      did_set_swap_interval_(false) {
+      did_set_swap_interval_(false),
+      waiting_for_swap_ack_(false) {
   helper_.reset(new ImageTransportHelper(this,
                                          manager,
                                          stub,
@@ -266,8 +267,7 @@ bool PassThroughImageTransportSurface::SwapBuffers() {
     params.size = GetSize();
 #endif
     helper_->SendAcceleratedSurfaceBuffersSwapped(params);
-
-    helper_->SetScheduled(false);
+    DidSwap();
   }
   return result;
 }
@@ -286,8 +286,7 @@ bool PassThroughImageTransportSurface::PostSubBuffer(
     params.width = width;
     params.height = height;
     helper_->SendAcceleratedSurfacePostSubBuffer(params);
-
-    helper_->SetScheduled(false);
+    DidSwap();
   }
   return result;
 }
@@ -307,12 +306,12 @@ void PassThroughImageTransportSurface::OnNewSurfaceACK(
 
 void PassThroughImageTransportSurface::OnBuffersSwappedACK() {
   DCHECK(transport_);
-  helper_->SetScheduled(true);
+  DidReceiveSwapACK();
 }
 
 void PassThroughImageTransportSurface::OnPostSubBufferACK() {
   DCHECK(transport_);
-  helper_->SetScheduled(true);
+  DidReceiveSwapACK();
 }
 
 void PassThroughImageTransportSurface::OnResizeViewACK() {
@@ -335,4 +334,33 @@ void PassThroughImageTransportSurface::OnResize(gfx::Size size) {
 
 PassThroughImageTransportSurface::~PassThroughImageTransportSurface() {}
 
+void PassThroughImageTransportSurface::DidSwap() {
+  pending_swaps_.push(base::TimeTicks::Now());
+  TRACE_COUNTER_ID1("gpu", "PendingSwapACKs", this,
+                    static_cast<int>(pending_swaps_.size()));
+
+  if (pending_swaps_.size() > kMaxPendingSwapACKs && !waiting_for_swap_ack_) {
+    waiting_for_swap_ack_ = true;
+    helper_->SetScheduled(false);
+  }
+}
+
+void PassThroughImageTransportSurface::DidReceiveSwapACK() {
+  DCHECK(!pending_swaps_.empty());
+  if (pending_swaps_.empty())
+    return;
+
+  base::TimeDelta latency = base::TimeTicks::Now() - pending_swaps_.front();
+  pending_swaps_.pop();
+  TRACE_EVENT_INSTANT1("gpu", "SwapACK", "latency_us",
+                       static_cast<int>(latency.InMicroseconds()));
+  TRACE_COUNTER_ID1("gpu", "PendingSwapACKs", this,
+                    static_cast<int>(pending_swaps_.size()));
+
+  if (waiting_for_swap_ack_ && pending_swaps_.size() <= kMaxPendingSwapACKs) {
+    waiting_for_swap_ack_ = false;
+    helper_->SetScheduled(true);
+  }
+}
+
 #endif  // defined(ENABLE_GPU)
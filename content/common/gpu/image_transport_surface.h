@@ -8,6 +8,7 @@
 
 #if defined(ENABLE_GPU)
 
+#include <queue>
 #include <vector>
 
 #include "base/callback.h"
@@ -15,6 +16,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
+#include "base/time.h"
 #include "ipc/ipc_channel.h"
 #include "ipc/ipc_message.h"
 #include "ui/gfx/gl/gl_surface.h"
@@ -178,11 +180,31 @@ class PassThroughImageTransportSurface
   virtual ~PassThroughImageTransportSurface();
 
  private:
+  // Number of frames whose swap the browser has not acknowledged yet that
+  // the client may run ahead by. The frame has already been presented when
+  // the swap message is sent, so the acknowledgment only throttles the
+  // client, and waiting for every frame's one stalls the pipeline whenever
+  // the browser is a little late.
+  static const size_t kMaxPendingSwapACKs = 1;
+
+  // Tells the browser that a frame was presented, and stops the client if it
+  // has run too far ahead of the browser.
+  void DidSwap();
+
+  // Called when the browser has acknowledged a swap or sub buffer post.
+  void DidReceiveSwapACK();
+
   scoped_ptr<ImageTransportHelper> helper_;
   gfx::Size new_size_;
   bool transport_;
   bool did_set_swap_interval_;
 
+  // When the swaps that the browser has not acknowledged yet were sent.
+  std::queue<base::TimeTicks> pending_swaps_;
+
+  // Whether the client is descheduled until a swap is acknowledged.
+  bool waiting_for_swap_ack_;
+
   DISALLOW_COPY_AND_ASSIGN(PassThroughImageTransportSurface);
 };
 
@@ -254,6 +254,7 @@ URLFetcherCore::URLFetcherCore(URLFetcher* fetcher,
           base::MessageLoopProxy::current()),
       request_(NULL),
       load_flags_(net::LOAD_NORMAL),
+      priority_(net::LOWEST),
       response_code_(URLFetcher::RESPONSE_CODE_INVALID),
       buffer_(new net::IOBuffer(kBufferSize)),
       url_request_data_key_(NULL),
@@ -374,6 +375,10 @@ int URLFetcherCore::GetLoadFlags() const {
   return load_flags_;
 }
 
+void URLFetcherCore::SetPriority(net::RequestPriority priority) {
+  priority_ = priority;
+}
+
 void URLFetcherCore::SetReferrer(const std::string& referrer) {
   referrer_ = referrer;
 }
@@ -731,6 +736,7 @@ void URLFetcherCore::StartURLRequest() {
   if (is_chunked_upload_)
     request_->EnableChunkedUpload();
   request_->set_load_flags(flags);
+  request_->set_priority(priority_);
   request_->set_context(request_context_getter_->GetURLRequestContext());
   request_->set_referrer(referrer_);
   request_->set_first_party_for_cookies(first_party_for_cookies_.is_empty() ?
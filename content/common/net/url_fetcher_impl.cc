@@ -79,6 +79,10 @@ int URLFetcherImpl::GetLoadFlags() const {
   return core_->GetLoadFlags();
 }
 
+void URLFetcherImpl::SetPriority(net::RequestPriority priority) {
+  core_->SetPriority(priority);
+}
+
 void URLFetcherImpl::SetExtraRequestHeaders(
     const std::string& extra_request_headers) {
   core_->SetExtraRequestHeaders(extra_request_headers);
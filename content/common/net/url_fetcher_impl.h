@@ -45,6 +45,7 @@ class CONTENT_EXPORT URLFetcherImpl : public content::URLFetcher {
                                    bool is_last_chunk) OVERRIDE;
   virtual void SetLoadFlags(int load_flags) OVERRIDE;
   virtual int GetLoadFlags() const OVERRIDE;
+  virtual void SetPriority(net::RequestPriority priority) OVERRIDE;
   virtual void SetReferrer(const std::string& referrer) OVERRIDE;
   virtual void SetExtraRequestHeaders(
       const std::string& extra_request_headers) OVERRIDE;
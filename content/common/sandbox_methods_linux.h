@@ -19,6 +19,7 @@ class LinuxSandbox {
     METHOD_GET_STYLE_FOR_STRIKE = 35,
     METHOD_MAKE_SHARED_MEMORY_SEGMENT = 36,
     METHOD_MATCH_WITH_FALLBACK = 37,
+    METHOD_GET_GLOBAL_PID = 38,
   };
 };
 
@@ -13,6 +13,7 @@
 #include "base/logging.h"
 #include "base/pickle.h"
 #include "base/stl_util.h"
+#include "build/build_config.h"
 
 // static
 bool UnixDomainSocket::SendMsg(int fd,
@@ -52,9 +53,30 @@ ssize_t UnixDomainSocket::RecvMsg(int fd,
                                   void* buf,
                                   size_t length,
                                   std::vector<int>* fds) {
+  return RecvMsgWithPid(fd, buf, length, fds, NULL);
+}
+
+// static
+bool UnixDomainSocket::EnableReceiveProcessId(int fd) {
+#if defined(OS_LINUX)
+  const int enable = 1;
+  return setsockopt(fd, SOL_SOCKET, SO_PASSCRED, &enable, sizeof(enable)) == 0;
+#else
+  return false;
+#endif
+}
+
+// static
+ssize_t UnixDomainSocket::RecvMsgWithPid(int fd,
+                                         void* buf,
+                                         size_t length,
+                                         std::vector<int>* fds,
+                                         base::ProcessId* pid) {
   static const unsigned kMaxDescriptors = 16;
 
   fds->clear();
+  if (pid)
+    *pid = -1;
 
   struct msghdr msg;
   memset(&msg, 0, sizeof(msg));
@@ -62,7 +84,14 @@ ssize_t UnixDomainSocket::RecvMsg(int fd,
   msg.msg_iov = &iov;
   msg.msg_iovlen = 1;
 
+  // Leave room for the sender's credentials, which the kernel adds to every
+  // message once EnableReceiveProcessId() has been called.
+#if defined(OS_LINUX)
+  char control_buffer[CMSG_SPACE(sizeof(int) * kMaxDescriptors) +
+                      CMSG_SPACE(sizeof(struct ucred))];
+#else
   char control_buffer[CMSG_SPACE(sizeof(int) * kMaxDescriptors)];
+#endif
   msg.msg_control = control_buffer;
   msg.msg_controllen = sizeof(control_buffer);
 
@@ -82,8 +111,15 @@ ssize_t UnixDomainSocket::RecvMsg(int fd,
         DCHECK(payload_len % sizeof(int) == 0);
         wire_fds = reinterpret_cast<int*>(CMSG_DATA(cmsg));
         wire_fds_len = payload_len / sizeof(int);
-        break;
       }
+#if defined(OS_LINUX)
+      if (cmsg->cmsg_level == SOL_SOCKET &&
+          cmsg->cmsg_type == SCM_CREDENTIALS && pid) {
+        const struct ucred* cred =
+            reinterpret_cast<struct ucred*>(CMSG_DATA(cmsg));
+        *pid = cred->pid;
+      }
+#endif
     }
   }
 
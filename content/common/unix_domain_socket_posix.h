@@ -10,6 +10,7 @@
 #include <sys/types.h>
 #include <vector>
 
+#include "base/process.h"
 #include "content/common/content_export.h"
 
 class Pickle;
@@ -30,6 +31,19 @@ class CONTENT_EXPORT UnixDomainSocket {
                          size_t length,
                          std::vector<int>* fds);
 
+  // Makes every message received on |fd| carry the PID of the process that
+  // sent it, as seen from this process's PID namespace. Returns true on
+  // success; only supported on Linux.
+  static bool EnableReceiveProcessId(int fd);
+
+  // Like RecvMsg, but also sets |pid| to the PID of the sending process, or
+  // to -1 if EnableReceiveProcessId() wasn't called on |fd|.
+  static ssize_t RecvMsgWithPid(int fd,
+                                void* msg,
+                                size_t length,
+                                std::vector<int>* fds,
+                                base::ProcessId* pid);
+
   // Perform a sendmsg/recvmsg pair.
   //   1. This process creates a UNIX DGRAM socketpair.
   //   2. This proces writes a request to |fd| with an SCM_RIGHTS control
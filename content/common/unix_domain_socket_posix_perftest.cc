@@ -0,0 +1,106 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times spawning children the way the zygote does inside the SUID sandbox,
+// where each child's PID has to be found as the browser sees it.
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "base/eintr_wrapper.h"
+#include "base/linux_util.h"
+#include "base/perftimer.h"
+#include "content/common/unix_domain_socket_posix.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kSpawnCount = 200;
+
+class UnixDomainSocketSpawnPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds_));
+  }
+
+  virtual void TearDown() OVERRIDE {
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+
+  // Forks a child which holds a fresh socket, as the zygote's children do,
+  // and sends one message on fds_[0] before exiting.
+  pid_t SpawnChild(ino_t* socket_inode) {
+    const int dummy_fd = socket(PF_UNIX, SOCK_DGRAM, 0);
+    EXPECT_GE(dummy_fd, 0);
+    EXPECT_TRUE(base::FileDescriptorGetInode(socket_inode, dummy_fd));
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+      std::vector<int> empty;
+      char ping = 0;
+      UnixDomainSocket::SendMsg(fds_[0], &ping, sizeof(ping), empty);
+      // Hold the socket until the parent has found us.
+      char ack;
+      HANDLE_EINTR(read(fds_[0], &ack, sizeof(ack)));
+      _exit(0);
+    }
+    close(dummy_fd);
+    return pid;
+  }
+
+  void ReapChild(pid_t pid) {
+    char ack = 0;
+    HANDLE_EINTR(write(fds_[1], &ack, sizeof(ack)));
+    HANDLE_EINTR(waitpid(pid, NULL, 0));
+  }
+
+  int fds_[2];
+};
+
+}  // namespace
+
+// Finds each child by scanning /proc for its socket, as the setuid sandbox
+// binary does for METHOD_GET_CHILD_WITH_INODE.
+TEST_F(UnixDomainSocketSpawnPerfTest, InodeLookup) {
+  PerfTimeLogger logger("UnixDomainSocketSpawnPerfTest.InodeLookup");
+  for (int i = 0; i < kSpawnCount; ++i) {
+    ino_t inode;
+    const pid_t child = SpawnChild(&inode);
+    ASSERT_GT(child, 0);
+
+    char buf[1];
+    std::vector<int> fds;
+    ASSERT_EQ(1, UnixDomainSocket::RecvMsg(fds_[1], buf, sizeof(buf), &fds));
+    pid_t found_pid = 0;
+    EXPECT_TRUE(base::FindProcessHoldingSocket(&found_pid, inode));
+    EXPECT_EQ(child, found_pid);
+    ReapChild(child);
+  }
+}
+
+// Takes each child's PID from the credentials the kernel attaches to its
+// message, as the sandbox host does for METHOD_GET_GLOBAL_PID.
+TEST_F(UnixDomainSocketSpawnPerfTest, ReceiveProcessId) {
+  ASSERT_TRUE(UnixDomainSocket::EnableReceiveProcessId(fds_[1]));
+
+  PerfTimeLogger logger("UnixDomainSocketSpawnPerfTest.ReceiveProcessId");
+  for (int i = 0; i < kSpawnCount; ++i) {
+    ino_t inode;
+    const pid_t child = SpawnChild(&inode);
+    ASSERT_GT(child, 0);
+
+    char buf[1];
+    std::vector<int> fds;
+    base::ProcessId sender_pid;
+    ASSERT_EQ(1, UnixDomainSocket::RecvMsgWithPid(fds_[1], buf, sizeof(buf),
+                                                  &fds, &sender_pid));
+    EXPECT_EQ(child, sender_pid);
+    ReapChild(child);
+  }
+}
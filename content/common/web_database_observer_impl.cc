@@ -7,6 +7,7 @@
 #include "base/metrics/histogram.h"
 #include "base/string16.h"
 #include "content/common/database_messages.h"
+#include "content/common/database_util.h"
 #include "third_party/sqlite/sqlite3.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/WebDatabase.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebString.h"
@@ -82,8 +83,11 @@ void WebDatabaseObserverImpl::databaseOpened(
 
 void WebDatabaseObserverImpl::databaseModified(
     const WebDatabase& database) {
+  string16 origin_identifier = database.securityOrigin().databaseIdentifier();
+  string16 database_name = database.name();
+  DatabaseUtil::InvalidateDatabaseFileInfo(origin_identifier, database_name);
   sender_->Send(new DatabaseHostMsg_Modified(
-      database.securityOrigin().databaseIdentifier(), database.name()));
+      origin_identifier, database_name));
 }
 
 void WebDatabaseObserverImpl::databaseClosed(
@@ -54,6 +54,11 @@ class CONTENT_EXPORT ResourceDispatcherHost {
   // redirected cross-site and needs to be resumed by a new render view.
   virtual void MarkAsTransferredNavigation(net::URLRequest* request) = 0;
 
+  // Controls whether images, prefetches and the requests of hidden tabs wait
+  // while more important requests are in flight. Enabled by default; must be
+  // set before any request is made.
+  virtual void SetResourceSchedulingEnabled(bool enabled) = 0;
+
  protected:
   virtual ~ResourceDispatcherHost() {}
 };
@@ -202,17 +202,17 @@ struct ParamTraits<net::UploadData::Element> {
     WriteParam(m, static_cast<int>(p.type()));
     switch (p.type()) {
       case net::UploadData::TYPE_BYTES: {
-        m->WriteData(&p.bytes()[0], static_cast<int>(p.bytes().size()));
+        m->WriteData(p.bytes(), static_cast<int>(p.bytes_length()));
         break;
       }
       case net::UploadData::TYPE_CHUNK: {
         std::string chunk_length = StringPrintf(
-            "%X\r\n", static_cast<unsigned int>(p.bytes().size()));
+            "%X\r\n", static_cast<unsigned int>(p.bytes_length()));
         std::vector<char> bytes;
         bytes.insert(bytes.end(), chunk_length.data(),
                      chunk_length.data() + chunk_length.length());
-        const char* data = &p.bytes()[0];
-        bytes.insert(bytes.end(), data, data + p.bytes().size());
+        const char* data = p.bytes();
+        bytes.insert(bytes.end(), data, data + p.bytes_length());
         const char* crlf = "\r\n";
         bytes.insert(bytes.end(), crlf, crlf + strlen(crlf));
         if (p.is_last_chunk()) {
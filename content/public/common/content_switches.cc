@@ -459,6 +459,10 @@ const char kPpapiPluginLauncher[]           = "ppapi-plugin-launcher";
 // Argument to the process type that indicates a PPAPI plugin process type.
 const char kPpapiPluginProcess[]            = "ppapi";
 
+// The number of idle sandboxed PPAPI plugin processes to keep launched, so
+// that starting a plugin doesn't wait for a new process. None by default.
+const char kPpapiPluginProcessPoolSize[]    = "ppapi-plugin-process-pool-size";
+
 // Causes the PPAPI sub process to display a dialog on launch.
 const char kPpapiStartupDialog[]            = "ppapi-startup-dialog";
 
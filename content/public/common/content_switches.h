@@ -144,6 +144,7 @@ CONTENT_EXPORT extern const char kPpapiFlashVersion[];
 CONTENT_EXPORT extern const char kPpapiOutOfProcess[];
 extern const char kPpapiPluginLauncher[];
 CONTENT_EXPORT extern const char kPpapiPluginProcess[];
+extern const char kPpapiPluginProcessPoolSize[];
 extern const char kPpapiStartupDialog[];
 extern const char kProcessPerSite[];
 CONTENT_EXPORT extern const char kProcessPerTab[];
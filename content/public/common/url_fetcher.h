@@ -12,6 +12,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/platform_file.h"
 #include "content/common/content_export.h"
+#include "net/base/request_priority.h"
 
 class FilePath;
 class GURL;
@@ -134,6 +135,10 @@ class CONTENT_EXPORT URLFetcher {
   // Returns the current load flags.
   virtual int GetLoadFlags() const = 0;
 
+  // Sets the priority of the request.  Fetches default to net::LOWEST, like
+  // other URLRequests.  Must be called before the request is started.
+  virtual void SetPriority(net::RequestPriority priority) = 0;
+
   // The referrer URL for the request. Must be called before the request is
   // started.
   virtual void SetReferrer(const std::string& referrer) = 0;
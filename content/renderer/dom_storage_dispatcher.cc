@@ -0,0 +1,195 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/renderer/dom_storage_dispatcher.h"
+
+#include <map>
+#include <string>
+
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/string_number_conversions.h"
+#include "content/common/dom_storage_messages.h"
+#include "content/renderer/render_thread_impl.h"
+#include "googleurl/src/gurl.h"
+#include "webkit/dom_storage/dom_storage_cached_area.h"
+#include "webkit/dom_storage/dom_storage_proxy.h"
+
+using dom_storage::DomStorageCachedArea;
+using dom_storage::DomStorageProxy;
+using dom_storage::ValuesMap;
+
+// Sends the cached areas' requests to the browser, and keeps track of the
+// cached areas which are open.
+class DomStorageDispatcher::ProxyImpl : public DomStorageProxy {
+ public:
+  ProxyImpl() : next_operation_id_(1) {}
+
+  scoped_refptr<DomStorageCachedArea> OpenCachedArea(
+      int64 namespace_id, const GURL& origin);
+  void CloseCachedArea(DomStorageCachedArea* area);
+  DomStorageCachedArea* LookupCachedArea(
+      int64 namespace_id, const GURL& origin);
+
+  void CompleteOperation(int operation_id, bool success);
+
+  // DomStorageProxy interface for use by DomStorageCachedArea.
+  virtual void LoadArea(int connection_id, ValuesMap* values) OVERRIDE;
+  virtual void SetItem(int connection_id, const string16& key,
+                       const string16& value, const GURL& page_url,
+                       const CompletionCallback& callback) OVERRIDE;
+  virtual void RemoveItem(int connection_id, const string16& key,
+                          const GURL& page_url,
+                          const CompletionCallback& callback) OVERRIDE;
+  virtual void ClearArea(int connection_id,
+                         const GURL& page_url,
+                         const CompletionCallback& callback) OVERRIDE;
+
+ private:
+  // A cached area and the number of connections it is open for.
+  struct CachedAreaHolder {
+    scoped_refptr<DomStorageCachedArea> area;
+    int open_count;
+    CachedAreaHolder() : open_count(0) {}
+  };
+  typedef std::map<std::string, CachedAreaHolder> CachedAreaMap;
+
+  virtual ~ProxyImpl() {}
+
+  static std::string GetCachedAreaKey(int64 namespace_id,
+                                      const GURL& origin) {
+    return base::Int64ToString(namespace_id) + origin.spec();
+  }
+
+  // Returns the id to send with an operation, to look up |callback| with
+  // when the browser completes it.
+  int AddCallback(const CompletionCallback& callback);
+
+  CachedAreaMap cached_areas_;
+  std::map<int, CompletionCallback> pending_callbacks_;
+  int next_operation_id_;
+};
+
+scoped_refptr<DomStorageCachedArea>
+DomStorageDispatcher::ProxyImpl::OpenCachedArea(
+    int64 namespace_id, const GURL& origin) {
+  CachedAreaHolder& holder =
+      cached_areas_[GetCachedAreaKey(namespace_id, origin)];
+  if (!holder.area)
+    holder.area = new DomStorageCachedArea(namespace_id, origin, this);
+  ++holder.open_count;
+  return holder.area;
+}
+
+void DomStorageDispatcher::ProxyImpl::CloseCachedArea(
+    DomStorageCachedArea* area) {
+  CachedAreaMap::iterator found = cached_areas_.find(
+      GetCachedAreaKey(area->namespace_id(), area->origin()));
+  DCHECK(found != cached_areas_.end());
+  DCHECK_EQ(area, found->second.area.get());
+  if (--found->second.open_count == 0)
+    cached_areas_.erase(found);
+}
+
+DomStorageCachedArea* DomStorageDispatcher::ProxyImpl::LookupCachedArea(
+    int64 namespace_id, const GURL& origin) {
+  CachedAreaMap::const_iterator found = cached_areas_.find(
+      GetCachedAreaKey(namespace_id, origin));
+  if (found == cached_areas_.end())
+    return NULL;
+  return found->second.area.get();
+}
+
+void DomStorageDispatcher::ProxyImpl::CompleteOperation(
+    int operation_id, bool success) {
+  std::map<int, CompletionCallback>::iterator found =
+      pending_callbacks_.find(operation_id);
+  if (found == pending_callbacks_.end())
+    return;
+  CompletionCallback callback = found->second;
+  pending_callbacks_.erase(found);
+  callback.Run(success);
+}
+
+void DomStorageDispatcher::ProxyImpl::LoadArea(int connection_id,
+                                               ValuesMap* values) {
+  RenderThreadImpl::current()->Send(
+      new DOMStorageHostMsg_LoadStorageArea(connection_id, values));
+}
+
+void DomStorageDispatcher::ProxyImpl::SetItem(
+    int connection_id, const string16& key, const string16& value,
+    const GURL& page_url, const CompletionCallback& callback) {
+  RenderThreadImpl::current()->Send(new DOMStorageHostMsg_SetItemAsync(
+      connection_id, AddCallback(callback), key, value, page_url));
+}
+
+void DomStorageDispatcher::ProxyImpl::RemoveItem(
+    int connection_id, const string16& key, const GURL& page_url,
+    const CompletionCallback& callback) {
+  RenderThreadImpl::current()->Send(new DOMStorageHostMsg_RemoveItemAsync(
+      connection_id, AddCallback(callback), key, page_url));
+}
+
+void DomStorageDispatcher::ProxyImpl::ClearArea(
+    int connection_id, const GURL& page_url,
+    const CompletionCallback& callback) {
+  RenderThreadImpl::current()->Send(new DOMStorageHostMsg_ClearAsync(
+      connection_id, AddCallback(callback), page_url));
+}
+
+int DomStorageDispatcher::ProxyImpl::AddCallback(
+    const CompletionCallback& callback) {
+  int operation_id = next_operation_id_++;
+  pending_callbacks_[operation_id] = callback;
+  return operation_id;
+}
+
+DomStorageDispatcher::DomStorageDispatcher()
+    : proxy_(new ProxyImpl()) {
+}
+
+DomStorageDispatcher::~DomStorageDispatcher() {
+}
+
+scoped_refptr<DomStorageCachedArea> DomStorageDispatcher::OpenCachedArea(
+    int connection_id, int64 namespace_id, const GURL& origin) {
+  RenderThreadImpl::current()->Send(
+      new DOMStorageHostMsg_OpenStorageArea(
+          connection_id, namespace_id, origin));
+  return proxy_->OpenCachedArea(namespace_id, origin);
+}
+
+void DomStorageDispatcher::CloseCachedArea(
+    int connection_id, DomStorageCachedArea* area) {
+  RenderThreadImpl::current()->Send(
+      new DOMStorageHostMsg_CloseStorageArea(connection_id));
+  proxy_->CloseCachedArea(area);
+}
+
+void DomStorageDispatcher::OnStorageEvent(
+    const DOMStorageMsg_Event_Params& params) {
+  // Changes made in this process have already been applied to its cache.
+  if (params.connection_id)
+    return;
+  DomStorageCachedArea* cached_area = proxy_->LookupCachedArea(
+      params.namespace_id, params.origin);
+  if (cached_area)
+    cached_area->ApplyMutation(params.key, params.new_value);
+}
+
+bool DomStorageDispatcher::OnMessageReceived(const IPC::Message& msg) {
+  bool handled = true;
+  IPC_BEGIN_MESSAGE_MAP(DomStorageDispatcher, msg)
+    IPC_MESSAGE_HANDLER(DOMStorageMsg_AsyncOperationComplete,
+                        OnAsyncOperationComplete)
+    IPC_MESSAGE_UNHANDLED(handled = false)
+  IPC_END_MESSAGE_MAP()
+  return handled;
+}
+
+void DomStorageDispatcher::OnAsyncOperationComplete(int operation_id,
+                                                    bool success) {
+  proxy_->CompleteOperation(operation_id, success);
+}
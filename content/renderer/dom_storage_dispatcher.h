@@ -0,0 +1,54 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_RENDERER_DOM_STORAGE_DISPATCHER_H_
+#define CONTENT_RENDERER_DOM_STORAGE_DISPATCHER_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+
+class GURL;
+struct DOMStorageMsg_Event_Params;
+
+namespace IPC {
+class Message;
+}
+
+namespace dom_storage {
+class DomStorageCachedArea;
+}
+
+// Holds the renderer-side caches of the DOM storage areas open in this
+// process, and keeps them in sync with the browser. Lives on the render
+// thread and is owned by RenderThreadImpl.
+class DomStorageDispatcher {
+ public:
+  DomStorageDispatcher();
+  ~DomStorageDispatcher();
+
+  // Returns the cached area for |namespace_id| and |origin|, which is shared
+  // by all the connections to it. Each call must be balanced by a call to
+  // CloseCachedArea().
+  scoped_refptr<dom_storage::DomStorageCachedArea> OpenCachedArea(
+      int connection_id, int64 namespace_id, const GURL& origin);
+  void CloseCachedArea(int connection_id,
+                       dom_storage::DomStorageCachedArea* area);
+
+  // Applies the change |params| describes to the cached area it is for.
+  void OnStorageEvent(const DOMStorageMsg_Event_Params& params);
+
+  bool OnMessageReceived(const IPC::Message& msg);
+
+ private:
+  class ProxyImpl;
+
+  void OnAsyncOperationComplete(int operation_id, bool success);
+
+  scoped_refptr<ProxyImpl> proxy_;
+
+  DISALLOW_COPY_AND_ASSIGN(DomStorageDispatcher);
+};
+
+#endif  // CONTENT_RENDERER_DOM_STORAGE_DISPATCHER_H_
@@ -4,6 +4,8 @@
 
 #include "content/renderer/media/audio_device.h"
 
+#include <algorithm>
+
 #include "base/debug/trace_event.h"
 #include "base/message_loop.h"
 #include "base/threading/thread_restrictions.h"
@@ -12,11 +14,16 @@
 #include "content/common/media/audio_messages.h"
 #include "content/common/view_messages.h"
 #include "content/renderer/render_thread_impl.h"
+#include "media/audio/audio_buffer_ring.h"
 #include "media/audio/audio_output_controller.h"
 #include "media/audio/audio_util.h"
 
 using media::AudioRendererSink;
 
+// The amount of audio queued in the shared memory ring by default. It covers
+// a short descheduling of the audio thread without adding noticeable latency.
+static const int kTargetQueuedAudioMs = 20;
+
 // Takes care of invoking the render callback on the audio thread.
 // An instance of this class is created for each capture stream in
 // OnStreamCreated().
@@ -26,6 +33,7 @@ class AudioDevice::AudioThreadCallback
   AudioThreadCallback(const media::AudioParameters& audio_parameters,
                       base::SharedMemoryHandle memory,
                       int memory_length,
+                      int buffer_depth,
                       AudioRendererSink::RenderCallback* render_callback);
   virtual ~AudioThreadCallback();
 
@@ -35,7 +43,15 @@ class AudioDevice::AudioThreadCallback
   virtual void Process(int pending_data) OVERRIDE;
 
  private:
+  // Renders a buffer into |dest| and returns the number of bytes written.
+  uint32 RenderBuffer(void* dest, int pending_bytes);
+
   AudioRendererSink::RenderCallback* render_callback_;
+  const int buffer_depth_;
+
+  // The buffers queued for the browser. NULL if the buffer size does not
+  // allow for a ring, in which case a single buffer is handed over at a time.
+  scoped_ptr<media::AudioBufferRing> ring_;
   DISALLOW_COPY_AND_ASSIGN(AudioThreadCallback);
 };
 
@@ -43,6 +59,7 @@ AudioDevice::AudioDevice()
     : ScopedLoopObserver(ChildProcess::current()->io_message_loop()),
       callback_(NULL),
       volume_(1.0),
+      buffer_depth_(0),
       stream_id_(0),
       play_on_start_(true),
       is_started_(false) {
@@ -55,6 +72,7 @@ AudioDevice::AudioDevice(const media::AudioParameters& params,
       audio_parameters_(params),
       callback_(callback),
       volume_(1.0),
+      buffer_depth_(0),
       stream_id_(0),
       play_on_start_(true),
       is_started_(false) {
@@ -124,6 +142,14 @@ void AudioDevice::GetVolume(double* volume) {
   *volume = volume_;
 }
 
+void AudioDevice::SetBufferDepth(int depth) {
+  CHECK_EQ(0, stream_id_) <<
+      "AudioDevice::SetBufferDepth() must be called before Start()";
+  DCHECK_GE(depth, 1);
+  DCHECK_LE(depth, static_cast<int>(media::AudioBufferRing::kMaxDepth));
+  buffer_depth_ = depth;
+}
+
 void AudioDevice::CreateStreamOnIOThread(const media::AudioParameters& params) {
   DCHECK(message_loop()->BelongsToCurrentThread());
   // Make sure we don't create the stream more than once.
@@ -233,7 +259,7 @@ void AudioDevice::OnStreamCreated(
 
   DCHECK(audio_thread_.IsStopped());
   audio_callback_.reset(new AudioDevice::AudioThreadCallback(audio_parameters_,
-      handle, length, callback_));
+      handle, length, buffer_depth_, callback_));
   audio_thread_.Start(audio_callback_.get(), socket_handle, "AudioDevice");
 
   // We handle the case where Play() and/or Pause() may have been called
@@ -258,9 +284,11 @@ AudioDevice::AudioThreadCallback::AudioThreadCallback(
     const media::AudioParameters& audio_parameters,
     base::SharedMemoryHandle memory,
     int memory_length,
+    int buffer_depth,
     media::AudioRendererSink::RenderCallback* render_callback)
     : AudioDeviceThread::Callback(audio_parameters, memory, memory_length),
-      render_callback_(render_callback) {
+      render_callback_(render_callback),
+      buffer_depth_(buffer_depth) {
 }
 
 AudioDevice::AudioThreadCallback::~AudioThreadCallback() {
@@ -268,19 +296,56 @@ AudioDevice::AudioThreadCallback::~AudioThreadCallback() {
 
 void AudioDevice::AudioThreadCallback::MapSharedMemory() {
   shared_memory_.Map(media::TotalSharedMemorySizeInBytes(memory_length_));
+
+  ring_.reset(media::CreateAudioBufferRing(&shared_memory_, memory_length_));
+  if (!ring_.get())
+    return;
+
+  int depth = buffer_depth_;
+  if (!depth) {
+    int buffer_ms_times_rate = audio_parameters_.frames_per_buffer() *
+        base::Time::kMillisecondsPerSecond;
+    depth = (kTargetQueuedAudioMs * audio_parameters_.sample_rate() +
+             buffer_ms_times_rate - 1) / buffer_ms_times_rate;
+  }
+  depth = std::max(1, std::min(depth,
+      static_cast<int>(media::AudioBufferRing::kMaxDepth)));
+  ring_->SetDepth(depth);
 }
 
 // Called whenever we receive notifications about pending data.
 void AudioDevice::AudioThreadCallback::Process(int pending_data) {
+  if (ring_.get()) {
+    // The browser drops the queued buffers itself when it pauses.
+    if (pending_data == media::AudioOutputController::kPauseMark)
+      return;
+
+    // Top up the ring; usually a single buffer was read since the last call.
+    while (ring_->CanWrite()) {
+      uint32 size = RenderBuffer(ring_->GetWriteBuffer(),
+                                 pending_data + ring_->queued_bytes());
+      ring_->CommitWrite(size);
+    }
+    return;
+  }
+
   if (pending_data == media::AudioOutputController::kPauseMark) {
     memset(shared_memory_.memory(), 0, memory_length_);
     media::SetActualDataSizeInBytes(&shared_memory_, memory_length_, 0);
     return;
   }
 
+  uint32 size = RenderBuffer(shared_memory_.memory(), pending_data);
+
+  // Let the host know we are done.
+  media::SetActualDataSizeInBytes(&shared_memory_, memory_length_, size);
+}
+
+uint32 AudioDevice::AudioThreadCallback::RenderBuffer(void* dest,
+                                                      int pending_bytes) {
   // Convert the number of pending bytes in the render buffer
   // into milliseconds.
-  int audio_delay_milliseconds = pending_data / bytes_per_ms_;
+  int audio_delay_milliseconds = pending_bytes / bytes_per_ms_;
 
   TRACE_EVENT0("audio", "AudioDevice::FireRenderCallback");
 
@@ -291,11 +356,9 @@ void AudioDevice::AudioThreadCallback::Process(int pending_data) {
   // Interleave, scale, and clip to int.
   // TODO(crogers/vrk): Figure out a way to avoid the float -> int -> float
   // conversions that happen in the <audio> and WebRTC scenarios.
-  media::InterleaveFloatToInt(audio_data_, shared_memory_.memory(),
+  media::InterleaveFloatToInt(audio_data_, dest,
       audio_parameters_.frames_per_buffer(),
       audio_parameters_.bits_per_sample() / 8);
 
-  // Let the host know we are done.
-  media::SetActualDataSizeInBytes(&shared_memory_, memory_length_,
-      num_frames * audio_parameters_.GetBytesPerFrame());
+  return num_frames * audio_parameters_.GetBytesPerFrame();
 }
@@ -102,6 +102,12 @@ class CONTENT_EXPORT AudioDevice
   virtual bool SetVolume(double volume) OVERRIDE;
   virtual void GetVolume(double* volume) OVERRIDE;
 
+  // Sets the number of buffers rendered ahead of the browser's reads, between
+  // 1 and media::AudioBufferRing::kMaxDepth. More buffers survive longer
+  // stalls of the audio thread at the cost of latency. By default about
+  // 20 ms of audio is queued. Must be called before Start().
+  void SetBufferDepth(int depth);
+
   // Methods called on IO thread ----------------------------------------------
   // AudioMessageFilter::Delegate methods, called by AudioMessageFilter.
   virtual void OnStateChanged(AudioStreamState state) OVERRIDE;
@@ -138,6 +144,9 @@ class CONTENT_EXPORT AudioDevice
   // The current volume scaling [0.0, 1.0] of the audio stream.
   double volume_;
 
+  // The number of buffers to queue, or 0 to choose it from the buffer size.
+  int buffer_depth_;
+
   // Cached audio message filter (lives on the main render thread).
   scoped_refptr<AudioMessageFilter> filter_;
 
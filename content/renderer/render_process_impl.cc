@@ -34,6 +34,14 @@
 #include "base/mac/mac_util.h"
 #endif
 
+namespace {
+
+// Transport DIBs are allocated in multiples of this size, so that a paint
+// slightly larger than the last, as when scrolling, can reuse its DIB.
+const size_t kTransportDIBSizeGranularity = 64 * 1024;
+
+}  // namespace
+
 RenderProcessImpl::RenderProcessImpl()
     : ALLOW_THIS_IN_INITIALIZER_LIST(shared_mem_cache_cleaner_(
           FROM_HERE, base::TimeDelta::FromSeconds(5),
@@ -165,7 +173,11 @@ skia::PlatformCanvas* RenderProcessImpl::GetDrawingCanvas(
   const size_t size = height * stride;
 
   if (!GetTransportDIBFromCache(memory, size)) {
-    *memory = CreateTransportDIB(size);
+    size_t alloc_size = (size + kTransportDIBSizeGranularity - 1) /
+        kTransportDIBSizeGranularity * kTransportDIBSizeGranularity;
+    if (max_size != 0 && alloc_size > max_size)
+      alloc_size = size;
+    *memory = CreateTransportDIB(alloc_size);
     if (!*memory)
       return NULL;
   }
@@ -188,17 +200,24 @@ bool RenderProcessImpl::UseInProcessPlugins() const {
 
 bool RenderProcessImpl::GetTransportDIBFromCache(TransportDIB** mem,
                                              size_t size) {
-  // look for a cached object that is suitable for the requested size.
+  // look for the smallest cached object that is suitable for the requested
+  // size, leaving larger ones for larger paints.
+  int best_index = -1;
   for (size_t i = 0; i < arraysize(shared_mem_cache_); ++i) {
     if (shared_mem_cache_[i] &&
-        size <= shared_mem_cache_[i]->size()) {
-      *mem = shared_mem_cache_[i];
-      shared_mem_cache_[i] = NULL;
-      return true;
+        size <= shared_mem_cache_[i]->size() &&
+        (best_index == -1 ||
+         shared_mem_cache_[i]->size() <
+             shared_mem_cache_[best_index]->size())) {
+      best_index = i;
     }
   }
+  if (best_index == -1)
+    return false;
 
-  return false;
+  *mem = shared_mem_cache_[best_index];
+  shared_mem_cache_[best_index] = NULL;
+  return true;
 }
 
 int RenderProcessImpl::FindFreeCacheSlot(size_t size) {
@@ -213,7 +232,7 @@ int RenderProcessImpl::FindFreeCacheSlot(size_t size) {
   size_t smallest_size = size;
   int smallest_index = -1;
 
-  for (size_t i = 1; i < arraysize(shared_mem_cache_); ++i) {
+  for (size_t i = 0; i < arraysize(shared_mem_cache_); ++i) {
     const size_t entry_size = shared_mem_cache_[i]->size();
     if (entry_size < smallest_size) {
       smallest_size = entry_size;
@@ -36,7 +36,7 @@ class RenderProcessImpl : public RenderProcess {
   static bool InProcessPlugins();
 
  private:
-  // Look in the shared memory cache for a suitable object to reuse.
+  // Look in the shared memory cache for the smallest suitable object to reuse.
   //   result: (output) the memory found
   //   size: the resulting memory will be >= this size, in bytes
   //   returns: false if a suitable DIB memory could not be found
@@ -47,6 +47,7 @@
 #include "content/public/renderer/render_process_observer.h"
 #include "content/public/renderer/render_view_visitor.h"
 #include "content/renderer/devtools_agent_filter.h"
+#include "content/renderer/dom_storage_dispatcher.h"
 #include "content/renderer/gpu/compositor_thread.h"
 #include "content/renderer/media/audio_input_message_filter.h"
 #include "content/renderer/media/audio_message_filter.h"
@@ -82,6 +83,7 @@
 #include "ui/base/ui_base_switches.h"
 #include "v8/include/v8.h"
 #include "webkit/glue/webkit_glue.h"
+#include "webkit/media/buffered_resource_loader.h"
 
 // TODO(port)
 #if !defined(OS_WIN)
@@ -210,6 +212,7 @@ void RenderThreadImpl::Init() {
   compositor_initialized_ = false;
 
   appcache_dispatcher_.reset(new AppCacheDispatcher(Get()));
+  dom_storage_dispatcher_.reset(new DomStorageDispatcher());
   main_thread_indexed_db_dispatcher_.reset(new IndexedDBDispatcher());
 
   media_stream_center_ = NULL;
@@ -443,6 +446,7 @@ void RenderThreadImpl::WidgetHidden() {
 void RenderThreadImpl::WidgetRestored() {
   DCHECK_GT(hidden_widget_count_, 0);
   hidden_widget_count_--;
+  webkit_media::BufferedResourceLoader::SetLowMemory(false);
   if (!content::GetContentClient()->renderer()->
           RunIdleHandlerWhenWidgetsHidden()) {
     return;
@@ -638,6 +642,10 @@ void RenderThreadImpl::IdleHandler() {
 
   base::allocator::ReleaseFreeMemory();
 
+  // Every widget is hidden, so give back the media read-ahead buffers until
+  // one is shown again.
+  webkit_media::BufferedResourceLoader::SetLowMemory(true);
+
   v8::V8::IdleNotification();
 
   // Schedule next invocation.
@@ -808,6 +816,9 @@ void RenderThreadImpl::OnSetZoomLevelForCurrentURL(const std::string& host,
 
 void RenderThreadImpl::OnDOMStorageEvent(
     const DOMStorageMsg_Event_Params& params) {
+  // Update the cached area first, so listeners see the new value.
+  dom_storage_dispatcher_->OnStorageEvent(params);
+
   EnsureWebKitInitialized();
 
   bool originated_in_process = params.connection_id != 0;
@@ -855,6 +866,8 @@ bool RenderThreadImpl::OnControlMessageReceived(const IPC::Message& msg) {
   // Some messages are handled by delegates.
   if (appcache_dispatcher_->OnMessageReceived(msg))
     return true;
+  if (dom_storage_dispatcher_->OnMessageReceived(msg))
+    return true;
 
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(RenderThreadImpl, msg)
@@ -64,6 +64,7 @@
 #include "content/renderer/input_tag_speech_dispatcher.h"
 #include "content/renderer/java/java_bridge_dispatcher.h"
 #include "content/renderer/load_progress_tracker.h"
+#include "content/renderer/media/audio_hardware.h"
 #include "content/renderer/media/audio_message_filter.h"
 #include "content/renderer/media/media_stream_dependency_factory.h"
 #include "content/renderer/media/media_stream_dispatcher.h"
@@ -2223,9 +2224,16 @@ WebMediaPlayer* RenderViewImpl::createMediaPlayer(
     audio_source_provider = new RenderAudioSourceProvider();
 
     // Add the chrome specific audio renderer, using audio_source_provider
-    // as the sink.
+    // as the sink. The audio is converted to the hardware sample rate here
+    // so that the browser can play it through the low latency path.
+    media::AudioParameters hardware_params(
+        media::AudioParameters::AUDIO_PCM_LOW_LATENCY,
+        CHANNEL_LAYOUT_STEREO,
+        audio_hardware::GetOutputSampleRate(),
+        16,
+        audio_hardware::GetOutputBufferSize());
     media::AudioRendererImpl* audio_renderer =
-        new media::AudioRendererImpl(audio_source_provider);
+        new media::AudioRendererImpl(audio_source_provider, hardware_params);
     collection->AddAudioRenderer(audio_renderer);
   }
 
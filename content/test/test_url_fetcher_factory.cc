@@ -35,6 +35,7 @@ TestURLFetcher::TestURLFetcher(int id,
       delegate_(d),
       did_receive_last_chunk_(false),
       fake_load_flags_(0),
+      fake_priority_(net::LOWEST),
       fake_response_code_(-1),
       fake_response_destination_(STRING),
       fake_was_fetched_via_proxy_(false),
@@ -67,6 +68,10 @@ int TestURLFetcher::GetLoadFlags() const {
   return fake_load_flags_;
 }
 
+void TestURLFetcher::SetPriority(net::RequestPriority priority) {
+  fake_priority_ = priority;
+}
+
 void TestURLFetcher::SetReferrer(const std::string& referrer) {
 }
 
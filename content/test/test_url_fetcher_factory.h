@@ -72,6 +72,7 @@ class TestURLFetcher : public content::URLFetcher {
                                    bool is_last_chunk) OVERRIDE;
   virtual void SetLoadFlags(int load_flags) OVERRIDE;
   virtual int GetLoadFlags() const OVERRIDE;
+  virtual void SetPriority(net::RequestPriority priority) OVERRIDE;
   virtual void SetReferrer(const std::string& referrer) OVERRIDE;
   virtual void SetExtraRequestHeaders(
       const std::string& extra_request_headers) OVERRIDE;
@@ -126,6 +127,9 @@ class TestURLFetcher : public content::URLFetcher {
   // Returns the delegate installed on the URLFetcher.
   content::URLFetcherDelegate* delegate() const { return delegate_; }
 
+  // Returns the priority set on the URLFetcher.
+  net::RequestPriority priority() const { return fake_priority_; }
+
   void set_url(const GURL& url) { fake_url_ = url; }
   void set_status(const net::URLRequestStatus& status);
   void set_response_code(int response_code) {
@@ -160,6 +164,7 @@ class TestURLFetcher : public content::URLFetcher {
   // has no setters. The data is a private member of a class defined
   // in a .cc file, so we can't get at it with friendship.
   int fake_load_flags_;
+  net::RequestPriority fake_priority_;
   GURL fake_url_;
   net::URLRequestStatus fake_status_;
   int fake_response_code_;
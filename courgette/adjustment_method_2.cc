@@ -13,9 +13,11 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/compiler_specific.h"
 #include "base/format_macros.h"
 #include "base/logging.h"
 #include "base/stringprintf.h"
+#include "base/threading/simple_thread.h"
 #include "base/time.h"
 #include "courgette/assembly_program.h"
 #include "courgette/courgette.h"
@@ -1220,6 +1222,31 @@ class AssignmentProblem {
   DISALLOW_COPY_AND_ASSIGN(AssignmentProblem);
 };
 
+// Solves the AssignmentProblem of one trace.  The abs32 and rel32 traces
+// refer to disjoint sets of labels and LabelInfos, so their problems are
+// solved on separate threads.
+class TraceSolver : public base::DelegateSimpleThread::Delegate {
+ public:
+  TraceSolver(const Trace& trace, size_t model_end)
+      : trace_(trace),
+        model_end_(model_end) {
+  }
+
+  virtual void Run() OVERRIDE {
+    base::Time start_time = base::Time::Now();
+    AssignmentProblem a(trace_, model_end_);
+    a.Solve();
+    VLOG(1) << " Adjuster::Solve "
+            << (base::Time::Now() - start_time).InSecondsF();
+  }
+
+ private:
+  const Trace& trace_;
+  size_t model_end_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceSolver);
+};
+
 class Adjuster : public AdjustmentMethod {
  public:
   Adjuster() : prog_(NULL), model_(NULL) {}
@@ -1240,8 +1267,17 @@ class Adjuster : public AdjustmentMethod {
     size_t abs32_model_end = abs32_trace_.size();
     size_t rel32_model_end = rel32_trace_.size();
     CollectTraces(prog_,  &abs32_trace_,  &rel32_trace_,  false);
-    Solve(abs32_trace_, abs32_model_end);
-    Solve(rel32_trace_, rel32_model_end);
+
+    // The rel32 trace is usually the bigger one, so it is solved on this
+    // thread while the abs32 trace is solved on another.
+    TraceSolver abs32_solver(abs32_trace_, abs32_model_end);
+    TraceSolver rel32_solver(rel32_trace_, rel32_model_end);
+    base::DelegateSimpleThread abs32_thread(&abs32_solver,
+                                            "CourgetteAbs32Solver");
+    abs32_thread.Start();
+    rel32_solver.Run();
+    abs32_thread.Join();
+
     prog_->AssignRemainingIndexes();
     return true;
   }
@@ -1265,14 +1301,6 @@ class Adjuster : public AdjustmentMethod {
     // single-occurrence labels.
   }
 
-  void Solve(const Trace& model, size_t model_end) {
-    base::Time start_time = base::Time::Now();
-    AssignmentProblem a(model, model_end);
-    a.Solve();
-    VLOG(1) << " Adjuster::Solve "
-            << (base::Time::Now() - start_time).InSecondsF();
-  }
-
   void ReferenceLabel(Trace* trace, Label* label, bool is_model) {
     trace->push_back(
         label_info_maker_.MakeLabelInfo(label, is_model,
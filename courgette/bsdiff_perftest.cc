@@ -0,0 +1,124 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures the time and memory bsdiff takes per MB of old file, and the time
+// the suffix sort and the CRC take on their own.
+
+#include "courgette/third_party/bsdiff.h"
+
+#include <string>
+
+#include "base/format_macros.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/perftimer.h"
+#include "base/process_util.h"
+#include "base/stringprintf.h"
+#include "courgette/base_test_unittest.h"
+#include "courgette/crc.h"
+#include "courgette/streams.h"
+#include "courgette/suffix_array.h"
+#include "courgette/third_party/paged_array.h"
+
+namespace {
+
+const size_t kMB = 1024 * 1024;
+
+// Returns the high water mark of the working set of this process, in bytes.
+size_t GetPeakWorkingSetSize() {
+#if defined(OS_MACOSX)
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle(), NULL));
+#else
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle()));
+#endif
+  return metrics->GetPeakWorkingSetSize();
+}
+
+class BSDiffPerfTest : public BaseTest {
+ protected:
+  // Returns |length| bytes that look a little like code: runs of a repeated
+  // pattern interleaved with noise.
+  std::string GenerateSyntheticInput(size_t length, int seed) const {
+    std::string result;
+    result.reserve(length);
+    unsigned int state = seed;
+    while (result.length() < length) {
+      state = state * 1103515245 + 12345;
+      if (result.length() % 1024 < 512)
+        result.push_back("\x8b\x45\x08\x89\x04\x24\xe8"[result.length() % 7]);
+      else
+        result.push_back(static_cast<char>(state >> 16));
+    }
+    return result;
+  }
+
+  // Logs the time and the growth of the peak working set per MB of
+  // |old_text| of creating a patch from |old_text| to |new_text|.
+  void TimePatch(const std::string& name, const std::string& old_text,
+                 const std::string& new_text) {
+    courgette::SourceStream old_stream;
+    courgette::SourceStream new_stream;
+    old_stream.Init(old_text.c_str(), old_text.length());
+    new_stream.Init(new_text.c_str(), new_text.length());
+    courgette::SinkStream patch;
+
+    size_t peak_before = GetPeakWorkingSetSize();
+    PerfTimer timer;
+    EXPECT_EQ(courgette::OK,
+              courgette::CreateBinaryPatch(&old_stream, &new_stream, &patch));
+    base::TimeDelta elapsed = timer.Elapsed();
+    size_t peak_after = GetPeakWorkingSetSize();
+
+    double megabytes = static_cast<double>(old_text.length()) / kMB;
+    LogPerfResult((name + "_time_per_mb").c_str(),
+                  elapsed.InMillisecondsF() / megabytes, "ms");
+    LogPerfResult((name + "_peak_memory_per_mb").c_str(),
+                  (static_cast<double>(peak_after) - peak_before) / kMB /
+                      megabytes,
+                  "mb");
+  }
+};
+
+// Runs from the smallest input up, so that each size can raise the peak.
+TEST_F(BSDiffPerfTest, SyntheticInputs) {
+  const size_t kSizes[] = { 1 * kMB, 4 * kMB, 16 * kMB };
+  for (size_t i = 0; i < arraysize(kSizes); ++i) {
+    std::string old_text = GenerateSyntheticInput(kSizes[i], 0);
+    std::string new_text = GenerateSyntheticInput(kSizes[i], 1);
+    TimePatch(base::StringPrintf("BSDiff_synthetic_%" PRIuS "mb",
+                                 kSizes[i] / kMB),
+              old_text, new_text);
+  }
+}
+
+TEST_F(BSDiffPerfTest, DifferentExes) {
+  TimePatch("BSDiff_setup_exe", FileContents("setup1.exe"),
+            FileContents("setup2.exe"));
+}
+
+TEST_F(BSDiffPerfTest, SuffixSort) {
+  std::string text = GenerateSyntheticInput(16 * kMB, 0);
+  courgette::PagedArray<int> suffix_array;
+  ASSERT_TRUE(suffix_array.Allocate(text.length() + 1));
+  PerfTimer timer;
+  courgette::BuildSuffixArray(reinterpret_cast<const uint8*>(text.data()),
+                              static_cast<int>(text.length()), &suffix_array);
+  LogPerfResult("BSDiff_suffix_sort_time_per_mb",
+                timer.Elapsed().InMillisecondsF() / 16, "ms");
+}
+
+TEST_F(BSDiffPerfTest, Crc) {
+  std::string text = GenerateSyntheticInput(16 * kMB, 0);
+  PerfTimer timer;
+  uint32 crc = courgette::CalculateCrc(
+      reinterpret_cast<const uint8*>(text.data()), text.length());
+  LogPerfResult("BSDiff_crc_time_per_mb",
+                timer.Elapsed().InMillisecondsF() / 16, "ms");
+  EXPECT_NE(0U, crc);
+}
+
+}  // namespace
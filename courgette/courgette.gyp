@@ -39,6 +39,8 @@
       'simple_delta.h',
       'streams.cc',
       'streams.h',
+      'suffix_array.cc',
+      'suffix_array.h',
       'types_elf.h',
       'types_win_pe.h',
       'patch_generator_x86_32.h',
@@ -51,7 +53,6 @@
       'type': 'static_library',
       'dependencies': [
         '../base/base.gyp:base',
-        '../third_party/lzma_sdk/lzma_sdk.gyp:lzma_sdk',
       ],
       'sources': [
         '<@(courgette_lib_sources)'
@@ -92,6 +93,7 @@
         'bsdiff_memory_unittest.cc',
         'base_test_unittest.cc',
         'base_test_unittest.h',
+        'crc_unittest.cc',
         'difference_estimator_unittest.cc',
         'disassembler_elf_32_x86_unittest.cc',
         'disassembler_win32_x86_unittest.cc',
@@ -100,6 +102,7 @@
         'ensemble_unittest.cc',
         'run_all_unittests.cc',
         'streams_unittest.cc',
+        'suffix_array_unittest.cc',
         'versioning_unittest.cc',
         'third_party/paged_array_unittest.cc'
       ],
@@ -122,6 +125,34 @@
         }],
       ],
     },
+    {
+      'target_name': 'courgette_perftests',
+      'type': 'executable',
+      'sources': [
+        'base_test_unittest.cc',
+        'base_test_unittest.h',
+        'bsdiff_perftest.cc',
+      ],
+      'dependencies': [
+        'courgette_lib',
+        '../base/base.gyp:base',
+        '../base/base.gyp:base_i18n',
+        '../base/base.gyp:test_support_base',
+        '../base/base.gyp:test_support_perf',
+        '../testing/gtest.gyp:gtest',
+      ],
+      'conditions': [
+        [ 'toolkit_uses_gtk == 1', {
+          'dependencies': [
+            # Workaround for gyp bug 69.
+            # Needed to handle the #include chain:
+            #   base/test_suite.h
+            #   gtk/gtk.h
+            '../build/linux/system.gyp:gtk',
+          ],
+        }],
+      ],
+    },
     {
       'target_name': 'courgette_fuzz',
       'type': 'executable',
@@ -158,7 +189,6 @@
           'type': 'static_library',
           'dependencies': [
             '../base/base.gyp:base_nacl_win64',
-            '../third_party/lzma_sdk/lzma_sdk.gyp:lzma_sdk64',
           ],
           'sources': [
             '<@(courgette_lib_sources)',
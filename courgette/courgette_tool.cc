@@ -10,9 +10,11 @@
 #include "base/command_line.h"
 #include "base/file_path.h"
 #include "base/file_util.h"
+#include "base/format_macros.h"
 #include "base/logging.h"
 #include "base/string_number_conversions.h"
 #include "base/string_util.h"
+#include "base/time.h"
 #include "base/utf_string_conversions.h"
 #include "courgette/third_party/bsdiff.h"
 #include "courgette/courgette.h"
@@ -309,11 +311,16 @@ void GenerateEnsemblePatch(const FilePath& old_file,
   new_stream.Init(new_buffer);
 
   courgette::SinkStream patch_stream;
+  base::TimeTicks start_time = base::TimeTicks::Now();
   courgette::Status status =
       courgette::GenerateEnsemblePatch(&old_stream, &new_stream, &patch_stream);
 
   if (status != courgette::C_OK) Problem("-gen failed.");
 
+  fprintf(stderr, "Generated %" PRIuS " byte patch in %.2fs.\n",
+          patch_stream.Length(),
+          (base::TimeTicks::Now() - start_time).InSecondsF());
+
   WriteSinkToFile(&patch_stream, patch_file);
 }
 
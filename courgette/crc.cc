@@ -1,4 +1,4 @@
-// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
@@ -7,15 +7,76 @@
 #ifdef COURGETTE_USE_CRC_LIB
 #  include "zlib.h"
 #else
-extern "C" {
-#  include "third_party/lzma_sdk/7zCrc.h"
-}
+#  include <string.h>
+#  include "base/lazy_instance.h"
+#  include "build/build_config.h"
 #endif
 
 #include "base/basictypes.h"
 
 namespace courgette {
 
+#ifndef COURGETTE_USE_CRC_LIB
+
+namespace {
+
+const uint32 kCrcPolynomial = 0xEDB88320;
+
+// Tables for the 'slicing-by-8' CRC32, which consumes eight bytes per step.
+// tables_[0] is the usual byte-at-a-time table, and tables_[k][b] is the CRC
+// of byte |b| followed by |k| zero bytes.
+class CrcTables {
+ public:
+  CrcTables() {
+    for (uint32 i = 0; i < 256; ++i) {
+      uint32 r = i;
+      for (int j = 0; j < 8; ++j)
+        r = (r >> 1) ^ (kCrcPolynomial & ~((r & 1) - 1));
+      tables_[0][i] = r;
+    }
+    for (uint32 i = 0; i < 256; ++i) {
+      for (int k = 1; k < 8; ++k) {
+        uint32 r = tables_[k - 1][i];
+        tables_[k][i] = (r >> 8) ^ tables_[0][r & 0xFF];
+      }
+    }
+  }
+
+  uint32 Update(uint32 crc, const uint8* buffer, size_t size) const {
+#if defined(ARCH_CPU_LITTLE_ENDIAN)
+    for (; size >= 8; size -= 8, buffer += 8) {
+      uint32 low;
+      uint32 high;
+      memcpy(&low, buffer, sizeof(low));
+      memcpy(&high, buffer + 4, sizeof(high));
+      low ^= crc;
+      crc = tables_[7][low & 0xFF] ^
+            tables_[6][(low >> 8) & 0xFF] ^
+            tables_[5][(low >> 16) & 0xFF] ^
+            tables_[4][low >> 24] ^
+            tables_[3][high & 0xFF] ^
+            tables_[2][(high >> 8) & 0xFF] ^
+            tables_[1][(high >> 16) & 0xFF] ^
+            tables_[0][high >> 24];
+    }
+#endif
+    for (; size > 0; --size, ++buffer)
+      crc = tables_[0][(crc ^ *buffer) & 0xFF] ^ (crc >> 8);
+    return crc;
+  }
+
+ private:
+  uint32 tables_[8][256];
+
+  DISALLOW_COPY_AND_ASSIGN(CrcTables);
+};
+
+base::LazyInstance<CrcTables>::Leaky g_crc_tables = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+#endif  // COURGETTE_USE_CRC_LIB
+
 uint32 CalculateCrc(const uint8* buffer, size_t size) {
   uint32 crc;
 
@@ -23,9 +84,7 @@ uint32 CalculateCrc(const uint8* buffer, size_t size) {
   // Calculate Crc by calling CRC method in zlib
   crc = crc32(0, buffer, size);
 #else
-  // Calculate Crc by calling CRC method in LZMA SDK
-  CrcGenerateTable();
-  crc = CrcCalc(buffer, size);
+  crc = g_crc_tables.Get().Update(0xFFFFFFFF, buffer, size) ^ 0xFFFFFFFF;
 #endif
 
   return ~crc;
@@ -9,7 +9,7 @@
 
 namespace courgette {
 
-// Calculates Crc of the given buffer by calling CRC method in LZMA SDK
+// Calculates the bitwise complement of the CRC-32 of the given buffer.
 //
 uint32 CalculateCrc(const uint8* buffer, size_t size);
 
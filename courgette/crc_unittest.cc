@@ -0,0 +1,46 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "courgette/crc.h"
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+uint32 ByteAtATimeCrc(const uint8* buffer, size_t size) {
+  uint32 crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= buffer[i];
+    for (int j = 0; j < 8; ++j)
+      crc = (crc >> 1) ^ (0xEDB88320 & ~((crc & 1) - 1));
+  }
+  return crc ^ 0xFFFFFFFF;
+}
+
+}  // namespace
+
+TEST(CrcTest, KnownValue) {
+  const char kCheck[] = "123456789";
+  EXPECT_EQ(~0xCBF43926U,
+            courgette::CalculateCrc(reinterpret_cast<const uint8*>(kCheck),
+                                    sizeof(kCheck) - 1));
+  EXPECT_EQ(~0U, courgette::CalculateCrc(NULL, 0));
+}
+
+// Every alignment and tail length gives the same result as the byte at a time
+// algorithm.
+TEST(CrcTest, MatchesByteAtATime) {
+  std::string data;
+  for (int i = 0; i < 100; ++i)
+    data.push_back(static_cast<char>(i * 37 + 11));
+  const uint8* buffer = reinterpret_cast<const uint8*>(data.data());
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t size = 0; offset + size <= data.size(); ++size) {
+      EXPECT_EQ(~ByteAtATimeCrc(buffer + offset, size),
+                courgette::CalculateCrc(buffer + offset, size));
+    }
+  }
+}
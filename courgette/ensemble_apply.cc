@@ -6,7 +6,10 @@
 
 #include "courgette/ensemble.h"
 
+#include <stdio.h>
+
 #include "base/basictypes.h"
+#include "base/file_path.h"
 #include "base/file_util.h"
 #include "base/logging.h"
 
@@ -49,6 +52,11 @@ class EnsemblePatchApplication {
   Status TransformDown(SourceStreamSet* transformed_elements,
                        SinkStream* basic_elements);
 
+  // Like TransformDown, but writes the blob to |file_path| one element at a
+  // time, so that it never has to be held in memory.
+  Status TransformDownToFile(SourceStreamSet* transformed_elements,
+                             const FilePath& file_path);
+
   Status SubpatchFinalOutput(SourceStream* original,
                              SourceStream* correction,
                              SinkStream* corrected_ensemble);
@@ -257,6 +265,44 @@ Status EnsemblePatchApplication::TransformDown(
   return C_OK;
 }
 
+Status EnsemblePatchApplication::TransformDownToFile(
+    SourceStreamSet* transformed_elements,
+    const FilePath& file_path) {
+  file_util::ScopedFILE file(file_util::OpenFile(file_path, "wb"));
+  if (!file.get())
+    return C_WRITE_OPEN_ERROR;
+
+  // The original input, straight from its mapping:
+  if (fwrite(base_region_.start(), 1, base_region_.length(), file.get()) !=
+      base_region_.length())
+    return C_WRITE_ERROR;
+
+  for (size_t i = 0;  i < patchers_.size();  ++i) {
+    SourceStreamSet single_corrected_element;
+    if (!transformed_elements->ReadSet(&single_corrected_element))
+      return C_STREAM_ERROR;
+    SinkStream reformed_element;
+    Status status = patchers_[i]->Reform(&single_corrected_element,
+                                         &reformed_element);
+    if (status != C_OK)
+      return status;
+    if (!single_corrected_element.Empty())
+      return C_STREAM_NOT_CONSUMED;
+    if (fwrite(reformed_element.Buffer(), 1, reformed_element.Length(),
+               file.get()) != reformed_element.Length())
+      return C_WRITE_ERROR;
+  }
+
+  if (!transformed_elements->Empty())
+    return C_STREAM_NOT_CONSUMED;
+  corrected_elements_storage_.Retire();
+
+  if (fclose(file.release()) != 0)
+    return C_WRITE_ERROR;
+
+  return C_OK;
+}
+
 Status EnsemblePatchApplication::SubpatchFinalOutput(
     SourceStream* original,
     SourceStream* correction,
@@ -298,9 +344,13 @@ Status EnsemblePatchApplication::SubpatchStreamSets(
   return C_OK;
 }
 
-Status ApplyEnsemblePatch(SourceStream* base,
-                          SourceStream* patch,
-                          SinkStream* output) {
+// Applies |patch| to |base|.  If |scratch_file_path| is not empty, the
+// prediction of the final output, which is bigger than |base|, is built in
+// that file and read back through a mapping rather than built in memory.
+Status ApplyEnsemblePatchInternal(SourceStream* base,
+                                  SourceStream* patch,
+                                  const FilePath& scratch_file_path,
+                                  SinkStream* output) {
   Status status;
   EnsemblePatchApplication patch_process;
 
@@ -356,14 +406,26 @@ Status ApplyEnsemblePatch(SourceStream* base,
     return status;
 
   SinkStream original_ensemble_and_corrected_base_elements;
-  status = patch_process.TransformDown(
-      &corrected_transformed_elements,
-      &original_ensemble_and_corrected_base_elements);
-  if (status != C_OK)
-    return status;
-
+  file_util::MemoryMappedFile mapped_prediction;
   SourceStream final_patch_prediction;
-  final_patch_prediction.Init(original_ensemble_and_corrected_base_elements);
+  if (scratch_file_path.empty()) {
+    status = patch_process.TransformDown(
+        &corrected_transformed_elements,
+        &original_ensemble_and_corrected_base_elements);
+    if (status != C_OK)
+      return status;
+    final_patch_prediction.Init(original_ensemble_and_corrected_base_elements);
+  } else {
+    status = patch_process.TransformDownToFile(
+        &corrected_transformed_elements, scratch_file_path);
+    if (status != C_OK)
+      return status;
+    if (!mapped_prediction.Initialize(scratch_file_path))
+      return C_READ_ERROR;
+    final_patch_prediction.Init(mapped_prediction.data(),
+                                mapped_prediction.length());
+  }
+
   status = patch_process.SubpatchFinalOutput(&final_patch_prediction,
                                              ensemble_correction, output);
   if (status != C_OK)
@@ -372,6 +434,12 @@ Status ApplyEnsemblePatch(SourceStream* base,
   return C_OK;
 }
 
+Status ApplyEnsemblePatch(SourceStream* base,
+                          SourceStream* patch,
+                          SinkStream* output) {
+  return ApplyEnsemblePatchInternal(base, patch, FilePath(), output);
+}
+
 Status ApplyEnsemblePatch(const FilePath::CharType* old_file_name,
                           const FilePath::CharType* patch_file_name,
                           const FilePath::CharType* new_file_name) {
@@ -396,19 +464,28 @@ Status ApplyEnsemblePatch(const FilePath::CharType* old_file_name,
   if (!old_file.Initialize(old_file_path))
     return C_READ_ERROR;
 
+  // The prediction of the new file is built in a scratch file next to it,
+  // so that the old file, the patch and the prediction are all mapped files
+  // and only the new file is held in memory.
+  FilePath new_file_path(new_file_name);
+  FilePath scratch_file_path;
+  if (!file_util::CreateTemporaryFileInDir(new_file_path.DirName(),
+                                           &scratch_file_path))
+    return C_WRITE_OPEN_ERROR;
+
   // Apply patch on streams.
   SourceStream old_source_stream;
   SourceStream patch_source_stream;
   old_source_stream.Init(old_file.data(), old_file.length());
   patch_source_stream.Init(patch_file.data(), patch_file.length());
   SinkStream new_sink_stream;
-  status = ApplyEnsemblePatch(&old_source_stream, &patch_source_stream,
-                              &new_sink_stream);
+  status = ApplyEnsemblePatchInternal(&old_source_stream, &patch_source_stream,
+                                      scratch_file_path, &new_sink_stream);
+  file_util::Delete(scratch_file_path, false);
   if (status != C_OK)
     return status;
 
   // Write the patched data to |new_file_name|.
-  FilePath new_file_path(new_file_name);
   int written =
       file_util::WriteFile(
           new_file_path,
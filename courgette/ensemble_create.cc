@@ -14,11 +14,16 @@
 
 #include "courgette/ensemble.h"
 
+#include <algorithm>
 #include <vector>
 #include <limits>
 
 #include "base/basictypes.h"
+#include "base/compiler_specific.h"
 #include "base/logging.h"
+#include "base/memory/scoped_vector.h"
+#include "base/sys_info.h"
+#include "base/threading/simple_thread.h"
 #include "base/time.h"
 
 #include "courgette/third_party/bsdiff.h"
@@ -220,6 +225,68 @@ void FreeGenerators(std::vector<TransformationPatchGenerator*>* generators) {
   generators->clear();
 }
 
+// Each Transform holds the disassembled old and new programs of its elements,
+// which for big elements are several times the size of the elements, so the
+// number of Transforms running at once is bounded to bound the peak memory.
+// Big allocations are backed by temporary files (see MemoryAllocator).
+const int kMaxParallelTransforms = 4;
+
+// Runs the Transform step of one generator.  The Transform of each element
+// only reads the ensembles and writes its own streams, so the elements are
+// transformed in parallel.
+class TransformTask : public base::DelegateSimpleThread::Delegate {
+ public:
+  explicit TransformTask(TransformationPatchGenerator* generator)
+      : generator_(generator),
+        status_(C_OK) {
+  }
+
+  virtual void Run() OVERRIDE {
+    status_ = generator_->Transform(&parameters_,
+                                    &predicted_transformed_element_,
+                                    &corrected_transformed_element_);
+  }
+
+  SourceStreamSet* parameters() { return &parameters_; }
+  SinkStreamSet* predicted_transformed_element() {
+    return &predicted_transformed_element_;
+  }
+  SinkStreamSet* corrected_transformed_element() {
+    return &corrected_transformed_element_;
+  }
+  Status status() const { return status_; }
+
+ private:
+  TransformationPatchGenerator* generator_;
+  SourceStreamSet parameters_;
+  SinkStreamSet predicted_transformed_element_;
+  SinkStreamSet corrected_transformed_element_;
+  Status status_;
+
+  DISALLOW_COPY_AND_ASSIGN(TransformTask);
+};
+
+// Runs |tasks| on up to kMaxParallelTransforms threads, one per processor.
+void RunTransformTasks(const std::vector<TransformTask*>& tasks) {
+  base::Time start_time = base::Time::Now();
+  int num_threads = std::min(base::SysInfo::NumberOfProcessors(),
+                             kMaxParallelTransforms);
+  num_threads = std::min(num_threads, static_cast<int>(tasks.size()));
+  if (num_threads <= 1) {
+    for (size_t i = 0;  i < tasks.size();  ++i)
+      tasks[i]->Run();
+  } else {
+    base::DelegateSimpleThreadPool pool("CourgetteTransform", num_threads);
+    for (size_t i = 0;  i < tasks.size();  ++i)
+      pool.AddWork(tasks[i]);
+    pool.Start();
+    pool.JoinAll();
+  }
+  VLOG(1) << "done " << tasks.size() << " Transforms on "
+          << std::max(num_threads, 1) << " threads in "
+          << (base::Time::Now() - start_time).InSecondsF() << "s";
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Status GenerateEnsemblePatch(SourceStream* base,
@@ -314,34 +381,38 @@ Status GenerateEnsemblePatch(SourceStream* base,
   if (!corrected_parameters_source_set.Init(&corrected_parameters_source))
     return C_STREAM_ERROR;
 
+  ScopedVector<TransformTask> transforms;
+  for (size_t i = 0;  i < number_of_transformations;  ++i) {
+    transforms.push_back(new TransformTask(generators[i]));
+    if (!corrected_parameters_source_set.ReadSet(transforms[i]->parameters()))
+      return C_STREAM_ERROR;
+  }
+
+  if (!corrected_parameters_source_set.Empty())
+    return C_STREAM_NOT_CONSUMED;
+
+  RunTransformTasks(transforms.get());
+
   SinkStreamSet predicted_transformed_elements;
   SinkStreamSet corrected_transformed_elements;
 
   for (size_t i = 0;  i < number_of_transformations;  ++i) {
-    SourceStreamSet single_parameters;
-    if (!corrected_parameters_source_set.ReadSet(&single_parameters))
-      return C_STREAM_ERROR;
-    SinkStreamSet single_predicted_transformed_element;
-    SinkStreamSet single_corrected_transformed_element;
-    Status status = generators[i]->Transform(
-        &single_parameters,
-        &single_predicted_transformed_element,
-        &single_corrected_transformed_element);
-    if (status != C_OK)
-      return status;
-    if (!single_parameters.Empty())
+    TransformTask* transform = transforms[i];
+    if (transform->status() != C_OK)
+      return transform->status();
+    if (!transform->parameters()->Empty())
       return C_STREAM_NOT_CONSUMED;
     if (!predicted_transformed_elements.WriteSet(
-            &single_predicted_transformed_element))
+            transform->predicted_transformed_element()))
       return C_STREAM_ERROR;
     if (!corrected_transformed_elements.WriteSet(
-            &single_corrected_transformed_element))
+            transform->corrected_transformed_element()))
       return C_STREAM_ERROR;
+    // Free the streams of this element now they have been copied.
+    delete transform;
+    transforms[i] = NULL;
   }
 
-  if (!corrected_parameters_source_set.Empty())
-    return C_STREAM_NOT_CONSUMED;
-
   SinkStream linearized_predicted_transformed_elements;
   SinkStream linearized_corrected_transformed_elements;
 
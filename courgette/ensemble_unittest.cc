@@ -2,6 +2,9 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/scoped_temp_dir.h"
 #include "courgette/base_test_unittest.h"
 #include "courgette/courgette.h"
 #include "courgette/streams.h"
@@ -67,6 +70,50 @@ void EnsembleTest::PeEnsemble() const {
   TestEnsemble(src_bytes, tgt_bytes);
 }
 
+// The file based ApplyEnsemblePatch builds its intermediate output in a
+// scratch file rather than in memory.
+TEST_F(EnsembleTest, ApplyToFiles) {
+  std::string src_bytes = FileContents("elf-32-1");
+  std::string tgt_bytes = FileContents("elf-32-2");
+
+  courgette::SourceStream source;
+  courgette::SourceStream target;
+  source.Init(src_bytes);
+  target.Init(tgt_bytes);
+  courgette::SinkStream patch_sink;
+  EXPECT_EQ(courgette::C_OK,
+            courgette::GenerateEnsemblePatch(&source, &target, &patch_sink));
+
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath old_path = temp_dir.path().AppendASCII("old");
+  FilePath patch_path = temp_dir.path().AppendASCII("patch");
+  FilePath new_path = temp_dir.path().AppendASCII("new");
+  ASSERT_EQ(static_cast<int>(src_bytes.size()),
+            file_util::WriteFile(old_path, src_bytes.data(),
+                                 src_bytes.size()));
+  ASSERT_EQ(static_cast<int>(patch_sink.Length()),
+            file_util::WriteFile(
+                patch_path,
+                reinterpret_cast<const char*>(patch_sink.Buffer()),
+                patch_sink.Length()));
+
+  EXPECT_EQ(courgette::C_OK,
+            courgette::ApplyEnsemblePatch(old_path.value().c_str(),
+                                          patch_path.value().c_str(),
+                                          new_path.value().c_str()));
+
+  std::string new_bytes;
+  ASSERT_TRUE(file_util::ReadFileToString(new_path, &new_bytes));
+  EXPECT_EQ(tgt_bytes, new_bytes);
+
+  // The scratch file is gone once the patch has been applied.
+  file_util::Delete(old_path, false);
+  file_util::Delete(patch_path, false);
+  file_util::Delete(new_path, false);
+  EXPECT_TRUE(file_util::IsDirectoryEmpty(temp_dir.path()));
+}
+
 TEST_F(EnsembleTest, DISABLED_All) {
   // TODO(dgarrett) http://code.google.com/p/chromium/issues/detail?id=101614
   PeEnsemble();
@@ -0,0 +1,211 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "courgette/suffix_array.h"
+
+#include <vector>
+
+#include "base/logging.h"
+
+namespace courgette {
+
+namespace {
+
+// A window onto |array| starting at |offset|.  The reduced problem of each
+// level of the recursion, and its suffix array, live inside the suffix array
+// of the level above.
+class IntArrayView {
+ public:
+  IntArrayView(PagedArray<int>* array, size_t offset)
+      : array_(array), offset_(offset) {}
+
+  int& operator[](size_t i) const { return (*array_)[offset_ + i]; }
+
+  IntArrayView Offset(size_t offset) const {
+    return IntArrayView(array_, offset_ + offset);
+  }
+
+ private:
+  PagedArray<int>* array_;
+  size_t offset_;
+};
+
+// Presents |bytes| as a string of |size| + 1 characters over the alphabet
+// [0, 256], terminated by the unique smallest character 0.
+class ByteText {
+ public:
+  ByteText(const uint8* bytes, int size) : bytes_(bytes), size_(size) {}
+
+  int operator[](int i) const { return i == size_ ? 0 : bytes_[i] + 1; }
+
+ private:
+  const uint8* bytes_;
+  int size_;
+};
+
+// Suffix types: a suffix is S-type if it is smaller than the suffix following
+// it, and L-type otherwise.  The sentinel is S-type.
+class SuffixTypes {
+ public:
+  explicit SuffixTypes(int n) : s_type_(n) {}
+
+  bool IsSType(int i) const { return s_type_[i]; }
+  void Set(int i, bool s_type) { s_type_[i] = s_type; }
+
+  // A leftmost S-type position is an S-type position preceded by an L-type
+  // one.
+  bool IsLMS(int i) const { return i > 0 && s_type_[i] && !s_type_[i - 1]; }
+
+ private:
+  std::vector<bool> s_type_;
+};
+
+// Fills |buckets| with the start, or one past the end if |end| is true, of
+// the bucket of each character of the |n| characters of |text|.
+template <typename Text>
+void GetBuckets(const Text& text, int n, int alphabet_size, bool end,
+                std::vector<int>* buckets) {
+  buckets->assign(alphabet_size, 0);
+  for (int i = 0; i < n; ++i)
+    ++(*buckets)[text[i]];
+  int sum = 0;
+  for (int c = 0; c < alphabet_size; ++c) {
+    sum += (*buckets)[c];
+    (*buckets)[c] = end ? sum : sum - (*buckets)[c];
+  }
+}
+
+// Induces the order of the L-type suffixes from the sorted positions already
+// in |sa|, scanning left to right.
+template <typename Text>
+void InduceL(const Text& text, int n, int alphabet_size,
+             const SuffixTypes& types, const IntArrayView& sa,
+             std::vector<int>* buckets) {
+  GetBuckets(text, n, alphabet_size, false, buckets);
+  for (int i = 0; i < n; ++i) {
+    int j = sa[i] - 1;
+    if (j >= 0 && !types.IsSType(j))
+      sa[(*buckets)[text[j]]++] = j;
+  }
+}
+
+// Induces the order of the S-type suffixes, scanning right to left.
+template <typename Text>
+void InduceS(const Text& text, int n, int alphabet_size,
+             const SuffixTypes& types, const IntArrayView& sa,
+             std::vector<int>* buckets) {
+  GetBuckets(text, n, alphabet_size, true, buckets);
+  for (int i = n - 1; i >= 0; --i) {
+    int j = sa[i] - 1;
+    if (j >= 0 && types.IsSType(j))
+      sa[--(*buckets)[text[j]]] = j;
+  }
+}
+
+// Sorts the |n| suffixes of |text|, whose last character is the unique
+// smallest, into |sa|.  |n| must be at least 2.
+template <typename Text>
+void SAIS(const Text& text, int n, int alphabet_size, const IntArrayView& sa) {
+  SuffixTypes types(n);
+  types.Set(n - 1, true);
+  types.Set(n - 2, false);
+  for (int i = n - 3; i >= 0; --i) {
+    types.Set(i, text[i] < text[i + 1] ||
+                 (text[i] == text[i + 1] && types.IsSType(i + 1)));
+  }
+
+  // Stage 1: sort the LMS substrings by placing the LMS positions at the ends
+  // of their buckets and inducing the rest.
+  std::vector<int> buckets;
+  GetBuckets(text, n, alphabet_size, true, &buckets);
+  for (int i = 0; i < n; ++i)
+    sa[i] = -1;
+  for (int i = 1; i < n; ++i) {
+    if (types.IsLMS(i))
+      sa[--buckets[text[i]]] = i;
+  }
+  InduceL(text, n, alphabet_size, types, sa, &buckets);
+  InduceS(text, n, alphabet_size, types, sa, &buckets);
+
+  // Move the sorted LMS substrings to the front and name them.  No two LMS
+  // positions are adjacent, so the name of the one at |pos| can be stored at
+  // |n1| + |pos| / 2.
+  int n1 = 0;
+  for (int i = 0; i < n; ++i) {
+    if (types.IsLMS(sa[i]))
+      sa[n1++] = sa[i];
+  }
+  for (int i = n1; i < n; ++i)
+    sa[i] = -1;
+  int names = 0;
+  int previous = -1;
+  for (int i = 0; i < n1; ++i) {
+    int pos = sa[i];
+    bool different = false;
+    for (int d = 0; d < n; ++d) {
+      if (previous == -1 ||
+          text[pos + d] != text[previous + d] ||
+          types.IsSType(pos + d) != types.IsSType(previous + d)) {
+        different = true;
+        break;
+      }
+      if (d > 0 && (types.IsLMS(pos + d) || types.IsLMS(previous + d)))
+        break;
+    }
+    if (different) {
+      ++names;
+      previous = pos;
+    }
+    sa[n1 + pos / 2] = names - 1;
+  }
+  for (int i = n - 1, j = n - 1; i >= n1; --i) {
+    if (sa[i] >= 0)
+      sa[j--] = sa[i];
+  }
+
+  // Stage 2: sort the reduced string of names, recursing only if the names
+  // are not all unique.
+  IntArrayView reduced_sa = sa;
+  IntArrayView reduced_text = sa.Offset(n - n1);
+  std::vector<int>().swap(buckets);
+  if (names < n1) {
+    SAIS(reduced_text, n1, names, reduced_sa);
+  } else {
+    for (int i = 0; i < n1; ++i)
+      reduced_sa[reduced_text[i]] = i;
+  }
+
+  // Stage 3: place the sorted LMS suffixes at the ends of their buckets and
+  // induce the order of all the suffixes from them.
+  for (int i = 1, j = 0; i < n; ++i) {
+    if (types.IsLMS(i))
+      reduced_text[j++] = i;
+  }
+  for (int i = 0; i < n1; ++i)
+    reduced_sa[i] = reduced_text[reduced_sa[i]];
+  for (int i = n1; i < n; ++i)
+    sa[i] = -1;
+  GetBuckets(text, n, alphabet_size, true, &buckets);
+  for (int i = n1 - 1; i >= 0; --i) {
+    int j = sa[i];
+    sa[i] = -1;
+    sa[--buckets[text[j]]] = j;
+  }
+  InduceL(text, n, alphabet_size, types, sa, &buckets);
+  InduceS(text, n, alphabet_size, types, sa, &buckets);
+}
+
+}  // namespace
+
+void BuildSuffixArray(const uint8* text, int size,
+                      PagedArray<int>* suffix_array) {
+  DCHECK_GE(size, 0);
+  if (size == 0) {
+    (*suffix_array)[0] = 0;
+    return;
+  }
+  SAIS(ByteText(text, size), size + 1, 257, IntArrayView(suffix_array, 0));
+}
+
+}  // namespace courgette
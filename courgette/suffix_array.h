@@ -0,0 +1,26 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef COURGETTE_SUFFIX_ARRAY_H_
+#define COURGETTE_SUFFIX_ARRAY_H_
+
+#include "base/basictypes.h"
+#include "courgette/third_party/paged_array.h"
+
+namespace courgette {
+
+// Sorts the suffixes of |text| in linear time with the SA-IS algorithm of Nong,
+// Zhang and Chan, "Two Efficient Algorithms for Linear Time Suffix Array
+// Construction".  |suffix_array| must have room for |size| + 1 elements.  On
+// return suffix_array[0] is |size|, the empty suffix, and suffix_array[1..size]
+// are the starting positions of the other suffixes in lexicographic order.
+//
+// This is the same array qsufsort produces, but needs no second array of
+// |size| + 1 ranks.
+void BuildSuffixArray(const uint8* text, int size,
+                      PagedArray<int>* suffix_array);
+
+}  // namespace courgette
+
+#endif  // COURGETTE_SUFFIX_ARRAY_H_
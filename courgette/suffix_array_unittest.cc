@@ -0,0 +1,87 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "courgette/suffix_array.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Orders positions of |text| by the suffixes starting there.
+class SuffixLess {
+ public:
+  explicit SuffixLess(const std::string& text) : text_(text) {}
+
+  bool operator()(int a, int b) const {
+    return text_.compare(a, std::string::npos, text_, b, std::string::npos) < 0;
+  }
+
+ private:
+  const std::string& text_;
+};
+
+void ExpectSuffixArray(const std::string& text) {
+  int size = static_cast<int>(text.size());
+  courgette::PagedArray<int> suffix_array;
+  ASSERT_TRUE(suffix_array.Allocate(size + 1));
+  courgette::BuildSuffixArray(reinterpret_cast<const uint8*>(text.data()),
+                              size, &suffix_array);
+
+  std::vector<int> expected;
+  for (int i = 0; i <= size; ++i)
+    expected.push_back(i);
+  std::sort(expected.begin(), expected.end(), SuffixLess(text));
+
+  for (int i = 0; i <= size; ++i)
+    EXPECT_EQ(expected[i], suffix_array[i]) << "at " << i << " of " << text;
+}
+
+}  // namespace
+
+TEST(SuffixArrayTest, Empty) {
+  ExpectSuffixArray("");
+}
+
+TEST(SuffixArrayTest, SmallInputs) {
+  ExpectSuffixArray("a");
+  ExpectSuffixArray("ab");
+  ExpectSuffixArray("ba");
+  ExpectSuffixArray("banana");
+  ExpectSuffixArray("mississippi");
+  ExpectSuffixArray("abracadabra");
+}
+
+TEST(SuffixArrayTest, Repeats) {
+  ExpectSuffixArray(std::string(1000, 'x'));
+  std::string text;
+  for (int i = 0; i < 100; ++i)
+    text += "abcabd";
+  ExpectSuffixArray(text);
+}
+
+TEST(SuffixArrayTest, AllBytes) {
+  std::string text;
+  for (int i = 0; i < 3; ++i) {
+    for (int c = 255; c >= 0; --c)
+      text.push_back(static_cast<char>(c));
+  }
+  ExpectSuffixArray(text);
+}
+
+// Small alphabets give deep recursion.
+TEST(SuffixArrayTest, Synthetic) {
+  unsigned int seed = 1;
+  for (int alphabet = 2; alphabet <= 256; alphabet *= 4) {
+    std::string text;
+    for (int i = 0; i < 5000; ++i) {
+      seed = seed * 1103515245 + 12345;
+      text.push_back(static_cast<char>((seed >> 16) % alphabet));
+    }
+    ExpectSuffixArray(text);
+  }
+}
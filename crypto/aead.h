@@ -0,0 +1,75 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CRYPTO_AEAD_H_
+#define CRYPTO_AEAD_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/string_piece.h"
+#include "crypto/crypto_export.h"
+
+namespace crypto {
+
+// Simplify the interface and reduce includes by abstracting out the internals.
+struct AeadPlatformData;
+class SymmetricKey;
+
+// Authenticated encryption with associated data using AES-GCM, which
+// encrypts and authenticates in a single pass. The key is set up once by
+// Init() and reused by every Seal() and Open(), and both write into buffers
+// owned by the caller, so that encrypting a stream of messages does not
+// allocate. The underlying library uses AES-NI and carry-less multiplication
+// instructions where the CPU has them.
+class CRYPTO_EXPORT Aead {
+ public:
+  // The length of the nonce passed to Seal() and Open(). A nonce must never
+  // be used twice with the same key.
+  static const size_t kNonceLength = 12;
+  // The length of the authentication tag appended to each ciphertext.
+  static const size_t kTagLength = 16;
+
+  Aead();
+  ~Aead();
+
+  // Returns true if the crypto library Chromium was built against provides
+  // AES-GCM. NSS has it from version 3.15.
+  static bool IsSupported();
+
+  // Initializes this instance with the 128- or 256-bit AES key |key|. Call
+  // Init only once. Returns false if the key cannot be used.
+  bool Init(SymmetricKey* key) WARN_UNUSED_RESULT;
+
+  // Encrypts the |plaintext_len| bytes at |plaintext| and authenticates them
+  // together with |additional_data|, which is not encrypted. Writes the
+  // ciphertext followed by the tag to |out|, which must have room for
+  // |plaintext_len| + kTagLength bytes and may be the same as |plaintext|.
+  bool Seal(const base::StringPiece& nonce,
+            const base::StringPiece& additional_data,
+            const char* plaintext,
+            size_t plaintext_len,
+            char* out) WARN_UNUSED_RESULT;
+
+  // Checks the tag at the end of the |ciphertext_len| bytes at |ciphertext|
+  // and decrypts the rest into |out|, which must have room for
+  // |ciphertext_len| - kTagLength bytes and may be the same as |ciphertext|.
+  // Returns false, leaving the contents of |out| undefined, if the
+  // ciphertext or |additional_data| was not what Seal() authenticated.
+  bool Open(const base::StringPiece& nonce,
+            const base::StringPiece& additional_data,
+            const char* ciphertext,
+            size_t ciphertext_len,
+            char* out) WARN_UNUSED_RESULT;
+
+ private:
+  scoped_ptr<AeadPlatformData> plat_;
+
+  DISALLOW_COPY_AND_ASSIGN(Aead);
+};
+
+}  // namespace crypto
+
+#endif  // CRYPTO_AEAD_H_
@@ -0,0 +1,170 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "crypto/aead.h"
+
+#include <nss.h>
+#include <pk11pub.h>
+
+#include <string>
+
+#include "base/logging.h"
+#include "crypto/nss_util.h"
+#include "crypto/scoped_nss_types.h"
+#include "crypto/symmetric_key.h"
+
+// PK11_Encrypt() and PK11_Decrypt(), which take the per-message GCM
+// parameters, first appeared in NSS 3.15.
+#if NSS_VMAJOR > 3 || (NSS_VMAJOR == 3 && NSS_VMINOR >= 15)
+#define AEAD_HAVE_AES_GCM
+#endif
+
+namespace crypto {
+
+struct AeadPlatformData {
+  // Imported once for both directions, so that the key schedule is kept in
+  // the token between messages.
+  ScopedPK11SymKey key;
+};
+
+Aead::Aead() : plat_(new AeadPlatformData()) {
+}
+
+Aead::~Aead() {
+}
+
+#if defined(AEAD_HAVE_AES_GCM)
+
+namespace {
+
+// Fills in |params|, and |param| to point at it, for one message.
+void MakeGcmParams(const base::StringPiece& nonce,
+                   const base::StringPiece& additional_data,
+                   CK_GCM_PARAMS* params,
+                   SECItem* param) {
+  params->pIv =
+      reinterpret_cast<CK_BYTE_PTR>(const_cast<char*>(nonce.data()));
+  params->ulIvLen = nonce.size();
+  params->pAAD = reinterpret_cast<CK_BYTE_PTR>(
+      const_cast<char*>(additional_data.data()));
+  params->ulAADLen = additional_data.size();
+  params->ulTagBits = Aead::kTagLength * 8;
+
+  param->type = siBuffer;
+  param->data = reinterpret_cast<unsigned char*>(params);
+  param->len = sizeof(*params);
+}
+
+}  // namespace
+
+// static
+bool Aead::IsSupported() {
+  return true;
+}
+
+bool Aead::Init(SymmetricKey* key) {
+  DCHECK(key);
+  // Init must not be called more than once on the same Aead object.
+  DCHECK(!plat_->key.get());
+
+  EnsureNSSInit();
+  std::string raw_key;
+  if (!key->GetRawKey(&raw_key) ||
+      (raw_key.size() != 16 && raw_key.size() != 32)) {
+    return false;
+  }
+
+  ScopedPK11Slot slot(PK11_GetBestSlot(CKM_AES_GCM, NULL));
+  if (!slot.get())
+    return false;
+
+  SECItem key_item;
+  key_item.type = siBuffer;
+  key_item.data = reinterpret_cast<unsigned char*>(
+      const_cast<char*>(raw_key.data()));
+  key_item.len = raw_key.size();
+  plat_->key.reset(PK11_ImportSymKeyWithFlags(
+      slot.get(), CKM_AES_GCM, PK11_OriginUnwrap, CKA_FLAGS_ONLY, &key_item,
+      CKF_ENCRYPT | CKF_DECRYPT, PR_FALSE, NULL));
+  return plat_->key.get() != NULL;
+}
+
+bool Aead::Seal(const base::StringPiece& nonce,
+                const base::StringPiece& additional_data,
+                const char* plaintext,
+                size_t plaintext_len,
+                char* out) {
+  DCHECK(plat_->key.get());  // Must call Init() before Seal().
+  if (nonce.size() != kNonceLength)
+    return false;
+
+  CK_GCM_PARAMS params;
+  SECItem param;
+  MakeGcmParams(nonce, additional_data, &params, &param);
+  unsigned int out_len = 0;
+  SECStatus rv = PK11_Encrypt(
+      plat_->key.get(), CKM_AES_GCM, &param,
+      reinterpret_cast<unsigned char*>(out), &out_len,
+      plaintext_len + kTagLength,
+      reinterpret_cast<const unsigned char*>(plaintext), plaintext_len);
+  if (rv != SECSuccess)
+    return false;
+  DCHECK_EQ(plaintext_len + kTagLength, out_len);
+  return true;
+}
+
+bool Aead::Open(const base::StringPiece& nonce,
+                const base::StringPiece& additional_data,
+                const char* ciphertext,
+                size_t ciphertext_len,
+                char* out) {
+  DCHECK(plat_->key.get());  // Must call Init() before Open().
+  if (nonce.size() != kNonceLength || ciphertext_len < kTagLength)
+    return false;
+
+  CK_GCM_PARAMS params;
+  SECItem param;
+  MakeGcmParams(nonce, additional_data, &params, &param);
+  // Fails if the tag does not match.
+  unsigned int out_len = 0;
+  SECStatus rv = PK11_Decrypt(
+      plat_->key.get(), CKM_AES_GCM, &param,
+      reinterpret_cast<unsigned char*>(out), &out_len,
+      ciphertext_len - kTagLength,
+      reinterpret_cast<const unsigned char*>(ciphertext), ciphertext_len);
+  return rv == SECSuccess;
+}
+
+#else  // !defined(AEAD_HAVE_AES_GCM)
+
+// static
+bool Aead::IsSupported() {
+  return false;
+}
+
+bool Aead::Init(SymmetricKey* key) {
+  return false;
+}
+
+bool Aead::Seal(const base::StringPiece& nonce,
+                const base::StringPiece& additional_data,
+                const char* plaintext,
+                size_t plaintext_len,
+                char* out) {
+  NOTREACHED();
+  return false;
+}
+
+bool Aead::Open(const base::StringPiece& nonce,
+                const base::StringPiece& additional_data,
+                const char* ciphertext,
+                size_t ciphertext_len,
+                char* out) {
+  NOTREACHED();
+  return false;
+}
+
+#endif  // defined(AEAD_HAVE_AES_GCM)
+
+}  // namespace crypto
@@ -0,0 +1,148 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "crypto/aead.h"
+
+#include <openssl/evp.h>
+#include <string.h>
+
+#include <string>
+
+#include "base/logging.h"
+#include "crypto/openssl_util.h"
+#include "crypto/symmetric_key.h"
+
+namespace crypto {
+
+namespace {
+
+const EVP_CIPHER* GetCipherForKey(const std::string& key) {
+  switch (key.length()) {
+    case 16: return EVP_aes_128_gcm();
+    case 32: return EVP_aes_256_gcm();
+    default: return NULL;
+  }
+}
+
+}  // namespace
+
+// Each context holds the expanded key, so Seal() and Open() only have to set
+// the nonce.
+struct AeadPlatformData {
+  ScopedOpenSSL<EVP_CIPHER_CTX, EVP_CIPHER_CTX_free> encrypt_ctx;
+  ScopedOpenSSL<EVP_CIPHER_CTX, EVP_CIPHER_CTX_free> decrypt_ctx;
+};
+
+Aead::Aead() : plat_(new AeadPlatformData()) {
+}
+
+Aead::~Aead() {
+}
+
+// static
+bool Aead::IsSupported() {
+  return true;
+}
+
+bool Aead::Init(SymmetricKey* key) {
+  DCHECK(key);
+  // Init must not be called more than once on the same Aead object.
+  DCHECK(!plat_->encrypt_ctx.get());
+
+  OpenSSLErrStackTracer err_tracer(FROM_HERE);
+  const std::string& raw_key = key->key();
+  const EVP_CIPHER* cipher = GetCipherForKey(raw_key);
+  if (!cipher)
+    return false;
+
+  const uint8* key_data = reinterpret_cast<const uint8*>(raw_key.data());
+  plat_->encrypt_ctx.reset(EVP_CIPHER_CTX_new());
+  plat_->decrypt_ctx.reset(EVP_CIPHER_CTX_new());
+  if (!plat_->encrypt_ctx.get() || !plat_->decrypt_ctx.get() ||
+      !EVP_EncryptInit_ex(plat_->encrypt_ctx.get(), cipher, NULL, key_data,
+                          NULL) ||
+      !EVP_DecryptInit_ex(plat_->decrypt_ctx.get(), cipher, NULL, key_data,
+                          NULL)) {
+    plat_->encrypt_ctx.reset(NULL);
+    plat_->decrypt_ctx.reset(NULL);
+    return false;
+  }
+  return true;
+}
+
+bool Aead::Seal(const base::StringPiece& nonce,
+                const base::StringPiece& additional_data,
+                const char* plaintext,
+                size_t plaintext_len,
+                char* out) {
+  EVP_CIPHER_CTX* ctx = plat_->encrypt_ctx.get();
+  DCHECK(ctx);  // Must call Init() before Seal().
+  if (nonce.size() != kNonceLength)
+    return false;
+
+  OpenSSLErrStackTracer err_tracer(FROM_HERE);
+  uint8* out_ptr = reinterpret_cast<uint8*>(out);
+  int len;
+  if (!EVP_EncryptInit_ex(ctx, NULL, NULL, NULL,
+                          reinterpret_cast<const uint8*>(nonce.data())) ||
+      (!additional_data.empty() &&
+       !EVP_EncryptUpdate(ctx, NULL, &len,
+                          reinterpret_cast<const uint8*>(
+                              additional_data.data()),
+                          additional_data.size())) ||
+      !EVP_EncryptUpdate(ctx, out_ptr, &len,
+                         reinterpret_cast<const uint8*>(plaintext),
+                         plaintext_len)) {
+    return false;
+  }
+  DCHECK_EQ(plaintext_len, static_cast<size_t>(len));
+
+  int tail_len;
+  if (!EVP_EncryptFinal_ex(ctx, out_ptr + len, &tail_len))
+    return false;
+  DCHECK_EQ(0, tail_len);
+  return EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, kTagLength,
+                             out_ptr + plaintext_len) == 1;
+}
+
+bool Aead::Open(const base::StringPiece& nonce,
+                const base::StringPiece& additional_data,
+                const char* ciphertext,
+                size_t ciphertext_len,
+                char* out) {
+  EVP_CIPHER_CTX* ctx = plat_->decrypt_ctx.get();
+  DCHECK(ctx);  // Must call Init() before Open().
+  if (nonce.size() != kNonceLength || ciphertext_len < kTagLength)
+    return false;
+
+  OpenSSLErrStackTracer err_tracer(FROM_HERE);
+  const size_t plaintext_len = ciphertext_len - kTagLength;
+  // Decrypting in place overwrites only the plaintext's length of |out|,
+  // but EVP_CTRL_GCM_SET_TAG takes a non-const pointer.
+  uint8 tag[kTagLength];
+  memcpy(tag, ciphertext + plaintext_len, kTagLength);
+
+  uint8* out_ptr = reinterpret_cast<uint8*>(out);
+  int len;
+  if (!EVP_DecryptInit_ex(ctx, NULL, NULL, NULL,
+                          reinterpret_cast<const uint8*>(nonce.data())) ||
+      !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, kTagLength, tag) ||
+      (!additional_data.empty() &&
+       !EVP_DecryptUpdate(ctx, NULL, &len,
+                          reinterpret_cast<const uint8*>(
+                              additional_data.data()),
+                          additional_data.size())) ||
+      !EVP_DecryptUpdate(ctx, out_ptr, &len,
+                         reinterpret_cast<const uint8*>(ciphertext),
+                         plaintext_len)) {
+    return false;
+  }
+  DCHECK_EQ(plaintext_len, static_cast<size_t>(len));
+
+  // Fails if the tag does not match.
+  int tail_len;
+  return EVP_DecryptFinal_ex(ctx, out_ptr + len, &tail_len) == 1;
+}
+
+}  // namespace crypto
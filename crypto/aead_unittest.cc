@@ -0,0 +1,136 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "crypto/aead.h"
+
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/string_number_conversions.h"
+#include "crypto/symmetric_key.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+std::string HexToString(const char* hex) {
+  std::vector<uint8> bytes;
+  EXPECT_TRUE(base::HexStringToBytes(hex, &bytes));
+  return std::string(bytes.begin(), bytes.end());
+}
+
+// Test case 4 from "The Galois/Counter Mode of Operation (GCM)".
+const char kKey[] = "feffe9928665731c6d6a8f9467308308";
+const char kNonce[] = "cafebabefacedbaddecaf888";
+const char kPlaintext[] =
+    "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+    "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39";
+const char kAdditionalData[] = "feedfacedeadbeeffeedfacedeadbeefabaddad2";
+const char kCiphertextAndTag[] =
+    "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+    "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091"
+    "5bc94fbc3221a5db94fae95ae7121a47";
+
+class AeadTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    if (!crypto::Aead::IsSupported())
+      return;
+    key_.reset(crypto::SymmetricKey::Import(crypto::SymmetricKey::AES,
+                                            HexToString(kKey)));
+    ASSERT_TRUE(key_.get());
+    ASSERT_TRUE(aead_.Init(key_.get()));
+  }
+
+  scoped_ptr<crypto::SymmetricKey> key_;
+  crypto::Aead aead_;
+};
+
+}  // namespace
+
+TEST_F(AeadTest, Seal) {
+  if (!crypto::Aead::IsSupported())
+    return;
+  std::string plaintext = HexToString(kPlaintext);
+  std::string out(plaintext.size() + crypto::Aead::kTagLength, '\0');
+  ASSERT_TRUE(aead_.Seal(HexToString(kNonce), HexToString(kAdditionalData),
+                         plaintext.data(), plaintext.size(), &out[0]));
+  EXPECT_EQ(HexToString(kCiphertextAndTag), out);
+}
+
+TEST_F(AeadTest, Open) {
+  if (!crypto::Aead::IsSupported())
+    return;
+  std::string ciphertext = HexToString(kCiphertextAndTag);
+  std::string out(ciphertext.size() - crypto::Aead::kTagLength, '\0');
+  ASSERT_TRUE(aead_.Open(HexToString(kNonce), HexToString(kAdditionalData),
+                         ciphertext.data(), ciphertext.size(), &out[0]));
+  EXPECT_EQ(HexToString(kPlaintext), out);
+}
+
+TEST_F(AeadTest, InPlace) {
+  if (!crypto::Aead::IsSupported())
+    return;
+  std::string plaintext = HexToString(kPlaintext);
+  std::string buffer(plaintext);
+  buffer.resize(plaintext.size() + crypto::Aead::kTagLength);
+  ASSERT_TRUE(aead_.Seal(HexToString(kNonce), HexToString(kAdditionalData),
+                         buffer.data(), plaintext.size(), &buffer[0]));
+  EXPECT_EQ(HexToString(kCiphertextAndTag), buffer);
+
+  ASSERT_TRUE(aead_.Open(HexToString(kNonce), HexToString(kAdditionalData),
+                         buffer.data(), buffer.size(), &buffer[0]));
+  EXPECT_EQ(plaintext, buffer.substr(0, plaintext.size()));
+}
+
+TEST_F(AeadTest, KeyIsReused) {
+  if (!crypto::Aead::IsSupported())
+    return;
+  // Each message gets a fresh nonce but no new key setup.
+  std::string nonce(crypto::Aead::kNonceLength, '\0');
+  for (int i = 0; i < 3; ++i) {
+    nonce[0] = static_cast<char>(i);
+    std::string message(i * 10 + 1, 'a' + i);
+    std::string sealed(message.size() + crypto::Aead::kTagLength, '\0');
+    ASSERT_TRUE(aead_.Seal(nonce, "", message.data(), message.size(),
+                           &sealed[0]));
+    std::string opened(message.size(), '\0');
+    ASSERT_TRUE(aead_.Open(nonce, "", sealed.data(), sealed.size(),
+                           &opened[0]));
+    EXPECT_EQ(message, opened);
+  }
+}
+
+TEST_F(AeadTest, OpenRejectsTampering) {
+  if (!crypto::Aead::IsSupported())
+    return;
+  std::string ciphertext = HexToString(kCiphertextAndTag);
+  std::string out(ciphertext.size() - crypto::Aead::kTagLength, '\0');
+
+  std::string corrupted(ciphertext);
+  corrupted[0] ^= 1;
+  EXPECT_FALSE(aead_.Open(HexToString(kNonce), HexToString(kAdditionalData),
+                          corrupted.data(), corrupted.size(), &out[0]));
+
+  corrupted = ciphertext;
+  corrupted[corrupted.size() - 1] ^= 1;
+  EXPECT_FALSE(aead_.Open(HexToString(kNonce), HexToString(kAdditionalData),
+                          corrupted.data(), corrupted.size(), &out[0]));
+
+  EXPECT_FALSE(aead_.Open(HexToString(kNonce), "other additional data",
+                          ciphertext.data(), ciphertext.size(), &out[0]));
+
+  EXPECT_FALSE(aead_.Open(HexToString(kNonce), HexToString(kAdditionalData),
+                          ciphertext.data(), crypto::Aead::kTagLength - 1,
+                          &out[0]));
+}
+
+TEST_F(AeadTest, WrongNonceLength) {
+  if (!crypto::Aead::IsSupported())
+    return;
+  std::string plaintext("plaintext");
+  std::string out(plaintext.size() + crypto::Aead::kTagLength, '\0');
+  EXPECT_FALSE(aead_.Seal("short", "", plaintext.data(), plaintext.size(),
+                          &out[0]));
+}
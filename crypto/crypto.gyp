@@ -51,6 +51,7 @@
         }, {  # os_posix != 1 or OS == "mac" or OS == "android"
             'sources/': [
               ['exclude', '_nss\.cc$'],
+              ['include', 'aead_nss\.cc$'],
               ['include', 'ec_private_key_nss\.cc$'],
               ['include', 'ec_signature_creator_nss\.cc$'],
               ['include', 'signature_verifier_nss\.cc$'],
@@ -107,6 +108,7 @@
             # TODO(joth): Use a glob to match exclude patterns once the
             #             OpenSSL file set is complete.
             'sources!': [
+              'aead_nss.cc',
               'ec_private_key_nss.cc',
               'ec_signature_creator_nss.cc',
               'encryptor_nss.cc',
@@ -129,6 +131,7 @@
             ],
           }, {
             'sources!': [
+              'aead_openssl.cc',
               'ec_private_key_openssl.cc',
               'ec_signature_creator_openssl.cc',
               'encryptor_openssl.cc',
@@ -147,6 +150,9 @@
         # NOTE: all transitive dependencies of HMAC on windows need
         #     to be placed in the source list above.
         '<@(hmac_win64_related_sources)',
+        'aead.h',
+        'aead_nss.cc',
+        'aead_openssl.cc',
         'capi_util.cc',
         'capi_util.h',
         'crypto_export.h',
@@ -226,6 +232,7 @@
         'run_all_unittests.cc',
 
         # Tests.
+        'aead_unittest.cc',
         'ec_private_key_unittest.cc',
         'ec_signature_creator_unittest.cc',
         'encryptor_unittest.cc',
@@ -287,6 +294,19 @@
         }],
       ],
     },
+    {
+      'target_name': 'crypto_perftests',
+      'type': 'executable',
+      'sources': [
+        'aead_perftest.cc',
+      ],
+      'dependencies': [
+        'crypto',
+        '../base/base.gyp:base',
+        '../base/base.gyp:test_support_perf',
+        '../testing/gtest.gyp:gtest',
+      ],
+    },
   ],
   'conditions': [
     [ 'OS == "win"', {
@@ -31,10 +31,13 @@
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop.h"
+#include "base/metrics/histogram.h"
 #include "base/native_library.h"
 #include "base/scoped_temp_dir.h"
 #include "base/stringprintf.h"
 #include "base/threading/thread_restrictions.h"
+#include "base/threading/worker_pool.h"
+#include "base/time.h"
 #include "build/build_config.h"
 #include "crypto/scoped_nss_types.h"
 
@@ -387,6 +390,22 @@ class NSSInitSingleton {
   }
 #endif  // defined(USE_NSS)
 
+  // Loads the built-in root certificates if NSS was initialized with a
+  // persistent database and they aren't loaded yet.
+  void EnsureRootCertsLoaded() {
+#if defined(USE_NSS)
+    base::AutoLock lock(root_lock_);
+    if (!load_root_certs_ || root_)
+      return;
+    // Only try once; InitDefaultRootCerts already complains on failure.
+    load_root_certs_ = false;
+    base::TimeTicks start = base::TimeTicks::Now();
+    root_ = InitDefaultRootCerts();
+    UMA_HISTOGRAM_TIMES("NSS.RootCertsLoadTime",
+                        base::TimeTicks::Now() - start);
+#endif  // defined(USE_NSS)
+  }
+
   // This method is used to force NSS to be initialized without a DB.
   // Call this method before NSSInitSingleton() is constructed.
   static void ForceNoDBInit() {
@@ -402,9 +421,11 @@ class NSSInitSingleton {
         test_slot_(NULL),
         tpm_slot_(NULL),
         root_(NULL),
+        load_root_certs_(false),
         chromeos_user_logged_in_(false),
         ALLOW_THIS_IN_INITIALIZER_LIST(weak_ptr_factory_(this)) {
     EnsureNSPRInit();
+    base::TimeTicks start = base::TimeTicks::Now();
 
     // We *must* have NSS >= 3.12.3.  See bug 26448.
     COMPILE_ASSERT(
@@ -489,9 +510,12 @@ class NSSInitSingleton {
         PK11_FreeSlot(slot);
       }
 
-      root_ = InitDefaultRootCerts();
+      // Loading libnssckbi.so and its certificates is slow, so it is left to
+      // EnsureRootCertsLoaded for the code which needs them.
+      load_root_certs_ = true;
 #endif  // defined(USE_NSS)
     }
+    UMA_HISTOGRAM_TIMES("NSS.InitTime", base::TimeTicks::Now() - start);
   }
 
   // NOTE(willchan): We don't actually execute this code since we leak NSS to
@@ -624,12 +648,16 @@ class NSSInitSingleton {
   PK11SlotInfo* test_slot_;
   PK11SlotInfo* tpm_slot_;
   SECMODModule* root_;
+  // Whether the root certificates are still to be loaded.
+  bool load_root_certs_;
   bool chromeos_user_logged_in_;
   base::WeakPtrFactory<NSSInitSingleton> weak_ptr_factory_;
 #if defined(USE_NSS)
   // TODO(davidben): When https://bugzilla.mozilla.org/show_bug.cgi?id=564011
   // is fixed, we will no longer need the lock.
   base::Lock write_lock_;
+  // Guards |root_| and |load_root_certs_|.
+  base::Lock root_lock_;
 #endif  // defined(USE_NSS)
 };
 
@@ -660,6 +688,21 @@ void EnsureNSSInit() {
   g_nss_singleton.Get();
 }
 
+void EnsureNSSRootCertsInit() {
+  // Loading the root certificates module does blocking IO.
+  base::ThreadRestrictions::ScopedAllowIO allow_io;
+  g_nss_singleton.Get().EnsureRootCertsLoaded();
+}
+
+void PreinitializeNSSInBackground() {
+  // NSPR is cheap to initialize and wants to be initialized on the main
+  // thread rather than on the worker.
+  EnsureNSPRInit();
+  base::WorkerPool::PostTask(FROM_HERE,
+                             base::Bind(&EnsureNSSRootCertsInit),
+                             true);
+}
+
 void ForceNSSNoDBInit() {
   NSSInitSingleton::ForceNoDBInit();
 }
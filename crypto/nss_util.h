@@ -44,8 +44,23 @@ CRYPTO_EXPORT void EnsureNSPRInit();
 // Initialize NSS if it isn't already initialized.  This must be called before
 // any other NSS functions.  This function is thread-safe, and NSS will only
 // ever be initialized once.
+//
+// This does not load the built-in root certificates, which is slow and only
+// needed to verify certificates; see EnsureNSSRootCertsInit.
 CRYPTO_EXPORT void EnsureNSSInit();
 
+// Initialize NSS, as EnsureNSSInit does, and load NSS's built-in root
+// certificates if they aren't already loaded.  Call this before verifying
+// certificates or making SSL connections.  This function is thread-safe.
+CRYPTO_EXPORT void EnsureNSSRootCertsInit();
+
+// Starts initializing NSS and loading the root certificates on a worker
+// thread, so that the first SSL connection or certificate operation does not
+// have to wait for it.  Callers of the Ensure functions above block until the
+// background initialization is done rather than starting another.  Call this
+// on the thread which should initialize NSPR.
+CRYPTO_EXPORT void PreinitializeNSSInBackground();
+
 // Call this before calling EnsureNSSInit() will force NSS to initialize
 // without a persistent DB.  This is used for the special case where access of
 // persistent DB is prohibited.
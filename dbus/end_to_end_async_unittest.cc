@@ -10,6 +10,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop.h"
 #include "base/stl_util.h"
+#include "base/stringprintf.h"
 #include "base/test/test_timeouts.h"
 #include "base/threading/thread.h"
 #include "base/threading/thread_restrictions.h"
@@ -313,6 +314,29 @@ TEST_F(EndToEndAsyncTest, EchoThreeTimes) {
   EXPECT_EQ("foo", response_strings_[2]);
 }
 
+// Call Echo method many times in a burst, which is sent and answered in
+// batches.
+TEST_F(EndToEndAsyncTest, EchoBurst) {
+  const size_t kNumCalls = 100;
+
+  for (size_t i = 0; i < kNumCalls; ++i) {
+    dbus::MethodCall method_call("org.chromium.TestInterface", "Echo");
+    dbus::MessageWriter writer(&method_call);
+    writer.AppendString(base::StringPrintf("%03d", static_cast<int>(i)));
+
+    const int timeout_ms = dbus::ObjectProxy::TIMEOUT_USE_DEFAULT;
+    CallMethod(&method_call, timeout_ms);
+  }
+
+  WaitForResponses(kNumCalls);
+  ASSERT_EQ(kNumCalls, response_strings_.size());
+  std::sort(response_strings_.begin(), response_strings_.end());
+  for (size_t i = 0; i < kNumCalls; ++i) {
+    EXPECT_EQ(base::StringPrintf("%03d", static_cast<int>(i)),
+              response_strings_[i]);
+  }
+}
+
 TEST_F(EndToEndAsyncTest, BrokenBus) {
   const char* kHello = "hello";
 
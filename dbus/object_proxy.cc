@@ -125,7 +125,7 @@ void ObjectProxy::CallMethodWithErrorCallback(MethodCall* method_call,
                                   error_callback,
                                   start_time);
   // Wait for the response in the D-Bus thread.
-  bus_->PostTaskToDBusThread(FROM_HERE, task);
+  PostTaskToDBusThreadBatched(task);
 }
 
 void ObjectProxy::ConnectToSignal(const std::string& interface_name,
@@ -134,13 +134,12 @@ void ObjectProxy::ConnectToSignal(const std::string& interface_name,
                                   OnConnectedCallback on_connected_callback) {
   bus_->AssertOnOriginThread();
 
-  bus_->PostTaskToDBusThread(FROM_HERE,
-                             base::Bind(&ObjectProxy::ConnectToSignalInternal,
-                                        this,
-                                        interface_name,
-                                        signal_name,
-                                        signal_callback,
-                                        on_connected_callback));
+  PostTaskToDBusThreadBatched(base::Bind(&ObjectProxy::ConnectToSignalInternal,
+                                         this,
+                                         interface_name,
+                                         signal_name,
+                                         signal_callback,
+                                         on_connected_callback));
 }
 
 void ObjectProxy::Detach() {
@@ -199,7 +198,7 @@ void ObjectProxy::StartAsyncMethodCall(int timeout_ms,
                                     error_callback,
                                     start_time,
                                     response_message);
-    bus_->PostTaskToOriginThread(FROM_HERE, task);
+    PostTaskToOriginThreadBatched(task);
 
     dbus_message_unref(request_message);
     return;
@@ -241,7 +240,7 @@ void ObjectProxy::OnPendingCallIsComplete(DBusPendingCall* pending_call,
                                   error_callback,
                                   start_time,
                                   response_message);
-  bus_->PostTaskToOriginThread(FROM_HERE, task);
+  PostTaskToOriginThreadBatched(task);
 }
 
 void ObjectProxy::RunResponseCallback(ResponseCallback response_callback,
@@ -339,14 +338,12 @@ void ObjectProxy::ConnectToSignalInternal(
   }
 
   // Run on_connected_callback in the origin thread.
-  bus_->PostTaskToOriginThread(
-      FROM_HERE,
-      base::Bind(&ObjectProxy::OnConnected,
-                 this,
-                 on_connected_callback,
-                 interface_name,
-                 signal_name,
-                 success));
+  PostTaskToOriginThreadBatched(base::Bind(&ObjectProxy::OnConnected,
+                                           this,
+                                           on_connected_callback,
+                                           interface_name,
+                                           signal_name,
+                                           success));
 }
 
 void ObjectProxy::OnConnected(OnConnectedCallback on_connected_callback,
@@ -398,12 +395,11 @@ DBusHandlerResult ObjectProxy::HandleMessage(
     // Transfer the ownership of |signal| to RunMethod().
     // |released_signal| will be deleted in RunMethod().
     Signal* released_signal = signal.release();
-    bus_->PostTaskToOriginThread(FROM_HERE,
-                                 base::Bind(&ObjectProxy::RunMethod,
-                                            this,
-                                            start_time,
-                                            iter->second,
-                                            released_signal));
+    PostTaskToOriginThreadBatched(base::Bind(&ObjectProxy::RunMethod,
+                                             this,
+                                             start_time,
+                                             iter->second,
+                                             released_signal));
   } else {
     const base::TimeTicks start_time = base::TimeTicks::Now();
     // If the D-Bus thread is not used, just call the callback on the
@@ -435,6 +431,54 @@ DBusHandlerResult ObjectProxy::HandleMessageThunk(
   return self->HandleMessage(connection, raw_message);
 }
 
+void ObjectProxy::PostTaskToDBusThreadBatched(const base::Closure& task) {
+  {
+    base::AutoLock auto_lock(task_queue_lock_);
+    dbus_thread_tasks_.push_back(task);
+    if (dbus_thread_tasks_.size() > 1)
+      return;
+  }
+  bus_->PostTaskToDBusThread(FROM_HERE,
+                             base::Bind(&ObjectProxy::RunDBusThreadTasks,
+                                        this));
+}
+
+void ObjectProxy::PostTaskToOriginThreadBatched(const base::Closure& task) {
+  {
+    base::AutoLock auto_lock(task_queue_lock_);
+    origin_thread_tasks_.push_back(task);
+    if (origin_thread_tasks_.size() > 1)
+      return;
+  }
+  bus_->PostTaskToOriginThread(FROM_HERE,
+                               base::Bind(&ObjectProxy::RunOriginThreadTasks,
+                                          this));
+}
+
+void ObjectProxy::RunDBusThreadTasks() {
+  std::vector<base::Closure> tasks;
+  {
+    base::AutoLock auto_lock(task_queue_lock_);
+    tasks.swap(dbus_thread_tasks_);
+  }
+  for (size_t i = 0; i < tasks.size(); ++i)
+    tasks[i].Run();
+  UMA_HISTOGRAM_COUNTS_100("DBus.DBusThreadTasksPerBatch", tasks.size());
+}
+
+void ObjectProxy::RunOriginThreadTasks() {
+  bus_->AssertOnOriginThread();
+
+  std::vector<base::Closure> tasks;
+  {
+    base::AutoLock auto_lock(task_queue_lock_);
+    tasks.swap(origin_thread_tasks_);
+  }
+  for (size_t i = 0; i < tasks.size(); ++i)
+    tasks[i].Run();
+  UMA_HISTOGRAM_COUNTS_100("DBus.OriginThreadTasksPerBatch", tasks.size());
+}
+
 void ObjectProxy::LogMethodCallFailure(
     const base::StringPiece& error_name,
     const base::StringPiece& error_message) const {
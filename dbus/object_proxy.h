@@ -11,10 +11,12 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "base/callback.h"
 #include "base/memory/ref_counted.h"
 #include "base/string_piece.h"
+#include "base/synchronization/lock.h"
 #include "base/time.h"
 #include "dbus/object_path.h"
 
@@ -225,6 +227,20 @@ class ObjectProxy : public base::RefCountedThreadSafe<ObjectProxy> {
                                               DBusMessage* raw_message,
                                               void* user_data);
 
+  // Queues |task| to run in the D-Bus thread. A burst of method calls
+  // issued before the D-Bus thread gets to them is sent by a single posted
+  // task, rather than by one thread hop per call.
+  void PostTaskToDBusThreadBatched(const base::Closure& task);
+
+  // Queues |task| to run in the origin thread. Replies and signals that
+  // arrive together are run by a single posted task, in the order they
+  // were received.
+  void PostTaskToOriginThreadBatched(const base::Closure& task);
+
+  // Run the tasks queued by the two methods above.
+  void RunDBusThreadTasks();
+  void RunOriginThreadTasks();
+
   // Helper method for logging response errors appropriately.
   void LogMethodCallFailure(const base::StringPiece& error_name,
                             const base::StringPiece& error_message) const;
@@ -249,6 +265,13 @@ class ObjectProxy : public base::RefCountedThreadSafe<ObjectProxy> {
 
   const bool ignore_service_unknown_errors_;
 
+  // Tasks waiting for RunDBusThreadTasks() and RunOriginThreadTasks().
+  // A task to run a queue is posted only when the queue becomes non-empty.
+  // |task_queue_lock_| must be held when accessing either queue.
+  base::Lock task_queue_lock_;
+  std::vector<base::Closure> dbus_thread_tasks_;
+  std::vector<base::Closure> origin_thread_tasks_;
+
   DISALLOW_COPY_AND_ASSIGN(ObjectProxy);
 };
 
@@ -650,6 +650,14 @@ void GLES2ProduceTextureCHROMIUM(GLenum target, const GLbyte* mailbox) {
 void GLES2ConsumeTextureCHROMIUM(GLenum target, const GLbyte* mailbox) {
   gles2::GetGLContext()->ConsumeTextureCHROMIUM(target, mailbox);
 }
+void GLES2AsyncTexImage2DCHROMIUM(
+    GLenum target, GLint level, GLint internalformat, GLsizei width,
+    GLsizei height, GLint border, GLenum format, GLenum type,
+    const void* pixels) {
+  gles2::GetGLContext()->AsyncTexImage2DCHROMIUM(
+      target, level, internalformat, width, height, border, format, type,
+      pixels);
+}
 
 #endif  // GPU_COMMAND_BUFFER_CLIENT_GLES2_C_LIB_AUTOGEN_H_
 
@@ -1797,5 +1797,18 @@
     }
   }
 
+  void AsyncTexImage2DCHROMIUM(
+      GLenum target, GLint level, GLint internalformat, GLsizei width,
+      GLsizei height, GLint border, GLenum format, GLenum type,
+      uint32 pixels_shm_id, uint32 pixels_shm_offset) {
+    gles2::AsyncTexImage2DCHROMIUM* c =
+        GetCmdSpace<gles2::AsyncTexImage2DCHROMIUM>();
+    if (c) {
+      c->Init(
+          target, level, internalformat, width, height, border, format, type,
+          pixels_shm_id, pixels_shm_offset);
+    }
+  }
+
 #endif  // GPU_COMMAND_BUFFER_CLIENT_GLES2_CMD_HELPER_AUTOGEN_H_
 
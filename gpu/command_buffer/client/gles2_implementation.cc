@@ -363,6 +363,8 @@ class ClientSideBufferHelper {
 #if !defined(_MSC_VER)
 const size_t GLES2Implementation::kMaxSizeOfSimpleResult;
 const unsigned int GLES2Implementation::kStartingOffset;
+const unsigned int GLES2Implementation::kLargeTransferSize;
+const size_t GLES2Implementation::kMaxPendingLargeTransfers;
 #endif
 
 GLES2Implementation::SingleThreadChecker::SingleThreadChecker(
@@ -403,6 +405,7 @@ GLES2Implementation::GLES2Implementation(
       error_bits_(0),
       debug_(false),
       use_count_(0),
+      wait_for_cmd_count_(0),
       current_query_(NULL),
       error_message_callback_(NULL) {
   GPU_DCHECK(helper);
@@ -546,6 +549,7 @@ void GLES2Implementation::FreeEverything() {
 
 void GLES2Implementation::WaitForCmd() {
   TRACE_EVENT0("gpu", "GLES2::WaitForCmd");
+  ++wait_for_cmd_count_;
   helper_->CommandBufferHelper::Finish();
 }
 
@@ -734,6 +738,74 @@ void GLES2Implementation::SetBucketAsString(
   SetBucketContents(bucket_id, str.c_str(), str.size() + 1);
 }
 
+bool* GLES2Implementation::GetCapabilityState(GLenum cap) {
+  switch (cap) {
+    case GL_BLEND:
+      return &gl_state_.blend;
+    case GL_CULL_FACE:
+      return &gl_state_.cull_face;
+    case GL_DEPTH_TEST:
+      return &gl_state_.depth_test;
+    case GL_DITHER:
+      return &gl_state_.dither;
+    case GL_POLYGON_OFFSET_FILL:
+      return &gl_state_.polygon_offset_fill;
+    case GL_SAMPLE_ALPHA_TO_COVERAGE:
+      return &gl_state_.sample_alpha_to_coverage;
+    case GL_SAMPLE_COVERAGE:
+      return &gl_state_.sample_coverage;
+    case GL_SCISSOR_TEST:
+      return &gl_state_.scissor_test;
+    case GL_STENCIL_TEST:
+      return &gl_state_.stencil_test;
+    default:
+      return NULL;
+  }
+}
+
+void GLES2Implementation::Enable(GLenum cap) {
+  GPU_CLIENT_SINGLE_THREAD_CHECK();
+  GPU_CLIENT_LOG("[" << this << "] glEnable("
+      << GLES2Util::GetStringCapability(cap) << ")");
+  bool* state = GetCapabilityState(cap);
+  if (state) {
+    *state = true;
+  }
+  helper_->Enable(cap);
+}
+
+void GLES2Implementation::Disable(GLenum cap) {
+  GPU_CLIENT_SINGLE_THREAD_CHECK();
+  GPU_CLIENT_LOG("[" << this << "] glDisable("
+      << GLES2Util::GetStringCapability(cap) << ")");
+  bool* state = GetCapabilityState(cap);
+  if (state) {
+    *state = false;
+  }
+  helper_->Disable(cap);
+}
+
+GLboolean GLES2Implementation::IsEnabled(GLenum cap) {
+  GPU_CLIENT_SINGLE_THREAD_CHECK();
+  GPU_CLIENT_LOG("[" << this << "] glIsEnabled("
+      << GLES2Util::GetStringCapability(cap) << ")");
+  const bool* state = GetCapabilityState(cap);
+  if (state) {
+    GPU_CLIENT_LOG("returned " << *state);
+    return *state;
+  }
+  typedef IsEnabled::Result Result;
+  Result* result = GetResultAs<Result*>();
+  if (!result) {
+    return GL_FALSE;
+  }
+  *result = 0;
+  helper_->IsEnabled(cap, GetResultShmId(), GetResultShmOffset());
+  WaitForCmd();
+  GPU_CLIENT_LOG("returned " << *result);
+  return *result;
+}
+
 bool GLES2Implementation::GetHelper(GLenum pname, GLint* params) {
   switch (pname) {
     case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:
@@ -811,8 +883,14 @@ bool GLES2Implementation::GetHelper(GLenum pname, GLint* params) {
         return true;
       }
       return false;
-    default:
+    default: {
+      const bool* state = GetCapabilityState(pname);
+      if (state) {
+        *params = *state;
+        return true;
+      }
       return false;
+    }
   }
 }
 
@@ -953,6 +1031,8 @@ void GLES2Implementation::SwapBuffers() {
   // All it means is that we could be slightly looser on the kMaxSwapBuffers
   // semantics if the client doesn't use the callback mechanism, and by chance
   // the scheduler yields between the InsertToken and the SwapBuffers.
+  TRACE_COUNTER1("gpu", "GLES2::WaitForCmdPerFrame", wait_for_cmd_count_);
+  wait_for_cmd_count_ = 0;
   swap_buffers_tokens_.push(helper_->InsertToken());
   helper_->SwapBuffers();
   helper_->CommandBufferHelper::Flush();
@@ -1616,6 +1696,22 @@ void GLES2Implementation::TexImage2D(
         unpack_skip_pixels_ * group_size;
   }
 
+  if (size >= kLargeTransferSize) {
+    int32 shm_id;
+    unsigned int shm_offset;
+    void* mem = AllocLargeTransfer(size, &shm_id, &shm_offset);
+    if (mem) {
+      CopyRectToBuffer(
+          pixels, height, unpadded_row_size, src_padded_row_size,
+          unpack_flip_y_, mem, padded_row_size);
+      helper_->TexImage2D(
+          target, level, internalformat, width, height, border, format, type,
+          shm_id, shm_offset);
+      FreeLargeTransfer(mem);
+      return;
+    }
+  }
+
   // Check if we can send it all at once.
   ScopedTransferBufferPtr buffer(size, helper_, transfer_buffer_);
   if (!buffer.valid()) {
@@ -1641,6 +1737,66 @@ void GLES2Implementation::TexImage2D(
       pixels, src_padded_row_size, GL_TRUE, &buffer, padded_row_size);
 }
 
+void GLES2Implementation::AsyncTexImage2DCHROMIUM(
+    GLenum target, GLint level, GLint internalformat, GLsizei width,
+    GLsizei height, GLint border, GLenum format, GLenum type,
+    const void* pixels) {
+  GPU_CLIENT_SINGLE_THREAD_CHECK();
+  GPU_CLIENT_LOG("[" << this << "] glAsyncTexImage2DCHROMIUM("
+      << GLES2Util::GetStringTextureTarget(target) << ", "
+      << level << ", "
+      << GLES2Util::GetStringTextureInternalFormat(internalformat) << ", "
+      << width << ", " << height << ", " << border << ", "
+      << GLES2Util::GetStringTextureFormat(format) << ", "
+      << GLES2Util::GetStringPixelType(type) << ", "
+      << static_cast<const void*>(pixels) << ")");
+  if (level < 0 || height < 0 || width < 0) {
+    SetGLError(GL_INVALID_VALUE, "glAsyncTexImage2DCHROMIUM dimension < 0");
+    return;
+  }
+  uint32 size;
+  uint32 unpadded_row_size;
+  uint32 padded_row_size;
+  if (!GLES2Util::ComputeImageDataSizes(
+          width, height, format, type, unpack_alignment_, &size,
+          &unpadded_row_size, &padded_row_size)) {
+    SetGLError(GL_INVALID_VALUE,
+               "glAsyncTexImage2DCHROMIUM: image size too large");
+    return;
+  }
+
+  // Uploads without pixels, or that read a sub-rectangle of the client's
+  // memory, take the synchronous path.
+  if (!pixels || unpack_row_length_ > 0 || unpack_skip_rows_ > 0 ||
+      unpack_skip_pixels_ > 0) {
+    TexImage2D(target, level, internalformat, width, height, border, format,
+               type, pixels);
+    return;
+  }
+
+  // The service copies the pixels out of the transfer buffer before
+  // returning, so the whole image must fit.
+  {
+    ScopedTransferBufferPtr buffer(size, helper_, transfer_buffer_);
+    if (!buffer.valid()) {
+      return;
+    }
+    if (buffer.size() >= size) {
+      CopyRectToBuffer(
+          pixels, height, unpadded_row_size, padded_row_size, unpack_flip_y_,
+          buffer.address(), padded_row_size);
+      helper_->AsyncTexImage2DCHROMIUM(
+          target, level, internalformat, width, height, border, format, type,
+          buffer.shm_id(), buffer.offset());
+      return;
+    }
+  }
+
+  // Too large for the transfer buffer, so upload it in pieces synchronously.
+  TexImage2D(target, level, internalformat, width, height, border, format,
+             type, pixels);
+}
+
 void GLES2Implementation::TexSubImage2D(
     GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width,
     GLsizei height, GLenum format, GLenum type, const void* pixels) {
@@ -1694,6 +1850,22 @@ void GLES2Implementation::TexSubImage2D(
         unpack_skip_pixels_ * group_size;
   }
 
+  if (temp_size >= kLargeTransferSize) {
+    int32 shm_id;
+    unsigned int shm_offset;
+    void* mem = AllocLargeTransfer(temp_size, &shm_id, &shm_offset);
+    if (mem) {
+      CopyRectToBuffer(
+          pixels, height, unpadded_row_size, src_padded_row_size,
+          unpack_flip_y_, mem, padded_row_size);
+      helper_->TexSubImage2D(
+          target, level, xoffset, yoffset, width, height, format, type,
+          shm_id, shm_offset, GL_FALSE);
+      FreeLargeTransfer(mem);
+      return;
+    }
+  }
+
   ScopedTransferBufferPtr buffer(temp_size, helper_, transfer_buffer_);
   TexSubImage2DImpl(
       target, level, xoffset, yoffset, width, height, format, type,
@@ -1701,6 +1873,23 @@ void GLES2Implementation::TexSubImage2D(
       padded_row_size);
 }
 
+void* GLES2Implementation::AllocLargeTransfer(
+    unsigned int size, int32* shm_id, unsigned int* shm_offset) {
+  // Each pending upload may hold a chunk of its own, so bound their number.
+  if (large_transfer_tokens_.size() >= kMaxPendingLargeTransfers) {
+    TRACE_EVENT0("gpu", "GLES2::WaitForLargeTransfer");
+    helper_->WaitForToken(large_transfer_tokens_.front());
+    large_transfer_tokens_.pop();
+  }
+  return mapped_memory_->Alloc(size, shm_id, shm_offset);
+}
+
+void GLES2Implementation::FreeLargeTransfer(void* mem) {
+  int32 token = helper_->InsertToken();
+  mapped_memory_->FreePendingToken(mem, token);
+  large_transfer_tokens_.push(token);
+}
+
 static GLint ComputeNumRowsThatFitInBuffer(
     GLsizeiptr padded_row_size, GLsizeiptr unpadded_row_size,
     unsigned int size) {
@@ -2847,6 +3036,9 @@ void GLES2Implementation::PostSubBufferCHROMIUM(
       << x << ", " << y << ", " << width << ", " << height << ")");
   TRACE_EVENT0("gpu", "GLES2::PostSubBufferCHROMIUM");
 
+  TRACE_COUNTER1("gpu", "GLES2::WaitForCmdPerFrame", wait_for_cmd_count_);
+  wait_for_cmd_count_ = 0;
+
   // Same flow control as GLES2Implementation::SwapBuffers (see comments there).
   swap_buffers_tokens_.push(helper_->InsertToken());
   helper_->PostSubBufferCHROMIUM(x, y, width, height);
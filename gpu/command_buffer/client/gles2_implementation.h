@@ -113,7 +113,16 @@ class GLES2_IMPL_EXPORT GLES2Implementation {
           max_vertex_texture_image_units(0),
           max_vertex_uniform_vectors(0),
           num_compressed_texture_formats(0),
-          num_shader_binary_formats(0) {
+          num_shader_binary_formats(0),
+          blend(false),
+          cull_face(false),
+          depth_test(false),
+          dither(true),
+          polygon_offset_fill(false),
+          sample_alpha_to_coverage(false),
+          sample_coverage(false),
+          scissor_test(false),
+          stencil_test(false) {
     }
 
     GLint max_combined_texture_image_units;
@@ -128,6 +137,18 @@ class GLES2_IMPL_EXPORT GLES2Implementation {
     GLint max_vertex_uniform_vectors;
     GLint num_compressed_texture_formats;
     GLint num_shader_binary_formats;
+
+    // Capabilities as last set by glEnable / glDisable, so that querying them
+    // does not need a round trip to the service.
+    bool blend;
+    bool cull_face;
+    bool depth_test;
+    bool dither;
+    bool polygon_offset_fill;
+    bool sample_alpha_to_coverage;
+    bool sample_coverage;
+    bool scissor_test;
+    bool stencil_test;
   };
 
   // The maxiumum result size from simple GL get commands.
@@ -142,6 +163,13 @@ class GLES2_IMPL_EXPORT GLES2Implementation {
   // The bucket used for results. Public for testing only.
   static const uint32 kResultBucketId = 1;
 
+  // Texture uploads at least this large bypass the transfer buffer.
+  static const unsigned int kLargeTransferSize = 512 * 1024;
+
+  // The number of large uploads that may be waiting for the service before
+  // the client waits for the oldest.
+  static const size_t kMaxPendingLargeTransfers = 2;
+
   // Alignment of allocations.
   static const unsigned int kAlignment = 4;
 
@@ -413,6 +441,15 @@ class GLES2_IMPL_EXPORT GLES2Implementation {
   GLuint GetMaxValueInBufferCHROMIUMHelper(
       GLuint buffer_id, GLsizei count, GLenum type, GLuint offset);
 
+  // Allocates shared memory for an upload of kLargeTransferSize or more from
+  // its own chunk, so that large uploads do not wait for, nor make wait, the
+  // small allocations in the transfer buffer. Returns NULL on failure.
+  void* AllocLargeTransfer(
+      unsigned int size, int32* shm_id, unsigned int* shm_offset);
+
+  // Frees memory from AllocLargeTransfer once the service has consumed it.
+  void FreeLargeTransfer(void* mem);
+
   // The pixels pointer should already account for unpack skip rows and skip
   // pixels.
   void TexSubImage2DImpl(
@@ -422,6 +459,10 @@ class GLES2_IMPL_EXPORT GLES2Implementation {
       ScopedTransferBufferPtr* buffer, uint32 buffer_padded_row_size);
 
   // Helpers for query functions.
+  // Returns the client side copy of the state of |cap|, or NULL if |cap| is
+  // not a capability tracked in gl_state_.
+  bool* GetCapabilityState(GLenum cap);
+
   bool GetHelper(GLenum pname, GLint* params);
   bool GetBooleanvHelper(GLenum pname, GLboolean* params);
   bool GetBufferParameterivHelper(GLenum target, GLenum pname, GLint* params);
@@ -448,6 +489,7 @@ class GLES2_IMPL_EXPORT GLES2Implementation {
 
   std::queue<int32> swap_buffers_tokens_;
   std::queue<int32> rate_limit_tokens_;
+  std::queue<int32> large_transfer_tokens_;
 
   ExtensionStatus angle_pack_reverse_row_order_status;
 
@@ -507,6 +549,10 @@ class GLES2_IMPL_EXPORT GLES2Implementation {
   // Used to check for single threaded access.
   int use_count_;
 
+  // Number of synchronous waits for the service since the last swap, traced
+  // once per frame.
+  int wait_for_cmd_count_;
+
   // Map of GLenum to Strings for glGetString.  We need to cache these because
   // the pointer passed back to the client has to remain valid for eternity.
   typedef std::map<uint32, std::set<std::string> > GLStringMap;
@@ -1836,6 +1836,46 @@ TEST_F(GLES2ImplementationTest, GetIntegerCacheWrite) {
   EXPECT_EQ(static_cast<GLenum>(GL_NO_ERROR), gl_->GetError());
 }
 
+TEST_F(GLES2ImplementationTest, CapabilitiesAreCached) {
+  static const GLenum kCapabilities[] = {
+    GL_BLEND,
+    GL_CULL_FACE,
+    GL_DEPTH_TEST,
+    GL_DITHER,
+    GL_POLYGON_OFFSET_FILL,
+    GL_SAMPLE_ALPHA_TO_COVERAGE,
+    GL_SAMPLE_COVERAGE,
+    GL_SCISSOR_TEST,
+    GL_STENCIL_TEST,
+  };
+  for (size_t ii = 0; ii < arraysize(kCapabilities); ++ii) {
+    GLenum cap = kCapabilities[ii];
+    EXPECT_EQ(cap == GL_DITHER, gl_->IsEnabled(cap) != 0);
+    EXPECT_TRUE(NoCommandsWritten());
+  }
+
+  struct Cmds {
+    Enable enable_cmd;
+    Disable disable_cmd;
+  };
+  Cmds expected;
+  expected.enable_cmd.Init(GL_BLEND);
+  expected.disable_cmd.Init(GL_DITHER);
+
+  // Only the state changes reach the service, the queries are answered
+  // locally.
+  gl_->Enable(GL_BLEND);
+  EXPECT_TRUE(gl_->IsEnabled(GL_BLEND));
+  gl_->Disable(GL_DITHER);
+  GLboolean blend = GL_FALSE;
+  gl_->GetBooleanv(GL_BLEND, &blend);
+  EXPECT_TRUE(blend);
+  GLint dither = -1;
+  gl_->GetIntegerv(GL_DITHER, &dither);
+  EXPECT_EQ(0, dither);
+  EXPECT_EQ(0, memcmp(&expected, commands_, sizeof(expected)));
+}
+
 static bool CheckRect(
     int width, int height, GLenum format, GLenum type, int alignment,
     bool flip_y, const uint8* r1, const uint8* r2) {
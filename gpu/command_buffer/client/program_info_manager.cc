@@ -168,7 +168,7 @@ class CachedProgramInfoManager : public ProgramInfoManager {
 
     bool GetProgramiv(GLenum pname, GLint* params);
 
-    // Updates the program info after a successful link.
+    // Updates the program info after a link.
     void Update(GLES2Implementation* gl, GLuint program);
 
    private:
@@ -312,6 +312,9 @@ void CachedProgramInfoManager::ProgramInfo::Update(
   const ProgramInfoHeader* header = LocalGetAs<const ProgramInfoHeader*>(
       result, 0, sizeof(header));
   link_status_ = header->link_status != 0;
+  // A failed link stays failed until the program is linked again, which
+  // resets this info, so there is no point asking the service again.
+  cached_ = true;
   if (!link_status_) {
     return;
   }
@@ -352,7 +355,6 @@ void CachedProgramInfoManager::ProgramInfo::Update(
   }
   GPU_DCHECK_EQ(header->num_attribs + header->num_uniforms,
                 static_cast<uint32>(input - inputs));
-  cached_ = true;
 }
 
 CachedProgramInfoManager::CachedProgramInfoManager() {
@@ -6,6 +6,7 @@
 
 #include "../client/transfer_buffer.h"
 #include "../client/cmd_buffer_helper.h"
+#include "../common/trace_event.h"
 
 namespace gpu {
 
@@ -22,6 +23,8 @@ TransferBuffer::TransferBuffer(
       alignment_(0),
       size_to_flush_(0),
       bytes_since_last_flush_(0),
+      stall_count_(0),
+      bytes_waited_on_(0),
       buffer_id_(-1),
       result_buffer_(NULL),
       result_shm_offset_(0),
@@ -161,8 +164,7 @@ void* TransferBuffer::AllocUpTo(
 
   unsigned int max_size = ring_buffer_->GetLargestFreeOrPendingSize();
   *size_allocated = std::min(max_size, size);
-  bytes_since_last_flush_ += *size_allocated;
-  return ring_buffer_->Alloc(*size_allocated);
+  return AllocFromRingBuffer(*size_allocated);
 }
 
 void* TransferBuffer::Alloc(unsigned int size) {
@@ -177,7 +179,22 @@ void* TransferBuffer::Alloc(unsigned int size) {
     return NULL;
   }
 
+  return AllocFromRingBuffer(size);
+}
+
+void* TransferBuffer::AllocFromRingBuffer(unsigned int size) {
   bytes_since_last_flush_ += size;
+  if (size <= ring_buffer_->GetLargestFreeSizeNoWaiting()) {
+    return ring_buffer_->Alloc(size);
+  }
+
+  // The ring buffer has to wait for the service to consume earlier
+  // allocations. The duration of the event is the stall time.
+  TRACE_EVENT1("gpu", "TransferBuffer::Stall", "bytes", size);
+  ++stall_count_;
+  bytes_waited_on_ += size;
+  TRACE_COUNTER1("gpu", "TransferBufferStalls", stall_count_);
+  TRACE_COUNTER1("gpu", "TransferBufferBytesWaitedOn", bytes_waited_on_);
   return ring_buffer_->Alloc(size);
 }
 
@@ -113,12 +113,24 @@ class GPU_EXPORT TransferBuffer : public TransferBufferInterface {
   unsigned int GetCurrentMaxAllocationWithoutRealloc() const;
   unsigned int GetMaxAllocation() const;
 
+  // The number of allocations that had to wait for the service to consume
+  // earlier ones, and the bytes they asked for.
+  unsigned int stall_count() const {
+    return stall_count_;
+  }
+  unsigned int bytes_waited_on() const {
+    return bytes_waited_on_;
+  }
+
  private:
   // Tries to reallocate the ring buffer if it's not large enough for size.
   void ReallocateRingBuffer(unsigned int size);
 
   void AllocateRingBuffer(unsigned int size);
 
+  // Allocates from the ring buffer, recording a stall if it has to wait.
+  void* AllocFromRingBuffer(unsigned int size);
+
   CommandBufferHelper* helper_;
   scoped_ptr<AlignedRingBuffer> ring_buffer_;
 
@@ -143,6 +155,10 @@ class GPU_EXPORT TransferBuffer : public TransferBufferInterface {
   // Number of bytes since we last flushed.
   unsigned int bytes_since_last_flush_;
 
+  // Stall statistics, reported as trace counters.
+  unsigned int stall_count_;
+  unsigned int bytes_waited_on_;
+
   // the current buffer.
   gpu::Buffer buffer_;
 
@@ -200,6 +200,22 @@ TEST_F(TransferBufferTest, Flush) {
   }
 }
 
+TEST_F(TransferBufferTest, CountsStalls) {
+  Initialize(0);
+  const unsigned int kSize = kTransferBufferSize - kStartingOffset;
+  void* ptr = transfer_buffer_->Alloc(kSize);
+  ASSERT_TRUE(ptr != NULL);
+  EXPECT_EQ(0u, transfer_buffer_->stall_count());
+  transfer_buffer_->FreePendingToken(ptr, 1);
+
+  // The buffer is full, so this has to wait for the token.
+  ptr = transfer_buffer_->Alloc(8u);
+  ASSERT_TRUE(ptr != NULL);
+  EXPECT_EQ(1u, transfer_buffer_->stall_count());
+  EXPECT_EQ(8u, transfer_buffer_->bytes_waited_on());
+  transfer_buffer_->FreePendingToken(ptr, 1);
+}
+
 class MockClientCommandBufferCanFail : public MockClientCommandBufferMockFlush {
  public:
   MockClientCommandBufferCanFail() {
@@ -135,6 +135,7 @@ static GLES2Util::EnumToString enum_to_string_table[] = {
   { 0x8363, "GL_UNSIGNED_SHORT_5_6_5", },
   { 0x8814, "GL_RGBA32F_EXT", },
   { 0x84F2, "GL_ALL_COMPLETED_NV", },
+  { 0x6005, "GL_ASYNC_TEXTURE_UPLOADS_COMPLETED_CHROMIUM", },
   { 0x8816, "GL_ALPHA32F_EXT", },
   { 0x84F4, "GL_FENCE_CONDITION_NV", },
   { 0x8366, "GL_UNSIGNED_SHORT_1_5_5_5_REV_EXT", },
@@ -948,6 +949,8 @@ std::string GLES2Util::GetStringQueryTarget(uint32 value) {
     { GL_ANY_SAMPLES_PASSED_CONSERVATIVE_EXT,
     "GL_ANY_SAMPLES_PASSED_CONSERVATIVE_EXT" },
     { GL_COMMANDS_ISSUED_CHROMIUM, "GL_COMMANDS_ISSUED_CHROMIUM" },
+    { GL_ASYNC_TEXTURE_UPLOADS_COMPLETED_CHROMIUM,
+    "GL_ASYNC_TEXTURE_UPLOADS_COMPLETED_CHROMIUM" },
   };
   return GLES2Util::GetQualifiedEnumString(
       string_table, arraysize(string_table), value);
@@ -27,6 +27,7 @@
 #define TRACE_EVENT_IF_LONGER_THAN0(x0, x1, x2) { }
 #define TRACE_EVENT_IF_LONGER_THAN1(x0, x1, x2, x3, x4) { }
 #define TRACE_EVENT_IF_LONGER_THAN2(x0, x1, x2, x3, x4, x5, x6) { }
+#define TRACE_COUNTER1(x0, x1, x2) { }
 
 #endif  // __native_client__
 
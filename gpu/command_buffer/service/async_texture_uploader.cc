@@ -0,0 +1,124 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/async_texture_uploader.h"
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/debug/trace_event.h"
+#include "base/logging.h"
+#include "base/synchronization/waitable_event.h"
+#include "gpu/command_buffer/service/gl_utils.h"
+#include "ui/gfx/gl/gl_context.h"
+#include "ui/gfx/gl/gl_surface.h"
+#include "ui/gfx/size.h"
+
+namespace gpu {
+namespace gles2 {
+
+namespace {
+
+void SignalEvent(base::WaitableEvent* event) {
+  event->Signal();
+}
+
+}  // anonymous namespace
+
+// static
+AsyncTextureUploader* AsyncTextureUploader::Create(
+    gfx::GLContext* decoder_context, gfx::GLSurface* decoder_surface) {
+  scoped_refptr<gfx::GLSurface> surface(
+      gfx::GLSurface::CreateOffscreenGLSurface(false, gfx::Size(1, 1)));
+  scoped_refptr<gfx::GLContext> context;
+  if (surface.get()) {
+    context = gfx::GLContext::CreateGLContext(
+        decoder_context->share_group(), surface.get(),
+        gfx::PreferIntegratedGpu);
+  }
+
+  // Creating the context may have changed the current one.
+  if (!decoder_context->MakeCurrent(decoder_surface)) {
+    LOG(ERROR) << "Could not restore the context after creating the "
+               << "texture upload context.";
+    return NULL;
+  }
+  if (!context.get()) {
+    LOG(ERROR) << "Could not create the texture upload context.";
+    return NULL;
+  }
+
+  scoped_ptr<AsyncTextureUploader> uploader(
+      new AsyncTextureUploader(surface.get(), context.get()));
+  if (!uploader->Start())
+    return NULL;
+  return uploader.release();
+}
+
+AsyncTextureUploader::AsyncTextureUploader(gfx::GLSurface* surface,
+                                           gfx::GLContext* context)
+    : thread_("GpuTextureUploadThread"),
+      surface_(surface),
+      context_(context),
+      posted_serial_(0),
+      completed_serial_(0) {
+}
+
+AsyncTextureUploader::~AsyncTextureUploader() {
+  if (thread_.IsRunning()) {
+    thread_.message_loop()->PostTask(
+        FROM_HERE,
+        base::Bind(&AsyncTextureUploader::ReleaseContext,
+                   base::Unretained(this)));
+    thread_.Stop();
+  }
+}
+
+bool AsyncTextureUploader::Start() {
+  if (!thread_.Start()) {
+    LOG(ERROR) << "Could not start the texture upload thread.";
+    return false;
+  }
+  return true;
+}
+
+uint32 AsyncTextureUploader::PostUpload(const base::Closure& upload) {
+  ++posted_serial_;
+  thread_.message_loop()->PostTask(
+      FROM_HERE,
+      base::Bind(&AsyncTextureUploader::RunUpload, base::Unretained(this),
+                 upload, posted_serial_));
+  return posted_serial_;
+}
+
+void AsyncTextureUploader::WaitForPendingUploads() {
+  if (!HasPendingUploads())
+    return;
+  TRACE_EVENT0("gpu", "AsyncTextureUploader::WaitForPendingUploads");
+  base::WaitableEvent event(false, false);
+  thread_.message_loop()->PostTask(
+      FROM_HERE, base::Bind(&SignalEvent, base::Unretained(&event)));
+  event.Wait();
+}
+
+void AsyncTextureUploader::RunUpload(const base::Closure& upload,
+                                     uint32 serial) {
+  TRACE_EVENT0("gpu", "AsyncTextureUploader::RunUpload");
+  if (context_->MakeCurrent(surface_.get())) {
+    upload.Run();
+    // The other contexts of the share group may only use the texture once the
+    // upload is complete.
+    glFinish();
+  } else {
+    LOG(ERROR) << "Could not make the texture upload context current.";
+  }
+  base::subtle::Release_Store(&completed_serial_,
+                              static_cast<base::subtle::Atomic32>(serial));
+}
+
+void AsyncTextureUploader::ReleaseContext() {
+  context_->ReleaseCurrent(surface_.get());
+}
+
+}  // namespace gles2
+}  // namespace gpu
@@ -0,0 +1,84 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GPU_COMMAND_BUFFER_SERVICE_ASYNC_TEXTURE_UPLOADER_H_
+#define GPU_COMMAND_BUFFER_SERVICE_ASYNC_TEXTURE_UPLOADER_H_
+
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/threading/thread.h"
+#include "gpu/gpu_export.h"
+
+namespace gfx {
+class GLContext;
+class GLSurface;
+}
+
+namespace gpu {
+namespace gles2 {
+
+// Runs texture uploads on a dedicated thread that has its own GL context in
+// the share group of the decoder's context, so that large glTexImage2D calls
+// do not stall the command stream. Uploads run in the order they are posted.
+class GPU_EXPORT AsyncTextureUploader {
+ public:
+  // Creates an uploader whose context shares with |decoder_context|, which is
+  // made current on |decoder_surface| again before returning. Returns NULL if
+  // the upload context could not be created, in which case uploads should be
+  // done synchronously.
+  static AsyncTextureUploader* Create(gfx::GLContext* decoder_context,
+                                      gfx::GLSurface* decoder_surface);
+
+  // Waits for the pending uploads to complete.
+  ~AsyncTextureUploader();
+
+  // Runs |upload| on the upload thread with the upload context current.
+  // Returns the serial of the upload.
+  uint32 PostUpload(const base::Closure& upload);
+
+  // The serial of the last upload whose results are visible to the other
+  // contexts of the share group.
+  uint32 completed_serial() const {
+    return static_cast<uint32>(base::subtle::Acquire_Load(&completed_serial_));
+  }
+
+  // The serial of the last posted upload.
+  uint32 posted_serial() const {
+    return posted_serial_;
+  }
+
+  bool HasPendingUploads() const {
+    return completed_serial() != posted_serial_;
+  }
+
+  // Blocks until all the posted uploads have completed. Used before textures
+  // that might still be uploading are deleted.
+  void WaitForPendingUploads();
+
+ private:
+  AsyncTextureUploader(gfx::GLSurface* surface, gfx::GLContext* context);
+
+  bool Start();
+
+  // Run on the upload thread.
+  void RunUpload(const base::Closure& upload, uint32 serial);
+  void ReleaseContext();
+
+  base::Thread thread_;
+  scoped_refptr<gfx::GLSurface> surface_;
+  scoped_refptr<gfx::GLContext> context_;
+
+  uint32 posted_serial_;
+  base::subtle::Atomic32 completed_serial_;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncTextureUploader);
+};
+
+}  // namespace gles2
+}  // namespace gpu
+
+#endif  // GPU_COMMAND_BUFFER_SERVICE_ASYNC_TEXTURE_UPLOADER_H_
@@ -0,0 +1,232 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/command_buffer_recorder.h"
+
+#include <string.h>
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "gpu/command_buffer/common/command_buffer.h"
+
+namespace gpu {
+
+namespace {
+
+const uint32 kRecordingMagic = 0x52424347;  // 'GCBR'
+const uint32 kRecordingVersion = 1;
+
+const uint32 kFlagOffscreen = 1 << 0;
+const uint32 kFlagBindGeneratesResource = 1 << 1;
+
+// Upper bounds that keep a corrupt recording from allocating huge amounts of
+// memory.
+const uint32 kMaxAttribs = 1024;
+const uint32 kMaxDataSize = 256 * 1024 * 1024;
+
+void WriteUint32(FILE* file, uint32 value) {
+  fwrite(&value, sizeof(value), 1, file);
+}
+
+bool ReadUint32(FILE* file, uint32* value) {
+  return fread(value, sizeof(*value), 1, file) == 1;
+}
+
+}  // anonymous namespace
+
+CommandBufferRecord::CommandBufferRecord()
+    : type(kCommandBufferRecordFlush),
+      id(0),
+      buffer_size(0),
+      offscreen(false),
+      bind_generates_resource(false) {
+}
+
+CommandBufferRecord::~CommandBufferRecord() {
+}
+
+// static
+CommandBufferRecorder* CommandBufferRecorder::Create(const FilePath& path) {
+  FILE* file = file_util::OpenFile(path, "wb");
+  if (!file) {
+    LOG(ERROR) << "Could not open " << path.value() << " for recording.";
+    return NULL;
+  }
+  WriteUint32(file, kRecordingMagic);
+  WriteUint32(file, kRecordingVersion);
+  return new CommandBufferRecorder(file);
+}
+
+CommandBufferRecorder::CommandBufferRecorder(FILE* file)
+    : file_(file) {
+}
+
+CommandBufferRecorder::~CommandBufferRecorder() {
+  file_util::CloseFile(file_);
+}
+
+void CommandBufferRecorder::RecordInitialize(
+    bool offscreen,
+    bool bind_generates_resource,
+    const gfx::Size& size,
+    const std::string& allowed_extensions,
+    const std::vector<int32>& attribs) {
+  CommandBufferRecord record;
+  record.type = kCommandBufferRecordInitialize;
+  record.offscreen = offscreen;
+  record.bind_generates_resource = bind_generates_resource;
+  record.size = size;
+  record.attribs = attribs;
+  record.data = allowed_extensions;
+  WriteRecord(record);
+}
+
+void CommandBufferRecorder::RecordCreateTransferBuffer(int32 id, uint32 size) {
+  // The contents are recorded on the next flush.
+  buffer_contents_[id].clear();
+
+  CommandBufferRecord record;
+  record.type = kCommandBufferRecordCreateTransferBuffer;
+  record.id = id;
+  record.buffer_size = size;
+  WriteRecord(record);
+}
+
+void CommandBufferRecorder::RecordDestroyTransferBuffer(int32 id) {
+  buffer_contents_.erase(id);
+
+  CommandBufferRecord record;
+  record.type = kCommandBufferRecordDestroyTransferBuffer;
+  record.id = id;
+  WriteRecord(record);
+}
+
+void CommandBufferRecorder::RecordSetGetBuffer(int32 id) {
+  CommandBufferRecord record;
+  record.type = kCommandBufferRecordSetGetBuffer;
+  record.id = id;
+  WriteRecord(record);
+}
+
+void CommandBufferRecorder::RecordFlush(CommandBuffer* command_buffer,
+                                        int32 put_offset) {
+  for (BufferContentsMap::iterator it = buffer_contents_.begin();
+       it != buffer_contents_.end(); ++it) {
+    Buffer buffer = command_buffer->GetTransferBuffer(it->first);
+    if (!buffer.ptr)
+      continue;
+    std::string& contents = it->second;
+    if (contents.size() == buffer.size &&
+        memcmp(contents.data(), buffer.ptr, buffer.size) == 0) {
+      continue;
+    }
+    contents.assign(static_cast<const char*>(buffer.ptr), buffer.size);
+
+    CommandBufferRecord record;
+    record.type = kCommandBufferRecordTransferBufferContents;
+    record.id = it->first;
+    record.data = contents;
+    WriteRecord(record);
+  }
+
+  CommandBufferRecord record;
+  record.type = kCommandBufferRecordFlush;
+  record.id = put_offset;
+  WriteRecord(record);
+  fflush(file_);
+}
+
+void CommandBufferRecorder::WriteRecord(const CommandBufferRecord& record) {
+  uint32 flags = 0;
+  if (record.offscreen)
+    flags |= kFlagOffscreen;
+  if (record.bind_generates_resource)
+    flags |= kFlagBindGeneratesResource;
+
+  WriteUint32(file_, record.type);
+  WriteUint32(file_, static_cast<uint32>(record.id));
+  WriteUint32(file_, record.buffer_size);
+  WriteUint32(file_, flags);
+  WriteUint32(file_, static_cast<uint32>(record.size.width()));
+  WriteUint32(file_, static_cast<uint32>(record.size.height()));
+  WriteUint32(file_, static_cast<uint32>(record.attribs.size()));
+  for (size_t ii = 0; ii < record.attribs.size(); ++ii)
+    WriteUint32(file_, static_cast<uint32>(record.attribs[ii]));
+  WriteUint32(file_, static_cast<uint32>(record.data.size()));
+  if (!record.data.empty())
+    fwrite(record.data.data(), 1, record.data.size(), file_);
+}
+
+// static
+CommandBufferRecordReader* CommandBufferRecordReader::Create(
+    const FilePath& path) {
+  FILE* file = file_util::OpenFile(path, "rb");
+  if (!file) {
+    LOG(ERROR) << "Could not open " << path.value() << ".";
+    return NULL;
+  }
+  uint32 magic = 0;
+  uint32 version = 0;
+  if (!ReadUint32(file, &magic) || magic != kRecordingMagic ||
+      !ReadUint32(file, &version) || version != kRecordingVersion) {
+    LOG(ERROR) << path.value() << " is not a command buffer recording.";
+    file_util::CloseFile(file);
+    return NULL;
+  }
+  return new CommandBufferRecordReader(file);
+}
+
+CommandBufferRecordReader::CommandBufferRecordReader(FILE* file)
+    : file_(file) {
+}
+
+CommandBufferRecordReader::~CommandBufferRecordReader() {
+  file_util::CloseFile(file_);
+}
+
+bool CommandBufferRecordReader::ReadRecord(CommandBufferRecord* record) {
+  uint32 type = 0;
+  uint32 id = 0;
+  uint32 flags = 0;
+  uint32 width = 0;
+  uint32 height = 0;
+  uint32 num_attribs = 0;
+  if (!ReadUint32(file_, &type) ||
+      type > kCommandBufferRecordFlush ||
+      !ReadUint32(file_, &id) ||
+      !ReadUint32(file_, &record->buffer_size) ||
+      !ReadUint32(file_, &flags) ||
+      !ReadUint32(file_, &width) ||
+      !ReadUint32(file_, &height) ||
+      !ReadUint32(file_, &num_attribs) ||
+      num_attribs > kMaxAttribs) {
+    return false;
+  }
+  record->type = static_cast<CommandBufferRecordType>(type);
+  record->id = static_cast<int32>(id);
+  record->offscreen = (flags & kFlagOffscreen) != 0;
+  record->bind_generates_resource = (flags & kFlagBindGeneratesResource) != 0;
+  record->size.SetSize(static_cast<int>(width), static_cast<int>(height));
+
+  record->attribs.resize(num_attribs);
+  for (uint32 ii = 0; ii < num_attribs; ++ii) {
+    uint32 attrib = 0;
+    if (!ReadUint32(file_, &attrib))
+      return false;
+    record->attribs[ii] = static_cast<int32>(attrib);
+  }
+
+  uint32 data_size = 0;
+  if (!ReadUint32(file_, &data_size) || data_size > kMaxDataSize)
+    return false;
+  record->data.resize(data_size);
+  if (data_size &&
+      fread(&record->data[0], 1, data_size, file_) != data_size) {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace gpu
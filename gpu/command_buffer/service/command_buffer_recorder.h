@@ -0,0 +1,125 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Records the commands and transfer buffer contents a command buffer receives
+// so that they can be replayed against a decoder by
+// gpu/tools/command_buffer_replay.
+
+#ifndef GPU_COMMAND_BUFFER_SERVICE_COMMAND_BUFFER_RECORDER_H_
+#define GPU_COMMAND_BUFFER_SERVICE_COMMAND_BUFFER_RECORDER_H_
+
+#include <stdio.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "gpu/gpu_export.h"
+#include "ui/gfx/size.h"
+
+class FilePath;
+
+namespace gpu {
+
+class CommandBuffer;
+
+enum CommandBufferRecordType {
+  // The arguments the decoder was initialized with.
+  kCommandBufferRecordInitialize,
+  // A transfer buffer was created or registered with the id |id|.
+  kCommandBufferRecordCreateTransferBuffer,
+  kCommandBufferRecordDestroyTransferBuffer,
+  // The contents of transfer buffer |id| changed to |data|.
+  kCommandBufferRecordTransferBufferContents,
+  kCommandBufferRecordSetGetBuffer,
+  // The put offset was changed to |id|.
+  kCommandBufferRecordFlush,
+};
+
+struct GPU_EXPORT CommandBufferRecord {
+  CommandBufferRecord();
+  ~CommandBufferRecord();
+
+  CommandBufferRecordType type;
+
+  // The transfer buffer id, or the put offset of a flush.
+  int32 id;
+
+  // The size of a created transfer buffer.
+  uint32 buffer_size;
+
+  // The arguments of kCommandBufferRecordInitialize.
+  bool offscreen;
+  bool bind_generates_resource;
+  gfx::Size size;
+  std::vector<int32> attribs;
+
+  // The allowed extensions of kCommandBufferRecordInitialize or the contents
+  // of kCommandBufferRecordTransferBufferContents.
+  std::string data;
+};
+
+// Writes the records of a single command buffer to a file. Transfer buffers
+// are compared against their last recorded contents on every flush and
+// written out if they changed, so recording is slow and only meant for
+// capturing benchmark workloads.
+class GPU_EXPORT CommandBufferRecorder {
+ public:
+  // Returns NULL if |path| could not be opened for writing.
+  static CommandBufferRecorder* Create(const FilePath& path);
+
+  ~CommandBufferRecorder();
+
+  void RecordInitialize(bool offscreen,
+                        bool bind_generates_resource,
+                        const gfx::Size& size,
+                        const std::string& allowed_extensions,
+                        const std::vector<int32>& attribs);
+  void RecordCreateTransferBuffer(int32 id, uint32 size);
+  void RecordDestroyTransferBuffer(int32 id);
+  void RecordSetGetBuffer(int32 id);
+
+  // Records the transfer buffers of |command_buffer| that changed since the
+  // last flush, followed by the new put offset. Call before the flush is
+  // processed.
+  void RecordFlush(CommandBuffer* command_buffer, int32 put_offset);
+
+ private:
+  explicit CommandBufferRecorder(FILE* file);
+
+  void WriteRecord(const CommandBufferRecord& record);
+
+  FILE* file_;
+
+  // The last recorded contents of each transfer buffer.
+  typedef std::map<int32, std::string> BufferContentsMap;
+  BufferContentsMap buffer_contents_;
+
+  DISALLOW_COPY_AND_ASSIGN(CommandBufferRecorder);
+};
+
+// Reads back the records written by CommandBufferRecorder.
+class GPU_EXPORT CommandBufferRecordReader {
+ public:
+  // Returns NULL if |path| could not be opened or is not a recording.
+  static CommandBufferRecordReader* Create(const FilePath& path);
+
+  ~CommandBufferRecordReader();
+
+  // Reads the next record. Returns false at the end of the recording or if
+  // the recording is truncated.
+  bool ReadRecord(CommandBufferRecord* record);
+
+ private:
+  explicit CommandBufferRecordReader(FILE* file);
+
+  FILE* file_;
+
+  DISALLOW_COPY_AND_ASSIGN(CommandBufferRecordReader);
+};
+
+}  // namespace gpu
+
+#endif  // GPU_COMMAND_BUFFER_SERVICE_COMMAND_BUFFER_RECORDER_H_
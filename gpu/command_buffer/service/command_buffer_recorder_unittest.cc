@@ -0,0 +1,111 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include "base/file_util.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/scoped_temp_dir.h"
+#include "gpu/command_buffer/service/command_buffer_recorder.h"
+#include "gpu/command_buffer/service/command_buffer_service.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace gpu {
+
+class CommandBufferRecorderTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.path().AppendASCII("recording");
+  }
+
+  ScopedTempDir temp_dir_;
+  FilePath path_;
+};
+
+TEST_F(CommandBufferRecorderTest, RecordsOnlyChangedBuffers) {
+  CommandBufferService command_buffer;
+  ASSERT_TRUE(command_buffer.Initialize());
+  int32 id = command_buffer.CreateTransferBuffer(16, -1);
+  ASSERT_GE(id, 0);
+  Buffer buffer = command_buffer.GetTransferBuffer(id);
+  memset(buffer.ptr, 1, buffer.size);
+
+  std::vector<int32> attribs;
+  attribs.push_back(0x3038);  // EGL_NONE
+  {
+    scoped_ptr<CommandBufferRecorder> recorder(
+        CommandBufferRecorder::Create(path_));
+    ASSERT_TRUE(recorder.get() != NULL);
+    recorder->RecordInitialize(
+        true, false, gfx::Size(4, 2), "*", attribs);
+    recorder->RecordCreateTransferBuffer(id, buffer.size);
+    recorder->RecordSetGetBuffer(id);
+    recorder->RecordFlush(&command_buffer, 2);
+    // Nothing changed, so only the flush is recorded.
+    recorder->RecordFlush(&command_buffer, 3);
+    static_cast<char*>(buffer.ptr)[0] = 2;
+    recorder->RecordFlush(&command_buffer, 4);
+    recorder->RecordDestroyTransferBuffer(id);
+  }
+
+  scoped_ptr<CommandBufferRecordReader> reader(
+      CommandBufferRecordReader::Create(path_));
+  ASSERT_TRUE(reader.get() != NULL);
+  CommandBufferRecord record;
+
+  ASSERT_TRUE(reader->ReadRecord(&record));
+  EXPECT_EQ(kCommandBufferRecordInitialize, record.type);
+  EXPECT_TRUE(record.offscreen);
+  EXPECT_FALSE(record.bind_generates_resource);
+  EXPECT_EQ(gfx::Size(4, 2), record.size);
+  EXPECT_EQ("*", record.data);
+  EXPECT_TRUE(attribs == record.attribs);
+
+  ASSERT_TRUE(reader->ReadRecord(&record));
+  EXPECT_EQ(kCommandBufferRecordCreateTransferBuffer, record.type);
+  EXPECT_EQ(id, record.id);
+  EXPECT_EQ(buffer.size, record.buffer_size);
+
+  ASSERT_TRUE(reader->ReadRecord(&record));
+  EXPECT_EQ(kCommandBufferRecordSetGetBuffer, record.type);
+  EXPECT_EQ(id, record.id);
+
+  ASSERT_TRUE(reader->ReadRecord(&record));
+  EXPECT_EQ(kCommandBufferRecordTransferBufferContents, record.type);
+  EXPECT_EQ(id, record.id);
+  EXPECT_EQ(std::string(buffer.size, 1), record.data);
+
+  ASSERT_TRUE(reader->ReadRecord(&record));
+  EXPECT_EQ(kCommandBufferRecordFlush, record.type);
+  EXPECT_EQ(2, record.id);
+
+  ASSERT_TRUE(reader->ReadRecord(&record));
+  EXPECT_EQ(kCommandBufferRecordFlush, record.type);
+  EXPECT_EQ(3, record.id);
+
+  ASSERT_TRUE(reader->ReadRecord(&record));
+  EXPECT_EQ(kCommandBufferRecordTransferBufferContents, record.type);
+  EXPECT_EQ(2, record.data[0]);
+
+  ASSERT_TRUE(reader->ReadRecord(&record));
+  EXPECT_EQ(kCommandBufferRecordFlush, record.type);
+  EXPECT_EQ(4, record.id);
+
+  ASSERT_TRUE(reader->ReadRecord(&record));
+  EXPECT_EQ(kCommandBufferRecordDestroyTransferBuffer, record.type);
+
+  EXPECT_FALSE(reader->ReadRecord(&record));
+}
+
+TEST_F(CommandBufferRecorderTest, RejectsOtherFiles) {
+  const char kContents[] = "not a recording";
+  ASSERT_EQ(static_cast<int>(sizeof(kContents)),
+            file_util::WriteFile(path_, kContents, sizeof(kContents)));
+  scoped_ptr<CommandBufferRecordReader> reader(
+      CommandBufferRecordReader::Create(path_));
+  EXPECT_TRUE(reader.get() == NULL);
+}
+
+}  // namespace gpu
@@ -27,6 +27,7 @@ class GLES2Decoder;
 class FramebufferManager;
 class MailboxManager;
 class RenderbufferManager;
+class ProgramCache;
 class ProgramManager;
 class ShaderManager;
 class TextureManager;
@@ -38,8 +39,11 @@ class GPU_EXPORT ContextGroup : public base::RefCounted<ContextGroup> {
  public:
   typedef scoped_refptr<ContextGroup> Ref;
 
-  explicit ContextGroup(MailboxManager* mailbox_manager,
-                        bool bind_generates_resource);
+  // |program_cache| is not owned and may be NULL. It is only used if the
+  // driver supports retrieving program binaries.
+  ContextGroup(MailboxManager* mailbox_manager,
+               ProgramCache* program_cache,
+               bool bind_generates_resource);
   ~ContextGroup();
 
   // This should only be called by GLES2Decoder. This must be paired with a
@@ -124,6 +128,7 @@ class GPU_EXPORT ContextGroup : public base::RefCounted<ContextGroup> {
   bool QueryGLFeatureU(GLenum pname, GLint min_required, uint32* v);
 
   scoped_refptr<MailboxManager> mailbox_manager_;
+  ProgramCache* program_cache_;
 
   // Whether or not this context is initialized.
   int num_contexts_;
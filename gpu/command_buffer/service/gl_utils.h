@@ -85,6 +85,14 @@
 // GL_CHROMIUM_command_buffer_query
 #define GL_COMMANDS_ISSUED_CHROMIUM            0x84F2
 
+// GL_CHROMIUM_async_texture_upload
+#define GL_ASYNC_TEXTURE_UPLOADS_COMPLETED_CHROMIUM 0x6005
+
+// GL_OES_get_program_binary
+#define GL_PROGRAM_BINARY_LENGTH_OES           0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS_OES      0x87FE
+#define GL_PROGRAM_BINARY_FORMATS_OES          0x87FF
+
 
 #define GL_GLEXT_PROTOTYPES 1
 
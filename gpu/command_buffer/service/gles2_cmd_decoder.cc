@@ -15,6 +15,7 @@
 #include "base/at_exit.h"
 #include "base/atomicops.h"
 #include "base/bind.h"
+#include "base/bind_helpers.h"
 #include "base/command_line.h"
 #include "base/debug/trace_event.h"
 #if defined(OS_MACOSX)
@@ -27,6 +28,7 @@
 #include "gpu/command_buffer/common/gles2_cmd_format.h"
 #include "gpu/command_buffer/common/gles2_cmd_utils.h"
 #include "gpu/command_buffer/common/id_allocator.h"
+#include "gpu/command_buffer/service/async_texture_uploader.h"
 #include "gpu/command_buffer/service/buffer_manager.h"
 #include "gpu/command_buffer/service/cmd_buffer_engine.h"
 #include "gpu/command_buffer/service/context_group.h"
@@ -174,6 +176,29 @@ static inline GLenum GetTexInternalFormat(GLenum internal_format) {
   return internal_format;
 }
 
+// The pixels of an asynchronous texture upload, copied out of shared memory
+// so that the client may reuse the transfer buffer right away.
+struct AsyncTexSubImage2DParams {
+  GLuint service_id;
+  GLenum target;
+  GLint level;
+  GLsizei width;
+  GLsizei height;
+  GLenum format;
+  GLenum type;
+  GLint unpack_alignment;
+  std::vector<uint8> pixels;
+};
+
+// Runs on the texture upload thread.
+static void DoAsyncTexSubImage2D(AsyncTexSubImage2DParams* params) {
+  glBindTexture(params->target, params->service_id);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, params->unpack_alignment);
+  glTexSubImage2D(params->target, params->level, 0, 0, params->width,
+                  params->height, params->format, params->type,
+                  &params->pixels[0]);
+}
+
 static void WrappedTexImage2D(
     GLenum target,
     GLint level,
@@ -579,6 +604,9 @@ class GLES2DecoderImpl : public base::SupportsWeakPtr<GLES2DecoderImpl>,
       if (bound_texture_external_oes == texture) {
         bound_texture_external_oes = NULL;
       }
+      if (bound_texture_rectangle_arb == texture) {
+        bound_texture_rectangle_arb = NULL;
+      }
     }
   };
 
@@ -1457,6 +1485,10 @@ class GLES2DecoderImpl : public base::SupportsWeakPtr<GLES2DecoderImpl>,
   scoped_ptr<QueryManager> query_manager_;
   QueryManager::Query::Ref current_query_;
 
+  // Created on the first glAsyncTexImage2DCHROMIUM.
+  scoped_ptr<AsyncTextureUploader> async_texture_uploader_;
+  bool async_texture_uploader_failed_;
+
   base::Callback<void(gfx::Size)> resize_callback_;
 
   MsgCallback msg_callback_;
@@ -1899,6 +1931,7 @@ GLES2DecoderImpl::GLES2DecoderImpl(ContextGroup* group)
       offscreen_target_samples_(0),
       offscreen_target_buffer_preserved_(true),
       offscreen_saved_color_format_(0),
+      async_texture_uploader_failed_(false),
       stream_texture_manager_(NULL),
       back_buffer_color_format_(0),
       back_buffer_has_depth_(false),
@@ -2454,6 +2487,9 @@ void GLES2DecoderImpl::DeleteTexturesHelper(
     GLsizei n, const GLuint* client_ids) {
   bool supports_seperate_framebuffer_binds =
      feature_info_->feature_flags().chromium_framebuffer_multisample;
+  // An upload may still be writing to one of the textures.
+  if (async_texture_uploader_.get())
+    async_texture_uploader_->WaitForPendingUploads();
   for (GLsizei ii = 0; ii < n; ++ii) {
     TextureManager::TextureInfo* texture = GetTextureInfo(client_ids[ii]);
     if (texture && !texture->IsDeleted()) {
@@ -2802,7 +2838,11 @@ void GLES2DecoderImpl::Destroy() {
   }
   copy_texture_CHROMIUM_.reset();
 
+  // Stops the upload thread once the pending uploads have run.
+  async_texture_uploader_.reset();
+
   if (query_manager_.get()) {
+    query_manager_->set_async_texture_uploader(NULL);
     query_manager_->Destroy(have_context);
     query_manager_.reset();
   }
@@ -3405,7 +3445,11 @@ void GLES2DecoderImpl::DoBindTexture(GLenum target, GLuint client_id) {
   if (info->target() == 0) {
     texture_manager()->SetInfoTarget(info, target);
   }
-  glBindTexture(target, info->service_id());
+  // Compositors rebind the same textures every frame. Binding the texture
+  // that is already bound is a no-op, so only make the GL call when the
+  // binding changes. Stream textures are still updated below.
+  if (info != GetTextureInfoForTarget(target))
+    glBindTexture(target, info->service_id());
   TextureUnit& unit = texture_units_[active_texture_unit_];
   unit.bind_target = target;
   switch (target) {
@@ -4093,9 +4137,13 @@ void GLES2DecoderImpl::DoFramebufferRenderbuffer(
 bool GLES2DecoderImpl::SetCapabilityState(GLenum cap, bool enabled) {
   switch (cap) {
     case GL_CULL_FACE:
+      if (enable_cull_face_ == enabled)
+        return false;
       enable_cull_face_ = enabled;
       return true;
     case GL_SCISSOR_TEST:
+      if (enable_scissor_test_ == enabled)
+        return false;
       enable_scissor_test_ = enabled;
       return true;
     case GL_DEPTH_TEST: {
@@ -4805,6 +4853,8 @@ void GLES2DecoderImpl::DoUseProgram(GLuint program) {
     }
     service_id = info->service_id();
   }
+  if (info == current_program_)
+    return;
   if (current_program_) {
     program_manager()->UnuseProgram(shader_manager(), current_program_);
   }
@@ -4920,16 +4970,12 @@ void GLES2DecoderImpl::RestoreStateForNonRenderableTextures() {
       if (texture_unit_index < group_->max_texture_units()) {
         TextureUnit& texture_unit = texture_units_[texture_unit_index];
         TextureManager::TextureInfo* texture_info =
-            uniform_info->type == GL_SAMPLER_2D ?
-                texture_unit.bound_texture_2d :
-                texture_unit.bound_texture_cube_map;
+            texture_unit.GetInfoForSamplerType(uniform_info->type);
         if (!texture_info || !texture_manager()->CanRender(texture_info)) {
           glActiveTexture(GL_TEXTURE0 + texture_unit_index);
-          // Get the texture info that was previously bound here.
-          texture_info = texture_unit.bind_target == GL_TEXTURE_2D ?
-              texture_unit.bound_texture_2d :
-              texture_unit.bound_texture_cube_map;
-          glBindTexture(texture_unit.bind_target,
+          // Rebind the texture that was replaced by the black texture, so that
+          // the GL bindings match the ones DoBindTexture compares against.
+          glBindTexture(GetBindTargetForSamplerType(uniform_info->type),
                         texture_info ? texture_info->service_id() : 0);
         }
       }
@@ -6922,6 +6968,84 @@ error::Error GLES2DecoderImpl::HandleTexImage2D(
       pixels, pixels_size);
 }
 
+error::Error GLES2DecoderImpl::HandleAsyncTexImage2DCHROMIUM(
+    uint32 immediate_data_size, const gles2::AsyncTexImage2DCHROMIUM& c) {
+  TRACE_EVENT0("gpu", "GLES2DecoderImpl::HandleAsyncTexImage2DCHROMIUM");
+  tex_image_2d_failed_ = true;
+  GLenum target = static_cast<GLenum>(c.target);
+  GLint level = static_cast<GLint>(c.level);
+  GLint internal_format = static_cast<GLint>(c.internalformat);
+  GLsizei width = static_cast<GLsizei>(c.width);
+  GLsizei height = static_cast<GLsizei>(c.height);
+  GLint border = static_cast<GLint>(c.border);
+  GLenum format = static_cast<GLenum>(c.format);
+  GLenum type = static_cast<GLenum>(c.type);
+  uint32 pixels_shm_id = static_cast<uint32>(c.pixels_shm_id);
+  uint32 pixels_shm_offset = static_cast<uint32>(c.pixels_shm_offset);
+  uint32 pixels_size;
+  if (!GLES2Util::ComputeImageDataSizes(
+      width, height, format, type, unpack_alignment_, &pixels_size, NULL,
+      NULL)) {
+    return error::kOutOfBounds;
+  }
+  const void* pixels = NULL;
+  if (pixels_shm_id != 0 || pixels_shm_offset != 0) {
+    pixels = GetSharedMemoryAs<const void*>(
+        pixels_shm_id, pixels_shm_offset, pixels_size);
+    if (!pixels) {
+      return error::kOutOfBounds;
+    }
+  }
+
+  if (!async_texture_uploader_.get() && !async_texture_uploader_failed_) {
+    async_texture_uploader_.reset(
+        AsyncTextureUploader::Create(context_.get(), surface_.get()));
+    async_texture_uploader_failed_ = !async_texture_uploader_.get();
+    query_manager_->set_async_texture_uploader(async_texture_uploader_.get());
+  }
+
+  // Anything but a plain 2D upload is done synchronously.
+  if (!pixels || pixels_size == 0 || target != GL_TEXTURE_2D ||
+      !async_texture_uploader_.get()) {
+    return DoTexImage2D(
+        target, level, internal_format, width, height, border, format, type,
+        pixels, pixels_size);
+  }
+
+  // Define the level without contents here so that it is validated and
+  // tracked like any other, then fill it in on the upload thread.
+  DoTexImage2D(
+      target, level, internal_format, width, height, border, format, type,
+      NULL, pixels_size);
+  if (tex_image_2d_failed_)
+    return error::kNoError;
+  TextureManager::TextureInfo* info = GetTextureInfoForTarget(target);
+  DCHECK(info);
+
+  // The upload context must see the new level before writing to it.
+  glFlush();
+
+  AsyncTexSubImage2DParams* params = new AsyncTexSubImage2DParams;
+  params->service_id = info->service_id();
+  params->target = target;
+  params->level = level;
+  params->width = width;
+  params->height = height;
+  params->format = format;
+  params->type = type;
+  params->unpack_alignment = unpack_alignment_;
+  const uint8* data = static_cast<const uint8*>(pixels);
+  params->pixels.assign(data, data + pixels_size);
+  async_texture_uploader_->PostUpload(
+      base::Bind(&DoAsyncTexSubImage2D, base::Owned(params)));
+
+  // The contents are undefined until a
+  // GL_ASYNC_TEXTURE_UPLOADS_COMPLETED_CHROMIUM query ended after this
+  // command completes, which the client must wait for.
+  texture_manager()->SetLevelCleared(info, target, level);
+  return error::kNoError;
+}
+
 error::Error GLES2DecoderImpl::HandleTexImage2DImmediate(
     uint32 immediate_data_size, const gles2::TexImage2DImmediate& c) {
   GLenum target = static_cast<GLenum>(c.target);
@@ -8050,6 +8174,7 @@ error::Error GLES2DecoderImpl::HandleBeginQueryEXT(
 
   switch (target) {
     case GL_COMMANDS_ISSUED_CHROMIUM:
+    case GL_ASYNC_TEXTURE_UPLOADS_COMPLETED_CHROMIUM:
       break;
     default:
       if (!feature_info_->feature_flags().occlusion_query_boolean) {
@@ -10,6 +10,9 @@ namespace switches {
 // Turn on Calling GL Error after every command.
 const char kCompileShaderAlwaysSucceeds[]   = "compile-shader-always-succeeds";
 
+// Disable the in-memory cache of linked program binaries.
+const char kDisableGpuProgramCache[]        = "disable-gpu-program-cache";
+
 // Disable the GLSL translator.
 const char kDisableGLSLTranslator[]         = "disable-glsl-translator";
 
@@ -22,12 +25,19 @@ const char kEnableGPUDebugging[]            = "enable-gpu-debugging";
 // Enforce GL minimums.
 const char kEnforceGLMinimums[]             = "enforce-gl-minimums";
 
+// Records the commands of every command buffer to a file in the given
+// directory, for replaying with gpu/tools/command_buffer_replay. The GPU
+// process must not be sandboxed.
+const char kRecordGPUCommandBuffers[]       = "record-gpu-command-buffers";
+
 const char* kGpuSwitches[] = {
   kCompileShaderAlwaysSucceeds,
+  kDisableGpuProgramCache,
   kDisableGLSLTranslator,
   kEnableGPUCommandLogging,
   kEnableGPUDebugging,
   kEnforceGLMinimums,
+  kRecordGPUCommandBuffers,
 };
 
 const int kNumGpuSwitches = arraysize(kGpuSwitches);
@@ -0,0 +1,156 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/program_cache.h"
+
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "base/sha1.h"
+#include "base/string_number_conversions.h"
+
+namespace gpu {
+namespace gles2 {
+
+namespace {
+
+std::string GetGLString(GLenum name) {
+  const char* str = reinterpret_cast<const char*>(glGetString(name));
+  return str ? std::string(str) : std::string();
+}
+
+}  // anonymous namespace
+
+ProgramCache::ProgramEntry::ProgramEntry()
+    : format(0) {
+}
+
+ProgramCache::ProgramEntry::ProgramEntry(GLenum format,
+                                         const std::string& binary)
+    : format(format),
+      binary(binary) {
+}
+
+ProgramCache::ProgramEntry::~ProgramEntry() {
+}
+
+ProgramCache::ProgramCache(size_t max_cache_size_bytes)
+    : entries_(EntryMap::NO_AUTO_EVICT),
+      max_size_bytes_(max_cache_size_bytes),
+      size_bytes_(0) {
+}
+
+ProgramCache::~ProgramCache() {
+}
+
+std::string ProgramCache::ComputeKey(
+    const std::string& vertex_source,
+    const std::string& fragment_source,
+    const std::map<std::string, GLint>& bind_attrib_location_map) {
+  if (driver_identity_.empty()) {
+    driver_identity_ = GetGLString(GL_VENDOR) + '\0' +
+                       GetGLString(GL_RENDERER) + '\0' +
+                       GetGLString(GL_VERSION);
+  }
+
+  std::string data(driver_identity_);
+  data += '\0';
+  data += vertex_source;
+  data += '\0';
+  data += fragment_source;
+  data += '\0';
+  for (std::map<std::string, GLint>::const_iterator it =
+           bind_attrib_location_map.begin();
+       it != bind_attrib_location_map.end(); ++it) {
+    data += it->first;
+    data += '=';
+    data += base::IntToString(it->second);
+    data += '\0';
+  }
+  return base::SHA1HashString(data);
+}
+
+bool ProgramCache::LoadProgram(const std::string& key, GLuint program) {
+  EntryMap::iterator it = entries_.Get(key);
+  if (it == entries_.end())
+    return false;
+
+  const ProgramEntry& entry = it->second;
+  glProgramBinary(program, entry.format, entry.binary.data(),
+                  static_cast<GLsizei>(entry.binary.size()));
+  GLint success = 0;
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (success != GL_TRUE) {
+    // The driver was updated or the binary was produced by another GPU.
+    EvictEntry(it);
+    return false;
+  }
+  return true;
+}
+
+void ProgramCache::SaveProgram(const std::string& key, GLuint program) {
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+  if (length <= 0 || static_cast<size_t>(length) > max_size_bytes_)
+    return;
+
+  std::string binary(length, '\0');
+  GLsizei written = 0;
+  GLenum format = 0;
+  glGetProgramBinary(program, length, &written, &format, &binary[0]);
+  if (written <= 0 || written > length)
+    return;
+  binary.resize(written);
+
+  ProgramEntry entry(format, binary);
+  AddEntry(key, entry);
+
+  if (!program_cache_callback_.is_null()) {
+    Pickle pickle;
+    pickle.WriteUInt32(format);
+    pickle.WriteString(binary);
+    program_cache_callback_.Run(
+        key, std::string(static_cast<const char*>(pickle.data()),
+                         pickle.size()));
+  }
+}
+
+bool ProgramCache::LoadSerializedEntry(const std::string& key,
+                                       const std::string& serialized) {
+  Pickle pickle(serialized.data(), serialized.size());
+  PickleIterator iter(pickle);
+  uint32 format = 0;
+  std::string binary;
+  if (!iter.ReadUInt32(&format) || !iter.ReadString(&binary) ||
+      binary.empty() || binary.size() > max_size_bytes_) {
+    return false;
+  }
+  AddEntry(key, ProgramEntry(format, binary));
+  return true;
+}
+
+void ProgramCache::Clear() {
+  entries_.Clear();
+  size_bytes_ = 0;
+}
+
+void ProgramCache::AddEntry(const std::string& key,
+                            const ProgramEntry& entry) {
+  EntryMap::iterator existing = entries_.Peek(key);
+  if (existing != entries_.end())
+    EvictEntry(existing);
+
+  size_bytes_ += entry.binary.size();
+  entries_.Put(key, entry);
+  while (size_bytes_ > max_size_bytes_ && entries_.size() > 1)
+    EvictEntry(--entries_.end());
+}
+
+void ProgramCache::EvictEntry(EntryMap::iterator it) {
+  DCHECK_GE(size_bytes_, it->second.binary.size());
+  size_bytes_ -= it->second.binary.size();
+  entries_.Erase(it);
+}
+
+}  // namespace gles2
+}  // namespace gpu
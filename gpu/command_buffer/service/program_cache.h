@@ -0,0 +1,106 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GPU_COMMAND_BUFFER_SERVICE_PROGRAM_CACHE_H_
+#define GPU_COMMAND_BUFFER_SERVICE_PROGRAM_CACHE_H_
+
+#include <map>
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/memory/mru_cache.h"
+#include "gpu/command_buffer/service/gl_utils.h"
+#include "gpu/gpu_export.h"
+
+namespace gpu {
+namespace gles2 {
+
+// Caches the binaries of linked programs so that relinking the same shaders,
+// which is common when pages are reloaded or several tabs run the same
+// content, can skip the driver's compiler. Requires GL_OES_get_program_binary
+// or GL_ARB_get_program_binary. One cache is shared by all the contexts of
+// the GPU process.
+class GPU_EXPORT ProgramCache {
+ public:
+  // Called with the key and the serialized entry of every program added to the
+  // cache so the embedder can persist it and hand it back through
+  // LoadSerializedEntry() in a later session.
+  typedef base::Callback<void(const std::string&, const std::string&)>
+      ProgramCacheCallback;
+
+  static const size_t kDefaultMaxCacheSizeBytes = 6 * 1024 * 1024;
+
+  explicit ProgramCache(size_t max_cache_size_bytes);
+  ~ProgramCache();
+
+  // Computes the key of a program from the translated sources of its shaders
+  // and its attribute bindings. The key also covers the GL vendor, renderer and
+  // version of the current context, so binaries are not handed to a different
+  // driver.
+  std::string ComputeKey(
+      const std::string& vertex_source,
+      const std::string& fragment_source,
+      const std::map<std::string, GLint>& bind_attrib_location_map);
+
+  // Loads the binary stored under |key| into |program|. Returns true if the
+  // program is linked afterwards. A binary the driver rejects is evicted.
+  bool LoadProgram(const std::string& key, GLuint program);
+
+  // Reads back the binary of the linked |program| and stores it under |key|.
+  void SaveProgram(const std::string& key, GLuint program);
+
+  // Adds an entry produced by the ProgramCacheCallback. Returns false if
+  // |serialized| could not be parsed.
+  bool LoadSerializedEntry(const std::string& key,
+                           const std::string& serialized);
+
+  void set_program_cache_callback(const ProgramCacheCallback& callback) {
+    program_cache_callback_ = callback;
+  }
+
+  // Removes all the entries.
+  void Clear();
+
+  size_t size_bytes() const {
+    return size_bytes_;
+  }
+
+  size_t num_entries() const {
+    return entries_.size();
+  }
+
+ private:
+  struct ProgramEntry {
+    ProgramEntry();
+    ProgramEntry(GLenum format, const std::string& binary);
+    ~ProgramEntry();
+
+    GLenum format;
+    std::string binary;
+  };
+
+  typedef base::MRUCache<std::string, ProgramEntry> EntryMap;
+
+  void AddEntry(const std::string& key, const ProgramEntry& entry);
+  void EvictEntry(EntryMap::iterator it);
+
+  EntryMap entries_;
+
+  size_t max_size_bytes_;
+  size_t size_bytes_;
+
+  // Vendor, renderer and version of the GL implementation. Computed the first
+  // time a key is needed.
+  std::string driver_identity_;
+
+  ProgramCacheCallback program_cache_callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProgramCache);
+};
+
+}  // namespace gles2
+}  // namespace gpu
+
+#endif  // GPU_COMMAND_BUFFER_SERVICE_PROGRAM_CACHE_H_
@@ -0,0 +1,186 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/program_cache.h"
+
+#include <string.h>
+
+#include "base/bind.h"
+#include "base/memory/scoped_ptr.h"
+#include "gpu/command_buffer/common/gl_mock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using ::gfx::MockGLInterface;
+using ::testing::_;
+using ::testing::Return;
+using ::testing::SetArgumentPointee;
+using ::testing::StrictMock;
+
+namespace gpu {
+namespace gles2 {
+
+namespace {
+
+const GLuint kProgram = 11;
+const GLenum kFormat = 0x1234;
+
+// Fills in the outputs of glGetProgramBinary with |binary|.
+ACTION_P(SetProgramBinary, binary) {
+  *arg2 = static_cast<GLsizei>(binary.size());
+  *arg3 = kFormat;
+  memcpy(arg4, binary.data(), binary.size());
+}
+
+}  // anonymous namespace
+
+class ProgramCacheTest : public testing::Test {
+ public:
+  ProgramCacheTest()
+      : cache_(kMaxCacheSize),
+        saved_count_(0) {
+  }
+
+ protected:
+  static const size_t kMaxCacheSize = 16;
+
+  virtual void SetUp() {
+    gl_.reset(new StrictMock<MockGLInterface>());
+    ::gfx::GLInterface::SetGLInterface(gl_.get());
+  }
+
+  virtual void TearDown() {
+    ::gfx::GLInterface::SetGLInterface(NULL);
+    gl_.reset();
+  }
+
+  std::string ComputeKey(const std::string& vertex_source) {
+    static const GLubyte kString[] = "test";
+    EXPECT_CALL(*gl_, GetString(_))
+        .WillRepeatedly(Return(kString));
+    std::map<std::string, GLint> bindings;
+    return cache_.ComputeKey(vertex_source, "fragment", bindings);
+  }
+
+  void SetupSaveExpectations(const std::string& binary) {
+    EXPECT_CALL(*gl_, GetProgramiv(kProgram, GL_PROGRAM_BINARY_LENGTH_OES, _))
+        .WillOnce(SetArgumentPointee<2>(static_cast<GLint>(binary.size())))
+        .RetiresOnSaturation();
+    EXPECT_CALL(*gl_, GetProgramBinary(
+        kProgram, static_cast<GLsizei>(binary.size()), _, _, _))
+        .WillOnce(SetProgramBinary(binary))
+        .RetiresOnSaturation();
+  }
+
+  void SetupLoadExpectations(const std::string& binary, GLint link_status) {
+    EXPECT_CALL(*gl_, ProgramBinary(
+        kProgram, kFormat, _, static_cast<GLsizei>(binary.size())))
+        .Times(1)
+        .RetiresOnSaturation();
+    EXPECT_CALL(*gl_, GetProgramiv(kProgram, GL_LINK_STATUS, _))
+        .WillOnce(SetArgumentPointee<2>(link_status))
+        .RetiresOnSaturation();
+  }
+
+  void OnProgramSaved(const std::string& key, const std::string& serialized) {
+    ++saved_count_;
+    saved_key_ = key;
+    saved_entry_ = serialized;
+  }
+
+  scoped_ptr<StrictMock<MockGLInterface> > gl_;
+  ProgramCache cache_;
+  int saved_count_;
+  std::string saved_key_;
+  std::string saved_entry_;
+};
+
+TEST_F(ProgramCacheTest, KeyDependsOnSourceAndBindings) {
+  std::string key1 = ComputeKey("vertex1");
+  std::string key2 = ComputeKey("vertex2");
+  EXPECT_NE(key1, key2);
+  EXPECT_EQ(key1, ComputeKey("vertex1"));
+
+  std::map<std::string, GLint> bindings;
+  bindings["a"] = 1;
+  EXPECT_NE(key1, cache_.ComputeKey("vertex1", "fragment", bindings));
+}
+
+TEST_F(ProgramCacheTest, SaveAndLoad) {
+  std::string key = ComputeKey("vertex");
+  EXPECT_FALSE(cache_.LoadProgram(key, kProgram));
+
+  const std::string binary("binary");
+  SetupSaveExpectations(binary);
+  cache_.SaveProgram(key, kProgram);
+  EXPECT_EQ(1u, cache_.num_entries());
+  EXPECT_EQ(binary.size(), cache_.size_bytes());
+
+  SetupLoadExpectations(binary, GL_TRUE);
+  EXPECT_TRUE(cache_.LoadProgram(key, kProgram));
+}
+
+TEST_F(ProgramCacheTest, RejectedBinaryIsEvicted) {
+  std::string key = ComputeKey("vertex");
+  const std::string binary("binary");
+  SetupSaveExpectations(binary);
+  cache_.SaveProgram(key, kProgram);
+
+  SetupLoadExpectations(binary, GL_FALSE);
+  EXPECT_FALSE(cache_.LoadProgram(key, kProgram));
+  EXPECT_EQ(0u, cache_.num_entries());
+  EXPECT_EQ(0u, cache_.size_bytes());
+}
+
+TEST_F(ProgramCacheTest, EvictsLeastRecentlyUsed) {
+  std::string key1 = ComputeKey("vertex1");
+  std::string key2 = ComputeKey("vertex2");
+  std::string key3 = ComputeKey("vertex3");
+  const std::string binary("12345678");
+
+  SetupSaveExpectations(binary);
+  cache_.SaveProgram(key1, kProgram);
+  SetupSaveExpectations(binary);
+  cache_.SaveProgram(key2, kProgram);
+  EXPECT_EQ(2u, cache_.num_entries());
+
+  // Touch |key1| so that |key2| is evicted by the next save.
+  SetupLoadExpectations(binary, GL_TRUE);
+  EXPECT_TRUE(cache_.LoadProgram(key1, kProgram));
+
+  SetupSaveExpectations(binary);
+  cache_.SaveProgram(key3, kProgram);
+  EXPECT_EQ(2u, cache_.num_entries());
+  EXPECT_EQ(2 * binary.size(), cache_.size_bytes());
+  EXPECT_FALSE(cache_.LoadProgram(key2, kProgram));
+}
+
+TEST_F(ProgramCacheTest, TooLargeBinaryIsNotSaved) {
+  std::string key = ComputeKey("vertex");
+  EXPECT_CALL(*gl_, GetProgramiv(kProgram, GL_PROGRAM_BINARY_LENGTH_OES, _))
+      .WillOnce(SetArgumentPointee<2>(static_cast<GLint>(kMaxCacheSize + 1)));
+  cache_.SaveProgram(key, kProgram);
+  EXPECT_EQ(0u, cache_.num_entries());
+}
+
+TEST_F(ProgramCacheTest, SerializedEntryRoundTrip) {
+  cache_.set_program_cache_callback(base::Bind(
+      &ProgramCacheTest::OnProgramSaved, base::Unretained(this)));
+  std::string key = ComputeKey("vertex");
+  const std::string binary("binary");
+  SetupSaveExpectations(binary);
+  cache_.SaveProgram(key, kProgram);
+  EXPECT_EQ(1, saved_count_);
+  EXPECT_EQ(key, saved_key_);
+
+  ProgramCache other_cache(kMaxCacheSize);
+  EXPECT_FALSE(other_cache.LoadSerializedEntry(key, "garbage"));
+  EXPECT_TRUE(other_cache.LoadSerializedEntry(saved_key_, saved_entry_));
+  EXPECT_EQ(binary.size(), other_cache.size_bytes());
+
+  SetupLoadExpectations(binary, GL_TRUE);
+  EXPECT_TRUE(other_cache.LoadProgram(key, kProgram));
+}
+
+}  // namespace gles2
+}  // namespace gpu
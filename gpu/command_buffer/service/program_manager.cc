@@ -10,10 +10,13 @@
 #include "base/basictypes.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/metrics/histogram.h"
 #include "base/string_number_conversions.h"
+#include "base/time.h"
 #include "gpu/command_buffer/common/gles2_cmd_format.h"
 #include "gpu/command_buffer/common/gles2_cmd_utils.h"
 #include "gpu/command_buffer/service/gles2_cmd_decoder.h"
+#include "gpu/command_buffer/service/program_cache.h"
 
 namespace gpu {
 namespace gles2 {
@@ -260,10 +263,34 @@ bool ProgramManager::ProgramInfo::Link() {
     return false;
   }
   ExecuteBindAttribLocationCalls();
+
+  ProgramCache* program_cache = manager_->program_cache_;
+  std::string cache_key;
+  if (program_cache) {
+    cache_key = program_cache->ComputeKey(
+        GetShaderSource(attached_shaders_[0]),
+        GetShaderSource(attached_shaders_[1]),
+        bind_attrib_location_map_);
+    base::TimeTicks load_start = base::TimeTicks::HighResNow();
+    bool hit = program_cache->LoadProgram(cache_key, service_id());
+    UMA_HISTOGRAM_BOOLEAN("GPU.ProgramCache.Hit", hit);
+    if (hit) {
+      UMA_HISTOGRAM_TIMES("GPU.ProgramCache.BinaryLoadTime",
+                          base::TimeTicks::HighResNow() - load_start);
+      Update();
+      return true;
+    }
+  }
+
+  base::TimeTicks link_start = base::TimeTicks::HighResNow();
   glLinkProgram(service_id());
   GLint success = 0;
   glGetProgramiv(service_id(), GL_LINK_STATUS, &success);
   if (success == GL_TRUE) {
+    UMA_HISTOGRAM_TIMES("GPU.ProgramCache.LinkTime",
+                        base::TimeTicks::HighResNow() - link_start);
+    if (program_cache)
+      program_cache->SaveProgram(cache_key, service_id());
     Update();
   } else {
     UpdateLogInfo();
@@ -271,6 +298,16 @@ bool ProgramManager::ProgramInfo::Link() {
   return success == GL_TRUE;
 }
 
+// static
+const std::string& ProgramManager::ProgramInfo::GetShaderSource(
+    const ShaderManager::ShaderInfo* shader_info) {
+  CR_DEFINE_STATIC_LOCAL(std::string, empty, ());
+  const std::string* source = shader_info->translated_source();
+  if (!source)
+    source = shader_info->source();
+  return source ? *source : empty;
+}
+
 void ProgramManager::ProgramInfo::Validate() {
   if (!IsValid()) {
     set_log_info("program not linked");
@@ -679,10 +716,11 @@ ProgramManager::ProgramInfo::~ProgramInfo() {
 // by at least 1 bit each time chrome is run.
 static int uniform_random_offset_ = 3;
 
-ProgramManager::ProgramManager()
+ProgramManager::ProgramManager(ProgramCache* program_cache)
     : uniform_swizzle_(uniform_random_offset_++ % 15),
       program_info_count_(0),
-      have_context_(true) {
+      have_context_(true),
+      program_cache_(program_cache) {
 }
 
 ProgramManager::~ProgramManager() {
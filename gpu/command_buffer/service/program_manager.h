@@ -20,6 +20,8 @@
 namespace gpu {
 namespace gles2 {
 
+class ProgramCache;
+
 // Tracks the Programs.
 //
 // NOTE: To support shared resources an instance of this class will
@@ -234,6 +236,11 @@ class GPU_EXPORT ProgramManager {
 
     void DetachShaders(ShaderManager* manager);
 
+    // Returns the translated source of |shader_info|, or its original source
+    // if the translator is disabled.
+    static const std::string& GetShaderSource(
+        const ShaderManager::ShaderInfo* shader_info);
+
     static inline GLint GetUniformInfoIndexFromFakeLocation(
         GLint fake_location) {
       return fake_location & 0xFFFF;
@@ -289,7 +296,9 @@ class GPU_EXPORT ProgramManager {
     std::map<std::string, GLint> bind_attrib_location_map_;
   };
 
-  ProgramManager();
+  // |program_cache| may be NULL, in which case programs are always linked by
+  // the driver.
+  explicit ProgramManager(ProgramCache* program_cache);
   ~ProgramManager();
 
   // Must call before destruction.
@@ -342,6 +351,9 @@ class GPU_EXPORT ProgramManager {
 
   bool have_context_;
 
+  // Not owned. May be NULL.
+  ProgramCache* program_cache_;
+
   // Used to clear uniforms.
   std::vector<uint8> zero_;
 
@@ -33,7 +33,7 @@ namespace gles2 {
 
 class ProgramManagerTest : public testing::Test {
  public:
-  ProgramManagerTest() { }
+  ProgramManagerTest() : manager_(NULL) { }
   ~ProgramManagerTest() {
     manager_.Destroy(false);
   }
@@ -143,7 +143,8 @@ TEST_F(ProgramManagerTest, SwizzleLocation) {
 class ProgramManagerWithShaderTest : public testing::Test {
  public:
   ProgramManagerWithShaderTest()
-      : program_info_(NULL) {
+      : manager_(NULL),
+        program_info_(NULL) {
   }
 
   ~ProgramManagerWithShaderTest() {
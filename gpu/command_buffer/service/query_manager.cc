@@ -7,6 +7,7 @@
 #include "base/logging.h"
 #include "base/time.h"
 #include "gpu/command_buffer/common/gles2_cmd_format.h"
+#include "gpu/command_buffer/service/async_texture_uploader.h"
 #include "gpu/command_buffer/service/common_decoder.h"
 
 namespace gpu {
@@ -115,12 +116,68 @@ void CommandsIssuedQuery::Destroy(bool /* have_context */) {
   }
 }
 
+class AsyncTextureUploadsCompletedQuery : public QueryManager::Query {
+ public:
+  AsyncTextureUploadsCompletedQuery(
+      QueryManager* manager, GLenum target, int32 shm_id, uint32 shm_offset);
+  virtual ~AsyncTextureUploadsCompletedQuery();
+
+  virtual bool Begin() OVERRIDE;
+  virtual bool End(uint32 submit_count) OVERRIDE;
+  virtual bool Process() OVERRIDE;
+  virtual void Destroy(bool have_context) OVERRIDE;
+
+ private:
+  // The serial of the last upload posted before the query ended.
+  uint32 upload_serial_;
+};
+
+AsyncTextureUploadsCompletedQuery::AsyncTextureUploadsCompletedQuery(
+    QueryManager* manager, GLenum target, int32 shm_id, uint32 shm_offset)
+    : Query(manager, target, shm_id, shm_offset),
+      upload_serial_(0) {
+}
+
+AsyncTextureUploadsCompletedQuery::~AsyncTextureUploadsCompletedQuery() {
+}
+
+bool AsyncTextureUploadsCompletedQuery::Begin() {
+  return true;
+}
+
+bool AsyncTextureUploadsCompletedQuery::End(uint32 submit_count) {
+  AsyncTextureUploader* uploader = manager()->async_texture_uploader();
+  if (!uploader || !uploader->HasPendingUploads()) {
+    MarkAsPending(submit_count);
+    return MarkAsCompleted(1);
+  }
+  upload_serial_ = uploader->posted_serial();
+  return AddToPendingQueue(submit_count);
+}
+
+bool AsyncTextureUploadsCompletedQuery::Process() {
+  AsyncTextureUploader* uploader = manager()->async_texture_uploader();
+  // Serials only grow, so wrap-around is handled by the subtraction.
+  if (uploader &&
+      static_cast<int32>(uploader->completed_serial() - upload_serial_) < 0) {
+    return true;
+  }
+  return MarkAsCompleted(1);
+}
+
+void AsyncTextureUploadsCompletedQuery::Destroy(bool /* have_context */) {
+  if (!IsDeleted()) {
+    MarkAsDeleted();
+  }
+}
+
 QueryManager::QueryManager(
     CommonDecoder* decoder,
     bool use_arb_occlusion_query2_for_occlusion_query_boolean)
     : decoder_(decoder),
       use_arb_occlusion_query2_for_occlusion_query_boolean_(
           use_arb_occlusion_query2_for_occlusion_query_boolean),
+      async_texture_uploader_(NULL),
       query_count_(0) {
 }
 
@@ -148,6 +205,10 @@ QueryManager::Query* QueryManager::CreateQuery(
     case GL_COMMANDS_ISSUED_CHROMIUM:
       query = new CommandsIssuedQuery(this, target, shm_id, shm_offset);
       break;
+    case GL_ASYNC_TEXTURE_UPLOADS_COMPLETED_CHROMIUM:
+      query = new AsyncTextureUploadsCompletedQuery(
+          this, target, shm_id, shm_offset);
+      break;
     default: {
       GLuint service_id = 0;
       glGenQueriesARB(1, &service_id);
@@ -488,6 +488,29 @@ TEST_F(QueryManagerTest, ARBOcclusionQuery2) {
   manager->Destroy(false);
 }
 
+TEST_F(QueryManagerTest, AsyncTextureUploadsCompletedWithoutUploader) {
+  const GLuint kClient1Id = 1;
+  const GLenum kTarget = GL_ASYNC_TEXTURE_UPLOADS_COMPLETED_CHROMIUM;
+  const uint32 kSubmitCount = 123;
+
+  QueryManager::Query* query = manager_->CreateQuery(
+      kTarget, kClient1Id, kSharedMemoryId, kSharedMemoryOffset);
+  ASSERT_TRUE(query != NULL);
+
+  QuerySync* sync = decoder_->GetSharedMemoryAs<QuerySync*>(
+      kSharedMemoryId, kSharedMemoryOffset, sizeof(*sync));
+  ASSERT_TRUE(sync != NULL);
+  sync->Reset();
+
+  // With nothing uploading the query completes as soon as it ends.
+  EXPECT_TRUE(manager_->BeginQuery(query));
+  EXPECT_TRUE(manager_->EndQuery(query, kSubmitCount));
+  EXPECT_FALSE(query->pending());
+  EXPECT_FALSE(manager_->HavePendingQueries());
+  EXPECT_EQ(kSubmitCount, sync->process_count);
+  EXPECT_EQ(1u, sync->result);
+}
+
 }  // namespace gles2
 }  // namespace gpu
 
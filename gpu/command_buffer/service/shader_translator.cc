@@ -7,7 +7,10 @@
 #include <string.h>
 
 #include "base/at_exit.h"
+#include "base/debug/trace_event.h"
 #include "base/logging.h"
+#include "base/stringprintf.h"
+#include "gpu/command_buffer/service/shader_translator_cache.h"
 
 namespace {
 void FinalizeShaderTranslator(void* /* dummy */) {
@@ -111,6 +114,20 @@ bool ShaderTranslator::Init(
   implementation_is_glsl_es_ = (glsl_implementation_type == kGlslES);
   needs_built_in_function_emulation_ =
       (glsl_built_in_function_behavior == kGlslBuiltInFunctionEmulated);
+  options_key_ = base::StringPrintf(
+      "%d %d %d %d %d %d %d %d %d %d %d %d %d %d",
+      shader_type, shader_spec, shader_output,
+      needs_built_in_function_emulation_,
+      resources->MaxVertexAttribs,
+      resources->MaxVertexUniformVectors,
+      resources->MaxVaryingVectors,
+      resources->MaxVertexTextureImageUnits,
+      resources->MaxCombinedTextureImageUnits,
+      resources->MaxTextureImageUnits,
+      resources->MaxFragmentUniformVectors,
+      resources->MaxDrawBuffers,
+      resources->OES_standard_derivatives,
+      resources->ARB_texture_rectangle);
   return compiler_ != NULL;
 }
 
@@ -120,6 +137,28 @@ bool ShaderTranslator::Translate(const char* shader) {
   DCHECK(shader != NULL);
   ClearResults();
 
+  ShaderTranslatorCache* cache = ShaderTranslatorCache::GetInstance();
+  std::string cache_key = ShaderTranslatorCache::ComputeKey(options_key_,
+                                                            shader);
+  ShaderTranslatorCache::Entry entry;
+  if (cache->Lookup(cache_key, &entry)) {
+    TRACE_EVENT_INSTANT0("gpu", "ShaderTranslator::Translate.CacheHit");
+    if (!entry.translated_shader.empty()) {
+      translated_shader_.reset(new char[entry.translated_shader.size() + 1]);
+      memcpy(translated_shader_.get(), entry.translated_shader.c_str(),
+             entry.translated_shader.size() + 1);
+    }
+    if (!entry.info_log.empty()) {
+      info_log_.reset(new char[entry.info_log.size() + 1]);
+      memcpy(info_log_.get(), entry.info_log.c_str(),
+             entry.info_log.size() + 1);
+    }
+    attrib_map_.swap(entry.attrib_map);
+    uniform_map_.swap(entry.uniform_map);
+    return true;
+  }
+
+  TRACE_EVENT0("gpu", "ShaderTranslator::Translate");
   bool success = false;
   int compile_options =
       SH_OBJECT_CODE | SH_ATTRIBUTES_UNIFORMS | SH_MAP_LONG_VARIABLE_NAMES;
@@ -149,6 +188,18 @@ bool ShaderTranslator::Translate(const char* shader) {
     info_log_.reset();
   }
 
+  // Only successful translations are cached; failures are rare and their
+  // info log is what the client is after.
+  if (success) {
+    if (translated_shader_.get())
+      entry.translated_shader = translated_shader_.get();
+    if (info_log_.get())
+      entry.info_log = info_log_.get();
+    entry.attrib_map = attrib_map_;
+    entry.uniform_map = uniform_map_;
+    cache->Store(cache_key, entry);
+  }
+
   return success;
 }
 
@@ -109,6 +109,9 @@ class GPU_EXPORT ShaderTranslator
   bool implementation_is_glsl_es_;
   bool needs_built_in_function_emulation_;
 
+  // Summarizes the Init() arguments for ShaderTranslatorCache keys.
+  std::string options_key_;
+
   DISALLOW_COPY_AND_ASSIGN(ShaderTranslator);
 };
 
@@ -0,0 +1,73 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/shader_translator_cache.h"
+
+#include "base/lazy_instance.h"
+#include "base/sha1.h"
+
+namespace gpu {
+namespace gles2 {
+
+namespace {
+
+struct LazyShaderTranslatorCache : public ShaderTranslatorCache {
+  LazyShaderTranslatorCache()
+      : ShaderTranslatorCache(ShaderTranslatorCache::kDefaultMaxEntries) {
+  }
+};
+
+base::LazyInstance<LazyShaderTranslatorCache>::Leaky g_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // anonymous namespace
+
+ShaderTranslatorCache::Entry::Entry() {
+}
+
+ShaderTranslatorCache::Entry::~Entry() {
+}
+
+ShaderTranslatorCache::ShaderTranslatorCache(size_t max_entries)
+    : entries_(max_entries) {
+}
+
+ShaderTranslatorCache::~ShaderTranslatorCache() {
+}
+
+// static
+ShaderTranslatorCache* ShaderTranslatorCache::GetInstance() {
+  return g_cache.Pointer();
+}
+
+// static
+std::string ShaderTranslatorCache::ComputeKey(const std::string& options_key,
+                                              const char* shader) {
+  std::string data(options_key);
+  data += '\0';
+  data += shader;
+  return base::SHA1HashString(data);
+}
+
+bool ShaderTranslatorCache::Lookup(const std::string& key, Entry* entry) {
+  base::AutoLock lock(lock_);
+  EntryMap::iterator it = entries_.Get(key);
+  if (it == entries_.end())
+    return false;
+  *entry = it->second;
+  return true;
+}
+
+void ShaderTranslatorCache::Store(const std::string& key, const Entry& entry) {
+  base::AutoLock lock(lock_);
+  entries_.Put(key, entry);
+}
+
+size_t ShaderTranslatorCache::size() const {
+  base::AutoLock lock(lock_);
+  return entries_.size();
+}
+
+}  // namespace gles2
+}  // namespace gpu
@@ -0,0 +1,68 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GPU_COMMAND_BUFFER_SERVICE_SHADER_TRANSLATOR_CACHE_H_
+#define GPU_COMMAND_BUFFER_SERVICE_SHADER_TRANSLATOR_CACHE_H_
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/memory/mru_cache.h"
+#include "base/synchronization/lock.h"
+#include "gpu/command_buffer/service/shader_translator.h"
+#include "gpu/gpu_export.h"
+
+namespace gpu {
+namespace gles2 {
+
+// Remembers the results of successful shader translations so that compiling
+// the same source with the same translator options, as happens for compositor
+// shaders and for WebGL content shared between tabs, does not run ANGLE again.
+// One cache is shared by all the translators of the process.
+class GPU_EXPORT ShaderTranslatorCache {
+ public:
+  struct GPU_EXPORT Entry {
+    Entry();
+    ~Entry();
+
+    std::string translated_shader;
+    std::string info_log;
+    ShaderTranslatorInterface::VariableMap attrib_map;
+    ShaderTranslatorInterface::VariableMap uniform_map;
+  };
+
+  static const size_t kDefaultMaxEntries = 256;
+
+  explicit ShaderTranslatorCache(size_t max_entries);
+  ~ShaderTranslatorCache();
+
+  static ShaderTranslatorCache* GetInstance();
+
+  // Computes the key of |shader| translated by a translator whose options are
+  // summarized by |options_key|.
+  static std::string ComputeKey(const std::string& options_key,
+                                const char* shader);
+
+  // Copies the entry for |key| into |entry|. Returns false on a miss.
+  bool Lookup(const std::string& key, Entry* entry);
+
+  void Store(const std::string& key, const Entry& entry);
+
+  size_t size() const;
+
+ private:
+  typedef base::MRUCache<std::string, Entry> EntryMap;
+
+  // Translators run on the GPU thread, but in-process contexts may run on
+  // other threads.
+  mutable base::Lock lock_;
+  EntryMap entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShaderTranslatorCache);
+};
+
+}  // namespace gles2
+}  // namespace gpu
+
+#endif  // GPU_COMMAND_BUFFER_SERVICE_SHADER_TRANSLATOR_CACHE_H_
@@ -0,0 +1,52 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/shader_translator_cache.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace gpu {
+namespace gles2 {
+
+TEST(ShaderTranslatorCacheTest, KeyDependsOnOptionsAndSource) {
+  std::string key = ShaderTranslatorCache::ComputeKey("options", "source");
+  EXPECT_EQ(key, ShaderTranslatorCache::ComputeKey("options", "source"));
+  EXPECT_NE(key, ShaderTranslatorCache::ComputeKey("options2", "source"));
+  EXPECT_NE(key, ShaderTranslatorCache::ComputeKey("options", "source2"));
+}
+
+TEST(ShaderTranslatorCacheTest, StoreAndLookup) {
+  ShaderTranslatorCache cache(2);
+  ShaderTranslatorCache::Entry entry;
+  EXPECT_FALSE(cache.Lookup("a", &entry));
+
+  entry.translated_shader = "translated";
+  entry.attrib_map["a_mapped"] =
+      ShaderTranslatorInterface::VariableInfo(1, 1, "a");
+  cache.Store("a", entry);
+
+  ShaderTranslatorCache::Entry result;
+  EXPECT_TRUE(cache.Lookup("a", &result));
+  EXPECT_EQ("translated", result.translated_shader);
+  EXPECT_TRUE(result.info_log.empty());
+  ASSERT_EQ(1u, result.attrib_map.size());
+  EXPECT_EQ("a", result.attrib_map["a_mapped"].name);
+  EXPECT_TRUE(result.uniform_map.empty());
+}
+
+TEST(ShaderTranslatorCacheTest, EvictsLeastRecentlyUsed) {
+  ShaderTranslatorCache cache(2);
+  ShaderTranslatorCache::Entry entry;
+  cache.Store("a", entry);
+  cache.Store("b", entry);
+  // Touch "a" so that "b" is evicted next.
+  EXPECT_TRUE(cache.Lookup("a", &entry));
+  cache.Store("c", entry);
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_TRUE(cache.Lookup("a", &entry));
+  EXPECT_FALSE(cache.Lookup("b", &entry));
+  EXPECT_TRUE(cache.Lookup("c", &entry));
+}
+
+}  // namespace gles2
+}  // namespace gpu
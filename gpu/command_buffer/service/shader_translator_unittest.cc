@@ -151,6 +151,29 @@ TEST_F(ShaderTranslatorTest, GetAttributes) {
   EXPECT_EQ("vPosition", iter->second.name);
 }
 
+TEST_F(ShaderTranslatorTest, RepeatedTranslationMatches) {
+  const char* shader =
+      "attribute vec4 vPosition;\n"
+      "void main() {\n"
+      "  gl_Position = vPosition;\n"
+      "}";
+
+  // The second translation is served by ShaderTranslatorCache and must
+  // produce the same results as the first one.
+  ASSERT_TRUE(vertex_translator_.Translate(shader));
+  std::string translated(vertex_translator_.translated_shader());
+  ShaderTranslator::VariableMap attrib_map = vertex_translator_.attrib_map();
+
+  EXPECT_TRUE(vertex_translator_.Translate(shader));
+  EXPECT_TRUE(vertex_translator_.info_log() == NULL);
+  ASSERT_TRUE(vertex_translator_.translated_shader() != NULL);
+  EXPECT_EQ(translated, vertex_translator_.translated_shader());
+  ASSERT_EQ(attrib_map.size(), vertex_translator_.attrib_map().size());
+  EXPECT_EQ(attrib_map["vPosition"].name,
+            vertex_translator_.attrib_map().find("vPosition")->second.name);
+  EXPECT_TRUE(vertex_translator_.uniform_map().empty());
+}
+
 TEST_F(ShaderTranslatorTest, GetUniforms) {
   const char* shader =
       "precision mediump float;\n"
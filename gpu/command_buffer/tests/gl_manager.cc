@@ -64,7 +64,7 @@ void GLManager::Initialize(const gfx::Size& size) {
       << "could not create command buffer service";
 
   decoder_.reset(::gpu::gles2::GLES2Decoder::Create(
-      new gles2::ContextGroup(mailbox_manager_.get(), false)));
+      new gles2::ContextGroup(mailbox_manager_.get(), NULL, false)));
 
   gpu_scheduler_.reset(new GpuScheduler(command_buffer_.get(),
                                         decoder_.get(),
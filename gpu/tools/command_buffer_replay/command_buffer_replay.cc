@@ -0,0 +1,330 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This tool replays a command buffer recorded by the GPU process with
+// --record-gpu-command-buffers=<dir> against a headless decoder and reports
+// how long each command and each frame took, for benchmarking changes to
+// gpu/command_buffer/service against real workloads. Use --use-gl=osmesa to
+// replay without a GPU.
+//
+// Only the commands of the recorded context are replayed, so textures that
+// were shared with other contexts through mailboxes or parent textures are
+// missing, and onscreen contexts are replayed offscreen.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/file_path.h"
+#include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/time.h"
+#include "gpu/command_buffer/common/gles2_cmd_format.h"
+#include "gpu/command_buffer/service/cmd_parser.h"
+#include "gpu/command_buffer/service/command_buffer_recorder.h"
+#include "gpu/command_buffer/service/command_buffer_service.h"
+#include "gpu/command_buffer/service/context_group.h"
+#include "gpu/command_buffer/service/gl_utils.h"
+#include "gpu/command_buffer/service/gles2_cmd_decoder.h"
+#include "gpu/command_buffer/service/gpu_scheduler.h"
+#include "gpu/command_buffer/service/mailbox_manager.h"
+#include "ui/gfx/gl/gl_context.h"
+#include "ui/gfx/gl/gl_share_group.h"
+#include "ui/gfx/gl/gl_surface.h"
+
+using base::TimeDelta;
+using base::TimeTicks;
+
+namespace {
+
+struct CommandStats {
+  CommandStats() : count(0) {}
+
+  int count;
+  TimeDelta total_time;
+};
+
+// Times every command before handing it to the decoder. A frame ends with
+// each SwapBuffers or PostSubBufferCHROMIUM; the GL pipeline is finished at
+// that point so that the frame time includes the work done by the GPU.
+class TimingHandler : public gpu::AsyncAPIInterface {
+ public:
+  explicit TimingHandler(gpu::gles2::GLES2Decoder* decoder)
+      : decoder_(decoder),
+        command_stats_(gpu::gles2::kNumCommands) {
+  }
+
+  virtual gpu::error::Error DoCommand(unsigned int command,
+                                      unsigned int arg_count,
+                                      const void* cmd_data) OVERRIDE {
+    TimeTicks start = TimeTicks::HighResNow();
+    gpu::error::Error error = decoder_->DoCommand(command, arg_count, cmd_data);
+    bool end_of_frame = command == gpu::gles2::kSwapBuffers ||
+                        command == gpu::gles2::kPostSubBufferCHROMIUM;
+    if (end_of_frame)
+      glFinish();
+    TimeDelta elapsed = TimeTicks::HighResNow() - start;
+
+    if (command < command_stats_.size()) {
+      CommandStats& stats = command_stats_[command];
+      ++stats.count;
+      stats.total_time += elapsed;
+    }
+    current_frame_time_ += elapsed;
+    if (end_of_frame) {
+      frame_times_.push_back(current_frame_time_);
+      current_frame_time_ = TimeDelta();
+    }
+    return error;
+  }
+
+  virtual const char* GetCommandName(unsigned int command_id) const OVERRIDE {
+    return decoder_->GetCommandName(command_id);
+  }
+
+  void PrintResults() const {
+    typedef std::vector<std::pair<TimeDelta, unsigned int> > SortedCommands;
+    SortedCommands sorted;
+    TimeDelta total_time;
+    for (unsigned int command = 0; command < command_stats_.size();
+         ++command) {
+      const CommandStats& stats = command_stats_[command];
+      if (!stats.count)
+        continue;
+      sorted.push_back(std::make_pair(stats.total_time, command));
+      total_time += stats.total_time;
+    }
+    std::sort(sorted.rbegin(), sorted.rend());
+
+    printf("%-40s %10s %12s %10s\n", "command", "count", "total_us",
+           "mean_us");
+    for (SortedCommands::const_iterator it = sorted.begin();
+         it != sorted.end(); ++it) {
+      const CommandStats& stats = command_stats_[it->second];
+      printf("%-40s %10d %12lld %10.2f\n",
+             GetCommandName(it->second),
+             stats.count,
+             static_cast<long long>(stats.total_time.InMicroseconds()),
+             static_cast<double>(stats.total_time.InMicroseconds()) /
+                 stats.count);
+    }
+    printf("total_us %lld\n",
+           static_cast<long long>(total_time.InMicroseconds()));
+
+    if (frame_times_.empty())
+      return;
+    std::vector<TimeDelta> frame_times(frame_times_);
+    std::sort(frame_times.begin(), frame_times.end());
+    TimeDelta total_frame_time;
+    for (size_t ii = 0; ii < frame_times.size(); ++ii)
+      total_frame_time += frame_times[ii];
+    printf("frames %d\n", static_cast<int>(frame_times.size()));
+    printf("frame_mean_us %.2f\n",
+           static_cast<double>(total_frame_time.InMicroseconds()) /
+               frame_times.size());
+    printf("frame_median_us %lld\n", static_cast<long long>(
+        frame_times[frame_times.size() / 2].InMicroseconds()));
+    printf("frame_max_us %lld\n", static_cast<long long>(
+        frame_times.back().InMicroseconds()));
+  }
+
+ private:
+  gpu::gles2::GLES2Decoder* decoder_;
+  // Indexed by command id.
+  std::vector<CommandStats> command_stats_;
+  TimeDelta current_frame_time_;
+  std::vector<TimeDelta> frame_times_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimingHandler);
+};
+
+class Replayer {
+ public:
+  Replayer() {}
+
+  ~Replayer() {
+    scheduler_.reset();
+    if (decoder_.get()) {
+      decoder_->MakeCurrent();
+      decoder_->Destroy();
+    }
+  }
+
+  // Replays all the records of |reader|. Returns false if the recording could
+  // not be replayed.
+  bool Replay(gpu::CommandBufferRecordReader* reader) {
+    gpu::CommandBufferRecord record;
+    if (!reader->ReadRecord(&record) ||
+        record.type != gpu::kCommandBufferRecordInitialize) {
+      LOG(ERROR) << "The recording does not start with the initialization.";
+      return false;
+    }
+    if (!Initialize(record))
+      return false;
+
+    while (reader->ReadRecord(&record)) {
+      if (!ReplayRecord(record))
+        return false;
+    }
+    return true;
+  }
+
+  void PrintResults() const {
+    if (timing_handler_.get())
+      timing_handler_->PrintResults();
+  }
+
+ private:
+  bool Initialize(const gpu::CommandBufferRecord& record) {
+    command_buffer_.reset(new gpu::CommandBufferService);
+    if (!command_buffer_->Initialize()) {
+      LOG(ERROR) << "Could not initialize the command buffer.";
+      return false;
+    }
+
+    decoder_.reset(gpu::gles2::GLES2Decoder::Create(
+        new gpu::gles2::ContextGroup(new gpu::gles2::MailboxManager,
+                                     NULL,
+                                     record.bind_generates_resource)));
+    timing_handler_.reset(new TimingHandler(decoder_.get()));
+    scheduler_.reset(new gpu::GpuScheduler(command_buffer_.get(),
+                                           timing_handler_.get(),
+                                           decoder_.get()));
+    decoder_->set_engine(scheduler_.get());
+
+    surface_ = gfx::GLSurface::CreateOffscreenGLSurface(false, record.size);
+    if (!surface_.get()) {
+      // Ensure the decoder is not destroyed if it is not initialized.
+      decoder_.reset();
+      LOG(ERROR) << "Could not create the surface.";
+      return false;
+    }
+    context_ = gfx::GLContext::CreateGLContext(new gfx::GLShareGroup,
+                                               surface_.get(),
+                                               gfx::PreferDiscreteGpu);
+    if (!context_.get()) {
+      decoder_.reset();
+      LOG(ERROR) << "Could not create the context.";
+      return false;
+    }
+    if (!decoder_->Initialize(surface_.get(),
+                              context_.get(),
+                              true,
+                              record.size,
+                              gpu::gles2::DisallowedFeatures(),
+                              record.data.c_str(),
+                              record.attribs)) {
+      LOG(ERROR) << "Could not initialize the decoder.";
+      return false;
+    }
+
+    command_buffer_->SetPutOffsetChangeCallback(
+        base::Bind(&Replayer::PumpCommands, base::Unretained(this)));
+    command_buffer_->SetGetBufferChangeCallback(
+        base::Bind(&gpu::GpuScheduler::SetGetBuffer,
+                   base::Unretained(scheduler_.get())));
+    return true;
+  }
+
+  bool ReplayRecord(const gpu::CommandBufferRecord& record) {
+    switch (record.type) {
+      case gpu::kCommandBufferRecordCreateTransferBuffer:
+        // The commands refer to transfer buffers by id, so the ids must be
+        // the recorded ones.
+        if (command_buffer_->CreateTransferBuffer(
+                record.buffer_size, record.id) != record.id) {
+          LOG(ERROR) << "Could not create transfer buffer " << record.id;
+          return false;
+        }
+        return true;
+      case gpu::kCommandBufferRecordDestroyTransferBuffer:
+        command_buffer_->DestroyTransferBuffer(record.id);
+        return true;
+      case gpu::kCommandBufferRecordTransferBufferContents: {
+        gpu::Buffer buffer = command_buffer_->GetTransferBuffer(record.id);
+        if (!buffer.ptr || buffer.size != record.data.size()) {
+          LOG(ERROR) << "Contents of unknown transfer buffer " << record.id;
+          return false;
+        }
+        memcpy(buffer.ptr, record.data.data(), buffer.size);
+        return true;
+      }
+      case gpu::kCommandBufferRecordSetGetBuffer:
+        command_buffer_->SetGetBuffer(record.id);
+        return true;
+      case gpu::kCommandBufferRecordFlush:
+        command_buffer_->Flush(record.id);
+        return command_buffer_->GetLastState().error ==
+            gpu::error::kNoError;
+      case gpu::kCommandBufferRecordInitialize:
+        break;
+    }
+    LOG(ERROR) << "Unexpected record " << record.type;
+    return false;
+  }
+
+  void PumpCommands() {
+    decoder_->MakeCurrent();
+    scheduler_->PutChanged();
+    gpu::CommandBuffer::State state = command_buffer_->GetLastState();
+    if (state.error != gpu::error::kNoError) {
+      LOG(ERROR) << "Replay stopped with error " << state.error;
+    } else if (state.get_offset != state.put_offset) {
+      // Commands that wait on other contexts, like WaitSyncPointCHROMIUM, can
+      // not complete in a replay.
+      LOG(WARNING) << "Not all the commands of the flush were processed.";
+    }
+  }
+
+  scoped_ptr<gpu::CommandBufferService> command_buffer_;
+  scoped_ptr<gpu::gles2::GLES2Decoder> decoder_;
+  scoped_ptr<TimingHandler> timing_handler_;
+  scoped_ptr<gpu::GpuScheduler> scheduler_;
+  scoped_refptr<gfx::GLSurface> surface_;
+  scoped_refptr<gfx::GLContext> context_;
+
+  DISALLOW_COPY_AND_ASSIGN(Replayer);
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  base::AtExitManager at_exit;
+  CommandLine::Init(argc, argv);
+  const CommandLine* cl = CommandLine::ForCurrentProcess();
+
+  FilePath in_path = cl->GetSwitchValuePath("in");
+  if (in_path.empty()) {
+    LOG(INFO) << "Usage: \n" <<
+      cl->GetProgram().BaseName().LossyDisplayName() <<
+      " --in=[recording] (--use-gl=osmesa)\n"
+      "Replays a command buffer recorded with --record-gpu-command-buffers\n"
+      "and prints the time taken by each command and by each frame.";
+    return -1;
+  }
+
+  MessageLoop message_loop;
+  if (!gfx::GLSurface::InitializeOneOff()) {
+    LOG(ERROR) << "Could not initialize GL.";
+    return -1;
+  }
+
+  scoped_ptr<gpu::CommandBufferRecordReader> reader(
+      gpu::CommandBufferRecordReader::Create(in_path));
+  if (!reader.get())
+    return -1;
+
+  Replayer replayer;
+  bool success = replayer.Replay(reader.get());
+  replayer.PrintResults();
+  return success ? 0 : -1;
+}
@@ -47,9 +47,14 @@
       'sources': [
         'file_descriptor_set_posix_unittest.cc',
         'ipc_channel_posix_unittest.cc',
+        'ipc_channel_reader_unittest.cc',
         'ipc_fuzzing_tests.cc',
+        'ipc_message_size_unittest.cc',
+        'ipc_message_size_unittest.h',
         'ipc_message_unittest.cc',
         'ipc_send_fds_test.cc',
+        'ipc_shared_memory_perftest_posix.cc',
+        'ipc_shared_memory_ring_buffer_unittest.cc',
         'ipc_sync_channel_unittest.cc',
         'ipc_sync_message_unittest.cc',
         'ipc_sync_message_unittest.h',
@@ -79,6 +84,23 @@
         }]
       ],
     },
+    {
+      'target_name': 'ipc_perftests',
+      'type': 'executable',
+      'dependencies': [
+        'ipc',
+        '../base/base.gyp:base',
+        '../base/base.gyp:test_support_base',
+        '../base/base.gyp:test_support_perf',
+        '../testing/gtest.gyp:gtest',
+      ],
+      'include_dirs': [
+        '..'
+      ],
+      'sources': [
+        'ipc_message_size_perftest.cc',
+      ],
+    },
     {
       'target_name': 'test_support_ipc',
       'type': 'static_library',
@@ -30,7 +30,9 @@
 #include "base/memory/singleton.h"
 #include "base/process_util.h"
 #include "base/rand_util.h"
+#include "base/shared_memory.h"
 #include "base/stl_util.h"
+#include "base/string_piece.h"
 #include "base/string_util.h"
 #include "base/synchronization/lock.h"
 #include "ipc/ipc_descriptors.h"
@@ -38,6 +40,7 @@
 #include "ipc/file_descriptor_set_posix.h"
 #include "ipc/ipc_logging.h"
 #include "ipc/ipc_message_utils.h"
+#include "ipc/ipc_shared_memory_ring_buffer.h"
 
 namespace IPC {
 
@@ -292,6 +295,24 @@ bool SocketWriteErrorIsRecoverable() {
 #endif  // OS_MACOSX
 }
 
+// In shared memory mode each direction of the channel gets a ring of this many
+// bytes.  Ring 0 carries data from the server to the client, ring 1 from the
+// client to the server.
+const size_t kSharedMemoryRingCapacity = 256 * 1024;
+
+size_t SharedMemoryRingOffset(int ring) {
+  return ring * internal::SharedMemoryRingBuffer::SizeForCapacity(
+      kSharedMemoryRingCapacity);
+}
+
+size_t SharedMemorySegmentSize() {
+  return SharedMemoryRingOffset(2);
+}
+
+// The most iovecs handed to a single sendmsg().  Comfortably below IOV_MAX
+// on every supported platform.
+const size_t kMaxIovecsPerWrite = 64;
+
 }  // namespace
 //------------------------------------------------------------------------------
 
@@ -488,20 +509,16 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
   if (pipe_ == -1)
     return false;
 
+  if (uses_shared_memory())
+    return ProcessOutgoingMessagesToSharedMemory();
+
   // Write out all the messages we can till the write blocks or there are no
   // more outgoing messages.
   while (!output_queue_.empty()) {
     Message* msg = output_queue_.front();
 
-    size_t amt_to_write = msg->size() - message_send_bytes_written_;
-    DCHECK_NE(0U, amt_to_write);
-    const char* out_bytes = reinterpret_cast<const char*>(msg->data()) +
-        message_send_bytes_written_;
-
     struct msghdr msgh = {0};
-    struct iovec iov = {const_cast<char*>(out_bytes), amt_to_write};
-    msgh.msg_iov = &iov;
-    msgh.msg_iovlen = 1;
+    struct iovec iov[kMaxIovecsPerWrite];
     char buf[CMSG_SPACE(
         sizeof(int) * FileDescriptorSet::kMaxDescriptorsPerMessage)];
 
@@ -546,9 +563,9 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
         // fd_pipe_ which makes Seccomp sandbox operation more efficient.
         struct iovec fd_pipe_iov = { const_cast<char *>(""), 1 };
         msgh.msg_iov = &fd_pipe_iov;
+        msgh.msg_iovlen = 1;
         fd_written = fd_pipe_;
         bytes_written = HANDLE_EINTR(sendmsg(fd_pipe_, &msgh, MSG_DONTWAIT));
-        msgh.msg_iov = &iov;
         msgh.msg_controllen = 0;
         if (bytes_written > 0) {
           msg->file_descriptor_set()->CommitAll();
@@ -557,14 +574,53 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
 #endif  // IPC_USES_READWRITE
     }
 
+    // Gather the unwritten part of |msg| and as many of the messages behind
+    // it as fit into one write.  Descriptors travel with the first byte of a
+    // write, so the batch stops short of the next message that carries any.
+    size_t amt_to_write = 0;
+    size_t iov_count = 0;
+    std::vector<base::StringPiece> pieces;
+    for (size_t i = 0; i < output_queue_.size(); ++i) {
+      Message* batched = output_queue_[i];
+      if (i > 0) {
+        const FileDescriptorSet* fds =
+            static_cast<const Message*>(batched)->file_descriptor_set();
+        if (fds && !fds->empty())
+          break;
+      }
+
+      pieces.clear();
+      batched->GetWirePieces(&pieces);
+      if (i > 0 && iov_count + pieces.size() > kMaxIovecsPerWrite)
+        break;
+
+      size_t skip = i == 0 ? message_send_bytes_written_ : 0;
+      for (size_t j = 0; j < pieces.size() && iov_count < kMaxIovecsPerWrite;
+           ++j) {
+        if (skip >= pieces[j].size()) {
+          skip -= pieces[j].size();
+          continue;
+        }
+        iov[iov_count].iov_base = const_cast<char*>(pieces[j].data() + skip);
+        iov[iov_count].iov_len = pieces[j].size() - skip;
+        amt_to_write += iov[iov_count].iov_len;
+        ++iov_count;
+        skip = 0;
+      }
+    }
+    DCHECK_NE(0U, amt_to_write);
+    msgh.msg_iov = iov;
+    msgh.msg_iovlen = iov_count;
+
     if (bytes_written == 1) {
       fd_written = pipe_;
 #if defined(IPC_USES_READWRITE)
       if ((mode_ & MODE_CLIENT_FLAG) && IsHelloMessage(*msg)) {
         DCHECK_EQ(msg->file_descriptor_set()->size(), 1U);
       }
-      if (!msgh.msg_controllen) {
-        bytes_written = HANDLE_EINTR(write(pipe_, out_bytes, amt_to_write));
+      if (!msgh.msg_controllen && iov_count == 1) {
+        bytes_written = HANDLE_EINTR(write(pipe_, iov[0].iov_base,
+                                           iov[0].iov_len));
       } else
 #endif  // IPC_USES_READWRITE
       {
@@ -589,17 +645,33 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
       PLOG(ERROR) << "pipe error on "
                   << fd_written
                   << " Currently writing message of size: "
-                  << msg->size();
+                  << msg->wire_size();
       return false;
     }
 
-    if (static_cast<size_t>(bytes_written) != amt_to_write) {
-      if (bytes_written > 0) {
-        // If write() fails with EAGAIN then bytes_written will be -1.
-        message_send_bytes_written_ += bytes_written;
+    // Retire every message the write completed and remember how far into the
+    // next one it got.
+    size_t bytes_left = bytes_written > 0 ? bytes_written : 0;
+    while (bytes_left > 0) {
+      Message* sent = output_queue_.front();
+      size_t unsent = sent->wire_size() - message_send_bytes_written_;
+      if (bytes_left < unsent) {
+        message_send_bytes_written_ += bytes_left;
+        break;
       }
+      bytes_left -= unsent;
+      message_send_bytes_written_ = 0;
+
+      // Message sent OK!
+      DVLOG(2) << "sent message @" << sent << " on channel @" << this
+               << " with type " << sent->type() << " on fd " << pipe_;
+      delete sent;
+      output_queue_.pop_front();
+    }
 
+    if (static_cast<size_t>(bytes_written) != amt_to_write) {
       // Tell libevent to call us back once things are unblocked.
+      // If write() fails with EAGAIN then bytes_written will be -1.
       is_blocked_on_write_ = true;
       MessageLoopForIO::current()->WatchFileDescriptor(
           pipe_,
@@ -608,14 +680,6 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
           &write_watcher_,
           this);
       return true;
-    } else {
-      message_send_bytes_written_ = 0;
-
-      // Message sent OK!
-      DVLOG(2) << "sent message @" << msg << " on channel @" << this
-               << " with type " << msg->type() << " on fd " << pipe_;
-      delete output_queue_.front();
-      output_queue_.pop();
     }
   }
   return true;
@@ -630,7 +694,7 @@ bool Channel::ChannelImpl::Send(Message* message) {
   Logging::GetInstance()->OnSendMessage(message, "");
 #endif  // IPC_MESSAGE_LOG_ENABLED
 
-  output_queue_.push(message);
+  output_queue_.push_back(message);
   if (!is_blocked_on_write_ && !waiting_connect_) {
     return ProcessOutgoingMessages();
   }
@@ -722,9 +786,11 @@ void Channel::ChannelImpl::ResetToAcceptingConnectionState() {
   }
 #endif  // IPC_USES_READWRITE
 
+  CloseSharedMemory();
+
   while (!output_queue_.empty()) {
     Message* m = output_queue_.front();
-    output_queue_.pop();
+    output_queue_.pop_front();
     delete m;
   }
 
@@ -748,6 +814,7 @@ void Channel::ChannelImpl::SetGlobalPid(int pid) {
 // Called by libevent when we can read from the pipe without blocking.
 void Channel::ChannelImpl::OnFileCanReadWithoutBlocking(int fd) {
   bool send_server_hello_msg = false;
+  bool resume_output = false;
   if (fd == server_listen_pipe_) {
     int new_pipe = 0;
     if (!ServerAcceptConnection(server_listen_pipe_, &new_pipe)) {
@@ -797,7 +864,11 @@ void Channel::ChannelImpl::OnFileCanReadWithoutBlocking(int fd) {
       // ProcessOutgoingMessages.
       send_server_hello_msg = false;
       ClosePipeOnError();
+      return;
     }
+    // In shared memory mode a byte on the socket may mean that the peer freed
+    // space in our output ring, or a client may just have mapped the rings.
+    resume_output = uses_shared_memory() && !waiting_connect_;
   } else {
     NOTREACHED() << "Unknown pipe " << fd;
   }
@@ -808,6 +879,10 @@ void Channel::ChannelImpl::OnFileCanReadWithoutBlocking(int fd) {
   // is invalid.
   if (send_server_hello_msg) {
     ProcessOutgoingMessages();
+  } else if (resume_output) {
+    is_blocked_on_write_ = false;
+    if (!ProcessOutgoingMessages())
+      ClosePipeOnError();
   }
 }
 
@@ -826,6 +901,10 @@ bool Channel::ChannelImpl::AcceptConnection() {
                                                    MessageLoopForIO::WATCH_READ,
                                                    &read_watcher_,
                                                    this);
+  if (uses_shared_memory() && (mode_ & MODE_SERVER_FLAG) &&
+      !SendSharedMemory()) {
+    return false;
+  }
   QueueHelloMessage();
 
   if (mode_ & MODE_CLIENT_FLAG) {
@@ -886,7 +965,7 @@ void Channel::ChannelImpl::QueueHelloMessage() {
     DCHECK_EQ(msg->file_descriptor_set()->size(), 1U);
   }
 #endif  // IPC_USES_READWRITE
-  output_queue_.push(msg.release());
+  output_queue_.push_back(msg.release());
 }
 
 Channel::ChannelImpl::ReadState Channel::ChannelImpl::ReadData(
@@ -896,6 +975,9 @@ Channel::ChannelImpl::ReadState Channel::ChannelImpl::ReadData(
   if (pipe_ == -1)
     return READ_FAILED;
 
+  if (uses_shared_memory())
+    return ReadDataFromSharedMemory(buffer, buffer_len, bytes_read);
+
   struct msghdr msg = {0};
 
   struct iovec iov = {buffer, buffer_len};
@@ -978,6 +1060,13 @@ bool Channel::ChannelImpl::WillDispatchInputMessage(Message* msg) {
     return true;  // Nothing to do.
 
   // The message has file descriptors.
+  // In shared memory mode the descriptors were sent over the socket ahead of
+  // the message bytes, so they are already waiting there.
+  if (header_fds > input_fds_.size() && uses_shared_memory() &&
+      !DrainSocket()) {
+    return false;
+  }
+
   const char* error = NULL;
   if (header_fds > input_fds_.size()) {
     // The message has been completely received, but we didn't get
@@ -1064,6 +1153,256 @@ void Channel::ChannelImpl::ClearInputFDs() {
   input_fds_.clear();
 }
 
+bool Channel::ChannelImpl::SendSharedMemory() {
+  DCHECK(mode_ & MODE_SERVER_FLAG);
+  CloseSharedMemory();
+  shared_memory_.reset(new base::SharedMemory);
+  if (!shared_memory_->CreateAndMapAnonymous(SharedMemorySegmentSize())) {
+    LOG(ERROR) << "Unable to create shared memory for " << pipe_name_;
+    shared_memory_.reset();
+    return false;
+  }
+  char* memory = static_cast<char*>(shared_memory_->memory());
+  output_ring_.reset(new internal::SharedMemoryRingBuffer(
+      memory + SharedMemoryRingOffset(0), kSharedMemoryRingCapacity));
+  input_ring_.reset(new internal::SharedMemoryRingBuffer(
+      memory + SharedMemoryRingOffset(1), kSharedMemoryRingCapacity));
+  output_ring_->Initialize();
+  input_ring_->Initialize();
+
+  // The segment is the first thing on the socket, so the client knows the
+  // first descriptor it receives is the segment.
+  int fd = shared_memory_->handle().fd;
+  struct msghdr msgh = {0};
+  struct iovec iov = { const_cast<char*>(""), 1 };
+  char buf[CMSG_SPACE(sizeof(int))];
+  msgh.msg_iov = &iov;
+  msgh.msg_iovlen = 1;
+  msgh.msg_control = buf;
+  msgh.msg_controllen = sizeof(buf);
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgh);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &fd, sizeof(fd));
+  msgh.msg_controllen = cmsg->cmsg_len;
+  if (HANDLE_EINTR(sendmsg(pipe_, &msgh, MSG_DONTWAIT)) != 1) {
+    PLOG(ERROR) << "Unable to send shared memory on " << pipe_name_;
+    CloseSharedMemory();
+    return false;
+  }
+  return true;
+}
+
+bool Channel::ChannelImpl::MapSharedMemory(int fd) {
+  DCHECK(mode_ & MODE_CLIENT_FLAG);
+  shared_memory_.reset(
+      new base::SharedMemory(base::FileDescriptor(fd, true), false));
+  if (!shared_memory_->Map(SharedMemorySegmentSize())) {
+    LOG(ERROR) << "Unable to map shared memory for " << pipe_name_;
+    shared_memory_.reset();
+    return false;
+  }
+  char* memory = static_cast<char*>(shared_memory_->memory());
+  input_ring_.reset(new internal::SharedMemoryRingBuffer(
+      memory + SharedMemoryRingOffset(0), kSharedMemoryRingCapacity));
+  output_ring_.reset(new internal::SharedMemoryRingBuffer(
+      memory + SharedMemoryRingOffset(1), kSharedMemoryRingCapacity));
+  return true;
+}
+
+void Channel::ChannelImpl::CloseSharedMemory() {
+  input_ring_.reset();
+  output_ring_.reset();
+  shared_memory_.reset();
+}
+
+Channel::ChannelImpl::ReadState
+Channel::ChannelImpl::ReadDataFromSharedMemory(char* buffer,
+                                               int buffer_len,
+                                               int* bytes_read) {
+  if (!DrainSocket())
+    return READ_FAILED;
+  if (!input_ring_.get())
+    return READ_PENDING;  // The client is still waiting for the segment.
+
+  while (true) {
+    size_t bytes = input_ring_->Read(buffer, buffer_len);
+    if (input_ring_->corrupted()) {
+      LOG(ERROR) << "Corrupt shared memory ring on " << pipe_name_;
+      return READ_FAILED;
+    }
+    if (bytes) {
+      if (input_ring_->TakeWriterWaiting())
+        SendWakeup();
+      CloseClientFileDescriptor();
+      *bytes_read = static_cast<int>(bytes);
+      return READ_SUCCEEDED;
+    }
+    // Go to sleep until the peer sends a wakeup, unless data arrived after
+    // the read above.
+    if (input_ring_->WaitForData())
+      return READ_PENDING;
+  }
+}
+
+bool Channel::ChannelImpl::ProcessOutgoingMessagesToSharedMemory() {
+  if (!output_ring_.get())
+    return true;  // The client is still waiting for the segment.
+
+  bool wrote = false;
+  bool blocked = false;
+  while (!output_queue_.empty()) {
+    Message* msg = output_queue_.front();
+
+    if (message_send_bytes_written_ == 0 &&
+        !msg->file_descriptor_set()->empty()) {
+      const unsigned num_fds = msg->file_descriptor_set()->size();
+      DCHECK(num_fds <= FileDescriptorSet::kMaxDescriptorsPerMessage);
+      if (msg->file_descriptor_set()->ContainsDirectoryDescriptor()) {
+        LOG(FATAL) << "Panic: attempting to transport directory descriptor over"
+                      " IPC. Aborting to maintain sandbox isolation.";
+      }
+
+      struct msghdr msgh = {0};
+      struct iovec iov = { const_cast<char*>(""), 1 };
+      char buf[CMSG_SPACE(
+          sizeof(int) * FileDescriptorSet::kMaxDescriptorsPerMessage)];
+      msgh.msg_iov = &iov;
+      msgh.msg_iovlen = 1;
+      msgh.msg_control = buf;
+      msgh.msg_controllen = CMSG_SPACE(sizeof(int) * num_fds);
+      struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgh);
+      cmsg->cmsg_level = SOL_SOCKET;
+      cmsg->cmsg_type = SCM_RIGHTS;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(int) * num_fds);
+      msg->file_descriptor_set()->GetDescriptors(
+          reinterpret_cast<int*>(CMSG_DATA(cmsg)));
+      msgh.msg_controllen = cmsg->cmsg_len;
+      msg->header()->num_fds = static_cast<uint16>(num_fds);
+
+      int fd_written = pipe_;
+#if defined(IPC_USES_READWRITE)
+      // As on the socket path, only the Hello message sends its descriptor
+      // on the main socket.
+      if (!IsHelloMessage(*msg))
+        fd_written = fd_pipe_;
+#endif  // IPC_USES_READWRITE
+      ssize_t bytes_written =
+          HANDLE_EINTR(sendmsg(fd_written, &msgh, MSG_DONTWAIT));
+      if (bytes_written != 1) {
+        if (bytes_written < 0 && SocketWriteErrorIsRecoverable()) {
+          blocked = true;
+          MessageLoopForIO::current()->WatchFileDescriptor(
+              pipe_,
+              false,  // One shot
+              MessageLoopForIO::WATCH_WRITE,
+              &write_watcher_,
+              this);
+          break;
+        }
+        if (errno == EPIPE) {
+          Close();
+          return false;
+        }
+        PLOG(ERROR) << "pipe error on " << fd_written;
+        return false;
+      }
+      msg->file_descriptor_set()->CommitAll();
+    }
+
+    std::vector<base::StringPiece> pieces;
+    msg->GetWirePieces(&pieces);
+    size_t skip = message_send_bytes_written_;
+    bool ring_full = false;
+    for (size_t i = 0; i < pieces.size() && !ring_full; ++i) {
+      if (skip >= pieces[i].size()) {
+        skip -= pieces[i].size();
+        continue;
+      }
+      size_t len = pieces[i].size() - skip;
+      size_t bytes = output_ring_->Write(pieces[i].data() + skip, len);
+      message_send_bytes_written_ += bytes;
+      wrote |= bytes > 0;
+      ring_full = bytes < len;
+      skip = 0;
+    }
+    if (output_ring_->corrupted()) {
+      LOG(ERROR) << "Corrupt shared memory ring on " << pipe_name_;
+      return false;
+    }
+
+    if (message_send_bytes_written_ == msg->wire_size()) {
+      message_send_bytes_written_ = 0;
+
+      // Message sent OK!
+      DVLOG(2) << "sent message @" << msg << " on channel @" << this
+               << " with type " << msg->type() << " to shared memory";
+      delete msg;
+      output_queue_.pop_front();
+      continue;
+    }
+
+    // The ring is full.  Wake the reader first so that it can make room,
+    // then wait for it to wake us back unless it already has.
+    if (wrote && output_ring_->TakeReaderWaiting())
+      SendWakeup();
+    wrote = false;
+    if (output_ring_->WaitForSpace()) {
+      blocked = true;
+      break;
+    }
+  }
+
+  if (wrote && output_ring_->TakeReaderWaiting())
+    SendWakeup();
+  if (blocked)
+    is_blocked_on_write_ = true;
+  return true;
+}
+
+bool Channel::ChannelImpl::DrainSocket() {
+  char buffer[64];
+  while (true) {
+    struct msghdr msg = {0};
+    struct iovec iov = { buffer, sizeof(buffer) };
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = input_cmsg_buf_;
+    msg.msg_controllen = sizeof(input_cmsg_buf_);
+    ssize_t bytes_read = HANDLE_EINTR(recvmsg(pipe_, &msg, MSG_DONTWAIT));
+    if (bytes_read < 0) {
+      if (errno == EAGAIN)
+        break;
+      if (errno != ECONNRESET && errno != EPIPE)
+        PLOG(ERROR) << "pipe error (" << pipe_ << ")";
+      return false;
+    }
+    if (bytes_read == 0)
+      return false;  // The pipe has closed...
+    if (!ExtractFileDescriptorsFromMsghdr(&msg))
+      return false;
+  }
+
+  if (!input_ring_.get() && (mode_ & MODE_CLIENT_FLAG) && !input_fds_.empty()) {
+    int fd = input_fds_.front();
+    input_fds_.erase(input_fds_.begin());
+    if (!MapSharedMemory(fd))
+      return false;
+  }
+  return true;
+}
+
+void Channel::ChannelImpl::SendWakeup() {
+  char byte = 0;
+  // A full socket already holds wakeups the peer has yet to read, and any
+  // other error shows up on the next read.
+  if (HANDLE_EINTR(send(pipe_, &byte, 1, MSG_DONTWAIT)) < 0 &&
+      errno != EAGAIN) {
+    DPLOG(WARNING) << "Unable to wake peer on " << pipe_name_;
+  }
+}
+
 void Channel::ChannelImpl::HandleHelloMessage(const Message& msg) {
   // The Hello message contains only the process id.
   PickleIterator iter(msg);
@@ -10,15 +10,20 @@
 
 #include <sys/socket.h>  // for CMSG macros
 
-#include <queue>
+#include <deque>
 #include <string>
 #include <vector>
 
+#include "base/memory/scoped_ptr.h"
 #include "base/message_loop.h"
 #include "base/process.h"
 #include "ipc/file_descriptor_set_posix.h"
 #include "ipc/ipc_channel_reader.h"
 
+namespace base {
+class SharedMemory;
+}
+
 #if !defined(OS_MACOSX)
 // On Linux, the seccomp sandbox makes it very expensive to call
 // recvmsg() and sendmsg(). The restriction on calling read() and write(), which
@@ -49,6 +54,10 @@
 
 namespace IPC {
 
+namespace internal {
+class SharedMemoryRingBuffer;
+}
+
 class Channel::ChannelImpl : public internal::ChannelReader,
                              public MessageLoopForIO::Watcher {
  public:
@@ -82,6 +91,36 @@ class Channel::ChannelImpl : public internal::ChannelReader,
   int GetHelloMessageProcId();
   void QueueHelloMessage();
 
+  // Shared memory mode (MODE_SHARED_MEMORY_FLAG).  The server creates a
+  // segment holding one ring per direction and sends it to the client as the
+  // first descriptor on the socket.  From then on message bytes only travel
+  // through the rings; the socket carries descriptors, which are sent ahead
+  // of the bytes of their message, and single wakeup bytes for a peer that
+  // went to sleep on an empty or full ring.
+  bool uses_shared_memory() const {
+    return (mode_ & MODE_SHARED_MEMORY_FLAG) != 0;
+  }
+
+  // Server side: creates the rings and sends the segment to the client.
+  bool SendSharedMemory();
+
+  // Client side: maps the segment received as |fd| and takes ownership of it.
+  bool MapSharedMemory(int fd);
+
+  void CloseSharedMemory();
+
+  ReadState ReadDataFromSharedMemory(char* buffer,
+                                     int buffer_len,
+                                     int* bytes_read);
+  bool ProcessOutgoingMessagesToSharedMemory();
+
+  // Reads everything waiting on the socket in shared memory mode, collecting
+  // descriptors into input_fds_.  Returns false if the peer went away.
+  bool DrainSocket();
+
+  // Wakes the peer after it announced that it is waiting on a ring.
+  void SendWakeup();
+
   // ChannelReader implementation.
   virtual ReadState ReadData(char* buffer,
                              int buffer_len,
@@ -127,8 +166,9 @@ class Channel::ChannelImpl : public internal::ChannelReader,
   bool is_blocked_on_write_;
   bool waiting_connect_;
 
-  // If sending a message blocks then we use this variable
-  // to keep track of where we are.
+  // If sending a message blocks then we use this variable to keep track of
+  // where we are in the message at the front of |output_queue_|, counted in
+  // wire bytes.
   size_t message_send_bytes_written_;
 
   // File descriptor we're listening on for new connections if we listen
@@ -153,8 +193,14 @@ class Channel::ChannelImpl : public internal::ChannelReader,
   // the pipe.  On POSIX it's used as a key in a local map of file descriptors.
   std::string pipe_name_;
 
-  // Messages to be sent are queued here.
-  std::queue<Message*> output_queue_;
+  // Shared memory mode only; see uses_shared_memory().
+  scoped_ptr<base::SharedMemory> shared_memory_;
+  scoped_ptr<internal::SharedMemoryRingBuffer> input_ring_;
+  scoped_ptr<internal::SharedMemoryRingBuffer> output_ring_;
+
+  // Messages to be sent are queued here.  A deque rather than a queue so
+  // that consecutive messages can be gathered into a single write.
+  std::deque<Message*> output_queue_;
 
   // We assume a worst case: kReadBufferSize bytes of messages, where each
   // message has no payload and a full complement of descriptors.
@@ -11,14 +11,19 @@
 #include <sys/un.h>
 #include <unistd.h>
 
+#include <string>
+#include <vector>
+
 #include "base/basictypes.h"
 #include "base/eintr_wrapper.h"
 #include "base/file_path.h"
 #include "base/file_util.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop.h"
 #include "base/test/multiprocess_test.h"
 #include "base/test/test_timeouts.h"
+#include "ipc/ipc_message_utils.h"
 #include "testing/multiprocess_func_list.h"
 
 namespace {
@@ -90,6 +95,86 @@ class IPCChannelPosixTestListener : public IPC::Channel::Listener {
   bool quit_only_on_message_;
 };
 
+// Checks that each message carries its sequence number followed by
+// |bytes_per_sequence| times that many bytes of data, and quits the run loop
+// once |expected_count| have arrived.
+class GatheringTestListener : public IPC::Channel::Listener {
+ public:
+  GatheringTestListener(int expected_count, int bytes_per_sequence)
+      : expected_count_(expected_count),
+        bytes_per_sequence_(bytes_per_sequence),
+        received_count_(0) {
+  }
+
+  virtual ~GatheringTestListener() {}
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    PickleIterator iter(message);
+    int sequence;
+    const char* data;
+    int length;
+    EXPECT_TRUE(message.ReadInt(&iter, &sequence));
+    EXPECT_EQ(received_count_, sequence);
+    EXPECT_TRUE(message.ReadData(&iter, &data, &length));
+    EXPECT_EQ(std::string(sequence * bytes_per_sequence_, 'x'),
+              std::string(data, length));
+    if (++received_count_ == expected_count_)
+      MessageLoopForIO::current()->QuitNow();
+    return true;
+  }
+
+  int received_count() const { return received_count_; }
+
+ private:
+  int expected_count_;
+  int bytes_per_sequence_;
+  int received_count_;
+};
+
+// Expects a single message carrying one descriptor.
+class DescriptorTestListener : public IPC::Channel::Listener {
+ public:
+  DescriptorTestListener() : received_fd_(false) {}
+  virtual ~DescriptorTestListener() {}
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    PickleIterator iter(message);
+    base::FileDescriptor descriptor;
+    EXPECT_TRUE(message.ReadFileDescriptor(&iter, &descriptor));
+    received_fd_ = descriptor.fd >= 0;
+    if (received_fd_)
+      EXPECT_EQ(0, HANDLE_EINTR(close(descriptor.fd)));
+    MessageLoopForIO::current()->QuitNow();
+    return true;
+  }
+
+  bool received_fd() const { return received_fd_; }
+
+ private:
+  bool received_fd_;
+};
+
+// Sends |count| messages numbered from 0, each carrying |bytes_per_sequence|
+// times its number of bytes of data.  Odd messages attach their data as
+// external data.
+void SendNumberedMessages(IPC::Channel* channel,
+                          int count,
+                          int bytes_per_sequence) {
+  for (int i = 0; i < count; ++i) {
+    IPC::Message* message = new IPC::Message(0, 1,
+                                             IPC::Message::PRIORITY_NORMAL);
+    message->WriteInt(i);
+    std::string data(i * bytes_per_sequence, 'x');
+    if (i % 2) {
+      std::vector<unsigned char> bytes(data.begin(), data.end());
+      message->WriteExternalData(new base::RefCountedBytes(bytes));
+    } else {
+      message->WriteData(data.data(), data.size());
+    }
+    EXPECT_TRUE(channel->Send(message));
+  }
+}
+
 }  // namespace
 
 class IPCChannelPosixTest : public base::MultiProcessTest {
@@ -225,6 +310,99 @@ TEST_F(IPCChannelPosixTest, BasicConnected) {
   ASSERT_FALSE(channel2.AcceptsConnections());
 }
 
+TEST_F(IPCChannelPosixTest, GatheredWrites) {
+  // Queue enough messages, some with external data, that the server has to
+  // gather several into each write and split the backlog across writes.
+  // Both ends live in this process and share the message loop.
+  const int kMessageCount = 200;
+  int pipe_fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, pipe_fds));
+  ASSERT_GE(fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK), 0);
+  ASSERT_GE(fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK), 0);
+
+  IPCChannelPosixTestListener server_listener(true);
+  GatheringTestListener listener(kMessageCount, 1);
+  IPC::ChannelHandle server_handle(
+      "/var/tmp/IPCChannelPosixTest_GatheredWritesServer",
+      base::FileDescriptor(pipe_fds[0], true));
+  IPC::ChannelHandle client_handle(
+      "/var/tmp/IPCChannelPosixTest_GatheredWritesClient",
+      base::FileDescriptor(pipe_fds[1], true));
+  IPC::Channel server(server_handle, IPC::Channel::MODE_SERVER,
+                      &server_listener);
+  IPC::Channel client(client_handle, IPC::Channel::MODE_CLIENT, &listener);
+  ASSERT_TRUE(server.Connect());
+  ASSERT_TRUE(client.Connect());
+
+  // The server holds these until it has seen the client's hello.
+  SendNumberedMessages(&server, kMessageCount, 1);
+
+  SpinRunLoop(TestTimeouts::action_max_timeout_ms());
+  EXPECT_EQ(kMessageCount, listener.received_count());
+}
+
+TEST_F(IPCChannelPosixTest, SharedMemoryMode) {
+  // Messages up to several hundred kilobytes overflow the rings many times
+  // over, so both ends repeatedly wait for and wake each other.
+  const int kMessageCount = 100;
+  const int kBytesPerSequence = 5000;
+  int pipe_fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, pipe_fds));
+  ASSERT_GE(fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK), 0);
+  ASSERT_GE(fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK), 0);
+
+  IPCChannelPosixTestListener server_listener(true);
+  GatheringTestListener listener(kMessageCount, kBytesPerSequence);
+  IPC::ChannelHandle server_handle(
+      "/var/tmp/IPCChannelPosixTest_SharedMemoryServer",
+      base::FileDescriptor(pipe_fds[0], true));
+  IPC::ChannelHandle client_handle(
+      "/var/tmp/IPCChannelPosixTest_SharedMemoryClient",
+      base::FileDescriptor(pipe_fds[1], true));
+  IPC::Channel server(server_handle, IPC::Channel::MODE_SHARED_MEMORY_SERVER,
+                      &server_listener);
+  IPC::Channel client(client_handle, IPC::Channel::MODE_SHARED_MEMORY_CLIENT,
+                      &listener);
+  ASSERT_TRUE(server.Connect());
+  ASSERT_TRUE(client.Connect());
+  SendNumberedMessages(&server, kMessageCount, kBytesPerSequence);
+
+  SpinRunLoop(TestTimeouts::action_max_timeout_ms());
+  EXPECT_EQ(kMessageCount, listener.received_count());
+}
+
+TEST_F(IPCChannelPosixTest, SharedMemoryModeDescriptors) {
+  int pipe_fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, pipe_fds));
+  ASSERT_GE(fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK), 0);
+  ASSERT_GE(fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK), 0);
+
+  IPCChannelPosixTestListener server_listener(true);
+  DescriptorTestListener listener;
+  IPC::ChannelHandle server_handle(
+      "/var/tmp/IPCChannelPosixTest_SharedMemoryFdServer",
+      base::FileDescriptor(pipe_fds[0], true));
+  IPC::ChannelHandle client_handle(
+      "/var/tmp/IPCChannelPosixTest_SharedMemoryFdClient",
+      base::FileDescriptor(pipe_fds[1], true));
+  IPC::Channel server(server_handle, IPC::Channel::MODE_SHARED_MEMORY_SERVER,
+                      &server_listener);
+  IPC::Channel client(client_handle, IPC::Channel::MODE_SHARED_MEMORY_CLIENT,
+                      &listener);
+  ASSERT_TRUE(server.Connect());
+  ASSERT_TRUE(client.Connect());
+
+  int fd = open("/dev/null", O_RDONLY);
+  ASSERT_GE(fd, 0);
+  IPC::Message* message = new IPC::Message(0, 1,
+                                           IPC::Message::PRIORITY_NORMAL);
+  ASSERT_TRUE(message->WriteFileDescriptor(base::FileDescriptor(fd, true)));
+  ASSERT_TRUE(server.Send(message));
+
+  SpinRunLoop(TestTimeouts::action_max_timeout_ms());
+  EXPECT_TRUE(listener.received_fd());
+}
+
 TEST_F(IPCChannelPosixTest, AdvancedConnected) {
   // Test creating a connection to an external process.
   IPCChannelPosixTestListener listener(false);
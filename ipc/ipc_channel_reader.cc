@@ -4,11 +4,23 @@
 
 #include "ipc/ipc_channel_reader.h"
 
+#include <string.h>
+
 namespace IPC {
 namespace internal {
 
+ChannelReader::ReadStats::ReadStats()
+    : messages_dispatched(0),
+      bytes_copied(0),
+      bytes_read_in_place(0) {
+}
+
 ChannelReader::ChannelReader(Channel::Listener* listener)
-    : listener_(listener) {
+    : listener_(listener),
+      in_place_buf_capacity_(0),
+      in_place_message_size_(0),
+      in_place_bytes_received_(0),
+      max_read_buffer_size_(Channel::kMaximumReadBufferSize) {
   memset(input_buf_, 0, sizeof(input_buf_));
 }
 
@@ -17,22 +29,27 @@ ChannelReader::~ChannelReader() {
 
 bool ChannelReader::ProcessIncomingMessages() {
   while (true) {
+    char* buffer;
+    int buffer_len;
+    GetReadBuffer(&buffer, &buffer_len);
+
     int bytes_read = 0;
-    ReadState read_state = ReadData(input_buf_, Channel::kReadBufferSize,
-                                    &bytes_read);
+    ReadState read_state = ReadData(buffer, buffer_len, &bytes_read);
     if (read_state == READ_FAILED)
       return false;
-    if (read_state == READ_PENDING)
+    if (read_state == READ_PENDING) {
+      ShrinkBuffers();
       return true;
+    }
 
     DCHECK(bytes_read > 0);
-    if (!DispatchInputData(input_buf_, bytes_read))
+    if (!DidReadData(bytes_read))
       return false;
   }
 }
 
 bool ChannelReader::AsyncReadComplete(int bytes_read) {
-  return DispatchInputData(input_buf_, bytes_read);
+  return DidReadData(bytes_read);
 }
 
 bool ChannelReader::IsHelloMessage(const Message& m) const {
@@ -40,6 +57,37 @@ bool ChannelReader::IsHelloMessage(const Message& m) const {
          m.type() == Channel::HELLO_MESSAGE_TYPE;
 }
 
+void ChannelReader::GetReadBuffer(char** buffer, int* buffer_len) {
+  if (in_place_message_size_) {
+    *buffer = in_place_buf_.get() + in_place_bytes_received_;
+    *buffer_len =
+        static_cast<int>(in_place_message_size_ - in_place_bytes_received_);
+  } else {
+    *buffer = input_buf_;
+    *buffer_len = Channel::kReadBufferSize;
+  }
+}
+
+bool ChannelReader::DidReadData(int bytes_read) {
+  if (!in_place_message_size_)
+    return DispatchInputData(input_buf_, bytes_read);
+
+  // The read was limited to the rest of the message, so it cannot contain
+  // the start of the next one.
+  in_place_bytes_received_ += bytes_read;
+  read_stats_.bytes_read_in_place += bytes_read;
+  DCHECK_LE(in_place_bytes_received_, in_place_message_size_);
+  if (in_place_bytes_received_ < in_place_message_size_)
+    return true;
+
+  int message_size = static_cast<int>(in_place_message_size_);
+  in_place_message_size_ = 0;
+  in_place_bytes_received_ = 0;
+  if (!DispatchMessage(in_place_buf_.get(), message_size))
+    return false;
+  return DidEmptyInputBuffers();
+}
+
 bool ChannelReader::DispatchInputData(const char* input_data,
                                       int input_data_len) {
   const char* p;
@@ -57,6 +105,7 @@ bool ChannelReader::DispatchInputData(const char* input_data,
       return false;
     }
     input_overflow_buf_.append(input_data, input_data_len);
+    read_stats_.bytes_copied += input_data_len;
     p = input_overflow_buf_.data();
     end = p + input_overflow_buf_.size();
   }
@@ -66,14 +115,8 @@ bool ChannelReader::DispatchInputData(const char* input_data,
     const char* message_tail = Message::FindNext(p, end);
     if (message_tail) {
       int len = static_cast<int>(message_tail - p);
-      Message m(p, len);
-      if (!WillDispatchInputMessage(&m))
+      if (!DispatchMessage(p, len))
         return false;
-
-      if (IsHelloMessage(m))
-        HandleHelloMessage(m);
-      else
-        listener_->OnMessageReceived(m);
       p = message_tail;
     } else {
       // Last message is partial.
@@ -81,14 +124,68 @@ bool ChannelReader::DispatchInputData(const char* input_data,
     }
   }
 
-  // Save any partial data in the overflow buffer.
-  input_overflow_buf_.assign(p, end - p);
+  // A large partial message continues in its own buffer.
+  if (p < end && MaybeBeginInPlaceRead(p, end - p)) {
+    input_overflow_buf_.clear();
+    return true;
+  }
+
+  // Save any partial data in the overflow buffer.  Data already there only
+  // needs the dispatched messages trimmed off the front.
+  if (!input_overflow_buf_.empty()) {
+    input_overflow_buf_.erase(0, p - input_overflow_buf_.data());
+  } else {
+    input_overflow_buf_.assign(p, end - p);
+    read_stats_.bytes_copied += end - p;
+  }
 
   if (input_overflow_buf_.empty() && !DidEmptyInputBuffers())
     return false;
   return true;
 }
 
+bool ChannelReader::DispatchMessage(const char* data, int data_len) {
+  Message m(data, data_len);
+  if (!WillDispatchInputMessage(&m))
+    return false;
+
+  ++read_stats_.messages_dispatched;
+  if (IsHelloMessage(m))
+    HandleHelloMessage(m);
+  else
+    listener_->OnMessageReceived(m);
+  return true;
+}
+
+bool ChannelReader::MaybeBeginInPlaceRead(const char* data, size_t len) {
+  size_t message_size = Message::GetAnnouncedSize(data, data + len);
+  if (message_size <= Channel::kReadBufferSize ||
+      message_size > max_read_buffer_size_) {
+    return false;
+  }
+  DCHECK_GT(message_size, len);
+
+  if (in_place_buf_capacity_ < message_size) {
+    in_place_buf_.reset(new char[message_size]);
+    in_place_buf_capacity_ = message_size;
+  }
+  memcpy(in_place_buf_.get(), data, len);
+  read_stats_.bytes_copied += len;
+  in_place_message_size_ = message_size;
+  in_place_bytes_received_ = len;
+  return true;
+}
+
+void ChannelReader::ShrinkBuffers() {
+  if (!in_place_message_size_ && in_place_buf_capacity_) {
+    in_place_buf_.reset();
+    in_place_buf_capacity_ = 0;
+  }
+  if (input_overflow_buf_.empty() &&
+      input_overflow_buf_.capacity() > Channel::kReadBufferSize) {
+    std::string().swap(input_overflow_buf_);
+  }
+}
 
 }  // namespace internal
 }  // namespace IPC
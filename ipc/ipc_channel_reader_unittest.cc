@@ -0,0 +1,183 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ipc/ipc_channel_reader.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "ipc/ipc_message.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace IPC {
+namespace internal {
+
+namespace {
+
+const uint32 kTestMessageType = 1;
+
+// Records the data carried by each message it receives.
+class DataListener : public Channel::Listener {
+ public:
+  DataListener() {}
+  virtual ~DataListener() {}
+
+  virtual bool OnMessageReceived(const Message& message) OVERRIDE {
+    PickleIterator iter(message);
+    const char* data;
+    int length;
+    EXPECT_TRUE(message.ReadData(&iter, &data, &length));
+    received_.push_back(std::string(data, length));
+    return true;
+  }
+
+  const std::vector<std::string>& received() const { return received_; }
+
+ private:
+  std::vector<std::string> received_;
+
+  DISALLOW_COPY_AND_ASSIGN(DataListener);
+};
+
+// Serves queued wire bytes to the reader at most |chunk_size| bytes per read.
+class TestChannelReader : public ChannelReader {
+ public:
+  TestChannelReader(Channel::Listener* listener, size_t chunk_size)
+      : ChannelReader(listener),
+        chunk_size_(chunk_size),
+        largest_read_(0) {
+  }
+  virtual ~TestChannelReader() {}
+
+  void AppendMessage(const std::string& data) {
+    Message message(0, kTestMessageType, Message::PRIORITY_NORMAL);
+    message.WriteData(data.data(), data.size());
+    pending_.append(static_cast<const char*>(message.data()), message.size());
+  }
+
+  size_t largest_read() const { return largest_read_; }
+
+ protected:
+  virtual ReadState ReadData(char* buffer,
+                             int buffer_len,
+                             int* bytes_read) OVERRIDE {
+    if (pending_.empty())
+      return READ_PENDING;
+    size_t len = std::min(std::min(static_cast<size_t>(buffer_len),
+                                   chunk_size_),
+                          pending_.size());
+    memcpy(buffer, pending_.data(), len);
+    pending_.erase(0, len);
+    largest_read_ = std::max(largest_read_, len);
+    *bytes_read = static_cast<int>(len);
+    return READ_SUCCEEDED;
+  }
+
+  virtual bool WillDispatchInputMessage(Message* msg) OVERRIDE {
+    return true;
+  }
+
+  virtual bool DidEmptyInputBuffers() OVERRIDE {
+    return true;
+  }
+
+  virtual void HandleHelloMessage(const Message& msg) OVERRIDE {
+  }
+
+ private:
+  size_t chunk_size_;
+  size_t largest_read_;
+  std::string pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestChannelReader);
+};
+
+}  // namespace
+
+TEST(ChannelReaderTest, SmallMessagesAreNotCopied) {
+  DataListener listener;
+  TestChannelReader reader(&listener, Channel::kReadBufferSize);
+  reader.AppendMessage("one");
+  reader.AppendMessage("two");
+  reader.AppendMessage("three");
+
+  EXPECT_TRUE(reader.ProcessIncomingMessages());
+  ASSERT_EQ(3u, listener.received().size());
+  EXPECT_EQ("three", listener.received()[2]);
+  EXPECT_EQ(3u, reader.read_stats().messages_dispatched);
+  EXPECT_EQ(0u, reader.read_stats().bytes_copied);
+  EXPECT_EQ(0u, reader.read_stats().bytes_read_in_place);
+}
+
+TEST(ChannelReaderTest, LargeMessageIsReadInPlace) {
+  const std::string large(100 * 1024, 'x');
+  DataListener listener;
+  TestChannelReader reader(&listener, Channel::kMaximumReadBufferSize);
+  reader.AppendMessage(large);
+  reader.AppendMessage("after");
+
+  EXPECT_TRUE(reader.ProcessIncomingMessages());
+  ASSERT_EQ(2u, listener.received().size());
+  EXPECT_EQ(large, listener.received()[0]);
+  EXPECT_EQ("after", listener.received()[1]);
+
+  // Only the first read's worth of the large message is copied; the rest
+  // arrives with one read straight into its buffer.
+  EXPECT_EQ(static_cast<size_t>(Channel::kReadBufferSize),
+            reader.read_stats().bytes_copied);
+  EXPECT_GT(reader.read_stats().bytes_read_in_place, large.size() / 2);
+  EXPECT_GT(reader.largest_read(),
+            static_cast<size_t>(Channel::kReadBufferSize));
+}
+
+TEST(ChannelReaderTest, SplitLargeMessageIsReadInPlace) {
+  const std::string large(64 * 1024, 'y');
+  DataListener listener;
+  TestChannelReader reader(&listener, 1000);
+  reader.AppendMessage(large);
+
+  EXPECT_TRUE(reader.ProcessIncomingMessages());
+  ASSERT_EQ(1u, listener.received().size());
+  EXPECT_EQ(large, listener.received()[0]);
+  EXPECT_EQ(1000u, reader.read_stats().bytes_copied);
+}
+
+TEST(ChannelReaderTest, MessageAboveLimitUsesOverflowBuffer) {
+  const std::string large(100 * 1024, 'z');
+  DataListener listener;
+  TestChannelReader reader(&listener, Channel::kMaximumReadBufferSize);
+  reader.set_max_read_buffer_size(16 * 1024);
+  reader.AppendMessage(large);
+  reader.AppendMessage("after");
+
+  EXPECT_TRUE(reader.ProcessIncomingMessages());
+  ASSERT_EQ(2u, listener.received().size());
+  EXPECT_EQ(large, listener.received()[0]);
+  EXPECT_EQ("after", listener.received()[1]);
+  EXPECT_EQ(0u, reader.read_stats().bytes_read_in_place);
+  EXPECT_GT(reader.read_stats().bytes_copied, large.size());
+  EXPECT_EQ(static_cast<size_t>(Channel::kReadBufferSize),
+            reader.largest_read());
+}
+
+TEST(ChannelReaderTest, ReadsInPlaceAgainAfterIdle) {
+  const std::string large(32 * 1024, 'w');
+  DataListener listener;
+  TestChannelReader reader(&listener, Channel::kMaximumReadBufferSize);
+
+  reader.AppendMessage(large);
+  EXPECT_TRUE(reader.ProcessIncomingMessages());
+  reader.AppendMessage(large);
+  EXPECT_TRUE(reader.ProcessIncomingMessages());
+
+  ASSERT_EQ(2u, listener.received().size());
+  EXPECT_EQ(large, listener.received()[1]);
+  EXPECT_EQ(2 * Channel::kReadBufferSize, reader.read_stats().bytes_copied);
+}
+
+}  // namespace internal
+}  // namespace IPC
@@ -88,6 +88,8 @@ bool Channel::ChannelImpl::Send(Message* message) {
   Logging::GetInstance()->OnSendMessage(message, "");
 #endif
 
+  // WriteFile() takes a single buffer, so gather external data up front.
+  message->InlineExternalData();
   output_queue_.push(message);
   // ensure waiting to write
   if (!waiting_connect_) {
@@ -4,6 +4,8 @@
 
 #include "ipc/ipc_message.h"
 
+#include <string.h>
+
 #include "base/logging.h"
 #include "build/build_config.h"
 
@@ -11,6 +13,13 @@
 #include "ipc/file_descriptor_set_posix.h"
 #endif
 
+namespace {
+
+// Source of the zero padding that follows external data on the wire.
+const char kZeroPadding[sizeof(uint32)] = { 0 };
+
+}  // namespace
+
 namespace IPC {
 
 //------------------------------------------------------------------------------
@@ -19,24 +28,23 @@ Message::~Message() {
 }
 
 Message::Message()
-    : Pickle(sizeof(Header)) {
-  header()->routing = header()->type = header()->flags = 0;
-#if defined(OS_POSIX)
-  header()->num_fds = 0;
-  header()->pad = 0;
-#endif
+    : Pickle(sizeof(Header), 0, POOLED_STORAGE) {
+  InitHeader(0, 0, 0);
   InitLoggingVariables();
 }
 
 Message::Message(int32 routing_id, uint32 type, PriorityValue priority)
-    : Pickle(sizeof(Header)) {
-  header()->routing = routing_id;
-  header()->type = type;
-  header()->flags = priority;
-#if defined(OS_POSIX)
-  header()->num_fds = 0;
-  header()->pad = 0;
-#endif
+    : Pickle(sizeof(Header), 0, POOLED_STORAGE) {
+  InitHeader(routing_id, type, priority);
+  InitLoggingVariables();
+}
+
+Message::Message(int32 routing_id,
+                 uint32 type,
+                 PriorityValue priority,
+                 size_t payload_capacity)
+    : Pickle(sizeof(Header), payload_capacity, POOLED_STORAGE) {
+  InitHeader(routing_id, type, priority);
   InitLoggingVariables();
 }
 
@@ -44,13 +52,27 @@ Message::Message(const char* data, int data_len) : Pickle(data, data_len) {
   InitLoggingVariables();
 }
 
-Message::Message(const Message& other) : Pickle(other) {
+Message::Message(const Message& other)
+    : Pickle(other),
+      external_data_(other.external_data_) {
   InitLoggingVariables();
 #if defined(OS_POSIX)
   file_descriptor_set_ = other.file_descriptor_set_;
 #endif
 }
 
+void Message::InitHeader(int32 routing_id,
+                         uint32 type,
+                         uint32 flags) {
+  header()->routing = routing_id;
+  header()->type = type;
+  header()->flags = flags;
+#if defined(OS_POSIX)
+  header()->num_fds = 0;
+  header()->pad = 0;
+#endif
+}
+
 void Message::InitLoggingVariables() {
 #ifdef IPC_MESSAGE_LOG_ENABLED
   received_time_ = 0;
@@ -61,12 +83,105 @@ void Message::InitLoggingVariables() {
 
 Message& Message::operator=(const Message& other) {
   *static_cast<Pickle*>(this) = other;
+  external_data_ = other.external_data_;
 #if defined(OS_POSIX)
   file_descriptor_set_ = other.file_descriptor_set_;
 #endif
   return *this;
 }
 
+// static
+size_t Message::GetAnnouncedSize(const char* range_start,
+                                 const char* range_end) {
+  if (static_cast<size_t>(range_end - range_start) < sizeof(Header))
+    return 0;
+  const Header* hdr = reinterpret_cast<const Header*>(range_start);
+  return sizeof(Header) + hdr->payload_size;
+}
+
+bool Message::WriteExternalData(base::RefCountedMemory* buffer) {
+  DCHECK(buffer);
+  if (buffer->size() > static_cast<size_t>(kint32max))
+    return false;
+  if (!WriteInt(static_cast<int>(buffer->size())))
+    return false;
+
+  // WriteInt() leaves the payload size aligned, so the buffer starts on the
+  // same boundary WriteBytes() would have used.
+  ExternalData external_data;
+  external_data.offset = payload_size();
+  external_data.buffer = buffer;
+  external_data_.push_back(external_data);
+  return true;
+}
+
+size_t Message::wire_size() const {
+  size_t wire_size = size();
+  for (size_t i = 0; i < external_data_.size(); ++i)
+    wire_size += external_data_[i].buffer->size() + ExternalDataPadding(i);
+  return wire_size;
+}
+
+void Message::GetWirePieces(std::vector<base::StringPiece>* pieces) {
+  if (external_data_.empty()) {
+    pieces->push_back(base::StringPiece(static_cast<const char*>(data()),
+                                        size()));
+    return;
+  }
+
+  wire_header_ = *header();
+  wire_header_.payload_size =
+      static_cast<uint32>(wire_size() - sizeof(wire_header_));
+  pieces->push_back(base::StringPiece(
+      reinterpret_cast<const char*>(&wire_header_), sizeof(wire_header_)));
+
+  size_t start = 0;
+  for (size_t i = 0; i < external_data_.size(); ++i) {
+    const ExternalData& external_data = external_data_[i];
+    if (external_data.offset > start) {
+      pieces->push_back(base::StringPiece(payload() + start,
+                                          external_data.offset - start));
+    }
+    if (external_data.buffer->size()) {
+      pieces->push_back(base::StringPiece(
+          reinterpret_cast<const char*>(external_data.buffer->front()),
+          external_data.buffer->size()));
+    }
+    size_t padding = ExternalDataPadding(i);
+    if (padding)
+      pieces->push_back(base::StringPiece(kZeroPadding, padding));
+    start = external_data.offset;
+  }
+  if (payload_size() > start)
+    pieces->push_back(base::StringPiece(payload() + start,
+                                        payload_size() - start));
+}
+
+void Message::InlineExternalData() {
+  if (external_data_.empty())
+    return;
+
+  std::vector<base::StringPiece> pieces;
+  GetWirePieces(&pieces);
+  std::string bytes;
+  bytes.reserve(wire_size());
+  for (size_t i = 0; i < pieces.size(); ++i)
+    pieces[i].AppendToString(&bytes);
+
+  external_data_.clear();
+  *static_cast<Pickle*>(this) =
+      Pickle(bytes.data(), static_cast<int>(bytes.size()));
+}
+
+size_t Message::ExternalDataPadding(size_t index) const {
+  // As with WriteBytes(), data at the very end of the payload is not padded.
+  const ExternalData& external_data = external_data_[index];
+  if (external_data.offset == payload_size())
+    return 0;
+  size_t remainder = external_data.buffer->size() % sizeof(uint32);
+  return remainder ? sizeof(uint32) - remainder : 0;
+}
+
 #ifdef IPC_MESSAGE_LOG_ENABLED
 void Message::set_sent_time(int64 time) {
   DCHECK((header()->flags & HAS_SENT_TIME_BIT) == 0);
@@ -7,9 +7,13 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/pickle.h"
+#include "base/string_piece.h"
 #include "ipc/ipc_export.h"
 
 // Ipc logging adds a dependency from the 'chrome' target on all ipc message
@@ -19,10 +23,6 @@
 #define IPC_MESSAGE_LOG_ENABLED
 #endif
 
-#if defined(OS_POSIX)
-#include "base/memory/ref_counted.h"
-#endif
-
 namespace base {
 struct FileDescriptor;
 }
@@ -70,12 +70,21 @@ class IPC_EXPORT Message : public Pickle {
 
   virtual ~Message();
 
+  // Messages keep their data in pooled storage (see base::PickleBufferPool),
+  // since most are built, sent and destroyed at a high rate.
   Message();
 
   // Initialize a message with a user-defined type, priority value, and
   // destination WebView ID.
   Message(int32 routing_id, uint32 type, PriorityValue priority);
 
+  // As above, but reserves room for |payload_capacity| bytes of payload so
+  // that writing a payload of known size allocates only once.
+  Message(int32 routing_id,
+          uint32 type,
+          PriorityValue priority,
+          size_t payload_capacity);
+
   // Initializes a message from a const block of data.  The data is not copied;
   // instead the data is merely referenced by this message.  Only const methods
   // should be used on the message when initialized this way.
@@ -190,6 +199,34 @@ class IPC_EXPORT Message : public Pickle {
     return Pickle::FindNext(sizeof(Header), range_start, range_end);
   }
 
+  // Returns the total size announced by the header of the message that starts
+  // at range_start, or 0 if the range is too short to hold a header.
+  static size_t GetAnnouncedSize(const char* range_start,
+                                 const char* range_end);
+
+  // Appends the contents of |buffer| as if by WriteData(), but without copying
+  // them into the pickle.  The message holds a reference to |buffer| and the
+  // channel gathers it into the outgoing bytes when the message is written,
+  // so the receiver reads it back with ReadData() as usual.  Until then data()
+  // and size() describe only the pickled part of the message; see
+  // InlineExternalData().
+  bool WriteExternalData(base::RefCountedMemory* buffer);
+
+  bool has_external_data() const { return !external_data_.empty(); }
+
+  // Returns the number of bytes the message occupies on the wire, including
+  // any external data.
+  size_t wire_size() const;
+
+  // Appends to |pieces| the byte ranges which, concatenated, form the message
+  // as it is sent on the wire.  The ranges are only valid until the message
+  // is next modified.
+  void GetWirePieces(std::vector<base::StringPiece>* pieces);
+
+  // Copies any external data into the pickle, after which data() and size()
+  // describe the whole message.  Used by channels that cannot gather writes.
+  void InlineExternalData();
+
 #if defined(OS_POSIX)
   // On POSIX, a message supports reading / writing FileDescriptor objects.
   // This is used to pass a file descriptor to the peer of an IPC channel.
@@ -246,8 +283,26 @@ class IPC_EXPORT Message : public Pickle {
     return headerT<Header>();
   }
 
+  void InitHeader(int32 routing_id, uint32 type, uint32 flags);
   void InitLoggingVariables();
 
+  // Returns the number of zero bytes sent after external_data_[index] to keep
+  // the pickled data that follows it aligned.
+  size_t ExternalDataPadding(size_t index) const;
+
+  struct ExternalData {
+    // Offset into the payload at which |buffer| is spliced in on the wire.
+    size_t offset;
+    scoped_refptr<base::RefCountedMemory> buffer;
+  };
+
+  // Buffers attached by WriteExternalData(), in payload order.
+  std::vector<ExternalData> external_data_;
+
+  // The header as sent on the wire when external data is attached; its
+  // payload size counts the external bytes.  Filled by GetWirePieces().
+  Header wire_header_;
+
 #if defined(OS_POSIX)
   // The set of file descriptors associated with this message.
   scoped_refptr<FileDescriptorSet> file_descriptor_set_;
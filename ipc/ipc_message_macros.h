@@ -45,6 +45,11 @@
 //     // Generate destructors.
 //     #include "ipc/struct_destructor_macros.h"
 //     #include "path/to/YYY_message_generator.h"
+//     // Generate param traits size methods.
+//     #include "ipc/param_traits_size_macros.h"
+//     namespace IPC {
+//     #include "path/to/YYY_message_generator.h"
+//     }  // namespace IPC
 //     // Generate param traits write methods.
 //     #include "ipc/param_traits_write_macros.h"
 //     namespace IPC {
@@ -706,7 +711,8 @@
 
 #define IPC_ASYNC_CONTROL_IMPL(msg_class, in_cnt, out_cnt, in_list, out_list) \
   msg_class::msg_class(IPC_TYPE_IN_##in_cnt in_list) :                        \
-      IPC::Message(MSG_ROUTING_CONTROL, ID, PRIORITY_NORMAL) {                \
+      IPC::Message(MSG_ROUTING_CONTROL, ID, PRIORITY_NORMAL,                  \
+                   Schema::GetSize(IPC_NAME_IN_##in_cnt in_list)) {           \
         Schema::Write(this, IPC_NAME_IN_##in_cnt in_list);                    \
       }                                                                       \
   msg_class::~msg_class() {}                                                  \
@@ -717,7 +723,8 @@
 #define IPC_ASYNC_ROUTED_IMPL(msg_class, in_cnt, out_cnt, in_list, out_list)  \
   msg_class::msg_class(int32 routing_id IPC_COMMA_##in_cnt                    \
                        IPC_TYPE_IN_##in_cnt in_list) :                        \
-      IPC::Message(routing_id, ID, PRIORITY_NORMAL) {                         \
+      IPC::Message(routing_id, ID, PRIORITY_NORMAL,                           \
+                   Schema::GetSize(IPC_NAME_IN_##in_cnt in_list)) {           \
         Schema::Write(this, IPC_NAME_IN_##in_cnt in_list);                    \
       }                                                                       \
   msg_class::~msg_class() {}                                                  \
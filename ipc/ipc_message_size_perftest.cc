@@ -0,0 +1,108 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Compares building messages that grow as their parameters are written with
+// building messages that reserve their computed payload size up front.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/string16.h"
+#include "base/test/perf_benchmark.h"
+#include "base/utf_string_conversions.h"
+#include "ipc/ipc_message.h"
+#include "ipc/ipc_message_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// Get basic type definitions.
+#define IPC_MESSAGE_IMPL
+#include "ipc/ipc_message_size_unittest.h"
+
+// Generate constructors.
+#include "ipc/struct_constructor_macros.h"
+#include "ipc/ipc_message_size_unittest.h"
+
+// Generate destructors.
+#include "ipc/struct_destructor_macros.h"
+#include "ipc/ipc_message_size_unittest.h"
+
+// Generate param traits size methods.
+#include "ipc/param_traits_size_macros.h"
+namespace IPC {
+#include "ipc/ipc_message_size_unittest.h"
+}  // namespace IPC
+
+// Generate param traits write methods.
+#include "ipc/param_traits_write_macros.h"
+namespace IPC {
+#include "ipc/ipc_message_size_unittest.h"
+}  // namespace IPC
+
+// Generate param traits read methods.
+#include "ipc/param_traits_read_macros.h"
+namespace IPC {
+#include "ipc/ipc_message_size_unittest.h"
+}  // namespace IPC
+
+// Generate param traits log methods.
+#include "ipc/param_traits_log_macros.h"
+namespace IPC {
+#include "ipc/ipc_message_size_unittest.h"
+}  // namespace IPC
+
+namespace {
+
+const int kNumItems = 100;
+const int kMessagesPerRun = 100;
+
+SizeTestStruct MakeStruct(int id) {
+  SizeTestStruct s;
+  s.id = id;
+  s.flag = (id % 2) != 0;
+  s.scale = id * 0.5;
+  s.kind = SIZE_TEST_SECOND;
+  s.name = std::string(id % 13, 'n');
+  s.title = ASCIIToUTF16(std::string(id % 7, 't'));
+  s.values.assign(id % 5, id);
+  return s;
+}
+
+// Writes the parameters into a message that starts out empty.
+void BuildUnsizedMessage(const std::vector<SizeTestStruct>& items,
+                         const SizeTestNameMap& names) {
+  IPC::Message message(1, SizeTestMsg_Routed::ID,
+                       IPC::Message::PRIORITY_NORMAL);
+  IPC::WriteParam(&message, MakeRefTuple(items, names));
+  CHECK_GT(message.payload_size(), 0u);
+}
+
+// The generated constructor computes the size of the parameters first.
+void BuildSizedMessage(const std::vector<SizeTestStruct>& items,
+                       const SizeTestNameMap& names) {
+  SizeTestMsg_Routed message(1, items, names);
+  CHECK_GT(message.payload_size(), 0u);
+}
+
+}  // namespace
+
+TEST(IPCMessageSizePerfTest, SizedWrite) {
+  std::vector<SizeTestStruct> items;
+  SizeTestNameMap names;
+  for (int i = 0; i < kNumItems; ++i) {
+    items.push_back(MakeStruct(i));
+    names[i] = std::string(i, 'x');
+  }
+
+  base::PerfBenchmark unsized_benchmark("IPCMessage_UnsizedWrite");
+  unsized_benchmark.set_iterations_per_run(kMessagesPerRun);
+  unsized_benchmark.Run(base::Bind(&BuildUnsizedMessage, items, names));
+
+  base::PerfBenchmark sized_benchmark("IPCMessage_SizedWrite");
+  sized_benchmark.set_iterations_per_run(kMessagesPerRun);
+  sized_benchmark.Run(base::Bind(&BuildSizedMessage, items, names));
+}
@@ -0,0 +1,210 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Checks that ParamTraits<P>::GetSize() matches the bytes that
+// ParamTraits<P>::Write() appends, and that messages reserve their payload
+// up front.
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/file_path.h"
+#include "base/string16.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "ipc/ipc_message.h"
+#include "ipc/ipc_message_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// Get basic type definitions.
+#define IPC_MESSAGE_IMPL
+#include "ipc/ipc_message_size_unittest.h"
+
+// Generate constructors.
+#include "ipc/struct_constructor_macros.h"
+#include "ipc/ipc_message_size_unittest.h"
+
+// Generate destructors.
+#include "ipc/struct_destructor_macros.h"
+#include "ipc/ipc_message_size_unittest.h"
+
+// Generate param traits size methods.
+#include "ipc/param_traits_size_macros.h"
+namespace IPC {
+#include "ipc/ipc_message_size_unittest.h"
+}  // namespace IPC
+
+// Generate param traits write methods.
+#include "ipc/param_traits_write_macros.h"
+namespace IPC {
+#include "ipc/ipc_message_size_unittest.h"
+}  // namespace IPC
+
+// Generate param traits read methods.
+#include "ipc/param_traits_read_macros.h"
+namespace IPC {
+#include "ipc/ipc_message_size_unittest.h"
+}  // namespace IPC
+
+// Generate param traits log methods.
+#include "ipc/param_traits_log_macros.h"
+namespace IPC {
+#include "ipc/ipc_message_size_unittest.h"
+}  // namespace IPC
+
+namespace {
+
+// A type whose traits predate GetSize().
+struct UnsizedType {
+  int value;
+};
+
+}  // namespace
+
+namespace IPC {
+
+template <>
+struct ParamTraits<UnsizedType> {
+  typedef UnsizedType param_type;
+  static void Write(Message* m, const param_type& p) {
+    m->WriteInt(p.value);
+  }
+  static bool Read(const Message* m, PickleIterator* iter, param_type* r) {
+    return m->ReadInt(iter, &r->value);
+  }
+  static void Log(const param_type& p, std::string* l) {
+  }
+};
+
+}  // namespace IPC
+
+namespace {
+
+// Returns the number of payload bytes WriteParam() appends for |p|.
+template <class P>
+size_t GetWrittenSize(const P& p) {
+  IPC::Message message(0, 1, IPC::Message::PRIORITY_NORMAL);
+  IPC::WriteParam(&message, p);
+  return message.payload_size();
+}
+
+// Like GetWrittenSize(), but rounded up the way the next write would see it.
+template <class P>
+size_t GetAlignedWrittenSize(const P& p) {
+  return IPC::GetPaddedSize(GetWrittenSize(p));
+}
+
+SizeTestStruct MakeStruct(int id) {
+  SizeTestStruct s;
+  s.id = id;
+  s.flag = (id % 2) != 0;
+  s.scale = id * 0.5;
+  s.kind = SIZE_TEST_SECOND;
+  s.name = std::string(id % 13, 'n');
+  s.title = ASCIIToUTF16(std::string(id % 7, 't'));
+  s.values.assign(id % 5, id);
+  return s;
+}
+
+}  // namespace
+
+TEST(IPCMessageSizeTest, Scalars) {
+  EXPECT_EQ(GetAlignedWrittenSize(true), IPC::GetParamSize(true));
+  EXPECT_EQ(GetAlignedWrittenSize(42), IPC::GetParamSize(42));
+  EXPECT_EQ(GetAlignedWrittenSize(42u), IPC::GetParamSize(42u));
+  EXPECT_EQ(GetAlignedWrittenSize(42L), IPC::GetParamSize(42L));
+  EXPECT_EQ(GetAlignedWrittenSize(static_cast<int64>(42)),
+            IPC::GetParamSize(static_cast<int64>(42)));
+  EXPECT_EQ(GetAlignedWrittenSize(static_cast<uint64>(42)),
+            IPC::GetParamSize(static_cast<uint64>(42)));
+  EXPECT_EQ(GetAlignedWrittenSize(static_cast<unsigned short>(42)),
+            IPC::GetParamSize(static_cast<unsigned short>(42)));
+  EXPECT_EQ(GetAlignedWrittenSize(1.5f), IPC::GetParamSize(1.5f));
+  EXPECT_EQ(GetAlignedWrittenSize(1.5), IPC::GetParamSize(1.5));
+  EXPECT_EQ(GetAlignedWrittenSize(base::Time::Now()),
+            IPC::GetParamSize(base::Time::Now()));
+  EXPECT_EQ(GetAlignedWrittenSize(base::TimeDelta::FromSeconds(1)),
+            IPC::GetParamSize(base::TimeDelta::FromSeconds(1)));
+  EXPECT_EQ(GetAlignedWrittenSize(SIZE_TEST_SECOND),
+            IPC::GetParamSize(SIZE_TEST_SECOND));
+}
+
+TEST(IPCMessageSizeTest, StringsAndContainers) {
+  for (size_t length = 0; length < 9; ++length) {
+    std::string str(length, 's');
+    EXPECT_EQ(GetAlignedWrittenSize(str), IPC::GetParamSize(str));
+    string16 str16 = ASCIIToUTF16(str);
+    EXPECT_EQ(GetAlignedWrittenSize(str16), IPC::GetParamSize(str16));
+    std::wstring wstr(length, L'w');
+    EXPECT_EQ(GetAlignedWrittenSize(wstr), IPC::GetParamSize(wstr));
+    std::vector<char> chars(length, 'c');
+    EXPECT_EQ(GetAlignedWrittenSize(chars), IPC::GetParamSize(chars));
+    std::vector<unsigned char> bytes(length, 'b');
+    EXPECT_EQ(GetAlignedWrittenSize(bytes), IPC::GetParamSize(bytes));
+    std::vector<bool> bools(length, true);
+    EXPECT_EQ(GetAlignedWrittenSize(bools), IPC::GetParamSize(bools));
+    FilePath path(FILE_PATH_LITERAL("path"));
+    EXPECT_EQ(GetAlignedWrittenSize(path), IPC::GetParamSize(path));
+  }
+
+  std::vector<std::string> strings;
+  std::set<int> ints;
+  std::map<int, std::string> names;
+  for (int i = 0; i < 10; ++i) {
+    strings.push_back(std::string(i, 'v'));
+    ints.insert(i);
+    names[i] = std::string(i, 'm');
+  }
+  EXPECT_EQ(GetAlignedWrittenSize(strings), IPC::GetParamSize(strings));
+  EXPECT_EQ(GetAlignedWrittenSize(ints), IPC::GetParamSize(ints));
+  EXPECT_EQ(GetAlignedWrittenSize(names), IPC::GetParamSize(names));
+  std::pair<int, std::string> pair(1, "abc");
+  EXPECT_EQ(GetAlignedWrittenSize(pair), IPC::GetParamSize(pair));
+}
+
+TEST(IPCMessageSizeTest, GeneratedStructTraits) {
+  for (int i = 0; i < 20; ++i) {
+    SizeTestStruct s = MakeStruct(i);
+    EXPECT_EQ(GetAlignedWrittenSize(s), IPC::GetParamSize(s));
+  }
+}
+
+TEST(IPCMessageSizeTest, TraitsWithoutGetSizeCountAsZero) {
+  UnsizedType unsized = { 3 };
+  EXPECT_EQ(0u, IPC::GetParamSize(unsized));
+
+  // Containers of such types are only bounded from below.
+  std::vector<UnsizedType> list(4, unsized);
+  EXPECT_EQ(sizeof(int), IPC::GetParamSize(list));
+  EXPECT_LT(IPC::GetParamSize(list), GetWrittenSize(list));
+}
+
+TEST(IPCMessageSizeTest, MessagesReserveTheirPayload) {
+  SizeTestMsg_Control control(7, "name", MakeStruct(11));
+  EXPECT_EQ(GetAlignedWrittenSize(MakeStruct(11)) +
+                IPC::GetParamSize(7) +
+                IPC::GetParamSize(std::string("name")),
+            IPC::GetPaddedSize(control.payload_size()));
+
+  std::vector<SizeTestStruct> items;
+  std::map<int, std::string> names;
+  for (int i = 0; i < 50; ++i) {
+    items.push_back(MakeStruct(i));
+    names[i] = std::string(i, 'x');
+  }
+  SizeTestMsg_Routed routed(1, items, names);
+  // The computed size includes the padding after the last field.
+  EXPECT_EQ(IPC::GetParamSize(items) + IPC::GetParamSize(names),
+            IPC::GetPaddedSize(routed.payload_size()));
+
+  // The generated Read() still agrees with the sized write.
+  Tuple2<std::vector<SizeTestStruct>, std::map<int, std::string> > params;
+  ASSERT_TRUE(SizeTestMsg_Routed::Read(&routed, &params));
+  ASSERT_EQ(items.size(), params.a.size());
+  EXPECT_EQ(items[49].title, params.a[49].title);
+  EXPECT_EQ(names, params.b);
+}
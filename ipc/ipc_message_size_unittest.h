@@ -0,0 +1,48 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Test messages for the serialized-size traits.
+// Multiply-included message file, hence no include guard.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/string16.h"
+#include "ipc/ipc_message_macros.h"
+
+#define IPC_MESSAGE_START TestMsgStart
+
+#ifndef IPC_IPC_MESSAGE_SIZE_UNITTEST_H_
+#define IPC_IPC_MESSAGE_SIZE_UNITTEST_H_
+
+enum SizeTestEnum {
+  SIZE_TEST_FIRST,
+  SIZE_TEST_SECOND,
+};
+
+typedef std::map<int, std::string> SizeTestNameMap;
+
+#endif  // IPC_IPC_MESSAGE_SIZE_UNITTEST_H_
+
+IPC_ENUM_TRAITS(SizeTestEnum)
+
+IPC_STRUCT_BEGIN(SizeTestStruct)
+  IPC_STRUCT_MEMBER(int, id)
+  IPC_STRUCT_MEMBER(bool, flag)
+  IPC_STRUCT_MEMBER(double, scale)
+  IPC_STRUCT_MEMBER(SizeTestEnum, kind)
+  IPC_STRUCT_MEMBER(std::string, name)
+  IPC_STRUCT_MEMBER(string16, title)
+  IPC_STRUCT_MEMBER(std::vector<int>, values)
+IPC_STRUCT_END()
+
+IPC_MESSAGE_CONTROL3(SizeTestMsg_Control,
+                     int /* id */,
+                     std::string /* name */,
+                     SizeTestStruct /* details */)
+
+IPC_MESSAGE_ROUTED2(SizeTestMsg_Routed,
+                    std::vector<SizeTestStruct> /* items */,
+                    SizeTestNameMap /* names */)
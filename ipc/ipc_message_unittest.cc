@@ -6,6 +6,10 @@
 
 #include <string.h>
 
+#include <string>
+#include <vector>
+
+#include "base/memory/ref_counted_memory.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/values.h"
 #include "ipc/ipc_message_utils.h"
@@ -67,3 +71,84 @@ TEST(IPCMessageTest, DictionaryValue) {
   iter = PickleIterator(bad_msg);
   EXPECT_FALSE(IPC::ReadParam(&bad_msg, &iter, &output));
 }
+
+namespace {
+
+std::string FlattenWirePieces(IPC::Message* msg) {
+  std::vector<base::StringPiece> pieces;
+  msg->GetWirePieces(&pieces);
+  std::string bytes;
+  for (size_t i = 0; i < pieces.size(); ++i)
+    pieces[i].AppendToString(&bytes);
+  return bytes;
+}
+
+}  // namespace
+
+TEST(IPCMessageTest, ExternalData) {
+  std::vector<unsigned char> first(5, 'a');
+  std::vector<unsigned char> second(7, 'b');
+  scoped_refptr<base::RefCountedBytes> first_buffer(
+      new base::RefCountedBytes(first));
+  scoped_refptr<base::RefCountedBytes> second_buffer(
+      new base::RefCountedBytes(second));
+
+  // |expected| pickles the same values the ordinary way.
+  IPC::Message expected(1, 2, IPC::Message::PRIORITY_NORMAL);
+  expected.WriteInt(10);
+  expected.WriteData(reinterpret_cast<const char*>(&first[0]), first.size());
+  expected.WriteInt(20);
+  expected.WriteData(reinterpret_cast<const char*>(&second[0]), second.size());
+
+  IPC::Message msg(1, 2, IPC::Message::PRIORITY_NORMAL);
+  EXPECT_FALSE(msg.has_external_data());
+  msg.WriteInt(10);
+  EXPECT_TRUE(msg.WriteExternalData(first_buffer));
+  msg.WriteInt(20);
+  EXPECT_TRUE(msg.WriteExternalData(second_buffer));
+  EXPECT_TRUE(msg.has_external_data());
+
+  // Only the length prefixes are pickled; the wire form matches |expected|.
+  EXPECT_LT(msg.size(), expected.size());
+  EXPECT_EQ(expected.size(), msg.wire_size());
+  std::string expected_bytes(static_cast<const char*>(expected.data()),
+                             expected.size());
+  EXPECT_EQ(expected_bytes, FlattenWirePieces(&msg));
+
+  // A copy shares the external buffers.
+  IPC::Message copy(msg);
+  EXPECT_EQ(expected_bytes, FlattenWirePieces(&copy));
+
+  msg.InlineExternalData();
+  EXPECT_FALSE(msg.has_external_data());
+  EXPECT_EQ(expected.size(), msg.size());
+  EXPECT_EQ(expected_bytes,
+            std::string(static_cast<const char*>(msg.data()), msg.size()));
+
+  PickleIterator iter(msg);
+  int value;
+  const char* data;
+  int length;
+  EXPECT_TRUE(msg.ReadInt(&iter, &value));
+  EXPECT_EQ(10, value);
+  EXPECT_TRUE(msg.ReadData(&iter, &data, &length));
+  EXPECT_EQ(std::string(first.begin(), first.end()),
+            std::string(data, length));
+  EXPECT_TRUE(msg.ReadInt(&iter, &value));
+  EXPECT_EQ(20, value);
+  EXPECT_TRUE(msg.ReadData(&iter, &data, &length));
+  EXPECT_EQ(std::string(second.begin(), second.end()),
+            std::string(data, length));
+}
+
+TEST(IPCMessageTest, WirePiecesWithoutExternalData) {
+  IPC::Message msg(1, 2, IPC::Message::PRIORITY_NORMAL);
+  msg.WriteInt(42);
+
+  std::vector<base::StringPiece> pieces;
+  msg.GetWirePieces(&pieces);
+  ASSERT_EQ(1u, pieces.size());
+  EXPECT_EQ(msg.data(), pieces[0].data());
+  EXPECT_EQ(msg.size(), pieces[0].size());
+  EXPECT_EQ(msg.size(), msg.wire_size());
+}
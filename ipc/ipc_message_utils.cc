@@ -348,6 +348,10 @@ void ParamTraits<std::wstring>::Log(const param_type& p, std::string* l) {
   l->append(WideToUTF8(p));
 }
 
+size_t ParamTraits<NullableString16>::GetSize(const param_type& p) {
+  return GetParamSize(p.string()) + GetParamSize(p.is_null());
+}
+
 void ParamTraits<NullableString16>::Write(Message* m, const param_type& p) {
   WriteParam(m, p.string());
   WriteParam(m, p.is_null());
@@ -380,6 +384,10 @@ void ParamTraits<string16>::Log(const param_type& p, std::string* l) {
 #endif
 
 
+size_t ParamTraits<FilePath>::GetSize(const param_type& p) {
+  return GetParamSize(p.value());
+}
+
 void ParamTraits<FilePath>::Write(Message* m, const param_type& p) {
   ParamTraits<FilePath::StringType>::Write(m, p.value());
 }
@@ -399,6 +407,11 @@ void ParamTraits<FilePath>::Log(const param_type& p, std::string* l) {
 }
 
 #if defined(OS_POSIX)
+size_t ParamTraits<base::FileDescriptor>::GetSize(const param_type& p) {
+  // A validity flag, then the descriptor's index.
+  return p.fd >= 0 ? 2 * sizeof(int) : sizeof(int);
+}
+
 void ParamTraits<base::FileDescriptor>::Write(Message* m, const param_type& p) {
   const bool valid = p.fd >= 0;
   WriteParam(m, valid);
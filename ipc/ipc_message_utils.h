@@ -184,9 +184,62 @@ static inline void LogParam(const P& p, std::string* l) {
   ParamTraits<Type>::Log(static_cast<const Type& >(p), l);
 }
 
+// Returns the number of payload bytes a write of |bytes| bytes takes up in a
+// message, including the padding that keeps the next write aligned.
+inline size_t GetPaddedSize(size_t bytes) {
+  return (bytes + sizeof(uint32) - 1) & ~(sizeof(uint32) - 1);
+}
+
+// Payload bytes taken by WriteData() of |bytes| bytes: a length, then the
+// padded data.
+inline size_t GetDataSize(size_t bytes) {
+  return sizeof(int) + GetPaddedSize(bytes);
+}
+
+namespace internal {
+
+// Detects whether ParamTraits<P> provides
+//   static size_t GetSize(const param_type& p);
+template <class P>
+struct ParamTraitsHaveGetSize {
+  typedef char Yes;
+  struct No { char dummy[2]; };
+
+  template <size_t (*)(const P&)> struct Check;
+  template <class T> static Yes Test(Check<&ParamTraits<T>::GetSize>*);
+  template <class T> static No Test(...);
+
+  static const bool value = sizeof(Test<P>(NULL)) == sizeof(Yes);
+};
+
+template <class P, bool has_get_size = ParamTraitsHaveGetSize<P>::value>
+struct ParamSize {
+  static size_t Get(const P& p) { return ParamTraits<P>::GetSize(p); }
+};
+
+template <class P>
+struct ParamSize<P, false> {
+  static size_t Get(const P& p) { return 0; }
+};
+
+}  // namespace internal
+
+// Returns the number of payload bytes WriteParam(m, p) appends to a message.
+// ParamTraits that do not implement GetSize() count as zero bytes, so for
+// types containing those the result is only a lower bound; it is a sizing
+// hint, never a limit.
+template <class P>
+static inline size_t GetParamSize(const P& p) {
+  typedef typename SimilarTypeTraits<P>::Type Type;
+  return internal::ParamSize<Type>::Get(static_cast<const Type& >(p));
+}
+
 template <>
 struct ParamTraits<bool> {
   typedef bool param_type;
+  static size_t GetSize(const param_type& p) {
+    return sizeof(int);
+  }
   static void Write(Message* m, const param_type& p) {
     m->WriteBool(p);
   }
@@ -202,6 +255,9 @@ struct ParamTraits<bool> {
 template <>
 struct ParamTraits<int> {
   typedef int param_type;
+  static size_t GetSize(const param_type& p) {
+    return sizeof(int);
+  }
   static void Write(Message* m, const param_type& p) {
     m->WriteInt(p);
   }
@@ -215,6 +271,9 @@ struct ParamTraits<int> {
 template <>
 struct ParamTraits<unsigned int> {
   typedef unsigned int param_type;
+  static size_t GetSize(const param_type& p) {
+    return sizeof(int);
+  }
   static void Write(Message* m, const param_type& p) {
     m->WriteInt(p);
   }
@@ -228,6 +287,9 @@ struct ParamTraits<unsigned int> {
 template <>
 struct ParamTraits<long> {
   typedef long param_type;
+  static size_t GetSize(const param_type& p) {
+    return sizeof(long);
+  }
   static void Write(Message* m, const param_type& p) {
     m->WriteLongUsingDangerousNonPortableLessPersistableForm(p);
   }
@@ -241,6 +303,9 @@ struct ParamTraits<long> {
 template <>
 struct ParamTraits<unsigned long> {
   typedef unsigned long param_type;
+  static size_t GetSize(const param_type& p) {
+    return sizeof(long);
+  }
   static void Write(Message* m, const param_type& p) {
     m->WriteLongUsingDangerousNonPortableLessPersistableForm(p);
   }
@@ -254,6 +319,9 @@ struct ParamTraits<unsigned long> {
 template <>
 struct ParamTraits<long long> {
   typedef long long param_type;
+  static size_t GetSize(const param_type& p) {
+    return sizeof(int64);
+  }
   static void Write(Message* m, const param_type& p) {
     m->WriteInt64(static_cast<int64>(p));
   }
@@ -267,6 +335,9 @@ struct ParamTraits<long long> {
 template <>
 struct ParamTraits<unsigned long long> {
   typedef unsigned long long param_type;
+  static size_t GetSize(const param_type& p) {
+    return sizeof(int64);
+  }
   static void Write(Message* m, const param_type& p) {
     m->WriteInt64(p);
   }
@@ -280,6 +351,9 @@ struct ParamTraits<unsigned long long> {
 template <>
 struct IPC_EXPORT ParamTraits<unsigned short> {
   typedef unsigned short param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetPaddedSize(sizeof(param_type));
+  }
   static void Write(Message* m, const param_type& p);
   static bool Read(const Message* m, PickleIterator* iter, param_type* r);
   static void Log(const param_type& p, std::string* l);
@@ -291,6 +365,9 @@ struct IPC_EXPORT ParamTraits<unsigned short> {
 template <>
 struct ParamTraits<float> {
   typedef float param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetDataSize(sizeof(param_type));
+  }
   static void Write(Message* m, const param_type& p) {
     m->WriteData(reinterpret_cast<const char*>(&p), sizeof(param_type));
   }
@@ -314,6 +391,9 @@ struct ParamTraits<float> {
 template <>
 struct ParamTraits<double> {
   typedef double param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetDataSize(sizeof(param_type));
+  }
   static void Write(Message* m, const param_type& p) {
     m->WriteData(reinterpret_cast<const char*>(&p), sizeof(param_type));
   }
@@ -337,6 +417,9 @@ struct ParamTraits<double> {
 template <>
 struct IPC_EXPORT ParamTraits<base::Time> {
   typedef base::Time param_type;
+  static size_t GetSize(const param_type& p) {
+    return sizeof(int64);
+  }
   static void Write(Message* m, const param_type& p);
   static bool Read(const Message* m, PickleIterator* iter, param_type* r);
   static void Log(const param_type& p, std::string* l);
@@ -345,6 +428,9 @@ struct IPC_EXPORT ParamTraits<base::Time> {
 template <>
 struct IPC_EXPORT ParamTraits<base::TimeDelta> {
   typedef base::TimeDelta param_type;
+  static size_t GetSize(const param_type& p) {
+    return sizeof(int64);
+  }
   static void Write(Message* m, const param_type& p);
   static bool Read(const Message* m, PickleIterator* iter, param_type* r);
   static void Log(const param_type& p, std::string* l);
@@ -353,6 +439,9 @@ struct IPC_EXPORT ParamTraits<base::TimeDelta> {
 template <>
 struct IPC_EXPORT ParamTraits<base::TimeTicks> {
   typedef base::TimeTicks param_type;
+  static size_t GetSize(const param_type& p) {
+    return sizeof(int64);
+  }
   static void Write(Message* m, const param_type& p);
   static bool Read(const Message* m, PickleIterator* iter, param_type* r);
   static void Log(const param_type& p, std::string* l);
@@ -429,6 +518,9 @@ struct IPC_EXPORT ParamTraits<base::ListValue> {
 template <>
 struct ParamTraits<std::string> {
   typedef std::string param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetDataSize(p.size());
+  }
   static void Write(Message* m, const param_type& p) {
     m->WriteString(p);
   }
@@ -467,6 +559,9 @@ static void LogBytes(const std::vector<CharType>& data, std::string* out) {
 template <>
 struct ParamTraits<std::vector<unsigned char> > {
   typedef std::vector<unsigned char> param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetDataSize(p.size());
+  }
   static void Write(Message* m, const param_type& p) {
     if (p.empty()) {
       m->WriteData(NULL, 0);
@@ -494,6 +589,9 @@ struct ParamTraits<std::vector<unsigned char> > {
 template <>
 struct ParamTraits<std::vector<char> > {
   typedef std::vector<char> param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetDataSize(p.size());
+  }
   static void Write(Message* m, const param_type& p) {
     if (p.empty()) {
       m->WriteData(NULL, 0);
@@ -520,6 +618,9 @@ struct ParamTraits<std::vector<char> > {
 template <>
 struct ParamTraits<std::vector<bool> > {
   typedef std::vector<bool> param_type;
+  static size_t GetSize(const param_type& p) {
+    return sizeof(int) + p.size() * sizeof(int);
+  }
   static void Write(Message* m, const param_type& p) {
     WriteParam(m, static_cast<int>(p.size()));
     for (size_t i = 0; i < p.size(); i++)
@@ -552,6 +653,12 @@ struct ParamTraits<std::vector<bool> > {
 template <class P>
 struct ParamTraits<std::vector<P> > {
   typedef std::vector<P> param_type;
+  static size_t GetSize(const param_type& p) {
+    size_t size = sizeof(int);
+    for (size_t i = 0; i < p.size(); i++)
+      size += GetParamSize(p[i]);
+    return size;
+  }
   static void Write(Message* m, const param_type& p) {
     WriteParam(m, static_cast<int>(p.size()));
     for (size_t i = 0; i < p.size(); i++)
@@ -585,6 +692,13 @@ struct ParamTraits<std::vector<P> > {
 template <class P>
 struct ParamTraits<std::set<P> > {
   typedef std::set<P> param_type;
+  static size_t GetSize(const param_type& p) {
+    size_t size = sizeof(int);
+    typename param_type::const_iterator iter;
+    for (iter = p.begin(); iter != p.end(); ++iter)
+      size += GetParamSize(*iter);
+    return size;
+  }
   static void Write(Message* m, const param_type& p) {
     WriteParam(m, static_cast<int>(p.size()));
     typename param_type::const_iterator iter;
@@ -613,6 +727,13 @@ struct ParamTraits<std::set<P> > {
 template <class K, class V>
 struct ParamTraits<std::map<K, V> > {
   typedef std::map<K, V> param_type;
+  static size_t GetSize(const param_type& p) {
+    size_t size = sizeof(int);
+    typename param_type::const_iterator iter;
+    for (iter = p.begin(); iter != p.end(); ++iter)
+      size += GetParamSize(iter->first) + GetParamSize(iter->second);
+    return size;
+  }
   static void Write(Message* m, const param_type& p) {
     WriteParam(m, static_cast<int>(p.size()));
     typename param_type::const_iterator iter;
@@ -645,6 +766,9 @@ struct ParamTraits<std::map<K, V> > {
 template <>
 struct ParamTraits<std::wstring> {
   typedef std::wstring param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetDataSize(p.size() * sizeof(wchar_t));
+  }
   static void Write(Message* m, const param_type& p) {
     m->WriteWString(p);
   }
@@ -658,6 +782,9 @@ struct ParamTraits<std::wstring> {
 template <class A, class B>
 struct ParamTraits<std::pair<A, B> > {
   typedef std::pair<A, B> param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetParamSize(p.first) + GetParamSize(p.second);
+  }
   static void Write(Message* m, const param_type& p) {
     WriteParam(m, p.first);
     WriteParam(m, p.second);
@@ -678,6 +805,7 @@ struct ParamTraits<std::pair<A, B> > {
 template <>
 struct IPC_EXPORT ParamTraits<NullableString16> {
   typedef NullableString16 param_type;
+  static size_t GetSize(const param_type& p);
   static void Write(Message* m, const param_type& p);
   static bool Read(const Message* m, PickleIterator* iter,
                    param_type* r);
@@ -690,6 +818,9 @@ struct IPC_EXPORT ParamTraits<NullableString16> {
 template <>
 struct ParamTraits<string16> {
   typedef string16 param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetDataSize(p.size() * sizeof(char16));
+  }
   static void Write(Message* m, const param_type& p) {
     m->WriteString16(p);
   }
@@ -775,6 +906,7 @@ struct ParamTraits<POINT> {
 template <>
 struct IPC_EXPORT ParamTraits<FilePath> {
   typedef FilePath param_type;
+  static size_t GetSize(const param_type& p);
   static void Write(Message* m, const param_type& p);
   static bool Read(const Message* m, PickleIterator* iter, param_type* r);
   static void Log(const param_type& p, std::string* l);
@@ -799,6 +931,7 @@ struct IPC_EXPORT ParamTraits<FilePath> {
 template<>
 struct IPC_EXPORT ParamTraits<base::FileDescriptor> {
   typedef base::FileDescriptor param_type;
+  static size_t GetSize(const param_type& p);
   static void Write(Message* m, const param_type& p);
   static bool Read(const Message* m, PickleIterator* iter, param_type* r);
   static void Log(const param_type& p, std::string* l);
@@ -895,6 +1028,9 @@ struct ParamTraits<Message> {
 template <>
 struct ParamTraits<Tuple0> {
   typedef Tuple0 param_type;
+  static size_t GetSize(const param_type& p) {
+    return 0;
+  }
   static void Write(Message* m, const param_type& p) {
   }
   static bool Read(const Message* m, PickleIterator* iter, param_type* r) {
@@ -907,6 +1043,9 @@ struct ParamTraits<Tuple0> {
 template <class A>
 struct ParamTraits< Tuple1<A> > {
   typedef Tuple1<A> param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetParamSize(p.a);
+  }
   static void Write(Message* m, const param_type& p) {
     WriteParam(m, p.a);
   }
@@ -921,6 +1060,10 @@ struct ParamTraits< Tuple1<A> > {
 template <class A, class B>
 struct ParamTraits< Tuple2<A, B> > {
   typedef Tuple2<A, B> param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetParamSize(p.a) +
+           GetParamSize(p.b);
+  }
   static void Write(Message* m, const param_type& p) {
     WriteParam(m, p.a);
     WriteParam(m, p.b);
@@ -939,6 +1082,11 @@ struct ParamTraits< Tuple2<A, B> > {
 template <class A, class B, class C>
 struct ParamTraits< Tuple3<A, B, C> > {
   typedef Tuple3<A, B, C> param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetParamSize(p.a) +
+           GetParamSize(p.b) +
+           GetParamSize(p.c);
+  }
   static void Write(Message* m, const param_type& p) {
     WriteParam(m, p.a);
     WriteParam(m, p.b);
@@ -961,6 +1109,12 @@ struct ParamTraits< Tuple3<A, B, C> > {
 template <class A, class B, class C, class D>
 struct ParamTraits< Tuple4<A, B, C, D> > {
   typedef Tuple4<A, B, C, D> param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetParamSize(p.a) +
+           GetParamSize(p.b) +
+           GetParamSize(p.c) +
+           GetParamSize(p.d);
+  }
   static void Write(Message* m, const param_type& p) {
     WriteParam(m, p.a);
     WriteParam(m, p.b);
@@ -987,6 +1141,13 @@ struct ParamTraits< Tuple4<A, B, C, D> > {
 template <class A, class B, class C, class D, class E>
 struct ParamTraits< Tuple5<A, B, C, D, E> > {
   typedef Tuple5<A, B, C, D, E> param_type;
+  static size_t GetSize(const param_type& p) {
+    return GetParamSize(p.a) +
+           GetParamSize(p.b) +
+           GetParamSize(p.c) +
+           GetParamSize(p.d) +
+           GetParamSize(p.e);
+  }
   static void Write(Message* m, const param_type& p) {
     WriteParam(m, p.a);
     WriteParam(m, p.b);
@@ -1024,6 +1185,9 @@ class MessageSchema {
   typedef ParamType Param;
   typedef typename TupleTypes<ParamType>::ParamTuple RefParam;
 
+  static size_t GetSize(const RefParam& p) {
+    return GetParamSize(p);
+  }
   static void Write(Message* msg, const RefParam& p) IPC_MSG_NOINLINE;
   static bool Read(const Message* msg, Param* p) IPC_MSG_NOINLINE;
 };
@@ -0,0 +1,209 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares the latency and throughput of socket-backed channels with
+// channels that carry their messages through shared memory.  The results are
+// logged rather than checked; run ipc_tests with
+// --gtest_filter=IPCSharedMemoryPerfTest.* to see them.
+
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/cancelable_callback.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/test/test_timeouts.h"
+#include "base/threading/thread.h"
+#include "base/time.h"
+#include "ipc/ipc_channel.h"
+#include "ipc/ipc_channel_handle.h"
+#include "ipc/ipc_message.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kMessageCount = 2000;
+
+// Sends every message it receives straight back.
+class ReflectorListener : public IPC::Channel::Listener {
+ public:
+  ReflectorListener() : channel_(NULL) {}
+  virtual ~ReflectorListener() {}
+
+  void set_channel(IPC::Channel* channel) { channel_ = channel; }
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    channel_->Send(new IPC::Message(message));
+    return true;
+  }
+
+ private:
+  IPC::Channel* channel_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReflectorListener);
+};
+
+// Runs the reflecting end of a channel on its own IO thread, so that both
+// ends have to wake each other up just as they would across processes.
+class Reflector {
+ public:
+  Reflector(const IPC::ChannelHandle& handle, IPC::Channel::Mode mode)
+      : handle_(handle),
+        mode_(mode),
+        thread_("IPCReflector") {
+    base::Thread::Options options(MessageLoop::TYPE_IO, 0);
+    CHECK(thread_.StartWithOptions(options));
+    thread_.message_loop()->PostTask(
+        FROM_HERE, base::Bind(&Reflector::Connect, base::Unretained(this)));
+  }
+
+  ~Reflector() {
+    thread_.message_loop()->PostTask(
+        FROM_HERE, base::Bind(&Reflector::Close, base::Unretained(this)));
+    thread_.Stop();
+  }
+
+ private:
+  void Connect() {
+    channel_.reset(new IPC::Channel(handle_, mode_, &listener_));
+    listener_.set_channel(channel_.get());
+    CHECK(channel_->Connect());
+  }
+
+  void Close() {
+    channel_.reset();
+  }
+
+  IPC::ChannelHandle handle_;
+  IPC::Channel::Mode mode_;
+  ReflectorListener listener_;
+  scoped_ptr<IPC::Channel> channel_;
+  base::Thread thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(Reflector);
+};
+
+// Sends |message_count| messages of |payload_size| bytes and quits the
+// current message loop once all of them have come back.  In burst mode all
+// messages are sent up front; otherwise each reply triggers the next send.
+class PerfListener : public IPC::Channel::Listener {
+ public:
+  PerfListener(int message_count, size_t payload_size, bool burst)
+      : message_count_(message_count),
+        payload_(payload_size, 'p'),
+        burst_(burst),
+        channel_(NULL),
+        received_count_(0) {
+  }
+  virtual ~PerfListener() {}
+
+  void Start(IPC::Channel* channel) {
+    channel_ = channel;
+    int initial_count = burst_ ? message_count_ : 1;
+    for (int i = 0; i < initial_count; ++i)
+      SendMessage();
+  }
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    if (++received_count_ == message_count_)
+      MessageLoop::current()->QuitNow();
+    else if (!burst_)
+      SendMessage();
+    return true;
+  }
+
+  int received_count() const { return received_count_; }
+
+ private:
+  void SendMessage() {
+    IPC::Message* message = new IPC::Message(0, 2,
+                                             IPC::Message::PRIORITY_NORMAL);
+    message->WriteData(payload_.data(), payload_.size());
+    channel_->Send(message);
+  }
+
+  int message_count_;
+  std::string payload_;
+  bool burst_;
+  IPC::Channel* channel_;
+  int received_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(PerfListener);
+};
+
+class IPCSharedMemoryPerfTest : public testing::Test {
+ protected:
+  // Bounces kMessageCount messages of |payload_size| bytes off a reflector
+  // and logs how long the round trips took.
+  void RunTest(bool shared_memory, size_t payload_size, bool burst) {
+    int pipe_fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, pipe_fds));
+    ASSERT_GE(fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK), 0);
+    ASSERT_GE(fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK), 0);
+
+    IPC::ChannelHandle server_handle(
+        "IPCSharedMemoryPerfTestServer",
+        base::FileDescriptor(pipe_fds[0], true));
+    IPC::ChannelHandle client_handle(
+        "IPCSharedMemoryPerfTestClient",
+        base::FileDescriptor(pipe_fds[1], true));
+    PerfListener listener(kMessageCount, payload_size, burst);
+    IPC::Channel server(server_handle,
+                        shared_memory ? IPC::Channel::MODE_SHARED_MEMORY_SERVER
+                                      : IPC::Channel::MODE_SERVER,
+                        &listener);
+    ASSERT_TRUE(server.Connect());
+    Reflector reflector(client_handle,
+                        shared_memory ? IPC::Channel::MODE_SHARED_MEMORY_CLIENT
+                                      : IPC::Channel::MODE_CLIENT);
+
+    // Guard against a wedged channel so the test fails instead of hanging.
+    base::CancelableClosure timeout(MessageLoop::QuitClosure());
+    message_loop_.PostDelayedTask(
+        FROM_HERE, timeout.callback(),
+        base::TimeDelta::FromMilliseconds(
+            TestTimeouts::action_max_timeout_ms()));
+
+    base::TimeTicks start = base::TimeTicks::Now();
+    listener.Start(&server);
+    message_loop_.Run();
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+    timeout.Cancel();
+
+    EXPECT_EQ(kMessageCount, listener.received_count());
+    LOG(INFO) << (shared_memory ? "shared memory" : "socket")
+              << (burst ? " burst" : " ping-pong")
+              << ", " << payload_size << " byte payload: "
+              << kMessageCount << " round trips in "
+              << elapsed.InMillisecondsF() << " ms, "
+              << elapsed.InMicroseconds() / kMessageCount
+              << " us per round trip";
+  }
+
+ private:
+  MessageLoopForIO message_loop_;
+};
+
+const size_t kPayloadSizes[] = { 12, 1024, 64 * 1024 };
+
+}  // namespace
+
+TEST_F(IPCSharedMemoryPerfTest, PingPongLatency) {
+  for (size_t i = 0; i < arraysize(kPayloadSizes); ++i) {
+    RunTest(false, kPayloadSizes[i], false);
+    RunTest(true, kPayloadSizes[i], false);
+  }
+}
+
+TEST_F(IPCSharedMemoryPerfTest, BurstThroughput) {
+  for (size_t i = 0; i < arraysize(kPayloadSizes); ++i) {
+    RunTest(false, kPayloadSizes[i], true);
+    RunTest(true, kPayloadSizes[i], true);
+  }
+}
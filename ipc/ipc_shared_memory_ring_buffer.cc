@@ -0,0 +1,156 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ipc/ipc_shared_memory_ring_buffer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace IPC {
+namespace internal {
+
+namespace {
+
+// Keeps the producer's and the consumer's fields on separate cache lines.
+const size_t kCacheLineSize = 64;
+
+}  // namespace
+
+// Lives at the start of the shared memory, followed by the ring itself.
+struct SharedMemoryRingBuffer::Control {
+  // Total bytes ever written, modulo 2^32.  Advanced by the producer.
+  base::subtle::Atomic32 write_position;
+  // Set by the producer while it waits for space.
+  base::subtle::Atomic32 writer_waiting;
+  char producer_padding[kCacheLineSize - 2 * sizeof(base::subtle::Atomic32)];
+
+  // Total bytes ever read, modulo 2^32.  Advanced by the consumer.
+  base::subtle::Atomic32 read_position;
+  // Set by the consumer while it waits for data.
+  base::subtle::Atomic32 reader_waiting;
+  char consumer_padding[kCacheLineSize - 2 * sizeof(base::subtle::Atomic32)];
+};
+
+SharedMemoryRingBuffer::SharedMemoryRingBuffer(void* memory, size_t capacity)
+    : control_(static_cast<Control*>(memory)),
+      data_(static_cast<char*>(memory) + sizeof(Control)),
+      capacity_(capacity),
+      write_position_(0),
+      read_position_(0),
+      corrupted_(false) {
+  DCHECK(memory);
+  DCHECK(capacity_ && (capacity_ & (capacity_ - 1)) == 0);
+  DCHECK_LE(capacity_, 1u << 31);
+}
+
+SharedMemoryRingBuffer::~SharedMemoryRingBuffer() {
+}
+
+// static
+size_t SharedMemoryRingBuffer::SizeForCapacity(size_t capacity) {
+  return sizeof(Control) + capacity;
+}
+
+void SharedMemoryRingBuffer::Initialize() {
+  memset(control_, 0, sizeof(Control));
+  // The consumer starts out asleep, so the first write wakes it.
+  control_->reader_waiting = 1;
+  write_position_ = 0;
+  read_position_ = 0;
+  corrupted_ = false;
+}
+
+size_t SharedMemoryRingBuffer::Write(const char* data, size_t len) {
+  uint32 read = base::subtle::Acquire_Load(&control_->read_position);
+  size_t used = UsedBytes(read, write_position_);
+  if (corrupted_)
+    return 0;
+
+  size_t count = std::min(len, capacity_ - used);
+  size_t offset = write_position_ & (capacity_ - 1);
+  size_t first = std::min(count, capacity_ - offset);
+  memcpy(data_ + offset, data, first);
+  memcpy(data_, data + first, count - first);
+
+  // The release store publishes the bytes before the new position.
+  write_position_ += static_cast<uint32>(count);
+  base::subtle::Release_Store(&control_->write_position, write_position_);
+  return count;
+}
+
+bool SharedMemoryRingBuffer::WaitForSpace() {
+  base::subtle::NoBarrier_Store(&control_->writer_waiting, 1);
+  // The flag must be visible before we look at the read position again, or
+  // a consumer that frees space right now could miss it.
+  base::subtle::MemoryBarrier();
+  uint32 read = base::subtle::Acquire_Load(&control_->read_position);
+  if (UsedBytes(read, write_position_) < capacity_ && !corrupted_) {
+    base::subtle::NoBarrier_Store(&control_->writer_waiting, 0);
+    return false;
+  }
+  return true;
+}
+
+bool SharedMemoryRingBuffer::TakeReaderWaiting() {
+  // Pairs with the barrier in WaitForData(); orders our position store
+  // before the flag load.
+  base::subtle::MemoryBarrier();
+  if (!base::subtle::NoBarrier_Load(&control_->reader_waiting))
+    return false;
+  return base::subtle::NoBarrier_AtomicExchange(
+      &control_->reader_waiting, 0) != 0;
+}
+
+size_t SharedMemoryRingBuffer::Read(char* buffer, size_t len) {
+  uint32 write = base::subtle::Acquire_Load(&control_->write_position);
+  size_t used = UsedBytes(read_position_, write);
+  if (corrupted_)
+    return 0;
+
+  size_t count = std::min(len, used);
+  size_t offset = read_position_ & (capacity_ - 1);
+  size_t first = std::min(count, capacity_ - offset);
+  memcpy(buffer, data_ + offset, first);
+  memcpy(buffer + first, data_, count - first);
+
+  // The release store keeps the copies above from being reordered after the
+  // producer may reuse the space.
+  read_position_ += static_cast<uint32>(count);
+  base::subtle::Release_Store(&control_->read_position, read_position_);
+  return count;
+}
+
+bool SharedMemoryRingBuffer::WaitForData() {
+  base::subtle::NoBarrier_Store(&control_->reader_waiting, 1);
+  base::subtle::MemoryBarrier();
+  uint32 write = base::subtle::Acquire_Load(&control_->write_position);
+  if (UsedBytes(read_position_, write) > 0 || corrupted_) {
+    base::subtle::NoBarrier_Store(&control_->reader_waiting, 0);
+    return false;
+  }
+  return true;
+}
+
+bool SharedMemoryRingBuffer::TakeWriterWaiting() {
+  base::subtle::MemoryBarrier();
+  if (!base::subtle::NoBarrier_Load(&control_->writer_waiting))
+    return false;
+  return base::subtle::NoBarrier_AtomicExchange(
+      &control_->writer_waiting, 0) != 0;
+}
+
+size_t SharedMemoryRingBuffer::UsedBytes(uint32 read, uint32 write) {
+  uint32 used = write - read;
+  if (used > capacity_) {
+    corrupted_ = true;
+    return 0;
+  }
+  return used;
+}
+
+}  // namespace internal
+}  // namespace IPC
@@ -0,0 +1,101 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IPC_IPC_SHARED_MEMORY_RING_BUFFER_H_
+#define IPC_IPC_SHARED_MEMORY_RING_BUFFER_H_
+#pragma once
+
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "ipc/ipc_export.h"
+
+namespace IPC {
+namespace internal {
+
+// A single-producer, single-consumer byte stream carried through a ring in
+// memory that may be shared between two processes.  One side only calls the
+// producer methods and the other only the consumer methods.
+//
+// Neither side ever blocks in here.  A side that finds the ring empty (or
+// full) announces that it is about to sleep with WaitForData() (or
+// WaitForSpace()); the other side then learns from TakeReaderWaiting() (or
+// TakeWriterWaiting()) that it has to wake it, which the channel does by
+// sending a byte over its socket.  Wakeups are therefore only paid for when
+// the peer actually went to sleep.
+//
+// Each side keeps its own copy of the position it advances and never trusts
+// the peer's copy further than checking it for consistency, so a peer that
+// scribbles over the shared state can only make the stream look corrupted().
+class IPC_EXPORT SharedMemoryRingBuffer {
+ public:
+  // |memory| must point at SizeForCapacity(|capacity|) bytes that stay mapped
+  // for the lifetime of this object.  |capacity| must be a power of two no
+  // larger than 2^31.
+  SharedMemoryRingBuffer(void* memory, size_t capacity);
+  ~SharedMemoryRingBuffer();
+
+  // Returns the number of bytes of shared memory a ring of |capacity| needs.
+  static size_t SizeForCapacity(size_t capacity);
+
+  // Resets the shared state to an empty ring whose consumer is waiting for
+  // data.  Called once by whichever side creates the memory, before the peer
+  // can see it.
+  void Initialize();
+
+  // Producer: copies up to |len| bytes of |data| into the ring and returns how
+  // many fit.
+  size_t Write(const char* data, size_t len);
+
+  // Producer: announces that the ring is full and the producer is going to
+  // wait for space.  Returns false if space showed up in the meantime, in
+  // which case the producer must retry rather than wait.
+  bool WaitForSpace();
+
+  // Producer: returns true if the consumer was waiting for data and must be
+  // woken up.  Clears the consumer's waiting flag.
+  bool TakeReaderWaiting();
+
+  // Consumer: copies up to |len| bytes out of the ring into |buffer| and
+  // returns how many were available.
+  size_t Read(char* buffer, size_t len);
+
+  // Consumer: announces that the ring is empty and the consumer is going to
+  // wait for data.  Returns false if data showed up in the meantime.
+  bool WaitForData();
+
+  // Consumer: returns true if the producer was waiting for space and must be
+  // woken up.  Clears the producer's waiting flag.
+  bool TakeWriterWaiting();
+
+  // True once the peer's position has been seen to be inconsistent with ours.
+  // The stream cannot be trusted after that.
+  bool corrupted() const { return corrupted_; }
+
+  size_t capacity() const { return capacity_; }
+
+ private:
+  struct Control;
+
+  // Returns the number of bytes between |read| and |write|, or marks the ring
+  // corrupted and returns 0 if that is more than the ring can hold.
+  size_t UsedBytes(uint32 read, uint32 write);
+
+  Control* control_;
+  char* data_;
+  const size_t capacity_;
+
+  // This side's copy of the position it advances: the write position for the
+  // producer, the read position for the consumer.
+  uint32 write_position_;
+  uint32 read_position_;
+
+  bool corrupted_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryRingBuffer);
+};
+
+}  // namespace internal
+}  // namespace IPC
+
+#endif  // IPC_IPC_SHARED_MEMORY_RING_BUFFER_H_
@@ -0,0 +1,185 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ipc/ipc_shared_memory_ring_buffer.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace IPC {
+namespace internal {
+
+namespace {
+
+const size_t kCapacity = 16;
+
+class RingBufferTest : public testing::Test {
+ protected:
+  RingBufferTest()
+      : memory_(SharedMemoryRingBuffer::SizeForCapacity(kCapacity)),
+        producer_(&memory_[0], kCapacity),
+        consumer_(&memory_[0], kCapacity) {
+    producer_.Initialize();
+  }
+
+  std::string ReadAll() {
+    char buffer[kCapacity * 2];
+    size_t bytes = consumer_.Read(buffer, sizeof(buffer));
+    return std::string(buffer, bytes);
+  }
+
+  std::vector<char> memory_;
+  SharedMemoryRingBuffer producer_;
+  SharedMemoryRingBuffer consumer_;
+};
+
+// Writes |count| bytes, counting up from 0 modulo 256, in bursts.
+class Producer : public base::DelegateSimpleThread::Delegate {
+ public:
+  Producer(SharedMemoryRingBuffer* ring, size_t count)
+      : ring_(ring),
+        count_(count) {
+  }
+
+  virtual void Run() OVERRIDE {
+    size_t sent = 0;
+    char burst[7];
+    while (sent < count_) {
+      size_t len = std::min(sizeof(burst), count_ - sent);
+      for (size_t i = 0; i < len; ++i)
+        burst[i] = static_cast<char>(sent + i);
+      size_t written = 0;
+      while (written < len) {
+        written += ring_->Write(burst + written, len - written);
+        if (written < len)
+          base::PlatformThread::YieldCurrentThread();
+      }
+      sent += len;
+    }
+  }
+
+ private:
+  SharedMemoryRingBuffer* ring_;
+  size_t count_;
+};
+
+}  // namespace
+
+TEST_F(RingBufferTest, WriteAndRead) {
+  EXPECT_EQ("", ReadAll());
+  EXPECT_EQ(5u, producer_.Write("hello", 5));
+  EXPECT_EQ(6u, producer_.Write(" world", 6));
+  EXPECT_EQ("hello world", ReadAll());
+  EXPECT_EQ("", ReadAll());
+  EXPECT_FALSE(producer_.corrupted());
+  EXPECT_FALSE(consumer_.corrupted());
+}
+
+TEST_F(RingBufferTest, PartialWriteWhenFull) {
+  std::string data(kCapacity + 4, 'a');
+  EXPECT_EQ(kCapacity, producer_.Write(data.data(), data.size()));
+  EXPECT_EQ(0u, producer_.Write("b", 1));
+
+  char buffer[4];
+  EXPECT_EQ(4u, consumer_.Read(buffer, sizeof(buffer)));
+  EXPECT_EQ(4u, producer_.Write("bbbbbb", 6));
+  EXPECT_EQ(std::string(kCapacity - 4, 'a') + "bbbb", ReadAll());
+}
+
+TEST_F(RingBufferTest, WrapsAround) {
+  for (int round = 0; round < 10; ++round) {
+    std::string data(11, static_cast<char>('a' + round));
+    EXPECT_EQ(data.size(), producer_.Write(data.data(), data.size()));
+    EXPECT_EQ(data, ReadAll());
+  }
+}
+
+TEST_F(RingBufferTest, ConsumerStartsWaiting) {
+  // The first write after Initialize() must wake the consumer.
+  EXPECT_EQ(1u, producer_.Write("x", 1));
+  EXPECT_TRUE(producer_.TakeReaderWaiting());
+  EXPECT_FALSE(producer_.TakeReaderWaiting());
+}
+
+TEST_F(RingBufferTest, WaitForData) {
+  // Clear the flag the consumer starts out with.
+  EXPECT_TRUE(producer_.TakeReaderWaiting());
+  EXPECT_EQ("", ReadAll());
+  EXPECT_FALSE(producer_.TakeReaderWaiting());
+
+  // An empty ring lets the consumer sleep, and the next write wakes it.
+  EXPECT_TRUE(consumer_.WaitForData());
+  EXPECT_EQ(1u, producer_.Write("x", 1));
+  EXPECT_TRUE(producer_.TakeReaderWaiting());
+
+  // With data available the consumer must not sleep.
+  EXPECT_FALSE(consumer_.WaitForData());
+  EXPECT_FALSE(producer_.TakeReaderWaiting());
+  EXPECT_EQ("x", ReadAll());
+}
+
+TEST_F(RingBufferTest, WaitForSpace) {
+  std::string data(kCapacity, 'a');
+  EXPECT_EQ(kCapacity, producer_.Write(data.data(), data.size()));
+  EXPECT_FALSE(consumer_.TakeWriterWaiting());
+
+  EXPECT_TRUE(producer_.WaitForSpace());
+  char buffer[1];
+  EXPECT_EQ(1u, consumer_.Read(buffer, sizeof(buffer)));
+  EXPECT_TRUE(consumer_.TakeWriterWaiting());
+
+  // There is room now, so the producer must not sleep.
+  EXPECT_FALSE(producer_.WaitForSpace());
+  EXPECT_FALSE(consumer_.TakeWriterWaiting());
+}
+
+TEST_F(RingBufferTest, DetectsCorruptPositions) {
+  std::string data(kCapacity, 'a');
+  EXPECT_EQ(kCapacity, producer_.Write(data.data(), data.size()));
+  EXPECT_EQ(data, ReadAll());
+  EXPECT_EQ(kCapacity, producer_.Write(data.data(), data.size()));
+
+  // To a consumer that missed the first bytes, the producer appears to be
+  // further ahead than the ring can hold.
+  SharedMemoryRingBuffer stale_consumer(&memory_[0], kCapacity);
+  char buffer[kCapacity];
+  EXPECT_EQ(0u, stale_consumer.Read(buffer, sizeof(buffer)));
+  EXPECT_TRUE(stale_consumer.corrupted());
+  EXPECT_FALSE(stale_consumer.WaitForData());
+}
+
+TEST(SharedMemoryRingBufferThreadTest, ProducerAndConsumerThreads) {
+  const size_t kCount = 100000;
+  std::vector<char> memory(SharedMemoryRingBuffer::SizeForCapacity(64));
+  SharedMemoryRingBuffer producer_ring(&memory[0], 64);
+  SharedMemoryRingBuffer consumer_ring(&memory[0], 64);
+  producer_ring.Initialize();
+
+  Producer producer(&producer_ring, kCount);
+  base::DelegateSimpleThread thread(&producer, "RingBufferProducer");
+  thread.Start();
+
+  size_t received = 0;
+  char buffer[13];
+  while (received < kCount) {
+    size_t bytes = consumer_ring.Read(buffer, sizeof(buffer));
+    for (size_t i = 0; i < bytes; ++i)
+      ASSERT_EQ(static_cast<char>(received + i), buffer[i]);
+    received += bytes;
+    if (!bytes)
+      base::PlatformThread::YieldCurrentThread();
+  }
+  thread.Join();
+  EXPECT_FALSE(consumer_ring.corrupted());
+  EXPECT_FALSE(producer_ring.corrupted());
+}
+
+}  // namespace internal
+}  // namespace IPC
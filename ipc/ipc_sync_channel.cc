@@ -75,8 +75,24 @@ class SyncChannel::ReceivedSyncMsgQueue :
     }
   }
 
+  // Called on the IPC thread when a reply arrives that doesn't unblock the
+  // innermost Send() of |context|.
   void QueueReply(const Message &msg, SyncChannel::SyncContext* context) {
-    received_replies_.push_back(QueuedMessage(new Message(msg), context));
+    {
+      base::AutoLock auto_lock(message_lock_);
+      received_replies_.push_back(QueuedMessage(new Message(msg), context));
+    }
+
+    // The innermost Send() may have returned since the reply failed to unblock
+    // it, and checked for queued replies before this one was queued.
+    DispatchReplies();
+  }
+
+  // Called on the listener thread when a Send() returns, to find out whether
+  // an outer Send() may be waiting for a reply that is already queued.
+  bool HasQueuedReplies() {
+    base::AutoLock auto_lock(message_lock_);
+    return !received_replies_.empty();
   }
 
   // Called on the listener's thread to process any queues synchronous
@@ -154,12 +170,16 @@ class SyncChannel::ReceivedSyncMsgQueue :
       lazy_tls_ptr_;
 
   // Called on the ipc thread to check if we can unblock any current Send()
-  // calls based on a queued reply.
+  // calls based on a queued reply.  Only the ipc thread changes
+  // |received_replies_|, so it reads it without taking the lock.
   void DispatchReplies() {
     for (size_t i = 0; i < received_replies_.size(); ++i) {
       Message* message = received_replies_[i].message;
       if (received_replies_[i].context->TryToUnblockListener(message)) {
         delete message;
+        // Don't let the context go away while the lock is held.
+        scoped_refptr<SyncContext> context(received_replies_[i].context);
+        base::AutoLock auto_lock(message_lock_);
         received_replies_.erase(received_replies_.begin() + i);
         return;
       }
@@ -272,10 +292,13 @@ bool SyncChannel::SyncContext::Pop() {
   // thread.  However, further down the call stack there could be another
   // blocking Send() call, whose reply we received after we made this last
   // Send() call.  So check if we have any queued replies available that
-  // can now unblock the listener thread.
-  ipc_message_loop()->PostTask(
-      FROM_HERE, base::Bind(&ReceivedSyncMsgQueue::DispatchReplies,
-                            received_sync_msgs_.get()));
+  // can now unblock the listener thread.  There are none unless Send() calls
+  // were nested, so most calls return without waking up the ipc thread.
+  if (received_sync_msgs_->HasQueuedReplies()) {
+    ipc_message_loop()->PostTask(
+        FROM_HERE, base::Bind(&ReceivedSyncMsgQueue::DispatchReplies,
+                              received_sync_msgs_.get()));
+  }
 
   return result;
 }
@@ -18,9 +18,12 @@
 #include "ipc/ipc_tests.h"
 
 #include "base/base_switches.h"
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/debug/debug_on_start_win.h"
 #include "base/perftimer.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/test/perf_benchmark.h"
 #include "base/test/perf_test_suite.h"
 #include "base/test/test_suite.h"
 #include "base/threading/thread.h"
@@ -29,6 +32,8 @@
 #include "ipc/ipc_channel_proxy.h"
 #include "ipc/ipc_message_utils.h"
 #include "ipc/ipc_switches.h"
+#include "ipc/ipc_sync_channel.h"
+#include "ipc/ipc_sync_message_unittest.h"
 #include "testing/multiprocess_func_list.h"
 
 // Define to enable IPC performance testing instead of the regular unit tests
@@ -576,6 +581,95 @@ MULTIPROCESS_TEST_MAIN(RunReflector) {
   return true;
 }
 
+// Answers SyncChannelTestMsg_Double on the thread of its channel, the way the
+// browser answers the sync messages of renderers on its IO thread.
+class SyncReflectorListener : public IPC::Channel::Listener {
+ public:
+  SyncReflectorListener() : channel_(NULL) {}
+
+  void set_channel(IPC::Channel* channel) { channel_ = channel; }
+
+  // Used by the message map to reply to malformed messages.
+  bool Send(IPC::Message* message) { return channel_->Send(message); }
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    IPC_BEGIN_MESSAGE_MAP(SyncReflectorListener, message)
+      IPC_MESSAGE_HANDLER_DELAY_REPLY(SyncChannelTestMsg_Double, OnDouble)
+    IPC_END_MESSAGE_MAP()
+    return true;
+  }
+
+ private:
+  void OnDouble(int in, IPC::Message* reply_msg) {
+    SyncChannelTestMsg_Double::WriteReplyParams(reply_msg, in * 2);
+    Send(reply_msg);
+  }
+
+  IPC::Channel* channel_;
+};
+
+class NullListener : public IPC::Channel::Listener {
+ public:
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    return false;
+  }
+};
+
+void CreateSyncReflector(SyncReflectorListener* listener,
+                         scoped_ptr<IPC::Channel>* channel,
+                         base::WaitableEvent* created_event) {
+  channel->reset(new IPC::Channel(kReflectorChannel,
+                                  IPC::Channel::MODE_SERVER, listener));
+  listener->set_channel(channel->get());
+  CHECK((*channel)->Connect());
+  created_event->Signal();
+}
+
+void DestroySyncReflector(scoped_ptr<IPC::Channel>* channel) {
+  channel->reset();
+}
+
+void SendSyncMessage(IPC::SyncChannel* channel) {
+  int result = 0;
+  CHECK(channel->Send(new SyncChannelTestMsg_Double(21, &result)));
+  CHECK_EQ(42, result);
+}
+
+// Times the round trip of a sync message from a listener thread, through the
+// ipc thread of its SyncChannel, to a channel answering on a third thread.
+TEST(IPCSyncChannelPerfTest, RoundTrip) {
+  MessageLoop message_loop;
+  base::Thread::Options options(MessageLoop::TYPE_IO, 0);
+  base::Thread reflector_thread("SyncReflector");
+  ASSERT_TRUE(reflector_thread.StartWithOptions(options));
+  base::Thread ipc_thread("SyncChannelIPC");
+  ASSERT_TRUE(ipc_thread.StartWithOptions(options));
+
+  SyncReflectorListener reflector_listener;
+  scoped_ptr<IPC::Channel> reflector_channel;
+  base::WaitableEvent created_event(false, false);
+  reflector_thread.message_loop()->PostTask(
+      FROM_HERE, base::Bind(&CreateSyncReflector, &reflector_listener,
+                            &reflector_channel, &created_event));
+  created_event.Wait();
+
+  base::WaitableEvent shutdown_event(true, false);
+  NullListener listener;
+  scoped_ptr<IPC::SyncChannel> channel(new IPC::SyncChannel(
+      kReflectorChannel, IPC::Channel::MODE_CLIENT, &listener,
+      ipc_thread.message_loop_proxy(), true, &shutdown_event));
+
+  base::PerfBenchmark benchmark("IPC_SyncRoundTrip");
+  benchmark.set_iterations_per_run(100);
+  benchmark.Run(base::Bind(&SendSyncMessage, channel.get()));
+
+  channel.reset();
+  ipc_thread.Stop();
+  reflector_thread.message_loop()->PostTask(
+      FROM_HERE, base::Bind(&DestroySyncReflector, &reflector_channel));
+  reflector_thread.Stop();
+}
+
 #endif  // PERFORMANCE_TEST
 
 int main(int argc, char** argv) {
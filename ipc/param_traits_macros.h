@@ -13,6 +13,7 @@
     template <> \
     struct IPC_MESSAGE_EXPORT ParamTraits<struct_name> { \
       typedef struct_name param_type; \
+      static size_t GetSize(const param_type& p); \
       static void Write(Message* m, const param_type& p); \
       static bool Read(const Message* m, PickleIterator* iter, param_type* p); \
       static void Log(const param_type& p, std::string* l); \
@@ -29,6 +30,7 @@
     template <> \
     struct IPC_MESSAGE_EXPORT ParamTraits<enum_name> { \
       typedef enum_name param_type; \
+      static size_t GetSize(const param_type& p); \
       static void Write(Message* m, const param_type& p); \
       static bool Read(const Message* m, PickleIterator* iter, param_type* p); \
       static void Log(const param_type& p, std::string* l); \
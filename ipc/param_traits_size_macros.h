@@ -0,0 +1,44 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IPC_PARAM_TRAITS_SIZE_MACROS_H_
+#define IPC_PARAM_TRAITS_SIZE_MACROS_H_
+#pragma once
+
+// Null out all the macros that need nulling.
+#include "ipc/ipc_message_null_macros.h"
+
+// STRUCT declarations cause corresponding STRUCT_TRAITS declarations to occur.
+#undef IPC_STRUCT_BEGIN
+#undef IPC_STRUCT_BEGIN_WITH_PARENT
+#undef IPC_STRUCT_MEMBER
+#undef IPC_STRUCT_END
+#define IPC_STRUCT_BEGIN_WITH_PARENT(struct_name, parent) \
+  IPC_STRUCT_BEGIN(struct_name)
+#define IPC_STRUCT_BEGIN(struct_name) IPC_STRUCT_TRAITS_BEGIN(struct_name)
+#define IPC_STRUCT_MEMBER(type, name, ...) IPC_STRUCT_TRAITS_MEMBER(name)
+#define IPC_STRUCT_END() IPC_STRUCT_TRAITS_END()
+
+// Set up so next include will generate size methods.
+#undef IPC_STRUCT_TRAITS_BEGIN
+#undef IPC_STRUCT_TRAITS_MEMBER
+#undef IPC_STRUCT_TRAITS_PARENT
+#undef IPC_STRUCT_TRAITS_END
+#define IPC_STRUCT_TRAITS_BEGIN(struct_name) \
+  size_t ParamTraits<struct_name>::GetSize(const param_type& p) { \
+    size_t size = 0;
+#define IPC_STRUCT_TRAITS_MEMBER(name) size += GetParamSize(p.name);
+#define IPC_STRUCT_TRAITS_PARENT(type) \
+    size += GetParamSize(static_cast<const type&>(p));
+#define IPC_STRUCT_TRAITS_END() \
+    return size; \
+  }
+
+#undef IPC_ENUM_TRAITS
+#define IPC_ENUM_TRAITS(enum_name) \
+  size_t ParamTraits<enum_name>::GetSize(const param_type& p) { \
+    return sizeof(int); \
+  }
+
+#endif  // IPC_PARAM_TRAITS_SIZE_MACROS_H_
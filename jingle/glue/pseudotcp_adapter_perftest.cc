@@ -0,0 +1,224 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times a bulk transfer through a pair of PseudoTcpAdapters over a simulated
+// link with high latency and random loss, with PseudoTcp's default windows
+// and with the larger windows remoting configures.
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/compiler_specific.h"
+#include "base/message_loop.h"
+#include "base/perftimer.h"
+#include "jingle/glue/pseudotcp_adapter.h"
+#include "jingle/glue/thread_wrapper.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace jingle_glue {
+
+namespace {
+
+const int kLatencyMs = 50;
+// One packet in a hundred is lost.
+const int kLossPerMille = 10;
+const int kTransferSize = 2 * 1024 * 1024;
+const int kChunkSize = 16 * 1024;
+
+// Matches remoting's TransportConfig defaults.
+const int kLargeReceiveBufferSize = 256 * 1024;
+const int kLargeSendBufferSize = kLargeReceiveBufferSize + 30 * 1024;
+
+// One end of a datagram link which delivers each packet |kLatencyMs| later
+// and drops some of them. Drops are chosen by a fixed-seed generator so that
+// every run sees the same loss pattern.
+class LossyLinkSocket : public net::Socket {
+ public:
+  LossyLinkSocket() : peer_(NULL), seed_(1), read_buffer_size_(0) {}
+  virtual ~LossyLinkSocket() {}
+
+  void Connect(LossyLinkSocket* peer) { peer_ = peer; }
+
+  // net::Socket interface.
+  virtual int Read(net::IOBuffer* buf, int buf_len,
+                   const net::CompletionCallback& callback) OVERRIDE {
+    CHECK(read_callback_.is_null());
+    if (!incoming_packets_.empty()) {
+      int size = CopyPacket(buf, buf_len);
+      incoming_packets_.pop_front();
+      return size;
+    }
+    read_buffer_ = buf;
+    read_buffer_size_ = buf_len;
+    read_callback_ = callback;
+    return net::ERR_IO_PENDING;
+  }
+
+  virtual int Write(net::IOBuffer* buf, int buf_len,
+                    const net::CompletionCallback& callback) OVERRIDE {
+    if (peer_ && !ShouldDrop()) {
+      MessageLoop::current()->PostDelayedTask(
+          FROM_HERE,
+          base::Bind(&LossyLinkSocket::DeliverPacket, base::Unretained(peer_),
+                     std::vector<char>(buf->data(), buf->data() + buf_len)),
+          base::TimeDelta::FromMilliseconds(kLatencyMs));
+    }
+    return buf_len;
+  }
+
+  virtual bool SetReceiveBufferSize(int32 size) OVERRIDE { return false; }
+  virtual bool SetSendBufferSize(int32 size) OVERRIDE { return false; }
+
+ private:
+  bool ShouldDrop() {
+    // A linear congruential generator, so that the loss pattern does not
+    // depend on the platform's rand().
+    seed_ = seed_ * 1103515245 + 12345;
+    return (seed_ >> 16) % 1000 < kLossPerMille;
+  }
+
+  void DeliverPacket(const std::vector<char>& packet) {
+    incoming_packets_.push_back(packet);
+    if (read_callback_.is_null())
+      return;
+    int size = CopyPacket(read_buffer_, read_buffer_size_);
+    incoming_packets_.pop_front();
+    net::CompletionCallback callback = read_callback_;
+    read_callback_.Reset();
+    read_buffer_ = NULL;
+    callback.Run(size);
+  }
+
+  int CopyPacket(net::IOBuffer* buf, int buf_len) {
+    const std::vector<char>& packet = incoming_packets_.front();
+    int size = std::min(static_cast<int>(packet.size()), buf_len);
+    memcpy(buf->data(), &packet[0], size);
+    return size;
+  }
+
+  LossyLinkSocket* peer_;
+  uint32 seed_;
+  std::deque<std::vector<char> > incoming_packets_;
+  scoped_refptr<net::IOBuffer> read_buffer_;
+  int read_buffer_size_;
+  net::CompletionCallback read_callback_;
+};
+
+class PseudoTcpAdapterPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    JingleThreadWrapper::EnsureForCurrentThread();
+
+    LossyLinkSocket* host_socket = new LossyLinkSocket();
+    LossyLinkSocket* client_socket = new LossyLinkSocket();
+    host_socket->Connect(client_socket);
+    client_socket->Connect(host_socket);
+
+    host_.reset(new PseudoTcpAdapter(host_socket));
+    client_.reset(new PseudoTcpAdapter(client_socket));
+    host_->SetNoDelay(true);
+    client_->SetNoDelay(true);
+  }
+
+  void SetWindows(int send_buffer_size, int receive_buffer_size) {
+    host_->SetSendBufferSize(send_buffer_size);
+    host_->SetReceiveBufferSize(receive_buffer_size);
+    client_->SetSendBufferSize(send_buffer_size);
+    client_->SetReceiveBufferSize(receive_buffer_size);
+  }
+
+  // Connects the adapters and moves kTransferSize bytes from the client to
+  // the host.
+  void Transfer() {
+    net::TestCompletionCallback host_connect_cb;
+    net::TestCompletionCallback client_connect_cb;
+    int rv1 = host_->Connect(host_connect_cb.callback());
+    int rv2 = client_->Connect(client_connect_cb.callback());
+    if (rv1 == net::ERR_IO_PENDING)
+      rv1 = host_connect_cb.WaitForResult();
+    if (rv2 == net::ERR_IO_PENDING)
+      rv2 = client_connect_cb.WaitForResult();
+    ASSERT_EQ(net::OK, rv1);
+    ASSERT_EQ(net::OK, rv2);
+
+    write_buffer_ = new net::DrainableIOBuffer(
+        new net::IOBuffer(kTransferSize), kTransferSize);
+    memset(write_buffer_->data(), 'x', kTransferSize);
+    read_buffer_ = new net::IOBuffer(kChunkSize);
+    bytes_read_ = 0;
+
+    DoWrite();
+    DoRead();
+    if (bytes_read_ < kTransferSize)
+      message_loop_.Run();
+    EXPECT_EQ(kTransferSize, bytes_read_);
+  }
+
+ private:
+  void DoWrite() {
+    while (write_buffer_->BytesRemaining() > 0) {
+      int rv = client_->Write(
+          write_buffer_, std::min(write_buffer_->BytesRemaining(), kChunkSize),
+          base::Bind(&PseudoTcpAdapterPerfTest::OnWritten,
+                     base::Unretained(this)));
+      if (rv == net::ERR_IO_PENDING)
+        return;
+      ASSERT_GT(rv, 0);
+      write_buffer_->DidConsume(rv);
+    }
+  }
+
+  void OnWritten(int result) {
+    ASSERT_GT(result, 0);
+    write_buffer_->DidConsume(result);
+    DoWrite();
+  }
+
+  void DoRead() {
+    while (bytes_read_ < kTransferSize) {
+      int rv = host_->Read(read_buffer_, kChunkSize,
+                           base::Bind(&PseudoTcpAdapterPerfTest::OnRead,
+                                      base::Unretained(this)));
+      if (rv == net::ERR_IO_PENDING)
+        return;
+      ASSERT_GT(rv, 0);
+      bytes_read_ += rv;
+    }
+  }
+
+  void OnRead(int result) {
+    ASSERT_GT(result, 0);
+    bytes_read_ += result;
+    DoRead();
+    if (bytes_read_ == kTransferSize)
+      MessageLoop::current()->Quit();
+  }
+
+  MessageLoop message_loop_;
+  scoped_ptr<PseudoTcpAdapter> host_;
+  scoped_ptr<PseudoTcpAdapter> client_;
+  scoped_refptr<net::DrainableIOBuffer> write_buffer_;
+  scoped_refptr<net::IOBuffer> read_buffer_;
+  int bytes_read_;
+};
+
+}  // namespace
+
+TEST_F(PseudoTcpAdapterPerfTest, DefaultWindows) {
+  PerfTimeLogger timer("PseudoTcpAdapterPerfTest.DefaultWindows");
+  Transfer();
+}
+
+TEST_F(PseudoTcpAdapterPerfTest, LargeWindows) {
+  SetWindows(kLargeSendBufferSize, kLargeReceiveBufferSize);
+  PerfTimeLogger timer("PseudoTcpAdapterPerfTest.LargeWindows");
+  Transfer();
+}
+
+}  // namespace jingle_glue
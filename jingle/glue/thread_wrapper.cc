@@ -7,6 +7,7 @@
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/lazy_instance.h"
+#include "base/metrics/histogram.h"
 #include "base/threading/thread_local.h"
 
 namespace jingle_glue {
@@ -47,6 +48,7 @@ JingleThreadWrapper::JingleThreadWrapper(MessageLoop* message_loop)
       message_loop_(message_loop),
       send_allowed_(false),
       last_task_id_(0),
+      pending_messages_task_posted_(false),
       pending_send_event_(true, false) {
   DCHECK_EQ(message_loop_, MessageLoop::current());
 
@@ -104,6 +106,21 @@ void JingleThreadWrapper::Clear(talk_base::MessageHandler* handler, uint32 id,
     it = next;
   }
 
+  for (std::deque<talk_base::Message>::iterator it =
+           pending_messages_.begin();
+       it != pending_messages_.end();) {
+    if (it->Match(handler, id)) {
+      if (removed) {
+        removed->push_back(*it);
+      } else {
+        delete it->pdata;
+      }
+      it = pending_messages_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
   for (std::list<PendingSend*>::iterator it = pending_send_messages_.begin();
        it != pending_send_messages_.end();) {
     std::list<PendingSend*>::iterator next = it;
@@ -198,27 +215,35 @@ void JingleThreadWrapper::ProcessPendingSends() {
 void JingleThreadWrapper::PostTaskInternal(
     int delay_ms, talk_base::MessageHandler* handler,
     uint32 message_id, talk_base::MessageData* data) {
-  int task_id;
   talk_base::Message message;
   message.phandler = handler;
   message.message_id = message_id;
   message.pdata = data;
+
+  if (delay_ms <= 0) {
+    {
+      base::AutoLock auto_lock(lock_);
+      pending_messages_.push_back(message);
+      if (pending_messages_task_posted_)
+        return;
+      pending_messages_task_posted_ = true;
+    }
+    message_loop_->PostTask(
+        FROM_HERE, base::Bind(&JingleThreadWrapper::ProcessPendingMessages,
+                              base::Unretained(this)));
+    return;
+  }
+
+  int task_id;
   {
     base::AutoLock auto_lock(lock_);
     task_id = ++last_task_id_;
     messages_.insert(std::pair<int, talk_base::Message>(task_id, message));
   }
-
-  if (delay_ms <= 0) {
-    message_loop_->PostTask(FROM_HERE,
-                            base::Bind(&JingleThreadWrapper::RunTask,
-                                       base::Unretained(this), task_id));
-  } else {
-    message_loop_->PostDelayedTask(FROM_HERE,
-                                   base::Bind(&JingleThreadWrapper::RunTask,
-                                              base::Unretained(this), task_id),
-                                   base::TimeDelta::FromMilliseconds(delay_ms));
-  }
+  message_loop_->PostDelayedTask(FROM_HERE,
+                                 base::Bind(&JingleThreadWrapper::RunTask,
+                                            base::Unretained(this), task_id),
+                                 base::TimeDelta::FromMilliseconds(delay_ms));
 }
 
 void JingleThreadWrapper::RunTask(int task_id) {
@@ -234,13 +259,45 @@ void JingleThreadWrapper::RunTask(int task_id) {
     }
   }
 
-  if (have_message) {
-    if (message.message_id == talk_base::MQID_DISPOSE) {
-      DCHECK(message.phandler == NULL);
-      delete message.pdata;
-    } else {
-      message.phandler->OnMessage(&message);
+  if (have_message)
+    DeliverMessage(&message);
+}
+
+void JingleThreadWrapper::ProcessPendingMessages() {
+  // Run only the messages that are already queued, so that handlers which
+  // keep posting cannot starve other tasks on |message_loop_|. Messages
+  // posted from now on get a new task.
+  size_t count;
+  {
+    base::AutoLock auto_lock(lock_);
+    pending_messages_task_posted_ = false;
+    count = pending_messages_.size();
+  }
+
+  int processed = 0;
+  for (; count > 0; --count) {
+    talk_base::Message message;
+    {
+      // A handler may have Clear()ed the rest of the queue.
+      base::AutoLock auto_lock(lock_);
+      if (pending_messages_.empty())
+        break;
+      message = pending_messages_.front();
+      pending_messages_.pop_front();
     }
+    DeliverMessage(&message);
+    ++processed;
+  }
+
+  UMA_HISTOGRAM_COUNTS_100("JingleThreadWrapper.MessagesPerTask", processed);
+}
+
+void JingleThreadWrapper::DeliverMessage(talk_base::Message* message) {
+  if (message->message_id == talk_base::MQID_DISPOSE) {
+    DCHECK(message->phandler == NULL);
+    delete message->pdata;
+  } else {
+    message->phandler->OnMessage(message);
   }
 }
 
@@ -5,6 +5,7 @@
 #ifndef JINGLE_GLUE_THREAD_WRAPPER_H_
 #define JINGLE_GLUE_THREAD_WRAPPER_H_
 
+#include <deque>
 #include <list>
 #include <map>
 
@@ -96,17 +97,26 @@ class JingleThreadWrapper
       int delay_ms, talk_base::MessageHandler* handler,
       uint32 message_id, talk_base::MessageData* data);
   void RunTask(int task_id);
+  void ProcessPendingMessages();
   void ProcessPendingSends();
+  void DeliverMessage(talk_base::Message* message);
 
   // Chromium thread used to execute messages posted on this thread.
   MessageLoop* message_loop_;
 
   bool send_allowed_;
 
-  // |lock_| must be locked when accessing |messages_|.
+  // |lock_| must be locked when accessing |messages_|,
+  // |pending_messages_| or |pending_messages_task_posted_|.
   base::Lock lock_;
   int last_task_id_;
+  // Delayed messages, each run by its own delayed task.
   MessagesQueue messages_;
+  // Messages posted without a delay. They are all run by a single
+  // ProcessPendingMessages() task, which is posted when the first of them
+  // arrives, instead of posting a closure for each one.
+  std::deque<talk_base::Message> pending_messages_;
+  bool pending_messages_task_posted_;
   std::list<PendingSend*> pending_send_messages_;
   base::WaitableEvent pending_send_event_;
 };
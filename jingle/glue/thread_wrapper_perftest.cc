@@ -0,0 +1,67 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times posting and running bursts of small messages through a
+// JingleThreadWrapper, as the WebRTC and remoting network threads do.
+
+#include "base/message_loop.h"
+#include "base/perftimer.h"
+#include "jingle/glue/thread_wrapper.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace jingle_glue {
+
+namespace {
+
+const int kBursts = 1000;
+const int kMessagesPerBurst = 100;
+
+class CountingHandler : public talk_base::MessageHandler {
+ public:
+  CountingHandler() : count_(0) {}
+
+  virtual void OnMessage(talk_base::Message* message) OVERRIDE {
+    ++count_;
+  }
+
+  int count() const { return count_; }
+
+ private:
+  int count_;
+};
+
+}  // namespace
+
+TEST(ThreadWrapperPerfTest, PostBursts) {
+  MessageLoop message_loop;
+  JingleThreadWrapper::EnsureForCurrentThread();
+  talk_base::Thread* thread = talk_base::Thread::Current();
+  CountingHandler handler;
+
+  PerfTimeLogger timer("ThreadWrapperPerfTest.PostBursts");
+  for (int i = 0; i < kBursts; ++i) {
+    for (int j = 0; j < kMessagesPerBurst; ++j)
+      thread->Post(&handler, j);
+    message_loop.RunAllPending();
+  }
+  timer.Done();
+
+  EXPECT_EQ(kBursts * kMessagesPerBurst, handler.count());
+}
+
+TEST(ThreadWrapperPerfTest, SendSameThread) {
+  MessageLoop message_loop;
+  JingleThreadWrapper::EnsureForCurrentThread();
+  talk_base::Thread* thread = talk_base::Thread::Current();
+  CountingHandler handler;
+
+  PerfTimeLogger timer("ThreadWrapperPerfTest.SendSameThread");
+  for (int i = 0; i < kBursts * kMessagesPerBurst; ++i)
+    thread->Send(&handler, i);
+  timer.Done();
+
+  EXPECT_EQ(kBursts * kMessagesPerBurst, handler.count());
+}
+
+}  // namespace jingle_glue
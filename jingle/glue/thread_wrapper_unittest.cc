@@ -43,6 +43,10 @@ ACTION(DeleteMessageData) {
   delete arg0->pdata;
 }
 
+ACTION_P2(ClearMessages, thread, handler) {
+  thread->Clear(handler);
+}
+
 // Helper class used in the Dispose test.
 class DeletableObject {
  public:
@@ -177,6 +181,24 @@ TEST_F(ThreadWrapperTest, Clear) {
   message_loop_.RunAllPending();
 }
 
+// Verify that a message removed by a handler that runs earlier in the same
+// batch is not delivered.
+TEST_F(ThreadWrapperTest, ClearFromHandler) {
+  thread_->Post(&handler1_, kTestMessage1, NULL);
+  thread_->Post(&handler2_, kTestMessage1, NULL);
+  thread_->Post(&handler1_, kTestMessage2, NULL);
+
+  talk_base::MessageData* null_data = NULL;
+  EXPECT_CALL(handler1_, OnMessage(
+      MatchMessage(&handler1_, kTestMessage1, null_data)))
+      .WillOnce(ClearMessages(thread_, &handler2_));
+  EXPECT_CALL(handler1_, OnMessage(
+      MatchMessage(&handler1_, kTestMessage2, null_data)));
+  EXPECT_CALL(handler2_, OnMessage(testing::_)).Times(0);
+
+  message_loop_.RunAllPending();
+}
+
 TEST_F(ThreadWrapperTest, ClearDelayed) {
   thread_->PostDelayed(kTestDelayMs1, &handler1_, kTestMessage1, NULL);
   thread_->PostDelayed(kTestDelayMs2, &handler1_, kTestMessage2, NULL);
@@ -202,5 +202,25 @@
         '../third_party/libjingle/libjingle.gyp:libjingle',
       ],
     },
+    {
+      'target_name': 'jingle_perftests',
+      'type': 'executable',
+      'sources': [
+        'glue/pseudotcp_adapter_perftest.cc',
+        'glue/thread_wrapper_perftest.cc',
+      ],
+      'include_dirs': [
+        '..',
+      ],
+      'dependencies': [
+        'jingle_glue',
+        '../base/base.gyp:base',
+        '../base/base.gyp:test_support_perf',
+        '../net/net.gyp:net',
+        '../net/net.gyp:net_test_support',
+        '../testing/gtest.gyp:gtest',
+        '../third_party/libjingle/libjingle.gyp:libjingle',
+      ],
+    },
   ],
 }
@@ -0,0 +1,133 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/audio/audio_buffer_ring.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+using base::subtle::Acquire_Load;
+using base::subtle::Atomic32;
+using base::subtle::NoBarrier_Load;
+using base::subtle::NoBarrier_Store;
+using base::subtle::Release_Store;
+
+namespace media {
+
+// The counters only grow and wrap around; their difference is the number of
+// queued buffers. |write_count| and the buffer sizes are only written by the
+// producer, |read_count| and |underruns| only by the consumer.
+struct AudioBufferRing::Header {
+  Atomic32 depth;
+  Atomic32 write_count;
+  Atomic32 read_count;
+  Atomic32 underruns;
+  Atomic32 sizes[kMaxDepth];
+};
+
+// static
+uint32 AudioBufferRing::SizeInBytes(uint32 packet_size) {
+  if (!packet_size || packet_size & 3)
+    return 0;
+  return HeaderSizeInBytes() + kMaxDepth * packet_size;
+}
+
+// static
+uint32 AudioBufferRing::HeaderSizeInBytes() {
+  return sizeof(Header);
+}
+
+AudioBufferRing::AudioBufferRing(void* memory, uint32 packet_size)
+    : header_(static_cast<Header*>(memory)),
+      buffers_(static_cast<uint8*>(memory) + sizeof(Header)),
+      packet_size_(packet_size) {
+  DCHECK_EQ(0u, reinterpret_cast<size_t>(memory) & 3);
+  DCHECK_GT(SizeInBytes(packet_size), 0u);
+}
+
+AudioBufferRing::~AudioBufferRing() {}
+
+void AudioBufferRing::SetDepth(int depth) {
+  DCHECK_GE(depth, 0);
+  DCHECK_LE(depth, static_cast<int>(kMaxDepth));
+  DCHECK_EQ(0u, queued_buffers());
+  Release_Store(&header_->depth, depth);
+}
+
+int AudioBufferRing::depth() const {
+  int depth = Acquire_Load(&header_->depth);
+  // The other process may have written anything.
+  return std::max(0, std::min(depth, static_cast<int>(kMaxDepth)));
+}
+
+bool AudioBufferRing::CanWrite() const {
+  return queued_buffers() < static_cast<uint32>(depth());
+}
+
+void* AudioBufferRing::GetWriteBuffer() {
+  DCHECK(CanWrite());
+  uint32 index =
+      static_cast<uint32>(NoBarrier_Load(&header_->write_count)) % depth();
+  return buffers_ + index * packet_size_;
+}
+
+void AudioBufferRing::CommitWrite(uint32 size) {
+  DCHECK(CanWrite());
+  Atomic32 write_count = NoBarrier_Load(&header_->write_count);
+  uint32 index = static_cast<uint32>(write_count) % depth();
+  NoBarrier_Store(&header_->sizes[index], std::min(size, packet_size_));
+  // Publishes the buffer and its size to the consumer.
+  Release_Store(&header_->write_count, write_count + 1);
+}
+
+bool AudioBufferRing::CanRead() const {
+  return queued_buffers() > 0;
+}
+
+uint32 AudioBufferRing::Read(void* dest, uint32 size) {
+  int ring_depth = depth();
+  if (!ring_depth || !CanRead()) {
+    memset(dest, 0, size);
+    NoBarrier_Store(&header_->underruns,
+                    NoBarrier_Load(&header_->underruns) + 1);
+    return 0;
+  }
+
+  Atomic32 read_count = NoBarrier_Load(&header_->read_count);
+  uint32 index = static_cast<uint32>(read_count) % ring_depth;
+  uint32 read_size = std::min(
+      static_cast<uint32>(NoBarrier_Load(&header_->sizes[index])),
+      std::min(size, packet_size_));
+  memcpy(dest, buffers_ + index * packet_size_, read_size);
+  if (read_size < size)
+    memset(static_cast<uint8*>(dest) + read_size, 0, size - read_size);
+
+  // Hands the buffer back to the producer.
+  Release_Store(&header_->read_count, read_count + 1);
+  return read_size;
+}
+
+void AudioBufferRing::DropQueuedBuffers() {
+  Release_Store(&header_->read_count, Acquire_Load(&header_->write_count));
+}
+
+uint32 AudioBufferRing::queued_bytes() const {
+  return queued_buffers() * packet_size_;
+}
+
+int AudioBufferRing::underruns() const {
+  return NoBarrier_Load(&header_->underruns);
+}
+
+uint32 AudioBufferRing::queued_buffers() const {
+  uint32 queued = static_cast<uint32>(Acquire_Load(&header_->write_count)) -
+      static_cast<uint32>(Acquire_Load(&header_->read_count));
+  // A misbehaving renderer must not make the browser read out of bounds.
+  return std::min(queued, static_cast<uint32>(kMaxDepth));
+}
+
+}  // namespace media
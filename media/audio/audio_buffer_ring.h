@@ -0,0 +1,82 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_AUDIO_AUDIO_BUFFER_RING_H_
+#define MEDIA_AUDIO_AUDIO_BUFFER_RING_H_
+
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "media/base/media_export.h"
+
+namespace media {
+
+// A lock-free ring of audio buffers in the shared memory of an audio output
+// stream, with the renderer as the single producer and the browser as the
+// single consumer. It lets the renderer queue several buffers ahead of the
+// browser's reads, so the browser never has to wait on the renderer and a
+// late renderer costs a glitch only once the queue runs dry.
+//
+// The ring is placed behind the single packet and data size of the original
+// layout (see SetActualDataSizeInBytes()), so clients that do not know about
+// it, such as Pepper plugins, keep working. The ring is used once the
+// producer sets its depth; until then the consumer reads the single packet.
+class MEDIA_EXPORT AudioBufferRing {
+ public:
+  enum { kMaxDepth = 4 };
+
+  // Returns the number of bytes the ring needs for buffers of |packet_size|
+  // bytes, or 0 if the ring can not be used with such buffers: the buffers
+  // must keep the counters that follow them 4 byte aligned.
+  static uint32 SizeInBytes(uint32 packet_size);
+
+  // The part of SizeInBytes() that does not depend on the packet size.
+  static uint32 HeaderSizeInBytes();
+
+  // |memory| must point to SizeInBytes(|packet_size|) bytes of shared memory,
+  // 4 byte aligned, and zeroed before the first use.
+  AudioBufferRing(void* memory, uint32 packet_size);
+  ~AudioBufferRing();
+
+  // The number of buffers the producer queues ahead, between 1 and
+  // kMaxDepth, or 0 if the ring is not used. Set by the producer before it
+  // writes the first buffer.
+  void SetDepth(int depth);
+  int depth() const;
+
+  // Producer methods. GetWriteBuffer() returns the buffer to fill next if
+  // CanWrite(), which CommitWrite() then hands to the consumer.
+  bool CanWrite() const;
+  void* GetWriteBuffer();
+  void CommitWrite(uint32 size);
+
+  // Consumer methods. Read() copies the next buffer to |dest| and returns the
+  // number of bytes it contained, padding |dest| with silence. If the ring is
+  // empty it fills |dest| with silence, counts an underrun and returns 0.
+  bool CanRead() const;
+  uint32 Read(void* dest, uint32 size);
+
+  // Drops the queued buffers, e.g. on pause. Called by the consumer.
+  void DropQueuedBuffers();
+
+  // The number of bytes queued and not read yet.
+  uint32 queued_bytes() const;
+
+  // The number of reads that found the ring empty.
+  int underruns() const;
+
+ private:
+  struct Header;
+
+  uint32 queued_buffers() const;
+
+  Header* header_;
+  uint8* buffers_;
+  uint32 packet_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(AudioBufferRing);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_AUDIO_AUDIO_BUFFER_RING_H_
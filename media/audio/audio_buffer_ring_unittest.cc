@@ -0,0 +1,99 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include <vector>
+
+#include "media/audio/audio_buffer_ring.h"
+#include "media/audio/audio_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+static const uint32 kPacketSize = 16;
+
+class AudioBufferRingTest : public testing::Test {
+ protected:
+  AudioBufferRingTest()
+      : memory_(AudioBufferRing::SizeInBytes(kPacketSize) / sizeof(uint32)),
+        ring_(&memory_[0], kPacketSize) {
+  }
+
+  void Write(uint8 value, uint32 size) {
+    ASSERT_TRUE(ring_.CanWrite());
+    memset(ring_.GetWriteBuffer(), value, size);
+    ring_.CommitWrite(size);
+  }
+
+  std::vector<uint32> memory_;
+  AudioBufferRing ring_;
+};
+
+TEST_F(AudioBufferRingTest, UnusedUntilDepthIsSet) {
+  EXPECT_EQ(0, ring_.depth());
+  EXPECT_FALSE(ring_.CanWrite());
+  EXPECT_FALSE(ring_.CanRead());
+}
+
+TEST_F(AudioBufferRingTest, ReadsBuffersInOrder) {
+  ring_.SetDepth(3);
+  Write(1, kPacketSize);
+  Write(2, kPacketSize);
+  Write(3, kPacketSize / 2);
+  EXPECT_FALSE(ring_.CanWrite());
+  EXPECT_EQ(3 * kPacketSize, ring_.queued_bytes());
+
+  uint8 data[kPacketSize];
+  EXPECT_EQ(kPacketSize, ring_.Read(data, kPacketSize));
+  EXPECT_EQ(1, data[kPacketSize - 1]);
+  EXPECT_TRUE(ring_.CanWrite());
+  Write(4, kPacketSize);
+
+  EXPECT_EQ(kPacketSize, ring_.Read(data, kPacketSize));
+  EXPECT_EQ(2, data[0]);
+
+  // A short buffer is padded with silence.
+  EXPECT_EQ(kPacketSize / 2, ring_.Read(data, kPacketSize));
+  EXPECT_EQ(3, data[kPacketSize / 2 - 1]);
+  EXPECT_EQ(0, data[kPacketSize / 2]);
+
+  EXPECT_EQ(kPacketSize, ring_.Read(data, kPacketSize));
+  EXPECT_EQ(4, data[0]);
+  EXPECT_FALSE(ring_.CanRead());
+  EXPECT_EQ(0, ring_.underruns());
+}
+
+TEST_F(AudioBufferRingTest, EmptyReadIsAnUnderrun) {
+  ring_.SetDepth(2);
+  uint8 data[kPacketSize];
+  memset(data, 1, sizeof(data));
+  EXPECT_EQ(0u, ring_.Read(data, kPacketSize));
+  EXPECT_EQ(0, data[0]);
+  EXPECT_EQ(1, ring_.underruns());
+}
+
+TEST_F(AudioBufferRingTest, DropQueuedBuffers) {
+  ring_.SetDepth(2);
+  Write(1, kPacketSize);
+  Write(2, kPacketSize);
+  ring_.DropQueuedBuffers();
+  EXPECT_FALSE(ring_.CanRead());
+  EXPECT_EQ(0u, ring_.queued_bytes());
+
+  Write(3, kPacketSize);
+  uint8 data[kPacketSize];
+  EXPECT_EQ(kPacketSize, ring_.Read(data, kPacketSize));
+  EXPECT_EQ(3, data[0]);
+}
+
+TEST(AudioBufferRingSizeTest, PacketSizeRoundTrips) {
+  // Sizes that are not a multiple of 4 get no ring.
+  EXPECT_EQ(0u, AudioBufferRing::SizeInBytes(882));
+  EXPECT_EQ(882u, PacketSizeSizeInBytes(TotalSharedMemorySizeInBytes(882)));
+  EXPECT_EQ(4096u, PacketSizeSizeInBytes(TotalSharedMemorySizeInBytes(4096)));
+  EXPECT_EQ(1764u, PacketSizeSizeInBytes(TotalSharedMemorySizeInBytes(1764)));
+}
+
+}  // namespace media
@@ -11,6 +11,7 @@
 #include "media/audio/audio_output_dispatcher_impl.h"
 #include "media/audio/audio_output_mixer.h"
 #include "media/audio/audio_output_proxy.h"
+#include "media/audio/audio_util.h"
 #include "media/audio/fake_audio_input_stream.h"
 #include "media/audio/fake_audio_output_stream.h"
 #include "media/base/media_switches.h"
@@ -144,7 +145,18 @@ AudioOutputStream* AudioManagerBase::MakeAudioOutputStreamProxy(
         base::TimeDelta::FromSeconds(kStreamCloseDelaySeconds);
     const CommandLine* cmd_line = CommandLine::ForCurrentProcess();
     if (cmd_line->HasSwitch(switches::kEnableAudioMixer)) {
-      dispatcher = new AudioOutputMixer(this, params, close_delay);
+      if (params.format() == AudioParameters::AUDIO_MOCK) {
+        dispatcher = new AudioOutputMixer(this, params, close_delay);
+      } else {
+        // Mix at the rate of the streams but play at the hardware rate, the
+        // only one the low latency path supports.
+        AudioParameters output_params(
+            AudioParameters::AUDIO_PCM_LOW_LATENCY, params.channel_layout(),
+            GetAudioHardwareSampleRate(), 16,
+            GetAudioHardwareBufferSize());
+        dispatcher = new AudioOutputMixer(this, params, output_params,
+                                          close_delay);
+      }
     } else {
       dispatcher = new AudioOutputDispatcherImpl(this, params, close_delay);
     }
@@ -13,6 +13,7 @@
 #include "media/audio/audio_io.h"
 #include "media/audio/audio_output_proxy.h"
 #include "media/audio/audio_util.h"
+#include "media/base/sinc_resampler.h"
 
 namespace media {
 
@@ -25,11 +26,54 @@ AudioOutputMixer::AudioOutputMixer(AudioManager* audio_manager,
                    close_delay,
                    weak_this_.GetWeakPtr(),
                    &AudioOutputMixer::ClosePhysicalStream),
-      pending_bytes_(0) {
+      pending_bytes_(0),
+      physical_params_(params),
+      resampler_pending_bytes_(0) {
   // TODO(enal): align data.
   mixer_data_.reset(new uint8[params_.GetBytesPerBuffer()]);
 }
 
+AudioOutputMixer::AudioOutputMixer(AudioManager* audio_manager,
+                                   const AudioParameters& params,
+                                   const AudioParameters& output_params,
+                                   const base::TimeDelta& close_delay)
+    : AudioOutputDispatcher(audio_manager, params),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_this_(this)),
+      close_timer_(FROM_HERE,
+                   close_delay,
+                   weak_this_.GetWeakPtr(),
+                   &AudioOutputMixer::ClosePhysicalStream),
+      pending_bytes_(0),
+      physical_params_(output_params.format(),
+                       params.channel_layout(),
+                       output_params.sample_rate(),
+                       output_params.bits_per_sample(),
+                       output_params.frames_per_buffer()),
+      resampler_pending_bytes_(0) {
+  // TODO(enal): align data.
+  mixer_data_.reset(new uint8[params_.GetBytesPerBuffer()]);
+
+  if (physical_params_.sample_rate() == params_.sample_rate()) {
+    physical_params_ = params_;
+  } else {
+    // Ask for whole packets of |params_| so the proxies are read the same way
+    // as without resampling.
+    resampler_.reset(new SincResampler(
+        static_cast<double>(params_.sample_rate()) /
+            physical_params_.sample_rate(),
+        params_.channels(),
+        params_.frames_per_buffer(),
+        base::Bind(&AudioOutputMixer::ProvideResamplerInput,
+                   base::Unretained(this))));
+    resampler_input_.reset(new uint8[params_.GetBytesPerBuffer()]);
+    int frames = physical_params_.frames_per_buffer();
+    resampler_output_data_.resize(params_.channels() * frames);
+    resampler_output_.resize(params_.channels());
+    for (int i = 0; i < params_.channels(); ++i)
+      resampler_output_[i] = &resampler_output_data_[i * frames];
+  }
+}
+
 AudioOutputMixer::~AudioOutputMixer() {
 }
 
@@ -38,7 +82,8 @@ bool AudioOutputMixer::OpenStream() {
 
   if (physical_stream_.get())
     return true;
-  AudioOutputStream* stream = audio_manager_->MakeAudioOutputStream(params_);
+  AudioOutputStream* stream =
+      audio_manager_->MakeAudioOutputStream(physical_params_);
   if (!stream)
     return false;
   if (!stream->Open()) {
@@ -152,17 +197,66 @@ void AudioOutputMixer::ClosePhysicalStream() {
 uint32 AudioOutputMixer::OnMoreData(uint8* dest,
                                     uint32 max_size,
                                     AudioBuffersState buffers_state) {
-  max_size = std::min(max_size,
-                      static_cast<uint32>(params_.GetBytesPerBuffer()));
   // TODO(enal): consider getting rid of lock as it is in time-critical code.
   //             E.g. swap |proxies_| with local variable, and merge 2 lists
   //             at the end. That would speed things up but complicate stopping
   //             the stream.
   base::AutoLock lock(lock_);
 
-  DCHECK_GE(pending_bytes_, buffers_state.pending_bytes);
+  if (!resampler_.get()) {
+    DCHECK_GE(pending_bytes_, buffers_state.pending_bytes);
+    return MixProxies_Locked(dest, max_size, buffers_state.pending_bytes);
+  }
+
+  // Convert the pending bytes of the physical stream into the format of the
+  // proxies.
+  resampler_pending_bytes_ = static_cast<int>(
+      static_cast<int64>(buffers_state.pending_bytes) *
+      params_.GetBytesPerSecond() / physical_params_.GetBytesPerSecond());
+  if (proxies_.empty()) {
+    pending_bytes_ = resampler_pending_bytes_;
+    resampler_->Flush();
+    return 0;
+  }
+
+  int bytes_per_frame = physical_params_.GetBytesPerFrame();
+  int frames = std::min(static_cast<int>(max_size) / bytes_per_frame,
+                        physical_params_.frames_per_buffer());
+  resampler_->Resample(resampler_output_, frames);
+  InterleaveFloatToInt(resampler_output_, dest, frames,
+                       physical_params_.bits_per_sample() / 8);
+  return frames * bytes_per_frame;
+}
+
+void AudioOutputMixer::ProvideResamplerInput(
+    const std::vector<float*>& audio_data,
+    int number_of_frames) {
+  lock_.AssertAcquired();
+  int bytes_per_frame = params_.GetBytesPerFrame();
+  uint32 size = MixProxies_Locked(resampler_input_.get(),
+                                  number_of_frames * bytes_per_frame,
+                                  resampler_pending_bytes_);
+  resampler_pending_bytes_ = pending_bytes_;
+
+  int frames_filled = size / bytes_per_frame;
+  for (size_t i = 0; i < audio_data.size(); ++i) {
+    DeinterleaveAudioChannel(resampler_input_.get(), audio_data[i],
+                             audio_data.size(), i,
+                             params_.bits_per_sample() / 8, frames_filled);
+    memset(audio_data[i] + frames_filled, 0,
+           sizeof(float) * (number_of_frames - frames_filled));
+  }
+}
+
+uint32 AudioOutputMixer::MixProxies_Locked(uint8* dest,
+                                           uint32 max_size,
+                                           int pending_bytes) {
+  lock_.AssertAcquired();
+  max_size = std::min(max_size,
+                      static_cast<uint32>(params_.GetBytesPerBuffer()));
+
   if (proxies_.empty()) {
-    pending_bytes_ = buffers_state.pending_bytes;
+    pending_bytes_ = pending_bytes;
     return 0;
   }
   uint32 actual_total_size = 0;
@@ -184,7 +278,7 @@ uint32 AudioOutputMixer::OnMoreData(uint8* dest,
     // combined stream.
     // Note: use >= instead of ==, that way is safer.
     if (proxy_data->pending_bytes >= pending_bytes_)
-      proxy_data->pending_bytes = buffers_state.pending_bytes;
+      proxy_data->pending_bytes = pending_bytes;
 
     // Note: there is no way we can deduce hardware_delay_bytes for the
     // particular proxy stream. Use zero instead.
@@ -230,7 +324,7 @@ uint32 AudioOutputMixer::OnMoreData(uint8* dest,
   for (ProxyMap::iterator it = proxies_.begin(); it != proxies_.end(); ++it) {
     it->second.pending_bytes += actual_total_size;
   }
-  pending_bytes_ = buffers_state.pending_bytes + actual_total_size;
+  pending_bytes_ = pending_bytes + actual_total_size;
 
   return actual_total_size;
 }
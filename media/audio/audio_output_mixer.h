@@ -10,6 +10,7 @@
 #define MEDIA_AUDIO_AUDIO_OUTPUT_MIXER_H_
 
 #include <map>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/memory/ref_counted.h"
@@ -24,6 +25,8 @@
 
 namespace media {
 
+class SincResampler;
+
 class MEDIA_EXPORT AudioOutputMixer
     : public AudioOutputDispatcher,
       public AudioOutputStream::AudioSourceCallback {
@@ -32,6 +35,14 @@ class MEDIA_EXPORT AudioOutputMixer
                    const AudioParameters& params,
                    const base::TimeDelta& close_delay);
 
+  // Mixes streams of |params|, but if the sample rate of |output_params|
+  // differs, opens the physical stream with |output_params| and resamples the
+  // mix. The channel layout of |output_params| is ignored.
+  AudioOutputMixer(AudioManager* audio_manager,
+                   const AudioParameters& params,
+                   const AudioParameters& output_params,
+                   const base::TimeDelta& close_delay);
+
   // AudioOutputDispatcher interface.
   virtual bool OpenStream() OVERRIDE;
   virtual bool StartStream(AudioOutputStream::AudioSourceCallback* callback,
@@ -56,6 +67,15 @@ class MEDIA_EXPORT AudioOutputMixer
   // Called by |close_timer_|. Closes physical stream.
   void ClosePhysicalStream();
 
+  // Mixes at most |max_size| bytes of every proxy into |dest|, in the format
+  // of |params_|. |pending_bytes| is the amount of mixed data buffered after
+  // |dest|. Returns the number of bytes written.
+  uint32 MixProxies_Locked(uint8* dest, uint32 max_size, int pending_bytes);
+
+  // Called by |resampler_| for more mixed audio.
+  void ProvideResamplerInput(const std::vector<float*>& audio_data,
+                             int number_of_frames);
+
   // The |lock_| must be acquired whenever we modify |proxies_| in the audio
   // manager thread or accessing it in the hardware audio thread. Read in the
   // audio manager thread is safe.
@@ -83,9 +103,23 @@ class MEDIA_EXPORT AudioOutputMixer
   base::WeakPtrFactory<AudioOutputMixer> weak_this_;
   base::DelayTimer<AudioOutputMixer> close_timer_;
 
-  // Size of data in all in-flight buffers.
+  // Size of data in all in-flight buffers, in the format of |params_|.
   int pending_bytes_;
 
+  // The parameters of |physical_stream_|.
+  AudioParameters physical_params_;
+
+  // Converts the mix to the sample rate of |physical_params_|; NULL if the
+  // rates match. The buffers below are only used with it.
+  scoped_ptr<SincResampler> resampler_;
+  scoped_array<uint8> resampler_input_;
+  std::vector<float> resampler_output_data_;
+  std::vector<float*> resampler_output_;
+
+  // Bytes buffered after the next data handed to |resampler_|, in the
+  // format of |params_|.
+  int resampler_pending_bytes_;
+
   DISALLOW_COPY_AND_ASSIGN(AudioOutputMixer);
 };
 
@@ -20,12 +20,16 @@
 #include "base/logging.h"
 #include "base/shared_memory.h"
 #include "base/time.h"
+#include "build/build_config.h"
 #if defined(OS_WIN)
 #include "base/win/windows_version.h"
 #include "media/audio/audio_manager_base.h"
 #endif
+#include "media/audio/audio_buffer_ring.h"
 #include "media/audio/audio_parameters.h"
 #include "media/audio/audio_util.h"
+#include "media/base/cpu_features.h"
+#include "media/base/simd/mix_audio.h"
 #if defined(OS_MACOSX)
 #include "media/audio/mac/audio_low_latency_input_mac.h"
 #include "media/audio/mac/audio_low_latency_output_mac.h"
@@ -41,7 +45,51 @@ const uint32 kUnknownDataSize = static_cast<uint32>(-1);
 
 namespace media {
 
-// TODO(fbarchard): Convert to intrinsics for better efficiency.
+static MixAudio16Proc ChooseMixAudio16Proc() {
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (hasSSE2())
+    return &MixAudio16_SSE2;
+#elif defined(__ARM_NEON__)
+  if (hasNEON())
+    return &MixAudio16_NEON;
+#endif
+  return &MixAudio16_C;
+}
+
+static AdjustVolume16Proc ChooseAdjustVolume16Proc() {
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (hasSSE2())
+    return &AdjustVolume16_SSE2;
+#elif defined(__ARM_NEON__)
+  if (hasNEON())
+    return &AdjustVolume16_NEON;
+#endif
+  return &AdjustVolume16_C;
+}
+
+static InterleaveStereoFloatToInt16Proc
+ChooseInterleaveStereoFloatToInt16Proc() {
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (hasSSE2())
+    return &InterleaveStereoFloatToInt16_SSE2;
+#elif defined(__ARM_NEON__)
+  if (hasNEON())
+    return &InterleaveStereoFloatToInt16_NEON;
+#endif
+  return &InterleaveStereoFloatToInt16_C;
+}
+
+static DeinterleaveInt16ToFloatProc ChooseDeinterleaveInt16ToFloatProc() {
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (hasSSE2())
+    return &DeinterleaveInt16ToFloat_SSE2;
+#elif defined(__ARM_NEON__)
+  if (hasNEON())
+    return &DeinterleaveInt16ToFloat_NEON;
+#endif
+  return &DeinterleaveInt16ToFloat_C;
+}
+
 template<class Fixed>
 static int ScaleChannel(int channel, int volume) {
   return static_cast<int>((static_cast<Fixed>(channel) * volume) >> 16);
@@ -131,9 +179,12 @@ bool AdjustVolume(void* buf,
                                       fixed_volume);
       return true;
     } else if (bytes_per_sample == 2) {
-      AdjustVolume<int16, int32, 0>(reinterpret_cast<int16*>(buf),
-                                    sample_count,
-                                    fixed_volume);
+      static AdjustVolume16Proc adjust_volume_proc = NULL;
+      if (!adjust_volume_proc)
+        adjust_volume_proc = ChooseAdjustVolume16Proc();
+      adjust_volume_proc(reinterpret_cast<int16*>(buf),
+                         sample_count,
+                         fixed_volume);
       return true;
     } else if (bytes_per_sample == 4) {
       AdjustVolume<int32, int64, 0>(reinterpret_cast<int32*>(buf),
@@ -201,11 +252,16 @@ bool DeinterleaveAudioChannel(void* source,
 
     case 2:
     {
-      int16* source16 = reinterpret_cast<int16*>(source) + channel_index;
-      const float kScale = 1.0f / 32768.0f;
-      for (unsigned i = 0; i < number_of_frames; ++i) {
-        destination[i] = kScale * *source16;
-        source16 += channels;
+      static DeinterleaveInt16ToFloatProc deinterleave_proc = NULL;
+      if (!deinterleave_proc)
+        deinterleave_proc = ChooseDeinterleaveInt16ToFloatProc();
+      if (channels <= 2) {
+        deinterleave_proc(reinterpret_cast<int16*>(source), destination,
+                          channels, channel_index, number_of_frames);
+      } else {
+        DeinterleaveInt16ToFloat_C(reinterpret_cast<int16*>(source),
+                                   destination, channels, channel_index,
+                                   number_of_frames);
       }
       return true;
     }
@@ -265,6 +321,14 @@ void InterleaveFloatToInt(const std::vector<float*>& source, void* dst,
       InterleaveFloatToInt<uint8, int32>(source, dst, number_of_frames);
       break;
     case 2:
+      if (source.size() == 2) {
+        static InterleaveStereoFloatToInt16Proc interleave_proc = NULL;
+        if (!interleave_proc)
+          interleave_proc = ChooseInterleaveStereoFloatToInt16Proc();
+        interleave_proc(source[0], source[1], static_cast<int16*>(dst),
+                        number_of_frames);
+        break;
+      }
       InterleaveFloatToInt<int16, int32>(source, dst, number_of_frames);
       break;
     case 4:
@@ -275,10 +339,7 @@ void InterleaveFloatToInt(const std::vector<float*>& source, void* dst,
   }
 }
 
-// TODO(enal): use template specialization and size-specific intrinsics.
-//             Call is on the time-critical path, and by using SSE/AVX
-//             instructions we can speed things up by ~4-8x, more for the case
-//             when we have to adjust volume as well.
+// 16 bit samples, by far the most common, are mixed by MixAudio16Proc.
 template<class Format, class Fixed, int min_value, int max_value, int bias>
 static void MixStreams(Format* dst, Format* src, int count, float volume) {
   if (volume == 1.0f) {
@@ -316,13 +377,17 @@ void MixStreams(void* dst,
                                                buflen,
                                                volume);
       break;
-    case 2:
+    case 2: {
       DCHECK_EQ(0u, buflen % 2);
-      MixStreams<int16, int32, -32768, 32767, 0>(static_cast<int16*>(dst),
-                                                 static_cast<int16*>(src),
-                                                 buflen / 2,
-                                                 volume);
+      static MixAudio16Proc mix_proc = NULL;
+      if (!mix_proc)
+        mix_proc = ChooseMixAudio16Proc();
+      mix_proc(static_cast<int16*>(dst),
+               static_cast<int16*>(src),
+               buflen / 2,
+               static_cast<int>(volume * 65536));
       break;
+    }
     case 4:
       DCHECK_EQ(0u, buflen % 4);
       MixStreams<int32, int64, 0x80000000, 0x7fffffff, 0>(
@@ -459,16 +524,32 @@ size_t GetHighLatencyOutputBufferSize(int sample_rate) {
   return samples;
 }
 
-// When transferring data in the shared memory, first word is size of data
-// in bytes. Actual data starts immediately after it.
+// When transferring data in the shared memory, the data is followed by its
+// size in bytes, and then by the AudioBufferRing if the packet size allows it.
 
 uint32 TotalSharedMemorySizeInBytes(uint32 packet_size) {
   // Need to reserve extra 4 bytes for size of data.
-  return packet_size + sizeof(Atomic32);
+  return packet_size + sizeof(Atomic32) +
+      AudioBufferRing::SizeInBytes(packet_size);
 }
 
 uint32 PacketSizeSizeInBytes(uint32 shared_memory_created_size) {
-  return shared_memory_created_size - sizeof(Atomic32);
+  uint32 size = shared_memory_created_size - sizeof(Atomic32);
+  // The ring is only added for packet sizes that are a multiple of 4, which
+  // keeps |size| a multiple of 4 as well.
+  if (size & 3)
+    return size;
+  return (size - AudioBufferRing::HeaderSizeInBytes()) /
+      (AudioBufferRing::kMaxDepth + 1);
+}
+
+AudioBufferRing* CreateAudioBufferRing(base::SharedMemory* shared_memory,
+                                       uint32 shared_memory_size) {
+  if (!AudioBufferRing::SizeInBytes(shared_memory_size))
+    return NULL;
+  char* ptr = static_cast<char*>(shared_memory->memory()) +
+      shared_memory_size + sizeof(Atomic32);
+  return new AudioBufferRing(ptr, shared_memory_size);
 }
 
 uint32 GetActualDataSizeInBytes(base::SharedMemory* shared_memory,
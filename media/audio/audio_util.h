@@ -18,6 +18,8 @@ class SharedMemory;
 
 namespace media {
 
+class AudioBufferRing;
+
 // For all audio functions 3 audio formats are supported:
 // 8 bits unsigned 0 to 255.
 // 16 bit signed (little endian).
@@ -123,6 +125,12 @@ MEDIA_EXPORT void SetActualDataSizeInBytes(base::SharedMemory* shared_memory,
                                            uint32 actual_data_size);
 MEDIA_EXPORT void SetUnknownDataSize(base::SharedMemory* shared_memory,
                                      uint32 shared_memory_size);
+
+// Returns the AudioBufferRing that follows the data in |shared_memory|, or
+// NULL if |shared_memory_size| does not allow for one. The caller owns the
+// returned object, which must not outlive the mapping of |shared_memory|.
+MEDIA_EXPORT AudioBufferRing* CreateAudioBufferRing(
+    base::SharedMemory* shared_memory, uint32 shared_memory_size);
 MEDIA_EXPORT bool IsUnknownDataSize(base::SharedMemory* shared_memory,
                                     uint32 shared_memory_size);
 
@@ -0,0 +1,176 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/channel_mixer.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+#include "build/build_config.h"
+#include "media/base/cpu_features.h"
+
+namespace media {
+
+// Scale used to fold one channel into two at equal power.
+static const float kEqualPowerScale = 0.7071067811865476f;
+
+static FMACProc ChooseFMACProc() {
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (hasSSE())
+    return &FMAC_SSE;
+#elif defined(__ARM_NEON__)
+  if (hasNEON())
+    return &FMAC_NEON;
+#endif
+  return &FMAC_C;
+}
+
+ChannelMixer::ChannelMixer(ChannelLayout input_layout,
+                           ChannelLayout output_layout)
+    : input_layout_(input_layout),
+      output_layout_(output_layout),
+      matrix_(ChannelLayoutToChannelCount(output_layout),
+              std::vector<float>(ChannelLayoutToChannelCount(input_layout))),
+      copied_channels_(matrix_.size()),
+      fmac_proc_(ChooseFMACProc()) {
+  for (int ch = 0; ch < CHANNELS_MAX; ++ch) {
+    Channels channel = static_cast<Channels>(ch);
+    if (!HasChannel(input_layout_, channel))
+      continue;
+
+    // Channels present in both layouts are copied.
+    if (Mix(channel, channel, 1.0f))
+      continue;
+
+    switch (channel) {
+      case LEFT:
+      case RIGHT:
+        // Into mono.
+        Mix(channel, CENTER, kEqualPowerScale);
+        break;
+      case STEREO_LEFT:
+        if (!Mix(STEREO_LEFT, LEFT, 1.0f))
+          Mix(STEREO_LEFT, CENTER, kEqualPowerScale);
+        break;
+      case STEREO_RIGHT:
+        if (!Mix(STEREO_RIGHT, RIGHT, 1.0f))
+          Mix(STEREO_RIGHT, CENTER, kEqualPowerScale);
+        break;
+      case CENTER:
+        // Mono into stereo, or the center of a surround layout into the
+        // front speakers.
+        if (!MixPair(CENTER, CENTER, LEFT, RIGHT, kEqualPowerScale))
+          MixPair(CENTER, CENTER, STEREO_LEFT, STEREO_RIGHT, kEqualPowerScale);
+        break;
+      case BACK_LEFT:
+      case BACK_RIGHT:
+        if (!Mix(channel, channel == BACK_LEFT ? SIDE_LEFT : SIDE_RIGHT, 1.0f) &&
+            !Mix(channel, channel == BACK_LEFT ? LEFT : RIGHT,
+                 kEqualPowerScale)) {
+          Mix(channel, CENTER, kEqualPowerScale);
+        }
+        break;
+      case SIDE_LEFT:
+      case SIDE_RIGHT:
+        if (!Mix(channel, channel == SIDE_LEFT ? BACK_LEFT : BACK_RIGHT, 1.0f) &&
+            !Mix(channel, channel == SIDE_LEFT ? LEFT : RIGHT,
+                 kEqualPowerScale)) {
+          Mix(channel, CENTER, kEqualPowerScale);
+        }
+        break;
+      case BACK_CENTER:
+        if (!MixPair(BACK_CENTER, BACK_CENTER, BACK_LEFT, BACK_RIGHT,
+                     kEqualPowerScale) &&
+            !MixPair(BACK_CENTER, BACK_CENTER, SIDE_LEFT, SIDE_RIGHT,
+                     kEqualPowerScale) &&
+            !MixPair(BACK_CENTER, BACK_CENTER, LEFT, RIGHT,
+                     kEqualPowerScale)) {
+          Mix(BACK_CENTER, CENTER, kEqualPowerScale);
+        }
+        break;
+      case LEFT_OF_CENTER:
+      case RIGHT_OF_CENTER:
+        if (!Mix(channel, channel == LEFT_OF_CENTER ? LEFT : RIGHT,
+                 kEqualPowerScale)) {
+          Mix(channel, CENTER, kEqualPowerScale);
+        }
+        break;
+      case LFE:
+        break;
+      case CHANNELS_MAX:
+        NOTREACHED();
+        break;
+    }
+  }
+
+  // Find the output channels that are plain copies of an input channel.
+  for (size_t output_ch = 0; output_ch < matrix_.size(); ++output_ch) {
+    int copied_ch = -1;
+    for (size_t input_ch = 0; input_ch < matrix_[output_ch].size();
+         ++input_ch) {
+      float scale = matrix_[output_ch][input_ch];
+      if (scale == 0.0f)
+        continue;
+      if (scale != 1.0f || copied_ch != -1) {
+        copied_ch = -1;
+        break;
+      }
+      copied_ch = input_ch;
+    }
+    copied_channels_[output_ch] = copied_ch;
+  }
+}
+
+ChannelMixer::~ChannelMixer() {}
+
+bool ChannelMixer::HasChannel(ChannelLayout layout, Channels channel) {
+  return kChannelOrderings[layout][channel] >= 0;
+}
+
+bool ChannelMixer::Mix(Channels input_channel, Channels output_channel,
+                       float scale) {
+  if (!HasChannel(input_layout_, input_channel) ||
+      !HasChannel(output_layout_, output_channel)) {
+    return false;
+  }
+  matrix_[kChannelOrderings[output_layout_][output_channel]]
+         [kChannelOrderings[input_layout_][input_channel]] += scale;
+  return true;
+}
+
+bool ChannelMixer::MixPair(Channels input_left, Channels input_right,
+                           Channels output_left, Channels output_right,
+                           float scale) {
+  if (!HasChannel(output_layout_, output_left) ||
+      !HasChannel(output_layout_, output_right)) {
+    return false;
+  }
+  return Mix(input_left, output_left, scale) &&
+      Mix(input_right, output_right, scale);
+}
+
+void ChannelMixer::Transform(const std::vector<float*>& input,
+                             const std::vector<float*>& output,
+                             int frames) {
+  DCHECK_EQ(matrix_.size(), output.size());
+  for (size_t output_ch = 0; output_ch < output.size(); ++output_ch) {
+    const std::vector<float>& weights = matrix_[output_ch];
+    DCHECK_EQ(weights.size(), input.size());
+
+    if (copied_channels_[output_ch] >= 0) {
+      memcpy(output[output_ch], input[copied_channels_[output_ch]],
+             sizeof(float) * frames);
+      continue;
+    }
+
+    memset(output[output_ch], 0, sizeof(float) * frames);
+    for (size_t input_ch = 0; input_ch < input.size(); ++input_ch) {
+      if (weights[input_ch] != 0.0f)
+        fmac_proc_(input[input_ch], weights[input_ch], frames,
+                   output[output_ch]);
+    }
+  }
+}
+
+}  // namespace media
@@ -0,0 +1,64 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_CHANNEL_MIXER_H_
+#define MEDIA_BASE_CHANNEL_MIXER_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "media/base/channel_layout.h"
+#include "media/base/media_export.h"
+#include "media/base/simd/vector_math.h"
+
+namespace media {
+
+// ChannelMixer converts planar float audio from one channel layout to
+// another. Channels present in both layouts are copied; the others are
+// folded into their nearest neighbours at equal power, e.g. the center and
+// surround channels into left and right when downmixing to stereo, and mono
+// into left and right when upmixing. The LFE channel is dropped if the
+// output layout has none.
+class MEDIA_EXPORT ChannelMixer {
+ public:
+  ChannelMixer(ChannelLayout input_layout, ChannelLayout output_layout);
+  ~ChannelMixer();
+
+  // Mixes |frames| frames of the channels of |input| into the channels of
+  // |output|. The buffers must not overlap.
+  void Transform(const std::vector<float*>& input,
+                 const std::vector<float*>& output,
+                 int frames);
+
+ private:
+  // Adds |input_channel| to |output_channel| of the matrix, scaled by
+  // |scale|. Returns false if either channel is missing from its layout.
+  bool Mix(Channels input_channel, Channels output_channel, float scale);
+
+  // Like Mix(), but for a pair of channels into a pair of channels.
+  bool MixPair(Channels input_left, Channels input_right,
+               Channels output_left, Channels output_right, float scale);
+
+  // Returns true if |channel| is part of |layout|.
+  static bool HasChannel(ChannelLayout layout, Channels channel);
+
+  ChannelLayout input_layout_;
+  ChannelLayout output_layout_;
+
+  // |matrix_[output][input]| is the weight of input channel |input| in
+  // output channel |output|, both indexed in the order of their layouts.
+  std::vector<std::vector<float> > matrix_;
+
+  // For each output channel, the input channel it is a plain copy of, or -1
+  // if it has to be mixed.
+  std::vector<int> copied_channels_;
+
+  FMACProc fmac_proc_;
+
+  DISALLOW_COPY_AND_ASSIGN(ChannelMixer);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_CHANNEL_MIXER_H_
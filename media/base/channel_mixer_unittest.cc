@@ -0,0 +1,94 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "media/base/channel_mixer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+static const int kFrames = 9;
+static const float kEqualPowerScale = 0.7071067811865476f;
+
+class ChannelMixerTest : public testing::Test {
+ protected:
+  // Mixes one frame where input channel i holds i + 1 and returns the
+  // output channels.
+  std::vector<float> MixFrame(ChannelLayout input_layout,
+                              ChannelLayout output_layout) {
+    int input_channels = ChannelLayoutToChannelCount(input_layout);
+    int output_channels = ChannelLayoutToChannelCount(output_layout);
+    input_data_.assign(input_channels * kFrames, 0);
+    output_data_.assign(output_channels * kFrames, -1);
+
+    std::vector<float*> input;
+    for (int ch = 0; ch < input_channels; ++ch) {
+      input.push_back(&input_data_[ch * kFrames]);
+      for (int i = 0; i < kFrames; ++i)
+        input[ch][i] = ch + 1;
+    }
+    std::vector<float*> output;
+    for (int ch = 0; ch < output_channels; ++ch)
+      output.push_back(&output_data_[ch * kFrames]);
+
+    ChannelMixer mixer(input_layout, output_layout);
+    mixer.Transform(input, output, kFrames);
+
+    std::vector<float> result;
+    for (int ch = 0; ch < output_channels; ++ch) {
+      // Every frame must be mixed the same way.
+      for (int i = 1; i < kFrames; ++i)
+        EXPECT_EQ(output[ch][0], output[ch][i]);
+      result.push_back(output[ch][0]);
+    }
+    return result;
+  }
+
+  std::vector<float> input_data_;
+  std::vector<float> output_data_;
+};
+
+TEST_F(ChannelMixerTest, SameLayoutIsCopied) {
+  std::vector<float> output =
+      MixFrame(CHANNEL_LAYOUT_5_1, CHANNEL_LAYOUT_5_1);
+  ASSERT_EQ(6u, output.size());
+  for (size_t ch = 0; ch < output.size(); ++ch)
+    EXPECT_EQ(ch + 1.0f, output[ch]);
+}
+
+TEST_F(ChannelMixerTest, MonoToStereo) {
+  std::vector<float> output =
+      MixFrame(CHANNEL_LAYOUT_MONO, CHANNEL_LAYOUT_STEREO);
+  ASSERT_EQ(2u, output.size());
+  EXPECT_FLOAT_EQ(kEqualPowerScale, output[0]);
+  EXPECT_FLOAT_EQ(kEqualPowerScale, output[1]);
+}
+
+TEST_F(ChannelMixerTest, StereoToMono) {
+  std::vector<float> output =
+      MixFrame(CHANNEL_LAYOUT_STEREO, CHANNEL_LAYOUT_MONO);
+  ASSERT_EQ(1u, output.size());
+  EXPECT_FLOAT_EQ(3 * kEqualPowerScale, output[0]);
+}
+
+TEST_F(ChannelMixerTest, SurroundToStereo) {
+  // 5.1 is L, R, C, LFE, SL, SR; the LFE is dropped.
+  std::vector<float> output =
+      MixFrame(CHANNEL_LAYOUT_5_1, CHANNEL_LAYOUT_STEREO);
+  ASSERT_EQ(2u, output.size());
+  EXPECT_FLOAT_EQ(1 + (3 + 5) * kEqualPowerScale, output[0]);
+  EXPECT_FLOAT_EQ(2 + (3 + 6) * kEqualPowerScale, output[1]);
+}
+
+TEST_F(ChannelMixerTest, SideToBack) {
+  // 5.0 is L, R, C, SL, SR and 5.0 back is L, R, C, BL, BR.
+  std::vector<float> output =
+      MixFrame(CHANNEL_LAYOUT_5_0, CHANNEL_LAYOUT_5_0_BACK);
+  ASSERT_EQ(5u, output.size());
+  for (size_t ch = 0; ch < output.size(); ++ch)
+    EXPECT_EQ(ch + 1.0f, output[ch]);
+}
+
+}  // namespace media
@@ -22,6 +22,9 @@ bool hasSSE2();
 // Returns true if CPU supports SSE2, SSE3, and SSSE3.
 bool hasSSSE3();
 
+// Returns true if CPU has NEON support.
+bool hasNEON();
+
 }  // namespace media
 
 #endif  // MEDIA_BASE_CPU_FEATURES_H_
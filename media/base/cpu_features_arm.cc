@@ -14,4 +14,14 @@ bool hasSSSE3() {
   return false;
 }
 
+// NEON is optional on ARMv7, so the NEON code is only built when the
+// compiler targets it (arm_neon=1) and __ARM_NEON__ is defined.
+bool hasNEON() {
+#if defined(__ARM_NEON__)
+  return true;
+#else
+  return false;
+#endif
+}
+
 }  // namespace media
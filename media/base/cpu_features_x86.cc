@@ -89,4 +89,8 @@ bool hasSSSE3() {
       (cpu_info[2] & 0x00000200) != 0;
 }
 
+bool hasNEON() {
+  return false;
+}
+
 }  // namespace media
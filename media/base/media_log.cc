@@ -69,14 +69,10 @@ const char* MediaLog::PipelineStateToString(Pipeline::State state) {
       return "created";
     case Pipeline::kInitDemuxer:
       return "initDemuxer";
-    case Pipeline::kInitAudioDecoder:
-      return "initAudioDecoder";
-    case Pipeline::kInitAudioRenderer:
-      return "initAudioRenderer";
-    case Pipeline::kInitVideoDecoder:
-      return "initVideoDecoder";
-    case Pipeline::kInitVideoRenderer:
-      return "initVideoRenderer";
+    case Pipeline::kInitDecoders:
+      return "initDecoders";
+    case Pipeline::kInitRenderers:
+      return "initRenderers";
     case Pipeline::kPausing:
       return "pausing";
     case Pipeline::kSeeking:
@@ -251,6 +247,11 @@ void MediaLog::AddStatisticsUpdatedEvent() {
                            last_statistics_.video_frames_decoded);
   event->params.SetInteger("video_frames_dropped",
                            last_statistics_.video_frames_dropped);
+  event->params.SetDouble("video_decode_time_ms",
+                          last_statistics_.video_decode_time.InMillisecondsF());
+  event->params.SetDouble(
+      "video_max_decode_time_ms",
+      last_statistics_.video_max_decode_time.InMillisecondsF());
   AddEvent(event.Pass());
   stats_update_pending_ = false;
 }
@@ -73,6 +73,7 @@ struct MediaLogEvent {
     // The recorded statistics of the media pipeline have been updated.
     // params: "audio_bytes_decoded", "video_bytes_decoded",
     //         "video_frames_decoded", "video_frames_dropped": <integers>.
+    //         "video_decode_time_ms", "video_max_decode_time_ms": <doubles>.
     STATISTICS_UPDATED,
   };
 
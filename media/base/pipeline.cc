@@ -59,9 +59,14 @@ media::PipelineStatus PipelineStatusNotification::status() {
 }
 
 struct Pipeline::PipelineInitState {
+  PipelineInitState() : pending_filters(0) {}
+
   scoped_refptr<AudioDecoder> audio_decoder;
   scoped_refptr<VideoDecoder> video_decoder;
   scoped_refptr<CompositeFilter> composite;
+
+  // Filters of the current initialization stage that have not reported back.
+  int pending_filters;
 };
 
 Pipeline::Pipeline(MessageLoop* message_loop, MediaLog* media_log)
@@ -589,6 +594,9 @@ void Pipeline::OnUpdateStatistics(const PipelineStatistics& stats) {
   statistics_.video_bytes_decoded += stats.video_bytes_decoded;
   statistics_.video_frames_decoded += stats.video_frames_decoded;
   statistics_.video_frames_dropped += stats.video_frames_dropped;
+  statistics_.video_decode_time += stats.video_decode_time;
+  statistics_.video_max_decode_time = std::max(
+      statistics_.video_max_decode_time, stats.video_max_decode_time);
   media_log_->QueueStatisticsUpdatedEvent(statistics_);
 }
 
@@ -619,10 +627,10 @@ void Pipeline::StartTask(scoped_ptr<FilterCollection> filter_collection,
 // Initialization step performed in this method depends on current state of this
 // object, indicated by |state_|.  After each step of initialization, this
 // object transits to the next stage.  It starts by creating a Demuxer, and then
-// connects the Demuxer's audio stream to an AudioDecoder which is then
-// connected to an AudioRenderer.  If the media has video, then it connects a
-// VideoDecoder to the Demuxer's video stream, and then connects the
-// VideoDecoder to a VideoRenderer.
+// connects an AudioDecoder to the Demuxer's audio stream and a VideoDecoder to
+// its video stream, initializing both at once.  Once every decoder is ready,
+// the AudioDecoder is connected to an AudioRenderer and the VideoDecoder to a
+// VideoRenderer, again at once.
 //
 // When all required filters have been created and have called their
 // FilterHost's InitializationComplete() method, the pipeline will update its
@@ -634,11 +642,13 @@ void Pipeline::StartTask(scoped_ptr<FilterCollection> filter_collection,
 void Pipeline::InitializeTask(PipelineStatus last_stage_status) {
   DCHECK(message_loop_->BelongsToCurrentThread());
 
+  // Currently only VideoDecoders have a recoverable error code, in which case
+  // the next video decoder of the collection gets a try.
+  bool try_next_video_decoder = false;
   if (last_stage_status != PIPELINE_OK) {
-    // Currently only VideoDecoders have a recoverable error code.
-    if (state_ == kInitVideoDecoder &&
+    if (state_ == kInitDecoders &&
         last_stage_status == DECODER_ERROR_NOT_SUPPORTED) {
-      state_ = kInitAudioRenderer;
+      try_next_video_decoder = true;
     } else {
       SetError(last_stage_status);
     }
@@ -649,55 +659,64 @@ void Pipeline::InitializeTask(PipelineStatus last_stage_status) {
     return;
 
   DCHECK(state_ == kInitDemuxer ||
-         state_ == kInitAudioDecoder ||
-         state_ == kInitAudioRenderer ||
-         state_ == kInitVideoDecoder ||
-         state_ == kInitVideoRenderer);
+         state_ == kInitDecoders ||
+         state_ == kInitRenderers);
+
+  if (state_ != kInitDemuxer) {
+    DCHECK_GT(pipeline_init_state_->pending_filters, 0);
+    --pipeline_init_state_->pending_filters;
+  }
+
+  if (try_next_video_decoder && InitializeVideoDecoder(demuxer_))
+    ++pipeline_init_state_->pending_filters;
 
-  // Demuxer created, create audio decoder.
+  // Wait for the other streams of this stage.
+  if (pipeline_init_state_->pending_filters > 0)
+    return;
+
+  // Demuxer created, create the decoders of its streams.
   if (state_ == kInitDemuxer) {
-    SetState(kInitAudioDecoder);
-    // If this method returns false, then there's no audio stream.
+    UMA_HISTOGRAM_TIMES("Media.TimeToDemuxerInitialized",
+                        base::Time::Now() - creation_time_);
+    SetState(kInitDecoders);
+
+    // These return false if there's no such stream.
     if (InitializeAudioDecoder(demuxer_))
+      ++pipeline_init_state_->pending_filters;
+    if (InitializeVideoDecoder(demuxer_))
+      ++pipeline_init_state_->pending_filters;
+    if (pipeline_init_state_->pending_filters > 0)
       return;
   }
 
-  // Assuming audio decoder was created, create audio renderer.
-  if (state_ == kInitAudioDecoder) {
-    SetState(kInitAudioRenderer);
+  // Decoders created, create the renderers they feed.
+  if (state_ == kInitDecoders) {
+    SetState(kInitRenderers);
 
-    // Returns false if there's no audio stream.
+    // These return false if there's no such decoder.
     if (InitializeAudioRenderer(pipeline_init_state_->audio_decoder)) {
       base::AutoLock auto_lock(lock_);
       has_audio_ = true;
-      return;
+      ++pipeline_init_state_->pending_filters;
     }
-  }
-
-  // Assuming audio renderer was created, create video decoder.
-  if (state_ == kInitAudioRenderer) {
-    // Then perform the stage of initialization, i.e. initialize video decoder.
-    SetState(kInitVideoDecoder);
-    if (InitializeVideoDecoder(demuxer_))
-      return;
-  }
-
-  // Assuming video decoder was created, create video renderer.
-  if (state_ == kInitVideoDecoder) {
-    SetState(kInitVideoRenderer);
     if (InitializeVideoRenderer(pipeline_init_state_->video_decoder)) {
       base::AutoLock auto_lock(lock_);
       has_video_ = true;
-      return;
+      ++pipeline_init_state_->pending_filters;
     }
+    if (pipeline_init_state_->pending_filters > 0)
+      return;
   }
 
-  if (state_ == kInitVideoRenderer) {
+  if (state_ == kInitRenderers) {
     if (!IsPipelineOk() || !(HasAudio() || HasVideo())) {
       SetError(PIPELINE_ERROR_COULD_NOT_RENDER);
       return;
     }
 
+    UMA_HISTOGRAM_TIMES("Media.TimeToFiltersInitialized",
+                        base::Time::Now() - creation_time_);
+
     // Clear the collection of filters.
     filter_collection_->Clear();
 
@@ -1042,10 +1061,8 @@ void Pipeline::TeardownStateTransitionTask() {
     case kCreated:
     case kError:
     case kInitDemuxer:
-    case kInitAudioDecoder:
-    case kInitAudioRenderer:
-    case kInitVideoDecoder:
-    case kInitVideoRenderer:
+    case kInitDecoders:
+    case kInitRenderers:
     case kSeeking:
     case kStarting:
     case kStopped:
@@ -1243,10 +1260,8 @@ void Pipeline::TearDownPipeline() {
       break;
 
     case kInitDemuxer:
-    case kInitAudioDecoder:
-    case kInitAudioRenderer:
-    case kInitVideoDecoder:
-    case kInitVideoRenderer:
+    case kInitDecoders:
+    case kInitRenderers:
       // Make it look like initialization was successful.
       pipeline_filter_ = pipeline_init_state_->composite;
       pipeline_init_state_.reset();
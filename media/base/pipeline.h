@@ -81,7 +81,7 @@ class MEDIA_EXPORT PipelineStatusNotification {
 //   [ *Created ]                                    [ Stopped ]
 //         | Start()                                      ^
 //         V                       SetError()             |
-//   [ InitXXX (for each filter) ] -------->[ Stopping (for each filter) ]
+//   [ InitXXX (for each stream) ] -------->[ Stopping (for each filter) ]
 //         |                                              ^
 //         V                                              | if Stop
 //   [ Seeking (for each filter) ] <--------[ Flushing (for each filter) ]
@@ -99,9 +99,12 @@ class MEDIA_EXPORT PipelineStatusNotification {
 //                                         [ Any State Other Than InitXXX ]
 
 //
-// Initialization is a series of state transitions from "Created" through each
-// filter initialization state.  When all filter initialization states have
-// completed, we are implicitly in a "Paused" state.  At that point we simulate
+// Initialization is a series of state transitions from "Created" through the
+// demuxer, decoder and renderer initialization states. The decoders of all
+// the streams are initialized at the same time, and so are the renderers, so
+// that a video decoder that takes a while to start does not hold up the audio
+// path. When all filter initialization states have completed, we are
+// implicitly in a "Paused" state.  At that point we simulate
 // a Seek() to the beginning of the media to give filters a chance to preroll.
 // From then on the normal Seek() transitions are carried out and we start
 // playing the media.
@@ -256,10 +259,8 @@ class MEDIA_EXPORT Pipeline
   enum State {
     kCreated,
     kInitDemuxer,
-    kInitAudioDecoder,
-    kInitAudioRenderer,
-    kInitVideoDecoder,
-    kInitVideoRenderer,
+    kInitDecoders,
+    kInitRenderers,
     kPausing,
     kSeeking,
     kFlushing,
@@ -358,8 +359,8 @@ class MEDIA_EXPORT Pipeline
   // InitializeTask() performs initialization in multiple passes. It is executed
   // as a result of calling Start() or InitializationComplete() that advances
   // initialization to the next state. It works as a hub of state transition for
-  // initialization.  One stage communicates its status to the next through
-  // |last_stage_status|.
+  // initialization.  Each filter of a stage reports its status through
+  // |last_stage_status|, and the next stage starts once all of them have.
   void InitializeTask(PipelineStatus last_stage_status);
 
   // Stops and destroys all filters, placing the pipeline in the kStopped state.
@@ -6,6 +6,7 @@
 #define MEDIA_BASE_PIPELINE_STATUS_H_
 
 #include "base/callback.h"
+#include "base/time.h"
 
 namespace media {
 
@@ -46,6 +47,12 @@ struct PipelineStatistics {
   uint32 video_bytes_decoded;  // Should be uint64?
   uint32 video_frames_decoded;
   uint32 video_frames_dropped;
+
+  // Time the video decoder spent decoding, in total and for the slowest
+  // buffer. Compared with the frame rate this tells how much headroom the
+  // decoder has.
+  base::TimeDelta video_decode_time;
+  base::TimeDelta video_max_decode_time;
 };
 
 // Used for updating pipeline statistics.
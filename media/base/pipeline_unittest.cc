@@ -27,6 +27,7 @@ using ::testing::Mock;
 using ::testing::NotNull;
 using ::testing::Return;
 using ::testing::ReturnRef;
+using ::testing::SaveArg;
 using ::testing::StrictMock;
 using ::testing::WithArg;
 
@@ -411,6 +412,35 @@ TEST_F(PipelineTest, AudioVideoStream) {
   EXPECT_TRUE(pipeline_->HasVideo());
 }
 
+// The video decoder must not wait for the audio decoder, but no renderer may
+// start until both decoders are done.
+TEST_F(PipelineTest, DecodersInitializeConcurrently) {
+  CreateAudioStream();
+  CreateVideoStream();
+  MockDemuxerStreamVector streams;
+  streams.push_back(audio_stream());
+  streams.push_back(video_stream());
+
+  InitializeDemuxer(&streams);
+  PipelineStatusCB audio_decoder_cb;
+  EXPECT_CALL(*mocks_->audio_decoder(), Initialize(
+      scoped_refptr<DemuxerStream>(audio_stream()), _, _))
+      .WillOnce(SaveArg<1>(&audio_decoder_cb));
+  InitializeVideoDecoder(video_stream());
+
+  InitializePipeline(PIPELINE_OK);
+  ASSERT_FALSE(audio_decoder_cb.is_null());
+  EXPECT_FALSE(pipeline_->IsInitialized());
+
+  InitializeAudioRenderer();
+  InitializeVideoRenderer();
+  audio_decoder_cb.Run(PIPELINE_OK);
+  message_loop_.RunAllPending();
+  EXPECT_TRUE(pipeline_->IsInitialized());
+  EXPECT_TRUE(pipeline_->HasAudio());
+  EXPECT_TRUE(pipeline_->HasVideo());
+}
+
 TEST_F(PipelineTest, Seek) {
   CreateAudioStream();
   CreateVideoStream();
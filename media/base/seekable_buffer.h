@@ -110,6 +110,10 @@ class MEDIA_EXPORT SeekableBuffer {
     backward_capacity_ = new_backward_capacity;
   }
 
+  // Evicts buffers in the backward direction until backward bytes is within
+  // the backward capacity. Reads and seeks do this automatically.
+  void EvictBackwardBuffers();
+
   // Returns the maximum number of bytes that should be kept in the forward
   // direction.
   int forward_capacity() const { return forward_capacity_; }
@@ -130,9 +134,6 @@ class MEDIA_EXPORT SeekableBuffer {
   // Definition of the buffer queue.
   typedef std::list<scoped_refptr<Buffer> > BufferQueue;
 
-  // A helper method to evict buffers in the backward direction until backward
-  // bytes is within the backward capacity.
-  void EvictBackwardBuffers();
 
   // An internal method shared by Read() and SeekForward() that actually does
   // reading. It reads a maximum of |size| bytes into |data|. Returns the number
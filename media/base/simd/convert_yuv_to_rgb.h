@@ -54,6 +54,17 @@ void ConvertYUVToRGB32_MMX(const uint8* yplane,
                            int rgbstride,
                            YUVType yuv_type);
 
+void ConvertYUVToRGB32_NEON(const uint8* yplane,
+                            const uint8* uplane,
+                            const uint8* vplane,
+                            uint8* rgbframe,
+                            int width,
+                            int height,
+                            int ystride,
+                            int uvstride,
+                            int rgbstride,
+                            YUVType yuv_type);
+
 }  // namespace media
 
 // Assembly functions are declared without namespace.
@@ -89,6 +100,12 @@ void ConvertYUVToRGB32Row_SSE(const uint8* yplane,
                               uint8* rgbframe,
                               int width);
 
+void ConvertYUVToRGB32Row_NEON(const uint8* yplane,
+                               const uint8* uplane,
+                               const uint8* vplane,
+                               uint8* rgbframe,
+                               int width);
+
 void ScaleYUVToRGB32Row_C(const uint8* y_buf,
                           const uint8* u_buf,
                           const uint8* v_buf,
@@ -110,6 +127,13 @@ void ScaleYUVToRGB32Row_SSE(const uint8* y_buf,
                             int width,
                             int source_dx);
 
+void ScaleYUVToRGB32Row_NEON(const uint8* y_buf,
+                             const uint8* u_buf,
+                             const uint8* v_buf,
+                             uint8* rgb_buf,
+                             int width,
+                             int source_dx);
+
 void ScaleYUVToRGB32Row_SSE2_X64(const uint8* y_buf,
                                  const uint8* u_buf,
                                  const uint8* v_buf,
@@ -0,0 +1,114 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <arm_neon.h>
+
+#include "media/base/simd/convert_yuv_to_rgb.h"
+#include "media/base/simd/yuv_to_rgb_table.h"
+#include "media/base/yuv_convert.h"
+
+// The table lookups are the same as in ConvertYUVToRGB32Row_C, but the four
+// channels of a pixel are added, shifted and saturated in one register, which
+// gives the same results as the C and MMX versions bit for bit.
+
+// Returns the saturated sum of the U and V entries of the table.
+static inline int16x4_t LoadUV(uint8 u, uint8 v) {
+  return vqadd_s16(vld1_s16(kCoefficientsRgbY[256 + u]),
+                   vld1_s16(kCoefficientsRgbY[512 + v]));
+}
+
+// Returns the BGRA channels of a pixel, before they are packed to bytes.
+static inline int16x4_t ConvertPixel(uint8 y, int16x4_t uv) {
+  return vshr_n_s16(vqadd_s16(uv, vld1_s16(kCoefficientsRgbY[y])), 6);
+}
+
+static inline void StorePixels(int16x4_t pixel0,
+                               int16x4_t pixel1,
+                               uint8* rgb_buf) {
+  vst1_u8(rgb_buf, vqmovun_s16(vcombine_s16(pixel0, pixel1)));
+}
+
+static inline void StorePixel(int16x4_t pixel, uint8* rgb_buf) {
+  uint8x8_t packed = vqmovun_s16(vcombine_s16(pixel, pixel));
+  vst1_lane_u32(reinterpret_cast<uint32*>(rgb_buf),
+                vreinterpret_u32_u8(packed), 0);
+}
+
+extern "C" {
+
+void ConvertYUVToRGB32Row_NEON(const uint8* y_buf,
+                               const uint8* u_buf,
+                               const uint8* v_buf,
+                               uint8* rgb_buf,
+                               int width) {
+  int x = 0;
+  for (; x + 1 < width; x += 2) {
+    int16x4_t uv = LoadUV(u_buf[x >> 1], v_buf[x >> 1]);
+    StorePixels(ConvertPixel(y_buf[x], uv),
+                ConvertPixel(y_buf[x + 1], uv),
+                rgb_buf);
+    rgb_buf += 8;
+  }
+
+  // If number of pixels is odd then compute it.
+  if (x < width) {
+    int16x4_t uv = LoadUV(u_buf[x >> 1], v_buf[x >> 1]);
+    StorePixel(ConvertPixel(y_buf[x], uv), rgb_buf);
+  }
+}
+
+void ScaleYUVToRGB32Row_NEON(const uint8* y_buf,
+                             const uint8* u_buf,
+                             const uint8* v_buf,
+                             uint8* rgb_buf,
+                             int width,
+                             int source_dx) {
+  int x = 0;
+  int i = 0;
+  for (; i + 1 < width; i += 2) {
+    int16x4_t uv = LoadUV(u_buf[x >> 17], v_buf[x >> 17]);
+    int16x4_t pixel0 = ConvertPixel(y_buf[x >> 16], uv);
+    x += source_dx;
+    int16x4_t pixel1 = ConvertPixel(y_buf[x >> 16], uv);
+    x += source_dx;
+    StorePixels(pixel0, pixel1, rgb_buf);
+    rgb_buf += 8;
+  }
+
+  if (i < width) {
+    int16x4_t uv = LoadUV(u_buf[x >> 17], v_buf[x >> 17]);
+    StorePixel(ConvertPixel(y_buf[x >> 16], uv), rgb_buf);
+  }
+}
+
+}  // extern "C"
+
+namespace media {
+
+void ConvertYUVToRGB32_NEON(const uint8* yplane,
+                            const uint8* uplane,
+                            const uint8* vplane,
+                            uint8* rgbframe,
+                            int width,
+                            int height,
+                            int ystride,
+                            int uvstride,
+                            int rgbstride,
+                            YUVType yuv_type) {
+  unsigned int y_shift = yuv_type;
+  for (int y = 0; y < height; ++y) {
+    uint8* rgb_row = rgbframe + y * rgbstride;
+    const uint8* y_ptr = yplane + y * ystride;
+    const uint8* u_ptr = uplane + (y >> y_shift) * uvstride;
+    const uint8* v_ptr = vplane + (y >> y_shift) * uvstride;
+
+    ConvertYUVToRGB32Row_NEON(y_ptr,
+                              u_ptr,
+                              v_ptr,
+                              rgb_row,
+                              width);
+  }
+}
+
+}  // namespace media
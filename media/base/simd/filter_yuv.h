@@ -24,6 +24,9 @@ void FilterYUVRows_MMX(uint8* ybuf, const uint8* y0_ptr, const uint8* y1_ptr,
 void FilterYUVRows_SSE2(uint8* ybuf, const uint8* y0_ptr, const uint8* y1_ptr,
                         int source_width, int source_y_fraction);
 
+void FilterYUVRows_NEON(uint8* ybuf, const uint8* y0_ptr, const uint8* y1_ptr,
+                        int source_width, int source_y_fraction);
+
 }  // namespace media
 
 #endif  // MEDIA_BASE_SIMD_FILTER_YUV_H_
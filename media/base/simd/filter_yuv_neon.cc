@@ -0,0 +1,50 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <arm_neon.h>
+
+#include "media/base/simd/filter_yuv.h"
+
+namespace media {
+
+void FilterYUVRows_NEON(uint8* dest,
+                        const uint8* src0,
+                        const uint8* src1,
+                        int width,
+                        int fraction) {
+  int pixel = 0;
+
+  const uint8x8_t src1_fraction = vdup_n_u8(static_cast<uint8>(fraction));
+  const uint16x8_t src0_fraction = vdupq_n_u16(256 - fraction);
+
+  // NEON loads and stores do not need aligned addresses, so there is no
+  // unaligned head to process.
+  int end = width & ~15;
+  while (pixel < end) {
+    uint8x16_t src0_bytes = vld1q_u8(src0 + pixel);
+    uint8x16_t src1_bytes = vld1q_u8(src1 + pixel);
+
+    // 256 - fraction does not fit in a byte when fraction is 0, so the
+    // weights of |src0| are applied in 16 bits.
+    uint16x8_t low = vmulq_u16(vmovl_u8(vget_low_u8(src0_bytes)),
+                               src0_fraction);
+    uint16x8_t high = vmulq_u16(vmovl_u8(vget_high_u8(src0_bytes)),
+                                src0_fraction);
+    low = vmlal_u8(low, vget_low_u8(src1_bytes), src1_fraction);
+    high = vmlal_u8(high, vget_high_u8(src1_bytes), src1_fraction);
+
+    vst1q_u8(dest + pixel, vcombine_u8(vshrn_n_u16(low, 8),
+                                       vshrn_n_u16(high, 8)));
+    pixel += 16;
+  }
+
+  // And then process the last few bytes.
+  while (pixel < width) {
+    dest[pixel] = (src0[pixel] * (256 - fraction) +
+                   src1[pixel] * fraction) >> 8;
+    ++pixel;
+  }
+}
+
+}  // namespace media
@@ -0,0 +1,60 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Kernels for 16 bit audio, the sample format used by the browser's audio
+// output streams. Volumes are 16.16 fixed point, 65536 being unity gain.
+// The SIMD versions produce exactly the same results as the C versions.
+
+#ifndef MEDIA_BASE_SIMD_MIX_AUDIO_H_
+#define MEDIA_BASE_SIMD_MIX_AUDIO_H_
+
+#include "base/basictypes.h"
+
+namespace media {
+
+// Adds |src| scaled by |fixed_volume| to |dest|, saturating the result.
+typedef void (*MixAudio16Proc)(int16*, const int16*, int, int);
+
+void MixAudio16_C(int16* dest, const int16* src, int count, int fixed_volume);
+void MixAudio16_SSE2(int16* dest, const int16* src, int count,
+                     int fixed_volume);
+void MixAudio16_NEON(int16* dest, const int16* src, int count,
+                     int fixed_volume);
+
+// Scales |buf| by |fixed_volume|, which must not be above unity.
+typedef void (*AdjustVolume16Proc)(int16*, int, int);
+
+void AdjustVolume16_C(int16* buf, int count, int fixed_volume);
+void AdjustVolume16_SSE2(int16* buf, int count, int fixed_volume);
+void AdjustVolume16_NEON(int16* buf, int count, int fixed_volume);
+
+// Converts the float samples of |left| and |right| to interleaved stereo,
+// clipping them to [-1, 1].
+typedef void (*InterleaveStereoFloatToInt16Proc)(const float*, const float*,
+                                                  int16*, int);
+
+void InterleaveStereoFloatToInt16_C(const float* left, const float* right,
+                                    int16* dest, int frames);
+void InterleaveStereoFloatToInt16_SSE2(const float* left, const float* right,
+                                       int16* dest, int frames);
+void InterleaveStereoFloatToInt16_NEON(const float* left, const float* right,
+                                       int16* dest, int frames);
+
+// Converts channel |channel_index| of the |channels| interleaved channels of
+// |src| to float. The SIMD versions support mono and stereo only.
+typedef void (*DeinterleaveInt16ToFloatProc)(const int16*, float*, int, int,
+                                             int);
+
+void DeinterleaveInt16ToFloat_C(const int16* src, float* dest, int channels,
+                                int channel_index, int frames);
+void DeinterleaveInt16ToFloat_SSE2(const int16* src, float* dest,
+                                   int channels, int channel_index,
+                                   int frames);
+void DeinterleaveInt16ToFloat_NEON(const int16* src, float* dest,
+                                   int channels, int channel_index,
+                                   int frames);
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_SIMD_MIX_AUDIO_H_
@@ -0,0 +1,55 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/simd/mix_audio.h"
+
+namespace media {
+
+static const float kInt16ToFloatScale = 1.0f / 32768.0f;
+
+static inline int16 ClampToInt16(int value) {
+  if (value > kint16max)
+    return kint16max;
+  if (value < kint16min)
+    return kint16min;
+  return static_cast<int16>(value);
+}
+
+static inline int16 FloatToInt16(float sample) {
+  float value = kint16max * sample;
+  if (value > kint16max)
+    return kint16max;
+  if (value < kint16min)
+    return kint16min;
+  return static_cast<int16>(value);
+}
+
+void MixAudio16_C(int16* dest, const int16* src, int count, int fixed_volume) {
+  for (int i = 0; i < count; ++i)
+    dest[i] = ClampToInt16(dest[i] + ((src[i] * fixed_volume) >> 16));
+}
+
+void AdjustVolume16_C(int16* buf, int count, int fixed_volume) {
+  for (int i = 0; i < count; ++i)
+    buf[i] = static_cast<int16>((buf[i] * fixed_volume) >> 16);
+}
+
+void InterleaveStereoFloatToInt16_C(const float* left, const float* right,
+                                    int16* dest, int frames) {
+  for (int i = 0; i < frames; ++i) {
+    dest[2 * i] = FloatToInt16(left[i]);
+    dest[2 * i + 1] = FloatToInt16(right[i]);
+  }
+}
+
+void DeinterleaveInt16ToFloat_C(const int16* src, float* dest, int channels,
+                                int channel_index, int frames) {
+  src += channel_index;
+  for (int i = 0; i < frames; ++i) {
+    dest[i] = kInt16ToFloatScale * *src;
+    src += channels;
+  }
+}
+
+}  // namespace media
@@ -0,0 +1,80 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <arm_neon.h>
+
+#include "media/base/simd/mix_audio.h"
+
+namespace media {
+
+// Returns (|samples| * |fixed_volume|) >> 16, computed in 32 bits.
+static inline int16x8_t ScaleSamples(int16x8_t samples, int32 fixed_volume) {
+  int32x4_t lo = vmulq_n_s32(vmovl_s16(vget_low_s16(samples)), fixed_volume);
+  int32x4_t hi = vmulq_n_s32(vmovl_s16(vget_high_s16(samples)), fixed_volume);
+  return vcombine_s16(vshrn_n_s32(lo, 16), vshrn_n_s32(hi, 16));
+}
+
+void MixAudio16_NEON(int16* dest, const int16* src, int count,
+                     int fixed_volume) {
+  int i = 0;
+  if (fixed_volume >= 65536) {
+    for (; i + 8 <= count; i += 8)
+      vst1q_s16(dest + i, vqaddq_s16(vld1q_s16(dest + i), vld1q_s16(src + i)));
+  } else {
+    for (; i + 8 <= count; i += 8) {
+      int16x8_t s = ScaleSamples(vld1q_s16(src + i), fixed_volume);
+      vst1q_s16(dest + i, vqaddq_s16(vld1q_s16(dest + i), s));
+    }
+  }
+  MixAudio16_C(dest + i, src + i, count - i, fixed_volume);
+}
+
+void AdjustVolume16_NEON(int16* buf, int count, int fixed_volume) {
+  int i = 0;
+  for (; i + 8 <= count; i += 8)
+    vst1q_s16(buf + i, ScaleSamples(vld1q_s16(buf + i), fixed_volume));
+  AdjustVolume16_C(buf + i, count - i, fixed_volume);
+}
+
+void InterleaveStereoFloatToInt16_NEON(const float* left, const float* right,
+                                       int16* dest, int frames) {
+  int i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    // The conversion truncates and saturates like the C version.
+    int16x4x2_t out;
+    out.val[0] = vqmovn_s32(vcvtq_s32_f32(
+        vmulq_n_f32(vld1q_f32(left + i), kint16max)));
+    out.val[1] = vqmovn_s32(vcvtq_s32_f32(
+        vmulq_n_f32(vld1q_f32(right + i), kint16max)));
+    vst2_s16(dest + 2 * i, out);
+  }
+  InterleaveStereoFloatToInt16_C(left + i, right + i, dest + 2 * i,
+                                 frames - i);
+}
+
+void DeinterleaveInt16ToFloat_NEON(const int16* src, float* dest,
+                                   int channels, int channel_index,
+                                   int frames) {
+  const float kScale = 1.0f / 32768.0f;
+  int i = 0;
+  if (channels == 1 || channels == 2) {
+    for (; i + 8 <= frames; i += 8) {
+      int16x8_t s;
+      if (channels == 1) {
+        s = vld1q_s16(src + i);
+      } else {
+        int16x8x2_t samples = vld2q_s16(src + 2 * i);
+        s = samples.val[channel_index];
+      }
+      vst1q_f32(dest + i, vmulq_n_f32(
+          vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))), kScale));
+      vst1q_f32(dest + i + 4, vmulq_n_f32(
+          vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), kScale));
+    }
+  }
+  DeinterleaveInt16ToFloat_C(src + i * channels, dest + i, channels,
+                             channel_index, frames - i);
+}
+
+}  // namespace media
@@ -0,0 +1,122 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+#include "media/base/simd/mix_audio.h"
+
+namespace media {
+
+// Returns (|samples| * |fixed_volume|) >> 16 for a volume below unity.
+// _mm_mulhi_epi16() takes a signed 16 bit volume, so volumes of 0.5 and
+// above are passed as |fixed_volume| - 65536 and |samples| is added back.
+static inline __m128i ScaleSamples(__m128i samples, __m128i volume,
+                                   bool volume_above_half) {
+  __m128i scaled = _mm_mulhi_epi16(samples, volume);
+  if (volume_above_half)
+    scaled = _mm_add_epi16(scaled, samples);
+  return scaled;
+}
+
+void MixAudio16_SSE2(int16* dest, const int16* src, int count,
+                     int fixed_volume) {
+  int i = 0;
+  if (fixed_volume >= 65536) {
+    for (; i + 8 <= count; i += 8) {
+      __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest + i));
+      __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                       _mm_adds_epi16(d, s));
+    }
+  } else {
+    bool volume_above_half = fixed_volume >= 32768;
+    __m128i volume = _mm_set1_epi16(static_cast<int16>(
+        volume_above_half ? fixed_volume - 65536 : fixed_volume));
+    for (; i + 8 <= count; i += 8) {
+      __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest + i));
+      __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      s = ScaleSamples(s, volume, volume_above_half);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                       _mm_adds_epi16(d, s));
+    }
+  }
+  MixAudio16_C(dest + i, src + i, count - i, fixed_volume);
+}
+
+void AdjustVolume16_SSE2(int16* buf, int count, int fixed_volume) {
+  bool volume_above_half = fixed_volume >= 32768;
+  __m128i volume = _mm_set1_epi16(static_cast<int16>(
+      volume_above_half ? fixed_volume - 65536 : fixed_volume));
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m128i* p = reinterpret_cast<__m128i*>(buf + i);
+    _mm_storeu_si128(p, ScaleSamples(_mm_loadu_si128(p), volume,
+                                     volume_above_half));
+  }
+  AdjustVolume16_C(buf + i, count - i, fixed_volume);
+}
+
+void InterleaveStereoFloatToInt16_SSE2(const float* left, const float* right,
+                                       int16* dest, int frames) {
+  const __m128 scale = _mm_set1_ps(kint16max);
+  const __m128 max_value = _mm_set1_ps(kint16max);
+  const __m128 min_value = _mm_set1_ps(kint16min);
+  int i = 0;
+  for (; i + 8 <= frames; i += 8) {
+    // Clamp before truncating, as the conversion of out of range values is
+    // not saturated.
+    __m128i l0 = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(
+        _mm_mul_ps(_mm_loadu_ps(left + i), scale), max_value), min_value));
+    __m128i l1 = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(
+        _mm_mul_ps(_mm_loadu_ps(left + i + 4), scale), max_value), min_value));
+    __m128i r0 = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(
+        _mm_mul_ps(_mm_loadu_ps(right + i), scale), max_value), min_value));
+    __m128i r1 = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(
+        _mm_mul_ps(_mm_loadu_ps(right + i + 4), scale), max_value),
+        min_value));
+    __m128i l = _mm_packs_epi32(l0, l1);
+    __m128i r = _mm_packs_epi32(r0, r1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 2 * i),
+                     _mm_unpacklo_epi16(l, r));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 2 * i + 8),
+                     _mm_unpackhi_epi16(l, r));
+  }
+  InterleaveStereoFloatToInt16_C(left + i, right + i, dest + 2 * i,
+                                 frames - i);
+}
+
+void DeinterleaveInt16ToFloat_SSE2(const int16* src, float* dest,
+                                   int channels, int channel_index,
+                                   int frames) {
+  const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+  int i = 0;
+  if (channels == 1) {
+    for (; i + 8 <= frames; i += 8) {
+      __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      // Sign extend by moving each sample to the high half of a 32 bit lane.
+      __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+      __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+      _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+      _mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+  } else if (channels == 2) {
+    for (; i + 4 <= frames; i += 4) {
+      // Each 32 bit lane holds a frame, the left sample in the low half.
+      __m128i s = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(src + 2 * i));
+      if (channel_index == 0)
+        s = _mm_slli_epi32(s, 16);
+      s = _mm_srai_epi32(s, 16);
+      _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(s), scale));
+    }
+  }
+  DeinterleaveInt16ToFloat_C(src + i * channels, dest + i, channels,
+                             channel_index, frames - i);
+}
+
+}  // namespace media
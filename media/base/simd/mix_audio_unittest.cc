@@ -0,0 +1,107 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/logging.h"
+#include "build/build_config.h"
+#include "media/base/cpu_features.h"
+#include "media/base/simd/mix_audio.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+// Not a multiple of the SIMD width, so the C tails are exercised too.
+static const int kFrames = 67;
+static const int kVolumes[] = { 0, 1, 16384, 32767, 32768, 50000, 65535, 65536 };
+
+static void FillSamples(int16* samples, int count) {
+  for (int i = 0; i < count; ++i)
+    samples[i] = static_cast<int16>(rand());
+  // Extremes that saturate when mixed.
+  samples[0] = kint16max;
+  samples[1] = kint16min;
+}
+
+static void FillFloats(float* samples, int count) {
+  for (int i = 0; i < count; ++i)
+    samples[i] = 2.5f * rand() / RAND_MAX - 1.25f;
+}
+
+static void TestKernels(MixAudio16Proc mix_proc,
+                        AdjustVolume16Proc adjust_volume_proc,
+                        InterleaveStereoFloatToInt16Proc interleave_proc,
+                        DeinterleaveInt16ToFloatProc deinterleave_proc) {
+  int16 src[2 * kFrames];
+  int16 expected[2 * kFrames];
+  int16 actual[2 * kFrames];
+
+  for (size_t i = 0; i < arraysize(kVolumes); ++i) {
+    FillSamples(src, kFrames);
+    FillSamples(expected, kFrames);
+    memcpy(actual, expected, sizeof(actual));
+    MixAudio16_C(expected, src, kFrames, kVolumes[i]);
+    mix_proc(actual, src, kFrames, kVolumes[i]);
+    EXPECT_EQ(0, memcmp(expected, actual, kFrames * sizeof(int16)))
+        << "volume " << kVolumes[i];
+
+    if (kVolumes[i] < 65536) {
+      memcpy(expected, src, sizeof(expected));
+      memcpy(actual, src, sizeof(actual));
+      AdjustVolume16_C(expected, kFrames, kVolumes[i]);
+      adjust_volume_proc(actual, kFrames, kVolumes[i]);
+      EXPECT_EQ(0, memcmp(expected, actual, kFrames * sizeof(int16)))
+          << "volume " << kVolumes[i];
+    }
+  }
+
+  float left[kFrames];
+  float right[kFrames];
+  FillFloats(left, kFrames);
+  FillFloats(right, kFrames);
+  InterleaveStereoFloatToInt16_C(left, right, expected, kFrames);
+  interleave_proc(left, right, actual, kFrames);
+  EXPECT_EQ(0, memcmp(expected, actual, sizeof(actual)));
+
+  float expected_float[2 * kFrames];
+  float actual_float[2 * kFrames];
+  FillSamples(src, 2 * kFrames);
+  for (int channels = 1; channels <= 2; ++channels) {
+    for (int index = 0; index < channels; ++index) {
+      DeinterleaveInt16ToFloat_C(src, expected_float, channels, index,
+                                 kFrames);
+      deinterleave_proc(src, actual_float, channels, index, kFrames);
+      EXPECT_EQ(0, memcmp(expected_float, actual_float,
+                          kFrames * sizeof(float)))
+          << channels << " channels, index " << index;
+    }
+  }
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+TEST(MixAudioTest, SSE2MatchesC) {
+  if (!hasSSE2()) {
+    LOG(WARNING) << "System not supported. Test skipped.";
+    return;
+  }
+  TestKernels(&MixAudio16_SSE2, &AdjustVolume16_SSE2,
+              &InterleaveStereoFloatToInt16_SSE2,
+              &DeinterleaveInt16ToFloat_SSE2);
+}
+#endif
+
+#if defined(__ARM_NEON__)
+TEST(MixAudioTest, NEONMatchesC) {
+  if (!hasNEON()) {
+    LOG(WARNING) << "System not supported. Test skipped.";
+    return;
+  }
+  TestKernels(&MixAudio16_NEON, &AdjustVolume16_NEON,
+              &InterleaveStereoFloatToInt16_NEON,
+              &DeinterleaveInt16ToFloat_NEON);
+}
+#endif
+
+}  // namespace media
@@ -0,0 +1,44 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Float kernels used by SincResampler, ChannelMixer and
+// AudioRendererAlgorithm.
+
+#ifndef MEDIA_BASE_SIMD_VECTOR_MATH_H_
+#define MEDIA_BASE_SIMD_VECTOR_MATH_H_
+
+namespace media {
+
+// Convolves |input| with the kernels |k1| and |k2| of |kernel_size| taps and
+// linearly interpolates between the two results by
+// |kernel_interpolation_factor|. The SIMD versions require |kernel_size| to
+// be a multiple of 4 and |k1| and |k2| to be 16 byte aligned.
+typedef float (*ConvolveProc)(const float*, const float*, const float*, int,
+                              double);
+
+float Convolve_C(const float* input, const float* k1, const float* k2,
+                 int kernel_size, double kernel_interpolation_factor);
+float Convolve_SSE(const float* input, const float* k1, const float* k2,
+                   int kernel_size, double kernel_interpolation_factor);
+float Convolve_NEON(const float* input, const float* k1, const float* k2,
+                    int kernel_size, double kernel_interpolation_factor);
+
+// Multiplies each of the |length| elements of |src| by |scale| and adds the
+// result to |dest|.
+typedef void (*FMACProc)(const float*, float, int, float*);
+
+void FMAC_C(const float* src, float scale, int length, float* dest);
+void FMAC_SSE(const float* src, float scale, int length, float* dest);
+void FMAC_NEON(const float* src, float scale, int length, float* dest);
+
+// Returns the sum of the products of the |length| elements of |a| and |b|.
+typedef float (*DotProductProc)(const float*, const float*, int);
+
+float DotProduct_C(const float* a, const float* b, int length);
+float DotProduct_SSE(const float* a, const float* b, int length);
+float DotProduct_NEON(const float* a, const float* b, int length);
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_SIMD_VECTOR_MATH_H_
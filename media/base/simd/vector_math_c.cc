@@ -0,0 +1,35 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/simd/vector_math.h"
+
+namespace media {
+
+float Convolve_C(const float* input, const float* k1, const float* k2,
+                 int kernel_size, double kernel_interpolation_factor) {
+  float sum1 = 0;
+  float sum2 = 0;
+  for (int i = 0; i < kernel_size; ++i) {
+    sum1 += input[i] * k1[i];
+    sum2 += input[i] * k2[i];
+  }
+
+  // Linearly interpolate the two "convolutions".
+  return static_cast<float>((1.0 - kernel_interpolation_factor) * sum1 +
+                            kernel_interpolation_factor * sum2);
+}
+
+void FMAC_C(const float* src, float scale, int length, float* dest) {
+  for (int i = 0; i < length; ++i)
+    dest[i] += src[i] * scale;
+}
+
+float DotProduct_C(const float* a, const float* b, int length) {
+  float sum = 0;
+  for (int i = 0; i < length; ++i)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+}  // namespace media
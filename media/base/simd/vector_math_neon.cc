@@ -0,0 +1,51 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <arm_neon.h>
+
+#include "media/base/simd/vector_math.h"
+
+namespace media {
+
+// Returns the sum of the four floats of |sums|.
+static inline float HorizontalSum(float32x4_t sums) {
+  float32x2_t half = vadd_f32(vget_low_f32(sums), vget_high_f32(sums));
+  return vget_lane_f32(vpadd_f32(half, half), 0);
+}
+
+float Convolve_NEON(const float* input, const float* k1, const float* k2,
+                    int kernel_size, double kernel_interpolation_factor) {
+  float32x4_t sums1 = vmovq_n_f32(0);
+  float32x4_t sums2 = vmovq_n_f32(0);
+
+  for (int i = 0; i < kernel_size; i += 4) {
+    float32x4_t m_input = vld1q_f32(input + i);
+    sums1 = vmlaq_f32(sums1, m_input, vld1q_f32(k1 + i));
+    sums2 = vmlaq_f32(sums2, m_input, vld1q_f32(k2 + i));
+  }
+
+  // Linearly interpolate the two "convolutions".
+  float sum1 = HorizontalSum(sums1);
+  float sum2 = HorizontalSum(sums2);
+  return static_cast<float>((1.0 - kernel_interpolation_factor) * sum1 +
+                            kernel_interpolation_factor * sum2);
+}
+
+void FMAC_NEON(const float* src, float scale, int length, float* dest) {
+  int i = 0;
+  for (; i + 4 <= length; i += 4)
+    vst1q_f32(dest + i, vmlaq_n_f32(vld1q_f32(dest + i), vld1q_f32(src + i),
+                                   scale));
+  FMAC_C(src + i, scale, length - i, dest + i);
+}
+
+float DotProduct_NEON(const float* a, const float* b, int length) {
+  float32x4_t sums = vmovq_n_f32(0);
+  int i = 0;
+  for (; i + 4 <= length; i += 4)
+    sums = vmlaq_f32(sums, vld1q_f32(a + i), vld1q_f32(b + i));
+  return HorizontalSum(sums) + DotProduct_C(a + i, b + i, length - i);
+}
+
+}  // namespace media
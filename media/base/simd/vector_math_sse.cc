@@ -0,0 +1,63 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <xmmintrin.h>
+#endif
+
+#include "media/base/simd/vector_math.h"
+
+namespace media {
+
+// Returns the sum of the four floats of |sums|.
+static inline float HorizontalSum(__m128 sums) {
+  sums = _mm_add_ps(_mm_movehl_ps(sums, sums), sums);
+  sums = _mm_add_ss(_mm_shuffle_ps(sums, sums, 1), sums);
+  float result;
+  _mm_store_ss(&result, sums);
+  return result;
+}
+
+float Convolve_SSE(const float* input, const float* k1, const float* k2,
+                   int kernel_size, double kernel_interpolation_factor) {
+  __m128 sums1 = _mm_setzero_ps();
+  __m128 sums2 = _mm_setzero_ps();
+
+  // The kernels are aligned, the input may not be.
+  for (int i = 0; i < kernel_size; i += 4) {
+    __m128 m_input = _mm_loadu_ps(input + i);
+    sums1 = _mm_add_ps(sums1, _mm_mul_ps(m_input, _mm_load_ps(k1 + i)));
+    sums2 = _mm_add_ps(sums2, _mm_mul_ps(m_input, _mm_load_ps(k2 + i)));
+  }
+
+  // Linearly interpolate the two "convolutions".
+  float sum1 = HorizontalSum(sums1);
+  float sum2 = HorizontalSum(sums2);
+  return static_cast<float>((1.0 - kernel_interpolation_factor) * sum1 +
+                            kernel_interpolation_factor * sum2);
+}
+
+void FMAC_SSE(const float* src, float scale, int length, float* dest) {
+  __m128 m_scale = _mm_set1_ps(scale);
+  int i = 0;
+  for (; i + 4 <= length; i += 4) {
+    _mm_storeu_ps(dest + i, _mm_add_ps(
+        _mm_loadu_ps(dest + i), _mm_mul_ps(_mm_loadu_ps(src + i), m_scale)));
+  }
+  FMAC_C(src + i, scale, length - i, dest + i);
+}
+
+float DotProduct_SSE(const float* a, const float* b, int length) {
+  __m128 sums = _mm_setzero_ps();
+  int i = 0;
+  for (; i + 4 <= length; i += 4) {
+    sums = _mm_add_ps(sums,
+                      _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+  return HorizontalSum(sums) + DotProduct_C(a + i, b + i, length - i);
+}
+
+}  // namespace media
@@ -0,0 +1,185 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Each channel's input buffer holds kKernelSize + request_frames frames. The
+// kernel for output frame i is centered on input frame i + kKernelSize / 2
+// of the buffer, so the buffer always keeps kKernelSize frames of history:
+//
+// 1) Prime the buffer with request_frames + kKernelSize / 2 frames, behind
+//    kKernelSize / 2 frames of silence.
+// 2) Convolve while the source index is below request_frames.
+// 3) Move the last kKernelSize frames to the start of the buffer and read
+//    request_frames new frames behind them.
+// 4) Go back to 2).
+
+#include "media/base/sinc_resampler.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "base/logging.h"
+#include "build/build_config.h"
+#include "media/base/cpu_features.h"
+
+namespace media {
+
+static const double kPi = 3.14159265358979323846;
+
+static ConvolveProc ChooseConvolveProc() {
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (hasSSE())
+    return &Convolve_SSE;
+#elif defined(__ARM_NEON__)
+  if (hasNEON())
+    return &Convolve_NEON;
+#endif
+  return &Convolve_C;
+}
+
+SincResampler::SincResampler(double io_sample_rate_ratio,
+                             int channels,
+                             int request_frames,
+                             const ReadCB& read_cb)
+    : io_sample_rate_ratio_(io_sample_rate_ratio),
+      virtual_source_idx_(0),
+      buffer_primed_(false),
+      read_cb_(read_cb),
+      request_frames_(request_frames),
+      kernel_storage_buffer_(new float[kKernelStorageSize + 3]),
+      input_buffers_(channels * (request_frames + kKernelSize)),
+      input_channels_(channels),
+      read_destination_(channels),
+      convolve_proc_(ChooseConvolveProc()) {
+  DCHECK_GT(io_sample_rate_ratio_, 0);
+  DCHECK_GT(channels, 0);
+  DCHECK_GT(request_frames_, static_cast<int>(kKernelSize));
+
+  kernel_storage_ = reinterpret_cast<float*>(
+      (reinterpret_cast<uintptr_t>(kernel_storage_buffer_.get()) + 15) & ~15);
+
+  for (int i = 0; i < channels; ++i) {
+    input_channels_[i] = &input_buffers_[i * (request_frames + kKernelSize)];
+    // The initial read fills r0, later reads fill r5.
+    read_destination_[i] = input_channels_[i] + kKernelSize / 2;
+  }
+
+  InitializeKernel();
+}
+
+SincResampler::~SincResampler() {}
+
+void SincResampler::InitializeKernel() {
+  // Blackman window parameters.
+  static const double kAlpha = 0.16;
+  static const double kA0 = 0.5 * (1.0 - kAlpha);
+  static const double kA1 = 0.5;
+  static const double kA2 = 0.5 * kAlpha;
+
+  // |sinc_scale_factor| is basically the normalized cutoff frequency of the
+  // low-pass filter.
+  double sinc_scale_factor =
+      io_sample_rate_ratio_ > 1.0 ? 1.0 / io_sample_rate_ratio_ : 1.0;
+
+  // The sinc function is an idealized brick-wall filter, but since we're
+  // windowing it the transition from pass to stop does not happen right
+  // away. So we should adjust the low pass filter cutoff slightly downward
+  // to avoid some aliasing at the very high-end.
+  sinc_scale_factor *= 0.9;
+
+  // Generates a set of windowed sinc() kernels.
+  // We generate a range of sub-sample offsets from 0.0 to 1.0.
+  for (int offset_idx = 0; offset_idx <= kKernelOffsetCount; ++offset_idx) {
+    double subsample_offset =
+        static_cast<double>(offset_idx) / kKernelOffsetCount;
+
+    for (int i = 0; i < kKernelSize; ++i) {
+      // Compute the sinc with offset.
+      double s =
+          sinc_scale_factor * kPi * (i - kKernelSize / 2 - subsample_offset);
+      double sinc = (!s ? 1.0 : sin(s) / s) * sinc_scale_factor;
+
+      // Compute Blackman window, matching the offset of the sinc().
+      double x = (i - subsample_offset) / kKernelSize;
+      double window = kA0 - kA1 * cos(2.0 * kPi * x) + kA2 *
+          cos(4.0 * kPi * x);
+
+      // Window the sinc() function and store at the correct offset.
+      kernel_storage_[i + offset_idx * kKernelSize] =
+          static_cast<float>(sinc * window);
+    }
+  }
+}
+
+void SincResampler::Resample(const std::vector<float*>& destination,
+                             int frames) {
+  DCHECK_EQ(input_channels_.size(), destination.size());
+  int channels = input_channels_.size();
+  int remaining_frames = frames;
+  int output_idx = 0;
+
+  // Step (1) -- Prime the input buffer at the start of the input stream.
+  if (!buffer_primed_) {
+    read_cb_.Run(read_destination_, request_frames_ + kKernelSize / 2);
+    for (int ch = 0; ch < channels; ++ch)
+      read_destination_[ch] = input_channels_[ch] + kKernelSize;
+    buffer_primed_ = true;
+  }
+
+  // Step (2) -- Resample!
+  while (remaining_frames) {
+    while (virtual_source_idx_ < request_frames_) {
+      // |virtual_source_idx_| lies in between two kernel offsets so figure
+      // out what they are.
+      int source_idx = static_cast<int>(virtual_source_idx_);
+      double subsample_remainder = virtual_source_idx_ - source_idx;
+
+      double virtual_offset_idx = subsample_remainder * kKernelOffsetCount;
+      int offset_idx = static_cast<int>(virtual_offset_idx);
+
+      // We'll compute "convolutions" for the two kernels which straddle
+      // |virtual_source_idx_|.
+      const float* k1 = kernel_storage_ + offset_idx * kKernelSize;
+      const float* k2 = k1 + kKernelSize;
+
+      // Figure out how much to weight each kernel's "convolution".
+      double kernel_interpolation_factor = virtual_offset_idx - offset_idx;
+
+      for (int ch = 0; ch < channels; ++ch) {
+        destination[ch][output_idx] = convolve_proc_(
+            input_channels_[ch] + source_idx, k1, k2, kKernelSize,
+            kernel_interpolation_factor);
+      }
+      ++output_idx;
+
+      // Advance the virtual index.
+      virtual_source_idx_ += io_sample_rate_ratio_;
+
+      if (!--remaining_frames)
+        return;
+    }
+
+    // Wrap back around to the start.
+    virtual_source_idx_ -= request_frames_;
+
+    // Step (3) -- Copy r3, r4 to r1, r2. This wraps the last input frames
+    // back to the start of the buffer.
+    for (int ch = 0; ch < channels; ++ch) {
+      memcpy(input_channels_[ch], input_channels_[ch] + request_frames_,
+             sizeof(float) * kKernelSize);
+    }
+
+    // Step (4) -- Refresh the buffer with more input.
+    read_cb_.Run(read_destination_, request_frames_);
+  }
+}
+
+void SincResampler::Flush() {
+  virtual_source_idx_ = 0;
+  buffer_primed_ = false;
+  memset(&input_buffers_[0], 0, sizeof(float) * input_buffers_.size());
+  for (size_t ch = 0; ch < input_channels_.size(); ++ch)
+    read_destination_[ch] = input_channels_[ch] + kKernelSize / 2;
+}
+
+}  // namespace media
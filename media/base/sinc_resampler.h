@@ -0,0 +1,97 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_SINC_RESAMPLER_H_
+#define MEDIA_BASE_SINC_RESAMPLER_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/memory/scoped_ptr.h"
+#include "media/base/media_export.h"
+#include "media/base/simd/vector_math.h"
+
+namespace media {
+
+// SincResampler is a high-quality sample-rate converter operating on planar
+// float samples. It uses a windowed sinc kernel, with the kernels for
+// fractional sample offsets precomputed and linearly interpolated.
+class MEDIA_EXPORT SincResampler {
+ public:
+  enum {
+    // The kernel size can be adjusted for quality (higher is better) at the
+    // expense of performance. It must be a multiple of 4 for the SIMD
+    // convolution kernels.
+    kKernelSize = 32,
+
+    // The number of precomputed kernel offsets between two input samples.
+    kKernelOffsetCount = 32,
+    kKernelStorageSize = kKernelSize * (kKernelOffsetCount + 1),
+
+    // The number of input frames requested at a time by default.
+    kDefaultRequestFrames = 512,
+  };
+
+  // Callback type for providing more data into the resampler. The callback
+  // must fill the |frames| first frames of every channel of |destination|.
+  typedef base::Callback<void(const std::vector<float*>& destination,
+                              int frames)> ReadCB;
+
+  // Constructs a SincResampler for |channels| channels with the specified
+  // |read_cb|, which is used to acquire audio data for resampling in chunks
+  // of |request_frames| frames, which must be larger than kKernelSize.
+  // |io_sample_rate_ratio| is the ratio of input / output sample rates.
+  SincResampler(double io_sample_rate_ratio,
+                int channels,
+                int request_frames,
+                const ReadCB& read_cb);
+  ~SincResampler();
+
+  // Resamples |frames| frames into each channel of |destination|.
+  void Resample(const std::vector<float*>& destination, int frames);
+
+  // Drops the buffered input, e.g. after a seek.
+  void Flush();
+
+ private:
+  void InitializeKernel();
+
+  // The ratio of input / output sample rates.
+  const double io_sample_rate_ratio_;
+
+  // An index on the source input buffer with sub-sample precision. It must be
+  // double precision to avoid drift.
+  double virtual_source_idx_;
+
+  // The buffer is primed once at the very beginning of processing.
+  bool buffer_primed_;
+
+  // Source of data for resampling.
+  const ReadCB read_cb_;
+
+  const int request_frames_;
+
+  // Contains kKernelOffsetCount + 1 kernels back-to-back, each of size
+  // kKernelSize. The kernel offsets are sub-sample shifts of a windowed sinc
+  // shifted from 0.0 to 1.0 sample. Aligned to 16 bytes for the SIMD kernels.
+  scoped_array<float> kernel_storage_buffer_;
+  float* kernel_storage_;
+
+  // Data from the source is copied into these buffers, one per channel, of
+  // |request_frames_| + kKernelSize frames each.
+  std::vector<float> input_buffers_;
+  std::vector<float*> input_channels_;
+
+  // Pointers to the start of the new input within each channel's buffer.
+  std::vector<float*> read_destination_;
+
+  ConvolveProc convolve_proc_;
+
+  DISALLOW_COPY_AND_ASSIGN(SincResampler);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_SINC_RESAMPLER_H_
@@ -0,0 +1,139 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <math.h>
+
+#include "base/bind.h"
+#include "base/memory/scoped_ptr.h"
+#include "build/build_config.h"
+#include "media/base/cpu_features.h"
+#include "media/base/sinc_resampler.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+static const double kPi = 3.14159265358979323846;
+static const double kFrequency = 1000.0;
+
+// Provides a sine wave on every channel, negated on odd channels.
+class SineSource {
+ public:
+  explicit SineSource(int sample_rate)
+      : sample_rate_(sample_rate),
+        frame_(0),
+        calls_(0) {
+  }
+
+  void Read(const std::vector<float*>& destination, int frames) {
+    ++calls_;
+    for (int i = 0; i < frames; ++i, ++frame_) {
+      float value = static_cast<float>(
+          sin(2.0 * kPi * kFrequency * frame_ / sample_rate_));
+      for (size_t ch = 0; ch < destination.size(); ++ch)
+        destination[ch][i] = ch & 1 ? -value : value;
+    }
+  }
+
+  int calls() const { return calls_; }
+
+ private:
+  int sample_rate_;
+  int frame_;
+  int calls_;
+};
+
+static void TestResampling(int input_rate, int output_rate) {
+  static const int kChannels = 2;
+  static const int kFrames = 4800;
+  SineSource source(input_rate);
+  SincResampler resampler(
+      static_cast<double>(input_rate) / output_rate, kChannels, 441,
+      base::Bind(&SineSource::Read, base::Unretained(&source)));
+
+  std::vector<float> left(kFrames);
+  std::vector<float> right(kFrames);
+  std::vector<float*> destination;
+  destination.push_back(&left[0]);
+  destination.push_back(&right[0]);
+  resampler.Resample(destination, kFrames);
+
+  // Skip the start, where the kernel still covers the initial silence.
+  for (int i = SincResampler::kKernelSize; i < kFrames; ++i) {
+    double expected = sin(2.0 * kPi * kFrequency * i / output_rate);
+    ASSERT_NEAR(expected, left[i], 0.001) << "frame " << i;
+    ASSERT_EQ(-left[i], right[i]) << "frame " << i;
+  }
+}
+
+TEST(SincResamplerTest, Upsample) {
+  TestResampling(44100, 48000);
+}
+
+TEST(SincResamplerTest, Downsample) {
+  TestResampling(48000, 44100);
+}
+
+TEST(SincResamplerTest, ReadsInRequestSizedChunks) {
+  SineSource source(48000);
+  SincResampler resampler(
+      1.0, 1, 480, base::Bind(&SineSource::Read, base::Unretained(&source)));
+  std::vector<float> output(480);
+  std::vector<float*> destination(1, &output[0]);
+
+  // The first read primes the buffer.
+  resampler.Resample(destination, 480);
+  EXPECT_EQ(1, source.calls());
+  resampler.Resample(destination, 480);
+  EXPECT_EQ(2, source.calls());
+
+  resampler.Flush();
+  resampler.Resample(destination, 1);
+  EXPECT_EQ(3, source.calls());
+}
+
+static void TestConvolve(ConvolveProc convolve_proc) {
+  // The SIMD versions need aligned kernels.
+  scoped_array<float> buffer(new float[3 * SincResampler::kKernelSize + 4]);
+  float* aligned = reinterpret_cast<float*>(
+      (reinterpret_cast<uintptr_t>(buffer.get()) + 15) & ~15);
+  float* k1 = aligned;
+  float* k2 = k1 + SincResampler::kKernelSize;
+  float* input = k2 + SincResampler::kKernelSize + 1;
+  for (int i = 0; i < SincResampler::kKernelSize; ++i) {
+    k1[i] = sin(static_cast<float>(i));
+    k2[i] = cos(static_cast<float>(i));
+    input[i] = 0.01f * i - 0.1f;
+  }
+
+  const double kFactors[] = { 0.0, 0.3, 1.0 };
+  for (size_t i = 0; i < arraysize(kFactors); ++i) {
+    EXPECT_NEAR(Convolve_C(input, k1, k2, SincResampler::kKernelSize,
+                           kFactors[i]),
+                convolve_proc(input, k1, k2, SincResampler::kKernelSize,
+                              kFactors[i]),
+                1e-5);
+  }
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+TEST(SincResamplerTest, ConvolveSSEMatchesC) {
+  if (!hasSSE()) {
+    LOG(WARNING) << "System not supported. Test skipped.";
+    return;
+  }
+  TestConvolve(&Convolve_SSE);
+}
+#endif
+
+#if defined(__ARM_NEON__)
+TEST(SincResamplerTest, ConvolveNEONMatchesC) {
+  if (!hasNEON()) {
+    LOG(WARNING) << "System not supported. Test skipped.";
+    return;
+  }
+  TestConvolve(&Convolve_NEON);
+}
+#endif
+
+}  // namespace media
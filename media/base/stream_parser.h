@@ -16,6 +16,7 @@
 namespace media {
 
 class AudioDecoderConfig;
+class DataBuffer;
 class StreamParserBuffer;
 class VideoDecoderConfig;
 
@@ -81,6 +82,11 @@ class MEDIA_EXPORT StreamParser {
   // Returns true if the parse succeeds.
   virtual bool Parse(const uint8* buf, int size) = 0;
 
+  // Same as Parse(), but the parsed stream buffers may reference the data of
+  // |buffer| instead of copying it. |buffer| must be padded like the buffers
+  // returned by DataBuffer::CopyFrom() and must not be modified afterwards.
+  virtual bool ParseBuffer(const scoped_refptr<DataBuffer>& buffer) = 0;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(StreamParser);
 };
@@ -4,14 +4,35 @@
 
 #include "media/base/stream_parser_buffer.h"
 
+#include "base/logging.h"
+
 namespace media {
 
 StreamParserBuffer::StreamParserBuffer(const uint8* data, int data_size,
                                        bool is_keyframe)
     : DataBuffer(data, data_size),
-      is_keyframe_(is_keyframe) {
+      is_keyframe_(is_keyframe),
+      slice_data_(NULL),
+      slice_size_(0) {
+}
+
+StreamParserBuffer::StreamParserBuffer(
+    const scoped_refptr<DataBuffer>& backing_buffer,
+    const uint8* data, int data_size, bool is_keyframe)
+    : DataBuffer(NULL, 0),
+      is_keyframe_(is_keyframe),
+      backing_buffer_(backing_buffer),
+      slice_data_(data),
+      slice_size_(data_size) {
+  DCHECK(backing_buffer_);
+  DCHECK_GT(data_size, 0);
+  DCHECK(data >= backing_buffer_->GetData());
+  DCHECK(data + data_size <=
+         backing_buffer_->GetData() + backing_buffer_->GetDataSize());
 }
 
+StreamParserBuffer::~StreamParserBuffer() {}
+
 scoped_refptr<StreamParserBuffer> StreamParserBuffer::CreateEOSBuffer() {
   return make_scoped_refptr(new StreamParserBuffer(NULL, 0, false));
 }
@@ -22,4 +43,29 @@ scoped_refptr<StreamParserBuffer> StreamParserBuffer::CopyFrom(
       new StreamParserBuffer(data, data_size, is_keyframe));
 }
 
+scoped_refptr<StreamParserBuffer> StreamParserBuffer::CreateSlice(
+    const scoped_refptr<DataBuffer>& backing_buffer,
+    const uint8* data, int data_size, bool is_keyframe) {
+  return make_scoped_refptr(
+      new StreamParserBuffer(backing_buffer, data, data_size, is_keyframe));
+}
+
+const uint8* StreamParserBuffer::GetData() const {
+  if (backing_buffer_)
+    return slice_data_;
+  return DataBuffer::GetData();
+}
+
+int StreamParserBuffer::GetDataSize() const {
+  if (backing_buffer_)
+    return slice_size_;
+  return DataBuffer::GetDataSize();
+}
+
+uint8* StreamParserBuffer::GetWritableData() {
+  if (backing_buffer_)
+    return NULL;
+  return DataBuffer::GetWritableData();
+}
+
 }  // namespace media
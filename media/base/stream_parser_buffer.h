@@ -15,11 +15,37 @@ class MEDIA_EXPORT StreamParserBuffer : public DataBuffer {
   static scoped_refptr<StreamParserBuffer> CreateEOSBuffer();
   static scoped_refptr<StreamParserBuffer> CopyFrom(
       const uint8* data, int data_size, bool is_keyframe);
+
+  // Creates a buffer for [data,data+data_size), which must lie within
+  // |backing_buffer|, without copying it. |backing_buffer| is kept alive and
+  // must not be modified while the returned buffer is in use. The bytes that
+  // follow |data| in |backing_buffer| stand in for the FFmpeg input padding,
+  // so the end of |backing_buffer| must be padded.
+  static scoped_refptr<StreamParserBuffer> CreateSlice(
+      const scoped_refptr<DataBuffer>& backing_buffer,
+      const uint8* data, int data_size, bool is_keyframe);
+
   bool IsKeyframe() const { return is_keyframe_; }
 
+  // DataBuffer implementation. Slices are read only, so GetWritableData()
+  // returns NULL for them.
+  virtual const uint8* GetData() const OVERRIDE;
+  virtual int GetDataSize() const OVERRIDE;
+  virtual uint8* GetWritableData() OVERRIDE;
+
  private:
   StreamParserBuffer(const uint8* data, int data_size, bool is_keyframe);
+  StreamParserBuffer(const scoped_refptr<DataBuffer>& backing_buffer,
+                     const uint8* data, int data_size, bool is_keyframe);
+  virtual ~StreamParserBuffer();
+
   bool is_keyframe_;
+
+  // Set for slices only.
+  scoped_refptr<DataBuffer> backing_buffer_;
+  const uint8* slice_data_;
+  int slice_size_;
+
   DISALLOW_COPY_AND_ASSIGN(StreamParserBuffer);
 };
 
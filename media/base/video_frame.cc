@@ -98,7 +98,8 @@ void VideoFrame::AllocateRGB(size_t bytes_per_pixel) {
   // is sufficient for MMX reads (movq).
   size_t bytes_per_row = RoundUp(width_ * bytes_per_pixel, 8);
   strides_[VideoFrame::kRGBPlane] = bytes_per_row;
-  data_[VideoFrame::kRGBPlane] = new uint8[bytes_per_row * height_];
+  allocation_ = new uint8[bytes_per_row * height_];
+  data_[VideoFrame::kRGBPlane] = allocation_;
   DCHECK(!(reinterpret_cast<intptr_t>(data_[VideoFrame::kRGBPlane]) & 7));
   COMPILE_ASSERT(0 == VideoFrame::kRGBPlane, RGB_data_must_be_index_0);
 }
@@ -107,23 +108,34 @@ static const int kFramePadBytes = 15;  // Allows faster SIMD YUV convert.
 
 void VideoFrame::AllocateYUV() {
   DCHECK(format_ == VideoFrame::YV12 || format_ == VideoFrame::YV16);
-  // Align Y rows at 32-bit (4 byte) boundaries.  The stride for both YV12 and
-  // YV16 is 1/2 of the stride of Y.  For YV12, every row of bytes for U and V
-  // applies to two rows of Y (one byte of UV for 4 bytes of Y), so in the
-  // case of YV12 the strides are identical for the same width surface, but the
-  // number of bytes allocated for YV12 is 1/2 the amount for U & V as YV16.
-  // We also round the height of the surface allocated to be an even number
-  // to avoid any potential of faulting by code that attempts to access the Y
-  // values of the final row, but assumes that the last row of U & V applies to
-  // a full two rows of Y.
-  size_t y_height = rows(VideoFrame::kYPlane);
-  size_t y_stride = RoundUp(row_bytes(VideoFrame::kYPlane), 4);
-  size_t uv_stride = RoundUp(row_bytes(VideoFrame::kUPlane), 4);
-  size_t uv_height = rows(VideoFrame::kUPlane);
+  // Align Y rows at 32 byte boundaries and U and V rows at 16 byte
+  // boundaries, which is what FFmpeg's SIMD code needs to decode directly
+  // into the frame. The stride for both YV12 and YV16 is 1/2 of the stride of
+  // Y.  For YV12, every row of bytes for U and V applies to two rows of Y
+  // (one byte of UV for 4 bytes of Y), so in the case of YV12 the strides are
+  // identical for the same width surface, but the number of bytes allocated
+  // for YV12 is 1/2 the amount for U & V as YV16.
+  // The height is rounded up to a multiple of 32 rows and padded, which
+  // covers the rows FFmpeg decodes past the visible height and avoids any
+  // potential of faulting by code that attempts to access the Y values of the
+  // final row, but assumes that the last row of U & V applies to a full two
+  // rows of Y.
+  size_t y_stride = RoundUp(row_bytes(VideoFrame::kYPlane),
+                            kFrameSizeAlignment * 2);
+  size_t uv_stride = RoundUp(row_bytes(VideoFrame::kUPlane),
+                             kFrameSizeAlignment);
+  size_t y_height = RoundUp(height_, kFrameSizeAlignment * 2) +
+      kFrameSizePadding * 2;
+  size_t uv_height = format_ == VideoFrame::YV12 ? y_height / 2 : y_height;
   size_t y_bytes = y_height * y_stride;
   size_t uv_bytes = uv_height * uv_stride;
 
-  uint8* data = new uint8[y_bytes + (uv_bytes * 2) + kFramePadBytes];
+  // The extra row of U and V is because H.264 chroma motion compensation
+  // reads one row past the plane in some cases.
+  allocation_ = new uint8[y_bytes + (uv_bytes * 2) + uv_stride +
+                          kFramePadBytes + kFrameAddressAlignment - 1];
+  uint8* data = reinterpret_cast<uint8*>(
+      RoundUp(reinterpret_cast<size_t>(allocation_), kFrameAddressAlignment));
   COMPILE_ASSERT(0 == VideoFrame::kYPlane, y_plane_data_must_be_index_0);
   data_[VideoFrame::kYPlane] = data;
   data_[VideoFrame::kUPlane] = data + y_bytes;
@@ -141,6 +153,7 @@ VideoFrame::VideoFrame(VideoFrame::Format format,
     : format_(format),
       width_(width),
       height_(height),
+      allocation_(NULL),
       texture_id_(0),
       texture_target_(0),
       timestamp_(timestamp),
@@ -156,9 +169,8 @@ VideoFrame::~VideoFrame() {
   }
 
   // In multi-plane allocations, only a single block of memory is allocated
-  // on the heap, and other |data| pointers point inside the same, single block
-  // so just delete index 0.
-  delete[] data_[0];
+  // on the heap, and the |data| pointers point inside the same, single block.
+  delete[] allocation_;
 }
 
 bool VideoFrame::IsValidPlane(size_t plane) const {
@@ -23,6 +23,17 @@ class MEDIA_EXPORT VideoFrame : public base::RefCountedThreadSafe<VideoFrame> {
     kVPlane = 2,
   };
 
+  // YUV frames are allocated with the alignment and padding FFmpeg needs to
+  // decode directly into them (see avcodec_align_dimensions2()): strides are
+  // multiples of kFrameSizeAlignment, the Y plane has at least
+  // kFrameSizePadding extra rows and every plane starts at an address that is
+  // a multiple of kFrameAddressAlignment.
+  enum {
+    kFrameSizeAlignment = 16,
+    kFrameSizePadding = 16,
+    kFrameAddressAlignment = 32,
+  };
+
   // Surface formats roughly based on FOURCC labels, see:
   // http://www.fourcc.org/rgb.php
   // http://www.fourcc.org/yuv.php
@@ -151,6 +162,10 @@ class MEDIA_EXPORT VideoFrame : public base::RefCountedThreadSafe<VideoFrame> {
   // Array of data pointers to each plane.
   uint8* data_[kMaxPlanes];
 
+  // The memory the planes point into. The planes of YUV frames do not start
+  // at the beginning of the allocation since they are aligned.
+  uint8* allocation_;
+
   // Native texture ID, if this is a NATIVE_TEXTURE frame.
   uint32 texture_id_;
   uint32 texture_target_;
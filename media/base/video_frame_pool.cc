@@ -0,0 +1,54 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/video_frame_pool.h"
+
+namespace media {
+
+VideoFramePool::VideoFramePool() {}
+
+VideoFramePool::~VideoFramePool() {}
+
+scoped_refptr<VideoFrame> VideoFramePool::CreateFrame(
+    VideoFrame::Format format,
+    size_t width,
+    size_t height,
+    base::TimeDelta timestamp,
+    base::TimeDelta duration) {
+  scoped_refptr<VideoFrame> frame;
+  FrameList::iterator it = frames_.begin();
+  while (it != frames_.end()) {
+    // Only the pool can hand out new references to its frames, so a frame
+    // that has no other references can not gain one behind our back.
+    if (!(*it)->HasOneRef()) {
+      ++it;
+      continue;
+    }
+    if ((*it)->format() != format || (*it)->width() != width ||
+        (*it)->height() != height) {
+      it = frames_.erase(it);
+      continue;
+    }
+    if (!frame)
+      frame = *it;
+    ++it;
+  }
+
+  if (!frame) {
+    frame = VideoFrame::CreateFrame(format, width, height, timestamp,
+                                    duration);
+    frames_.push_back(frame);
+    return frame;
+  }
+
+  frame->SetTimestamp(timestamp);
+  frame->SetDuration(duration);
+  return frame;
+}
+
+void VideoFramePool::Clear() {
+  frames_.clear();
+}
+
+}  // namespace media
@@ -0,0 +1,54 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_VIDEO_FRAME_POOL_H_
+#define MEDIA_BASE_VIDEO_FRAME_POOL_H_
+
+#include <list>
+
+#include "base/memory/ref_counted.h"
+#include "media/base/video_frame.h"
+
+namespace media {
+
+// Recycles the memory of video frames that have been released by everyone
+// else, so that decoders do not allocate a full frame for every picture.
+//
+// The pool keeps a reference to every frame it created; a frame can be
+// handed out again once the pool holds the only reference. Frames are reused
+// only for the same format and size, so frames of other sizes are dropped
+// when the pool sees them unused, e.g. after a resolution change.
+//
+// Not thread safe, but the frames it creates can be released on any thread.
+class MEDIA_EXPORT VideoFramePool {
+ public:
+  VideoFramePool();
+  ~VideoFramePool();
+
+  // Returns a frame like VideoFrame::CreateFrame(), reusing an unused frame
+  // of the same |format|, |width| and |height| if there is one. The contents
+  // of the frame are undefined.
+  scoped_refptr<VideoFrame> CreateFrame(VideoFrame::Format format,
+                                        size_t width,
+                                        size_t height,
+                                        base::TimeDelta timestamp,
+                                        base::TimeDelta duration);
+
+  // Forgets all the frames. Frames still in use are freed when they are
+  // released instead of returning to the pool.
+  void Clear();
+
+  // Returns the number of frames the pool keeps, in use or not.
+  size_t size() const { return frames_.size(); }
+
+ private:
+  typedef std::list<scoped_refptr<VideoFrame> > FrameList;
+  FrameList frames_;
+
+  DISALLOW_COPY_AND_ASSIGN(VideoFramePool);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_VIDEO_FRAME_POOL_H_
@@ -0,0 +1,61 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/video_frame_pool.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+static scoped_refptr<VideoFrame> CreateFrame(VideoFramePool* pool,
+                                             size_t width,
+                                             size_t height) {
+  return pool->CreateFrame(VideoFrame::YV12, width, height,
+                           base::TimeDelta::FromSeconds(1),
+                           base::TimeDelta::FromSeconds(2));
+}
+
+TEST(VideoFramePoolTest, ReusesReleasedFrames) {
+  VideoFramePool pool;
+  scoped_refptr<VideoFrame> frame = CreateFrame(&pool, 320, 240);
+  uint8* data = frame->data(VideoFrame::kYPlane);
+  frame = NULL;
+
+  frame = pool.CreateFrame(VideoFrame::YV12, 320, 240,
+                           base::TimeDelta::FromSeconds(3),
+                           base::TimeDelta::FromSeconds(4));
+  EXPECT_EQ(data, frame->data(VideoFrame::kYPlane));
+  EXPECT_EQ(base::TimeDelta::FromSeconds(3), frame->GetTimestamp());
+  EXPECT_EQ(base::TimeDelta::FromSeconds(4), frame->GetDuration());
+  EXPECT_EQ(1u, pool.size());
+}
+
+TEST(VideoFramePoolTest, DoesNotReuseFramesInUse) {
+  VideoFramePool pool;
+  scoped_refptr<VideoFrame> frame1 = CreateFrame(&pool, 320, 240);
+  scoped_refptr<VideoFrame> frame2 = CreateFrame(&pool, 320, 240);
+  EXPECT_NE(frame1.get(), frame2.get());
+  EXPECT_EQ(2u, pool.size());
+}
+
+TEST(VideoFramePoolTest, DropsFramesOfOtherSizes) {
+  VideoFramePool pool;
+  scoped_refptr<VideoFrame> frame = CreateFrame(&pool, 320, 240);
+  uint8* data = frame->data(VideoFrame::kYPlane);
+  frame = NULL;
+
+  frame = CreateFrame(&pool, 640, 480);
+  EXPECT_NE(data, frame->data(VideoFrame::kYPlane));
+  EXPECT_EQ(640u, frame->width());
+  EXPECT_EQ(1u, pool.size());
+}
+
+TEST(VideoFramePoolTest, ClearKeepsFramesInUseAlive) {
+  VideoFramePool pool;
+  scoped_refptr<VideoFrame> frame = CreateFrame(&pool, 320, 240);
+  pool.Clear();
+  EXPECT_EQ(0u, pool.size());
+  EXPECT_TRUE(frame->HasOneRef());
+}
+
+}  // namespace media
@@ -209,4 +209,20 @@ TEST(VideoFrame, CheckFrameExtents) {
       VideoFrame::YV16,   3, 1, "9bb99ac3ff350644ebff4d28dc01b461");
 }
 
+// FFmpeg decodes directly into YUV frames, which requires aligned planes and
+// strides.
+TEST(VideoFrame, YUVPlanesAreAligned) {
+  const VideoFrame::Format kFormats[] = { VideoFrame::YV12, VideoFrame::YV16 };
+  for (size_t i = 0; i < arraysize(kFormats); ++i) {
+    scoped_refptr<VideoFrame> frame = VideoFrame::CreateFrame(
+        kFormats[i], 61, 31, base::TimeDelta(), base::TimeDelta());
+    for (int plane = 0; plane < VideoFrame::kMaxPlanes; ++plane) {
+      SCOPED_TRACE(base::StringPrintf("Checking plane %d", plane));
+      EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(frame->data(plane)) %
+                VideoFrame::kFrameAddressAlignment);
+      EXPECT_EQ(0, frame->stride(plane) % VideoFrame::kFrameSizeAlignment);
+    }
+  }
+}
+
 }  // namespace media
@@ -41,6 +41,9 @@ static FilterYUVRowsProc ChooseFilterYUVRowsProc() {
     return &FilterYUVRows_SSE2;
   if (hasMMX())
     return &FilterYUVRows_MMX;
+#elif defined(__ARM_NEON__)
+  if (hasNEON())
+    return &FilterYUVRows_NEON;
 #endif
   return &FilterYUVRows_C;
 }
@@ -51,6 +54,9 @@ static ConvertYUVToRGB32RowProc ChooseConvertYUVToRGB32RowProc() {
     return &ConvertYUVToRGB32Row_SSE;
   if (hasMMX())
     return &ConvertYUVToRGB32Row_MMX;
+#elif defined(__ARM_NEON__)
+  if (hasNEON())
+    return &ConvertYUVToRGB32Row_NEON;
 #endif
   return &ConvertYUVToRGB32Row_C;
 }
@@ -65,6 +71,9 @@ static ScaleYUVToRGB32RowProc ChooseScaleYUVToRGB32RowProc() {
     return &ScaleYUVToRGB32Row_SSE;
   if (hasMMX())
     return &ScaleYUVToRGB32Row_MMX;
+#elif defined(__ARM_NEON__)
+  if (hasNEON())
+    return &ScaleYUVToRGB32Row_NEON;
 #endif  // defined(ARCH_CPU_X86_64)
   return &ScaleYUVToRGB32Row_C;
 }
@@ -536,6 +545,14 @@ void ConvertYUVToRGB32(const uint8* yplane,
                        int rgbstride,
                        YUVType yuv_type) {
 #if defined(ARCH_CPU_ARM_FAMILY)
+#if defined(__ARM_NEON__)
+  if (hasNEON()) {
+    ConvertYUVToRGB32_NEON(yplane, uplane, vplane, rgbframe,
+                           width, height, ystride, uvstride, rgbstride,
+                           yuv_type);
+    return;
+  }
+#endif
   ConvertYUVToRGB32_C(yplane, uplane, vplane, rgbframe,
                       width, height, ystride, uvstride, rgbstride, yuv_type);
 #else
@@ -893,3 +893,116 @@ TEST(YUVConvertTest, LinearScaleYUVToRGB32Row_MMX_X64) {
 #endif  // defined(ARCH_CPU_X86_64)
 
 #endif  // defined(ARCH_CPU_X86_FAMILY)
+
+#if defined(__ARM_NEON__)
+
+TEST(YUVConvertTest, ConvertYUVToRGB32Row_NEON) {
+  if (!media::hasNEON()) {
+    LOG(WARNING) << "System not supported. Test skipped.";
+    return;
+  }
+
+  scoped_array<uint8> yuv_bytes(new uint8[kYUV12Size]);
+  scoped_array<uint8> rgb_bytes_reference(new uint8[kRGBSize]);
+  scoped_array<uint8> rgb_bytes_converted(new uint8[kRGBSize]);
+  ReadYV12Data(&yuv_bytes);
+
+  const int kWidth = 167;
+  ConvertYUVToRGB32Row_C(yuv_bytes.get(),
+                         yuv_bytes.get() + kSourceUOffset,
+                         yuv_bytes.get() + kSourceVOffset,
+                         rgb_bytes_reference.get(),
+                         kWidth);
+  ConvertYUVToRGB32Row_NEON(yuv_bytes.get(),
+                            yuv_bytes.get() + kSourceUOffset,
+                            yuv_bytes.get() + kSourceVOffset,
+                            rgb_bytes_converted.get(),
+                            kWidth);
+  EXPECT_EQ(0, memcmp(rgb_bytes_reference.get(),
+                      rgb_bytes_converted.get(),
+                      kWidth * kBpp));
+}
+
+TEST(YUVConvertTest, ScaleYUVToRGB32Row_NEON) {
+  if (!media::hasNEON()) {
+    LOG(WARNING) << "System not supported. Test skipped.";
+    return;
+  }
+
+  scoped_array<uint8> yuv_bytes(new uint8[kYUV12Size]);
+  scoped_array<uint8> rgb_bytes_reference(new uint8[kRGBSize]);
+  scoped_array<uint8> rgb_bytes_converted(new uint8[kRGBSize]);
+  ReadYV12Data(&yuv_bytes);
+
+  const int kWidth = 167;
+  const int kSourceDx = 80000;  // This value means a scale down.
+  ScaleYUVToRGB32Row_C(yuv_bytes.get(),
+                       yuv_bytes.get() + kSourceUOffset,
+                       yuv_bytes.get() + kSourceVOffset,
+                       rgb_bytes_reference.get(),
+                       kWidth,
+                       kSourceDx);
+  ScaleYUVToRGB32Row_NEON(yuv_bytes.get(),
+                          yuv_bytes.get() + kSourceUOffset,
+                          yuv_bytes.get() + kSourceVOffset,
+                          rgb_bytes_converted.get(),
+                          kWidth,
+                          kSourceDx);
+  EXPECT_EQ(0, memcmp(rgb_bytes_reference.get(),
+                      rgb_bytes_converted.get(),
+                      kWidth * kBpp));
+}
+
+TEST(YUVConvertTest, FilterYUVRows_NEON_OutOfBounds) {
+  if (!media::hasNEON()) {
+    LOG(WARNING) << "System not supported. Test skipped.";
+    return;
+  }
+
+  scoped_array<uint8> src(new uint8[16]);
+  scoped_array<uint8> dst(new uint8[16]);
+
+  memset(src.get(), 0xff, 16);
+  memset(dst.get(), 0, 16);
+
+  media::FilterYUVRows_NEON(dst.get(), src.get(), src.get(), 1, 255);
+
+  EXPECT_EQ(255u, dst[0]);
+  for (int i = 1; i < 16; ++i) {
+    EXPECT_EQ(0u, dst[i]);
+  }
+}
+
+TEST(YUVConvertTest, FilterYUVRows_NEON_MatchReference) {
+  if (!media::hasNEON()) {
+    LOG(WARNING) << "System not supported. Test skipped.";
+    return;
+  }
+
+  const int kSize = 64;
+  scoped_array<uint8> src0(new uint8[kSize]);
+  scoped_array<uint8> src1(new uint8[kSize]);
+  scoped_array<uint8> dst_sample(new uint8[kSize]);
+  scoped_array<uint8> dst(new uint8[kSize]);
+
+  for (int i = 0; i < kSize; ++i) {
+    src0[i] = 100 + i;
+    src1[i] = 255 - 3 * i;
+  }
+
+  // Odd sizes and the extreme fractions exercise the scalar tail and the
+  // 16-bit weights.
+  const int kFractions[] = { 0, 1, 128, 255 };
+  for (size_t i = 0; i < arraysize(kFractions); ++i) {
+    memset(dst_sample.get(), 0, kSize);
+    memset(dst.get(), 0, kSize);
+    media::FilterYUVRows_C(dst_sample.get(),
+                           src0.get(), src1.get(), 37, kFractions[i]);
+    // Generate an unaligned output address.
+    media::FilterYUVRows_NEON(dst.get() + 1,
+                              src0.get(), src1.get(), 37, kFractions[i]);
+    EXPECT_EQ(0, memcmp(dst_sample.get(), dst.get() + 1, 37));
+  }
+}
+
+#endif  // defined(__ARM_NEON__)
@@ -6,11 +6,14 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
 
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "build/build_config.h"
 #include "media/audio/audio_util.h"
 #include "media/base/buffers.h"
+#include "media/base/cpu_features.h"
 
 namespace media {
 
@@ -29,12 +32,38 @@ static const double kWindowDuration = 0.08;
 // Duration of crossfade between audio segments (in seconds).
 static const double kCrossfadeDuration = 0.008;
 
+// How far the intro segment of a crossfade may be moved to line up with the
+// outtro (in seconds). A bit more than the period of the lowest voice pitches.
+static const double kSearchDuration = 0.005;
+
+static const double kPi = 3.14159265358979323846;
+
 // Max/min supported playback rates for fast/slow audio. Audio outside of these
 // ranges are muted.
 // Audio at these speeds would sound better under a frequency domain algorithm.
 static const float kMinPlaybackRate = 0.5f;
 static const float kMaxPlaybackRate = 4.0f;
 
+static DotProductProc ChooseDotProductProc() {
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (hasSSE())
+    return &DotProduct_SSE;
+#elif defined(__ARM_NEON__)
+  if (hasNEON())
+    return &DotProduct_NEON;
+#endif
+  return &DotProduct_C;
+}
+
+// Converts |samples| samples of |source| to floats centered on zero.
+template <class Type>
+static void DoConvertToFloat(const uint8* source, int samples, float bias,
+                             float* dest) {
+  const Type* typed_source = reinterpret_cast<const Type*>(source);
+  for (int i = 0; i < samples; ++i)
+    dest[i] = typed_source[i] - bias;
+}
+
 AudioRendererAlgorithm::AudioRendererAlgorithm()
     : channels_(0),
       samples_per_second_(0),
@@ -47,6 +76,11 @@ AudioRendererAlgorithm::AudioRendererAlgorithm()
       crossfade_frame_number_(0),
       muted_(false),
       needs_more_data_(false),
+      search_range_(0),
+      dot_product_proc_(ChooseDotProductProc()),
+      intro_found_(false),
+      bytes_to_skip_after_window_(0),
+      input_drift_(0),
       window_size_(0) {
 }
 
@@ -102,6 +136,21 @@ void AudioRendererAlgorithm::Initialize(
   AlignToFrameBoundary(&bytes_in_crossfade_);
 
   crossfade_buffer_.reset(new uint8[bytes_in_crossfade_]);
+
+  search_range_ = samples_per_second_ * bytes_per_frame_ * kSearchDuration;
+  AlignToFrameBoundary(&search_range_);
+
+  int search_buffer_size = bytes_in_crossfade_ + 2 * search_range_;
+  search_buffer_.reset(new uint8[search_buffer_size]);
+  target_samples_.reset(new float[bytes_in_crossfade_ / bytes_per_channel_]);
+  candidate_samples_.reset(new float[search_buffer_size / bytes_per_channel_]);
+
+  // A raised cosine window keeps the loudness steady through the crossfade of
+  // two segments whose waveforms line up.
+  int frames_in_crossfade = bytes_in_crossfade_ / bytes_per_frame_;
+  crossfade_window_.reset(new float[frames_in_crossfade]);
+  for (int i = 0; i < frames_in_crossfade; ++i)
+    crossfade_window_[i] = 0.5 * (1.0 - cos(kPi * i / frames_in_crossfade));
 }
 
 int AudioRendererAlgorithm::FillBuffer(
@@ -140,6 +189,8 @@ void AudioRendererAlgorithm::ResetWindow() {
   DCHECK_LE(index_into_window_, window_size_);
   index_into_window_ = 0;
   crossfade_frame_number_ = 0;
+  intro_found_ = false;
+  bytes_to_skip_after_window_ = 0;
 }
 
 bool AudioRendererAlgorithm::OutputFasterPlayback(uint8* dest) {
@@ -158,7 +209,8 @@ bool AudioRendererAlgorithm::OutputFasterPlayback(uint8* dest) {
   //  d) Output crossfaded audio leading up to the next window.
   //
   // The duration of each phase is computed below based on the |window_size_|
-  // and |playback_rate_|.
+  // and |playback_rate_|. Phase c) drops up to |search_range_| bytes more or
+  // less than that so that the intro of phase d) lines up with the outtro.
   int input_step = window_size_;
   int output_step = ceil(window_size_ / playback_rate_);
   AlignToFrameBoundary(&output_step);
@@ -200,7 +252,41 @@ bool AudioRendererAlgorithm::OutputFasterPlayback(uint8* dest) {
     index_into_window_ += bytes_per_frame_;
   }
 
-  // c) Drop frames until we reach the intro crossfade section.
+  // c) Drop the frames before the intro segment most similar to the outtro,
+  //    looking within |search_range_| of where the playback rate puts it.
+  if (!intro_found_ && bytes_to_crossfade > 0 &&
+      intro_crossfade_begin >= outtro_crossfade_end) {
+    // Offsets from the current position of |audio_buffer_|.
+    int nominal_offset = intro_crossfade_begin - outtro_crossfade_end;
+    int ideal_offset = nominal_offset - input_drift_;
+    int first_offset = std::max(ideal_offset - search_range_, 0);
+    int last_offset = std::max(ideal_offset + search_range_, first_offset);
+    if (audio_buffer_.forward_bytes() < first_offset + bytes_to_crossfade)
+      return false;
+    int available = audio_buffer_.forward_bytes() - bytes_to_crossfade;
+    AlignToFrameBoundary(&available);
+    last_offset = std::min(last_offset, available);
+
+    int candidate_bytes = last_offset - first_offset + bytes_to_crossfade;
+    int copied = audio_buffer_.Peek(search_buffer_.get(), candidate_bytes,
+                                    first_offset);
+    DCHECK_EQ(candidate_bytes, copied);
+    ConvertToFloat(crossfade_buffer_.get(), bytes_to_crossfade,
+                   target_samples_.get());
+    ConvertToFloat(search_buffer_.get(), candidate_bytes,
+                   candidate_samples_.get());
+    int intro_offset = first_offset +
+        FindBestMatch(candidate_bytes, ideal_offset - first_offset);
+
+    audio_buffer_.Seek(intro_offset);
+    if (!IsQueueFull())
+      request_read_cb_.Run();
+    input_drift_ += intro_offset - nominal_offset;
+    index_into_window_ = intro_crossfade_begin;
+    intro_found_ = true;
+  }
+
+  // Without a crossfade, drop frames until we reach the end of the window.
   while (index_into_window_ < intro_crossfade_begin) {
     if (audio_buffer_.forward_bytes() < bytes_per_frame_)
       return false;
@@ -251,7 +337,10 @@ bool AudioRendererAlgorithm::OutputSlowerPlayback(uint8* dest) {
   // |audio_buffer_|'s cursor is in the correct place for the next window.
   //
   // The duration of each phase is computed below based on the |window_size_|
-  // and |playback_rate_|.
+  // and |playback_rate_|. Phases a) and b) stop up to |search_range_| bytes
+  // short of that, so that the intro segment of phase d) can be picked among
+  // the positions on either side of where the next window should start. The
+  // cursor skips to the end of the chosen intro when the window ends.
   int input_step = ceil(window_size_ * playback_rate_);
   AlignToFrameBoundary(&input_step);
   int output_step = window_size_;
@@ -261,11 +350,17 @@ bool AudioRendererAlgorithm::OutputSlowerPlayback(uint8* dest) {
   if (muted_ || bytes_to_crossfade > input_step)
     bytes_to_crossfade = 0;
 
+  bool search_intro = bytes_to_crossfade > 0 &&
+      input_step <= output_step - bytes_to_crossfade;
+  int held_back = 0;
+  if (search_intro)
+    held_back = std::min(search_range_, input_step - bytes_to_crossfade);
+
   // This is the index of the end of phase a, beginning of phase b.
-  int intro_crossfade_begin = input_step - bytes_to_crossfade;
+  int intro_crossfade_begin = input_step - held_back - bytes_to_crossfade;
 
   // This is the index of the end of phase b, beginning of phase c.
-  int intro_crossfade_end = input_step;
+  int intro_crossfade_end = input_step - held_back;
 
   // This is the index of the end of phase c,  beginning of phase d.
   // This phase continues until |index_into_window_| reaches |window_size_|, at
@@ -295,6 +390,54 @@ bool AudioRendererAlgorithm::OutputSlowerPlayback(uint8* dest) {
   if (audio_buffer_.forward_bytes() < audio_buffer_offset + bytes_per_frame_)
     return false;
 
+  // Before the first crossfaded frame, replace the intro in
+  // |crossfade_buffer_| with the segment most similar to the outtro.
+  if (search_intro && !intro_found_ &&
+      index_into_window_ >= outtro_crossfade_begin) {
+    int outtro_offset = outtro_crossfade_begin - intro_crossfade_end;
+    if (audio_buffer_.forward_bytes() < outtro_offset + bytes_to_crossfade)
+      return false;
+    int copied = audio_buffer_.Peek(search_buffer_.get(), bytes_to_crossfade,
+                                    outtro_offset);
+    DCHECK_EQ(bytes_to_crossfade, copied);
+    ConvertToFloat(search_buffer_.get(), bytes_to_crossfade,
+                   target_samples_.get());
+
+    // Offsets from the start of |crossfade_buffer_|, which holds the
+    // |bytes_to_crossfade| bytes before the cursor of |audio_buffer_|.
+    int nominal_offset = held_back;
+    int ideal_offset = nominal_offset - input_drift_;
+    int first_offset = std::max(ideal_offset - search_range_, 0);
+    int last_offset = std::max(ideal_offset + search_range_, first_offset);
+    int available = audio_buffer_.forward_bytes();
+    AlignToFrameBoundary(&available);
+    if (available < first_offset)
+      return false;
+    last_offset = std::min(last_offset, available);
+
+    int candidate_bytes = last_offset - first_offset + bytes_to_crossfade;
+    int saved_bytes = std::max(bytes_to_crossfade - first_offset, 0);
+    if (saved_bytes > 0) {
+      memcpy(search_buffer_.get(), crossfade_buffer_.get() + first_offset,
+             saved_bytes);
+    }
+    int peek_offset = first_offset + saved_bytes - bytes_to_crossfade;
+    copied = audio_buffer_.Peek(search_buffer_.get() + saved_bytes,
+                                candidate_bytes - saved_bytes, peek_offset);
+    DCHECK_EQ(candidate_bytes - saved_bytes, copied);
+    ConvertToFloat(search_buffer_.get(), candidate_bytes,
+                   candidate_samples_.get());
+    int best_offset =
+        FindBestMatch(candidate_bytes, ideal_offset - first_offset);
+    memcpy(crossfade_buffer_.get(), search_buffer_.get() + best_offset,
+           bytes_to_crossfade);
+
+    int intro_offset = first_offset + best_offset;
+    bytes_to_skip_after_window_ = intro_offset;
+    input_drift_ += intro_offset - nominal_offset;
+    intro_found_ = true;
+  }
+
   // c) Output a raw frame into |dest| without advancing the |audio_buffer_|
   //    cursor. See function-level comment.
   DCHECK_GE(index_into_window_, intro_crossfade_end);
@@ -311,6 +454,14 @@ bool AudioRendererAlgorithm::OutputSlowerPlayback(uint8* dest) {
   }
 
   index_into_window_ += bytes_per_frame_;
+
+  // Move on to the end of the intro the next window continues from.
+  if (index_into_window_ == window_size_ && bytes_to_skip_after_window_ > 0) {
+    audio_buffer_.Seek(bytes_to_skip_after_window_);
+    bytes_to_skip_after_window_ = 0;
+    if (!IsQueueFull())
+      request_read_cb_.Run();
+  }
   return true;
 }
 
@@ -349,6 +500,53 @@ void AudioRendererAlgorithm::DropFrame() {
     request_read_cb_.Run();
 }
 
+void AudioRendererAlgorithm::ConvertToFloat(
+    const uint8* source, int bytes, float* dest) {
+  int samples = bytes / bytes_per_channel_;
+  switch (bytes_per_channel_) {
+    case 4:
+      DoConvertToFloat<int32>(source, samples, 0, dest);
+      break;
+    case 2:
+      DoConvertToFloat<int16>(source, samples, 0, dest);
+      break;
+    case 1:
+      DoConvertToFloat<uint8>(source, samples, 128, dest);
+      break;
+    default:
+      NOTREACHED() << "Unsupported audio bit depth in search.";
+  }
+}
+
+int AudioRendererAlgorithm::FindBestMatch(int candidate_bytes,
+                                          int preferred_offset) {
+  DCHECK_GE(candidate_bytes, bytes_in_crossfade_);
+  int samples = bytes_in_crossfade_ / bytes_per_channel_;
+  int candidates = (candidate_bytes - bytes_in_crossfade_) / bytes_per_frame_;
+  int preferred_frame = preferred_offset / bytes_per_frame_;
+
+  // Normalized cross-correlation: the target's own energy is the same for
+  // every candidate, so only the candidate's is divided out.
+  int best_frame = 0;
+  float best_score = 0;
+  for (int frame = 0; frame <= candidates; ++frame) {
+    const float* candidate = candidate_samples_.get() + frame * channels_;
+    float energy = dot_product_proc_(candidate, candidate, samples);
+    float score = 0;
+    if (energy > 0) {
+      score = dot_product_proc_(target_samples_.get(), candidate, samples) /
+          sqrt(energy);
+    }
+    if (frame == 0 || score > best_score ||
+        (score == best_score && std::abs(frame - preferred_frame) <
+                                    std::abs(best_frame - preferred_frame))) {
+      best_frame = frame;
+      best_score = score;
+    }
+  }
+  return best_frame * bytes_per_frame_;
+}
+
 void AudioRendererAlgorithm::OutputCrossfadedFrame(
     uint8* outtro, const uint8* intro) {
   DCHECK_LE(index_into_window_, window_size_);
@@ -375,9 +573,8 @@ void AudioRendererAlgorithm::CrossfadeFrame(
   Type* outtro = reinterpret_cast<Type*>(outtro_bytes);
   const Type* intro = reinterpret_cast<const Type*>(intro_bytes);
 
-  int frames_in_crossfade = bytes_in_crossfade_ / bytes_per_frame_;
-  float crossfade_ratio =
-      static_cast<float>(crossfade_frame_number_) / frames_in_crossfade;
+  DCHECK_LT(crossfade_frame_number_, bytes_in_crossfade_ / bytes_per_frame_);
+  float crossfade_ratio = crossfade_window_[crossfade_frame_number_];
   for (int channel = 0; channel < channels_; ++channel) {
     *outtro *= 1.0 - crossfade_ratio;
     *outtro++ += (*intro++) * crossfade_ratio;
@@ -390,6 +587,7 @@ void AudioRendererAlgorithm::SetPlaybackRate(float new_rate) {
   playback_rate_ = new_rate;
   muted_ =
       playback_rate_ < kMinPlaybackRate || playback_rate_ > kMaxPlaybackRate;
+  input_drift_ = 0;
 
   ResetWindow();
 }
@@ -400,6 +598,7 @@ void AudioRendererAlgorithm::AlignToFrameBoundary(int* value) {
 
 void AudioRendererAlgorithm::FlushBuffers() {
   ResetWindow();
+  input_drift_ = 0;
 
   // Clear the queue of decoded packets (releasing the buffers).
   audio_buffer_.Clear();
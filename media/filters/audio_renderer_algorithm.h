@@ -13,9 +13,12 @@
 // This class is *not* thread-safe. Calls to enqueue and retrieve data must be
 // locked if called from multiple threads.
 //
-// AudioRendererAlgorithm uses a simple pitch-preservation algorithm to
+// AudioRendererAlgorithm uses WSOLA (Waveform Similarity Overlap-Add) to
 // stretch and compress audio data to meet playback speeds less than and
-// greater than the natural playback of the audio stream.
+// greater than the natural playback of the audio stream: the segments that are
+// overlapped are chosen among nearby positions of the input so that they line
+// up with the waveform they are blended into, which avoids the echoes and
+// phasing of plain Overlap-Add.
 //
 // Audio at very low or very high playback rates are muted to preserve quality.
 
@@ -25,6 +28,7 @@
 #include "base/callback.h"
 #include "base/gtest_prod_util.h"
 #include "media/base/seekable_buffer.h"
+#include "media/base/simd/vector_math.h"
 
 namespace media {
 
@@ -143,7 +147,16 @@ class MEDIA_EXPORT AudioRendererAlgorithm {
   // Moves the |audio_buffer_| forward by one frame.
   void DropFrame();
 
-  // Does a linear crossfade from |intro| into |outtro| for one frame.
+  // Converts |bytes| of audio data from |source| to floats in |dest|.
+  void ConvertToFloat(const uint8* source, int bytes, float* dest);
+
+  // Returns the offset in bytes into the |candidate_bytes| of audio data in
+  // |candidate_samples_| of the |bytes_in_crossfade_| long segment whose
+  // waveform is the most similar to |target_samples_|. Of equally similar
+  // segments, the one closest to |preferred_offset| wins.
+  int FindBestMatch(int candidate_bytes, int preferred_offset);
+
+  // Does a raised cosine crossfade from |intro| into |outtro| for one frame.
   // Assumes pointers are valid and are at least size of |bytes_per_frame_|.
   void OutputCrossfadedFrame(uint8* outtro, const uint8* intro);
   template <class Type>
@@ -192,6 +205,32 @@ class MEDIA_EXPORT AudioRendererAlgorithm {
   // Temporary buffer to hold crossfade data.
   scoped_array<uint8> crossfade_buffer_;
 
+  // How far, in bytes, the start of the intro segment may move away from where
+  // the playback rate would put it, in either direction.
+  int search_range_;
+
+  // Audio data around the possible intro segments, and the float samples
+  // FindBestMatch() compares.
+  scoped_array<uint8> search_buffer_;
+  scoped_array<float> target_samples_;
+  scoped_array<float> candidate_samples_;
+  DotProductProc dot_product_proc_;
+
+  // True once the intro segment of the current window has been chosen.
+  bool intro_found_;
+
+  // For slower playback, the bytes |audio_buffer_| skips at the end of the
+  // current window to start the next one right after the intro segment.
+  int bytes_to_skip_after_window_;
+
+  // How many bytes more than the playback rate asks for were consumed since
+  // the rate was set. The search for the next intro segment is centered on
+  // the position that brings it back to zero, so the rate does not drift.
+  int input_drift_;
+
+  // Gain of the intro for each frame of a crossfade.
+  scoped_array<float> crossfade_window_;
+
   // Window size, in bytes (calculated from audio properties).
   int window_size_;
 
@@ -0,0 +1,98 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times AudioRendererAlgorithm at the playback rates users pick. Every run
+// consumes one second of input audio, so the "_cpu" results are the CPU time
+// spent per second of media.
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/bind.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/stringprintf.h"
+#include "base/test/perf_benchmark.h"
+#include "media/base/data_buffer.h"
+#include "media/filters/audio_renderer_algorithm.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+const int kSamplesPerSecond = 44100;
+const int kChannels = 2;
+const int kBitsPerChannel = 16;
+const int kBytesPerFrame = kChannels * kBitsPerChannel / 8;
+
+// Sizes of the buffers read from the source and rendered to the device.
+const int kInputBytes = 8192;
+const int kOutputFrames = 2048;
+
+// Feeds an AudioRendererAlgorithm two tones for as long as it asks for data.
+class ToneSource {
+ public:
+  ToneSource() : algorithm_(NULL), frames_(0) {}
+
+  void set_algorithm(AudioRendererAlgorithm* algorithm) {
+    algorithm_ = algorithm;
+  }
+
+  void Read() {
+    scoped_array<uint8> data(new uint8[kInputBytes]);
+    int16* samples = reinterpret_cast<int16*>(data.get());
+    for (int i = 0; i < kInputBytes / kBytesPerFrame; ++i, ++frames_) {
+      double time = static_cast<double>(frames_) / kSamplesPerSecond;
+      int16 value = 8000 * sin(2 * kPi * 220 * time) +
+          4000 * sin(2 * kPi * 1375 * time);
+      for (int channel = 0; channel < kChannels; ++channel)
+        samples[i * kChannels + channel] = value;
+    }
+    algorithm_->EnqueueBuffer(new DataBuffer(data.Pass(), kInputBytes));
+  }
+
+ private:
+  AudioRendererAlgorithm* algorithm_;
+  int64 frames_;
+
+  DISALLOW_COPY_AND_ASSIGN(ToneSource);
+};
+
+// Renders as many frames as one second of input makes at the current rate.
+void RenderOneSecond(AudioRendererAlgorithm* algorithm, uint8* output) {
+  int frames = kSamplesPerSecond / algorithm->playback_rate();
+  while (frames > 0) {
+    int rendered =
+        algorithm->FillBuffer(output, std::min(frames, kOutputFrames));
+    CHECK_GT(rendered, 0);
+    frames -= rendered;
+  }
+}
+
+}  // namespace
+
+TEST(AudioRendererAlgorithmPerfTest, PlaybackRates) {
+  const float kPlaybackRates[] = { 0.5f, 0.75f, 1.0f, 1.25f, 1.5f, 2.0f, 3.0f };
+  scoped_array<uint8> output(new uint8[kOutputFrames * kBytesPerFrame]);
+
+  for (size_t i = 0; i < arraysize(kPlaybackRates); ++i) {
+    ToneSource source;
+    AudioRendererAlgorithm algorithm;
+    source.set_algorithm(&algorithm);
+    algorithm.Initialize(kChannels, kSamplesPerSecond, kBitsPerChannel,
+                         kPlaybackRates[i],
+                         base::Bind(&ToneSource::Read,
+                                    base::Unretained(&source)));
+    source.Read();
+
+    base::PerfBenchmark benchmark(
+        base::StringPrintf("AudioRendererAlgorithm_%.2fx", kPlaybackRates[i]));
+    benchmark.set_runs(10);
+    benchmark.Run(base::Bind(&RenderOneSecond, &algorithm, output.get()));
+  }
+}
+
+}  // namespace media
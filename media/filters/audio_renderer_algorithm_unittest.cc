@@ -12,7 +12,10 @@
 
 #include "base/bind.h"
 #include "base/callback.h"
+#include "build/build_config.h"
+#include "media/base/cpu_features.h"
 #include "media/base/data_buffer.h"
+#include "media/base/simd/vector_math.h"
 #include "media/filters/audio_renderer_algorithm.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -21,12 +24,19 @@ static const int kSamplesPerSecond = 44100;
 static const int kDefaultChannels = 2;
 static const int kDefaultSampleBits = 16;
 
+static const double kPi = 3.14159265358979323846;
+
+// A tone whose period is a whole number of frames, and its amplitude.
+static const int kSineWavePeriodInFrames = 100;
+static const double kSineWaveAmplitude = 10000;
+
 namespace media {
 
 class AudioRendererAlgorithmTest : public testing::Test {
  public:
   AudioRendererAlgorithmTest()
-      : bytes_enqueued_(0) {
+      : bytes_enqueued_(0),
+        sine_wave_(false) {
   }
 
   ~AudioRendererAlgorithmTest() {}
@@ -48,6 +58,13 @@ class AudioRendererAlgorithmTest : public testing::Test {
     CHECK_EQ(kRawDataSize % algorithm_.bytes_per_channel(), 0u);
     CHECK_EQ(kRawDataSize % algorithm_.bytes_per_frame(), 0u);
     size_t length = kRawDataSize / algorithm_.bytes_per_channel();
+    if (sine_wave_) {
+      // EnqueueBuffer() calls back here for more, so count the bytes first.
+      WriteSineWave(audio_data.get(), length);
+      bytes_enqueued_ += kRawDataSize;
+      algorithm_.EnqueueBuffer(new DataBuffer(audio_data.Pass(), kRawDataSize));
+      return;
+    }
     switch (algorithm_.bytes_per_channel()) {
       case 4:
         WriteFakeData<int32>(audio_data.get(), length);
@@ -75,6 +92,52 @@ class AudioRendererAlgorithmTest : public testing::Test {
     }
   }
 
+  // Writes the next |length| samples of a mono 16 bit sine wave.
+  void WriteSineWave(uint8* audio_data, size_t length) {
+    int16* output = reinterpret_cast<int16*>(audio_data);
+    int first_frame = bytes_enqueued_ / sizeof(*output);
+    for (size_t i = 0; i < length; i++) {
+      output[i] = kSineWaveAmplitude *
+          sin(2 * kPi * (first_frame + i) / kSineWavePeriodInFrames);
+    }
+  }
+
+  // Plays a sine wave at |playback_rate| and checks that the crossfades
+  // neither cut into the waveform nor weaken it.
+  void TestSineWaveIsPreserved(double playback_rate) {
+    sine_wave_ = true;
+    Initialize(1, 16);
+    algorithm_.SetPlaybackRate(static_cast<float>(playback_rate));
+
+    // Let the first window go by.
+    static const int kFramesToSkip = kSamplesPerSecond / 10;
+    static const int kFramesToCheck = kSamplesPerSecond;
+    scoped_array<int16> output(new int16[kFramesToSkip + kFramesToCheck]);
+    int frames_written = 0;
+    while (frames_written < kFramesToSkip + kFramesToCheck) {
+      int frames = algorithm_.FillBuffer(
+          reinterpret_cast<uint8*>(output.get() + frames_written),
+          kFramesToSkip + kFramesToCheck - frames_written);
+      ASSERT_GT(frames, 0);
+      frames_written += frames;
+    }
+
+    // The steepest step of the sine wave itself, with some slack.
+    double max_step =
+        1.1 * kSineWaveAmplitude * 2 * kPi / kSineWavePeriodInFrames;
+    for (int i = kFramesToSkip + 1; i < frames_written; ++i)
+      ASSERT_LE(std::abs(output[i] - output[i - 1]), max_step) << i;
+
+    // Every period still reaches close to the full amplitude.
+    for (int i = kFramesToSkip; i + kSineWavePeriodInFrames <= frames_written;
+         i += kSineWavePeriodInFrames) {
+      int peak = 0;
+      for (int j = i; j < i + kSineWavePeriodInFrames; ++j)
+        peak = std::max(peak, std::abs(static_cast<int>(output[j])));
+      ASSERT_GE(peak, 0.95 * kSineWaveAmplitude) << i;
+    }
+  }
+
   void CheckFakeData(uint8* audio_data, int frames_written,
                      double playback_rate) {
     size_t length =
@@ -181,6 +244,7 @@ class AudioRendererAlgorithmTest : public testing::Test {
  protected:
   AudioRendererAlgorithm algorithm_;
   int bytes_enqueued_;
+  bool sine_wave_;
 };
 
 TEST_F(AudioRendererAlgorithmTest, FillBuffer_NormalRate) {
@@ -284,4 +348,48 @@ TEST_F(AudioRendererAlgorithmTest, FillBuffer_HigherQualityAudio) {
   TestPlaybackRate(1.5);
 }
 
+TEST_F(AudioRendererAlgorithmTest, FillBuffer_SineWaveFasterRate) {
+  TestSineWaveIsPreserved(1.5);
+}
+
+TEST_F(AudioRendererAlgorithmTest, FillBuffer_SineWaveSlowerRate) {
+  TestSineWaveIsPreserved(0.75);
+}
+
+static void TestDotProduct(DotProductProc dot_product_proc) {
+  // Odd lengths and offsets exercise the unaligned loads and the tail.
+  static const int kLength = 101;
+  float a[kLength + 1];
+  float b[kLength];
+  for (int i = 0; i <= kLength; ++i)
+    a[i] = sin(static_cast<float>(i));
+  for (int i = 0; i < kLength; ++i)
+    b[i] = 0.01f * i - 0.3f;
+
+  for (int length = 0; length <= kLength; ++length) {
+    EXPECT_NEAR(DotProduct_C(a + 1, b, length),
+                dot_product_proc(a + 1, b, length), 1e-4);
+  }
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+TEST(AudioRendererAlgorithmSIMDTest, DotProductSSEMatchesC) {
+  if (!hasSSE()) {
+    LOG(WARNING) << "System not supported. Test skipped.";
+    return;
+  }
+  TestDotProduct(&DotProduct_SSE);
+}
+#endif
+
+#if defined(__ARM_NEON__)
+TEST(AudioRendererAlgorithmSIMDTest, DotProductNEONMatchesC) {
+  if (!hasNEON()) {
+    LOG(WARNING) << "System not supported. Test skipped.";
+    return;
+  }
+  TestDotProduct(&DotProduct_NEON);
+}
+#endif
+
 }  // namespace media
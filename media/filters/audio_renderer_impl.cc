@@ -6,12 +6,16 @@
 
 #include <math.h>
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/callback.h"
 #include "base/callback_helpers.h"
 #include "base/logging.h"
-#include "media/base/filter_host.h"
 #include "media/audio/audio_util.h"
+#include "media/base/channel_mixer.h"
+#include "media/base/filter_host.h"
+#include "media/base/sinc_resampler.h"
 
 namespace media {
 
@@ -26,6 +30,29 @@ AudioRendererImpl::AudioRendererImpl(media::AudioRendererSink* sink)
       stopped_(false),
       sink_(sink),
       is_initialized_(false),
+      sample_rate_(0),
+      flush_resampler_(false),
+      resampler_delay_milliseconds_(0),
+      read_cb_(base::Bind(&AudioRendererImpl::DecodedAudioReady,
+                          base::Unretained(this))) {
+}
+
+AudioRendererImpl::AudioRendererImpl(media::AudioRendererSink* sink,
+                                     const AudioParameters& hardware_params)
+    : state_(kUninitialized),
+      pending_read_(false),
+      received_end_of_stream_(false),
+      rendered_end_of_stream_(false),
+      audio_time_buffered_(kNoTimestamp()),
+      bytes_per_frame_(0),
+      bytes_per_second_(0),
+      stopped_(false),
+      sink_(sink),
+      is_initialized_(false),
+      hardware_params_(hardware_params),
+      sample_rate_(0),
+      flush_resampler_(false),
+      resampler_delay_milliseconds_(0),
       read_cb_(base::Bind(&AudioRendererImpl::DecodedAudioReady,
                           base::Unretained(this))) {
 }
@@ -126,6 +153,7 @@ void AudioRendererImpl::Seek(base::TimeDelta time, const PipelineStatusCB& cb) {
 
   // |algorithm_| will request more reads.
   algorithm_->FlushBuffers();
+  flush_resampler_ = true;
 
   if (stopped_)
     return;
@@ -178,15 +206,42 @@ void AudioRendererImpl::Initialize(const scoped_refptr<AudioDecoder>& decoder,
   if (config_ok)
     algorithm_->Initialize(channels, sample_rate, bits_per_channel, 0.0f, cb);
 
-  // We use the AUDIO_PCM_LINEAR flag because AUDIO_PCM_LOW_LATENCY
-  // does not currently support all the sample-rates that we require.
-  // Please see: http://code.google.com/p/chromium/issues/detail?id=103627
-  // for more details.
-  audio_parameters_ = AudioParameters(
-      AudioParameters::AUDIO_PCM_LINEAR, channel_layout, sample_rate,
-      bits_per_channel, GetHighLatencyOutputBufferSize(sample_rate));
+  sample_rate_ = sample_rate;
+  if (hardware_params_.IsValid()) {
+    // Open the sink the way the hardware runs so the browser can hand the
+    // audio straight to the device; AUDIO_PCM_LOW_LATENCY only supports the
+    // hardware sample rate.
+    ChannelLayout output_layout = channel_layout;
+    if (channels > hardware_params_.channels()) {
+      output_layout = hardware_params_.channel_layout();
+      channel_mixer_.reset(new ChannelMixer(channel_layout, output_layout));
+      mixer_input_.resize(channels);
+    }
+    audio_parameters_ = AudioParameters(
+        AudioParameters::AUDIO_PCM_LOW_LATENCY, output_layout,
+        hardware_params_.sample_rate(), 16,
+        hardware_params_.frames_per_buffer());
+
+    if (sample_rate != hardware_params_.sample_rate()) {
+      resampler_.reset(new SincResampler(
+          static_cast<double>(sample_rate) / hardware_params_.sample_rate(),
+          audio_parameters_.channels(),
+          SincResampler::kDefaultRequestFrames,
+          base::Bind(&AudioRendererImpl::ProvideResamplerInput,
+                     base::Unretained(this))));
+    }
+  } else {
+    // We use the AUDIO_PCM_LINEAR flag because AUDIO_PCM_LOW_LATENCY
+    // does not currently support all the sample-rates that we require.
+    // Please see: http://code.google.com/p/chromium/issues/detail?id=103627
+    // for more details.
+    audio_parameters_ = AudioParameters(
+        AudioParameters::AUDIO_PCM_LINEAR, channel_layout, sample_rate,
+        bits_per_channel, GetHighLatencyOutputBufferSize(sample_rate));
+  }
 
-  bytes_per_second_ = audio_parameters_.GetBytesPerSecond();
+  // The clock follows the stream, which may differ from what the sink plays.
+  bytes_per_second_ = bytes_per_frame_ * sample_rate;
 
   DCHECK(sink_.get());
   DCHECK(!is_initialized_);
@@ -333,6 +388,33 @@ int AudioRendererImpl::Render(const std::vector<float*>& audio_data,
     return 0;
   }
 
+  if (!resampler_.get())
+    return RenderStream(audio_data, number_of_frames, audio_delay_milliseconds);
+
+  bool flush_resampler = false;
+  {
+    base::AutoLock auto_lock(lock_);
+    std::swap(flush_resampler, flush_resampler_);
+  }
+  if (flush_resampler)
+    resampler_->Flush();
+
+  resampler_delay_milliseconds_ = audio_delay_milliseconds;
+  resampler_->Resample(audio_data, number_of_frames);
+  return number_of_frames;
+}
+
+void AudioRendererImpl::ProvideResamplerInput(
+    const std::vector<float*>& audio_data,
+    int number_of_frames) {
+  RenderStream(audio_data, number_of_frames, resampler_delay_milliseconds_);
+  resampler_delay_milliseconds_ += static_cast<int>(
+      number_of_frames * base::Time::kMillisecondsPerSecond / sample_rate_);
+}
+
+int AudioRendererImpl::RenderStream(const std::vector<float*>& audio_data,
+                                    int number_of_frames,
+                                    int audio_delay_milliseconds) {
   // Adjust the playback delay.
   base::TimeDelta request_delay =
       base::TimeDelta::FromMilliseconds(audio_delay_milliseconds);
@@ -344,7 +426,7 @@ int AudioRendererImpl::Render(const std::vector<float*>& audio_data,
                                 GetPlaybackRate())));
   }
 
-  int bytes_per_frame = audio_parameters_.GetBytesPerFrame();
+  int bytes_per_frame = bytes_per_frame_;
 
   const int buf_size = number_of_frames * bytes_per_frame;
   scoped_array<uint8> buf(new uint8[buf_size]);
@@ -354,11 +436,23 @@ int AudioRendererImpl::Render(const std::vector<float*>& audio_data,
   DCHECK_LE(bytes_filled, buf_size);
   UpdateEarliestEndTime(bytes_filled, request_delay, base::Time::Now());
 
-  // Deinterleave each audio channel.
-  int channels = audio_data.size();
+  // Deinterleave each audio channel, into |mixer_input_| if the stream has
+  // more channels than the sink.
+  const std::vector<float*>* channel_data = &audio_data;
+  if (channel_mixer_.get()) {
+    size_t mixer_input_size = mixer_input_.size() * number_of_frames;
+    if (mixer_input_data_.size() < mixer_input_size) {
+      mixer_input_data_.resize(mixer_input_size);
+      for (size_t i = 0; i < mixer_input_.size(); ++i)
+        mixer_input_[i] = &mixer_input_data_[i * number_of_frames];
+    }
+    channel_data = &mixer_input_;
+  }
+
+  int channels = channel_data->size();
   for (int channel_index = 0; channel_index < channels; ++channel_index) {
     media::DeinterleaveAudioChannel(buf.get(),
-                                    audio_data[channel_index],
+                                    (*channel_data)[channel_index],
                                     channels,
                                     channel_index,
                                     bytes_per_frame / channels,
@@ -367,11 +461,14 @@ int AudioRendererImpl::Render(const std::vector<float*>& audio_data,
     // If FillBuffer() didn't give us enough data then zero out the remainder.
     if (frames_filled < number_of_frames) {
       int frames_to_zero = number_of_frames - frames_filled;
-      memset(audio_data[channel_index] + frames_filled,
+      memset((*channel_data)[channel_index] + frames_filled,
              0,
              sizeof(float) * frames_to_zero);
     }
   }
+
+  if (channel_mixer_.get())
+    channel_mixer_->Transform(mixer_input_, audio_data, number_of_frames);
   return frames_filled;
 }
 
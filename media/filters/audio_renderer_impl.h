@@ -21,7 +21,9 @@
 #define MEDIA_FILTERS_AUDIO_RENDERER_IMPL_H_
 
 #include <deque>
+#include <vector>
 
+#include "base/memory/scoped_ptr.h"
 #include "base/synchronization/lock.h"
 #include "media/base/audio_decoder.h"
 #include "media/base/audio_renderer_sink.h"
@@ -31,6 +33,9 @@
 
 namespace media {
 
+class ChannelMixer;
+class SincResampler;
+
 class MEDIA_EXPORT AudioRendererImpl
     : public AudioRenderer,
       NON_EXPORTED_BASE(public media::AudioRendererSink::RenderCallback) {
@@ -38,6 +43,13 @@ class MEDIA_EXPORT AudioRendererImpl
   // Methods called on Render thread ------------------------------------------
   // An AudioRendererSink is used as the destination for the rendered audio.
   explicit AudioRendererImpl(media::AudioRendererSink* sink);
+
+  // Same as above, but the sink is opened with the sample rate, buffer size
+  // and at most the channel count of |hardware_params| so that the browser
+  // does not have to convert the audio. Streams with other sample rates are
+  // resampled and streams with more channels are downmixed in Render().
+  AudioRendererImpl(media::AudioRendererSink* sink,
+                    const AudioParameters& hardware_params);
   virtual ~AudioRendererImpl();
 
   // Methods called on pipeline thread ----------------------------------------
@@ -117,6 +129,17 @@ class MEDIA_EXPORT AudioRendererImpl
                      int audio_delay_milliseconds) OVERRIDE;
   virtual void OnRenderError() OVERRIDE;
 
+  // Fills |audio_data| with |number_of_frames| frames of the stream, mixed
+  // down to the sink's channels if needed. Returns the number of frames that
+  // came from |algorithm_|; the rest of |audio_data| is zeroed.
+  int RenderStream(const std::vector<float*>& audio_data,
+                   int number_of_frames,
+                   int audio_delay_milliseconds);
+
+  // Called by |resampler_| from within Render() for more stream frames.
+  void ProvideResamplerInput(const std::vector<float*>& audio_data,
+                             int number_of_frames);
+
   // Helper method that schedules an asynchronous read from the decoder and
   // increments |pending_reads_|.
   //
@@ -198,8 +221,34 @@ class MEDIA_EXPORT AudioRendererImpl
   // than nothing.
   base::Time earliest_end_time_;
 
+  // The parameters the sink was opened with.
   AudioParameters audio_parameters_;
 
+  // The output parameters requested at construction. Invalid if the sink
+  // should be opened with the parameters of the stream.
+  AudioParameters hardware_params_;
+
+  int sample_rate_;
+
+  // Converts the stream to the sample rate of the sink. Only used on the
+  // audio thread; NULL if the rates match.
+  scoped_ptr<SincResampler> resampler_;
+
+  // Set by Seek() so that the audio thread drops the frames still held in
+  // |resampler_|.
+  bool flush_resampler_;
+
+  // The delay of the current Render() call, advanced by every frame handed
+  // to |resampler_|.
+  int resampler_delay_milliseconds_;
+
+  // Downmixes the stream to the channels of the sink; NULL if they match.
+  scoped_ptr<ChannelMixer> channel_mixer_;
+
+  // Deinterleaved stream channels fed to |channel_mixer_|.
+  std::vector<float> mixer_input_data_;
+  std::vector<float*> mixer_input_;
+
   AudioDecoder::ReadCB read_cb_;
 
   DISALLOW_COPY_AND_ASSIGN(AudioRendererImpl);
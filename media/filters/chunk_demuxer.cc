@@ -7,7 +7,9 @@
 #include "base/bind.h"
 #include "base/logging.h"
 #include "base/message_loop.h"
+#include "base/metrics/histogram.h"
 #include "media/base/audio_decoder_config.h"
+#include "media/base/data_buffer.h"
 #include "media/base/stream_parser_buffer.h"
 #include "media/base/video_decoder_config.h"
 #include "media/filters/chunk_demuxer_client.h"
@@ -359,12 +361,24 @@ ChunkDemuxer::ChunkDemuxer(ChunkDemuxerClient* client)
       host_(NULL),
       client_(client),
       buffered_bytes_(0),
-      seek_waits_for_data_(true) {
+      seek_waits_for_data_(true),
+      pending_appends_(0),
+      pending_appends_cv_(&lock_) {
   DCHECK(client);
 }
 
 ChunkDemuxer::~ChunkDemuxer() {
   DCHECK_NE(state_, INITIALIZED);
+  // The posted parse tasks do not hold a reference to |this|.
+  if (parser_thread_.get())
+    parser_thread_->Stop();
+}
+
+void ChunkDemuxer::StartParserThread() {
+  DCHECK_EQ(state_, WAITING_FOR_INIT);
+  DCHECK(!parser_thread_.get());
+  parser_thread_.reset(new base::Thread("ChunkDemuxerParser"));
+  CHECK(parser_thread_->Start());
 }
 
 void ChunkDemuxer::Initialize(DemuxerHost* host,
@@ -464,6 +478,7 @@ base::TimeDelta ChunkDemuxer::GetStartTime() const {
 void ChunkDemuxer::FlushData() {
   DVLOG(1) << "FlushData()";
   base::AutoLock auto_lock(lock_);
+  WaitForPendingAppends_Locked();
   DCHECK(state_ == INITIALIZED || state_ == ENDED || state_ == SHUTDOWN);
 
   if (state_ == SHUTDOWN)
@@ -508,6 +523,7 @@ bool ChunkDemuxer::GetBufferedRanges(const std::string& id,
   DCHECK(ranges_out);
 
   base::AutoLock auto_lock(lock_);
+  WaitForPendingAppends_Locked();
   base::TimeDelta start = kNoTimestamp();
   base::TimeDelta end;
   base::TimeDelta tmp_start;
@@ -552,6 +568,44 @@ bool ChunkDemuxer::AppendData(const std::string& id,
   DCHECK(data);
   DCHECK_GT(length, 0u);
 
+  base::TimeTicks append_start = base::TimeTicks::Now();
+  scoped_refptr<DataBuffer> buffer = DataBuffer::CopyFrom(data, length);
+
+  bool success = true;
+  if (parser_thread_.get()) {
+    {
+      base::AutoLock auto_lock(lock_);
+      if (state_ != INITIALIZING && state_ != INITIALIZED) {
+        DVLOG(1) << "AppendData(): called in unexpected state " << state_;
+        return false;
+      }
+      ++pending_appends_;
+    }
+    parser_thread_->message_loop()->PostTask(FROM_HERE, base::Bind(
+        &ChunkDemuxer::ParseAppendedDataTask, base::Unretained(this),
+        buffer));
+  } else {
+    success = ParseAppendedData(buffer);
+  }
+
+  UMA_HISTOGRAM_TIMES("Media.MSE.AppendDataCallerTime",
+                      base::TimeTicks::Now() - append_start);
+  return success;
+}
+
+void ChunkDemuxer::ParseAppendedDataTask(
+    const scoped_refptr<DataBuffer>& buffer) {
+  ParseAppendedData(buffer);
+
+  base::AutoLock auto_lock(lock_);
+  DCHECK_GT(pending_appends_, 0);
+  if (--pending_appends_ == 0)
+    pending_appends_cv_.Broadcast();
+}
+
+bool ChunkDemuxer::ParseAppendedData(const scoped_refptr<DataBuffer>& buffer) {
+  base::TimeTicks parse_start = base::TimeTicks::Now();
+
   int64 buffered_bytes = 0;
   base::TimeDelta buffered_ts = base::TimeDelta::FromSeconds(-1);
 
@@ -566,7 +620,7 @@ bool ChunkDemuxer::AppendData(const std::string& id,
 
     switch (state_) {
       case INITIALIZING:
-        if (!source_buffer_->AppendData(data, length)) {
+        if (!source_buffer_->AppendBuffer(buffer)) {
           DCHECK_EQ(state_, INITIALIZING);
           ReportError_Locked(DEMUXER_ERROR_COULD_NOT_OPEN);
           return true;
@@ -574,7 +628,7 @@ bool ChunkDemuxer::AppendData(const std::string& id,
         break;
 
       case INITIALIZED: {
-        if (!source_buffer_->AppendData(data, length)) {
+        if (!source_buffer_->AppendBuffer(buffer)) {
           ReportError_Locked(PIPELINE_ERROR_DECODE);
           return true;
         }
@@ -621,6 +675,12 @@ bool ChunkDemuxer::AppendData(const std::string& id,
   if (!cb.is_null())
     cb.Run(PIPELINE_OK);
 
+  base::TimeDelta parse_time = base::TimeTicks::Now() - parse_start;
+  if (parse_time.InMicroseconds() > 0) {
+    UMA_HISTOGRAM_COUNTS("Media.MSE.AppendThroughputKBps", static_cast<int>(
+        buffer->GetDataSize() * base::Time::kMicrosecondsPerSecond /
+        (1024 * parse_time.InMicroseconds())));
+  }
   return true;
 }
 
@@ -628,12 +688,15 @@ void ChunkDemuxer::Abort(const std::string& id) {
   DCHECK(!id.empty());
   DCHECK_EQ(source_id_, id);
 
+  base::AutoLock auto_lock(lock_);
+  WaitForPendingAppends_Locked();
   source_buffer_->Flush();
 }
 
 void ChunkDemuxer::EndOfStream(PipelineStatus status) {
   DVLOG(1) << "EndOfStream(" << status << ")";
   base::AutoLock auto_lock(lock_);
+  WaitForPendingAppends_Locked();
   DCHECK_NE(state_, WAITING_FOR_INIT);
   DCHECK_NE(state_, ENDED);
 
@@ -693,6 +756,10 @@ void ChunkDemuxer::Shutdown() {
   if (!cb.is_null())
     cb.Run(PIPELINE_ERROR_ABORT);
 
+  // Appends still queued are dropped since the state is now SHUTDOWN.
+  if (parser_thread_.get())
+    parser_thread_->Stop();
+
   client_->DemuxerClosed();
 }
 
@@ -701,6 +768,12 @@ void ChunkDemuxer::ChangeState_Locked(State new_state) {
   state_ = new_state;
 }
 
+void ChunkDemuxer::WaitForPendingAppends_Locked() const {
+  lock_.AssertAcquired();
+  while (pending_appends_ > 0)
+    pending_appends_cv_.Wait();
+}
+
 void ChunkDemuxer::ReportError_Locked(PipelineStatus error) {
   lock_.AssertAcquired();
   DCHECK_NE(error, PIPELINE_OK);
@@ -10,7 +10,10 @@
 #include <utility>
 #include <vector>
 
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/condition_variable.h"
 #include "base/synchronization/lock.h"
+#include "base/threading/thread.h"
 #include "media/base/byte_queue.h"
 #include "media/base/demuxer.h"
 #include "media/filters/source_buffer.h"
@@ -19,6 +22,7 @@ namespace media {
 
 class ChunkDemuxerClient;
 class ChunkDemuxerStream;
+class DataBuffer;
 class FFmpegURLProtocol;
 
 // Demuxer implementation that allows chunks of media data to be passed
@@ -50,6 +54,13 @@ class MEDIA_EXPORT ChunkDemuxer : public Demuxer {
   virtual bool IsSeekable() OVERRIDE;
 
   // Methods used by an external object to control this demuxer.
+  //
+  // Makes AppendData() hand the data to a parser thread and return without
+  // waiting for it to be parsed, so that large appends do not block the
+  // caller. GetBufferedRanges(), Abort(), FlushData() and EndOfStream() wait
+  // for the pending appends first. Must be called before Initialize().
+  void StartParserThread();
+
   void FlushData();
 
   // Registers a new |id| to use for AppendData() calls. |type| indicates
@@ -72,7 +83,8 @@ class MEDIA_EXPORT ChunkDemuxer : public Demuxer {
   bool GetBufferedRanges(const std::string& id, Ranges* ranges_out) const;
 
   // Appends media data to the source buffer associated with |id|. Returns
-  // false if this method is called in an invalid state.
+  // false if this method is called in an invalid state. The data is copied
+  // once; the parsed buffers reference that copy.
   bool AppendData(const std::string& id, const uint8* data, size_t length);
 
   // Aborts parsing the current segment and reset the parser to a state where
@@ -95,6 +107,16 @@ class MEDIA_EXPORT ChunkDemuxer : public Demuxer {
 
   void ChangeState_Locked(State new_state);
 
+  // Parses |buffer| and notifies |host_| of the new data. Runs on the parser
+  // thread if there is one. Returns false if called in an invalid state.
+  bool ParseAppendedData(const scoped_refptr<DataBuffer>& buffer);
+
+  // Task posted by AppendData() to the parser thread.
+  void ParseAppendedDataTask(const scoped_refptr<DataBuffer>& buffer);
+
+  // Blocks until the parser thread has parsed all the appended data.
+  void WaitForPendingAppends_Locked() const;
+
   // Reports an error and puts the demuxer in a state where it won't accept more
   // data.
   void ReportError_Locked(PipelineStatus error);
@@ -132,6 +154,14 @@ class MEDIA_EXPORT ChunkDemuxer : public Demuxer {
   // TODO(acolwell): Remove this when fixing http://crbug.com/122909
   std::string source_id_;
 
+  // Parses the appended data if StartParserThread() was called.
+  scoped_ptr<base::Thread> parser_thread_;
+
+  // Number of appends posted to |parser_thread_| that have not been parsed
+  // yet, and the condition signalled when it drops to zero.
+  int pending_appends_;
+  mutable base::ConditionVariable pending_appends_cv_;
+
   DISALLOW_COPY_AND_ASSIGN(ChunkDemuxer);
 };
 
@@ -515,6 +515,24 @@ TEST_F(ChunkDemuxerTest, TestRead) {
   EXPECT_TRUE(video_read_done);
 }
 
+TEST_F(ChunkDemuxerTest, TestParserThread) {
+  demuxer_->StartParserThread();
+  ASSERT_TRUE(InitDemuxer(true, true, false));
+
+  ClusterBuilder cb;
+  cb.SetClusterTimecode(0);
+  AddSimpleBlock(&cb, kAudioTrackNum, 32);
+  AddSimpleBlock(&cb, kVideoTrackNum, 123);
+  scoped_ptr<Cluster> cluster(cb.Finish());
+  ASSERT_TRUE(AppendDataInPieces(cluster->data(), cluster->size()));
+
+  // GetBufferedRanges() waits for the appends to be parsed.
+  ChunkDemuxer::Ranges ranges;
+  ASSERT_TRUE(demuxer_->GetBufferedRanges(kSourceId, &ranges));
+  ASSERT_EQ(1u, ranges.size());
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(32), ranges[0].first);
+}
+
 TEST_F(ChunkDemuxerTest, TestOutOfOrderClusters) {
   ASSERT_TRUE(InitDemuxer(true, true, false));
 
@@ -9,6 +9,7 @@
 #include "base/command_line.h"
 #include "base/message_loop.h"
 #include "base/string_number_conversions.h"
+#include "base/sys_info.h"
 #include "media/base/demuxer_stream.h"
 #include "media/base/limits.h"
 #include "media/base/media_switches.h"
@@ -20,8 +21,8 @@
 
 namespace media {
 
-// Always try to use three threads for video decoding.  There is little reason
-// not to since current day CPUs tend to be multi-core and we measured
+// Always try to use at least two threads for video decoding.  There is little
+// reason not to since current day CPUs tend to be multi-core and we measured
 // performance benefits on older machines such as P4s with hyperthreading.
 //
 // Handling decoding on separate threads also frees up the pipeline thread to
@@ -32,22 +33,65 @@ namespace media {
 static const int kDecodeThreads = 2;
 static const int kMaxDecodeThreads = 16;
 
-// Returns the number of threads given the FFmpeg CodecID. Also inspects the
-// command line for a valid --video-threads flag.
-static int GetThreadCount(CodecID codec_id) {
+// Larger videos get one more decode thread for every this many pixels, up to
+// the number of cores: 2 threads up to 480p, 3 for 720p and 7 for 1080p.
+static const int kPixelsPerDecodeThread = 640 * 480;
+
+// Returns the number of threads to decode a video of |width| x |height| with.
+// Also inspects the command line for a valid --video-threads flag, which
+// overrides the choice.
+static int GetThreadCount(int width, int height) {
   // Refer to http://crbug.com/93932 for tsan suppressions on decoding.
   int decode_threads = kDecodeThreads;
 
   const CommandLine* cmd_line = CommandLine::ForCurrentProcess();
   std::string threads(cmd_line->GetSwitchValueASCII(switches::kVideoThreads));
-  if (threads.empty() || !base::StringToInt(threads, &decode_threads))
-    return decode_threads;
+  if (threads.empty() || !base::StringToInt(threads, &decode_threads)) {
+    int max_threads = std::min(base::SysInfo::NumberOfProcessors(),
+                               kMaxDecodeThreads);
+    int pixels = width * height;
+    decode_threads = (pixels + kPixelsPerDecodeThread - 1) /
+        kPixelsPerDecodeThread;
+    decode_threads = std::max(decode_threads, kDecodeThreads);
+    return std::min(decode_threads, std::max(max_threads, kDecodeThreads));
+  }
 
   decode_threads = std::max(decode_threads, 0);
   decode_threads = std::min(decode_threads, kMaxDecodeThreads);
   return decode_threads;
 }
 
+// Returns the FF_THREAD_* type to decode with |codec|. Frame threading scales
+// with the number of threads for any stream, while slice threading only helps
+// streams that were encoded with several slices, so it is only used for codecs
+// that can not decode frames in parallel.
+static int GetThreadType(const AVCodec* codec) {
+  if (codec->capabilities & CODEC_CAP_FRAME_THREADS)
+    return FF_THREAD_FRAME;
+  return FF_THREAD_SLICE;
+}
+
+static int GetVideoBufferImpl(AVCodecContext* s, AVFrame* frame) {
+  FFmpegVideoDecoder* decoder = static_cast<FFmpegVideoDecoder*>(s->opaque);
+  return decoder->GetVideoBuffer(s, frame);
+}
+
+static void ReleaseVideoBufferImpl(AVCodecContext* s, AVFrame* frame) {
+  if (frame->type != FF_BUFFER_TYPE_USER) {
+    avcodec_default_release_buffer(s, frame);
+    return;
+  }
+
+  // Drop the reference FFmpeg held on the frame; the frame returns to the pool
+  // once the renderer releases it too.
+  scoped_refptr<VideoFrame> video_frame;
+  video_frame.swap(reinterpret_cast<VideoFrame**>(&frame->opaque));
+
+  // The FFmpeg API expects us to zero the data pointers in this callback.
+  memset(frame->data, 0, sizeof(frame->data));
+  frame->opaque = NULL;
+}
+
 FFmpegVideoDecoder::FFmpegVideoDecoder(
     const base::Callback<MessageLoop*()>& message_loop_cb)
     : message_loop_factory_cb_(message_loop_cb),
@@ -105,7 +149,6 @@ void FFmpegVideoDecoder::Initialize(const scoped_refptr<DemuxerStream>& stream,
   // for damaged macroblocks, and set our error detection sensitivity.
   codec_context_->error_concealment = FF_EC_GUESS_MVS | FF_EC_DEBLOCK;
   codec_context_->err_recognition = AV_EF_CAREFUL;
-  codec_context_->thread_count = GetThreadCount(codec_context_->codec_id);
 
   AVCodec* codec = avcodec_find_decoder(codec_context_->codec_id);
   if (!codec) {
@@ -113,6 +156,24 @@ void FFmpegVideoDecoder::Initialize(const scoped_refptr<DemuxerStream>& stream,
     return;
   }
 
+  codec_context_->thread_count = GetThreadCount(codec_context_->width,
+                                                codec_context_->height);
+  codec_context_->thread_type = GetThreadType(codec);
+  DVLOG(1) << "Decoding " << codec->name << " with "
+           << codec_context_->thread_count << " threads, "
+           << (codec_context_->thread_type == FF_THREAD_FRAME ?
+               "frame" : "slice") << " threading";
+
+  // Decode directly into pooled video frames, which saves copying every
+  // frame out of FFmpeg's buffers. Edge emulation keeps FFmpeg from writing
+  // outside the planes.
+  if (codec->capabilities & CODEC_CAP_DR1) {
+    codec_context_->opaque = this;
+    codec_context_->flags |= CODEC_FLAG_EMU_EDGE;
+    codec_context_->get_buffer = GetVideoBufferImpl;
+    codec_context_->release_buffer = ReleaseVideoBufferImpl;
+  }
+
   if (avcodec_open2(codec_context_, codec, NULL) < 0) {
     status_cb.Run(PIPELINE_ERROR_DECODE);
     return;
@@ -273,16 +334,23 @@ void FFmpegVideoDecoder::DoDecodeBuffer(const scoped_refptr<Buffer>& buffer) {
   }
 
   scoped_refptr<VideoFrame> video_frame;
+  base::TimeTicks decode_start = base::TimeTicks::HighResNow();
   if (!Decode(unencrypted_buffer, &video_frame)) {
     state_ = kDecodeFinished;
     base::ResetAndReturn(&read_cb_).Run(kDecodeError, NULL);
     return;
   }
+  // With frame threading this is the time the decode blocked the decoder
+  // thread, which is what limits playback.
+  base::TimeDelta decode_time =
+      base::TimeTicks::HighResNow() - decode_start;
 
   // Any successful decode counts!
   if (buffer->GetDataSize()) {
     PipelineStatistics statistics;
     statistics.video_bytes_decoded = buffer->GetDataSize();
+    statistics.video_decode_time = decode_time;
+    statistics.video_max_decode_time = decode_time;
     statistics_cb_.Run(statistics);
   }
 
@@ -356,11 +424,18 @@ bool FFmpegVideoDecoder::Decode(
     return false;
   }
 
-  // We've got a frame! Make sure we have a place to store it.
-  *video_frame = AllocateVideoFrame();
-  if (!(*video_frame)) {
-    LOG(ERROR) << "Failed to allocate video frame";
-    return false;
+  // We've got a frame! If FFmpeg decoded it into one of our frames it can be
+  // delivered as is, otherwise make sure we have a place to copy it to.
+  bool decoded_into_video_frame =
+      av_frame_->type == FF_BUFFER_TYPE_USER && av_frame_->opaque;
+  if (decoded_into_video_frame) {
+    *video_frame = static_cast<VideoFrame*>(av_frame_->opaque);
+  } else {
+    *video_frame = AllocateVideoFrame();
+    if (!(*video_frame)) {
+      LOG(ERROR) << "Failed to allocate video frame";
+      return false;
+    }
   }
 
   // Determine timestamp and calculate the duration based on the repeat picture
@@ -381,6 +456,9 @@ bool FFmpegVideoDecoder::Decode(
   (*video_frame)->SetDuration(
       ConvertFromTimeBase(doubled_time_base, 2 + av_frame_->repeat_pict));
 
+  if (decoded_into_video_frame)
+    return true;
+
   // Copy the frame data since FFmpeg reuses internal buffers for AVFrame
   // output, meaning the data is only valid until the next
   // avcodec_decode_video() call.
@@ -421,8 +499,54 @@ scoped_refptr<VideoFrame> FFmpegVideoDecoder::AllocateVideoFrame() {
   size_t width = codec_context_->width;
   size_t height = codec_context_->height;
 
-  return VideoFrame::CreateFrame(format, width, height,
+  return frame_pool_.CreateFrame(format, width, height,
                                  kNoTimestamp(), kNoTimestamp());
 }
 
+int FFmpegVideoDecoder::GetVideoBuffer(AVCodecContext* codec_context,
+                                       AVFrame* frame) {
+  VideoFrame::Format format = PixelFormatToVideoFormat(codec_context->pix_fmt);
+  int width = codec_context->width;
+  int height = codec_context->height;
+  if ((format != VideoFrame::YV12 && format != VideoFrame::YV16) ||
+      !VideoFrame::IsValidConfig(format, width, height)) {
+    return avcodec_default_get_buffer(codec_context, frame);
+  }
+
+  // The codec may decode past the visible size, up to the aligned size.
+  int aligned_width = width;
+  int aligned_height = height;
+  int linesize_align[4];
+  avcodec_align_dimensions2(codec_context, &aligned_width, &aligned_height,
+                            linesize_align);
+
+  scoped_refptr<VideoFrame> video_frame = frame_pool_.CreateFrame(
+      format, width, height, kNoTimestamp(), kNoTimestamp());
+
+  // VideoFrame rounds the height up to a multiple of twice
+  // kFrameSizeAlignment and pads it further, which covers the codecs we
+  // support. Let FFmpeg allocate the buffer if it needs more.
+  int max_height = (height + VideoFrame::kFrameSizeAlignment * 2 - 1) &
+      ~(VideoFrame::kFrameSizeAlignment * 2 - 1);
+  bool fits = aligned_width <= video_frame->stride(VideoFrame::kYPlane) &&
+      aligned_height <= max_height;
+  for (int i = 0; i < VideoFrame::kMaxPlanes && fits; ++i)
+    fits = video_frame->stride(i) % linesize_align[i] == 0;
+  if (!fits)
+    return avcodec_default_get_buffer(codec_context, frame);
+
+  for (int i = 0; i < VideoFrame::kMaxPlanes; ++i) {
+    frame->base[i] = video_frame->data(i);
+    frame->data[i] = video_frame->data(i);
+    frame->linesize[i] = video_frame->stride(i);
+  }
+  frame->type = FF_BUFFER_TYPE_USER;
+  frame->reordered_opaque = codec_context->reordered_opaque;
+
+  // FFmpeg keeps a reference to the frame until it calls release_buffer.
+  frame->opaque = NULL;
+  video_frame.swap(reinterpret_cast<VideoFrame**>(&frame->opaque));
+  return 0;
+}
+
 }  // namespace media
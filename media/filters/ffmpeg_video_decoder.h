@@ -10,6 +10,7 @@
 #include "base/callback.h"
 #include "base/memory/scoped_ptr.h"
 #include "media/base/video_decoder.h"
+#include "media/base/video_frame_pool.h"
 #include "media/crypto/aes_decryptor.h"
 
 class MessageLoop;
@@ -35,6 +36,13 @@ class MEDIA_EXPORT FFmpegVideoDecoder : public VideoDecoder {
 
   AesDecryptor* decryptor();
 
+  // Callback called from within FFmpeg to allocate a buffer based on the
+  // dimensions of |codec_context|. Decodes directly into a frame from
+  // |frame_pool_| when the frame meets the codec's alignment requirements and
+  // otherwise lets FFmpeg allocate the buffer. See the documentation of
+  // AVCodecContext.get_buffer inside FFmpeg.
+  int GetVideoBuffer(AVCodecContext* codec_context, AVFrame* frame);
+
  private:
   enum DecoderState {
     kUninitialized,
@@ -69,6 +77,10 @@ class MEDIA_EXPORT FFmpegVideoDecoder : public VideoDecoder {
   // the current state of |codec_context_|.
   scoped_refptr<VideoFrame> AllocateVideoFrame();
 
+  // Frames FFmpeg decodes into, and frames the decoded pictures are copied
+  // into when FFmpeg allocated the buffer itself.
+  VideoFramePool frame_pool_;
+
   // This is !is_null() iff Initialize() hasn't been called.
   base::Callback<MessageLoop*()> message_loop_factory_cb_;
 
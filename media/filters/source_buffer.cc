@@ -45,6 +45,10 @@ bool SourceBuffer::AppendData(const uint8* data, size_t length) {
   return stream_parser_->Parse(data, length);
 }
 
+bool SourceBuffer::AppendBuffer(const scoped_refptr<DataBuffer>& buffer) {
+  return stream_parser_->ParseBuffer(buffer);
+}
+
 void SourceBuffer::Flush() {
   stream_parser_->Flush();
 }
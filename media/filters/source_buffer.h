@@ -36,6 +36,10 @@ class MEDIA_EXPORT SourceBuffer {
   // Returns true if data was successfully appended, false if the parse failed.
   bool AppendData(const uint8* data, size_t length);
 
+  // Same as above, but the parsed buffers may reference the data of |buffer|
+  // instead of copying it. See StreamParser::ParseBuffer().
+  bool AppendBuffer(const scoped_refptr<DataBuffer>& buffer);
+
   // Clears the data from this buffer.  Used during a seek to ensure the next
   // buffers provided during a read are the buffers appended after the seek.
   void Flush();
@@ -0,0 +1,143 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This tool measures the performance of the 16 bit audio kernels used for
+// mixing, volume, interleaving and deinterleaving. Each kernel is timed in
+// its C version and in every SIMD version the CPU supports.
+
+#include <iostream>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/string_number_conversions.h"
+#include "base/time.h"
+#include "build/build_config.h"
+#include "media/base/cpu_features.h"
+#include "media/base/simd/mix_audio.h"
+
+using base::TimeTicks;
+
+static int num_frames = 2048;
+static int num_iterations = 20000;
+
+// Volume of the benchmarks that scale; unity takes a faster path in the
+// mixer and is timed separately.
+static const int kFixedVolume = 45000;
+
+// Returns the time taken per buffer, in microseconds.
+static double BenchmarkMix(media::MixAudio16Proc proc, int fixed_volume) {
+  std::vector<int16> dest(2 * num_frames);
+  std::vector<int16> src(2 * num_frames, 1000);
+  TimeTicks start = TimeTicks::HighResNow();
+  for (int i = 0; i < num_iterations; ++i)
+    proc(&dest[0], &src[0], 2 * num_frames, fixed_volume);
+  TimeTicks end = TimeTicks::HighResNow();
+  return static_cast<double>((end - start).InMicroseconds()) / num_iterations;
+}
+
+static double BenchmarkAdjustVolume(media::AdjustVolume16Proc proc) {
+  std::vector<int16> buf(2 * num_frames, 1000);
+  TimeTicks start = TimeTicks::HighResNow();
+  for (int i = 0; i < num_iterations; ++i)
+    proc(&buf[0], 2 * num_frames, kFixedVolume);
+  TimeTicks end = TimeTicks::HighResNow();
+  return static_cast<double>((end - start).InMicroseconds()) / num_iterations;
+}
+
+static double BenchmarkInterleave(
+    media::InterleaveStereoFloatToInt16Proc proc) {
+  std::vector<float> left(num_frames, 0.5f);
+  std::vector<float> right(num_frames, -0.5f);
+  std::vector<int16> dest(2 * num_frames);
+  TimeTicks start = TimeTicks::HighResNow();
+  for (int i = 0; i < num_iterations; ++i)
+    proc(&left[0], &right[0], &dest[0], num_frames);
+  TimeTicks end = TimeTicks::HighResNow();
+  return static_cast<double>((end - start).InMicroseconds()) / num_iterations;
+}
+
+static double BenchmarkDeinterleave(media::DeinterleaveInt16ToFloatProc proc) {
+  std::vector<int16> src(2 * num_frames, 1000);
+  std::vector<float> dest(num_frames);
+  TimeTicks start = TimeTicks::HighResNow();
+  for (int i = 0; i < num_iterations; ++i)
+    proc(&src[0], &dest[0], 2, i & 1, num_frames);
+  TimeTicks end = TimeTicks::HighResNow();
+  return static_cast<double>((end - start).InMicroseconds()) / num_iterations;
+}
+
+static void BenchmarkKernels(
+    const char* name,
+    media::MixAudio16Proc mix_proc,
+    media::AdjustVolume16Proc adjust_volume_proc,
+    media::InterleaveStereoFloatToInt16Proc interleave_proc,
+    media::DeinterleaveInt16ToFloatProc deinterleave_proc) {
+  std::cout << name << std::endl;
+  std::cout << "  Mix: " << BenchmarkMix(mix_proc, 65536) << "us"
+            << std::endl;
+  std::cout << "  Mix with volume: " << BenchmarkMix(mix_proc, kFixedVolume)
+            << "us" << std::endl;
+  std::cout << "  Adjust volume: "
+            << BenchmarkAdjustVolume(adjust_volume_proc) << "us" << std::endl;
+  std::cout << "  Interleave float to int16: "
+            << BenchmarkInterleave(interleave_proc) << "us" << std::endl;
+  std::cout << "  Deinterleave int16 to float: "
+            << BenchmarkDeinterleave(deinterleave_proc) << "us" << std::endl;
+}
+
+int main(int argc, const char** argv) {
+  CommandLine::Init(argc, argv);
+  const CommandLine* cmd_line = CommandLine::ForCurrentProcess();
+
+  if (!cmd_line->GetArgs().empty()) {
+    std::cerr << "Usage: " << argv[0] << " [OPTIONS]\n"
+              << "  --frames=N                      "
+              << "Number of stereo frames per buffer\n"
+              << "  --iterations=N                  "
+              << "Number of buffers to process\n"
+              << std::endl;
+    return 1;
+  }
+
+  std::string frames_param(cmd_line->GetSwitchValueASCII("frames"));
+  if (!frames_param.empty() &&
+      !base::StringToInt(frames_param, &num_frames)) {
+    num_frames = 0;
+  }
+
+  std::string iterations_param(cmd_line->GetSwitchValueASCII("iterations"));
+  if (!iterations_param.empty() &&
+      !base::StringToInt(iterations_param, &num_iterations)) {
+    num_iterations = 0;
+  }
+
+  if (num_frames <= 0 || num_iterations <= 0) {
+    std::cerr << "Invalid arguments." << std::endl;
+    return 1;
+  }
+
+  std::cout << "Frames per buffer: " << num_frames << std::endl;
+  std::cout << "Number of iterations: " << num_iterations << std::endl;
+  std::cout << "Time per buffer:" << std::endl;
+
+  BenchmarkKernels("C", &media::MixAudio16_C, &media::AdjustVolume16_C,
+                   &media::InterleaveStereoFloatToInt16_C,
+                   &media::DeinterleaveInt16ToFloat_C);
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (media::hasSSE2()) {
+    BenchmarkKernels("SSE2", &media::MixAudio16_SSE2,
+                     &media::AdjustVolume16_SSE2,
+                     &media::InterleaveStereoFloatToInt16_SSE2,
+                     &media::DeinterleaveInt16ToFloat_SSE2);
+  }
+#elif defined(__ARM_NEON__)
+  if (media::hasNEON()) {
+    BenchmarkKernels("NEON", &media::MixAudio16_NEON,
+                     &media::AdjustVolume16_NEON,
+                     &media::InterleaveStereoFloatToInt16_NEON,
+                     &media::DeinterleaveInt16ToFloat_NEON);
+  }
+#endif
+  return 0;
+}
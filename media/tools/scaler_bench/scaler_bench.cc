@@ -5,6 +5,8 @@
 // This tool can be used to measure performace of video frame scaling
 // code. It times performance of the scaler with and without filtering.
 // It also measures performance of the Skia scaler for comparison.
+// With --matrix the scaler is timed for every filter at several scale
+// factors, which exercises each of the SIMD row functions.
 
 #include <iostream>
 #include <vector>
@@ -152,6 +154,74 @@ static double BenchmarkFilter(media::ScaleFilter filter) {
   return static_cast<double>((end - start).InMilliseconds()) / num_frames;
 }
 
+static double BenchmarkConvert() {
+  std::vector<scoped_refptr<VideoFrame> > source_frames;
+  std::vector<scoped_refptr<VideoFrame> > dest_frames;
+
+  for (int i = 0; i < num_buffers; i++) {
+    source_frames.push_back(
+        VideoFrame::CreateBlackFrame(source_width, source_height));
+
+    dest_frames.push_back(
+        VideoFrame::CreateFrame(VideoFrame::RGB32,
+                                source_width,
+                                source_height,
+                                TimeDelta::FromSeconds(0),
+                                TimeDelta::FromSeconds(0)));
+  }
+
+  TimeTicks start = TimeTicks::HighResNow();
+  for (int i = 0; i < num_frames; i++) {
+    scoped_refptr<VideoFrame> source_frame = source_frames[i % num_buffers];
+    scoped_refptr<VideoFrame> dest_frame = dest_frames[i % num_buffers];
+
+    media::ConvertYUVToRGB32(source_frame->data(VideoFrame::kYPlane),
+                             source_frame->data(VideoFrame::kUPlane),
+                             source_frame->data(VideoFrame::kVPlane),
+                             dest_frame->data(0),
+                             source_width,
+                             source_height,
+                             source_frame->stride(VideoFrame::kYPlane),
+                             source_frame->stride(VideoFrame::kUPlane),
+                             dest_frame->stride(0),
+                             media::YV12);
+  }
+  TimeTicks end = TimeTicks::HighResNow();
+  return static_cast<double>((end - start).InMilliseconds()) / num_frames;
+}
+
+// Times every filter for destinations of half, the same and twice the source
+// size.
+static void BenchmarkMatrix() {
+  static const struct {
+    media::ScaleFilter filter;
+    const char* name;
+  } kFilters[] = {
+    { media::FILTER_NONE, "none" },
+    { media::FILTER_BILINEAR_V, "bilinear-v" },
+    { media::FILTER_BILINEAR_H, "bilinear-h" },
+    { media::FILTER_BILINEAR, "bilinear" },
+  };
+  static const int kScalePercents[] = { 50, 100, 200 };
+
+  int saved_dest_width = dest_width;
+  int saved_dest_height = dest_height;
+  for (size_t i = 0; i < arraysize(kScalePercents); ++i) {
+    dest_width = source_width * kScalePercents[i] / 100;
+    dest_height = source_height * kScalePercents[i] / 100;
+    // kFilters has a local type, which arraysize() can't take.
+    for (size_t j = 0; j < ARRAYSIZE_UNSAFE(kFilters); ++j) {
+      std::cout << source_width << "x" << source_height << " -> "
+                << dest_width << "x" << dest_height << " "
+                << kFilters[j].name << ": "
+                << BenchmarkFilter(kFilters[j].filter)
+                << "ms/frame" << std::endl;
+    }
+  }
+  dest_width = saved_dest_width;
+  dest_height = saved_dest_height;
+}
+
 static double BenchmarkScaleWithRect() {
   std::vector<scoped_refptr<VideoFrame> > source_frames;
   std::vector<scoped_refptr<VideoFrame> > dest_frames;
@@ -211,6 +281,8 @@ int main(int argc, const char** argv) {
               << "Width of the destination image\n"
               << "  --dest-h=N                      "
               << "Height of the destination image\n"
+              << "  --matrix                        "
+              << "Time every filter at several scale factors\n"
               << std::endl;
     return 1;
   }
@@ -274,6 +346,11 @@ int main(int argc, const char** argv) {
             << "ms/frame" << std::endl;
   std::cout << "Bilinear with rect: " << BenchmarkScaleWithRect()
             << "ms/frame" << std::endl;
+  std::cout << "YUV To RGB: " << BenchmarkConvert()
+            << "ms/frame" << std::endl;
+
+  if (cmd_line->HasSwitch("matrix"))
+    BenchmarkMatrix();
 
   return 0;
 }
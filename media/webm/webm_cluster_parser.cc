@@ -46,10 +46,17 @@ void WebMClusterParser::Reset() {
 }
 
 int WebMClusterParser::Parse(const uint8* buf, int size) {
+  return Parse(NULL, buf, size);
+}
+
+int WebMClusterParser::Parse(const scoped_refptr<DataBuffer>& backing_buffer,
+                             const uint8* buf, int size) {
   audio_buffers_.clear();
   video_buffers_.clear();
 
+  backing_buffer_ = backing_buffer;
   int result = parser_.Parse(buf, size);
+  backing_buffer_ = NULL;
 
   if (result <= 0)
     return result;
@@ -118,8 +125,15 @@ bool WebMClusterParser::OnSimpleBlock(int track_num, int timecode,
   // The first bit of the flags is set when the block contains only keyframes.
   // http://www.matroska.org/technical/specs/index.html
   bool is_keyframe = (flags & 0x80) != 0;
-  scoped_refptr<StreamParserBuffer> buffer =
-      StreamParserBuffer::CopyFrom(data, size, is_keyframe);
+  scoped_refptr<StreamParserBuffer> buffer;
+  if (backing_buffer_ && size > 0 && data >= backing_buffer_->GetData() &&
+      data + size <=
+          backing_buffer_->GetData() + backing_buffer_->GetDataSize()) {
+    buffer = StreamParserBuffer::CreateSlice(backing_buffer_, data, size,
+                                             is_keyframe);
+  } else {
+    buffer = StreamParserBuffer::CopyFrom(data, size, is_keyframe);
+  }
 
   if (track_num == video_track_num_ && video_encryption_key_id_.get()) {
     buffer->SetDecryptConfig(scoped_ptr<DecryptConfig>(new DecryptConfig(
@@ -37,6 +37,11 @@ class WebMClusterParser : public WebMParserClient {
   // Returns the number of bytes parsed on success.
   int Parse(const uint8* buf, int size);
 
+  // Same as above, but the parsed buffers reference the data of
+  // |backing_buffer|, which must contain |buf|, instead of copying it.
+  int Parse(const scoped_refptr<DataBuffer>& backing_buffer,
+            const uint8* buf, int size);
+
   const BufferQueue& audio_buffers() const { return audio_buffers_; }
   const BufferQueue& video_buffers() const { return video_buffers_; }
 
@@ -59,6 +64,9 @@ class WebMClusterParser : public WebMParserClient {
 
   WebMListParser parser_;
 
+  // Only set during Parse().
+  scoped_refptr<DataBuffer> backing_buffer_;
+
   int64 last_block_timecode_;
 
   int64 cluster_timecode_;
@@ -6,6 +6,7 @@
 
 #include "base/callback.h"
 #include "base/logging.h"
+#include "media/base/data_buffer.h"
 #include "media/ffmpeg/ffmpeg_common.h"
 #include "media/filters/ffmpeg_glue.h"
 #include "media/filters/in_memory_url_protocol.h"
@@ -180,8 +181,24 @@ bool FFmpegConfigHelper::SetupStreamConfigs() {
   return !no_supported_streams;
 }
 
+// Returns a padded buffer holding [data1,data1+size1) followed by
+// [data2,data2+size2).
+static scoped_refptr<DataBuffer> JoinData(const uint8* data1, int size1,
+                                          const uint8* data2, int size2) {
+  int size = size1 + size2;
+  int buffer_size = size + FF_INPUT_BUFFER_PADDING_SIZE;
+  scoped_array<uint8> data(new uint8[buffer_size]);
+  memcpy(data.get(), data1, size1);
+  memcpy(data.get() + size1, data2, size2);
+  memset(data.get() + size, 0, FF_INPUT_BUFFER_PADDING_SIZE);
+  scoped_refptr<DataBuffer> buffer(new DataBuffer(data.Pass(), buffer_size));
+  buffer->SetDataSize(size);
+  return buffer;
+}
+
 WebMStreamParser::WebMStreamParser()
-    : state_(kWaitingForInit) {
+    : state_(kWaitingForInit),
+      pending_offset_(0) {
 }
 
 WebMStreamParser::~WebMStreamParser() {}
@@ -209,7 +226,8 @@ void WebMStreamParser::Init(const InitCB& init_cb,
 void WebMStreamParser::Flush() {
   DCHECK_NE(state_, kWaitingForInit);
 
-  byte_queue_.Reset();
+  pending_buffer_ = NULL;
+  pending_offset_ = 0;
 
   if (state_ != kParsingClusters)
     return;
@@ -218,19 +236,31 @@ void WebMStreamParser::Flush() {
 }
 
 bool WebMStreamParser::Parse(const uint8* buf, int size) {
+  return ParseBuffer(DataBuffer::CopyFrom(buf, size));
+}
+
+bool WebMStreamParser::ParseBuffer(const scoped_refptr<DataBuffer>& buffer) {
   DCHECK_NE(state_, kWaitingForInit);
 
   if (state_ == kError)
     return false;
 
-  byte_queue_.Push(buf, size);
+  // Parse straight out of |buffer| unless an element was split across
+  // appends.
+  scoped_refptr<DataBuffer> data = buffer;
+  if (pending_buffer_) {
+    data = JoinData(pending_buffer_->GetData() + pending_offset_,
+                    pending_buffer_->GetDataSize() - pending_offset_,
+                    buffer->GetData(), buffer->GetDataSize());
+    pending_buffer_ = NULL;
+    pending_offset_ = 0;
+  }
 
   int result = 0;
   int bytes_parsed = 0;
-  const uint8* cur = NULL;
-  int cur_size = 0;
+  const uint8* cur = data->GetData();
+  int cur_size = data->GetDataSize();
 
-  byte_queue_.Peek(&cur, &cur_size);
   do {
     switch (state_) {
       case kParsingHeaders:
@@ -238,7 +268,7 @@ bool WebMStreamParser::Parse(const uint8* buf, int size) {
         break;
 
       case kParsingClusters:
-        result = ParseCluster(cur, cur_size);
+        result = ParseCluster(data, cur, cur_size);
         break;
 
       case kWaitingForInit:
@@ -256,7 +286,10 @@ bool WebMStreamParser::Parse(const uint8* buf, int size) {
     bytes_parsed += result;
   } while (result > 0 && cur_size > 0);
 
-  byte_queue_.Pop(bytes_parsed);
+  if (cur_size > 0) {
+    pending_buffer_ = data;
+    pending_offset_ = bytes_parsed;
+  }
   return true;
 }
 
@@ -362,7 +395,8 @@ int WebMStreamParser::ParseInfoAndTracks(const uint8* data, int size) {
   return bytes_parsed;
 }
 
-int WebMStreamParser::ParseCluster(const uint8* data, int size) {
+int WebMStreamParser::ParseCluster(const scoped_refptr<DataBuffer>& buffer,
+                                   const uint8* data, int size) {
   if (!cluster_parser_.get())
     return -1;
 
@@ -382,7 +416,7 @@ int WebMStreamParser::ParseCluster(const uint8* data, int size) {
     return result + element_size;
   }
 
-  int bytes_parsed = cluster_parser_->Parse(data, size);
+  int bytes_parsed = cluster_parser_->Parse(buffer, data, size);
 
   if (bytes_parsed <= 0)
     return bytes_parsed;
@@ -9,7 +9,6 @@
 #include "base/memory/ref_counted.h"
 #include "media/base/audio_decoder_config.h"
 #include "media/base/buffers.h"
-#include "media/base/byte_queue.h"
 #include "media/base/stream_parser.h"
 #include "media/base/video_decoder_config.h"
 #include "media/webm/webm_cluster_parser.h"
@@ -28,6 +27,7 @@ class WebMStreamParser : public StreamParser {
                     const KeyNeededCB& key_needed_cb) OVERRIDE;
   virtual void Flush() OVERRIDE;
   virtual bool Parse(const uint8* buf, int size) OVERRIDE;
+  virtual bool ParseBuffer(const scoped_refptr<DataBuffer>& buffer) OVERRIDE;
 
  private:
   enum State {
@@ -56,7 +56,8 @@ class WebMStreamParser : public StreamParser {
   // Returns < 0 if the parse fails.
   // Returns 0 if more data is needed.
   // Returning > 0 indicates success & the number of bytes parsed.
-  int ParseCluster(const uint8* data, int size);
+  int ParseCluster(const scoped_refptr<DataBuffer>& buffer,
+                   const uint8* data, int size);
 
   State state_;
   InitCB init_cb_;
@@ -66,7 +67,12 @@ class WebMStreamParser : public StreamParser {
   KeyNeededCB key_needed_cb_;
 
   scoped_ptr<WebMClusterParser> cluster_parser_;
-  ByteQueue byte_queue_;
+
+  // The buffer the last parse stopped in, and the offset of the first byte
+  // that still needs to be parsed. The unparsed bytes are joined with the next
+  // appended buffer.
+  scoped_refptr<DataBuffer> pending_buffer_;
+  int pending_offset_;
 
   DISALLOW_COPY_AND_ASSIGN(WebMStreamParser);
 };
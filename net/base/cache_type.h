@@ -16,6 +16,14 @@ enum CacheType {
   APP_CACHE  // Backing store for an AppCache.
 };
 
+// The implementations of the disk cache that can be used.
+enum BackendType {
+  CACHE_BACKEND_DEFAULT,
+  CACHE_BACKEND_BLOCKFILE,  // Block files and an index, in a few big files.
+  CACHE_BACKEND_SIMPLE,  // One file per entry.
+  CACHE_BACKEND_TIERED  // Block files, with the hot entries kept in memory.
+};
+
 }  // namespace disk_cache
 
 #endif  // NET_BASE_CACHE_TYPE_H_
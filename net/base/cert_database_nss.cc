@@ -33,7 +33,9 @@ namespace psm = mozilla_security_manager;
 namespace net {
 
 CertDatabase::CertDatabase() {
-  crypto::EnsureNSSInit();
+  // The built-in roots are listed and edited along with the user's
+  // certificates.
+  crypto::EnsureNSSRootCertsInit();
   psm::EnsurePKCS12Init();
 }
 
@@ -693,6 +693,10 @@ int CertVerifyProcNSS::VerifyInternal(X509Certificate* cert,
                                       int flags,
                                       CRLSet* crl_set,
                                       CertVerifyResult* verify_result) {
+  // Chains are verified against NSS's built-in roots, which are loaded on
+  // first use.
+  crypto::EnsureNSSRootCertsInit();
+
   CERTCertificate* cert_handle = cert->os_cert_handle();
   // Make sure that the hostname matches with the common name of the cert.
   SECStatus status = CERT_VerifyCertName(cert_handle, hostname.c_str());
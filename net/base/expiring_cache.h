@@ -6,6 +6,7 @@
 #define NET_BASE_EXPIRING_CACHE_H_
 #pragma once
 
+#include <list>
 #include <map>
 #include <utility>
 
@@ -16,7 +17,8 @@
 namespace net {
 
 // Cache implementation where all entries have an explicit expiration policy. As
-// new items are added, expired items will be removed first.
+// new items are added, expired items will be removed first, followed by the
+// least recently used ones.
 // The template types have the following requirements:
 //  KeyType must be LessThanComparable, Assignable, and CopyConstructible.
 //  ValueType must be CopyConstructible and Assignable.
@@ -28,8 +30,19 @@ class ExpiringCache {
   // using EntryMap::const_iterator, while GCC and MSVC happily resolve the
   // typename.
 
-  // Tuple to represent the value and when it expires.
-  typedef std::pair<ValueType, base::TimeTicks> Entry;
+  // Keys from the most to the least recently used.
+  typedef std::list<KeyType> KeyList;
+
+  // The value, when it expires and where its key is on |lru_list_|.
+  struct Entry {
+    Entry(const ValueType& value, base::TimeTicks expiration,
+          typename KeyList::iterator position)
+        : value(value), expiration(expiration), position(position) {}
+
+    ValueType value;
+    base::TimeTicks expiration;
+    typename KeyList::iterator position;
+  };
   typedef std::map<KeyType, Entry> EntryMap;
 
  public:
@@ -49,8 +62,10 @@ class ExpiringCache {
     void Advance() { ++it_; }
 
     const KeyType& key() const { return it_->first; }
-    const ValueType& value() const { return it_->second.first; }
-    const base::TimeTicks& expiration() const { return it_->second.second; }
+    const ValueType& value() const { return it_->second.value; }
+    const base::TimeTicks& expiration() const {
+      return it_->second.expiration;
+    }
 
    private:
     const ExpiringCache& cache_;
@@ -72,17 +87,30 @@ class ExpiringCache {
   // Note: The returned pointer remains owned by the ExpiringCache and is
   // invalidated by a call to a non-const method.
   const ValueType* Get(const KeyType& key, base::TimeTicks now) {
+    base::TimeTicks expiration;
+    return GetStale(key, now, base::TimeDelta(), &expiration);
+  }
+
+  // Like Get(), but also returns values that expired less than |max_stale|
+  // before |now|. The time at which the value expires, or expired, is returned
+  // in |expiration|.
+  const ValueType* GetStale(const KeyType& key,
+                            base::TimeTicks now,
+                            base::TimeDelta max_stale,
+                            base::TimeTicks* expiration) {
     typename EntryMap::iterator it = entries_.find(key);
     if (it == entries_.end())
       return NULL;
 
     // Immediately remove expired entries.
-    if (!CanUseEntry(it->second, now)) {
-      entries_.erase(it);
+    if (!CanUseEntry(it->second, now - max_stale)) {
+      Erase(it);
       return NULL;
     }
 
-    return &it->second.first;
+    lru_list_.splice(lru_list_.begin(), lru_list_, it->second.position);
+    *expiration = it->second.expiration;
+    return &it->second.value;
   }
 
   // Updates or replaces the value associated with |key|.
@@ -98,17 +126,21 @@ class ExpiringCache {
         Compact(now);
 
       // No existing entry. Creating a new one.
-      entries_.insert(std::make_pair(key, Entry(value, expiration)));
+      lru_list_.push_front(key);
+      entries_.insert(
+          std::make_pair(key, Entry(value, expiration, lru_list_.begin())));
     } else {
       // Update an existing cache entry.
-      it->second.first = value;
-      it->second.second = expiration;
+      it->second.value = value;
+      it->second.expiration = expiration;
+      lru_list_.splice(lru_list_.begin(), lru_list_, it->second.position);
     }
   }
 
   // Empties the cache.
   void Clear() {
     entries_.clear();
+    lru_list_.clear();
   }
 
   // Returns the number of entries in the cache.
@@ -124,7 +156,12 @@ class ExpiringCache {
 
   // Returns true if this cache entry's result is valid at time |now|.
   static bool CanUseEntry(const Entry& entry, const base::TimeTicks now) {
-    return entry.second > now;
+    return entry.expiration > now;
+  }
+
+  void Erase(typename EntryMap::iterator it) {
+    lru_list_.erase(it->second.position);
+    entries_.erase(it);
   }
 
   // Prunes entries from the cache to bring it below |max_entries()|.
@@ -133,26 +170,22 @@ class ExpiringCache {
     typename EntryMap::iterator it;
     for (it = entries_.begin(); it != entries_.end(); ) {
       if (!CanUseEntry(it->second, now)) {
-        entries_.erase(it++);
+        Erase(it++);
       } else {
         ++it;
       }
     }
 
-    if (entries_.size() < max_entries_)
-      return;
-
-    // If the cache is still too full, start deleting items 'randomly'.
-    for (it = entries_.begin();
-         it != entries_.end() && entries_.size() >= max_entries_;) {
-      entries_.erase(it++);
-    }
+    // If the cache is still too full, delete the least recently used items.
+    while (!entries_.empty() && entries_.size() >= max_entries_)
+      Erase(entries_.find(lru_list_.back()));
   }
 
   // Bound on total size of the cache.
   size_t max_entries_;
 
   EntryMap entries_;
+  KeyList lru_list_;
 
   DISALLOW_COPY_AND_ASSIGN(ExpiringCache);
 };
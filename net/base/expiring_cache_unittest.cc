@@ -242,4 +242,32 @@ TEST(ExpiringCache, GetTruncatesExpiredEntries) {
   EXPECT_EQ(6U, cache.size());
 }
 
+TEST(ExpiringCacheTest, GetStale) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+  const base::TimeDelta kMaxStale = base::TimeDelta::FromSeconds(5);
+
+  Cache cache(kMaxCacheEntries);
+
+  // Add an entry at t=0, which expires at t=10.
+  base::TimeTicks now;
+  cache.Put("test1", "foo1", now, kTTL);
+
+  base::TimeTicks expiration;
+  EXPECT_THAT(cache.GetStale("test1", now, kMaxStale, &expiration),
+              Pointee(StrEq("foo1")));
+  EXPECT_EQ(now + kTTL, expiration);
+
+  // At t=12 the entry has expired, but it is still returned.
+  now += base::TimeDelta::FromSeconds(12);
+  EXPECT_THAT(cache.GetStale("test1", now, kMaxStale, &expiration),
+              Pointee(StrEq("foo1")));
+  EXPECT_LT(expiration, now);
+  EXPECT_EQ(1U, cache.size());
+
+  // At t=15 it is removed.
+  now += base::TimeDelta::FromSeconds(3);
+  EXPECT_FALSE(cache.GetStale("test1", now, kMaxStale, &expiration));
+  EXPECT_EQ(0U, cache.size());
+}
+
 }  // namespace net
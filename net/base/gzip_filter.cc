@@ -10,40 +10,108 @@
 #include "third_party/zlib/zlib.h"
 #endif
 
+#include <vector>
+
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/stl_util.h"
+#include "base/synchronization/lock.h"
 #include "net/base/gzip_header.h"
 
 namespace net {
 
+namespace {
+
+// The maximum number of idle zlib streams kept for reuse.  Each one holds on
+// to its inflate state and 32KB window.
+const size_t kMaxPooledStreams = 4;
+
+// Keeps the zlib streams of destroyed GZipFilters, so that new filters don't
+// have to allocate and initialize the inflate state again.  Most pages load
+// several compressed resources at once, so the streams are reused quickly.
+class InflateStreamPool {
+ public:
+  InflateStreamPool() {}
+
+  // Returns a stream ready to inflate data with |window_bits| (see
+  // inflateInit2), or NULL on failure.
+  z_stream* Acquire(int window_bits) {
+    z_stream* stream = NULL;
+    {
+      base::AutoLock lock(lock_);
+      if (!streams_.empty()) {
+        stream = streams_.back();
+        streams_.pop_back();
+      }
+    }
+    if (stream) {
+      if (inflateReset2(stream, window_bits) == Z_OK)
+        return stream;
+      Destroy(stream);
+    }
+
+    stream = new z_stream;
+    memset(stream, 0, sizeof(z_stream));
+    if (inflateInit2(stream, window_bits) != Z_OK) {
+      delete stream;
+      return NULL;
+    }
+    return stream;
+  }
+
+  // Takes back a stream returned by Acquire().
+  void Release(z_stream* stream) {
+    {
+      base::AutoLock lock(lock_);
+      if (streams_.size() < kMaxPooledStreams) {
+        streams_.push_back(stream);
+        return;
+      }
+    }
+    Destroy(stream);
+  }
+
+ private:
+  static void Destroy(z_stream* stream) {
+    inflateEnd(stream);
+    delete stream;
+  }
+
+  base::Lock lock_;
+  std::vector<z_stream*> streams_;
+
+  DISALLOW_COPY_AND_ASSIGN(InflateStreamPool);
+};
+
+base::LazyInstance<InflateStreamPool>::Leaky g_inflate_stream_pool =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
 GZipFilter::GZipFilter()
     : decoding_status_(DECODING_UNINITIALIZED),
       decoding_mode_(DECODE_MODE_UNKNOWN),
       gzip_header_status_(GZIP_CHECK_HEADER_IN_PROGRESS),
       zlib_header_added_(false),
       gzip_footer_bytes_(0),
+      zlib_stream_(NULL),
       possible_sdch_pass_through_(false) {
 }
 
 GZipFilter::~GZipFilter() {
-  if (decoding_status_ != DECODING_UNINITIALIZED) {
-    inflateEnd(zlib_stream_.get());
-  }
+  if (zlib_stream_)
+    g_inflate_stream_pool.Get().Release(zlib_stream_);
 }
 
 bool GZipFilter::InitDecoding(Filter::FilterType filter_type) {
   if (decoding_status_ != DECODING_UNINITIALIZED)
     return false;
 
-  // Initialize zlib control block
-  zlib_stream_.reset(new z_stream);
-  if (!zlib_stream_.get())
-    return false;
-  memset(zlib_stream_.get(), 0, sizeof(z_stream));
-
   // Set decoding mode
   switch (filter_type) {
     case Filter::FILTER_TYPE_DEFLATE: {
-      if (inflateInit(zlib_stream_.get()) != Z_OK)
+      zlib_stream_ = g_inflate_stream_pool.Get().Acquire(MAX_WBITS);
+      if (!zlib_stream_)
         return false;
       decoding_mode_ = DECODE_MODE_DEFLATE;
       break;
@@ -55,7 +123,8 @@ bool GZipFilter::InitDecoding(Filter::FilterType filter_type) {
       gzip_header_.reset(new GZipHeader());
       if (!gzip_header_.get())
         return false;
-      if (inflateInit2(zlib_stream_.get(), -MAX_WBITS) != Z_OK)
+      zlib_stream_ = g_inflate_stream_pool.Get().Acquire(-MAX_WBITS);
+      if (!zlib_stream_)
         return false;
       decoding_mode_ = DECODE_MODE_GZIP;
       break;
@@ -209,13 +278,13 @@ Filter::FilterStatus GZipFilter::DoInflate(char* dest_buffer, int* dest_len) {
   }
 
   // Fill in zlib control block
-  zlib_stream_.get()->next_in = bit_cast<Bytef*>(next_stream_data_);
-  zlib_stream_.get()->avail_in = stream_data_len_;
-  zlib_stream_.get()->next_out = bit_cast<Bytef*>(dest_buffer);
-  zlib_stream_.get()->avail_out = *dest_len;
+  zlib_stream_->next_in = bit_cast<Bytef*>(next_stream_data_);
+  zlib_stream_->avail_in = stream_data_len_;
+  zlib_stream_->next_out = bit_cast<Bytef*>(dest_buffer);
+  zlib_stream_->avail_out = *dest_len;
 
-  int inflate_code = inflate(zlib_stream_.get(), Z_NO_FLUSH);
-  int bytesWritten = *dest_len - zlib_stream_.get()->avail_out;
+  int inflate_code = inflate(zlib_stream_, Z_NO_FLUSH);
+  int bytesWritten = *dest_len - zlib_stream_->avail_out;
 
   Filter::FilterStatus status;
 
@@ -223,8 +292,8 @@ Filter::FilterStatus GZipFilter::DoInflate(char* dest_buffer, int* dest_len) {
     case Z_STREAM_END: {
       *dest_len = bytesWritten;
 
-      stream_data_len_ = zlib_stream_.get()->avail_in;
-      next_stream_data_ = bit_cast<char*>(zlib_stream_.get()->next_in);
+      stream_data_len_ = zlib_stream_->avail_in;
+      next_stream_data_ = bit_cast<char*>(zlib_stream_->next_in);
 
       SkipGZipFooter();
 
@@ -246,12 +315,12 @@ Filter::FilterStatus GZipFilter::DoInflate(char* dest_buffer, int* dest_len) {
       *dest_len = bytesWritten;
 
       // Check whether we have consumed all input data.
-      stream_data_len_ = zlib_stream_.get()->avail_in;
+      stream_data_len_ = zlib_stream_->avail_in;
       if (stream_data_len_ == 0) {
         next_stream_data_ = NULL;
         status = Filter::FILTER_NEED_MORE_DATA;
       } else {
-        next_stream_data_ = bit_cast<char*>(zlib_stream_.get()->next_in);
+        next_stream_data_ = bit_cast<char*>(zlib_stream_->next_in);
         status = Filter::FILTER_OK;
       }
       break;
@@ -274,13 +343,13 @@ bool GZipFilter::InsertZlibHeader() {
   if (zlib_header_added_)
     return false;
 
-  inflateReset(zlib_stream_.get());
-  zlib_stream_.get()->next_in = bit_cast<Bytef*>(&dummy_head[0]);
-  zlib_stream_.get()->avail_in = sizeof(dummy_head);
-  zlib_stream_.get()->next_out = bit_cast<Bytef*>(&dummy_output[0]);
-  zlib_stream_.get()->avail_out = sizeof(dummy_output);
+  inflateReset(zlib_stream_);
+  zlib_stream_->next_in = bit_cast<Bytef*>(&dummy_head[0]);
+  zlib_stream_->avail_in = sizeof(dummy_head);
+  zlib_stream_->next_out = bit_cast<Bytef*>(&dummy_output[0]);
+  zlib_stream_->avail_out = sizeof(dummy_output);
 
-  int code = inflate(zlib_stream_.get(), Z_NO_FLUSH);
+  int code = inflate(zlib_stream_, Z_NO_FLUSH);
   zlib_header_added_ = true;
 
   return (code == Z_OK);
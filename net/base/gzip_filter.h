@@ -133,7 +133,9 @@ class GZipFilter : public Filter {
   // The control block of zlib which actually does the decoding.
   // This data structure is initialized by InitDecoding and updated only by
   // DoInflate, with InsertZlibHeader being the exception as a workaround.
-  scoped_ptr<z_stream> zlib_stream_;
+  // It comes from a pool of streams shared by all GZipFilters, and goes back
+  // to it when the filter is destroyed.
+  z_stream* zlib_stream_;
 
   // For robustness, when we see the solo sdch filter, we chain in a gzip filter
   // in front of it, with this flag to indicate that the gzip decoding might not
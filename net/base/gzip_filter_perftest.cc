@@ -0,0 +1,127 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times decoding gzip responses of different sizes, from setting up the
+// filter to reading out the last byte.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#if defined(USE_SYSTEM_ZLIB)
+#include <zlib.h>
+#else
+#include "third_party/zlib/zlib.h"
+#endif
+
+#include "base/bind.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/path_service.h"
+#include "base/rand_util.h"
+#include "base/stringprintf.h"
+#include "base/test/perf_benchmark.h"
+#include "net/base/filter.h"
+#include "net/base/io_buffer.h"
+#include "net/base/mock_filter_context.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kOutputBufferSize = 32 * 1024;
+
+// Compresses |source| into a gzip stream.
+std::string GZipCompress(const std::string& source) {
+  z_stream zlib_stream;
+  memset(&zlib_stream, 0, sizeof(zlib_stream));
+  CHECK_EQ(Z_OK, deflateInit2(&zlib_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                              MAX_WBITS + 16,  // Write a gzip header.
+                              8,  // DEF_MEM_LEVEL
+                              Z_DEFAULT_STRATEGY));
+
+  std::string encoded(deflateBound(&zlib_stream, source.size()), '\0');
+  zlib_stream.next_in = reinterpret_cast<Bytef*>(
+      const_cast<char*>(source.data()));
+  zlib_stream.avail_in = source.size();
+  zlib_stream.next_out = reinterpret_cast<Bytef*>(&encoded[0]);
+  zlib_stream.avail_out = encoded.size();
+  CHECK_EQ(Z_STREAM_END, deflate(&zlib_stream, Z_FINISH));
+  encoded.resize(zlib_stream.total_out);
+  deflateEnd(&zlib_stream);
+  return encoded;
+}
+
+// Decodes all of |encoded| with a new gzip filter, feeding it as much input as
+// its stream buffer holds.
+void Decode(const FilterContext* filter_context,
+            const std::string& encoded,
+            int expected_len) {
+  std::vector<Filter::FilterType> filter_types;
+  filter_types.push_back(Filter::FILTER_TYPE_GZIP);
+  scoped_ptr<Filter> filter(Filter::Factory(filter_types, *filter_context));
+  CHECK(filter.get());
+
+  scoped_array<char> output(new char[kOutputBufferSize]);
+  size_t encoded_pos = 0;
+  int decoded_len = 0;
+  Filter::FilterStatus code = Filter::FILTER_NEED_MORE_DATA;
+  while (code != Filter::FILTER_DONE) {
+    if (code == Filter::FILTER_NEED_MORE_DATA) {
+      CHECK_LT(encoded_pos, encoded.size());
+      int len = std::min(static_cast<int>(encoded.size() - encoded_pos),
+                         filter->stream_buffer_size());
+      memcpy(filter->stream_buffer()->data(), encoded.data() + encoded_pos,
+             len);
+      filter->FlushStreamBuffer(len);
+      encoded_pos += len;
+    }
+    int output_len = kOutputBufferSize;
+    code = filter->ReadData(output.get(), &output_len);
+    CHECK_NE(Filter::FILTER_ERROR, code);
+    decoded_len += output_len;
+  }
+  CHECK_EQ(expected_len, decoded_len);
+}
+
+}  // namespace
+
+TEST(GZipFilterPerfTest, Decode) {
+  FilePath file_path;
+  PathService::Get(base::DIR_SOURCE_ROOT, &file_path);
+  file_path = file_path.AppendASCII("net");
+  file_path = file_path.AppendASCII("data");
+  file_path = file_path.AppendASCII("filter_unittests");
+  file_path = file_path.AppendASCII("google.txt");
+  std::string sample;
+  ASSERT_TRUE(file_util::ReadFileToString(file_path, &sample));
+  ASSERT_FALSE(sample.empty());
+
+  const int sample_len = static_cast<int>(sample.size());
+
+  MockFilterContext filter_context;
+  const int kSizes[] = { 1024, 16 * 1024, 256 * 1024, 1024 * 1024 };
+  const int kTotalBytes = 16 * 1024 * 1024;
+  for (size_t i = 0; i < arraysize(kSizes); ++i) {
+    // Compressible, text-like data.
+    std::string source;
+    while (static_cast<int>(source.size()) < kSizes[i]) {
+      source.append(sample, 0, base::RandInt(1, sample_len));
+      source.push_back(static_cast<char>(base::RandInt('a', 'z')));
+    }
+    source.resize(kSizes[i]);
+
+    base::PerfBenchmark benchmark(
+        base::StringPrintf("GZipFilter_Decode_%dKB", kSizes[i] / 1024));
+    benchmark.set_runs(10);
+    benchmark.set_iterations_per_run(
+        std::max(1, kTotalBytes / kSizes[i] / 10));
+    benchmark.Run(base::Bind(&Decode, &filter_context, GZipCompress(source),
+                             kSizes[i]));
+  }
+}
+
+}  // namespace net
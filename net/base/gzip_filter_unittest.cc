@@ -394,4 +394,38 @@ TEST_F(GZipUnitTest, DecodeCorruptedHeader) {
   EXPECT_TRUE(code == Filter::FILTER_ERROR);
 }
 
+// Tests that filters decode correctly with zlib streams reused from earlier
+// filters, including ones that were destroyed in the middle of a stream, after
+// an error, or with the other encoding.
+TEST_F(GZipUnitTest, ReuseInflateStreams) {
+  char decode_buffer[kDefaultBufferSize];
+  for (int i = 0; i < 3; ++i) {
+    // Leave a stream half-decoded.
+    InitFilter(Filter::FILTER_TYPE_GZIP);
+    int decode_size = kSmallBufferSize;
+    DecodeAllWithFilter(filter_.get(), gzip_encode_buffer_,
+                        gzip_encode_len_ / 2, decode_buffer, &decode_size);
+
+    // Leave a stream in an error state.
+    InitFilter(Filter::FILTER_TYPE_DEFLATE);
+    char corrupt_data[kDefaultBufferSize];
+    memcpy(corrupt_data, deflate_encode_buffer_, deflate_encode_len_);
+    corrupt_data[deflate_encode_len_ / 2] ^= 0xff;
+    decode_size = kDefaultBufferSize;
+    EXPECT_EQ(Filter::FILTER_ERROR,
+              DecodeAllWithFilter(filter_.get(), corrupt_data,
+                                  deflate_encode_len_, decode_buffer,
+                                  &decode_size));
+
+    InitFilter(Filter::FILTER_TYPE_DEFLATE);
+    DecodeAndCompareWithFilter(filter_.get(), source_buffer(), source_len(),
+                               deflate_encode_buffer_, deflate_encode_len_,
+                               kDefaultBufferSize);
+    InitFilter(Filter::FILTER_TYPE_GZIP);
+    DecodeAndCompareWithFilter(filter_.get(), source_buffer(), source_len(),
+                               gzip_encode_buffer_, gzip_encode_len_,
+                               kDefaultBufferSize);
+  }
+}
+
 }  // namespace net
@@ -34,7 +34,35 @@ const HostCache::Entry* HostCache::Lookup(const Key& key,
   if (caching_is_disabled())
     return NULL;
 
-  return entries_.Get(key, now);
+  base::TimeTicks expiration;
+  const Entry* entry = entries_.GetStale(key, now, max_stale_, &expiration);
+  if (!entry || expiration <= now)
+    return NULL;
+  return entry;
+}
+
+const HostCache::Entry* HostCache::LookupStale(const Key& key,
+                                               base::TimeTicks now,
+                                               base::TimeDelta* staleness) {
+  DCHECK(CalledOnValidThread());
+  if (caching_is_disabled())
+    return NULL;
+
+  base::TimeTicks expiration;
+  const Entry* entry = entries_.GetStale(key, now, max_stale_, &expiration);
+  if (!entry)
+    return NULL;
+
+  if (expiration > now) {
+    *staleness = base::TimeDelta();
+    return entry;
+  }
+
+  // Failures are not worth serving past their expiration.
+  if (entry->error != OK)
+    return NULL;
+  *staleness = now - expiration;
+  return entry;
 }
 
 void HostCache::Set(const Key& key,
@@ -59,6 +87,16 @@ size_t HostCache::size() const {
   return entries_.size();
 }
 
+void HostCache::set_max_stale(base::TimeDelta max_stale) {
+  DCHECK(CalledOnValidThread());
+  max_stale_ = max_stale;
+}
+
+base::TimeDelta HostCache::max_stale() const {
+  DCHECK(CalledOnValidThread());
+  return max_stale_;
+}
+
 size_t HostCache::max_entries() const {
   DCHECK(CalledOnValidThread());
   return entries_.max_entries();
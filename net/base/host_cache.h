@@ -65,6 +65,13 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   // |now|. If there is no such entry, returns NULL.
   const Entry* Lookup(const Key& key, base::TimeTicks now);
 
+  // Like Lookup(), but also returns a successful entry that expired less than
+  // max_stale() before |now|. |staleness| is set to how long ago the entry
+  // expired, or to zero if it is still valid.
+  const Entry* LookupStale(const Key& key,
+                           base::TimeTicks now,
+                           base::TimeDelta* staleness);
+
   // Overwrites or creates an entry for |key|.
   // (|error|, |addrlist|) is the value to set, |now| is the current time
   // |ttl| is the "time to live".
@@ -80,6 +87,11 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   // Returns the number of entries in the cache.
   size_t size() const;
 
+  // Keeps expired entries for up to |max_stale|, so that they can be returned
+  // by LookupStale(). Zero by default.
+  void set_max_stale(base::TimeDelta max_stale);
+  base::TimeDelta max_stale() const;
+
   // Following are used by net_internals UI.
   size_t max_entries() const;
 
@@ -100,6 +112,8 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   // a resolved result entry.
   EntryMap entries_;
 
+  base::TimeDelta max_stale_;
+
   DISALLOW_COPY_AND_ASSIGN(HostCache);
 };
 
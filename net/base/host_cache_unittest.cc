@@ -247,6 +247,73 @@ TEST(HostCacheTest, HostResolverFlagsArePartOfKey) {
   EXPECT_NE(cache.Lookup(key2, now), cache.Lookup(key3, now));
 }
 
+// Tests that expired entries are kept for max_stale(), and that only successful
+// entries are returned after they expire.
+TEST(HostCacheTest, Stale) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  HostCache cache(kMaxCacheEntries);
+  cache.set_max_stale(base::TimeDelta::FromSeconds(30));
+
+  // Start at t=0.
+  base::TimeTicks now;
+
+  HostCache::Key key1 = Key("foobar.com");
+  HostCache::Key key2 = Key("foobar2.com");
+  cache.Set(key1, OK, AddressList(), now, kTTL);
+  cache.Set(key2, ERR_NAME_NOT_RESOLVED, AddressList(), now, kTTL);
+
+  base::TimeDelta staleness = base::TimeDelta::FromSeconds(1);
+  EXPECT_TRUE(cache.LookupStale(key1, now, &staleness));
+  EXPECT_EQ(base::TimeDelta(), staleness);
+  EXPECT_TRUE(cache.LookupStale(key2, now, &staleness));
+
+  // Advance to t=15; both entries are expired.
+  now += base::TimeDelta::FromSeconds(15);
+  EXPECT_FALSE(cache.Lookup(key1, now));
+  EXPECT_FALSE(cache.Lookup(key2, now));
+
+  EXPECT_TRUE(cache.LookupStale(key1, now, &staleness));
+  EXPECT_EQ(base::TimeDelta::FromSeconds(5), staleness);
+  EXPECT_FALSE(cache.LookupStale(key2, now, &staleness));
+  EXPECT_EQ(2U, cache.size());
+
+  // Advance to t=40; key1 is too old to be used.
+  now += base::TimeDelta::FromSeconds(25);
+  EXPECT_FALSE(cache.LookupStale(key1, now, &staleness));
+  EXPECT_EQ(1U, cache.size());
+}
+
+// Tests that the least recently used entries are evicted first.
+TEST(HostCacheTest, EvictLeastRecentlyUsed) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  HostCache cache(3);
+
+  // Set t=0.
+  base::TimeTicks now;
+
+  cache.Set(Key("foobar1.com"), OK, AddressList(), now, kTTL);
+  cache.Set(Key("foobar2.com"), OK, AddressList(), now, kTTL);
+  cache.Set(Key("foobar3.com"), OK, AddressList(), now, kTTL);
+
+  // Make foobar1.com the most recently used entry, so that foobar2.com goes
+  // first.
+  EXPECT_TRUE(cache.Lookup(Key("foobar1.com"), now));
+  cache.Set(Key("foobar4.com"), OK, AddressList(), now, kTTL);
+  EXPECT_EQ(3U, cache.size());
+  EXPECT_FALSE(cache.Lookup(Key("foobar2.com"), now));
+  EXPECT_TRUE(cache.Lookup(Key("foobar1.com"), now));
+
+  // Overwriting an entry also counts as a use.
+  cache.Set(Key("foobar3.com"), OK, AddressList(), now, kTTL);
+  cache.Set(Key("foobar5.com"), OK, AddressList(), now, kTTL);
+  EXPECT_FALSE(cache.Lookup(Key("foobar4.com"), now));
+  EXPECT_TRUE(cache.Lookup(Key("foobar1.com"), now));
+  EXPECT_TRUE(cache.Lookup(Key("foobar3.com"), now));
+  EXPECT_TRUE(cache.Lookup(Key("foobar5.com"), now));
+}
+
 TEST(HostCacheTest, NoCache) {
   // Disable caching.
   const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
@@ -10,6 +10,7 @@
 #include <netdb.h>
 #endif
 
+#include <algorithm>
 #include <cmath>
 #include <utility>
 #include <vector>
@@ -326,6 +327,49 @@ class JobAttachParameters : public NetLog::EventParameters {
   const RequestPriority priority_;
 };
 
+// Parameters of the HOST_RESOLVER_IMPL_STALE_CACHE_HIT event.
+class StaleCacheHitParameters : public NetLog::EventParameters {
+ public:
+  explicit StaleCacheHitParameters(base::TimeDelta staleness)
+      : staleness_(staleness) {}
+
+  virtual Value* ToValue() const OVERRIDE {
+    DictionaryValue* dict = new DictionaryValue();
+    dict->SetInteger("staleness_ms",
+                     static_cast<int>(staleness_.InMilliseconds()));
+    return dict;
+  }
+
+ protected:
+  virtual ~StaleCacheHitParameters() {}
+
+ private:
+  const base::TimeDelta staleness_;
+};
+
+// Parameters of the HOST_RESOLVER_IMPL_CACHE_REFRESH event.
+class CacheRefreshParameters : public NetLog::EventParameters {
+ public:
+  CacheRefreshParameters(base::TimeDelta latency, int net_error)
+      : latency_(latency), net_error_(net_error) {}
+
+  virtual Value* ToValue() const OVERRIDE {
+    DictionaryValue* dict = new DictionaryValue();
+    dict->SetInteger("latency_ms",
+                     static_cast<int>(latency_.InMilliseconds()));
+    if (net_error_ != OK)
+      dict->SetInteger("net_error", net_error_);
+    return dict;
+  }
+
+ protected:
+  virtual ~CacheRefreshParameters() {}
+
+ private:
+  const base::TimeDelta latency_;
+  const int net_error_;
+};
+
 // Parameters of the DNS_CONFIG_CHANGED event.
 class DnsConfigParameters : public NetLog::EventParameters {
  public:
@@ -1043,7 +1087,8 @@ class HostResolverImpl::IPv6ProbeJob
 
 //-----------------------------------------------------------------------------
 
-// Resolves the hostname using DnsTransaction.
+// Resolves the hostname using DnsTransaction. For ADDRESS_FAMILY_UNSPECIFIED
+// the A and AAAA queries are sent in parallel, and their addresses merged.
 // TODO(szym): This could be moved to separate source file as well.
 class HostResolverImpl::DnsTask {
  public:
@@ -1059,65 +1104,144 @@ class HostResolverImpl::DnsTask {
     DCHECK(factory);
     DCHECK(!callback.is_null());
 
-    // For now we treat ADDRESS_FAMILY_UNSPEC as if it was IPV4.
-    uint16 qtype = (key.address_family == ADDRESS_FAMILY_IPV6)
-                   ? dns_protocol::kTypeAAAA
-                   : dns_protocol::kTypeA;
     // TODO(szym): Implement "happy eyeballs".
-    transaction_ = factory->CreateTransaction(
-        key.hostname,
-        qtype,
-        base::Bind(&DnsTask::OnTransactionComplete, base::Unretained(this),
-                   base::TimeTicks::Now()),
-        net_log_);
-    DCHECK(transaction_.get());
+    if (key.address_family != ADDRESS_FAMILY_IPV6) {
+      transactions_[QUERY_A] = factory->CreateTransaction(
+          key.hostname,
+          dns_protocol::kTypeA,
+          base::Bind(&DnsTask::OnTransactionComplete, base::Unretained(this),
+                     QUERY_A, base::TimeTicks::Now()),
+          net_log_);
+      DCHECK(transactions_[QUERY_A].get());
+    }
+    if (key.address_family != ADDRESS_FAMILY_IPV4) {
+      transactions_[QUERY_AAAA] = factory->CreateTransaction(
+          key.hostname,
+          dns_protocol::kTypeAAAA,
+          base::Bind(&DnsTask::OnTransactionComplete, base::Unretained(this),
+                     QUERY_AAAA, base::TimeTicks::Now()),
+          net_log_);
+      DCHECK(transactions_[QUERY_AAAA].get());
+    }
   }
 
   int Start() {
     net_log_.BeginEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK, NULL);
-    return transaction_->Start();
+    for (int i = 0; i < NUM_QUERIES; ++i) {
+      if (!transactions_[i].get())
+        continue;
+      results_[i].net_error = ERR_IO_PENDING;
+      int rv = transactions_[i]->Start();
+      if (rv != ERR_IO_PENDING) {
+        // Cancel the other query too, the owning Job falls back to ProcTask.
+        for (int j = 0; j < NUM_QUERIES; ++j)
+          transactions_[j].reset();
+        net_log_.EndEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK,
+                          new DnsTaskFailedParams(rv,
+                                                  DnsResponse::DNS_SUCCESS));
+        return rv;
+      }
+    }
+    return ERR_IO_PENDING;
   }
 
-  void OnTransactionComplete(const base::TimeTicks& start_time,
+  void OnTransactionComplete(int query,
+                             const base::TimeTicks& start_time,
                              DnsTransaction* transaction,
                              int net_error,
                              const DnsResponse* response) {
     DCHECK(transaction);
-    // Run |callback_| last since the owning Job will then delete this DnsTask.
-    DnsResponse::Result result = DnsResponse::DNS_SUCCESS;
+    DCHECK_EQ(transactions_[query].get(), transaction);
+    QueryResult& result = results_[query];
+    result.net_error = net_error;
     if (net_error == OK) {
       CHECK(response);
       DNS_HISTOGRAM("AsyncDNS.TransactionSuccess",
                     base::TimeTicks::Now() - start_time);
-      AddressList addr_list;
-      base::TimeDelta ttl;
-      result = response->ParseToAddressList(&addr_list, &ttl);
+      result.dns_error = response->ParseToAddressList(&result.addr_list,
+                                                      &result.ttl);
       UMA_HISTOGRAM_ENUMERATION("AsyncDNS.ParseToAddressList",
-                                result,
+                                result.dns_error,
                                 DnsResponse::DNS_PARSE_RESULT_MAX);
-      if (result == DnsResponse::DNS_SUCCESS) {
-        net_log_.EndEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK,
-                          new AddressListNetLogParam(addr_list));
-        callback_.Run(net_error, addr_list, ttl);
-        return;
-      }
-      net_error = ERR_DNS_MALFORMED_RESPONSE;
+      if (result.dns_error != DnsResponse::DNS_SUCCESS)
+        result.net_error = ERR_DNS_MALFORMED_RESPONSE;
     } else {
       DNS_HISTOGRAM("AsyncDNS.TransactionFailure",
                     base::TimeTicks::Now() - start_time);
     }
-    net_log_.EndEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK,
-                      new DnsTaskFailedParams(net_error, result));
-    callback_.Run(net_error, AddressList(), base::TimeDelta());
+
+    for (int i = 0; i < NUM_QUERIES; ++i) {
+      if (results_[i].net_error == ERR_IO_PENDING)
+        return;
+    }
+    OnQueriesComplete();
   }
 
  private:
+  enum Query {
+    QUERY_A,
+    QUERY_AAAA,
+    NUM_QUERIES,
+  };
+
+  // The outcome of one of the queries.
+  struct QueryResult {
+    // Queries that are not sent count as failed.
+    QueryResult()
+        : net_error(ERR_NAME_NOT_RESOLVED),
+          dns_error(DnsResponse::DNS_SUCCESS) {}
+
+    int net_error;
+    DnsResponse::Result dns_error;
+    AddressList addr_list;
+    base::TimeDelta ttl;
+  };
+
+  // Merges the results of the queries. The lookup succeeds if any query
+  // found addresses, since hosts often lack one of the families.
+  void OnQueriesComplete() {
+    AddressList addr_list;
+    base::TimeDelta ttl;
+    const QueryResult* failure = NULL;
+    for (int i = 0; i < NUM_QUERIES; ++i) {
+      const QueryResult& result = results_[i];
+      if (result.net_error != OK) {
+        if (!failure && transactions_[i].get())
+          failure = &result;
+        continue;
+      }
+      // IPv4 addresses come first, as getaddrinfo would list them without a
+      // way to tell whether IPv6 connectivity is any good.
+      if (!addr_list.head()) {
+        addr_list = result.addr_list;
+        ttl = result.ttl;
+      } else {
+        addr_list.Append(result.addr_list.head());
+        ttl = std::min(ttl, result.ttl);
+      }
+    }
+
+    // Run |callback_| last since the owning Job will then delete this DnsTask.
+    if (addr_list.head()) {
+      net_log_.EndEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK,
+                        new AddressListNetLogParam(addr_list));
+      callback_.Run(OK, addr_list, ttl);
+      return;
+    }
+    DCHECK(failure);
+    net_log_.EndEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK,
+                      new DnsTaskFailedParams(failure->net_error,
+                                              failure->dns_error));
+    callback_.Run(failure->net_error, AddressList(), base::TimeDelta());
+  }
+
   // The listener to the results of this DnsTask.
   Callback callback_;
 
   const BoundNetLog net_log_;
 
-  scoped_ptr<DnsTransaction> transaction_;
+  scoped_ptr<DnsTransaction> transactions_[NUM_QUERIES];
+  QueryResult results_[NUM_QUERIES];
 };
 
 //-----------------------------------------------------------------------------
@@ -1134,6 +1258,8 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
         key_(key),
         had_non_speculative_request_(false),
         had_dns_config_(false),
+        is_refresh_(false),
+        creation_time_(base::TimeTicks::Now()),
         net_log_(BoundNetLog::Make(request_net_log.net_log(),
                                    NetLog::SOURCE_HOST_RESOLVER_IMPL_JOB)) {
     request_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_CREATE_JOB, NULL);
@@ -1181,6 +1307,12 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
     handle_ = resolver_->dispatcher_.Add(this, priority);
   }
 
+  // Makes this job update the cache even if it has no Requests, because it was
+  // created to refresh an expired entry.
+  void MarkAsRefresh() {
+    is_refresh_ = true;
+  }
+
   void AddRequest(scoped_ptr<Request> req) {
     DCHECK_EQ(key_.hostname, req->info().hostname());
 
@@ -1227,7 +1359,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
         make_scoped_refptr(new JobAttachParameters(
             req->request_net_log().source(), priority())));
 
-    if (num_active_requests() > 0) {
+    if (num_active_requests() > 0 || is_refresh_) {
       if (is_queued())
         handle_ = resolver_->dispatcher_.ChangePriority(handle_, priority());
     } else {
@@ -1263,7 +1395,9 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
   // Attempts to serve the job from HOSTS. Returns true if succeeded and
   // this Job was destroyed.
   bool ServeFromHosts() {
-    DCHECK_GT(num_active_requests(), 0u);
+    DCHECK(num_active_requests() > 0 || is_refresh_);
+    if (requests_.empty())
+      return false;
     AddressList addr_list;
     if (resolver_->ServeFromHosts(key(),
                                   requests_->front()->info(),
@@ -1336,8 +1470,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
       }
     }
 
-    base::TimeDelta ttl = base::TimeDelta::FromSeconds(
-        kNegativeCacheEntryTTLSeconds);
+    base::TimeDelta ttl = resolver_->negative_cache_ttl_;
     if (net_error == OK)
       ttl = base::TimeDelta::FromSeconds(kCacheEntryTTLSeconds);
 
@@ -1415,21 +1548,27 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
       handle_.Reset();
     }
 
-    if (num_active_requests() == 0) {
+    if (num_active_requests() == 0 && !is_refresh_) {
       net_log_.AddEvent(NetLog::TYPE_CANCELLED, NULL);
       net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HOST_RESOLVER_IMPL_JOB,
                                         OK);
       return;
     }
 
+    if (is_refresh_) {
+      net_log_.AddEvent(
+          NetLog::TYPE_HOST_RESOLVER_IMPL_CACHE_REFRESH,
+          make_scoped_refptr(new CacheRefreshParameters(
+              base::TimeTicks::Now() - creation_time_, net_error)));
+    }
     net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HOST_RESOLVER_IMPL_JOB,
                                       net_error);
 
-    DCHECK(!requests_.empty());
+    DCHECK(!requests_.empty() || is_refresh_);
 
     // We are the only consumer of |list|, so we can safely change the port
     // without copy-on-write. This pays off, when job has only one request.
-    if (net_error == OK)
+    if (net_error == OK && !requests_.empty())
       MutableSetPort(requests_->front()->info().port(), &list);
 
     if ((net_error != ERR_ABORTED) &&
@@ -1488,6 +1627,11 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
   // True if resolver had DnsConfig when the Job was started.
   bool had_dns_config_;
 
+  // True if the Job was created to refresh an expired cache entry.
+  bool is_refresh_;
+
+  base::TimeTicks creation_time_;
+
   BoundNetLog net_log_;
 
   // Resolves the host using a HostResolverProc.
@@ -1526,6 +1670,8 @@ HostResolverImpl::HostResolverImpl(
       dispatcher_(job_limits),
       max_queued_jobs_(job_limits.total_jobs * 100u),
       proc_params_(proc_params),
+      negative_cache_ttl_(
+          base::TimeDelta::FromSeconds(kNegativeCacheEntryTTLSeconds)),
       default_address_family_(ADDRESS_FAMILY_UNSPECIFIED),
       dns_client_(NULL),
       dns_config_service_(dns_config_service.Pass()),
@@ -1582,6 +1728,11 @@ void HostResolverImpl::SetMaxQueuedJobs(size_t value) {
   max_queued_jobs_ = value;
 }
 
+void HostResolverImpl::SetNegativeCacheTTL(base::TimeDelta ttl) {
+  DCHECK(CalledOnValidThread());
+  negative_cache_ttl_ = ttl;
+}
+
 int HostResolverImpl::Resolve(const RequestInfo& info,
                               AddressList* addresses,
                               const CompletionCallback& callback,
@@ -1660,8 +1811,17 @@ int HostResolverImpl::ResolveHelper(const Key& key,
   int net_error = ERR_UNEXPECTED;
   if (ResolveAsIP(key, info, &net_error, addresses))
     return net_error;
-  if (ServeFromCache(key, info, &net_error, addresses)) {
-    request_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_CACHE_HIT, NULL);
+  base::TimeDelta staleness;
+  if (ServeFromCache(key, info, &net_error, addresses, &staleness)) {
+    if (staleness > base::TimeDelta()) {
+      request_net_log.AddEvent(
+          NetLog::TYPE_HOST_RESOLVER_IMPL_STALE_CACHE_HIT,
+          make_scoped_refptr(new StaleCacheHitParameters(staleness)));
+      RefreshCacheEntry(key, request_net_log);
+    } else {
+      request_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_CACHE_HIT,
+                               NULL);
+    }
     return net_error;
   }
   // TODO(szym): Do not do this if nsswitch.conf instructs not to.
@@ -1768,14 +1928,16 @@ bool HostResolverImpl::ResolveAsIP(const Key& key,
 bool HostResolverImpl::ServeFromCache(const Key& key,
                                       const RequestInfo& info,
                                       int* net_error,
-                                      AddressList* addresses) {
+                                      AddressList* addresses,
+                                      base::TimeDelta* staleness) {
   DCHECK(addresses);
   DCHECK(net_error);
+  DCHECK(staleness);
   if (!info.allow_cached_response() || !cache_.get())
     return false;
 
-  const HostCache::Entry* cache_entry = cache_->Lookup(
-      key, base::TimeTicks::Now());
+  const HostCache::Entry* cache_entry = cache_->LookupStale(
+      key, base::TimeTicks::Now(), staleness);
   if (!cache_entry)
     return false;
 
@@ -1826,6 +1988,20 @@ void HostResolverImpl::CacheResult(const Key& key,
     cache_->Set(key, net_error, addr_list, base::TimeTicks::Now(), ttl);
 }
 
+void HostResolverImpl::RefreshCacheEntry(const Key& key,
+                                         const BoundNetLog& request_net_log) {
+  // Refreshing is not worth growing the queue when the resolver is busy.
+  if (ContainsKey(jobs_, key) ||
+      dispatcher_.num_queued_jobs() >= max_queued_jobs_) {
+    return;
+  }
+
+  Job* job = new Job(this, key, request_net_log);
+  job->MarkAsRefresh();
+  job->Schedule(MINIMUM_PRIORITY);
+  jobs_.insert(std::make_pair(key, job));
+}
+
 void HostResolverImpl::RemoveJob(Job* job) {
   DCHECK(job);
   JobMap::iterator it = jobs_.find(job->key());
@@ -129,6 +129,10 @@ class NET_EXPORT HostResolverImpl
   // Only allowed when the queue is empty.
   void SetMaxQueuedJobs(size_t value);
 
+  // Configures how long failed resolutions are cached. By default, they are
+  // not cached.
+  void SetNegativeCacheTTL(base::TimeDelta ttl);
+
   // HostResolver methods:
   virtual int Resolve(const RequestInfo& info,
                       AddressList* addresses,
@@ -178,11 +182,13 @@ class NET_EXPORT HostResolverImpl
 
   // If |key| is not found in cache returns false, otherwise returns
   // true, sets |net_error| to the cached error code and fills |addresses|
-  // if it is a positive entry.
+  // if it is a positive entry. |staleness| is set to how long ago the entry
+  // expired, when the cache is allowed to return expired entries.
   bool ServeFromCache(const Key& key,
                       const RequestInfo& info,
                       int* net_error,
-                      AddressList* addresses);
+                      AddressList* addresses,
+                      base::TimeDelta* staleness);
 
   // If |key| is not found in the HOSTS file or no HOSTS file known, returns
   // false, otherwise returns true and fills |addresses|.
@@ -207,6 +213,10 @@ class NET_EXPORT HostResolverImpl
                    const AddressList& addr_list,
                    base::TimeDelta ttl);
 
+  // Starts a low priority Job to update the expired cache entry for |key|,
+  // unless the key is already being resolved.
+  void RefreshCacheEntry(const Key& key, const BoundNetLog& request_net_log);
+
   // Removes |job| from |jobs_|, only if it exists.
   void RemoveJob(Job* job);
 
@@ -249,6 +259,9 @@ class NET_EXPORT HostResolverImpl
   // Parameters for ProcTask.
   ProcTaskParams proc_params_;
 
+  // TTL of the cache entries for failed resolutions.
+  base::TimeDelta negative_cache_ttl_;
+
   // Address family to use when the request doesn't specify one.
   AddressFamily default_address_family_;
 
@@ -541,6 +541,10 @@ class HostResolverImplTest : public testing::Test {
     resolver_->set_dns_client_for_tests(client.Pass());
   }
 
+  HostCache::Key GetEffectiveKey(const HostResolver::RequestInfo& info) const {
+    return resolver_->GetEffectiveKeyForRequest(info);
+  }
+
   scoped_refptr<MockHostResolverProc> proc_;
   scoped_ptr<HostResolverImpl> resolver_;
   ScopedVector<Request> requests_;
@@ -1208,6 +1212,88 @@ TEST_F(HostResolverImplTest, ResolveFromCache) {
   EXPECT_TRUE(requests_[2]->HasOneAddress("192.168.1.42", 80));
 }
 
+TEST_F(HostResolverImplTest, NegativeCacheTTL) {
+  proc_->AddRuleForAllFamilies("", "0.0.0.0");  // Default to failures.
+  proc_->SignalMultiple(1u);
+  resolver_->SetNegativeCacheTTL(base::TimeDelta::FromMinutes(1));
+
+  Request* req = CreateRequest("just.testing", 80);
+  EXPECT_EQ(ERR_IO_PENDING, req->Resolve());
+  EXPECT_EQ(ERR_NAME_NOT_RESOLVED, req->WaitForResult());
+
+  // The error is served from the cache.
+  EXPECT_EQ(ERR_NAME_NOT_RESOLVED, req->ResolveFromCache());
+  EXPECT_EQ(1u, proc_->GetCaptureList().size());
+}
+
+// Tests that an expired entry is served while it is refreshed.
+TEST_F(HostResolverImplTest, StaleWhileRevalidate) {
+  proc_->AddRuleForAllFamilies("just.testing", "192.168.1.42");
+
+  HostCache* cache = resolver_->GetHostCache();
+  cache->set_max_stale(base::TimeDelta::FromHours(1));
+
+  HostResolver::RequestInfo info(HostPortPair("just.testing", 80));
+  AddressList old_addresses;
+  ASSERT_EQ(OK, ParseAddressList("192.168.1.1", "", &old_addresses));
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(60);
+  cache->Set(GetEffectiveKey(info), OK, old_addresses,
+             base::TimeTicks::Now() - 2 * kTTL, kTTL);
+
+  // The expired entry is returned, and a Job is started to refresh it.
+  EXPECT_EQ(OK, CreateRequest(info)->Resolve());
+  EXPECT_TRUE(requests_[0]->HasOneAddress("192.168.1.1", 80));
+  EXPECT_TRUE(proc_->WaitFor(1u));
+
+  // Further requests do not start another Job.
+  EXPECT_EQ(OK, CreateRequest(info)->Resolve());
+
+  // A request that bypasses the cache waits for the refresh.
+  info.set_allow_cached_response(false);
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest(info)->Resolve());
+  proc_->SignalMultiple(1u);
+  EXPECT_EQ(OK, requests_[2]->WaitForResult());
+  EXPECT_EQ(1u, proc_->GetCaptureList().size());
+
+  // The cache now has the new result.
+  info.set_allow_cached_response(true);
+  EXPECT_EQ(OK, CreateRequest(info)->ResolveFromCache());
+  EXPECT_TRUE(requests_[3]->HasOneAddress("192.168.1.42", 80));
+}
+
+// Tests that a refresh continues without any request attached.
+TEST_F(HostResolverImplTest, RefreshWithoutRequests) {
+  proc_->AddRuleForAllFamilies("just.testing", "192.168.1.42");
+
+  HostCache* cache = resolver_->GetHostCache();
+  cache->set_max_stale(base::TimeDelta::FromHours(1));
+
+  HostResolver::RequestInfo info(HostPortPair("just.testing", 80));
+  AddressList old_addresses;
+  ASSERT_EQ(OK, ParseAddressList("192.168.1.1", "", &old_addresses));
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(60);
+  cache->Set(GetEffectiveKey(info), OK, old_addresses,
+             base::TimeTicks::Now() - 2 * kTTL, kTTL);
+
+  EXPECT_EQ(OK, CreateRequest(info)->ResolveFromCache());
+  EXPECT_TRUE(proc_->WaitFor(1u));
+
+  // Attach and cancel a request; the refresh must not be aborted.
+  info.set_allow_cached_response(false);
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest(info)->Resolve());
+  requests_[1]->Cancel();
+  proc_->SignalMultiple(1u);
+
+  info.set_allow_cached_response(true);
+  base::TimeTicks start = base::TimeTicks::Now();
+  while (!cache->Lookup(GetEffectiveKey(info), base::TimeTicks::Now())) {
+    ASSERT_LT(base::TimeTicks::Now() - start, TestTimeouts::action_timeout());
+    MessageLoop::current()->RunAllPending();
+  }
+  EXPECT_EQ(OK, CreateRequest(info)->ResolveFromCache());
+  EXPECT_TRUE(requests_[2]->HasOneAddress("192.168.1.42", 80));
+}
+
 // Test the retry attempts simulating host resolver proc that takes too long.
 TEST_F(HostResolverImplTest, MultipleAttempts) {
   // Total number of attempts would be 3 and we want the 3rd attempt to resolve
@@ -1293,8 +1379,10 @@ TEST_F(HostResolverImplTest, DnsTask) {
   }
 
   EXPECT_EQ(OK, requests_[1]->result());
-  // Resolved by MockDnsClient.
-  EXPECT_TRUE(requests_[1]->HasOneAddress("127.0.0.1", 80));
+  // Resolved by MockDnsClient, which answers both A and AAAA queries.
+  EXPECT_EQ(2u, requests_[1]->NumberOfAddresses());
+  EXPECT_TRUE(requests_[1]->HasAddress("127.0.0.1", 80));
+  EXPECT_TRUE(requests_[1]->HasAddress("::1", 80));
   EXPECT_EQ(ERR_NAME_NOT_RESOLVED, requests_[2]->result());
   EXPECT_EQ(ERR_NAME_NOT_RESOLVED, requests_[3]->result());
   EXPECT_EQ(OK, requests_[4]->result());
@@ -1303,6 +1391,21 @@ TEST_F(HostResolverImplTest, DnsTask) {
   EXPECT_TRUE(requests_[5]->HasOneAddress("192.168.1.102", 80));
 }
 
+// Test that DnsTask only sends the queries for the requested address family.
+TEST_F(HostResolverImplTest, DnsTaskAddressFamily) {
+  set_dns_client(CreateMockDnsClient(CreateValidDnsConfig()));
+
+  EXPECT_EQ(ERR_IO_PENDING,
+            CreateRequest("ok", 80, MEDIUM, ADDRESS_FAMILY_IPV4)->Resolve());
+  EXPECT_EQ(ERR_IO_PENDING,
+            CreateRequest("ok", 80, MEDIUM, ADDRESS_FAMILY_IPV6)->Resolve());
+
+  EXPECT_EQ(OK, requests_[0]->WaitForResult());
+  EXPECT_EQ(OK, requests_[1]->WaitForResult());
+  EXPECT_TRUE(requests_[0]->HasOneAddress("127.0.0.1", 80));
+  EXPECT_TRUE(requests_[1]->HasOneAddress("::1", 80));
+}
+
 TEST_F(HostResolverImplTest, ServeFromHosts) {
   // Initially, there's DnsConfigService, but no DnsConfig.
   MockDnsConfigService* config_service = new MockDnsConfigService();
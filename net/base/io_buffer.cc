@@ -39,6 +39,18 @@ IOBufferWithSize::IOBufferWithSize(char* data, int size)
 IOBufferWithSize::~IOBufferWithSize() {
 }
 
+IOBufferSlice::IOBufferSlice(IOBuffer* base, int offset, int size)
+    : IOBufferWithSize(base->data() + offset, size),
+      base_(base) {
+  DCHECK_GE(offset, 0);
+  DCHECK_GE(size, 0);
+}
+
+IOBufferSlice::~IOBufferSlice() {
+  // The buffer is owned by the |base_| instance.
+  data_ = NULL;
+}
+
 StringIOBuffer::StringIOBuffer(const std::string& s)
     : IOBuffer(static_cast<char*>(NULL)),
       string_data_(s) {
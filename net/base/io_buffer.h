@@ -110,6 +110,19 @@ class NET_EXPORT IOBufferWithSize : public IOBuffer {
   int size_;
 };
 
+// This version refers to |size| bytes at |offset| of another IOBuffer, and
+// keeps that buffer alive. It is useful to hand out parts of a buffer that
+// was read from the network without copying them.
+class NET_EXPORT IOBufferSlice : public IOBufferWithSize {
+ public:
+  IOBufferSlice(IOBuffer* base, int offset, int size);
+
+ private:
+  virtual ~IOBufferSlice();
+
+  scoped_refptr<IOBuffer> base_;
+};
+
 // This is a read only IOBuffer.  The data is stored in a string and
 // the IOBuffer interface does not provide a proper way to modify it.
 class NET_EXPORT StringIOBuffer : public IOBuffer {
@@ -0,0 +1,71 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_BASE_LOAD_TIMING_INFO_H_
+#define NET_BASE_LOAD_TIMING_INFO_H_
+#pragma once
+
+#include "base/time.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+// Structure containing the timing information of a request.  It is filled in
+// as the request goes through the URLRequestJob, the HttpTransaction and the
+// ClientSocketHandle, so consumers don't have to parse the NetLog to get a
+// latency breakdown.
+//
+// A null time means that the corresponding phase didn't happen.  For instance,
+// a request sent on a reused socket has no DNS or connect times, and a
+// response read from the cache has no send times.
+struct NET_EXPORT LoadTimingInfo {
+  // Times spent setting up a new connection.  They are only reported to the
+  // request that caused the connection to be established.
+  struct NET_EXPORT ConnectTiming {
+    ConnectTiming();
+    ~ConnectTiming();
+
+    // Host resolution.  Null when the connection was to a proxy resolved by
+    // another pool, or when the address was already known.
+    base::TimeTicks dns_start;
+    base::TimeTicks dns_end;
+
+    // Connection establishment, including any SOCKS or HTTP tunnel and the SSL
+    // handshake.  It starts after host resolution completes.
+    base::TimeTicks connect_start;
+    base::TimeTicks connect_end;
+
+    // SSL handshake, within [connect_start, connect_end].
+    base::TimeTicks ssl_start;
+    base::TimeTicks ssl_end;
+  };
+
+  LoadTimingInfo();
+  ~LoadTimingInfo();
+
+  // True if the request was sent on a socket that had already carried another
+  // request.  |connect_timing| is empty in that case.
+  bool socket_reused;
+
+  // The time URLRequest::Start() was called.
+  base::TimeTicks request_start;
+
+  ConnectTiming connect_timing;
+
+  // Sending the request headers and body.
+  base::TimeTicks send_start;
+  base::TimeTicks send_end;
+
+  // The time the response headers were received from the network.
+  base::TimeTicks receive_headers_end;
+
+  // Reading the response info from the cache, including the entries that are
+  // only validated against the network.
+  base::TimeTicks cache_read_start;
+  base::TimeTicks cache_read_end;
+};
+
+}  // namespace net
+
+#endif  // NET_BASE_LOAD_TIMING_INFO_H_
@@ -68,11 +68,19 @@ namespace net {
 //
 // On a cache hit, MultiThreadedCertVerifier::Verify() returns synchronously
 // without posting a task to a worker thread.
+//
+// When max_concurrent_jobs_ jobs are already running, the new job is queued
+// in pending_jobs_ instead of being started, and HandleResult() starts it once
+// a running job completes.
 
 namespace {
 
-// The default value of max_cache_entries_.
-const unsigned kMaxCacheEntries = 256;
+// The default value of max_cache_entries_.  A page load can easily involve
+// dozens of origins, each with their own chain.
+const unsigned kMaxCacheEntries = 1024;
+
+// The default value of max_concurrent_jobs_.
+const size_t kMaxConcurrentJobs = 4;
 
 // The number of seconds for which we'll cache a cache entry.
 const unsigned kTTLSecs = 1800;  // 30 minutes.
@@ -138,8 +146,10 @@ class CertVerifierWorker {
                      const std::string& hostname,
                      int flags,
                      CRLSet* crl_set,
+                     const MultiThreadedCertVerifier::RequestParams& key,
                      MultiThreadedCertVerifier* cert_verifier)
       : verify_proc_(verify_proc),
+        key_(key),
         cert_(cert),
         hostname_(hostname),
         flags_(flags),
@@ -198,8 +208,7 @@ class CertVerifierWorker {
       // memory leaks or worse errors.
       base::AutoLock locked(lock_);
       if (!canceled_) {
-        cert_verifier_->HandleResult(cert_, hostname_, flags_,
-                                     error_, verify_result_);
+        cert_verifier_->HandleResult(key_, error_, verify_result_);
       }
     }
     delete this;
@@ -233,6 +242,7 @@ class CertVerifierWorker {
   }
 
   scoped_refptr<CertVerifyProc> verify_proc_;
+  const MultiThreadedCertVerifier::RequestParams key_;
   scoped_refptr<X509Certificate> cert_;
   const std::string hostname_;
   const int flags_;
@@ -255,13 +265,15 @@ class CertVerifierWorker {
 };
 
 // A CertVerifierJob is a one-to-one counterpart of a CertVerifierWorker. It
-// lives only on the CertVerifier's origin message loop.
+// lives only on the CertVerifier's origin message loop.  It owns its worker
+// until Start() hands the worker over to the worker pool.
 class CertVerifierJob {
  public:
   CertVerifierJob(CertVerifierWorker* worker,
                   const BoundNetLog& net_log)
       : start_time_(base::TimeTicks::Now()),
         worker_(worker),
+        started_(false),
         net_log_(net_log) {
     scoped_refptr<NetLog::EventParameters> params(
         new X509CertificateNetLogParam(worker_->certificate()));
@@ -272,11 +284,22 @@ class CertVerifierJob {
     if (worker_) {
       net_log_.AddEvent(NetLog::TYPE_CANCELLED, NULL);
       net_log_.EndEvent(NetLog::TYPE_CERT_VERIFIER_JOB, NULL);
-      worker_->Cancel();
+      if (started_)
+        worker_->Cancel();
+      else
+        delete worker_;
       DeleteAllCanceled();
     }
   }
 
+  // Starts the verification on a worker thread.  Returns false if the worker
+  // couldn't be started.
+  bool Start() {
+    DCHECK(!started_);
+    started_ = worker_->Start();
+    return started_;
+  }
+
   void AddRequest(CertVerifierRequest* request) {
     request->net_log().AddEvent(
         NetLog::TYPE_CERT_VERIFIER_REQUEST_BOUND_TO_JOB,
@@ -288,6 +311,8 @@ class CertVerifierJob {
 
   void HandleResult(
       const MultiThreadedCertVerifier::CachedResult& verify_result) {
+    if (!started_)
+      delete worker_;
     worker_ = NULL;
     net_log_.EndEvent(NetLog::TYPE_CERT_VERIFIER_JOB, NULL);
     UMA_HISTOGRAM_CUSTOM_TIMES("Net.CertVerifier_Job_Latency",
@@ -324,19 +349,31 @@ class CertVerifierJob {
   const base::TimeTicks start_time_;
   std::vector<CertVerifierRequest*> requests_;
   CertVerifierWorker* worker_;
+  bool started_;
   const BoundNetLog net_log_;
 };
 
 MultiThreadedCertVerifier::MultiThreadedCertVerifier()
     : cache_(kMaxCacheEntries),
+      num_running_jobs_(0),
+      max_concurrent_jobs_(kMaxConcurrentJobs),
       requests_(0),
       cache_hits_(0),
       inflight_joins_(0),
+      queued_jobs_(0),
       verify_proc_(CertVerifyProc::CreateDefault()) {
   CertDatabase::AddObserver(this);
 }
 
 MultiThreadedCertVerifier::~MultiThreadedCertVerifier() {
+  if (requests_ > 0) {
+    UMA_HISTOGRAM_PERCENTAGE("Net.CertVerifier_CacheHitRate",
+                             static_cast<int>(cache_hits_ * 100 / requests_));
+    UMA_HISTOGRAM_PERCENTAGE(
+        "Net.CertVerifier_InflightJoinRate",
+        static_cast<int>(inflight_joins_ * 100 / requests_));
+  }
+
   STLDeleteValues(&inflight_);
 
   CertDatabase::RemoveObserver(this);
@@ -360,11 +397,13 @@ int MultiThreadedCertVerifier::Verify(X509Certificate* cert,
   requests_++;
 
   const RequestParams key(cert->fingerprint(), cert->ca_fingerprint(),
-                          hostname, flags);
+                          hostname, flags, crl_set ? crl_set->sequence() : 0);
   const CertVerifierCache::value_type* cached_entry =
       cache_.Get(key, base::TimeTicks::Now());
   if (cached_entry) {
     ++cache_hits_;
+    UMA_HISTOGRAM_ENUMERATION("Net.CertVerifier_RequestType",
+                              REQUEST_CACHE_HIT, REQUEST_TYPE_MAX);
     *out_req = NULL;
     *verify_result = cached_entry->result;
     return cached_entry->error;
@@ -378,22 +417,35 @@ int MultiThreadedCertVerifier::Verify(X509Certificate* cert,
     // An identical request is in flight already. We'll just attach our
     // callback.
     inflight_joins_++;
+    UMA_HISTOGRAM_ENUMERATION("Net.CertVerifier_RequestType",
+                              REQUEST_INFLIGHT_JOIN, REQUEST_TYPE_MAX);
     job = j->second;
   } else {
     // Need to make a new request.
     CertVerifierWorker* worker = new CertVerifierWorker(verify_proc_, cert,
                                                         hostname, flags,
-                                                        crl_set, this);
+                                                        crl_set, key, this);
     job = new CertVerifierJob(
         worker,
         BoundNetLog::Make(net_log.net_log(), NetLog::SOURCE_CERT_VERIFIER_JOB));
-    if (!worker->Start()) {
-      delete job;
-      delete worker;
-      *out_req = NULL;
-      // TODO(wtc): log to the NetLog.
-      LOG(ERROR) << "CertVerifierWorker couldn't be started.";
-      return ERR_INSUFFICIENT_RESOURCES;  // Just a guess.
+    if (num_running_jobs_ < max_concurrent_jobs_) {
+      if (!job->Start()) {
+        delete job;
+        *out_req = NULL;
+        // TODO(wtc): log to the NetLog.
+        LOG(ERROR) << "CertVerifierWorker couldn't be started.";
+        return ERR_INSUFFICIENT_RESOURCES;  // Just a guess.
+      }
+      num_running_jobs_++;
+      UMA_HISTOGRAM_ENUMERATION("Net.CertVerifier_RequestType",
+                                REQUEST_NEW_JOB, REQUEST_TYPE_MAX);
+    } else {
+      queued_jobs_++;
+      pending_jobs_.push_back(key);
+      UMA_HISTOGRAM_ENUMERATION("Net.CertVerifier_RequestType",
+                                REQUEST_QUEUED_JOB, REQUEST_TYPE_MAX);
+      UMA_HISTOGRAM_COUNTS_100("Net.CertVerifier_PendingJobs",
+                               pending_jobs_.size());
     }
     inflight_.insert(std::make_pair(key, job));
   }
@@ -414,22 +466,47 @@ void MultiThreadedCertVerifier::CancelRequest(RequestHandle req) {
 // HandleResult is called by CertVerifierWorker on the origin message loop.
 // It deletes CertVerifierJob.
 void MultiThreadedCertVerifier::HandleResult(
-    X509Certificate* cert,
-    const std::string& hostname,
-    int flags,
+    const RequestParams& key,
     int error,
     const CertVerifyResult& verify_result) {
   DCHECK(CalledOnValidThread());
 
-  const RequestParams key(cert->fingerprint(), cert->ca_fingerprint(),
-                          hostname, flags);
-
   CachedResult cached_result;
   cached_result.error = error;
   cached_result.result = verify_result;
   cache_.Put(key, cached_result, base::TimeTicks::Now(),
              base::TimeDelta::FromSeconds(kTTLSecs));
 
+  DCHECK_GT(num_running_jobs_, 0u);
+  num_running_jobs_--;
+  StartPendingJobs();
+
+  CompleteJob(key, error, verify_result);
+}
+
+void MultiThreadedCertVerifier::StartPendingJobs() {
+  while (num_running_jobs_ < max_concurrent_jobs_ && !pending_jobs_.empty()) {
+    const RequestParams key = pending_jobs_.front();
+    pending_jobs_.pop_front();
+
+    std::map<RequestParams, CertVerifierJob*>::iterator j = inflight_.find(key);
+    if (j == inflight_.end()) {
+      NOTREACHED();
+      continue;
+    }
+    if (j->second->Start()) {
+      num_running_jobs_++;
+      continue;
+    }
+    LOG(ERROR) << "CertVerifierWorker couldn't be started.";
+    CompleteJob(key, ERR_INSUFFICIENT_RESOURCES, CertVerifyResult());
+  }
+}
+
+void MultiThreadedCertVerifier::CompleteJob(
+    const RequestParams& key,
+    int error,
+    const CertVerifyResult& verify_result) {
   std::map<RequestParams, CertVerifierJob*>::iterator j;
   j = inflight_.find(key);
   if (j == inflight_.end()) {
@@ -439,6 +516,9 @@ void MultiThreadedCertVerifier::HandleResult(
   CertVerifierJob* job = j->second;
   inflight_.erase(j);
 
+  CachedResult cached_result;
+  cached_result.error = error;
+  cached_result.result = verify_result;
   job->HandleResult(cached_result);
   delete job;
 }
@@ -6,6 +6,7 @@
 #define NET_BASE_MULTI_THREADED_CERT_VERIFIER_H_
 #pragma once
 
+#include <deque>
 #include <map>
 #include <string>
 
@@ -31,6 +32,12 @@ class CertVerifyProc;
 
 // MultiThreadedCertVerifier is a CertVerifier implementation that runs
 // synchronous CertVerifier implementations on worker threads.
+//
+// Identical requests share a single verification, and results are cached per
+// certificate chain, hostname, flags and CRLSet.  At most
+// max_concurrent_jobs() verifications run at a time; the others wait in
+// arrival order, so that a burst of new origins doesn't tie up every worker
+// thread.
 class NET_EXPORT_PRIVATE MultiThreadedCertVerifier :
     public CertVerifier,
     NON_EXPORTED_BASE(public base::NonThreadSafe),
@@ -65,24 +72,32 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier :
   FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest, CancelRequest);
   FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest,
                            RequestParamsComparators);
+  FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest, BoundedJobs);
+  FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest,
+                           CancelPendingJobThenQuit);
 
-  // Input parameters of a certificate verification request.
+  // Input parameters of a certificate verification request.  Together,
+  // |cert_fingerprint| and |ca_fingerprint| identify the certificate chain.
   struct RequestParams {
     RequestParams(const SHA1Fingerprint& cert_fingerprint_arg,
                   const SHA1Fingerprint& ca_fingerprint_arg,
                   const std::string& hostname_arg,
-                  int flags_arg)
+                  int flags_arg,
+                  uint32 crl_set_sequence_arg)
         : cert_fingerprint(cert_fingerprint_arg),
           ca_fingerprint(ca_fingerprint_arg),
           hostname(hostname_arg),
-          flags(flags_arg) {}
+          flags(flags_arg),
+          crl_set_sequence(crl_set_sequence_arg) {}
 
     bool operator<(const RequestParams& other) const {
-      // |flags| is compared before |cert_fingerprint|, |ca_fingerprint|, and
-      // |hostname| under assumption that integer comparisons are faster than
-      // memory and string comparisons.
+      // |flags| and |crl_set_sequence| are compared before |cert_fingerprint|,
+      // |ca_fingerprint|, and |hostname| under assumption that integer
+      // comparisons are faster than memory and string comparisons.
       if (flags != other.flags)
         return flags < other.flags;
+      if (crl_set_sequence != other.crl_set_sequence)
+        return crl_set_sequence < other.crl_set_sequence;
       int rv = memcmp(cert_fingerprint.data, other.cert_fingerprint.data,
                       sizeof(cert_fingerprint.data));
       if (rv != 0)
@@ -98,6 +113,9 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier :
     SHA1Fingerprint ca_fingerprint;
     std::string hostname;
     int flags;
+    // The sequence number of the CRLSet used for the verification, or 0 if
+    // there was none.
+    uint32 crl_set_sequence;
   };
 
   // CachedResult contains the result of a certificate verification.
@@ -109,12 +127,31 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier :
     CertVerifyResult result;  // The output of CertVerifier::Verify.
   };
 
-  void HandleResult(X509Certificate* cert,
-                    const std::string& hostname,
-                    int flags,
+  // How a request was served.  These values are logged to UMA; only add new
+  // values at the end.
+  enum RequestType {
+    REQUEST_CACHE_HIT = 0,
+    REQUEST_INFLIGHT_JOIN = 1,
+    REQUEST_NEW_JOB = 2,
+    REQUEST_QUEUED_JOB = 3,
+    REQUEST_TYPE_MAX,
+  };
+
+  void HandleResult(const RequestParams& key,
                     int error,
                     const CertVerifyResult& verify_result);
 
+  // Starts the jobs waiting in |pending_jobs_|, as long as fewer than
+  // |max_concurrent_jobs_| are running.  Jobs that fail to start complete with
+  // an error.
+  void StartPendingJobs();
+
+  // Removes the job for |key| from |inflight_|, posts |error| and
+  // |verify_result| to its requests, and deletes it.
+  void CompleteJob(const RequestParams& key,
+                   int error,
+                   const CertVerifyResult& verify_result);
+
   // CertDatabase::Observer methods:
   virtual void OnCertTrustChanged(const X509Certificate* cert) OVERRIDE;
 
@@ -124,7 +161,13 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier :
   uint64 cache_hits() const { return cache_hits_; }
   uint64 requests() const { return requests_; }
   uint64 inflight_joins() const { return inflight_joins_; }
+  uint64 queued_jobs() const { return queued_jobs_; }
+  size_t num_running_jobs() const { return num_running_jobs_; }
+  size_t num_pending_jobs() const { return pending_jobs_.size(); }
   void SetCertVerifyProc(CertVerifyProc* verify_proc);
+  void set_max_concurrent_jobs(size_t max_concurrent_jobs) {
+    max_concurrent_jobs_ = max_concurrent_jobs;
+  }
 
   // cache_ maps from a request to a cached result.
   typedef ExpiringCache<RequestParams, CachedResult> CertVerifierCache;
@@ -134,9 +177,16 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier :
   // place.
   std::map<RequestParams, CertVerifierJob*> inflight_;
 
+  // The keys of the jobs in |inflight_| that haven't started yet, oldest
+  // first.
+  std::deque<RequestParams> pending_jobs_;
+  size_t num_running_jobs_;
+  size_t max_concurrent_jobs_;
+
   uint64 requests_;
   uint64 cache_hits_;
   uint64 inflight_joins_;
+  uint64 queued_jobs_;
 
   scoped_refptr<CertVerifyProc> verify_proc_;
 
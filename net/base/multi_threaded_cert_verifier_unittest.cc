@@ -242,6 +242,85 @@ TEST_F(MultiThreadedCertVerifierTest, CancelRequestThenQuit) {
   // Destroy |verifier| by going out of scope.
 }
 
+// Tests that no more than max_concurrent_jobs() verifications run at a time,
+// and that the queued ones run once a running one completes.
+TEST_F(MultiThreadedCertVerifierTest, BoundedJobs) {
+  FilePath certs_dir = GetTestCertsDirectory();
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(certs_dir, "ok_cert.pem"));
+  ASSERT_NE(static_cast<X509Certificate*>(NULL), test_cert);
+
+  verifier_.set_max_concurrent_jobs(1);
+
+  int error;
+  CertVerifyResult verify_result;
+  TestCompletionCallback callback;
+  CertVerifier::RequestHandle request_handle;
+  CertVerifyResult verify_result2;
+  TestCompletionCallback callback2;
+  CertVerifier::RequestHandle request_handle2;
+  CertVerifyResult verify_result3;
+  TestCompletionCallback callback3;
+  CertVerifier::RequestHandle request_handle3;
+
+  error = verifier_.Verify(test_cert, "www.example.com", 0, NULL,
+                           &verify_result, callback.callback(),
+                           &request_handle, BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  error = verifier_.Verify(test_cert, "www2.example.com", 0, NULL,
+                           &verify_result2, callback2.callback(),
+                           &request_handle2, BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  ASSERT_TRUE(request_handle2 != NULL);
+  EXPECT_EQ(1u, verifier_.num_running_jobs());
+  EXPECT_EQ(1u, verifier_.num_pending_jobs());
+  EXPECT_EQ(1u, verifier_.queued_jobs());
+
+  // Requests for a queued job join it.
+  error = verifier_.Verify(test_cert, "www2.example.com", 0, NULL,
+                           &verify_result3, callback3.callback(),
+                           &request_handle3, BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  EXPECT_EQ(1u, verifier_.num_pending_jobs());
+  EXPECT_EQ(1u, verifier_.inflight_joins());
+
+  EXPECT_TRUE(IsCertificateError(callback.WaitForResult()));
+  EXPECT_TRUE(IsCertificateError(callback2.WaitForResult()));
+  EXPECT_TRUE(IsCertificateError(callback3.WaitForResult()));
+  EXPECT_EQ(0u, verifier_.num_running_jobs());
+  EXPECT_EQ(0u, verifier_.num_pending_jobs());
+  EXPECT_EQ(2u, verifier_.GetCacheSize());
+}
+
+// Tests that jobs that haven't started are not leaked.
+TEST_F(MultiThreadedCertVerifierTest, CancelPendingJobThenQuit) {
+  FilePath certs_dir = GetTestCertsDirectory();
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(certs_dir, "ok_cert.pem"));
+  ASSERT_NE(static_cast<X509Certificate*>(NULL), test_cert);
+
+  verifier_.set_max_concurrent_jobs(1);
+
+  int error;
+  CertVerifyResult verify_result;
+  CertVerifier::RequestHandle request_handle;
+  CertVerifyResult verify_result2;
+  CertVerifier::RequestHandle request_handle2;
+
+  error = verifier_.Verify(
+      test_cert, "www.example.com", 0, NULL, &verify_result,
+      base::Bind(&FailTest), &request_handle, BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  error = verifier_.Verify(
+      test_cert, "www2.example.com", 0, NULL, &verify_result2,
+      base::Bind(&FailTest), &request_handle2, BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  ASSERT_EQ(1u, verifier_.num_pending_jobs());
+  verifier_.CancelRequest(request_handle);
+  verifier_.CancelRequest(request_handle2);
+  // Destroy |verifier| by going out of scope.
+}
+
 TEST_F(MultiThreadedCertVerifierTest, RequestParamsComparators) {
   SHA1Fingerprint a_key;
   memset(a_key.data, 'a', sizeof(a_key.data));
@@ -262,42 +341,51 @@ TEST_F(MultiThreadedCertVerifierTest, RequestParamsComparators) {
   } tests[] = {
     {  // Test for basic equivalence.
       MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
-                                               0),
+                                               0, 0),
       MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
-                                               0),
+                                               0, 0),
       0,
     },
     {  // Test that different certificates but with the same CA and for
        // the same host are different validation keys.
       MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
-                                               0),
+                                               0, 0),
       MultiThreadedCertVerifier::RequestParams(z_key, a_key, "www.example.test",
-                                               0),
+                                               0, 0),
       -1,
     },
     {  // Test that the same EE certificate for the same host, but with
        // different chains are different validation keys.
       MultiThreadedCertVerifier::RequestParams(a_key, z_key, "www.example.test",
-                                               0),
+                                               0, 0),
       MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
-                                               0),
+                                               0, 0),
       1,
     },
     {  // The same certificate, with the same chain, but for different
        // hosts are different validation keys.
       MultiThreadedCertVerifier::RequestParams(a_key, a_key,
-                                               "www1.example.test", 0),
+                                               "www1.example.test", 0, 0),
       MultiThreadedCertVerifier::RequestParams(a_key, a_key,
-                                               "www2.example.test", 0),
+                                               "www2.example.test", 0, 0),
       -1,
     },
     {  // The same certificate, chain, and host, but with different flags
        // are different validation keys.
       MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
-                                               X509Certificate::VERIFY_EV_CERT),
-      MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
+                                               X509Certificate::VERIFY_EV_CERT,
                                                0),
+      MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
+                                               0, 0),
       1,
+    },
+    {  // The same certificate, chain, host, and flags, but checked against
+       // different CRLSets are different validation keys.
+      MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
+                                               0, 1),
+      MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
+                                               0, 2),
+      -1,
     }
   };
   for (size_t i = 0; i < ARRAYSIZE_UNSAFE(tests); ++i) {
@@ -62,6 +62,15 @@ EVENT_TYPE(HOST_RESOLVER_IMPL_REQUEST)
 // This event is logged when a request is handled by a cache entry.
 EVENT_TYPE(HOST_RESOLVER_IMPL_CACHE_HIT)
 
+// This event is logged when a request is handled by a cache entry that has
+// expired, and a HostResolverImpl::Job is started to refresh the entry unless
+// one is already running. It contains the following parameters:
+//
+//   {
+//     "staleness_ms": <How long ago the entry expired>,
+//   }
+EVENT_TYPE(HOST_RESOLVER_IMPL_STALE_CACHE_HIT)
+
 // This event is logged when a request is handled by a HOSTS entry.
 EVENT_TYPE(HOST_RESOLVER_IMPL_HOSTS_HIT)
 
@@ -98,6 +107,19 @@ EVENT_TYPE(HOST_RESOLVER_IMPL_JOB_EVICTED)
 // PriorityDispatch.
 EVENT_TYPE(HOST_RESOLVER_IMPL_JOB_STARTED)
 
+// This event is logged when a HostResolverImpl::Job that was created to refresh
+// an expired cache entry completes. It contains the following parameters:
+//
+//   {
+//     "latency_ms": <Time since the Job was created>,
+//   }
+//
+// If an error occurred, it also contains:
+//   {
+//     "net_error": <The net error code integer for the failure>,
+//   }
+EVENT_TYPE(HOST_RESOLVER_IMPL_CACHE_REFRESH)
+
 // This event is created when HostResolverImpl::ProcJob is about to start a new
 // attempt to resolve the host.
 //
@@ -537,6 +559,22 @@ EVENT_TYPE(SSL_SOCKET_BYTES_RECEIVED)
 //  }
 EVENT_TYPE(SSL_CERTIFICATES_RECEIVED)
 
+// A breakdown of how long the steps of an SSL client handshake took, logged
+// once the server's certificate has been verified.  The times are in
+// milliseconds since the ClientHello was sent, and are only present for the
+// steps that the SSL library reports:
+//  {
+//    "transport_connect_ms": <Time to connect the underlying transport,
+//                             including host resolution>,
+//    "server_hello_ms": <When the ServerHello was received>,
+//    "finished_ms": <When the client could start sending application data>,
+//    "cert_verify_start_ms": <When certificate verification started>,
+//    "cert_verify_end_ms": <When certificate verification completed>,
+//    "resumed": <True if a previous session was resumed>,
+//    "false_start_enabled": <True if False Start was enabled>,
+//  }
+EVENT_TYPE(SSL_HANDSHAKE_TIMING)
+
 // ------------------------------------------------------------------------
 // DatagramSocket
 // ------------------------------------------------------------------------
@@ -858,6 +896,18 @@ EVENT_TYPE(HTTP_STREAM_JOB_BOUND_TO_REQUEST)
 //   }
 EVENT_TYPE(HTTP_STREAM_REQUEST_PROTO)
 
+// Logged when HttpStreamFactoryImpl preconnects streams to an origin. The
+// event parameters are:
+//   {
+//      "origin": <The origin to preconnect to>,
+//      "requested_streams": <The number of streams the caller asked for>,
+//      "planned_streams": <The number of streams that will be preconnected>,
+//      "hits": <Total number of preconnected sockets that requests used>,
+//      "wasted": <Total number of preconnected sockets that timed out before
+//                 being used>,
+//   }
+EVENT_TYPE(HTTP_STREAM_FACTORY_PRECONNECT)
+
 // ------------------------------------------------------------------------
 // HttpNetworkTransaction
 // ------------------------------------------------------------------------
@@ -1344,6 +1394,18 @@ EVENT_TYPE(DNS_TRANSACTION_ATTEMPT)
 //   }
 EVENT_TYPE(DNS_TRANSACTION_RESPONSE)
 
+// This event is created when a DnsTransaction waits for the result of another
+// one that is already in flight for the same name and type, instead of sending
+// its own queries.
+//
+// It has the following parameters:
+//
+//   {
+//     "hostname": <The hostname it is trying to resolve>,
+//     "query_type": <Type of the query>,
+//   }
+EVENT_TYPE(DNS_TRANSACTION_COALESCED)
+
 // ------------------------------------------------------------------------
 // ChromeExtension
 // ------------------------------------------------------------------------
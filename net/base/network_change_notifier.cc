@@ -144,7 +144,7 @@ NetworkChangeNotifier::NetworkChangeNotifier()
 
 void NetworkChangeNotifier::NotifyObserversOfIPAddressChange() {
   if (g_network_change_notifier) {
-    g_network_change_notifier->ip_address_observer_list_->Notify(
+    g_network_change_notifier->ip_address_observer_list_->NotifyCoalesced(
         &IPAddressObserver::OnIPAddressChanged);
   }
 }
@@ -158,7 +158,7 @@ void NetworkChangeNotifier::NotifyObserversOfDNSChange(unsigned detail) {
 
 void NetworkChangeNotifier::NotifyObserversOfOnlineStateChange() {
   if (g_network_change_notifier) {
-    g_network_change_notifier->online_state_observer_list_->Notify(
+    g_network_change_notifier->online_state_observer_list_->NotifyCoalesced(
         &OnlineStateObserver::OnOnlineStateChanged, !IsOffline());
   }
 }
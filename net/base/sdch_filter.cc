@@ -13,10 +13,67 @@
 #include "base/metrics/histogram.h"
 #include "net/base/sdch_manager.h"
 
+#include "sdch/open-vcdiff/src/google/output_string.h"
 #include "sdch/open-vcdiff/src/google/vcdecoder.h"
 
 namespace net {
 
+namespace {
+
+// Decoder output that is written straight into the destination buffer of
+// ReadFilteredData(), and appended to |excess| once that buffer is full.
+class SdchOutputBuffer : public open_vcdiff::OutputStringInterface {
+ public:
+  SdchOutputBuffer(char* dest, size_t dest_len, std::string* excess)
+      : dest_(dest),
+        dest_len_(dest_len),
+        dest_used_(0),
+        excess_(excess) {
+    DCHECK(excess_->empty());
+  }
+
+  virtual OutputStringInterface& append(const char* s, size_t n) OVERRIDE {
+    size_t amount = std::min(n, dest_len_ - dest_used_);
+    memcpy(dest_ + dest_used_, s, amount);
+    dest_used_ += amount;
+    if (amount < n)
+      excess_->append(s + amount, n - amount);
+    return *this;
+  }
+
+  virtual void clear() OVERRIDE {
+    dest_used_ = 0;
+    excess_->clear();
+  }
+
+  virtual void push_back(char c) OVERRIDE {
+    append(&c, 1);
+  }
+
+  virtual void ReserveAdditionalBytes(size_t n) OVERRIDE {
+    size_t dest_space = dest_len_ - dest_used_;
+    if (n > dest_space)
+      excess_->reserve(excess_->size() + n - dest_space);
+  }
+
+  virtual size_t size() const OVERRIDE {
+    return dest_used_ + excess_->size();
+  }
+
+  // Number of bytes written to the destination buffer.
+  size_t dest_used() const { return dest_used_; }
+
+ private:
+  char* const dest_;
+  const size_t dest_len_;
+  size_t dest_used_;
+  std::string* const excess_;
+
+  DISALLOW_COPY_AND_ASSIGN(SdchOutputBuffer);
+};
+
+}  // namespace
+
 SdchFilter::SdchFilter(const FilterContext& filter_context)
     : filter_context_(filter_context),
       decoding_status_(DECODING_UNINITIALIZED),
@@ -45,8 +102,14 @@ SdchFilter::~SdchFilter() {
     UMA_HISTOGRAM_COUNTS("Sdch3.FilterUseBeforeDisabling", filter_use_count);
   }
 
+  if (dictionary_.get())
+    dictionary_->RecordDecode(source_bytes_, output_bytes_, decode_time_);
+
   if (vcdiff_streaming_decoder_.get()) {
-    if (!vcdiff_streaming_decoder_->FinishDecoding()) {
+    if (vcdiff_streaming_decoder_->FinishDecoding()) {
+      // Let the next response that uses this dictionary reuse the decoder.
+      dictionary_->ReleaseDecoder(vcdiff_streaming_decoder_.release());
+    } else {
       decoding_status_ = DECODING_ERROR;
       SdchManager::SdchErrorRecovery(SdchManager::INCOMPLETE_SDCH_CONTENT);
       // Make it possible for the user to hit reload, and get non-sdch content.
@@ -86,6 +149,7 @@ SdchFilter::~SdchFilter() {
                 (filter_context_.GetByteReadCount() * 100) / output_bytes_));
       UMA_HISTOGRAM_COUNTS("Sdch3.Network_Decode_Bytes_VcdiffOut_a",
                            output_bytes_);
+      UMA_HISTOGRAM_TIMES("Sdch3.Network_Decode_Time_a", decode_time_);
       filter_context_.RecordPacketStats(FilterContext::SDCH_DECODE);
 
       // Allow latency experiments to proceed.
@@ -288,13 +352,18 @@ Filter::FilterStatus SdchFilter::ReadFilteredData(char* dest_buffer,
   if (!next_stream_data_ || stream_data_len_ <= 0)
     return FILTER_NEED_MORE_DATA;
 
-  bool ret = vcdiff_streaming_decoder_->DecodeChunk(
-    next_stream_data_, stream_data_len_, &dest_buffer_excess_);
+  // Decode straight into |dest_buffer|.  Only the output that doesn't fit is
+  // kept in |dest_buffer_excess_|.
+  SdchOutputBuffer output(dest_buffer, available_space, &dest_buffer_excess_);
+  base::TimeTicks decode_start = base::TimeTicks::Now();
+  bool ret = vcdiff_streaming_decoder_->DecodeChunkToInterface(
+    next_stream_data_, stream_data_len_, &output);
+  decode_time_ += base::TimeTicks::Now() - decode_start;
   // Assume all data was used in decoding.
   next_stream_data_ = NULL;
   source_bytes_ += stream_data_len_;
   stream_data_len_ = 0;
-  output_bytes_ += dest_buffer_excess_.size();
+  output_bytes_ += output.size();
   if (!ret) {
     vcdiff_streaming_decoder_.reset(NULL);  // Don't call it again.
     decoding_status_ = DECODING_ERROR;
@@ -302,9 +371,8 @@ Filter::FilterStatus SdchFilter::ReadFilteredData(char* dest_buffer,
     return FILTER_ERROR;
   }
 
-  amount = OutputBufferExcess(dest_buffer, available_space);
+  amount = output.dest_used();
   *dest_len += amount;
-  dest_buffer += amount;
   available_space -= amount;
   if (0 == available_space && !dest_buffer_excess_.empty())
       return FILTER_OK;
@@ -361,10 +429,7 @@ Filter::FilterStatus SdchFilter::InitializeDictionary() {
     return FILTER_ERROR;
   }
   dictionary_ = dictionary;
-  vcdiff_streaming_decoder_.reset(new open_vcdiff::VCDiffStreamingDecoder);
-  vcdiff_streaming_decoder_->SetAllowVcdTarget(false);
-  vcdiff_streaming_decoder_->StartDecoding(dictionary_->text().data(),
-                                           dictionary_->text().size());
+  vcdiff_streaming_decoder_.reset(dictionary_->TakeDecoder());
   decoding_status_ = DECODING_IN_PROGRESS;
   return FILTER_OK;
 }
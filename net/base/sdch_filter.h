@@ -18,6 +18,7 @@
 #include <string>
 
 #include "base/memory/scoped_ptr.h"
+#include "base/time.h"
 #include "net/base/filter.h"
 #include "net/base/net_export.h"
 #include "net/base/sdch_manager.h"
@@ -108,6 +109,9 @@ class NET_EXPORT_PRIVATE SdchFilter : public Filter {
   size_t source_bytes_;
   size_t output_bytes_;
 
+  // Time spent in the decoder, accounted to the dictionary.
+  base::TimeDelta decode_time_;
+
   // Error recovery in content type may add an sdch filter type, in which case
   // we should gracefully perform pass through if the format is incorrect, or
   // an applicable dictionary can't be found.
@@ -443,6 +443,54 @@ TEST_F(SdchFilterTest, BasicDictionary) {
   EXPECT_EQ(output, expanded_);
 }
 
+TEST_F(SdchFilterTest, ReuseDecoderAndRecordStats) {
+  const std::string kSampleDomain = "sdchtest.com";
+  std::string dictionary(NewSdchDictionary(kSampleDomain));
+  GURL url("http://" + kSampleDomain);
+  EXPECT_TRUE(sdch_manager_->AddSdchDictionary(dictionary, url));
+  std::string compressed(NewSdchCompressedData(dictionary));
+
+  std::vector<Filter::FilterType> filter_types;
+  filter_types.push_back(Filter::FILTER_TYPE_SDCH);
+  MockFilterContext filter_context;
+  filter_context.SetURL(url);
+
+  // Each response after the first reuses the decoder of the previous one,
+  // and output that doesn't fit the caller's buffer is carried over.
+  const size_t kOutputBlockSizes[] = { 100, 1, 7, 4096 };
+  for (size_t i = 0; i < arraysize(kOutputBlockSizes); ++i) {
+    scoped_ptr<Filter> filter(Filter::Factory(filter_types, filter_context));
+    std::string output;
+    EXPECT_TRUE(FilterTestData(compressed, 100, kOutputBlockSizes[i],
+                               filter.get(), &output));
+    EXPECT_EQ(expanded_, output);
+  }
+
+  // A response that stops in the middle of the data doesn't hand back a
+  // broken decoder.
+  {
+    scoped_ptr<Filter> filter(Filter::Factory(filter_types, filter_context));
+    std::string output;
+    FilterTestData(compressed.substr(0, compressed.size() / 2), 100, 100,
+                   filter.get(), &output);
+  }
+  SdchManager::ClearBlacklistings();
+  {
+    scoped_ptr<Filter> filter(Filter::Factory(filter_types, filter_context));
+    std::string output;
+    EXPECT_TRUE(FilterTestData(compressed, 100, 100, filter.get(), &output));
+    EXPECT_EQ(expanded_, output);
+  }
+
+  std::vector<SdchManager::DictionaryStats> stats;
+  sdch_manager_->GetDictionaryStats(&stats);
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ(url, stats[0].url);
+  EXPECT_EQ(6, stats[0].decode_count);
+  EXPECT_LE(static_cast<int64>(5 * expanded_.size()), stats[0].output_bytes);
+  EXPECT_LT(stats[0].vcdiff_bytes, stats[0].output_bytes);
+}
+
 TEST_F(SdchFilterTest, NoDecodeHttps) {
   // Construct a valid SDCH dictionary from a VCDIFF dictionary.
   const std::string kSampleDomain = "sdchtest.com";
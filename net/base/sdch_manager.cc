@@ -12,6 +12,7 @@
 #include "crypto/sha2.h"
 #include "net/base/registry_controlled_domain.h"
 #include "net/url_request/url_request_http_job.h"
+#include "sdch/open-vcdiff/src/google/vcdecoder.h"
 
 namespace net {
 
@@ -28,6 +29,13 @@ SdchManager* SdchManager::global_ = NULL;
 // static
 bool SdchManager::g_sdch_enabled_ = true;
 
+//------------------------------------------------------------------------------
+SdchManager::DictionaryStats::DictionaryStats()
+    : decode_count(0),
+      vcdiff_bytes(0),
+      output_bytes(0) {
+}
+
 //------------------------------------------------------------------------------
 SdchManager::Dictionary::Dictionary(const std::string& dictionary_text,
                                     size_t offset,
@@ -43,12 +51,42 @@ SdchManager::Dictionary::Dictionary(const std::string& dictionary_text,
       domain_(domain),
       path_(path),
       expiration_(expiration),
-      ports_(ports) {
+      ports_(ports),
+      decode_count_(0),
+      vcdiff_bytes_(0),
+      output_bytes_(0) {
 }
 
 SdchManager::Dictionary::~Dictionary() {
 }
 
+open_vcdiff::VCDiffStreamingDecoder* SdchManager::Dictionary::TakeDecoder() {
+  if (idle_decoder_.get())
+    return idle_decoder_.release();
+
+  open_vcdiff::VCDiffStreamingDecoder* decoder =
+      new open_vcdiff::VCDiffStreamingDecoder;
+  decoder->SetAllowVcdTarget(false);
+  decoder->StartDecoding(text_.data(), text_.size());
+  return decoder;
+}
+
+void SdchManager::Dictionary::ReleaseDecoder(
+    open_vcdiff::VCDiffStreamingDecoder* decoder) {
+  // Restart the decoder now, so that it's ready for the next response.
+  decoder->StartDecoding(text_.data(), text_.size());
+  idle_decoder_.reset(decoder);
+}
+
+void SdchManager::Dictionary::RecordDecode(int64 vcdiff_bytes,
+                                           int64 output_bytes,
+                                           base::TimeDelta decode_time) {
+  ++decode_count_;
+  vcdiff_bytes_ += vcdiff_bytes;
+  output_bytes_ += output_bytes;
+  decode_time_ += decode_time;
+}
+
 bool SdchManager::Dictionary::CanAdvertise(const GURL& target_url) {
   if (!SdchManager::Global()->IsInSupportedDomain(target_url))
     return false;
@@ -483,6 +521,23 @@ void SdchManager::GetVcdiffDictionary(const std::string& server_hash,
   *dictionary = matching_dictionary;
 }
 
+void SdchManager::GetDictionaryStats(
+    std::vector<DictionaryStats>* stats) const {
+  DCHECK(CalledOnValidThread());
+  for (DictionaryMap::const_iterator it = dictionaries_.begin();
+       it != dictionaries_.end(); ++it) {
+    const Dictionary* dictionary = it->second;
+    DictionaryStats dictionary_stats;
+    dictionary_stats.url = dictionary->url();
+    dictionary_stats.client_hash = dictionary->client_hash();
+    dictionary_stats.decode_count = dictionary->decode_count_;
+    dictionary_stats.vcdiff_bytes = dictionary->vcdiff_bytes_;
+    dictionary_stats.output_bytes = dictionary->output_bytes_;
+    dictionary_stats.decode_time = dictionary->decode_time_;
+    stats->push_back(dictionary_stats);
+  }
+}
+
 // TODO(jar): If we have evictions from the dictionaries_, then we need to
 // change this interface to return a list of reference counted Dictionary
 // instances that can be used if/when a server specifies one.
@@ -24,6 +24,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
@@ -33,6 +34,10 @@
 #include "googleurl/src/gurl.h"
 #include "net/base/net_export.h"
 
+namespace open_vcdiff {
+class VCDiffStreamingDecoder;
+}
+
 namespace net {
 
 //------------------------------------------------------------------------------
@@ -156,6 +161,20 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
     MAX_PROBLEM_CODE  // Used to bound histogram.
   };
 
+  // Totals over the responses decoded with a dictionary.  The bytes saved by
+  // the dictionary are |output_bytes| - |vcdiff_bytes|.
+  struct DictionaryStats {
+    DictionaryStats();
+
+    GURL url;
+    std::string client_hash;
+    int decode_count;
+    int64 vcdiff_bytes;
+    int64 output_bytes;
+    // Time spent decoding on the IO thread.
+    base::TimeDelta decode_time;
+  };
+
   // Use the following static limits to block DOS attacks until we implement
   // a cached dictionary evicition strategy.
   static const size_t kMaxDictionarySize;
@@ -168,6 +187,22 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
     // Sdch filters can get our text to use in decoding compressed data.
     const std::string& text() const { return text_; }
 
+    // Returns a decoder that is ready to decode a stream with this
+    // dictionary.  Decoders given back with ReleaseDecoder() are reused, so
+    // that a page with many SDCH encoded responses doesn't build a decoder
+    // for each of them.  The caller owns the returned decoder.
+    open_vcdiff::VCDiffStreamingDecoder* TakeDecoder();
+
+    // Gives back a |decoder| taken with TakeDecoder() that has successfully
+    // finished decoding its stream.
+    void ReleaseDecoder(open_vcdiff::VCDiffStreamingDecoder* decoder);
+
+    // Accounts for a response decoded with this dictionary, made of
+    // |vcdiff_bytes| of SDCH encoded data that expanded to |output_bytes|,
+    // in |decode_time|.
+    void RecordDecode(int64 vcdiff_bytes, int64 output_bytes,
+                      base::TimeDelta decode_time);
+
    private:
     friend class base::RefCounted<Dictionary>;
     friend class SdchManager;  // Only manager can construct an instance.
@@ -229,6 +264,15 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
     const base::Time expiration_;  // Implied by max-age.
     const std::set<int> ports_;
 
+    // A decoder left by a finished response, started with text_.
+    scoped_ptr<open_vcdiff::VCDiffStreamingDecoder> idle_decoder_;
+
+    // Totals over the responses decoded with this dictionary.
+    int decode_count_;
+    int64 vcdiff_bytes_;
+    int64 output_bytes_;
+    base::TimeDelta decode_time_;
+
     DISALLOW_COPY_AND_ASSIGN(Dictionary);
   };
 
@@ -313,6 +357,9 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
                            const GURL& referring_url,
                            Dictionary** dictionary);
 
+  // Appends the decoding statistics of each loaded dictionary to |stats|.
+  void GetDictionaryStats(std::vector<DictionaryStats>* stats) const;
+
   // Get list of available (pre-cached) dictionaries that we have already loaded
   // into memory.  The list is a comma separated list of (client) hashes per
   // the SDCH spec.
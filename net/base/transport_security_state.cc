@@ -19,11 +19,14 @@
 #include <utility>
 
 #include "base/base64.h"
+#include "base/hash_tables.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/metrics/histogram.h"
 #include "base/sha1.h"
 #include "base/string_number_conversions.h"
+#include "base/string_piece.h"
 #include "base/string_tokenizer.h"
 #include "base/string_util.h"
 #include "base/time.h"
@@ -128,6 +131,11 @@ bool TransportSecurityState::GetDomainState(const std::string& host,
       return true;
     }
 
+    // The dynamic entries are keyed by a SHA-256 of the name, which is only
+    // worth computing when there are any.
+    if (enabled_hosts_.empty())
+      continue;
+
     std::map<std::string, DomainState>::iterator j =
         enabled_hosts_.find(HashHost(host_sub_chunk));
     if (j == enabled_hosts_.end())
@@ -588,45 +596,91 @@ struct HSTSPreload {
   SecondLevelDomainName second_level_domain_name;
 };
 
-static bool HasPreload(const struct HSTSPreload* entries, size_t num_entries,
+// Maps the DNS-encoded names of a table of HSTSPreload entries to the entries.
+typedef base::hash_map<base::StringPiece, const HSTSPreload*> HSTSPreloadMap;
+
+// Returns the entry of |entries| for the suffix of |canonicalized_host| that
+// starts at |i|, or NULL if there is none.
+static const struct HSTSPreload* FindPreload(
+    const HSTSPreloadMap& entries,
+    const std::string& canonicalized_host,
+    size_t i) {
+  HSTSPreloadMap::const_iterator it = entries.find(
+      base::StringPiece(canonicalized_host.data() + i,
+                        canonicalized_host.size() - i));
+  return it == entries.end() ? NULL : it->second;
+}
+
+static bool HasPreload(const HSTSPreloadMap& entries,
                        const std::string& canonicalized_host, size_t i,
                        TransportSecurityState::DomainState* out, bool* ret) {
-  for (size_t j = 0; j < num_entries; j++) {
-    if (entries[j].length == canonicalized_host.size() - i &&
-        memcmp(entries[j].dns_name, &canonicalized_host[i],
-               entries[j].length) == 0) {
-      if (!entries[j].include_subdomains && i != 0) {
-        *ret = false;
-      } else {
-        out->include_subdomains = entries[j].include_subdomains;
-        *ret = true;
-        if (!entries[j].https_required)
-          out->upgrade_mode = TransportSecurityState::DomainState::MODE_DEFAULT;
-        if (entries[j].pins.required_hashes) {
-          const char* const* hash = entries[j].pins.required_hashes;
-          while (*hash) {
-            bool ok = AddHash(*hash, &out->static_spki_hashes);
-            DCHECK(ok) << " failed to parse " << *hash;
-            hash++;
-          }
-        }
-        if (entries[j].pins.excluded_hashes) {
-          const char* const* hash = entries[j].pins.excluded_hashes;
-          while (*hash) {
-            bool ok = AddHash(*hash, &out->bad_static_spki_hashes);
-            DCHECK(ok) << " failed to parse " << *hash;
-            hash++;
-          }
-        }
+  const struct HSTSPreload* entry =
+      FindPreload(entries, canonicalized_host, i);
+  if (!entry)
+    return false;
+
+  if (!entry->include_subdomains && i != 0) {
+    *ret = false;
+  } else {
+    out->include_subdomains = entry->include_subdomains;
+    *ret = true;
+    if (!entry->https_required)
+      out->upgrade_mode = TransportSecurityState::DomainState::MODE_DEFAULT;
+    if (entry->pins.required_hashes) {
+      const char* const* hash = entry->pins.required_hashes;
+      while (*hash) {
+        bool ok = AddHash(*hash, &out->static_spki_hashes);
+        DCHECK(ok) << " failed to parse " << *hash;
+        hash++;
+      }
+    }
+    if (entry->pins.excluded_hashes) {
+      const char* const* hash = entry->pins.excluded_hashes;
+      while (*hash) {
+        bool ok = AddHash(*hash, &out->bad_static_spki_hashes);
+        DCHECK(ok) << " failed to parse " << *hash;
+        hash++;
       }
-      return true;
     }
   }
-  return false;
+  return true;
 }
 
 #include "net/base/transport_security_state_static.h"
 
+// Indexes the preload tables by name, so that finding the entry for a host
+// takes one probe per label instead of a scan of every table entry. Built on
+// first use and shared by all TransportSecurityState instances.
+class HSTSPreloadIndex {
+ public:
+  HSTSPreloadIndex() {
+    AddEntries(kPreloadedSTS, kNumPreloadedSTS, &sts_entries_);
+    AddEntries(kPreloadedSNISTS, kNumPreloadedSNISTS, &sni_sts_entries_);
+  }
+
+  const HSTSPreloadMap& sts_entries() const { return sts_entries_; }
+  const HSTSPreloadMap& sni_sts_entries() const { return sni_sts_entries_; }
+
+ private:
+  static void AddEntries(const struct HSTSPreload* entries,
+                         size_t num_entries,
+                         HSTSPreloadMap* map) {
+    for (size_t i = 0; i < num_entries; ++i) {
+      base::StringPiece name(entries[i].dns_name, entries[i].length);
+      // The first entry wins, as it did when the table was scanned.
+      map->insert(std::make_pair(name, entries + i));
+    }
+  }
+
+  HSTSPreloadMap sts_entries_;
+  HSTSPreloadMap sni_sts_entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(HSTSPreloadIndex);
+};
+
+static base::LazyInstance<HSTSPreloadIndex>::Leaky g_hsts_preload_index =
+    LAZY_INSTANCE_INITIALIZER;
+
 // Returns the HSTSPreload entry for the |canonicalized_host| in |entries|,
 // or NULL if there is none. Prefers exact hostname matches to those that
 // match only because HSTSPreload.include_subdomains is true.
@@ -635,20 +689,12 @@ static bool HasPreload(const struct HSTSPreload* entries, size_t num_entries,
 // CanonicalizeHost.
 static const struct HSTSPreload* GetHSTSPreload(
     const std::string& canonicalized_host,
-    const struct HSTSPreload* entries,
-    size_t num_entries) {
+    const HSTSPreloadMap& entries) {
   for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1) {
-    for (size_t j = 0; j < num_entries; j++) {
-      const struct HSTSPreload* entry = entries + j;
-
-      if (i != 0 && !entry->include_subdomains)
-        continue;
-
-      if (entry->length == canonicalized_host.size() - i &&
-          memcmp(entry->dns_name, &canonicalized_host[i], entry->length) == 0) {
-        return entry;
-      }
-    }
+    const struct HSTSPreload* entry =
+        FindPreload(entries, canonicalized_host, i);
+    if (entry && (i == 0 || entry->include_subdomains))
+      return entry;
   }
 
   return NULL;
@@ -658,15 +704,15 @@ static const struct HSTSPreload* GetHSTSPreload(
 bool TransportSecurityState::IsGooglePinnedProperty(const std::string& host,
                                                     bool sni_enabled) {
   std::string canonicalized_host = CanonicalizeHost(host);
+  const HSTSPreloadIndex& index = g_hsts_preload_index.Get();
   const struct HSTSPreload* entry =
-      GetHSTSPreload(canonicalized_host, kPreloadedSTS, kNumPreloadedSTS);
+      GetHSTSPreload(canonicalized_host, index.sts_entries());
 
   if (entry && entry->pins.required_hashes == kGoogleAcceptableCerts)
     return true;
 
   if (sni_enabled) {
-    entry = GetHSTSPreload(canonicalized_host, kPreloadedSNISTS,
-                           kNumPreloadedSNISTS);
+    entry = GetHSTSPreload(canonicalized_host, index.sni_sts_entries());
     if (entry && entry->pins.required_hashes == kGoogleAcceptableCerts)
       return true;
   }
@@ -677,14 +723,13 @@ bool TransportSecurityState::IsGooglePinnedProperty(const std::string& host,
 // static
 void TransportSecurityState::ReportUMAOnPinFailure(const std::string& host) {
   std::string canonicalized_host = CanonicalizeHost(host);
+  const HSTSPreloadIndex& index = g_hsts_preload_index.Get();
 
   const struct HSTSPreload* entry =
-      GetHSTSPreload(canonicalized_host, kPreloadedSTS, kNumPreloadedSTS);
+      GetHSTSPreload(canonicalized_host, index.sts_entries());
 
-  if (!entry) {
-    entry = GetHSTSPreload(canonicalized_host, kPreloadedSNISTS,
-                           kNumPreloadedSNISTS);
-  }
+  if (!entry)
+    entry = GetHSTSPreload(canonicalized_host, index.sni_sts_entries());
 
   DCHECK(entry);
   DCHECK(entry->pins.required_hashes);
@@ -703,24 +748,27 @@ bool TransportSecurityState::GetStaticDomainState(
   out->upgrade_mode = DomainState::MODE_FORCE_HTTPS;
   out->include_subdomains = false;
 
+  const HSTSPreloadIndex& index = g_hsts_preload_index.Get();
   for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1) {
     std::string host_sub_chunk(&canonicalized_host[i],
                                canonicalized_host.size() - i);
     out->domain = DNSDomainToString(host_sub_chunk);
-    std::string hashed_host(HashHost(host_sub_chunk));
-    if (forced_hosts_.find(hashed_host) != forced_hosts_.end()) {
-      *out = forced_hosts_[hashed_host];
-      out->domain = DNSDomainToString(host_sub_chunk);
-      return true;
+    // Forced hosts are only set by tests and the command line, so skip
+    // hashing the name when there are none.
+    if (!forced_hosts_.empty()) {
+      std::string hashed_host(HashHost(host_sub_chunk));
+      if (forced_hosts_.find(hashed_host) != forced_hosts_.end()) {
+        *out = forced_hosts_[hashed_host];
+        out->domain = DNSDomainToString(host_sub_chunk);
+        return true;
+      }
     }
     bool ret;
-    if (HasPreload(kPreloadedSTS, kNumPreloadedSTS, canonicalized_host, i, out,
-                   &ret)) {
+    if (HasPreload(index.sts_entries(), canonicalized_host, i, out, &ret))
       return ret;
-    }
     if (sni_enabled &&
-        HasPreload(kPreloadedSNISTS, kNumPreloadedSNISTS, canonicalized_host, i,
-                   out, &ret)) {
+        HasPreload(index.sni_sts_entries(), canonicalized_host, i, out,
+                   &ret)) {
       return ret;
     }
   }
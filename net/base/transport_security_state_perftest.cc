@@ -0,0 +1,66 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/perftimer.h"
+#include "base/string_number_conversions.h"
+#include "base/time.h"
+#include "net/base/transport_security_state.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kNumLookups = 100000;
+
+// A preloaded host, a subdomain of one, and a host that matches nothing.
+const char* const kHosts[] = {
+  "www.paypal.com",
+  "foo.mail.google.com",
+  "some.deep.subdomain.of.an.unknown.example.com",
+};
+
+}  // namespace
+
+namespace net {
+
+// Measures the cost of the lookup done for every HTTP and HTTPS request,
+// against the static preloads only.
+TEST(TransportSecurityStatePerfTest, StaticLookup) {
+  TransportSecurityState state;
+  for (size_t i = 0; i < arraysize(kHosts); ++i) {
+    PerfTimeLogger timer(("TransportSecurityState_static_lookup_" +
+                          std::string(kHosts[i])).c_str());
+    for (int j = 0; j < kNumLookups; ++j) {
+      TransportSecurityState::DomainState domain_state;
+      state.GetDomainState(kHosts[i], true, &domain_state);
+    }
+    timer.Done();
+  }
+}
+
+// Same, with some dynamic entries as well.
+TEST(TransportSecurityStatePerfTest, DynamicLookup) {
+  TransportSecurityState state;
+  const base::Time expiry =
+      base::Time::Now() + base::TimeDelta::FromSeconds(1000);
+  for (int i = 0; i < 100; ++i) {
+    TransportSecurityState::DomainState domain_state;
+    domain_state.upgrade_expiry = expiry;
+    state.EnableHost("host" + base::IntToString(i) + ".example.com",
+                     domain_state);
+  }
+
+  for (size_t i = 0; i < arraysize(kHosts); ++i) {
+    PerfTimeLogger timer(("TransportSecurityState_dynamic_lookup_" +
+                          std::string(kHosts[i])).c_str());
+    for (int j = 0; j < kNumLookups; ++j) {
+      TransportSecurityState::DomainState domain_state;
+      state.GetDomainState(kHosts[i], true, &domain_state);
+    }
+    timer.Done();
+  }
+}
+
+}  // namespace net
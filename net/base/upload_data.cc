@@ -31,6 +31,8 @@ void OnGetContentLengthComplete(
 
 UploadData::Element::Element()
     : type_(TYPE_BYTES),
+      bytes_start_(NULL),
+      bytes_length_(0),
       file_range_offset_(0),
       file_range_length_(kuint64max),
       is_last_chunk_(false),
@@ -56,6 +58,8 @@ void UploadData::Element::SetToChunk(const char* bytes,
                                      bool is_last_chunk) {
   bytes_.clear();
   bytes_.insert(bytes_.end(), bytes, bytes + bytes_len);
+  bytes_start_ = NULL;
+  bytes_length_ = 0;
   type_ = TYPE_CHUNK;
   is_last_chunk_ = is_last_chunk;
 }
@@ -65,7 +69,7 @@ uint64 UploadData::Element::GetContentLength() {
     return content_length_;
 
   if (type_ == TYPE_BYTES || type_ == TYPE_CHUNK)
-    return static_cast<uint64>(bytes_.size());
+    return bytes_length();
   else if (type_ == TYPE_BLOB)
     // The blob reference will be resolved later.
     return 0;
@@ -145,12 +149,10 @@ int UploadData::Element::ReadFromMemorySync(char* buf, int buf_len) {
   const size_t num_bytes_to_read = std::min(BytesRemaining(),
                                             static_cast<uint64>(buf_len));
 
-  // Check if we have anything to copy first, because we are getting
-  // the address of an element in |bytes_| and that will throw an
-  // exception if |bytes_| is an empty vector.
-  if (num_bytes_to_read > 0) {
-    memcpy(buf, &bytes_[offset_], num_bytes_to_read);
-  }
+  // Check if we have anything to copy first, because bytes() is NULL for
+  // an empty element.
+  if (num_bytes_to_read > 0)
+    memcpy(buf, bytes() + offset_, num_bytes_to_read);
 
   offset_ += num_bytes_to_read;
   return num_bytes_to_read;
@@ -6,6 +6,7 @@
 #define NET_BASE_UPLOAD_DATA_H_
 #pragma once
 
+#include <algorithm>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -66,7 +67,16 @@ class NET_EXPORT UploadData
       type_ = type;
     }
 
-    const std::vector<char>& bytes() const { return bytes_; }
+    // Returns the data of a TYPE_BYTES or TYPE_CHUNK element, which may be
+    // shared with its owner rather than held by the element.
+    const char* bytes() const {
+      if (bytes_start_)
+        return bytes_start_;
+      return bytes_.empty() ? NULL : &bytes_[0];
+    }
+    uint64 bytes_length() const {
+      return bytes_start_ ? bytes_length_ : bytes_.size();
+    }
     const FilePath& file_path() const { return file_path_; }
     uint64 file_range_offset() const { return file_range_offset_; }
     uint64 file_range_length() const { return file_range_length_; }
@@ -79,6 +89,18 @@ class NET_EXPORT UploadData
     void SetToBytes(const char* bytes, int bytes_len) {
       type_ = TYPE_BYTES;
       bytes_.assign(bytes, bytes + bytes_len);
+      bytes_start_ = NULL;
+      bytes_length_ = 0;
+    }
+
+    // Refers to |bytes_len| bytes at |bytes| without copying them. The
+    // caller must keep them alive, unchanged, for as long as this element,
+    // e.g. by attaching their owner to the UploadData as user data.
+    void SetToSharedBytes(const char* bytes, int bytes_len) {
+      type_ = TYPE_BYTES;
+      bytes_.clear();
+      bytes_start_ = bytes;
+      bytes_length_ = bytes_len;
     }
 
     void SetToFilePath(const FilePath& path) {
@@ -153,6 +175,8 @@ class NET_EXPORT UploadData
 
     Type type_;
     std::vector<char> bytes_;
+    const char* bytes_start_;
+    uint64 bytes_length_;
     FilePath file_path_;
     uint64 file_range_offset_;
     uint64 file_range_length_;
@@ -171,6 +195,8 @@ class NET_EXPORT UploadData
     FileStream* file_stream_;
 
     FRIEND_TEST_ALL_PREFIXES(UploadDataStreamTest, FileSmallerThanLength);
+    FRIEND_TEST_ALL_PREFIXES(UploadDataStreamTest,
+                             ReadBufferFileSmallerThanLength);
     FRIEND_TEST_ALL_PREFIXES(HttpNetworkTransactionTest,
                              UploadFileSmallerThanLength);
     FRIEND_TEST_ALL_PREFIXES(HttpNetworkTransactionSpdy2Test,
@@ -260,8 +286,10 @@ inline bool operator==(const UploadData::Element& a,
                        const UploadData::Element& b) {
   if (a.type() != b.type())
     return false;
-  if (a.type() == UploadData::TYPE_BYTES)
-    return a.bytes() == b.bytes();
+  if (a.type() == UploadData::TYPE_BYTES) {
+    return a.bytes_length() == b.bytes_length() &&
+           std::equal(a.bytes(), a.bytes() + a.bytes_length(), b.bytes());
+  }
   if (a.type() == UploadData::TYPE_FILE) {
     return a.file_path() == b.file_path() &&
            a.file_range_offset() == b.file_range_offset() &&
@@ -4,6 +4,9 @@
 
 #include "net/base/upload_data_stream.h"
 
+#include <algorithm>
+
+#include "base/bind.h"
 #include "base/file_util.h"
 #include "base/logging.h"
 #include "base/threading/thread_restrictions.h"
@@ -13,14 +16,43 @@
 
 namespace net {
 
+namespace {
+
+// Refers to the bytes of an element of |upload_data| in place, and keeps the
+// upload data alive while the buffer is in use.
+class UploadBytesIOBuffer : public WrappedIOBuffer {
+ public:
+  UploadBytesIOBuffer(UploadData* upload_data, const char* data)
+      : WrappedIOBuffer(data),
+        upload_data_(upload_data) {
+  }
+
+ private:
+  virtual ~UploadBytesIOBuffer() {}
+
+  scoped_refptr<UploadData> upload_data_;
+};
+
+}  // namespace
+
 bool UploadDataStream::merge_chunks_ = true;
 
+const int UploadDataStream::kMinInPlaceSize;
+const int UploadDataStream::kMaxFileReadSize;
+
 UploadDataStream::UploadDataStream(UploadData* upload_data)
     : upload_data_(upload_data),
       element_index_(0),
       total_size_(0),
       current_position_(0),
-      initialized_successfully_(false) {
+      initialized_successfully_(false),
+      element_offset_(0),
+      file_open_started_(false),
+      file_read_pending_(false),
+      file_read_len_(0),
+      file_bytes_read_(0),
+      file_read_size_(0),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
 }
 
 UploadDataStream::~UploadDataStream() {
@@ -87,6 +119,237 @@ int UploadDataStream::Read(IOBuffer* buf, int buf_len) {
   return bytes_copied;
 }
 
+int UploadDataStream::ReadBuffer(int max_len, scoped_refptr<IOBuffer>* buf,
+                                 const CompletionCallback& callback) {
+  DCHECK(initialized_successfully_);
+  DCHECK(!is_chunked());
+  DCHECK_LT(0, max_len);
+  DCHECK(file_read_callback_.is_null());
+
+  std::vector<UploadData::Element>& elements = *upload_data_->elements();
+  while (element_index_ < elements.size() &&
+         element_offset_ >= elements[element_index_].GetContentLength()) {
+    NextElement();
+  }
+  if (element_index_ == elements.size())
+    return 0;
+
+  int rv;
+  if (elements[element_index_].type() == UploadData::TYPE_FILE)
+    rv = ReadFileBuffer(max_len, buf, callback);
+  else
+    rv = ReadMemoryBuffer(max_len, buf);
+  if (rv > 0)
+    current_position_ += rv;
+  return rv;
+}
+
+int UploadDataStream::ReadMemoryBuffer(int max_len,
+                                       scoped_refptr<IOBuffer>* buf) {
+  std::vector<UploadData::Element>& elements = *upload_data_->elements();
+  UploadData::Element& element = elements[element_index_];
+  uint64 remaining = element.GetContentLength() - element_offset_;
+  if (remaining >= static_cast<uint64>(kMinInPlaceSize)) {
+    int len = static_cast<int>(std::min(remaining,
+                                        static_cast<uint64>(max_len)));
+    *buf = new UploadBytesIOBuffer(upload_data_,
+                                   element.bytes() + element_offset_);
+    element_offset_ += len;
+    if (element_offset_ == element.GetContentLength())
+      NextElement();
+    return len;
+  }
+
+  // Gather this element and the small in-memory elements that follow it.
+  int gather_len = 0;
+  uint64 offset = element_offset_;
+  for (size_t i = element_index_;
+       i < elements.size() && gather_len < max_len; ++i, offset = 0) {
+    if (elements[i].type() == UploadData::TYPE_FILE)
+      break;
+    uint64 element_remaining = elements[i].GetContentLength() - offset;
+    if (gather_len > 0 &&
+        element_remaining >= static_cast<uint64>(kMinInPlaceSize)) {
+      break;
+    }
+    gather_len += static_cast<int>(std::min(
+        element_remaining, static_cast<uint64>(max_len - gather_len)));
+  }
+
+  scoped_refptr<IOBuffer> gathered(new IOBuffer(gather_len));
+  int len = 0;
+  while (len < gather_len) {
+    UploadData::Element& next = elements[element_index_];
+    int bytes = static_cast<int>(std::min(
+        next.GetContentLength() - element_offset_,
+        static_cast<uint64>(gather_len - len)));
+    if (bytes > 0)
+      memcpy(gathered->data() + len, next.bytes() + element_offset_, bytes);
+    len += bytes;
+    element_offset_ += bytes;
+    if (element_offset_ == next.GetContentLength())
+      NextElement();
+  }
+  *buf = gathered;
+  return len;
+}
+
+int UploadDataStream::ReadFileBuffer(int max_len,
+                                     scoped_refptr<IOBuffer>* buf,
+                                     const CompletionCallback& callback) {
+  UploadData::Element& element = (*upload_data_->elements())[element_index_];
+  if (!file_open_started_) {
+    file_read_size_ = std::min(max_len, kMaxFileReadSize);
+    StartFileRead();
+  }
+  if (file_read_pending_) {
+    file_read_callback_ = callback;
+    return ERR_IO_PENDING;
+  }
+
+  DCHECK(file_read_buf_);
+  int len = file_read_len_;
+  if (len > max_len) {
+    // The caller asked for less than the data read ahead. Hand out a copy of
+    // the beginning of it and keep the rest.
+    scoped_refptr<IOBuffer> part(new IOBuffer(max_len));
+    memcpy(part->data(), file_read_buf_->data(), max_len);
+    memmove(file_read_buf_->data(), file_read_buf_->data() + max_len,
+            len - max_len);
+    file_read_len_ -= max_len;
+    element_offset_ += max_len;
+    *buf = part;
+    return max_len;
+  }
+
+  *buf = file_read_buf_;
+  file_read_buf_ = NULL;
+  file_read_len_ = 0;
+  element_offset_ += len;
+  if (element_offset_ == element.GetContentLength()) {
+    NextElement();
+  } else {
+    // Read the next piece of the file while the caller sends this one.
+    StartFileRead();
+  }
+  return len;
+}
+
+void UploadDataStream::NextElement() {
+  DCHECK(!file_read_pending_);
+  ++element_index_;
+  element_offset_ = 0;
+  file_stream_.reset();
+  file_open_started_ = false;
+  file_read_buf_ = NULL;
+  file_read_len_ = 0;
+  file_bytes_read_ = 0;
+}
+
+void UploadDataStream::StartFileRead() {
+  UploadData::Element& element = (*upload_data_->elements())[element_index_];
+  DCHECK(!file_read_pending_);
+  DCHECK_LT(file_bytes_read_, element.GetContentLength());
+
+  int len = static_cast<int>(std::min(
+      element.GetContentLength() - file_bytes_read_,
+      static_cast<uint64>(file_read_size_)));
+  file_read_buf_ = new IOBufferWithSize(len);
+  file_read_len_ = 0;
+  file_read_pending_ = true;
+
+  if (!file_open_started_) {
+    file_open_started_ = true;
+    file_stream_.reset(new FileStream(NULL));
+    int rv = file_stream_->Open(
+        element.file_path(),
+        base::PLATFORM_FILE_OPEN | base::PLATFORM_FILE_READ |
+            base::PLATFORM_FILE_ASYNC,
+        base::Bind(&UploadDataStream::OnFileOpened,
+                   weak_factory_.GetWeakPtr()));
+    if (rv != ERR_IO_PENDING)
+      OnFileOpened(rv);
+    return;
+  }
+  DoFileRead();
+}
+
+void UploadDataStream::OnFileOpened(int result) {
+  if (result != OK) {
+    DLOG(WARNING) << "Failed to open \""
+                  << (*upload_data_->elements())[element_index_].file_path().
+                         value()
+                  << "\" for reading: " << result;
+    file_stream_.reset();
+    CompleteFileRead(0);
+    return;
+  }
+
+  uint64 offset =
+      (*upload_data_->elements())[element_index_].file_range_offset();
+  if (!offset) {
+    DoFileRead();
+    return;
+  }
+  int64 rv = file_stream_->Seek(
+      FROM_BEGIN, offset,
+      base::Bind(&UploadDataStream::OnFileSeeked,
+                 weak_factory_.GetWeakPtr()));
+  if (rv != ERR_IO_PENDING)
+    OnFileSeeked(rv);
+}
+
+void UploadDataStream::OnFileSeeked(int64 result) {
+  if (result < 0) {
+    file_stream_.reset();
+    CompleteFileRead(0);
+    return;
+  }
+  DoFileRead();
+}
+
+void UploadDataStream::DoFileRead() {
+  // |file_stream_| is NULL once the file couldn't be read.
+  if (!file_stream_.get()) {
+    CompleteFileRead(0);
+    return;
+  }
+  int rv = file_stream_->Read(
+      file_read_buf_, file_read_buf_->size(),
+      base::Bind(&UploadDataStream::OnFileRead,
+                 weak_factory_.GetWeakPtr()));
+  if (rv != ERR_IO_PENDING)
+    OnFileRead(rv);
+}
+
+void UploadDataStream::OnFileRead(int result) {
+  if (result <= 0) {
+    // The file is shorter than we observed, or can't be read any more. Pad
+    // the rest of the element with zeros, or the server will hang waiting for
+    // the rest of the data.
+    file_stream_.reset();
+    result = 0;
+  }
+  CompleteFileRead(result);
+}
+
+void UploadDataStream::CompleteFileRead(int bytes_read) {
+  DCHECK(file_read_pending_);
+  if (bytes_read == 0) {
+    memset(file_read_buf_->data(), 0, file_read_buf_->size());
+    bytes_read = file_read_buf_->size();
+  }
+  file_read_len_ = bytes_read;
+  file_bytes_read_ += bytes_read;
+  file_read_pending_ = false;
+
+  if (!file_read_callback_.is_null()) {
+    CompletionCallback callback = file_read_callback_;
+    file_read_callback_.Reset();
+    callback.Run(OK);
+  }
+}
+
 bool UploadDataStream::IsEOF() const {
   const std::vector<UploadData::Element>& elements = *upload_data_->elements();
 
@@ -6,7 +6,10 @@
 #define NET_BASE_UPLOAD_DATA_STREAM_H_
 #pragma once
 
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "net/base/completion_callback.h"
 #include "net/base/net_export.h"
 #include "net/base/upload_data.h"
 
@@ -14,6 +17,7 @@ namespace net {
 
 class FileStream;
 class IOBuffer;
+class IOBufferWithSize;
 
 class NET_EXPORT UploadDataStream {
  public:
@@ -44,6 +48,24 @@ class NET_EXPORT UploadDataStream {
   // won't fail.
   int Read(IOBuffer* buf, int buf_len);
 
+  // Hands out up to |max_len| bytes of a non-chunked upload in |*buf|,
+  // without copying them where possible, and returns the number of bytes
+  // handed out. Zero is returned at the end of the stream.
+  //
+  // Bytes held in memory are referenced in place, except that runs of small
+  // elements are gathered into one buffer so they go out in one write. File
+  // data is read through an asynchronous FileStream, and the next piece of the
+  // file is read ahead while the caller sends the current one. If that data
+  // isn't ready yet, ERR_IO_PENDING is returned and |callback| is run with OK
+  // once ReadBuffer() can be called again. Files that turn out to be shorter
+  // than their observed size are padded with zeros, as with Read().
+  //
+  // The returned buffer keeps the upload data alive, so it can outlive this
+  // stream. A stream must be read either with Read() or with ReadBuffer(), not
+  // both.
+  int ReadBuffer(int max_len, scoped_refptr<IOBuffer>* buf,
+                 const CompletionCallback& callback);
+
   // Sets the callback to be invoked when new chunks are available to upload.
   void set_chunk_callback(ChunkCallback* callback) {
     upload_data_->set_chunk_callback(callback);
@@ -68,7 +90,37 @@ class NET_EXPORT UploadDataStream {
   // This method is provided only to be used by unit tests.
   static void set_merge_chunks(bool merge) { merge_chunks_ = merge; }
 
+  // Elements held in memory with at least this many unread bytes are handed
+  // out in place by ReadBuffer(). Smaller ones are copied together.
+  static const int kMinInPlaceSize = 4 * 1024;
+
+  // Upper bound on the size of each file read done by ReadBuffer().
+  static const int kMaxFileReadSize = 64 * 1024;
+
  private:
+  // Hands out in-memory elements, starting with the current one.
+  int ReadMemoryBuffer(int max_len, scoped_refptr<IOBuffer>* buf);
+
+  // Hands out the file data read ahead for the current element, starting the
+  // file reads if needed.
+  int ReadFileBuffer(int max_len, scoped_refptr<IOBuffer>* buf,
+                     const CompletionCallback& callback);
+
+  // Moves on to the next element.
+  void NextElement();
+
+  // Steps of the asynchronous file reads of the current element.
+  // StartFileRead() opens the file the first time it's called.
+  void StartFileRead();
+  void OnFileOpened(int result);
+  void OnFileSeeked(int64 result);
+  void DoFileRead();
+  void OnFileRead(int result);
+
+  // Marks the pending file read as complete with |bytes_read| bytes, and runs
+  // the pending callback. Zero bytes fill the read buffer with zeros.
+  void CompleteFileRead(int bytes_read);
+
   scoped_refptr<UploadData> upload_data_;
 
   // Index of the current upload element (i.e. the element currently being
@@ -83,6 +135,27 @@ class NET_EXPORT UploadDataStream {
   // True if the initialization was successful.
   bool initialized_successfully_;
 
+  // Read position within the current element, used by ReadBuffer().
+  uint64 element_offset_;
+
+  // State of the file reads done by ReadBuffer() for the current element.
+  // |file_stream_| is NULL until the file is being opened, and after the file
+  // turns out to be unreadable or shorter than expected, in which case
+  // zeros are handed out instead. |file_read_buf_| holds the data read ahead
+  // once |file_read_pending_| is false, and |file_read_len_| bytes of it are
+  // valid. |file_bytes_read_| counts the bytes of the element read so far,
+  // including the ones read ahead.
+  scoped_ptr<FileStream> file_stream_;
+  bool file_open_started_;
+  bool file_read_pending_;
+  scoped_refptr<IOBufferWithSize> file_read_buf_;
+  int file_read_len_;
+  uint64 file_bytes_read_;
+  int file_read_size_;
+  CompletionCallback file_read_callback_;
+
+  base::WeakPtrFactory<UploadDataStream> weak_factory_;
+
   // TODO(satish): Remove this once we have a better way to unit test POST
   // requests with chunked uploads.
   static bool merge_chunks_;
@@ -0,0 +1,95 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times reading a large upload with Read(), which copies every element into
+// the caller's buffer, and with ReadBuffer(), which hands out in-memory
+// elements in place and reads files asynchronously.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/test/perf_benchmark.h"
+#include "base/time.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "net/base/upload_data.h"
+#include "net/base/upload_data_stream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kUploadSize = 32 * 1024 * 1024;
+const int kBufferSize = 1 << 14;  // 16KB.
+
+void ReadAll(const scoped_refptr<UploadData>& upload_data) {
+  UploadDataStream stream(upload_data);
+  CHECK_EQ(OK, stream.Init());
+  scoped_refptr<IOBuffer> buf = new IOBuffer(kBufferSize);
+  while (!stream.IsEOF())
+    CHECK_LT(0, stream.Read(buf, kBufferSize));
+}
+
+void ReadAllWithReadBuffer(const scoped_refptr<UploadData>& upload_data) {
+  UploadDataStream stream(upload_data);
+  CHECK_EQ(OK, stream.Init());
+  while (!stream.IsEOF()) {
+    scoped_refptr<IOBuffer> buf;
+    TestCompletionCallback callback;
+    int bytes_read = stream.ReadBuffer(kBufferSize, &buf,
+                                       callback.callback());
+    if (bytes_read == ERR_IO_PENDING)
+      CHECK_EQ(OK, callback.WaitForResult());
+    else
+      CHECK_LT(0, bytes_read);
+  }
+}
+
+void RunUploadBenchmarks(const std::string& name,
+                         const scoped_refptr<UploadData>& upload_data) {
+  base::PerfBenchmark read_benchmark("UploadDataStream_Read_" + name);
+  read_benchmark.set_warmup_runs(1);
+  read_benchmark.set_runs(10);
+  read_benchmark.Run(base::Bind(&ReadAll, upload_data));
+
+  base::PerfBenchmark read_buffer_benchmark(
+      "UploadDataStream_ReadBuffer_" + name);
+  read_buffer_benchmark.set_warmup_runs(1);
+  read_buffer_benchmark.set_runs(10);
+  read_buffer_benchmark.Run(base::Bind(&ReadAllWithReadBuffer, upload_data));
+}
+
+}  // namespace
+
+TEST(UploadDataStreamPerfTest, Bytes) {
+  MessageLoopForIO message_loop;
+  const std::string data(kUploadSize, 'x');
+  scoped_refptr<UploadData> upload_data(new UploadData);
+  upload_data->AppendBytes(data.data(), data.size());
+  RunUploadBenchmarks("bytes", upload_data);
+}
+
+TEST(UploadDataStreamPerfTest, File) {
+  // File elements are read asynchronously by ReadBuffer().
+  MessageLoopForIO message_loop;
+  FilePath temp_file_path;
+  ASSERT_TRUE(file_util::CreateTemporaryFile(&temp_file_path));
+  const std::string data(kUploadSize, 'x');
+  ASSERT_EQ(kUploadSize, file_util::WriteFile(temp_file_path, data.data(),
+                                              data.size()));
+
+  scoped_refptr<UploadData> upload_data(new UploadData);
+  upload_data->AppendFileRange(temp_file_path, 0, kuint64max, base::Time());
+  RunUploadBenchmarks("file", upload_data);
+
+  file_util::Delete(temp_file_path, false);
+}
+
+}  // namespace net
@@ -4,6 +4,7 @@
 
 #include "net/base/upload_data_stream.h"
 
+#include <string>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -12,9 +13,11 @@
 #include "base/file_util.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop.h"
+#include "base/stringprintf.h"
 #include "base/time.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
 #include "net/base/upload_data.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/platform_test.h"
@@ -27,6 +30,27 @@ const char kTestData[] = "0123456789";
 const size_t kTestDataSize = arraysize(kTestData) - 1;
 const size_t kTestBufferSize = 1 << 14;  // 16KB.
 
+// Reads |stream| to the end with ReadBuffer(), |max_len| bytes at a time.
+std::string ReadAllWithReadBuffer(UploadDataStream* stream, int max_len) {
+  std::string data;
+  while (!stream->IsEOF()) {
+    scoped_refptr<IOBuffer> buf;
+    TestCompletionCallback callback;
+    int bytes_read = stream->ReadBuffer(max_len, &buf, callback.callback());
+    if (bytes_read == ERR_IO_PENDING) {
+      EXPECT_EQ(OK, callback.WaitForResult());
+      continue;
+    }
+    EXPECT_LT(0, bytes_read);
+    EXPECT_GE(max_len, bytes_read);
+    if (bytes_read <= 0)
+      break;
+    data.append(buf->data(), bytes_read);
+    EXPECT_EQ(data.size(), stream->position());
+  }
+  return data;
+}
+
 }  // namespace
 
 class UploadDataStreamTest : public PlatformTest {
@@ -37,6 +61,8 @@ class UploadDataStreamTest : public PlatformTest {
                          const base::Time& time,
                          bool error_expected);
 
+  // File elements are read asynchronously by ReadBuffer().
+  MessageLoopForIO message_loop_;
   scoped_refptr<UploadData> upload_data_;
 };
 
@@ -104,6 +130,125 @@ TEST_F(UploadDataStreamTest, FileSmallerThanLength) {
   file_util::Delete(temp_file_path, false);
 }
 
+TEST_F(UploadDataStreamTest, ReadBufferMixedElements) {
+  FilePath temp_file_path;
+  ASSERT_TRUE(file_util::CreateTemporaryFile(&temp_file_path));
+  std::string file_data;
+  for (int i = 0; file_data.size() < 200 * 1024; ++i)
+    file_data += base::StringPrintf("line %d\n", i);
+  ASSERT_EQ(static_cast<int>(file_data.size()),
+            file_util::WriteFile(temp_file_path, file_data.data(),
+                                 file_data.size()));
+
+  const std::string large_bytes(20 * 1024, 'x');
+  upload_data_->AppendBytes(kTestData, kTestDataSize);
+  upload_data_->AppendBytes(kTestData, kTestDataSize);
+  upload_data_->AppendFileRange(temp_file_path, 3, 100 * 1024, base::Time());
+  upload_data_->AppendBytes(large_bytes.data(), large_bytes.size());
+  upload_data_->AppendBytes(kTestData, kTestDataSize);
+  upload_data_->AppendFileRange(temp_file_path, 0, kuint64max, base::Time());
+
+  std::string expected;
+  {
+    scoped_ptr<UploadDataStream> stream(new UploadDataStream(upload_data_));
+    ASSERT_EQ(OK, stream->Init());
+    scoped_refptr<IOBuffer> buf = new IOBuffer(kTestBufferSize);
+    while (!stream->IsEOF()) {
+      int bytes_read = stream->Read(buf, kTestBufferSize);
+      ASSERT_LT(0, bytes_read);
+      expected.append(buf->data(), bytes_read);
+    }
+  }
+  EXPECT_EQ(std::string(kTestData) + kTestData +
+                file_data.substr(3, 100 * 1024) + large_bytes + kTestData +
+                file_data,
+            expected);
+
+  const int kMaxLens[] = { 100, 4096, 16 * 1024, 100 * 1024 };
+  for (size_t i = 0; i < arraysize(kMaxLens); ++i) {
+    SCOPED_TRACE(kMaxLens[i]);
+    scoped_ptr<UploadDataStream> stream(new UploadDataStream(upload_data_));
+    ASSERT_EQ(OK, stream->Init());
+    EXPECT_EQ(expected, ReadAllWithReadBuffer(stream.get(), kMaxLens[i]));
+    EXPECT_EQ(expected.size(), stream->position());
+  }
+
+  file_util::Delete(temp_file_path, false);
+}
+
+TEST_F(UploadDataStreamTest, ReadBufferInPlace) {
+  const std::string large_bytes(64 * 1024, 'x');
+  upload_data_->AppendBytes(kTestData, kTestDataSize);
+  upload_data_->AppendBytes(large_bytes.data(), large_bytes.size());
+  const char* element_data = (*upload_data_->elements())[1].bytes();
+
+  scoped_ptr<UploadDataStream> stream(new UploadDataStream(upload_data_));
+  ASSERT_EQ(OK, stream->Init());
+
+  // The small element isn't merged with the large one that follows it.
+  scoped_refptr<IOBuffer> buf;
+  EXPECT_EQ(static_cast<int>(kTestDataSize),
+            stream->ReadBuffer(kTestBufferSize, &buf, CompletionCallback()));
+  EXPECT_EQ(std::string(kTestData), std::string(buf->data(), kTestDataSize));
+
+  // The large element is handed out without being copied.
+  EXPECT_EQ(static_cast<int>(kTestBufferSize),
+            stream->ReadBuffer(kTestBufferSize, &buf, CompletionCallback()));
+  EXPECT_EQ(element_data, buf->data());
+  EXPECT_EQ(static_cast<int>(kTestBufferSize),
+            stream->ReadBuffer(kTestBufferSize, &buf, CompletionCallback()));
+  EXPECT_EQ(element_data + kTestBufferSize, buf->data());
+
+  // The buffer keeps the data alive.
+  stream.reset();
+  upload_data_ = NULL;
+  EXPECT_EQ('x', buf->data()[kTestBufferSize - 1]);
+}
+
+TEST_F(UploadDataStreamTest, ReadBufferFileSmallerThanLength) {
+  FilePath temp_file_path;
+  ASSERT_TRUE(file_util::CreateTemporaryFile(&temp_file_path));
+  ASSERT_EQ(static_cast<int>(kTestDataSize),
+            file_util::WriteFile(temp_file_path, kTestData, kTestDataSize));
+  const uint64 kFakeSize = kTestDataSize*2;
+
+  std::vector<UploadData::Element> elements;
+  UploadData::Element element;
+  element.SetToFilePath(temp_file_path);
+  element.SetContentLength(kFakeSize);
+  elements.push_back(element);
+  upload_data_->SetElements(elements);
+
+  scoped_ptr<UploadDataStream> stream(new UploadDataStream(upload_data_));
+  ASSERT_EQ(OK, stream->Init());
+  // The file is padded with zeros, like Read() does.
+  EXPECT_EQ(std::string(kTestData) + std::string(kTestDataSize, '\0'),
+            ReadAllWithReadBuffer(stream.get(), kTestBufferSize));
+
+  file_util::Delete(temp_file_path, false);
+}
+
+// A file larger than the read size takes several asynchronous reads, and
+// every byte comes back in order.
+TEST_F(UploadDataStreamTest, ReadBufferFile) {
+  FilePath temp_file_path;
+  ASSERT_TRUE(file_util::CreateTemporaryFile(&temp_file_path));
+  std::string file_data;
+  for (int i = 0; file_data.size() < 4 * kTestBufferSize; ++i)
+    file_data += base::StringPrintf("line %d\n", i);
+  ASSERT_EQ(static_cast<int>(file_data.size()),
+            file_util::WriteFile(temp_file_path, file_data.data(),
+                                 file_data.size()));
+
+  upload_data_->AppendFileRange(temp_file_path, 0, kuint64max, base::Time());
+  scoped_ptr<UploadDataStream> stream(new UploadDataStream(upload_data_));
+  ASSERT_EQ(OK, stream->Init());
+  EXPECT_EQ(file_data, ReadAllWithReadBuffer(stream.get(), kTestBufferSize));
+  EXPECT_TRUE(stream->IsEOF());
+
+  file_util::Delete(temp_file_path, false);
+}
+
 void UploadDataStreamTest::FileChangedHelper(const FilePath& file_path,
                                              const base::Time& time,
                                              bool error_expected) {
@@ -177,4 +177,25 @@ TEST_F(UploadDataTest, GetContentLength_Mixed) {
   ASSERT_EQ(content_length + kData.size(), callback.WaitForResult());
 }
 
+TEST_F(UploadDataTest, SharedBytes) {
+  const char kData[] = "123abc";
+  upload_data_->elements()->push_back(UploadData::Element());
+  UploadData::Element& element = upload_data_->elements()->back();
+  element.SetToSharedBytes(kData, 6);
+  EXPECT_EQ(kData, element.bytes());
+  EXPECT_EQ(6U, element.bytes_length());
+  EXPECT_EQ(6U, upload_data_->GetContentLengthSync());
+  EXPECT_TRUE(upload_data_->IsInMemory());
+
+  char buf[4];
+  EXPECT_EQ(4, element.ReadSync(buf, sizeof(buf)));
+  EXPECT_EQ(0, memcmp(kData, buf, sizeof(buf)));
+  EXPECT_EQ(2U, element.BytesRemaining());
+
+  // Setting copied bytes stops sharing |kData|.
+  element.SetToBytes(kData, 3);
+  EXPECT_NE(kData, element.bytes());
+  EXPECT_EQ(3U, element.bytes_length());
+}
+
 }  // namespace net
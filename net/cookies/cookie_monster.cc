@@ -108,6 +108,22 @@ typedef std::vector<CookieMonster::CanonicalCookie*> CanonicalCookieVector;
 // will update it again.
 const int kDefaultAccessUpdateThresholdSeconds = 60;
 
+// The number of cookie lines kept by GetCookiesWithOptions().
+const size_t kMaxCachedCookieLines = 64;
+
+// Returns the key under which the cookie line for |url| and |options| is
+// cached.  Everything that decides which cookies apply to a request is part
+// of it: the scheme (for secure cookies), the host and the path.
+std::string GetCookieLineCacheKey(const GURL& url,
+                                  const CookieOptions& options) {
+  std::string cache_key(options.exclude_httponly() ? "-" : "+");
+  cache_key.append(url.scheme());
+  cache_key.append("://");
+  cache_key.append(url.host());
+  cache_key.append(url.path());
+  return cache_key;
+}
+
 // Comparator to sort cookies from highest creation date to lowest
 // creation date.
 struct OrderByCreationTimeDesc {
@@ -362,7 +378,8 @@ void BuildCookieInfoList(const CanonicalCookieVector& cookies,
 bool CookieMonster::enable_file_scheme_ = false;
 
 CookieMonster::CookieMonster(PersistentCookieStore* store, Delegate* delegate)
-    : initialized_(false),
+    : cookie_line_cache_(kMaxCachedCookieLines),
+      initialized_(false),
       loaded_(false),
       store_(store),
       last_access_threshold_(
@@ -370,7 +387,8 @@ CookieMonster::CookieMonster(PersistentCookieStore* store, Delegate* delegate)
       delegate_(delegate),
       last_statistic_record_time_(Time::Now()),
       keep_expired_cookies_(false),
-      persist_session_cookies_(false) {
+      persist_session_cookies_(false),
+      first_cookie_load_recorded_(false) {
   InitializeHistograms();
   SetDefaultCookieableSchemes();
 }
@@ -378,7 +396,8 @@ CookieMonster::CookieMonster(PersistentCookieStore* store, Delegate* delegate)
 CookieMonster::CookieMonster(PersistentCookieStore* store,
                              Delegate* delegate,
                              int last_access_threshold_milliseconds)
-    : initialized_(false),
+    : cookie_line_cache_(kMaxCachedCookieLines),
+      initialized_(false),
       loaded_(false),
       store_(store),
       last_access_threshold_(base::TimeDelta::FromMilliseconds(
@@ -386,11 +405,16 @@ CookieMonster::CookieMonster(PersistentCookieStore* store,
       delegate_(delegate),
       last_statistic_record_time_(base::Time::Now()),
       keep_expired_cookies_(false),
-      persist_session_cookies_(false) {
+      persist_session_cookies_(false),
+      first_cookie_load_recorded_(false) {
   InitializeHistograms();
   SetDefaultCookieableSchemes();
 }
 
+CookieMonster::CachedCookieLine::CachedCookieLine() {}
+
+CookieMonster::CachedCookieLine::~CachedCookieLine() {}
+
 // Parse a cookie expiration time.  We try to be lenient, but we need to
 // assume some order to distinguish the fields.  The basic rules:
 //  - The month name must be present and prefix the first 3 letters of the
@@ -1159,7 +1183,8 @@ void CookieMonster::DoCookieTaskForURL(
           ::iterator it = tasks_queued_.find(key);
         if (it == tasks_queued_.end()) {
           store_->LoadCookiesForKey(key,
-            base::Bind(&CookieMonster::OnKeyLoaded, this, key));
+            base::Bind(&CookieMonster::OnKeyLoaded, this, key,
+                       TimeTicks::Now()));
           it = tasks_queued_.insert(std::make_pair(key,
             std::deque<scoped_refptr<CookieMonsterTask> >())).first;
         }
@@ -1412,12 +1437,53 @@ std::string CookieMonster::GetCookiesWithOptions(const GURL& url,
 
   TimeTicks start_time(TimeTicks::Now());
 
+  // The cookie line is reused as long as no cookie of the domain was added or
+  // removed since, and none of its cookies expired.  Expired cookies are kept
+  // around on purpose when |keep_expired_cookies_| is set, so the cache is
+  // not used then.
+  const std::string cache_key(GetCookieLineCacheKey(url, options));
+  if (!keep_expired_cookies_) {
+    CookieLineCache::iterator cached = cookie_line_cache_.Get(cache_key);
+    if (cached != cookie_line_cache_.end()) {
+      const Time current_time(CurrentTime());
+      const CachedCookieLine& entry = cached->second;
+      if (entry.expiry_date.is_null() || current_time < entry.expiry_date) {
+        RecordPeriodicStats(current_time);
+        for (std::vector<CanonicalCookie*>::const_iterator it =
+                 entry.cookies.begin(); it != entry.cookies.end(); ++it) {
+          InternalUpdateCookieAccessTime(*it, current_time);
+        }
+        histogram_time_get_->AddTime(TimeTicks::Now() - start_time);
+        VLOG(kVlogGetCookies) << "GetCookies() cached result: "
+                              << entry.cookie_line;
+        return entry.cookie_line;
+      }
+      cookie_line_cache_.Erase(cached);
+    }
+  }
+
   std::vector<CanonicalCookie*> cookies;
   FindCookiesForHostAndDomain(url, options, true, &cookies);
   std::sort(cookies.begin(), cookies.end(), CookieSorter);
 
   std::string cookie_line = BuildCookieLine(cookies);
 
+  if (!keep_expired_cookies_) {
+    CachedCookieLine entry;
+    entry.key = GetKey(url.host());
+    entry.cookie_line = cookie_line;
+    entry.cookies = cookies;
+    for (std::vector<CanonicalCookie*>::const_iterator it = cookies.begin();
+         it != cookies.end(); ++it) {
+      const Time& expiry_date = (*it)->ExpiryDate();
+      if (!expiry_date.is_null() &&
+          (entry.expiry_date.is_null() || expiry_date < entry.expiry_date)) {
+        entry.expiry_date = expiry_date;
+      }
+    }
+    cookie_line_cache_.Put(cache_key, entry);
+  }
+
   histogram_time_get_->AddTime(TimeTicks::Now() - start_time);
 
   VLOG(kVlogGetCookies) << "GetCookies() result: " << cookie_line;
@@ -1543,22 +1609,29 @@ void CookieMonster::InitStore() {
 
   // We bind in the current time so that we can report the wall-clock time for
   // loading cookies.
-  store_->Load(base::Bind(&CookieMonster::OnLoaded, this, TimeTicks::Now()));
+  store_load_start_time_ = TimeTicks::Now();
+  store_->Load(base::Bind(&CookieMonster::OnLoaded, this,
+                          store_load_start_time_));
 }
 
 void CookieMonster::OnLoaded(TimeTicks beginning_time,
                              const std::vector<CanonicalCookie*>& cookies) {
   StoreLoadedCookies(cookies);
   histogram_time_blocked_on_load_->AddTime(TimeTicks::Now() - beginning_time);
+  RecordFirstCookieLoaded();
 
   // Invoke the task queue of cookie request.
   InvokeQueue();
 }
 
 void CookieMonster::OnKeyLoaded(const std::string& key,
+                                TimeTicks beginning_time,
                                 const std::vector<CanonicalCookie*>& cookies) {
   // This function does its own separate locking.
   StoreLoadedCookies(cookies);
+  histogram_time_blocked_on_key_load_->AddTime(
+      TimeTicks::Now() - beginning_time);
+  RecordFirstCookieLoaded();
 
   std::deque<scoped_refptr<CookieMonsterTask> > tasks_queued;
   {
@@ -1586,12 +1659,15 @@ void CookieMonster::StoreLoadedCookies(
   // and sync'd.
   base::AutoLock autolock(lock_);
 
+  std::set<std::string> keys;
   for (std::vector<CanonicalCookie*>::const_iterator it = cookies.begin();
        it != cookies.end(); ++it) {
     int64 cookie_creation_time = (*it)->CreationDate().ToInternalValue();
 
     if (creation_times_.insert(cookie_creation_time).second) {
-      InternalInsertCookie(GetKey((*it)->Domain()), *it, false);
+      const std::string key(GetKey((*it)->Domain()));
+      InternalInsertCookie(key, *it, false);
+      keys.insert(key);
       const Time cookie_access_time((*it)->LastAccessDate());
       if (earliest_access_time_.is_null() ||
           cookie_access_time < earliest_access_time_)
@@ -1613,10 +1689,19 @@ void CookieMonster::StoreLoadedCookies(
   // none of our other constraints are violated.
   // In particular, the backing store might have given us duplicate cookies.
 
-  // This method could be called multiple times due to priority loading, thus
-  // cookies loaded in previous runs will be validated again, but this is OK
-  // since they are expected to be much fewer than total DB.
-  EnsureCookiesMapIsValid();
+  // This method is called once per priority load, so only the keys that just
+  // received cookies are validated; the cookies of a key are all loaded at
+  // once.
+  EnsureCookiesMapIsValid(keys);
+}
+
+void CookieMonster::RecordFirstCookieLoaded() {
+  base::AutoLock autolock(lock_);
+  if (first_cookie_load_recorded_)
+    return;
+  first_cookie_load_recorded_ = true;
+  histogram_time_to_first_cookie_load_->AddTime(
+      TimeTicks::Now() - store_load_start_time_);
 }
 
 void CookieMonster::InvokeQueue() {
@@ -1637,22 +1722,19 @@ void CookieMonster::InvokeQueue() {
   }
 }
 
-void CookieMonster::EnsureCookiesMapIsValid() {
+void CookieMonster::EnsureCookiesMapIsValid(
+    const std::set<std::string>& keys) {
   lock_.AssertAcquired();
 
   int num_duplicates_trimmed = 0;
 
-  // Iterate through all the of the cookies, grouped by host.
-  CookieMap::iterator prev_range_end = cookies_.begin();
-  while (prev_range_end != cookies_.end()) {
-    CookieMap::iterator cur_range_begin = prev_range_end;
-    const std::string key = cur_range_begin->first;  // Keep a copy.
-    CookieMap::iterator cur_range_end = cookies_.upper_bound(key);
-    prev_range_end = cur_range_end;
+  for (std::set<std::string>::const_iterator it = keys.begin();
+       it != keys.end(); ++it) {
+    CookieMapItPair range = cookies_.equal_range(*it);
 
     // Ensure no equivalent cookies for this host.
     num_duplicates_trimmed +=
-        TrimDuplicateCookiesForKey(key, cur_range_begin, cur_range_end);
+        TrimDuplicateCookiesForKey(*it, range.first, range.second);
   }
 
   // Record how many duplicates were found in the database.
@@ -1826,6 +1908,18 @@ void CookieMonster::FindCookiesForKey(
   }
 }
 
+void CookieMonster::InvalidateCachedCookieLines(const std::string& key) {
+  lock_.AssertAcquired();
+
+  for (CookieLineCache::iterator it = cookie_line_cache_.begin();
+       it != cookie_line_cache_.end(); ) {
+    if (it->second.key == key)
+      it = cookie_line_cache_.Erase(it);
+    else
+      ++it;
+  }
+}
+
 bool CookieMonster::DeleteAnyEquivalentCookie(const std::string& key,
                                               const CanonicalCookie& ecc,
                                               bool skip_httponly,
@@ -1865,6 +1959,7 @@ void CookieMonster::InternalInsertCookie(const std::string& key,
   if ((cc->IsPersistent() || persist_session_cookies_) &&
       store_ && sync_to_store)
     store_->AddCookie(*cc);
+  InvalidateCachedCookieLines(key);
   cookies_.insert(CookieMap::value_type(key, cc));
   if (delegate_.get()) {
     delegate_->OnCookieChanged(
@@ -2011,6 +2106,7 @@ void CookieMonster::InternalDeleteCookie(CookieMap::iterator it,
     if (mapping.notify)
       delegate_->OnCookieChanged(*cc, true, mapping.cause);
   }
+  InvalidateCachedCookieLines(it->first);
   cookies_.erase(it);
   delete cc;
 }
@@ -2317,6 +2413,14 @@ void CookieMonster::InitializeHistograms() {
       "Cookie.TimeBlockedOnLoad",
       base::TimeDelta::FromMilliseconds(1), base::TimeDelta::FromMinutes(1),
       50, base::Histogram::kUmaTargetedHistogramFlag);
+  histogram_time_blocked_on_key_load_ = base::Histogram::FactoryTimeGet(
+      "Cookie.TimeBlockedOnKeyLoad",
+      base::TimeDelta::FromMilliseconds(1), base::TimeDelta::FromMinutes(1),
+      50, base::Histogram::kUmaTargetedHistogramFlag);
+  histogram_time_to_first_cookie_load_ = base::Histogram::FactoryTimeGet(
+      "Cookie.TimeToFirstCookieLoad",
+      base::TimeDelta::FromMilliseconds(1), base::TimeDelta::FromMinutes(1),
+      50, base::Histogram::kUmaTargetedHistogramFlag);
 }
 
 
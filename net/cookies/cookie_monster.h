@@ -19,6 +19,7 @@
 #include "base/basictypes.h"
 #include "base/callback_forward.h"
 #include "base/gtest_prod_util.h"
+#include "base/memory/mru_cache.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/synchronization/lock.h"
@@ -446,21 +447,28 @@ class NET_EXPORT CookieMonster : public CookieStore {
   // Stores cookies loaded from the backing store and invokes the deferred
   // task(s) pending loading of cookies associated with the domain key
   // (eTLD+1). Called when all cookies for the domain key(eTLD+1) have been
-  // loaded from DB. See PersistentCookieStore::Load for details on the contents
-  // of cookies.
+  // loaded from DB. |beginning_time| is the moment the key was requested from
+  // the backing store. See PersistentCookieStore::Load for details on the
+  // contents of cookies.
   void OnKeyLoaded(
     const std::string& key,
+    base::TimeTicks beginning_time,
     const std::vector<CanonicalCookie*>& cookies);
 
+  // Reports the time from InitStore() until the first cookies could be used,
+  // either from a priority load or from the full load.
+  void RecordFirstCookieLoaded();
+
   // Stores the loaded cookies.
   void StoreLoadedCookies(const std::vector<CanonicalCookie*>& cookies);
 
   // Invokes deferred calls.
   void InvokeQueue();
 
-  // Checks that |cookies_| matches our invariants, and tries to repair any
-  // inconsistencies. (In other words, it does not have duplicate cookies).
-  void EnsureCookiesMapIsValid();
+  // Checks that the cookies of the CookieMap keys in |keys| match our
+  // invariants, and tries to repair any inconsistencies. (In other words, they
+  // do not have duplicate cookies).
+  void EnsureCookiesMapIsValid(const std::set<std::string>& keys);
 
   // Checks for any duplicate cookies for CookieMap key |key| which lie between
   // |begin| and |end|. If any are found, all but the most recent are deleted.
@@ -483,6 +491,10 @@ class NET_EXPORT CookieMonster : public CookieStore {
                          bool update_access_time,
                          std::vector<CanonicalCookie*>* cookies);
 
+  // Drops the cookie lines cached for CookieMap key |key|.  Must be called
+  // whenever a cookie is added to or removed from |cookies_| under |key|.
+  void InvalidateCachedCookieLines(const std::string& key);
+
   // Delete any cookies that are equivalent to |ecc| (same path, domain, etc).
   // If |skip_httponly| is true, httponly cookies will not be deleted.  The
   // return value with be true if |skip_httponly| skipped an httponly cookie.
@@ -590,9 +602,34 @@ class NET_EXPORT CookieMonster : public CookieStore {
   base::Histogram* histogram_time_get_;
   base::Histogram* histogram_time_mac_;
   base::Histogram* histogram_time_blocked_on_load_;
+  base::Histogram* histogram_time_blocked_on_key_load_;
+  base::Histogram* histogram_time_to_first_cookie_load_;
 
   CookieMap cookies_;
 
+  // A cookie line computed by GetCookiesWithOptions(), along with the cookies
+  // it was built from, so that their access times can still be updated when
+  // the line is reused.
+  struct CachedCookieLine {
+    CachedCookieLine();
+    ~CachedCookieLine();
+
+    // The CookieMap key that holds all of |cookies|.
+    std::string key;
+    std::string cookie_line;
+    std::vector<CanonicalCookie*> cookies;
+    // The earliest expiration date of |cookies|, or null if none of them
+    // expire.  The line can't be reused from then on.
+    base::Time expiry_date;
+  };
+  typedef base::MRUCache<std::string, CachedCookieLine> CookieLineCache;
+
+  // Cookie lines most recently returned by GetCookiesWithOptions(), keyed by
+  // the options, scheme, host and path they were computed for.  Pages issue
+  // many requests to the same few URLs, and each would otherwise walk all the
+  // cookies of the domain again.
+  CookieLineCache cookie_line_cache_;
+
   // Indicates whether the cookie store has been initialized. This happens
   // lazily in InitStoreIfNecessary().
   bool initialized_;
@@ -651,6 +688,11 @@ class NET_EXPORT CookieMonster : public CookieStore {
   bool keep_expired_cookies_;
   bool persist_session_cookies_;
 
+  // When InitStore() started loading the backing store, and whether the time
+  // until the first cookies were loaded has been reported yet.
+  base::TimeTicks store_load_start_time_;
+  bool first_cookie_load_recorded_;
+
   static bool enable_file_scheme_;
 
   DISALLOW_COPY_AND_ASSIGN(CookieMonster);
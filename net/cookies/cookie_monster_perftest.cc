@@ -5,8 +5,10 @@
 #include <algorithm>
 
 #include "base/bind.h"
+#include "base/format_macros.h"
 #include "base/message_loop.h"
 #include "base/perftimer.h"
+#include "base/string_number_conversions.h"
 #include "base/string_util.h"
 #include "base/stringprintf.h"
 #include "googleurl/src/gurl.h"
@@ -223,6 +225,48 @@ TEST_F(CookieMonsterTest, TestGetCookiesWithInfo) {
   timer.Done();
 }
 
+// Pages load many resources from the same few URLs of a domain that holds
+// many cookies; reading the cookies for them is the common case.
+TEST_F(CookieMonsterTest, TestQueryBusyDomain) {
+  scoped_refptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
+
+  SetCookieCallback setCookieCallback;
+  const char* kHosts[] = { "http://www.google.izzle",
+                           "http://a.google.izzle",
+                           "http://b.a.google.izzle" };
+  const char* kPaths[] = { "/", "/foo", "/foo/bar", "/baz" };
+  for (size_t i = 0; i < 150; ++i) {
+    GURL gurl(std::string(kHosts[i % arraysize(kHosts)]) +
+              kPaths[i % arraysize(kPaths)]);
+    setCookieCallback.SetCookie(
+        cm, gurl, base::StringPrintf("a%03" PRIuS "=b; path=%s", i,
+                                     kPaths[i % arraysize(kPaths)]));
+  }
+
+  std::vector<GURL> gurls;
+  for (size_t i = 0; i < arraysize(kHosts); ++i) {
+    gurls.push_back(GURL(std::string(kHosts[i]) + "/foo/bar/index.html"));
+    gurls.push_back(GURL(std::string(kHosts[i]) + "/baz/image.png"));
+  }
+
+  GetCookiesCallback getCookiesCallback;
+
+  PerfTimeLogger timer("Cookie_monster_query_busy_domain");
+  for (int i = 0; i < kNumCookies; ++i)
+    getCookiesCallback.GetCookies(cm, gurls[i % gurls.size()]);
+  timer.Done();
+
+  // A cookie set every few reads throws away the lines cached for the domain.
+  PerfTimeLogger timer2("Cookie_monster_query_busy_domain_with_updates");
+  for (int i = 0; i < kNumCookies; ++i) {
+    if (i % 10 == 0)
+      setCookieCallback.SetCookie(cm, gurls[0], "counter=" +
+                                  base::IntToString(i));
+    getCookiesCallback.GetCookies(cm, gurls[i % gurls.size()]);
+  }
+  timer2.Done();
+}
+
 static int CountInString(const std::string& str, char c) {
   return std::count(str.begin(), str.end(), c);
 }
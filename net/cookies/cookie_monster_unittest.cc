@@ -1345,6 +1345,63 @@ TEST_F(CookieMonsterTest, TestLastAccess) {
   EXPECT_FALSE(last_access_date == GetFirstCookieAccessDate(cm));
 }
 
+// GetCookies() reuses the cookie lines it computed until a cookie of the
+// domain changes or expires; check that the reused lines stay correct.
+TEST_F(CookieMonsterTest, CachedCookieLines) {
+  scoped_refptr<CookieMonster> cm(
+      new CookieMonster(NULL, NULL, kLastAccessThresholdMilliseconds));
+  CookieOptions options;
+  options.set_include_httponly();
+
+  EXPECT_TRUE(SetCookie(cm, url_google_, "A=B"));
+  EXPECT_EQ("A=B", GetCookies(cm, url_google_));
+  EXPECT_EQ("A=B", GetCookies(cm, url_google_));
+
+  // Adding, replacing and deleting cookies is seen by the next read.
+  EXPECT_TRUE(SetCookie(cm, url_google_, "C=D"));
+  EXPECT_EQ("A=B; C=D", GetCookies(cm, url_google_));
+  EXPECT_TRUE(SetCookie(cm, url_google_, "A=E"));
+  EXPECT_EQ("C=D; A=E", GetCookies(cm, url_google_));
+  EXPECT_TRUE(FindAndDeleteCookie(cm, url_google_.host(), "C"));
+  EXPECT_EQ("A=E", GetCookies(cm, url_google_));
+
+  // The options, scheme and path of the request are part of the key.
+  EXPECT_TRUE(SetCookieWithOptions(cm, url_google_, "H=I; httponly", options));
+  EXPECT_EQ("A=E", GetCookies(cm, url_google_));
+  EXPECT_EQ("A=E; H=I", GetCookiesWithOptions(cm, url_google_, options));
+  EXPECT_TRUE(SetCookie(cm, url_google_secure_, "S=T; secure"));
+  EXPECT_EQ("A=E", GetCookies(cm, url_google_));
+  EXPECT_EQ("A=E; S=T", GetCookies(cm, url_google_secure_));
+  EXPECT_TRUE(SetCookie(cm, url_google_foo_, "P=Q; path=/foo"));
+  EXPECT_EQ("A=E", GetCookies(cm, url_google_));
+  EXPECT_EQ("P=Q; A=E", GetCookies(cm, url_google_foo_));
+
+  // Changes to another domain don't affect the cached lines.
+  EXPECT_TRUE(SetCookie(cm, GURL("http://www.example.com"), "X=Y"));
+  EXPECT_EQ("A=E", GetCookies(cm, url_google_));
+  EXPECT_EQ("X=Y", GetCookies(cm, GURL("http://www.example.com")));
+
+  // Reused lines still update the access date of their cookies.
+  EXPECT_EQ(5, DeleteAll(cm));
+  EXPECT_TRUE(SetCookie(cm, url_google_, "A=B"));
+  EXPECT_EQ("A=B", GetCookies(cm, url_google_));
+  const Time last_access_date(GetFirstCookieAccessDate(cm));
+  base::PlatformThread::Sleep(
+      base::TimeDelta::FromMilliseconds(kAccessDelayMs));
+  EXPECT_EQ("A=B", GetCookies(cm, url_google_));
+  EXPECT_FALSE(last_access_date == GetFirstCookieAccessDate(cm));
+
+  // A line isn't reused once one of its cookies expired.
+  EXPECT_TRUE(SetCookieWithDetails(
+      cm, url_google_, "E", "F", std::string(), "/",
+      Time::Now() + TimeDelta::FromMilliseconds(kAccessDelayMs),
+      false, false));
+  EXPECT_EQ("A=B; E=F", GetCookies(cm, url_google_));
+  base::PlatformThread::Sleep(
+      base::TimeDelta::FromMilliseconds(2 * kAccessDelayMs));
+  EXPECT_EQ("A=B", GetCookies(cm, url_google_));
+}
+
 TEST_F(CookieMonsterTest, TestHostGarbageCollection) {
   TestHostGarbageCollectHelper(
       CookieMonster::kDomainMaxCookies, CookieMonster::kDomainPurgeCookies);
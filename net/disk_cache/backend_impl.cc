@@ -32,6 +32,8 @@
 // This has to be defined before including histogram_macros.h from this file.
 #define NET_DISK_CACHE_BACKEND_IMPL_CC_
 #include "net/disk_cache/histogram_macros.h"
+#include "net/disk_cache/simple/simple_backend_impl.h"
+#include "net/disk_cache/tiered_backend_impl.h"
 
 using base::Time;
 using base::TimeDelta;
@@ -52,6 +54,15 @@ const int kDefaultCacheSize = 80 * 1024 * 1024;
 // Avoid trimming the cache for the first 5 minutes (10 timer ticks).
 const int kTrimDelay = 10;
 
+// The summary of the index is rebuilt when it has this many removed entries,
+// and as many as the stored ones.
+const int kMinRemovedForSummaryRebuild = 1000;
+
+// After a crash, the index is scrubbed this many buckets at a time, starting
+// a few seconds after the cache is ready so that the first requests go first.
+const int kScrubBucketsPerTask = 256;
+const int kScrubDelaySeconds = 5;
+
 int DesiredIndexTableLen(int32 storage_size) {
   if (storage_size <= k64kEntriesStore)
     return kBaseTableLen;
@@ -143,14 +154,31 @@ bool DelayedCacheCleanup(const FilePath& full_path) {
 
 // Sets group for the current experiment. Returns false if the files should be
 // discarded.
-bool InitExperiment(disk_cache::IndexHeader* header) {
+bool InitExperiment(disk_cache::IndexHeader* header, bool cache_created) {
   if (header->experiment == disk_cache::EXPERIMENT_OLD_FILE1 ||
       header->experiment == disk_cache::EXPERIMENT_OLD_FILE2) {
     // Discard current cache.
     return false;
   }
 
+  if (header->experiment == disk_cache::EXPERIMENT_SIZE_AWARE_CONTROL ||
+      header->experiment == disk_cache::EXPERIMENT_SIZE_AWARE_EVICTION) {
+    // Keep the group for the lifetime of the files.
+    return true;
+  }
+
   header->experiment = disk_cache::NO_EXPERIMENT;
+  if (!cache_created)
+    return true;
+
+  // Only empty caches join the size-aware eviction experiment, so that both
+  // groups start from the same state.
+  int option = base::RandInt(0, 99);
+  if (option < 5) {
+    header->experiment = disk_cache::EXPERIMENT_SIZE_AWARE_EVICTION;
+  } else if (option < 10) {
+    header->experiment = disk_cache::EXPERIMENT_SIZE_AWARE_CONTROL;
+  }
   return true;
 }
 
@@ -174,7 +202,8 @@ class CacheCreator {
         backend_(backend),
         callback_(callback),
         cache_(NULL),
-        net_log_(net_log) {
+        net_log_(net_log),
+        start_(base::TimeTicks::Now()) {
   }
   ~CacheCreator() {}
 
@@ -198,6 +227,7 @@ class CacheCreator {
   net::CompletionCallback callback_;
   disk_cache::BackendImpl* cache_;
   net::NetLog* net_log_;
+  base::TimeTicks start_;
 
   DISALLOW_COPY_AND_ASSIGN(CacheCreator);
 };
@@ -216,6 +246,13 @@ int CacheCreator::Run() {
 void CacheCreator::DoCallback(int result) {
   DCHECK_NE(net::ERR_IO_PENDING, result);
   if (result == net::OK) {
+    // How long the first requests waited for the cache, and whether it had
+    // to be thrown away to get there.
+    if (type_ == net::DISK_CACHE) {
+      UMA_HISTOGRAM_TIMES("DiskCache.TimeToReady",
+                          base::TimeTicks::Now() - start_);
+      UMA_HISTOGRAM_BOOLEAN("DiskCache.DiscardedAtInit", retry_);
+    }
     *backend_ = cache_;
   } else {
     LOG(ERROR) << "Unable to create cache";
@@ -255,7 +292,8 @@ void FinalCleanupCallback(disk_cache::BackendImpl* backend) {
 
 namespace disk_cache {
 
-int CreateCacheBackend(net::CacheType type, const FilePath& path, int max_bytes,
+int CreateCacheBackend(net::CacheType type, net::BackendType backend_type,
+                       const FilePath& path, int max_bytes,
                        bool force, base::MessageLoopProxy* thread,
                        net::NetLog* net_log, Backend** backend,
                        const net::CompletionCallback& callback) {
@@ -266,6 +304,17 @@ int CreateCacheBackend(net::CacheType type, const FilePath& path, int max_bytes,
   }
   DCHECK(thread);
 
+  if (backend_type == net::CACHE_BACKEND_SIMPLE) {
+    return SimpleBackendImpl::CreateBackend(path, max_bytes, thread, backend,
+                                            callback);
+  }
+
+  if (backend_type == net::CACHE_BACKEND_TIERED) {
+    return TieredBackendImpl::CreateBackend(path, force, max_bytes, type,
+                                            thread, net_log, backend,
+                                            callback);
+  }
+
   return BackendImpl::CreateBackend(path, force, max_bytes, type, kNone, thread,
                                     net_log, backend, callback);
 }
@@ -319,7 +368,11 @@ BackendImpl::BackendImpl(const FilePath& path,
       read_only_(false),
       disabled_(false),
       new_eviction_(false),
+      size_aware_eviction_(false),
       first_timer_(true),
+      scrubbing_(false),
+      scrub_position_(0),
+      num_scrubbed_(0),
       user_load_(false),
       net_log_(net_log),
       done_(true, false),
@@ -345,7 +398,11 @@ BackendImpl::BackendImpl(const FilePath& path,
       read_only_(false),
       disabled_(false),
       new_eviction_(false),
+      size_aware_eviction_(false),
       first_timer_(true),
+      scrubbing_(false),
+      scrub_position_(0),
+      num_scrubbed_(0),
       user_load_(false),
       net_log_(net_log),
       done_(true, false),
@@ -453,10 +510,15 @@ int BackendImpl::SyncInit() {
   if (create_files || !data_->header.num_entries)
     ReportError(ERR_CACHE_CREATED);
 
-  if (!(user_flags_ & kNoRandom) &&
-      cache_type_ == net::DISK_CACHE && !InitExperiment(&data_->header))
+  if (!(user_flags_ & kNoRandom) && cache_type_ == net::DISK_CACHE &&
+      !InitExperiment(&data_->header,
+                      create_files || !data_->header.num_entries))
     return net::ERR_FAILED;
 
+  if (new_eviction_ &&
+      data_->header.experiment == EXPERIMENT_SIZE_AWARE_EVICTION)
+    size_aware_eviction_ = true;
+
   // We don't care if the value overflows. The only thing we care about is that
   // the id cannot be zero, because that value is used as "not dirty".
   // Increasing the value once per second gives us many years before we start
@@ -465,8 +527,10 @@ int BackendImpl::SyncInit() {
   if (!data_->header.this_id)
     data_->header.this_id++;
 
+  bool previous_crash = false;
   if (data_->header.crash) {
     ReportError(ERR_PREVIOUS_CRASH);
+    previous_crash = true;
   } else {
     ReportError(ERR_NO_ERROR);
     data_->header.crash = 1;
@@ -493,6 +557,28 @@ int BackendImpl::SyncInit() {
   if (!disabled_ && !(user_flags_ & kNoRandom) && base::RandInt(0, 99) < 2)
     rankings_.SelfCheck();  // Ignore return value for now.
 
+  // Walking the index takes a while, so the summary is built after the
+  // initialization completes.
+  if (!disabled_) {
+    MessageLoop::current()->PostTask(
+        FROM_HERE, base::Bind(&BackendImpl::BuildIndexSummary, GetWeakPtr()));
+  }
+
+  // A crash leaves behind entries that were open at the time. They are
+  // validated as lookups find them, so the cache is usable right away, and the
+  // rest of the index is scrubbed in the background. The unit tests look for
+  // dirty entries themselves.
+  if (!disabled_ && previous_crash && !read_only_ &&
+      !(user_flags_ & kNoRandom) && !scrubbing_) {
+    scrubbing_ = true;
+    scrub_position_ = 0;
+    num_scrubbed_ = 0;
+    scrub_start_ = TimeTicks::Now();
+    MessageLoop::current()->PostDelayedTask(
+        FROM_HERE, base::Bind(&BackendImpl::ScrubIndex, GetWeakPtr()),
+        TimeDelta::FromSeconds(kScrubDelaySeconds));
+  }
+
 #if defined(STRESS_CACHE_EXTENDED_VALIDATION)
   trace_object_->EnableTracing(false);
   int sc = SelfCheck();
@@ -709,6 +795,7 @@ EntryImpl* BackendImpl::CreateEntryImpl(const std::string& key) {
   TimeTicks start = TimeTicks::Now();
   uint32 hash = Hash(key);
   Trace("Create hash 0x%x", hash);
+  index_summary_.Add(hash);
 
   scoped_refptr<EntryImpl> parent;
   Addr entry_address(data_->table[hash & mask_]);
@@ -917,6 +1004,7 @@ void BackendImpl::RecoveredEntry(CacheRankingsBlock* rankings) {
 
   uint32 hash = cache_entry->GetHash();
   cache_entry->Release();
+  index_summary_.Add(hash);
 
   // Anything on the table means that this entry is there.
   if (data_->table[hash & mask_])
@@ -942,6 +1030,7 @@ void BackendImpl::InternalDoomEntry(EntryImpl* entry) {
     if (!new_eviction_) {
       DecreaseNumEntries();
     }
+    index_summary_.OnRemoved();
     stats_.OnEvent(Stats::DOOM_ENTRY);
   }
 
@@ -1188,6 +1277,11 @@ void BackendImpl::OnWrite(int32 bytes) {
   OnRead(bytes);
 }
 
+void BackendImpl::OnEntryIO(base::TimeDelta queue_time,
+                            base::TimeDelta io_time) {
+  stats_.OnEntryIO(queue_time, io_time);
+}
+
 void BackendImpl::OnStatsTimer() {
   stats_.OnEvent(Stats::TIMER);
   int64 time = stats_.GetCounter(Stats::TIMER);
@@ -1226,6 +1320,12 @@ void BackendImpl::OnStatsTimer() {
   // Save stats to disk at 5 min intervals.
   if (time % 10 == 0)
     stats_.Store();
+
+  if (data_ && !disabled_ && index_summary_.is_published() &&
+      index_summary_.num_removed() >= kMinRemovedForSummaryRebuild &&
+      index_summary_.num_removed() >= data_->header.num_entries) {
+    BuildIndexSummary();
+  }
 }
 
 void BackendImpl::IncrementIoCount() {
@@ -1251,6 +1351,12 @@ void BackendImpl::SetNewEviction() {
   new_eviction_ = true;
 }
 
+void BackendImpl::SetSizeAwareEviction() {
+  user_flags_ |= kNewEviction | kSizeAwareEviction;
+  new_eviction_ = true;
+  size_aware_eviction_ = true;
+}
+
 void BackendImpl::SetFlags(uint32 flags) {
   user_flags_ |= flags;
 }
@@ -1324,6 +1430,13 @@ int32 BackendImpl::GetEntryCount() const {
 int BackendImpl::OpenEntry(const std::string& key, Entry** entry,
                            const CompletionCallback& callback) {
   DCHECK(!callback.is_null());
+  // An entry that is not in the summary can only show up by being created, so
+  // there is no need to ask the cache thread when no creation is in flight.
+  if (!background_queue_.HasPendingCreates() &&
+      !index_summary_.MayContain(Hash(key))) {
+    return net::ERR_FAILED;
+  }
+
   background_queue_.OpenEntry(key, entry, callback);
   return net::ERR_IO_PENDING;
 }
@@ -1530,6 +1643,8 @@ void BackendImpl::RestartCache(bool failure) {
 }
 
 void BackendImpl::PrepareForRestart() {
+  index_summary_.Reset(mask_ + 1);
+
   // Reset the mask_ if it was not given by the user.
   if (!(user_flags_ & kMask))
     mask_ = 0;
@@ -1537,6 +1652,9 @@ void BackendImpl::PrepareForRestart() {
   if (!(user_flags_ & kNewEviction))
     new_eviction_ = false;
 
+  if (!(user_flags_ & kSizeAwareEviction))
+    size_aware_eviction_ = false;
+
   disabled_ = true;
   data_->header.crash = 0;
   index_ = NULL;
@@ -2004,6 +2122,9 @@ void BackendImpl::ReportStats() {
 
   CACHE_UMA(HOURS, "UseTime", 0, static_cast<int>(use_hours));
   CACHE_UMA(PERCENTAGE, "HitRatio", 0, stats_.GetHitRatio());
+  if (data_->header.experiment != NO_EXPERIMENT)
+    CACHE_UMA(PERCENTAGE, "HitRatio", data_->header.experiment,
+              stats_.GetHitRatio());
 
   int64 trim_rate = stats_.GetCounter(Stats::TRIM_ENTRY) / use_hours;
   CACHE_UMA(COUNTS, "TrimRate", 0, static_cast<int>(trim_rate));
@@ -2167,6 +2288,109 @@ bool BackendImpl::CheckEntry(EntryImpl* cache_entry) {
   return ok && cache_entry->rankings()->VerifyHash();
 }
 
+void BackendImpl::BuildIndexSummary() {
+  if (disabled_ || !data_)
+    return;
+
+  // Any problem with the index leaves the summary unpublished, so that every
+  // lookup goes to the cache thread.
+  TimeTicks start = TimeTicks::Now();
+  index_summary_.Reset(mask_ + 1);
+  int max_entries =
+      data_->header.num_entries + static_cast<int>(open_entries_.size()) + 1;
+  int num_entries = 0;
+  for (unsigned int i = 0; i <= mask_; i++) {
+    Addr address(data_->table[i]);
+    while (address.is_initialized()) {
+      if (++num_entries > max_entries)
+        return;
+
+      EntriesMap::iterator it = open_entries_.find(address.value());
+      if (it != open_entries_.end()) {
+        index_summary_.Add(it->second->GetHash());
+        address.set_value(it->second->GetNextAddress());
+        continue;
+      }
+
+      if (!address.SanityCheckForEntry() || !block_files_.IsValid(address))
+        return;
+
+      CacheEntryBlock entry(File(address), address);
+      if (!entry.Load())
+        return;
+      index_summary_.Add(entry.Data()->hash);
+      address.set_value(entry.Data()->next);
+    }
+  }
+  index_summary_.Publish();
+  CACHE_UMA(AGE_MS, "BuildIndexSummaryTime", 0, start);
+}
+
+void BackendImpl::ScrubIndex() {
+  // A restart replaces the index, and the new one is clean.
+  if (disabled_ || !data_ || restarted_) {
+    scrubbing_ = false;
+    return;
+  }
+
+  uint32 end = std::min(mask_ + 1, scrub_position_ + kScrubBucketsPerTask);
+  for (; scrub_position_ < end && !disabled_; scrub_position_++)
+    num_scrubbed_ += ScrubBucket(scrub_position_);
+
+  if (scrub_position_ <= mask_ && !disabled_) {
+    MessageLoop::current()->PostTask(
+        FROM_HERE, base::Bind(&BackendImpl::ScrubIndex, GetWeakPtr()));
+    return;
+  }
+
+  scrubbing_ = false;
+  CACHE_UMA(AGE_MS, "ScrubTime", 0, scrub_start_);
+  CACHE_UMA(COUNTS_10000, "ScrubbedEntries", 0, num_scrubbed_);
+}
+
+int BackendImpl::ScrubBucket(uint32 bucket) {
+  int num_removed = 0;
+  Addr address(data_->table[bucket]);
+  scoped_refptr<EntryImpl> parent_entry;
+  std::set<CacheAddr> visited;
+  while (address.is_initialized() && !disabled_) {
+    // A loop is broken by MatchEntry() when a lookup runs into it.
+    if (!visited.insert(address.value()).second)
+      break;
+
+    EntryImpl* tmp = NULL;
+    int error = NewEntry(address, &tmp);
+    scoped_refptr<EntryImpl> cache_entry;
+    cache_entry.swap(&tmp);
+
+    if (!error && !cache_entry->dirty()) {
+      parent_entry = cache_entry;
+      address.set_value(parent_entry->GetNextAddress());
+      continue;
+    }
+
+    // Same as MatchEntry(): unlink the entry, then destroy it.
+    Addr child(0);
+    if (!error)
+      child.set_value(cache_entry->GetNextAddress());
+
+    if (parent_entry) {
+      if (!parent_entry->Update())
+        break;
+      parent_entry->SetNextAddress(child);
+    } else {
+      data_->table[bucket] = child.value();
+    }
+
+    Trace("ScrubBucket dirty 0x%x", address.value());
+    if (!error)
+      DestroyInvalidEntry(cache_entry);
+    num_removed++;
+    address = child;
+  }
+  return num_removed;
+}
+
 int BackendImpl::MaxBuffersSize() {
   static int64 total_memory = base::SysInfo::AmountOfPhysicalMemory();
   static bool done = false;
@@ -15,6 +15,7 @@
 #include "net/disk_cache/disk_cache.h"
 #include "net/disk_cache/eviction.h"
 #include "net/disk_cache/in_flight_backend_io.h"
+#include "net/disk_cache/index_summary.h"
 #include "net/disk_cache/rankings.h"
 #include "net/disk_cache/stats.h"
 #include "net/disk_cache/stress_support.h"
@@ -35,7 +36,8 @@ enum BackendFlags {
   kNewEviction = 1 << 4,        // Use of new eviction was specified.
   kNoRandom = 1 << 5,           // Don't add randomness to the behavior.
   kNoLoadProtection = 1 << 6,   // Don't act conservatively under load.
-  kNoBuffering = 1 << 7         // Disable extended IO buffering.
+  kNoBuffering = 1 << 7,        // Disable extended IO buffering.
+  kSizeAwareEviction = 1 << 8   // Use of size-aware eviction was specified.
 };
 
 // This class implements the Backend interface. An object of this
@@ -211,6 +213,10 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   void OnRead(int bytes);
   void OnWrite(int bytes);
 
+  // Keeps track of the time spent by an entry operation waiting for the cache
+  // thread, and performing the operation.
+  void OnEntryIO(base::TimeDelta queue_time, base::TimeDelta io_time);
+
   // Timer callback to calculate usage statistics.
   void OnStatsTimer();
 
@@ -227,6 +233,10 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   // Sets the eviction algorithm to version 2.
   void SetNewEviction();
 
+  // Sets the eviction algorithm to version 2, selecting the entries to evict
+  // by their size and reuse count.
+  void SetSizeAwareEviction();
+
   // Sets an explicit set of BackendFlags.
   void SetFlags(uint32 flags);
 
@@ -345,6 +355,18 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   // Part of the self test. Returns false if the entry is corrupt.
   bool CheckEntry(EntryImpl* cache_entry);
 
+  // Walks the index to add every stored key to |index_summary_|.
+  void BuildIndexSummary();
+
+  // After a crash, walks the next few buckets of the index removing the
+  // entries that were left dirty, so that they are not found one by one by
+  // later lookups. Reposts itself until the whole table is done.
+  void ScrubIndex();
+
+  // Removes the dirty or unreadable entries linked from |bucket| of the index.
+  // Returns the number of entries removed.
+  int ScrubBucket(uint32 bucket);
+
   // Returns the maximum total memory for the memory buffers.
   int MaxBuffersSize();
 
@@ -357,6 +379,7 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   uint32 mask_;  // Binary mask to map a hash to the hash table.
   int32 max_size_;  // Maximum data size for this instance.
   Eviction eviction_;  // Handler of the eviction algorithm.
+  IndexSummary index_summary_;  // Filters out misses on the caller's thread.
   EntriesMap open_entries_;  // Map of open entries.
   int num_refs_;  // Number of referenced cache entries.
   int max_refs_;  // Max number of referenced cache entries.
@@ -374,7 +397,12 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   bool read_only_;  // Prevents updates of the rankings data (used by tools).
   bool disabled_;
   bool new_eviction_;  // What eviction algorithm should be used.
+  bool size_aware_eviction_;  // Whether new_eviction_ considers entry sizes.
   bool first_timer_;  // True if the timer has not been called.
+  bool scrubbing_;  // True while ScrubIndex() is walking the index.
+  uint32 scrub_position_;  // The next bucket for ScrubIndex().
+  int num_scrubbed_;  // Entries removed by ScrubIndex() so far.
+  base::TimeTicks scrub_start_;
   bool user_load_;  // True if we see a high load coming from the caller.
 
   net::NetLog* net_log_;
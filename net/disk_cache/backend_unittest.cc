@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <set>
+
 #include "base/basictypes.h"
 #include "base/file_util.h"
 #include "base/string_util.h"
@@ -200,6 +202,99 @@ TEST_F(DiskCacheBackendTest, AppCacheKeying) {
   BackendKeying();
 }
 
+TEST_F(DiskCacheBackendTest, SimpleCacheBasics) {
+  SetSimpleCacheMode();
+  BackendBasics();
+}
+
+TEST_F(DiskCacheBackendTest, SimpleCacheKeying) {
+  SetSimpleCacheMode();
+  BackendKeying();
+}
+
+// Tests that the simple cache finds its entries on disk.
+TEST_F(DiskCacheBackendTest, SimpleCachePersistence) {
+  SetSimpleCacheMode();
+  InitCache();
+
+  const int kSize = 20000;
+  scoped_refptr<net::IOBuffer> buffer1(new net::IOBuffer(kSize));
+  scoped_refptr<net::IOBuffer> buffer2(new net::IOBuffer(kSize));
+  CacheTestFillBuffer(buffer1->data(), kSize, false);
+
+  disk_cache::Entry* entry;
+  ASSERT_EQ(net::OK, CreateEntry("the first key", &entry));
+  EXPECT_EQ(100, WriteData(entry, 0, 0, buffer1, 100, false));
+  EXPECT_EQ(kSize, WriteData(entry, 1, 0, buffer1, kSize, false));
+  entry->Close();
+
+  // Opening the entry again waits until it is stored, and reads the file.
+  ASSERT_EQ(net::OK, OpenEntry("the first key", &entry));
+  EXPECT_EQ(100, entry->GetDataSize(0));
+  EXPECT_EQ(kSize, entry->GetDataSize(1));
+  EXPECT_EQ(0, entry->GetDataSize(2));
+  EXPECT_EQ(100, ReadData(entry, 0, 0, buffer2, kSize));
+  EXPECT_EQ(0, memcmp(buffer1->data(), buffer2->data(), 100));
+  EXPECT_EQ(kSize, ReadData(entry, 1, 0, buffer2, kSize));
+  EXPECT_EQ(0, memcmp(buffer1->data(), buffer2->data(), kSize));
+
+  // The entry can outlive the backend.
+  delete cache_;
+  cache_ = NULL;
+  entry->Close();
+
+  DisableFirstCleanup();
+  InitCache();
+  ASSERT_EQ(net::OK, OpenEntry("the first key", &entry));
+  EXPECT_EQ(kSize, entry->GetDataSize(1));
+  memset(buffer2->data(), 0, kSize);
+  EXPECT_EQ(kSize, ReadData(entry, 1, 0, buffer2, kSize));
+  EXPECT_EQ(0, memcmp(buffer1->data(), buffer2->data(), kSize));
+  entry->Close();
+
+  disk_cache::Entry* entry2;
+  EXPECT_NE(net::OK, OpenEntry("some other key", &entry2));
+}
+
+// Tests that the simple cache enumerates every entry once, whether or not it
+// is open, and that an enumeration can be ended early.
+TEST_F(DiskCacheBackendTest, SimpleCacheEnumerations) {
+  SetSimpleCacheMode();
+  InitCache();
+
+  const int kNumEntries = 20;
+  std::set<std::string> keys;
+  disk_cache::Entry* open_entry = NULL;
+  for (int i = 0; i < kNumEntries; i++) {
+    std::string key = base::StringPrintf("key %d", i);
+    disk_cache::Entry* entry;
+    ASSERT_EQ(net::OK, CreateEntry(key, &entry));
+    if (i == 0)
+      open_entry = entry;
+    else
+      entry->Close();
+    keys.insert(key);
+  }
+
+  disk_cache::Entry* entry;
+  void* iter = NULL;
+  std::set<std::string> enumerated;
+  while (OpenNextEntry(&iter, &entry) == net::OK) {
+    ASSERT_TRUE(NULL != entry);
+    EXPECT_TRUE(enumerated.insert(entry->GetKey()).second);
+    entry->Close();
+  }
+  EXPECT_TRUE(keys == enumerated);
+  EXPECT_TRUE(NULL == iter);
+
+  ASSERT_EQ(net::OK, OpenNextEntry(&iter, &entry));
+  entry->Close();
+  cache_->EndEnumeration(&iter);
+  EXPECT_TRUE(NULL == iter);
+
+  open_entry->Close();
+}
+
 TEST_F(DiskCacheTest, CreateBackend) {
   net::TestCompletionCallback cb;
 
@@ -224,7 +319,9 @@ TEST_F(DiskCacheTest, CreateBackend) {
     cache = NULL;
 
     // Now test the public API.
-    rv = disk_cache::CreateCacheBackend(net::DISK_CACHE, cache_path_, 0, false,
+    rv = disk_cache::CreateCacheBackend(net::DISK_CACHE,
+                                        net::CACHE_BACKEND_DEFAULT,
+                                        cache_path_, 0, false,
                                         cache_thread.message_loop_proxy(),
                                         NULL, &cache, cb.callback());
     ASSERT_EQ(net::OK, cb.GetResult(rv));
@@ -232,7 +329,9 @@ TEST_F(DiskCacheTest, CreateBackend) {
     delete cache;
     cache = NULL;
 
-    rv = disk_cache::CreateCacheBackend(net::MEMORY_CACHE, FilePath(), 0, false,
+    rv = disk_cache::CreateCacheBackend(net::MEMORY_CACHE,
+                                        net::CACHE_BACKEND_DEFAULT,
+                                        FilePath(), 0, false,
                                         NULL, NULL, &cache, cb.callback());
     ASSERT_EQ(net::OK, cb.GetResult(rv));
     ASSERT_TRUE(cache);
@@ -651,6 +750,42 @@ TEST_F(DiskCacheBackendTest, NewEvictionTrim) {
   entry->Close();
 }
 
+TEST_F(DiskCacheBackendTest, SizeAwareEvictionTrim) {
+  SetSizeAwareEviction();
+  SetDirectMode();
+  InitCache();
+
+  disk_cache::Entry* entry;
+  for (int i = 0; i < 10; i++) {
+    std::string name(StringPrintf("Key %d", i));
+    ASSERT_EQ(net::OK, CreateEntry(name, &entry));
+    entry->Close();
+    ASSERT_EQ(net::OK, OpenEntry(name, &entry));
+    entry->Close();
+  }
+
+  // A large entry that is used once goes first, even if it is the newest one.
+  const int kLargeSize = 200000;
+  scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(kLargeSize));
+  CacheTestFillBuffer(buffer->data(), kLargeSize, false);
+  ASSERT_EQ(net::OK, CreateEntry("Large", &entry));
+  EXPECT_EQ(kLargeSize, WriteData(entry, 1, 0, buffer, kLargeSize, false));
+  entry->Close();
+
+  TrimForTest(false);
+  EXPECT_NE(net::OK, OpenEntry("Large", &entry));
+
+  // Between entries of the same size, the one that was used less goes first.
+  ASSERT_EQ(net::OK, CreateEntry("Small", &entry));
+  entry->Close();
+  TrimForTest(false);
+  EXPECT_NE(net::OK, OpenEntry("Small", &entry));
+
+  ASSERT_EQ(net::OK, OpenEntry("Key 0", &entry));
+  entry->Close();
+  EXPECT_EQ(10, cache_->GetEntryCount());
+}
+
 // Before looking for invalid entries, let's check a valid entry.
 void DiskCacheBackendTest::BackendValidEntry() {
   SetDirectMode();
@@ -2576,3 +2711,42 @@ TEST_F(DiskCacheBackendTest, UpdateRankForExternalCacheHit) {
   ASSERT_EQ(net::OK, OpenEntry("key0", &entry));
   entry->Close();
 }
+
+TEST_F(DiskCacheBackendTest, IndexSummary) {
+  SetDirectMode();
+  InitCache();
+
+  disk_cache::Entry* entry;
+  ASSERT_EQ(net::OK, CreateEntry("the first key", &entry));
+  entry->Close();
+  FlushQueueForTest();
+
+  // A key that was never stored misses without going to the cache thread.
+  net::TestCompletionCallback cb;
+  EXPECT_EQ(net::ERR_FAILED,
+            cache_->OpenEntry("some other key", &entry, cb.callback()));
+  ASSERT_EQ(net::OK, OpenEntry("the first key", &entry));
+  entry->Close();
+
+  // But not while the key may be being created.
+  net::TestCompletionCallback create_cb;
+  disk_cache::Entry* created_entry;
+  int rv = cache_->CreateEntry("some other key", &created_entry,
+                               create_cb.callback());
+  EXPECT_EQ(net::ERR_IO_PENDING,
+            cache_->OpenEntry("some other key", &entry, cb.callback()));
+  ASSERT_EQ(net::OK, create_cb.GetResult(rv));
+  ASSERT_EQ(net::OK, cb.WaitForResult());
+  created_entry->Close();
+  entry->Close();
+
+  // The summary is built again from the index.
+  SimulateCrash();
+  FlushQueueForTest();
+  EXPECT_EQ(net::ERR_FAILED,
+            cache_->OpenEntry("yet another key", &entry, cb.callback()));
+  ASSERT_EQ(net::OK, OpenEntry("the first key", &entry));
+  entry->Close();
+  ASSERT_EQ(net::OK, OpenEntry("some other key", &entry));
+  entry->Close();
+}
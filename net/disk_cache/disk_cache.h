@@ -34,7 +34,8 @@ namespace disk_cache {
 class Entry;
 class Backend;
 
-// Returns an instance of a Backend of the given |type|. |path| points to a
+// Returns an instance of a Backend of the given |type|, implemented by
+// |backend_type| when the cache is stored on disk. |path| points to a
 // folder where the cached data will be stored (if appropriate). This cache
 // instance must be the only object that will be reading or writing files to
 // that folder. The returned object should be deleted when not needed anymore.
@@ -49,7 +50,9 @@ class Backend;
 // be invoked when a backend is available or a fatal error condition is reached.
 // The pointer to receive the |backend| must remain valid until the operation
 // completes (the callback is notified).
-NET_EXPORT int CreateCacheBackend(net::CacheType type, const FilePath& path,
+NET_EXPORT int CreateCacheBackend(net::CacheType type,
+                                  net::BackendType backend_type,
+                                  const FilePath& path,
                                   int max_bytes, bool force,
                                   base::MessageLoopProxy* thread,
                                   net::NetLog* net_log, Backend** backend,
@@ -7,9 +7,11 @@
 #include "base/basictypes.h"
 #include "base/bind.h"
 #include "base/bind_helpers.h"
+#include "base/file_util.h"
 #include "base/perftimer.h"
 #include "base/string_util.h"
 #include "base/threading/thread.h"
+#include "base/test/perf_benchmark.h"
 #include "base/test/test_file_util.h"
 #include "base/timer.h"
 #include "net/base/io_buffer.h"
@@ -143,30 +145,19 @@ int BlockSize() {
   return (rand() & 0x3) + 1;
 }
 
-}  // namespace
-
-TEST_F(DiskCacheTest, Hash) {
-  int seed = static_cast<int>(Time::Now().ToInternalValue());
-  srand(seed);
-
-  PerfTimeLogger timer("Hash disk cache keys");
-  for (int i = 0; i < 300000; i++) {
-    std::string key = GenerateKey(true);
-    disk_cache::Hash(key);
-  }
-  timer.Done();
-}
-
-TEST_F(DiskCacheTest, CacheBackendPerformance) {
+// Measures writing and reading entries with the given |backend_type|, stored
+// in |cache_path|.
+void CacheBackendPerformance(const FilePath& cache_path,
+                             net::BackendType backend_type) {
   base::Thread cache_thread("CacheThread");
   ASSERT_TRUE(cache_thread.StartWithOptions(
                   base::Thread::Options(MessageLoop::TYPE_IO, 0)));
 
-  ASSERT_TRUE(CleanupCacheDir());
+  ASSERT_TRUE(DeleteCache(cache_path));
   net::TestCompletionCallback cb;
   disk_cache::Backend* cache;
   int rv = disk_cache::CreateCacheBackend(
-      net::DISK_CACHE, cache_path_, 0, false,
+      net::DISK_CACHE, backend_type, cache_path, 0, false,
       cache_thread.message_loop_proxy(), NULL, &cache, cb.callback());
 
   ASSERT_EQ(net::OK, cb.GetResult(rv));
@@ -182,20 +173,17 @@ TEST_F(DiskCacheTest, CacheBackendPerformance) {
   MessageLoop::current()->RunAllPending();
   delete cache;
 
-  ASSERT_TRUE(file_util::EvictFileFromSystemCache(
-              cache_path_.AppendASCII("index")));
-  ASSERT_TRUE(file_util::EvictFileFromSystemCache(
-              cache_path_.AppendASCII("data_0")));
-  ASSERT_TRUE(file_util::EvictFileFromSystemCache(
-              cache_path_.AppendASCII("data_1")));
-  ASSERT_TRUE(file_util::EvictFileFromSystemCache(
-              cache_path_.AppendASCII("data_2")));
-  ASSERT_TRUE(file_util::EvictFileFromSystemCache(
-              cache_path_.AppendASCII("data_3")));
+  // The backends store their data in different files.
+  file_util::FileEnumerator enumerator(cache_path, true,
+                                       file_util::FileEnumerator::FILES);
+  for (FilePath file = enumerator.Next(); !file.empty();
+       file = enumerator.Next()) {
+    ASSERT_TRUE(file_util::EvictFileFromSystemCache(file));
+  }
 
   rv = disk_cache::CreateCacheBackend(
-      net::DISK_CACHE, cache_path_, 0, false, cache_thread.message_loop_proxy(),
-      NULL, &cache, cb.callback());
+      net::DISK_CACHE, backend_type, cache_path, 0, false,
+      cache_thread.message_loop_proxy(), NULL, &cache, cb.callback());
   ASSERT_EQ(net::OK, cb.GetResult(rv));
 
   EXPECT_TRUE(TimeRead(num_entries, cache, entries, true));
@@ -206,6 +194,55 @@ TEST_F(DiskCacheTest, CacheBackendPerformance) {
   delete cache;
 }
 
+// Seeks to a pseudo-random position of the sparse |entry|: finds the cached
+// range, then reads the first 32 KB after the seek in small pieces, as the
+// media code does.
+void SeekAndRead(disk_cache::Entry* entry,
+                 const scoped_refptr<net::IOBuffer>& buf,
+                 int file_size,
+                 int read_size,
+                 int reads_per_seek,
+                 uint32* seed) {
+  *seed = *seed * 1103515245 + 12345;
+  int64 position = (*seed >> 8) % (file_size - read_size * reads_per_seek);
+  net::TestCompletionCallback cb;
+  int64 start;
+  int rv = entry->GetAvailableRange(position, file_size, &start,
+                                    cb.callback());
+  CHECK_EQ(file_size - position, cb.GetResult(rv));
+  for (int i = 0; i < reads_per_seek; ++i) {
+    rv = entry->ReadSparseData(position + i * read_size, buf, read_size,
+                               cb.callback());
+    CHECK_EQ(read_size, cb.GetResult(rv));
+  }
+}
+
+}  // namespace
+
+TEST_F(DiskCacheTest, Hash) {
+  int seed = static_cast<int>(Time::Now().ToInternalValue());
+  srand(seed);
+
+  PerfTimeLogger timer("Hash disk cache keys");
+  for (int i = 0; i < 300000; i++) {
+    std::string key = GenerateKey(true);
+    disk_cache::Hash(key);
+  }
+  timer.Done();
+}
+
+TEST_F(DiskCacheTest, CacheBackendPerformance) {
+  CacheBackendPerformance(cache_path_, net::CACHE_BACKEND_DEFAULT);
+}
+
+TEST_F(DiskCacheTest, SimpleCacheBackendPerformance) {
+  CacheBackendPerformance(cache_path_, net::CACHE_BACKEND_SIMPLE);
+}
+
+TEST_F(DiskCacheTest, TieredCacheBackendPerformance) {
+  CacheBackendPerformance(cache_path_, net::CACHE_BACKEND_TIERED);
+}
+
 // Creating and deleting "entries" on a block-file is something quite frequent
 // (after all, almost everything is stored on block files). The operation is
 // almost free when the file is empty, but can be expensive if the file gets
@@ -248,3 +285,28 @@ TEST_F(DiskCacheTest, BlockFilesPerformance) {
   MessageLoop::current()->RunAllPending();
   delete[] address;
 }
+
+class DiskCacheSparsePerfTest : public DiskCacheTestWithCache {
+};
+
+// Measures the time it takes to seek in a large media file stored by a warm
+// cache.
+TEST_F(DiskCacheSparsePerfTest, Seek) {
+  InitCache();
+  disk_cache::Entry* entry;
+  ASSERT_EQ(net::OK, CreateEntry("the first key", &entry));
+
+  const int kFileSize = 8 * 1024 * 1024;
+  const int kWriteSize = 64 * 1024;
+  scoped_refptr<net::IOBuffer> buf(new net::IOBuffer(kWriteSize));
+  CacheTestFillBuffer(buf->data(), kWriteSize, false);
+  for (int offset = 0; offset < kFileSize; offset += kWriteSize)
+    ASSERT_EQ(kWriteSize, WriteSparseData(entry, offset, buf, kWriteSize));
+
+  uint32 seed = 42;
+  base::PerfBenchmark benchmark("DiskCache_SparseSeek_first_32KB");
+  benchmark.set_iterations_per_run(10);
+  benchmark.Run(base::Bind(&SeekAndRead, entry, buf, kFileSize, 4096, 8,
+                           &seed));
+  entry->Close();
+}
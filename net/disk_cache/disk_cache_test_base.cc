@@ -12,6 +12,7 @@
 #include "net/disk_cache/backend_impl.h"
 #include "net/disk_cache/disk_cache_test_util.h"
 #include "net/disk_cache/mem_backend_impl.h"
+#include "net/disk_cache/simple/simple_backend_impl.h"
 
 DiskCacheTest::DiskCacheTest() {
   cache_path_ = GetCacheFilePath();
@@ -54,9 +55,11 @@ DiskCacheTestWithCache::DiskCacheTestWithCache()
       implementation_(false),
       force_creation_(false),
       new_eviction_(false),
+      size_aware_eviction_(false),
       first_cleanup_(true),
       integrity_(true),
       use_current_thread_(false),
+      simple_cache_mode_(false),
       cache_thread_("CacheThread") {
 }
 
@@ -219,7 +222,7 @@ void DiskCacheTestWithCache::TearDown() {
   if (cache_thread_.IsRunning())
     cache_thread_.Stop();
 
-  if (!memory_only_ && integrity_) {
+  if (!memory_only_ && !simple_cache_mode_ && integrity_) {
     EXPECT_TRUE(CheckCacheIntegrity(cache_path_, new_eviction_, mask_));
   }
 
@@ -252,6 +255,15 @@ void DiskCacheTestWithCache::InitDiskCache() {
   }
   ASSERT_TRUE(cache_thread_.message_loop() != NULL);
 
+  if (simple_cache_mode_) {
+    net::TestCompletionCallback cb;
+    int rv = disk_cache::SimpleBackendImpl::CreateBackend(
+                 cache_path_, size_, cache_thread_.message_loop_proxy(),
+                 &cache_, cb.callback());
+    ASSERT_EQ(net::OK, cb.GetResult(rv));
+    return;
+  }
+
   if (implementation_)
     return InitDiskCacheImpl();
 
@@ -281,7 +293,9 @@ void DiskCacheTestWithCache::InitDiskCacheImpl() {
   if (size_)
     EXPECT_TRUE(cache_impl_->SetMaxSize(size_));
 
-  if (new_eviction_)
+  if (size_aware_eviction_)
+    cache_impl_->SetSizeAwareEviction();
+  else if (new_eviction_)
     cache_impl_->SetNewEviction();
 
   cache_impl_->SetType(type_);
@@ -86,6 +86,11 @@ class DiskCacheTestWithCache : public DiskCacheTest {
     new_eviction_ = true;
   }
 
+  void SetSizeAwareEviction() {
+    new_eviction_ = true;
+    size_aware_eviction_ = true;
+  }
+
   void DisableFirstCleanup() {
     first_cleanup_ = false;
   }
@@ -102,6 +107,11 @@ class DiskCacheTestWithCache : public DiskCacheTest {
     type_ = type;
   }
 
+  // Uses the simple cache backend instead of the block files.
+  void SetSimpleCacheMode() {
+    simple_cache_mode_ = true;
+  }
+
   // Utility methods to access the cache and wait for each operation to finish.
   int OpenEntry(const std::string& key, disk_cache::Entry** entry);
   int CreateEntry(const std::string& key, disk_cache::Entry** entry);
@@ -146,9 +156,11 @@ class DiskCacheTestWithCache : public DiskCacheTest {
   bool implementation_;
   bool force_creation_;
   bool new_eviction_;
+  bool size_aware_eviction_;
   bool first_cleanup_;
   bool integrity_;
   bool use_current_thread_;
+  bool simple_cache_mode_;
   // This is intentionally left uninitialized, to be used by any test.
   bool success_;
 
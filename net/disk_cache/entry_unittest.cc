@@ -50,6 +50,8 @@ class DiskCacheEntryTest : public DiskCacheTestWithCache {
   void BasicSparseIO();
   void HugeSparseIO();
   void GetAvailableRange();
+  void GetAvailableRangeAcrossChildren();
+  void SequentialSparseReads();
   void CouldBeSparse();
   void UpdateSparseEntry();
   void DoomSparseEntry();
@@ -1528,6 +1530,105 @@ TEST_F(DiskCacheEntryTest, MemoryOnlyGetAvailableRange) {
   GetAvailableRange();
 }
 
+// Tests that a range stored by more than one child is reported as a whole.
+void DiskCacheEntryTest::GetAvailableRangeAcrossChildren() {
+  std::string key("the first key");
+  disk_cache::Entry* entry;
+  ASSERT_EQ(net::OK, CreateEntry(key, &entry));
+
+  const int kSize = 16 * 1024;
+  scoped_refptr<net::IOBuffer> buf(new net::IOBuffer(kSize));
+  CacheTestFillBuffer(buf->data(), kSize, false);
+
+  // Write around offset 0x100000 (1 MB), where the second child starts, and
+  // again at the end of the second child.
+  EXPECT_EQ(kSize, WriteSparseData(entry, 0x100000 - kSize, buf, kSize));
+  EXPECT_EQ(kSize, WriteSparseData(entry, 0x100000, buf, kSize));
+  EXPECT_EQ(kSize, WriteSparseData(entry, 0x200000 - kSize, buf, kSize));
+
+  int64 start;
+  net::TestCompletionCallback cb;
+  int rv = entry->GetAvailableRange(0, 0x300000, &start, cb.callback());
+  EXPECT_EQ(2 * kSize, cb.GetResult(rv));
+  EXPECT_EQ(0x100000 - kSize, start);
+
+  // Respect |len| when merging.
+  rv = entry->GetAvailableRange(0x100000 - kSize, kSize + 100, &start,
+                                cb.callback());
+  EXPECT_EQ(kSize + 100, cb.GetResult(rv));
+  EXPECT_EQ(0x100000 - kSize, start);
+
+  // The range at the end of the second child doesn't continue.
+  rv = entry->GetAvailableRange(0x200000 - kSize, 0x100000, &start,
+                                cb.callback());
+  EXPECT_EQ(kSize, cb.GetResult(rv));
+  EXPECT_EQ(0x200000 - kSize, start);
+
+  entry->Close();
+}
+
+TEST_F(DiskCacheEntryTest, GetAvailableRangeAcrossChildren) {
+  InitCache();
+  GetAvailableRangeAcrossChildren();
+}
+
+TEST_F(DiskCacheEntryTest, MemoryOnlyGetAvailableRangeAcrossChildren) {
+  SetMemoryOnlyMode();
+  InitCache();
+  GetAvailableRangeAcrossChildren();
+}
+
+// Tests small sequential reads that go across children, with writes in
+// between.
+void DiskCacheEntryTest::SequentialSparseReads() {
+  std::string key("the first key");
+  disk_cache::Entry* entry;
+  ASSERT_EQ(net::OK, CreateEntry(key, &entry));
+
+  const int kSize = 256 * 1024;
+  const int64 kOffset = 0x100000 - kSize / 2;
+  scoped_refptr<net::IOBuffer> buf_1(new net::IOBuffer(kSize));
+  CacheTestFillBuffer(buf_1->data(), kSize, false);
+  EXPECT_EQ(kSize, WriteSparseData(entry, kOffset, buf_1, kSize));
+
+  const int kReadSize = 4096;
+  const int kOverwritePosition = 20 * kReadSize;
+  scoped_refptr<net::IOBuffer> buf_2(new net::IOBuffer(kReadSize));
+  for (int pos = 0; pos < kSize; pos += kReadSize) {
+    if (pos == kOverwritePosition) {
+      // Change data that may have been read already.
+      scoped_refptr<net::IOBuffer> buf_3(new net::IOBuffer(kReadSize));
+      CacheTestFillBuffer(buf_3->data(), kReadSize, false);
+      EXPECT_EQ(kReadSize,
+                WriteSparseData(entry, kOffset + pos, buf_3, kReadSize));
+      memcpy(buf_1->data() + pos, buf_3->data(), kReadSize);
+    }
+    ASSERT_EQ(kReadSize,
+              ReadSparseData(entry, kOffset + pos, buf_2, kReadSize));
+    EXPECT_EQ(0, memcmp(buf_1->data() + pos, buf_2->data(), kReadSize))
+        << "pos=" << pos;
+  }
+
+  // Nothing is stored after the data.
+  EXPECT_EQ(0, ReadSparseData(entry, kOffset + kSize, buf_2, kReadSize));
+
+  // Reading backwards still works.
+  ASSERT_EQ(kReadSize, ReadSparseData(entry, kOffset, buf_2, kReadSize));
+  EXPECT_EQ(0, memcmp(buf_1->data(), buf_2->data(), kReadSize));
+  entry->Close();
+}
+
+TEST_F(DiskCacheEntryTest, SequentialSparseReads) {
+  InitCache();
+  SequentialSparseReads();
+}
+
+TEST_F(DiskCacheEntryTest, MemoryOnlySequentialSparseReads) {
+  SetMemoryOnlyMode();
+  InitCache();
+  SequentialSparseReads();
+}
+
 void DiskCacheEntryTest::CouldBeSparse() {
   std::string key("the first key");
   disk_cache::Entry* entry;
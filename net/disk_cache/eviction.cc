@@ -26,6 +26,15 @@
 // size so that we have a chance to see an element again and move it to another
 // list.
 
+// The size-aware variant of the new policy keeps the same lists, but instead of
+// evicting entries strictly from the end of one of them, it looks at the last
+// few entries of every list and evicts the one with the lowest reuse count per
+// byte, (reuse_count + 1) / (size + kSizeOverhead). This is similar to Greedy
+// Dual Size Frequency, with the position on the lists standing for the age of
+// the entry: a large resource that is used once goes away before the small
+// resources that are reused, and the lists still make sure that nothing stays
+// on the cache just by being small.
+
 #include "net/disk_cache/eviction.h"
 
 #include "base/bind.h"
@@ -49,6 +58,9 @@ const int kCleanUpMargin = 1024 * 1024;
 const int kHighUse = 10;  // Reuse count to be on the HIGH_USE list.
 const int kTargetTime = 24 * 7;  // Time to be evicted (hours since last use).
 const int kMaxDelayedTrims = 60;
+const int kCandidatesPerList = 4;  // Entries to compare from each list.
+const int kMaxNodesToScan = 16;  // Nodes to look at for kCandidatesPerList.
+const int kSizeOverhead = 4096;  // Storage used by the entry, besides the data.
 
 int LowWaterAdjust(int high_water) {
   if (high_water < kCleanUpMargin)
@@ -81,6 +93,7 @@ void Eviction::Init(BackendImpl* backend) {
   max_size_ = LowWaterAdjust(backend_->max_size_);
   index_size_ = backend->mask_ + 1;
   new_eviction_ = backend->new_eviction_;
+  size_aware_ = backend->size_aware_eviction_;
   first_trim_ = true;
   trimming_ = false;
   delay_trim_ = false;
@@ -109,6 +122,9 @@ void Eviction::TrimCache(bool empty) {
   if (!empty && !ShouldTrim())
     return PostDelayedTrim();
 
+  if (new_eviction_ && size_aware_ && !empty)
+    return TrimCacheBySize();
+
   if (new_eviction_)
     return TrimCacheV2(empty);
 
@@ -284,15 +300,7 @@ bool Eviction::EvictEntry(CacheRankingsBlock* node, bool empty,
     if (!empty)
       backend_->OnEvent(Stats::TRIM_ENTRY);
   } else {
-    entry->DeleteEntryData(false);
-    EntryStore* info = entry->entry()->Data();
-    DCHECK_EQ(ENTRY_NORMAL, info->state);
-
-    rankings_->Remove(entry->rankings(), GetListForEntryV2(entry), true);
-    info->state = ENTRY_EVICTED;
-    entry->entry()->Store();
-    rankings_->Insert(entry->rankings(), true, Rankings::DELETED);
-    backend_->OnEvent(Stats::TRIM_ENTRY);
+    EvictToDeletedList(entry);
   }
   entry->Release();
 
@@ -523,6 +531,108 @@ bool Eviction::RemoveDeletedNode(CacheRankingsBlock* node) {
   return !doomed;
 }
 
+// -----------------------------------------------------------------------
+
+void Eviction::TrimCacheBySize() {
+  Trace("*** Trim Cache By Size ***");
+  trimming_ = true;
+  TimeTicks start = TimeTicks::Now();
+  int deleted_entries = 0;
+
+  while (header_->num_bytes > max_size_ || test_mode_) {
+    EntryImpl* entry = SelectEntryToEvict();
+    if (!entry)
+      break;
+
+    ReportTrimTimes(entry);
+    EvictToDeletedList(entry);
+    entry->Release();
+    deleted_entries++;
+
+    if (test_mode_)
+      break;
+    if (deleted_entries > 20 ||
+        (TimeTicks::Now() - start).InMilliseconds() > 20) {
+      MessageLoop::current()->PostTask(FROM_HERE, base::Bind(
+          &Eviction::TrimCache, ptr_factory_.GetWeakPtr(), false));
+      break;
+    }
+  }
+
+  if (ShouldTrimDeleted()) {
+    MessageLoop::current()->PostTask(FROM_HERE,
+        base::Bind(&Eviction::TrimDeleted, ptr_factory_.GetWeakPtr(), false));
+  }
+
+  CACHE_UMA(AGE_MS, "TotalTrimTimeBySize", 0, start);
+  CACHE_UMA(COUNTS, "TrimItemsBySize", 0, deleted_entries);
+
+  Trace("*** Trim Cache By Size end ***");
+  trimming_ = false;
+}
+
+// Returns the entry (with an extra reference) that should be evicted next, out
+// of the last kCandidatesPerList entries of each list that are not in use.
+EntryImpl* Eviction::SelectEntryToEvict() {
+  const int kListsToSearch = 3;
+  EntryImpl* victim = NULL;
+  int64 victim_uses = 0;
+  int64 victim_size = 0;
+
+  for (int i = 0; i < kListsToSearch; i++) {
+    Rankings::List list = static_cast<Rankings::List>(i);
+    Rankings::ScopedRankingsBlock node(rankings_);
+    Rankings::ScopedRankingsBlock next(rankings_,
+                                       rankings_->GetPrev(NULL, list));
+    int candidates = 0;
+    for (int scanned = 0; next.get() && scanned < kMaxNodesToScan &&
+         candidates < kCandidatesPerList; scanned++) {
+      // The iterator could be invalidated within GetEnumeratedEntry().
+      if (!next->HasData())
+        break;
+      node.reset(next.release());
+      next.reset(rankings_->GetPrev(node.get(), list));
+      if (node->Data()->dirty == backend_->GetCurrentEntryId())
+        continue;
+
+      EntryImpl* entry = backend_->GetEnumeratedEntry(node.get(), list);
+      if (!entry)
+        continue;
+      candidates++;
+
+      EntryStore* info = entry->entry()->Data();
+      int64 uses = info->reuse_count + 1;
+      int64 size = kSizeOverhead + info->key_len;
+      for (size_t index = 0; index < arraysize(info->data_size); index++)
+        size += info->data_size[index];
+
+      // uses / size < victim_uses / victim_size, without a division.
+      if (!victim || uses * victim_size < victim_uses * size) {
+        if (victim)
+          victim->Release();
+        victim = entry;
+        victim_uses = uses;
+        victim_size = size;
+      } else {
+        entry->Release();
+      }
+    }
+  }
+  return victim;
+}
+
+void Eviction::EvictToDeletedList(EntryImpl* entry) {
+  entry->DeleteEntryData(false);
+  EntryStore* info = entry->entry()->Data();
+  DCHECK_EQ(ENTRY_NORMAL, info->state);
+
+  rankings_->Remove(entry->rankings(), GetListForEntryV2(entry), true);
+  info->state = ENTRY_EVICTED;
+  entry->entry()->Store();
+  rankings_->Insert(entry->rankings(), true, Rankings::DELETED);
+  backend_->OnEvent(Stats::TRIM_ENTRY);
+}
+
 bool Eviction::NodeIsOldEnough(CacheRankingsBlock* node, int list) {
   if (!node)
     return false;
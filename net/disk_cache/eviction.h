@@ -66,6 +66,12 @@ class Eviction {
   void TrimDeleted(bool empty);
   bool RemoveDeletedNode(CacheRankingsBlock* node);
 
+  // Size-aware version of TrimCacheV2(), used when the whole cache is not
+  // being emptied.
+  void TrimCacheBySize();
+  EntryImpl* SelectEntryToEvict();
+  void EvictToDeletedList(EntryImpl* entry);
+
   bool NodeIsOldEnough(CacheRankingsBlock* node, int list);
   int SelectListByLength(Rankings::ScopedRankingsBlock* next);
   void ReportListStats();
@@ -77,6 +83,7 @@ class Eviction {
   int trim_delays_;
   int index_size_;
   bool new_eviction_;
+  bool size_aware_;
   bool first_trim_;
   bool trimming_;
   bool delay_trim_;
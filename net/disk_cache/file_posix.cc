@@ -6,6 +6,10 @@
 
 #include <fcntl.h>
 
+#include <list>
+#include <map>
+#include <vector>
+
 #include "base/bind.h"
 #include "base/location.h"
 #include "base/logging.h"
@@ -26,10 +30,12 @@ class FileBackgroundIO : public disk_cache::BackgroundIO {
   // (we do NOT invoke the callback), in the worker thead that completed the
   // operation.
   FileBackgroundIO(disk_cache::File* file, const void* buf, size_t buf_len,
-                   size_t offset, disk_cache::FileIOCallback* callback,
+                   size_t offset, bool write,
+                   disk_cache::FileIOCallback* callback,
                    disk_cache::InFlightIO* controller)
       : disk_cache::BackgroundIO(controller), callback_(callback), file_(file),
-        buf_(buf), buf_len_(buf_len), offset_(offset) {
+        buf_(buf), buf_len_(buf_len), offset_(offset), write_(write),
+        started_(false) {
   }
 
   disk_cache::FileIOCallback* callback() {
@@ -40,6 +46,19 @@ class FileBackgroundIO : public disk_cache::BackgroundIO {
     return file_;
   }
 
+  bool write() const { return write_; }
+  bool started() const { return started_; }
+  void set_started() { started_ = true; }
+
+  // Returns true if this operation has to wait for |other|, an operation on
+  // the same file that was issued before.
+  bool ConflictsWith(const FileBackgroundIO* other) const {
+    if (!write_ && !other->write_)
+      return false;
+    return offset_ < other->offset_ + other->buf_len_ &&
+           other->offset_ < offset_ + buf_len_;
+  }
+
   // Read and Write are the operations that can be performed asynchronously.
   // The actual parameters for the operation are setup in the constructor of
   // the object. Both methods should be called from a worker thread, by posting
@@ -57,16 +76,23 @@ class FileBackgroundIO : public disk_cache::BackgroundIO {
   const void* buf_;
   size_t buf_len_;
   size_t offset_;
+  bool write_;
+  bool started_;
 
   DISALLOW_COPY_AND_ASSIGN(FileBackgroundIO);
 };
 
 
 // The specialized controller that keeps track of current operations.
+//
+// Operations on different files, or on different parts of the same file, run
+// in parallel on the worker pool. An operation that overlaps an earlier write
+// (or a write that overlaps an earlier read) waits until the earlier one
+// completes, so the data of a given entry is seen in the order it was issued.
 class FileInFlightIO : public disk_cache::InFlightIO {
  public:
   FileInFlightIO() {}
-  ~FileInFlightIO() {}
+  ~FileInFlightIO();
 
   // These methods start an asynchronous operation. The arguments have the same
   // semantics of the File asynchronous operations, with the exception that the
@@ -76,6 +102,10 @@ class FileInFlightIO : public disk_cache::InFlightIO {
   void PostWrite(disk_cache::File* file, const void* buf, size_t buf_len,
                  size_t offset, disk_cache::FileIOCallback* callback);
 
+  // Forgets about the operations that are waiting for another one. The
+  // callbacks of these operations are never invoked.
+  void DropWaitingIO();
+
  protected:
   // Invokes the users' completion callback at the end of the IO operation.
   // |cancel| is true if the actual task posted to the thread is still
@@ -85,6 +115,19 @@ class FileInFlightIO : public disk_cache::InFlightIO {
                                    bool cancel);
 
  private:
+  typedef std::list<scoped_refptr<FileBackgroundIO> > OperationList;
+  typedef std::map<disk_cache::File*, OperationList> FileOperations;
+
+  // Adds |operation| to the list of its file, and starts it if possible.
+  void AddOperation(FileBackgroundIO* operation);
+
+  // Starts the operations of |list| that no longer wait for another one.
+  void StartOperations(OperationList* list);
+
+  // The operations of each file that are running or waiting, in the order
+  // they were issued.
+  FileOperations operations_;
+
   DISALLOW_COPY_AND_ASSIGN(FileInFlightIO);
 };
 
@@ -108,29 +151,99 @@ void FileBackgroundIO::Write() {
   NotifyController();
 }
 
+// Runs on a worker thread. Performs |operations| in order.
+void RunOperations(
+    const std::vector<scoped_refptr<FileBackgroundIO> >& operations) {
+  for (size_t i = 0; i < operations.size(); ++i) {
+    if (operations[i]->write())
+      operations[i]->Write();
+    else
+      operations[i]->Read();
+  }
+}
+
 // ---------------------------------------------------------------------------
 
+FileInFlightIO::~FileInFlightIO() {
+  DropWaitingIO();
+}
+
 void FileInFlightIO::PostRead(disk_cache::File *file, void* buf, size_t buf_len,
                           size_t offset, disk_cache::FileIOCallback *callback) {
   scoped_refptr<FileBackgroundIO> operation(
-      new FileBackgroundIO(file, buf, buf_len, offset, callback, this));
+      new FileBackgroundIO(file, buf, buf_len, offset, false, callback, this));
   file->AddRef();  // Balanced on OnOperationComplete()
-
-  base::WorkerPool::PostTask(FROM_HERE,
-      base::Bind(&FileBackgroundIO::Read, operation.get()), true);
-  OnOperationPosted(operation);
+  AddOperation(operation);
 }
 
 void FileInFlightIO::PostWrite(disk_cache::File* file, const void* buf,
                            size_t buf_len, size_t offset,
                            disk_cache::FileIOCallback* callback) {
   scoped_refptr<FileBackgroundIO> operation(
-      new FileBackgroundIO(file, buf, buf_len, offset, callback, this));
+      new FileBackgroundIO(file, buf, buf_len, offset, true, callback, this));
   file->AddRef();  // Balanced on OnOperationComplete()
+  AddOperation(operation);
+}
 
-  base::WorkerPool::PostTask(FROM_HERE,
-      base::Bind(&FileBackgroundIO::Write, operation.get()), true);
-  OnOperationPosted(operation);
+void FileInFlightIO::DropWaitingIO() {
+  for (FileOperations::iterator it = operations_.begin();
+       it != operations_.end(); ++it) {
+    for (OperationList::iterator op = it->second.begin();
+         op != it->second.end(); ++op) {
+      if (!(*op)->started())
+        (*op)->file()->Release();
+    }
+  }
+  operations_.clear();
+}
+
+void FileInFlightIO::AddOperation(FileBackgroundIO* operation) {
+  OperationList* list = &operations_[operation->file()];
+  list->push_back(make_scoped_refptr(operation));
+  StartOperations(list);
+}
+
+void FileInFlightIO::StartOperations(OperationList* list) {
+  std::vector<scoped_refptr<FileBackgroundIO> > ready;
+  for (OperationList::iterator it = list->begin(); it != list->end(); ++it) {
+    FileBackgroundIO* operation = *it;
+    if (operation->started())
+      continue;
+
+    bool blocked = false;
+    for (OperationList::iterator prev = list->begin();
+         prev != it && !blocked; ++prev) {
+      blocked = operation->ConflictsWith(*prev);
+    }
+    if (blocked)
+      continue;
+
+    operation->set_started();
+    ready.push_back(operation);
+  }
+
+  if (ready.empty())
+    return;
+
+  // Operations released together by the completion of another one go to a
+  // single worker, one after the other, instead of waking up a thread each.
+  // They are on the same file, so the disk would mostly serialize them
+  // anyway.
+  if (ready.size() == 1) {
+    FileBackgroundIO* operation = ready[0];
+    if (operation->write()) {
+      base::WorkerPool::PostTask(FROM_HERE,
+          base::Bind(&FileBackgroundIO::Write, operation), true);
+    } else {
+      base::WorkerPool::PostTask(FROM_HERE,
+          base::Bind(&FileBackgroundIO::Read, operation), true);
+    }
+  } else {
+    base::WorkerPool::PostTask(FROM_HERE,
+        base::Bind(&RunOperations, ready), true);
+  }
+  for (size_t i = 0; i < ready.size(); ++i)
+    OnOperationPosted(ready[i]);
 }
 
 // Runs on the IO thread.
@@ -141,6 +254,22 @@ void FileInFlightIO::OnOperationComplete(disk_cache::BackgroundIO* operation,
   disk_cache::FileIOCallback* callback = op->callback();
   int bytes = operation->result();
 
+  // Let the operations that were waiting for this one go.
+  FileOperations::iterator it = operations_.find(op->file());
+  if (it != operations_.end()) {
+    OperationList* list = &it->second;
+    for (OperationList::iterator i = list->begin(); i != list->end(); ++i) {
+      if (i->get() == op) {
+        list->erase(i);
+        break;
+      }
+    }
+    if (list->empty())
+      operations_.erase(it);
+    else
+      StartOperations(list);
+  }
+
   // Release the references acquired in PostRead / PostWrite.
   op->file()->Release();
   callback->OnFileIOComplete(bytes);
@@ -284,6 +413,7 @@ void File::WaitForPendingIO(int* num_pending_io) {
 
 // Static.
 void File::DropPendingIO() {
+  GetFileInFlightIO()->DropWaitingIO();
   GetFileInFlightIO()->DropPendingIO();
   DeleteFileInFlightIO();
 }
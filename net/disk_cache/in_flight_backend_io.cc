@@ -47,6 +47,7 @@ void BackendIO::OnIOComplete(int result) {
   DCHECK(IsEntryOperation());
   DCHECK_NE(result, net::ERR_IO_PENDING);
   result_ = result;
+  ReportEntryIOTimes();
   NotifyController();
 }
 
@@ -70,6 +71,10 @@ bool BackendIO::IsEntryOperation() {
   return operation_ > OP_MAX_BACKEND;
 }
 
+bool BackendIO::IsCreateOperation() {
+  return operation_ == OP_CREATE;
+}
+
 // Runs on the background thread.
 void BackendIO::ReferenceEntry() {
   entry_->AddRef();
@@ -285,6 +290,7 @@ void BackendIO::ExecuteBackendOperation() {
 
 // Runs on the background thread.
 void BackendIO::ExecuteEntryOperation() {
+  execute_time_ = base::TimeTicks::Now();
   switch (operation_) {
     case OP_READ:
       result_ = entry_->ReadDataImpl(
@@ -322,14 +328,23 @@ void BackendIO::ExecuteEntryOperation() {
       NOTREACHED() << "Invalid Operation";
       result_ = net::ERR_UNEXPECTED;
   }
-  if (result_ != net::ERR_IO_PENDING)
+  if (result_ != net::ERR_IO_PENDING) {
+    ReportEntryIOTimes();
     NotifyController();
+  }
+}
+
+// Runs on the background thread.
+void BackendIO::ReportEntryIOTimes() {
+  backend_->OnEntryIO(execute_time_ - start_time_,
+                      base::TimeTicks::Now() - execute_time_);
 }
 
 InFlightBackendIO::InFlightBackendIO(BackendImpl* backend,
                     base::MessageLoopProxy* background_thread)
     : backend_(backend),
       background_thread_(background_thread),
+      pending_creates_(0),
       ALLOW_THIS_IN_INITIALIZER_LIST(ptr_factory_(this)) {
 }
 
@@ -353,6 +368,7 @@ void InFlightBackendIO::CreateEntry(const std::string& key, Entry** entry,
                                     const net::CompletionCallback& callback) {
   scoped_refptr<BackendIO> operation(new BackendIO(this, backend_, callback));
   operation->CreateEntry(key, entry);
+  pending_creates_++;
   PostOperation(operation);
 }
 
@@ -503,6 +519,8 @@ void InFlightBackendIO::OnOperationComplete(BackgroundIO* operation,
                                             bool cancel) {
   BackendIO* op = static_cast<BackendIO*>(operation);
   op->OnDone(cancel);
+  if (op->IsCreateOperation())
+    pending_creates_--;
 
   if (!op->callback().is_null() && (!cancel || op->IsEntryOperation()))
     op->callback().Run(op->result());
@@ -41,6 +41,9 @@ class BackendIO : public BackgroundIO {
   // Returns true if this operation is directed to an entry (vs. the backend).
   bool IsEntryOperation();
 
+  // Returns true if this operation may add an entry to the cache.
+  bool IsCreateOperation();
+
   net::CompletionCallback callback() const { return callback_; }
 
   // Grabs an extra reference of entry_.
@@ -119,6 +122,10 @@ class BackendIO : public BackgroundIO {
   void ExecuteBackendOperation();
   void ExecuteEntryOperation();
 
+  // Reports the time spent by an entry operation waiting to start, and from
+  // there until it completed.
+  void ReportEntryIOTimes();
+
   BackendImpl* backend_;
   net::CompletionCallback callback_;
   Operation operation_;
@@ -139,6 +146,7 @@ class BackendIO : public BackgroundIO {
   int64 offset64_;
   int64* start_;
   base::TimeTicks start_time_;
+  base::TimeTicks execute_time_;
   base::Closure task_;
 
   DISALLOW_COPY_AND_ASSIGN(BackendIO);
@@ -194,6 +202,11 @@ class InFlightBackendIO : public InFlightIO {
   // Blocks until all operations are cancelled or completed.
   void WaitForPendingIO();
 
+  // Returns true if a CreateEntry() operation has not completed yet.
+  bool HasPendingCreates() const {
+    return pending_creates_ > 0;
+  }
+
   scoped_refptr<base::MessageLoopProxy> background_thread() {
     return background_thread_;
   }
@@ -214,6 +227,7 @@ class InFlightBackendIO : public InFlightIO {
 
   BackendImpl* backend_;
   scoped_refptr<base::MessageLoopProxy> background_thread_;
+  int pending_creates_;
   base::WeakPtrFactory<InFlightBackendIO> ptr_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(InFlightBackendIO);
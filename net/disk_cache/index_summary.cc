@@ -0,0 +1,119 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/index_summary.h"
+
+#include "base/logging.h"
+
+using base::subtle::Atomic32;
+
+namespace {
+
+// With 8 bits per bucket of the index table and 4 probes per key, a full
+// table gives about 2.4% false positives.
+const int kBitsPerBucket = 8;
+const int kNumProbes = 4;
+const int kMinBits = 1024;
+
+// The hash of the index is not well distributed on its higher bits (that are
+// not used to select a bucket), so it has to be mixed before use.
+uint32 Mix(uint32 value) {
+  value ^= value >> 16;
+  value *= 0x85ebca6b;
+  value ^= value >> 13;
+  value *= 0xc2b2ae35;
+  value ^= value >> 16;
+  return value;
+}
+
+}  // namespace
+
+namespace disk_cache {
+
+IndexSummary::IndexSummary()
+    : generation_(1), bit_mask_(0), num_removed_(0) {
+}
+
+IndexSummary::~IndexSummary() {
+}
+
+void IndexSummary::Reset(int num_buckets) {
+  Atomic32 generation = base::subtle::NoBarrier_Load(&generation_);
+  if (!(generation & 1)) {
+    // Readers that see the new generation will not look at the map, and
+    // readers that started before will notice the change after reading it.
+    base::subtle::NoBarrier_Store(&generation_, generation + 1);
+    base::subtle::MemoryBarrier();
+  }
+
+  if (!map_.get()) {
+    int num_bits = kMinBits;
+    while (num_bits < num_buckets * kBitsPerBucket && num_bits < kint32max / 2)
+      num_bits *= 2;
+    map_.reset(new Atomic32[num_bits / 32]);
+    bit_mask_ = num_bits - 1;
+  }
+
+  for (uint32 i = 0; i <= bit_mask_ / 32; i++)
+    base::subtle::NoBarrier_Store(&map_[i], 0);
+  num_removed_ = 0;
+}
+
+void IndexSummary::Add(uint32 hash) {
+  if (!map_.get())
+    return;
+
+  uint32 first = Mix(hash);
+  uint32 step = Mix(hash ^ 0x9e3779b9) | 1;
+  for (int i = 0; i < kNumProbes; i++)
+    SetBit(first + i * step);
+}
+
+void IndexSummary::Publish() {
+  Atomic32 generation = base::subtle::NoBarrier_Load(&generation_);
+  DCHECK(map_.get());
+  DCHECK(generation & 1);
+  base::subtle::Release_Store(&generation_, generation + 1);
+}
+
+void IndexSummary::OnRemoved() {
+  num_removed_++;
+}
+
+bool IndexSummary::MayContain(uint32 hash) const {
+  Atomic32 generation = base::subtle::Acquire_Load(&generation_);
+  if (generation & 1)
+    return true;
+
+  uint32 first = Mix(hash);
+  uint32 step = Mix(hash ^ 0x9e3779b9) | 1;
+  for (int i = 0; i < kNumProbes; i++) {
+    if (!GetBit(first + i * step)) {
+      // The answer is only valid if the map was not reset while reading it.
+      base::subtle::MemoryBarrier();
+      return base::subtle::NoBarrier_Load(&generation_) != generation;
+    }
+  }
+  return true;
+}
+
+bool IndexSummary::is_published() const {
+  return !(base::subtle::Acquire_Load(&generation_) & 1);
+}
+
+void IndexSummary::SetBit(uint32 bit) {
+  // There is a single writer, so there is no need for an atomic exchange.
+  bit &= bit_mask_;
+  Atomic32 value = base::subtle::NoBarrier_Load(&map_[bit / 32]);
+  value |= static_cast<Atomic32>(1U << (bit % 32));
+  base::subtle::NoBarrier_Store(&map_[bit / 32], value);
+}
+
+bool IndexSummary::GetBit(uint32 bit) const {
+  bit &= bit_mask_;
+  return (base::subtle::NoBarrier_Load(&map_[bit / 32]) &
+          static_cast<Atomic32>(1U << (bit % 32))) != 0;
+}
+
+}  // namespace disk_cache
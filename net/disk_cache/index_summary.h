@@ -0,0 +1,72 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// See net/disk_cache/disk_cache.h for the public interface of the cache.
+
+#ifndef NET_DISK_CACHE_INDEX_SUMMARY_H_
+#define NET_DISK_CACHE_INDEX_SUMMARY_H_
+#pragma once
+
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/net_export.h"
+
+namespace disk_cache {
+
+// A bloom filter over the hashes of the keys stored by the cache, so that the
+// thread that owns the backend can tell that a key is definitely not stored
+// without a round trip to the cache thread.
+//
+// The summary is modified only on the cache thread, and MayContain() can be
+// called from any thread without taking a lock. While the summary is being
+// rebuilt, or before it is built for the first time, every key may be present.
+// Entries cannot be removed from a bloom filter, so doomed entries just make
+// the summary less precise until it is rebuilt.
+class NET_EXPORT_PRIVATE IndexSummary {
+ public:
+  IndexSummary();
+  ~IndexSummary();
+
+  // Empties the summary and stops it from answering lookups until Publish() is
+  // called. The storage is sized for |num_buckets| the first time this method
+  // is called, and kept for the lifetime of this object.
+  void Reset(int num_buckets);
+
+  // Records the hash of a stored key. Must be called before the entry can be
+  // found through the index.
+  void Add(uint32 hash);
+
+  // Starts answering lookups with the hashes added since the last Reset().
+  void Publish();
+
+  // Records that a stored key was removed.
+  void OnRemoved();
+
+  // Returns false if no key with the given |hash| is stored.
+  bool MayContain(uint32 hash) const;
+
+  bool is_published() const;
+
+  // Returns the number of removals recorded since the last Reset().
+  int num_removed() const {
+    return num_removed_;
+  }
+
+ private:
+  void SetBit(uint32 bit);
+  bool GetBit(uint32 bit) const;
+
+  // Odd values mean that the contents of the summary cannot be used.
+  base::subtle::Atomic32 generation_;
+  scoped_array<base::subtle::Atomic32> map_;
+  uint32 bit_mask_;
+  int num_removed_;
+
+  DISALLOW_COPY_AND_ASSIGN(IndexSummary);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_INDEX_SUMMARY_H_
@@ -0,0 +1,64 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/index_summary.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+TEST(DiskCacheIndexSummaryTest, Unpublished) {
+  disk_cache::IndexSummary summary;
+  EXPECT_FALSE(summary.is_published());
+  EXPECT_TRUE(summary.MayContain(0x1234));
+
+  summary.Reset(1024);
+  summary.Add(0x1234);
+  EXPECT_TRUE(summary.MayContain(0x4321));
+
+  summary.Publish();
+  EXPECT_TRUE(summary.is_published());
+  EXPECT_TRUE(summary.MayContain(0x1234));
+  EXPECT_FALSE(summary.MayContain(0x4321));
+
+  // Resetting the summary stops it from filtering out anything.
+  summary.Reset(1024);
+  EXPECT_FALSE(summary.is_published());
+  EXPECT_TRUE(summary.MayContain(0x4321));
+  summary.Publish();
+  EXPECT_FALSE(summary.MayContain(0x1234));
+}
+
+TEST(DiskCacheIndexSummaryTest, FalsePositives) {
+  const int kNumBuckets = 64 * 1024;
+  disk_cache::IndexSummary summary;
+  summary.Reset(kNumBuckets);
+
+  // Hashes that share their lower bits land on the same bucket of the index.
+  for (uint32 i = 0; i < kNumBuckets / 2; i++)
+    summary.Add(i * 0x10001);
+  summary.Publish();
+
+  for (uint32 i = 0; i < kNumBuckets / 2; i++)
+    EXPECT_TRUE(summary.MayContain(i * 0x10001));
+
+  int false_positives = 0;
+  for (uint32 i = 1; i <= kNumBuckets; i++) {
+    if (summary.MayContain(i * 0x10001 + kNumBuckets / 2))
+      false_positives++;
+  }
+  EXPECT_LT(false_positives, kNumBuckets / 100);
+}
+
+TEST(DiskCacheIndexSummaryTest, Removals) {
+  disk_cache::IndexSummary summary;
+  summary.Reset(1024);
+  summary.Add(1);
+  summary.OnRemoved();
+  summary.OnRemoved();
+  summary.Publish();
+  EXPECT_EQ(2, summary.num_removed());
+
+  // Removed entries are still reported, until the summary is rebuilt.
+  EXPECT_TRUE(summary.MayContain(1));
+  summary.Reset(1024);
+  EXPECT_EQ(0, summary.num_removed());
+}
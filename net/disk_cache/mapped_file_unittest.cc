@@ -88,4 +88,57 @@ TEST_F(DiskCacheTest, MappedFile_AsyncIO) {
   EXPECT_EQ(expected, helper.callbacks_called());
   EXPECT_FALSE(helper.callback_reused_error());
   EXPECT_STREQ(buffer1, buffer2);
+
+  // The controller of the asynchronous IO belongs to this message loop.
+  int num_pending_io = 0;
+  disk_cache::File::WaitForPendingIO(&num_pending_io);
+}
+
+// Tests that asynchronous operations on overlapping parts of a file complete
+// in the order they were issued.
+TEST_F(DiskCacheTest, MappedFile_AsyncIOOrdering) {
+  FilePath filename = cache_path_.AppendASCII("a_test");
+  scoped_refptr<disk_cache::MappedFile> file(new disk_cache::MappedFile);
+  ASSERT_TRUE(CreateCacheTestFile(filename));
+  ASSERT_TRUE(file->Init(filename, 8192));
+
+  int max_id = 1;
+  MessageLoopHelper helper;
+  FileCallbackTest callback(1, &helper, &max_id);
+
+  const int kSize = 64 * 1024;
+  const int kNumWrites = 10;
+  scoped_array<char> buffers(new char[kSize * kNumWrites]);
+  for (int i = 0; i < kNumWrites; i++)
+    CacheTestFillBuffer(&buffers[i * kSize], kSize, false);
+  scoped_array<char> result(new char[kSize]);
+  scoped_array<char> other(new char[kSize]);
+
+  // Every write replaces the previous one, and the read sees the last one.
+  int expected = 0;
+  bool completed;
+  for (int i = 0; i < kNumWrites; i++) {
+    EXPECT_TRUE(file->Write(&buffers[i * kSize], kSize, 1024 * 1024,
+                            &callback, &completed));
+    if (!completed)
+      expected++;
+  }
+  EXPECT_TRUE(file->Read(result.get(), kSize, 1024 * 1024, &callback,
+                         &completed));
+  if (!completed)
+    expected++;
+
+  // This one does not have to wait.
+  EXPECT_TRUE(file->Write(other.get(), kSize, 2 * 1024 * 1024, &callback,
+                          &completed));
+  if (!completed)
+    expected++;
+
+  helper.WaitUntilCacheIoFinished(expected);
+  EXPECT_EQ(expected, helper.callbacks_called());
+  EXPECT_EQ(0, memcmp(&buffers[(kNumWrites - 1) * kSize], result.get(),
+                      kSize));
+
+  int num_pending_io = 0;
+  disk_cache::File::WaitForPendingIO(&num_pending_io);
 }
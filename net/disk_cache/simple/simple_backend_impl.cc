@@ -0,0 +1,517 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_backend_impl.h"
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/file_util.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/message_loop_proxy.h"
+#include "base/sys_info.h"
+#include "base/threading/worker_pool.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/backend_impl.h"
+#include "net/disk_cache/simple/simple_entry_impl.h"
+#include "net/disk_cache/simple/simple_index.h"
+#include "net/disk_cache/simple/simple_synchronous_entry.h"
+#include "net/disk_cache/simple/simple_util.h"
+
+using base::WorkerPool;
+
+namespace {
+
+// Reports the completion of a group of operations started together, once the
+// last of them is done.
+class DoomBarrier : public base::RefCounted<DoomBarrier> {
+ public:
+  explicit DoomBarrier(const net::CompletionCallback& callback)
+      : callback_(callback), pending_(0) {}
+
+  void set_pending(int pending) { pending_ = pending; }
+
+  void OnOperationComplete(int result) {
+    DCHECK_GT(pending_, 0);
+    if (!--pending_ && !callback_.is_null())
+      callback_.Run(net::OK);
+  }
+
+ private:
+  friend class base::RefCounted<DoomBarrier>;
+  ~DoomBarrier() {}
+
+  net::CompletionCallback callback_;
+  int pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(DoomBarrier);
+};
+
+}  // namespace
+
+namespace disk_cache {
+
+struct SimpleBackendImpl::Enumeration {
+  Enumeration() : next(0) {}
+
+  // The entries that were in the index when the enumeration started.
+  std::vector<uint64> hashes;
+  size_t next;
+};
+
+SimpleBackendImpl::~SimpleBackendImpl() {
+  // The entries that are still open outlive the backend, and just stop
+  // reporting to it.
+}
+
+// static
+int SimpleBackendImpl::CreateBackend(const FilePath& path, int max_bytes,
+                                     base::MessageLoopProxy* cache_thread,
+                                     Backend** backend,
+                                     const CompletionCallback& callback) {
+  DCHECK(cache_thread);
+  DCHECK(!callback.is_null());
+  SimpleBackendImpl* backend_impl =
+      new SimpleBackendImpl(path, max_bytes, cache_thread);
+  int* max_size = new int(max_bytes);
+  int* result = new int(net::ERR_FAILED);
+  cache_thread->PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&SimpleBackendImpl::InitializeOnCacheThread, path, max_size,
+                 result),
+      base::Bind(&SimpleBackendImpl::InitializeComplete, backend_impl, backend,
+                 callback, base::Owned(max_size), base::Owned(result)));
+  return net::ERR_IO_PENDING;
+}
+
+int SimpleBackendImpl::DoomEntryFromHash(uint64 hash,
+                                         const CompletionCallback& callback) {
+  if (IsBusy(hash)) {
+    Defer(hash,
+          base::Bind(&SimpleBackendImpl::DoomEntryFromHash,
+                     base::Unretained(this), hash),
+          callback);
+    return net::ERR_IO_PENDING;
+  }
+
+  EntryMap::iterator it = active_entries_.find(hash);
+  if (it != active_entries_.end()) {
+    it->second->MarkAsDoomed();
+    active_entries_.erase(it);
+  } else if (!index_->Has(hash)) {
+    return net::ERR_FAILED;
+  }
+
+  index_->Remove(hash);
+  MarkAsBusy(hash);
+  WorkerPool::PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(base::IgnoreResult(&SimpleSynchronousEntry::DeleteEntryFile),
+                 path_, hash),
+      base::Bind(&SimpleBackendImpl::FinishOperation, AsWeakPtr(), hash,
+                 callback, net::OK),
+      true);
+  return net::ERR_IO_PENDING;
+}
+
+void SimpleBackendImpl::OnEntryClosing(SimpleEntryImpl* entry) {
+  uint64 hash = entry->hash();
+  DCHECK(active_entries_.find(hash) != active_entries_.end());
+  DCHECK_EQ(entry, active_entries_[hash]);
+  active_entries_.erase(hash);
+  index_->UseIfExists(hash);
+
+  // The file cannot be opened again until the entry is done with it.
+  MarkAsBusy(hash);
+}
+
+void SimpleBackendImpl::OnEntryClosed(uint64 hash, int64 file_size) {
+  if (file_size < 0)
+    index_->Remove(hash);
+  else
+    index_->UpdateEntrySize(hash, file_size);
+  EvictIfNeeded();
+  FinishOperation(hash, CompletionCallback(), net::OK);
+}
+
+int32 SimpleBackendImpl::GetEntryCount() const {
+  return index_->GetEntryCount();
+}
+
+int SimpleBackendImpl::OpenEntry(const std::string& key, Entry** entry,
+                                 const CompletionCallback& callback) {
+  return OpenOrCreateEntry(key, false, entry, callback);
+}
+
+int SimpleBackendImpl::CreateEntry(const std::string& key, Entry** entry,
+                                   const CompletionCallback& callback) {
+  return OpenOrCreateEntry(key, true, entry, callback);
+}
+
+int SimpleBackendImpl::DoomEntry(const std::string& key,
+                                 const CompletionCallback& callback) {
+  return DoomEntryFromHash(GetEntryHashKey(key), callback);
+}
+
+int SimpleBackendImpl::DoomAllEntries(const CompletionCallback& callback) {
+  return DoomEntriesBetween(base::Time(), base::Time(), callback);
+}
+
+int SimpleBackendImpl::DoomEntriesBetween(base::Time initial_time,
+                                          base::Time end_time,
+                                          const CompletionCallback& callback) {
+  if (index_->initialized())
+    return DoomEntriesNow(initial_time, end_time, callback);
+
+  index_->ExecuteWhenReady(
+      base::Bind(&SimpleBackendImpl::RunDeferredOperation,
+                 base::Bind(&SimpleBackendImpl::DoomEntriesNow,
+                            base::Unretained(this), initial_time, end_time),
+                 callback));
+  return net::ERR_IO_PENDING;
+}
+
+int SimpleBackendImpl::DoomEntriesSince(base::Time initial_time,
+                                        const CompletionCallback& callback) {
+  return DoomEntriesBetween(initial_time, base::Time(), callback);
+}
+
+int SimpleBackendImpl::OpenNextEntry(void** iter, Entry** next_entry,
+                                     const CompletionCallback& callback) {
+  if (index_->initialized())
+    return OpenNextEntryNow(iter, next_entry, callback);
+
+  index_->ExecuteWhenReady(
+      base::Bind(&SimpleBackendImpl::RunDeferredOperation,
+                 base::Bind(&SimpleBackendImpl::OpenNextEntryNow,
+                            base::Unretained(this), iter, next_entry),
+                 callback));
+  return net::ERR_IO_PENDING;
+}
+
+void SimpleBackendImpl::EndEnumeration(void** iter) {
+  delete static_cast<Enumeration*>(*iter);
+  *iter = NULL;
+}
+
+void SimpleBackendImpl::GetStats(
+    std::vector<std::pair<std::string, std::string> >* stats) {
+  stats->push_back(std::make_pair(std::string("Cache type"),
+                                  std::string("Simple Cache")));
+}
+
+void SimpleBackendImpl::OnExternalCacheHit(const std::string& key) {
+  index_->UseIfExists(GetEntryHashKey(key));
+}
+
+SimpleBackendImpl::SimpleBackendImpl(const FilePath& path, int max_bytes,
+                                     base::MessageLoopProxy* cache_thread)
+    : path_(path),
+      max_size_(max_bytes),
+      cache_thread_(cache_thread),
+      index_(new SimpleIndex(cache_thread, path)) {
+}
+
+// static
+void SimpleBackendImpl::InitializeOnCacheThread(const FilePath& path,
+                                                int* max_size,
+                                                int* result) {
+  if (!file_util::PathExists(path) && !file_util::CreateDirectory(path)) {
+    LOG(ERROR) << "Unable to create cache folder";
+    *result = net::ERR_FAILED;
+    return;
+  }
+
+  if (!*max_size) {
+    int64 available = base::SysInfo::AmountOfFreeDiskSpace(path);
+    if (available < 0) {
+      *result = net::ERR_FAILED;
+      return;
+    }
+    *max_size = PreferedCacheSize(available);
+  }
+  *result = net::OK;
+}
+
+// static
+void SimpleBackendImpl::InitializeComplete(SimpleBackendImpl* backend,
+                                           Backend** out_backend,
+                                           const CompletionCallback& callback,
+                                           const int* max_size,
+                                           const int* result) {
+  if (*result == net::OK) {
+    backend->max_size_ = *max_size;
+    backend->index_->Initialize();
+    *out_backend = backend;
+  } else {
+    delete backend;
+    *out_backend = NULL;
+  }
+  callback.Run(*result);
+}
+
+// static
+void SimpleBackendImpl::OpenOrCreateOnWorkerPool(
+    const FilePath& path,
+    const std::string& key,
+    bool create,
+    SimpleSynchronousEntry** entry) {
+  if (create)
+    *entry = SimpleSynchronousEntry::CreateEntry(path, key);
+  else
+    *entry = SimpleSynchronousEntry::OpenEntry(path, key);
+}
+
+// static
+void SimpleBackendImpl::OpenOrCreateComplete(
+    const base::WeakPtr<SimpleBackendImpl>& backend,
+    uint64 hash,
+    bool create,
+    Entry** entry,
+    const CompletionCallback& callback,
+    SimpleSynchronousEntry** synchronous_entry) {
+  if (!backend) {
+    if (*synchronous_entry) {
+      WorkerPool::PostTask(
+          FROM_HERE,
+          base::Bind(&base::DeletePointer<SimpleSynchronousEntry>,
+                     *synchronous_entry),
+          true);
+    }
+    return;
+  }
+  backend->OnOpenOrCreateComplete(hash, create, entry, callback,
+                                  *synchronous_entry);
+}
+
+// static
+void SimpleBackendImpl::RunDeferredOperation(
+    const Operation& operation,
+    const CompletionCallback& callback) {
+  int rv = operation.Run(callback);
+  if (rv != net::ERR_IO_PENDING && !callback.is_null())
+    callback.Run(rv);
+}
+
+int SimpleBackendImpl::OpenOrCreateEntry(const std::string& key, bool create,
+                                         Entry** entry,
+                                         const CompletionCallback& callback) {
+  uint64 hash = GetEntryHashKey(key);
+  if (IsBusy(hash)) {
+    Defer(hash,
+          base::Bind(&SimpleBackendImpl::OpenOrCreateEntry,
+                     base::Unretained(this), key, create, entry),
+          callback);
+    return net::ERR_IO_PENDING;
+  }
+
+  EntryMap::iterator it = active_entries_.find(hash);
+  if (it != active_entries_.end()) {
+    if (create || it->second->GetKey() != key)
+      return net::ERR_FAILED;
+    it->second->Reopen();
+    index_->UseIfExists(hash);
+    *entry = it->second;
+    return net::OK;
+  }
+
+  // The index knows about every entry file, so most misses end here.
+  if (!create && !index_->Has(hash))
+    return net::ERR_FAILED;
+
+  MarkAsBusy(hash);
+  SimpleSynchronousEntry** synchronous_entry =
+      new SimpleSynchronousEntry*(NULL);
+  WorkerPool::PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&SimpleBackendImpl::OpenOrCreateOnWorkerPool, path_, key,
+                 create, synchronous_entry),
+      base::Bind(&SimpleBackendImpl::OpenOrCreateComplete, AsWeakPtr(), hash,
+                 create, entry, callback, base::Owned(synchronous_entry)),
+      true);
+  return net::ERR_IO_PENDING;
+}
+
+void SimpleBackendImpl::OnOpenOrCreateComplete(
+    uint64 hash,
+    bool create,
+    Entry** entry,
+    const CompletionCallback& callback,
+    SimpleSynchronousEntry* synchronous_entry) {
+  if (!synchronous_entry) {
+    // A file that cannot be opened is gone, or was deleted as corrupt.
+    if (!create)
+      index_->Remove(hash);
+    FinishOperation(hash, callback, net::ERR_FAILED);
+    return;
+  }
+
+  SimpleEntryImpl* entry_impl =
+      new SimpleEntryImpl(AsWeakPtr(), path_, hash, synchronous_entry);
+  active_entries_[hash] = entry_impl;
+  if (create)
+    index_->Insert(hash);
+  else
+    index_->UseIfExists(hash);
+  *entry = entry_impl;
+  FinishOperation(hash, callback, net::OK);
+}
+
+int SimpleBackendImpl::DoomEntriesNow(base::Time initial_time,
+                                      base::Time end_time,
+                                      const CompletionCallback& callback) {
+  std::vector<uint64> hashes;
+  index_->GetEntriesBetween(initial_time, end_time, &hashes);
+
+  // Dooming an entry never completes synchronously with success, so the
+  // barrier cannot fire before every operation is started.
+  scoped_refptr<DoomBarrier> barrier(new DoomBarrier(callback));
+  int pending = 0;
+  for (size_t i = 0; i < hashes.size(); i++) {
+    int rv = DoomEntryFromHash(
+        hashes[i], base::Bind(&DoomBarrier::OnOperationComplete, barrier));
+    if (rv == net::ERR_IO_PENDING)
+      pending++;
+  }
+  if (!pending)
+    return net::OK;
+
+  barrier->set_pending(pending);
+  return net::ERR_IO_PENDING;
+}
+
+// static
+void SimpleBackendImpl::ReadKeyOnWorkerPool(const FilePath& path, uint64 hash,
+                                            std::string* key) {
+  if (!SimpleSynchronousEntry::ReadKey(path, hash, key))
+    key->clear();
+}
+
+int SimpleBackendImpl::OpenNextEntryNow(void** iter, Entry** next_entry,
+                                        const CompletionCallback& callback) {
+  Enumeration* enumeration = static_cast<Enumeration*>(*iter);
+  if (!enumeration) {
+    enumeration = new Enumeration;
+    index_->GetEntriesBetween(base::Time(), base::Time(),
+                              &enumeration->hashes);
+    *iter = enumeration;
+  }
+
+  while (enumeration->next < enumeration->hashes.size()) {
+    uint64 hash = enumeration->hashes[enumeration->next++];
+    // Skip the entries doomed since the enumeration started.
+    if (!index_->Has(hash))
+      continue;
+
+    EntryMap::iterator it = active_entries_.find(hash);
+    if (it != active_entries_.end()) {
+      it->second->Reopen();
+      *next_entry = it->second;
+      return net::OK;
+    }
+
+    // Only the file knows the key, which OpenEntry() needs.
+    std::string* key = new std::string;
+    WorkerPool::PostTaskAndReply(
+        FROM_HERE,
+        base::Bind(&SimpleBackendImpl::ReadKeyOnWorkerPool, path_, hash, key),
+        base::Bind(&SimpleBackendImpl::OnEnumerationKeyRead, AsWeakPtr(),
+                   iter, next_entry, callback, base::Owned(key)),
+        true);
+    return net::ERR_IO_PENDING;
+  }
+
+  EndEnumeration(iter);
+  return net::ERR_FAILED;
+}
+
+// static
+void SimpleBackendImpl::OnEnumerationKeyRead(
+    const base::WeakPtr<SimpleBackendImpl>& backend,
+    void** iter,
+    Entry** next_entry,
+    const CompletionCallback& callback,
+    const std::string* key) {
+  if (!backend)
+    return;
+
+  // An entry whose file is gone is skipped, like one that fails to open.
+  if (key->empty()) {
+    backend->OnEnumerationEntryOpened(iter, next_entry, callback,
+                                      net::ERR_FAILED);
+    return;
+  }
+  int rv = backend->OpenEntry(
+      *key, next_entry,
+      base::Bind(&SimpleBackendImpl::OnEnumerationEntryOpened,
+                 backend->AsWeakPtr(), iter, next_entry, callback));
+  if (rv != net::ERR_IO_PENDING)
+    backend->OnEnumerationEntryOpened(iter, next_entry, callback, rv);
+}
+
+void SimpleBackendImpl::OnEnumerationEntryOpened(
+    void** iter,
+    Entry** next_entry,
+    const CompletionCallback& callback,
+    int result) {
+  if (result != net::OK)
+    result = OpenNextEntryNow(iter, next_entry, callback);
+  if (result != net::ERR_IO_PENDING)
+    callback.Run(result);
+}
+
+bool SimpleBackendImpl::IsBusy(uint64 hash) const {
+  return pending_operations_.find(hash) != pending_operations_.end();
+}
+
+void SimpleBackendImpl::MarkAsBusy(uint64 hash) {
+  DCHECK(!IsBusy(hash));
+  pending_operations_.insert(
+      std::make_pair(hash, std::vector<base::Closure>()));
+}
+
+void SimpleBackendImpl::Defer(uint64 hash, const Operation& operation,
+                              const CompletionCallback& callback) {
+  DCHECK(IsBusy(hash));
+  pending_operations_[hash].push_back(
+      base::Bind(&SimpleBackendImpl::RunDeferredOperation, operation,
+                 callback));
+}
+
+void SimpleBackendImpl::FinishOperation(uint64 hash,
+                                        const CompletionCallback& callback,
+                                        int result) {
+  PendingOperations::iterator it = pending_operations_.find(hash);
+  DCHECK(it != pending_operations_.end());
+  std::vector<base::Closure> operations;
+  operations.swap(it->second);
+  pending_operations_.erase(it);
+
+  // Any of the callbacks may delete the backend.
+  base::WeakPtr<SimpleBackendImpl> weak_this = AsWeakPtr();
+  if (!callback.is_null())
+    callback.Run(result);
+
+  // The first operation may make the entry busy again, and then the rest
+  // wait behind it, in order.
+  for (size_t i = 0; i < operations.size() && weak_this; i++)
+    operations[i].Run();
+}
+
+void SimpleBackendImpl::EvictIfNeeded() {
+  if (!index_->initialized() || index_->cache_size() <= max_size_)
+    return;
+
+  std::vector<uint64> hashes;
+  index_->GetEntriesForEviction(max_size_ - max_size_ / 10, &hashes);
+  for (size_t i = 0; i < hashes.size(); i++) {
+    if (IsBusy(hashes[i]) ||
+        active_entries_.find(hashes[i]) != active_entries_.end()) {
+      continue;
+    }
+    DoomEntryFromHash(hashes[i], CompletionCallback());
+  }
+}
+
+}  // namespace disk_cache
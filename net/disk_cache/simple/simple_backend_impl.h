@@ -0,0 +1,186 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_BACKEND_IMPL_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_BACKEND_IMPL_H_
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/compiler_specific.h"
+#include "base/file_path.h"
+#include "base/hash_tables.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "net/base/net_export.h"
+#include "net/disk_cache/disk_cache.h"
+
+namespace base {
+class MessageLoopProxy;
+}
+
+namespace disk_cache {
+
+class SimpleEntryImpl;
+class SimpleIndex;
+class SimpleSynchronousEntry;
+
+// This class implements the Backend interface with one file per entry, in a
+// single directory. Entries that are not open are only known by a small
+// index, kept in memory and written to disk from time to time, that can be
+// rebuilt from the entry files when it is lost. The IO of different entries
+// runs in parallel on the worker pool, and there is no global structure on
+// disk that could be corrupted by a crash.
+//
+// Sparse entries are not supported. Enumeration walks the entries that are in
+// the index when it starts, in no particular order.
+class NET_EXPORT_PRIVATE SimpleBackendImpl
+    : public Backend,
+      public base::SupportsWeakPtr<SimpleBackendImpl> {
+ public:
+  virtual ~SimpleBackendImpl();
+
+  // Creates a simple cache in |path|, as disk_cache::CreateCacheBackend()
+  // would. |cache_thread| is used to create the directory and to read and
+  // write the index.
+  static int CreateBackend(const FilePath& path, int max_bytes,
+                           base::MessageLoopProxy* cache_thread,
+                           Backend** backend,
+                           const CompletionCallback& callback);
+
+  // Dooms the entry with the given |hash|, as DoomEntry() would.
+  int DoomEntryFromHash(uint64 hash, const CompletionCallback& callback);
+
+  // Called by an entry when its last user closes it, and when it is done
+  // writing its file. |file_size| is negative if the file could not be
+  // written.
+  void OnEntryClosing(SimpleEntryImpl* entry);
+  void OnEntryClosed(uint64 hash, int64 file_size);
+
+  const FilePath& path() const { return path_; }
+  int max_size() const { return max_size_; }
+
+  // Backend interface.
+  virtual int32 GetEntryCount() const OVERRIDE;
+  virtual int OpenEntry(const std::string& key, Entry** entry,
+                        const CompletionCallback& callback) OVERRIDE;
+  virtual int CreateEntry(const std::string& key, Entry** entry,
+                          const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntry(const std::string& key,
+                        const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomAllEntries(const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesBetween(base::Time initial_time,
+                                 base::Time end_time,
+                                 const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesSince(base::Time initial_time,
+                               const CompletionCallback& callback) OVERRIDE;
+  virtual int OpenNextEntry(void** iter, Entry** next_entry,
+                            const CompletionCallback& callback) OVERRIDE;
+  virtual void EndEnumeration(void** iter) OVERRIDE;
+  virtual void GetStats(
+      std::vector<std::pair<std::string, std::string> >* stats) OVERRIDE;
+  virtual void OnExternalCacheHit(const std::string& key) OVERRIDE;
+
+ private:
+  typedef base::hash_map<uint64, SimpleEntryImpl*> EntryMap;
+  typedef base::Callback<int(const CompletionCallback&)> Operation;
+  typedef base::hash_map<uint64, std::vector<base::Closure> >
+      PendingOperations;
+
+  // The state of an enumeration, which OpenNextEntry() keeps in |*iter|.
+  struct Enumeration;
+
+  SimpleBackendImpl(const FilePath& path, int max_bytes,
+                    base::MessageLoopProxy* cache_thread);
+
+  // Runs on the cache thread, and returns a net error code in |result|.
+  static void InitializeOnCacheThread(const FilePath& path, int* max_size,
+                                      int* result);
+  static void InitializeComplete(SimpleBackendImpl* backend,
+                                 Backend** out_backend,
+                                 const CompletionCallback& callback,
+                                 const int* max_size,
+                                 const int* result);
+
+  // Runs on the worker pool, where the entry file is opened or created.
+  static void OpenOrCreateOnWorkerPool(const FilePath& path,
+                                       const std::string& key,
+                                       bool create,
+                                       SimpleSynchronousEntry** entry);
+
+  // The reply to OpenOrCreateOnWorkerPool(), that closes the file if the
+  // backend is already gone.
+  static void OpenOrCreateComplete(
+      const base::WeakPtr<SimpleBackendImpl>& backend,
+      uint64 hash,
+      bool create,
+      Entry** entry,
+      const CompletionCallback& callback,
+      SimpleSynchronousEntry** synchronous_entry);
+
+  // Runs an operation that was waiting for a busy entry, and reports its
+  // result if it completed synchronously.
+  static void RunDeferredOperation(const Operation& operation,
+                                   const CompletionCallback& callback);
+
+  int OpenOrCreateEntry(const std::string& key, bool create, Entry** entry,
+                        const CompletionCallback& callback);
+  void OnOpenOrCreateComplete(uint64 hash, bool create, Entry** entry,
+                              const CompletionCallback& callback,
+                              SimpleSynchronousEntry* synchronous_entry);
+  int DoomEntriesNow(base::Time initial_time, base::Time end_time,
+                     const CompletionCallback& callback);
+
+  // Runs on the worker pool, where the key of the next entry to enumerate
+  // is read from its file. |key| is left empty if it cannot be read.
+  static void ReadKeyOnWorkerPool(const FilePath& path, uint64 hash,
+                                  std::string* key);
+
+  // Opens the next entry of the enumeration in |*iter|, once the index is
+  // initialized. Entries that are gone by the time they are reached are
+  // skipped. Ends the enumeration when there are no entries left.
+  int OpenNextEntryNow(void** iter, Entry** next_entry,
+                       const CompletionCallback& callback);
+  static void OnEnumerationKeyRead(
+      const base::WeakPtr<SimpleBackendImpl>& backend,
+      void** iter,
+      Entry** next_entry,
+      const CompletionCallback& callback,
+      const std::string* key);
+  void OnEnumerationEntryOpened(void** iter, Entry** next_entry,
+                                const CompletionCallback& callback,
+                                int result);
+
+  // An entry is busy while its file is opened, created, closed or deleted.
+  // Any operation on a busy entry waits for the operation in progress.
+  bool IsBusy(uint64 hash) const;
+  void MarkAsBusy(uint64 hash);
+  void Defer(uint64 hash, const Operation& operation,
+             const CompletionCallback& callback);
+
+  // Runs |callback| with |result|, and then the operations that waited for
+  // the entry with the given |hash|.
+  void FinishOperation(uint64 hash, const CompletionCallback& callback,
+                       int result);
+
+  // Dooms the least recently used entries if the cache is too large.
+  void EvictIfNeeded();
+
+  const FilePath path_;
+  int max_size_;
+  scoped_refptr<base::MessageLoopProxy> cache_thread_;
+  scoped_ptr<SimpleIndex> index_;
+  EntryMap active_entries_;
+  PendingOperations pending_operations_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimpleBackendImpl);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_BACKEND_IMPL_H_
@@ -0,0 +1,59 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_ENTRY_FORMAT_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_ENTRY_FORMAT_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/port.h"
+
+namespace disk_cache {
+
+// The simple cache stores each entry in its own file, named after the hash of
+// the key of the entry (see simple_util.h). The file looks like this:
+//
+//   SimpleFileHeader
+//   the key
+//   stream 1
+//   stream 0
+//   stream 2
+//   SimpleFileEOF
+//
+// Stream 1 holds the bulk of the data (the body of an HTTP response), so it is
+// written in place. The other streams are small, so they are kept in memory
+// while the entry is open and written right after stream 1 when the entry is
+// closed. An entry that is modified loses its SimpleFileEOF until it is
+// closed, so a file without a valid SimpleFileEOF (for instance after a crash)
+// is just discarded; there is no need for a journal or for flushing the file.
+
+const uint64 kSimpleInitialMagicNumber = GG_UINT64_C(0xfcfb6d1ba7725c30);
+const uint64 kSimpleFinalMagicNumber = GG_UINT64_C(0xf4fa6f45970d41d8);
+const uint32 kSimpleVersion = 1;
+
+const int kSimpleEntryStreamCount = 3;
+
+// The stream that is stored in place.
+const int kSimpleLargeStreamIndex = 1;
+
+struct SimpleFileHeader {
+  uint64 initial_magic_number;
+  uint32 version;
+  uint32 key_length;
+  uint32 key_hash;
+  uint32 unused;
+};
+
+struct SimpleFileEOF {
+  uint64 final_magic_number;
+  int32 data_size[kSimpleEntryStreamCount];
+  uint32 unused;
+};
+
+COMPILE_ASSERT(sizeof(SimpleFileHeader) == 24, bad_SimpleFileHeader);
+COMPILE_ASSERT(sizeof(SimpleFileEOF) == 24, bad_SimpleFileEOF);
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_ENTRY_FORMAT_H_
@@ -0,0 +1,305 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_entry_impl.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/threading/worker_pool.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/simple/simple_backend_impl.h"
+#include "net/disk_cache/simple/simple_synchronous_entry.h"
+
+using base::WorkerPool;
+
+namespace {
+
+void ReadOnWorkerPool(disk_cache::SimpleSynchronousEntry* entry, int offset,
+                      net::IOBuffer* buf, int buf_len, int* result) {
+  *result = entry->ReadData(offset, buf, buf_len);
+}
+
+void WriteOnWorkerPool(disk_cache::SimpleSynchronousEntry* entry, int offset,
+                       net::IOBuffer* buf, int buf_len, bool truncate,
+                       int* result) {
+  *result = entry->WriteData(offset, buf, buf_len, truncate);
+}
+
+// Deletes |entry|, after storing the small streams when |write_end| is true.
+// |file_size| is set to -1 if the entry could not be stored.
+void CloseOnWorkerPool(disk_cache::SimpleSynchronousEntry* entry,
+                       bool write_end,
+                       const std::string& stream_0,
+                       const std::string& stream_2,
+                       const FilePath& path,
+                       uint64 hash,
+                       int64* file_size) {
+  if (write_end && !entry->WriteEntryEnd(stream_0, stream_2)) {
+    *file_size = -1;
+    delete entry;
+    disk_cache::SimpleSynchronousEntry::DeleteEntryFile(path, hash);
+    return;
+  }
+  *file_size = entry->file_size();
+  delete entry;
+}
+
+}  // namespace
+
+namespace disk_cache {
+
+SimpleEntryImpl::SimpleEntryImpl(
+    const base::WeakPtr<SimpleBackendImpl>& backend,
+    const FilePath& path,
+    uint64 hash,
+    SimpleSynchronousEntry* synchronous_entry)
+    : backend_(backend),
+      path_(path),
+      hash_(hash),
+      key_(synchronous_entry->key()),
+      last_used_(base::Time::Now()),
+      last_modified_(synchronous_entry->last_modified()),
+      modified_(false),
+      doomed_(false),
+      open_count_(1),
+      synchronous_entry_(synchronous_entry),
+      operation_running_(false) {
+  for (int i = 0; i < kSimpleEntryStreamCount; i++) {
+    data_size_[i] = synchronous_entry->data_size(i);
+    if (i != kSimpleLargeStreamIndex)
+      stream_data_[i].swap(*synchronous_entry->stream_data(i));
+  }
+  // This reference belongs to the users of the entry, and goes away with
+  // the last call to Close().
+  AddRef();
+}
+
+void SimpleEntryImpl::Reopen() {
+  DCHECK_GT(open_count_, 0);
+  open_count_++;
+  last_used_ = base::Time::Now();
+}
+
+void SimpleEntryImpl::MarkAsDoomed() {
+  doomed_ = true;
+}
+
+void SimpleEntryImpl::Doom() {
+  if (doomed_)
+    return;
+
+  if (backend_) {
+    backend_->DoomEntryFromHash(hash_, CompletionCallback());
+    DCHECK(doomed_);
+    return;
+  }
+
+  doomed_ = true;
+  WorkerPool::PostTask(
+      FROM_HERE,
+      base::Bind(base::IgnoreResult(&SimpleSynchronousEntry::DeleteEntryFile),
+                 path_, hash_),
+      true);
+}
+
+void SimpleEntryImpl::Close() {
+  DCHECK_GT(open_count_, 0);
+  if (--open_count_)
+    return;
+
+  if (backend_ && !doomed_)
+    backend_->OnEntryClosing(this);
+  EnqueueOperation(base::Bind(&SimpleEntryImpl::CloseInternal, this));
+  Release();
+}
+
+std::string SimpleEntryImpl::GetKey() const {
+  return key_;
+}
+
+base::Time SimpleEntryImpl::GetLastUsed() const {
+  return last_used_;
+}
+
+base::Time SimpleEntryImpl::GetLastModified() const {
+  return last_modified_;
+}
+
+int32 SimpleEntryImpl::GetDataSize(int index) const {
+  if (index < 0 || index >= kSimpleEntryStreamCount)
+    return 0;
+  return data_size_[index];
+}
+
+int SimpleEntryImpl::ReadData(int index, int offset, net::IOBuffer* buf,
+                              int buf_len,
+                              const CompletionCallback& callback) {
+  DCHECK(open_count_);
+  if (index < 0 || index >= kSimpleEntryStreamCount || buf_len < 0)
+    return net::ERR_INVALID_ARGUMENT;
+  if (offset < 0)
+    return net::ERR_INVALID_ARGUMENT;
+
+  last_used_ = base::Time::Now();
+  if (offset >= data_size_[index] || !buf_len)
+    return 0;
+  buf_len = std::min(buf_len, data_size_[index] - offset);
+
+  if (index != kSimpleLargeStreamIndex) {
+    memcpy(buf->data(), stream_data_[index].data() + offset, buf_len);
+    return buf_len;
+  }
+
+  EnqueueOperation(base::Bind(&SimpleEntryImpl::ReadDataInternal, this,
+                              offset, make_scoped_refptr(buf), buf_len,
+                              callback));
+  return net::ERR_IO_PENDING;
+}
+
+int SimpleEntryImpl::WriteData(int index, int offset, net::IOBuffer* buf,
+                               int buf_len,
+                               const CompletionCallback& callback,
+                               bool truncate) {
+  DCHECK(open_count_);
+  if (index < 0 || index >= kSimpleEntryStreamCount || buf_len < 0)
+    return net::ERR_INVALID_ARGUMENT;
+  if (offset < 0 || offset > kint32max - buf_len)
+    return net::ERR_INVALID_ARGUMENT;
+
+  // The size of the stream changes right away, so that the following calls
+  // see it even before the data is written.
+  int end = offset + buf_len;
+  if (truncate || end > data_size_[index])
+    data_size_[index] = end;
+  last_used_ = last_modified_ = base::Time::Now();
+  modified_ = true;
+
+  if (index != kSimpleLargeStreamIndex) {
+    std::string* data = &stream_data_[index];
+    if (end > static_cast<int>(data->size()))
+      data->resize(end);
+    if (buf_len)
+      memcpy(&(*data)[offset], buf->data(), buf_len);
+    if (truncate)
+      data->resize(end);
+    return buf_len;
+  }
+
+  EnqueueOperation(base::Bind(&SimpleEntryImpl::WriteDataInternal, this,
+                              offset, make_scoped_refptr(buf), buf_len,
+                              truncate, callback));
+  return net::ERR_IO_PENDING;
+}
+
+int SimpleEntryImpl::ReadSparseData(int64 offset, net::IOBuffer* buf,
+                                    int buf_len,
+                                    const CompletionCallback& callback) {
+  return net::ERR_CACHE_OPERATION_NOT_SUPPORTED;
+}
+
+int SimpleEntryImpl::WriteSparseData(int64 offset, net::IOBuffer* buf,
+                                     int buf_len,
+                                     const CompletionCallback& callback) {
+  return net::ERR_CACHE_OPERATION_NOT_SUPPORTED;
+}
+
+int SimpleEntryImpl::GetAvailableRange(int64 offset, int len, int64* start,
+                                       const CompletionCallback& callback) {
+  return net::ERR_CACHE_OPERATION_NOT_SUPPORTED;
+}
+
+bool SimpleEntryImpl::CouldBeSparse() const {
+  return false;
+}
+
+void SimpleEntryImpl::CancelSparseIO() {
+}
+
+int SimpleEntryImpl::ReadyForSparseIO(const CompletionCallback& callback) {
+  return net::OK;
+}
+
+SimpleEntryImpl::~SimpleEntryImpl() {
+  DCHECK(!synchronous_entry_);
+  DCHECK(pending_operations_.empty());
+}
+
+void SimpleEntryImpl::EnqueueOperation(const base::Closure& operation) {
+  pending_operations_.push(operation);
+  RunNextOperationIfNeeded();
+}
+
+void SimpleEntryImpl::RunNextOperationIfNeeded() {
+  if (operation_running_ || pending_operations_.empty())
+    return;
+
+  base::Closure operation = pending_operations_.front();
+  pending_operations_.pop();
+  operation_running_ = true;
+  operation.Run();
+}
+
+void SimpleEntryImpl::ReadDataInternal(int offset,
+                                       scoped_refptr<net::IOBuffer> buf,
+                                       int buf_len,
+                                       const CompletionCallback& callback) {
+  int* result = new int(net::ERR_FAILED);
+  WorkerPool::PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&ReadOnWorkerPool, synchronous_entry_, offset, buf, buf_len,
+                 result),
+      base::Bind(&SimpleEntryImpl::OperationComplete, this, callback,
+                 base::Owned(result)),
+      true);
+}
+
+void SimpleEntryImpl::WriteDataInternal(int offset,
+                                        scoped_refptr<net::IOBuffer> buf,
+                                        int buf_len,
+                                        bool truncate,
+                                        const CompletionCallback& callback) {
+  int* result = new int(net::ERR_FAILED);
+  WorkerPool::PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&WriteOnWorkerPool, synchronous_entry_, offset, buf, buf_len,
+                 truncate, result),
+      base::Bind(&SimpleEntryImpl::OperationComplete, this, callback,
+                 base::Owned(result)),
+      true);
+}
+
+void SimpleEntryImpl::CloseInternal() {
+  DCHECK(pending_operations_.empty());
+  int64* file_size = new int64(-1);
+  bool write_end = modified_ && !doomed_;
+  WorkerPool::PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&CloseOnWorkerPool, synchronous_entry_, write_end,
+                 stream_data_[0], stream_data_[2], path_, hash_, file_size),
+      base::Bind(&SimpleEntryImpl::CloseComplete, this,
+                 base::Owned(file_size)),
+      true);
+  synchronous_entry_ = NULL;
+}
+
+void SimpleEntryImpl::OperationComplete(const CompletionCallback& callback,
+                                        const int* result) {
+  operation_running_ = false;
+  RunNextOperationIfNeeded();
+  if (!callback.is_null())
+    callback.Run(*result);
+}
+
+void SimpleEntryImpl::CloseComplete(const int64* file_size) {
+  operation_running_ = false;
+  if (backend_ && !doomed_)
+    backend_->OnEntryClosed(hash_, *file_size);
+}
+
+}  // namespace disk_cache
@@ -0,0 +1,112 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_ENTRY_IMPL_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_ENTRY_IMPL_H_
+#pragma once
+
+#include <queue>
+#include <string>
+
+#include "base/callback.h"
+#include "base/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time.h"
+#include "net/disk_cache/disk_cache.h"
+#include "net/disk_cache/simple/simple_entry_format.h"
+
+namespace disk_cache {
+
+class SimpleBackendImpl;
+class SimpleSynchronousEntry;
+
+// This class implements the Entry interface for the simple cache, on the IO
+// thread. The operations that need the disk are run one at a time, in order,
+// by a SimpleSynchronousEntry on a worker thread, so different entries do
+// their IO in parallel. The streams other than stream 1 are kept in memory, so
+// accessing them completes synchronously.
+class SimpleEntryImpl : public Entry,
+                        public base::RefCounted<SimpleEntryImpl> {
+ public:
+  // Takes ownership of |synchronous_entry|, that must be open.
+  SimpleEntryImpl(const base::WeakPtr<SimpleBackendImpl>& backend,
+                  const FilePath& path,
+                  uint64 hash,
+                  SimpleSynchronousEntry* synchronous_entry);
+
+  // Called by the backend when the entry is opened again.
+  void Reopen();
+
+  // Called by the backend when the entry is doomed.
+  void MarkAsDoomed();
+
+  uint64 hash() const { return hash_; }
+
+  // Entry interface.
+  virtual void Doom() OVERRIDE;
+  virtual void Close() OVERRIDE;
+  virtual std::string GetKey() const OVERRIDE;
+  virtual base::Time GetLastUsed() const OVERRIDE;
+  virtual base::Time GetLastModified() const OVERRIDE;
+  virtual int32 GetDataSize(int index) const OVERRIDE;
+  virtual int ReadData(int index, int offset, net::IOBuffer* buf, int buf_len,
+                       const CompletionCallback& callback) OVERRIDE;
+  virtual int WriteData(int index, int offset, net::IOBuffer* buf, int buf_len,
+                        const CompletionCallback& callback,
+                        bool truncate) OVERRIDE;
+  virtual int ReadSparseData(int64 offset, net::IOBuffer* buf, int buf_len,
+                             const CompletionCallback& callback) OVERRIDE;
+  virtual int WriteSparseData(int64 offset, net::IOBuffer* buf, int buf_len,
+                              const CompletionCallback& callback) OVERRIDE;
+  virtual int GetAvailableRange(int64 offset, int len, int64* start,
+                                const CompletionCallback& callback) OVERRIDE;
+  virtual bool CouldBeSparse() const OVERRIDE;
+  virtual void CancelSparseIO() OVERRIDE;
+  virtual int ReadyForSparseIO(const CompletionCallback& callback) OVERRIDE;
+
+ private:
+  friend class base::RefCounted<SimpleEntryImpl>;
+
+  virtual ~SimpleEntryImpl();
+
+  // Queues an operation that uses |synchronous_entry_|.
+  void EnqueueOperation(const base::Closure& operation);
+  void RunNextOperationIfNeeded();
+
+  void ReadDataInternal(int offset, scoped_refptr<net::IOBuffer> buf,
+                        int buf_len, const CompletionCallback& callback);
+  void WriteDataInternal(int offset, scoped_refptr<net::IOBuffer> buf,
+                         int buf_len, bool truncate,
+                         const CompletionCallback& callback);
+  void CloseInternal();
+
+  // Called on the IO thread when a read or write completes.
+  void OperationComplete(const CompletionCallback& callback,
+                         const int* result);
+  void CloseComplete(const int64* file_size);
+
+  base::WeakPtr<SimpleBackendImpl> backend_;
+  const FilePath path_;
+  const uint64 hash_;
+  const std::string key_;
+  base::Time last_used_;
+  base::Time last_modified_;
+  int32 data_size_[kSimpleEntryStreamCount];
+  std::string stream_data_[kSimpleEntryStreamCount];
+  bool modified_;
+  bool doomed_;
+  int open_count_;
+
+  // Only used from the worker thread, by one operation at a time.
+  SimpleSynchronousEntry* synchronous_entry_;
+  std::queue<base::Closure> pending_operations_;
+  bool operation_running_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimpleEntryImpl);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_ENTRY_IMPL_H_
@@ -0,0 +1,326 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_index.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/message_loop_proxy.h"
+#include "base/pickle.h"
+#include "net/disk_cache/hash.h"
+#include "net/disk_cache/simple/simple_util.h"
+
+namespace {
+
+const uint64 kSimpleIndexMagicNumber = GG_UINT64_C(0x656e74657220796f);
+const uint32 kSimpleIndexVersion = 1;
+
+const char kIndexDirName[] = "index-dir";
+const char kIndexFileName[] = "the-real-index";
+const char kTempIndexFileName[] = "temp-index";
+
+// Changes are written to disk at most this often.
+const int kWriteToDiskDelaySecs = 20;
+
+bool CompareLastUsed(
+    const std::pair<base::Time, uint64>& a,
+    const std::pair<base::Time, uint64>& b) {
+  return a.first < b.first;
+}
+
+}  // namespace
+
+namespace disk_cache {
+
+SimpleIndex::SimpleIndex(base::MessageLoopProxy* cache_thread,
+                         const FilePath& path)
+    : cache_thread_(cache_thread),
+      path_(path),
+      cache_size_(0),
+      initialized_(false),
+      dirty_(false) {
+}
+
+SimpleIndex::~SimpleIndex() {
+  if (initialized_ && dirty_)
+    WriteToDiskNow();
+}
+
+void SimpleIndex::Initialize() {
+  EntrySet* loaded_entries = new EntrySet;
+  cache_thread_->PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&SimpleIndex::LoadFromDisk, path_, loaded_entries),
+      base::Bind(&SimpleIndex::MergeInitializingSet, AsWeakPtr(),
+                 base::Owned(loaded_entries)));
+}
+
+void SimpleIndex::ExecuteWhenReady(const base::Closure& task) {
+  if (initialized_)
+    task.Run();
+  else
+    to_run_when_initialized_.push_back(task);
+}
+
+void SimpleIndex::Insert(uint64 hash) {
+  if (!initialized_)
+    removed_entries_.erase(hash);
+  if (entries_set_.find(hash) == entries_set_.end())
+    InsertInEntrySet(hash, EntryMetadata(base::Time::Now(), 0));
+  PostponeWritingToDisk();
+}
+
+void SimpleIndex::Remove(uint64 hash) {
+  EntrySet::iterator it = entries_set_.find(hash);
+  if (it != entries_set_.end()) {
+    cache_size_ -= it->second.entry_size;
+    entries_set_.erase(it);
+  }
+  if (!initialized_)
+    removed_entries_.insert(hash);
+  PostponeWritingToDisk();
+}
+
+bool SimpleIndex::Has(uint64 hash) const {
+  return !initialized_ || entries_set_.find(hash) != entries_set_.end();
+}
+
+void SimpleIndex::UseIfExists(uint64 hash) {
+  EntrySet::iterator it = entries_set_.find(hash);
+  if (it == entries_set_.end())
+    return;
+  it->second.last_used_time = base::Time::Now();
+  PostponeWritingToDisk();
+}
+
+void SimpleIndex::UpdateEntrySize(uint64 hash, int64 entry_size) {
+  EntrySet::iterator it = entries_set_.find(hash);
+  if (it == entries_set_.end())
+    return;
+  cache_size_ += entry_size - it->second.entry_size;
+  it->second.entry_size = entry_size;
+  it->second.last_used_time = base::Time::Now();
+  PostponeWritingToDisk();
+}
+
+int32 SimpleIndex::GetEntryCount() const {
+  return static_cast<int32>(entries_set_.size());
+}
+
+void SimpleIndex::GetEntriesBetween(base::Time initial_time,
+                                    base::Time end_time,
+                                    std::vector<uint64>* hashes) const {
+  DCHECK(initialized_);
+  for (EntrySet::const_iterator it = entries_set_.begin();
+       it != entries_set_.end(); ++it) {
+    base::Time last_used = it->second.last_used_time;
+    if (last_used >= initial_time &&
+        (end_time.is_null() || last_used < end_time)) {
+      hashes->push_back(it->first);
+    }
+  }
+}
+
+void SimpleIndex::GetEntriesForEviction(int64 target_size,
+                                        std::vector<uint64>* hashes) const {
+  if (cache_size_ <= target_size)
+    return;
+
+  std::vector<std::pair<base::Time, uint64> > entries;
+  entries.reserve(entries_set_.size());
+  for (EntrySet::const_iterator it = entries_set_.begin();
+       it != entries_set_.end(); ++it) {
+    entries.push_back(std::make_pair(it->second.last_used_time, it->first));
+  }
+  std::sort(entries.begin(), entries.end(), CompareLastUsed);
+
+  int64 size = cache_size_;
+  for (size_t i = 0; i < entries.size() && size > target_size; i++) {
+    size -= entries_set_.find(entries[i].second)->second.entry_size;
+    hashes->push_back(entries[i].second);
+  }
+}
+
+// static
+void SimpleIndex::Serialize(const EntrySet& entries, std::string* data) {
+  Pickle pickle;
+  pickle.WriteUInt64(kSimpleIndexMagicNumber);
+  pickle.WriteUInt32(kSimpleIndexVersion);
+  pickle.WriteUInt64(entries.size());
+  for (EntrySet::const_iterator it = entries.begin(); it != entries.end();
+       ++it) {
+    pickle.WriteUInt64(it->first);
+    pickle.WriteInt64(it->second.last_used_time.ToInternalValue());
+    pickle.WriteInt64(it->second.entry_size);
+  }
+
+  std::string payload(static_cast<const char*>(pickle.data()), pickle.size());
+  Pickle file_pickle;
+  file_pickle.WriteString(payload);
+  file_pickle.WriteUInt32(Hash(payload));
+  data->assign(static_cast<const char*>(file_pickle.data()),
+               file_pickle.size());
+}
+
+// static
+bool SimpleIndex::Deserialize(const std::string& data, EntrySet* entries) {
+  Pickle file_pickle(data.data(), static_cast<int>(data.size()));
+  PickleIterator file_iter(file_pickle);
+  std::string payload;
+  uint32 checksum;
+  if (!file_pickle.ReadString(&file_iter, &payload) ||
+      !file_pickle.ReadUInt32(&file_iter, &checksum) ||
+      checksum != Hash(payload)) {
+    return false;
+  }
+
+  Pickle pickle(payload.data(), static_cast<int>(payload.size()));
+  PickleIterator iter(pickle);
+  uint64 magic_number, num_entries;
+  uint32 version;
+  if (!pickle.ReadUInt64(&iter, &magic_number) ||
+      magic_number != kSimpleIndexMagicNumber ||
+      !pickle.ReadUInt32(&iter, &version) ||
+      version != kSimpleIndexVersion ||
+      !pickle.ReadUInt64(&iter, &num_entries)) {
+    return false;
+  }
+
+  for (uint64 i = 0; i < num_entries; i++) {
+    uint64 hash;
+    int64 last_used, entry_size;
+    if (!pickle.ReadUInt64(&iter, &hash) ||
+        !pickle.ReadInt64(&iter, &last_used) ||
+        !pickle.ReadInt64(&iter, &entry_size) ||
+        entry_size < 0) {
+      entries->clear();
+      return false;
+    }
+    (*entries)[hash] = EntryMetadata(base::Time::FromInternalValue(last_used),
+                                     entry_size);
+  }
+  return true;
+}
+
+// static
+FilePath SimpleIndex::GetIndexFilePath(const FilePath& path) {
+  return path.AppendASCII(kIndexDirName).AppendASCII(kIndexFileName);
+}
+
+// static
+void SimpleIndex::LoadFromDisk(const FilePath& path, EntrySet* entries) {
+  // Creating or deleting an entry file updates the time of the directory, so
+  // an index file written before that is out of date. The index file lives
+  // in a directory of its own so that writing it does not count as a change.
+  FilePath index_file = GetIndexFilePath(path);
+  base::PlatformFileInfo index_info, dir_info;
+  std::string data;
+  if (file_util::GetFileInfo(index_file, &index_info) &&
+      file_util::GetFileInfo(path, &dir_info) &&
+      index_info.last_modified > dir_info.last_modified &&
+      file_util::ReadFileToString(index_file, &data) &&
+      Deserialize(data, entries)) {
+    return;
+  }
+
+  entries->clear();
+  RebuildFromEntryFiles(path, entries);
+}
+
+// static
+void SimpleIndex::RebuildFromEntryFiles(const FilePath& path,
+                                        EntrySet* entries) {
+  file_util::FileEnumerator enumerator(path, false,
+                                       file_util::FileEnumerator::FILES);
+  for (FilePath file = enumerator.Next(); !file.empty();
+       file = enumerator.Next()) {
+    uint64 hash;
+    if (!GetEntryHashFromFilename(file.BaseName().MaybeAsASCII(), &hash))
+      continue;
+    file_util::FileEnumerator::FindInfo info;
+    enumerator.GetFindInfo(&info);
+    (*entries)[hash] = EntryMetadata(
+        file_util::FileEnumerator::GetLastModifiedTime(info),
+        file_util::FileEnumerator::GetFilesize(info));
+  }
+}
+
+// static
+void SimpleIndex::WriteToDisk(const FilePath& path, const std::string& data) {
+  FilePath index_file = GetIndexFilePath(path);
+  FilePath temp_file = index_file.DirName().AppendASCII(kTempIndexFileName);
+  if (!file_util::CreateDirectory(index_file.DirName()))
+    return;
+
+  int size = static_cast<int>(data.size());
+  if (file_util::WriteFile(temp_file, data.data(), size) != size ||
+      !file_util::ReplaceFile(temp_file, index_file)) {
+    LOG(ERROR) << "Unable to write the simple cache index";
+    file_util::Delete(temp_file, false);
+  }
+}
+
+void SimpleIndex::MergeInitializingSet(EntrySet* loaded_entries) {
+  DCHECK(!initialized_);
+  for (base::hash_set<uint64>::const_iterator it = removed_entries_.begin();
+       it != removed_entries_.end(); ++it) {
+    loaded_entries->erase(*it);
+  }
+  removed_entries_.clear();
+
+  // The entries that were used meanwhile are more up to date.
+  for (EntrySet::const_iterator it = entries_set_.begin();
+       it != entries_set_.end(); ++it) {
+    (*loaded_entries)[it->first] = it->second;
+  }
+
+  entries_set_.swap(*loaded_entries);
+  cache_size_ = 0;
+  for (EntrySet::const_iterator it = entries_set_.begin();
+       it != entries_set_.end(); ++it) {
+    cache_size_ += it->second.entry_size;
+  }
+  initialized_ = true;
+
+  // The index may have been rebuilt, so it is worth writing in any case.
+  PostponeWritingToDisk();
+
+  std::vector<base::Closure> to_run;
+  to_run.swap(to_run_when_initialized_);
+  for (size_t i = 0; i < to_run.size(); i++)
+    to_run[i].Run();
+}
+
+void SimpleIndex::InsertInEntrySet(uint64 hash,
+                                   const EntryMetadata& metadata) {
+  entries_set_[hash] = metadata;
+  cache_size_ += metadata.entry_size;
+}
+
+void SimpleIndex::PostponeWritingToDisk() {
+  dirty_ = true;
+  if (!initialized_)
+    return;
+
+  if (!write_to_disk_timer_.IsRunning()) {
+    write_to_disk_timer_.Start(
+        FROM_HERE, base::TimeDelta::FromSeconds(kWriteToDiskDelaySecs), this,
+        &SimpleIndex::WriteToDiskNow);
+  }
+}
+
+void SimpleIndex::WriteToDiskNow() {
+  dirty_ = false;
+  std::string data;
+  Serialize(entries_set_, &data);
+  cache_thread_->PostTask(FROM_HERE,
+                          base::Bind(&SimpleIndex::WriteToDisk, path_, data));
+}
+
+}  // namespace disk_cache
@@ -0,0 +1,126 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_INDEX_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_INDEX_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/file_path.h"
+#include "base/hash_tables.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time.h"
+#include "base/timer.h"
+#include "net/base/net_export.h"
+
+namespace base {
+class MessageLoopProxy;
+}
+
+namespace disk_cache {
+
+// The index of the simple cache keeps the size and the last use of every entry
+// in memory, so that the cache can answer misses, count entries and evict
+// without touching the entry files.
+//
+// The index is written to its own file from time to time, but it is only a
+// hint: when the file is missing, corrupt or older than the cache directory,
+// the index is rebuilt by listing the entry files. The index is used on the IO
+// thread; reading and writing its file happens on the cache thread.
+class NET_EXPORT_PRIVATE SimpleIndex
+    : public base::SupportsWeakPtr<SimpleIndex> {
+ public:
+  struct EntryMetadata {
+    EntryMetadata() : entry_size(0) {}
+    EntryMetadata(base::Time last_used_time, int64 entry_size)
+        : last_used_time(last_used_time), entry_size(entry_size) {}
+
+    base::Time last_used_time;
+    int64 entry_size;
+  };
+  typedef base::hash_map<uint64, EntryMetadata> EntrySet;
+
+  SimpleIndex(base::MessageLoopProxy* cache_thread, const FilePath& path);
+
+  // Writes the index file, if the index changed.
+  ~SimpleIndex();
+
+  // Starts loading the index file, or rebuilding the index.
+  void Initialize();
+
+  bool initialized() const { return initialized_; }
+
+  // Runs |task| once the index is initialized.
+  void ExecuteWhenReady(const base::Closure& task);
+
+  void Insert(uint64 hash);
+  void Remove(uint64 hash);
+
+  // Returns false if there is definitely no entry with the given |hash|.
+  // Until the index is initialized, any entry may exist.
+  bool Has(uint64 hash) const;
+
+  // Marks the entry with the given |hash| as used now, if it is in the index.
+  void UseIfExists(uint64 hash);
+
+  void UpdateEntrySize(uint64 hash, int64 entry_size);
+
+  int32 GetEntryCount() const;
+  int64 cache_size() const { return cache_size_; }
+
+  // Returns the entries last used between |initial_time| (included) and
+  // |end_time| (excluded). A null |end_time| means no limit.
+  void GetEntriesBetween(base::Time initial_time, base::Time end_time,
+                         std::vector<uint64>* hashes) const;
+
+  // Returns the least recently used entries that have to go so that the cache
+  // is no larger than |target_size|, oldest first.
+  void GetEntriesForEviction(int64 target_size,
+                             std::vector<uint64>* hashes) const;
+
+  // Converts |entries| to and from the contents of the index file.
+  static void Serialize(const EntrySet& entries, std::string* data);
+  static bool Deserialize(const std::string& data, EntrySet* entries);
+
+  // Returns the path of the index file for the cache stored in |path|.
+  static FilePath GetIndexFilePath(const FilePath& path);
+
+ private:
+  // Reads the index file, or rebuilds the index from the entry files, on the
+  // cache thread.
+  static void LoadFromDisk(const FilePath& path, EntrySet* entries);
+  static void RebuildFromEntryFiles(const FilePath& path, EntrySet* entries);
+  static void WriteToDisk(const FilePath& path, const std::string& data);
+
+  // Adds the entries loaded from disk to the ones that changed meanwhile.
+  void MergeInitializingSet(EntrySet* loaded_entries);
+
+  void InsertInEntrySet(uint64 hash, const EntryMetadata& metadata);
+  void PostponeWritingToDisk();
+  void WriteToDiskNow();
+
+  scoped_refptr<base::MessageLoopProxy> cache_thread_;
+  const FilePath path_;
+  EntrySet entries_set_;
+  int64 cache_size_;
+
+  bool initialized_;
+  // The entries removed before the index was initialized.
+  base::hash_set<uint64> removed_entries_;
+  std::vector<base::Closure> to_run_when_initialized_;
+
+  bool dirty_;
+  base::OneShotTimer<SimpleIndex> write_to_disk_timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimpleIndex);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_INDEX_H_
@@ -0,0 +1,84 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_index.h"
+
+#include "base/file_path.h"
+#include "base/message_loop.h"
+#include "base/message_loop_proxy.h"
+#include "base/threading/platform_thread.h"
+#include "net/disk_cache/simple/simple_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using disk_cache::SimpleIndex;
+
+TEST(SimpleIndexTest, Serialize) {
+  SimpleIndex::EntrySet entries;
+  base::Time now = base::Time::Now();
+  entries[1] = SimpleIndex::EntryMetadata(now, 100);
+  entries[GG_UINT64_C(0xffffffffffffffff)] =
+      SimpleIndex::EntryMetadata(now - base::TimeDelta::FromDays(1), 2000);
+
+  std::string data;
+  SimpleIndex::Serialize(entries, &data);
+
+  SimpleIndex::EntrySet loaded;
+  ASSERT_TRUE(SimpleIndex::Deserialize(data, &loaded));
+  ASSERT_EQ(2u, loaded.size());
+  EXPECT_EQ(now, loaded[1].last_used_time);
+  EXPECT_EQ(100, loaded[1].entry_size);
+  EXPECT_EQ(2000, loaded[GG_UINT64_C(0xffffffffffffffff)].entry_size);
+
+  // Any change to the file is detected.
+  data[data.size() / 2] ^= 1;
+  loaded.clear();
+  EXPECT_FALSE(SimpleIndex::Deserialize(data, &loaded));
+  EXPECT_FALSE(SimpleIndex::Deserialize(std::string(), &loaded));
+}
+
+TEST(SimpleIndexTest, Eviction) {
+  MessageLoop message_loop;
+  SimpleIndex index(base::MessageLoopProxy::current(),
+                    FilePath(FILE_PATH_LITERAL("unused")));
+
+  // Entries that are not known may exist until the index is loaded.
+  EXPECT_TRUE(index.Has(1));
+
+  for (uint64 hash = 1; hash <= 4; hash++) {
+    index.Insert(hash);
+    index.UpdateEntrySize(hash, 1000);
+    base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(2));
+  }
+  EXPECT_EQ(4, index.GetEntryCount());
+  EXPECT_EQ(4000, index.cache_size());
+
+  // Using an entry moves it to the end of the eviction order.
+  index.UseIfExists(1);
+  std::vector<uint64> hashes;
+  index.GetEntriesForEviction(1500, &hashes);
+  ASSERT_EQ(3u, hashes.size());
+  EXPECT_EQ(2u, hashes[0]);
+  EXPECT_EQ(3u, hashes[1]);
+  EXPECT_EQ(4u, hashes[2]);
+
+  index.Remove(2);
+  EXPECT_EQ(3000, index.cache_size());
+  hashes.clear();
+  index.GetEntriesForEviction(3000, &hashes);
+  EXPECT_TRUE(hashes.empty());
+}
+
+TEST(SimpleIndexTest, EntryFilenames) {
+  uint64 hash = disk_cache::GetEntryHashKey("the first key");
+  EXPECT_NE(hash, disk_cache::GetEntryHashKey("the first Key"));
+
+  std::string filename = disk_cache::GetFilenameFromEntryHash(hash);
+  EXPECT_EQ(16u, filename.size());
+  uint64 parsed_hash;
+  ASSERT_TRUE(disk_cache::GetEntryHashFromFilename(filename, &parsed_hash));
+  EXPECT_EQ(hash, parsed_hash);
+  EXPECT_FALSE(disk_cache::GetEntryHashFromFilename("index", &parsed_hash));
+  EXPECT_FALSE(disk_cache::GetEntryHashFromFilename(filename + "0",
+                                                    &parsed_hash));
+}
@@ -0,0 +1,286 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_synchronous_entry.h"
+
+#include <algorithm>
+
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/hash.h"
+#include "net/disk_cache/simple/simple_util.h"
+
+using base::ClosePlatformFile;
+using base::CreatePlatformFile;
+using base::PlatformFile;
+using base::ReadPlatformFile;
+using base::TruncatePlatformFile;
+using base::WritePlatformFile;
+
+namespace {
+
+const int kFileFlags = base::PLATFORM_FILE_READ | base::PLATFORM_FILE_WRITE |
+                       base::PLATFORM_FILE_SHARE_DELETE;
+
+FilePath GetEntryFilePath(const FilePath& path, uint64 hash) {
+  return path.AppendASCII(disk_cache::GetFilenameFromEntryHash(hash));
+}
+
+bool ReadAll(PlatformFile file, int64 offset, char* data, int size) {
+  return ReadPlatformFile(file, offset, data, size) == size;
+}
+
+bool WriteAll(PlatformFile file, int64 offset, const char* data, int size) {
+  return !size || WritePlatformFile(file, offset, data, size) == size;
+}
+
+}  // namespace
+
+namespace disk_cache {
+
+// static
+SimpleSynchronousEntry* SimpleSynchronousEntry::OpenEntry(
+    const FilePath& path, const std::string& key) {
+  uint64 hash = GetEntryHashKey(key);
+  PlatformFile file = CreatePlatformFile(
+      GetEntryFilePath(path, hash), base::PLATFORM_FILE_OPEN | kFileFlags,
+      NULL, NULL);
+  if (file == base::kInvalidPlatformFileValue)
+    return NULL;
+
+  scoped_ptr<SimpleSynchronousEntry> entry(
+      new SimpleSynchronousEntry(key, file));
+  bool other_key = false;
+  if (!entry->Initialize(&other_key)) {
+    entry.reset();
+    // The file for another key with the same hash is perfectly fine.
+    if (!other_key)
+      DeleteEntryFile(path, hash);
+    return NULL;
+  }
+  return entry.release();
+}
+
+// static
+SimpleSynchronousEntry* SimpleSynchronousEntry::CreateEntry(
+    const FilePath& path, const std::string& key) {
+  uint64 hash = GetEntryHashKey(key);
+  PlatformFile file = CreatePlatformFile(
+      GetEntryFilePath(path, hash), base::PLATFORM_FILE_CREATE | kFileFlags,
+      NULL, NULL);
+  if (file == base::kInvalidPlatformFileValue)
+    return NULL;
+
+  scoped_ptr<SimpleSynchronousEntry> entry(
+      new SimpleSynchronousEntry(key, file));
+  if (!entry->InitializeForCreate()) {
+    entry.reset();
+    DeleteEntryFile(path, hash);
+    return NULL;
+  }
+  return entry.release();
+}
+
+// static
+bool SimpleSynchronousEntry::ReadKey(const FilePath& path, uint64 hash,
+                                     std::string* key) {
+  PlatformFile file = CreatePlatformFile(
+      GetEntryFilePath(path, hash),
+      base::PLATFORM_FILE_OPEN | base::PLATFORM_FILE_READ |
+          base::PLATFORM_FILE_SHARE_DELETE,
+      NULL, NULL);
+  if (file == base::kInvalidPlatformFileValue)
+    return false;
+
+  base::PlatformFileInfo info;
+  SimpleFileHeader header;
+  bool valid =
+      base::GetPlatformFileInfo(file, &info) &&
+      ReadAll(file, 0, reinterpret_cast<char*>(&header), sizeof(header)) &&
+      header.initial_magic_number == kSimpleInitialMagicNumber &&
+      header.version == kSimpleVersion &&
+      header.key_length <= info.size - sizeof(header);
+  if (valid) {
+    scoped_array<char> key_data(new char[header.key_length]);
+    valid = ReadAll(file, sizeof(header), key_data.get(), header.key_length);
+    if (valid)
+      key->assign(key_data.get(), header.key_length);
+  }
+  ClosePlatformFile(file);
+  return valid && header.key_hash == Hash(*key) &&
+      GetEntryHashKey(*key) == hash;
+}
+
+// static
+bool SimpleSynchronousEntry::DeleteEntryFile(const FilePath& path,
+                                             uint64 hash) {
+  return file_util::Delete(GetEntryFilePath(path, hash), false);
+}
+
+SimpleSynchronousEntry::SimpleSynchronousEntry(const std::string& key,
+                                               PlatformFile file)
+    : key_(key),
+      file_(file),
+      modified_(false),
+      file_size_(0) {
+  for (int i = 0; i < kSimpleEntryStreamCount; i++)
+    data_size_[i] = 0;
+}
+
+SimpleSynchronousEntry::~SimpleSynchronousEntry() {
+  ClosePlatformFile(file_);
+}
+
+int SimpleSynchronousEntry::ReadData(int offset, net::IOBuffer* buf,
+                                     int buf_len) {
+  DCHECK_LE(offset + buf_len, data_size_[kSimpleLargeStreamIndex]);
+  int rv = ReadPlatformFile(file_, stream_1_offset() + offset, buf->data(),
+                            buf_len);
+  return rv < 0 ? net::ERR_CACHE_READ_FAILURE : rv;
+}
+
+int SimpleSynchronousEntry::WriteData(int offset, net::IOBuffer* buf,
+                                      int buf_len, bool truncate) {
+  if (!MarkModified())
+    return net::ERR_CACHE_WRITE_FAILURE;
+
+  if (buf_len &&
+      !WriteAll(file_, stream_1_offset() + offset, buf->data(), buf_len)) {
+    return net::ERR_CACHE_WRITE_FAILURE;
+  }
+
+  int32 end = offset + buf_len;
+  int32* size = &data_size_[kSimpleLargeStreamIndex];
+  if (truncate || (!buf_len && end > *size)) {
+    // A write of zero bytes can also extend the stream, with zeros.
+    if (!TruncatePlatformFile(file_, stream_1_offset() + end))
+      return net::ERR_CACHE_WRITE_FAILURE;
+    *size = end;
+  } else {
+    *size = std::max(*size, end);
+  }
+  last_modified_ = base::Time::Now();
+  return buf_len;
+}
+
+bool SimpleSynchronousEntry::WriteEntryEnd(const std::string& stream_0,
+                                           const std::string& stream_2) {
+  if (!MarkModified())
+    return false;
+
+  data_size_[0] = static_cast<int32>(stream_0.size());
+  data_size_[2] = static_cast<int32>(stream_2.size());
+  int64 offset = stream_1_offset() + data_size_[kSimpleLargeStreamIndex];
+  if (!WriteAll(file_, offset, stream_0.data(), data_size_[0]))
+    return false;
+  offset += data_size_[0];
+  if (!WriteAll(file_, offset, stream_2.data(), data_size_[2]))
+    return false;
+  offset += data_size_[2];
+
+  SimpleFileEOF eof = {};
+  eof.final_magic_number = kSimpleFinalMagicNumber;
+  for (int i = 0; i < kSimpleEntryStreamCount; i++)
+    eof.data_size[i] = data_size_[i];
+  if (!WriteAll(file_, offset, reinterpret_cast<const char*>(&eof),
+                sizeof(eof))) {
+    return false;
+  }
+
+  file_size_ = offset + sizeof(eof);
+  modified_ = false;
+  return true;
+}
+
+bool SimpleSynchronousEntry::Initialize(bool* other_key) {
+  base::PlatformFileInfo info;
+  if (!base::GetPlatformFileInfo(file_, &info))
+    return false;
+  file_size_ = info.size;
+  last_modified_ = info.last_modified;
+
+  SimpleFileHeader header;
+  if (file_size_ < static_cast<int64>(sizeof(header) + sizeof(SimpleFileEOF)) ||
+      !ReadAll(file_, 0, reinterpret_cast<char*>(&header), sizeof(header))) {
+    return false;
+  }
+  if (header.initial_magic_number != kSimpleInitialMagicNumber ||
+      header.version != kSimpleVersion) {
+    return false;
+  }
+
+  if (header.key_length != key_.size() || header.key_hash != Hash(key_)) {
+    *other_key = true;
+    return false;
+  }
+  scoped_array<char> key(new char[header.key_length]);
+  if (!ReadAll(file_, sizeof(header), key.get(), header.key_length))
+    return false;
+  if (key_.compare(0, key_.size(), key.get(), header.key_length)) {
+    *other_key = true;
+    return false;
+  }
+
+  SimpleFileEOF eof;
+  if (!ReadAll(file_, file_size_ - sizeof(eof), reinterpret_cast<char*>(&eof),
+               sizeof(eof)) ||
+      eof.final_magic_number != kSimpleFinalMagicNumber) {
+    return false;
+  }
+  int64 expected_size = stream_1_offset() + sizeof(eof);
+  for (int i = 0; i < kSimpleEntryStreamCount; i++) {
+    if (eof.data_size[i] < 0)
+      return false;
+    data_size_[i] = eof.data_size[i];
+    expected_size += data_size_[i];
+  }
+  if (expected_size != file_size_)
+    return false;
+
+  int64 offset = stream_1_offset() + data_size_[kSimpleLargeStreamIndex];
+  for (int i = 0; i < kSimpleEntryStreamCount; i++) {
+    if (i == kSimpleLargeStreamIndex || !data_size_[i])
+      continue;
+    stream_data_[i].resize(data_size_[i]);
+    if (!ReadAll(file_, offset, &stream_data_[i][0], data_size_[i]))
+      return false;
+    offset += data_size_[i];
+  }
+  return true;
+}
+
+bool SimpleSynchronousEntry::InitializeForCreate() {
+  SimpleFileHeader header = {};
+  header.initial_magic_number = kSimpleInitialMagicNumber;
+  header.version = kSimpleVersion;
+  header.key_length = key_.size();
+  header.key_hash = Hash(key_);
+  if (!WriteAll(file_, 0, reinterpret_cast<const char*>(&header),
+                sizeof(header)) ||
+      !WriteAll(file_, sizeof(header), key_.data(), key_.size())) {
+    return false;
+  }
+
+  // An empty entry is valid from the start.
+  modified_ = true;
+  last_modified_ = base::Time::Now();
+  return WriteEntryEnd(std::string(), std::string());
+}
+
+bool SimpleSynchronousEntry::MarkModified() {
+  if (modified_)
+    return true;
+
+  if (!TruncatePlatformFile(
+          file_, stream_1_offset() + data_size_[kSimpleLargeStreamIndex])) {
+    return false;
+  }
+  modified_ = true;
+  return true;
+}
+
+}  // namespace disk_cache
@@ -0,0 +1,101 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_SYNCHRONOUS_ENTRY_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_SYNCHRONOUS_ENTRY_H_
+#pragma once
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/file_path.h"
+#include "base/platform_file.h"
+#include "base/time.h"
+#include "net/base/net_export.h"
+#include "net/disk_cache/simple/simple_entry_format.h"
+
+namespace net {
+class IOBuffer;
+}
+
+namespace disk_cache {
+
+// The part of a simple cache entry that performs the actual disk IO. All the
+// methods of this class block, so they run on a worker thread, and a given
+// object is used by a single thread at a time.
+class NET_EXPORT_PRIVATE SimpleSynchronousEntry {
+ public:
+  // Opens the file of the entry for |key| stored in |path|. Returns NULL if
+  // there is no such entry, or if it is not valid.
+  static SimpleSynchronousEntry* OpenEntry(const FilePath& path,
+                                           const std::string& key);
+
+  // Creates a new file for the entry for |key|. Returns NULL if the entry
+  // already exists, or on failure.
+  static SimpleSynchronousEntry* CreateEntry(const FilePath& path,
+                                             const std::string& key);
+
+  // Reads the key of the entry with the given |hash| stored in |path|, to
+  // enumerate entries that are only known by their hash. Returns false if
+  // there is no such entry, or if its header is not valid.
+  static bool ReadKey(const FilePath& path, uint64 hash, std::string* key);
+
+  // Deletes the file of the entry with the given |hash|. This can be called
+  // while the file is open.
+  static bool DeleteEntryFile(const FilePath& path, uint64 hash);
+
+  // Closes the file, without modifying it.
+  ~SimpleSynchronousEntry();
+
+  // Reads from or writes to stream 1, as Entry::ReadData() and
+  // Entry::WriteData() would.
+  int ReadData(int offset, net::IOBuffer* buf, int buf_len);
+  int WriteData(int offset, net::IOBuffer* buf, int buf_len, bool truncate);
+
+  // Stores the data of the other streams, and makes the file valid again if
+  // it was modified. Returns false on failure, in which case the file should
+  // be deleted.
+  bool WriteEntryEnd(const std::string& stream_0, const std::string& stream_2);
+
+  const std::string& key() const { return key_; }
+  int32 data_size(int index) const { return data_size_[index]; }
+  int64 file_size() const { return file_size_; }
+  base::Time last_modified() const { return last_modified_; }
+
+  // The contents of the streams other than stream 1, loaded when the entry is
+  // opened.
+  std::string* stream_data(int index) { return &stream_data_[index]; }
+
+ private:
+  SimpleSynchronousEntry(const std::string& key, base::PlatformFile file);
+
+  // Loads and verifies the contents of an existing file. |other_key| is set
+  // when the file belongs to another key with the same hash.
+  bool Initialize(bool* other_key);
+
+  // Writes a new header and key.
+  bool InitializeForCreate();
+
+  // Drops everything after stream 1, so that a crash before WriteEntryEnd()
+  // leaves an invalid file.
+  bool MarkModified();
+
+  int64 stream_1_offset() const {
+    return sizeof(SimpleFileHeader) + key_.size();
+  }
+
+  const std::string key_;
+  base::PlatformFile file_;
+  bool modified_;
+  int32 data_size_[kSimpleEntryStreamCount];
+  std::string stream_data_[kSimpleEntryStreamCount];
+  int64 file_size_;
+  base::Time last_modified_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimpleSynchronousEntry);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_SYNCHRONOUS_ENTRY_H_
@@ -0,0 +1,53 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_util.h"
+
+#include <string.h>
+
+#include "base/format_macros.h"
+#include "base/sha1.h"
+#include "base/stringprintf.h"
+
+namespace {
+
+// Entry files are named with the 16 hex digits of the hash of the key.
+const size_t kEntryFilenameLength = 16;
+
+}  // namespace
+
+namespace disk_cache {
+
+uint64 GetEntryHashKey(const std::string& key) {
+  std::string sha_hash = base::SHA1HashString(key);
+  uint64 hash;
+  memcpy(&hash, sha_hash.data(), sizeof(hash));
+  return hash;
+}
+
+std::string GetFilenameFromEntryHash(uint64 hash) {
+  return base::StringPrintf("%016" PRIx64, hash);
+}
+
+bool GetEntryHashFromFilename(const std::string& filename, uint64* hash) {
+  if (filename.size() != kEntryFilenameLength)
+    return false;
+
+  uint64 value = 0;
+  for (size_t i = 0; i < filename.size(); i++) {
+    char c = filename[i];
+    int digit;
+    if (c >= '0' && c <= '9')
+      digit = c - '0';
+    else if (c >= 'a' && c <= 'f')
+      digit = c - 'a' + 10;
+    else
+      return false;
+    value = value << 4 | digit;
+  }
+  *hash = value;
+  return true;
+}
+
+}  // namespace disk_cache
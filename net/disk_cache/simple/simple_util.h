@@ -0,0 +1,29 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_UTIL_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_UTIL_H_
+#pragma once
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "net/base/net_export.h"
+
+namespace disk_cache {
+
+// Returns the 64-bit hash that identifies the entry for |key|.
+NET_EXPORT_PRIVATE uint64 GetEntryHashKey(const std::string& key);
+
+// Returns the name of the file that stores the entry with the given |hash|.
+NET_EXPORT_PRIVATE std::string GetFilenameFromEntryHash(uint64 hash);
+
+// Parses a name returned by GetFilenameFromEntryHash(). Returns false if
+// |filename| is not the name of an entry file.
+NET_EXPORT_PRIVATE bool GetEntryHashFromFilename(const std::string& filename,
+                                                 uint64* hash);
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_UTIL_H_
@@ -37,6 +37,13 @@ const int kMaxEntrySize = 0x100000;
 // The size of each data block (tracked by the child allocation bitmap).
 const int kBlockSize = 1024;
 
+// Sequential reads smaller than this read this much from the children, and
+// serve the next reads from memory.
+const int kReadAheadSize = 64 * 1024;
+
+// Offsets must stay below 64 GB.
+const int64 kMaxSparseOffset = 0x1000000000LL;
+
 // Returns the name of a child entry given the base_name and signature of the
 // parent and the child_id.
 // If the entry is called entry_name, child entries will be named something
@@ -189,7 +196,13 @@ SparseControl::SparseControl(EntryImpl* entry)
       child_(NULL),
       operation_(kNoOperation),
       init_(false),
-      child_map_(child_data_.bitmap, kNumSparseBits, kNumSparseBits / 32) {
+      child_map_(child_data_.bitmap, kNumSparseBits, kNumSparseBits / 32),
+      read_start_(0),
+      user_read_len_(0),
+      last_read_end_(-1),
+      read_ahead_offset_(0),
+      read_ahead_pos_(0),
+      read_ahead_len_(0) {
 }
 
 SparseControl::~SparseControl() {
@@ -241,7 +254,7 @@ int SparseControl::StartIO(SparseOperation op, int64 offset, net::IOBuffer* buf,
     return net::ERR_INVALID_ARGUMENT;
 
   // We only support up to 64 GB.
-  if (offset + buf_len >= 0x1000000000LL || offset + buf_len < 0)
+  if (offset + buf_len >= kMaxSparseOffset || offset + buf_len < 0)
     return net::ERR_CACHE_OPERATION_NOT_SUPPORTED;
 
   DCHECK(!user_buf_);
@@ -250,9 +263,32 @@ int SparseControl::StartIO(SparseOperation op, int64 offset, net::IOBuffer* buf,
   if (!buf && (op == kReadOperation || op == kWriteOperation))
     return 0;
 
+  if (op == kWriteOperation) {
+    // The data kept in memory may be about to change.
+    read_ahead_len_ = 0;
+  } else if (op == kReadOperation && buf_len) {
+    int rv = ReadFromReadAhead(offset, buf, buf_len);
+    if (rv)
+      return rv;
+
+    // Media is usually streamed with many small sequential reads. Read a
+    // bigger piece at once, going into the next child if needed.
+    read_ahead_len_ = 0;
+    if (offset == last_read_end_ && buf_len < kReadAheadSize) {
+      user_read_buf_ = buf;
+      user_read_len_ = buf_len;
+      if (!read_ahead_buf_)
+        read_ahead_buf_ = new net::IOBuffer(kReadAheadSize);
+      buf = read_ahead_buf_;
+      buf_len = static_cast<int>(std::min(
+          static_cast<int64>(kReadAheadSize), kMaxSparseOffset - 1 - offset));
+    }
+  }
+
   // Copy the operation parameters.
   operation_ = op;
   offset_ = offset;
+  read_start_ = offset;
   user_buf_ = buf ? new net::DrainableIOBuffer(buf, buf_len) : NULL;
   buf_len_ = buf_len;
   user_callback_ = callback;
@@ -271,10 +307,11 @@ int SparseControl::StartIO(SparseOperation op, int64 offset, net::IOBuffer* buf,
 
   if (!pending_) {
     // Everything was done synchronously.
+    int rv = FinishRead(offset, result_);
     operation_ = kNoOperation;
     user_buf_ = NULL;
     user_callback_.Reset();
-    return result_;
+    return rv;
   }
 
   return net::ERR_IO_PENDING;
@@ -293,6 +330,21 @@ int SparseControl::GetAvailableRange(int64 offset, int len, int64* start) {
       kGetRangeOperation, offset, NULL, len, CompletionCallback());
   if (range_found_) {
     *start = offset_;
+
+    // Each child reports its own range. When a range runs to the end of a
+    // child, merge it with the one at the start of the next child so that
+    // callers don't split their IO at every child boundary.
+    int64 end = *start + result;
+    while (result > 0 && !(end & (kMaxEntrySize - 1)) && end < offset + len) {
+      range_found_ = false;
+      int next = StartIO(kGetRangeOperation, end, NULL,
+                         static_cast<int>(offset + len - end),
+                         CompletionCallback());
+      if (!range_found_ || next <= 0 || offset_ != end)
+        break;
+      result += next;
+      end += next;
+    }
     return result;
   }
 
@@ -848,14 +900,54 @@ void SparseControl::OnChildIOCompleted(int result) {
   DoChildrenIO();
 }
 
+int SparseControl::ReadFromReadAhead(int64 offset, net::IOBuffer* buf,
+                                     int buf_len) {
+  if (!read_ahead_len_ || offset < read_ahead_offset_ ||
+      offset >= read_ahead_offset_ + read_ahead_len_) {
+    return 0;
+  }
+
+  int skip = static_cast<int>(offset - read_ahead_offset_);
+  int len = std::min(buf_len, read_ahead_len_ - skip);
+  memcpy(buf->data(), read_ahead_buf_->data() + read_ahead_pos_ + skip, len);
+  read_ahead_offset_ += skip + len;
+  read_ahead_pos_ += skip + len;
+  read_ahead_len_ -= skip + len;
+  last_read_end_ = offset + len;
+  return len;
+}
+
+int SparseControl::FinishRead(int64 offset, int result) {
+  if (operation_ != kReadOperation)
+    return result;
+
+  if (user_read_buf_) {
+    // Hand the first part of what was read to the user, and keep the rest.
+    if (result > 0) {
+      int len = std::min(result, user_read_len_);
+      memcpy(user_read_buf_->data(), read_ahead_buf_->data(), len);
+      read_ahead_offset_ = offset + len;
+      read_ahead_pos_ = len;
+      read_ahead_len_ = result - len;
+      result = len;
+    }
+    user_read_buf_ = NULL;
+    user_read_len_ = 0;
+  }
+
+  if (result > 0)
+    last_read_end_ = offset + result;
+  return result;
+}
+
 void SparseControl::DoUserCallback() {
   DCHECK(!user_callback_.is_null());
+  int rv = FinishRead(read_start_, result_);
   CompletionCallback cb = user_callback_;
   user_callback_.Reset();
   user_buf_ = NULL;
   pending_ = false;
   operation_ = kNoOperation;
-  int rv = result_;
   entry_->Release();  // Don't touch object after this line.
   cb.Run(rv);
 }
@@ -143,6 +143,15 @@ class SparseControl {
   // Invoked by the callback of asynchronous operations.
   void OnChildIOCompleted(int result);
 
+  // Copies to |buf| the data kept in memory by an earlier sequential read, if
+  // it starts at |offset|. Returns the number of bytes copied.
+  int ReadFromReadAhead(int64 offset, net::IOBuffer* buf, int buf_len);
+
+  // Completes a read operation that started at |offset| and returned
+  // |result|, handing the user its part of the data read ahead. Returns the
+  // result for the user.
+  int FinishRead(int64 offset, int result);
+
   // Reports to the user that we are done.
   void DoUserCallback();
   void DoAbortCallbacks();
@@ -169,6 +178,20 @@ class SparseControl {
   int child_offset_;  // Offset to use for the current child.
   int child_len_;  // Bytes to read or write for this child.
   int result_;
+  int64 read_start_;  // Sparse offset where the current operation started.
+
+  // Sequential reads go through |read_ahead_buf_| while a read is in
+  // progress; |user_read_buf_| is where the user wants the data.
+  scoped_refptr<net::IOBuffer> user_read_buf_;
+  int user_read_len_;
+  int64 last_read_end_;  // Sparse offset after the last read, or -1.
+
+  // Data read ahead of the user: |read_ahead_len_| bytes for the sparse
+  // offset |read_ahead_offset_|, at |read_ahead_pos_| in |read_ahead_buf_|.
+  scoped_refptr<net::IOBuffer> read_ahead_buf_;
+  int64 read_ahead_offset_;
+  int read_ahead_pos_;
+  int read_ahead_len_;
 
   DISALLOW_COPY_AND_ASSIGN(SparseControl);
 };
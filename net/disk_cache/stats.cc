@@ -60,7 +60,9 @@ static const char* kCounterNames[] = {
   "Fatal error",
   "Last report",
   "Last report timer",
-  "Doom recent entries"
+  "Doom recent entries",
+  "IO queue time",
+  "IO time"
 };
 COMPILE_ASSERT(arraysize(kCounterNames) == disk_cache::Stats::MAX_COUNTER,
                update_the_names);
@@ -179,6 +181,11 @@ void Stats::OnEvent(Counters an_event) {
   counters_[an_event]++;
 }
 
+void Stats::OnEntryIO(base::TimeDelta queue_time, base::TimeDelta io_time) {
+  counters_[IO_QUEUE_TIME] += queue_time.InMicroseconds();
+  counters_[IO_TIME] += io_time.InMicroseconds();
+}
+
 void Stats::SetCounter(Counters counter, int64 value) {
   DCHECK(counter >= MIN_COUNTER && counter < MAX_COUNTER);
   counters_[counter] = value;
@@ -11,6 +11,7 @@
 
 #include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/time.h"
 #include "net/disk_cache/stats_histogram.h"
 
 namespace disk_cache {
@@ -46,6 +47,8 @@ class Stats {
     LAST_REPORT,  // Time of the last time we sent a report.
     LAST_REPORT_TIMER,  // Timer count of the last time we sent a report.
     DOOM_RECENT,  // The cache was partially cleared.
+    IO_QUEUE_TIME,  // Microseconds that entry operations waited to start.
+    IO_TIME,  // Microseconds that entry operations took once started.
     MAX_COUNTER
   };
 
@@ -59,6 +62,10 @@ class Stats {
 
   // Tracks general events.
   void OnEvent(Counters an_event);
+
+  // Tracks the time that an entry operation spent waiting for the cache
+  // thread (|queue_time|), and the time it took from there (|io_time|).
+  void OnEntryIO(base::TimeDelta queue_time, base::TimeDelta io_time);
   void SetCounter(Counters counter, int64 value);
   int64 GetCounter(Counters counter) const;
 
@@ -0,0 +1,457 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/tiered_backend_impl.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/metrics/histogram.h"
+#include "base/string_number_conversions.h"
+#include "base/sys_info.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/backend_impl.h"
+
+namespace {
+
+// An entry is hot once it has been opened this many times.
+const int kOpensToPromote = 2;
+
+// Streams larger than this are never kept in memory.
+const int kMaxHotStreamSize = 64 * 1024;
+
+// The number of keys whose open count is remembered.
+const size_t kMaxOpenCounts = 10000;
+
+// The memory budget is this fraction of the physical memory, within bounds.
+const int kMemoryBudgetDivisor = 512;
+const int kMinMemoryBudget = 2 * 1024 * 1024;
+const int kMaxMemoryBudget = 32 * 1024 * 1024;
+
+}  // namespace
+
+namespace disk_cache {
+
+// This class implements the Entry interface for TieredBackendImpl, forwarding
+// to an entry of the underlying backend. Streams kept in memory are read
+// without going to that entry.
+class TieredEntryImpl : public Entry {
+ public:
+  // Takes ownership of |disk_entry|. |is_hot| tells whether the streams that
+  // are read in full should be kept in memory.
+  TieredEntryImpl(TieredBackendImpl* backend, Entry* disk_entry,
+                  const std::string& key, bool is_hot)
+      : backend_(backend->AsWeakPtr()),
+        disk_entry_(disk_entry),
+        key_(key),
+        is_hot_(is_hot) {
+  }
+
+  // Entry interface.
+  virtual void Doom() OVERRIDE {
+    if (backend_)
+      backend_->OnEntryModified(key_);
+    disk_entry_->Doom();
+  }
+
+  virtual void Close() OVERRIDE {
+    disk_entry_->Close();
+    delete this;
+  }
+
+  virtual std::string GetKey() const OVERRIDE {
+    return key_;
+  }
+
+  virtual base::Time GetLastUsed() const OVERRIDE {
+    return disk_entry_->GetLastUsed();
+  }
+
+  virtual base::Time GetLastModified() const OVERRIDE {
+    return disk_entry_->GetLastModified();
+  }
+
+  virtual int32 GetDataSize(int index) const OVERRIDE {
+    return disk_entry_->GetDataSize(index);
+  }
+
+  virtual int ReadData(int index, int offset, net::IOBuffer* buf, int buf_len,
+                       const CompletionCallback& callback) OVERRIDE {
+    if (!backend_)
+      return disk_entry_->ReadData(index, offset, buf, buf_len, callback);
+
+    int result;
+    bool memory_hit =
+        backend_->ReadHotStream(key_, index, offset, buf, buf_len, &result);
+    if (is_hot_) {
+      UMA_HISTOGRAM_BOOLEAN("DiskCache.TieredBackend.MemoryTierHit",
+                            memory_hit);
+    }
+    if (memory_hit)
+      return result;
+
+    int size = disk_entry_->GetDataSize(index);
+    if (!is_hot_ || callback.is_null() || offset != 0 || buf_len < size ||
+        size <= 0 || size > kMaxHotStreamSize ||
+        index >= TieredBackendImpl::kNumStreams) {
+      return disk_entry_->ReadData(index, offset, buf, buf_len, callback);
+    }
+
+    // The whole stream is being read; keep it once it arrives.
+    int64 write_generation = backend_->write_generation_;
+    result = disk_entry_->ReadData(
+        index, offset, buf, buf_len,
+        base::Bind(&TieredBackendImpl::OnStreamRead, backend_, key_, index,
+                   make_scoped_refptr(buf), write_generation, callback));
+    if (result > 0)
+      backend_->StoreHotStream(key_, index, buf, result, write_generation);
+    return result;
+  }
+
+  virtual int WriteData(int index, int offset, net::IOBuffer* buf, int buf_len,
+                        const CompletionCallback& callback,
+                        bool truncate) OVERRIDE {
+    if (backend_)
+      backend_->OnEntryModified(key_);
+    return disk_entry_->WriteData(index, offset, buf, buf_len, callback,
+                                  truncate);
+  }
+
+  virtual int ReadSparseData(int64 offset, net::IOBuffer* buf, int buf_len,
+                             const CompletionCallback& callback) OVERRIDE {
+    return disk_entry_->ReadSparseData(offset, buf, buf_len, callback);
+  }
+
+  virtual int WriteSparseData(int64 offset, net::IOBuffer* buf, int buf_len,
+                              const CompletionCallback& callback) OVERRIDE {
+    if (backend_)
+      backend_->OnEntryModified(key_);
+    return disk_entry_->WriteSparseData(offset, buf, buf_len, callback);
+  }
+
+  virtual int GetAvailableRange(int64 offset, int len, int64* start,
+                                const CompletionCallback& callback) OVERRIDE {
+    return disk_entry_->GetAvailableRange(offset, len, start, callback);
+  }
+
+  virtual bool CouldBeSparse() const OVERRIDE {
+    return disk_entry_->CouldBeSparse();
+  }
+
+  virtual void CancelSparseIO() OVERRIDE {
+    disk_entry_->CancelSparseIO();
+  }
+
+  virtual int ReadyForSparseIO(const CompletionCallback& callback) OVERRIDE {
+    return disk_entry_->ReadyForSparseIO(callback);
+  }
+
+ private:
+  virtual ~TieredEntryImpl() {}
+
+  base::WeakPtr<TieredBackendImpl> backend_;
+  Entry* disk_entry_;
+  std::string key_;
+  bool is_hot_;
+
+  DISALLOW_COPY_AND_ASSIGN(TieredEntryImpl);
+};
+
+namespace {
+
+// Creates a BackendImpl and wraps it in a TieredBackendImpl. This object
+// deletes itself when done.
+class TieredBackendCreator {
+ public:
+  TieredBackendCreator(Backend** backend,
+                       const net::CompletionCallback& callback)
+      : backend_(backend),
+        callback_(callback),
+        disk_backend_(NULL) {
+  }
+
+  int Run(const FilePath& path, bool force, int max_bytes,
+          net::CacheType type, base::MessageLoopProxy* thread,
+          net::NetLog* net_log) {
+    int rv = BackendImpl::CreateBackend(
+        path, force, max_bytes, type, kNone, thread, net_log, &disk_backend_,
+        base::Bind(&TieredBackendCreator::OnIOComplete,
+                   base::Unretained(this)));
+    if (rv == net::ERR_IO_PENDING)
+      return rv;
+    rv = Finish(rv);
+    delete this;
+    return rv;
+  }
+
+ private:
+  void OnIOComplete(int result) {
+    net::CompletionCallback callback = callback_;
+    result = Finish(result);
+    delete this;
+    callback.Run(result);
+  }
+
+  int Finish(int result) {
+    if (result == net::OK) {
+      *backend_ = new TieredBackendImpl(
+          disk_backend_, TieredBackendImpl::GetDefaultMemoryBudget());
+    }
+    return result;
+  }
+
+  Backend** backend_;
+  net::CompletionCallback callback_;
+  Backend* disk_backend_;
+
+  DISALLOW_COPY_AND_ASSIGN(TieredBackendCreator);
+};
+
+}  // namespace
+
+TieredBackendImpl::HotEntry::HotEntry() {
+  std::fill(has_stream, has_stream + kNumStreams, false);
+}
+
+TieredBackendImpl::HotEntry::~HotEntry() {
+}
+
+TieredBackendImpl::TieredBackendImpl(Backend* disk_backend, int memory_budget)
+    : disk_backend_(disk_backend),
+      memory_budget_(memory_budget),
+      memory_size_(0),
+      write_generation_(0) {
+  DCHECK(disk_backend);
+}
+
+TieredBackendImpl::~TieredBackendImpl() {
+}
+
+// static
+int TieredBackendImpl::CreateBackend(const FilePath& path, bool force,
+                                     int max_bytes, net::CacheType type,
+                                     base::MessageLoopProxy* thread,
+                                     net::NetLog* net_log, Backend** backend,
+                                     const CompletionCallback& callback) {
+  TieredBackendCreator* creator = new TieredBackendCreator(backend, callback);
+  return creator->Run(path, force, max_bytes, type, thread, net_log);
+}
+
+// static
+int TieredBackendImpl::GetDefaultMemoryBudget() {
+  int64 budget =
+      base::SysInfo::AmountOfPhysicalMemory() / kMemoryBudgetDivisor;
+  return static_cast<int>(std::max<int64>(
+      kMinMemoryBudget, std::min<int64>(kMaxMemoryBudget, budget)));
+}
+
+int32 TieredBackendImpl::GetEntryCount() const {
+  return disk_backend_->GetEntryCount();
+}
+
+int TieredBackendImpl::OpenEntry(const std::string& key, Entry** entry,
+                                 const CompletionCallback& callback) {
+  int rv = disk_backend_->OpenEntry(
+      key, entry,
+      base::Bind(&TieredBackendImpl::OnEntryOpened, AsWeakPtr(), key, true,
+                 entry, callback));
+  if (rv == net::OK)
+    WrapEntry(key, true, entry);
+  return rv;
+}
+
+int TieredBackendImpl::CreateEntry(const std::string& key, Entry** entry,
+                                   const CompletionCallback& callback) {
+  // A created entry starts empty, and its reuse is counted from scratch.
+  OnEntryModified(key);
+  open_counts_.erase(key);
+  int rv = disk_backend_->CreateEntry(
+      key, entry,
+      base::Bind(&TieredBackendImpl::OnEntryOpened, AsWeakPtr(), key, false,
+                 entry, callback));
+  if (rv == net::OK)
+    WrapEntry(key, false, entry);
+  return rv;
+}
+
+int TieredBackendImpl::DoomEntry(const std::string& key,
+                                 const CompletionCallback& callback) {
+  OnEntryModified(key);
+  return disk_backend_->DoomEntry(key, callback);
+}
+
+int TieredBackendImpl::DoomAllEntries(const CompletionCallback& callback) {
+  DropAllHotEntries();
+  return disk_backend_->DoomAllEntries(callback);
+}
+
+int TieredBackendImpl::DoomEntriesBetween(base::Time initial_time,
+                                          base::Time end_time,
+                                          const CompletionCallback& callback) {
+  DropAllHotEntries();
+  return disk_backend_->DoomEntriesBetween(initial_time, end_time, callback);
+}
+
+int TieredBackendImpl::DoomEntriesSince(base::Time initial_time,
+                                        const CompletionCallback& callback) {
+  DropAllHotEntries();
+  return disk_backend_->DoomEntriesSince(initial_time, callback);
+}
+
+int TieredBackendImpl::OpenNextEntry(void** iter, Entry** next_entry,
+                                     const CompletionCallback& callback) {
+  int rv = disk_backend_->OpenNextEntry(
+      iter, next_entry,
+      base::Bind(&TieredBackendImpl::OnEnumeratedEntryOpened, AsWeakPtr(),
+                 next_entry, callback));
+  if (rv == net::OK)
+    WrapEntry((*next_entry)->GetKey(), false, next_entry);
+  return rv;
+}
+
+void TieredBackendImpl::EndEnumeration(void** iter) {
+  disk_backend_->EndEnumeration(iter);
+}
+
+void TieredBackendImpl::GetStats(
+    std::vector<std::pair<std::string, std::string> >* stats) {
+  disk_backend_->GetStats(stats);
+  stats->push_back(std::make_pair(std::string("Hot entries"),
+                                  base::IntToString(hot_entries_.size())));
+  stats->push_back(std::make_pair(std::string("Hot entry bytes"),
+                                  base::IntToString(memory_size_)));
+}
+
+void TieredBackendImpl::OnExternalCacheHit(const std::string& key) {
+  disk_backend_->OnExternalCacheHit(key);
+}
+
+// static
+void TieredBackendImpl::OnEntryOpened(
+    const base::WeakPtr<TieredBackendImpl>& backend,
+    const std::string& key,
+    bool count_open,
+    Entry** entry,
+    const CompletionCallback& callback,
+    int result) {
+  if (result == net::OK && backend)
+    backend->WrapEntry(key, count_open, entry);
+  callback.Run(result);
+}
+
+// static
+void TieredBackendImpl::OnEnumeratedEntryOpened(
+    const base::WeakPtr<TieredBackendImpl>& backend,
+    Entry** entry,
+    const CompletionCallback& callback,
+    int result) {
+  if (result == net::OK && backend)
+    backend->WrapEntry((*entry)->GetKey(), false, entry);
+  callback.Run(result);
+}
+
+void TieredBackendImpl::WrapEntry(const std::string& key, bool count_open,
+                                  Entry** entry) {
+  bool is_hot = false;
+  if (count_open) {
+    if (open_counts_.size() >= kMaxOpenCounts &&
+        open_counts_.find(key) == open_counts_.end()) {
+      open_counts_.clear();
+    }
+    is_hot = ++open_counts_[key] >= kOpensToPromote;
+  }
+  *entry = new TieredEntryImpl(this, *entry, key, is_hot);
+}
+
+// static
+void TieredBackendImpl::OnStreamRead(
+    const base::WeakPtr<TieredBackendImpl>& backend,
+    const std::string& key,
+    int index,
+    scoped_refptr<net::IOBuffer> buf,
+    int64 write_generation,
+    const CompletionCallback& callback,
+    int result) {
+  if (result > 0 && backend)
+    backend->StoreHotStream(key, index, buf, result, write_generation);
+  callback.Run(result);
+}
+
+bool TieredBackendImpl::ReadHotStream(const std::string& key, int index,
+                                      int offset, net::IOBuffer* buf,
+                                      int buf_len, int* result) {
+  if (index < 0 || index >= kNumStreams || offset < 0 || buf_len < 0)
+    return false;
+
+  HotEntryMap::iterator it = hot_entries_.find(key);
+  if (it == hot_entries_.end() || !it->second.has_stream[index])
+    return false;
+
+  HotEntry& hot_entry = it->second;
+  lru_list_.splice(lru_list_.begin(), lru_list_, hot_entry.lru_position);
+
+  const std::string& stream = hot_entry.streams[index];
+  int stream_size = static_cast<int>(stream.size());
+  if (offset >= stream_size) {
+    *result = 0;
+    return true;
+  }
+  *result = std::min(buf_len, stream_size - offset);
+  memcpy(buf->data(), stream.data() + offset, *result);
+  return true;
+}
+
+void TieredBackendImpl::StoreHotStream(const std::string& key, int index,
+                                       net::IOBuffer* buf, int size,
+                                       int64 write_generation) {
+  if (write_generation != write_generation_ || size > memory_budget_)
+    return;
+
+  HotEntryMap::iterator it = hot_entries_.find(key);
+  if (it == hot_entries_.end()) {
+    it = hot_entries_.insert(std::make_pair(key, HotEntry())).first;
+    lru_list_.push_front(key);
+    it->second.lru_position = lru_list_.begin();
+  }
+  HotEntry& hot_entry = it->second;
+  memory_size_ -= static_cast<int>(hot_entry.streams[index].size());
+  hot_entry.streams[index].assign(buf->data(), size);
+  hot_entry.has_stream[index] = true;
+  memory_size_ += size;
+  TrimToBudget();
+}
+
+void TieredBackendImpl::DropHotEntry(const std::string& key) {
+  HotEntryMap::iterator it = hot_entries_.find(key);
+  if (it == hot_entries_.end())
+    return;
+
+  for (int i = 0; i < kNumStreams; ++i)
+    memory_size_ -= static_cast<int>(it->second.streams[i].size());
+  lru_list_.erase(it->second.lru_position);
+  hot_entries_.erase(it);
+}
+
+void TieredBackendImpl::DropAllHotEntries() {
+  ++write_generation_;
+  hot_entries_.clear();
+  lru_list_.clear();
+  memory_size_ = 0;
+}
+
+void TieredBackendImpl::OnEntryModified(const std::string& key) {
+  ++write_generation_;
+  DropHotEntry(key);
+}
+
+void TieredBackendImpl::TrimToBudget() {
+  while (memory_size_ > memory_budget_ && !lru_list_.empty()) {
+    std::string key = lru_list_.back();
+    DropHotEntry(key);
+  }
+}
+
+}  // namespace disk_cache
@@ -0,0 +1,168 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_TIERED_BACKEND_IMPL_H_
+#define NET_DISK_CACHE_TIERED_BACKEND_IMPL_H_
+#pragma once
+
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "base/hash_tables.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "net/base/net_export.h"
+#include "net/disk_cache/disk_cache.h"
+
+class FilePath;
+
+namespace base {
+class MessageLoopProxy;
+}
+
+namespace disk_cache {
+
+class TieredEntryImpl;
+
+// This class implements the Backend interface on top of another backend,
+// usually a BackendImpl, keeping the data of hot entries in memory. An entry
+// becomes hot once it has been opened a few times; its small streams (the
+// response headers, small bodies and metadata) are then kept when they are
+// read in full, and later reads are served from memory without a trip to the
+// cache thread. Writes always go to the underlying backend and drop the copy
+// in memory, so the two tiers never disagree. The copies are evicted in LRU
+// order to stay within a memory budget.
+class NET_EXPORT_PRIVATE TieredBackendImpl
+    : public Backend,
+      public base::SupportsWeakPtr<TieredBackendImpl> {
+ public:
+  // Takes ownership of |disk_backend|. |memory_budget| is the maximum number
+  // of bytes of entry data kept in memory.
+  TieredBackendImpl(Backend* disk_backend, int memory_budget);
+  virtual ~TieredBackendImpl();
+
+  // Creates a block file cache, as disk_cache::CreateCacheBackend() would,
+  // behind a memory tier sized by GetDefaultMemoryBudget().
+  static int CreateBackend(const FilePath& path, bool force, int max_bytes,
+                           net::CacheType type,
+                           base::MessageLoopProxy* thread,
+                           net::NetLog* net_log, Backend** backend,
+                           const CompletionCallback& callback);
+
+  // Returns the memory budget to use on this machine, which grows with the
+  // amount of physical memory.
+  static int GetDefaultMemoryBudget();
+
+  int memory_budget() const { return memory_budget_; }
+  int memory_size() const { return memory_size_; }
+
+  // Backend interface.
+  virtual int32 GetEntryCount() const OVERRIDE;
+  virtual int OpenEntry(const std::string& key, Entry** entry,
+                        const CompletionCallback& callback) OVERRIDE;
+  virtual int CreateEntry(const std::string& key, Entry** entry,
+                          const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntry(const std::string& key,
+                        const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomAllEntries(const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesBetween(base::Time initial_time,
+                                 base::Time end_time,
+                                 const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesSince(base::Time initial_time,
+                               const CompletionCallback& callback) OVERRIDE;
+  virtual int OpenNextEntry(void** iter, Entry** next_entry,
+                            const CompletionCallback& callback) OVERRIDE;
+  virtual void EndEnumeration(void** iter) OVERRIDE;
+  virtual void GetStats(
+      std::vector<std::pair<std::string, std::string> >* stats) OVERRIDE;
+  virtual void OnExternalCacheHit(const std::string& key) OVERRIDE;
+
+ private:
+  friend class TieredEntryImpl;
+
+  // The in-memory copy of an entry. A stream is only present when it was read
+  // in full.
+  enum { kNumStreams = 3 };
+  struct HotEntry {
+    HotEntry();
+    ~HotEntry();
+
+    bool has_stream[kNumStreams];
+    std::string streams[kNumStreams];
+    std::list<std::string>::iterator lru_position;
+  };
+
+  typedef base::hash_map<std::string, HotEntry> HotEntryMap;
+  typedef base::hash_map<std::string, int> OpenCountMap;
+
+  // Wraps the underlying |*entry|, once opened or created, in a
+  // TieredEntryImpl. |count_open| tells whether this counts as a reuse of
+  // |key|.
+  static void OnEntryOpened(const base::WeakPtr<TieredBackendImpl>& backend,
+                            const std::string& key,
+                            bool count_open,
+                            Entry** entry,
+                            const CompletionCallback& callback,
+                            int result);
+  static void OnEnumeratedEntryOpened(
+      const base::WeakPtr<TieredBackendImpl>& backend,
+      Entry** entry,
+      const CompletionCallback& callback,
+      int result);
+  void WrapEntry(const std::string& key, bool count_open, Entry** entry);
+
+  // Called when the read of a whole stream from the underlying entry
+  // completes, to keep it in memory. |result| is the size of the stream.
+  static void OnStreamRead(const base::WeakPtr<TieredBackendImpl>& backend,
+                           const std::string& key,
+                           int index,
+                           scoped_refptr<net::IOBuffer> buf,
+                           int64 write_generation,
+                           const CompletionCallback& callback,
+                           int result);
+
+  // Copies from the in-memory stream |index| of |key| into |buf|. Returns
+  // false if that stream is not in memory.
+  bool ReadHotStream(const std::string& key, int index, int offset,
+                     net::IOBuffer* buf, int buf_len, int* result);
+
+  // Keeps |size| bytes of |buf| as stream |index| of |key|, unless the entry
+  // was written since |write_generation|.
+  void StoreHotStream(const std::string& key, int index, net::IOBuffer* buf,
+                      int size, int64 write_generation);
+
+  // Drops the in-memory copy of |key|, or of all entries.
+  void DropHotEntry(const std::string& key);
+  void DropAllHotEntries();
+
+  // Called before the data of an entry changes.
+  void OnEntryModified(const std::string& key);
+
+  // Evicts least recently used entries until the budget is met.
+  void TrimToBudget();
+
+  scoped_ptr<Backend> disk_backend_;
+  const int memory_budget_;
+  int memory_size_;
+
+  // Incremented whenever entry data changes, so that a read that started
+  // before the change is not kept in memory.
+  int64 write_generation_;
+
+  HotEntryMap hot_entries_;
+  std::list<std::string> lru_list_;  // Most recently used first.
+
+  // How many times each recently seen key was opened.
+  OpenCountMap open_counts_;
+
+  DISALLOW_COPY_AND_ASSIGN(TieredBackendImpl);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_TIERED_BACKEND_IMPL_H_
@@ -0,0 +1,106 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/tiered_backend_impl.h"
+
+#include <string>
+
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/mem_backend_impl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kMemoryBudget = 1024;
+
+// The memory backend completes every operation synchronously, which keeps
+// these tests free of callbacks.
+class DiskCacheTieredBackendTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    backend_.reset(new disk_cache::TieredBackendImpl(
+        disk_cache::MemBackendImpl::CreateBackend(1024 * 1024, NULL),
+        kMemoryBudget));
+  }
+
+  void WriteEntry(const std::string& key, const std::string& data) {
+    disk_cache::Entry* entry = NULL;
+    if (backend_->OpenEntry(key, &entry, net::CompletionCallback()) !=
+        net::OK) {
+      ASSERT_EQ(net::OK, backend_->CreateEntry(key, &entry,
+                                               net::CompletionCallback()));
+    }
+    scoped_refptr<net::StringIOBuffer> buf(new net::StringIOBuffer(data));
+    EXPECT_EQ(static_cast<int>(data.size()),
+              entry->WriteData(0, 0, buf, buf->size(),
+                               net::CompletionCallback(), true));
+    entry->Close();
+  }
+
+  // Opens |key| and reads all of its first stream.
+  std::string ReadEntry(const std::string& key) {
+    disk_cache::Entry* entry = NULL;
+    EXPECT_EQ(net::OK,
+              backend_->OpenEntry(key, &entry, net::CompletionCallback()));
+    if (!entry)
+      return std::string();
+    int size = entry->GetDataSize(0);
+    scoped_refptr<net::IOBuffer> buf(new net::IOBuffer(size));
+    EXPECT_EQ(size,
+              entry->ReadData(0, 0, buf, size, net::CompletionCallback()));
+    entry->Close();
+    return std::string(buf->data(), size);
+  }
+
+  scoped_ptr<disk_cache::TieredBackendImpl> backend_;
+};
+
+}  // namespace
+
+TEST_F(DiskCacheTieredBackendTest, PromotesReusedEntries) {
+  WriteEntry("key", "some data");
+
+  // The first open does not make the entry hot.
+  EXPECT_EQ("some data", ReadEntry("key"));
+  EXPECT_EQ(0, backend_->memory_size());
+
+  EXPECT_EQ("some data", ReadEntry("key"));
+  EXPECT_EQ(9, backend_->memory_size());
+
+  // Now served from memory.
+  EXPECT_EQ("some data", ReadEntry("key"));
+  EXPECT_EQ(9, backend_->memory_size());
+}
+
+TEST_F(DiskCacheTieredBackendTest, WritesDropHotCopy) {
+  WriteEntry("key", "old");
+  ReadEntry("key");
+  ReadEntry("key");
+  EXPECT_EQ(3, backend_->memory_size());
+
+  WriteEntry("key", "new data");
+  EXPECT_EQ(0, backend_->memory_size());
+  EXPECT_EQ("new data", ReadEntry("key"));
+
+  EXPECT_EQ(net::OK, backend_->DoomEntry("key", net::CompletionCallback()));
+  EXPECT_EQ(0, backend_->memory_size());
+}
+
+TEST_F(DiskCacheTieredBackendTest, StaysWithinBudget) {
+  std::string data(kMemoryBudget / 2, 'a');
+  for (int i = 0; i < 4; ++i) {
+    std::string key(1, 'a' + i);
+    WriteEntry(key, data);
+    ReadEntry(key);
+    ReadEntry(key);
+    EXPECT_LE(backend_->memory_size(), backend_->memory_budget());
+  }
+  EXPECT_EQ(kMemoryBudget, backend_->memory_size());
+
+  // The least recently used entries were evicted, but are still on disk.
+  EXPECT_EQ(data, ReadEntry("a"));
+}
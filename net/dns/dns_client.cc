@@ -28,7 +28,10 @@ class DnsClientImpl : public DnsClient {
                                 ClientSocketFactory::GetDefaultFactory(),
                                 base::Bind(&base::RandInt),
                                 net_log_);
-      factory_ = DnsTransactionFactory::CreateFactory(session_);
+      // Jobs of HostResolverImpl for different address families or flags
+      // send the same queries.
+      factory_ = DnsTransactionFactory::CreateCoalescingFactory(
+          DnsTransactionFactory::CreateFactory(session_));
     }
   }
 
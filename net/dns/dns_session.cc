@@ -4,8 +4,11 @@
 
 #include "net/dns/dns_session.h"
 
+#include <algorithm>
+
 #include "base/basictypes.h"
 #include "base/bind.h"
+#include "base/logging.h"
 #include "base/time.h"
 #include "net/base/ip_endpoint.h"
 #include "net/dns/dns_config_service.h"
@@ -13,6 +16,17 @@
 
 namespace net {
 
+namespace {
+
+// Timeouts derived from the round-trip time are kept between this value and
+// the timeout set by the DnsConfig.
+const int kMinTimeoutMs = 100;
+
+}  // namespace
+
+DnsSession::ServerStats::ServerStats() : has_rtt(false), num_lost(0) {
+}
+
 DnsSession::DnsSession(const DnsConfig& config,
                        ClientSocketFactory* factory,
                        const RandIntCallback& rand_int_callback,
@@ -21,7 +35,8 @@ DnsSession::DnsSession(const DnsConfig& config,
       socket_factory_(factory),
       rand_callback_(base::Bind(rand_int_callback, 0, kuint16max)),
       net_log_(net_log),
-      server_index_(0) {
+      server_index_(0),
+      server_stats_(config.nameservers.size()) {
 }
 
 int DnsSession::NextQueryId() const {
@@ -32,13 +47,54 @@ int DnsSession::NextFirstServerIndex() {
   int index = server_index_;
   if (config_.rotate)
     server_index_ = (server_index_ + 1) % config_.nameservers.size();
-  return index;
+
+  // Fail over to the next server that lost the fewest queries in a row.
+  int num_servers = config_.nameservers.size();
+  int best_index = index;
+  for (int i = 1; i < num_servers; ++i) {
+    int candidate = (index + i) % num_servers;
+    if (server_stats_[candidate].num_lost < server_stats_[best_index].num_lost)
+      best_index = candidate;
+  }
+  return best_index;
 }
 
-base::TimeDelta DnsSession::NextTimeout(int attempt) {
+base::TimeDelta DnsSession::NextTimeout(int server_index, int attempt) {
+  DCHECK_LT(static_cast<size_t>(server_index), server_stats_.size());
+  const ServerStats& stats = server_stats_[server_index];
+  base::TimeDelta timeout = config_.timeout;
+  if (stats.has_rtt) {
+    base::TimeDelta rtt_timeout = std::max(
+        base::TimeDelta::FromMilliseconds(kMinTimeoutMs),
+        stats.rtt_estimate + 4 * stats.rtt_deviation);
+    timeout = std::min(timeout, rtt_timeout);
+  }
   // The timeout doubles every full round (each nameserver once).
-  // TODO(szym): Adapt timeout to observed RTT. http://crbug.com/110197
-  return config_.timeout * (1 << (attempt / config_.nameservers.size()));
+  return timeout * (1 << (attempt / config_.nameservers.size()));
+}
+
+void DnsSession::RecordRTT(int server_index, base::TimeDelta rtt) {
+  DCHECK_LT(static_cast<size_t>(server_index), server_stats_.size());
+  ServerStats& stats = server_stats_[server_index];
+  if (stats.has_rtt) {
+    base::TimeDelta error = rtt - stats.rtt_estimate;
+    if (error < base::TimeDelta())
+      error = -error;
+    stats.rtt_deviation = (3 * stats.rtt_deviation + error) / 4;
+    stats.rtt_estimate = (7 * stats.rtt_estimate + rtt) / 8;
+  } else {
+    stats.has_rtt = true;
+    stats.rtt_estimate = rtt;
+    stats.rtt_deviation = rtt / 2;
+  }
+  stats.num_lost = 0;
+}
+
+void DnsSession::RecordLostPacket(int server_index) {
+  DCHECK_LT(static_cast<size_t>(server_index), server_stats_.size());
+  ServerStats& stats = server_stats_[server_index];
+  if (stats.num_lost < kint32max)
+    ++stats.num_lost;
 }
 
 DnsSession::~DnsSession() {}
@@ -6,6 +6,8 @@
 #define NET_DNS_DNS_SESSION_H_
 #pragma once
 
+#include <vector>
+
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/time.h"
@@ -40,13 +42,33 @@ class NET_EXPORT_PRIVATE DnsSession
   int NextQueryId() const;
 
   // Return the index of the first configured server to use on first attempt.
+  // Servers that lost more of their last queries than the others are skipped.
   int NextFirstServerIndex();
 
-  // Return the timeout for the next query.
-  base::TimeDelta NextTimeout(int attempt);
+  // Return the timeout for the next query, which is the |attempt|-th one of
+  // its transaction and is sent to the server at |server_index|.
+  base::TimeDelta NextTimeout(int server_index, int attempt);
+
+  // Record that the server at |server_index| answered a query after |rtt|.
+  void RecordRTT(int server_index, base::TimeDelta rtt);
+
+  // Record that the server at |server_index| did not answer a query in time.
+  void RecordLostPacket(int server_index);
 
  private:
   friend class base::RefCounted<DnsSession>;
+
+  // Round-trip time estimates of a server, as in RFC 2988.
+  struct ServerStats {
+    ServerStats();
+
+    bool has_rtt;
+    base::TimeDelta rtt_estimate;
+    base::TimeDelta rtt_deviation;
+    // Number of queries lost in a row.
+    int num_lost;
+  };
+
   ~DnsSession();
 
   const DnsConfig config_;
@@ -57,7 +79,9 @@ class NET_EXPORT_PRIVATE DnsSession
   // Current index into |config_.nameservers| to begin resolution with.
   int server_index_;
 
-  // TODO(szym): Add current RTT estimate.
+  // Indexed like |config_.nameservers|.
+  std::vector<ServerStats> server_stats_;
+
   // TODO(szym): Add TCP connection pool to support DNS over TCP.
   // TODO(szym): Add UDP port pool to avoid NAT table overload.
 
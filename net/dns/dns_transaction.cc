@@ -5,7 +5,10 @@
 #include "net/dns/dns_transaction.h"
 
 #include <deque>
+#include <list>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/bind.h"
@@ -18,6 +21,7 @@
 #include "base/stl_util.h"
 #include "base/string_piece.h"
 #include "base/threading/non_thread_safe.h"
+#include "base/time.h"
 #include "base/timer.h"
 #include "base/values.h"
 #include "net/base/completion_callback.h"
@@ -101,11 +105,13 @@ class ResponseParameters : public NetLog::EventParameters {
 class DnsUDPAttempt {
  public:
   DnsUDPAttempt(scoped_ptr<DatagramClientSocket> socket,
+                unsigned server_index,
                 const IPEndPoint& server,
                 scoped_ptr<DnsQuery> query,
                 const CompletionCallback& callback)
       : next_state_(STATE_NONE),
         socket_(socket.Pass()),
+        server_index_(server_index),
         server_(server),
         query_(query.Pass()),
         callback_(callback) {
@@ -116,9 +122,20 @@ class DnsUDPAttempt {
   int Start() {
     DCHECK_EQ(STATE_NONE, next_state_);
     next_state_ = STATE_CONNECT;
+    start_time_ = base::TimeTicks::Now();
     return DoLoop(OK);
   }
 
+  // Returns the index of the server in the DnsConfig.
+  unsigned server_index() const {
+    return server_index_;
+  }
+
+  // Returns the time since the query was sent.
+  base::TimeDelta GetElapsedTime() const {
+    return base::TimeTicks::Now() - start_time_;
+  }
+
   const DnsQuery* query() const {
     return query_.get();
   }
@@ -245,7 +262,9 @@ class DnsUDPAttempt {
   State next_state_;
 
   scoped_ptr<DatagramClientSocket> socket_;
+  unsigned server_index_;
   IPEndPoint server_;
+  base::TimeTicks start_time_;
   scoped_ptr<DnsQuery> query_;
 
   scoped_ptr<DnsResponse> response_;
@@ -262,7 +281,8 @@ class DnsUDPAttempt {
 // The timeout for each DnsUDPAttempt is given by DnsSession::NextTimeout.
 // The first server to attempt on each query is given by
 // DnsSession::NextFirstServerIndex, and the order is round-robin afterwards.
-// Each server is attempted DnsConfig::attempts times.
+// Each server is attempted DnsConfig::attempts times. The round-trip times and
+// the timeouts of the attempts are reported back to the DnsSession.
 class DnsTransactionImpl : public DnsTransaction,
                            public base::NonThreadSafe,
                            public base::SupportsWeakPtr<DnsTransactionImpl> {
@@ -434,11 +454,12 @@ class DnsTransactionImpl : public DnsTransaction,
 
     const DnsConfig& config = session_->config();
 
-    unsigned server_index = first_server_index_ +
-        (attempt_number % config.nameservers.size());
+    unsigned server_index = (first_server_index_ + attempt_number) %
+        config.nameservers.size();
 
     DnsUDPAttempt* attempt = new DnsUDPAttempt(
         socket.Pass(),
+        server_index,
         config.nameservers[server_index],
         query.Pass(),
         base::Bind(&DnsTransactionImpl::OnAttemptComplete,
@@ -450,7 +471,8 @@ class DnsTransactionImpl : public DnsTransaction,
     int rv = attempt->Start();
     if (rv == ERR_IO_PENDING) {
       timer_.Stop();
-      base::TimeDelta timeout = session_->NextTimeout(attempt_number);
+      base::TimeDelta timeout = session_->NextTimeout(server_index,
+                                                      attempt_number);
       timer_.Start(FROM_HERE, timeout, this, &DnsTransactionImpl::OnTimeout);
     }
     return AttemptResult(rv, attempt);
@@ -500,6 +522,10 @@ class DnsTransactionImpl : public DnsTransaction,
   AttemptResult FinishAttempt(AttemptResult result) {
     while (result.rv != ERR_IO_PENDING) {
       LogResponse(result.attempt);
+      if (result.attempt && result.attempt->response()) {
+        session_->RecordRTT(result.attempt->server_index(),
+                            result.attempt->GetElapsedTime());
+      }
 
       switch (result.rv) {
         case OK:
@@ -547,6 +573,7 @@ class DnsTransactionImpl : public DnsTransaction,
   void OnTimeout() {
     if (callback_.is_null())
       return;
+    session_->RecordLostPacket(attempts_->back()->server_index());
     AttemptResult result = FinishAttempt(
         AttemptResult(ERR_DNS_TIMED_OUT, NULL));
     if (result.rv != ERR_IO_PENDING)
@@ -601,6 +628,235 @@ class DnsTransactionFactoryImpl : public DnsTransactionFactory {
   scoped_refptr<DnsSession> session_;
 };
 
+// ----------------------------------------------------------------------------
+
+class CoalescedTransaction;
+
+// Keeps a single DnsTransaction in flight for each name and type, and reports
+// its result to all the CoalescedTransactions that wait for it. It is shared
+// by CoalescingTransactionFactory and the transactions that it creates, so
+// that they keep working once the factory is destroyed.
+class TransactionCoalescer : public base::RefCounted<TransactionCoalescer>,
+                             public base::NonThreadSafe {
+ public:
+  typedef std::pair<std::string, uint16> Key;
+
+  // A transaction in flight, and the transactions waiting for its result.
+  struct Group {
+    explicit Group(const Key& key);
+    ~Group();
+
+    const Key key;
+    scoped_ptr<DnsTransaction> transaction;
+    std::list<CoalescedTransaction*> listeners;
+  };
+
+  explicit TransactionCoalescer(scoped_ptr<DnsTransactionFactory> factory)
+      : factory_(factory.Pass()) {
+  }
+
+  // Adds |transaction| to the listeners of the transaction in flight for its
+  // name and type, and starts one if there is none. Returns the Group that
+  // |transaction| joined, or NULL on synchronous failure. |rv| is set to the
+  // net error, or ERR_IO_PENDING.
+  Group* Join(CoalescedTransaction* transaction, int* rv);
+
+  // Removes |transaction| from the listeners of |group|. The transaction in
+  // flight is cancelled when nobody waits for its result anymore.
+  void Leave(CoalescedTransaction* transaction, Group* group);
+
+ private:
+  friend class base::RefCounted<TransactionCoalescer>;
+  typedef std::map<Key, Group*> GroupMap;
+
+  ~TransactionCoalescer() {
+    DCHECK(groups_.empty());
+  }
+
+  void OnTransactionComplete(const Key& key,
+                             DnsTransaction* transaction,
+                             int net_error,
+                             const DnsResponse* response);
+
+  scoped_ptr<DnsTransactionFactory> factory_;
+
+  // Groups that are still waiting for their transaction.
+  GroupMap groups_;
+
+  DISALLOW_COPY_AND_ASSIGN(TransactionCoalescer);
+};
+
+// A DnsTransaction that shares the network effort of all the other ones for
+// the same name and type that run at the same time.
+class CoalescedTransaction : public DnsTransaction,
+                             public base::NonThreadSafe {
+ public:
+  CoalescedTransaction(TransactionCoalescer* coalescer,
+                       const std::string& hostname,
+                       uint16 qtype,
+                       const DnsTransactionFactory::CallbackType& callback,
+                       const BoundNetLog& net_log)
+      : coalescer_(coalescer),
+        hostname_(hostname),
+        qtype_(qtype),
+        callback_(callback),
+        net_log_(net_log),
+        group_(NULL) {
+    DCHECK(!callback_.is_null());
+  }
+
+  virtual ~CoalescedTransaction() {
+    if (group_)
+      coalescer_->Leave(this, group_);
+  }
+
+  virtual const std::string& GetHostname() const OVERRIDE {
+    DCHECK(CalledOnValidThread());
+    return hostname_;
+  }
+
+  virtual uint16 GetType() const OVERRIDE {
+    DCHECK(CalledOnValidThread());
+    return qtype_;
+  }
+
+  virtual int Start() OVERRIDE {
+    DCHECK(!callback_.is_null());
+    DCHECK(!group_);
+    int rv = ERR_IO_PENDING;
+    group_ = coalescer_->Join(this, &rv);
+    if (rv != ERR_IO_PENDING)
+      callback_.Reset();
+    return rv;
+  }
+
+  const BoundNetLog& net_log() const {
+    return net_log_;
+  }
+
+  // Called by the coalescer with the result of the transaction of the group.
+  void OnComplete(int net_error, const DnsResponse* response) {
+    DCHECK(!callback_.is_null());
+    group_ = NULL;
+    DnsTransactionFactory::CallbackType callback = callback_;
+    callback_.Reset();
+    callback.Run(this, net_error, response);
+  }
+
+ private:
+  scoped_refptr<TransactionCoalescer> coalescer_;
+  std::string hostname_;
+  uint16 qtype_;
+  // Cleared in OnComplete.
+  DnsTransactionFactory::CallbackType callback_;
+
+  BoundNetLog net_log_;
+
+  // The group that this transaction waits for, if any.
+  TransactionCoalescer::Group* group_;
+
+  DISALLOW_COPY_AND_ASSIGN(CoalescedTransaction);
+};
+
+TransactionCoalescer::Group::Group(const Key& key) : key(key) {
+}
+
+TransactionCoalescer::Group::~Group() {
+}
+
+TransactionCoalescer::Group* TransactionCoalescer::Join(
+    CoalescedTransaction* transaction,
+    int* rv) {
+  DCHECK(CalledOnValidThread());
+  Key key(transaction->GetHostname(), transaction->GetType());
+  GroupMap::iterator it = groups_.find(key);
+  if (it != groups_.end()) {
+    transaction->net_log().AddEvent(
+        NetLog::TYPE_DNS_TRANSACTION_COALESCED,
+        make_scoped_refptr(new StartParameters(key.first, key.second)));
+    it->second->listeners.push_back(transaction);
+    *rv = ERR_IO_PENDING;
+    return it->second;
+  }
+
+  // The network activity of the whole group is logged by the first
+  // transaction.
+  scoped_ptr<Group> group(new Group(key));
+  group->transaction = factory_->CreateTransaction(
+      key.first,
+      key.second,
+      base::Bind(&TransactionCoalescer::OnTransactionComplete, this, key),
+      transaction->net_log());
+  *rv = group->transaction->Start();
+  if (*rv != ERR_IO_PENDING)
+    return NULL;
+
+  group->listeners.push_back(transaction);
+  groups_[key] = group.get();
+  return group.release();
+}
+
+void TransactionCoalescer::Leave(CoalescedTransaction* transaction,
+                                 Group* group) {
+  DCHECK(CalledOnValidThread());
+  group->listeners.remove(transaction);
+  if (!group->listeners.empty())
+    return;
+
+  // A group that is not on the map is owned by OnTransactionComplete.
+  GroupMap::iterator it = groups_.find(group->key);
+  if (it != groups_.end() && it->second == group) {
+    groups_.erase(it);
+    delete group;
+  }
+}
+
+void TransactionCoalescer::OnTransactionComplete(const Key& key,
+                                                 DnsTransaction* transaction,
+                                                 int net_error,
+                                                 const DnsResponse* response) {
+  DCHECK(CalledOnValidThread());
+  GroupMap::iterator it = groups_.find(key);
+  DCHECK(it != groups_.end());
+  DCHECK_EQ(transaction, it->second->transaction.get());
+
+  // Transactions started by the callbacks must not join this group. The
+  // response is owned by |group|, so it is valid until all the listeners are
+  // notified, even if they are destroyed by the callbacks.
+  scoped_ptr<Group> group(it->second);
+  groups_.erase(it);
+  while (!group->listeners.empty()) {
+    CoalescedTransaction* listener = group->listeners.front();
+    group->listeners.pop_front();
+    listener->OnComplete(net_error, response);
+  }
+}
+
+// Implementation of DnsTransactionFactory that returns instances of
+// CoalescedTransaction.
+class CoalescingTransactionFactory : public DnsTransactionFactory {
+ public:
+  explicit CoalescingTransactionFactory(
+      scoped_ptr<DnsTransactionFactory> factory)
+      : coalescer_(new TransactionCoalescer(factory.Pass())) {
+  }
+
+  virtual scoped_ptr<DnsTransaction> CreateTransaction(
+      const std::string& hostname,
+      uint16 qtype,
+      const CallbackType& callback,
+      const BoundNetLog& net_log) OVERRIDE {
+    return scoped_ptr<DnsTransaction>(new CoalescedTransaction(coalescer_,
+                                                               hostname,
+                                                               qtype,
+                                                               callback,
+                                                               net_log));
+  }
+
+ private:
+  scoped_refptr<TransactionCoalescer> coalescer_;
+};
+
 }  // namespace
 
 // static
@@ -610,5 +866,13 @@ scoped_ptr<DnsTransactionFactory> DnsTransactionFactory::CreateFactory(
       new DnsTransactionFactoryImpl(session));
 }
 
+// static
+scoped_ptr<DnsTransactionFactory>
+DnsTransactionFactory::CreateCoalescingFactory(
+    scoped_ptr<DnsTransactionFactory> factory) {
+  return scoped_ptr<DnsTransactionFactory>(
+      new CoalescingTransactionFactory(factory.Pass()));
+}
+
 }  // namespace net
 
@@ -73,6 +73,12 @@ class NET_EXPORT_PRIVATE DnsTransactionFactory {
   // |session|.
   static scoped_ptr<DnsTransactionFactory> CreateFactory(
       DnsSession* session) WARN_UNUSED_RESULT;
+
+  // Creates a DnsTransactionFactory whose transactions share a single
+  // transaction of |factory| when they run at the same time for the same
+  // |hostname| and |qtype|, so that identical queries are sent only once.
+  static scoped_ptr<DnsTransactionFactory> CreateCoalescingFactory(
+      scoped_ptr<DnsTransactionFactory> factory) WARN_UNUSED_RESULT;
 };
 
 }  // namespace net
@@ -566,6 +566,116 @@ TEST_F(DnsTransactionTest, ServerFallbackAndRotate) {
   CheckServerOrder(kOrder, arraysize(kOrder));
 }
 
+TEST_F(DnsTransactionTest, FailoverToAnsweringServer) {
+  ConfigureNumServers(2);
+  // Use short timeout to speed up the test.
+  config_.timeout = base::TimeDelta::FromMilliseconds(
+      TestTimeouts::tiny_timeout_ms());
+  ConfigureFactory();
+
+  // Responses for first request.
+  AddTimeout(kT0HostName, kT0Qtype);
+  AddAsyncRcode(kT0HostName, kT0Qtype, dns_protocol::kRcodeNXDOMAIN);
+  // Responses for second request.
+  AddAsyncRcode(kT1HostName, kT1Qtype, dns_protocol::kRcodeNXDOMAIN);
+  PrepareSockets();
+
+  TransactionHelper helper0(kT0HostName,
+                            kT0Qtype,
+                            ERR_NAME_NOT_RESOLVED);
+  TransactionHelper helper1(kT1HostName,
+                            kT1Qtype,
+                            ERR_NAME_NOT_RESOLVED);
+
+  EXPECT_TRUE(helper0.RunUntilDone(transaction_factory_.get()));
+  EXPECT_TRUE(helper1.Run(transaction_factory_.get()));
+
+  unsigned kOrder[] = {
+      0, 1,   // The first transaction.
+      1,      // The second transaction skips the server that timed out.
+  };
+  CheckServerOrder(kOrder, arraysize(kOrder));
+}
+
+TEST_F(DnsTransactionTest, CoalescedLookup) {
+  AddAsyncResponse(kT0HostName,
+                   kT0Qtype,
+                   0 /* id */,
+                   reinterpret_cast<const char*>(kT0ResponseDatagram),
+                   arraysize(kT0ResponseDatagram));
+  AddAsyncResponse(kT0HostName,
+                   kT0Qtype,
+                   1 /* id */,
+                   reinterpret_cast<const char*>(kT0ResponseDatagram),
+                   arraysize(kT0ResponseDatagram));
+  PrepareSockets();
+
+  scoped_ptr<DnsTransactionFactory> factory =
+      DnsTransactionFactory::CreateCoalescingFactory(
+          transaction_factory_.Pass());
+
+  TransactionHelper helper0(kT0HostName,
+                            kT0Qtype,
+                            kT0RecordCount);
+  helper0.StartTransaction(factory.get());
+  TransactionHelper helper1(kT0HostName,
+                            kT0Qtype,
+                            kT0RecordCount);
+  helper1.StartTransaction(factory.get());
+  // Only the first transaction sent a query.
+  EXPECT_EQ(1u, socket_factory_->remote_endpoints.size());
+
+  MessageLoop::current()->RunAllPending();
+
+  EXPECT_TRUE(helper0.has_completed());
+  EXPECT_TRUE(helper1.has_completed());
+
+  // A transaction started after the others completed sends its own query.
+  TransactionHelper helper2(kT0HostName,
+                            kT0Qtype,
+                            kT0RecordCount);
+  EXPECT_TRUE(helper2.Run(factory.get()));
+  EXPECT_EQ(2u, socket_factory_->remote_endpoints.size());
+}
+
+TEST_F(DnsTransactionTest, CancelCoalescedLookup) {
+  AddAsyncResponse(kT0HostName,
+                   kT0Qtype,
+                   0 /* id */,
+                   reinterpret_cast<const char*>(kT0ResponseDatagram),
+                   arraysize(kT0ResponseDatagram));
+  PrepareSockets();
+
+  scoped_ptr<DnsTransactionFactory> factory =
+      DnsTransactionFactory::CreateCoalescingFactory(
+          transaction_factory_.Pass());
+
+  TransactionHelper helper0(kT0HostName,
+                            kT0Qtype,
+                            kT0RecordCount);
+  helper0.StartTransaction(factory.get());
+  TransactionHelper helper1(kT0HostName,
+                            kT0Qtype,
+                            kT0RecordCount);
+  helper1.StartTransaction(factory.get());
+  TransactionHelper helper2(kT0HostName,
+                            kT0Qtype,
+                            kT0RecordCount);
+  helper2.set_cancel_in_callback();
+  helper2.StartTransaction(factory.get());
+
+  // Cancelling the transaction that sent the query does not affect the others,
+  // and neither does destroying the factory.
+  helper0.Cancel();
+  factory.reset();
+
+  MessageLoop::current()->RunAllPending();
+
+  EXPECT_FALSE(helper0.has_completed());
+  EXPECT_TRUE(helper1.has_completed());
+  EXPECT_TRUE(helper2.has_completed());
+}
+
 TEST_F(DnsTransactionTest, SuffixSearchAboveNdots) {
   config_.ndots = 2;
   config_.search.push_back("a");
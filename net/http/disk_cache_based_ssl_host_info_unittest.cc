@@ -72,7 +72,11 @@ TEST(DiskCacheBasedSSLHostInfo, Update) {
 
   net::SSLHostInfo::State* state = ssl_host_info->mutable_state();
   EXPECT_TRUE(state->certs.empty());
+  EXPECT_TRUE(state->session_expiry.is_null());
   state->certs.push_back(std::string("foo"));
+  const base::Time session_expiry =
+      base::Time::Now() + base::TimeDelta::FromHours(1);
+  state->session_expiry = session_expiry;
   ssl_host_info->Persist();
 
   // Wait until Persist() does the work.
@@ -91,6 +95,7 @@ TEST(DiskCacheBasedSSLHostInfo, Update) {
   state = ssl_host_info->mutable_state();
   EXPECT_EQ(1U, state->certs.size());
   EXPECT_EQ("foo", state->certs.front());
+  EXPECT_EQ(session_expiry, state->session_expiry);
   state->certs.push_back(std::string("bar"));
 
   // Fail instead of DCHECKing double creates.
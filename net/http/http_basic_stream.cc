@@ -114,6 +114,14 @@ bool HttpBasicStream::IsConnectionReusable() const {
   return parser_->IsConnectionReusable();
 }
 
+bool HttpBasicStream::GetLoadTimingInfo(
+    LoadTimingInfo* load_timing_info) const {
+  if (!parser_.get())
+    return false;
+  return connection_->GetLoadTimingInfo(IsConnectionReused(),
+                                        load_timing_info);
+}
+
 void HttpBasicStream::GetSSLInfo(SSLInfo* ssl_info) {
   parser_->GetSSLInfo(ssl_info);
 }
@@ -74,6 +74,9 @@ class HttpBasicStream : public HttpStream {
 
   virtual bool IsConnectionReusable() const OVERRIDE;
 
+  virtual bool GetLoadTimingInfo(
+      LoadTimingInfo* load_timing_info) const OVERRIDE;
+
   virtual void GetSSLInfo(SSLInfo* ssl_info) OVERRIDE;
 
   virtual void GetSSLCertRequestInfo(
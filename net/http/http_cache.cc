@@ -19,6 +19,7 @@
 #include "base/location.h"
 #include "base/memory/ref_counted.h"
 #include "base/message_loop.h"
+#include "base/metrics/histogram.h"
 #include "base/pickle.h"
 #include "base/stl_util.h"
 #include "base/string_number_conversions.h"
@@ -96,7 +97,8 @@ int HttpCache::DefaultBackend::CreateBackend(
     NetLog* net_log, disk_cache::Backend** backend,
     const CompletionCallback& callback) {
   DCHECK_GE(max_bytes_, 0);
-  return disk_cache::CreateCacheBackend(type_, path_, max_bytes_, true,
+  return disk_cache::CreateCacheBackend(type_, CACHE_BACKEND_DEFAULT,
+                                        path_, max_bytes_, true,
                                         thread_, net_log, backend, callback);
 }
 
@@ -279,6 +281,89 @@ void HttpCache::MetadataWriter::OnIOComplete(int result) {
 
 //-----------------------------------------------------------------------------
 
+// This class encapsulates a detached transaction that revalidates an entry
+// which was served stale, and reads the response to the end so that an updated
+// resource is stored.
+class HttpCache::AsyncRevalidation {
+ public:
+  AsyncRevalidation(HttpCache* cache,
+                    const std::string& key,
+                    const HttpRequestInfo& request)
+      : cache_(cache),
+        key_(key),
+        request_info_(request) {
+    // Go to the network even if the caller would prefer the cache.
+    request_info_.load_flags |= LOAD_VALIDATE_CACHE;
+    request_info_.load_flags &= ~LOAD_PREFERRING_CACHE;
+  }
+
+  ~AsyncRevalidation() {}
+
+  void Start();
+
+ private:
+  enum { kReadBufferSize = 32 * 1024 };
+
+  void OnStartComplete(int result);
+  void ReadResponse();
+  void OnReadComplete(int result);
+  void Finish();
+
+  HttpCache* cache_;
+  std::string key_;
+  HttpRequestInfo request_info_;
+  scoped_ptr<HttpCache::Transaction> transaction_;
+  scoped_refptr<IOBuffer> buf_;
+  base::TimeTicks start_time_;
+  DISALLOW_COPY_AND_ASSIGN(AsyncRevalidation);
+};
+
+void HttpCache::AsyncRevalidation::Start() {
+  start_time_ = base::TimeTicks::Now();
+  transaction_.reset(new HttpCache::Transaction(cache_));
+  int rv = transaction_->Start(
+      &request_info_,
+      base::Bind(&AsyncRevalidation::OnStartComplete, base::Unretained(this)),
+      BoundNetLog());
+  if (rv != ERR_IO_PENDING)
+    OnStartComplete(rv);
+}
+
+void HttpCache::AsyncRevalidation::OnStartComplete(int result) {
+  if (result != OK)
+    return Finish();
+
+  buf_ = new IOBuffer(kReadBufferSize);
+  ReadResponse();
+}
+
+void HttpCache::AsyncRevalidation::ReadResponse() {
+  int rv;
+  do {
+    rv = transaction_->Read(
+        buf_, kReadBufferSize,
+        base::Bind(&AsyncRevalidation::OnReadComplete, base::Unretained(this)));
+  } while (rv > 0);
+
+  if (rv != ERR_IO_PENDING)
+    Finish();
+}
+
+void HttpCache::AsyncRevalidation::OnReadComplete(int result) {
+  if (result <= 0)
+    return Finish();
+  ReadResponse();
+}
+
+void HttpCache::AsyncRevalidation::Finish() {
+  // This is the latency the consumer of the stale entry did not wait for.
+  UMA_HISTOGRAM_TIMES("HttpCache.StaleWhileRevalidate.RevalidationTime",
+                      base::TimeTicks::Now() - start_time_);
+  cache_->OnAsyncRevalidationDone(key_);
+}
+
+//-----------------------------------------------------------------------------
+
 class HttpCache::SSLHostInfoFactoryAdaptor : public SSLHostInfoFactory {
  public:
   SSLHostInfoFactoryAdaptor(CertVerifier* cert_verifier, HttpCache* http_cache)
@@ -315,6 +400,7 @@ HttpCache::HttpCache(HostResolver* host_resolver,
       backend_factory_(backend_factory),
       building_backend_(false),
       mode_(NORMAL),
+      async_revalidation_enabled_(false),
       ssl_host_info_factory_(new SSLHostInfoFactoryAdaptor(
           cert_verifier,
           ALLOW_THIS_IN_INITIALIZER_LIST(this))),
@@ -343,6 +429,7 @@ HttpCache::HttpCache(HttpNetworkSession* session,
       backend_factory_(backend_factory),
       building_backend_(false),
       mode_(NORMAL),
+      async_revalidation_enabled_(false),
       ssl_host_info_factory_(new SSLHostInfoFactoryAdaptor(
           session->cert_verifier(),
           ALLOW_THIS_IN_INITIALIZER_LIST(this))),
@@ -356,10 +443,14 @@ HttpCache::HttpCache(HttpTransactionFactory* network_layer,
       backend_factory_(backend_factory),
       building_backend_(false),
       mode_(NORMAL),
+      async_revalidation_enabled_(false),
       network_layer_(network_layer) {
 }
 
 HttpCache::~HttpCache() {
+  // The revalidations own transactions that still use our entries.
+  STLDeleteValues(&async_revalidations_);
+
   // If we have any active entries remaining, then we need to deactivate them.
   // We may have some pending calls to OnProcessPendingQueue, but since those
   // won't run (due to our destruction), we can simply ignore the corresponding
@@ -1012,6 +1103,30 @@ void HttpCache::ProcessPendingQueue(ActiveEntry* entry) {
                  entry));
 }
 
+void HttpCache::StartAsyncRevalidation(const HttpRequestInfo& request) {
+  std::string key = GenerateCacheKey(&request);
+  if (async_revalidations_.find(key) != async_revalidations_.end())
+    return;
+
+  async_revalidations_[key] = new AsyncRevalidation(this, key, request);
+  MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&HttpCache::OnStartAsyncRevalidation, AsWeakPtr(), key));
+}
+
+void HttpCache::OnAsyncRevalidationDone(const std::string& key) {
+  AsyncRevalidationMap::iterator it = async_revalidations_.find(key);
+  DCHECK(it != async_revalidations_.end());
+  delete it->second;
+  async_revalidations_.erase(it);
+}
+
+void HttpCache::OnStartAsyncRevalidation(const std::string& key) {
+  AsyncRevalidationMap::iterator it = async_revalidations_.find(key);
+  if (it != async_revalidations_.end())
+    it->second->Start();
+}
+
 void HttpCache::OnProcessPendingQueue(ActiveEntry* entry) {
   entry->will_process_pending_queue = false;
   DCHECK(!entry->writer);
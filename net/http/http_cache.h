@@ -179,6 +179,16 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   void set_mode(Mode value) { mode_ = value; }
   Mode mode() { return mode_; }
 
+  // Get/Set whether a stale entry whose response allows it through
+  // "Cache-Control: stale-while-revalidate" is served right away, while a
+  // detached transaction revalidates it in the background.
+  void set_async_revalidation_enabled(bool value) {
+    async_revalidation_enabled_ = value;
+  }
+  bool async_revalidation_enabled() const {
+    return async_revalidation_enabled_;
+  }
+
   // Close currently active sockets so that fresh page loads will not use any
   // recycled connections.  For sockets currently in use, they may not close
   // immediately, but they will not be reusable. This is for debugging.
@@ -211,6 +221,7 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
  private:
   // Types --------------------------------------------------------------------
 
+  class AsyncRevalidation;
   class MetadataWriter;
   class SSLHostInfoFactoryAdaptor;
   class Transaction;
@@ -237,6 +248,8 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   typedef base::hash_map<std::string, PendingOp*> PendingOpsMap;
   typedef std::set<ActiveEntry*> ActiveEntriesSet;
   typedef base::hash_map<std::string, int> PlaybackCacheMap;
+  typedef base::hash_map<std::string, AsyncRevalidation*>
+      AsyncRevalidationMap;
 
   // Methods ------------------------------------------------------------------
 
@@ -348,10 +361,21 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   // Resumes processing the pending list of |entry|.
   void ProcessPendingQueue(ActiveEntry* entry);
 
+  // Revalidates the entry for |request| in the background, unless that is
+  // already under way. Called by a transaction that served the entry stale.
+  void StartAsyncRevalidation(const HttpRequestInfo& request);
+
+  // Deletes the finished background revalidation of the entry for |key|.
+  void OnAsyncRevalidationDone(const std::string& key);
+
   // Events (called via PostTask) ---------------------------------------------
 
   void OnProcessPendingQueue(ActiveEntry* entry);
 
+  // Starts the background revalidation of the entry for |key|, once the
+  // transaction that asked for it is done with the current call stack.
+  void OnStartAsyncRevalidation(const std::string& key);
+
   // Callbacks ----------------------------------------------------------------
 
   // Processes BackendCallback notifications.
@@ -380,6 +404,8 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
 
   Mode mode_;
 
+  bool async_revalidation_enabled_;
+
   const scoped_ptr<SSLHostInfoFactoryAdaptor> ssl_host_info_factory_;
 
   const scoped_ptr<HttpTransactionFactory> network_layer_;
@@ -396,6 +422,9 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
 
   scoped_ptr<PlaybackCacheMap> playback_cache_map_;
 
+  // The background revalidations in progress, indexed by cache key.
+  AsyncRevalidationMap async_revalidations_;
+
   DISALLOW_COPY_AND_ASSIGN(HttpCache);
 };
 
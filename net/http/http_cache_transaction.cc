@@ -122,6 +122,7 @@ HttpCache::Transaction::Transaction(HttpCache* cache)
       effective_load_flags_(0),
       write_len_(0),
       final_upload_progress_(0),
+      has_final_load_timing_info_(false),
       ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)),
       ALLOW_THIS_IN_INITIALIZER_LIST(io_callback_(
           base::Bind(&Transaction::OnIOComplete,
@@ -405,6 +406,29 @@ uint64 HttpCache::Transaction::GetUploadProgress() const {
   return final_upload_progress_;
 }
 
+bool HttpCache::Transaction::GetLoadTimingInfo(
+    LoadTimingInfo* load_timing_info) const {
+  bool has_timing = false;
+  if (network_trans_.get()) {
+    has_timing = network_trans_->GetLoadTimingInfo(load_timing_info);
+  } else if (has_final_load_timing_info_) {
+    load_timing_info->socket_reused = final_load_timing_info_.socket_reused;
+    load_timing_info->connect_timing = final_load_timing_info_.connect_timing;
+    load_timing_info->send_start = final_load_timing_info_.send_start;
+    load_timing_info->send_end = final_load_timing_info_.send_end;
+    load_timing_info->receive_headers_end =
+        final_load_timing_info_.receive_headers_end;
+    has_timing = true;
+  }
+
+  if (!cache_read_start_.is_null()) {
+    load_timing_info->cache_read_start = cache_read_start_;
+    load_timing_info->cache_read_end = cache_read_end_;
+    has_timing = true;
+  }
+  return has_timing;
+}
+
 //-----------------------------------------------------------------------------
 
 void HttpCache::Transaction::DoCallback(int rv) {
@@ -1053,7 +1077,7 @@ int HttpCache::Transaction::DoUpdateCachedResponse() {
   response_.response_time = new_response_->response_time;
   response_.request_time = new_response_->request_time;
 
-  if (response_.headers->HasHeaderValue("cache-control", "no-store")) {
+  if (response_.headers->HasNoStoreDirective()) {
     int ret = cache_->DoomEntry(cache_key_, NULL);
     DCHECK_EQ(OK, ret);
   } else {
@@ -1085,6 +1109,8 @@ int HttpCache::Transaction::DoUpdateCachedResponseComplete(int result) {
     }
     // We no longer need the network transaction, so destroy it.
     final_upload_progress_ = network_trans_->GetUploadProgress();
+    has_final_load_timing_info_ =
+        network_trans_->GetLoadTimingInfo(&final_load_timing_info_);
     network_trans_.reset();
   } else if (entry_ && handling_206_ && truncated_ &&
              partial_->initial_validation()) {
@@ -1204,12 +1230,14 @@ int HttpCache::Transaction::DoCacheReadResponse() {
   read_buf_ = new IOBuffer(io_buf_len_);
 
   net_log_.BeginEvent(NetLog::TYPE_HTTP_CACHE_READ_INFO, NULL);
+  cache_read_start_ = base::TimeTicks::Now();
   return entry_->disk_entry->ReadData(kResponseInfoIndex, 0, read_buf_,
                                       io_buf_len_, io_callback_);
 }
 
 int HttpCache::Transaction::DoCacheReadResponseComplete(int result) {
   net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HTTP_CACHE_READ_INFO, result);
+  cache_read_end_ = base::TimeTicks::Now();
   if (result != io_buf_len_ ||
       !HttpCache::ParseResponseInfo(read_buf_->data(), io_buf_len_,
                                     &response_, &truncated_)) {
@@ -1573,6 +1601,12 @@ int HttpCache::Transaction::BeginCacheValidation() {
   if ((partial_.get() && !partial_->IsCurrentRangeCached()) || invalid_range_)
     skip_validation = false;
 
+  if (!skip_validation && !partial_.get() && !invalid_range_ &&
+      CanServeStaleWhileRevalidating()) {
+    cache_->StartAsyncRevalidation(*request_);
+    skip_validation = true;
+  }
+
   if (skip_validation) {
     if (partial_.get()) {
       // We are going to return the saved response headers to the caller, so
@@ -1736,6 +1770,27 @@ bool HttpCache::Transaction::RequiresValidation() {
   return false;
 }
 
+bool HttpCache::Transaction::CanServeStaleWhileRevalidating() {
+  if (!cache_->async_revalidation_enabled() || request_->method != "GET" ||
+      effective_load_flags_ & LOAD_VALIDATE_CACHE) {
+    return false;
+  }
+
+  base::TimeDelta window;
+  if (!response_.headers->GetStaleWhileRevalidateValue(&window))
+    return false;
+
+  // A different variant has to be fetched, not revalidated.
+  bool can_serve_stale =
+      response_.headers->IsWithinStaleWhileRevalidateWindow(
+          response_.request_time, response_.response_time, Time::Now()) &&
+      (!response_.vary_data.is_valid() ||
+       response_.vary_data.MatchesRequest(*request_, *response_.headers));
+  UMA_HISTOGRAM_BOOLEAN("HttpCache.StaleWhileRevalidate.ServedStale",
+                        can_serve_stale);
+  return can_serve_stale;
+}
+
 bool HttpCache::Transaction::ConditionalizeRequest() {
   DCHECK(response_.headers);
 
@@ -1975,7 +2030,7 @@ int HttpCache::Transaction::WriteResponseInfoToEntry(bool truncated) {
   // errors) and no SSL blocking page is shown.  An alternative would be to
   // reverse-map the cert status to a net error and replay the net error.
   if ((cache_->mode() != RECORD &&
-       response_.headers->HasHeaderValue("cache-control", "no-store")) ||
+       response_.headers->HasNoStoreDirective()) ||
       net::IsCertStatusError(response_.ssl_info.cert_status)) {
     DoneWritingToEntry(false);
     return OK;
@@ -13,6 +13,7 @@
 
 #include "base/time.h"
 #include "net/base/completion_callback.h"
+#include "net/base/load_timing_info.h"
 #include "net/base/net_log.h"
 #include "net/http/http_cache.h"
 #include "net/http/http_response_info.h"
@@ -117,6 +118,8 @@ class HttpCache::Transaction : public HttpTransaction {
   virtual const HttpResponseInfo* GetResponseInfo() const OVERRIDE;
   virtual LoadState GetLoadState() const OVERRIDE;
   virtual uint64 GetUploadProgress(void) const OVERRIDE;
+  virtual bool GetLoadTimingInfo(
+      LoadTimingInfo* load_timing_info) const OVERRIDE;
 
  private:
   static const size_t kNumValidationHeaders = 2;
@@ -267,6 +270,10 @@ class HttpCache::Transaction : public HttpTransaction {
   // Called to determine if we need to validate the cache entry before using it.
   bool RequiresValidation();
 
+  // Called when the cache entry requires validation, to determine if it can be
+  // used right away while the cache revalidates it in the background.
+  bool CanServeStaleWhileRevalidating();
+
   // Called to make the request conditional (to ask the server if the cached
   // copy is valid).  Returns true if able to make the request conditional.
   bool ConditionalizeRequest();
@@ -367,6 +374,12 @@ class HttpCache::Transaction : public HttpTransaction {
   int write_len_;
   scoped_ptr<PartialData> partial_;  // We are dealing with range requests.
   uint64 final_upload_progress_;
+  // Network timing saved when |network_trans_| is dropped after validating
+  // the cached entry.
+  LoadTimingInfo final_load_timing_info_;
+  bool has_final_load_timing_info_;
+  base::TimeTicks cache_read_start_;
+  base::TimeTicks cache_read_end_;
   base::WeakPtrFactory<Transaction> weak_factory_;
   CompletionCallback io_callback_;
 };
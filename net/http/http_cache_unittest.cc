@@ -14,6 +14,7 @@
 #include "net/base/cert_status_flags.h"
 #include "net/base/host_port_pair.h"
 #include "net/base/load_flags.h"
+#include "net/base/load_timing_info.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_log_unittest.h"
 #include "net/base/ssl_cert_request_info.h"
@@ -634,6 +635,39 @@ TEST(HttpCache, SimpleGET_LoadOnlyFromCache_Hit) {
   EXPECT_EQ(1, cache.disk_cache()->create_count());
 }
 
+// Tests that the network times are reported for a miss and the cache read
+// times for a hit.
+TEST(HttpCache, SimpleGET_LoadTimingInfo) {
+  MockHttpCache cache;
+  MockHttpRequest request(kSimpleGET_Transaction);
+
+  for (int i = 0; i < 2; ++i) {
+    scoped_ptr<net::HttpTransaction> trans;
+    EXPECT_EQ(net::OK, cache.http_cache()->CreateTransaction(&trans));
+
+    net::TestCompletionCallback callback;
+    int rv = trans->Start(&request, callback.callback(), net::BoundNetLog());
+    EXPECT_EQ(net::OK, callback.GetResult(rv));
+    std::string content;
+    ReadTransaction(trans.get(), &content);
+
+    net::LoadTimingInfo load_timing_info;
+    EXPECT_TRUE(trans->GetLoadTimingInfo(&load_timing_info));
+    if (i == 0) {
+      EXPECT_FALSE(load_timing_info.send_start.is_null());
+      EXPECT_FALSE(load_timing_info.receive_headers_end.is_null());
+      EXPECT_TRUE(load_timing_info.cache_read_start.is_null());
+    } else {
+      EXPECT_TRUE(load_timing_info.send_start.is_null());
+      EXPECT_FALSE(load_timing_info.cache_read_start.is_null());
+      EXPECT_LE(load_timing_info.cache_read_start,
+                load_timing_info.cache_read_end);
+    }
+  }
+
+  EXPECT_EQ(1, cache.network_layer()->transaction_count());
+}
+
 TEST(HttpCache, SimpleGET_LoadOnlyFromCache_Miss) {
   MockHttpCache cache;
 
@@ -1586,6 +1620,37 @@ TEST(HttpCache, ETagGET_ConditionalRequest_304) {
   EXPECT_EQ(1, cache.disk_cache()->create_count());
 }
 
+// Tests that an entry within its stale-while-revalidate window is served from
+// the cache, and revalidated in the background.
+TEST(HttpCache, ETagGET_StaleWhileRevalidate) {
+  MockHttpCache cache;
+  cache.http_cache()->set_async_revalidation_enabled(true);
+
+  ScopedMockTransaction transaction(kETagGET_Transaction);
+  transaction.response_headers =
+      "Cache-Control: max-age=0, stale-while-revalidate=86400\n"
+      "Etag: foopy\n";
+
+  // write to the cache
+  RunTransactionTest(cache.http_cache(), transaction);
+
+  // The stale entry is returned without waiting for the server.
+  transaction.handler = ETagGet_ConditionalRequest_Handler;
+  net::HttpResponseInfo response;
+  RunTransactionTestWithResponseInfo(cache.http_cache(), transaction,
+                                     &response);
+  EXPECT_TRUE(response.was_cached);
+
+  // Let the conditional request run, which makes the entry fresh again.
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+
+  transaction.handler = NULL;
+  RunTransactionTest(cache.http_cache(), transaction);
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+  EXPECT_EQ(1, cache.disk_cache()->create_count());
+}
+
 static void ETagGet_UnconditionalRequest_Handler(
     const net::HttpRequestInfo* request,
     std::string* response_status,
@@ -368,6 +368,20 @@ uint64 HttpNetworkTransaction::GetUploadProgress() const {
   return stream_->GetUploadProgress();
 }
 
+bool HttpNetworkTransaction::GetLoadTimingInfo(
+    LoadTimingInfo* load_timing_info) const {
+  if (load_timing_info_.send_start.is_null())
+    return false;
+
+  load_timing_info->socket_reused = load_timing_info_.socket_reused;
+  load_timing_info->connect_timing = load_timing_info_.connect_timing;
+  load_timing_info->send_start = load_timing_info_.send_start;
+  load_timing_info->send_end = load_timing_info_.send_end;
+  load_timing_info->receive_headers_end =
+      load_timing_info_.receive_headers_end;
+  return true;
+}
+
 void HttpNetworkTransaction::OnStreamReady(const SSLConfig& used_ssl_config,
                                            const ProxyInfo& used_proxy_info,
                                            HttpStream* stream) {
@@ -763,6 +777,11 @@ int HttpNetworkTransaction::DoBuildRequestComplete(int result) {
 int HttpNetworkTransaction::DoSendRequest() {
   next_state_ = STATE_SEND_REQUEST_COMPLETE;
 
+  // Only the last request sent by the transaction is timed.
+  load_timing_info_ = LoadTimingInfo();
+  stream_->GetLoadTimingInfo(&load_timing_info_);
+  load_timing_info_.send_start = base::TimeTicks::Now();
+
   return stream_->SendRequest(
       request_headers_, request_body_.release(), &response_, io_callback_);
 }
@@ -770,6 +789,7 @@ int HttpNetworkTransaction::DoSendRequest() {
 int HttpNetworkTransaction::DoSendRequestComplete(int result) {
   if (result < 0)
     return HandleIOError(result);
+  load_timing_info_.send_end = base::TimeTicks::Now();
   next_state_ = STATE_READ_HEADERS;
   return OK;
 }
@@ -821,8 +841,10 @@ int HttpNetworkTransaction::DoReadHeadersComplete(int result) {
   // After we call RestartWithAuth a new response_time will be recorded, and
   // we need to be cautious about incorrectly logging the duration across the
   // authentication activity.
-  if (result == OK)
+  if (result == OK) {
+    load_timing_info_.receive_headers_end = base::TimeTicks::Now();
     LogTransactionConnectedMetrics();
+  }
 
   if (result == ERR_CONNECTION_CLOSED) {
     // For now, if we get at least some data, we do the best we can to make
@@ -13,6 +13,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/time.h"
+#include "net/base/load_timing_info.h"
 #include "net/base/net_log.h"
 #include "net/base/request_priority.h"
 #include "net/base/ssl_config_service.h"
@@ -62,6 +63,8 @@ class NET_EXPORT_PRIVATE HttpNetworkTransaction
   virtual const HttpResponseInfo* GetResponseInfo() const OVERRIDE;
   virtual LoadState GetLoadState() const OVERRIDE;
   virtual uint64 GetUploadProgress() const OVERRIDE;
+  virtual bool GetLoadTimingInfo(
+      LoadTimingInfo* load_timing_info) const OVERRIDE;
 
   // HttpStreamRequest::Delegate methods:
   virtual void OnStreamReady(const SSLConfig& used_ssl_config,
@@ -263,6 +266,10 @@ class NET_EXPORT_PRIVATE HttpNetworkTransaction
   scoped_ptr<HttpStreamRequest> stream_request_;
   scoped_ptr<HttpStream> stream_;
 
+  // Timing of the last request sent on |stream_|.  It is kept here because the
+  // connection goes back to the pool once the body has been read.
+  LoadTimingInfo load_timing_info_;
+
   // True if we've validated the headers that the stream parser has returned.
   bool headers_valid_;
 
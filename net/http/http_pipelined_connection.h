@@ -6,6 +6,8 @@
 #define NET_HTTP_HTTP_PIPELINED_CONNECTION_H_
 #pragma once
 
+#include "base/basictypes.h"
+#include "base/time.h"
 #include "net/base/net_export.h"
 #include "net/base/net_log.h"
 #include "net/socket/ssl_client_socket.h"
@@ -40,6 +42,16 @@ class NET_EXPORT_PRIVATE HttpPipelinedConnection {
     // the headers indicate that pipelining can be used.
     virtual void OnPipelineFeedback(HttpPipelinedConnection* pipeline,
                                     Feedback feedback) = 0;
+
+    // Called when a pipeline receives reusable headers. |content_length| is
+    // the announced size of the response body, or -1 if it isn't known.
+    // |time_to_headers| is the time from the request being sent until its
+    // headers arrived. |num_responses_behind| is the number of requests that
+    // have already been sent and will be read after this response.
+    virtual void OnPipelineResponseHeaders(HttpPipelinedConnection* pipeline,
+                                           int64 content_length,
+                                           base::TimeDelta time_to_headers,
+                                           int num_responses_behind) = 0;
   };
 
   class Factory {
@@ -73,6 +85,12 @@ class NET_EXPORT_PRIVATE HttpPipelinedConnection {
   // requests.
   virtual bool active() const = 0;
 
+  // Stops this pipeline from accepting new requests and evicts the requests
+  // waiting behind the response that is currently being read. The evicted
+  // requests fail with ERR_PIPELINE_EVICTION, so they are retried on other
+  // connections. Used when that response would hold them up for too long.
+  virtual void EvictQueuedRequests() = 0;
+
   // The SSLConfig used to establish this connection.
   virtual const SSLConfig& used_ssl_config() const = 0;
 
@@ -291,6 +291,8 @@ int HttpPipelinedConnectionImpl::DoSendComplete(int result) {
 
   request_order_.push(active_send_request_->pipeline_id);
   stream_info_map_[active_send_request_->pipeline_id].state = STREAM_SENT;
+  stream_info_map_[active_send_request_->pipeline_id].send_complete_time =
+      base::TimeTicks::Now();
   net_log_.AddEvent(
       NetLog::TYPE_HTTP_PIPELINED_CONNECTION_SENT_REQUEST,
       make_scoped_refptr(new NetLogSourceParameter(
@@ -544,6 +546,42 @@ int HttpPipelinedConnectionImpl::DoEvictPendingReadHeaders(int result) {
   return result;
 }
 
+void HttpPipelinedConnectionImpl::EvictQueuedRequests() {
+  if (!usable_) {
+    return;
+  }
+  // Requests that are still waiting to be sent are evicted by the send loop
+  // once it sees that we're no longer usable.
+  usable_ = false;
+  MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&HttpPipelinedConnectionImpl::EvictQueuedReads,
+                 weak_factory_.GetWeakPtr()));
+}
+
+void HttpPipelinedConnectionImpl::EvictQueuedReads() {
+  base::WeakPtr<HttpPipelinedConnectionImpl> weak_this =
+      weak_factory_.GetWeakPtr();
+  while (!request_order_.empty()) {
+    int evicted_id = request_order_.front();
+    request_order_.pop();
+    if (!ContainsKey(stream_info_map_, evicted_id)) {
+      continue;
+    }
+    // Streams that haven't asked for their headers yet will get
+    // ERR_PIPELINE_EVICTION when they do, since we're no longer usable.
+    if (stream_info_map_[evicted_id].state == STREAM_READ_PENDING) {
+      stream_info_map_[evicted_id].state = STREAM_READ_EVICTED;
+      CompletionCallback callback =
+          stream_info_map_[evicted_id].read_headers_callback;
+      callback.Run(ERR_PIPELINE_EVICTION);
+      if (!weak_this) {
+        return;
+      }
+    }
+  }
+}
+
 void HttpPipelinedConnectionImpl::Close(int pipeline_id,
                                         bool not_reusable) {
   CHECK(ContainsKey(stream_info_map_, pipeline_id));
@@ -662,6 +700,13 @@ void HttpPipelinedConnectionImpl::SetConnectionReused(int pipeline_id) {
   connection_->set_is_reused(true);
 }
 
+bool HttpPipelinedConnectionImpl::GetLoadTimingInfo(
+    int pipeline_id,
+    LoadTimingInfo* load_timing_info) const {
+  return connection_->GetLoadTimingInfo(IsConnectionReused(pipeline_id),
+                                        load_timing_info);
+}
+
 void HttpPipelinedConnectionImpl::GetSSLInfo(int pipeline_id,
                                              SSLInfo* ssl_info) {
   CHECK(ContainsKey(stream_info_map_, pipeline_id));
@@ -729,6 +774,11 @@ void HttpPipelinedConnectionImpl::CheckHeadersForPipelineCompatibility(
     return;
   }
   ReportPipelineFeedback(pipeline_id, OK);
+  delegate_->OnPipelineResponseHeaders(
+      this, info->headers->GetContentLength(),
+      base::TimeTicks::Now() -
+          stream_info_map_[pipeline_id].send_complete_time,
+      request_order_.size());
 }
 
 void HttpPipelinedConnectionImpl::ReportPipelineFeedback(int pipeline_id,
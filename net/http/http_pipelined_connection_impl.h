@@ -27,6 +27,7 @@
 namespace net {
 
 class ClientSocketHandle;
+struct LoadTimingInfo;
 class GrowableIOBuffer;
 class HostPortPair;
 class HttpNetworkSession;
@@ -83,6 +84,7 @@ class NET_EXPORT_PRIVATE HttpPipelinedConnectionImpl
   virtual int depth() const OVERRIDE;
   virtual bool usable() const OVERRIDE;
   virtual bool active() const OVERRIDE;
+  virtual void EvictQueuedRequests() OVERRIDE;
 
   // Used by HttpStreamFactoryImpl.
   virtual const SSLConfig& used_ssl_config() const OVERRIDE;
@@ -134,6 +136,9 @@ class NET_EXPORT_PRIVATE HttpPipelinedConnectionImpl
 
   void SetConnectionReused(int pipeline_id);
 
+  bool GetLoadTimingInfo(int pipeline_id,
+                         LoadTimingInfo* load_timing_info) const;
+
   void GetSSLInfo(int pipeline_id,
                   SSLInfo* ssl_info);
 
@@ -196,6 +201,7 @@ class NET_EXPORT_PRIVATE HttpPipelinedConnectionImpl
     CompletionCallback pending_user_callback;
     StreamState state;
     NetLog::Source source;
+    base::TimeTicks send_complete_time;
   };
 
   typedef std::map<int, StreamInfo> StreamInfoMap;
@@ -279,6 +285,11 @@ class NET_EXPORT_PRIVATE HttpPipelinedConnectionImpl
   // HttpPipelinedSockets indicates the connection was suddenly closed.
   int DoEvictPendingReadHeaders(int result);
 
+  // Evicts the requests in |request_order_| without touching the read loop,
+  // which may still be reading the active response. Posted by
+  // EvictQueuedRequests().
+  void EvictQueuedReads();
+
   // Determines if the response headers indicate pipelining will work. This is
   // called every time we receive headers.
   void CheckHeadersForPipelineCompatibility(int pipeline_id, int result);
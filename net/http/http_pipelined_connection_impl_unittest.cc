@@ -41,6 +41,11 @@ class MockPipelineDelegate : public HttpPipelinedConnection::Delegate {
   MOCK_METHOD2(OnPipelineFeedback, void(
       HttpPipelinedConnection* pipeline,
       HttpPipelinedConnection::Feedback feedback));
+  MOCK_METHOD4(OnPipelineResponseHeaders, void(
+      HttpPipelinedConnection* pipeline,
+      int64 content_length,
+      base::TimeDelta time_to_headers,
+      int num_responses_behind));
 };
 
 class SuddenCloseObserver : public MessageLoop::TaskObserver {
@@ -1497,6 +1502,101 @@ TEST_F(HttpPipelinedConnectionImplTest, FeedbackOnAuthenticationRequired) {
   TestSyncRequest(stream, "ok.html");
 }
 
+TEST_F(HttpPipelinedConnectionImplTest, ReportsResponseHeaders) {
+  MockWrite writes[] = {
+    MockWrite(SYNCHRONOUS, 0, "GET /ok.html HTTP/1.1\r\n\r\n"),
+    MockWrite(SYNCHRONOUS, 1, "GET /ko.html HTTP/1.1\r\n\r\n"),
+  };
+  MockRead reads[] = {
+    MockRead(SYNCHRONOUS, 2, "HTTP/1.1 200 OK\r\n"),
+    MockRead(SYNCHRONOUS, 3, "Content-Length: 7\r\n\r\n"),
+    MockRead(SYNCHRONOUS, 4, "ok.html"),
+    MockRead(SYNCHRONOUS, 5, "HTTP/1.1 200 OK\r\n"),
+    MockRead(SYNCHRONOUS, 6, "Content-Length: 7\r\n\r\n"),
+    MockRead(SYNCHRONOUS, 7, "ko.html"),
+  };
+  Initialize(reads, arraysize(reads), writes, arraysize(writes));
+
+  scoped_ptr<HttpStream> stream1(NewTestStream("ok.html"));
+  scoped_ptr<HttpStream> stream2(NewTestStream("ko.html"));
+
+  HttpRequestHeaders headers;
+  HttpResponseInfo response1;
+  EXPECT_EQ(OK, stream1->SendRequest(headers, NULL, &response1,
+                                     callback_.callback()));
+  HttpResponseInfo response2;
+  EXPECT_EQ(OK, stream2->SendRequest(headers, NULL, &response2,
+                                     callback_.callback()));
+
+  EXPECT_CALL(delegate_,
+              OnPipelineResponseHeaders(pipeline_.get(), 7, _, 1))
+      .Times(1);
+  EXPECT_EQ(OK, stream1->ReadResponseHeaders(callback_.callback()));
+  ExpectResponse("ok.html", stream1, false);
+  stream1->Close(false);
+
+  EXPECT_CALL(delegate_,
+              OnPipelineResponseHeaders(pipeline_.get(), 7, _, 0))
+      .Times(1);
+  EXPECT_EQ(OK, stream2->ReadResponseHeaders(callback_.callback()));
+  ExpectResponse("ko.html", stream2, false);
+  stream2->Close(false);
+}
+
+TEST_F(HttpPipelinedConnectionImplTest, EvictQueuedRequests) {
+  MockWrite writes[] = {
+    MockWrite(SYNCHRONOUS, 0, "GET /big.html HTTP/1.1\r\n\r\n"),
+    MockWrite(SYNCHRONOUS, 1, "GET /read_evicted.html HTTP/1.1\r\n\r\n"),
+    MockWrite(SYNCHRONOUS, 2, "GET /read_rejected.html HTTP/1.1\r\n\r\n"),
+  };
+  MockRead reads[] = {
+    MockRead(SYNCHRONOUS, 3, "HTTP/1.1 200 OK\r\n"),
+    MockRead(SYNCHRONOUS, 4, "Content-Length: 8\r\n\r\n"),
+    MockRead(SYNCHRONOUS, 5, "big.html"),
+  };
+  Initialize(reads, arraysize(reads), writes, arraysize(writes));
+
+  scoped_ptr<HttpStream> big_stream(NewTestStream("big.html"));
+  scoped_ptr<HttpStream> read_evicted_stream(
+      NewTestStream("read_evicted.html"));
+  scoped_ptr<HttpStream> read_rejected_stream(
+      NewTestStream("read_rejected.html"));
+
+  HttpRequestHeaders headers;
+  HttpResponseInfo response;
+  EXPECT_EQ(OK, big_stream->SendRequest(headers, NULL, &response,
+                                        callback_.callback()));
+  EXPECT_EQ(OK, read_evicted_stream->SendRequest(headers, NULL, &response,
+                                                 callback_.callback()));
+  EXPECT_EQ(OK, read_rejected_stream->SendRequest(headers, NULL, &response,
+                                                  callback_.callback()));
+
+  TestCompletionCallback read_evicted_callback;
+  EXPECT_EQ(ERR_IO_PENDING,
+            read_evicted_stream->ReadResponseHeaders(
+                read_evicted_callback.callback()));
+
+  EXPECT_EQ(OK, big_stream->ReadResponseHeaders(callback_.callback()));
+  pipeline_->EvictQueuedRequests();
+  EXPECT_FALSE(pipeline_->usable());
+
+  // The queued requests are evicted before the large response is done.
+  EXPECT_EQ(ERR_PIPELINE_EVICTION, read_evicted_callback.WaitForResult());
+  read_evicted_stream->Close(true);
+  EXPECT_EQ(ERR_PIPELINE_EVICTION,
+            read_rejected_stream->ReadResponseHeaders(callback_.callback()));
+  read_rejected_stream->Close(true);
+
+  ExpectResponse("big.html", big_stream, false);
+  big_stream->Close(false);
+
+  scoped_ptr<HttpStream> rejected_stream(NewTestStream("rejected.html"));
+  EXPECT_EQ(ERR_PIPELINE_EVICTION,
+            rejected_stream->SendRequest(headers, NULL, &response,
+                                         callback_.callback()));
+  rejected_stream->Close(true);
+}
+
 TEST_F(HttpPipelinedConnectionImplTest, OnPipelineHasCapacity) {
   MockWrite writes[] = {
     MockWrite(SYNCHRONOUS, 0, "GET /ok.html HTTP/1.1\r\n\r\n"),
@@ -89,6 +89,14 @@ void HttpPipelinedHostForced::OnPipelineFeedback(
   // We don't care. We always pipeline.
 }
 
+void HttpPipelinedHostForced::OnPipelineResponseHeaders(
+    HttpPipelinedConnection* pipeline,
+    int64 content_length,
+    base::TimeDelta time_to_headers,
+    int num_responses_behind) {
+  // Forced pipelines never evict, since evicted requests wouldn't be retried.
+}
+
 Value* HttpPipelinedHostForced::PipelineInfoToValue() const {
   ListValue* list_value = new ListValue();
   if (pipeline_.get()) {
@@ -66,6 +66,12 @@ class NET_EXPORT_PRIVATE HttpPipelinedHostForced
       HttpPipelinedConnection* pipeline,
       HttpPipelinedConnection::Feedback feedback) OVERRIDE;
 
+  virtual void OnPipelineResponseHeaders(
+      HttpPipelinedConnection* pipeline,
+      int64 content_length,
+      base::TimeDelta time_to_headers,
+      int num_responses_behind) OVERRIDE;
+
  private:
   // Called when a pipeline is empty and there are no pending requests. Closes
   // the connection.
@@ -4,6 +4,9 @@
 
 #include "net/http/http_pipelined_host_impl.h"
 
+#include <algorithm>
+
+#include "base/metrics/histogram.h"
 #include "base/stl_util.h"
 #include "base/values.h"
 #include "net/http/http_pipelined_connection_impl.h"
@@ -19,6 +22,25 @@ namespace net {
 // costing too much performance. Until then, this is just a bad guess.
 static const int kNumKnownSuccessesThreshold = 3;
 
+// Number of responses to see before the pipeline depth follows the measured
+// responses instead of max_pipeline_depth().
+static const int kMinResponseSamplesForAdaptiveDepth = 4;
+
+// Weight of the latest response in the moving averages, as 1 / kAverageWeight.
+static const int kAverageWeight = 8;
+
+// Bytes of responses we try to keep in flight on one pipeline. Deeper
+// pipelines make it more likely that a request waits behind a slow response.
+static const int64 kPipelineWindowBytes = 64 * 1024;
+
+// Hosts whose headers take longer than this get twice the window.
+static const int kSlowTimeToHeadersMs = 150;
+
+// Responses at least this large keep the requests queued behind them waiting
+// for several round trips on typical connections, so those requests are moved
+// to other connections.
+static const int64 kHeadOfLineBlockingSize = 256 * 1024;
+
 HttpPipelinedHostImpl::HttpPipelinedHostImpl(
     HttpPipelinedHost::Delegate* delegate,
     const HttpPipelinedHost::Key& key,
@@ -27,7 +49,11 @@ HttpPipelinedHostImpl::HttpPipelinedHostImpl(
     : delegate_(delegate),
       key_(key),
       factory_(factory),
-      capability_(capability) {
+      capability_(capability),
+      num_response_samples_(0),
+      average_response_size_(0),
+      adaptive_depth_(max_pipeline_depth()),
+      num_head_of_line_evictions_(0) {
   if (!factory) {
     factory_.reset(new HttpPipelinedConnectionImpl::Factory());
   }
@@ -35,6 +61,30 @@ HttpPipelinedHostImpl::HttpPipelinedHostImpl(
 
 HttpPipelinedHostImpl::~HttpPipelinedHostImpl() {
   CHECK(pipelines_.empty());
+  if (num_response_samples_ >= kMinResponseSamplesForAdaptiveDepth) {
+    UMA_HISTOGRAM_CUSTOM_COUNTS("Net.Pipelining.AdaptiveDepth",
+                                adaptive_depth_, 1,
+                                max_adaptive_pipeline_depth() + 1,
+                                max_adaptive_pipeline_depth() + 1);
+  }
+}
+
+// static
+int HttpPipelinedHostImpl::ComputePipelineDepth(
+    int64 average_response_size,
+    base::TimeDelta average_time_to_headers) {
+  int64 window = kPipelineWindowBytes;
+  if (average_time_to_headers.InMilliseconds() > kSlowTimeToHeadersMs) {
+    window *= 2;
+  }
+  int64 depth = window / std::max(average_response_size, static_cast<int64>(1));
+  depth = std::min(depth, static_cast<int64>(max_adaptive_pipeline_depth()));
+  return static_cast<int>(std::max(depth, static_cast<int64>(1)));
+}
+
+// static
+bool HttpPipelinedHostImpl::IsHeadOfLineBlocking(int64 content_length) {
+  return content_length >= kHeadOfLineBlockingSize;
 }
 
 HttpPipelinedStream* HttpPipelinedHostImpl::CreateStreamOnNewPipeline(
@@ -149,12 +199,43 @@ void HttpPipelinedHostImpl::OnPipelineFeedback(
   }
 }
 
+void HttpPipelinedHostImpl::OnPipelineResponseHeaders(
+    HttpPipelinedConnection* pipeline,
+    int64 content_length,
+    base::TimeDelta time_to_headers,
+    int num_responses_behind) {
+  CHECK(ContainsKey(pipelines_, pipeline));
+  if (content_length >= 0) {
+    if (num_response_samples_ == 0) {
+      average_response_size_ = content_length;
+      average_time_to_headers_ = time_to_headers;
+    } else {
+      average_response_size_ +=
+          (content_length - average_response_size_) / kAverageWeight;
+      average_time_to_headers_ +=
+          (time_to_headers - average_time_to_headers_) / kAverageWeight;
+    }
+    ++num_response_samples_;
+    if (num_response_samples_ >= kMinResponseSamplesForAdaptiveDepth) {
+      adaptive_depth_ = ComputePipelineDepth(average_response_size_,
+                                             average_time_to_headers_);
+    }
+  }
+
+  if (num_responses_behind > 0 && IsHeadOfLineBlocking(content_length)) {
+    ++num_head_of_line_evictions_;
+    UMA_HISTOGRAM_COUNTS_100("Net.Pipelining.HeadOfLineEvictedRequests",
+                             num_responses_behind);
+    pipeline->EvictQueuedRequests();
+  }
+}
+
 int HttpPipelinedHostImpl::GetPipelineCapacity() const {
   int capacity = 0;
   switch (capability_) {
     case PIPELINE_CAPABLE:
     case PIPELINE_PROBABLY_CAPABLE:
-      capacity = max_pipeline_depth();
+      capacity = adaptive_depth_;
       break;
 
     case PIPELINE_INCAPABLE:
@@ -202,6 +283,13 @@ Value* HttpPipelinedHostImpl::PipelineInfoToValue() const {
     pipeline_dict->SetBoolean("usable", it->first->usable());
     pipeline_dict->SetBoolean("active", it->first->active());
     pipeline_dict->SetInteger("source_id", it->first->net_log().source().id);
+    pipeline_dict->SetInteger("average_response_size",
+                              static_cast<int>(average_response_size_));
+    pipeline_dict->SetInteger(
+        "average_time_to_headers_ms",
+        static_cast<int>(average_time_to_headers_.InMilliseconds()));
+    pipeline_dict->SetInteger("head_of_line_evictions",
+                              num_head_of_line_evictions_);
     list_value->Append(pipeline_dict);
   }
   return list_value;
@@ -66,16 +66,42 @@ class NET_EXPORT_PRIVATE HttpPipelinedHostImpl
       HttpPipelinedConnection* pipeline,
       HttpPipelinedConnection::Feedback feedback) OVERRIDE;
 
+  // Updates the response statistics that size the pipelines of this host.
+  // Evicts the requests queued behind a response that is large enough to block
+  // them.
+  virtual void OnPipelineResponseHeaders(
+      HttpPipelinedConnection* pipeline,
+      int64 content_length,
+      base::TimeDelta time_to_headers,
+      int num_responses_behind) OVERRIDE;
+
   virtual const Key& GetKey() const OVERRIDE;
 
   // Creates a Value summary of this host's |pipelines_|. Caller assumes
   // ownership of the returned Value.
   virtual base::Value* PipelineInfoToValue() const OVERRIDE;
 
-  // Returns the maximum number of in-flight pipelined requests we'll allow on a
-  // single connection.
+  // Returns the number of in-flight pipelined requests we'll allow on a single
+  // connection until we've seen enough responses to size the pipeline.
   static int max_pipeline_depth() { return 3; }
 
+  // Returns the upper bound of the adaptive pipeline depth.
+  static int max_adaptive_pipeline_depth() { return 6; }
+
+  // Returns the pipeline depth for a host whose responses average
+  // |average_response_size| bytes and whose headers arrive
+  // |average_time_to_headers| after the request is sent. Enough requests are
+  // allowed to keep about one window of response bytes in flight, and the
+  // window is larger for slow hosts, since a new request costs them more.
+  // Returns 1 when responses are too large to be worth pipelining.
+  static int ComputePipelineDepth(int64 average_response_size,
+                                  base::TimeDelta average_time_to_headers);
+
+  // Returns true if a response of |content_length| bytes would hold up the
+  // requests behind it long enough that they're better off on another
+  // connection.
+  static bool IsHeadOfLineBlocking(int64 content_length);
+
  private:
   struct PipelineInfo {
     PipelineInfo();
@@ -110,6 +136,17 @@ class NET_EXPORT_PRIVATE HttpPipelinedHostImpl
   scoped_ptr<HttpPipelinedConnection::Factory> factory_;
   HttpPipelinedHostCapability capability_;
 
+  // Moving averages over the reusable responses received by all pipelines of
+  // this host, and the depth computed from them.
+  int num_response_samples_;
+  int64 average_response_size_;
+  base::TimeDelta average_time_to_headers_;
+  int adaptive_depth_;
+
+  // Number of times requests were evicted from a pipeline because of a large
+  // response ahead of them.
+  int num_head_of_line_evictions_;
+
   DISALLOW_COPY_AND_ASSIGN(HttpPipelinedHostImpl);
 };
 
@@ -303,6 +303,82 @@ TEST_F(HttpPipelinedHostImplTest, HeedsSocketErrorOnFirstRequestWithPipeline) {
   ClearTestPipeline(pipeline);
 }
 
+TEST_F(HttpPipelinedHostImplTest, ComputePipelineDepth) {
+  const base::TimeDelta kFast = base::TimeDelta::FromMilliseconds(20);
+  const base::TimeDelta kSlow = base::TimeDelta::FromMilliseconds(500);
+  EXPECT_EQ(HttpPipelinedHostImpl::max_adaptive_pipeline_depth(),
+            HttpPipelinedHostImpl::ComputePipelineDepth(0, kFast));
+  EXPECT_EQ(HttpPipelinedHostImpl::max_adaptive_pipeline_depth(),
+            HttpPipelinedHostImpl::ComputePipelineDepth(1024, kFast));
+  EXPECT_EQ(4, HttpPipelinedHostImpl::ComputePipelineDepth(16 * 1024, kFast));
+  EXPECT_EQ(1, HttpPipelinedHostImpl::ComputePipelineDepth(64 * 1024, kFast));
+  EXPECT_EQ(2, HttpPipelinedHostImpl::ComputePipelineDepth(64 * 1024, kSlow));
+  EXPECT_EQ(1, HttpPipelinedHostImpl::ComputePipelineDepth(1024 * 1024,
+                                                           kSlow));
+}
+
+TEST_F(HttpPipelinedHostImplTest, DepthGrowsWithSmallResponses) {
+  MockPipeline* pipeline = AddTestPipeline(
+      HttpPipelinedHostImpl::max_pipeline_depth(), true, true);
+  EXPECT_FALSE(host_->IsExistingPipelineAvailable());
+
+  for (int i = 0; i < 4; ++i) {
+    host_->OnPipelineResponseHeaders(pipeline, 2048,
+                                     base::TimeDelta::FromMilliseconds(50), 0);
+  }
+  EXPECT_TRUE(host_->IsExistingPipelineAvailable());
+
+  pipeline->SetState(HttpPipelinedHostImpl::max_adaptive_pipeline_depth(),
+                     true, true);
+  EXPECT_FALSE(host_->IsExistingPipelineAvailable());
+
+  ClearTestPipeline(pipeline);
+}
+
+TEST_F(HttpPipelinedHostImplTest, DepthShrinksWithLargeResponses) {
+  MockPipeline* pipeline = AddTestPipeline(1, true, true);
+  EXPECT_TRUE(host_->IsExistingPipelineAvailable());
+
+  for (int i = 0; i < 4; ++i) {
+    host_->OnPipelineResponseHeaders(pipeline, 128 * 1024,
+                                     base::TimeDelta::FromMilliseconds(50), 0);
+  }
+  EXPECT_FALSE(host_->IsExistingPipelineAvailable());
+
+  ClearTestPipeline(pipeline);
+}
+
+TEST_F(HttpPipelinedHostImplTest, UnknownSizesDontChangeDepth) {
+  MockPipeline* pipeline = AddTestPipeline(
+      HttpPipelinedHostImpl::max_pipeline_depth() - 1, true, true);
+
+  for (int i = 0; i < 8; ++i) {
+    host_->OnPipelineResponseHeaders(pipeline, -1,
+                                     base::TimeDelta::FromMilliseconds(50), 0);
+  }
+  EXPECT_TRUE(host_->IsExistingPipelineAvailable());
+
+  ClearTestPipeline(pipeline);
+}
+
+TEST_F(HttpPipelinedHostImplTest, EvictsRequestsBehindLargeResponse) {
+  MockPipeline* pipeline = AddTestPipeline(3, true, true);
+
+  EXPECT_CALL(*pipeline, EvictQueuedRequests())
+      .Times(0);
+  host_->OnPipelineResponseHeaders(pipeline, 1024,
+                                   base::TimeDelta::FromMilliseconds(50), 2);
+  host_->OnPipelineResponseHeaders(pipeline, 1024 * 1024,
+                                   base::TimeDelta::FromMilliseconds(50), 0);
+
+  EXPECT_CALL(*pipeline, EvictQueuedRequests())
+      .Times(1);
+  host_->OnPipelineResponseHeaders(pipeline, 1024 * 1024,
+                                   base::TimeDelta::FromMilliseconds(50), 2);
+
+  ClearTestPipeline(pipeline);
+}
+
 }  // anonymous namespace
 
 }  // namespace net
@@ -52,6 +52,7 @@ class MockPipeline : public HttpPipelinedConnection {
   virtual bool active() const OVERRIDE { return active_; }
 
   MOCK_METHOD0(CreateNewStream, HttpPipelinedStream*());
+  MOCK_METHOD0(EvictQueuedRequests, void());
   MOCK_METHOD1(OnStreamDeleted, void(int pipeline_id));
   MOCK_CONST_METHOD0(used_ssl_config, const SSLConfig&());
   MOCK_CONST_METHOD0(used_proxy_info, const ProxyInfo&());
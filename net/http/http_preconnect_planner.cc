@@ -0,0 +1,131 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_preconnect_planner.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "net/http/http_server_properties.h"
+#include "net/socket/client_socket_pool.h"
+
+namespace net {
+
+namespace {
+
+// The default limit of sockets per group of the socket pools. There is no
+// point in planning more preconnects than that.
+const int kMaxStreamsPerOrigin = 6;
+
+// Bounds the memory used by the planner. Origins that have no requests in
+// flight and no preconnected sockets are forgotten past this size.
+const size_t kMaxOrigins = 256;
+
+}  // namespace
+
+HttpPreconnectPlanner::OriginState::OriginState()
+    : num_active_requests(0),
+      peak_requests(0),
+      demand(0),
+      num_preconnected(0) {
+}
+
+HttpPreconnectPlanner::HttpPreconnectPlanner(
+    const HttpServerProperties* http_server_properties)
+    : http_server_properties_(http_server_properties),
+      num_hits_(0),
+      num_wasted_(0) {
+}
+
+HttpPreconnectPlanner::~HttpPreconnectPlanner() {
+}
+
+int HttpPreconnectPlanner::PlanPreconnect(const HostPortPair& origin,
+                                          int num_streams,
+                                          base::TimeTicks now) {
+  OriginState* state = GetState(origin);
+  ExpirePreconnects(state, now);
+
+  int planned = state->demand ? state->demand : num_streams;
+  if (http_server_properties_ && http_server_properties_->SupportsSpdy(origin))
+    planned = 1;
+  planned = std::max(1, std::min(planned, kMaxStreamsPerOrigin));
+
+  // The socket pools only open the sockets that are missing from the group,
+  // so the sockets preconnected earlier are part of the new ones.
+  if (planned > state->num_preconnected) {
+    state->num_preconnected = planned;
+    state->preconnect_time = now;
+  }
+  return planned;
+}
+
+bool HttpPreconnectPlanner::OnStreamRequested(const HostPortPair& origin,
+                                              base::TimeTicks now) {
+  OriginState* state = GetState(origin);
+  ExpirePreconnects(state, now);
+
+  state->num_active_requests++;
+  state->peak_requests = std::max(state->peak_requests,
+                                  state->num_active_requests);
+  if (!state->num_preconnected)
+    return false;
+
+  state->num_preconnected--;
+  num_hits_++;
+  return true;
+}
+
+void HttpPreconnectPlanner::OnStreamRequestDone(const HostPortPair& origin) {
+  OriginMap::iterator it = origins_.find(origin);
+  DCHECK(it != origins_.end());
+  OriginState& state = it->second;
+  DCHECK_GT(state.num_active_requests, 0);
+  if (--state.num_active_requests)
+    return;
+
+  // The burst of requests is over. Average it with the previous ones, but
+  // never plan less than what the last burst needed.
+  state.demand = std::max(state.peak_requests,
+                          (state.demand + state.peak_requests) / 2);
+  state.demand = std::min(state.demand, kMaxStreamsPerOrigin);
+  state.peak_requests = 0;
+}
+
+int HttpPreconnectPlanner::GetDemand(const HostPortPair& origin) const {
+  OriginMap::const_iterator it = origins_.find(origin);
+  return it == origins_.end() ? 0 : it->second.demand;
+}
+
+HttpPreconnectPlanner::OriginState* HttpPreconnectPlanner::GetState(
+    const HostPortPair& origin) {
+  OriginMap::iterator it = origins_.find(origin);
+  if (it != origins_.end())
+    return &it->second;
+
+  if (origins_.size() >= kMaxOrigins) {
+    for (it = origins_.begin(); it != origins_.end();) {
+      const OriginState& state = it->second;
+      if (!state.num_active_requests && !state.num_preconnected)
+        origins_.erase(it++);
+      else
+        ++it;
+    }
+  }
+  return &origins_[origin];
+}
+
+void HttpPreconnectPlanner::ExpirePreconnects(OriginState* state,
+                                              base::TimeTicks now) {
+  if (!state->num_preconnected)
+    return;
+  if (now - state->preconnect_time <
+      ClientSocketPool::unused_idle_socket_timeout()) {
+    return;
+  }
+  num_wasted_ += state->num_preconnected;
+  state->num_preconnected = 0;
+}
+
+}  // namespace net
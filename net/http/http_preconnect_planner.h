@@ -0,0 +1,90 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_HTTP_HTTP_PRECONNECT_PLANNER_H_
+#define NET_HTTP_HTTP_PRECONNECT_PLANNER_H_
+#pragma once
+
+#include <map>
+
+#include "base/basictypes.h"
+#include "base/time.h"
+#include "net/base/host_port_pair.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+class HttpServerProperties;
+
+// Learns how many streams each origin needs at the same time, so that the
+// preconnects of HttpStreamFactoryImpl warm as many sockets as the next page
+// load will use. Origins that are known to support SPDY only get one socket.
+//
+// It also keeps track of how many preconnected sockets were used (hits) and
+// how many timed out in the socket pools before any stream asked for them
+// (wasted). Preconnects are only counted as wasted when their origin is used
+// again.
+class NET_EXPORT_PRIVATE HttpPreconnectPlanner {
+ public:
+  // |http_server_properties| may be NULL, and must outlive this object.
+  explicit HttpPreconnectPlanner(
+      const HttpServerProperties* http_server_properties);
+  ~HttpPreconnectPlanner();
+
+  // Returns the number of streams to preconnect to |origin|, when |num_streams|
+  // were asked for.
+  int PlanPreconnect(const HostPortPair& origin,
+                     int num_streams,
+                     base::TimeTicks now);
+
+  // Records that a stream was requested for |origin|. Returns true if the
+  // request should find a preconnected socket.
+  bool OnStreamRequested(const HostPortPair& origin, base::TimeTicks now);
+
+  // Records that the request for a stream to |origin| is done.
+  void OnStreamRequestDone(const HostPortPair& origin);
+
+  // Returns the number of streams that |origin| needs at the same time, or 0
+  // if it is not known yet.
+  int GetDemand(const HostPortPair& origin) const;
+
+  int num_hits() const { return num_hits_; }
+  int num_wasted() const { return num_wasted_; }
+
+ private:
+  struct OriginState {
+    OriginState();
+
+    // Requests for streams that are not done yet.
+    int num_active_requests;
+    // The largest value of |num_active_requests| since it was last 0.
+    int peak_requests;
+    // The learned number of streams needed at the same time.
+    int demand;
+    // Preconnected sockets that no request used yet.
+    int num_preconnected;
+    base::TimeTicks preconnect_time;
+  };
+
+  typedef std::map<HostPortPair, OriginState> OriginMap;
+
+  // Returns the state of |origin|, which is created if needed.
+  OriginState* GetState(const HostPortPair& origin);
+
+  // Counts the preconnected sockets of |state| that were closed by the socket
+  // pools as wasted.
+  void ExpirePreconnects(OriginState* state, base::TimeTicks now);
+
+  const HttpServerProperties* const http_server_properties_;
+  OriginMap origins_;
+
+  int num_hits_;
+  int num_wasted_;
+
+  DISALLOW_COPY_AND_ASSIGN(HttpPreconnectPlanner);
+};
+
+}  // namespace net
+
+#endif  // NET_HTTP_HTTP_PRECONNECT_PLANNER_H_
@@ -0,0 +1,107 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_preconnect_planner.h"
+
+#include "base/time.h"
+#include "net/base/host_port_pair.h"
+#include "net/http/http_server_properties_impl.h"
+#include "net/socket/client_socket_pool.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+class HttpPreconnectPlannerTest : public testing::Test {
+ protected:
+  HttpPreconnectPlannerTest()
+      : planner_(&http_server_properties_),
+        origin_("www.google.com", 80),
+        now_(base::TimeTicks::Now()) {
+  }
+
+  // Requests |num_streams| streams to |origin_| at the same time.
+  void RequestStreams(int num_streams) {
+    for (int i = 0; i < num_streams; ++i)
+      planner_.OnStreamRequested(origin_, now_);
+    for (int i = 0; i < num_streams; ++i)
+      planner_.OnStreamRequestDone(origin_);
+  }
+
+  HttpServerPropertiesImpl http_server_properties_;
+  HttpPreconnectPlanner planner_;
+  const HostPortPair origin_;
+  base::TimeTicks now_;
+};
+
+TEST_F(HttpPreconnectPlannerTest, UnknownOrigin) {
+  EXPECT_EQ(0, planner_.GetDemand(origin_));
+  EXPECT_EQ(2, planner_.PlanPreconnect(origin_, 2, now_));
+
+  // Requests are always capped to the size of a socket pool group.
+  HostPortPair other_origin("www.example.com", 80);
+  EXPECT_EQ(6, planner_.PlanPreconnect(other_origin, 10, now_));
+}
+
+TEST_F(HttpPreconnectPlannerTest, LearnDemand) {
+  RequestStreams(4);
+  EXPECT_EQ(4, planner_.GetDemand(origin_));
+  EXPECT_EQ(4, planner_.PlanPreconnect(origin_, 1, now_));
+
+  // Bursts are averaged, but the demand covers at least the last one.
+  RequestStreams(2);
+  EXPECT_EQ(3, planner_.GetDemand(origin_));
+  RequestStreams(1);
+  EXPECT_EQ(2, planner_.GetDemand(origin_));
+  RequestStreams(5);
+  EXPECT_EQ(5, planner_.GetDemand(origin_));
+  RequestStreams(1);
+  EXPECT_EQ(3, planner_.GetDemand(origin_));
+
+  // Requests that do not overlap are not a burst.
+  for (int i = 0; i < 5; ++i) {
+    planner_.OnStreamRequested(origin_, now_);
+    planner_.OnStreamRequestDone(origin_);
+  }
+  EXPECT_EQ(1, planner_.GetDemand(origin_));
+}
+
+TEST_F(HttpPreconnectPlannerTest, SpdyOrigin) {
+  RequestStreams(4);
+  http_server_properties_.SetSupportsSpdy(origin_, true);
+  EXPECT_EQ(1, planner_.PlanPreconnect(origin_, 2, now_));
+}
+
+TEST_F(HttpPreconnectPlannerTest, HitsAndWaste) {
+  EXPECT_EQ(3, planner_.PlanPreconnect(origin_, 3, now_));
+  EXPECT_TRUE(planner_.OnStreamRequested(origin_, now_));
+  EXPECT_TRUE(planner_.OnStreamRequested(origin_, now_));
+  planner_.OnStreamRequestDone(origin_);
+  planner_.OnStreamRequestDone(origin_);
+  EXPECT_EQ(2, planner_.num_hits());
+  EXPECT_EQ(0, planner_.num_wasted());
+
+  // The last socket is closed by the pool before anybody uses it.
+  base::TimeTicks later = now_ + ClientSocketPool::unused_idle_socket_timeout();
+  EXPECT_FALSE(planner_.OnStreamRequested(origin_, later));
+  planner_.OnStreamRequestDone(origin_);
+  EXPECT_EQ(2, planner_.num_hits());
+  EXPECT_EQ(1, planner_.num_wasted());
+}
+
+TEST_F(HttpPreconnectPlannerTest, RepeatedPreconnects) {
+  // Sockets that are already preconnected are part of the new plan.
+  EXPECT_EQ(2, planner_.PlanPreconnect(origin_, 2, now_));
+  EXPECT_EQ(2, planner_.PlanPreconnect(origin_, 2, now_));
+  for (int i = 0; i < 3; ++i)
+    planner_.OnStreamRequested(origin_, now_);
+  EXPECT_EQ(2, planner_.num_hits());
+  for (int i = 0; i < 3; ++i)
+    planner_.OnStreamRequestDone(origin_);
+}
+
+}  // namespace
+
+}  // namespace net
@@ -183,6 +183,8 @@ int HttpProxyConnectJob::DoTransportConnectComplete(int result) {
   if (result != OK)
     return ERR_PROXY_CONNECTION_FAILED;
 
+  *mutable_connect_timing() = transport_socket_handle_->connect_timing();
+
   // Reset the timer to just the length of time allowed for HttpProxy handshake
   // so that a fast TCP connection plus a slow HttpProxy failure doesn't take
   // longer to timeout than it should.
@@ -234,6 +236,8 @@ int HttpProxyConnectJob::DoSSLConnectComplete(int result) {
     return ERR_PROXY_CONNECTION_FAILED;
   }
 
+  *mutable_connect_timing() = transport_socket_handle_->connect_timing();
+
   SSLClientSocket* ssl =
       static_cast<SSLClientSocket*>(transport_socket_handle_->socket());
   using_spdy_ = ssl->was_spdy_negotiated();
@@ -282,6 +286,9 @@ int HttpProxyConnectJob::DoHttpProxyConnect() {
 int HttpProxyConnectJob::DoHttpProxyConnectComplete(int result) {
   if (result == OK || result == ERR_PROXY_AUTH_REQUESTED ||
       result == ERR_HTTPS_PROXY_TUNNEL_RESPONSE) {
+      // Streams on an existing SPDY proxy session have no connect times.
+      if (!connect_timing().connect_start.is_null())
+        mutable_connect_timing()->connect_end = base::TimeTicks::Now();
       set_socket(transport_socket_.release());
   }
 
@@ -132,6 +132,18 @@ void CheckDoesNotHaveEmbededNulls(const std::string& str) {
   CHECK(str.find('\0') == std::string::npos);
 }
 
+// Returns a case-insensitive hash of the header name in [begin, end).
+template <typename Iterator>
+uint32 HashHeaderName(Iterator begin, Iterator end) {
+  // FNV-1a.
+  uint32 hash = 2166136261u;
+  for (; begin != end; ++begin) {
+    hash ^= static_cast<unsigned char>(base::ToLowerASCII(*begin));
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
 }  // namespace
 
 struct HttpResponseHeaders::ParsedHeader {
@@ -143,6 +155,12 @@ struct HttpResponseHeaders::ParsedHeader {
   std::string::const_iterator name_end;
   std::string::const_iterator value_begin;
   std::string::const_iterator value_end;
+
+  // Case-insensitive hash of the name, and index in parsed_ of the next
+  // header in the same bucket of the header name index.  Unused for
+  // continuations.
+  uint32 name_hash;
+  size_t next_in_bucket;
 };
 
 //-----------------------------------------------------------------------------
@@ -172,6 +190,7 @@ HttpResponseHeaders::HttpResponseHeaders(const std::string& raw_input)
 HttpResponseHeaders::HttpResponseHeaders(const Pickle& pickle,
                                          PickleIterator* iter)
     : response_code_(-1) {
+  ResetHeaderIndex();
   std::string raw_input;
   if (pickle.ReadString(iter, &raw_input))
     Parse(raw_input);
@@ -393,6 +412,8 @@ void HttpResponseHeaders::ReplaceStatusLine(const std::string& new_status) {
 }
 
 void HttpResponseHeaders::Parse(const std::string& raw_input) {
+  DCHECK(parsed_.empty());
+  ResetHeaderIndex();
   raw_headers_.reserve(raw_input.size());
 
   // ParseStatusLine adds a normalized status line to raw_headers_
@@ -595,13 +616,17 @@ bool HttpResponseHeaders::HasHeaderValue(const std::string& name,
                                          const std::string& value) const {
   // The value has to be an exact match.  This is important since
   // 'cache-control: no-cache' != 'cache-control: no-cache="foo"'
-  void* iter = NULL;
-  std::string temp;
-  while (EnumerateHeader(&iter, name, &temp)) {
-    if (value.size() == temp.size() &&
-        std::equal(temp.begin(), temp.end(), value.begin(),
-                   base::CaseInsensitiveCompare<char>()))
-      return true;
+  for (size_t i = FindHeader(0, name); i != std::string::npos;
+       i = FindHeader(i, name)) {
+    // Check the values of this header, including its continuations.
+    do {
+      const ParsedHeader& header = parsed_[i];
+      if (static_cast<size_t>(header.value_end - header.value_begin) ==
+              value.size() &&
+          std::equal(header.value_begin, header.value_end, value.begin(),
+                     base::CaseInsensitiveCompare<char>()))
+        return true;
+    } while (++i < parsed_.size() && parsed_[i].is_continuation());
   }
   return false;
 }
@@ -610,7 +635,12 @@ bool HttpResponseHeaders::HasHeader(const std::string& name) const {
   return FindHeader(0, name) != std::string::npos;
 }
 
+bool HttpResponseHeaders::HasNoStoreDirective() const {
+  return GetCacheDirectives().no_store;
+}
+
 HttpResponseHeaders::HttpResponseHeaders() : response_code_(-1) {
+  ResetHeaderIndex();
 }
 
 HttpResponseHeaders::~HttpResponseHeaders() {
@@ -734,9 +764,12 @@ void HttpResponseHeaders::ParseStatusLine(
 }
 
 size_t HttpResponseHeaders::FindHeader(size_t from,
-                                       const std::string& search) const {
-  for (size_t i = from; i < parsed_.size(); ++i) {
-    if (parsed_[i].is_continuation())
+                                       const StringPiece& search) const {
+  uint32 hash = HashHeaderName(search.begin(), search.end());
+  for (size_t i = header_buckets_[hash % kNumHeaderBuckets];
+       i != std::string::npos; i = parsed_[i].next_in_bucket) {
+    // The headers of a bucket are in order.
+    if (i < from || parsed_[i].name_hash != hash)
       continue;
     const std::string::const_iterator& name_begin = parsed_[i].name_begin;
     const std::string::const_iterator& name_end = parsed_[i].name_end;
@@ -749,6 +782,85 @@ size_t HttpResponseHeaders::FindHeader(size_t from,
   return std::string::npos;
 }
 
+void HttpResponseHeaders::ResetHeaderIndex() {
+  std::fill(header_buckets_, header_buckets_ + kNumHeaderBuckets,
+            std::string::npos);
+  std::fill(header_bucket_tails_, header_bucket_tails_ + kNumHeaderBuckets,
+            std::string::npos);
+  cache_directives_parsed_ = false;
+}
+
+const HttpResponseHeaders::CacheDirectives&
+HttpResponseHeaders::GetCacheDirectives() const {
+  if (cache_directives_parsed_)
+    return cache_directives_;
+
+  CacheDirectives& directives = cache_directives_;
+  directives.no_cache = false;
+  directives.no_store = false;
+  directives.must_revalidate = false;
+  directives.pragma_no_cache = false;
+  directives.vary_star = false;
+  directives.has_max_age = false;
+  directives.max_age_seconds = 0;
+  directives.has_stale_while_revalidate = false;
+  directives.stale_while_revalidate_seconds = 0;
+
+  const char kMaxAgePrefix[] = "max-age=";
+  const size_t kMaxAgePrefixLen = arraysize(kMaxAgePrefix) - 1;
+  const char kStaleWhileRevalidatePrefix[] = "stale-while-revalidate=";
+  const size_t kStaleWhileRevalidatePrefixLen =
+      arraysize(kStaleWhileRevalidatePrefix) - 1;
+
+  // Each value is matched exactly (case-insensitively), like HasHeaderValue()
+  // does, and the first max-age and stale-while-revalidate values win, like in
+  // GetMaxAgeValue().
+  const StringPiece kCacheControl("cache-control");
+  for (size_t i = FindHeader(0, kCacheControl); i != std::string::npos;
+       i = FindHeader(i, kCacheControl)) {
+    do {
+      std::string::const_iterator value_begin = parsed_[i].value_begin;
+      std::string::const_iterator value_end = parsed_[i].value_end;
+      if (LowerCaseEqualsASCII(value_begin, value_end, "no-cache")) {
+        directives.no_cache = true;
+      } else if (LowerCaseEqualsASCII(value_begin, value_end, "no-store")) {
+        directives.no_store = true;
+      } else if (LowerCaseEqualsASCII(value_begin, value_end,
+                                      "must-revalidate")) {
+        directives.must_revalidate = true;
+      } else if (!directives.has_max_age &&
+                 static_cast<size_t>(value_end - value_begin) >
+                     kMaxAgePrefixLen &&
+                 LowerCaseEqualsASCII(value_begin,
+                                      value_begin + kMaxAgePrefixLen,
+                                      kMaxAgePrefix)) {
+        directives.has_max_age = true;
+        base::StringToInt64(StringPiece(value_begin + kMaxAgePrefixLen,
+                                        value_end),
+                            &directives.max_age_seconds);
+      } else if (!directives.has_stale_while_revalidate &&
+                 static_cast<size_t>(value_end - value_begin) >
+                     kStaleWhileRevalidatePrefixLen &&
+                 LowerCaseEqualsASCII(
+                     value_begin,
+                     value_begin + kStaleWhileRevalidatePrefixLen,
+                     kStaleWhileRevalidatePrefix)) {
+        directives.has_stale_while_revalidate = true;
+        base::StringToInt64(
+            StringPiece(value_begin + kStaleWhileRevalidatePrefixLen,
+                        value_end),
+            &directives.stale_while_revalidate_seconds);
+      }
+    } while (++i < parsed_.size() && parsed_[i].is_continuation());
+  }
+
+  directives.pragma_no_cache = HasHeaderValue("pragma", "no-cache");
+  directives.vary_star = HasHeaderValue("vary", "*");
+
+  cache_directives_parsed_ = true;
+  return directives;
+}
+
 void HttpResponseHeaders::AddHeader(std::string::const_iterator name_begin,
                                     std::string::const_iterator name_end,
                                     std::string::const_iterator values_begin,
@@ -776,6 +888,17 @@ void HttpResponseHeaders::AddToParsed(std::string::const_iterator name_begin,
   header.name_end = name_end;
   header.value_begin = value_begin;
   header.value_end = value_end;
+  header.name_hash = 0;
+  header.next_in_bucket = std::string::npos;
+  if (!header.is_continuation()) {
+    header.name_hash = HashHeaderName(name_begin, name_end);
+    size_t bucket = header.name_hash % kNumHeaderBuckets;
+    if (header_bucket_tails_[bucket] == std::string::npos)
+      header_buckets_[bucket] = parsed_.size();
+    else
+      parsed_[header_bucket_tails_[bucket]].next_in_bucket = parsed_.size();
+    header_bucket_tails_[bucket] = parsed_.size();
+  }
   parsed_.push_back(header);
 }
 
@@ -957,10 +1080,10 @@ TimeDelta HttpResponseHeaders::GetFreshnessLifetime(
   // Check for headers that force a response to never be fresh.  For backwards
   // compat, we treat "Pragma: no-cache" as a synonym for "Cache-Control:
   // no-cache" even though RFC 2616 does not specify it.
-  if (HasHeaderValue("cache-control", "no-cache") ||
-      HasHeaderValue("cache-control", "no-store") ||
-      HasHeaderValue("pragma", "no-cache") ||
-      HasHeaderValue("vary", "*"))  // see RFC 2616 section 13.6
+  const CacheDirectives& directives = GetCacheDirectives();
+  if (directives.no_cache || directives.no_store ||
+      directives.pragma_no_cache ||
+      directives.vary_star)  // see RFC 2616 section 13.6
     return TimeDelta();  // not fresh
 
   // NOTE: "Cache-Control: max-age" overrides Expires, so we only check the
@@ -1010,7 +1133,7 @@ TimeDelta HttpResponseHeaders::GetFreshnessLifetime(
   //
   if ((response_code_ == 200 || response_code_ == 203 ||
        response_code_ == 206) &&
-      !HasHeaderValue("cache-control", "must-revalidate")) {
+      !directives.must_revalidate) {
     // TODO(darin): Implement a smarter heuristic.
     Time last_modified_value;
     if (GetLastModifiedValue(&last_modified_value)) {
@@ -1077,30 +1200,47 @@ TimeDelta HttpResponseHeaders::GetCurrentAge(const Time& request_time,
   return current_age;
 }
 
+bool HttpResponseHeaders::IsWithinStaleWhileRevalidateWindow(
+    const Time& request_time,
+    const Time& response_time,
+    const Time& current_time) const {
+  // must-revalidate forbids serving the response stale, and the other
+  // directives below forbid serving it without validation at all.
+  const CacheDirectives& directives = GetCacheDirectives();
+  if (!directives.has_stale_while_revalidate ||
+      directives.stale_while_revalidate_seconds <= 0 ||
+      directives.must_revalidate || directives.no_cache ||
+      directives.no_store || directives.pragma_no_cache ||
+      directives.vary_star) {
+    return false;
+  }
+
+  // Compare the staleness rather than adding the window to the lifetime, which
+  // can be "infinite".
+  TimeDelta staleness =
+      GetCurrentAge(request_time, response_time, current_time) -
+      GetFreshnessLifetime(response_time);
+  return staleness <
+      TimeDelta::FromSeconds(directives.stale_while_revalidate_seconds);
+}
+
 bool HttpResponseHeaders::GetMaxAgeValue(TimeDelta* result) const {
-  std::string name = "cache-control";
-  std::string value;
+  const CacheDirectives& directives = GetCacheDirectives();
+  if (!directives.has_max_age)
+    return false;
 
-  const char kMaxAgePrefix[] = "max-age=";
-  const size_t kMaxAgePrefixLen = arraysize(kMaxAgePrefix) - 1;
+  *result = TimeDelta::FromSeconds(directives.max_age_seconds);
+  return true;
+}
 
-  void* iter = NULL;
-  while (EnumerateHeader(&iter, name, &value)) {
-    if (value.size() > kMaxAgePrefixLen) {
-      if (LowerCaseEqualsASCII(value.begin(),
-                               value.begin() + kMaxAgePrefixLen,
-                               kMaxAgePrefix)) {
-        int64 seconds;
-        base::StringToInt64(StringPiece(value.begin() + kMaxAgePrefixLen,
-                                        value.end()),
-                            &seconds);
-        *result = TimeDelta::FromSeconds(seconds);
-        return true;
-      }
-    }
-  }
+bool HttpResponseHeaders::GetStaleWhileRevalidateValue(
+    TimeDelta* result) const {
+  const CacheDirectives& directives = GetCacheDirectives();
+  if (!directives.has_stale_while_revalidate)
+    return false;
 
-  return false;
+  *result = TimeDelta::FromSeconds(directives.stale_while_revalidate_seconds);
+  return true;
 }
 
 bool HttpResponseHeaders::GetAgeValue(TimeDelta* result) const {
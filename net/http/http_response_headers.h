@@ -12,6 +12,7 @@
 #include "base/basictypes.h"
 #include "base/hash_tables.h"
 #include "base/memory/ref_counted.h"
+#include "base/string_piece.h"
 #include "net/base/net_export.h"
 #include "net/http/http_version.h"
 
@@ -165,6 +166,11 @@ class NET_EXPORT HttpResponseHeaders
   // The name is compared case insensitively.
   bool HasHeader(const std::string& name) const;
 
+  // Returns true if the response has a "cache-control: no-store" directive.
+  // This is the same as HasHeaderValue("cache-control", "no-store"), but the
+  // directives are only parsed once.
+  bool HasNoStoreDirective() const;
+
   // Get the mime type and charset values in lower case form from the headers.
   // Empty strings are returned if the values are not present.
   void GetMimeTypeAndCharset(std::string* mime_type,
@@ -206,10 +212,19 @@ class NET_EXPORT HttpResponseHeaders
                                 const base::Time& response_time,
                                 const base::Time& current_time) const;
 
+  // Returns true if the response may be served stale while it is revalidated
+  // in the background, because it is within the "Cache-Control:
+  // stale-while-revalidate" window past its freshness lifetime. See
+  // RequiresValidation for a description of this method's parameters.
+  bool IsWithinStaleWhileRevalidateWindow(const base::Time& request_time,
+                                          const base::Time& response_time,
+                                          const base::Time& current_time) const;
+
   // The following methods extract values from the response headers.  If a
   // value is not present, then false is returned.  Otherwise, true is returned
   // and the out param is assigned to the corresponding value.
   bool GetMaxAgeValue(base::TimeDelta* value) const;
+  bool GetStaleWhileRevalidateValue(base::TimeDelta* value) const;
   bool GetAgeValue(base::TimeDelta* value) const;
   bool GetDateValue(base::Time* value) const;
   bool GetLastModifiedValue(base::Time* value) const;
@@ -261,6 +276,22 @@ class NET_EXPORT HttpResponseHeaders
   struct ParsedHeader;
   typedef std::vector<ParsedHeader> HeaderList;
 
+  // The caching directives of the Cache-Control, Pragma and Vary headers.
+  struct CacheDirectives {
+    bool no_cache;
+    bool no_store;
+    bool must_revalidate;
+    bool pragma_no_cache;
+    bool vary_star;
+    bool has_max_age;
+    int64 max_age_seconds;
+    bool has_stale_while_revalidate;
+    int64 stale_while_revalidate_seconds;
+  };
+
+  // Number of buckets of the header name index.
+  static const size_t kNumHeaderBuckets = 16;
+
   HttpResponseHeaders();
   ~HttpResponseHeaders();
 
@@ -286,8 +317,15 @@ class NET_EXPORT HttpResponseHeaders
                        bool has_headers);
 
   // Find the header in our list (case-insensitive) starting with parsed_ at
-  // index |from|.  Returns string::npos if not found.
-  size_t FindHeader(size_t from, const std::string& name) const;
+  // index |from|.  Returns string::npos if not found.  This uses the header
+  // name index, and doesn't allocate.
+  size_t FindHeader(size_t from, const base::StringPiece& name) const;
+
+  // Clears the header name index and the parsed caching directives.
+  void ResetHeaderIndex();
+
+  // Returns the caching directives, parsing them on first use.
+  const CacheDirectives& GetCacheDirectives() const;
 
   // Add a header->value pair to our list.  If we already have header in our
   // list, append the value to it.
@@ -344,6 +382,17 @@ class NET_EXPORT HttpResponseHeaders
   // header-value pairs within raw_headers_.
   HeaderList parsed_;
 
+  // Index of the headers in parsed_ by a case-insensitive hash of their name.
+  // Each bucket holds the index of its first header, and the headers of a
+  // bucket are chained in order through ParsedHeader::next_in_bucket.
+  // Continuations aren't indexed.
+  size_t header_buckets_[kNumHeaderBuckets];
+  size_t header_bucket_tails_[kNumHeaderBuckets];
+
+  // Parsed on first use by GetCacheDirectives(), and reset with the index.
+  mutable bool cache_directives_parsed_;
+  mutable CacheDirectives cache_directives_;
+
   // The raw_headers_ consists of the normalized status line (terminated with a
   // null byte) and then followed by the raw null-terminated headers from the
   // input that was passed to our constructor.  We preserve the input [*] to
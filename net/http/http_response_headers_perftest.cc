@@ -0,0 +1,124 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times parsing captured response headers, and the lookups made on them by
+// the HTTP cache.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/memory/ref_counted.h"
+#include "base/test/perf_benchmark.h"
+#include "base/time.h"
+#include "net/http/http_response_headers.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const char* const kCapturedHeaders[] = {
+  // Search results page.
+  "HTTP/1.1 200 OK\n"
+  "Date: Tue, 15 May 2012 20:04:31 GMT\n"
+  "Expires: -1\n"
+  "Cache-Control: private, max-age=0\n"
+  "Content-Type: text/html; charset=UTF-8\n"
+  "Set-Cookie: PREF=ID=1d3c0a4b:FF=0:TM=1337112271:LM=1337112271:S=ab; "
+  "expires=Thu, 15-May-2014 20:04:31 GMT; path=/; domain=.example.com\n"
+  "Set-Cookie: NID=59=kOaZ; expires=Wed, 14-Nov-2012 20:04:31 GMT; "
+  "path=/; domain=.example.com; HttpOnly\n"
+  "P3P: CP=\"This is not a P3P policy!\"\n"
+  "Content-Encoding: gzip\n"
+  "Server: gws\n"
+  "X-XSS-Protection: 1; mode=block\n"
+  "X-Frame-Options: SAMEORIGIN\n"
+  "Transfer-Encoding: chunked\n",
+  // Static image from a CDN.
+  "HTTP/1.1 200 OK\n"
+  "Accept-Ranges: bytes\n"
+  "Cache-Control: max-age=31536000, public\n"
+  "Content-Type: image/png\n"
+  "Date: Tue, 15 May 2012 20:04:32 GMT\n"
+  "ETag: \"4fa1a3ca-1c3e\"\n"
+  "Expires: Wed, 15 May 2013 20:04:32 GMT\n"
+  "Last-Modified: Wed, 02 May 2012 21:21:14 GMT\n"
+  "Server: ECS (lax/2857)\n"
+  "X-Cache: HIT\n"
+  "Content-Length: 7230\n"
+  "Age: 52014\n"
+  "Connection: keep-alive\n",
+  // Script from an application server.
+  "HTTP/1.1 200 OK\n"
+  "Server: Apache/2.2.3 (CentOS)\n"
+  "X-Powered-By: PHP/5.3.3\n"
+  "Vary: Accept-Encoding,User-Agent\n"
+  "Content-Type: application/javascript\n"
+  "Pragma: no-cache\n"
+  "Cache-Control: no-store, no-cache, must-revalidate, post-check=0, "
+  "pre-check=0\n"
+  "Expires: Thu, 19 Nov 1981 08:52:00 GMT\n"
+  "Keep-Alive: timeout=5, max=100\n"
+  "Connection: Keep-Alive\n"
+  "Content-Length: 18210\n",
+  // Revalidated style sheet.
+  "HTTP/1.1 304 Not Modified\n"
+  "Date: Tue, 15 May 2012 20:04:33 GMT\n"
+  "Server: nginx/1.0.15\n"
+  "Connection: keep-alive\n"
+  "ETag: \"1b3f-4bf1a2c8e7a40\"\n"
+  "Cache-Control: public, max-age=600\n"
+  "Vary: Accept-Encoding\n",
+};
+
+typedef std::vector<scoped_refptr<HttpResponseHeaders> > HeadersList;
+
+void ParseAll(const std::vector<std::string>* raw_headers) {
+  for (size_t i = 0; i < raw_headers->size(); ++i) {
+    scoped_refptr<HttpResponseHeaders> parsed(
+        new HttpResponseHeaders((*raw_headers)[i]));
+  }
+}
+
+// The lookups the HTTP cache makes on a response it stores or revalidates.
+void LookUpAll(const HeadersList* headers_list) {
+  for (size_t i = 0; i < headers_list->size(); ++i) {
+    const HttpResponseHeaders* headers = (*headers_list)[i];
+    base::Time now = base::Time::Now();
+    headers->RequiresValidation(now, now, now);
+    headers->HasNoStoreDirective();
+    std::string value;
+    headers->EnumerateHeader(NULL, "etag", &value);
+    headers->EnumerateHeader(NULL, "last-modified", &value);
+    headers->HasStrongValidators();
+    headers->GetContentLength();
+  }
+}
+
+}  // namespace
+
+TEST(HttpResponseHeadersPerfTest, ParseAndLookup) {
+  std::vector<std::string> raw_headers;
+  HeadersList headers_list;
+  for (size_t i = 0; i < arraysize(kCapturedHeaders); ++i) {
+    std::string raw(kCapturedHeaders[i]);
+    std::replace(raw.begin(), raw.end(), '\n', '\0');
+    raw += '\0';
+    raw_headers.push_back(raw);
+    headers_list.push_back(new HttpResponseHeaders(raw));
+  }
+
+  base::PerfBenchmark parse_benchmark("HttpResponseHeaders_Parse");
+  parse_benchmark.set_iterations_per_run(1000);
+  parse_benchmark.Run(base::Bind(&ParseAll, &raw_headers));
+
+  base::PerfBenchmark lookup_benchmark("HttpResponseHeaders_CacheLookups");
+  lookup_benchmark.set_iterations_per_run(1000);
+  lookup_benchmark.Run(base::Bind(&LookUpAll, &headers_list));
+}
+
+}  // namespace net
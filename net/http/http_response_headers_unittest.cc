@@ -6,6 +6,7 @@
 
 #include "base/basictypes.h"
 #include "base/pickle.h"
+#include "base/stringprintf.h"
 #include "base/time.h"
 #include "net/http/http_response_headers.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -1756,3 +1757,119 @@ TEST(HttpResponseHeadersTest, ReplaceStatus) {
     EXPECT_EQ(std::string(tests[i].expected_headers), resulting_headers);
   }
 }
+
+TEST(HttpResponseHeadersTest, FindManyHeaders) {
+  // More distinct names than there are buckets in the header index, with
+  // repeated and coalesced headers in between.
+  std::string headers("HTTP/1.1 200 OK\n");
+  for (int i = 0; i < 40; ++i) {
+    headers += base::StringPrintf("X-Header-%d: value-%d\n", i, i);
+    if (i % 10 == 0)
+      headers += "Cache-Control: private, max-age=60\n";
+  }
+  headers += "x-HEADER-7: second\n";
+  HeadersToRaw(&headers);
+  scoped_refptr<net::HttpResponseHeaders> parsed(
+      new net::HttpResponseHeaders(headers));
+
+  for (int i = 0; i < 40; ++i) {
+    std::string name = base::StringPrintf("x-header-%d", i);
+    EXPECT_TRUE(parsed->HasHeader(name)) << name;
+    EXPECT_TRUE(parsed->HasHeaderValue(name,
+                                       base::StringPrintf("VALUE-%d", i)));
+  }
+  EXPECT_FALSE(parsed->HasHeader("x-header-40"));
+  EXPECT_FALSE(parsed->HasHeader("x-header-"));
+
+  void* iter = NULL;
+  std::string value;
+  EXPECT_TRUE(parsed->EnumerateHeader(&iter, "X-Header-7", &value));
+  EXPECT_EQ("value-7", value);
+  EXPECT_TRUE(parsed->EnumerateHeader(&iter, "X-Header-7", &value));
+  EXPECT_EQ("second", value);
+  EXPECT_FALSE(parsed->EnumerateHeader(&iter, "X-Header-7", &value));
+
+  int count = 0;
+  iter = NULL;
+  while (parsed->EnumerateHeader(&iter, "cache-control", &value))
+    ++count;
+  EXPECT_EQ(8, count);
+  EXPECT_TRUE(parsed->HasHeaderValue("cache-control", "max-age=60"));
+}
+
+TEST(HttpResponseHeadersTest, CacheDirectives) {
+  std::string headers("HTTP/1.1 200 OK\n"
+                      "Cache-Control: private, MAX-AGE=30\n"
+                      "Cache-Control: max-age=60\n");
+  HeadersToRaw(&headers);
+  scoped_refptr<net::HttpResponseHeaders> parsed(
+      new net::HttpResponseHeaders(headers));
+
+  base::TimeDelta max_age;
+  EXPECT_TRUE(parsed->GetMaxAgeValue(&max_age));
+  EXPECT_EQ(30, max_age.InSeconds());
+  EXPECT_FALSE(parsed->HasNoStoreDirective());
+  base::Time now = base::Time::Now();
+  EXPECT_EQ(30, parsed->GetFreshnessLifetime(now).InSeconds());
+
+  // The directives are parsed again when the headers change.
+  parsed->AddHeader("cache-control: No-Store");
+  EXPECT_TRUE(parsed->HasNoStoreDirective());
+  EXPECT_EQ(0, parsed->GetFreshnessLifetime(now).InSeconds());
+
+  parsed->RemoveHeader("Cache-Control");
+  EXPECT_FALSE(parsed->HasNoStoreDirective());
+  EXPECT_FALSE(parsed->GetMaxAgeValue(&max_age));
+
+  parsed->AddHeader("Vary: Accept-Encoding, *");
+  parsed->AddHeader("Cache-Control: max-age=60");
+  EXPECT_TRUE(parsed->GetMaxAgeValue(&max_age));
+  EXPECT_EQ(60, max_age.InSeconds());
+  EXPECT_EQ(0, parsed->GetFreshnessLifetime(now).InSeconds());
+
+  // 'no-store="foo"' isn't the no-store directive.
+  std::string other_headers("HTTP/1.1 200 OK\n"
+                            "cache-control: no-store=\"foo\"\n"
+                            "pragma: no-cache\n");
+  HeadersToRaw(&other_headers);
+  parsed = new net::HttpResponseHeaders(other_headers);
+  EXPECT_FALSE(parsed->HasNoStoreDirective());
+  EXPECT_EQ(0, parsed->GetFreshnessLifetime(now).InSeconds());
+}
+
+TEST(HttpResponseHeadersTest, StaleWhileRevalidate) {
+  std::string headers("HTTP/1.1 200 OK\n"
+                      "Date: Wed, 28 Nov 2007 00:40:11 GMT\n"
+                      "Cache-Control: max-age=10, stale-while-revalidate=60\n");
+  HeadersToRaw(&headers);
+  scoped_refptr<net::HttpResponseHeaders> parsed(
+      new net::HttpResponseHeaders(headers));
+
+  base::TimeDelta window;
+  EXPECT_TRUE(parsed->GetStaleWhileRevalidateValue(&window));
+  EXPECT_EQ(60, window.InSeconds());
+
+  base::Time response_time;
+  EXPECT_TRUE(base::Time::FromString("Wed, 28 Nov 2007 00:40:11 GMT",
+                                     &response_time));
+  base::Time request_time = response_time;
+  const base::TimeDelta kSecond = base::TimeDelta::FromSeconds(1);
+
+  // Fresh, stale within the window and stale past it.
+  EXPECT_TRUE(parsed->IsWithinStaleWhileRevalidateWindow(
+      request_time, response_time, response_time + 5 * kSecond));
+  EXPECT_TRUE(parsed->IsWithinStaleWhileRevalidateWindow(
+      request_time, response_time, response_time + 30 * kSecond));
+  EXPECT_FALSE(parsed->IsWithinStaleWhileRevalidateWindow(
+      request_time, response_time, response_time + 71 * kSecond));
+
+  // must-revalidate takes precedence.
+  parsed->AddHeader("Cache-Control: must-revalidate");
+  EXPECT_FALSE(parsed->IsWithinStaleWhileRevalidateWindow(
+      request_time, response_time, response_time + 30 * kSecond));
+
+  parsed->RemoveHeader("Cache-Control");
+  EXPECT_FALSE(parsed->GetStaleWhileRevalidateValue(&window));
+  EXPECT_FALSE(parsed->IsWithinStaleWhileRevalidateWindow(
+      request_time, response_time, response_time + 5 * kSecond));
+}
@@ -28,6 +28,7 @@ class HttpRequestHeaders;
 struct HttpRequestInfo;
 class HttpResponseInfo;
 class IOBuffer;
+struct LoadTimingInfo;
 class SSLCertRequestInfo;
 class SSLInfo;
 class UploadDataStream;
@@ -122,6 +123,11 @@ class NET_EXPORT_PRIVATE HttpStream {
   // allows it to be reused.
   virtual bool IsConnectionReusable() const = 0;
 
+  // Fills in the socket reuse and connect times of |load_timing_info|.  The
+  // connect times are only reported to the first stream sent on a connection.
+  // Returns false if the stream has no connection.
+  virtual bool GetLoadTimingInfo(LoadTimingInfo* load_timing_info) const = 0;
+
   // Get the SSLInfo associated with this stream's connection.  This should
   // only be called for streams over SSL sockets, otherwise the behavior is
   // undefined.
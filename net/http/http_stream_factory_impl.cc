@@ -6,6 +6,8 @@
 
 #include "base/string_number_conversions.h"
 #include "base/stl_util.h"
+#include "base/time.h"
+#include "base/values.h"
 #include "googleurl/src/gurl.h"
 #include "net/base/net_log.h"
 #include "net/base/net_util.h"
@@ -33,13 +35,51 @@ GURL UpgradeUrlToHttps(const GURL& original_url, int port) {
   return original_url.ReplaceComponents(replacements);
 }
 
+// Parameters of the preconnects planned by HttpPreconnectPlanner, with the
+// running totals of its counters.
+class PreconnectPlanParameters : public NetLog::EventParameters {
+ public:
+  PreconnectPlanParameters(const HostPortPair& origin,
+                           int requested_streams,
+                           int planned_streams,
+                           int hits,
+                           int wasted)
+      : origin_(origin),
+        requested_streams_(requested_streams),
+        planned_streams_(planned_streams),
+        hits_(hits),
+        wasted_(wasted) {
+  }
+
+  virtual Value* ToValue() const OVERRIDE {
+    DictionaryValue* dict = new DictionaryValue();
+    dict->SetString("origin", origin_.ToString());
+    dict->SetInteger("requested_streams", requested_streams_);
+    dict->SetInteger("planned_streams", planned_streams_);
+    dict->SetInteger("hits", hits_);
+    dict->SetInteger("wasted", wasted_);
+    return dict;
+  }
+
+ protected:
+  virtual ~PreconnectPlanParameters() {}
+
+ private:
+  const HostPortPair origin_;
+  const int requested_streams_;
+  const int planned_streams_;
+  const int hits_;
+  const int wasted_;
+};
+
 }  // namespace
 
 HttpStreamFactoryImpl::HttpStreamFactoryImpl(HttpNetworkSession* session)
     : session_(session),
       http_pipelined_host_pool_(this, NULL,
                                 session_->http_server_properties(),
-                                session_->force_http_pipelining()) {}
+                                session_->force_http_pipelining()),
+      preconnect_planner_(session_->http_server_properties()) {}
 
 HttpStreamFactoryImpl::~HttpStreamFactoryImpl() {
   DCHECK(request_map_.empty());
@@ -64,6 +104,8 @@ HttpStreamRequest* HttpStreamFactoryImpl::RequestStream(
     HttpStreamRequest::Delegate* delegate,
     const BoundNetLog& net_log) {
   Request* request = new Request(request_info.url, this, delegate, net_log);
+  preconnect_planner_.OnStreamRequested(
+      HostPortPair::FromURL(request_info.url), base::TimeTicks::Now());
 
   GURL alternate_url;
   bool has_alternate_protocol =
@@ -101,6 +143,19 @@ void HttpStreamFactoryImpl::PreconnectStreams(
     const HttpRequestInfo& request_info,
     const SSLConfig& server_ssl_config,
     const SSLConfig& proxy_ssl_config) {
+  HostPortPair origin = HostPortPair::FromURL(request_info.url);
+  int requested_streams = num_streams;
+  num_streams = preconnect_planner_.PlanPreconnect(origin, requested_streams,
+                                                   base::TimeTicks::Now());
+  if (session_->net_log()) {
+    session_->net_log()->AddGlobalEntry(
+        NetLog::TYPE_HTTP_STREAM_FACTORY_PRECONNECT,
+        make_scoped_refptr(new PreconnectPlanParameters(
+            origin, requested_streams, num_streams,
+            preconnect_planner_.num_hits(),
+            preconnect_planner_.num_wasted())));
+  }
+
   GURL alternate_url;
   bool has_alternate_protocol =
       GetAlternateProtocolRequestFor(request_info.url, &alternate_url);
@@ -13,6 +13,7 @@
 #include "net/base/host_port_pair.h"
 #include "net/base/net_log.h"
 #include "net/http/http_pipelined_host_pool.h"
+#include "net/http/http_preconnect_planner.h"
 #include "net/http/http_stream_factory.h"
 #include "net/proxy/proxy_server.h"
 #include "net/socket/ssl_client_socket.h"
@@ -107,6 +108,10 @@ class NET_EXPORT_PRIVATE HttpStreamFactoryImpl :
 
   HttpPipelinedHostPool http_pipelined_host_pool_;
 
+  // Decides how many sockets PreconnectStreams() warms for each origin, from
+  // the streams that were requested before.
+  HttpPreconnectPlanner preconnect_planner_;
+
   // These jobs correspond to jobs orphaned by Requests and now owned by
   // HttpStreamFactoryImpl. Since they are no longer tied to Requests, they will
   // not be canceled when Requests are canceled. Therefore, in
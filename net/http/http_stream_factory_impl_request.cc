@@ -38,6 +38,9 @@ HttpStreamFactoryImpl::Request::~Request() {
 
   net_log_.EndEvent(NetLog::TYPE_HTTP_STREAM_REQUEST, NULL);
 
+  factory_->preconnect_planner_.OnStreamRequestDone(
+      HostPortPair::FromURL(url_));
+
   for (std::set<Job*>::iterator it = jobs_.begin(); it != jobs_.end(); ++it)
     factory_->request_map_.erase(*it);
 
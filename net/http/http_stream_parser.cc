@@ -217,15 +217,13 @@ int HttpStreamParser::SendRequest(const std::string& request_line,
 
   std::string request = request_line + headers.ToString();
   request_body_.reset(request_body);
-  if (request_body_ != NULL) {
+  if (request_body_ != NULL && request_body_->is_chunked()) {
     request_body_buf_ = new SeekableIOBuffer(kRequestBodyBufferSize);
-    if (request_body_->is_chunked()) {
-      request_body_->set_chunk_callback(this);
-      // The chunk buffer is adjusted to guarantee that |request_body_buf_|
-      // is large enough to hold the encoded chunk.
-      chunk_buf_ = new IOBufferWithSize(kRequestBodyBufferSize -
-                                        kChunkHeaderFooterSize);
-    }
+    request_body_->set_chunk_callback(this);
+    // The chunk buffer is adjusted to guarantee that |request_body_buf_|
+    // is large enough to hold the encoded chunk.
+    chunk_buf_ = new IOBufferWithSize(kRequestBodyBufferSize -
+                                      kChunkHeaderFooterSize);
   }
 
   io_state_ = STATE_SENDING_HEADERS;
@@ -487,28 +485,36 @@ int HttpStreamParser::DoSendChunkedBody(int result) {
 
 int HttpStreamParser::DoSendNonChunkedBody(int result) {
   // |result| is the number of bytes sent from the last call to
-  // DoSendNonChunkedBody(), or 0 (i.e. OK) the first time.
+  // DoSendNonChunkedBody(), or 0 (i.e. OK) the first time and when the
+  // request body stream finished reading from a file.
 
   // Send the remaining data in the request body buffer.
-  request_body_buf_->DidConsume(result);
-  if (request_body_buf_->BytesRemaining() > 0) {
-    return connection_->socket()->Write(request_body_buf_,
-                                        request_body_buf_->BytesRemaining(),
-                                        io_callback_);
+  if (request_body_send_buf_) {
+    request_body_send_buf_->DidConsume(result);
+    if (request_body_send_buf_->BytesRemaining() > 0) {
+      return connection_->socket()->Write(
+          request_body_send_buf_, request_body_send_buf_->BytesRemaining(),
+          io_callback_);
+    }
+    request_body_send_buf_ = NULL;
   }
 
-  request_body_buf_->Clear();
-  const int consumed = request_body_->Read(request_body_buf_,
-                                           request_body_buf_->capacity());
+  // The stream hands out its in-memory data in place, so it's written to the
+  // socket without being copied.
+  scoped_refptr<IOBuffer> buf;
+  const int consumed = request_body_->ReadBuffer(kRequestBodyBufferSize, &buf,
+                                                 io_callback_);
+  if (consumed == ERR_IO_PENDING)
+    return consumed;
   if (consumed == 0) {  // Reached the end.
     io_state_ = STATE_REQUEST_SENT;
   } else if (consumed > 0) {
-    request_body_buf_->DidAppend(consumed);
-    result = connection_->socket()->Write(request_body_buf_,
-                                          request_body_buf_->BytesRemaining(),
-                                          io_callback_);
+    request_body_send_buf_ = new DrainableIOBuffer(buf, consumed);
+    result = connection_->socket()->Write(
+        request_body_send_buf_, request_body_send_buf_->BytesRemaining(),
+        io_callback_);
   } else {
-    // UploadDataStream::Read() won't fail if not chunked.
+    // UploadDataStream::ReadBuffer() won't fail if not chunked.
     NOTREACHED();
   }
   return result;
@@ -17,6 +17,7 @@ class BoundNetLog;
 struct HttpRequestInfo;
 class HttpResponseInfo;
 class IOBuffer;
+struct LoadTimingInfo;
 class X509Certificate;
 class SSLHostInfo;
 
@@ -112,6 +113,11 @@ class NET_EXPORT_PRIVATE HttpTransaction {
   // zero will be returned.  This does not include the request headers.
   virtual uint64 GetUploadProgress() const = 0;
 
+  // Fills in the parts of |load_timing_info| known to the transaction: the
+  // connect, send and receive times, and the cache read times.  Returns false
+  // if there is no timing information yet.
+  virtual bool GetLoadTimingInfo(LoadTimingInfo* load_timing_info) const = 0;
+
   // SetSSLHostInfo sets a object which reads and writes public information
   // about an SSL server. It's used to implement Snap Start.
   // TODO(agl): remove this.
@@ -11,6 +11,7 @@
 #include "base/stringprintf.h"
 #include "net/base/net_errors.h"
 #include "net/base/load_flags.h"
+#include "net/base/load_timing_info.h"
 #include "net/disk_cache/disk_cache.h"
 #include "net/http/http_cache.h"
 #include "net/http/http_request_info.h"
@@ -252,6 +253,7 @@ int MockNetworkTransaction::Start(const net::HttpRequestInfo* request,
 
   response_.headers = new net::HttpResponseHeaders(header_data);
   response_.ssl_info.cert_status = t->cert_status;
+  send_time_ = base::TimeTicks::Now();
   data_ = resp_data;
   test_mode_ = t->test_mode;
 
@@ -319,6 +321,18 @@ uint64 MockNetworkTransaction::GetUploadProgress() const {
   return 0;
 }
 
+bool MockNetworkTransaction::GetLoadTimingInfo(
+    net::LoadTimingInfo* load_timing_info) const {
+  if (send_time_.is_null())
+    return false;
+
+  load_timing_info->socket_reused = true;
+  load_timing_info->send_start = send_time_;
+  load_timing_info->send_end = send_time_;
+  load_timing_info->receive_headers_end = send_time_;
+  return true;
+}
+
 void MockNetworkTransaction::CallbackLater(
     const net::CompletionCallback& callback, int result) {
   MessageLoop::current()->PostTask(
@@ -187,12 +187,17 @@ class MockNetworkTransaction : public net::HttpTransaction {
 
   virtual uint64 GetUploadProgress() const OVERRIDE;
 
+  virtual bool GetLoadTimingInfo(
+      net::LoadTimingInfo* load_timing_info) const OVERRIDE;
+
  private:
   void CallbackLater(const net::CompletionCallback& callback, int result);
   void RunCallback(const net::CompletionCallback& callback, int result);
 
   base::WeakPtrFactory<MockNetworkTransaction> weak_factory_;
   net::HttpResponseInfo response_;
+  // The mock "sends" the request and gets the headers when Start() is called.
+  base::TimeTicks send_time_;
   std::string data_;
   int data_cursor_;
   int test_mode_;
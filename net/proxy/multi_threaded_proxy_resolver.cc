@@ -22,6 +22,9 @@ namespace net {
 
 namespace {
 
+// How long the extra worker threads stay around once they are idle.
+const int kDefaultIdleThreadTimeoutSeconds = 60;
+
 class PurgeMemoryTask : public base::RefCountedThreadSafe<PurgeMemoryTask> {
  public:
   explicit PurgeMemoryTask(ProxyResolver* resolver) : resolver_(resolver) {}
@@ -392,7 +395,10 @@ MultiThreadedProxyResolver::MultiThreadedProxyResolver(
     size_t max_num_threads)
     : ProxyResolver(resolver_factory->resolvers_expect_pac_bytes()),
       resolver_factory_(resolver_factory),
-      max_num_threads_(max_num_threads) {
+      max_num_threads_(max_num_threads),
+      next_thread_number_(0),
+      idle_thread_timeout_(
+          base::TimeDelta::FromSeconds(kDefaultIdleThreadTimeoutSeconds)) {
   DCHECK_GE(max_num_threads, 1u);
 }
 
@@ -550,6 +556,8 @@ void MultiThreadedProxyResolver::ReleaseAllExecutors() {
     executor->Destroy();
   }
   executors_.clear();
+  next_thread_number_ = 0;
+  idle_timer_.Stop();
 }
 
 MultiThreadedProxyResolver::Executor*
@@ -569,7 +577,7 @@ MultiThreadedProxyResolver::AddNewExecutor() {
   DCHECK(CalledOnValidThread());
   DCHECK_LT(executors_.size(), max_num_threads_);
   // The "thread number" is used to give the thread a unique name.
-  int thread_number = executors_.size();
+  int thread_number = next_thread_number_++;
   ProxyResolver* resolver = resolver_factory_->CreateProxyResolver();
   Executor* executor = new Executor(
       this, resolver, thread_number);
@@ -579,8 +587,13 @@ MultiThreadedProxyResolver::AddNewExecutor() {
 
 void MultiThreadedProxyResolver::OnExecutorReady(Executor* executor) {
   DCHECK(CalledOnValidThread());
-  if (pending_jobs_.empty())
+  if (pending_jobs_.empty()) {
+    if (executors_.size() > 1) {
+      idle_timer_.Start(FROM_HERE, idle_thread_timeout_, this,
+                        &MultiThreadedProxyResolver::ReleaseIdleExecutors);
+    }
     return;
+  }
 
   // Get the next job to process (FIFO). Transfer it from the pending queue
   // to the executor.
@@ -589,4 +602,21 @@ void MultiThreadedProxyResolver::OnExecutorReady(Executor* executor) {
   executor->StartJob(job);
 }
 
+void MultiThreadedProxyResolver::ReleaseIdleExecutors() {
+  DCHECK(CalledOnValidThread());
+  if (!pending_jobs_.empty())
+    return;
+
+  for (ExecutorList::iterator it = executors_.begin();
+       it != executors_.end() && executors_.size() > 1; ) {
+    Executor* executor = *it;
+    if (executor->outstanding_job()) {
+      ++it;
+      continue;
+    }
+    executor->Destroy();
+    it = executors_.erase(it);
+  }
+}
+
 }  // namespace net
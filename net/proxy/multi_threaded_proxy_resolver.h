@@ -13,6 +13,8 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/threading/non_thread_safe.h"
+#include "base/time.h"
+#include "base/timer.h"
 #include "net/base/net_export.h"
 #include "net/proxy/proxy_resolver.h"
 
@@ -49,6 +51,8 @@ class ProxyResolverFactory {
 // Threads are created lazily on demand, up to a maximum total. The advantage
 // of having a pool of threads, is faster performance. In particular, being
 // able to keep servicing PAC requests even if one blocks its execution.
+// Threads that stay idle for a while are released again, down to a single
+// one, so a burst of requests doesn't keep extra script contexts around.
 //
 // During initialization (SetPacScript), a single thread is spun up to test
 // the script. If this succeeds, we cache the input script, and will re-use
@@ -107,6 +111,11 @@ class NET_EXPORT_PRIVATE MultiThreadedProxyResolver
       const scoped_refptr<ProxyResolverScriptData>& script_data,
       const CompletionCallback& callback) OVERRIDE;
 
+  // Sets how long the extra threads must stay idle before they are released.
+  void set_idle_thread_timeout(base::TimeDelta timeout) {
+    idle_thread_timeout_ = timeout;
+  }
+
  private:
   class Executor;
   class Job;
@@ -134,11 +143,22 @@ class NET_EXPORT_PRIVATE MultiThreadedProxyResolver
   // Starts the next job from |pending_jobs_| if possible.
   void OnExecutorReady(Executor* executor);
 
+  // Stops and deletes the idle worker threads, except for one.
+  void ReleaseIdleExecutors();
+
   const scoped_ptr<ProxyResolverFactory> resolver_factory_;
   const size_t max_num_threads_;
   PendingJobsQueue pending_jobs_;
   ExecutorList executors_;
   scoped_refptr<ProxyResolverScriptData> current_script_data_;
+
+  // Identifier given to the next worker thread.
+  int next_thread_number_;
+
+  // Runs ReleaseIdleExecutors() once no job was started or queued for
+  // |idle_thread_timeout_|.
+  base::TimeDelta idle_thread_timeout_;
+  base::OneShotTimer<MultiThreadedProxyResolver> idle_timer_;
 };
 
 }  // namespace net
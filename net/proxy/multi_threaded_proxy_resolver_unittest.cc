@@ -726,6 +726,60 @@ TEST(MultiThreadedProxyResolverTest, ThreeThreads_Basic) {
   EXPECT_EQ(7, total_count);
 }
 
+// Tests that the threads provisioned for a burst of requests are released
+// once they are idle, keeping a single one around.
+TEST(MultiThreadedProxyResolverTest, ThreeThreads_ReleasesIdleThreads) {
+  const size_t kNumThreads = 3u;
+  BlockableProxyResolverFactory* factory = new BlockableProxyResolverFactory;
+  MultiThreadedProxyResolver resolver(factory, kNumThreads);
+  resolver.set_idle_thread_timeout(base::TimeDelta());
+
+  int rv;
+
+  TestCompletionCallback set_script_callback;
+  rv = resolver.SetPacScript(
+      ProxyResolverScriptData::FromUTF8("pac script bytes"),
+      set_script_callback.callback());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(OK, set_script_callback.WaitForResult());
+
+  const int kNumRequests = 3;
+  TestCompletionCallback callback[kNumRequests];
+  ProxyInfo results[kNumRequests];
+
+  // Three requests in parallel provision all three threads.
+  for (int i = 0; i < kNumRequests; ++i) {
+    rv = resolver.GetProxyForURL(
+        GURL(base::StringPrintf("http://request%d", i)), &results[i],
+        callback[i].callback(), NULL, BoundNetLog());
+    EXPECT_EQ(ERR_IO_PENDING, rv);
+  }
+  ASSERT_EQ(3u, factory->resolvers().size());
+  for (int i = 0; i < kNumRequests; ++i)
+    EXPECT_GE(callback[i].WaitForResult(), 0);
+
+  // Let the idle timer fire.
+  MessageLoop::current()->RunAllPending();
+
+  // Only one thread is left, so two more requests in parallel need a new one.
+  TestCompletionCallback callback3;
+  ProxyInfo results3;
+  rv = resolver.GetProxyForURL(GURL("http://request3"), &results3,
+                               callback3.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  TestCompletionCallback callback4;
+  ProxyInfo results4;
+  rv = resolver.GetProxyForURL(GURL("http://request4"), &results4,
+                               callback4.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(4u, factory->resolvers().size());
+
+  EXPECT_GE(callback3.WaitForResult(), 0);
+  EXPECT_GE(callback4.WaitForResult(), 0);
+  EXPECT_EQ("PROXY request3:80", results3.ToPacString());
+  EXPECT_EQ("PROXY request4:80", results4.ToPacString());
+}
+
 // Tests using two threads. The first request hangs the first thread. Checks
 // that other requests are able to complete while this first request remains
 // stalled.
@@ -27,6 +27,12 @@ namespace {
 // DNS resolutions.
 const unsigned kCacheEntryTTLSeconds = 5 * 60;
 
+// Size and TTL of the DNS cache shared by all the requests that run on the
+// same bindings. Only successful resolutions are kept there, since failures
+// are often transient.
+const size_t kMaxSharedCacheEntries = 64;
+const unsigned kSharedCacheEntryTTLSeconds = 60;
+
 // Event parameters for a PAC error message (line number + message).
 class ErrorNetlogParams : public NetLog::EventParameters {
  public:
@@ -81,7 +87,8 @@ class DefaultJSBindings : public ProxyResolverJSBindings {
                     ProxyResolverErrorObserver* error_observer)
       : host_resolver_(host_resolver),
         net_log_(net_log),
-        error_observer_(error_observer) {
+        error_observer_(error_observer),
+        shared_host_cache_(kMaxSharedCacheEntries) {
   }
 
   // Handler for "alert(message)".
@@ -243,7 +250,7 @@ class DefaultJSBindings : public ProxyResolverJSBindings {
   }
 
   // Helper to execute a synchronous DNS resolve, using the per-request
-  // DNS cache if there is one.
+  // DNS cache if there is one, then the cache shared by all requests.
   int DnsResolveHelper(const HostResolver::RequestInfo& info,
                        AddressList* address_list) {
     HostCache::Key cache_key(info.hostname(),
@@ -266,6 +273,19 @@ class DefaultJSBindings : public ProxyResolverJSBindings {
       }
     }
 
+    // PAC scripts tend to resolve the same few hosts on every request, and
+    // each resolve blocks on a round trip to the host resolver's thread.
+    const HostCache::Entry* shared_entry =
+        shared_host_cache_.Lookup(cache_key, base::TimeTicks::Now());
+    if (shared_entry) {
+      *address_list = shared_entry->addrlist;
+      if (host_cache) {
+        host_cache->Set(cache_key, OK, *address_list, base::TimeTicks::Now(),
+                        base::TimeDelta::FromSeconds(kCacheEntryTTLSeconds));
+      }
+      return OK;
+    }
+
     // Otherwise ask the host resolver.
     const BoundNetLog* net_log = GetNetLogForCurrentRequest();
     int result = host_resolver_->Resolve(info,
@@ -278,6 +298,11 @@ class DefaultJSBindings : public ProxyResolverJSBindings {
                       base::TimeTicks::Now(),
                       base::TimeDelta::FromSeconds(kCacheEntryTTLSeconds));
     }
+    if (result == OK) {
+      shared_host_cache_.Set(
+          cache_key, result, *address_list, base::TimeTicks::Now(),
+          base::TimeDelta::FromSeconds(kSharedCacheEntryTTLSeconds));
+    }
 
     return result;
   }
@@ -311,6 +336,12 @@ class DefaultJSBindings : public ProxyResolverJSBindings {
   scoped_ptr<SyncHostResolver> host_resolver_;
   NetLog* net_log_;
   scoped_ptr<ProxyResolverErrorObserver> error_observer_;
+
+  // Successful resolutions made for earlier requests. Each bindings object
+  // belongs to one resolver, so this is only used from the thread that runs
+  // its PAC script.
+  HostCache shared_host_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(DefaultJSBindings);
 };
 
@@ -67,6 +67,28 @@ class MockFailingHostResolver : public SyncHostResolver {
   int count_;
 };
 
+// Resolves all hosts to 192.168.1.1, counting the calls.
+class CountingHostResolver : public SyncHostResolver {
+ public:
+  CountingHostResolver() : count_(0) {}
+
+  // HostResolver methods:
+  virtual int Resolve(const HostResolver::RequestInfo& info,
+                      AddressList* addresses,
+                      const net::BoundNetLog& bound_net_log) OVERRIDE {
+    count_++;
+    return ParseAddressList("192.168.1.1", "", addresses);
+  }
+
+  virtual void Shutdown() OVERRIDE {}
+
+  // Returns the number of times Resolve() has been called.
+  int count() const { return count_; }
+
+ private:
+  int count_;
+};
+
 class MockSyncHostResolver : public SyncHostResolver {
  public:
   MockSyncHostResolver() {
@@ -262,6 +284,39 @@ TEST(ProxyResolverJSBindingsTest, PerRequestDNSCache) {
   bindings->set_current_request_context(NULL);
 }
 
+// Test that successful resolutions are shared between requests, and that
+// failures are not.
+TEST(ProxyResolverJSBindingsTest, SharedDNSCache) {
+  CountingHostResolver* host_resolver = new CountingHostResolver;
+
+  // Get a hold of a DefaultJSBindings* (it is a hidden impl class).
+  scoped_ptr<ProxyResolverJSBindings> bindings(
+      ProxyResolverJSBindings::CreateDefault(host_resolver, NULL, NULL));
+
+  std::string ip_address;
+
+  // Two requests, each with its own per-request cache, resolve "foo" once.
+  for (int i = 0; i < 2; ++i) {
+    const unsigned kMaxCacheEntries = 50;
+    HostCache cache(kMaxCacheEntries);
+    ProxyResolverRequestContext context(NULL, &cache);
+    bindings->set_current_request_context(&context);
+    EXPECT_TRUE(bindings->DnsResolve("foo", &ip_address));
+    EXPECT_EQ("192.168.1.1", ip_address);
+    bindings->set_current_request_context(NULL);
+  }
+  EXPECT_EQ(1, host_resolver->count());
+
+  // Without a request context, the shared cache is still used.
+  EXPECT_TRUE(bindings->DnsResolve("foo", &ip_address));
+  EXPECT_EQ(1, host_resolver->count());
+
+  // The "Ex" version is keyed separately.
+  EXPECT_TRUE(bindings->DnsResolveEx("foo", &ip_address));
+  EXPECT_TRUE(bindings->DnsResolveEx("foo", &ip_address));
+  EXPECT_EQ(2, host_resolver->count());
+}
+
 // Test that when a binding is called, it logs to the per-request NetLog.
 TEST(ProxyResolverJSBindingsTest, NetLog) {
   MockFailingHostResolver* host_resolver = new MockFailingHostResolver;
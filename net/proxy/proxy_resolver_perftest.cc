@@ -8,8 +8,12 @@
 #include "base/path_service.h"
 #include "base/perftimer.h"
 #include "base/string_util.h"
+#include "base/stringprintf.h"
+#include "base/threading/platform_thread.h"
+#include "net/base/address_list.h"
 #include "net/base/mock_host_resolver.h"
 #include "net/base/net_errors.h"
+#include "net/base/net_util.h"
 #include "net/proxy/proxy_info.h"
 #include "net/proxy/proxy_resolver_js_bindings.h"
 #include "net/proxy/proxy_resolver_v8.h"
@@ -34,6 +38,31 @@ class MockSyncHostResolver : public net::SyncHostResolver {
   virtual void Shutdown() OVERRIDE {}
 };
 
+// Resolves every host to 10.0.0.1, taking about as long as the round trip to
+// the host resolver's thread that a real resolve costs.
+class SlowSyncHostResolver : public net::SyncHostResolver {
+ public:
+  SlowSyncHostResolver() : num_resolves_(0) {}
+
+  virtual int Resolve(const net::HostResolver::RequestInfo& info,
+                      net::AddressList* addresses,
+                      const net::BoundNetLog& net_log) OVERRIDE {
+    ++num_resolves_;
+    base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(1));
+    net::IPAddressNumber address;
+    CHECK(net::ParseIPLiteralToNumber("10.0.0.1", &address));
+    *addresses = net::AddressList::CreateFromIPAddress(address, 80);
+    return net::OK;
+  }
+
+  virtual void Shutdown() OVERRIDE {}
+
+  int num_resolves() const { return num_resolves_; }
+
+ private:
+  int num_resolves_;
+};
+
 // This class holds the URL to use for resolving, and the expected result.
 // We track the expected result in order to make sure the performance
 // test is actually resolving URLs properly, otherwise the perf numbers
@@ -217,3 +246,38 @@ TEST(ProxyResolverPerfTest, ProxyResolverV8) {
   runner.RunAllTests();
 }
 
+
+// Measures a script that resolves the host of every URL, as intranet
+// detection scripts do. The bindings remember successful resolutions across
+// requests, so only the first request for each host should wait for DNS.
+TEST(ProxyResolverPerfTest, ProxyResolverV8_DnsResolve) {
+  SlowSyncHostResolver* host_resolver = new SlowSyncHostResolver;
+  net::ProxyResolverJSBindings* js_bindings =
+      net::ProxyResolverJSBindings::CreateDefault(host_resolver, NULL, NULL);
+
+  net::ProxyResolverV8 resolver(js_bindings);
+  int rv = resolver.SetPacScript(
+      net::ProxyResolverScriptData::FromUTF8(
+          "function FindProxyForURL(url, host) {\n"
+          "  if (isInNet(dnsResolve(host), \"10.0.0.0\", \"255.0.0.0\"))\n"
+          "    return \"PROXY corp:80\";\n"
+          "  return \"DIRECT\";\n"
+          "}\n"),
+      net::CompletionCallback());
+  ASSERT_EQ(net::OK, rv);
+
+  const int kNumHosts = 10;
+  PerfTimeLogger timer("ProxyResolverV8_DnsResolve");
+  for (int i = 0; i < kNumIterations; ++i) {
+    net::ProxyInfo proxy_info;
+    int result = resolver.GetProxyForURL(
+        GURL(base::StringPrintf("http://host%d.example.com/%d",
+                                i % kNumHosts, i)),
+        &proxy_info, net::CompletionCallback(), NULL, net::BoundNetLog());
+    ASSERT_EQ(net::OK, result);
+    ASSERT_EQ("PROXY corp:80", proxy_info.ToPacString());
+  }
+  timer.Done();
+
+  EXPECT_EQ(kNumHosts, host_resolver->num_resolves());
+}
@@ -871,6 +871,9 @@ class ProxyService::PacRequest
     resolve_job_ = NULL;
     config_id_ = ProxyConfig::kInvalidConfigID;
 
+    if (result_code == OK)
+      service_->CachePacResult(url_, *results_);
+
     return service_->DidFinishResolvingProxy(results_, result_code, net_log_);
   }
 
@@ -924,7 +927,8 @@ ProxyService::ProxyService(ProxyConfigService* config_service,
       current_state_(STATE_NONE) ,
       net_log_(net_log),
       stall_proxy_auto_config_delay_(TimeDelta::FromMilliseconds(
-          kDelayAfterNetworkChangesMs)) {
+          kDelayAfterNetworkChangesMs)),
+      pac_result_cache_mode_(PAC_RESULT_CACHE_DISABLED) {
   NetworkChangeNotifier::AddIPAddressObserver(this);
   ResetConfigService(config_service);
 }
@@ -1070,6 +1074,12 @@ int ProxyService::ResolveProxy(const GURL& raw_url,
   if (rv != ERR_IO_PENDING)
     return DidFinishResolvingProxy(result, rv, net_log);
 
+  // Skip the PAC script if it ran for a similar URL recently.
+  if (current_state_ == STATE_READY && GetCachedPacResult(url, result)) {
+    result->config_id_ = config_.id();
+    return DidFinishResolvingProxy(result, OK, net_log);
+  }
+
   scoped_refptr<PacRequest> req(
       new PacRequest(this, url, result, callback, net_log));
 
@@ -1377,6 +1387,8 @@ ProxyService::State ProxyService::ResetProxyConfig(bool reset_fetched_config) {
 
   permanent_error_ = OK;
   proxy_retry_info_.clear();
+  if (pac_result_cache_.get())
+    pac_result_cache_->Clear();
   script_poller_.reset();
   init_proxy_resolver_.reset();
   SuspendAllPendingRequests();
@@ -1411,6 +1423,56 @@ void ProxyService::PurgeMemory() {
     resolver_->PurgeMemory();
 }
 
+void ProxyService::ConfigurePacResultCache(PacResultCacheMode mode,
+                                           size_t max_entries,
+                                           base::TimeDelta ttl) {
+  DCHECK(CalledOnValidThread());
+  pac_result_cache_mode_ = mode;
+  pac_result_cache_ttl_ = ttl;
+  if (mode == PAC_RESULT_CACHE_DISABLED || max_entries == 0) {
+    pac_result_cache_mode_ = PAC_RESULT_CACHE_DISABLED;
+    pac_result_cache_.reset();
+    return;
+  }
+  pac_result_cache_.reset(new PacResultCache(max_entries));
+}
+
+std::string ProxyService::GetPacResultCacheKey(const GURL& url) const {
+  if (pac_result_cache_mode_ == PAC_RESULT_CACHE_BY_HOST)
+    return url.GetOrigin().spec();
+
+  GURL::Replacements replacements;
+  replacements.ClearQuery();
+  return url.ReplaceComponents(replacements).spec();
+}
+
+bool ProxyService::GetCachedPacResult(const GURL& url, ProxyInfo* result) {
+  if (!pac_result_cache_.get())
+    return false;
+
+  PacResultCache::iterator it =
+      pac_result_cache_->Get(GetPacResultCacheKey(url));
+  if (it == pac_result_cache_->end())
+    return false;
+  if (it->second.expiration <= TimeTicks::Now()) {
+    pac_result_cache_->Erase(it);
+    return false;
+  }
+  result->Use(it->second.result);
+  return true;
+}
+
+void ProxyService::CachePacResult(const GURL& url, const ProxyInfo& result) {
+  // Results of a fall-back to manual settings don't come from the script.
+  if (!pac_result_cache_.get() || !config_.HasAutomaticSettings())
+    return;
+
+  CachedPacResult entry;
+  entry.result.Use(result);
+  entry.expiration = TimeTicks::Now() + pac_result_cache_ttl_;
+  pac_result_cache_->Put(GetPacResultCacheKey(url), entry);
+}
+
 void ProxyService::ForceReloadProxyConfig() {
   DCHECK(CalledOnValidThread());
   ResetProxyConfig(false);
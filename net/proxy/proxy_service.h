@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "base/gtest_prod_util.h"
+#include "base/memory/mru_cache.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/synchronization/waitable_event.h"
@@ -169,6 +170,24 @@ class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
   // Tells the resolver to purge any memory it does not need.
   void PurgeMemory();
 
+  // What the results of the PAC script are cached by.
+  enum PacResultCacheMode {
+    // Every request runs the PAC script. This is the default, since scripts
+    // may look at the whole URL.
+    PAC_RESULT_CACHE_DISABLED,
+    // One result per scheme, host and port.
+    PAC_RESULT_CACHE_BY_HOST,
+    // One result per URL, ignoring the query.
+    PAC_RESULT_CACHE_BY_URL_PREFIX,
+  };
+
+  // Caches up to |max_entries| results of the PAC script for |ttl|, keyed as
+  // described by |mode|. Only use this when the script is known not to look
+  // at the part of the URL that isn't part of the key. The cache is emptied
+  // whenever the PAC script or the proxy settings change.
+  void ConfigurePacResultCache(PacResultCacheMode mode,
+                               size_t max_entries,
+                               base::TimeDelta ttl);
 
   // Returns the last configuration fetched from ProxyConfigService.
   const ProxyConfig& fetched_config() {
@@ -294,6 +313,12 @@ class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
   class InitProxyResolver;
   class ProxyScriptDeciderPoller;
 
+  struct CachedPacResult {
+    ProxyInfo result;
+    base::TimeTicks expiration;
+  };
+  typedef base::MRUCache<std::string, CachedPacResult> PacResultCache;
+
   // TODO(eroman): change this to a std::set. Note that this requires updating
   // some tests in proxy_service_unittest.cc such as:
   //   ProxyServiceTest.InitialPACScriptDownload
@@ -349,6 +374,17 @@ class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
                               int result_code,
                               const BoundNetLog& net_log);
 
+  // Returns the key |url| is cached by in |pac_result_cache_|.
+  std::string GetPacResultCacheKey(const GURL& url) const;
+
+  // Fills |result| and returns true if a PAC script result for |url| is in
+  // |pac_result_cache_|.
+  bool GetCachedPacResult(const GURL& url, ProxyInfo* result);
+
+  // Adds the |result| the PAC script returned for |url| to
+  // |pac_result_cache_|, if it is enabled.
+  void CachePacResult(const GURL& url, const ProxyInfo& result);
+
   // Start initialization using |fetched_config_|.
   void InitializeUsingLastFetchedConfig();
 
@@ -426,6 +462,12 @@ class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
   // The amount of time to stall requests following IP address changes.
   base::TimeDelta stall_proxy_auto_config_delay_;
 
+  // Recent results of the PAC script. NULL unless enabled by
+  // ConfigurePacResultCache().
+  PacResultCacheMode pac_result_cache_mode_;
+  base::TimeDelta pac_result_cache_ttl_;
+  scoped_ptr<PacResultCache> pac_result_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(ProxyService);
 };
 
@@ -232,6 +232,67 @@ TEST_F(ProxyServiceTest, PAC) {
       entries, 4, NetLog::TYPE_PROXY_SERVICE));
 }
 
+// Test that the results of the PAC script are cached by host when enabled,
+// and that reloading the PAC script empties the cache.
+TEST_F(ProxyServiceTest, PAC_ResultCache) {
+  MockProxyConfigService* config_service =
+      new MockProxyConfigService("http://foopy/proxy.pac");
+
+  MockAsyncProxyResolver* resolver = new MockAsyncProxyResolver;
+
+  ProxyService service(config_service, resolver, NULL);
+  service.ConfigurePacResultCache(ProxyService::PAC_RESULT_CACHE_BY_HOST, 10,
+                                  base::TimeDelta::FromHours(1));
+
+  ProxyInfo info1;
+  TestCompletionCallback callback1;
+  int rv = service.ResolveProxy(GURL("http://www.google.com/a"), &info1,
+                                callback1.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+
+  resolver->pending_set_pac_script_request()->CompleteNow(OK);
+  ASSERT_EQ(1u, resolver->pending_requests().size());
+  resolver->pending_requests()[0]->results()->UseNamedProxy("foopy");
+  resolver->pending_requests()[0]->CompleteNow(OK);
+  EXPECT_EQ(OK, callback1.WaitForResult());
+  EXPECT_EQ("foopy:80", info1.proxy_server().ToURI());
+
+  // Another URL on the same host doesn't reach the resolver.
+  ProxyInfo info2;
+  TestCompletionCallback callback2;
+  rv = service.ResolveProxy(GURL("http://www.google.com/b?q=1"), &info2,
+                            callback2.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(OK, rv);
+  EXPECT_EQ("foopy:80", info2.proxy_server().ToURI());
+  EXPECT_TRUE(resolver->pending_requests().empty());
+
+  // A different host does.
+  ProxyInfo info3;
+  TestCompletionCallback callback3;
+  rv = service.ResolveProxy(GURL("http://www.example.com/"), &info3,
+                            callback3.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  ASSERT_EQ(1u, resolver->pending_requests().size());
+  resolver->pending_requests()[0]->results()->UseNamedProxy("other");
+  resolver->pending_requests()[0]->CompleteNow(OK);
+  EXPECT_EQ(OK, callback3.WaitForResult());
+  EXPECT_EQ("other:80", info3.proxy_server().ToURI());
+
+  // Reloading the PAC script forgets the cached results.
+  service.ForceReloadProxyConfig();
+  ProxyInfo info4;
+  TestCompletionCallback callback4;
+  rv = service.ResolveProxy(GURL("http://www.google.com/a"), &info4,
+                            callback4.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  resolver->pending_set_pac_script_request()->CompleteNow(OK);
+  ASSERT_EQ(1u, resolver->pending_requests().size());
+  resolver->pending_requests()[0]->results()->UseNamedProxy("newproxy");
+  resolver->pending_requests()[0]->CompleteNow(OK);
+  EXPECT_EQ(OK, callback4.WaitForResult());
+  EXPECT_EQ("newproxy:80", info4.proxy_server().ToURI());
+}
+
 // Test that the proxy resolver does not see the URL's username/password
 // or its reference section.
 TEST_F(ProxyServiceTest, PAC_NoIdentityOrHash) {
@@ -4,6 +4,7 @@
 
 #include "net/server/http_connection.h"
 
+#include "base/logging.h"
 #include "base/string_util.h"
 #include "base/stringprintf.h"
 #include "net/base/listen_socket.h"
@@ -38,6 +39,7 @@ void HttpConnection::Send200(const std::string& data,
       content_type.c_str(),
       static_cast<int>(data.length())));
   socket_->Send(data);
+  DidSendResponse();
 }
 
 void HttpConnection::Send404() {
@@ -47,6 +49,7 @@ void HttpConnection::Send404() {
       "HTTP/1.1 404 Not Found\r\n"
       "Content-Length: 0\r\n"
       "\r\n");
+  DidSendResponse();
 }
 
 void HttpConnection::Send500(const std::string& message) {
@@ -60,11 +63,50 @@ void HttpConnection::Send500(const std::string& message) {
       "%s",
       static_cast<int>(message.length()),
       message.c_str()));
+  DidSendResponse();
+}
+
+void HttpConnection::StartChunkedResponse(const std::string& content_type) {
+  if (!socket_)
+    return;
+  DCHECK(!sending_chunked_response_);
+  sending_chunked_response_ = true;
+  socket_->Send(base::StringPrintf(
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type:%s\r\n"
+      "Transfer-Encoding: chunked\r\n"
+      "\r\n",
+      content_type.c_str()));
+}
+
+void HttpConnection::SendChunk(const char* bytes, int len) {
+  if (!socket_ || !sending_chunked_response_ || len <= 0)
+    return;
+  socket_->Send(base::StringPrintf("%X\r\n", len));
+  socket_->Send(bytes, len);
+  socket_->Send("\r\n");
+}
+
+void HttpConnection::FinishChunkedResponse() {
+  // Does nothing if the response was not chunked, for example because it
+  // failed before it was started.
+  if (!socket_ || !sending_chunked_response_)
+    return;
+  sending_chunked_response_ = false;
+  socket_->Send("0\r\n\r\n");
+  DidSendResponse();
 }
 
 HttpConnection::HttpConnection(HttpServer* server, ListenSocket* sock)
     : server_(server),
-      socket_(sock) {
+      socket_(sock),
+      parse_state_(0),
+      parse_pos_(0),
+      response_pending_(false),
+      sending_chunked_response_(false),
+      close_after_response_(false),
+      dispatching_(false),
+      close_when_dispatched_(false) {
   id_ = last_id_++;
 }
 
@@ -77,8 +119,12 @@ void HttpConnection::DetachSocket() {
   socket_ = NULL;
 }
 
+void HttpConnection::DidSendResponse() {
+  server_->DidSendResponse(this);
+}
+
 void HttpConnection::Shift(int num_bytes) {
-  recv_data_ = recv_data_.substr(num_bytes);
+  recv_data_.erase(0, num_bytes);
 }
 
 }  // namespace net
@@ -6,11 +6,13 @@
 #define NET_SERVER_HTTP_CONNECTION_H_
 #pragma once
 
+#include <deque>
 #include <string>
 
 #include "base/basictypes.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "net/server/http_server_request_info.h"
 
 namespace net {
 
@@ -18,6 +20,9 @@ class HttpServer;
 class ListenSocket;
 class WebSocket;
 
+// A connection to the HTTP server. Requests are parsed as their bytes arrive
+// and queued, and each is handed to the delegate once the response to the one
+// before it has been sent, so that pipelined requests are answered in order.
 class HttpConnection {
  public:
   void Send(const std::string& data);
@@ -26,6 +31,13 @@ class HttpConnection {
   void Send404();
   void Send500(const std::string& message);
 
+  // Sends the headers of a 200 response whose body follows in SendChunk()
+  // calls, so that it does not have to be built up in memory first. The
+  // response is complete once FinishChunkedResponse() is called.
+  void StartChunkedResponse(const std::string& content_type);
+  void SendChunk(const char* bytes, int len);
+  void FinishChunkedResponse();
+
   void Shift(int num_bytes);
 
   const std::string& recv_data() const { return recv_data_; }
@@ -40,11 +52,36 @@ class HttpConnection {
 
   void DetachSocket();
 
+  // Tells the server that the response to the current request has been sent.
+  void DidSendResponse();
+
   HttpServer* server_;
   scoped_refptr<ListenSocket> socket_;
   scoped_ptr<WebSocket> web_socket_;
   std::string recv_data_;
   int id_;
+
+  // State of the request being parsed. Parsing resumes at |parse_pos_| in
+  // |recv_data_| when more data arrives, so each byte is scanned only once.
+  int parse_state_;
+  size_t parse_pos_;
+  std::string parse_buffer_;
+  std::string parse_header_name_;
+  HttpServerRequestInfo parse_request_;
+
+  // Requests which have been parsed but not yet handed to the delegate.
+  std::deque<HttpServerRequestInfo> pending_requests_;
+  // Whether the delegate has been handed a request it has not answered yet.
+  bool response_pending_;
+  // Whether a chunked response has been started and not yet finished.
+  bool sending_chunked_response_;
+  // Whether the connection is closed once the current response is sent.
+  bool close_after_response_;
+  // Set while the server hands requests to the delegate, which may answer
+  // them, and so finish responses, synchronously.
+  bool dispatching_;
+  bool close_when_dispatched_;
+
   DISALLOW_COPY_AND_ASSIGN(HttpConnection);
 };
 
@@ -6,6 +6,7 @@
 
 #include "base/compiler_specific.h"
 #include "base/logging.h"
+#include "base/string_number_conversions.h"
 #include "base/string_util.h"
 #include "base/stringprintf.h"
 #include "base/sys_byteorder.h"
@@ -82,6 +83,28 @@ void HttpServer::Send500(int connection_id, const std::string& message) {
   connection->Send500(message);
 }
 
+void HttpServer::StartChunkedResponse(int connection_id,
+                                      const std::string& content_type) {
+  HttpConnection* connection = FindConnection(connection_id);
+  if (connection == NULL)
+    return;
+  connection->StartChunkedResponse(content_type);
+}
+
+void HttpServer::SendChunk(int connection_id, const char* bytes, int len) {
+  HttpConnection* connection = FindConnection(connection_id);
+  if (connection == NULL)
+    return;
+  connection->SendChunk(bytes, len);
+}
+
+void HttpServer::FinishChunkedResponse(int connection_id) {
+  HttpConnection* connection = FindConnection(connection_id);
+  if (connection == NULL)
+    return;
+  connection->FinishChunkedResponse();
+}
+
 void HttpServer::Close(int connection_id)
 {
   HttpConnection* connection = FindConnection(connection_id);
@@ -109,43 +132,7 @@ void HttpServer::DidRead(ListenSocket* socket,
     return;
 
   connection->recv_data_.append(data, len);
-  while (connection->recv_data_.length()) {
-    if (connection->web_socket_.get()) {
-      std::string message;
-      WebSocket::ParseResult result = connection->web_socket_->Read(&message);
-      if (result == WebSocket::FRAME_INCOMPLETE)
-        break;
-
-      if (result == WebSocket::FRAME_CLOSE ||
-          result == WebSocket::FRAME_ERROR) {
-        Close(connection->id());
-        break;
-      }
-      delegate_->OnWebSocketMessage(connection->id(), message);
-      continue;
-    }
-
-    HttpServerRequestInfo request;
-    size_t pos = 0;
-    if (!ParseHeaders(connection, &request, &pos))
-      break;
-
-    std::string connection_header = request.GetHeaderValue("Connection");
-    if (connection_header == "Upgrade") {
-      connection->web_socket_.reset(WebSocket::CreateWebSocket(connection,
-                                                               request,
-                                                               &pos));
-
-      if (!connection->web_socket_.get())  // Not enought data was received.
-        break;
-      delegate_->OnWebSocketRequest(connection->id(), request);
-      connection->Shift(pos);
-      continue;
-    }
-    // Request body is not supported. It is always empty.
-    delegate_->OnHttpRequest(connection->id(), request);
-    connection->Shift(pos);
-  }
+  ProcessReceivedData(connection);
 }
 
 void HttpServer::DidClose(ListenSocket* socket) {
@@ -226,16 +213,15 @@ int charToInput(char ch) {
   return INPUT_DEFAULT;
 }
 
-bool HttpServer::ParseHeaders(HttpConnection* connection,
-                              HttpServerRequestInfo* info,
-                              size_t* ppos) {
-  size_t& pos = *ppos;
+HttpServer::ParseResult HttpServer::ParseHeaders(HttpConnection* connection,
+                                                 size_t* ppos) {
+  size_t& pos = connection->parse_pos_;
   size_t data_len = connection->recv_data_.length();
-  int state = ST_METHOD;
-  std::string buffer;
-  std::string header_name;
-  std::string header_value;
-  while (pos < data_len) {
+  int& state = connection->parse_state_;
+  std::string& buffer = connection->parse_buffer_;
+  std::string& header_name = connection->parse_header_name_;
+  HttpServerRequestInfo* info = &connection->parse_request_;
+  while (state != ST_DONE && pos < data_len) {
     char ch = connection->recv_data_[pos++];
     int input = charToInput(ch);
     int next_state = parser_state[state][input];
@@ -262,10 +248,9 @@ bool HttpServer::ParseHeaders(HttpConnection* connection,
           buffer.clear();
           break;
         case ST_VALUE:
-          header_value = buffer;
           // TODO(mbelshe): Deal better with duplicate headers
           DCHECK(info->headers.find(header_name) == info->headers.end());
-          info->headers[header_name] = header_value;
+          info->headers[header_name] = buffer;
           buffer.clear();
           break;
         case ST_SEPARATOR:
@@ -273,6 +258,8 @@ bool HttpServer::ParseHeaders(HttpConnection* connection,
           break;
       }
       state = next_state;
+      if (state == ST_ERR)
+        return PARSE_ERROR;
     } else {
       // Do any actions based on current state
       switch (state) {
@@ -283,16 +270,140 @@ bool HttpServer::ParseHeaders(HttpConnection* connection,
         case ST_NAME:
           buffer.append(&ch, 1);
           break;
-        case ST_DONE:
-          DCHECK(input == INPUT_LF);
-          return true;
-        case ST_ERR:
-          return false;
       }
     }
   }
-  // No more characters, but we haven't finished parsing yet.
-  return false;
+  if (state != ST_DONE) {
+    // No more characters, but we haven't finished parsing yet.
+    return PARSE_INCOMPLETE;
+  }
+  // The header block ends with CRLF; the LF is not consumed by the state
+  // table.
+  if (pos == data_len)
+    return PARSE_INCOMPLETE;
+  DCHECK_EQ('\n', connection->recv_data_[pos]);
+  *ppos = pos + 1;
+  return PARSE_OK;
+}
+
+void HttpServer::ProcessReceivedData(HttpConnection* connection) {
+  // The delegate may answer a request synchronously, which calls back into
+  // DidSendResponse(). The loop below picks up whatever that changed.
+  if (connection->dispatching_)
+    return;
+  connection->dispatching_ = true;
+  while (true) {
+    if (!ParseRequests(connection)) {
+      Close(connection->id());
+      return;
+    }
+    if (connection->response_pending_ ||
+        connection->pending_requests_.empty()) {
+      break;
+    }
+
+    HttpServerRequestInfo request = connection->pending_requests_.front();
+    connection->pending_requests_.pop_front();
+    connection->response_pending_ = true;
+    connection->close_after_response_ =
+        LowerCaseEqualsASCII(request.GetHeaderValue("Connection"), "close");
+    delegate_->OnHttpRequest(connection->id(), request);
+    if (connection->close_when_dispatched_) {
+      Close(connection->id());
+      return;
+    }
+  }
+  connection->dispatching_ = false;
+}
+
+bool HttpServer::ParseRequests(HttpConnection* connection) {
+  while (connection->recv_data_.length()) {
+    if (connection->web_socket_.get()) {
+      std::string message;
+      WebSocket::ParseResult result = connection->web_socket_->Read(&message);
+      if (result == WebSocket::FRAME_INCOMPLETE)
+        return true;
+
+      if (result == WebSocket::FRAME_CLOSE ||
+          result == WebSocket::FRAME_ERROR) {
+        return false;
+      }
+      delegate_->OnWebSocketMessage(connection->id(), message);
+      continue;
+    }
+
+    // Whatever follows a request to close the connection is ignored.
+    if (connection->close_after_response_ ||
+        (!connection->pending_requests_.empty() &&
+         LowerCaseEqualsASCII(
+             connection->pending_requests_.back().GetHeaderValue("Connection"),
+             "close"))) {
+      return true;
+    }
+
+    size_t pos = 0;
+    ParseResult result = ParseHeaders(connection, &pos);
+    if (result == PARSE_INCOMPLETE)
+      return true;
+    if (result == PARSE_ERROR)
+      return false;
+
+    HttpServerRequestInfo& request = connection->parse_request_;
+    std::string connection_header = request.GetHeaderValue("Connection");
+    if (connection_header == "Upgrade") {
+      // Everything after the handshake belongs to the WebSocket, so the
+      // requests before it are answered first.
+      if (connection->response_pending_ ||
+          !connection->pending_requests_.empty()) {
+        return true;
+      }
+      connection->web_socket_.reset(WebSocket::CreateWebSocket(connection,
+                                                               request,
+                                                               &pos));
+
+      if (!connection->web_socket_.get())  // Not enought data was received.
+        return true;
+      delegate_->OnWebSocketRequest(connection->id(), request);
+    } else {
+      int content_length = 0;
+      std::string content_length_header =
+          request.GetHeaderValue("Content-Length");
+      if (!content_length_header.empty() &&
+          (!base::StringToInt(content_length_header, &content_length) ||
+           content_length < 0)) {
+        return false;
+      }
+      if (connection->recv_data_.length() - pos <
+          static_cast<size_t>(content_length)) {
+        return true;
+      }
+      request.data = connection->recv_data_.substr(pos, content_length);
+      pos += content_length;
+      connection->pending_requests_.push_back(request);
+    }
+
+    connection->Shift(pos);
+    connection->parse_state_ = ST_METHOD;
+    connection->parse_pos_ = 0;
+    connection->parse_buffer_.clear();
+    connection->parse_header_name_.clear();
+    connection->parse_request_ = HttpServerRequestInfo();
+  }
+  return true;
+}
+
+void HttpServer::DidSendResponse(HttpConnection* connection) {
+  if (!connection->response_pending_)
+    return;
+  connection->response_pending_ = false;
+  if (connection->close_after_response_) {
+    if (connection->dispatching_)
+      connection->close_when_dispatched_ = true;
+    else
+      Close(connection->id());
+    return;
+  }
+  ProcessReceivedData(connection);
 }
 
 HttpConnection* HttpServer::FindConnection(int connection_id) {
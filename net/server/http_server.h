@@ -51,6 +51,10 @@ class HttpServer : public ListenSocket::ListenSocketDelegate,
                const std::string& mime_type);
   void Send404(int connection_id);
   void Send500(int connection_id, const std::string& message);
+  void StartChunkedResponse(int connection_id,
+                            const std::string& content_type);
+  void SendChunk(int connection_id, const char* bytes, int len);
+  void FinishChunkedResponse(int connection_id);
   void Close(int connection_id);
 
   // ListenSocketDelegate
@@ -67,12 +71,31 @@ class HttpServer : public ListenSocket::ListenSocketDelegate,
   friend class base::RefCountedThreadSafe<HttpServer>;
   friend class HttpConnection;
 
-  // Expects the raw data to be stored in recv_data_. If parsing is successful,
-  // will remove the data parsed from recv_data_, leaving only the unused
-  // recv data.
-  bool ParseHeaders(HttpConnection* connection,
-                    HttpServerRequestInfo* info,
-                    size_t* pos);
+  enum ParseResult {
+    PARSE_OK,
+    PARSE_INCOMPLETE,
+    PARSE_ERROR
+  };
+
+  // Parses the connection's received data into requests and hands them to the
+  // delegate one at a time, each once the response to the one before it has
+  // been sent. May close, and so delete, |connection|.
+  void ProcessReceivedData(HttpConnection* connection);
+
+  // Moves the complete requests at the start of the connection's recv_data_
+  // to its queue, and passes any WebSocket messages to the delegate. Returns
+  // false if the connection should be closed.
+  bool ParseRequests(HttpConnection* connection);
+
+  // Continues parsing the headers of the request at the start of the
+  // connection's recv_data_ from where the last call stopped. On PARSE_OK the
+  // request is in the connection's parse_request_ and *pos is the offset of
+  // its body.
+  ParseResult ParseHeaders(HttpConnection* connection, size_t* pos);
+
+  // Called by |connection| once the response to its current request has been
+  // sent. May close, and so delete, |connection|.
+  void DidSendResponse(HttpConnection* connection);
 
   HttpConnection* FindConnection(int connection_id);
   HttpConnection* FindConnection(ListenSocket* socket);
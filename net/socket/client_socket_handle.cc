@@ -62,6 +62,7 @@ void ClientSocketHandle::ResetInternal(bool cancel) {
   idle_time_ = base::TimeDelta();
   init_time_ = base::TimeTicks();
   setup_time_ = base::TimeDelta();
+  connect_timing_ = LoadTimingInfo::ConnectTiming();
   pool_id_ = -1;
 }
 
@@ -103,6 +104,21 @@ void ClientSocketHandle::RemoveLayeredPool(LayeredPool* layered_pool) {
   }
 }
 
+bool ClientSocketHandle::GetLoadTimingInfo(
+    bool is_reused,
+    LoadTimingInfo* load_timing_info) const {
+  if (!socket_.get())
+    return false;
+
+  load_timing_info->socket_reused = is_reused;
+  // The connect times belong to the first request sent on the socket.
+  if (is_reused)
+    load_timing_info->connect_timing = LoadTimingInfo::ConnectTiming();
+  else
+    load_timing_info->connect_timing = connect_timing_;
+  return true;
+}
+
 void ClientSocketHandle::OnIOComplete(int result) {
   CompletionCallback callback = user_callback_;
   user_callback_.Reset();
@@ -14,6 +14,7 @@
 #include "base/time.h"
 #include "net/base/completion_callback.h"
 #include "net/base/load_states.h"
+#include "net/base/load_timing_info.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_export.h"
 #include "net/base/net_log.h"
@@ -110,6 +111,9 @@ class NET_EXPORT ClientSocketHandle {
   // Used by ClientSocketPool to initialize the ClientSocketHandle.
   void set_is_reused(bool is_reused) { is_reused_ = is_reused; }
   void set_socket(StreamSocket* s) { socket_.reset(s); }
+  void set_connect_timing(const LoadTimingInfo::ConnectTiming& connect_timing) {
+    connect_timing_ = connect_timing;
+  }
   void set_idle_time(base::TimeDelta idle_time) { idle_time_ = idle_time; }
   void set_pool_id(int id) { pool_id_ = id; }
   void set_is_ssl_error(bool is_ssl_error) { is_ssl_error_ = is_ssl_error; }
@@ -142,6 +146,9 @@ class NET_EXPORT ClientSocketHandle {
   StreamSocket* release_socket() { return socket_.release(); }
   bool is_reused() const { return is_reused_; }
   base::TimeDelta idle_time() const { return idle_time_; }
+  const LoadTimingInfo::ConnectTiming& connect_timing() const {
+    return connect_timing_;
+  }
   SocketReuseType reuse_type() const {
     if (is_reused()) {
       return REUSED_IDLE;
@@ -152,6 +159,13 @@ class NET_EXPORT ClientSocketHandle {
     }
   }
 
+  // Fills in the socket reuse and connect times of |load_timing_info|.
+  // |is_reused| is passed in because the users of a handle may track reuse on
+  // their own, e.g. for the later requests of a pipeline.  Returns false if
+  // there is no socket.
+  bool GetLoadTimingInfo(bool is_reused,
+                         LoadTimingInfo* load_timing_info) const;
+
  private:
   // Called on asynchronous completion of an Init() request.
   void OnIOComplete(int result);
@@ -183,6 +197,7 @@ class NET_EXPORT ClientSocketHandle {
   scoped_ptr<ClientSocketHandle> pending_http_proxy_connection_;
   base::TimeTicks init_time_;
   base::TimeDelta setup_time_;
+  LoadTimingInfo::ConnectTiming connect_timing_;
 
   NetLog::Source requesting_source_;
 
@@ -387,9 +387,10 @@ int ClientSocketPoolBaseHelper::RequestSocketInternal(
     LogBoundConnectJobToRequest(connect_job->net_log().source(), request);
     if (!preconnecting) {
       HandOutSocket(connect_job->ReleaseSocket(), false /* not reused */,
-                    handle, base::TimeDelta(), group, request->net_log());
+                    connect_job->connect_timing(), handle, base::TimeDelta(),
+                    group, request->net_log());
     } else {
-      AddIdleSocket(connect_job->ReleaseSocket(), group);
+      AddIdleSocket(connect_job->ReleaseSocket(), group_name, group);
     }
   } else if (rv == ERR_IO_PENDING) {
     // If we don't have any sockets in this group, set a timer for potentially
@@ -412,8 +413,9 @@ int ClientSocketPoolBaseHelper::RequestSocketInternal(
       error_socket = connect_job->ReleaseSocket();
     }
     if (error_socket) {
-      HandOutSocket(error_socket, false /* not reused */, handle,
-                    base::TimeDelta(), group, request->net_log());
+      HandOutSocket(error_socket, false /* not reused */,
+                    connect_job->connect_timing(), handle, base::TimeDelta(),
+                    group, request->net_log());
     } else if (group->IsEmpty()) {
       RemoveGroup(group_name);
     }
@@ -424,32 +426,31 @@ int ClientSocketPoolBaseHelper::RequestSocketInternal(
 
 bool ClientSocketPoolBaseHelper::AssignIdleSocketToGroup(
     const Request* request, Group* group) {
-  std::list<IdleSocket>* idle_sockets = group->mutable_idle_sockets();
+  std::list<IdleSocket>* idle_sockets = group->mutable_used_idle_sockets();
   std::list<IdleSocket>::iterator idle_socket_it = idle_sockets->end();
-  double max_score = -1;
-
-  // Iterate through the idle sockets forwards (oldest to newest)
-  //   * Delete any disconnected ones.
-  //   * If we find a used idle socket, assign to |idle_socket|.  At the end,
-  //   the |idle_socket_it| will be set to the newest used idle socket.
-  for (std::list<IdleSocket>::iterator it = idle_sockets->begin();
-       it != idle_sockets->end();) {
-    if (!it->socket->IsConnectedAndIdle()) {
-      DecrementIdleCount();
-      delete it->socket;
-      it = idle_sockets->erase(it);
-      continue;
-    }
 
-    if (it->socket->WasEverUsed()) {
-      // We found one we can reuse!
-      double score = 0;
+  if (g_socket_reuse_policy_penalty_exponent >= 0) {
+    // Iterate through the used idle sockets forwards (oldest to newest)
+    //   * Delete any disconnected ones.
+    //   * Score the others.  At the end, the |idle_socket_it| will be set to
+    //   the newest used idle socket with the best score.
+    double max_score = -1;
+    for (std::list<IdleSocket>::iterator it = idle_sockets->begin();
+         it != idle_sockets->end();) {
+      if (!it->CanBeReused()) {
+        UnlinkIdleSocket(*it);
+        delete it->socket;
+        it = idle_sockets->erase(it);
+        continue;
+      }
+
       int64 bytes_read = it->socket->NumBytesRead();
       double num_kb = static_cast<double>(bytes_read) / 1024.0;
       int idle_time_sec = (base::TimeTicks::Now() - it->start_time).InSeconds();
       idle_time_sec = std::max(1, idle_time_sec);
 
-      if (g_socket_reuse_policy_penalty_exponent >= 0 && num_kb >= 0) {
+      double score = 0;
+      if (num_kb >= 0) {
         score = num_kb / pow(idle_time_sec,
                              g_socket_reuse_policy_penalty_exponent);
       }
@@ -459,19 +460,35 @@ bool ClientSocketPoolBaseHelper::AssignIdleSocketToGroup(
         idle_socket_it = it;
         max_score = score;
       }
-    }
 
-    ++it;
+      ++it;
+    }
+  } else {
+    // Pick the newest used idle socket (LIFO), deleting the disconnected ones
+    // found on the way.
+    while (!idle_sockets->empty() && !idle_sockets->back().CanBeReused()) {
+      UnlinkIdleSocket(idle_sockets->back());
+      delete idle_sockets->back().socket;
+      idle_sockets->pop_back();
+    }
+    if (!idle_sockets->empty())
+      idle_socket_it = --idle_sockets->end();
   }
 
   // If we haven't found an idle socket, that means there are no used idle
-  // sockets.  Pick the oldest (first) idle socket (FIFO).
-
-  if (idle_socket_it == idle_sockets->end() && !idle_sockets->empty())
+  // sockets.  Pick the oldest (first) unused idle socket (FIFO).
+  if (idle_socket_it == idle_sockets->end()) {
+    idle_sockets = group->mutable_unused_idle_sockets();
+    while (!idle_sockets->empty() && !idle_sockets->front().CanBeReused()) {
+      UnlinkIdleSocket(idle_sockets->front());
+      delete idle_sockets->front().socket;
+      idle_sockets->pop_front();
+    }
     idle_socket_it = idle_sockets->begin();
+  }
 
   if (idle_socket_it != idle_sockets->end()) {
-    DecrementIdleCount();
+    UnlinkIdleSocket(*idle_socket_it);
     base::TimeDelta idle_time =
         base::TimeTicks::Now() - idle_socket_it->start_time;
     IdleSocket idle_socket = *idle_socket_it;
@@ -479,6 +496,7 @@ bool ClientSocketPoolBaseHelper::AssignIdleSocketToGroup(
     HandOutSocket(
         idle_socket.socket,
         idle_socket.socket->WasEverUsed(),
+        LoadTimingInfo::ConnectTiming(),
         request->handle(),
         idle_time,
         group,
@@ -549,7 +567,7 @@ int ClientSocketPoolBaseHelper::IdleSocketCountInGroup(
   GroupMap::const_iterator i = group_map_.find(group_name);
   CHECK(i != group_map_.end());
 
-  return i->second->idle_sockets().size();
+  return i->second->idle_socket_count();
 }
 
 LoadState ClientSocketPoolBaseHelper::GetLoadState(
@@ -621,12 +639,18 @@ DictionaryValue* ClientSocketPoolBaseHelper::GetInfoAsValue(
     group_dict->SetInteger("active_socket_count", group->active_socket_count());
 
     ListValue* idle_socket_list = new ListValue();
-    std::list<IdleSocket>::const_iterator idle_socket;
-    for (idle_socket = group->idle_sockets().begin();
-         idle_socket != group->idle_sockets().end();
-         idle_socket++) {
-      int source_id = idle_socket->socket->NetLog().source().id;
-      idle_socket_list->Append(Value::CreateIntegerValue(source_id));
+    const std::list<IdleSocket>* idle_socket_lists[] = {
+      &group->unused_idle_sockets(),
+      &group->used_idle_sockets(),
+    };
+    for (size_t i = 0; i < arraysize(idle_socket_lists); ++i) {
+      std::list<IdleSocket>::const_iterator idle_socket;
+      for (idle_socket = idle_socket_lists[i]->begin();
+           idle_socket != idle_socket_lists[i]->end();
+           idle_socket++) {
+        int source_id = idle_socket->socket->NetLog().source().id;
+        idle_socket_list->Append(Value::CreateIntegerValue(source_id));
+      }
     }
     group_dict->Set("idle_sockets", idle_socket_list);
 
@@ -649,15 +673,8 @@ DictionaryValue* ClientSocketPoolBaseHelper::GetInfoAsValue(
   return dict;
 }
 
-bool ClientSocketPoolBaseHelper::IdleSocket::ShouldCleanup(
-    base::TimeTicks now,
-    base::TimeDelta timeout) const {
-  bool timed_out = (now - start_time) >= timeout;
-  if (timed_out)
-    return true;
-  if (socket->WasEverUsed())
-    return !socket->IsConnectedAndIdle();
-  return !socket->IsConnected();
+bool ClientSocketPoolBaseHelper::IdleSocket::CanBeReused() const {
+  return socket->IsConnectedAndIdle();
 }
 
 void ClientSocketPoolBaseHelper::CleanupIdleSockets(bool force) {
@@ -665,33 +682,16 @@ void ClientSocketPoolBaseHelper::CleanupIdleSockets(bool force) {
     return;
 
   // Current time value. Retrieving it once at the function start rather than
-  // inside the inner loop, since it shouldn't change by any meaningful amount.
+  // inside the loop, since it shouldn't change by any meaningful amount.
   base::TimeTicks now = base::TimeTicks::Now();
 
-  GroupMap::iterator i = group_map_.begin();
-  while (i != group_map_.end()) {
-    Group* group = i->second;
-
-    std::list<IdleSocket>::iterator j = group->mutable_idle_sockets()->begin();
-    while (j != group->idle_sockets().end()) {
-      base::TimeDelta timeout =
-          j->socket->WasEverUsed() ?
-          used_idle_socket_timeout_ : unused_idle_socket_timeout_;
-      if (force || j->ShouldCleanup(now, timeout)) {
-        delete j->socket;
-        j = group->mutable_idle_sockets()->erase(j);
-        DecrementIdleCount();
-      } else {
-        ++j;
-      }
-    }
-
-    // Delete group if no longer needed.
-    if (group->IsEmpty()) {
-      RemoveGroup(i++);
-    } else {
-      ++i;
-    }
+  // Only the sockets that timed out are visited, no matter how many groups
+  // have idle sockets.
+  while (!idle_socket_expirations_.empty()) {
+    IdleSocketExpirationMap::iterator it = idle_socket_expirations_.begin();
+    if (!force && it->first.first > now)
+      break;
+    CloseIdleSocket(it);
   }
 }
 
@@ -778,7 +778,7 @@ void ClientSocketPoolBaseHelper::ReleaseSocket(const std::string& group_name,
       id == pool_generation_number_;
   if (can_reuse) {
     // Add it to the idle list.
-    AddIdleSocket(socket, group);
+    AddIdleSocket(socket, group_name, group);
     OnAvailableSocketSlot(group_name, group);
   } else {
     delete socket;
@@ -871,12 +871,12 @@ void ClientSocketPoolBaseHelper::OnConnectJobComplete(
           group->mutable_pending_requests()->begin(), group));
       LogBoundConnectJobToRequest(job_log.source(), r.get());
       HandOutSocket(
-          socket.release(), false /* unused socket */, r->handle(),
-          base::TimeDelta(), group, r->net_log());
+          socket.release(), false /* unused socket */, job->connect_timing(),
+          r->handle(), base::TimeDelta(), group, r->net_log());
       r->net_log().EndEvent(NetLog::TYPE_SOCKET_POOL, NULL);
       InvokeUserCallbackLater(r->handle(), r->callback(), result);
     } else {
-      AddIdleSocket(socket.release(), group);
+      AddIdleSocket(socket.release(), group_name, group);
       OnAvailableSocketSlot(group_name, group);
       CheckForStalledSocketGroups();
     }
@@ -892,8 +892,9 @@ void ClientSocketPoolBaseHelper::OnConnectJobComplete(
       RemoveConnectJob(job, group);
       if (socket.get()) {
         handed_out_socket = true;
-        HandOutSocket(socket.release(), false /* unused socket */, r->handle(),
-                      base::TimeDelta(), group, r->net_log());
+        HandOutSocket(socket.release(), false /* unused socket */,
+                      job->connect_timing(), r->handle(), base::TimeDelta(),
+                      group, r->net_log());
       }
       r->net_log().EndEventWithNetErrorCode(NetLog::TYPE_SOCKET_POOL,
                                             result);
@@ -983,6 +984,7 @@ void ClientSocketPoolBaseHelper::ProcessPendingRequest(
 void ClientSocketPoolBaseHelper::HandOutSocket(
     StreamSocket* socket,
     bool reused,
+    const LoadTimingInfo::ConnectTiming& connect_timing,
     ClientSocketHandle* handle,
     base::TimeDelta idle_time,
     Group* group,
@@ -990,6 +992,7 @@ void ClientSocketPoolBaseHelper::HandOutSocket(
   DCHECK(socket);
   handle->set_socket(socket);
   handle->set_is_reused(reused);
+  handle->set_connect_timing(connect_timing);
   handle->set_idle_time(idle_time);
   handle->set_pool_id(pool_generation_number_);
 
@@ -1009,16 +1012,45 @@ void ClientSocketPoolBaseHelper::HandOutSocket(
 }
 
 void ClientSocketPoolBaseHelper::AddIdleSocket(
-    StreamSocket* socket, Group* group) {
+    StreamSocket* socket, const std::string& group_name, Group* group) {
   DCHECK(socket);
   IdleSocket idle_socket;
   idle_socket.socket = socket;
   idle_socket.start_time = base::TimeTicks::Now();
+  idle_socket.expiration_time = idle_socket.start_time +
+      (socket->WasEverUsed() ?
+       used_idle_socket_timeout_ : unused_idle_socket_timeout_);
 
-  group->mutable_idle_sockets()->push_back(idle_socket);
+  group->AddIdleSocket(idle_socket);
+  idle_socket_expirations_.insert(std::make_pair(
+      IdleSocketKey(idle_socket.expiration_time, socket), group_name));
   IncrementIdleCount();
 }
 
+void ClientSocketPoolBaseHelper::UnlinkIdleSocket(
+    const IdleSocket& idle_socket) {
+  size_t erased = idle_socket_expirations_.erase(
+      IdleSocketKey(idle_socket.expiration_time, idle_socket.socket));
+  DCHECK_EQ(1u, erased);
+  DecrementIdleCount();
+}
+
+void ClientSocketPoolBaseHelper::CloseIdleSocket(
+    IdleSocketExpirationMap::iterator it) {
+  GroupMap::iterator group_it = group_map_.find(it->second);
+  CHECK(group_it != group_map_.end());
+  Group* group = group_it->second;
+
+  StreamSocket* socket = it->first.second;
+  group->RemoveIdleSocket(socket);
+  idle_socket_expirations_.erase(it);
+  DecrementIdleCount();
+  delete socket;
+
+  if (group->IsEmpty())
+    RemoveGroup(group_it);
+}
+
 void ClientSocketPoolBaseHelper::CancelAllConnectJobs() {
   for (GroupMap::iterator i = group_map_.begin(); i != group_map_.end();) {
     Group* group = i->second;
@@ -1084,21 +1116,16 @@ bool ClientSocketPoolBaseHelper::CloseOneIdleSocketExceptInGroup(
     const Group* exception_group) {
   CHECK_GT(idle_socket_count(), 0);
 
-  for (GroupMap::iterator i = group_map_.begin(); i != group_map_.end(); ++i) {
-    Group* group = i->second;
-    if (exception_group == group)
-      continue;
-    std::list<IdleSocket>* idle_sockets = group->mutable_idle_sockets();
-
-    if (!idle_sockets->empty()) {
-      delete idle_sockets->front().socket;
-      idle_sockets->pop_front();
-      DecrementIdleCount();
-      if (group->IsEmpty())
-        RemoveGroup(i);
-
-      return true;
+  for (IdleSocketExpirationMap::iterator it = idle_socket_expirations_.begin();
+       it != idle_socket_expirations_.end(); ++it) {
+    if (exception_group) {
+      GroupMap::const_iterator group_it = group_map_.find(it->second);
+      CHECK(group_it != group_map_.end());
+      if (group_it->second == exception_group)
+        continue;
     }
+    CloseIdleSocket(it);
+    return true;
   }
 
   return false;
@@ -1149,6 +1176,32 @@ ClientSocketPoolBaseHelper::Group::~Group() {
   CleanupBackupJob();
 }
 
+void ClientSocketPoolBaseHelper::Group::AddIdleSocket(
+    const IdleSocket& idle_socket) {
+  if (idle_socket.socket->WasEverUsed())
+    used_idle_sockets_.push_back(idle_socket);
+  else
+    unused_idle_sockets_.push_back(idle_socket);
+}
+
+void ClientSocketPoolBaseHelper::Group::RemoveIdleSocket(
+    const StreamSocket* socket) {
+  std::list<IdleSocket>* idle_socket_lists[] = {
+    &used_idle_sockets_,
+    &unused_idle_sockets_,
+  };
+  for (size_t i = 0; i < arraysize(idle_socket_lists); ++i) {
+    for (std::list<IdleSocket>::iterator it = idle_socket_lists[i]->begin();
+         it != idle_socket_lists[i]->end(); ++it) {
+      if (it->socket == socket) {
+        idle_socket_lists[i]->erase(it);
+        return;
+      }
+    }
+  }
+  NOTREACHED();
+}
+
 void ClientSocketPoolBaseHelper::Group::StartBackupSocketTimer(
     const std::string& group_name,
     ClientSocketPoolBaseHelper* pool) {
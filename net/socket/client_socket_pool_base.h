@@ -28,6 +28,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -39,6 +40,7 @@
 #include "net/base/address_list.h"
 #include "net/base/completion_callback.h"
 #include "net/base/load_states.h"
+#include "net/base/load_timing_info.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_export.h"
 #include "net/base/net_log.h"
@@ -121,9 +123,19 @@ class NET_EXPORT_PRIVATE ConnectJob {
 
   const BoundNetLog& net_log() const { return net_log_; }
 
+  // The times spent connecting |socket_|, handed to the ClientSocketHandle
+  // along with the socket.
+  const LoadTimingInfo::ConnectTiming& connect_timing() const {
+    return connect_timing_;
+  }
+
  protected:
   void set_socket(StreamSocket* socket);
   StreamSocket* socket() { return socket_.get(); }
+  // Subclasses fill in the phases they go through.
+  LoadTimingInfo::ConnectTiming* mutable_connect_timing() {
+    return &connect_timing_;
+  }
   void NotifyDelegateOfCompletion(int rv);
   void ResetTimer(base::TimeDelta remainingTime);
 
@@ -148,6 +160,7 @@ class NET_EXPORT_PRIVATE ConnectJob {
   base::OneShotTimer<ConnectJob> timer_;
   Delegate* delegate_;
   scoped_ptr<StreamSocket> socket_;
+  LoadTimingInfo::ConnectTiming connect_timing_;
   BoundNetLog net_log_;
   // A ConnectJob is idle until Connect() has been called.
   bool idle_;
@@ -315,11 +328,7 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
   // sockets that timed out or can't be reused.  Made public for testing.
   void CleanupIdleSockets(bool force);
 
-  // Closes one idle socket.  Picks the first one encountered.
-  // TODO(willchan): Consider a better algorithm for doing this.  Perhaps we
-  // should keep an ordered list of idle sockets, and close them in order.
-  // Requires maintaining more state.  It's not clear if it's worth it since
-  // I'm not sure if we hit this situation often.
+  // Closes one idle socket.  Picks the one that would time out first.
   bool CloseOneIdleSocket();
 
   // Checks layered pools to see if they can close an idle connection.
@@ -347,24 +356,31 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
  private:
   friend class base::RefCounted<ClientSocketPoolBaseHelper>;
 
-  // Entry for a persistent socket which became idle at time |start_time|.
+  // Entry for a persistent socket which became idle at time |start_time|, and
+  // which is closed at |expiration_time| if it is still idle by then.
   struct IdleSocket {
     IdleSocket() : socket(NULL) {}
 
-    // An idle socket should be removed if it can't be reused, or has been idle
-    // for too long. |now| is the current time value (TimeTicks::Now()).
-    // |timeout| is the length of time to wait before timing out an idle socket.
-    //
     // An idle socket can't be reused if it is disconnected or has received
     // data unexpectedly (hence no longer idle).  The unread data would be
     // mistaken for the beginning of the next response if we were to reuse the
-    // socket for a new request.
-    bool ShouldCleanup(base::TimeTicks now, base::TimeDelta timeout) const;
+    // socket for a new request.  Such sockets are only found when they are
+    // about to be handed out, or when they time out.
+    bool CanBeReused() const;
 
     StreamSocket* socket;
     base::TimeTicks start_time;
+    base::TimeTicks expiration_time;
   };
 
+  // Identifies an idle socket in |idle_socket_expirations_|.  Sorting by
+  // the expiration time first lets the cleanup timer stop at the first socket
+  // that has not timed out yet.
+  typedef std::pair<base::TimeTicks, StreamSocket*> IdleSocketKey;
+
+  // Maps every idle socket of the pool to the name of its group.
+  typedef std::map<IdleSocketKey, std::string> IdleSocketExpirationMap;
+
   typedef std::deque<const Request* > RequestQueue;
   typedef std::map<const ClientSocketHandle*, const Request*> RequestMap;
 
@@ -377,7 +393,7 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
     ~Group();
 
     bool IsEmpty() const {
-      return active_socket_count_ == 0 && idle_sockets_.empty() &&
+      return active_socket_count_ == 0 && idle_socket_count() == 0 &&
           jobs_.empty() && pending_requests_.empty();
     }
 
@@ -387,7 +403,7 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
 
     int NumActiveSocketSlots() const {
       return active_socket_count_ + static_cast<int>(jobs_.size()) +
-          static_cast<int>(idle_sockets_.size());
+          idle_socket_count();
     }
 
     bool IsStalledOnPoolMaxSockets(int max_sockets_per_group) const {
@@ -417,15 +433,37 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
     void RemoveJob(ConnectJob* job) { jobs_.erase(job); }
     void RemoveAllJobs();
 
+    // Appends |idle_socket| to the used or unused idle sockets, depending on
+    // whether its socket was ever used.
+    void AddIdleSocket(const IdleSocket& idle_socket);
+
+    // Removes the idle socket entry for |socket|.  Both lists are searched
+    // from the oldest entry, which is where expiring sockets are found.
+    void RemoveIdleSocket(const StreamSocket* socket);
+
     void IncrementActiveSocketCount() { active_socket_count_++; }
     void DecrementActiveSocketCount() { active_socket_count_--; }
 
     const std::set<ConnectJob*>& jobs() const { return jobs_; }
-    const std::list<IdleSocket>& idle_sockets() const { return idle_sockets_; }
+    const std::list<IdleSocket>& used_idle_sockets() const {
+      return used_idle_sockets_;
+    }
+    const std::list<IdleSocket>& unused_idle_sockets() const {
+      return unused_idle_sockets_;
+    }
+    int idle_socket_count() const {
+      return static_cast<int>(used_idle_sockets_.size() +
+                              unused_idle_sockets_.size());
+    }
     const RequestQueue& pending_requests() const { return pending_requests_; }
     int active_socket_count() const { return active_socket_count_; }
     RequestQueue* mutable_pending_requests() { return &pending_requests_; }
-    std::list<IdleSocket>* mutable_idle_sockets() { return &idle_sockets_; }
+    std::list<IdleSocket>* mutable_used_idle_sockets() {
+      return &used_idle_sockets_;
+    }
+    std::list<IdleSocket>* mutable_unused_idle_sockets() {
+      return &unused_idle_sockets_;
+    }
 
    private:
     // Called when the backup socket timer fires.
@@ -433,7 +471,12 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
         std::string group_name,
         ClientSocketPoolBaseHelper* pool);
 
-    std::list<IdleSocket> idle_sockets_;
+    // Both lists go from the oldest idle socket to the newest one.  Used
+    // sockets are handed out newest first, since the server is less likely to
+    // have closed them.  Unused sockets are handed out oldest first, since
+    // they were all connected for this group and the oldest expires first.
+    std::list<IdleSocket> used_idle_sockets_;
+    std::list<IdleSocket> unused_idle_sockets_;
     std::set<ConnectJob*> jobs_;
     RequestQueue pending_requests_;
     int active_socket_count_;  // number of active sockets used by clients
@@ -480,8 +523,8 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
   // and |group_name| with data of the stalled group having highest priority.
   bool FindTopStalledGroup(Group** group, std::string* group_name) const;
 
-  // Called when timer_ fires.  This method scans the idle sockets removing
-  // sockets that timed out or can't be reused.
+  // Called when timer_ fires.  This method removes the idle sockets that timed
+  // out.
   void OnCleanupTimerFired() {
     CleanupIdleSockets(false);
   }
@@ -496,15 +539,27 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
   void ProcessPendingRequest(const std::string& group_name, Group* group);
 
   // Assigns |socket| to |handle| and updates |group|'s counters appropriately.
+  // |connect_timing| is empty for sockets that didn't just finish connecting.
   void HandOutSocket(StreamSocket* socket,
                      bool reused,
+                     const LoadTimingInfo::ConnectTiming& connect_timing,
                      ClientSocketHandle* handle,
                      base::TimeDelta time_idle,
                      Group* group,
                      const BoundNetLog& net_log);
 
   // Adds |socket| to the list of idle sockets for |group|.
-  void AddIdleSocket(StreamSocket* socket, Group* group);
+  void AddIdleSocket(StreamSocket* socket,
+                     const std::string& group_name,
+                     Group* group);
+
+  // Removes |idle_socket| from |idle_socket_expirations_| and updates the idle
+  // socket count.  The caller removes it from its group.
+  void UnlinkIdleSocket(const IdleSocket& idle_socket);
+
+  // Closes the idle socket identified by |it|, and removes its group if it is
+  // no longer needed.
+  void CloseIdleSocket(IdleSocketExpirationMap::iterator it);
 
   // Iterates through |group_map_|, canceling all ConnectJobs and deleting
   // groups if they are no longer needed.
@@ -558,10 +613,12 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
   // possible that the request is cancelled.
   PendingCallbackMap pending_callback_map_;
 
-  // Timer used to periodically prune idle sockets that timed out or can't be
-  // reused.
+  // Timer used to periodically prune idle sockets that timed out.
   base::RepeatingTimer<ClientSocketPoolBaseHelper> timer_;
 
+  // The idle sockets of all the groups, in the order in which they time out.
+  IdleSocketExpirationMap idle_socket_expirations_;
+
   // The total number of idle sockets in the system.
   int idle_socket_count_;
 
@@ -2158,6 +2158,80 @@ TEST_F(ClientSocketPoolBaseTest, CleanupTimedOutIdleSockets) {
       entries, 1, NetLog::TYPE_SOCKET_POOL_REUSED_AN_EXISTING_SOCKET));
 }
 
+// The idle socket that times out first is the one closed to make room for a
+// new socket.
+TEST_F(ClientSocketPoolBaseTest, CloseIdleSocketThatTimesOutFirst) {
+  CreatePoolWithIdleTimeouts(
+      2, kDefaultMaxSocketsPerGroup,
+      base::TimeDelta::FromHours(1),  // Unused sockets time out first.
+      base::TimeDelta::FromDays(1));
+  connect_job_factory_->set_job_type(TestConnectJob::kMockJob);
+
+  ClientSocketHandle handle;
+  TestCompletionCallback callback;
+  EXPECT_EQ(OK, handle.Init("a", params_, kDefaultPriority,
+                            callback.callback(), pool_.get(), BoundNetLog()));
+  EXPECT_EQ(1, handle.socket()->Write(NULL, 1, CompletionCallback()));
+  ClientSocketHandle handle2;
+  EXPECT_EQ(OK, handle2.Init("b", params_, kDefaultPriority,
+                             callback.callback(), pool_.get(), BoundNetLog()));
+  handle.Reset();
+  handle2.Reset();
+  MessageLoop::current()->RunAllPending();
+  ASSERT_EQ(2, pool_->IdleSocketCount());
+
+  // Group "a" comes first, but the unused socket of "b" times out sooner.
+  EXPECT_EQ(OK, handle.Init("c", params_, kDefaultPriority,
+                            callback.callback(), pool_.get(), BoundNetLog()));
+  EXPECT_EQ(1, pool_->IdleSocketCount());
+  EXPECT_TRUE(pool_->HasGroup("a"));
+  EXPECT_FALSE(pool_->HasGroup("b"));
+}
+
+// Idle sockets spread over many groups, as with a proxy per group.  Cleaning up
+// only visits the sockets that timed out, so the repeated cleanups are cheap.
+TEST_F(ClientSocketPoolBaseTest, CleanupIdleSocketsInManyGroups) {
+  const int kNumGroups = 10000;
+  const int kNumCleanups = 1000;
+  CreatePoolWithIdleTimeouts(
+      kNumGroups, kDefaultMaxSocketsPerGroup,
+      base::TimeDelta(),  // Time out unused sockets immediately.
+      base::TimeDelta::FromDays(1));  // Don't time out used sockets.
+  connect_job_factory_->set_job_type(TestConnectJob::kMockJob);
+
+  for (int i = 0; i < kNumGroups; ++i) {
+    ClientSocketHandle handle;
+    TestCompletionCallback callback;
+    ASSERT_EQ(OK, handle.Init(base::IntToString(i), params_, kDefaultPriority,
+                              callback.callback(), pool_.get(),
+                              BoundNetLog()));
+    // Use the sockets of the even groups.
+    if (i % 2 == 0)
+      EXPECT_EQ(1, handle.socket()->Write(NULL, 1, CompletionCallback()));
+  }
+  MessageLoop::current()->RunAllPending();
+  ASSERT_EQ(kNumGroups, pool_->IdleSocketCount());
+
+  // The first cleanup closes the unused sockets, the others have nothing to
+  // close.
+  for (int i = 0; i < kNumCleanups; ++i)
+    pool_->CleanupTimedOutIdleSockets();
+  EXPECT_EQ(kNumGroups / 2, pool_->IdleSocketCount());
+  EXPECT_TRUE(pool_->HasGroup("0"));
+  EXPECT_FALSE(pool_->HasGroup("1"));
+
+  for (int i = 0; i < kNumGroups; i += 2) {
+    ClientSocketHandle handle;
+    TestCompletionCallback callback;
+    ASSERT_EQ(OK, handle.Init(base::IntToString(i), params_, kDefaultPriority,
+                              callback.callback(), pool_.get(),
+                              BoundNetLog()));
+    EXPECT_TRUE(handle.is_reused());
+  }
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(kNumGroups / 2, pool_->IdleSocketCount());
+}
+
 // Make sure that we process all pending requests even when we're stalling
 // because of multiple releasing disconnected sockets.
 TEST_F(ClientSocketPoolBaseTest, MultipleReleasingDisconnectedSockets) {
@@ -18,6 +18,8 @@ enum NextProto {
   kProtoSPDY1 = 2,
   kProtoSPDY2 = 3,
   kProtoSPDY3 = 5,
+  // Experimental: SPDY/3 with indexed header compression.
+  kProtoSPDY3a1 = 6,
 };
 
 }  // namespace net
@@ -14,7 +14,9 @@
 #include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/memory/singleton.h"
+#include "base/metrics/histogram.h"
 #include "base/threading/thread_restrictions.h"
+#include "base/time.h"
 #include "base/values.h"
 #include "crypto/nss_util.h"
 #include "net/base/net_errors.h"
@@ -25,7 +27,10 @@ namespace net {
 class NSSSSLInitSingleton {
  public:
   NSSSSLInitSingleton() {
-    crypto::EnsureNSSInit();
+    // This is usually on the way to the first SSL connection, which has to
+    // wait for it unless NSS was initialized ahead of time.
+    base::TimeTicks start = base::TimeTicks::Now();
+    crypto::EnsureNSSRootCertsInit();
 
     NSS_SetDomesticPolicy();
 
@@ -61,6 +66,9 @@ class NSSSSLInitSingleton {
 
     // All other SSL options are set per-session by SSLClientSocket and
     // SSLServerSocket.
+
+    UMA_HISTOGRAM_TIMES("Net.SSL_NSSInitTime",
+                        base::TimeTicks::Now() - start);
   }
 
   ~NSSSSLInitSingleton() {
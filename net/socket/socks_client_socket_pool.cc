@@ -127,6 +127,8 @@ int SOCKSConnectJob::DoTransportConnectComplete(int result) {
   if (result != OK)
     return ERR_PROXY_CONNECTION_FAILED;
 
+  *mutable_connect_timing() = transport_socket_handle_->connect_timing();
+
   // Reset the timer to just the length of time allowed for SOCKS handshake
   // so that a fast TCP connection plus a slow SOCKS failure doesn't take
   // longer to timeout than it should.
@@ -157,6 +159,7 @@ int SOCKSConnectJob::DoSOCKSConnectComplete(int result) {
     return result;
   }
 
+  mutable_connect_timing()->connect_end = base::TimeTicks::Now();
   set_socket(socket_.release());
   return result;
 }
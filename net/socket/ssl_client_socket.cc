@@ -26,6 +26,8 @@ NextProto SSLClientSocket::NextProtoFromString(
     return kProtoSPDY2;
   } else if (proto_string == "spdy/3") {
     return kProtoSPDY3;
+  } else if (proto_string == "spdy/3a1") {
+    return kProtoSPDY3a1;
   } else {
     return kProtoUnknown;
   }
@@ -42,6 +44,8 @@ const char* SSLClientSocket::NextProtoToString(NextProto next_proto) {
       return "spdy/2";
     case kProtoSPDY3:
       return "spdy/3";
+    case kProtoSPDY3a1:
+      return "spdy/3a1";
     default:
       break;
   }
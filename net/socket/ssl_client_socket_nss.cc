@@ -116,6 +116,9 @@
 
 static const int kRecvBufferSize = 4096;
 
+// The lifetime of a session in the NSS client session cache.
+static const int kSessionCacheTimeoutHours = 24;
+
 #if defined(OS_WIN)
 // CERT_OCSP_RESPONSE_PROP_ID is only implemented on Vista+, but it can be
 // set on Windows XP without error. There is some overhead from the server
@@ -649,6 +652,7 @@ void SSLClientSocketNSS::Disconnect() {
   completed_handshake_   = false;
   eset_mitm_detected_    = false;
   start_cert_verification_time_ = base::TimeTicks();
+  handshake_timing_ = SSLHandshakeTiming();
   predicted_cert_chain_correct_ = false;
   nss_bufs_              = NULL;
   client_certs_.clear();
@@ -1418,6 +1422,10 @@ int SSLClientSocketNSS::DoLoadSSLHostInfo() {
 
 int SSLClientSocketNSS::DoHandshake() {
   EnterFunction("");
+  if (handshake_timing_.handshake_start.is_null()) {
+    handshake_timing_.handshake_start = base::TimeTicks::Now();
+    handshake_timing_.transport_connect_time = transport_->setup_time();
+  }
   int net_error = net::OK;
   SECStatus rv = SSL_ForceHandshake(nss_fd_);
 
@@ -1509,6 +1517,7 @@ int SSLClientSocketNSS::DoHandshake() {
         }
 #endif
 
+        LogHandshakeMetrics();
         SaveSSLHostInfo();
         // SSL handshake is completed. Let's verify the certificate.
         GotoState(STATE_VERIFY_DNSSEC);
@@ -1736,6 +1745,8 @@ int SSLClientSocketNSS::DoVerifyCertComplete(int result) {
   if (result == OK)
     LogConnectionTypeMetrics();
 
+  LogHandshakeTiming();
+
   completed_handshake_ = true;
 
   if (!user_read_callback_.is_null()) {
@@ -1877,6 +1888,51 @@ void SSLClientSocketNSS::LogConnectionTypeMetrics() const {
   };
 }
 
+void SSLClientSocketNSS::LogHandshakeMetrics() {
+  PRBool resumed;
+  if (SSL_HandshakeResumedSession(nss_fd_, &resumed) != SECSuccess)
+    return;
+
+  UMA_HISTOGRAM_BOOLEAN("Net.SSLHandshakeResumed", resumed == PR_TRUE);
+  handshake_timing_.finished = base::TimeTicks::Now();
+  handshake_timing_.resumed = resumed == PR_TRUE;
+  base::TimeDelta handshake_time =
+      handshake_timing_.finished - handshake_timing_.handshake_start;
+  if (resumed) {
+    UMA_HISTOGRAM_TIMES("Net.SSLHandshakeTime_Resumed", handshake_time);
+    return;
+  }
+  UMA_HISTOGRAM_TIMES("Net.SSLHandshakeTime_Full", handshake_time);
+
+  // NSS can't import sessions into its client session cache, so sessions
+  // don't survive a restart.  Measure the full handshakes with servers whose
+  // last session would still have been in the cache.
+  if (ssl_host_info_.get() &&
+      ssl_host_info_->WaitForDataReady(net::CompletionCallback()) == OK) {
+    const base::Time& session_expiry = ssl_host_info_->state().session_expiry;
+    UMA_HISTOGRAM_BOOLEAN(
+        "Net.SSLFullHandshakeWithUnexpiredSession",
+        !session_expiry.is_null() && session_expiry > base::Time::Now());
+  }
+}
+
+void SSLClientSocketNSS::LogHandshakeTiming() {
+  if (!start_cert_verification_time_.is_null()) {
+    handshake_timing_.cert_verify_start = start_cert_verification_time_;
+    handshake_timing_.cert_verify_end = base::TimeTicks::Now();
+  }
+#ifdef SSL_ENABLE_FALSE_START
+  PRBool false_start = PR_FALSE;
+  if (SSL_OptionGet(nss_fd_, SSL_ENABLE_FALSE_START, &false_start) ==
+      SECSuccess) {
+    handshake_timing_.false_start_enabled = false_start == PR_TRUE;
+  }
+#endif
+  net_log_.AddEvent(
+      NetLog::TYPE_SSL_HANDSHAKE_TIMING,
+      make_scoped_refptr(new SSLHandshakeTimingParams(handshake_timing_)));
+}
+
 // SaveSSLHostInfo saves the certificate chain of the connection so that we can
 // start verification faster in the future.
 void SSLClientSocketNSS::SaveSSLHostInfo() {
@@ -1890,6 +1946,14 @@ void SSLClientSocketNSS::SaveSSLHostInfo() {
 
   SSLHostInfo::State* state = ssl_host_info_->mutable_state();
 
+  // A full handshake starts a new session in the client session cache.
+  PRBool resumed;
+  if (SSL_HandshakeResumedSession(nss_fd_, &resumed) == SECSuccess &&
+      !resumed) {
+    state->session_expiry = base::Time::Now() +
+        base::TimeDelta::FromHours(kSessionCacheTimeoutHours);
+  }
+
   state->certs.clear();
   PeerCertificateChain certs(nss_fd_);
   for (unsigned i = 0; i < certs.size(); i++) {
@@ -2053,8 +2117,13 @@ SECStatus SSLClientSocketNSS::OwnAuthCertHandler(void* arg,
                                                  PRFileDesc* socket,
                                                  PRBool checksig,
                                                  PRBool is_server) {
-#ifdef SSL_ENABLE_FALSE_START
   SSLClientSocketNSS* that = reinterpret_cast<SSLClientSocketNSS*>(arg);
+  // NSS doesn't report the ServerHello itself, but the certificate is part of
+  // the same flight.
+  if (that->handshake_timing_.server_hello.is_null())
+    that->handshake_timing_.server_hello = base::TimeTicks::Now();
+
+#ifdef SSL_ENABLE_FALSE_START
   if (!that->server_cert_nss_) {
     // Only need to turn off False Start in the initial handshake. Also, it is
     // unsafe to call SSL_OptionSet in a renegotiation because the "first
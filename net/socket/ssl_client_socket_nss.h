@@ -29,6 +29,7 @@
 #include "net/base/ssl_config_service.h"
 #include "net/base/x509_certificate.h"
 #include "net/socket/ssl_client_socket.h"
+#include "net/socket/ssl_handshake_timing.h"
 
 namespace net {
 
@@ -146,6 +147,12 @@ class SSLClientSocketNSS : public SSLClientSocket {
   int DoPayloadRead();
   int DoPayloadWrite();
   void LogConnectionTypeMetrics() const;
+  // Records whether the handshake that just completed resumed a session, and
+  // how long it took.
+  void LogHandshakeMetrics();
+  // Adds the TYPE_SSL_HANDSHAKE_TIMING event once the certificate has been
+  // verified.
+  void LogHandshakeTiming();
   void SaveSSLHostInfo();
 
   bool DoTransportIO();
@@ -288,6 +295,10 @@ class SSLClientSocketNSS : public SSLClientSocket {
 
   base::TimeTicks start_cert_verification_time_;
 
+  // When the steps of the handshake happened.  The handshake starts with the
+  // first DoHandshake() of the connection.
+  SSLHandshakeTiming handshake_timing_;
+
   scoped_ptr<SSLHostInfo> ssl_host_info_;
 
   TransportSecurityState* transport_security_state_;
@@ -333,6 +333,7 @@ class SSLContext {
     SSL_CTX_set_timeout(ssl_ctx_.get(), kSessionCacheTimeoutSeconds);
     SSL_CTX_sess_set_cache_size(ssl_ctx_.get(), kSessionCacheMaxEntires);
     SSL_CTX_set_client_cert_cb(ssl_ctx_.get(), ClientCertCallback);
+    SSL_CTX_set_msg_callback(ssl_ctx_.get(), MessageCallback);
 #if defined(OPENSSL_NPN_NEGOTIATED)
     // TODO(kristianm): Only select this if ssl_config_.next_proto is not empty.
     // It would be better if the callback were not a global setting,
@@ -377,6 +378,13 @@ class SSLContext {
     return socket->SelectNextProtoCallback(out, outlen, in, inlen);
   }
 
+  static void MessageCallback(int write_p, int version, int content_type,
+                              const void* buf, size_t len, SSL* ssl,
+                              void* arg) {
+    SSLClientSocketOpenSSL* socket = GetInstance()->GetClientSocketFromSSL(ssl);
+    socket->MessageCallback(write_p, content_type, buf, len);
+  }
+
   // This is the index used with SSL_get_ex_data to retrieve the owner
   // SSLClientSocketOpenSSL object from an SSL instance.
   int ssl_socket_data_index_;
@@ -492,6 +500,13 @@ bool SSLClientSocketOpenSSL::Init() {
   mode.ConfigureFlag(SSL_MODE_SMALL_BUFFERS, true);
 #endif
 
+#if defined(SSL_MODE_HANDSHAKE_CUTTHROUGH)
+  // The OpenSSL equivalent of False Start: application data may be sent as
+  // soon as our Finished message is, without waiting for the server's.
+  mode.ConfigureFlag(SSL_MODE_HANDSHAKE_CUTTHROUGH,
+                     ssl_config_.false_start_enabled);
+#endif
+
   SSL_set_mode(ssl_, mode.set_mask);
   SSL_clear_mode(ssl_, mode.clear_mask);
 
@@ -730,6 +745,7 @@ void SSLClientSocketOpenSSL::Disconnect() {
 
   server_cert_verify_result_.Reset();
   completed_handshake_ = false;
+  handshake_timing_ = SSLHandshakeTiming();
 
   client_certs_.clear();
   client_auth_cert_needed_ = false;
@@ -776,6 +792,10 @@ int SSLClientSocketOpenSSL::DoHandshakeLoop(int last_io_result) {
 
 int SSLClientSocketOpenSSL::DoHandshake() {
   crypto::OpenSSLErrStackTracer err_tracer(FROM_HERE);
+  if (handshake_timing_.handshake_start.is_null()) {
+    handshake_timing_.handshake_start = base::TimeTicks::Now();
+    handshake_timing_.transport_connect_time = transport_->setup_time();
+  }
   int net_error = net::OK;
   int rv = SSL_do_handshake(ssl_);
 
@@ -799,6 +819,12 @@ int SSLClientSocketOpenSSL::DoHandshake() {
       DVLOG(2) << "Result of session reuse for " << host_and_port_.ToString()
                << " is: " << (SSL_session_reused(ssl_) ? "Success" : "Fail");
     }
+    handshake_timing_.finished = base::TimeTicks::Now();
+    handshake_timing_.resumed = !!SSL_session_reused(ssl_);
+#if defined(SSL_MODE_HANDSHAKE_CUTTHROUGH)
+    handshake_timing_.false_start_enabled =
+        (SSL_get_mode(ssl_) & SSL_MODE_HANDSHAKE_CUTTHROUGH) != 0;
+#endif
     // SSL handshake is completed.  Let's verify the certificate.
     const bool got_cert = !!UpdateServerCert();
     DCHECK(got_cert);
@@ -882,6 +908,17 @@ int SSLClientSocketOpenSSL::SelectNextProtoCallback(unsigned char** out,
   return SSL_TLSEXT_ERR_OK;
 }
 
+void SSLClientSocketOpenSSL::MessageCallback(int write_p, int content_type,
+                                             const void* buf, size_t len) {
+  if (write_p || content_type != SSL3_RT_HANDSHAKE || len == 0)
+    return;
+  const unsigned char message_type = static_cast<const unsigned char*>(buf)[0];
+  if (message_type == SSL3_MT_SERVER_HELLO &&
+      handshake_timing_.server_hello.is_null()) {
+    handshake_timing_.server_hello = base::TimeTicks::Now();
+  }
+}
+
 int SSLClientSocketOpenSSL::DoVerifyCert(int result) {
   DCHECK(server_cert_);
   GotoState(STATE_VERIFY_CERT_COMPLETE);
@@ -902,6 +939,7 @@ int SSLClientSocketOpenSSL::DoVerifyCert(int result) {
     flags |= X509Certificate::VERIFY_EV_CERT;
   if (ssl_config_.cert_io_enabled)
     flags |= X509Certificate::VERIFY_CERT_IO_ENABLED;
+  handshake_timing_.cert_verify_start = base::TimeTicks::Now();
   verifier_.reset(new SingleRequestCertVerifier(cert_verifier_));
   return verifier_->Verify(
       server_cert_, host_and_port_.host(), flags,
@@ -923,6 +961,12 @@ int SSLClientSocketOpenSSL::DoVerifyCertComplete(int result) {
              << " (" << result << ")";
   }
 
+  if (!handshake_timing_.cert_verify_start.is_null())
+    handshake_timing_.cert_verify_end = base::TimeTicks::Now();
+  net_log_.AddEvent(
+      NetLog::TYPE_SSL_HANDSHAKE_TIMING,
+      make_scoped_refptr(new SSLHandshakeTimingParams(handshake_timing_)));
+
   completed_handshake_ = true;
   // Exit DoHandshakeLoop and return the result to the caller to Connect.
   DCHECK_EQ(STATE_NONE, next_handshake_state_);
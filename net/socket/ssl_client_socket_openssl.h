@@ -14,6 +14,7 @@
 #include "net/base/io_buffer.h"
 #include "net/base/ssl_config_service.h"
 #include "net/socket/ssl_client_socket.h"
+#include "net/socket/ssl_handshake_timing.h"
 #include "net/socket/client_socket_handle.h"
 
 typedef struct bio_st BIO;
@@ -55,6 +56,12 @@ class SSLClientSocketOpenSSL : public SSLClientSocket {
   int SelectNextProtoCallback(unsigned char** out, unsigned char* outlen,
                               const unsigned char* in, unsigned int inlen);
 
+  // Callback from the SSL layer for each protocol message sent or received
+  // (|write_p| is non-zero for sent messages).  Records when the steps of the
+  // handshake happened.
+  void MessageCallback(int write_p, int content_type,
+                       const void* buf, size_t len);
+
   // SSLClientSocket implementation.
   virtual void GetSSLInfo(SSLInfo* ssl_info);
   virtual void GetSSLCertRequestInfo(SSLCertRequestInfo* cert_request_info);
@@ -141,6 +148,9 @@ class SSLClientSocketOpenSSL : public SSLClientSocket {
   CertVerifyResult server_cert_verify_result_;
   bool completed_handshake_;
 
+  // When the steps of the handshake happened.
+  SSLHandshakeTiming handshake_timing_;
+
   // Stores client authentication information between ClientAuthHandler and
   // GetSSLCertRequestInfo calls.
   std::vector<scoped_refptr<X509Certificate> > client_certs_;
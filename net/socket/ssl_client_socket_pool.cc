@@ -213,8 +213,10 @@ int SSLConnectJob::DoTransportConnect() {
 }
 
 int SSLConnectJob::DoTransportConnectComplete(int result) {
-  if (result == OK)
+  if (result == OK) {
+    *mutable_connect_timing() = transport_socket_handle_->connect_timing();
     next_state_ = STATE_SSL_CONNECT;
+  }
 
   return result;
 }
@@ -230,8 +232,10 @@ int SSLConnectJob::DoSOCKSConnect() {
 }
 
 int SSLConnectJob::DoSOCKSConnectComplete(int result) {
-  if (result == OK)
+  if (result == OK) {
+    *mutable_connect_timing() = transport_socket_handle_->connect_timing();
     next_state_ = STATE_SSL_CONNECT;
+  }
 
   return result;
 }
@@ -265,6 +269,7 @@ int SSLConnectJob::DoTunnelConnectComplete(int result) {
   if (result < 0)
     return result;
 
+  *mutable_connect_timing() = transport_socket_handle_->connect_timing();
   next_state_ = STATE_SSL_CONNECT;
   return result;
 }
@@ -274,6 +279,7 @@ int SSLConnectJob::DoSSLConnect() {
   // Reset the timeout to just the time allowed for the SSL handshake.
   ResetTimer(base::TimeDelta::FromSeconds(kSSLHandshakeTimeoutInSeconds));
   ssl_connect_start_time_ = base::TimeTicks::Now();
+  mutable_connect_timing()->ssl_start = ssl_connect_start_time_;
 
   ssl_socket_.reset(client_socket_factory_->CreateSSLClientSocket(
       transport_socket_handle_.release(), params_->host_and_port(),
@@ -303,7 +309,8 @@ int SSLConnectJob::DoSSLConnectComplete(int result) {
     // TODO(mbelshe): verify it was a protocol we advertised?
     if (protocol_negotiated == kProtoSPDY1 ||
         protocol_negotiated == kProtoSPDY2 ||
-        protocol_negotiated == kProtoSPDY3) {
+        protocol_negotiated == kProtoSPDY3 ||
+        protocol_negotiated == kProtoSPDY3a1) {
       ssl_socket_->set_was_spdy_negotiated(true);
     }
   }
@@ -379,6 +386,9 @@ int SSLConnectJob::DoSSLConnectComplete(int result) {
   }
 
   if (result == OK || IsCertificateError(result)) {
+    base::TimeTicks now = base::TimeTicks::Now();
+    mutable_connect_timing()->ssl_end = now;
+    mutable_connect_timing()->connect_end = now;
     set_socket(ssl_socket_.release());
   } else if (result == ERR_SSL_CLIENT_AUTH_CERT_NEEDED) {
     error_response_info_.cert_request_info = new SSLCertRequestInfo;
@@ -0,0 +1,57 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/socket/ssl_handshake_timing.h"
+
+#include "base/values.h"
+
+namespace net {
+
+namespace {
+
+// Sets |key| to the number of milliseconds between |start| and |time|, unless
+// |time| is null.
+void SetOffset(DictionaryValue* dict,
+               const char* key,
+               base::TimeTicks start,
+               base::TimeTicks time) {
+  if (time.is_null())
+    return;
+  dict->SetInteger(key, static_cast<int>((time - start).InMilliseconds()));
+}
+
+}  // namespace
+
+SSLHandshakeTiming::SSLHandshakeTiming()
+    : resumed(false),
+      false_start_enabled(false) {
+}
+
+SSLHandshakeTiming::~SSLHandshakeTiming() {}
+
+SSLHandshakeTimingParams::SSLHandshakeTimingParams(
+    const SSLHandshakeTiming& timing)
+    : timing_(timing) {
+}
+
+Value* SSLHandshakeTimingParams::ToValue() const {
+  DictionaryValue* dict = new DictionaryValue();
+  dict->SetInteger(
+      "transport_connect_ms",
+      static_cast<int>(timing_.transport_connect_time.InMilliseconds()));
+  if (!timing_.handshake_start.is_null()) {
+    const base::TimeTicks& start = timing_.handshake_start;
+    SetOffset(dict, "server_hello_ms", start, timing_.server_hello);
+    SetOffset(dict, "finished_ms", start, timing_.finished);
+    SetOffset(dict, "cert_verify_start_ms", start, timing_.cert_verify_start);
+    SetOffset(dict, "cert_verify_end_ms", start, timing_.cert_verify_end);
+  }
+  dict->SetBoolean("resumed", timing_.resumed);
+  dict->SetBoolean("false_start_enabled", timing_.false_start_enabled);
+  return dict;
+}
+
+SSLHandshakeTimingParams::~SSLHandshakeTimingParams() {}
+
+}  // namespace net
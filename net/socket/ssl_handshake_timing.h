@@ -0,0 +1,66 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_SOCKET_SSL_HANDSHAKE_TIMING_H_
+#define NET_SOCKET_SSL_HANDSHAKE_TIMING_H_
+#pragma once
+
+#include "base/time.h"
+#include "net/base/net_log.h"
+
+namespace net {
+
+// When the steps of an SSL client handshake happened.  SSLClientSocket
+// implementations fill this in as the handshake progresses and log it with a
+// TYPE_SSL_HANDSHAKE_TIMING event once the certificate has been verified.
+// Steps that didn't happen, or that the SSL library doesn't report, are left
+// null.
+struct SSLHandshakeTiming {
+  SSLHandshakeTiming();
+  ~SSLHandshakeTiming();
+
+  // The time between when the transport socket was requested and when it was
+  // connected.  This includes the host resolution and the TCP handshake.
+  base::TimeDelta transport_connect_time;
+
+  // When the client sent its ClientHello.
+  base::TimeTicks handshake_start;
+
+  // When the ServerHello was received.  Libraries that only report the
+  // server's certificate use that instead, since it arrives in the same
+  // flight.
+  base::TimeTicks server_hello;
+
+  // When the handshake completed from the client's point of view: the client
+  // may send application data from then on.  With False Start, this is before
+  // the server's Finished message arrives.
+  base::TimeTicks finished;
+
+  base::TimeTicks cert_verify_start;
+  base::TimeTicks cert_verify_end;
+
+  // Whether a previous session was resumed.
+  bool resumed;
+
+  // Whether False Start was enabled for the handshake.
+  bool false_start_enabled;
+};
+
+// NetLog parameters for TYPE_SSL_HANDSHAKE_TIMING.
+class SSLHandshakeTimingParams : public NetLog::EventParameters {
+ public:
+  explicit SSLHandshakeTimingParams(const SSLHandshakeTiming& timing);
+
+  virtual base::Value* ToValue() const OVERRIDE;
+
+ protected:
+  virtual ~SSLHandshakeTimingParams();
+
+ private:
+  const SSLHandshakeTiming timing_;
+};
+
+}  // namespace net
+
+#endif  // NET_SOCKET_SSL_HANDSHAKE_TIMING_H_
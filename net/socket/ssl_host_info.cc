@@ -21,6 +21,7 @@ SSLHostInfo::State::~State() {}
 
 void SSLHostInfo::State::Clear() {
   certs.clear();
+  session_expiry = base::Time();
 }
 
 SSLHostInfo::SSLHostInfo(
@@ -99,6 +100,11 @@ bool SSLHostInfo::ParseInner(const std::string& data) {
     }
   }
 
+  // The session expiry was added later, so it is optional.
+  int64 session_expiry;
+  if (p.ReadInt64(&iter, &session_expiry))
+    state->session_expiry = base::Time::FromInternalValue(session_expiry);
+
   if (!state->certs.empty()) {
     std::vector<base::StringPiece> der_certs(state->certs.size());
     for (size_t i = 0; i < state->certs.size(); i++)
@@ -161,6 +167,9 @@ std::string SSLHostInfo::Serialize() const {
     return "";
   }
 
+  if (!p.WriteInt64(state_.session_expiry.ToInternalValue()))
+    return "";
+
   return std::string(reinterpret_cast<const char *>(p.data()), p.size());
 }
 
@@ -26,8 +26,7 @@ struct SSLConfig;
 
 // SSLHostInfo is an interface for fetching information about an SSL server.
 // This information may be stored on disk so does not include keys or session
-// information etc. Primarily it's intended for caching the server's
-// certificates.
+// secrets etc. Primarily it's intended for caching the server's certificates.
 class NET_EXPORT_PRIVATE SSLHostInfo {
  public:
   SSLHostInfo(const std::string& hostname,
@@ -69,6 +68,10 @@ class NET_EXPORT_PRIVATE SSLHostInfo {
     // returned them and in the same order.
     std::vector<std::string> certs;
 
+    // When the session of the last full handshake with the server expires
+    // from the client session cache, or null if unknown.
+    base::Time session_expiry;
+
    private:
     DISALLOW_COPY_AND_ASSIGN(State);
   };
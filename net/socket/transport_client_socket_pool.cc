@@ -194,6 +194,7 @@ int TransportConnectJob::DoLoop(int result) {
 
 int TransportConnectJob::DoResolveHost() {
   next_state_ = STATE_RESOLVE_HOST_COMPLETE;
+  mutable_connect_timing()->dns_start = base::TimeTicks::Now();
   return resolver_.Resolve(
       params_->destination(), &addresses_,
       base::Bind(&TransportConnectJob::OnIOComplete, base::Unretained(this)),
@@ -201,6 +202,7 @@ int TransportConnectJob::DoResolveHost() {
 }
 
 int TransportConnectJob::DoResolveHostComplete(int result) {
+  mutable_connect_timing()->dns_end = base::TimeTicks::Now();
   if (result == OK)
     next_state_ = STATE_TRANSPORT_CONNECT;
   return result;
@@ -211,6 +213,7 @@ int TransportConnectJob::DoTransportConnect() {
   transport_socket_.reset(client_socket_factory_->CreateTransportClientSocket(
         addresses_, net_log().net_log(), net_log().source()));
   connect_start_time_ = base::TimeTicks::Now();
+  mutable_connect_timing()->connect_start = connect_start_time_;
   int rv = transport_socket_->Connect(
       base::Bind(&TransportConnectJob::OnIOComplete, base::Unretained(this)));
   if (rv == ERR_IO_PENDING &&
@@ -264,6 +267,7 @@ int TransportConnectJob::DoTransportConnectComplete(int result) {
                                    100);
       }
     }
+    mutable_connect_timing()->connect_end = now;
     set_socket(transport_socket_.release());
     fallback_timer_.Stop();
   } else {
@@ -335,6 +339,7 @@ void TransportConnectJob::DoIPv6FallbackTransportConnectComplete(int result) {
         base::TimeDelta::FromMilliseconds(1),
         base::TimeDelta::FromMinutes(10),
         100);
+    mutable_connect_timing()->connect_end = now;
     set_socket(fallback_transport_socket_.release());
     next_state_ = STATE_NONE;
     transport_socket_.reset();
@@ -12,6 +12,7 @@
 #include "base/message_loop.h"
 #include "base/threading/platform_thread.h"
 #include "net/base/ip_endpoint.h"
+#include "net/base/load_timing_info.h"
 #include "net/base/mock_host_resolver.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_util.h"
@@ -531,6 +532,38 @@ TEST_F(TransportClientSocketPoolTest, Basic) {
   handle.Reset();
 }
 
+// Tests that a new socket reports its host resolution and connect times, and
+// only to the first request that uses it.
+TEST_F(TransportClientSocketPoolTest, ConnectTiming) {
+  TestCompletionCallback callback;
+  ClientSocketHandle handle;
+  int rv = handle.Init("a", low_params_, LOW, callback.callback(), &pool_,
+                       BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(OK, callback.WaitForResult());
+
+  const LoadTimingInfo::ConnectTiming& connect_timing =
+      handle.connect_timing();
+  EXPECT_FALSE(connect_timing.dns_start.is_null());
+  EXPECT_LE(connect_timing.dns_start, connect_timing.dns_end);
+  EXPECT_LE(connect_timing.dns_end, connect_timing.connect_start);
+  EXPECT_LE(connect_timing.connect_start, connect_timing.connect_end);
+  EXPECT_TRUE(connect_timing.ssl_start.is_null());
+
+  LoadTimingInfo load_timing_info;
+  EXPECT_TRUE(handle.GetLoadTimingInfo(false, &load_timing_info));
+  EXPECT_FALSE(load_timing_info.socket_reused);
+  EXPECT_EQ(connect_timing.connect_end,
+            load_timing_info.connect_timing.connect_end);
+
+  EXPECT_TRUE(handle.GetLoadTimingInfo(true, &load_timing_info));
+  EXPECT_TRUE(load_timing_info.socket_reused);
+  EXPECT_TRUE(load_timing_info.connect_timing.connect_start.is_null());
+
+  handle.Reset();
+  EXPECT_TRUE(handle.connect_timing().connect_start.is_null());
+}
+
 TEST_F(TransportClientSocketPoolTest, InitHostResolutionFailure) {
   host_resolver_->rules()->AddSimulatedFailure("unresolvable.host.name");
   TestCompletionCallback callback;
@@ -34,6 +34,11 @@ void BufferedSpdyFramer::set_visitor(
   spdy_framer_.set_visitor(this);
 }
 
+void BufferedSpdyFramer::set_header_compressor(
+    SpdyHeaderCompressorInterface* compressor) {
+  spdy_framer_.set_header_compressor(compressor);
+}
+
 void BufferedSpdyFramer::OnError(SpdyFramer* spdy_framer) {
   DCHECK(spdy_framer);
   visitor_->OnError(spdy_framer->error_code());
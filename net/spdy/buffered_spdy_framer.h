@@ -85,6 +85,10 @@ class NET_EXPORT_PRIVATE BufferedSpdyFramer
   // visitor will be used.
   void set_visitor(BufferedSpdyFramerVisitorInterface* visitor);
 
+  // Compresses header blocks with |compressor| instead of zlib. Takes
+  // ownership of |compressor|. Must be called before any frame is framed.
+  void set_header_compressor(SpdyHeaderCompressorInterface* compressor);
+
   // SpdyFramerVisitorInterface
   virtual void OnError(SpdyFramer* spdy_framer) OVERRIDE;
   virtual void OnControl(const SpdyControlFrame* frame) OVERRIDE;
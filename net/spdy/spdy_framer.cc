@@ -705,7 +705,11 @@ size_t SpdyFramer::ProcessControlFrameHeaderBlock(const char* data,
          control_frame.type() == HEADERS);
   size_t process_bytes = std::min(data_len, remaining_control_payload_);
   if (process_bytes > 0) {
-    if (enable_compression_) {
+    if (enable_compression_ && header_block_compressor_.get()) {
+      processed_successfully = DecompressControlFrameHeaderDataWithCompressor(
+          &control_frame, data, process_bytes,
+          process_bytes == remaining_control_payload_);
+    } else if (enable_compression_) {
       processed_successfully = IncrementallyDecompressControlFrameHeaderData(
           &control_frame, data, process_bytes);
     } else {
@@ -1362,6 +1366,9 @@ bool SpdyFramer::GetFrameBoundaries(const SpdyFrame& frame,
 
 SpdyControlFrame* SpdyFramer::CompressControlFrame(
     const SpdyControlFrame& frame) {
+  if (enable_compression_ && header_block_compressor_.get())
+    return CompressControlFrameWithCompressor(frame);
+
   z_stream* compressor = GetHeaderCompressor();
   if (!compressor)
     return NULL;
@@ -1428,6 +1435,41 @@ SpdyControlFrame* SpdyFramer::CompressControlFrame(
   return new_frame.release();
 }
 
+SpdyControlFrame* SpdyFramer::CompressControlFrameWithCompressor(
+    const SpdyControlFrame& frame) {
+  int payload_length;
+  int header_length;
+  const char* payload;
+
+  base::StatsCounter compressed_frames("spdy.CompressedFrames");
+  base::StatsCounter pre_compress_bytes("spdy.PreCompressSize");
+  base::StatsCounter post_compress_bytes("spdy.PostCompressSize");
+
+  if (!GetFrameBoundaries(frame, &payload_length, &header_length, &payload))
+    return NULL;
+
+  std::string compressed;
+  if (!header_block_compressor_->CompressHeaderBlock(payload, payload_length,
+                                                     &compressed)) {
+    LOG(WARNING) << "Header block compression failure";
+    return NULL;
+  }
+
+  size_t new_frame_size = header_length + compressed.size();
+  scoped_ptr<SpdyControlFrame> new_frame(new SpdyControlFrame(new_frame_size));
+  memcpy(new_frame->data(), frame.data(), header_length);
+  memcpy(new_frame->data() + header_length, compressed.data(),
+         compressed.size());
+  new_frame->set_length(new_frame_size - SpdyFrame::kHeaderSize);
+
+  pre_compress_bytes.Add(payload_length);
+  post_compress_bytes.Add(new_frame->length());
+
+  compressed_frames.Increment();
+
+  return new_frame.release();
+}
+
 // Incrementally decompress the control frame's header block, feeding the
 // result to the visitor in chunks. Continue this until the visitor
 // indicates that it cannot process any more data, or (more commonly) we
@@ -1499,6 +1541,22 @@ bool SpdyFramer::IncrementallyDecompressControlFrameHeaderData(
   return processed_successfully;
 }
 
+bool SpdyFramer::DecompressControlFrameHeaderDataWithCompressor(
+    const SpdyControlFrame* control_frame,
+    const char* data,
+    size_t len,
+    bool end_of_block) {
+  std::string decompressed;
+  if (!header_block_compressor_->DecompressHeaderBlock(data, len, end_of_block,
+                                                       &decompressed)) {
+    DLOG(WARNING) << "Header block decompression failure: " << len;
+    set_error(SPDY_DECOMPRESS_FAILURE);
+    return false;
+  }
+  return IncrementallyDeliverControlFrameHeaderData(
+      control_frame, decompressed.data(), decompressed.size());
+}
+
 bool SpdyFramer::IncrementallyDeliverControlFrameHeaderData(
     const SpdyControlFrame* control_frame, const char* data, size_t len) {
   bool read_successfully = true;
@@ -1627,4 +1685,11 @@ void SpdyFramer::set_enable_compression(bool value) {
   enable_compression_ = value;
 }
 
+void SpdyFramer::set_header_compressor(
+    SpdyHeaderCompressorInterface* compressor) {
+  DCHECK(!header_compressor_.get());
+  DCHECK(!header_decompressor_.get());
+  header_block_compressor_.reset(compressor);
+}
+
 }  // namespace net
@@ -186,6 +186,31 @@ class NET_EXPORT_PRIVATE SpdyFramerVisitorInterface {
   virtual void OnSetting(SpdySettingsIds id, uint8 flags, uint32 value) = 0;
 };
 
+// SpdyHeaderCompressorInterface replaces the zlib compression of the header
+// blocks of SYN_STREAM, SYN_REPLY and HEADERS frames.  Header blocks are passed
+// in and out in their serialized SPDY form.  The compression state is shared
+// by all the header blocks of a session, so they must be compressed and
+// decompressed in the order in which they are put on the wire.
+class NET_EXPORT_PRIVATE SpdyHeaderCompressorInterface {
+ public:
+  virtual ~SpdyHeaderCompressorInterface() {}
+
+  // Compresses the serialized header block of |len| bytes at |data|, and
+  // appends the result to |output|.  Returns false on failure.
+  virtual bool CompressHeaderBlock(const char* data,
+                                   size_t len,
+                                   std::string* output) = 0;
+
+  // Decompresses the next |len| bytes of a compressed header block, and
+  // appends the serialized header block to |output| as it becomes available.
+  // |end_of_block| is true for the last bytes of the block.  Returns false if
+  // the compressed data is invalid.
+  virtual bool DecompressHeaderBlock(const char* data,
+                                     size_t len,
+                                     bool end_of_block,
+                                     std::string* output) = 0;
+};
+
 class NET_EXPORT_PRIVATE SpdyFramer {
  public:
   // SPDY states.
@@ -402,6 +427,12 @@ class NET_EXPORT_PRIVATE SpdyFramer {
   // For ease of testing and experimentation we can tweak compression on/off.
   void set_enable_compression(bool value);
 
+  // Compresses header blocks with |compressor| instead of zlib.  Takes
+  // ownership of |compressor|.  Both ends of the session must use the same
+  // kind of compressor, and it must be set before any header block is
+  // compressed or decompressed.
+  void set_header_compressor(SpdyHeaderCompressorInterface* compressor);
+
   // Used only in log messages.
   void set_display_protocol(const std::string& protocol) {
     display_protocol_ = protocol;
@@ -474,6 +505,20 @@ class NET_EXPORT_PRIVATE SpdyFramer {
       const char* data,
       size_t len);
 
+  // Same as IncrementallyDecompressControlFrameHeaderData(), but with
+  // |header_block_compressor_|.  |end_of_block| is true for the last bytes of
+  // the header block.
+  bool DecompressControlFrameHeaderDataWithCompressor(
+      const SpdyControlFrame* frame,
+      const char* data,
+      size_t len,
+      bool end_of_block);
+
+  // Returns a new SpdyControlFrame with the payload of |frame| compressed by
+  // |header_block_compressor_|.
+  SpdyControlFrame* CompressControlFrameWithCompressor(
+      const SpdyControlFrame& frame);
+
   // Deliver the given control frame's uncompressed headers block to the
   // visitor in chunks. Returns true if the visitor has accepted all of the
   // chunks.
@@ -543,6 +588,8 @@ class NET_EXPORT_PRIVATE SpdyFramer {
   // SPDY header compressors.
   scoped_ptr<z_stream> header_compressor_;
   scoped_ptr<z_stream> header_decompressor_;
+  // Replaces the zlib compressors when set.
+  scoped_ptr<SpdyHeaderCompressorInterface> header_block_compressor_;
 
   SpdyFramerVisitorInterface* visitor_;
 
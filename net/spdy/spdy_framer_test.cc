@@ -8,6 +8,7 @@
 
 #include "base/memory/scoped_ptr.h"
 #include "net/spdy/spdy_framer.h"
+#include "net/spdy/spdy_indexed_header_compressor.h"
 #include "net/spdy/spdy_protocol.h"
 #include "net/spdy/spdy_frame_builder.h"
 #include "testing/gmock/include/gmock/gmock.h"
@@ -1197,6 +1198,54 @@ TEST_P(SpdyFramerTest, HeaderCompression) {
   EXPECT_EQ(kValue3, decompressed_headers[kHeader3]);
 }
 
+TEST_P(SpdyFramerTest, IndexedHeaderCompression) {
+  SpdyFramer send_framer(spdy_version_);
+  SpdyFramer recv_framer(spdy_version_);
+  send_framer.set_header_compressor(
+      new SpdyIndexedHeaderCompressor(spdy_version_));
+  recv_framer.set_header_compressor(
+      new SpdyIndexedHeaderCompressor(spdy_version_));
+
+  SpdyHeaderBlock block;
+  block["header1"] = "value1";
+  block["header2"] = "value2";
+  block["user-agent"] = "Mozilla/5.0";
+
+  size_t previous_length = 0;
+  for (SpdyStreamId stream_id = 1; stream_id < 7; stream_id += 2) {
+    scoped_ptr<SpdySynStreamControlFrame> syn_frame(
+        send_framer.CreateSynStream(stream_id,
+                                    0,  // associated stream id
+                                    0,  // priority
+                                    0,  // credential slot
+                                    CONTROL_FLAG_NONE,
+                                    true,  // compress
+                                    &block));
+    ASSERT_TRUE(syn_frame.get() != NULL);
+    // Headers that were already sent are only referred to.
+    if (stream_id == 3)
+      EXPECT_LT(syn_frame->length(), previous_length);
+    previous_length = syn_frame->length();
+
+    scoped_ptr<SpdyFrame> decompressed(
+        SpdyFramerTestUtil::DecompressFrame(&recv_framer, *syn_frame.get()));
+    ASSERT_TRUE(decompressed.get() != NULL);
+    SpdySynStreamControlFrame decompressed_syn(decompressed->data(), false);
+    EXPECT_EQ(stream_id, decompressed_syn.stream_id());
+    SpdyHeaderBlock decompressed_headers;
+    EXPECT_TRUE(recv_framer.ParseHeaderBlockInBuffer(
+        decompressed_syn.header_block(), decompressed_syn.header_block_len(),
+        &decompressed_headers));
+    EXPECT_TRUE(CompareHeaderBlocks(&block, &decompressed_headers));
+
+    // The last block changes one value, and adds a header.
+    if (stream_id == 3) {
+      block["header1"] = "value3";
+      block["header3"] = "value3";
+    }
+  }
+}
+
 // Verify we don't leak when we leave streams unclosed
 TEST_P(SpdyFramerTest, UnclosedStreamDataCompressors) {
   SpdyFramer send_framer(spdy_version_);
@@ -0,0 +1,189 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares the CPU time and the compression ratio of zlib and of the indexed
+// header compressor, on a sequence of header blocks like those of a browser
+// loading a page.
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/perftimer.h"
+#include "base/string_number_conversions.h"
+#include "base/stringprintf.h"
+#include "base/test/perf_benchmark.h"
+#include "net/spdy/spdy_framer.h"
+#include "net/spdy/spdy_indexed_header_compressor.h"
+#include "net/spdy/spdy_protocol.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kNumBlocks = 1000;
+
+const int kSpdy2 = 2;
+const int kSpdy3 = 3;
+
+// Receives the decompressed header blocks of SYN_STREAM frames and drops them.
+class HeaderDiscardingVisitor : public SpdyFramerVisitorInterface {
+ public:
+  HeaderDiscardingVisitor() {}
+  virtual ~HeaderDiscardingVisitor() {}
+
+  virtual void OnError(SpdyFramer* framer) OVERRIDE {
+    LOG(FATAL) << "Error decompressing headers";
+  }
+  virtual void OnControl(const SpdyControlFrame* frame) OVERRIDE {
+    CHECK_EQ(SYN_STREAM, frame->type());
+  }
+  virtual bool OnControlFrameHeaderData(SpdyStreamId stream_id,
+                                        const char* header_data,
+                                        size_t len) OVERRIDE {
+    return true;
+  }
+  virtual bool OnCredentialFrameData(const char* credential_data,
+                                     size_t len) OVERRIDE {
+    NOTREACHED();
+    return false;
+  }
+  virtual void OnDataFrameHeader(const SpdyDataFrame* frame) OVERRIDE {
+    NOTREACHED();
+  }
+  virtual void OnStreamFrameData(SpdyStreamId stream_id,
+                                 const char* data,
+                                 size_t len) OVERRIDE {
+    NOTREACHED();
+  }
+  virtual void OnSetting(SpdySettingsIds id,
+                         uint8 flags,
+                         uint32 value) OVERRIDE {
+    NOTREACHED();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(HeaderDiscardingVisitor);
+};
+
+std::vector<SpdyHeaderBlock> MakeHeaderBlocks(int spdy_version) {
+  std::vector<SpdyHeaderBlock> blocks;
+  for (int i = 0; i < kNumBlocks; ++i) {
+    SpdyHeaderBlock block;
+    const std::string path = "/static/resource" + base::IntToString(i % 50) +
+        (i % 3 ? ".png" : ".js");
+    if (spdy_version == kSpdy2) {
+      block["method"] = "GET";
+      block["url"] = path;
+      block["host"] = "www.example.com";
+      block["scheme"] = "https";
+      block["version"] = "HTTP/1.1";
+    } else {
+      block[":method"] = "GET";
+      block[":path"] = path;
+      block[":host"] = "www.example.com";
+      block[":scheme"] = "https";
+      block[":version"] = "HTTP/1.1";
+    }
+    block["accept"] = i % 3 ? "image/webp,*/*;q=0.8" : "*/*";
+    block["accept-encoding"] = "gzip,deflate,sdch";
+    block["accept-language"] = "en-US,en;q=0.8";
+    block["referer"] = "https://www.example.com/page" +
+        base::IntToString(i / 100) + ".html";
+    block["user-agent"] = "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/536.5 "
+        "(KHTML, like Gecko) Chrome/19.0.1084.52 Safari/536.5";
+    block["cookie"] = "session=0123456789abcdef0123456789abcdef; prefs=" +
+        base::IntToString(i / 250);
+    blocks.push_back(block);
+  }
+  return blocks;
+}
+
+// Sends every block in |blocks| through a new pair of framers, the way one
+// session would, and returns the size of the compressed frames.
+size_t SendAll(int spdy_version,
+               bool indexed,
+               const std::vector<SpdyHeaderBlock>* blocks) {
+  SpdyFramer send_framer(spdy_version);
+  SpdyFramer recv_framer(spdy_version);
+  if (indexed) {
+    send_framer.set_header_compressor(
+        new SpdyIndexedHeaderCompressor(spdy_version));
+    recv_framer.set_header_compressor(
+        new SpdyIndexedHeaderCompressor(spdy_version));
+  }
+  HeaderDiscardingVisitor visitor;
+  recv_framer.set_visitor(&visitor);
+
+  size_t compressed_bytes = 0;
+  for (size_t i = 0; i < blocks->size(); ++i) {
+    SpdyStreamId stream_id = 2 * i + 1;
+    scoped_ptr<SpdySynStreamControlFrame> syn_frame(
+        send_framer.CreateSynStream(stream_id, 0, 0, 0, CONTROL_FLAG_NONE,
+                                    true, &(*blocks)[i]));
+    size_t frame_size = syn_frame->length() + SpdyFrame::kHeaderSize;
+    CHECK_EQ(frame_size, recv_framer.ProcessInput(syn_frame->data(),
+                                                  frame_size));
+    CHECK_EQ(SpdyFramer::SPDY_RESET, recv_framer.state());
+    compressed_bytes += syn_frame->length();
+  }
+  return compressed_bytes;
+}
+
+void RunSendAll(int spdy_version,
+                bool indexed,
+                const std::vector<SpdyHeaderBlock>* blocks) {
+  SendAll(spdy_version, indexed, blocks);
+}
+
+size_t UncompressedSize(int spdy_version,
+                        const std::vector<SpdyHeaderBlock>& blocks) {
+  SpdyFramer framer(spdy_version);
+  size_t uncompressed_bytes = 0;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    scoped_ptr<SpdySynStreamControlFrame> syn_frame(
+        framer.CreateSynStream(2 * i + 1, 0, 0, 0, CONTROL_FLAG_NONE, false,
+                               &blocks[i]));
+    uncompressed_bytes += syn_frame->length();
+  }
+  return uncompressed_bytes;
+}
+
+void RunCompressionBenchmarks(int spdy_version) {
+  const std::vector<SpdyHeaderBlock> blocks = MakeHeaderBlocks(spdy_version);
+  const size_t uncompressed_bytes = UncompressedSize(spdy_version, blocks);
+
+  const char* const kCompressorNames[] = { "zlib", "indexed" };
+  for (size_t i = 0; i < arraysize(kCompressorNames); ++i) {
+    const bool indexed = (i == 1);
+    const std::string name = base::StringPrintf(
+        "SpdyHeaderCompression_SPDY%d_%s", spdy_version, kCompressorNames[i]);
+
+    size_t compressed_bytes = SendAll(spdy_version, indexed, &blocks);
+    EXPECT_LT(compressed_bytes, uncompressed_bytes);
+    LogPerfResult((name + "_ratio").c_str(),
+                  static_cast<double>(compressed_bytes) / uncompressed_bytes,
+                  "");
+
+    base::PerfBenchmark benchmark(name);
+    benchmark.set_runs(10);
+    benchmark.Run(base::Bind(&RunSendAll, spdy_version, indexed, &blocks));
+  }
+}
+
+}  // namespace
+
+TEST(SpdyHeaderCompressionPerfTest, SPDY2) {
+  RunCompressionBenchmarks(kSpdy2);
+}
+
+TEST(SpdyHeaderCompressionPerfTest, SPDY3) {
+  RunCompressionBenchmarks(kSpdy3);
+}
+
+}  // namespace net
@@ -121,9 +121,8 @@ int SpdyHttpStream::ReadResponseBody(
         response_body_.pop_front();
       } else {
         const int bytes_remaining = data->size() - bytes_to_copy;
-        IOBufferWithSize* new_buffer = new IOBufferWithSize(bytes_remaining);
-        memcpy(new_buffer->data(), &(data->data()[bytes_to_copy]),
-               bytes_remaining);
+        IOBufferWithSize* new_buffer =
+            new IOBufferSlice(data, bytes_to_copy, bytes_remaining);
         response_body_.pop_front();
         response_body_.push_front(make_scoped_refptr(new_buffer));
       }
@@ -182,6 +181,14 @@ bool SpdyHttpStream::IsConnectionReusable() const {
   return false;
 }
 
+bool SpdyHttpStream::GetLoadTimingInfo(
+    LoadTimingInfo* load_timing_info) const {
+  if (!stream_.get())
+    return false;
+  return spdy_session_->GetLoadTimingInfo(stream_->stream_id(),
+                                          load_timing_info);
+}
+
 void SpdyHttpStream::set_chunk_callback(ChunkCallback* callback) {
   if (request_body_stream_ != NULL)
     request_body_stream_->set_chunk_callback(callback);
@@ -316,10 +323,27 @@ int SpdyHttpStream::OnSendBodyComplete(int status, bool* eof) {
   if (*eof)
     return OK;
 
+  if (!request_body_stream_->is_chunked()) {
+    // The request body stream hands out its in-memory data in place, and
+    // reads files asynchronously. |request_body_stream_| owns the callback,
+    // so it can't outlive |this|.
+    scoped_refptr<IOBuffer> buf;
+    const int bytes_read = request_body_stream_->ReadBuffer(
+        kMaxSpdyFrameChunkSize, &buf,
+        base::Bind(&SpdyHttpStream::OnRequestBodyReadReady,
+                   base::Unretained(this)));
+    if (bytes_read == ERR_IO_PENDING)
+      return ERR_IO_PENDING;
+    // UploadDataStream::ReadBuffer() won't fail if not chunked.
+    DCHECK_GE(bytes_read, 0);
+    request_body_buf_ = new DrainableIOBuffer(buf, bytes_read);
+    return OK;
+  }
+
   // Read the data from the request body stream.
   const int bytes_read = request_body_stream_->Read(
       raw_request_body_buf_, raw_request_body_buf_->size());
-  if (request_body_stream_->is_chunked() && bytes_read == ERR_IO_PENDING)
+  if (bytes_read == ERR_IO_PENDING)
     return ERR_IO_PENDING;
   // ERR_IO_PENDING with chunked encoding is the only possible error.
   DCHECK_GE(bytes_read, 0);
@@ -329,6 +353,14 @@ int SpdyHttpStream::OnSendBodyComplete(int status, bool* eof) {
   return OK;
 }
 
+void SpdyHttpStream::OnRequestBodyReadReady(int result) {
+  // Resume sending the body, which reads the data from the request body
+  // stream again.
+  DCHECK_EQ(OK, result);
+  if (stream_ && !stream_->cancelled() && !stream_->closed())
+    stream_->OnChunkAvailable();
+}
+
 int SpdyHttpStream::OnResponseReceived(const SpdyHeaderBlock& response,
                                        base::Time response_time,
                                        int status) {
@@ -376,7 +408,7 @@ int SpdyHttpStream::OnResponseReceived(const SpdyHeaderBlock& response,
   return status;
 }
 
-void SpdyHttpStream::OnDataReceived(const char* data, int length) {
+void SpdyHttpStream::OnDataReceived(IOBufferWithSize* buffer) {
   // SpdyStream won't call us with data if the header block didn't contain a
   // valid set of headers.  So we don't expect to not have headers received
   // here.
@@ -386,11 +418,9 @@ void SpdyHttpStream::OnDataReceived(const char* data, int length) {
   // ReadResponseBody(), therefore user_buffer_ may be NULL.  This may often
   // happen for server initiated streams.
   DCHECK(!stream_->closed() || stream_->pushed());
-  if (length > 0) {
-    // Save the received data.
-    IOBufferWithSize* io_buffer = new IOBufferWithSize(length);
-    memcpy(io_buffer->data(), data, length);
-    response_body_.push_back(make_scoped_refptr(io_buffer));
+  if (buffer && buffer->size() > 0) {
+    // Save the received data. It is only copied into the caller's buffer.
+    response_body_.push_back(make_scoped_refptr(buffer));
 
     if (user_buffer_) {
       // Handing small chunks of data to the caller creates measurable overhead.
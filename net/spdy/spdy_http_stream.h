@@ -66,6 +66,8 @@ class NET_EXPORT_PRIVATE SpdyHttpStream : public SpdyStream::Delegate,
   virtual bool IsConnectionReused() const OVERRIDE;
   virtual void SetConnectionReused() OVERRIDE;
   virtual bool IsConnectionReusable() const OVERRIDE;
+  virtual bool GetLoadTimingInfo(
+      LoadTimingInfo* load_timing_info) const OVERRIDE;
   virtual void GetSSLInfo(SSLInfo* ssl_info) OVERRIDE;
   virtual void GetSSLCertRequestInfo(
       SSLCertRequestInfo* cert_request_info) OVERRIDE;
@@ -80,7 +82,7 @@ class NET_EXPORT_PRIVATE SpdyHttpStream : public SpdyStream::Delegate,
   virtual int OnResponseReceived(const SpdyHeaderBlock& response,
                                  base::Time response_time,
                                  int status) OVERRIDE;
-  virtual void OnDataReceived(const char* buffer, int bytes) OVERRIDE;
+  virtual void OnDataReceived(IOBufferWithSize* buffer) OVERRIDE;
   virtual void OnDataSent(int length) OVERRIDE;
   virtual void OnClose(int status) OVERRIDE;
   virtual void set_chunk_callback(ChunkCallback* callback) OVERRIDE;
@@ -95,6 +97,9 @@ class NET_EXPORT_PRIVATE SpdyHttpStream : public SpdyStream::Delegate,
   FRIEND_TEST_ALL_PREFIXES(SpdyNetworkTransactionSpdy3Test,
                            FlowControlNegativeSendWindowSize);
 
+  // Called when the request body stream finished reading a file.
+  void OnRequestBodyReadReady(int result);
+
   // Call the user callback.
   void DoCallback(int rv);
 
@@ -133,9 +138,10 @@ class NET_EXPORT_PRIVATE SpdyHttpStream : public SpdyStream::Delegate,
   scoped_refptr<IOBuffer> user_buffer_;
   int user_buffer_len_;
 
-  // Temporary buffer used to read the request body from UploadDataStream.
+  // Temporary buffer used to read a chunked request body from
+  // UploadDataStream. Non-chunked bodies are handed out by the stream.
   scoped_refptr<IOBufferWithSize> raw_request_body_buf_;
-  // Wraps raw_request_body_buf_ to read the remaining data progressively.
+  // Wraps the data read from UploadDataStream to send it progressively.
   scoped_refptr<DrainableIOBuffer> request_body_buf_;
 
   // Is there a scheduled read callback pending.
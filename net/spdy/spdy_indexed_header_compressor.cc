@@ -0,0 +1,411 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/spdy_indexed_header_compressor.h"
+
+#include <vector>
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/string_piece.h"
+#include "net/spdy/spdy_frame_reader.h"
+
+namespace net {
+
+namespace {
+
+// The first byte of each compressed header.
+const uint8 kIndexedHeader = 0x80;
+const int kIndexedHeaderPrefixBits = 7;
+const uint8 kIndexedName = 0x40;
+const int kIndexedNamePrefixBits = 6;
+const uint8 kLiteralHeader = 0x00;
+
+// Header counts and lengths use all the bits of their first byte.
+const int kLengthPrefixBits = 8;
+
+// Numbers larger than this are invalid. Header blocks are much smaller than
+// this anyway, since control frames are.
+const size_t kMaxNumber = 1 << 24;
+
+// The static part of the table, in SPDY/3 form. Headers that are mostly sent
+// with different values have an empty value, so that they can be sent with an
+// indexed name.
+const char* const kStaticHeaders[][2] = {
+  { ":method", "GET" },
+  { ":method", "POST" },
+  { ":scheme", "http" },
+  { ":scheme", "https" },
+  { ":version", "HTTP/1.1" },
+  { ":status", "200 OK" },
+  { ":status", "204 No Content" },
+  { ":status", "301 Moved Permanently" },
+  { ":status", "302 Found" },
+  { ":status", "304 Not Modified" },
+  { ":status", "404 Not Found" },
+  { ":path", "/" },
+  { ":host", "" },
+  { "accept", "*/*" },
+  { "accept-charset", "ISO-8859-1,utf-8;q=0.7,*;q=0.3" },
+  { "accept-encoding", "gzip,deflate,sdch" },
+  { "accept-language", "en-US,en;q=0.8" },
+  { "accept-ranges", "bytes" },
+  { "cache-control", "" },
+  { "content-encoding", "gzip" },
+  { "content-length", "" },
+  { "content-type", "" },
+  { "cookie", "" },
+  { "date", "" },
+  { "etag", "" },
+  { "expires", "" },
+  { "if-modified-since", "" },
+  { "if-none-match", "" },
+  { "last-modified", "" },
+  { "location", "" },
+  { "referer", "" },
+  { "server", "" },
+  { "set-cookie", "" },
+  { "user-agent", "" },
+  { "vary", "Accept-Encoding" },
+  { "x-content-type-options", "nosniff" },
+};
+
+typedef std::pair<std::string, std::string> Header;
+typedef base::hash_map<std::string, size_t> HeaderIndexMap;
+
+std::string GetHeaderKey(const Header& header) {
+  std::string key(header.first);
+  key.push_back('\0');
+  key.append(header.second);
+  return key;
+}
+
+// The static part of the table for one SPDY version, with the indexes of its
+// headers.
+struct StaticTable {
+  explicit StaticTable(int version) {
+    for (size_t i = 0; i < arraysize(kStaticHeaders); ++i) {
+      Header header(kStaticHeaders[i][0], kStaticHeaders[i][1]);
+      if (version < 3) {
+        // SPDY/2 names the special headers without a colon, and the path is
+        // the url.
+        if (header.first == ":path")
+          header.first = "url";
+        else if (header.first[0] == ':')
+          header.first.erase(0, 1);
+      }
+      headers.push_back(header);
+      header_indexes.insert(std::make_pair(GetHeaderKey(header), i));
+      name_indexes.insert(std::make_pair(header.first, i));
+    }
+  }
+
+  std::vector<Header> headers;
+  HeaderIndexMap header_indexes;
+  HeaderIndexMap name_indexes;
+};
+
+struct StaticTables {
+  StaticTables() : spdy2(2), spdy3(3) {}
+
+  const StaticTable& Get(int version) const {
+    return version < 3 ? spdy2 : spdy3;
+  }
+
+  const StaticTable spdy2;
+  const StaticTable spdy3;
+};
+
+base::LazyInstance<StaticTables>::Leaky g_static_tables =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Appends |value| to |output|, with the first byte made of |flags| and the
+// lower |prefix_bits| bits of the number.
+void AppendNumber(uint8 flags, int prefix_bits, size_t value,
+                  std::string* output) {
+  const size_t max_prefix = (1 << prefix_bits) - 1;
+  if (value < max_prefix) {
+    output->push_back(static_cast<char>(flags | value));
+    return;
+  }
+  output->push_back(static_cast<char>(flags | max_prefix));
+  value -= max_prefix;
+  while (value >= 0x80) {
+    output->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  output->push_back(static_cast<char>(value));
+}
+
+void AppendString(const base::StringPiece& value, std::string* output) {
+  AppendNumber(0, kLengthPrefixBits, value.size(), output);
+  value.AppendToString(output);
+}
+
+// Reads a number with |prefix_bits| bits in its first byte from |input|,
+// starting at |*pos|. Returns false if the input is truncated, or the number
+// is too large.
+bool ReadNumber(const std::string& input, int prefix_bits, size_t* pos,
+                size_t* value) {
+  if (*pos >= input.size())
+    return false;
+  const size_t max_prefix = (1 << prefix_bits) - 1;
+  *value = static_cast<uint8>(input[(*pos)++]) & max_prefix;
+  if (*value < max_prefix)
+    return true;
+
+  for (int shift = 0; ; shift += 7) {
+    if (*pos >= input.size())
+      return false;
+    uint8 byte = static_cast<uint8>(input[(*pos)++]);
+    *value += static_cast<size_t>(byte & 0x7f) << shift;
+    if (*value > kMaxNumber)
+      return false;
+    if (!(byte & 0x80))
+      return true;
+  }
+}
+
+bool ReadString(const std::string& input, size_t* pos, std::string* value) {
+  size_t length;
+  if (!ReadNumber(input, kLengthPrefixBits, pos, &length) ||
+      length > input.size() - *pos) {
+    return false;
+  }
+  value->assign(input, *pos, length);
+  *pos += length;
+  return true;
+}
+
+void AppendSerializedLength(int version, size_t length, std::string* output) {
+  if (version >= 3) {
+    output->push_back(static_cast<char>((length >> 24) & 0xff));
+    output->push_back(static_cast<char>((length >> 16) & 0xff));
+  }
+  output->push_back(static_cast<char>((length >> 8) & 0xff));
+  output->push_back(static_cast<char>(length & 0xff));
+}
+
+void AppendSerializedString(int version, const std::string& value,
+                            std::string* output) {
+  AppendSerializedLength(version, value.size(), output);
+  output->append(value);
+}
+
+}  // namespace
+
+const size_t SpdyIndexedHeaderCompressor::kMaxDynamicTableSize = 4096;
+const size_t SpdyIndexedHeaderCompressor::kHeaderOverhead = 32;
+
+SpdyIndexedHeaderCompressor::HeaderTable::HeaderTable(int version,
+                                                      bool index_headers)
+    : version_(version),
+      index_headers_(index_headers),
+      first_id_(0),
+      size_(0) {
+}
+
+SpdyIndexedHeaderCompressor::HeaderTable::~HeaderTable() {}
+
+const SpdyIndexedHeaderCompressor::Header*
+SpdyIndexedHeaderCompressor::HeaderTable::GetHeader(size_t index) const {
+  const StaticTable& static_table = g_static_tables.Get().Get(version_);
+  if (index < static_table.headers.size())
+    return &static_table.headers[index];
+  index -= static_table.headers.size();
+  if (index >= headers_.size())
+    return NULL;
+  return &headers_[headers_.size() - 1 - index];
+}
+
+bool SpdyIndexedHeaderCompressor::HeaderTable::FindHeader(
+    const Header& header, size_t* index) const {
+  DCHECK(index_headers_);
+  std::string key = GetHeaderKey(header);
+  HeaderIdMap::const_iterator it = header_ids_.find(key);
+  if (it != header_ids_.end()) {
+    *index = IdToIndex(it->second);
+    return true;
+  }
+  const StaticTable& static_table = g_static_tables.Get().Get(version_);
+  HeaderIndexMap::const_iterator static_it =
+      static_table.header_indexes.find(key);
+  if (static_it == static_table.header_indexes.end())
+    return false;
+  *index = static_it->second;
+  return true;
+}
+
+bool SpdyIndexedHeaderCompressor::HeaderTable::FindName(
+    const std::string& name, size_t* index) const {
+  DCHECK(index_headers_);
+  HeaderIdMap::const_iterator it = name_ids_.find(name);
+  if (it != name_ids_.end()) {
+    *index = IdToIndex(it->second);
+    return true;
+  }
+  const StaticTable& static_table = g_static_tables.Get().Get(version_);
+  HeaderIndexMap::const_iterator static_it =
+      static_table.name_indexes.find(name);
+  if (static_it == static_table.name_indexes.end())
+    return false;
+  *index = static_it->second;
+  return true;
+}
+
+void SpdyIndexedHeaderCompressor::HeaderTable::AddHeader(const Header& header) {
+  size_t header_size =
+      header.first.size() + header.second.size() + kHeaderOverhead;
+  // Headers that could not fit in an empty table are not added, and don't
+  // evict anything.
+  if (header_size > kMaxDynamicTableSize)
+    return;
+
+  while (size_ + header_size > kMaxDynamicTableSize) {
+    const Header& oldest = headers_.front();
+    if (index_headers_) {
+      HeaderIdMap::iterator it = header_ids_.find(GetHeaderKey(oldest));
+      if (it != header_ids_.end() && it->second == first_id_)
+        header_ids_.erase(it);
+      it = name_ids_.find(oldest.first);
+      if (it != name_ids_.end() && it->second == first_id_)
+        name_ids_.erase(it);
+    }
+    size_ -= oldest.first.size() + oldest.second.size() + kHeaderOverhead;
+    headers_.pop_front();
+    ++first_id_;
+  }
+
+  int64 id = first_id_ + headers_.size();
+  headers_.push_back(header);
+  size_ += header_size;
+  if (index_headers_) {
+    header_ids_[GetHeaderKey(header)] = id;
+    name_ids_[header.first] = id;
+  }
+}
+
+size_t SpdyIndexedHeaderCompressor::HeaderTable::IdToIndex(int64 id) const {
+  const StaticTable& static_table = g_static_tables.Get().Get(version_);
+  int64 newest_id = first_id_ + headers_.size() - 1;
+  DCHECK_LE(first_id_, id);
+  DCHECK_LE(id, newest_id);
+  return static_table.headers.size() + static_cast<size_t>(newest_id - id);
+}
+
+SpdyIndexedHeaderCompressor::SpdyIndexedHeaderCompressor(int version)
+    : version_(version),
+      compression_table_(version, true),
+      decompression_table_(version, false) {
+}
+
+SpdyIndexedHeaderCompressor::~SpdyIndexedHeaderCompressor() {}
+
+bool SpdyIndexedHeaderCompressor::CompressHeaderBlock(const char* data,
+                                                      size_t len,
+                                                      std::string* output) {
+  SpdyFrameReader reader(data, len);
+  uint32 num_headers;
+  if (version_ < 3) {
+    uint16 num_headers16;
+    if (!reader.ReadUInt16(&num_headers16))
+      return false;
+    num_headers = num_headers16;
+  } else if (!reader.ReadUInt32(&num_headers)) {
+    return false;
+  }
+
+  AppendNumber(0, kLengthPrefixBits, num_headers, output);
+  for (uint32 i = 0; i < num_headers; ++i) {
+    base::StringPiece name;
+    base::StringPiece value;
+    bool read = (version_ < 3) ?
+        reader.ReadStringPiece16(&name) && reader.ReadStringPiece16(&value) :
+        reader.ReadStringPiece32(&name) && reader.ReadStringPiece32(&value);
+    if (!read)
+      return false;
+
+    Header header(name.as_string(), value.as_string());
+    size_t index;
+    if (compression_table_.FindHeader(header, &index)) {
+      AppendNumber(kIndexedHeader, kIndexedHeaderPrefixBits, index, output);
+      continue;
+    }
+    if (compression_table_.FindName(header.first, &index)) {
+      AppendNumber(kIndexedName, kIndexedNamePrefixBits, index, output);
+    } else {
+      output->push_back(kLiteralHeader);
+      AppendString(header.first, output);
+    }
+    AppendString(header.second, output);
+    compression_table_.AddHeader(header);
+  }
+  return reader.IsDoneReading();
+}
+
+bool SpdyIndexedHeaderCompressor::DecompressHeaderBlock(const char* data,
+                                                        size_t len,
+                                                        bool end_of_block,
+                                                        std::string* output) {
+  pending_input_.append(data, len);
+  if (!end_of_block)
+    return true;
+
+  bool decoded = DecodeHeaderBlock(output);
+  pending_input_.clear();
+  return decoded;
+}
+
+bool SpdyIndexedHeaderCompressor::DecodeHeaderBlock(std::string* output) {
+  size_t pos = 0;
+  size_t num_headers;
+  // Each header takes at least one byte.
+  if (!ReadNumber(pending_input_, kLengthPrefixBits, &pos, &num_headers) ||
+      num_headers > pending_input_.size() - pos) {
+    return false;
+  }
+
+  AppendSerializedLength(version_, num_headers, output);
+  for (size_t i = 0; i < num_headers; ++i) {
+    if (pos >= pending_input_.size())
+      return false;
+    uint8 type = static_cast<uint8>(pending_input_[pos]);
+    size_t index;
+    Header header;
+    if (type & kIndexedHeader) {
+      if (!ReadNumber(pending_input_, kIndexedHeaderPrefixBits, &pos, &index))
+        return false;
+      const Header* indexed_header = decompression_table_.GetHeader(index);
+      if (!indexed_header)
+        return false;
+      AppendSerializedString(version_, indexed_header->first, output);
+      AppendSerializedString(version_, indexed_header->second, output);
+      continue;
+    }
+
+    if (type & kIndexedName) {
+      if (!ReadNumber(pending_input_, kIndexedNamePrefixBits, &pos, &index))
+        return false;
+      const Header* indexed_header = decompression_table_.GetHeader(index);
+      if (!indexed_header)
+        return false;
+      header.first = indexed_header->first;
+    } else if (type == kLiteralHeader) {
+      ++pos;
+      if (!ReadString(pending_input_, &pos, &header.first))
+        return false;
+    } else {
+      return false;
+    }
+    if (!ReadString(pending_input_, &pos, &header.second))
+      return false;
+
+    AppendSerializedString(version_, header.first, output);
+    AppendSerializedString(version_, header.second, output);
+    decompression_table_.AddHeader(header);
+  }
+  return pos == pending_input_.size();
+}
+
+}  // namespace net
@@ -0,0 +1,122 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_SPDY_SPDY_INDEXED_HEADER_COMPRESSOR_H_
+#define NET_SPDY_SPDY_INDEXED_HEADER_COMPRESSOR_H_
+#pragma once
+
+#include <deque>
+#include <string>
+#include <utility>
+
+#include "base/basictypes.h"
+#include "base/hash_tables.h"
+#include "net/base/net_export.h"
+#include "net/spdy/spdy_framer.h"
+
+namespace net {
+
+// Compresses header blocks by referring to the headers that were already sent
+// on the session, instead of running them through zlib.  Both ends keep a table
+// of headers: a static part with common headers, followed by the headers that
+// were sent as literals, newest first.  The table is limited to
+// kMaxDynamicTableSize bytes, and the oldest headers are evicted first.
+//
+// A compressed header block is the number of headers, followed by one entry
+// per header:
+//   1xxxxxxx                 The header at index x of the table.
+//   01xxxxxx value           The name at index x of the table, with a literal
+//                            value.
+//   00000000 name value      A literal name and value.
+// Literal headers are then added to the table.  Names and values are prefixed
+// with their length.  Numbers use as many 7-bit groups as needed after the
+// prefix bits, least significant group first, and the high bit of each byte
+// set when more groups follow.
+//
+// Only the protocol variant negotiated as kProtoSPDY3a1 uses this; the
+// encoding is experimental and may change.
+class NET_EXPORT_PRIVATE SpdyIndexedHeaderCompressor
+    : public SpdyHeaderCompressorInterface {
+ public:
+  // The maximum number of bytes of headers kept in the dynamic part of the
+  // table.  Each header counts for the length of its name and value, plus
+  // kHeaderOverhead.
+  static const size_t kMaxDynamicTableSize;
+  static const size_t kHeaderOverhead;
+
+  // |version| is the SPDY version of the serialized header blocks.
+  explicit SpdyIndexedHeaderCompressor(int version);
+  virtual ~SpdyIndexedHeaderCompressor();
+
+  // SpdyHeaderCompressorInterface implementation.
+  virtual bool CompressHeaderBlock(const char* data,
+                                   size_t len,
+                                   std::string* output) OVERRIDE;
+  virtual bool DecompressHeaderBlock(const char* data,
+                                     size_t len,
+                                     bool end_of_block,
+                                     std::string* output) OVERRIDE;
+
+ private:
+  typedef std::pair<std::string, std::string> Header;
+
+  // The headers that one direction of the session added to the table.
+  class HeaderTable {
+   public:
+    // |index_headers| tells whether the headers can be looked up by content,
+    // which only the compressing side needs to do.
+    HeaderTable(int version, bool index_headers);
+    ~HeaderTable();
+
+    // Returns the header at |index|, or NULL if there is none.
+    const Header* GetHeader(size_t index) const;
+
+    // Finds the index of |header|, or of a header with the same name.
+    // Returns false if there is no such header.
+    bool FindHeader(const Header& header, size_t* index) const;
+    bool FindName(const std::string& name, size_t* index) const;
+
+    // Adds a literal header, evicting the oldest ones to make room.
+    void AddHeader(const Header& header);
+
+   private:
+    typedef base::hash_map<std::string, int64> HeaderIdMap;
+
+    // Converts between the wire index of a dynamic header and the id it was
+    // given when it was added.
+    size_t IdToIndex(int64 id) const;
+
+    const int version_;
+    const bool index_headers_;
+
+    // Oldest first.  The header added with id |i| is at i - |first_id_|.
+    std::deque<Header> headers_;
+    int64 first_id_;
+    size_t size_;
+
+    // The newest header with a given name and value, or a given name.  Keys
+    // of |header_ids_| are the name and value separated by a NUL, which can't
+    // be part of a name.
+    HeaderIdMap header_ids_;
+    HeaderIdMap name_ids_;
+
+    DISALLOW_COPY_AND_ASSIGN(HeaderTable);
+  };
+
+  // Decodes the complete compressed header block in |pending_input_|.
+  bool DecodeHeaderBlock(std::string* output);
+
+  const int version_;
+  HeaderTable compression_table_;
+  HeaderTable decompression_table_;
+
+  // The compressed header block received so far.
+  std::string pending_input_;
+
+  DISALLOW_COPY_AND_ASSIGN(SpdyIndexedHeaderCompressor);
+};
+
+}  // namespace net
+
+#endif  // NET_SPDY_SPDY_INDEXED_HEADER_COMPRESSOR_H_
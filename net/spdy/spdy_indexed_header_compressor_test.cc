@@ -0,0 +1,182 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/spdy_indexed_header_compressor.h"
+
+#include <string>
+
+#include "base/string_number_conversions.h"
+#include "net/spdy/spdy_framer.h"
+#include "testing/platform_test.h"
+
+namespace net {
+
+namespace {
+
+class SpdyIndexedHeaderCompressorTest : public ::testing::TestWithParam<int> {
+ protected:
+  SpdyIndexedHeaderCompressorTest()
+      : framer_(GetParam()),
+        compressor_(GetParam()),
+        decompressor_(GetParam()) {
+  }
+
+  void AppendLength(size_t length, std::string* output) {
+    if (GetParam() >= 3) {
+      output->push_back(static_cast<char>((length >> 24) & 0xff));
+      output->push_back(static_cast<char>((length >> 16) & 0xff));
+    }
+    output->push_back(static_cast<char>((length >> 8) & 0xff));
+    output->push_back(static_cast<char>(length & 0xff));
+  }
+
+  std::string Serialize(const SpdyHeaderBlock& headers) {
+    std::string serialized;
+    AppendLength(headers.size(), &serialized);
+    for (SpdyHeaderBlock::const_iterator it = headers.begin();
+         it != headers.end(); ++it) {
+      AppendLength(it->first.size(), &serialized);
+      serialized.append(it->first);
+      AppendLength(it->second.size(), &serialized);
+      serialized.append(it->second);
+    }
+    return serialized;
+  }
+
+  // Compresses |headers| and checks that they decompress to the same headers.
+  // Returns the size of the compressed block.
+  size_t RoundTrip(const SpdyHeaderBlock& headers) {
+    std::string serialized = Serialize(headers);
+    std::string compressed;
+    EXPECT_TRUE(compressor_.CompressHeaderBlock(
+        serialized.data(), serialized.size(), &compressed));
+
+    // Feed the compressed block one byte at a time.
+    std::string decompressed;
+    for (size_t i = 0; i < compressed.size(); ++i) {
+      EXPECT_TRUE(decompressor_.DecompressHeaderBlock(
+          compressed.data() + i, 1, i + 1 == compressed.size(),
+          &decompressed));
+    }
+    EXPECT_EQ(serialized, decompressed);
+
+    SpdyHeaderBlock parsed;
+    EXPECT_TRUE(framer_.ParseHeaderBlockInBuffer(
+        decompressed.data(), decompressed.size(), &parsed));
+    EXPECT_TRUE(headers == parsed);
+    return compressed.size();
+  }
+
+  SpdyHeaderBlock RequestHeaders() {
+    SpdyHeaderBlock headers;
+    if (GetParam() < 3) {
+      headers["method"] = "GET";
+      headers["url"] = "/index.html";
+      headers["host"] = "www.example.com";
+      headers["scheme"] = "http";
+      headers["version"] = "HTTP/1.1";
+    } else {
+      headers[":method"] = "GET";
+      headers[":path"] = "/index.html";
+      headers[":host"] = "www.example.com";
+      headers[":scheme"] = "http";
+      headers[":version"] = "HTTP/1.1";
+    }
+    headers["accept"] = "*/*";
+    headers["accept-encoding"] = "gzip,deflate,sdch";
+    headers["user-agent"] = "Mozilla/5.0 (X11; Linux x86_64)";
+    headers["cookie"] = "id=0123456789abcdef";
+    return headers;
+  }
+
+  SpdyFramer framer_;
+  SpdyIndexedHeaderCompressor compressor_;
+  SpdyIndexedHeaderCompressor decompressor_;
+};
+
+INSTANTIATE_TEST_CASE_P(SpdyIndexedHeaderCompressorTests,
+                        SpdyIndexedHeaderCompressorTest,
+                        ::testing::Values(2, 3));
+
+TEST_P(SpdyIndexedHeaderCompressorTest, RoundTrip) {
+  SpdyHeaderBlock headers = RequestHeaders();
+  size_t first_size = RoundTrip(headers);
+  EXPECT_LT(first_size, Serialize(headers).size());
+
+  // The second time, every header is sent as an index.
+  EXPECT_EQ(1 + headers.size(), RoundTrip(headers));
+
+  headers["cookie"] = "id=fedcba9876543210";
+  headers["x-extra"] = "1";
+  size_t third_size = RoundTrip(headers);
+  EXPECT_GT(third_size, 1 + headers.size());
+  EXPECT_LT(third_size, first_size);
+}
+
+TEST_P(SpdyIndexedHeaderCompressorTest, EmptyValues) {
+  SpdyHeaderBlock headers;
+  headers["a"] = "";
+  headers["b"] = std::string(300, 'b');
+  RoundTrip(headers);
+  RoundTrip(headers);
+}
+
+TEST_P(SpdyIndexedHeaderCompressorTest, Eviction) {
+  // Fill the table many times over, so that large indexes and evictions are
+  // exercised.
+  for (int i = 0; i < 1000; ++i) {
+    SpdyHeaderBlock headers = RequestHeaders();
+    headers["x-counter"] = base::IntToString(i);
+    headers["x-previous"] = base::IntToString(i - 1);
+    headers["x-large"] = std::string(i % 10 * 100, 'x');
+    RoundTrip(headers);
+  }
+
+  // Headers that don't fit in the table are never indexed.
+  SpdyHeaderBlock headers;
+  headers["x-huge"] = std::string(
+      SpdyIndexedHeaderCompressor::kMaxDynamicTableSize, 'x');
+  size_t huge_size = RoundTrip(headers);
+  EXPECT_EQ(huge_size, RoundTrip(headers));
+}
+
+TEST_P(SpdyIndexedHeaderCompressorTest, InvalidInput) {
+  std::string output;
+  // Truncated serialized block.
+  EXPECT_FALSE(compressor_.CompressHeaderBlock("\0", 1, &output));
+
+  // Index past the end of the table.
+  const char kBadIndex[] = { 0x01, static_cast<char>(0xfe) };
+  output.clear();
+  EXPECT_FALSE(decompressor_.DecompressHeaderBlock(
+      kBadIndex, arraysize(kBadIndex), true, &output));
+
+  // Literal name longer than the block.
+  const char kBadLength[] = { 0x01, 0x00, 0x10, 'a' };
+  output.clear();
+  EXPECT_FALSE(decompressor_.DecompressHeaderBlock(
+      kBadLength, arraysize(kBadLength), true, &output));
+
+  // More headers than bytes.
+  const char kBadCount[] = { 0x7f, static_cast<char>(0x80) };
+  output.clear();
+  EXPECT_FALSE(decompressor_.DecompressHeaderBlock(
+      kBadCount, arraysize(kBadCount), true, &output));
+
+  // Trailing bytes.
+  const char kTrailing[] = { 0x01, static_cast<char>(0x80), 0x00 };
+  output.clear();
+  EXPECT_FALSE(decompressor_.DecompressHeaderBlock(
+      kTrailing, arraysize(kTrailing), true, &output));
+
+  // A failed block does not affect the next one.
+  const char kIndexed[] = { 0x01, static_cast<char>(0x80) };
+  output.clear();
+  EXPECT_TRUE(decompressor_.DecompressHeaderBlock(
+      kIndexed, arraysize(kIndexed), true, &output));
+}
+
+}  // namespace
+
+}  // namespace net
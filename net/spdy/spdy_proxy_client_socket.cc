@@ -481,13 +481,11 @@ int SpdyProxyClientSocket::OnResponseReceived(
 }
 
 // Called when data is received.
-void SpdyProxyClientSocket::OnDataReceived(const char* data, int length) {
-  if (length > 0) {
+void SpdyProxyClientSocket::OnDataReceived(IOBufferWithSize* buffer) {
+  if (buffer && buffer->size() > 0) {
     // Save the received data.
-    scoped_refptr<IOBuffer> io_buffer(new IOBuffer(length));
-    memcpy(io_buffer->data(), data, length);
     read_buffer_.push_back(
-        make_scoped_refptr(new DrainableIOBuffer(io_buffer, length)));
+        make_scoped_refptr(new DrainableIOBuffer(buffer, buffer->size())));
   }
 
   if (!read_callback_.is_null()) {
@@ -543,7 +541,7 @@ void SpdyProxyClientSocket::OnClose(int status)  {
     read_callback.Run(status);
   } else if (!read_callback_.is_null()) {
     // If we have a read_callback_, the we need to make sure we call it back.
-    OnDataReceived(NULL, 0);
+    OnDataReceived(NULL);
   }
   // This may have been deleted by read_callback_, so check first.
   if (weak_ptr && !write_callback.is_null())
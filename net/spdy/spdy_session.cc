@@ -32,6 +32,7 @@
 #include "net/http/http_server_properties.h"
 #include "net/spdy/spdy_frame_builder.h"
 #include "net/spdy/spdy_http_utils.h"
+#include "net/spdy/spdy_indexed_header_compressor.h"
 #include "net/spdy/spdy_protocol.h"
 #include "net/spdy/spdy_session_pool.h"
 #include "net/spdy/spdy_stream.h"
@@ -446,11 +447,15 @@ net::Error SpdySession::InitializeWithSocket(
   }
 
   DCHECK(protocol >= kProtoSPDY2);
-  DCHECK(protocol <= kProtoSPDY3);
-  int version = (protocol == kProtoSPDY3) ? 3 : 2;
+  DCHECK(protocol <= kProtoSPDY3a1);
+  int version = (protocol >= kProtoSPDY3) ? 3 : 2;
   flow_control_ = (protocol >= kProtoSPDY3);
 
   buffered_spdy_framer_.reset(new BufferedSpdyFramer(version));
+  if (protocol == kProtoSPDY3a1) {
+    buffered_spdy_framer_->set_header_compressor(
+        new SpdyIndexedHeaderCompressor(version));
+  }
   buffered_spdy_framer_->set_visitor(this);
   SendSettings();
 
@@ -968,6 +973,11 @@ net::Error SpdySession::ReadSocket() {
 
   CHECK(connection_.get());
   CHECK(connection_->socket());
+
+  // Streams may still refer to data of the previous read.
+  if (!read_buffer_->HasOneRef())
+    read_buffer_ = new IOBuffer(kReadBufferSize);
+
   int bytes_read = connection_->socket()->Read(
       read_buffer_.get(),
       kReadBufferSize,
@@ -1025,15 +1035,24 @@ void SpdySession::WriteSocket() {
   // Loop sending frames until we've sent everything or until the write
   // returns error (or ERR_IO_PENDING).
   DCHECK(buffered_spdy_framer_.get());
-  while (in_flight_write_.buffer() || !queue_.empty()) {
+  while (in_flight_write_.buffer() || !write_queue_.IsEmpty()) {
     if (!in_flight_write_.buffer()) {
       // Grab the next SpdyFrame to send.
-      SpdyIOBuffer next_buffer = queue_.top();
-      queue_.pop();
+      SpdyIOBuffer next_buffer;
+      write_queue_.Dequeue(&next_buffer);
 
       // We've deferred compression until just before we write it to the socket,
       // which is now.  At this time, we don't compress our data frames.
       SpdyFrame uncompressed_frame(next_buffer.buffer()->data(), false);
+      // Note the streams without a body that start while other streams are
+      // still sending theirs.
+      if (uncompressed_frame.is_control_frame() &&
+          reinterpret_cast<const SpdyControlFrame&>(
+              uncompressed_frame).type() == SYN_STREAM &&
+          next_buffer.stream() && !next_buffer.stream()->has_upload_data() &&
+          write_queue_.num_data_frames() > 0) {
+        next_buffer.stream()->set_competing_with_upload(true);
+      }
       size_t size;
       if (buffered_spdy_framer_->IsCompressible(uncompressed_frame)) {
         DCHECK(uncompressed_frame.is_control_frame());
@@ -1117,8 +1136,7 @@ void SpdySession::CloseAllStreams(net::Error status) {
   }
 
   // We also need to drain the queue.
-  while (queue_.size())
-    queue_.pop();
+  write_queue_.Clear();
 }
 
 int SpdySession::GetNewStreamId() {
@@ -1135,7 +1153,7 @@ void SpdySession::QueueFrame(SpdyFrame* frame,
   int length = SpdyFrame::kHeaderSize + frame->length();
   IOBuffer* buffer = new IOBuffer(length);
   memcpy(buffer->data(), frame->data(), length);
-  queue_.push(SpdyIOBuffer(buffer, length, priority, stream));
+  write_queue_.Enqueue(SpdyIOBuffer(buffer, length, priority, stream));
 
   WriteSocketLater();
 }
@@ -1303,6 +1321,13 @@ bool SpdySession::GetSSLInfo(SSLInfo* ssl_info,
   return true;
 }
 
+bool SpdySession::GetLoadTimingInfo(SpdyStreamId stream_id,
+                                    LoadTimingInfo* load_timing_info) const {
+  // Stream ids start at 1 on a new session.
+  bool is_reused = stream_id != 1 || connection_->is_reused();
+  return connection_->GetLoadTimingInfo(is_reused, load_timing_info);
+}
+
 bool SpdySession::GetSSLCertRequestInfo(
     SSLCertRequestInfo* cert_request_info) {
   if (!is_secure_)
@@ -1352,8 +1377,22 @@ void SpdySession::OnStreamFrameData(SpdyStreamId stream_id,
     return;
   }
 
+  // The framer hands out DATA payloads in place, so they can be given to the
+  // stream as a slice of |read_buffer_| instead of being copied.
+  scoped_refptr<IOBufferWithSize> buffer;
+  if (len > 0) {
+    const char* read_buffer_start = read_buffer_->data();
+    if (data >= read_buffer_start &&
+        data + len <= read_buffer_start + kReadBufferSize) {
+      buffer = new IOBufferSlice(read_buffer_, data - read_buffer_start, len);
+    } else {
+      buffer = new IOBufferWithSize(len);
+      memcpy(buffer->data(), data, len);
+    }
+  }
+
   scoped_refptr<SpdyStream> stream = active_streams_[stream_id];
-  stream->OnDataReceived(data, len);
+  stream->OnDataReceived(buffer);
 }
 
 void SpdySession::OnSetting(SpdySettingsIds id,
@@ -1576,7 +1615,7 @@ void SpdySession::OnRstStream(const SpdyRstStreamControlFrame& frame) {
   CHECK(!stream->cancelled());
 
   if (frame.status() == 0) {
-    stream->OnDataReceived(NULL, 0);
+    stream->OnDataReceived(NULL);
   } else if (frame.status() == REFUSED_STREAM) {
     DeleteStream(stream_id, ERR_SPDY_SERVER_REFUSED_STREAM);
   } else {
@@ -31,6 +31,7 @@
 #include "net/spdy/spdy_io_buffer.h"
 #include "net/spdy/spdy_protocol.h"
 #include "net/spdy/spdy_session_pool.h"
+#include "net/spdy/spdy_write_queue.h"
 
 namespace base {
 class Value;
@@ -202,6 +203,12 @@ class NET_EXPORT SpdySession : public base::RefCounted<SpdySession>,
                   bool* was_npn_negotiated,
                   NextProto* protocol_negotiated);
 
+  // Fills in the socket reuse and connect times of |load_timing_info| for the
+  // stream |stream_id|.  Only the first stream of a new session gets the
+  // connect times.  Returns false if the session has no socket.
+  bool GetLoadTimingInfo(SpdyStreamId stream_id,
+                         LoadTimingInfo* load_timing_info) const;
+
   // Fills SSL Certificate Request info |cert_request_info| and returns
   // true when SSL is in use.
   bool GetSSLCertRequestInfo(SSLCertRequestInfo* cert_request_info);
@@ -354,7 +361,6 @@ class NET_EXPORT SpdySession : public base::RefCounted<SpdySession>,
   typedef std::map<int, scoped_refptr<SpdyStream> > ActiveStreamMap;
   // Only HTTP push a stream.
   typedef std::map<std::string, scoped_refptr<SpdyStream> > PushedStreamMap;
-  typedef std::priority_queue<SpdyIOBuffer> OutputQueue;
 
   struct CallbackResultPair {
     CallbackResultPair(const CompletionCallback& callback_in, int result_in)
@@ -550,7 +556,9 @@ class NET_EXPORT SpdySession : public base::RefCounted<SpdySession>,
   // The socket handle for this session.
   scoped_ptr<ClientSocketHandle> connection_;
 
-  // The read buffer used to read data from the socket.
+  // The read buffer used to read data from the socket.  Streams keep slices
+  // of it for the DATA payloads they have not consumed yet, in which case the
+  // next read uses a new buffer.
   scoped_refptr<IOBuffer> read_buffer_;
   bool read_pending_;
 
@@ -573,8 +581,8 @@ class NET_EXPORT SpdySession : public base::RefCounted<SpdySession>,
   // server, but do not have consumers yet.
   PushedStreamMap unclaimed_pushed_streams_;
 
-  // As we gather data to be sent, we put it into the output queue.
-  OutputQueue queue_;
+  // As we gather data to be sent, we put it into the write queue.
+  SpdyWriteQueue write_queue_;
 
   // The packet we are currently sending.
   bool write_pending_;            // Will be true when a write is in progress.
@@ -93,6 +93,7 @@ SpdyStream::SpdyStream(SpdySession* session,
       response_status_(OK),
       cancelled_(false),
       has_upload_data_(false),
+      competing_with_upload_(false),
       net_log_(net_log),
       send_bytes_(0),
       recv_bytes_(0),
@@ -139,9 +140,9 @@ void SpdyStream::PushedStreamReplayData() {
     if (!delegate_)
       break;
     if (buffers[i]) {
-      delegate_->OnDataReceived(buffers[i]->data(), buffers[i]->size());
+      delegate_->OnDataReceived(buffers[i]);
     } else {
-      delegate_->OnDataReceived(NULL, 0);
+      delegate_->OnDataReceived(NULL);
       session_->CloseStream(stream_id_, net::OK);
       // Note: |this| may be deleted after calling CloseStream.
       DCHECK_EQ(buffers.size() - 1, i);
@@ -390,8 +391,8 @@ int SpdyStream::OnHeaders(const SpdyHeaderBlock& headers) {
   return rv;
 }
 
-void SpdyStream::OnDataReceived(const char* data, int length) {
-  DCHECK_GE(length, 0);
+void SpdyStream::OnDataReceived(IOBufferWithSize* buffer) {
+  int length = buffer ? buffer->size() : 0;
 
   // If we don't have a response, then the SYN_REPLY did not come through.
   // We cannot pass data up to the caller unless the reply headers have been
@@ -406,9 +407,7 @@ void SpdyStream::OnDataReceived(const char* data, int length) {
     // It should be valid for this to happen in the server push case.
     // We'll return received data when delegate gets attached to the stream.
     if (length > 0) {
-      IOBufferWithSize* buf = new IOBufferWithSize(length);
-      memcpy(buf->data(), data, length);
-      pending_buffers_.push_back(make_scoped_refptr(buf));
+      pending_buffers_.push_back(make_scoped_refptr(buffer));
     } else {
       pending_buffers_.push_back(NULL);
       metrics_.StopStream();
@@ -438,13 +437,11 @@ void SpdyStream::OnDataReceived(const char* data, int length) {
   if (!delegate_) {
     // It should be valid for this to happen in the server push case.
     // We'll return received data when delegate gets attached to the stream.
-    IOBufferWithSize* buf = new IOBufferWithSize(length);
-    memcpy(buf->data(), data, length);
-    pending_buffers_.push_back(make_scoped_refptr(buf));
+    pending_buffers_.push_back(make_scoped_refptr(buffer));
     return;
   }
 
-  delegate_->OnDataReceived(data, length);
+  delegate_->OnDataReceived(buffer);
 }
 
 // This function is only called when an entire frame is written.
@@ -765,6 +762,10 @@ void SpdyStream::UpdateHistograms() {
 
   UMA_HISTOGRAM_TIMES("Net.SpdyStreamTimeToFirstByte",
       recv_first_byte_time_ - send_time_);
+  if (competing_with_upload_) {
+    UMA_HISTOGRAM_TIMES("Net.SpdyStreamTimeToFirstByteWithUpload",
+        recv_first_byte_time_ - send_time_);
+  }
   UMA_HISTOGRAM_TIMES("Net.SpdyStreamDownloadTime",
       recv_last_byte_time_ - recv_first_byte_time_);
   UMA_HISTOGRAM_TIMES("Net.SpdyStreamTime",
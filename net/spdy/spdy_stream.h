@@ -74,8 +74,10 @@ class NET_EXPORT_PRIVATE SpdyStream
                                    base::Time response_time,
                                    int status) = 0;
 
-    // Called when data is received.
-    virtual void OnDataReceived(const char* data, int length) = 0;
+    // Called when data is received. |buffer| is NULL at the end of the
+    // stream. Delegates may keep a reference to |buffer| instead of copying
+    // it; its contents are not modified afterwards.
+    virtual void OnDataReceived(IOBufferWithSize* buffer) = 0;
 
     // Called when data is sent.
     virtual void OnDataSent(int length) = 0;
@@ -193,11 +195,9 @@ class NET_EXPORT_PRIVATE SpdyStream
   // Called by the SpdySession when response data has been received for this
   // stream.  This callback may be called multiple times as data arrives
   // from the network, and will never be called prior to OnResponseReceived.
-  // |buffer| contains the data received.  The stream must copy any data
-  //          from this buffer before returning from this callback.
-  // |length| is the number of bytes received or an error.
-  //         A zero-length count does not indicate end-of-stream.
-  void OnDataReceived(const char* buffer, int bytes);
+  // |buffer| contains the data received, or is NULL at the end of the
+  //          stream.  It is handed to the delegate without being copied.
+  void OnDataReceived(IOBufferWithSize* buffer);
 
   // Called by the SpdySession when a write has completed.  This callback
   // will be called multiple times for each write which completes.  Writes
@@ -219,6 +219,13 @@ class NET_EXPORT_PRIVATE SpdyStream
   void Close();
   bool cancelled() const { return cancelled_; }
   bool closed() const { return io_state_ == STATE_DONE; }
+  bool has_upload_data() const { return has_upload_data_; }
+
+  // Set by the session when the SYN_STREAM of this stream is sent while
+  // other streams have DATA frames waiting to be sent.
+  void set_competing_with_upload(bool competing) {
+    competing_with_upload_ = competing;
+  }
   // TODO(satorux): This is only for testing. We should be able to remove
   // this once crbug.com/113107 is addressed.
   bool body_sent() const { return io_state_ > STATE_SEND_BODY_COMPLETE; }
@@ -352,6 +359,7 @@ class NET_EXPORT_PRIVATE SpdyStream
 
   bool cancelled_;
   bool has_upload_data_;
+  bool competing_with_upload_;
 
   BoundNetLog net_log_;
 
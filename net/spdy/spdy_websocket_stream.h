@@ -75,7 +75,7 @@ class NET_EXPORT_PRIVATE SpdyWebSocketStream
   virtual int OnResponseReceived(const SpdyHeaderBlock& response,
                                  base::Time response_time,
                                  int status) OVERRIDE;
-  virtual void OnDataReceived(const char* data, int length) OVERRIDE;
+  virtual void OnDataReceived(IOBufferWithSize* buffer) OVERRIDE;
   virtual void OnDataSent(int length) OVERRIDE;
   virtual void OnClose(int status) OVERRIDE;
   virtual void set_chunk_callback(ChunkCallback* callback) OVERRIDE;
@@ -0,0 +1,101 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/spdy_write_queue.h"
+
+#include "base/logging.h"
+#include "net/spdy/spdy_protocol.h"
+#include "net/spdy/spdy_stream.h"
+
+namespace net {
+
+namespace {
+
+bool IsDataFrame(const SpdyIOBuffer& buffer) {
+  SpdyFrame frame(buffer.buffer()->data(), false);
+  return !frame.is_control_frame();
+}
+
+}  // namespace
+
+SpdyWriteQueue::PriorityQueue::PriorityQueue() {}
+
+SpdyWriteQueue::PriorityQueue::~PriorityQueue() {}
+
+SpdyWriteQueue::SpdyWriteQueue() : num_frames_(0), num_data_frames_(0) {}
+
+SpdyWriteQueue::~SpdyWriteQueue() {}
+
+void SpdyWriteQueue::Enqueue(const SpdyIOBuffer& buffer) {
+  DCHECK(buffer.buffer());
+  DCHECK_GE(buffer.priority(), MINIMUM_PRIORITY);
+  DCHECK_LT(buffer.priority(), NUM_PRIORITIES);
+  PriorityQueue& queue = queues_[buffer.priority()];
+  SpdyStream* stream = buffer.stream().get();
+  if (!stream) {
+    queue.session_frames.push_back(buffer);
+  } else {
+    FrameQueue& frames = queue.stream_frames[stream];
+    if (frames.empty())
+      queue.ready_streams.push_back(stream);
+    frames.push_back(buffer);
+  }
+
+  ++num_frames_;
+  if (IsDataFrame(buffer))
+    ++num_data_frames_;
+}
+
+bool SpdyWriteQueue::Dequeue(SpdyIOBuffer* buffer) {
+  for (int priority = NUM_PRIORITIES - 1; priority >= MINIMUM_PRIORITY;
+       --priority) {
+    PriorityQueue& queue = queues_[priority];
+    std::map<SpdyStream*, FrameQueue>::iterator it = queue.stream_frames.end();
+    if (!queue.ready_streams.empty()) {
+      it = queue.stream_frames.find(queue.ready_streams.front());
+      DCHECK(it != queue.stream_frames.end());
+    }
+
+    // SpdyIOBuffers of the same priority compare by age, the newest being
+    // the smallest.
+    if (!queue.session_frames.empty() &&
+        (it == queue.stream_frames.end() ||
+         it->second.front() < queue.session_frames.front())) {
+      *buffer = queue.session_frames.front();
+      queue.session_frames.pop_front();
+    } else if (it != queue.stream_frames.end()) {
+      SpdyStream* stream = it->first;
+      queue.ready_streams.pop_front();
+      *buffer = it->second.front();
+      it->second.pop_front();
+      // The stream goes to the end of the line if it has more to write.
+      if (it->second.empty())
+        queue.stream_frames.erase(it);
+      else
+        queue.ready_streams.push_back(stream);
+    } else {
+      continue;
+    }
+
+    --num_frames_;
+    if (IsDataFrame(*buffer))
+      --num_data_frames_;
+    return true;
+  }
+  DCHECK_EQ(0u, num_frames_);
+  return false;
+}
+
+void SpdyWriteQueue::Clear() {
+  for (int priority = MINIMUM_PRIORITY; priority < NUM_PRIORITIES; ++priority) {
+    PriorityQueue& queue = queues_[priority];
+    queue.session_frames.clear();
+    queue.ready_streams.clear();
+    queue.stream_frames.clear();
+  }
+  num_frames_ = 0;
+  num_data_frames_ = 0;
+}
+
+}  // namespace net
@@ -0,0 +1,76 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_SPDY_SPDY_WRITE_QUEUE_H_
+#define NET_SPDY_SPDY_WRITE_QUEUE_H_
+#pragma once
+
+#include <deque>
+#include <map>
+
+#include "base/basictypes.h"
+#include "net/base/net_export.h"
+#include "net/base/request_priority.h"
+#include "net/spdy/spdy_io_buffer.h"
+
+namespace net {
+
+class SpdyStream;
+
+// Orders the frames that a SpdySession writes to its socket.  Frames are
+// written by decreasing priority.  Within a priority, the streams take turns
+// writing one frame each, and the frames that don't belong to a stream are
+// written as soon as they are older than the next frame of the stream whose
+// turn it is.  The frames of a stream are always written in order.
+//
+// DATA frames are at most kMaxSpdyFrameChunkSize bytes, so a stream with a
+// large body can't delay the other streams of its priority by more than one
+// frame each.  The send window of a stream is already taken into account when
+// its DATA frames are queued, so every queued frame can be written.
+class NET_EXPORT_PRIVATE SpdyWriteQueue {
+ public:
+  SpdyWriteQueue();
+  ~SpdyWriteQueue();
+
+  bool IsEmpty() const { return num_frames_ == 0; }
+
+  // The number of queued DATA frames.
+  size_t num_data_frames() const { return num_data_frames_; }
+
+  // Queues |buffer|, at its priority, after the frames already queued for its
+  // stream.
+  void Enqueue(const SpdyIOBuffer& buffer);
+
+  // Removes the next frame to write and stores it in |buffer|.  Returns false
+  // if the queue is empty.
+  bool Dequeue(SpdyIOBuffer* buffer);
+
+  // Drops all the queued frames.
+  void Clear();
+
+ private:
+  typedef std::deque<SpdyIOBuffer> FrameQueue;
+
+  struct PriorityQueue {
+    PriorityQueue();
+    ~PriorityQueue();
+
+    // The frames that don't belong to a stream, oldest first.
+    FrameQueue session_frames;
+    // The streams that have frames to write, in the order in which they take
+    // turns.
+    std::deque<SpdyStream*> ready_streams;
+    std::map<SpdyStream*, FrameQueue> stream_frames;
+  };
+
+  PriorityQueue queues_[NUM_PRIORITIES];
+  size_t num_frames_;
+  size_t num_data_frames_;
+
+  DISALLOW_COPY_AND_ASSIGN(SpdyWriteQueue);
+};
+
+}  // namespace net
+
+#endif  // NET_SPDY_SPDY_WRITE_QUEUE_H_
@@ -0,0 +1,153 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/spdy_write_queue.h"
+
+#include <cstring>
+
+#include "base/memory/scoped_ptr.h"
+#include "net/base/net_log.h"
+#include "net/spdy/spdy_framer.h"
+#include "net/spdy/spdy_stream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+class SpdyWriteQueueTest : public testing::Test {
+ protected:
+  SpdyWriteQueueTest() : framer_(3) {}
+
+  SpdyIOBuffer MakeBuffer(SpdyFrame* frame, RequestPriority priority,
+                          SpdyStream* stream) {
+    scoped_ptr<SpdyFrame> owned_frame(frame);
+    int length = SpdyFrame::kHeaderSize + frame->length();
+    IOBuffer* buffer = new IOBuffer(length);
+    memcpy(buffer->data(), frame->data(), length);
+    return SpdyIOBuffer(buffer, length, priority, stream);
+  }
+
+  // Queues a DATA frame for |stream|, with |id| as its only byte.
+  void EnqueueData(SpdyStream* stream, RequestPriority priority, char id) {
+    queue_.Enqueue(MakeBuffer(
+        framer_.CreateDataFrame(stream->stream_id(), &id, 1, DATA_FLAG_NONE),
+        priority, stream));
+  }
+
+  // Queues a PING frame that doesn't belong to a stream.
+  void EnqueuePing(RequestPriority priority, uint32 id) {
+    queue_.Enqueue(MakeBuffer(framer_.CreatePingFrame(id), priority, NULL));
+  }
+
+  // Dequeues the next frame, and returns its DATA byte, or 'P' followed by the
+  // id of a PING frame.
+  std::string DequeueOne() {
+    SpdyIOBuffer buffer;
+    if (!queue_.Dequeue(&buffer))
+      return "none";
+    SpdyFrame frame(buffer.buffer()->data(), false);
+    if (frame.is_control_frame()) {
+      SpdyPingControlFrame ping(buffer.buffer()->data(), false);
+      return "P" + std::string(1, '0' + ping.unique_id());
+    }
+    return std::string(buffer.buffer()->data() + SpdyFrame::kHeaderSize, 1);
+  }
+
+  scoped_refptr<SpdyStream> CreateStream(SpdyStreamId id) {
+    return new SpdyStream(NULL, id, false, BoundNetLog());
+  }
+
+  SpdyFramer framer_;
+  SpdyWriteQueue queue_;
+};
+
+TEST_F(SpdyWriteQueueTest, Empty) {
+  EXPECT_TRUE(queue_.IsEmpty());
+  EXPECT_EQ("none", DequeueOne());
+}
+
+TEST_F(SpdyWriteQueueTest, RoundRobinWithinPriority) {
+  scoped_refptr<SpdyStream> upload = CreateStream(1);
+  scoped_refptr<SpdyStream> small = CreateStream(3);
+  for (char c = 'a'; c <= 'd'; ++c)
+    EnqueueData(upload, MEDIUM, c);
+  EnqueueData(small, MEDIUM, 'x');
+  EnqueueData(small, MEDIUM, 'y');
+  EXPECT_EQ(6u, queue_.num_data_frames());
+
+  // The small stream doesn't wait for the whole upload.
+  EXPECT_EQ("a", DequeueOne());
+  EXPECT_EQ("x", DequeueOne());
+  EXPECT_EQ("b", DequeueOne());
+  EXPECT_EQ("y", DequeueOne());
+  EXPECT_EQ("c", DequeueOne());
+  EXPECT_EQ("d", DequeueOne());
+  EXPECT_TRUE(queue_.IsEmpty());
+  EXPECT_EQ(0u, queue_.num_data_frames());
+}
+
+TEST_F(SpdyWriteQueueTest, Priorities) {
+  scoped_refptr<SpdyStream> low = CreateStream(1);
+  scoped_refptr<SpdyStream> high = CreateStream(3);
+  EnqueueData(low, LOW, 'l');
+  EnqueuePing(LOW, 1);
+  EnqueuePing(HIGHEST, 2);
+  EnqueueData(high, HIGHEST, 'h');
+
+  EXPECT_EQ("P2", DequeueOne());
+  EXPECT_EQ("h", DequeueOne());
+  EXPECT_EQ("l", DequeueOne());
+  EXPECT_EQ("P1", DequeueOne());
+  EXPECT_EQ("none", DequeueOne());
+}
+
+TEST_F(SpdyWriteQueueTest, SessionFramesKeepTheirPlace) {
+  scoped_refptr<SpdyStream> stream1 = CreateStream(1);
+  scoped_refptr<SpdyStream> stream3 = CreateStream(3);
+  EnqueueData(stream1, MEDIUM, 'a');
+  EnqueueData(stream1, MEDIUM, 'b');
+  EnqueuePing(MEDIUM, 1);
+  EnqueueData(stream3, MEDIUM, 'c');
+
+  // The PING is written once the streams get to frames queued after it.
+  EXPECT_EQ("a", DequeueOne());
+  EXPECT_EQ("P1", DequeueOne());
+  EXPECT_EQ("c", DequeueOne());
+  EXPECT_EQ("b", DequeueOne());
+}
+
+TEST_F(SpdyWriteQueueTest, StreamRejoinsAtTheEnd) {
+  scoped_refptr<SpdyStream> stream1 = CreateStream(1);
+  scoped_refptr<SpdyStream> stream3 = CreateStream(3);
+  scoped_refptr<SpdyStream> stream5 = CreateStream(5);
+  EnqueueData(stream1, LOWEST, 'a');
+  EnqueueData(stream3, LOWEST, 'b');
+  EXPECT_EQ("a", DequeueOne());
+
+  // Stream 1 had nothing left to write, so it goes after stream 5.
+  EnqueueData(stream5, LOWEST, 'c');
+  EnqueueData(stream1, LOWEST, 'd');
+  EXPECT_EQ("b", DequeueOne());
+  EXPECT_EQ("c", DequeueOne());
+  EXPECT_EQ("d", DequeueOne());
+}
+
+TEST_F(SpdyWriteQueueTest, Clear) {
+  scoped_refptr<SpdyStream> stream = CreateStream(1);
+  EnqueueData(stream, LOWEST, 'a');
+  EnqueuePing(HIGHEST, 1);
+  queue_.Clear();
+  EXPECT_TRUE(queue_.IsEmpty());
+  EXPECT_EQ(0u, queue_.num_data_frames());
+  EXPECT_EQ("none", DequeueOne());
+
+  // The queue is usable after being cleared.
+  EnqueueData(stream, LOWEST, 'b');
+  EXPECT_EQ("b", DequeueOne());
+}
+
+}  // namespace
+
+}  // namespace net
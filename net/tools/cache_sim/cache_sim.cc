@@ -0,0 +1,214 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This command-line program replays a trace of cache requests against each one
+// of the eviction algorithms of the disk cache, and reports the hit ratios that
+// they get. Every line of the trace is a request for a resource, made of the
+// key of the resource and its size in bytes, separated by a space. A request
+// for a key that is not stored by the cache stores it. Empty lines and lines
+// starting with '#' are ignored.
+//
+// Usage: cache_sim --trace=<file> [--max-size=<bytes>]
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/scoped_temp_dir.h"
+#include "base/string_number_conversions.h"
+#include "base/string_split.h"
+#include "base/string_util.h"
+#include "base/threading/thread.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "net/disk_cache/backend_impl.h"
+#include "net/disk_cache/disk_cache.h"
+
+namespace {
+
+enum Errors {
+  GENERIC = -1,
+  ALL_GOOD = 0,
+  INVALID_ARGUMENT = 1,
+  INVALID_TRACE
+};
+
+const char kTrace[] = "trace";
+const char kMaxSize[] = "max-size";
+const int kDefaultMaxSize = 20 * 1024 * 1024;
+
+enum Policy {
+  LRU_EVICTION,
+  NEW_EVICTION,
+  SIZE_AWARE_EVICTION,
+  NUM_POLICIES
+};
+
+const char* const kPolicyNames[] = {
+  "lru",
+  "new",
+  "size-aware"
+};
+
+struct Request {
+  std::string key;
+  int size;
+};
+
+struct Result {
+  Result() : hits(0), misses(0), hit_bytes(0), miss_bytes(0) {}
+
+  int hits;
+  int misses;
+  int64 hit_bytes;
+  int64 miss_bytes;
+};
+
+// Reads the requests stored on the file at |path|.
+bool LoadTrace(const FilePath& path, std::vector<Request>* requests) {
+  std::string contents;
+  if (!file_util::ReadFileToString(path, &contents))
+    return false;
+
+  std::vector<std::string> lines;
+  base::SplitString(contents, '\n', &lines);
+  for (size_t i = 0; i < lines.size(); i++) {
+    if (lines[i].empty() || lines[i][0] == '#')
+      continue;
+
+    std::vector<std::string> tokens;
+    base::SplitString(lines[i], ' ', &tokens);
+    Request request;
+    if (tokens.size() != 2 || tokens[0].empty() ||
+        !base::StringToInt(tokens[1], &request.size) || request.size < 0) {
+      printf("Invalid request on line %d\n", static_cast<int>(i + 1));
+      return false;
+    }
+    request.key = tokens[0];
+    requests->push_back(request);
+  }
+  return true;
+}
+
+// Runs all the |requests| through an empty cache that uses the given eviction
+// |policy|.
+bool ReplayTrace(Policy policy, const std::vector<Request>& requests,
+                 int max_size, base::Thread* cache_thread, Result* result) {
+  ScopedTempDir temp_dir;
+  if (!temp_dir.CreateUniqueTempDir())
+    return false;
+
+  scoped_ptr<disk_cache::BackendImpl> cache(new disk_cache::BackendImpl(
+      temp_dir.path(), cache_thread->message_loop_proxy(), NULL));
+  if (!cache->SetMaxSize(max_size))
+    return false;
+
+  // The trace is replayed as fast as possible, so the cache should not wait
+  // for a quiet time to evict entries.
+  cache->SetFlags(disk_cache::kNoRandom | disk_cache::kNoLoadProtection);
+  if (policy == NEW_EVICTION)
+    cache->SetNewEviction();
+  else if (policy == SIZE_AWARE_EVICTION)
+    cache->SetSizeAwareEviction();
+
+  net::TestCompletionCallback cb;
+  int rv = cache->Init(cb.callback());
+  if (cb.GetResult(rv) != net::OK)
+    return false;
+
+  for (size_t i = 0; i < requests.size(); i++) {
+    const Request& request = requests[i];
+    disk_cache::Entry* entry;
+    rv = cache->OpenEntry(request.key, &entry, cb.callback());
+    if (cb.GetResult(rv) == net::OK) {
+      result->hits++;
+      result->hit_bytes += request.size;
+      entry->Close();
+      continue;
+    }
+
+    result->misses++;
+    result->miss_bytes += request.size;
+    rv = cache->CreateEntry(request.key, &entry, cb.callback());
+    if (cb.GetResult(rv) != net::OK)
+      continue;
+
+    if (request.size) {
+      // Resources that are too big for the cache are just not stored.
+      scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(request.size));
+      memset(buffer->data(), 0, request.size);
+      rv = entry->WriteData(1, 0, buffer, request.size, cb.callback(), false);
+      cb.GetResult(rv);
+    }
+    entry->Close();
+  }
+  return true;
+}
+
+void PrintResult(Policy policy, const Result& result) {
+  int requests = result.hits + result.misses;
+  int64 bytes = result.hit_bytes + result.miss_bytes;
+  printf("%-12s hits: %d of %d (%.2f%%), hit bytes: %.2f%%\n",
+         kPolicyNames[policy], result.hits, requests,
+         requests ? result.hits * 100.0 / requests : 0.0,
+         bytes ? result.hit_bytes * 100.0 / bytes : 0.0);
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+  COMPILE_ASSERT(arraysize(kPolicyNames) == NUM_POLICIES, policy_names);
+
+  // Setup an AtExitManager so Singleton objects will be destructed.
+  base::AtExitManager at_exit_manager;
+  CommandLine::Init(argc, argv);
+
+  // The cache logs every iterator that it invalidates while evicting entries.
+  logging::SetMinLogLevel(logging::LOG_WARNING);
+
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+
+  FilePath trace_path = command_line.GetSwitchValuePath(kTrace);
+  int max_size = kDefaultMaxSize;
+  if (trace_path.empty() || (command_line.HasSwitch(kMaxSize) &&
+      !base::StringToInt(command_line.GetSwitchValueASCII(kMaxSize),
+                         &max_size))) {
+    printf("Usage: cache_sim --trace=<file> [--max-size=<bytes>]\n");
+    return INVALID_ARGUMENT;
+  }
+
+  std::vector<Request> requests;
+  if (!LoadTrace(trace_path, &requests)) {
+    printf("Unable to read the trace\n");
+    return INVALID_TRACE;
+  }
+
+  MessageLoopForIO message_loop;
+  base::Thread cache_thread("CacheThread");
+  if (!cache_thread.StartWithOptions(
+          base::Thread::Options(MessageLoop::TYPE_IO, 0)))
+    return GENERIC;
+
+  for (int i = 0; i < NUM_POLICIES; i++) {
+    Policy policy = static_cast<Policy>(i);
+    Result result;
+    if (!ReplayTrace(policy, requests, max_size, &cache_thread, &result)) {
+      printf("Unable to replay the trace with the %s policy\n",
+             kPolicyNames[policy]);
+      return GENERIC;
+    }
+    PrintResult(policy, result);
+  }
+
+  return ALL_GOOD;
+}
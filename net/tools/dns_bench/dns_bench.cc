@@ -0,0 +1,203 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This command-line program resolves a list of hostnames with the system
+// resolver, which calls getaddrinfo on worker threads, and with the built-in
+// asynchronous DNS client, and compares how long they take. Every line of the
+// input file is a hostname. Empty lines and lines starting with '#' are
+// ignored.
+//
+// Each hostname is resolved once by each resolver, one request at a time.
+// The resolver that goes first alternates from one hostname to the next, since
+// the second request is likely to be answered from the cache of the name
+// server. Neither resolver caches the results.
+//
+// Usage: dns_bench --hosts=<file>
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/file_util.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/string_split.h"
+#include "base/string_util.h"
+#include "base/time.h"
+#include "base/values.h"
+#include "net/base/address_list.h"
+#include "net/base/host_resolver_impl.h"
+#include "net/base/net_errors.h"
+#include "net/base/net_log.h"
+#include "net/base/test_completion_callback.h"
+#include "net/dns/dns_config_service.h"
+
+namespace {
+
+enum Errors {
+  ALL_GOOD = 0,
+  INVALID_ARGUMENT = 1,
+  INVALID_HOSTS,
+  NO_DNS_CONFIG
+};
+
+const char kHosts[] = "hosts";
+
+// How long to wait for the system DNS configuration to be read.
+const int kDnsConfigTimeoutMs = 10000;
+
+// The number of resolutions that can run in parallel. Requests are sent one
+// at a time, so this only matters for the retries of the system resolver.
+const size_t kMaxJobs = 8;
+
+enum ResolverType {
+  SYSTEM_RESOLVER,
+  ASYNC_RESOLVER,
+  NUM_RESOLVERS
+};
+
+const char* const kResolverNames[] = {
+  "getaddrinfo",
+  "async"
+};
+
+struct Result {
+  Result() : succeeded(0), failed(0) {}
+
+  int succeeded;
+  int failed;
+  base::TimeDelta total_time;
+  base::TimeDelta max_time;
+};
+
+// Reads the hostnames stored on the file at |path|.
+bool LoadHosts(const FilePath& path, std::vector<std::string>* hosts) {
+  std::string contents;
+  if (!file_util::ReadFileToString(path, &contents))
+    return false;
+
+  std::vector<std::string> lines;
+  base::SplitString(contents, '\n', &lines);
+  for (size_t i = 0; i < lines.size(); i++) {
+    std::string host;
+    TrimWhitespaceASCII(lines[i], TRIM_ALL, &host);
+    if (host.empty() || host[0] == '#')
+      continue;
+    hosts->push_back(host);
+  }
+  return !hosts->empty();
+}
+
+net::HostResolverImpl* CreateResolver(ResolverType type) {
+  scoped_ptr<net::DnsConfigService> config_service;
+  if (type == ASYNC_RESOLVER)
+    config_service = net::DnsConfigService::CreateSystemService();
+
+  return new net::HostResolverImpl(
+      NULL,
+      net::PrioritizedDispatcher::Limits(net::NUM_PRIORITIES, kMaxJobs),
+      net::HostResolverImpl::ProcTaskParams(
+          NULL, net::HostResolver::kDefaultRetryAttempts),
+      config_service.Pass(),
+      NULL);
+}
+
+// Returns true once |resolver| has read the DNS configuration of the system,
+// so that it does not fall back to getaddrinfo.
+bool WaitForDnsConfig(net::HostResolverImpl* resolver) {
+  base::TimeTicks deadline = base::TimeTicks::Now() +
+      base::TimeDelta::FromMilliseconds(kDnsConfigTimeoutMs);
+  while (base::TimeTicks::Now() < deadline) {
+    scoped_ptr<Value> config(resolver->GetDnsConfigAsValue());
+    DictionaryValue* dict;
+    if (config.get() && config->GetAsDictionary(&dict) && !dict->empty())
+      return true;
+    MessageLoop::current()->PostDelayedTask(
+        FROM_HERE, MessageLoop::QuitClosure(),
+        base::TimeDelta::FromMilliseconds(50));
+    MessageLoop::current()->Run();
+  }
+  return false;
+}
+
+void Resolve(net::HostResolver* resolver, const std::string& host,
+             Result* result) {
+  net::HostResolver::RequestInfo info(net::HostPortPair(host, 80));
+  net::AddressList addresses;
+  net::TestCompletionCallback cb;
+  base::TimeTicks start = base::TimeTicks::Now();
+  int rv = resolver->Resolve(info, &addresses, cb.callback(), NULL,
+                             net::BoundNetLog());
+  rv = cb.GetResult(rv);
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+
+  if (rv == net::OK)
+    result->succeeded++;
+  else
+    result->failed++;
+  result->total_time += elapsed;
+  if (elapsed > result->max_time)
+    result->max_time = elapsed;
+}
+
+void PrintResult(ResolverType type, const Result& result) {
+  int requests = result.succeeded + result.failed;
+  printf("%-12s resolved: %d of %d, average: %.2f ms, max: %.2f ms, "
+         "total: %.2f ms\n",
+         kResolverNames[type], result.succeeded, requests,
+         requests ? result.total_time.InMillisecondsF() / requests : 0.0,
+         result.max_time.InMillisecondsF(),
+         result.total_time.InMillisecondsF());
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+  COMPILE_ASSERT(arraysize(kResolverNames) == NUM_RESOLVERS, resolver_names);
+
+  // Setup an AtExitManager so Singleton objects will be destructed.
+  base::AtExitManager at_exit_manager;
+  CommandLine::Init(argc, argv);
+
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+
+  FilePath hosts_path = command_line.GetSwitchValuePath(kHosts);
+  if (hosts_path.empty()) {
+    printf("Usage: dns_bench --hosts=<file>\n");
+    return INVALID_ARGUMENT;
+  }
+
+  std::vector<std::string> hosts;
+  if (!LoadHosts(hosts_path, &hosts)) {
+    printf("Unable to read the hostnames\n");
+    return INVALID_HOSTS;
+  }
+
+  MessageLoopForIO message_loop;
+
+  scoped_ptr<net::HostResolverImpl> resolvers[NUM_RESOLVERS];
+  for (int i = 0; i < NUM_RESOLVERS; i++)
+    resolvers[i].reset(CreateResolver(static_cast<ResolverType>(i)));
+
+  if (!WaitForDnsConfig(resolvers[ASYNC_RESOLVER].get())) {
+    printf("Unable to read the DNS configuration of the system\n");
+    return NO_DNS_CONFIG;
+  }
+
+  Result results[NUM_RESOLVERS];
+  for (size_t i = 0; i < hosts.size(); i++) {
+    for (int j = 0; j < NUM_RESOLVERS; j++) {
+      int type = (i + j) % NUM_RESOLVERS;
+      Resolve(resolvers[type].get(), hosts[i], &results[type]);
+    }
+  }
+
+  for (int i = 0; i < NUM_RESOLVERS; i++)
+    PrintResult(static_cast<ResolverType>(i), results[i]);
+
+  return ALL_GOOD;
+}
@@ -322,7 +322,9 @@ bool MasterSM::DoInit() {
   } else {
     disk_cache::Backend* cache;
     net::TestCompletionCallback cb;
-    int rv = disk_cache::CreateCacheBackend(net::DISK_CACHE, path_, 0, false,
+    int rv = disk_cache::CreateCacheBackend(net::DISK_CACHE,
+                                            net::CACHE_BACKEND_DEFAULT,
+                                            path_, 0, false,
                                             cache_thread_.message_loop_proxy(),
                                             NULL, &cache, cb.callback());
     if (cb.GetResult(rv) != net::OK) {
@@ -596,7 +598,9 @@ SlaveSM::SlaveSM(const FilePath& path, HANDLE channel)
     : BaseSM(channel), iterator_(NULL) {
   disk_cache::Backend* cache;
   net::TestCompletionCallback cb;
-  int rv = disk_cache::CreateCacheBackend(net::DISK_CACHE, path, 0, false,
+  int rv = disk_cache::CreateCacheBackend(net::DISK_CACHE,
+                                          net::CACHE_BACKEND_DEFAULT,
+                                          path, 0, false,
                                           cache_thread_.message_loop_proxy(),
                                           NULL, &cache, cb.callback());
   if (cb.GetResult(rv) != net::OK) {
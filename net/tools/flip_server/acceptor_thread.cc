@@ -5,6 +5,7 @@
 #include "net/tools/flip_server/acceptor_thread.h"
 
 #include <netinet/in.h>
+#include <sched.h>
 #include <netinet/tcp.h>  // For TCP_NODELAY
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -21,12 +22,16 @@
 namespace net {
 
 SMAcceptorThread::SMAcceptorThread(FlipAcceptor *acceptor,
+                                   int listen_fd,
                                    MemoryCache* memory_cache)
     : SimpleThread("SMAcceptorThread"),
       acceptor_(acceptor),
+      listen_fd_(listen_fd),
+      cpu_(-1),
       ssl_state_(NULL),
       use_ssl_(false),
       idle_socket_timeout_s_(acceptor->idle_socket_timeout_s_),
+      oldest_read_time_(time(NULL)),
       quitting_(false),
       memory_cache_(memory_cache) {
   if (!acceptor->ssl_cert_filename_.empty() &&
@@ -77,7 +82,7 @@ SMConnection* SMAcceptorThread::FindOrMakeNewSMConnection() {
 }
 
 void SMAcceptorThread::InitWorker() {
-  epoll_server_.RegisterFD(acceptor_->listen_fd_, this, EPOLLIN | EPOLLET);
+  epoll_server_.RegisterFD(listen_fd_, this, EPOLLIN | EPOLLET);
 }
 
 void SMAcceptorThread::HandleConnection(int server_fd,
@@ -116,11 +121,11 @@ void SMAcceptorThread::AcceptFromListenFD() {
     for (int i = 0; i < acceptor_->accepts_per_wake_; ++i) {
       struct sockaddr address;
       socklen_t socklen = sizeof(address);
-      int fd = accept(acceptor_->listen_fd_, &address, &socklen);
+      int fd = accept(listen_fd_, &address, &socklen);
       if (fd == -1) {
         if (errno != 11) {
           VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Acceptor: accept fail("
-                  << acceptor_->listen_fd_ << "): " << errno << ": "
+                  << listen_fd_ << "): " << errno << ": "
                   << strerror(errno);
         }
         break;
@@ -132,11 +137,11 @@ void SMAcceptorThread::AcceptFromListenFD() {
     while (true) {
       struct sockaddr address;
       socklen_t socklen = sizeof(address);
-      int fd = accept(acceptor_->listen_fd_, &address, &socklen);
+      int fd = accept(listen_fd_, &address, &socklen);
       if (fd == -1) {
         if (errno != 11) {
           VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Acceptor: accept fail("
-                  << acceptor_->listen_fd_ << "): " << errno << ": "
+                  << listen_fd_ << "): " << errno << ": "
                   << strerror(errno);
         }
         break;
@@ -148,12 +153,10 @@ void SMAcceptorThread::AcceptFromListenFD() {
 }
 
 void SMAcceptorThread::HandleConnectionIdleTimeout() {
-  static time_t oldest_time = time(NULL);
-
   int cur_time = time(NULL);
   // Only iterate the list if we speculate that a connection is ready to be
   // expired
-  if ((cur_time - oldest_time) < idle_socket_timeout_s_)
+  if ((cur_time - oldest_read_time_) < idle_socket_timeout_s_)
     return;
 
   // TODO(mbelshe): This code could be optimized, active_server_connections_
@@ -167,15 +170,24 @@ void SMAcceptorThread::HandleConnectionIdleTimeout() {
       iter = active_server_connections_.erase(iter);
       continue;
     }
-    if (conn->last_read_time_ < oldest_time)
-      oldest_time = conn->last_read_time_;
+    if (conn->last_read_time_ < oldest_read_time_)
+      oldest_read_time_ = conn->last_read_time_;
     iter++;
   }
-  if ((cur_time - oldest_time) >= idle_socket_timeout_s_)
-    oldest_time = cur_time;
+  if ((cur_time - oldest_read_time_) >= idle_socket_timeout_s_)
+    oldest_read_time_ = cur_time;
 }
 
 void SMAcceptorThread::Run() {
+  if (cpu_ >= 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu_, &cpus);
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0)
+      PLOG(ERROR) << "sched_setaffinity() failed for cpu " << cpu_;
+  }
+  request_stats_.SetForCurrentThread();
+
   while (!quitting_.HasBeenNotified()) {
     epoll_server_.set_timeout_in_us(10 * 1000);  // 10 ms
     epoll_server_.WaitForEventsAndExecuteCallbacks();
@@ -12,6 +12,7 @@
 #include "base/compiler_specific.h"
 #include "base/threading/simple_thread.h"
 #include "net/tools/flip_server/epoll_server.h"
+#include "net/tools/flip_server/request_stats.h"
 #include "net/tools/flip_server/sm_interface.h"
 #include "openssl/ssl.h"
 
@@ -42,11 +43,17 @@ class Notification {
    base::Lock lock_;
 };
 
+// Accepts connections from |listen_fd| and serves them on its own
+// EpollServer, so a connection stays on the thread which accepted it.
+// Several threads may share an acceptor, each with its own listening socket
+// or all with the acceptor's.
 class SMAcceptorThread : public base::SimpleThread,
                          public EpollCallbackInterface,
                          public SMConnectionPoolInterface {
  public:
-  SMAcceptorThread(FlipAcceptor *acceptor, MemoryCache* memory_cache);
+  SMAcceptorThread(FlipAcceptor *acceptor,
+                   int listen_fd,
+                   MemoryCache* memory_cache);
   virtual ~SMAcceptorThread();
 
   // EpollCallbackInteface interface
@@ -71,6 +78,11 @@ class SMAcceptorThread : public base::SimpleThread,
   // Notify the Accept thread that it is time to terminate.
   void Quit() { quitting_.Notify(); }
 
+  // Runs the thread only on |cpu|. Must be called before Start().
+  void set_cpu(int cpu) { cpu_ = cpu; }
+
+  RequestStats* request_stats() { return &request_stats_; }
+
   // Iterates through a list of active connections expiring any that have been
   // idle longer than the configured timeout.
   void HandleConnectionIdleTimeout();
@@ -80,9 +92,14 @@ class SMAcceptorThread : public base::SimpleThread,
  private:
   EpollServer epoll_server_;
   FlipAcceptor* acceptor_;
+  int listen_fd_;
+  int cpu_;
   SSLState* ssl_state_;
   bool use_ssl_;
   int idle_socket_timeout_s_;
+  // The oldest last read time among the active connections, as of the last
+  // idle timeout check.
+  time_t oldest_read_time_;
 
   std::vector<SMConnection*> unused_server_connections_;
   std::vector<SMConnection*> tmp_unused_server_connections_;
@@ -90,6 +107,7 @@ class SMAcceptorThread : public base::SimpleThread,
   std::list<SMConnection*> active_server_connections_;
   Notification quitting_;
   MemoryCache* memory_cache_;
+  RequestStats request_stats_;
 };
 
 }  // namespace net
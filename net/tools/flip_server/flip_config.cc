@@ -38,7 +38,9 @@ FlipAcceptor::FlipAcceptor(enum FlipHandlerType flip_handler_type,
       memory_cache_(memory_cache),
       ssl_session_expiry_(300),  // TODO(mbelshe):  Hook these up!
       ssl_disable_compression_(false),
-      idle_socket_timeout_s_(300) {
+      idle_socket_timeout_s_(300),
+      reuseport_(reuseport),
+      wait_for_iface_(wait_for_iface) {
   VLOG(1) << "Attempting to listen on " << listen_ip_.c_str() << ":"
           << listen_port_.c_str();
   if (!https_server_ip_.size())
@@ -46,31 +48,10 @@ FlipAcceptor::FlipAcceptor(enum FlipHandlerType flip_handler_type,
   if (!https_server_port_.size())
     https_server_port_ = http_server_port_;
 
-  while (1) {
-    int ret = CreateListeningSocket(listen_ip_,
-                                    listen_port_,
-                                    true,
-                                    accept_backlog_size_,
-                                    true,
-                                    reuseport,
-                                    wait_for_iface,
-                                    disable_nagle_,
-                                    &listen_fd_);
-    if ( ret == 0 ) {
-      break;
-    } else if ( ret == -3 && wait_for_iface ) {
-      // Binding error EADDRNOTAVAIL was encounted. We need
-      // to wait for the interfaces to raised. try again.
-      usleep(200000);
-    } else {
-      LOG(ERROR) << "Unable to create listening socket for: ret = " << ret
-                 << ": " << listen_ip_.c_str() << ":"
-                 << listen_port_.c_str();
-      return;
-    }
-  }
+  listen_fd_ = CreateListenFD();
+  if (listen_fd_ < 0)
+    return;
 
-  SetNonBlocking(listen_fd_);
   VLOG(1) << "Listening on socket: ";
   if (flip_handler_type == FLIP_HANDLER_PROXY)
     VLOG(1) << "\tType         : Proxy";
@@ -93,6 +74,41 @@ FlipAcceptor::FlipAcceptor(enum FlipHandlerType flip_handler_type,
 
 FlipAcceptor::~FlipAcceptor() {}
 
+int FlipAcceptor::CreateAdditionalListenFD() {
+  DCHECK(reuseport_);
+  return CreateListenFD();
+}
+
+int FlipAcceptor::CreateListenFD() {
+  int listen_fd = -1;
+  while (1) {
+    int ret = CreateListeningSocket(listen_ip_,
+                                    listen_port_,
+                                    true,
+                                    accept_backlog_size_,
+                                    true,
+                                    reuseport_,
+                                    wait_for_iface_,
+                                    disable_nagle_,
+                                    &listen_fd);
+    if ( ret == 0 ) {
+      break;
+    } else if ( ret == -3 && wait_for_iface_ ) {
+      // Binding error EADDRNOTAVAIL was encounted. We need
+      // to wait for the interfaces to raised. try again.
+      usleep(200000);
+    } else {
+      LOG(ERROR) << "Unable to create listening socket for: ret = " << ret
+                 << ": " << listen_ip_.c_str() << ":"
+                 << listen_port_.c_str();
+      return -1;
+    }
+  }
+
+  SetNonBlocking(listen_fd);
+  return listen_fd;
+}
+
 FlipConfig::FlipConfig()
     : server_think_time_in_s_(0),
       log_destination_(logging::LOG_ONLY_TO_SYSTEM_DEBUG_LOG),
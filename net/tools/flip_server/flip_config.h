@@ -42,6 +42,11 @@ class FlipAcceptor {
                void *memory_cache);
   ~FlipAcceptor();
 
+  // Opens another socket listening on the same address, so that an acceptor
+  // thread can have one of its own. Requires reuseport. Returns -1 on
+  // failure.
+  int CreateAdditionalListenFD();
+
   enum FlipHandlerType flip_handler_type_;
   std::string listen_ip_;
   std::string listen_port_;
@@ -60,6 +65,13 @@ class FlipAcceptor {
   int ssl_session_expiry_;
   bool ssl_disable_compression_;
   int idle_socket_timeout_s_;
+
+ private:
+  // Returns a new non-blocking listening socket, or -1 on failure.
+  int CreateListenFD();
+
+  bool reuseport_;
+  bool wait_for_iface_;
 };
 
 class FlipConfig {
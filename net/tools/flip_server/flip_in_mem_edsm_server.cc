@@ -7,6 +7,7 @@
 #include <sys/file.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -14,11 +15,14 @@
 #include "base/command_line.h"
 #include "base/logging.h"
 #include "base/synchronization/lock.h"
+#include "base/sys_info.h"
+#include "base/time.h"
 #include "base/timer.h"
 #include "net/tools/flip_server/acceptor_thread.h"
 #include "net/tools/flip_server/constants.h"
 #include "net/tools/flip_server/flip_config.h"
 #include "net/tools/flip_server/output_ordering.h"
+#include "net/tools/flip_server/request_stats.h"
 #include "net/tools/flip_server/sm_connection.h"
 #include "net/tools/flip_server/sm_interface.h"
 #include "net/tools/flip_server/spdy_interface.h"
@@ -46,6 +50,15 @@ int32 FLAGS_accept_backlog_size = 1024;
 //  SO_REUSEPORT);
 bool FLAGS_reuseport = false;
 
+// The number of acceptor threads, each with its own EpollServer, to serve
+//  each listen address with. If set to 0 then one thread is pinned to each
+//  CPU core.
+int32 FLAGS_accept_threads = 1;
+
+// How often, in seconds, to print the requests served per second and their
+//  latency. If set to 0 then nothing is printed.
+int32 FLAGS_stats_interval_s = 0;
+
 // Flag to force spdy, even if NPN is not negotiated.
 bool FLAGS_force_spdy = false;
 
@@ -204,6 +217,15 @@ int main (int argc, char**argv)
     cout << "\t--ssl-session-expiry=<seconds> (default is 300)\n";
     cout << "\t--ssl-disable-compression\n";
     cout << "\t--idle-timeout=<seconds> (default is 300)\n";
+    cout << "\t--threads=<n> (default is 1)\n";
+    cout << "\t  * The number of threads serving each listen address, or 0"
+         << " for one per\n"
+         << "\t    CPU core.\n";
+    cout << "\t--reuseport\n";
+    cout << "\t  * Gives each thread its own listening socket using"
+         << " SO_REUSEPORT.\n";
+    cout << "\t--stats-interval=<seconds>\n";
+    cout << "\t  * Prints requests per second and latency this often.\n";
     cout << "\t--pidfile=<filepath> (default /var/run/flip-server.pid)\n";
     cout << "\t--help\n";
     exit(0);
@@ -272,6 +294,23 @@ int main (int argc, char**argv)
   if (cl.HasSwitch("force_spdy"))
     net::SMConnection::set_force_spdy(true);
 
+  if (cl.HasSwitch("threads"))
+    FLAGS_accept_threads = atoi(cl.GetSwitchValueASCII("threads").c_str());
+
+  if (cl.HasSwitch("reuseport"))
+    FLAGS_reuseport = true;
+
+  if (cl.HasSwitch("stats-interval")) {
+    FLAGS_stats_interval_s =
+      atoi(cl.GetSwitchValueASCII("stats-interval").c_str());
+  }
+
+  bool pin_threads = false;
+  if (FLAGS_accept_threads <= 0) {
+    FLAGS_accept_threads = base::SysInfo::NumberOfProcessors();
+    pin_threads = true;
+  }
+
   InitLogging(g_proxy_config.log_filename_.c_str(),
               g_proxy_config.log_destination_,
               logging::DONT_LOCK_LOG_FILE,
@@ -299,6 +338,8 @@ int main (int argc, char**argv)
             << g_proxy_config.ssl_disable_compression_;
   LOG(INFO) << "Connection idle timeout : "
             << g_proxy_config.idle_socket_timeout_s_;
+  LOG(INFO) << "Threads per acceptor    : " << FLAGS_accept_threads
+            << (pin_threads?" (one per core)":"");
 
   // Proxy Acceptors
   while (true) {
@@ -375,21 +416,33 @@ int main (int argc, char**argv)
   for (i = 0; i < g_proxy_config.acceptors_.size(); i++) {
     net::FlipAcceptor *acceptor = g_proxy_config.acceptors_[i];
 
-    sm_worker_threads_.push_back(
-        new net::SMAcceptorThread(acceptor,
-                                  (net::MemoryCache *)acceptor->memory_cache_));
-    // Note that spdy_memory_cache is not threadsafe, it is merely
-    // thread compatible. Thus, if ever we are to spawn multiple threads,
-    // we either must make the MemoryCache threadsafe, or use
-    // a separate MemoryCache for each thread.
-    //
-    // The latter is what is currently being done as we spawn
-    // a separate thread for each http and spdy server acceptor.
-
-    sm_worker_threads_.back()->InitWorker();
-    sm_worker_threads_.back()->Start();
+    for (int thread = 0; thread < FLAGS_accept_threads; ++thread) {
+      // With reuseport the kernel spreads new connections over the threads'
+      // sockets. Otherwise every thread waits on the one socket.
+      int listen_fd = acceptor->listen_fd_;
+      if (thread > 0 && FLAGS_reuseport) {
+        listen_fd = acceptor->CreateAdditionalListenFD();
+        if (listen_fd < 0)
+          break;
+      }
+
+      // The MemoryCache is only read once the files are loaded, so the
+      // threads share it.
+      sm_worker_threads_.push_back(
+          new net::SMAcceptorThread(
+              acceptor, listen_fd,
+              (net::MemoryCache *)acceptor->memory_cache_));
+      if (pin_threads)
+        sm_worker_threads_.back()->set_cpu(thread);
+
+      sm_worker_threads_.back()->InitWorker();
+      sm_worker_threads_.back()->Start();
+    }
   }
 
+  std::vector<int> request_counts(net::RequestStats::kNumBuckets, 0);
+  base::TimeTicks last_stats_time = base::TimeTicks::Now();
+
   while (!wantExit) {
     // Close logfile when HUP signal is received. Logging system will
     // automatically reopen on next log message.
@@ -398,6 +451,17 @@ int main (int argc, char**argv)
       VLOG(1) << "HUP received, reopening log file.";
       logging::CloseLogFile();
     }
+    if (FLAGS_stats_interval_s > 0) {
+      base::TimeDelta elapsed = base::TimeTicks::Now() - last_stats_time;
+      if (elapsed >= base::TimeDelta::FromSeconds(FLAGS_stats_interval_s)) {
+        for (unsigned int i = 0; i < sm_worker_threads_.size(); ++i)
+          sm_worker_threads_[i]->request_stats()->TakeCounts(&request_counts);
+        cout << net::RequestStats::FormatReport(request_counts, elapsed)
+             << "\n";
+        std::fill(request_counts.begin(), request_counts.end(), 0);
+        last_stats_time += elapsed;
+      }
+    }
     if (GotQuitFromStdin()) {
       for (unsigned int i = 0; i < sm_worker_threads_.size(); ++i) {
         sm_worker_threads_[i]->Quit();
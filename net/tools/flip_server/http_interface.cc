@@ -7,6 +7,7 @@
 #include "net/tools/dump_cache/url_utilities.h"
 #include "net/tools/flip_server/balsa_frame.h"
 #include "net/tools/flip_server/flip_config.h"
+#include "net/tools/flip_server/request_stats.h"
 #include "net/tools/flip_server/sm_connection.h"
 #include "net/tools/flip_server/spdy_util.h"
 
@@ -202,6 +203,7 @@ void HttpSM::NewStream(uint32 stream_id, uint32 priority,
   MemCacheIter mci;
   mci.stream_id = stream_id;
   mci.priority = priority;
+  mci.request_time = base::TimeTicks::Now();
   if (!memory_cache_->AssignFileData(filename, &mci)) {
     // error creating new stream.
     VLOG(2) << ACCEPTOR_CLIENT_IDENT << "Sending ErrorNotFound";
@@ -330,6 +332,26 @@ void HttpSM::GetOutput() {
             << "output!?: stream " << stream_id_;
     return;
   }
+  if (!mci->transformed_header &&
+      acceptor_->flip_handler_type_ == FLIP_HANDLER_HTTP_SERVER &&
+      !mci->file_data->http_response.empty()) {
+    // The cache holds the whole response already framed, so queue it in
+    // place instead of framing and copying the body a segment at a time.
+    DataFrame* df = new DataFrame;
+    df->data = mci->file_data->http_response.data();
+    df->size = mci->file_data->http_response.size();
+    df->delete_when_done = false;
+    mci->bytes_sent = df->size;
+    mci->transformed_header = true;
+    EnqueueDataFrame(df);
+    if (!mci->request_time.is_null())
+      RequestStats::Record(base::TimeTicks::Now() - mci->request_time);
+    VLOG(2) << ACCEPTOR_CLIENT_IDENT << "HttpSM: GetOutput sent cached "
+            << "response stream_id: [" << mci->stream_id << "]";
+    Reset();
+    output_ordering_.RemoveStreamId(mci->stream_id);
+    return;
+  }
   if (!mci->transformed_header) {
     mci->bytes_sent = SendSynReply(mci->stream_id,
                                    *(mci->file_data->headers));
@@ -339,6 +361,8 @@ void HttpSM::GetOutput() {
     return;
   }
   if (mci->body_bytes_consumed >= mci->file_data->body.size()) {
+    if (!mci->request_time.is_null())
+      RequestStats::Record(base::TimeTicks::Now() - mci->request_time);
     SendEOF(mci->stream_id);
     output_ordering_.RemoveStreamId(mci->stream_id);
     VLOG(2) << ACCEPTOR_CLIENT_IDENT << "GetOutput remove_stream_id: ["
@@ -18,6 +18,7 @@
 #include "net/tools/dump_cache/url_utilities.h"
 #include "net/tools/flip_server/balsa_frame.h"
 #include "net/tools/flip_server/balsa_headers.h"
+#include "net/tools/flip_server/simple_buffer.h"
 
 // The directory where cache locates);
 std::string FLAGS_cache_base_dir = ".";
@@ -59,6 +60,7 @@ void FileData::CopyFrom(const FileData& file_data) {
     filename = file_data.filename;
     related_files = file_data.related_files;
     body = file_data.body;
+    http_response = file_data.http_response;
   }
 
 MemoryCache::MemoryCache() {}
@@ -201,10 +203,26 @@ void MemoryCache::ReadAndStoreFileContents(const char* filename) {
   fd = FileData(headers, visitor.body);
   fd.filename = std::string(filename_stripped,
                             filename_stripped.find_first_of('/'));
+
+  SimpleBuffer sb;
+  headers->WriteHeaderAndEndingToBuffer(&sb);
+  char* header_bytes;
+  int header_size;
+  sb.GetReadablePtr(&header_bytes, &header_size);
+  fd.http_response.assign(header_bytes, header_size);
+  if (!fd.body.empty()) {
+    char chunk_buf[128];
+    snprintf(chunk_buf, sizeof(chunk_buf), "%x\r\n",
+             static_cast<unsigned int>(fd.body.size()));
+    fd.http_response += chunk_buf;
+    fd.http_response += fd.body;
+    fd.http_response += "\r\n";
+  }
+  fd.http_response += "0\r\n\r\n";
 }
 
-FileData* MemoryCache::GetFileData(const std::string& filename) {
-  Files::iterator fi = files_.end();
+const FileData* MemoryCache::GetFileData(const std::string& filename) const {
+  Files::const_iterator fi = files_.end();
   if (filename.compare(filename.length() - 5, 5, ".html", 5) == 0) {
     std::string new_filename(filename.data(), filename.size() - 5);
     new_filename += ".http";
@@ -220,7 +238,7 @@ FileData* MemoryCache::GetFileData(const std::string& filename) {
 }
 
 bool MemoryCache::AssignFileData(const std::string& filename,
-                                 MemCacheIter* mci) {
+                                 MemCacheIter* mci) const {
   mci->file_data = GetFileData(filename);
   if (mci->file_data == NULL) {
     LOG(ERROR) << "Could not find file data for " << filename;
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "base/compiler_specific.h"
+#include "base/time.h"
 #include "net/tools/flip_server/balsa_headers.h"
 #include "net/tools/flip_server/balsa_visitor_interface.h"
 #include "net/tools/flip_server/constants.h"
@@ -73,6 +74,9 @@ struct FileData {
   // priority, filename
   std::vector< std::pair<int, std::string> > related_files;
   std::string body;
+  // The headers and the body framed as a complete chunked HTTP/1.1 response,
+  // so that the HTTP server can send it straight from the cache.
+  std::string http_response;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -87,7 +91,7 @@ class MemCacheIter {
       stream_id(0),
       max_segment_size(kInitialDataSendersThreshold),
       bytes_sent(0) {}
-  explicit MemCacheIter(FileData* fd) :
+  explicit MemCacheIter(const FileData* fd) :
       file_data(fd),
       priority(0),
       transformed_header(false),
@@ -95,17 +99,21 @@ class MemCacheIter {
       stream_id(0),
       max_segment_size(kInitialDataSendersThreshold),
       bytes_sent(0) {}
-  FileData* file_data;
+  const FileData* file_data;
   int priority;
   bool transformed_header;
   size_t body_bytes_consumed;
   uint32 stream_id;
   uint32 max_segment_size;
   size_t bytes_sent;
+  // When the request for |file_data| arrived, for the request stats.
+  base::TimeTicks request_time;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Once AddFiles() has returned, the cache is only read, so every acceptor
+// thread can share one without locking.
 class MemoryCache {
  public:
   typedef std::map<std::string, FileData> Files;
@@ -122,9 +130,9 @@ class MemoryCache {
 
   void ReadAndStoreFileContents(const char* filename);
 
-  FileData* GetFileData(const std::string& filename);
+  const FileData* GetFileData(const std::string& filename) const;
 
-  bool AssignFileData(const std::string& filename, MemCacheIter* mci);
+  bool AssignFileData(const std::string& filename, MemCacheIter* mci) const;
 
   Files files_;
   std::string cwd_;
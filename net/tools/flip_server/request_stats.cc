@@ -0,0 +1,93 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/flip_server/request_stats.h"
+
+#include "base/format_macros.h"
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/stringprintf.h"
+#include "base/threading/thread_local.h"
+
+namespace net {
+
+namespace {
+
+base::LazyInstance<base::ThreadLocalPointer<RequestStats> >::Leaky
+    current_stats_ = LAZY_INSTANCE_INITIALIZER;
+
+// Returns the bucket whose range holds |latency_us|.
+int BucketForLatency(int64 latency_us) {
+  int bucket = 0;
+  while (latency_us > 0 && bucket < RequestStats::kNumBuckets - 1) {
+    latency_us >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+// Returns the upper bound, in microseconds, of the bucket which holds the
+// |fraction| quantile of |counts|, whose total is |total|.
+int64 LatencyQuantile(const std::vector<int>& counts,
+                      int64 total,
+                      double fraction) {
+  int64 seen = 0;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    seen += counts[i];
+    if (seen >= total * fraction)
+      return GG_INT64_C(1) << i;
+  }
+  return GG_INT64_C(1) << (counts.size() - 1);
+}
+
+}  // namespace
+
+RequestStats::RequestStats() {
+  for (int i = 0; i < kNumBuckets; ++i)
+    counts_[i] = 0;
+}
+
+RequestStats::~RequestStats() {
+  if (current_stats_.Pointer()->Get() == this)
+    current_stats_.Pointer()->Set(NULL);
+}
+
+void RequestStats::SetForCurrentThread() {
+  current_stats_.Pointer()->Set(this);
+}
+
+// static
+void RequestStats::Record(base::TimeDelta latency) {
+  RequestStats* stats = current_stats_.Pointer()->Get();
+  if (!stats)
+    return;
+  base::subtle::NoBarrier_AtomicIncrement(
+      &stats->counts_[BucketForLatency(latency.InMicroseconds())], 1);
+}
+
+void RequestStats::TakeCounts(std::vector<int>* counts) {
+  DCHECK_EQ(static_cast<size_t>(kNumBuckets), counts->size());
+  for (int i = 0; i < kNumBuckets; ++i)
+    (*counts)[i] += base::subtle::NoBarrier_AtomicExchange(&counts_[i], 0);
+}
+
+// static
+std::string RequestStats::FormatReport(const std::vector<int>& counts,
+                                       base::TimeDelta elapsed) {
+  int64 total = 0;
+  for (size_t i = 0; i < counts.size(); ++i)
+    total += counts[i];
+  double rate = elapsed.InSecondsF() > 0 ? total / elapsed.InSecondsF() : 0;
+  if (!total)
+    return base::StringPrintf("requests/s: %.1f", rate);
+  return base::StringPrintf(
+      "requests/s: %.1f  latency p50 < %" PRId64 "us  p90 < %" PRId64
+      "us  p99 < %" PRId64 "us",
+      rate,
+      LatencyQuantile(counts, total, 0.5),
+      LatencyQuantile(counts, total, 0.9),
+      LatencyQuantile(counts, total, 0.99));
+}
+
+}  // namespace net
@@ -0,0 +1,52 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_FLIP_SERVER_REQUEST_STATS_H_
+#define NET_TOOLS_FLIP_SERVER_REQUEST_STATS_H_
+
+#include <string>
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "base/time.h"
+
+namespace net {
+
+// Counts the requests served on one thread, bucketed by latency. The thread
+// records without locking, and the reporting thread takes the counts with
+// atomic exchanges, so the threads never contend.
+class RequestStats {
+ public:
+  // Bucket i counts the requests which took under 2^i microseconds.
+  static const int kNumBuckets = 32;
+
+  RequestStats();
+  ~RequestStats();
+
+  // Makes Record() on the calling thread count into this object.
+  void SetForCurrentThread();
+
+  // Counts a request served on the calling thread which took |latency|. Does
+  // nothing on threads without a RequestStats.
+  static void Record(base::TimeDelta latency);
+
+  // Adds the counts recorded since the last call to |counts|, which must have
+  // kNumBuckets entries, and resets them.
+  void TakeCounts(std::vector<int>* counts);
+
+  // Returns a line with the request rate and latency percentiles of |counts|,
+  // which were recorded over |elapsed|.
+  static std::string FormatReport(const std::vector<int>& counts,
+                                  base::TimeDelta elapsed);
+
+ private:
+  base::subtle::Atomic32 counts_[kNumBuckets];
+
+  DISALLOW_COPY_AND_ASSIGN(RequestStats);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_FLIP_SERVER_REQUEST_STATS_H_
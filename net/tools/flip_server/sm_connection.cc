@@ -6,8 +6,11 @@
 
 #include <errno.h>
 #include <netinet/tcp.h>
+#include <string.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
+#include <algorithm>
 #include <list>
 #include <string>
 
@@ -575,7 +578,13 @@ bool SMConnection::DoWrite() {
       flags |= MSG_MORE;
     }
     VLOG(2) << log_prefix_ << "Attempting to send " << size << " bytes.";
-    ssize_t bytes_written = Send(bytes, size, flags);
+    // Gather the queued frames into one call, so that a frame header and the
+    // cached body it refers to don't take a system call each.
+    ssize_t bytes_written;
+    if (!ssl_ && output_list_.size() > 1)
+      bytes_written = SendOutputList(flags);
+    else
+      bytes_written = Send(bytes, size, flags);
     int stored_errno = errno;
     if (bytes_written == -1) {
       switch (stored_errno) {
@@ -597,8 +606,17 @@ bool SMConnection::DoWrite() {
     } else if (bytes_written > 0) {
       VLOG(2) << log_prefix_ << ACCEPTOR_CLIENT_IDENT << "Wrote: "
               << bytes_written << " bytes";
-      data_frame->index += bytes_written;
       bytes_sent += bytes_written;
+      // Frames which are now fully written are freed at the top of the loop.
+      for (OutputList::iterator it = output_list_.begin();
+           bytes_written > 0; ++it) {
+        DataFrame* written_frame = *it;
+        size_t consumed = std::min(
+            static_cast<size_t>(bytes_written),
+            written_frame->size - written_frame->index);
+        written_frame->index += consumed;
+        bytes_written -= consumed;
+      }
       continue;
     } else if (bytes_written == -2) {
       // -2 handles SSL_ERROR_WANT_* errors
@@ -622,6 +640,30 @@ bool SMConnection::DoWrite() {
   return false;
 }
 
+int SMConnection::SendOutputList(int flags) {
+  DCHECK(!ssl_);
+  const size_t kMaxIovecs = 16;
+  struct iovec iov[kMaxIovecs];
+  size_t iov_count = 0;
+  for (OutputList::const_iterator it = output_list_.begin();
+       it != output_list_.end() && iov_count < kMaxIovecs; ++it) {
+    const DataFrame* data_frame = *it;
+    if (data_frame->index >= data_frame->size)
+      continue;
+    iov[iov_count].iov_base =
+        const_cast<char*>(data_frame->data + data_frame->index);
+    iov[iov_count].iov_len = data_frame->size - data_frame->index;
+    ++iov_count;
+  }
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = iov_count;
+  CorkSocket();
+  return sendmsg(fd_, &msg, flags);
+}
+
 void SMConnection::Reset() {
   VLOG(2) << log_prefix_ << ACCEPTOR_CLIENT_IDENT << "Resetting";
   if (ssl_) {
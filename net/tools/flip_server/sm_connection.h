@@ -62,6 +62,7 @@ class SMConnection : public SMConnectionInterface,
   void EnqueueDataFrame(DataFrame* df);
 
   int fd() const { return fd_; }
+  bool using_ssl() const { return ssl_ != NULL; }
   bool initialized() const { return initialized_; }
   std::string client_ip() const { return client_ip_; }
 
@@ -78,6 +79,9 @@ class SMConnection : public SMConnectionInterface,
   void UncorkSocket();
 
   int Send(const char* data, int len, int flags);
+  // Writes as many of the queued frames as fit in one sendmsg() call.  Only
+  // for connections without SSL.
+  int SendOutputList(int flags);
 
   // EpollCallbackInterface interface.
   virtual void OnRegistration(EpollServer* eps,
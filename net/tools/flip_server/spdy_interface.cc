@@ -11,6 +11,7 @@
 #include "net/tools/dump_cache/url_utilities.h"
 #include "net/tools/flip_server/flip_config.h"
 #include "net/tools/flip_server/http_interface.h"
+#include "net/tools/flip_server/request_stats.h"
 #include "net/tools/flip_server/spdy_util.h"
 
 namespace net {
@@ -309,6 +310,7 @@ void SpdySM::NewStream(uint32 stream_id,
   mci.stream_id = stream_id;
   mci.priority = priority;
   if (acceptor_->flip_handler_type_ == FLIP_HANDLER_SPDY_SERVER) {
+    mci.request_time = base::TimeTicks::Now();
     if (!memory_cache_->AssignFileData(filename, &mci)) {
       // error creating new stream.
       VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Sending ErrorNotFound";
@@ -483,6 +485,30 @@ void SpdySM::SendDataFrameImpl(uint32 stream_id, const char* data, int64 len,
   }
 }
 
+void SpdySM::SendCachedDataFrames(uint32 stream_id, const char* data,
+                                  int64 len) {
+  while (len > 0) {
+    int64 size = std::min(len, static_cast<int64>(kSpdySegmentSize));
+
+    // Frame just the header, then queue the payload in place behind it.
+    SpdyDataFrame* fdf = buffered_spdy_framer_->CreateDataFrame(
+        stream_id, NULL, 0, DATA_FLAG_NONE);
+    fdf->set_length(size);
+    DataFrame* header = new SpdyFrameDataFrame(fdf);
+    header->size = SpdyFrame::kHeaderSize;
+    EnqueueDataFrame(header);
+
+    DataFrame* df = new DataFrame;
+    df->data = data;
+    df->size = size;
+    df->delete_when_done = false;
+    EnqueueDataFrame(df);
+
+    data += size;
+    len -= size;
+  }
+}
+
 void SpdySM::EnqueueDataFrame(DataFrame* df) {
   connection_->EnqueueDataFrame(df);
 }
@@ -520,6 +546,8 @@ void SpdySM::GetOutput() {
     if (mci->body_bytes_consumed >= mci->file_data->body.size()) {
       VLOG(2) << ACCEPTOR_CLIENT_IDENT << "SpdySM: GetOutput "
               << "remove_stream_id: [" << mci->stream_id << "]";
+      if (!mci->request_time.is_null())
+        RequestStats::Record(base::TimeTicks::Now() - mci->request_time);
       SendEOF(mci->stream_id);
       return;
     }
@@ -538,9 +566,19 @@ void SpdySM::GetOutput() {
       }
     }
 
-    SendDataFrame(mci->stream_id,
-                  mci->file_data->body.data() + mci->body_bytes_consumed,
-                  num_to_write, 0, should_compress);
+    // Without SSL the connection writes queued frames with one gathering
+    // call, so the body can be sent from the cache without copying it. SSL
+    // needs each record in one buffer, so copy the body into the frames.
+    if (!connection_->using_ssl()) {
+      SendCachedDataFrames(
+          mci->stream_id,
+          mci->file_data->body.data() + mci->body_bytes_consumed,
+          num_to_write);
+    } else {
+      SendDataFrame(mci->stream_id,
+                    mci->file_data->body.data() + mci->body_bytes_consumed,
+                    num_to_write, 0, should_compress);
+    }
     VLOG(2) << ACCEPTOR_CLIENT_IDENT << "SpdySM: GetOutput SendDataFrame["
             << mci->stream_id << "]: " << num_to_write;
     mci->body_bytes_consumed += num_to_write;
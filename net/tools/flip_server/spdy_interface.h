@@ -130,6 +130,9 @@ class SpdySM : public BufferedSpdyFramerVisitorInterface,
   size_t SendSynReplyImpl(uint32 stream_id, const BalsaHeaders& headers);
   void SendDataFrameImpl(uint32 stream_id, const char* data, int64 len,
                          SpdyDataFlags flags, bool compress);
+  // Sends |len| bytes of a body held in the memory cache as DATA frames whose
+  // payloads point into the cache rather than copies of it.
+  void SendCachedDataFrames(uint32 stream_id, const char* data, int64 len);
   void EnqueueDataFrame(DataFrame* df);
   virtual void GetOutput() OVERRIDE;
  private:
@@ -0,0 +1,341 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This command-line program simulates loading a page from a single host, and
+// reports the page load time without pipelining, with pipelines of a fixed
+// depth, and with the adaptive depth and head-of-line eviction used by
+// HttpPipelinedHostImpl. The page is a list of response sizes, one per line of
+// the trace, requested in order. Empty lines and lines starting with '#' are
+// ignored. Without a trace, a typical page of about 60 resources is used.
+//
+// The model is deliberately simple: all connections share the link bandwidth
+// equally while they receive data, new connections take one round trip to
+// connect, and the server answers each request one round trip after it's sent.
+//
+// Usage: pipeline_sim [--trace=<file>] [--rtt-ms=<ms>]
+//                     [--bandwidth-kbps=<kbps>] [--connections=<count>]
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/basictypes.h"
+#include "base/command_line.h"
+#include "base/file_util.h"
+#include "base/memory/linked_ptr.h"
+#include "base/string_number_conversions.h"
+#include "base/string_split.h"
+#include "base/time.h"
+#include "net/http/http_pipelined_host_impl.h"
+
+namespace {
+
+enum Errors {
+  ALL_GOOD = 0,
+  INVALID_ARGUMENT = 1,
+  INVALID_TRACE
+};
+
+const char kTrace[] = "trace";
+const char kRttMs[] = "rtt-ms";
+const char kBandwidthKbps[] = "bandwidth-kbps";
+const char kConnections[] = "connections";
+
+const int kDefaultRttMs = 100;
+const int kDefaultBandwidthKbps = 5000;
+const int kDefaultConnections = 6;
+
+// Length of a simulation step, in milliseconds.
+const int kStepMs = 1;
+
+// Gives up on a page that takes longer than this to load.
+const int kMaxSimulatedMs = 10 * 60 * 1000;
+
+enum Mode {
+  NO_PIPELINING,
+  FIXED_DEPTH,
+  ADAPTIVE_DEPTH,
+  NUM_MODES
+};
+
+const char* const kModeNames[] = {
+  "none",
+  "fixed",
+  "adaptive"
+};
+
+struct Options {
+  int rtt_ms;
+  int bandwidth_kbps;
+  int connections;
+};
+
+// A request that has been sent on a connection.
+struct InFlight {
+  size_t request;
+  int64 remaining;
+  int sent_ms;
+  // Time at which the first byte of the response may arrive.
+  int ready_ms;
+};
+
+struct Connection {
+  explicit Connection(int connected_ms)
+      : connected_ms(connected_ms), usable(true), headers_seen(false) {}
+
+  int connected_ms;
+  std::deque<InFlight> in_flight;
+  // False once the requests behind a large response were evicted. The
+  // connection is closed when its last response completes.
+  bool usable;
+  // True once the headers of the front response were seen.
+  bool headers_seen;
+};
+
+struct Result {
+  Result() : load_time_ms(-1), connections(0), evicted_requests(0) {}
+
+  int load_time_ms;
+  int connections;
+  int evicted_requests;
+};
+
+// Returns the sizes of a typical page: one document, a few style sheets and
+// scripts, many small images and a couple of large ones.
+void MakeDefaultPage(std::vector<int64>* sizes) {
+  sizes->push_back(48 * 1024);
+  uint32 seed = 42;
+  for (int i = 0; i < 60; ++i) {
+    // A small linear congruential generator keeps the page the same on every
+    // run and on every platform.
+    seed = seed * 1103515245 + 12345;
+    int64 size = 1024 + (seed >> 16) % (24 * 1024);
+    if (i % 10 == 3)
+      size *= 4;
+    sizes->push_back(size);
+    if (i == 15)
+      sizes->push_back(400 * 1024);
+    if (i == 35)
+      sizes->push_back(900 * 1024);
+  }
+}
+
+// Reads the response sizes stored on the file at |path|.
+bool LoadTrace(const FilePath& path, std::vector<int64>* sizes) {
+  std::string contents;
+  if (!file_util::ReadFileToString(path, &contents))
+    return false;
+
+  std::vector<std::string> lines;
+  base::SplitString(contents, '\n', &lines);
+  for (size_t i = 0; i < lines.size(); i++) {
+    if (lines[i].empty() || lines[i][0] == '#')
+      continue;
+
+    int64 size;
+    if (!base::StringToInt64(lines[i], &size) || size < 0) {
+      printf("Invalid response size on line %d\n", static_cast<int>(i + 1));
+      return false;
+    }
+    sizes->push_back(size);
+  }
+  return !sizes->empty();
+}
+
+// Loads the page made of |sizes| in the given |mode|.
+void Simulate(Mode mode, const std::vector<int64>& sizes,
+              const Options& options, Result* result) {
+  std::vector<linked_ptr<Connection> > connections;
+  std::deque<size_t> pending;
+  for (size_t i = 0; i < sizes.size(); ++i)
+    pending.push_back(i);
+  size_t completed = 0;
+
+  // Response statistics used by the adaptive mode, like the ones kept by
+  // HttpPipelinedHostImpl.
+  int num_samples = 0;
+  int64 average_size = 0;
+  int64 average_time_to_headers_ms = 0;
+  int depth = mode == NO_PIPELINING ?
+      1 : net::HttpPipelinedHostImpl::max_pipeline_depth();
+
+  const int64 bytes_per_step =
+      std::max(options.bandwidth_kbps / 8 * kStepMs, 1);
+
+  for (int now = 0; now < kMaxSimulatedMs; now += kStepMs) {
+    // Prefer idle connections, then new ones, then the shortest pipeline.
+    while (!pending.empty()) {
+      Connection* target = NULL;
+      for (size_t i = 0; i < connections.size(); ++i) {
+        Connection* connection = connections[i].get();
+        if (!connection->usable)
+          continue;
+        int connection_depth = static_cast<int>(connection->in_flight.size());
+        if (connection_depth == 0) {
+          target = connection;
+          break;
+        }
+        if (connection_depth < depth && (!target ||
+            connection_depth < static_cast<int>(target->in_flight.size()))) {
+          target = connection;
+        }
+      }
+      if ((!target || !target->in_flight.empty()) &&
+          static_cast<int>(connections.size()) < options.connections) {
+        target = new Connection(now + options.rtt_ms);
+        connections.push_back(make_linked_ptr(target));
+        ++result->connections;
+      }
+      if (!target)
+        break;
+
+      InFlight request;
+      request.request = pending.front();
+      request.remaining = sizes[request.request];
+      request.sent_ms = std::max(now, target->connected_ms);
+      request.ready_ms = request.sent_ms + options.rtt_ms;
+      target->in_flight.push_back(request);
+      pending.pop_front();
+    }
+
+    // Share the bandwidth between the connections that are receiving data.
+    int receiving = 0;
+    for (size_t i = 0; i < connections.size(); ++i) {
+      const Connection* connection = connections[i].get();
+      if (!connection->in_flight.empty() &&
+          connection->in_flight.front().ready_ms <= now) {
+        ++receiving;
+      }
+    }
+    for (size_t i = 0; i < connections.size(); ++i) {
+      Connection* connection = connections[i].get();
+      if (connection->in_flight.empty() ||
+          connection->in_flight.front().ready_ms > now) {
+        continue;
+      }
+      InFlight* front = &connection->in_flight.front();
+      if (!connection->headers_seen) {
+        connection->headers_seen = true;
+        int64 size = sizes[front->request];
+        if (mode == ADAPTIVE_DEPTH) {
+          int64 time_to_headers_ms = front->ready_ms - front->sent_ms;
+          if (num_samples == 0) {
+            average_size = size;
+            average_time_to_headers_ms = time_to_headers_ms;
+          } else {
+            average_size += (size - average_size) / 8;
+            average_time_to_headers_ms +=
+                (time_to_headers_ms - average_time_to_headers_ms) / 8;
+          }
+          if (++num_samples >= 4) {
+            depth = net::HttpPipelinedHostImpl::ComputePipelineDepth(
+                average_size,
+                base::TimeDelta::FromMilliseconds(average_time_to_headers_ms));
+          }
+          if (connection->in_flight.size() > 1 &&
+              net::HttpPipelinedHostImpl::IsHeadOfLineBlocking(size)) {
+            // The requests behind the large response go back to the front of
+            // the queue, in order.
+            while (connection->in_flight.size() > 1) {
+              pending.push_front(connection->in_flight.back().request);
+              connection->in_flight.pop_back();
+              ++result->evicted_requests;
+            }
+            connection->usable = false;
+          }
+        }
+      }
+      front->remaining -= bytes_per_step / receiving;
+      if (front->remaining > 0)
+        continue;
+
+      connection->in_flight.pop_front();
+      connection->headers_seen = false;
+      ++completed;
+      if (!connection->in_flight.empty()) {
+        // The server has been sending the next response behind this one.
+        InFlight* next = &connection->in_flight.front();
+        next->ready_ms = std::max(next->ready_ms, now);
+      }
+    }
+
+    for (size_t i = 0; i < connections.size(); ) {
+      if (!connections[i]->usable && connections[i]->in_flight.empty())
+        connections.erase(connections.begin() + i);
+      else
+        ++i;
+    }
+
+    if (completed == sizes.size()) {
+      result->load_time_ms = now + kStepMs;
+      return;
+    }
+  }
+}
+
+void PrintResult(Mode mode, const Result& result) {
+  if (result.load_time_ms < 0) {
+    printf("%-9s did not finish\n", kModeNames[mode]);
+    return;
+  }
+  printf("%-9s load time: %6d ms, connections: %d, evicted requests: %d\n",
+         kModeNames[mode], result.load_time_ms, result.connections,
+         result.evicted_requests);
+}
+
+bool GetIntSwitch(const CommandLine& command_line, const char* name,
+                  int* value) {
+  if (!command_line.HasSwitch(name))
+    return true;
+  return base::StringToInt(command_line.GetSwitchValueASCII(name), value) &&
+      *value > 0;
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+  COMPILE_ASSERT(arraysize(kModeNames) == NUM_MODES, mode_names);
+
+  base::AtExitManager at_exit_manager;
+  CommandLine::Init(argc, argv);
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+
+  Options options;
+  options.rtt_ms = kDefaultRttMs;
+  options.bandwidth_kbps = kDefaultBandwidthKbps;
+  options.connections = kDefaultConnections;
+  if (!GetIntSwitch(command_line, kRttMs, &options.rtt_ms) ||
+      !GetIntSwitch(command_line, kBandwidthKbps, &options.bandwidth_kbps) ||
+      !GetIntSwitch(command_line, kConnections, &options.connections)) {
+    printf("Usage: pipeline_sim [--trace=<file>] [--rtt-ms=<ms>]\n"
+           "                    [--bandwidth-kbps=<kbps>]"
+           " [--connections=<count>]\n");
+    return INVALID_ARGUMENT;
+  }
+
+  std::vector<int64> sizes;
+  FilePath trace_path = command_line.GetSwitchValuePath(kTrace);
+  if (trace_path.empty()) {
+    MakeDefaultPage(&sizes);
+  } else if (!LoadTrace(trace_path, &sizes)) {
+    printf("Unable to read the trace\n");
+    return INVALID_TRACE;
+  }
+
+  printf("%d responses, rtt %d ms, %d kbps, %d connections\n",
+         static_cast<int>(sizes.size()), options.rtt_ms,
+         options.bandwidth_kbps, options.connections);
+  for (int i = 0; i < NUM_MODES; i++) {
+    Mode mode = static_cast<Mode>(i);
+    Result result;
+    Simulate(mode, sizes, options, &result);
+    PrintResult(mode, result);
+  }
+
+  return ALL_GOOD;
+}
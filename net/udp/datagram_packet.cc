@@ -0,0 +1,26 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/udp/datagram_packet.h"
+
+namespace net {
+
+DatagramPacket::DatagramPacket()
+    : buf_len(0),
+      received_len(0) {
+}
+
+DatagramPacket::DatagramPacket(IOBuffer* buf,
+                               int buf_len,
+                               const IPEndPoint& address)
+    : buf(buf),
+      buf_len(buf_len),
+      address(address),
+      received_len(0) {
+}
+
+DatagramPacket::~DatagramPacket() {
+}
+
+}  // namespace net
@@ -0,0 +1,37 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_UDP_DATAGRAM_PACKET_H_
+#define NET_UDP_DATAGRAM_PACKET_H_
+#pragma once
+
+#include "base/memory/ref_counted.h"
+#include "net/base/io_buffer.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+// One datagram of a batch passed to DatagramServerSocket::RecvMultipleFrom()
+// or SendMultipleTo().
+struct NET_EXPORT DatagramPacket {
+  DatagramPacket();
+  DatagramPacket(IOBuffer* buf, int buf_len, const IPEndPoint& address);
+  ~DatagramPacket();
+
+  // For receiving, the buffer to read a datagram into and its size. For
+  // sending, the datagram and its length.
+  scoped_refptr<IOBuffer> buf;
+  int buf_len;
+
+  // The sender of a received datagram, or where to send this one.
+  IPEndPoint address;
+
+  // The number of bytes received into |buf|.
+  int received_len;
+};
+
+}  // namespace net
+
+#endif  // NET_UDP_DATAGRAM_PACKET_H_
@@ -6,7 +6,10 @@
 #define NET_UDP_DATAGRAM_SERVER_SOCKET_H_
 #pragma once
 
+#include <vector>
+
 #include "net/base/completion_callback.h"
+#include "net/udp/datagram_packet.h"
 #include "net/udp/datagram_socket.h"
 
 namespace net {
@@ -55,6 +58,26 @@ class NET_EXPORT DatagramServerSocket : public DatagramSocket {
                      const IPEndPoint& address,
                      const CompletionCallback& callback) = 0;
 
+  // Read several datagrams with one system call where the platform has one.
+  // Each of |packets| gives a buffer to read a datagram into; the |address|
+  // and |received_len| of the ones filled are set.
+  // Returns the number of datagrams read, a net error code, or
+  // ERR_IO_PENDING if none are waiting, in which case |callback| is called
+  // with the number read once some arrive. The caller must keep |packets|
+  // alive until then.
+  virtual int RecvMultipleFrom(std::vector<DatagramPacket>* packets,
+                               const CompletionCallback& callback) = 0;
+
+  // Send |packets| to their addresses with one system call where the
+  // platform has one.
+  // Returns the number of datagrams sent, which is fewer than given when the
+  // send buffer fills up, a net error code if none could be sent, or
+  // ERR_IO_PENDING, in which case |callback| is called with the number sent
+  // once the socket is writable again. The caller must keep |packets| alive
+  // until then.
+  virtual int SendMultipleTo(const std::vector<DatagramPacket>& packets,
+                             const CompletionCallback& callback) = 0;
+
   // Set the receive buffer size (in bytes) for the socket.
   virtual bool SetReceiveBufferSize(int32 size) = 0;
 
@@ -37,6 +37,16 @@ int UDPServerSocket::SendTo(IOBuffer* buf,
   return socket_.SendTo(buf, buf_len, address, callback);
 }
 
+int UDPServerSocket::RecvMultipleFrom(std::vector<DatagramPacket>* packets,
+                                      const CompletionCallback& callback) {
+  return socket_.RecvMultipleFrom(packets, callback);
+}
+
+int UDPServerSocket::SendMultipleTo(const std::vector<DatagramPacket>& packets,
+                                    const CompletionCallback& callback) {
+  return socket_.SendMultipleTo(packets, callback);
+}
+
 bool UDPServerSocket::SetReceiveBufferSize(int32 size) {
   return socket_.SetReceiveBufferSize(size);
 }
@@ -32,6 +32,10 @@ class NET_EXPORT UDPServerSocket : public DatagramServerSocket {
                      int buf_len,
                      const IPEndPoint& address,
                      const CompletionCallback& callback) OVERRIDE;
+  virtual int RecvMultipleFrom(std::vector<DatagramPacket>* packets,
+                               const CompletionCallback& callback) OVERRIDE;
+  virtual int SendMultipleTo(const std::vector<DatagramPacket>& packets,
+                             const CompletionCallback& callback) OVERRIDE;
   virtual bool SetReceiveBufferSize(int32 size) OVERRIDE;
   virtual bool SetSendBufferSize(int32 size) OVERRIDE;
   virtual void Close() OVERRIDE;
@@ -8,6 +8,11 @@
 #include <fcntl.h>
 #include <netdb.h>
 #include <sys/socket.h>
+#if defined(OS_LINUX)
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
 
 #include "base/eintr_wrapper.h"
 #include "base/logging.h"
@@ -30,6 +35,23 @@ static const int kBindRetries = 10;
 static const int kPortStart = 1024;
 static const int kPortEnd = 65535;
 
+// The most datagrams read or written with one system call.
+static const size_t kMaxDatagramBatch = 32;
+
+#if defined(OS_LINUX)
+// The kernel's struct mmsghdr, which older C libraries don't declare.
+struct MultiMsgHdr {
+  struct msghdr msg_hdr;
+  unsigned int msg_len;
+};
+
+// Set when the kernel turns out not to have recvmmsg() or sendmmsg(), so that
+// later calls go straight to one datagram per call. They only ever change to
+// true, so a race between sockets costs at most an extra failing call.
+bool g_recvmmsg_unsupported = false;
+bool g_sendmmsg_unsupported = false;
+#endif
+
 }  // namespace net
 
 namespace net {
@@ -46,7 +68,9 @@ UDPSocketLibevent::UDPSocketLibevent(
           write_watcher_(this),
           read_buf_len_(0),
           recv_from_address_(NULL),
+          recv_packets_(NULL),
           write_buf_len_(0),
+          send_packets_(NULL),
           net_log_(BoundNetLog::Make(net_log, NetLog::SOURCE_UDP_SOCKET)) {
   scoped_refptr<NetLog::EventParameters> params;
   if (source.is_valid())
@@ -72,10 +96,12 @@ void UDPSocketLibevent::Close() {
   read_buf_len_ = 0;
   read_callback_.Reset();
   recv_from_address_ = NULL;
+  recv_packets_ = NULL;
   write_buf_ = NULL;
   write_buf_len_ = 0;
   write_callback_.Reset();
   send_to_address_.reset();
+  send_packets_ = NULL;
 
   bool ok = read_socket_watcher_.StopWatchingFileDescriptor();
   DCHECK(ok);
@@ -169,6 +195,33 @@ int UDPSocketLibevent::RecvFrom(IOBuffer* buf,
   return ERR_IO_PENDING;
 }
 
+int UDPSocketLibevent::RecvMultipleFrom(std::vector<DatagramPacket>* packets,
+                                        const CompletionCallback& callback) {
+  DCHECK(CalledOnValidThread());
+  DCHECK_NE(kInvalidSocket, socket_);
+  DCHECK(read_callback_.is_null());
+  DCHECK(!recv_packets_);
+  DCHECK(!callback.is_null());  // Synchronous operation not supported
+  DCHECK(!packets->empty());
+
+  int result = InternalRecvMultipleFrom(packets);
+  if (result != ERR_IO_PENDING)
+    return result;
+
+  if (!MessageLoopForIO::current()->WatchFileDescriptor(
+          socket_, true, MessageLoopForIO::WATCH_READ,
+          &read_socket_watcher_, &read_watcher_)) {
+    PLOG(ERROR) << "WatchFileDescriptor failed on read";
+    result = MapSystemError(errno);
+    LogRead(result, NULL, 0, NULL);
+    return result;
+  }
+
+  recv_packets_ = packets;
+  read_callback_ = callback;
+  return ERR_IO_PENDING;
+}
+
 int UDPSocketLibevent::Write(IOBuffer* buf,
                              int buf_len,
                              const CompletionCallback& callback) {
@@ -215,6 +268,33 @@ int UDPSocketLibevent::SendToOrWrite(IOBuffer* buf,
   return ERR_IO_PENDING;
 }
 
+int UDPSocketLibevent::SendMultipleTo(
+    const std::vector<DatagramPacket>& packets,
+    const CompletionCallback& callback) {
+  DCHECK(CalledOnValidThread());
+  DCHECK_NE(kInvalidSocket, socket_);
+  DCHECK(write_callback_.is_null());
+  DCHECK(!callback.is_null());  // Synchronous operation not supported
+  DCHECK(!packets.empty());
+
+  int result = InternalSendMultipleTo(packets);
+  if (result != ERR_IO_PENDING)
+    return result;
+
+  if (!MessageLoopForIO::current()->WatchFileDescriptor(
+          socket_, true, MessageLoopForIO::WATCH_WRITE,
+          &write_socket_watcher_, &write_watcher_)) {
+    DVLOG(1) << "WatchFileDescriptor failed on write, errno " << errno;
+    result = MapSystemError(errno);
+    LogWrite(result, NULL, NULL);
+    return result;
+  }
+
+  send_packets_ = &packets;
+  write_callback_ = callback;
+  return ERR_IO_PENDING;
+}
+
 int UDPSocketLibevent::Connect(const IPEndPoint& address) {
   net_log_.BeginEvent(
       NetLog::TYPE_UDP_CONNECT,
@@ -304,11 +384,16 @@ void UDPSocketLibevent::DoWriteCallback(int rv) {
 }
 
 void UDPSocketLibevent::DidCompleteRead() {
-  int result = InternalRecvFrom(read_buf_, read_buf_len_, recv_from_address_);
+  int result;
+  if (recv_packets_)
+    result = InternalRecvMultipleFrom(recv_packets_);
+  else
+    result = InternalRecvFrom(read_buf_, read_buf_len_, recv_from_address_);
   if (result != ERR_IO_PENDING) {
     read_buf_ = NULL;
     read_buf_len_ = 0;
     recv_from_address_ = NULL;
+    recv_packets_ = NULL;
     bool ok = read_socket_watcher_.StopWatchingFileDescriptor();
     DCHECK(ok);
     DoReadCallback(result);
@@ -355,13 +440,19 @@ int UDPSocketLibevent::CreateSocket(const IPEndPoint& address) {
 }
 
 void UDPSocketLibevent::DidCompleteWrite() {
-  int result = InternalSendTo(write_buf_, write_buf_len_,
-                              send_to_address_.get());
+  int result;
+  if (send_packets_) {
+    result = InternalSendMultipleTo(*send_packets_);
+  } else {
+    result = InternalSendTo(write_buf_, write_buf_len_,
+                            send_to_address_.get());
+  }
 
   if (result != ERR_IO_PENDING) {
     write_buf_ = NULL;
     write_buf_len_ = 0;
     send_to_address_.reset();
+    send_packets_ = NULL;
     write_socket_watcher_.StopWatchingFileDescriptor();
     DoWriteCallback(result);
   }
@@ -447,6 +538,119 @@ int UDPSocketLibevent::InternalSendTo(IOBuffer* buf, int buf_len,
   return result;
 }
 
+int UDPSocketLibevent::InternalRecvMultipleFrom(
+    std::vector<DatagramPacket>* packets) {
+  const size_t count = std::min(packets->size(), kMaxDatagramBatch);
+
+#if defined(OS_LINUX) && defined(__NR_recvmmsg)
+  if (!g_recvmmsg_unsupported) {
+    struct sockaddr_storage addr_storage[kMaxDatagramBatch];
+    struct iovec iov[kMaxDatagramBatch];
+    MultiMsgHdr msgs[kMaxDatagramBatch];
+    memset(msgs, 0, sizeof(msgs[0]) * count);
+    for (size_t i = 0; i < count; ++i) {
+      DatagramPacket& packet = (*packets)[i];
+      iov[i].iov_base = packet.buf->data();
+      iov[i].iov_len = packet.buf_len;
+      msgs[i].msg_hdr.msg_name = &addr_storage[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(addr_storage[i]);
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int received = HANDLE_EINTR(
+        syscall(__NR_recvmmsg, socket_, msgs, count, 0, NULL));
+    if (received >= 0) {
+      for (int i = 0; i < received; ++i) {
+        DatagramPacket& packet = (*packets)[i];
+        struct sockaddr* addr =
+            reinterpret_cast<struct sockaddr*>(&addr_storage[i]);
+        socklen_t addr_len = msgs[i].msg_hdr.msg_namelen;
+        if (!packet.address.FromSockAddr(addr, addr_len)) {
+          LogRead(ERR_FAILED, NULL, 0, NULL);
+          return i > 0 ? i : ERR_FAILED;
+        }
+        packet.received_len = msgs[i].msg_len;
+        LogRead(packet.received_len, packet.buf->data(), addr_len, addr);
+      }
+      return received;
+    }
+    if (errno != ENOSYS) {
+      int result = MapSystemError(errno);
+      if (result != ERR_IO_PENDING)
+        LogRead(result, NULL, 0, NULL);
+      return result;
+    }
+    g_recvmmsg_unsupported = true;
+  }
+#endif
+
+  size_t received = 0;
+  for (; received < count; ++received) {
+    DatagramPacket& packet = (*packets)[received];
+    int result = InternalRecvFrom(packet.buf, packet.buf_len, &packet.address);
+    if (result < 0)
+      return received > 0 ? static_cast<int>(received) : result;
+    packet.received_len = result;
+  }
+  return static_cast<int>(received);
+}
+
+int UDPSocketLibevent::InternalSendMultipleTo(
+    const std::vector<DatagramPacket>& packets) {
+  const size_t count = std::min(packets.size(), kMaxDatagramBatch);
+
+#if defined(OS_LINUX) && defined(__NR_sendmmsg)
+  if (!g_sendmmsg_unsupported) {
+    struct sockaddr_storage addr_storage[kMaxDatagramBatch];
+    struct iovec iov[kMaxDatagramBatch];
+    MultiMsgHdr msgs[kMaxDatagramBatch];
+    memset(msgs, 0, sizeof(msgs[0]) * count);
+    for (size_t i = 0; i < count; ++i) {
+      const DatagramPacket& packet = packets[i];
+      size_t addr_len = sizeof(addr_storage[i]);
+      struct sockaddr* addr =
+          reinterpret_cast<struct sockaddr*>(&addr_storage[i]);
+      if (!packet.address.ToSockAddr(addr, &addr_len)) {
+        LogWrite(ERR_FAILED, NULL, NULL);
+        return ERR_FAILED;
+      }
+      iov[i].iov_base = packet.buf->data();
+      iov[i].iov_len = packet.buf_len;
+      msgs[i].msg_hdr.msg_name = addr;
+      msgs[i].msg_hdr.msg_namelen = addr_len;
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int sent = HANDLE_EINTR(syscall(__NR_sendmmsg, socket_, msgs, count, 0));
+    if (sent >= 0) {
+      for (int i = 0; i < sent; ++i) {
+        LogWrite(msgs[i].msg_len, packets[i].buf->data(),
+                 &packets[i].address);
+      }
+      return sent;
+    }
+    if (errno != ENOSYS) {
+      int result = MapSystemError(errno);
+      if (result != ERR_IO_PENDING)
+        LogWrite(result, NULL, NULL);
+      return result;
+    }
+    g_sendmmsg_unsupported = true;
+  }
+#endif
+
+  size_t sent = 0;
+  for (; sent < count; ++sent) {
+    const DatagramPacket& packet = packets[sent];
+    int result = InternalSendTo(packet.buf, packet.buf_len, &packet.address);
+    if (result < 0)
+      return sent > 0 ? static_cast<int>(sent) : result;
+  }
+  return static_cast<int>(sent);
+}
+
 int UDPSocketLibevent::DoBind(const IPEndPoint& address) {
   struct sockaddr_storage addr_storage;
   size_t addr_len = sizeof(addr_storage);
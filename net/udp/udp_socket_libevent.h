@@ -6,6 +6,8 @@
 #define NET_UDP_UDP_SOCKET_LIBEVENT_H_
 #pragma once
 
+#include <vector>
+
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop.h"
@@ -17,6 +19,7 @@
 #include "net/base/io_buffer.h"
 #include "net/base/ip_endpoint.h"
 #include "net/base/net_log.h"
+#include "net/udp/datagram_packet.h"
 #include "net/udp/datagram_socket.h"
 
 namespace net {
@@ -94,6 +97,17 @@ class NET_EXPORT UDPSocketLibevent : public base::NonThreadSafe {
              const IPEndPoint& address,
              const CompletionCallback& callback);
 
+  // Read the datagrams waiting on the socket into |packets|, with one
+  // recvmmsg() call where the kernel supports it. See
+  // DatagramServerSocket::RecvMultipleFrom() for the details.
+  int RecvMultipleFrom(std::vector<DatagramPacket>* packets,
+                       const CompletionCallback& callback);
+
+  // Send |packets|, with one sendmmsg() call where the kernel supports it.
+  // See DatagramServerSocket::SendMultipleTo() for the details.
+  int SendMultipleTo(const std::vector<DatagramPacket>& packets,
+                     const CompletionCallback& callback);
+
   // Set the receive buffer size (in bytes) for the socket.
   bool SetReceiveBufferSize(int32 size);
 
@@ -173,6 +187,8 @@ class NET_EXPORT UDPSocketLibevent : public base::NonThreadSafe {
   int InternalConnect(const IPEndPoint& address);
   int InternalRecvFrom(IOBuffer* buf, int buf_len, IPEndPoint* address);
   int InternalSendTo(IOBuffer* buf, int buf_len, const IPEndPoint* address);
+  int InternalRecvMultipleFrom(std::vector<DatagramPacket>* packets);
+  int InternalSendMultipleTo(const std::vector<DatagramPacket>& packets);
 
   int DoBind(const IPEndPoint& address);
   int RandomBind(const IPEndPoint& address);
@@ -204,11 +220,17 @@ class NET_EXPORT UDPSocketLibevent : public base::NonThreadSafe {
   int read_buf_len_;
   IPEndPoint* recv_from_address_;
 
+  // The packets used to retry a RecvMultipleFrom() request.
+  std::vector<DatagramPacket>* recv_packets_;
+
   // The buffer used by InternalWrite() to retry Write requests
   scoped_refptr<IOBuffer> write_buf_;
   int write_buf_len_;
   scoped_ptr<IPEndPoint> send_to_address_;
 
+  // The packets used to retry a SendMultipleTo() request.
+  const std::vector<DatagramPacket>* send_packets_;
+
   // External callback; called when read is complete.
   CompletionCallback read_callback_;
 
@@ -0,0 +1,139 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times moving small datagrams over loopback one per system call and in
+// batches, the way P2PSocketHostUdp reads and sends them.
+
+#include <string>
+#include <vector>
+
+#include "base/message_loop.h"
+#include "base/perftimer.h"
+#include "net/base/io_buffer.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_errors.h"
+#include "net/base/net_util.h"
+#include "net/base/test_completion_callback.h"
+#include "net/udp/datagram_packet.h"
+#include "net/udp/udp_server_socket.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kNumRounds = 2000;
+// Few enough that a round fits in the default socket buffers.
+const int kPacketsPerRound = 32;
+const int kPacketSize = 200;
+
+class UDPSocketPerfTest : public testing::Test {
+ protected:
+  UDPSocketPerfTest()
+      : sender_(NULL, NetLog::Source()),
+        receiver_(NULL, NetLog::Source()) {
+  }
+
+  virtual void SetUp() OVERRIDE {
+    IPAddressNumber localhost;
+    ASSERT_TRUE(ParseIPLiteralToNumber("127.0.0.1", &localhost));
+    ASSERT_EQ(OK, sender_.Listen(IPEndPoint(localhost, 0)));
+    ASSERT_EQ(OK, receiver_.Listen(IPEndPoint(localhost, 0)));
+    ASSERT_EQ(OK, receiver_.GetLocalAddress(&receiver_address_));
+
+    scoped_refptr<IOBuffer> payload(
+        new StringIOBuffer(std::string(kPacketSize, 'x')));
+    send_packets_.assign(
+        kPacketsPerRound,
+        DatagramPacket(payload, kPacketSize, receiver_address_));
+    recv_packets_.resize(kPacketsPerRound);
+    for (size_t i = 0; i < recv_packets_.size(); ++i) {
+      recv_packets_[i].buf = new IOBuffer(kPacketSize);
+      recv_packets_[i].buf_len = kPacketSize;
+    }
+  }
+
+  // Sends kNumRounds rounds of kPacketsPerRound datagrams and reads each
+  // round back before sending the next, so that none are dropped.
+  void RunRounds(bool batched) {
+    for (int round = 0; round < kNumRounds; ++round) {
+      if (batched) {
+        SendBatched();
+        RecvBatched();
+      } else {
+        SendSingly();
+        RecvSingly();
+      }
+    }
+  }
+
+ private:
+  void SendSingly() {
+    for (int i = 0; i < kPacketsPerRound; ++i) {
+      TestCompletionCallback callback;
+      int rv = sender_.SendTo(send_packets_[i].buf, kPacketSize,
+                              receiver_address_, callback.callback());
+      if (rv == ERR_IO_PENDING)
+        rv = callback.WaitForResult();
+      ASSERT_EQ(kPacketSize, rv);
+    }
+  }
+
+  void SendBatched() {
+    std::vector<DatagramPacket> packets(send_packets_);
+    while (!packets.empty()) {
+      TestCompletionCallback callback;
+      int rv = sender_.SendMultipleTo(packets, callback.callback());
+      if (rv == ERR_IO_PENDING)
+        rv = callback.WaitForResult();
+      ASSERT_GT(rv, 0);
+      packets.erase(packets.begin(), packets.begin() + rv);
+    }
+  }
+
+  void RecvSingly() {
+    for (int i = 0; i < kPacketsPerRound; ++i) {
+      TestCompletionCallback callback;
+      IPEndPoint from;
+      int rv = receiver_.RecvFrom(recv_packets_[0].buf, kPacketSize, &from,
+                                  callback.callback());
+      if (rv == ERR_IO_PENDING)
+        rv = callback.WaitForResult();
+      ASSERT_EQ(kPacketSize, rv);
+    }
+  }
+
+  void RecvBatched() {
+    int received = 0;
+    while (received < kPacketsPerRound) {
+      TestCompletionCallback callback;
+      int rv = receiver_.RecvMultipleFrom(&recv_packets_, callback.callback());
+      if (rv == ERR_IO_PENDING)
+        rv = callback.WaitForResult();
+      ASSERT_GT(rv, 0);
+      received += rv;
+    }
+  }
+
+  MessageLoopForIO message_loop_;
+  UDPServerSocket sender_;
+  UDPServerSocket receiver_;
+  IPEndPoint receiver_address_;
+  std::vector<DatagramPacket> send_packets_;
+  std::vector<DatagramPacket> recv_packets_;
+};
+
+}  // namespace
+
+TEST_F(UDPSocketPerfTest, OnePacketPerCall) {
+  PerfTimeLogger timer("UDPSocketPerfTest.OnePacketPerCall");
+  RunRounds(false);
+}
+
+TEST_F(UDPSocketPerfTest, BatchedPackets) {
+  PerfTimeLogger timer("UDPSocketPerfTest.BatchedPackets");
+  RunRounds(true);
+}
+
+}  // namespace net
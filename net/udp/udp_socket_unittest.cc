@@ -444,6 +444,61 @@ TEST_F(UDPSocketTest, CloseWithPendingRead) {
   EXPECT_FALSE(callback.have_result());
 }
 
+// Send a batch of datagrams between two servers and read them back as a
+// batch, in order and with the right sender.
+TEST_F(UDPSocketTest, SendAndRecvMultiple) {
+  const int kNumPackets = 5;
+  IPEndPoint bind_address;
+  CreateUDPAddress("127.0.0.1", 0, &bind_address);
+  UDPServerSocket sender(NULL, NetLog::Source());
+  EXPECT_EQ(OK, sender.Listen(bind_address));
+  UDPServerSocket receiver(NULL, NetLog::Source());
+  EXPECT_EQ(OK, receiver.Listen(bind_address));
+  IPEndPoint sender_address;
+  EXPECT_EQ(OK, sender.GetLocalAddress(&sender_address));
+  IPEndPoint receiver_address;
+  EXPECT_EQ(OK, receiver.GetLocalAddress(&receiver_address));
+
+  std::vector<std::string> messages;
+  std::vector<DatagramPacket> send_packets;
+  for (int i = 0; i < kNumPackets; ++i) {
+    messages.push_back(std::string(i + 1, 'a' + i));
+    send_packets.push_back(DatagramPacket(new StringIOBuffer(messages.back()),
+                                          messages.back().size(),
+                                          receiver_address));
+  }
+
+  // Platforms without a batched send may send fewer than asked at a time.
+  while (!send_packets.empty()) {
+    TestCompletionCallback callback;
+    int rv = sender.SendMultipleTo(send_packets, callback.callback());
+    if (rv == ERR_IO_PENDING)
+      rv = callback.WaitForResult();
+    ASSERT_GT(rv, 0);
+    send_packets.erase(send_packets.begin(), send_packets.begin() + rv);
+  }
+
+  std::vector<DatagramPacket> recv_packets(kNumPackets);
+  for (size_t i = 0; i < recv_packets.size(); ++i) {
+    recv_packets[i].buf = new IOBuffer(kMaxRead);
+    recv_packets[i].buf_len = kMaxRead;
+  }
+  std::vector<std::string> received;
+  while (received.size() < messages.size()) {
+    TestCompletionCallback callback;
+    int rv = receiver.RecvMultipleFrom(&recv_packets, callback.callback());
+    if (rv == ERR_IO_PENDING)
+      rv = callback.WaitForResult();
+    ASSERT_GT(rv, 0);
+    for (int i = 0; i < rv; ++i) {
+      EXPECT_EQ(sender_address, recv_packets[i].address);
+      received.push_back(std::string(recv_packets[i].buf->data(),
+                                     recv_packets[i].received_len));
+    }
+  }
+  EXPECT_EQ(messages, received);
+}
+
 }  // namespace
 
 }  // namespace net
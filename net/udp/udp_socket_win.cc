@@ -6,6 +6,7 @@
 
 #include <mstcpip.h>
 
+#include "base/bind.h"
 #include "base/eintr_wrapper.h"
 #include "base/logging.h"
 #include "base/message_loop.h"
@@ -31,6 +32,26 @@ static const int kPortEnd = 65535;
 
 namespace net {
 
+namespace {
+
+// Completes a batched read of a single datagram into |packet|.
+void DidRecvSinglePacket(DatagramPacket* packet,
+                         const CompletionCallback& callback,
+                         int result) {
+  if (result >= 0) {
+    packet->received_len = result;
+    result = 1;
+  }
+  callback.Run(result);
+}
+
+// Completes a batched send of a single datagram.
+void DidSendSinglePacket(const CompletionCallback& callback, int result) {
+  callback.Run(result >= 0 ? 1 : result);
+}
+
+}  // namespace
+
 void UDPSocketWin::ReadDelegate::OnObjectSignaled(HANDLE object) {
   DCHECK_EQ(object, socket_->read_overlapped_.hEvent);
   socket_->DidCompleteRead();
@@ -172,6 +193,27 @@ int UDPSocketWin::SendTo(IOBuffer* buf,
   return SendToOrWrite(buf, buf_len, &address, callback);
 }
 
+int UDPSocketWin::RecvMultipleFrom(std::vector<DatagramPacket>* packets,
+                                   const CompletionCallback& callback) {
+  DCHECK(!packets->empty());
+  DatagramPacket* packet = &packets->front();
+  int result = RecvFrom(packet->buf, packet->buf_len, &packet->address,
+                        base::Bind(&DidRecvSinglePacket, packet, callback));
+  if (result < 0)
+    return result;
+  packet->received_len = result;
+  return 1;
+}
+
+int UDPSocketWin::SendMultipleTo(const std::vector<DatagramPacket>& packets,
+                                 const CompletionCallback& callback) {
+  DCHECK(!packets.empty());
+  const DatagramPacket& packet = packets.front();
+  int result = SendTo(packet.buf, packet.buf_len, packet.address,
+                      base::Bind(&DidSendSinglePacket, callback));
+  return result < 0 ? result : 1;
+}
+
 int UDPSocketWin::SendToOrWrite(IOBuffer* buf,
                                 int buf_len,
                                 const IPEndPoint* address,
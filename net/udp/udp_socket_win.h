@@ -8,6 +8,8 @@
 
 #include <winsock2.h>
 
+#include <vector>
+
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/threading/non_thread_safe.h"
@@ -18,6 +20,7 @@
 #include "net/base/ip_endpoint.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_log.h"
+#include "net/udp/datagram_packet.h"
 #include "net/udp/datagram_socket.h"
 
 namespace net {
@@ -95,6 +98,14 @@ class NET_EXPORT UDPSocketWin : NON_EXPORTED_BASE(public base::NonThreadSafe) {
              const IPEndPoint& address,
              const CompletionCallback& callback);
 
+  // Batched versions of RecvFrom() and SendTo(), as described for
+  // DatagramServerSocket. Windows has no call to move several datagrams at
+  // once, so these read or send one datagram at a time.
+  int RecvMultipleFrom(std::vector<DatagramPacket>* packets,
+                       const CompletionCallback& callback);
+  int SendMultipleTo(const std::vector<DatagramPacket>& packets,
+                     const CompletionCallback& callback);
+
   // Set the receive buffer size (in bytes) for the socket.
   bool SetReceiveBufferSize(int32 size);
 
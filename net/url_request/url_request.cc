@@ -17,6 +17,7 @@
 #include "net/base/auth.h"
 #include "net/base/host_port_pair.h"
 #include "net/base/load_flags.h"
+#include "net/base/load_timing_info.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_log.h"
 #include "net/base/network_delegate.h"
@@ -303,6 +304,13 @@ HostPortPair URLRequest::GetSocketAddress() const {
   return job_->GetSocketAddress();
 }
 
+void URLRequest::GetLoadTimingInfo(LoadTimingInfo* load_timing_info) const {
+  *load_timing_info = LoadTimingInfo();
+  if (job_)
+    job_->GetLoadTimingInfo(load_timing_info);
+  load_timing_info->request_start = start_time_;
+}
+
 HttpResponseHeaders* URLRequest::response_headers() const {
   return response_info_.headers.get();
 }
@@ -394,6 +402,7 @@ void URLRequest::set_delegate(Delegate* delegate) {
 void URLRequest::Start() {
   g_url_requests_started = true;
   response_info_.request_time = Time::Now();
+  start_time_ = base::TimeTicks::Now();
 
   // Only notify the delegate for the initial request.
   if (context_ && context_->network_delegate()) {
@@ -79,6 +79,7 @@ class CookieList;
 class CookieOptions;
 class HostPortPair;
 class IOBuffer;
+struct LoadTimingInfo;
 class SSLCertRequestInfo;
 class SSLInfo;
 class UploadData;
@@ -449,6 +450,11 @@ class NET_EXPORT URLRequest : NON_EXPORTED_BASE(public base::NonThreadSafe),
   // http_response_info.h for caveats relating to cached content.
   HostPortPair GetSocketAddress() const;
 
+  // Fills in |load_timing_info| with the timing of the request.  The times
+  // after |request_start| belong to the current job, i.e. to the last leg of
+  // a redirect chain.  This is cheap and always available, unlike the NetLog.
+  void GetLoadTimingInfo(LoadTimingInfo* load_timing_info) const;
+
   // Get all response headers, as a HttpResponseHeaders object.  See comments
   // in HttpResponseHeaders class as to the format of the data.
   HttpResponseHeaders* response_headers() const;
@@ -768,6 +774,9 @@ class NET_EXPORT URLRequest : NON_EXPORTED_BASE(public base::NonThreadSafe),
 
   base::TimeTicks creation_time_;
 
+  // The time Start() was called.
+  base::TimeTicks start_time_;
+
   DISALLOW_COPY_AND_ASSIGN(URLRequest);
 };
 
@@ -16,11 +16,13 @@
 #include "base/metrics/histogram.h"
 #include "base/rand_util.h"
 #include "base/string_util.h"
+#include "base/stringprintf.h"
 #include "base/time.h"
 #include "net/base/cert_status_flags.h"
 #include "net/base/filter.h"
 #include "net/base/host_port_pair.h"
 #include "net/base/load_flags.h"
+#include "net/base/load_timing_info.h"
 #include "net/base/mime_util.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_util.h"
@@ -48,6 +50,94 @@ static const char kAvailDictionaryHeader[] = "Avail-Dictionary";
 
 namespace net {
 
+namespace {
+
+// The load timing histograms are split by these classes of hosts.
+enum LoadTimingHostClass {
+  HOST_CLASS_GOOGLE,
+  HOST_CLASS_SECURE,
+  HOST_CLASS_INSECURE,
+  NUM_HOST_CLASSES
+};
+
+const char* const kLoadTimingHostClassNames[] = {
+  "Google",
+  "Secure",
+  "Insecure"
+};
+COMPILE_ASSERT(arraysize(kLoadTimingHostClassNames) == NUM_HOST_CLASSES,
+               load_timing_host_class_names_mismatch);
+
+enum LoadTimingPhase {
+  PHASE_QUEUE,
+  PHASE_DNS,
+  PHASE_CONNECT,
+  PHASE_SSL,
+  PHASE_SEND,
+  PHASE_WAIT,
+  PHASE_RECEIVE,
+  PHASE_CACHE_READ,
+  NUM_PHASES
+};
+
+const char* const kLoadTimingPhaseNames[] = {
+  "Queue",
+  "Dns",
+  "Connect",
+  "Ssl",
+  "Send",
+  "Wait",
+  "Receive",
+  "CacheRead"
+};
+COMPILE_ASSERT(arraysize(kLoadTimingPhaseNames) == NUM_PHASES,
+               load_timing_phase_names_mismatch);
+
+// Only responses at least this large are used for throughput, smaller ones
+// mostly measure the round trip time.
+const int kMinThroughputResponseBytes = 32 * 1024;
+
+LoadTimingHostClass GetLoadTimingHostClass(const GURL& url) {
+  const std::string& host = url.host();
+  if (host == "google.com" || EndsWith(host, ".google.com", false))
+    return HOST_CLASS_GOOGLE;
+  return url.SchemeIsSecure() ? HOST_CLASS_SECURE : HOST_CLASS_INSECURE;
+}
+
+// Records the time between |start| and |end| when both are known.  The
+// histograms are looked up once, like the UMA_HISTOGRAM macros do.
+void RecordLoadTimingPhase(LoadTimingPhase phase,
+                           LoadTimingHostClass host_class,
+                           const base::TimeTicks& start,
+                           const base::TimeTicks& end) {
+  if (start.is_null() || end.is_null())
+    return;
+
+  static base::Histogram* histograms[NUM_PHASES][NUM_HOST_CLASSES];
+  base::Histogram*& histogram = histograms[phase][host_class];
+  if (!histogram) {
+    histogram = base::Histogram::FactoryTimeGet(
+        base::StringPrintf("Net.LoadTiming.%s_%s",
+                           kLoadTimingPhaseNames[phase],
+                           kLoadTimingHostClassNames[host_class]),
+        base::TimeDelta::FromMilliseconds(1), base::TimeDelta::FromMinutes(3),
+        100, base::Histogram::kUmaTargetedHistogramFlag);
+  }
+  histogram->AddTime(end - start);
+}
+
+// Returns the earliest of the non-null |times|, or a null time.
+base::TimeTicks EarliestTime(const base::TimeTicks* times, size_t count) {
+  base::TimeTicks earliest;
+  for (size_t i = 0; i < count; ++i) {
+    if (!times[i].is_null() && (earliest.is_null() || times[i] < earliest))
+      earliest = times[i];
+  }
+  return earliest;
+}
+
+}  // namespace
+
 class URLRequestHttpJob::HttpFilterContext : public FilterContext {
  public:
   explicit HttpFilterContext(URLRequestHttpJob* job);
@@ -1158,6 +1248,12 @@ HostPortPair URLRequestHttpJob::GetSocketAddress() const {
   return response_info_ ? response_info_->socket_address : HostPortPair();
 }
 
+void URLRequestHttpJob::GetLoadTimingInfo(
+    LoadTimingInfo* load_timing_info) const {
+  if (transaction_.get())
+    transaction_->GetLoadTimingInfo(load_timing_info);
+}
+
 URLRequestHttpJob::~URLRequestHttpJob() {
   CHECK(!awaiting_callback_);
 
@@ -1397,14 +1493,70 @@ void URLRequestHttpJob::RecordPerfHistograms(CompletionCause reason) {
   start_time_ = base::TimeTicks();
 }
 
+void URLRequestHttpJob::RecordLoadTimingHistograms() {
+  if (!request_)
+    return;
+
+  LoadTimingInfo timing;
+  request_->GetLoadTimingInfo(&timing);
+  base::TimeTicks now = base::TimeTicks::Now();
+  LoadTimingHostClass host_class = GetLoadTimingHostClass(request_info_.url);
+  const LoadTimingInfo::ConnectTiming& connect = timing.connect_timing;
+
+  // The request is queued until it starts doing any work of its own.
+  const base::TimeTicks first_work[] = {
+    timing.cache_read_start,
+    connect.dns_start,
+    connect.connect_start,
+    timing.send_start
+  };
+  RecordLoadTimingPhase(PHASE_QUEUE, host_class, timing.request_start,
+                        EarliestTime(first_work, arraysize(first_work)));
+  RecordLoadTimingPhase(PHASE_DNS, host_class, connect.dns_start,
+                        connect.dns_end);
+  RecordLoadTimingPhase(PHASE_CONNECT, host_class, connect.connect_start,
+                        connect.connect_end);
+  RecordLoadTimingPhase(PHASE_SSL, host_class, connect.ssl_start,
+                        connect.ssl_end);
+  RecordLoadTimingPhase(PHASE_SEND, host_class, timing.send_start,
+                        timing.send_end);
+  RecordLoadTimingPhase(PHASE_WAIT, host_class, timing.send_end,
+                        timing.receive_headers_end);
+  RecordLoadTimingPhase(PHASE_RECEIVE, host_class, timing.receive_headers_end,
+                        now);
+  RecordLoadTimingPhase(PHASE_CACHE_READ, host_class, timing.cache_read_start,
+                        timing.cache_read_end);
+
+  if (is_cached_content_ || timing.receive_headers_end.is_null() ||
+      prefilter_bytes_read() < kMinThroughputResponseBytes) {
+    return;
+  }
+  int64 receive_ms = (now - timing.receive_headers_end).InMilliseconds();
+  if (receive_ms <= 0)
+    return;
+
+  static base::Histogram* throughput_histograms[NUM_HOST_CLASSES];
+  base::Histogram*& histogram = throughput_histograms[host_class];
+  if (!histogram) {
+    histogram = base::Histogram::FactoryGet(
+        base::StringPrintf("Net.LoadTiming.ThroughputKBps_%s",
+                           kLoadTimingHostClassNames[host_class]),
+        1, 100000, 50, base::Histogram::kUmaTargetedHistogramFlag);
+  }
+  // Bytes per millisecond are roughly KB per second.
+  histogram->Add(static_cast<int>(prefilter_bytes_read() / receive_ms));
+}
+
 void URLRequestHttpJob::DoneWithRequest(CompletionCause reason) {
   if (done_)
     return;
   done_ = true;
 
   RecordPerfHistograms(reason);
-  if (reason == FINISHED)
+  if (reason == FINISHED) {
+    RecordLoadTimingHistograms();
     RecordCompressionHistograms();
+  }
 }
 
 HttpResponseHeaders* URLRequestHttpJob::GetResponseHeaders() const {
@@ -91,6 +91,8 @@ class URLRequestHttpJob : public URLRequestJob {
   virtual void StopCaching() OVERRIDE;
   virtual void DoneReading() OVERRIDE;
   virtual HostPortPair GetSocketAddress() const OVERRIDE;
+  virtual void GetLoadTimingInfo(
+      LoadTimingInfo* load_timing_info) const OVERRIDE;
   virtual void NotifyURLRequestDestroyed() OVERRIDE;
 
   // Keep a reference to the url request context to be sure it's not deleted
@@ -162,6 +164,8 @@ class URLRequestHttpJob : public URLRequestJob {
   void StartTransactionInternal();
 
   void RecordPerfHistograms(CompletionCause reason);
+  // Breaks the latency of a finished request down by phase and host class.
+  void RecordLoadTimingHistograms();
   void DoneWithRequest(CompletionCause reason);
 
   // Callback functions for Cookie Monster
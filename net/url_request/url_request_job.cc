@@ -210,6 +210,9 @@ HostPortPair URLRequestJob::GetSocketAddress() const {
   return HostPortPair();
 }
 
+void URLRequestJob::GetLoadTimingInfo(LoadTimingInfo* load_timing_info) const {
+}
+
 void URLRequestJob::OnSuspend() {
   Kill();
 }
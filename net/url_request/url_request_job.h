@@ -29,6 +29,7 @@ class CookieOptions;
 class HttpRequestHeaders;
 class HttpResponseInfo;
 class IOBuffer;
+struct LoadTimingInfo;
 class SSLCertRequestInfo;
 class SSLInfo;
 class URLRequest;
@@ -185,6 +186,10 @@ class NET_EXPORT URLRequestJob : public base::RefCounted<URLRequestJob>,
   // See url_request.h for details.
   virtual HostPortPair GetSocketAddress() const;
 
+  // Fills in the parts of |load_timing_info| known to the job.  Only jobs
+  // that go to the network or the cache have anything to report.
+  virtual void GetLoadTimingInfo(LoadTimingInfo* load_timing_info) const;
+
   // base::SystemMonitor::PowerObserver methods:
   // We invoke URLRequestJob::Kill on suspend (crbug.com/4606).
   virtual void OnSuspend() OVERRIDE;
@@ -30,6 +30,7 @@
 #include "net/base/cert_test_util.h"
 #include "net/base/ev_root_ca_metadata.h"
 #include "net/base/load_flags.h"
+#include "net/base/load_timing_info.h"
 #include "net/base/mock_host_resolver.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_log.h"
@@ -1173,6 +1174,38 @@ TEST_F(URLRequestTestHTTP, GetTest_NoCache) {
   }
 }
 
+// Tests that the phases of a request are timed in order.
+TEST_F(URLRequestTestHTTP, GetTest_LoadTimingInfo) {
+  ASSERT_TRUE(test_server_.Start());
+
+  TestDelegate d;
+  {
+    TestURLRequest r(test_server_.GetURL("echo"), &d);
+    r.set_context(default_context_);
+    r.set_load_flags(LOAD_DISABLE_CACHE);
+
+    r.Start();
+    MessageLoop::current()->Run();
+    EXPECT_EQ(1, d.response_started_count());
+
+    LoadTimingInfo load_timing_info;
+    r.GetLoadTimingInfo(&load_timing_info);
+    const LoadTimingInfo::ConnectTiming& connect =
+        load_timing_info.connect_timing;
+    EXPECT_FALSE(load_timing_info.socket_reused);
+    EXPECT_FALSE(load_timing_info.request_start.is_null());
+    EXPECT_LE(load_timing_info.request_start, connect.dns_start);
+    EXPECT_LE(connect.dns_start, connect.dns_end);
+    EXPECT_LE(connect.dns_end, connect.connect_start);
+    EXPECT_LE(connect.connect_start, connect.connect_end);
+    EXPECT_LE(connect.connect_end, load_timing_info.send_start);
+    EXPECT_LE(load_timing_info.send_start, load_timing_info.send_end);
+    EXPECT_LE(load_timing_info.send_end, load_timing_info.receive_headers_end);
+    EXPECT_TRUE(connect.ssl_start.is_null());
+    EXPECT_TRUE(load_timing_info.cache_read_start.is_null());
+  }
+}
+
 TEST_F(URLRequestTestHTTP, GetTest) {
   ASSERT_TRUE(test_server_.Start());
 
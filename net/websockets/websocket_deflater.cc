@@ -0,0 +1,162 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/websockets/websocket_deflater.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+#include "third_party/zlib/zlib.h"
+
+namespace {
+
+// How much output space zlib is given at a time.
+const size_t kOutputChunkSize = 16 * 1024;
+
+// Every sync flush ends with these bytes, which the extension leaves off the
+// wire.
+const char kFlushTrailer[] = { '\x00', '\x00', '\xff', '\xff' };
+
+}  // namespace
+
+namespace net {
+
+WebSocketDeflater::WebSocketDeflater(ContextTakeOverMode mode)
+    : mode_(mode) {
+}
+
+WebSocketDeflater::~WebSocketDeflater() {
+  if (stream_.get())
+    deflateEnd(stream_.get());
+}
+
+bool WebSocketDeflater::Initialize(int window_bits) {
+  DCHECK(!stream_.get());
+  DCHECK_LE(8, window_bits);
+  DCHECK_GE(15, window_bits);
+
+  stream_.reset(new z_stream);
+  memset(stream_.get(), 0, sizeof(z_stream));
+  // A negative window size makes zlib write raw DEFLATE data, with no zlib
+  // header or checksum.
+  int result = deflateInit2(stream_.get(), Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                            -window_bits, 8, Z_DEFAULT_STRATEGY);
+  if (result != Z_OK) {
+    stream_.reset();
+    return false;
+  }
+  return true;
+}
+
+bool WebSocketDeflater::AddBytes(const char* data, size_t size) {
+  DCHECK(stream_.get());
+  if (!size)
+    return true;
+
+  stream_->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  stream_->avail_in = size;
+  return Deflate(Z_NO_FLUSH);
+}
+
+bool WebSocketDeflater::Finish() {
+  DCHECK(stream_.get());
+  stream_->next_in = NULL;
+  stream_->avail_in = 0;
+  if (!Deflate(Z_SYNC_FLUSH))
+    return false;
+
+  DCHECK_GE(output_.size(), sizeof(kFlushTrailer));
+  DCHECK_EQ(0, memcmp(output_.data() + output_.size() - sizeof(kFlushTrailer),
+                      kFlushTrailer, sizeof(kFlushTrailer)));
+  output_.resize(output_.size() - sizeof(kFlushTrailer));
+
+  if (mode_ == DO_NOT_TAKE_OVER_CONTEXT)
+    deflateReset(stream_.get());
+  return true;
+}
+
+void WebSocketDeflater::TakeOutput(std::string* output) {
+  output->clear();
+  output->swap(output_);
+}
+
+bool WebSocketDeflater::Deflate(int flush) {
+  do {
+    size_t old_size = output_.size();
+    output_.resize(old_size + kOutputChunkSize);
+    stream_->next_out = reinterpret_cast<Bytef*>(&output_[old_size]);
+    stream_->avail_out = kOutputChunkSize;
+    int result = deflate(stream_.get(), flush);
+    output_.resize(old_size + kOutputChunkSize - stream_->avail_out);
+    // Z_BUF_ERROR only means there was nothing left to do.
+    if (result != Z_OK && result != Z_BUF_ERROR)
+      return false;
+  } while (stream_->avail_out == 0);
+  DCHECK_EQ(0u, stream_->avail_in);
+  return true;
+}
+
+WebSocketInflater::WebSocketInflater() {
+}
+
+WebSocketInflater::~WebSocketInflater() {
+  if (stream_.get())
+    inflateEnd(stream_.get());
+}
+
+bool WebSocketInflater::Initialize(int window_bits) {
+  DCHECK(!stream_.get());
+  DCHECK_LE(8, window_bits);
+  DCHECK_GE(15, window_bits);
+
+  stream_.reset(new z_stream);
+  memset(stream_.get(), 0, sizeof(z_stream));
+  if (inflateInit2(stream_.get(), -window_bits) != Z_OK) {
+    stream_.reset();
+    return false;
+  }
+  return true;
+}
+
+bool WebSocketInflater::AddBytes(const char* data, size_t size) {
+  DCHECK(stream_.get());
+  if (!size)
+    return true;
+
+  stream_->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  stream_->avail_in = size;
+  return Inflate();
+}
+
+bool WebSocketInflater::Finish() {
+  // Put back the flush trailer the sender left off, so that zlib outputs
+  // everything it has.
+  return AddBytes(kFlushTrailer, sizeof(kFlushTrailer));
+}
+
+void WebSocketInflater::TakeOutput(std::string* output) {
+  output->clear();
+  output->swap(output_);
+}
+
+bool WebSocketInflater::Inflate() {
+  do {
+    size_t old_size = output_.size();
+    output_.resize(old_size + kOutputChunkSize);
+    stream_->next_out = reinterpret_cast<Bytef*>(&output_[old_size]);
+    stream_->avail_out = kOutputChunkSize;
+    int result = inflate(stream_.get(), Z_SYNC_FLUSH);
+    output_.resize(old_size + kOutputChunkSize - stream_->avail_out);
+    if (result == Z_STREAM_END) {
+      // The sender marked a block as the last one. Anything after it starts
+      // a new DEFLATE stream.
+      inflateReset(stream_.get());
+    } else if (result != Z_OK && result != Z_BUF_ERROR) {
+      return false;
+    }
+  } while (stream_->avail_in > 0 || stream_->avail_out == 0);
+  return true;
+}
+
+}  // namespace net
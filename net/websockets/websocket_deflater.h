@@ -0,0 +1,97 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_WEBSOCKETS_WEBSOCKET_DEFLATER_H_
+#define NET_WEBSOCKETS_WEBSOCKET_DEFLATER_H_
+#pragma once
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/net_export.h"
+
+typedef struct z_stream_s z_stream;
+
+namespace net {
+
+// Compresses WebSocket messages for the per-message deflate extension: each
+// message is raw DEFLATE data, flushed at the end of the message with the
+// trailing 0x00 0x00 0xff 0xff removed.
+class NET_EXPORT_PRIVATE WebSocketDeflater {
+ public:
+  enum ContextTakeOverMode {
+    // Start every message with an empty window.
+    DO_NOT_TAKE_OVER_CONTEXT,
+    // Let each message refer back to the earlier ones.
+    TAKE_OVER_CONTEXT,
+  };
+
+  explicit WebSocketDeflater(ContextTakeOverMode mode);
+  ~WebSocketDeflater();
+
+  // Sets up zlib with a window of 2^|window_bits| bytes, which must be
+  // between 8 and 15. Returns false if zlib could not be set up.
+  bool Initialize(int window_bits);
+
+  // Compresses |size| more bytes of the current message.
+  bool AddBytes(const char* data, size_t size);
+
+  // Ends the current message. The zlib context is kept for the next message,
+  // and only reset when it may not be taken over, so no message pays for
+  // setting zlib up again.
+  bool Finish();
+
+  // Moves the compressed output so far into |output|, without copying it.
+  void TakeOutput(std::string* output);
+
+  size_t CurrentOutputSize() const { return output_.size(); }
+
+ private:
+  // Runs deflate() with |flush| until it has no more output.
+  bool Deflate(int flush);
+
+  const ContextTakeOverMode mode_;
+  scoped_ptr<z_stream> stream_;
+  std::string output_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebSocketDeflater);
+};
+
+// Decompresses messages made by a WebSocketDeflater, or by the peer's
+// implementation of the extension.
+class NET_EXPORT_PRIVATE WebSocketInflater {
+ public:
+  WebSocketInflater();
+  ~WebSocketInflater();
+
+  // Sets up zlib for a window of 2^|window_bits| bytes, which must be
+  // between 8 and 15. Returns false if zlib could not be set up.
+  bool Initialize(int window_bits);
+
+  // Decompresses |size| more bytes of the current message. Returns false if
+  // they are not valid DEFLATE data.
+  bool AddBytes(const char* data, size_t size);
+
+  // Ends the current message. Returns false if it was not valid.
+  bool Finish();
+
+  // Moves the decompressed output so far into |output|, without copying it.
+  void TakeOutput(std::string* output);
+
+  size_t CurrentOutputSize() const { return output_.size(); }
+
+ private:
+  // Runs inflate() over the pending input until it is all consumed.
+  bool Inflate();
+
+  scoped_ptr<z_stream> stream_;
+  std::string output_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebSocketInflater);
+};
+
+}  // namespace net
+
+#endif  // NET_WEBSOCKETS_WEBSOCKET_DEFLATER_H_
@@ -0,0 +1,108 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/websockets/websocket_deflater.h"
+
+#include <algorithm>
+#include <string>
+
+#include "base/rand_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+// Compresses |message| as one message and returns the result.
+std::string Deflate(WebSocketDeflater* deflater, const std::string& message) {
+  EXPECT_TRUE(deflater->AddBytes(message.data(), message.size()));
+  EXPECT_TRUE(deflater->Finish());
+  std::string output;
+  deflater->TakeOutput(&output);
+  return output;
+}
+
+std::string Inflate(WebSocketInflater* inflater, const std::string& message) {
+  EXPECT_TRUE(inflater->AddBytes(message.data(), message.size()));
+  EXPECT_TRUE(inflater->Finish());
+  std::string output;
+  inflater->TakeOutput(&output);
+  return output;
+}
+
+}  // namespace
+
+// The examples from the per-message compression draft.
+TEST(WebSocketDeflaterTest, CompressHello) {
+  WebSocketDeflater deflater(WebSocketDeflater::TAKE_OVER_CONTEXT);
+  ASSERT_TRUE(deflater.Initialize(15));
+
+  EXPECT_EQ(std::string("\xf2\x48\xcd\xc9\xc9\x07\x00", 7),
+            Deflate(&deflater, "Hello"));
+  // The second message refers back to the first.
+  EXPECT_EQ(std::string("\xf2\x00\x11\x00\x00", 5),
+            Deflate(&deflater, "Hello"));
+}
+
+TEST(WebSocketDeflaterTest, CompressWithoutContextTakeOver) {
+  WebSocketDeflater deflater(WebSocketDeflater::DO_NOT_TAKE_OVER_CONTEXT);
+  ASSERT_TRUE(deflater.Initialize(15));
+
+  const std::string first = Deflate(&deflater, "Hello");
+  EXPECT_EQ(std::string("\xf2\x48\xcd\xc9\xc9\x07\x00", 7), first);
+  EXPECT_EQ(first, Deflate(&deflater, "Hello"));
+}
+
+TEST(WebSocketDeflaterTest, CompressEmptyMessage) {
+  WebSocketDeflater deflater(WebSocketDeflater::TAKE_OVER_CONTEXT);
+  ASSERT_TRUE(deflater.Initialize(15));
+  EXPECT_EQ(std::string("\x00", 1), Deflate(&deflater, ""));
+}
+
+TEST(WebSocketInflaterTest, DecompressHello) {
+  WebSocketInflater inflater;
+  ASSERT_TRUE(inflater.Initialize(15));
+  EXPECT_EQ("Hello",
+            Inflate(&inflater, std::string("\xf2\x48\xcd\xc9\xc9\x07\x00", 7)));
+  EXPECT_EQ("Hello", Inflate(&inflater, std::string("\xf2\x00\x11\x00\x00",
+                                                    5)));
+}
+
+TEST(WebSocketInflaterTest, RejectsInvalidData) {
+  WebSocketInflater inflater;
+  ASSERT_TRUE(inflater.Initialize(15));
+  // 0xff starts a block of the reserved type 3.
+  const std::string invalid("\xff\xff\xff\xff", 4);
+  EXPECT_FALSE(inflater.AddBytes(invalid.data(), invalid.size()));
+}
+
+// Messages larger than zlib's output chunks survive a round trip, whether
+// they are added at once or in pieces.
+TEST(WebSocketDeflaterTest, RoundTripLargeMessages) {
+  WebSocketDeflater deflater(WebSocketDeflater::TAKE_OVER_CONTEXT);
+  ASSERT_TRUE(deflater.Initialize(15));
+  WebSocketInflater inflater;
+  ASSERT_TRUE(inflater.Initialize(15));
+
+  // Half random bytes, which don't compress, and half repeated text.
+  std::string message = base::RandBytesAsString(100 * 1024);
+  for (int i = 0; i < 10000; ++i)
+    message += "0123456789";
+
+  for (int round = 0; round < 3; ++round) {
+    const size_t kPieceSize = 1000 * (round + 1);
+    for (size_t offset = 0; offset < message.size(); offset += kPieceSize) {
+      size_t size = std::min(kPieceSize, message.size() - offset);
+      ASSERT_TRUE(deflater.AddBytes(message.data() + offset, size));
+    }
+    ASSERT_TRUE(deflater.Finish());
+    std::string compressed;
+    deflater.TakeOutput(&compressed);
+    EXPECT_LT(compressed.size(), message.size());
+
+    EXPECT_EQ(message, Inflate(&inflater, compressed));
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,177 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/websockets/websocket_frame.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+#include "base/rand_util.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+
+namespace {
+
+const uint8 kFinalBit = 0x80;
+const uint8 kReserved1Bit = 0x40;
+const uint8 kReserved2Bit = 0x20;
+const uint8 kReserved3Bit = 0x10;
+const uint8 kOpCodeMask = 0x0F;
+const uint8 kMaskBit = 0x80;
+const uint64 kMaxPayloadLengthWithoutExtendedLengthField = 125;
+const uint64 kPayloadLengthWithTwoByteExtendedLengthField = 126;
+const uint64 kPayloadLengthWithEightByteExtendedLengthField = 127;
+
+}  // namespace
+
+namespace net {
+
+const WebSocketFrameHeader::OpCode WebSocketFrameHeader::kOpCodeContinuation =
+    0x0;
+const WebSocketFrameHeader::OpCode WebSocketFrameHeader::kOpCodeText = 0x1;
+const WebSocketFrameHeader::OpCode WebSocketFrameHeader::kOpCodeBinary = 0x2;
+const WebSocketFrameHeader::OpCode WebSocketFrameHeader::kOpCodeClose = 0x8;
+const WebSocketFrameHeader::OpCode WebSocketFrameHeader::kOpCodePing = 0x9;
+const WebSocketFrameHeader::OpCode WebSocketFrameHeader::kOpCodePong = 0xA;
+
+const uint64 WebSocketFrameHeader::kMaxControlFramePayloadLength = 125;
+
+const int WebSocketFrameHeader::kBaseHeaderSize = 2;
+const int WebSocketFrameHeader::kMaximumExtendedLengthSize = 8;
+const int WebSocketFrameHeader::kMaskingKeyLength = 4;
+const int WebSocketFrameHeader::kMaxHeaderSize = 14;
+
+WebSocketFrameHeader::WebSocketFrameHeader()
+    : final(false),
+      reserved1(false),
+      reserved2(false),
+      reserved3(false),
+      opcode(kOpCodeContinuation),
+      masked(false),
+      payload_length(0) {
+}
+
+WebSocketFrameChunk::WebSocketFrameChunk() : final_chunk(false) {
+}
+
+WebSocketFrameChunk::~WebSocketFrameChunk() {
+}
+
+int GetWebSocketFrameHeaderSize(const WebSocketFrameHeader& header) {
+  int extended_length_size = 0;
+  if (header.payload_length > kMaxPayloadLengthWithoutExtendedLengthField &&
+      header.payload_length <= kuint16max) {
+    extended_length_size = 2;
+  } else if (header.payload_length > kuint16max) {
+    extended_length_size = 8;
+  }
+
+  return WebSocketFrameHeader::kBaseHeaderSize + extended_length_size +
+      (header.masked ? WebSocketFrameHeader::kMaskingKeyLength : 0);
+}
+
+int WriteWebSocketFrameHeader(const WebSocketFrameHeader& header,
+                              const WebSocketMaskingKey* masking_key,
+                              char* buffer,
+                              int buffer_size) {
+  DCHECK((header.opcode & kOpCodeMask) == header.opcode)
+      << "header.opcode must fit to kOpCodeMask.";
+  DCHECK(header.payload_length <= static_cast<uint64>(kint64max))
+      << "WebSocket specification doesn't allow a frame longer than "
+      << "kint64max (0x7FFFFFFFFFFFFFFF) bytes.";
+  DCHECK_EQ(header.masked, masking_key != NULL);
+
+  int header_size = GetWebSocketFrameHeaderSize(header);
+  if (header_size > buffer_size)
+    return ERR_INVALID_ARGUMENT;
+
+  int buffer_index = 0;
+
+  uint8 first_byte = 0u;
+  first_byte |= header.final ? kFinalBit : 0u;
+  first_byte |= header.reserved1 ? kReserved1Bit : 0u;
+  first_byte |= header.reserved2 ? kReserved2Bit : 0u;
+  first_byte |= header.reserved3 ? kReserved3Bit : 0u;
+  first_byte |= header.opcode;
+  buffer[buffer_index++] = first_byte;
+
+  uint8 second_byte = header.masked ? kMaskBit : 0u;
+  int extended_length_size = 0;
+  if (header.payload_length <= kMaxPayloadLengthWithoutExtendedLengthField) {
+    second_byte |= header.payload_length;
+  } else if (header.payload_length <= kuint16max) {
+    second_byte |= kPayloadLengthWithTwoByteExtendedLengthField;
+    extended_length_size = 2;
+  } else {
+    second_byte |= kPayloadLengthWithEightByteExtendedLengthField;
+    extended_length_size = 8;
+  }
+  buffer[buffer_index++] = second_byte;
+
+  // The extended length is in network byte order.
+  for (int i = extended_length_size - 1; i >= 0; --i) {
+    buffer[buffer_index++] =
+        static_cast<char>((header.payload_length >> (8 * i)) & 0xFF);
+  }
+
+  if (header.masked) {
+    memcpy(&buffer[buffer_index], masking_key->key,
+           WebSocketFrameHeader::kMaskingKeyLength);
+    buffer_index += WebSocketFrameHeader::kMaskingKeyLength;
+  }
+
+  DCHECK_EQ(header_size, buffer_index);
+  return header_size;
+}
+
+WebSocketMaskingKey GenerateWebSocketMaskingKey() {
+  WebSocketMaskingKey masking_key;
+  base::RandBytes(masking_key.key, WebSocketFrameHeader::kMaskingKeyLength);
+  return masking_key;
+}
+
+void MaskWebSocketFramePayload(const WebSocketMaskingKey& masking_key,
+                               uint64 frame_offset,
+                               char* data,
+                               int data_size) {
+  static const int kMaskingKeyLength = WebSocketFrameHeader::kMaskingKeyLength;
+  // The word size is a multiple of the key length, so a word of the key
+  // starting at any offset lines up with every word of the payload.
+  typedef uintptr_t PackedMaskType;
+  COMPILE_ASSERT(sizeof(PackedMaskType) % kMaskingKeyLength == 0,
+                 word_size_must_be_a_multiple_of_the_masking_key_length);
+
+  char* const end = data + data_size;
+  int key_offset = static_cast<int>(frame_offset % kMaskingKeyLength);
+
+  // Mask single bytes up to the first word boundary.
+  while (data < end &&
+         reinterpret_cast<uintptr_t>(data) % sizeof(PackedMaskType) != 0) {
+    *data++ ^= masking_key.key[key_offset];
+    key_offset = (key_offset + 1) % kMaskingKeyLength;
+  }
+
+  if (end - data >= static_cast<ptrdiff_t>(sizeof(PackedMaskType))) {
+    char packed_key_bytes[sizeof(PackedMaskType)];
+    for (size_t i = 0; i < sizeof(PackedMaskType); ++i) {
+      packed_key_bytes[i] =
+          masking_key.key[(key_offset + i) % kMaskingKeyLength];
+    }
+    PackedMaskType packed_key;
+    memcpy(&packed_key, packed_key_bytes, sizeof(packed_key));
+
+    char* const word_end =
+        data + ((end - data) & ~(sizeof(PackedMaskType) - 1));
+    for (; data < word_end; data += sizeof(PackedMaskType))
+      *reinterpret_cast<PackedMaskType*>(data) ^= packed_key;
+  }
+
+  // Whole words leave |key_offset| unchanged, so the tail picks up from it.
+  while (data < end) {
+    *data++ ^= masking_key.key[key_offset];
+    key_offset = (key_offset + 1) % kMaskingKeyLength;
+  }
+}
+
+}  // namespace net
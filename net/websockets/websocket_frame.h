@@ -0,0 +1,102 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_WEBSOCKETS_WEBSOCKET_FRAME_H_
+#define NET_WEBSOCKETS_WEBSOCKET_FRAME_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+class IOBufferWithSize;
+
+// The header of a WebSocket frame, as described in RFC 6455, section 5.2.
+struct NET_EXPORT_PRIVATE WebSocketFrameHeader {
+  typedef int OpCode;
+  static const OpCode kOpCodeContinuation;
+  static const OpCode kOpCodeText;
+  static const OpCode kOpCodeBinary;
+  static const OpCode kOpCodeClose;
+  static const OpCode kOpCodePing;
+  static const OpCode kOpCodePong;
+
+  // The largest payload a control frame may carry.
+  static const uint64 kMaxControlFramePayloadLength;
+
+  // The size of the frame header's fixed part, and its largest size.
+  static const int kBaseHeaderSize;
+  static const int kMaximumExtendedLengthSize;
+  static const int kMaskingKeyLength;
+  static const int kMaxHeaderSize;
+
+  WebSocketFrameHeader();
+
+  // Control frames (close, ping and pong) have opcodes 8 and up.
+  bool IsControlFrame() const { return (opcode & 0x08) != 0; }
+
+  bool final;
+  bool reserved1;
+  bool reserved2;
+  bool reserved3;
+  OpCode opcode;
+  bool masked;
+  uint64 payload_length;
+};
+
+// A piece of a frame's payload, in the order the frames arrived. The first
+// chunk of every frame carries the frame's |header|; later chunks of the same
+// frame have none. A frame with an empty payload is one chunk with a header,
+// no |data| and |final_chunk| set.
+struct NET_EXPORT_PRIVATE WebSocketFrameChunk {
+  WebSocketFrameChunk();
+  ~WebSocketFrameChunk();
+
+  scoped_ptr<WebSocketFrameHeader> header;
+
+  // Whether this chunk ends its frame.
+  bool final_chunk;
+
+  // The unmasked payload bytes of this chunk.
+  scoped_refptr<IOBufferWithSize> data;
+};
+
+struct NET_EXPORT_PRIVATE WebSocketMaskingKey {
+  char key[4];
+};
+
+// Returns the number of bytes WriteWebSocketFrameHeader() writes for
+// |header|.
+NET_EXPORT_PRIVATE int GetWebSocketFrameHeaderSize(
+    const WebSocketFrameHeader& header);
+
+// Writes the wire form of |header| into |buffer|, which has room for
+// |buffer_size| bytes. |masking_key| must be given exactly when
+// |header.masked| is set. Returns the number of bytes written, or
+// ERR_INVALID_ARGUMENT if |buffer| is too small.
+NET_EXPORT_PRIVATE int WriteWebSocketFrameHeader(
+    const WebSocketFrameHeader& header,
+    const WebSocketMaskingKey* masking_key,
+    char* buffer,
+    int buffer_size);
+
+// Returns a random masking key, as clients must use for every frame they
+// send.
+NET_EXPORT_PRIVATE WebSocketMaskingKey GenerateWebSocketMaskingKey();
+
+// Masks or unmasks, in place, the |data_size| bytes at |data|, which start
+// |frame_offset| bytes into their frame's payload. Works a machine word at a
+// time, so that large payloads cost little more than a copy.
+NET_EXPORT_PRIVATE void MaskWebSocketFramePayload(
+    const WebSocketMaskingKey& masking_key,
+    uint64 frame_offset,
+    char* data,
+    int data_size);
+
+}  // namespace net
+
+#endif  // NET_WEBSOCKETS_WEBSOCKET_FRAME_H_
@@ -0,0 +1,188 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/websockets/websocket_frame_parser.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/io_buffer.h"
+
+namespace {
+
+const uint8 kFinalBit = 0x80;
+const uint8 kReserved1Bit = 0x40;
+const uint8 kReserved2Bit = 0x20;
+const uint8 kReserved3Bit = 0x10;
+const uint8 kOpCodeMask = 0x0F;
+const uint8 kMaskBit = 0x80;
+const uint8 kPayloadLengthMask = 0x7F;
+const uint64 kPayloadLengthWithTwoByteExtendedLengthField = 126;
+const uint64 kPayloadLengthWithEightByteExtendedLengthField = 127;
+
+}  // namespace
+
+namespace net {
+
+WebSocketFrameParser::WebSocketFrameParser()
+    : in_frame_(false),
+      header_pending_(false),
+      frame_offset_(0),
+      failed_(false) {
+  memset(masking_key_.key, 0, sizeof(masking_key_.key));
+}
+
+WebSocketFrameParser::~WebSocketFrameParser() {
+}
+
+bool WebSocketFrameParser::Decode(
+    IOBuffer* buffer,
+    int size,
+    ScopedVector<WebSocketFrameChunk>* frame_chunks) {
+  if (failed_)
+    return false;
+
+  const char* const data = buffer->data();
+  int offset = 0;
+  while (offset < size) {
+    if (!in_frame_) {
+      int consumed;
+      if (incomplete_header_buffer_.empty()) {
+        int header_size = DecodeFrameHeader(data + offset, size - offset);
+        if (header_size < 0) {
+          failed_ = true;
+          return false;
+        }
+        if (header_size == 0) {
+          incomplete_header_buffer_.assign(data + offset, data + size);
+          return true;
+        }
+        consumed = header_size;
+      } else {
+        int buffered = incomplete_header_buffer_.size();
+        int to_buffer = std::min(size - offset,
+                                 WebSocketFrameHeader::kMaxHeaderSize -
+                                     buffered);
+        incomplete_header_buffer_.insert(incomplete_header_buffer_.end(),
+                                         data + offset,
+                                         data + offset + to_buffer);
+        int header_size = DecodeFrameHeader(&incomplete_header_buffer_[0],
+                                            incomplete_header_buffer_.size());
+        if (header_size < 0) {
+          failed_ = true;
+          return false;
+        }
+        if (header_size == 0)
+          return true;
+        consumed = header_size - buffered;
+        incomplete_header_buffer_.clear();
+      }
+      offset += consumed;
+      in_frame_ = true;
+      header_pending_ = true;
+      frame_offset_ = 0;
+
+      // A frame without payload is complete as soon as its header is.
+      if (current_frame_header_.payload_length == 0)
+        frame_chunks->push_back(MakeChunk(buffer, offset, 0));
+      continue;
+    }
+
+    uint64 remaining = current_frame_header_.payload_length - frame_offset_;
+    int chunk_size = static_cast<int>(
+        std::min(static_cast<uint64>(size - offset), remaining));
+    frame_chunks->push_back(MakeChunk(buffer, offset, chunk_size));
+    offset += chunk_size;
+  }
+  return true;
+}
+
+int WebSocketFrameParser::DecodeFrameHeader(const char* data, int size) {
+  if (size < WebSocketFrameHeader::kBaseHeaderSize)
+    return 0;
+
+  const uint8* bytes = reinterpret_cast<const uint8*>(data);
+  const uint8 first_byte = bytes[0];
+  const uint8 second_byte = bytes[1];
+  const bool masked = (second_byte & kMaskBit) != 0;
+  uint64 payload_length = second_byte & kPayloadLengthMask;
+
+  int extended_length_size = 0;
+  if (payload_length == kPayloadLengthWithTwoByteExtendedLengthField)
+    extended_length_size = 2;
+  else if (payload_length == kPayloadLengthWithEightByteExtendedLengthField)
+    extended_length_size = 8;
+
+  const int header_size = WebSocketFrameHeader::kBaseHeaderSize +
+      extended_length_size +
+      (masked ? WebSocketFrameHeader::kMaskingKeyLength : 0);
+  if (size < header_size)
+    return 0;
+
+  int index = WebSocketFrameHeader::kBaseHeaderSize;
+  if (extended_length_size > 0) {
+    payload_length = 0;
+    for (int i = 0; i < extended_length_size; ++i)
+      payload_length = (payload_length << 8) | bytes[index++];
+    // The most significant bit of a 64-bit length must be 0.
+    if (payload_length > static_cast<uint64>(kint64max))
+      return -1;
+  }
+
+  WebSocketFrameHeader header;
+  header.final = (first_byte & kFinalBit) != 0;
+  header.reserved1 = (first_byte & kReserved1Bit) != 0;
+  header.reserved2 = (first_byte & kReserved2Bit) != 0;
+  header.reserved3 = (first_byte & kReserved3Bit) != 0;
+  header.opcode = first_byte & kOpCodeMask;
+  header.masked = masked;
+  header.payload_length = payload_length;
+
+  // Control frames may not be fragmented, and must be short.
+  if (header.IsControlFrame() &&
+      (!header.final ||
+       payload_length > WebSocketFrameHeader::kMaxControlFramePayloadLength)) {
+    return -1;
+  }
+
+  if (masked) {
+    memcpy(masking_key_.key, data + index,
+           WebSocketFrameHeader::kMaskingKeyLength);
+    index += WebSocketFrameHeader::kMaskingKeyLength;
+  }
+  DCHECK_EQ(header_size, index);
+
+  current_frame_header_ = header;
+  return header_size;
+}
+
+WebSocketFrameChunk* WebSocketFrameParser::MakeChunk(IOBuffer* buffer,
+                                                     int offset,
+                                                     int chunk_size) {
+  DCHECK(in_frame_);
+  scoped_ptr<WebSocketFrameChunk> chunk(new WebSocketFrameChunk);
+  if (header_pending_) {
+    chunk->header.reset(new WebSocketFrameHeader(current_frame_header_));
+    header_pending_ = false;
+  }
+
+  if (chunk_size > 0) {
+    chunk->data = new IOBufferSlice(buffer, offset, chunk_size);
+    if (current_frame_header_.masked) {
+      MaskWebSocketFramePayload(masking_key_, frame_offset_,
+                                chunk->data->data(), chunk_size);
+    }
+  }
+
+  frame_offset_ += chunk_size;
+  chunk->final_chunk = frame_offset_ == current_frame_header_.payload_length;
+  if (chunk->final_chunk)
+    in_frame_ = false;
+  return chunk.release();
+}
+
+}  // namespace net
@@ -0,0 +1,73 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_WEBSOCKETS_WEBSOCKET_FRAME_PARSER_H_
+#define NET_WEBSOCKETS_WEBSOCKET_FRAME_PARSER_H_
+#pragma once
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_vector.h"
+#include "net/base/net_export.h"
+#include "net/websockets/websocket_frame.h"
+
+namespace net {
+
+class IOBuffer;
+
+// Splits the byte stream of a WebSocket connection into frames, as it is read
+// from the network. Payloads are handed out as they arrive rather than once a
+// frame is complete, so a large message is never reassembled by the parser.
+class NET_EXPORT_PRIVATE WebSocketFrameParser {
+ public:
+  WebSocketFrameParser();
+  ~WebSocketFrameParser();
+
+  // Parses the first |size| bytes of |buffer| and appends the frame chunks
+  // they complete to |frame_chunks|. A frame header split between calls is
+  // kept until the rest arrives. Payload chunks refer to |buffer| instead of
+  // copying it, and masked payloads are unmasked in place.
+  // Returns false, and leaves the parser failed, if the data breaks the
+  // framing rules.
+  bool Decode(IOBuffer* buffer,
+              int size,
+              ScopedVector<WebSocketFrameChunk>* frame_chunks);
+
+  // Whether a previous Decode() failed. Later calls fail straight away.
+  bool failed() const { return failed_; }
+
+ private:
+  // Parses a frame header from the |size| bytes at |data| into
+  // |current_frame_header_|. Returns the header's length, 0 if |size| bytes
+  // don't hold the whole header, or -1 if the header is invalid.
+  int DecodeFrameHeader(const char* data, int size);
+
+  // Returns the next chunk of the current frame, made of the |chunk_size|
+  // bytes at |offset| in |buffer|.
+  WebSocketFrameChunk* MakeChunk(IOBuffer* buffer, int offset, int chunk_size);
+
+  // The bytes of a frame header which a read ended in the middle of.
+  std::vector<char> incomplete_header_buffer_;
+
+  // The header of the frame whose payload is being read, if any.
+  WebSocketFrameHeader current_frame_header_;
+  WebSocketMaskingKey masking_key_;
+  bool in_frame_;
+
+  // Whether the next chunk is the first of its frame, and so carries the
+  // header.
+  bool header_pending_;
+
+  // How much of the current frame's payload has been handed out.
+  uint64 frame_offset_;
+
+  bool failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebSocketFrameParser);
+};
+
+}  // namespace net
+
+#endif  // NET_WEBSOCKETS_WEBSOCKET_FRAME_PARSER_H_
@@ -0,0 +1,188 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/websockets/websocket_frame_parser.h"
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_vector.h"
+#include "net/base/io_buffer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const char kHello[] = "Hello, world!";
+const int kHelloLength = arraysize(kHello) - 1;
+const char kHelloFrame[] = "\x81\x0DHello, world!";
+const int kHelloFrameLength = arraysize(kHelloFrame) - 1;
+const char kMaskedHelloFrame[] =
+    "\x81\x8D\xDE\xAD\xBE\xEF"
+    "\x96\xC8\xD2\x83\xB1\x81\x9E\x98\xB1\xDF\xD2\x8B\xFF";
+const int kMaskedHelloFrameLength = arraysize(kMaskedHelloFrame) - 1;
+
+// Returns a buffer holding a copy of the |size| bytes at |data|.
+scoped_refptr<IOBuffer> MakeBuffer(const char* data, int size) {
+  scoped_refptr<IOBuffer> buffer(new IOBuffer(size));
+  memcpy(buffer->data(), data, size);
+  return buffer;
+}
+
+// Joins the payloads of |frame_chunks|.
+std::string JoinPayloads(const ScopedVector<WebSocketFrameChunk>& chunks) {
+  std::string payload;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    if (chunks[i]->data)
+      payload.append(chunks[i]->data->data(), chunks[i]->data->size());
+  }
+  return payload;
+}
+
+}  // namespace
+
+TEST(WebSocketFrameParserTest, DecodeNormalFrame) {
+  WebSocketFrameParser parser;
+  scoped_refptr<IOBuffer> buffer(MakeBuffer(kHelloFrame, kHelloFrameLength));
+
+  ScopedVector<WebSocketFrameChunk> frames;
+  EXPECT_TRUE(parser.Decode(buffer, kHelloFrameLength, &frames));
+  EXPECT_FALSE(parser.failed());
+  ASSERT_EQ(1u, frames.size());
+  const WebSocketFrameChunk* frame = frames[0];
+  ASSERT_TRUE(frame->header.get());
+  EXPECT_TRUE(frame->header->final);
+  EXPECT_EQ(WebSocketFrameHeader::kOpCodeText, frame->header->opcode);
+  EXPECT_FALSE(frame->header->masked);
+  EXPECT_EQ(static_cast<uint64>(kHelloLength), frame->header->payload_length);
+  EXPECT_TRUE(frame->final_chunk);
+  ASSERT_TRUE(frame->data);
+  EXPECT_EQ(std::string(kHello, kHelloLength),
+            std::string(frame->data->data(), frame->data->size()));
+
+  // The payload refers to the buffer that was read instead of a copy.
+  EXPECT_EQ(buffer->data() + 2, frame->data->data());
+}
+
+TEST(WebSocketFrameParserTest, DecodeMaskedFrame) {
+  WebSocketFrameParser parser;
+  scoped_refptr<IOBuffer> buffer(
+      MakeBuffer(kMaskedHelloFrame, kMaskedHelloFrameLength));
+
+  ScopedVector<WebSocketFrameChunk> frames;
+  EXPECT_TRUE(parser.Decode(buffer, kMaskedHelloFrameLength, &frames));
+  ASSERT_EQ(1u, frames.size());
+  ASSERT_TRUE(frames[0]->header.get());
+  EXPECT_TRUE(frames[0]->header->masked);
+  EXPECT_EQ(std::string(kHello, kHelloLength), JoinPayloads(frames));
+}
+
+// Feed a masked frame one byte at a time, so that both the header and the
+// payload are split at every possible place.
+TEST(WebSocketFrameParserTest, DecodeFrameSplitIntoBytes) {
+  WebSocketFrameParser parser;
+  ScopedVector<WebSocketFrameChunk> frames;
+  for (int i = 0; i < kMaskedHelloFrameLength; ++i) {
+    scoped_refptr<IOBuffer> buffer(MakeBuffer(&kMaskedHelloFrame[i], 1));
+    EXPECT_TRUE(parser.Decode(buffer, 1, &frames));
+  }
+
+  ASSERT_EQ(static_cast<size_t>(kHelloLength), frames.size());
+  ASSERT_TRUE(frames[0]->header.get());
+  for (size_t i = 1; i < frames.size(); ++i)
+    EXPECT_FALSE(frames[i]->header.get());
+  for (size_t i = 0; i + 1 < frames.size(); ++i)
+    EXPECT_FALSE(frames[i]->final_chunk);
+  EXPECT_TRUE(frames[frames.size() - 1]->final_chunk);
+  EXPECT_EQ(std::string(kHello, kHelloLength), JoinPayloads(frames));
+}
+
+TEST(WebSocketFrameParserTest, DecodeSeveralFramesInOneRead) {
+  std::string input;
+  input.append(kHelloFrame, kHelloFrameLength);
+  input.append("\x89\x00", 2);  // An empty ping.
+  input.append(kMaskedHelloFrame, kMaskedHelloFrameLength);
+
+  WebSocketFrameParser parser;
+  scoped_refptr<IOBuffer> buffer(MakeBuffer(input.data(), input.size()));
+  ScopedVector<WebSocketFrameChunk> frames;
+  EXPECT_TRUE(parser.Decode(buffer, input.size(), &frames));
+  ASSERT_EQ(3u, frames.size());
+
+  ASSERT_TRUE(frames[1]->header.get());
+  EXPECT_EQ(WebSocketFrameHeader::kOpCodePing, frames[1]->header->opcode);
+  EXPECT_TRUE(frames[1]->final_chunk);
+  EXPECT_FALSE(frames[1]->data);
+
+  EXPECT_EQ(std::string(kHello, kHelloLength) + std::string(kHello,
+                                                            kHelloLength),
+            JoinPayloads(frames));
+}
+
+TEST(WebSocketFrameParserTest, DecodeLongFrameHeaders) {
+  struct TestCase {
+    const char* frame_header;
+    int frame_header_length;
+    uint64 frame_length;
+  };
+  static const TestCase kTests[] = {
+    { "\x81\x7E\x00\x7E", 4, GG_UINT64_C(126) },
+    { "\x81\x7E\xFF\xFF", 4, GG_UINT64_C(0xFFFF) },
+    { "\x81\x7F\x00\x00\x00\x00\x00\x01\x00\x00", 10, GG_UINT64_C(0x10000) },
+    { "\x81\x7F\x7F\xFF\xFF\xFF\xFF\xFF\xFF\xFF", 10,
+      GG_UINT64_C(0x7FFFFFFFFFFFFFFF) }
+  };
+
+  for (size_t i = 0; i < arraysize(kTests); ++i) {
+    WebSocketFrameParser parser;
+    scoped_refptr<IOBuffer> buffer(
+        MakeBuffer(kTests[i].frame_header, kTests[i].frame_header_length));
+    ScopedVector<WebSocketFrameChunk> frames;
+    EXPECT_TRUE(parser.Decode(buffer, kTests[i].frame_header_length,
+                              &frames));
+    // No payload has arrived, so there is nothing to hand out yet.
+    EXPECT_EQ(0u, frames.size());
+
+    scoped_refptr<IOBuffer> payload(MakeBuffer("x", 1));
+    EXPECT_TRUE(parser.Decode(payload, 1, &frames));
+    ASSERT_EQ(1u, frames.size());
+    ASSERT_TRUE(frames[0]->header.get());
+    EXPECT_EQ(kTests[i].frame_length, frames[0]->header->payload_length);
+    EXPECT_FALSE(frames[0]->final_chunk);
+  }
+}
+
+TEST(WebSocketFrameParserTest, InvalidFrames) {
+  struct TestCase {
+    const char* frame;
+    int frame_length;
+  };
+  static const TestCase kTests[] = {
+    // The most significant bit of a 64-bit length is set.
+    { "\x81\x7F\x80\x00\x00\x00\x00\x00\x00\x00", 10 },
+    // A fragmented ping.
+    { "\x09\x00", 2 },
+    // A close frame longer than 125 bytes.
+    { "\x88\x7E\x00\x7E", 4 }
+  };
+
+  for (size_t i = 0; i < arraysize(kTests); ++i) {
+    WebSocketFrameParser parser;
+    scoped_refptr<IOBuffer> buffer(
+        MakeBuffer(kTests[i].frame, kTests[i].frame_length));
+    ScopedVector<WebSocketFrameChunk> frames;
+    EXPECT_FALSE(parser.Decode(buffer, kTests[i].frame_length, &frames));
+    EXPECT_TRUE(parser.failed());
+    EXPECT_EQ(0u, frames.size());
+
+    // A failed parser stays failed.
+    scoped_refptr<IOBuffer> hello(
+        MakeBuffer(kHelloFrame, kHelloFrameLength));
+    EXPECT_FALSE(parser.Decode(hello, kHelloFrameLength, &frames));
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,38 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "base/perftimer.h"
+#include "net/websockets/websocket_frame.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kIterations = 100;
+const int kPayloadSize = 1024 * 1024;
+const WebSocketMaskingKey kMaskingKey = { { '\xFE', '\xED', '\xBE', '\xEF' } };
+
+}  // namespace
+
+// The byte-at-a-time loop from RFC 6455, for comparison.
+TEST(WebSocketFramePerfTest, MaskBytewise) {
+  std::vector<char> payload(kPayloadSize, 'x');
+  PerfTimeLogger timer("WebSocketFramePerfTest.MaskBytewise");
+  for (int i = 0; i < kIterations; ++i) {
+    for (int j = 0; j < kPayloadSize; ++j)
+      payload[j] ^= kMaskingKey.key[j % 4];
+  }
+}
+
+TEST(WebSocketFramePerfTest, MaskWebSocketFramePayload) {
+  std::vector<char> payload(kPayloadSize, 'x');
+  PerfTimeLogger timer("WebSocketFramePerfTest.MaskWebSocketFramePayload");
+  for (int i = 0; i < kIterations; ++i)
+    MaskWebSocketFramePayload(kMaskingKey, 0, &payload.front(), kPayloadSize);
+}
+
+}  // namespace net
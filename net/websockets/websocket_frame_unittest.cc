@@ -0,0 +1,114 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/websockets/websocket_frame.h"
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "net/base/net_errors.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+TEST(WebSocketFrameHeaderTest, FrameLengths) {
+  struct TestCase {
+    const char* frame_header;
+    size_t frame_header_length;
+    uint64 frame_length;
+  };
+  static const TestCase kTests[] = {
+    { "\x81\x00", 2, GG_UINT64_C(0) },
+    { "\x81\x7D", 2, GG_UINT64_C(125) },
+    { "\x81\x7E\x00\x7E", 4, GG_UINT64_C(126) },
+    { "\x81\x7E\xFF\xFF", 4, GG_UINT64_C(0xFFFF) },
+    { "\x81\x7F\x00\x00\x00\x00\x00\x01\x00\x00", 10, GG_UINT64_C(0x10000) },
+    { "\x81\x7F\x7F\xFF\xFF\xFF\xFF\xFF\xFF\xFF", 10,
+      GG_UINT64_C(0x7FFFFFFFFFFFFFFF) }
+  };
+
+  for (size_t i = 0; i < arraysize(kTests); ++i) {
+    WebSocketFrameHeader header;
+    header.final = true;
+    header.opcode = WebSocketFrameHeader::kOpCodeText;
+    header.payload_length = kTests[i].frame_length;
+
+    std::vector<char> expected_output(
+        kTests[i].frame_header,
+        kTests[i].frame_header + kTests[i].frame_header_length);
+    std::vector<char> output(expected_output.size());
+    EXPECT_EQ(static_cast<int>(expected_output.size()),
+              GetWebSocketFrameHeaderSize(header));
+    EXPECT_EQ(static_cast<int>(expected_output.size()),
+              WriteWebSocketFrameHeader(header, NULL, &output.front(),
+                                        output.size()));
+    EXPECT_EQ(expected_output, output);
+  }
+}
+
+TEST(WebSocketFrameHeaderTest, FrameLengthsWithMasking) {
+  static const WebSocketMaskingKey kMaskingKey = {
+    { '\xDE', '\xAD', '\xBE', '\xEF' }
+  };
+
+  WebSocketFrameHeader header;
+  header.final = true;
+  header.opcode = WebSocketFrameHeader::kOpCodeBinary;
+  header.masked = true;
+  header.payload_length = 126;
+
+  static const char kExpected[] = "\x82\xFE\x00\x7E\xDE\xAD\xBE\xEF";
+  std::vector<char> output(sizeof(kExpected) - 1);
+  EXPECT_EQ(static_cast<int>(output.size()),
+            WriteWebSocketFrameHeader(header, &kMaskingKey, &output.front(),
+                                      output.size()));
+  EXPECT_EQ(std::vector<char>(kExpected, kExpected + sizeof(kExpected) - 1),
+            output);
+}
+
+TEST(WebSocketFrameHeaderTest, InsufficientBufferSize) {
+  WebSocketFrameHeader header;
+  header.final = true;
+  header.opcode = WebSocketFrameHeader::kOpCodeText;
+  header.payload_length = 0xFFFF;
+
+  char buffer[3];
+  EXPECT_EQ(ERR_INVALID_ARGUMENT,
+            WriteWebSocketFrameHeader(header, NULL, buffer, sizeof(buffer)));
+}
+
+// Masking word by word must give the same bytes as the definition in RFC
+// 6455, at every alignment and starting offset.
+TEST(WebSocketFrameTest, MaskPayloadMatchesBytewiseMasking) {
+  static const WebSocketMaskingKey kMaskingKey = {
+    { '\x01', '\x23', '\x45', '\x67' }
+  };
+  static const int kPayloadSize = 67;
+  std::string payload;
+  for (int i = 0; i < kPayloadSize; ++i)
+    payload.push_back(static_cast<char>(i * 7));
+
+  for (int alignment = 0; alignment < 8; ++alignment) {
+    for (uint64 frame_offset = 0; frame_offset < 4; ++frame_offset) {
+      std::vector<char> buffer(alignment + kPayloadSize);
+      char* data = &buffer[alignment];
+      memcpy(data, payload.data(), kPayloadSize);
+      MaskWebSocketFramePayload(kMaskingKey, frame_offset, data, kPayloadSize);
+
+      for (int i = 0; i < kPayloadSize; ++i) {
+        char expected = payload[i] ^ kMaskingKey.key[(frame_offset + i) % 4];
+        EXPECT_EQ(expected, data[i]) << "alignment " << alignment
+                                     << ", offset " << frame_offset
+                                     << ", byte " << i;
+      }
+
+      // Masking again gives back the original payload.
+      MaskWebSocketFramePayload(kMaskingKey, frame_offset, data, kPayloadSize);
+      EXPECT_EQ(payload, std::string(data, kPayloadSize));
+    }
+  }
+}
+
+}  // namespace net
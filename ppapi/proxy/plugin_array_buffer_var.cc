@@ -8,27 +8,39 @@
 
 #include <limits>
 
+#include "base/logging.h"
+
 namespace ppapi {
 
 PluginArrayBufferVar::PluginArrayBufferVar(uint32 size_in_bytes)
-    : buffer_(size_in_bytes) {
+    : buffer_(size_in_bytes),
+      size_in_bytes_(size_in_bytes) {
+}
+
+PluginArrayBufferVar::PluginArrayBufferVar(uint32 size_in_bytes,
+                                           base::SharedMemory* shm)
+    : shmem_(shm),
+      size_in_bytes_(size_in_bytes) {
+  DCHECK(shmem_->memory());
 }
 
 PluginArrayBufferVar::~PluginArrayBufferVar() {
 }
 
 void* PluginArrayBufferVar::Map() {
+  if (shmem_.get())
+    return shmem_->memory();
   if (buffer_.empty())
     return NULL;
   return &(buffer_[0]);
 }
 
 void PluginArrayBufferVar::Unmap() {
-  // We don't actually use shared memory yet, so do nothing.
+  // Shared memory stays mapped until the var goes away.
 }
 
 uint32 PluginArrayBufferVar::ByteLength() {
-  return buffer_.size();
+  return size_in_bytes_;
 }
 
 }  // namespace ppapi
@@ -8,16 +8,21 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/shared_memory.h"
 #include "ppapi/c/pp_stdint.h"
 #include "ppapi/shared_impl/var.h"
 
 namespace ppapi {
 
 // Represents a plugin-side ArrayBufferVar. In the plugin process, it's
-// owned as a vector.
+// owned as a vector, unless it came from the host in shared memory.
 class PluginArrayBufferVar : public ArrayBufferVar {
  public:
   explicit PluginArrayBufferVar(uint32 size_in_bytes);
+  // Uses |shm|, which is mapped with at least |size_in_bytes|, as the buffer,
+  // taking ownership of it.
+  PluginArrayBufferVar(uint32 size_in_bytes, base::SharedMemory* shm);
   virtual ~PluginArrayBufferVar();
 
   // ArrayBufferVar implementation.
@@ -26,9 +31,14 @@ class PluginArrayBufferVar : public ArrayBufferVar {
   virtual uint32 ByteLength() OVERRIDE;
 
  private:
-  // TODO(dmichael): Use shared memory for this.
+  // The buffer of vars created in the plugin.
   std::vector<uint8> buffer_;
 
+  // The buffer of vars sent by the host. NULL for the others.
+  scoped_ptr<base::SharedMemory> shmem_;
+
+  uint32 size_in_bytes_;
+
   DISALLOW_COPY_AND_ASSIGN(PluginArrayBufferVar);
 };
 
@@ -63,6 +63,9 @@ class PPAPI_PROXY_EXPORT PluginVarTracker : public VarTracker {
   virtual void ObjectGettingZeroRef(VarMap::iterator iter) OVERRIDE;
   virtual bool DeleteObjectInfoIfNecessary(VarMap::iterator iter) OVERRIDE;
   virtual ArrayBufferVar* CreateArrayBuffer(uint32 size_in_bytes) OVERRIDE;
+  virtual ArrayBufferVar* CreateShmArrayBuffer(
+      uint32 size_in_bytes,
+      base::SharedMemory* shm) OVERRIDE;
 
  private:
   friend struct DefaultSingletonTraits<PluginVarTracker>;
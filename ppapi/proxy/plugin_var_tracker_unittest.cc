@@ -2,10 +2,15 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <string.h>
+
+#include "base/process_util.h"
+#include "base/shared_memory.h"
 #include "ipc/ipc_test_sink.h"
 #include "ppapi/proxy/plugin_var_tracker.h"
 #include "ppapi/proxy/ppapi_messages.h"
 #include "ppapi/proxy/ppapi_proxy_test.h"
+#include "ppapi/shared_impl/var.h"
 
 namespace ppapi {
 namespace proxy {
@@ -160,5 +165,32 @@ TEST_F(PluginVarTrackerTest, RecursiveTrackWithNoRef) {
             var_tracker().GetTrackedWithNoReferenceCountForObject(plugin_var));
 }
 
+// Array buffers received in shared memory use it as their buffer.
+TEST_F(PluginVarTrackerTest, ArrayBufferFromSharedMemory) {
+  const uint32 kSize = 1024;
+  base::SharedMemory shm;
+  ASSERT_TRUE(shm.CreateAndMapAnonymous(kSize));
+  memset(shm.memory(), 'x', kSize);
+  base::SharedMemoryHandle handle;
+  ASSERT_TRUE(shm.ShareToProcess(base::GetCurrentProcessHandle(), &handle));
+  base::SharedMemory* plugin_shm = new base::SharedMemory(handle, false);
+  ASSERT_TRUE(plugin_shm->Map(kSize));
+
+  PP_Var var = var_tracker().MakeArrayBufferPPVar(kSize, plugin_shm);
+  ArrayBufferVar* buffer = ArrayBufferVar::FromPPVar(var);
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(kSize, buffer->ByteLength());
+  const char* data = static_cast<const char*>(buffer->Map());
+  ASSERT_TRUE(data);
+  EXPECT_EQ('x', data[0]);
+  EXPECT_EQ('x', data[kSize - 1]);
+
+  // Writes go to the same memory rather than to a copy.
+  static_cast<char*>(shm.memory())[0] = 'y';
+  EXPECT_EQ('y', data[0]);
+
+  var_tracker().ReleaseVar(var);
+}
+
 }  // namespace proxy
 }  // namespace ppapi
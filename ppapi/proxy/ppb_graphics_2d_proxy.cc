@@ -4,7 +4,7 @@
 
 #include "ppapi/proxy/ppb_graphics_2d_proxy.h"
 
-#include <string.h>  // For memset.
+#include <vector>
 
 #include "base/compiler_specific.h"
 #include "base/logging.h"
@@ -15,6 +15,8 @@
 #include "ppapi/proxy/enter_proxy.h"
 #include "ppapi/proxy/plugin_dispatcher.h"
 #include "ppapi/proxy/ppapi_messages.h"
+#include "ppapi/proxy/serialized_structs.h"
+#include "ppapi/shared_impl/scoped_pp_resource.h"
 #include "ppapi/shared_impl/tracked_callback.h"
 #include "ppapi/thunk/enter.h"
 #include "ppapi/thunk/ppb_graphics_2d_api.h"
@@ -53,11 +55,23 @@ class Graphics2D : public Resource, public thunk::PPB_Graphics2D_API {
     return PluginDispatcher::GetForResource(this);
   }
 
+  // Returns the image resource if it belongs to this instance, logging an
+  // error for |function_name| otherwise.
+  Resource* GetImageObject(PP_Resource image_data, const char* function_name);
+
   static const ApiID kApiID = API_ID_PPB_GRAPHICS_2D;
 
   PP_Size size_;
   PP_Bool is_always_opaque_;
 
+  // The drawing calls made since the last Flush. They are only sent to the
+  // host with the Flush, which is when the host would apply them anyway.
+  std::vector<PPBGraphics2D_Operation> pending_operations_;
+
+  // Keeps the images of |pending_operations_| alive until they are sent, in
+  // case the plugin releases them first.
+  std::vector<ScopedPPResource> pending_images_;
+
   // In the plugin, this is the current callback set for Flushes. When the
   // pointer is non-NULL, we're waiting for a flush ACK.
   scoped_refptr<TrackedCallback> current_flush_callback_;
@@ -90,40 +104,45 @@ void Graphics2D::PaintImageData(PP_Resource image_data,
                                 const PP_Point* top_left,
                                 const PP_Rect* src_rect) {
   Resource* image_object =
-      PpapiGlobals::Get()->GetResourceTracker()->GetResource(image_data);
-  if (!image_object || pp_instance() != image_object->pp_instance()) {
-    Log(PP_LOGLEVEL_ERROR,
-        "PPB_Graphics2D.PaintImageData: Bad image resource.");
+      GetImageObject(image_data, "PPB_Graphics2D.PaintImageData");
+  if (!image_object)
     return;
-  }
 
-  PP_Rect dummy;
-  memset(&dummy, 0, sizeof(PP_Rect));
-  GetDispatcher()->Send(new PpapiHostMsg_PPBGraphics2D_PaintImageData(
-      kApiID, host_resource(), image_object->host_resource(), *top_left,
-      !!src_rect, src_rect ? *src_rect : dummy));
+  PPBGraphics2D_Operation operation;
+  operation.type = PPBGraphics2D_Operation::PAINT_IMAGE_DATA;
+  operation.image_data = image_object->host_resource();
+  operation.point = *top_left;
+  if (src_rect) {
+    operation.rect_specified = true;
+    operation.rect = *src_rect;
+  }
+  pending_operations_.push_back(operation);
+  pending_images_.push_back(ScopedPPResource(image_object));
 }
 
 void Graphics2D::Scroll(const PP_Rect* clip_rect,
                         const PP_Point* amount) {
-  PP_Rect dummy;
-  memset(&dummy, 0, sizeof(PP_Rect));
-  GetDispatcher()->Send(new PpapiHostMsg_PPBGraphics2D_Scroll(
-      kApiID, host_resource(), !!clip_rect, clip_rect ? *clip_rect : dummy,
-      *amount));
+  PPBGraphics2D_Operation operation;
+  operation.type = PPBGraphics2D_Operation::SCROLL;
+  operation.point = *amount;
+  if (clip_rect) {
+    operation.rect_specified = true;
+    operation.rect = *clip_rect;
+  }
+  pending_operations_.push_back(operation);
 }
 
 void Graphics2D::ReplaceContents(PP_Resource image_data) {
   Resource* image_object =
-      PpapiGlobals::Get()->GetResourceTracker()->GetResource(image_data);
-  if (!image_object || pp_instance() != image_object->pp_instance()) {
-    Log(PP_LOGLEVEL_ERROR,
-        "PPB_Graphics2D.PaintImageData: Bad image resource.");
+      GetImageObject(image_data, "PPB_Graphics2D.ReplaceContents");
+  if (!image_object)
     return;
-  }
 
-  GetDispatcher()->Send(new PpapiHostMsg_PPBGraphics2D_ReplaceContents(
-      kApiID, host_resource(), image_object->host_resource()));
+  PPBGraphics2D_Operation operation;
+  operation.type = PPBGraphics2D_Operation::REPLACE_CONTENTS;
+  operation.image_data = image_object->host_resource();
+  pending_operations_.push_back(operation);
+  pending_images_.push_back(ScopedPPResource(image_object));
 }
 
 int32_t Graphics2D::Flush(PP_CompletionCallback callback) {
@@ -136,8 +155,11 @@ int32_t Graphics2D::Flush(PP_CompletionCallback callback) {
     return PP_ERROR_INPROGRESS;  // Can't have >1 flush pending.
   current_flush_callback_ = new TrackedCallback(this, callback);
 
-  GetDispatcher()->Send(new PpapiHostMsg_PPBGraphics2D_Flush(kApiID,
-                                                             host_resource()));
+  GetDispatcher()->Send(new PpapiHostMsg_PPBGraphics2D_Flush(
+      kApiID, host_resource(), pending_operations_));
+  pending_operations_.clear();
+  // Any release of the images is sent after the flush, so they may go now.
+  pending_images_.clear();
   return PP_OK_COMPLETIONPENDING;
 }
 
@@ -145,6 +167,18 @@ void Graphics2D::FlushACK(int32_t result_code) {
   TrackedCallback::ClearAndRun(&current_flush_callback_, result_code);
 }
 
+Resource* Graphics2D::GetImageObject(PP_Resource image_data,
+                                     const char* function_name) {
+  Resource* image_object =
+      PpapiGlobals::Get()->GetResourceTracker()->GetResource(image_data);
+  if (!image_object || pp_instance() != image_object->pp_instance()) {
+    Log(PP_LOGLEVEL_ERROR,
+        std::string(function_name) + ": Bad image resource.");
+    return NULL;
+  }
+  return image_object;
+}
+
 PPB_Graphics2D_Proxy::PPB_Graphics2D_Proxy(Dispatcher* dispatcher)
     : InterfaceProxy(dispatcher),
       callback_factory_(ALLOW_THIS_IN_INITIALIZER_LIST(this)) {
@@ -175,12 +209,6 @@ bool PPB_Graphics2D_Proxy::OnMessageReceived(const IPC::Message& msg) {
   IPC_BEGIN_MESSAGE_MAP(PPB_Graphics2D_Proxy, msg)
     IPC_MESSAGE_HANDLER(PpapiHostMsg_PPBGraphics2D_Create,
                         OnHostMsgCreate)
-    IPC_MESSAGE_HANDLER(PpapiHostMsg_PPBGraphics2D_PaintImageData,
-                        OnHostMsgPaintImageData)
-    IPC_MESSAGE_HANDLER(PpapiHostMsg_PPBGraphics2D_Scroll,
-                        OnHostMsgScroll)
-    IPC_MESSAGE_HANDLER(PpapiHostMsg_PPBGraphics2D_ReplaceContents,
-                        OnHostMsgReplaceContents)
     IPC_MESSAGE_HANDLER(PpapiHostMsg_PPBGraphics2D_Flush,
                         OnHostMsgFlush)
 
@@ -203,44 +231,31 @@ void PPB_Graphics2D_Proxy::OnHostMsgCreate(PP_Instance instance,
   }
 }
 
-void PPB_Graphics2D_Proxy::OnHostMsgPaintImageData(
+void PPB_Graphics2D_Proxy::OnHostMsgFlush(
     const HostResource& graphics_2d,
-    const HostResource& image_data,
-    const PP_Point& top_left,
-    bool src_rect_specified,
-    const PP_Rect& src_rect) {
-  EnterHostFromHostResource<PPB_Graphics2D_API> enter(graphics_2d);
-  if (enter.failed())
-    return;
-  enter.object()->PaintImageData(image_data.host_resource(), &top_left,
-      src_rect_specified ? &src_rect : NULL);
-}
-
-void PPB_Graphics2D_Proxy::OnHostMsgScroll(const HostResource& graphics_2d,
-                                           bool clip_specified,
-                                           const PP_Rect& clip,
-                                           const PP_Point& amount) {
-  EnterHostFromHostResource<PPB_Graphics2D_API> enter(graphics_2d);
-  if (enter.failed())
-    return;
-  enter.object()->Scroll(clip_specified ? &clip : NULL, &amount);
-}
-
-void PPB_Graphics2D_Proxy::OnHostMsgReplaceContents(
-    const HostResource& graphics_2d,
-    const HostResource& image_data) {
-  EnterHostFromHostResource<PPB_Graphics2D_API> enter(graphics_2d);
-  if (enter.failed())
-    return;
-  enter.object()->ReplaceContents(image_data.host_resource());
-}
-
-void PPB_Graphics2D_Proxy::OnHostMsgFlush(const HostResource& graphics_2d) {
+    const std::vector<PPBGraphics2D_Operation>& operations) {
   EnterHostFromHostResourceForceCallback<PPB_Graphics2D_API> enter(
       graphics_2d, callback_factory_,
       &PPB_Graphics2D_Proxy::SendFlushACKToPlugin, graphics_2d);
   if (enter.failed())
     return;
+
+  for (size_t i = 0; i < operations.size(); ++i) {
+    const PPBGraphics2D_Operation& op = operations[i];
+    const PP_Rect* rect = op.rect_specified ? &op.rect : NULL;
+    switch (op.type) {
+      case PPBGraphics2D_Operation::PAINT_IMAGE_DATA:
+        enter.object()->PaintImageData(op.image_data.host_resource(),
+                                       &op.point, rect);
+        break;
+      case PPBGraphics2D_Operation::SCROLL:
+        enter.object()->Scroll(rect, &op.point);
+        break;
+      case PPBGraphics2D_Operation::REPLACE_CONTENTS:
+        enter.object()->ReplaceContents(op.image_data.host_resource());
+        break;
+    }
+  }
   enter.SetResult(enter.object()->Flush(enter.callback()));
 }
 
@@ -0,0 +1,60 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "base/perftimer.h"
+#include "ppapi/proxy/ppapi_messages.h"
+#include "ppapi/proxy/ppapi_proxy_test.h"
+#include "ppapi/proxy/serialized_structs.h"
+
+namespace ppapi {
+namespace proxy {
+namespace {
+
+const int kOperationCount = 10000;
+
+class PpbGraphics2DPerfTest : public TwoWayTest {
+ public:
+  PpbGraphics2DPerfTest() : TwoWayTest(TwoWayTest::TEST_PPB_INTERFACE) {}
+
+  // Sends kOperationCount drawing calls to the host, |batch_size| per flush,
+  // and waits for the host to have handled them all.
+  void SendOperations(int batch_size) {
+    PluginDispatcher* dispatcher = plugin().plugin_dispatcher();
+    PPBGraphics2D_Operation operation;
+    operation.type = PPBGraphics2D_Operation::SCROLL;
+    operation.point = PP_MakePoint(0, 1);
+    std::vector<PPBGraphics2D_Operation> batch(batch_size, operation);
+    for (int i = 0; i < kOperationCount; i += batch_size) {
+      dispatcher->Send(new PpapiHostMsg_PPBGraphics2D_Flush(
+          API_ID_PPB_GRAPHICS_2D, HostResource(), batch));
+    }
+
+    // The host has no resource creation functions in this test, so this
+    // just returns a null resource once the flushes before it are handled.
+    HostResource result;
+    dispatcher->Send(new PpapiHostMsg_PPBGraphics2D_Create(
+        API_ID_PPB_GRAPHICS_2D, pp_instance(), PP_MakeSize(1, 1), PP_FALSE,
+        &result));
+    EXPECT_TRUE(result.is_null());
+  }
+};
+
+}  // namespace
+
+// One message per drawing call, which is what every call used to cost.
+TEST_F(PpbGraphics2DPerfTest, UnbatchedOperations) {
+  PerfTimeLogger logger("PpbGraphics2DPerfTest.UnbatchedOperations");
+  SendOperations(1);
+}
+
+// The drawing calls of a typical frame sent with its flush.
+TEST_F(PpbGraphics2DPerfTest, BatchedOperations) {
+  PerfTimeLogger logger("PpbGraphics2DPerfTest.BatchedOperations");
+  SendOperations(50);
+}
+
+}  // namespace proxy
+}  // namespace ppapi
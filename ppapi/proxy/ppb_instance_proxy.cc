@@ -401,7 +401,8 @@ void PPB_Instance_Proxy::PostMessage(PP_Instance instance,
                                      PP_Var message) {
   dispatcher()->Send(new PpapiHostMsg_PPBInstance_PostMessage(
       API_ID_PPB_INSTANCE,
-      instance, SerializedVarSendInput(dispatcher(), message)));
+      instance,
+      SerializedVarSendInputShmem(dispatcher(), message, instance)));
 }
 
 PP_Bool PPB_Instance_Proxy::SetCursor(PP_Instance instance,
@@ -623,9 +624,15 @@ void PPB_Instance_Proxy::OnMsgHandleInputEventAck(PP_Instance instance,
 void PPB_Instance_Proxy::OnHostMsgPostMessage(
     PP_Instance instance,
     SerializedVarReceiveInput message) {
+  // The message may name shared memory of |instance|, so it must be the
+  // sender's.
+  if (HostDispatcher::GetForInstance(instance) != dispatcher())
+    return;
   EnterInstanceNoLock enter(instance);
-  if (enter.succeeded())
-    enter.functions()->PostMessage(instance, message.Get(dispatcher()));
+  if (enter.succeeded()) {
+    enter.functions()->PostMessage(
+        instance, message.GetForInstance(dispatcher(), instance));
+  }
 }
 
 void PPB_Instance_Proxy::OnHostMsgLockMouse(PP_Instance instance) {
@@ -33,7 +33,7 @@ void HandleMessage(PP_Instance instance, PP_Var message_data) {
   dispatcher->Send(new PpapiMsg_PPPMessaging_HandleMessage(
       API_ID_PPP_MESSAGING,
       instance,
-      SerializedVarSendInput(dispatcher, message_data)));
+      SerializedVarSendInputShmem(dispatcher, message_data, instance)));
 }
 
 static const PPP_Messaging messaging_interface = {
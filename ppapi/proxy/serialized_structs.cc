@@ -78,5 +78,12 @@ PPBFlash_DrawGlyphs_Params::PPBFlash_DrawGlyphs_Params()
 
 PPBFlash_DrawGlyphs_Params::~PPBFlash_DrawGlyphs_Params() {}
 
+PPBGraphics2D_Operation::PPBGraphics2D_Operation()
+    : type(PAINT_IMAGE_DATA),
+      point(PP_MakePoint(0, 0)),
+      rect_specified(false),
+      rect(PP_MakeRectFromXYWH(0, 0, 0, 0)) {
+}
+
 }  // namespace proxy
 }  // namespace ppapi
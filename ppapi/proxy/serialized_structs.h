@@ -103,6 +103,32 @@ struct PPBURLLoader_UpdateProgress_Params {
   int64_t total_bytes_to_be_received;
 };
 
+// A drawing call queued by the plugin-side Graphics2D and sent to the host
+// with the next Flush, so a frame takes one message however many calls it
+// makes.
+struct PPBGraphics2D_Operation {
+  enum Type {
+    PAINT_IMAGE_DATA,
+    SCROLL,
+    REPLACE_CONTENTS
+  };
+
+  PPBGraphics2D_Operation();
+
+  Type type;
+
+  // Unused by SCROLL.
+  ppapi::HostResource image_data;
+
+  // The top left of PAINT_IMAGE_DATA, or the amount of SCROLL.
+  PP_Point point;
+
+  // The source rect of PAINT_IMAGE_DATA, or the clip of SCROLL, when
+  // |rect_specified| is set.
+  bool rect_specified;
+  PP_Rect rect;
+};
+
 struct PPPVideoCapture_Buffer {
   ppapi::HostResource resource;
   uint32_t size;
@@ -4,23 +4,111 @@
 
 #include "ppapi/proxy/serialized_var.h"
 
+#include <string.h>
+
+#if defined(OS_POSIX)
+#include <sys/stat.h>
+#endif
+
 #include "base/logging.h"
+#include "base/platform_file.h"
 #include "ipc/ipc_message_utils.h"
+#include "ppapi/c/pp_errors.h"
 #include "ppapi/proxy/dispatcher.h"
 #include "ppapi/proxy/interface_proxy.h"
 #include "ppapi/proxy/ppapi_param_traits.h"
 #include "ppapi/shared_impl/ppapi_globals.h"
 #include "ppapi/shared_impl/var.h"
+#include "ppapi/thunk/enter.h"
+#include "ppapi/thunk/ppb_buffer_api.h"
+#include "ppapi/thunk/ppb_buffer_trusted_api.h"
+#include "ppapi/thunk/resource_creation_api.h"
+
+#if !defined(OS_NACL)
+#include "ppapi/proxy/ppb_buffer_proxy.h"
+#endif
 
 namespace ppapi {
 namespace proxy {
 
+namespace {
+
+// Array buffers of at least this size are sent by SerializedVarSendInputShmem
+// in shared memory. Below it, setting up the shared memory costs more than
+// copying the contents through the channel.
+const uint32 kMinimumArrayBufferSizeForShmem = 256 * 1024;
+
+// Maps the first |size_in_bytes| of |shm|. Fails if the shared memory is
+// smaller than that, since touching the pages past its end would crash.
+bool MapSharedMemory(base::SharedMemory* shm, uint32 size_in_bytes) {
+  if (!size_in_bytes)
+    return false;
+#if defined(OS_POSIX)
+  struct stat info;
+  if (fstat(shm->handle().fd, &info) != 0 ||
+      info.st_size < static_cast<off_t>(size_in_bytes))
+    return false;
+#endif
+  if (!shm->Map(size_in_bytes))
+    return false;
+#if defined(OS_WIN)
+  MEMORY_BASIC_INFORMATION info;
+  if (!VirtualQuery(shm->memory(), &info, sizeof(info)) ||
+      info.RegionSize < size_in_bytes)
+    return false;
+#endif
+  return true;
+}
+
+// Makes an array buffer var from the contents of the host PPB_Buffer
+// resource |host_buffer|, if it belongs to |instance|.
+PP_Var MakeArrayBufferFromHostBuffer(PP_Resource host_buffer,
+                                     uint32 size_in_bytes,
+                                     PP_Instance instance) {
+  thunk::EnterResourceNoLock<thunk::PPB_Buffer_API> enter(host_buffer, false);
+  if (enter.failed() || !instance)
+    return PP_MakeNull();
+  // Another instance's buffer may hold data this one must not see.
+  PP_Instance buffer_instance = enter.resource()->pp_instance();
+  PpapiGlobals* globals = PpapiGlobals::Get();
+  if (buffer_instance != instance ||
+      globals->GetModuleForInstance(buffer_instance) !=
+          globals->GetModuleForInstance(instance))
+    return PP_MakeNull();
+  uint32_t buffer_size = 0;
+  if (!enter.object()->Describe(&buffer_size) || buffer_size < size_in_bytes)
+    return PP_MakeNull();
+  const void* data = enter.object()->Map();
+  if (!data)
+    return PP_MakeNull();
+  PP_Var var = PpapiGlobals::Get()->GetVarTracker()->MakeArrayBufferPPVar(
+      size_in_bytes, data);
+  enter.object()->Unmap();
+  return var;
+}
+
+}  // namespace
+
+// SerializedVar::Inner::RawVarData --------------------------------------------
+
+SerializedVar::Inner::RawVarData::RawVarData()
+    : type(PP_VARTYPE_UNDEFINED),
+      transport(ARRAY_BUFFER_IN_MESSAGE),
+      host_buffer(0),
+      size_in_bytes(0) {
+}
+
 // SerializedVar::Inner --------------------------------------------------------
 
 SerializedVar::Inner::Inner()
     : serialization_rules_(NULL),
       var_(PP_MakeUndefined()),
-      cleanup_mode_(CLEANUP_NONE) {
+      cleanup_mode_(CLEANUP_NONE),
+      array_buffer_transport_(ARRAY_BUFFER_IN_MESSAGE),
+      host_buffer_(0),
+      plugin_handle_(base::SharedMemory::NULLHandle()),
+      shmem_size_(0),
+      receiving_instance_(0) {
 #ifndef NDEBUG
   has_been_serialized_ = false;
   has_been_deserialized_ = false;
@@ -30,7 +118,12 @@ SerializedVar::Inner::Inner()
 SerializedVar::Inner::Inner(VarSerializationRules* serialization_rules)
     : serialization_rules_(serialization_rules),
       var_(PP_MakeUndefined()),
-      cleanup_mode_(CLEANUP_NONE) {
+      cleanup_mode_(CLEANUP_NONE),
+      array_buffer_transport_(ARRAY_BUFFER_IN_MESSAGE),
+      host_buffer_(0),
+      plugin_handle_(base::SharedMemory::NULLHandle()),
+      shmem_size_(0),
+      receiving_instance_(0) {
 #ifndef NDEBUG
   has_been_serialized_ = false;
   has_been_deserialized_ = false;
@@ -118,6 +211,18 @@ void SerializedVar::Inner::WriteToMessage(IPC::Message* m) const {
       break;
     }
     case PP_VARTYPE_ARRAY_BUFFER: {
+      m->WriteInt(static_cast<int>(array_buffer_transport_));
+      if (array_buffer_transport_ == ARRAY_BUFFER_SHMEM_HOST) {
+        m->WriteInt(host_buffer_);
+        m->WriteUInt32(shmem_size_);
+        break;
+      }
+      if (array_buffer_transport_ == ARRAY_BUFFER_SHMEM_PLUGIN) {
+        IPC::ParamTraits<base::SharedMemoryHandle>::Write(m, plugin_handle_);
+        m->WriteUInt32(shmem_size_);
+        break;
+      }
+
       // TODO(dmichael) in the case of an invalid var ID, it would be nice
       // to send something to the other side such that a 0 ID would be
       // generated there. Then the function implementing the interface can
@@ -125,9 +230,7 @@ void SerializedVar::Inner::WriteToMessage(IPC::Message* m) const {
       // what looks like a valid empty ArraryBuffer.
       ArrayBufferVar* buffer_var = ArrayBufferVar::FromPPVar(var_);
       if (buffer_var) {
-        // TODO(dmichael): If it wasn't already Mapped, Unmap it. (Though once
-        //                 we use shared memory, this will probably be
-        //                 completely different anyway).
+        // TODO(dmichael): If it wasn't already Mapped, Unmap it.
         m->WriteData(static_cast<const char*>(buffer_var->Map()),
                      buffer_var->ByteLength());
       } else {
@@ -195,13 +298,47 @@ bool SerializedVar::Inner::ReadFromMessage(const IPC::Message* m,
       break;
     }
     case PP_VARTYPE_ARRAY_BUFFER: {
-      int length = 0;
-      const char* message_bytes = NULL;
-      success = m->ReadData(iter, &message_bytes, &length);
+      int transport;
+      if (!m->ReadInt(iter, &transport))
+        break;
+      scoped_ptr<RawVarData> raw_var_data(new RawVarData);
+      raw_var_data->type = PP_VARTYPE_ARRAY_BUFFER;
+      switch (transport) {
+        case ARRAY_BUFFER_IN_MESSAGE: {
+          int length = 0;
+          const char* message_bytes = NULL;
+          success = m->ReadData(iter, &message_bytes, &length);
+          if (success)
+            raw_var_data->data.assign(message_bytes, length);
+          break;
+        }
+        case ARRAY_BUFFER_SHMEM_HOST:
+          // Only the plugin names host buffers.
+          success = PpapiGlobals::Get()->IsHostGlobals() &&
+              m->ReadInt(iter, &raw_var_data->host_buffer) &&
+              m->ReadUInt32(iter, &raw_var_data->size_in_bytes);
+          break;
+        case ARRAY_BUFFER_SHMEM_PLUGIN: {
+          // Only the host sends shared memory, and it is mapped here so that
+          // a bad handle or size fails the message.
+          base::SharedMemoryHandle handle;
+          if (!IPC::ParamTraits<base::SharedMemoryHandle>::Read(m, iter,
+                                                               &handle))
+            break;
+          // Owns the handle from now on.
+          scoped_ptr<base::SharedMemory> shm(
+              new base::SharedMemory(handle, false));
+          success = PpapiGlobals::Get()->IsPluginGlobals() &&
+              m->ReadUInt32(iter, &raw_var_data->size_in_bytes) &&
+              MapSharedMemory(shm.get(), raw_var_data->size_in_bytes);
+          if (success)
+            raw_var_data->plugin_shm.reset(shm.release());
+          break;
+        }
+      }
       if (success) {
-        raw_var_data_.reset(new RawVarData);
-        raw_var_data_->type = PP_VARTYPE_ARRAY_BUFFER;
-        raw_var_data_->data.assign(message_bytes, length);
+        raw_var_data->transport = static_cast<ArrayBufferTransport>(transport);
+        raw_var_data_.reset(raw_var_data.release());
       }
       break;
     }
@@ -236,6 +373,26 @@ void SerializedVar::Inner::SetCleanupModeToEndReceiveCallerOwned() {
   cleanup_mode_ = END_RECEIVE_CALLER_OWNED;
 }
 
+void SerializedVar::Inner::SetArrayBufferShmemFromPlugin(
+    const ScopedPPResource& plugin_buffer,
+    PP_Resource host_buffer,
+    uint32 size_in_bytes) {
+  DCHECK_EQ(PP_VARTYPE_ARRAY_BUFFER, var_.type);
+  array_buffer_transport_ = ARRAY_BUFFER_SHMEM_HOST;
+  plugin_buffer_ = plugin_buffer;
+  host_buffer_ = host_buffer;
+  shmem_size_ = size_in_bytes;
+}
+
+void SerializedVar::Inner::SetArrayBufferShmemFromHost(
+    base::SharedMemoryHandle plugin_handle,
+    uint32 size_in_bytes) {
+  DCHECK_EQ(PP_VARTYPE_ARRAY_BUFFER, var_.type);
+  array_buffer_transport_ = ARRAY_BUFFER_SHMEM_PLUGIN;
+  plugin_handle_ = plugin_handle;
+  shmem_size_ = size_in_bytes;
+}
+
 void SerializedVar::Inner::ConvertRawVarData() {
   if (!raw_var_data_.get())
     return;
@@ -248,8 +405,24 @@ void SerializedVar::Inner::ConvertRawVarData() {
       break;
     }
     case PP_VARTYPE_ARRAY_BUFFER: {
-      var_ = PpapiGlobals::Get()->GetVarTracker()->MakeArrayBufferPPVar(
-          raw_var_data_->data.size(), raw_var_data_->data.data());
+      VarTracker* tracker = PpapiGlobals::Get()->GetVarTracker();
+      switch (raw_var_data_->transport) {
+        case ARRAY_BUFFER_IN_MESSAGE:
+          var_ = tracker->MakeArrayBufferPPVar(raw_var_data_->data.size(),
+                                               raw_var_data_->data.data());
+          break;
+        case ARRAY_BUFFER_SHMEM_HOST:
+          var_ = MakeArrayBufferFromHostBuffer(raw_var_data_->host_buffer,
+                                               raw_var_data_->size_in_bytes,
+                                               receiving_instance_);
+          break;
+        case ARRAY_BUFFER_SHMEM_PLUGIN:
+          // The var tracker takes over the shared memory.
+          var_ = tracker->MakeArrayBufferPPVar(
+              raw_var_data_->size_in_bytes,
+              raw_var_data_->plugin_shm.release());
+          break;
+      }
       break;
     }
     default:
@@ -288,6 +461,83 @@ void SerializedVarSendInput::ConvertVector(Dispatcher* dispatcher,
     output->push_back(SerializedVarSendInput(dispatcher, input[i]));
 }
 
+// SerializedVarSendInputShmem -------------------------------------------------
+
+SerializedVarSendInputShmem::SerializedVarSendInputShmem(
+    Dispatcher* dispatcher,
+    const PP_Var& var,
+    const PP_Instance& instance)
+    : SerializedVar(dispatcher->serialization_rules()) {
+  inner_->SetVar(dispatcher->serialization_rules()->SendCallerOwned(var));
+
+#if !defined(OS_NACL)
+  ArrayBufferVar* buffer_var = ArrayBufferVar::FromPPVar(var);
+  if (!buffer_var)
+    return;
+  uint32 size_in_bytes = buffer_var->ByteLength();
+  if (size_in_bytes < kMinimumArrayBufferSizeForShmem)
+    return;
+  const void* contents = buffer_var->Map();
+  if (!contents)
+    return;
+
+  // On any failure below, the contents are simply sent in the message.
+  if (dispatcher->IsPlugin()) {
+    // Only the host can create shared memory, so ask it for a buffer.
+    ScopedPPResource plugin_buffer(
+        ScopedPPResource::PassRef(),
+        PPB_Buffer_Proxy::CreateProxyResource(instance, size_in_bytes));
+    thunk::EnterResourceNoLock<thunk::PPB_Buffer_API> enter(plugin_buffer,
+                                                            false);
+    if (enter.failed())
+      return;
+    void* data = enter.object()->Map();
+    if (!data)
+      return;
+    memcpy(data, contents, size_in_bytes);
+    enter.object()->Unmap();
+    inner_->SetArrayBufferShmemFromPlugin(
+        plugin_buffer, enter.resource()->host_resource().host_resource(),
+        size_in_bytes);
+    return;
+  }
+
+  thunk::EnterResourceCreationNoLock enter_creation(instance);
+  if (enter_creation.failed())
+    return;
+  ScopedPPResource host_buffer(
+      ScopedPPResource::PassRef(),
+      enter_creation.functions()->CreateBuffer(instance, size_in_bytes));
+  thunk::EnterResourceNoLock<thunk::PPB_Buffer_API> enter(host_buffer, false);
+  thunk::EnterResourceNoLock<thunk::PPB_BufferTrusted_API> enter_trusted(
+      host_buffer, false);
+  int shm_handle;
+  if (enter.failed() || enter_trusted.failed() ||
+      enter_trusted.object()->GetSharedMemory(&shm_handle) != PP_OK)
+    return;
+  void* data = enter.object()->Map();
+  if (!data)
+    return;
+  memcpy(data, contents, size_in_bytes);
+  enter.object()->Unmap();
+
+  base::PlatformFile platform_file =
+#if defined(OS_WIN)
+      reinterpret_cast<HANDLE>(static_cast<intptr_t>(shm_handle));
+#elif defined(OS_POSIX)
+      shm_handle;
+#else
+  #error Not implemented.
+#endif
+  // The plugin gets its own handle, so the buffer may go away once this does.
+  base::SharedMemoryHandle plugin_handle =
+      dispatcher->ShareHandleWithRemote(platform_file, false);
+  if (!base::SharedMemory::IsHandleValid(plugin_handle))
+    return;
+  inner_->SetArrayBufferShmemFromHost(plugin_handle, size_in_bytes);
+#endif  // !defined(OS_NACL)
+}
+
 // ReceiveSerializedVarReturnValue ---------------------------------------------
 
 ReceiveSerializedVarReturnValue::ReceiveSerializedVarReturnValue() {
@@ -393,6 +643,12 @@ PP_Var SerializedVarReceiveInput::Get(Dispatcher* dispatcher) {
   return serialized_.inner_->GetVar();
 }
 
+PP_Var SerializedVarReceiveInput::GetForInstance(Dispatcher* dispatcher,
+                                                 PP_Instance instance) {
+  serialized_.inner_->set_receiving_instance(instance);
+  return Get(dispatcher);
+}
+
 // SerializedVarVectorReceiveInput ---------------------------------------------
 
 SerializedVarVectorReceiveInput::SerializedVarVectorReceiveInput(
@@ -11,9 +11,13 @@
 #include "base/basictypes.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/shared_memory.h"
+#include "ppapi/c/pp_instance.h"
+#include "ppapi/c/pp_resource.h"
 #include "ppapi/c/pp_var.h"
 #include "ppapi/proxy/ppapi_proxy_export.h"
 #include "ppapi/proxy/var_serialization_rules.h"
+#include "ppapi/shared_impl/scoped_pp_resource.h"
 
 class PickleIterator;
 
@@ -84,6 +88,7 @@ class PPAPI_PROXY_EXPORT SerializedVar {
   friend class SerializedVarReturnValue;
   friend class SerializedVarOutParam;
   friend class SerializedVarSendInput;
+  friend class SerializedVarSendInputShmem;
   friend class SerializedVarTestConstructor;
   friend class SerializedVarVectorReceiveInput;
 
@@ -115,7 +120,35 @@ class PPAPI_PROXY_EXPORT SerializedVar {
     void SetCleanupModeToEndSendPassRef();
     void SetCleanupModeToEndReceiveCallerOwned();
 
+    // Sets the instance a received var was sent to. Array buffers in host
+    // PPB_Buffer resources are only accepted if the resource belongs to it.
+    void set_receiving_instance(PP_Instance instance) {
+      receiving_instance_ = instance;
+    }
+
+    // Makes an array buffer var be sent in shared memory rather than in the
+    // message. From the plugin, it is in the host's PPB_Buffer resource
+    // |host_buffer|, which |plugin_buffer| keeps alive until the message is
+    // sent. From the host, it is in the shared memory |plugin_handle|, which
+    // is only valid in the plugin process.
+    void SetArrayBufferShmemFromPlugin(const ScopedPPResource& plugin_buffer,
+                                       PP_Resource host_buffer,
+                                       uint32 size_in_bytes);
+    void SetArrayBufferShmemFromHost(base::SharedMemoryHandle plugin_handle,
+                                     uint32 size_in_bytes);
+
    private:
+    // How an array buffer var is written to the message.
+    enum ArrayBufferTransport {
+      // The contents are copied into the message.
+      ARRAY_BUFFER_IN_MESSAGE,
+      // The message names a host PPB_Buffer resource holding the contents.
+      ARRAY_BUFFER_SHMEM_HOST,
+      // The message carries the plugin's handle to shared memory holding the
+      // contents.
+      ARRAY_BUFFER_SHMEM_PLUGIN
+    };
+
     enum CleanupMode {
       // The serialized var won't do anything special in the destructor
       // (default).
@@ -135,8 +168,17 @@ class PPAPI_PROXY_EXPORT SerializedVar {
     // and create PP_Var later when GetVar() is called, which should happen on
     // the main thread.
     struct RawVarData {
+      RawVarData();
+
       PP_VarType type;
       std::string data;
+
+      // For array buffers sent in shared memory, where |data| is unused.
+      // |plugin_shm| is already mapped and holds at least |size_in_bytes|.
+      ArrayBufferTransport transport;
+      PP_Resource host_buffer;
+      scoped_ptr<base::SharedMemory> plugin_shm;
+      uint32 size_in_bytes;
     };
 
     // Converts |raw_var_data_| to |var_|. It is a no-op if |raw_var_data_| is
@@ -160,6 +202,17 @@ class PPAPI_PROXY_EXPORT SerializedVar {
 
     CleanupMode cleanup_mode_;
 
+    // How to send an array buffer |var_|, and the shared memory it is copied
+    // to when it is not sent in the message.
+    ArrayBufferTransport array_buffer_transport_;
+    ScopedPPResource plugin_buffer_;
+    PP_Resource host_buffer_;
+    base::SharedMemoryHandle plugin_handle_;
+    uint32 shmem_size_;
+
+    // The instance a received var was sent to, or 0 if it is not known.
+    PP_Instance receiving_instance_;
+
 #ifndef NDEBUG
     // When being sent or received over IPC, we should only be serialized or
     // deserialized once. These flags help us assert this is true.
@@ -208,6 +261,22 @@ class PPAPI_PROXY_EXPORT SerializedVarSendInput : public SerializedVar {
   SerializedVarSendInput();
 };
 
+// Like SerializedVarSendInput, but array buffers of more than a few hundred
+// kilobytes are copied once into shared memory instead of into the message,
+// and the plugin side maps that memory rather than copying it again. For
+// calls like PostMessage which may carry multi-megabyte array buffers.
+class PPAPI_PROXY_EXPORT SerializedVarSendInputShmem : public SerializedVar {
+ public:
+  SerializedVarSendInputShmem(Dispatcher* dispatcher,
+                              const PP_Var& var,
+                              const PP_Instance& instance);
+
+ private:
+  // Disallow the empty constructor, but keep the default copy constructor
+  // which is required to send the object to the IPC system.
+  SerializedVarSendInputShmem();
+};
+
 // For the calling side of a function returning a var. The sending side uses
 // SerializedVarReturnValue.
 //
@@ -325,6 +394,11 @@ class PPAPI_PROXY_EXPORT SerializedVarReceiveInput {
 
   PP_Var Get(Dispatcher* dispatcher);
 
+  // Same as Get(), for a var that |dispatcher| sent to |instance| with
+  // SerializedVarSendInputShmem. The caller must have checked that |instance|
+  // belongs to |dispatcher|.
+  PP_Var GetForInstance(Dispatcher* dispatcher, PP_Instance instance);
+
  private:
   const SerializedVar& serialized_;
 };
@@ -20,6 +20,12 @@ class TestVarTracker : public VarTracker {
   virtual ArrayBufferVar* CreateArrayBuffer(uint32 size_in_bytes) OVERRIDE {
     return NULL;
   }
+  virtual ArrayBufferVar* CreateShmArrayBuffer(
+      uint32 size_in_bytes,
+      base::SharedMemory* shm) OVERRIDE {
+    delete shm;
+    return NULL;
+  }
 };
 
 // Implementation of PpapiGlobals for tests that don't need either the host- or
@@ -191,7 +191,21 @@ PP_Var VarTracker::MakeArrayBufferPPVar(uint32 size_in_bytes,
   scoped_refptr<ArrayBufferVar> array_buffer(CreateArrayBuffer(size_in_bytes));
   if (!array_buffer)
     return PP_MakeNull();
-  memcpy(array_buffer->Map(), data, size_in_bytes);
+  void* buffer = array_buffer->Map();
+  if (!buffer && size_in_bytes)
+    return PP_MakeNull();
+  memcpy(buffer, data, size_in_bytes);
+  return array_buffer->GetPPVar();
+}
+
+PP_Var VarTracker::MakeArrayBufferPPVar(uint32 size_in_bytes,
+                                        base::SharedMemory* shm) {
+  DCHECK(CalledOnValidThread());
+
+  scoped_refptr<ArrayBufferVar> array_buffer(
+      CreateShmArrayBuffer(size_in_bytes, shm));
+  if (!array_buffer)
+    return PP_MakeNull();
   return array_buffer->GetPPVar();
 }
 
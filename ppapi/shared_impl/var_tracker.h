@@ -10,6 +10,7 @@
 #include "base/basictypes.h"
 #include "base/hash_tables.h"
 #include "base/memory/ref_counted.h"
+#include "base/shared_memory.h"
 #include "base/threading/non_thread_safe.h"
 #include "ppapi/c/pp_module.h"
 #include "ppapi/c/pp_var.h"
@@ -71,6 +72,9 @@ class PPAPI_SHARED_EXPORT VarTracker
   PP_Var MakeArrayBufferPPVar(uint32 size_in_bytes);
   // Same as above, but copy the contents of |data| in to the new array buffer.
   PP_Var MakeArrayBufferPPVar(uint32 size_in_bytes, const void* data);
+  // Same as above, but the contents are in |shm|, which is mapped with at
+  // least |size_in_bytes| and which the new array buffer takes ownership of.
+  PP_Var MakeArrayBufferPPVar(uint32 size_in_bytes, base::SharedMemory* shm);
 
   // Return a vector containing all PP_Vars that are in the tracker. This is
   // to help implement PPB_Testing_Dev.GetLiveVars and should generally not be
@@ -162,6 +166,13 @@ class PPAPI_SHARED_EXPORT VarTracker
   // a real WebKit ArrayBuffer on the host side.
   virtual ArrayBufferVar* CreateArrayBuffer(uint32 size_in_bytes) = 0;
 
+  // Create and return a new ArrayBufferVar of size_in_bytes bytes which uses
+  // the mapped shared memory |shm| as its buffer, taking ownership of it.
+  // Only the plugin side receives array buffers this way; the host side
+  // deletes |shm| and returns NULL.
+  virtual ArrayBufferVar* CreateShmArrayBuffer(uint32 size_in_bytes,
+                                               base::SharedMemory* shm) = 0;
+
   DISALLOW_COPY_AND_ASSIGN(VarTracker);
 };
 
@@ -4,11 +4,14 @@
 
 #include "printing/pdf_metafile_skia.h"
 
+#include <algorithm>
+
 #include "base/eintr_wrapper.h"
 #include "base/file_descriptor_posix.h"
 #include "base/file_util.h"
 #include "base/hash_tables.h"
 #include "base/metrics/histogram.h"
+#include "base/time.h"
 #include "skia/ext/vector_platform_device_skia.h"
 #include "third_party/skia/include/core/SkData.h"
 #include "third_party/skia/include/core/SkRefCnt.h"
@@ -25,12 +28,25 @@
 #include "printing/pdf_metafile_cg_mac.h"
 #endif
 
+namespace {
+
+// The size of the chunks the PDF is written to files in, so that saving it
+// does not need a second copy of the whole document.
+const size_t kWriteChunkSize = 64 * 1024;
+
+}  // namespace
+
 namespace printing {
 
 struct PdfMetafileSkiaData {
+  PdfMetafileSkiaData() : pdf_doc_(new SkPDFDocument), page_count_(0) {}
+
   SkRefPtr<SkPDFDevice> current_page_;
-  SkPDFDocument pdf_doc_;
+  // Holds every page until the PDF is emitted, then is freed.
+  scoped_ptr<SkPDFDocument> pdf_doc_;
   SkDynamicMemoryWStream pdf_stream_;
+  int page_count_;
+  base::TimeTicks first_page_time_;
 #if defined(OS_MACOSX)
   PdfMetafileCg pdf_cg_;
 #endif
@@ -51,6 +67,8 @@ SkDevice* PdfMetafileSkia::StartPageForVectorCanvas(
     const float& scale_factor) {
   DCHECK(!page_outstanding_);
   page_outstanding_ = true;
+  if (data_->first_page_time_.is_null())
+    data_->first_page_time_ = base::TimeTicks::Now();
 
   // Adjust for the margins and apply the scale factor.
   SkMatrix transform;
@@ -79,7 +97,8 @@ bool PdfMetafileSkia::StartPage(const gfx::Size& page_size,
 bool PdfMetafileSkia::FinishPage() {
   DCHECK(data_->current_page_.get());
 
-  data_->pdf_doc_.appendPage(data_->current_page_.get());
+  data_->pdf_doc_->appendPage(data_->current_page_.get());
+  data_->page_count_++;
   page_outstanding_ = false;
   return true;
 }
@@ -88,6 +107,9 @@ bool PdfMetafileSkia::FinishDocument() {
   // Don't do anything if we've already set the data in InitFromData.
   if (data_->pdf_stream_.getOffset())
     return true;
+  // Or if emitting the PDF already failed.
+  if (!data_->pdf_doc_.get())
+    return false;
 
   if (page_outstanding_)
     FinishPage();
@@ -95,7 +117,7 @@ bool PdfMetafileSkia::FinishDocument() {
   data_->current_page_ = NULL;
 
   int font_counts[SkAdvancedTypefaceMetrics::kNotEmbeddable_Font + 1];
-  data_->pdf_doc_.getCountOfFontTypes(font_counts);
+  data_->pdf_doc_->getCountOfFontTypes(font_counts);
   for (int type = 0;
        type <= SkAdvancedTypefaceMetrics::kNotEmbeddable_Font;
        type++) {
@@ -106,7 +128,23 @@ bool PdfMetafileSkia::FinishDocument() {
     }
   }
 
-  return data_->pdf_doc_.emitPDF(&data_->pdf_stream_);
+  bool result = data_->pdf_doc_->emitPDF(&data_->pdf_stream_);
+  // The pages, with their fonts and images, are not needed past this point.
+  data_->pdf_doc_.reset();
+
+  if (data_->page_count_ > 0) {
+    base::TimeDelta elapsed =
+        base::TimeTicks::Now() - data_->first_page_time_;
+    UMA_HISTOGRAM_TIMES("PrintPreview.PdfGenerationTime", elapsed);
+    if (elapsed.InMillisecondsF() > 0) {
+      UMA_HISTOGRAM_COUNTS_1000(
+          "PrintPreview.PdfPagesPerSecond",
+          static_cast<int>(data_->page_count_ * 1000 /
+                           elapsed.InMillisecondsF()));
+    }
+  }
+  UMA_HISTOGRAM_MEMORY_KB("PrintPreview.PdfSize", GetDataSize() / 1024);
+  return result;
 }
 
 uint32 PdfMetafileSkia::GetDataSize() const {
@@ -118,21 +156,31 @@ bool PdfMetafileSkia::GetData(void* dst_buffer,
   if (dst_buffer_size < GetDataSize())
     return false;
 
-  SkAutoDataUnref data(data_->pdf_stream_.copyToData());
-  memcpy(dst_buffer, data.bytes(), dst_buffer_size);
+  data_->pdf_stream_.copyTo(dst_buffer);
   return true;
 }
 
 bool PdfMetafileSkia::SaveTo(const FilePath& file_path) const {
   DCHECK_GT(data_->pdf_stream_.getOffset(), 0U);
-  SkAutoDataUnref data(data_->pdf_stream_.copyToData());
-  if (file_util::WriteFile(file_path,
-                           reinterpret_cast<const char*>(data.data()),
-                           GetDataSize()) != static_cast<int>(GetDataSize())) {
-    DLOG(ERROR) << "Failed to save file " << file_path.value().c_str();
+  FILE* file = file_util::OpenFile(file_path, "wb");
+  if (!file) {
+    DLOG(ERROR) << "Failed to open file " << file_path.value().c_str();
     return false;
   }
-  return true;
+
+  bool result = true;
+  scoped_array<char> buffer(new char[kWriteChunkSize]);
+  for (size_t offset = 0; result && offset < GetDataSize();
+       offset += kWriteChunkSize) {
+    size_t size = std::min<size_t>(kWriteChunkSize, GetDataSize() - offset);
+    result = data_->pdf_stream_.read(buffer.get(), offset, size) &&
+             fwrite(buffer.get(), 1, size, file) == size;
+  }
+  if (!file_util::CloseFile(file))
+    result = false;
+  if (!result)
+    DLOG(ERROR) << "Failed to save file " << file_path.value().c_str();
+  return result;
 }
 
 gfx::Rect PdfMetafileSkia::GetPageBounds(unsigned int page_number) const {
@@ -205,14 +253,16 @@ bool PdfMetafileSkia::SaveToFD(const base::FileDescriptor& fd) const {
   }
 
   bool result = true;
-  SkAutoDataUnref data(data_->pdf_stream_.copyToData());
-  if (file_util::WriteFileDescriptor(fd.fd,
-                                     reinterpret_cast<const char*>(data.data()),
-                                     GetDataSize()) !=
-      static_cast<int>(GetDataSize())) {
-    DLOG(ERROR) << "Failed to save file with fd " << fd.fd;
-    result = false;
+  scoped_array<char> buffer(new char[kWriteChunkSize]);
+  for (size_t offset = 0; result && offset < GetDataSize();
+       offset += kWriteChunkSize) {
+    size_t size = std::min<size_t>(kWriteChunkSize, GetDataSize() - offset);
+    result = data_->pdf_stream_.read(buffer.get(), offset, size) &&
+             file_util::WriteFileDescriptor(fd.fd, buffer.get(), size) ==
+                 static_cast<int>(size);
   }
+  if (!result)
+    DLOG(ERROR) << "Failed to save file with fd " << fd.fd;
 
   if (fd.auto_close) {
     if (HANDLE_EINTR(close(fd.fd)) < 0) {
@@ -8,6 +8,7 @@
 #include "base/bind.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/time.h"
 #include "media/base/video_frame.h"
 #include "remoting/base/base_mock_objects.h"
 #include "remoting/base/codec_test.h"
@@ -348,4 +349,46 @@ void TestEncoderDecoder(Encoder* encoder, Decoder* decoder, bool strict) {
                         kTestRects + 3, 2);
 }
 
+static void DiscardPacket(scoped_ptr<VideoPacket> packet) {
+}
+
+double MeasureEncodeTimePerMegapixel(Encoder* encoder,
+                                     const SkISize& size,
+                                     const SkIRect& dirty_rect,
+                                     int frame_count) {
+  CHECK_GT(frame_count, 0);
+  const int stride = size.width() * kBytesPerPixel;
+  scoped_array<uint8> memory(new uint8[stride * size.height()]);
+  srand(0);
+  for (int i = 0; i < stride * size.height(); ++i)
+    memory[i] = rand() % 256;
+
+  DataPlanes planes;
+  memset(planes.data, 0, sizeof(planes.data));
+  memset(planes.strides, 0, sizeof(planes.strides));
+  planes.data[0] = memory.get();
+  planes.strides[0] = stride;
+  scoped_refptr<CaptureData> data =
+      new CaptureData(planes, size, media::VideoFrame::RGB32);
+
+  base::TimeDelta total_time;
+  for (int frame = 0; frame < frame_count; ++frame) {
+    // Change the dirty rect so that the encoder has new content to code.
+    for (int y = dirty_rect.top(); y < dirty_rect.bottom(); ++y) {
+      uint8* row = memory.get() + y * stride + dirty_rect.left() *
+          kBytesPerPixel;
+      for (int x = 0; x < dirty_rect.width() * kBytesPerPixel; ++x)
+        row[x] = rand() % 256;
+    }
+    data->mutable_dirty_region().setRect(dirty_rect);
+
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    encoder->Encode(data, false, base::Bind(&DiscardPacket));
+    total_time += base::TimeTicks::HighResNow() - start;
+  }
+
+  double megapixels = size.width() * size.height() / 1000000.0;
+  return total_time.InMillisecondsF() / frame_count / megapixels;
+}
+
 }  // namespace remoting
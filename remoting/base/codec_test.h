@@ -32,6 +32,14 @@ void TestEncoder(Encoder* encoder, bool strict);
 // are correct.
 void TestEncoderDecoder(Encoder* encoder, Decoder* decoder, bool strict);
 
+// Encodes |frame_count| frames of |size| in which |dirty_rect| changes every
+// frame and returns the average encode time per megapixel of the screen, in
+// milliseconds.
+double MeasureEncodeTimePerMegapixel(Encoder* encoder,
+                                     const SkISize& size,
+                                     const SkIRect& dirty_rect,
+                                     int frame_count);
+
 }  // namespace remoting
 
 #endif  // REMOTING_BASE_CODEC_TEST_H_
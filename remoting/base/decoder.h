@@ -12,6 +12,10 @@
 #include "third_party/skia/include/core/SkRegion.h"
 #include "third_party/skia/include/core/SkSize.h"
 
+namespace media {
+class VideoFrame;
+}  // namespace media
+
 namespace remoting {
 
 // Interface for a decoder that takes a stream of bytes from the network and
@@ -69,6 +73,17 @@ class Decoder {
                            uint8* image_buffer,
                            int image_stride,
                            SkRegion* output_region) = 0;
+
+  // Copies the invalidated pixels of the last decoded frame to the YV12
+  // |frame|, which has the source size, so that the caller can convert and
+  // scale them itself, e.g. on the GPU. Pixels outside the invalidated area
+  // are left untouched. On return, |output_region| contains the copied area
+  // in source coordinates. Returns false if the decoder does not produce YUV
+  // frames, in which case RenderFrame() must be used.
+  virtual bool RenderYUVFrame(media::VideoFrame* frame,
+                              SkRegion* output_region) {
+    return false;
+  }
 };
 
 }  // namespace remoting
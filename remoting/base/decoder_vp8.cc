@@ -8,6 +8,7 @@
 
 #include "base/logging.h"
 #include "media/base/media.h"
+#include "media/base/video_frame.h"
 #include "media/base/yuv_convert.h"
 #include "remoting/base/util.h"
 
@@ -16,6 +17,23 @@ extern "C" {
 #include "third_party/libvpx/libvpx.h"
 }
 
+namespace {
+
+// Copies |rect| of a plane of 8 bit samples.
+void CopyPlaneRect(const uint8* src, int src_stride,
+                   uint8* dest, int dest_stride,
+                   const SkIRect& rect) {
+  src += rect.fTop * src_stride + rect.fLeft;
+  dest += rect.fTop * dest_stride + rect.fLeft;
+  for (int y = 0; y < rect.height(); ++y) {
+    memcpy(dest, src, rect.width());
+    src += src_stride;
+    dest += dest_stride;
+  }
+}
+
+}  // namespace
+
 namespace remoting {
 
 DecoderVp8::DecoderVp8()
@@ -171,4 +189,44 @@ void DecoderVp8::RenderFrame(const SkISize& view_size,
                      SkRegion::kDifference_Op);
 }
 
+bool DecoderVp8::RenderYUVFrame(media::VideoFrame* frame,
+                                SkRegion* output_region) {
+  DCHECK_EQ(kReady, state_);
+  DCHECK_EQ(media::VideoFrame::YV12, frame->format());
+
+  // Nothing to copy if we haven't yet decoded any frames.
+  if (!last_image_)
+    return true;
+
+  SkIRect source_clip = SkIRect::MakeWH(last_image_->d_w, last_image_->d_h);
+  if (!source_clip.intersect(SkIRect::MakeWH(frame->width(), frame->height())))
+    return true;
+
+  for (SkRegion::Iterator i(updated_region_); !i.done(); i.next()) {
+    // Chroma is subsampled by two in both directions, so copy whole 2x2
+    // blocks of luma.
+    SkIRect rect = AlignRect(i.rect());
+    if (!rect.intersect(source_clip))
+      continue;
+    SkIRect uv_rect = SkIRect::MakeLTRB(rect.fLeft / 2, rect.fTop / 2,
+                                        (rect.fRight + 1) / 2,
+                                        (rect.fBottom + 1) / 2);
+
+    CopyPlaneRect(last_image_->planes[0], last_image_->stride[0],
+                  frame->data(media::VideoFrame::kYPlane),
+                  frame->stride(media::VideoFrame::kYPlane), rect);
+    CopyPlaneRect(last_image_->planes[1], last_image_->stride[1],
+                  frame->data(media::VideoFrame::kUPlane),
+                  frame->stride(media::VideoFrame::kUPlane), uv_rect);
+    CopyPlaneRect(last_image_->planes[2], last_image_->stride[2],
+                  frame->data(media::VideoFrame::kVPlane),
+                  frame->stride(media::VideoFrame::kVPlane), uv_rect);
+
+    output_region->op(rect, SkRegion::kUnion_Op);
+  }
+
+  updated_region_.setEmpty();
+  return true;
+}
+
 }  // namespace remoting
@@ -29,6 +29,8 @@ class DecoderVp8 : public Decoder {
                            uint8* image_buffer,
                            int image_stride,
                            SkRegion* output_region) OVERRIDE;
+  virtual bool RenderYUVFrame(media::VideoFrame* frame,
+                              SkRegion* output_region) OVERRIDE;
 
  private:
   enum State {
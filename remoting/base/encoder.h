@@ -41,6 +41,11 @@ class Encoder {
   virtual void Encode(scoped_refptr<CaptureData> capture_data,
                       bool key_frame,
                       const DataAvailableCallback& data_available_callback) = 0;
+
+  // Sets the bitrate the encoder should not exceed, e.g. the estimated
+  // bandwidth of the network. 0 removes the limit. Encoders that can't control
+  // their output rate ignore it.
+  virtual void SetTargetBitrate(int kilobits_per_second) {}
 };
 
 }  // namespace remoting
@@ -4,6 +4,8 @@
 
 #include "remoting/base/encoder_vp8.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/sys_info.h"
 #include "media/base/yuv_convert.h"
@@ -23,7 +25,32 @@ namespace {
 // map for the encoder.
 const int kMacroBlockSize = 16;
 
-}  // namespace remoting
+// Frames are stamped in milliseconds.
+const int kTimebaseDenominator = 1000;
+
+// The duration given to the first frame and the longest duration given to any
+// frame, so that an idle period does not hand a burst of bits to the next
+// frame.
+const int kDefaultFrameDurationMs = 50;
+const int kMaxFrameDurationMs = 1000;
+
+// Quantizer range of frames in which most of the screen changed, like
+// scrolling or video.
+const unsigned int kMinQuantizer = 20;
+const unsigned int kMaxQuantizer = 30;
+
+// Updates covering at most 1/kSmallUpdateFraction of the macroblocks, like
+// typing or a blinking caret, cost few bits, so they are encoded with a finer
+// quantizer to keep text sharp.
+const int kSmallUpdateFraction = 16;
+const unsigned int kSmallUpdateMinQuantizer = 4;
+const unsigned int kSmallUpdateMaxQuantizer = 16;
+
+// The coarsest quantizer for large updates when the bitrate is limited by the
+// network, so that the rate control can actually meet the target.
+const unsigned int kBitrateLimitedMaxQuantizer = 48;
+
+}  // namespace
 
 namespace remoting {
 
@@ -34,7 +61,9 @@ EncoderVp8::EncoderVp8()
       active_map_width_(0),
       active_map_height_(0),
       last_timestamp_(0),
-      size_(SkISize::Make(0, 0)) {
+      size_(SkISize::Make(0, 0)),
+      target_bitrate_kbps_(0),
+      default_bitrate_kbps_(0) {
 }
 
 EncoderVp8::~EncoderVp8() {
@@ -53,6 +82,7 @@ bool EncoderVp8::Init(const SkISize& size) {
   Destroy();
   size_ = size;
   codec_.reset(new vpx_codec_ctx_t());
+  config_.reset(new vpx_codec_enc_cfg_t());
   image_.reset(new vpx_image_t());
   memset(image_.get(), 0, sizeof(vpx_image_t));
 
@@ -106,7 +136,7 @@ bool EncoderVp8::Init(const SkISize& size) {
   image_->stride[1] = image_->w / 2;
   image_->stride[2] = image_->w / 2;
 
-  vpx_codec_enc_cfg_t config;
+  vpx_codec_enc_cfg_t& config = *config_;
   const vpx_codec_iface_t* algo = vpx_codec_vp8_cx();
   CHECK(algo);
   vpx_codec_err_t ret = vpx_codec_enc_config_default(algo, &config, 0);
@@ -115,6 +145,9 @@ bool EncoderVp8::Init(const SkISize& size) {
 
   config.rc_target_bitrate = size.width() * size.height() *
       config.rc_target_bitrate / config.g_w / config.g_h;
+  default_bitrate_kbps_ = config.rc_target_bitrate;
+  if (IsBitrateLimited())
+    config.rc_target_bitrate = target_bitrate_kbps_;
   config.g_w = size.width();
   config.g_h = size.height();
   config.g_pass = VPX_RC_ONE_PASS;
@@ -129,14 +162,17 @@ bool EncoderVp8::Init(const SkISize& size) {
   // windows systems can really hurt performance.
   // http://crbug.com/99179
   config.g_threads = (base::SysInfo::NumberOfProcessors() > 2) ? 2 : 1;
-  config.rc_min_quantizer = 20;
-  config.rc_max_quantizer = 30;
+  config.rc_min_quantizer = kMinQuantizer;
+  config.rc_max_quantizer = kMaxQuantizer;
   config.g_timebase.num = 1;
-  config.g_timebase.den = 20;
+  config.g_timebase.den = kTimebaseDenominator;
 
   if (vpx_codec_enc_init(codec_.get(), algo, &config, 0))
     return false;
 
+  last_timestamp_ = 0;
+  last_encode_time_ = base::TimeTicks();
+
   // Value of 16 will have the smallest CPU load. This turns off subpixel
   // motion search.
   if (vpx_codec_control(codec_.get(), VP8E_SET_CPUUSED, 16))
@@ -195,9 +231,10 @@ bool EncoderVp8::PrepareImage(scoped_refptr<CaptureData> capture_data,
   return true;
 }
 
-void EncoderVp8::PrepareActiveMap(const RectVector& updated_rects) {
+int EncoderVp8::PrepareActiveMap(const RectVector& updated_rects) {
   // Clear active map first.
   memset(active_map_.get(), 0, active_map_width_ * active_map_height_);
+  int active_blocks = 0;
 
   // Mark blocks at active.
   for (size_t i = 0; i < updated_rects.size(); ++i) {
@@ -213,11 +250,68 @@ void EncoderVp8::PrepareActiveMap(const RectVector& updated_rects) {
 
     uint8* map = active_map_.get() + top * active_map_width_;
     for (int y = top; y <= bottom; ++y) {
-      for (int x = left; x <= right; ++x)
+      for (int x = left; x <= right; ++x) {
+        // Rects may overlap once aligned to macroblocks.
+        active_blocks += !map[x];
         map[x] = 1;
+      }
       map += active_map_width_;
     }
   }
+  return active_blocks;
+}
+
+void EncoderVp8::UpdateQuantizer(int active_blocks) {
+  unsigned int min_quantizer = kMinQuantizer;
+  unsigned int max_quantizer = kMaxQuantizer;
+  if (active_blocks * kSmallUpdateFraction <=
+      active_map_width_ * active_map_height_) {
+    min_quantizer = kSmallUpdateMinQuantizer;
+    max_quantizer = kSmallUpdateMaxQuantizer;
+  } else if (IsBitrateLimited()) {
+    max_quantizer = kBitrateLimitedMaxQuantizer;
+  }
+
+  if (config_->rc_min_quantizer == min_quantizer &&
+      config_->rc_max_quantizer == max_quantizer) {
+    return;
+  }
+  config_->rc_min_quantizer = min_quantizer;
+  config_->rc_max_quantizer = max_quantizer;
+  if (vpx_codec_enc_config_set(codec_.get(), config_.get())) {
+    LOG(ERROR) << "Unable to set the quantizer range";
+  }
+}
+
+bool EncoderVp8::IsBitrateLimited() const {
+  return target_bitrate_kbps_ > 0 &&
+      static_cast<unsigned int>(target_bitrate_kbps_) < default_bitrate_kbps_;
+}
+
+void EncoderVp8::SetTargetBitrate(int kilobits_per_second) {
+  target_bitrate_kbps_ = kilobits_per_second;
+  if (!initialized_)
+    return;
+
+  unsigned int bitrate = IsBitrateLimited() ?
+      static_cast<unsigned int>(target_bitrate_kbps_) : default_bitrate_kbps_;
+  if (config_->rc_target_bitrate == bitrate)
+    return;
+  config_->rc_target_bitrate = bitrate;
+  if (vpx_codec_enc_config_set(codec_.get(), config_.get())) {
+    LOG(ERROR) << "Unable to set the target bitrate";
+  }
+}
+
+int EncoderVp8::GetFrameDuration() {
+  base::TimeTicks now = base::TimeTicks::Now();
+  int duration_ms = kDefaultFrameDurationMs;
+  if (!last_encode_time_.is_null()) {
+    duration_ms = static_cast<int>((now - last_encode_time_).InMilliseconds());
+    duration_ms = std::max(1, std::min(duration_ms, kMaxFrameDurationMs));
+  }
+  last_encode_time_ = now;
+  return duration_ms * kTimebaseDenominator / 1000;
 }
 
 void EncoderVp8::Encode(scoped_refptr<CaptureData> capture_data,
@@ -236,7 +330,8 @@ void EncoderVp8::Encode(scoped_refptr<CaptureData> capture_data,
   }
 
   // Update active map based on updated rectangles.
-  PrepareActiveMap(updated_rects);
+  int active_blocks = PrepareActiveMap(updated_rects);
+  UpdateQuantizer(active_blocks);
 
   // Apply active map to the encoder.
   vpx_active_map_t act_map;
@@ -247,17 +342,19 @@ void EncoderVp8::Encode(scoped_refptr<CaptureData> capture_data,
     LOG(ERROR) << "Unable to apply active map";
   }
 
-  // Do the actual encoding.
+  // Do the actual encoding. The capture rate varies with the capture and
+  // encode times, so each frame is given the time that actually passed since
+  // the previous one for the rate control to spread the bitrate over.
+  int duration = GetFrameDuration();
   vpx_codec_err_t ret = vpx_codec_encode(codec_.get(), image_.get(),
                                          last_timestamp_,
-                                         1, 0, VPX_DL_REALTIME);
+                                         duration, 0, VPX_DL_REALTIME);
   DCHECK_EQ(ret, VPX_CODEC_OK)
       << "Encoding error: " << vpx_codec_err_to_string(ret) << "\n"
       << "Details: " << vpx_codec_error(codec_.get()) << "\n"
       << vpx_codec_error_detail(codec_.get());
 
-  // TODO(hclam): Apply the proper timestamp here.
-  last_timestamp_ += 50;
+  last_timestamp_ += duration;
 
   // Read the encoded data.
   vpx_codec_iter_t iter = NULL;
@@ -8,10 +8,12 @@
 #include <vector>
 
 #include "base/gtest_prod_util.h"
+#include "base/time.h"
 #include "remoting/base/encoder.h"
 #include "third_party/skia/include/core/SkRect.h"
 
 typedef struct vpx_codec_ctx vpx_codec_ctx_t;
+typedef struct vpx_codec_enc_cfg vpx_codec_enc_cfg_t;
 typedef struct vpx_image vpx_image_t;
 
 namespace remoting {
@@ -26,11 +28,14 @@ class EncoderVp8 : public Encoder {
       scoped_refptr<CaptureData> capture_data,
       bool key_frame,
       const DataAvailableCallback& data_available_callback) OVERRIDE;
+  virtual void SetTargetBitrate(int kilobits_per_second) OVERRIDE;
 
  private:
   typedef std::vector<SkIRect> RectVector;
 
   FRIEND_TEST_ALL_PREFIXES(EncoderVp8Test, AlignAndClipRect);
+  FRIEND_TEST_ALL_PREFIXES(EncoderVp8Test, QuantizerFollowsDirtyArea);
+  FRIEND_TEST_ALL_PREFIXES(EncoderVp8Test, TargetBitrate);
 
   // Initialize the encoder. Returns true if successful.
   bool Init(const SkISize& size);
@@ -44,8 +49,22 @@ class EncoderVp8 : public Encoder {
                     RectVector* updated_rects);
 
   // Update the active map according to |updated_rects|. Active map is then
-  // given to the encoder to speed up encoding.
-  void PrepareActiveMap(const RectVector& updated_rects);
+  // given to the encoder to speed up encoding. Returns the number of active
+  // macroblocks.
+  int PrepareActiveMap(const RectVector& updated_rects);
+
+  // Picks the quantizer range for a frame in which |active_blocks| of the
+  // macroblocks changed and reconfigures the encoder if the range differs
+  // from the current one.
+  void UpdateQuantizer(int active_blocks);
+
+  // Returns true if the bitrate target set by SetTargetBitrate() is below the
+  // bitrate the encoder would use for the frame size.
+  bool IsBitrateLimited() const;
+
+  // Returns the duration of the frame being encoded in the units of the
+  // encoder's timebase, measured from the previous call.
+  int GetFrameDuration();
 
   // Align the sides of the rectangle to multiples of 2 (expanding outwards),
   // but ensuring the result stays within the screen area (width, height).
@@ -59,18 +78,28 @@ class EncoderVp8 : public Encoder {
   bool initialized_;
 
   scoped_ptr<vpx_codec_ctx_t> codec_;
+  scoped_ptr<vpx_codec_enc_cfg_t> config_;
   scoped_ptr<vpx_image_t> image_;
   scoped_array<uint8> active_map_;
   int active_map_width_;
   int active_map_height_;
   int last_timestamp_;
 
+  // When the previous frame was encoded, so that frames are stamped with the
+  // rate CaptureScheduler actually captures at.
+  base::TimeTicks last_encode_time_;
+
   // Buffer for storing the yuv image.
   scoped_array<uint8> yuv_image_;
 
   // The current frame size.
   SkISize size_;
 
+  // The bitrate limit set by SetTargetBitrate(), or 0, and the bitrate the
+  // encoder uses for the current frame size when not limited.
+  int target_bitrate_kbps_;
+  unsigned int default_bitrate_kbps_;
+
   DISALLOW_COPY_AND_ASSIGN(EncoderVp8);
 };
 
@@ -7,6 +7,7 @@
 
 #include "base/bind.h"
 #include "base/callback.h"
+#include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "remoting/base/capture_data.h"
 #include "remoting/base/codec_test.h"
@@ -14,6 +15,11 @@
 #include "remoting/proto/video.pb.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+extern "C" {
+#define VPX_CODEC_DISABLE_COMPAT 1
+#include "third_party/libvpx/libvpx.h"
+}
+
 namespace {
 
 const int kIntMax = std::numeric_limits<int>::max();
@@ -85,4 +91,64 @@ TEST(EncoderVp8Test, AlignAndClipRect) {
             SkIRect::MakeXYWH(100, 200, 98, 98));
 }
 
+// Test that small updates are coded with a finer quantizer than updates of
+// most of the screen.
+TEST(EncoderVp8Test, QuantizerFollowsDirtyArea) {
+  const SkISize kSize = SkISize::Make(640, 480);
+  EncoderVp8 encoder;
+  MeasureEncodeTimePerMegapixel(&encoder, kSize,
+                                SkIRect::MakeSize(kSize), 1);
+  unsigned int full_frame_quantizer = encoder.config_->rc_max_quantizer;
+
+  MeasureEncodeTimePerMegapixel(&encoder, kSize,
+                                SkIRect::MakeXYWH(32, 32, 64, 16), 1);
+  EXPECT_LT(encoder.config_->rc_max_quantizer, full_frame_quantizer);
+
+  MeasureEncodeTimePerMegapixel(&encoder, kSize,
+                                SkIRect::MakeSize(kSize), 1);
+  EXPECT_EQ(full_frame_quantizer, encoder.config_->rc_max_quantizer);
+}
+
+TEST(EncoderVp8Test, TargetBitrate) {
+  const SkISize kSize = SkISize::Make(640, 480);
+  EncoderVp8 encoder;
+  MeasureEncodeTimePerMegapixel(&encoder, kSize,
+                                SkIRect::MakeSize(kSize), 1);
+  unsigned int default_bitrate = encoder.config_->rc_target_bitrate;
+  unsigned int full_frame_quantizer = encoder.config_->rc_max_quantizer;
+
+  // A limit below the default bitrate lowers it and allows coarser
+  // quantizers for large updates.
+  encoder.SetTargetBitrate(default_bitrate / 4);
+  EXPECT_EQ(default_bitrate / 4, encoder.config_->rc_target_bitrate);
+  MeasureEncodeTimePerMegapixel(&encoder, kSize,
+                                SkIRect::MakeSize(kSize), 1);
+  EXPECT_GT(encoder.config_->rc_max_quantizer, full_frame_quantizer);
+
+  // A limit above the default bitrate has no effect.
+  encoder.SetTargetBitrate(default_bitrate * 4);
+  EXPECT_EQ(default_bitrate, encoder.config_->rc_target_bitrate);
+}
+
+// Reports how long a multi-monitor sized screen takes to encode when all of
+// it changes and when only a caret-sized area changes. This only logs its
+// timings, so it is disabled; run it with --gtest_also_run_disabled_tests.
+TEST(EncoderVp8Test, DISABLED_EncodeTimePerMegapixel) {
+  const SkISize kSize = SkISize::Make(2 * 1920, 1200);
+  const int kFrameCount = 10;
+
+  EncoderVp8 full_encoder;
+  double full_ms = MeasureEncodeTimePerMegapixel(
+      &full_encoder, kSize, SkIRect::MakeSize(kSize), kFrameCount);
+
+  EncoderVp8 small_encoder;
+  double small_ms = MeasureEncodeTimePerMegapixel(
+      &small_encoder, kSize, SkIRect::MakeXYWH(100, 100, 32, 32),
+      kFrameCount);
+
+  LOG(INFO) << "Full screen update: " << full_ms << " ms/megapixel";
+  LOG(INFO) << "Small update: " << small_ms << " ms/megapixel";
+  EXPECT_GT(full_ms, 0);
+}
+
 }  // namespace remoting
@@ -5,10 +5,15 @@
 #ifndef REMOTING_CLIENT_FRAME_CONSUMER_H_
 #define REMOTING_CLIENT_FRAME_CONSUMER_H_
 
+#include "base/memory/ref_counted.h"
 #include "third_party/skia/include/core/SkRect.h"
 #include "third_party/skia/include/core/SkRegion.h"
 #include "third_party/skia/include/core/SkSize.h"
 
+namespace media {
+class VideoFrame;
+}  // namespace media
+
 namespace pp {
 class ImageData;
 } // namespace pp
@@ -38,6 +43,17 @@ class FrameConsumer {
   // be freed or reused for another drawing operation.
   virtual void ReturnBuffer(pp::ImageData* buffer) = 0;
 
+  // Accepts a YV12 |frame| passed to FrameProducer::DrawYUVFrame(), whose
+  // |region| was updated. |region| is in source coordinates.
+  virtual void ApplyYUVFrame(const scoped_refptr<media::VideoFrame>& frame,
+                             const SkRegion& region) = 0;
+
+  // Accepts a YV12 |frame| that couldn't be drawn to. If |yuv_supported| is
+  // false, the decoder in use can not produce YUV output and the consumer must
+  // use FrameProducer::DrawBuffer() instead.
+  virtual void ReturnYUVFrame(const scoped_refptr<media::VideoFrame>& frame,
+                              bool yuv_supported) = 0;
+
   // Set the dimension of the entire host screen.
   virtual void SetSourceSize(const SkISize& source_size) = 0;
 
@@ -6,6 +6,7 @@
 
 #include "base/bind.h"
 #include "base/message_loop.h"
+#include "media/base/video_frame.h"
 #include "ppapi/cpp/image_data.h"
 
 namespace remoting {
@@ -41,6 +42,32 @@ void FrameConsumerProxy::ReturnBuffer(pp::ImageData* buffer) {
     frame_consumer_->ReturnBuffer(buffer);
 }
 
+void FrameConsumerProxy::ApplyYUVFrame(
+    const scoped_refptr<media::VideoFrame>& frame,
+    const SkRegion& region) {
+  if (!frame_consumer_message_loop_->BelongsToCurrentThread()) {
+    frame_consumer_message_loop_->PostTask(FROM_HERE, base::Bind(
+        &FrameConsumerProxy::ApplyYUVFrame, this, frame, region));
+    return;
+  }
+
+  if (frame_consumer_)
+    frame_consumer_->ApplyYUVFrame(frame, region);
+}
+
+void FrameConsumerProxy::ReturnYUVFrame(
+    const scoped_refptr<media::VideoFrame>& frame,
+    bool yuv_supported) {
+  if (!frame_consumer_message_loop_->BelongsToCurrentThread()) {
+    frame_consumer_message_loop_->PostTask(FROM_HERE, base::Bind(
+        &FrameConsumerProxy::ReturnYUVFrame, this, frame, yuv_supported));
+    return;
+  }
+
+  if (frame_consumer_)
+    frame_consumer_->ReturnYUVFrame(frame, yuv_supported);
+}
+
 void FrameConsumerProxy::SetSourceSize(const SkISize& source_size) {
   if (!frame_consumer_message_loop_->BelongsToCurrentThread()) {
     frame_consumer_message_loop_->PostTask(FROM_HERE, base::Bind(
@@ -35,6 +35,10 @@ class FrameConsumerProxy
                            pp::ImageData* buffer,
                            const SkRegion& region) OVERRIDE;
   virtual void ReturnBuffer(pp::ImageData* buffer) OVERRIDE;
+  virtual void ApplyYUVFrame(const scoped_refptr<media::VideoFrame>& frame,
+                             const SkRegion& region) OVERRIDE;
+  virtual void ReturnYUVFrame(const scoped_refptr<media::VideoFrame>& frame,
+                              bool yuv_supported) OVERRIDE;
   virtual void SetSourceSize(const SkISize& source_size) OVERRIDE;
 
   // Attaches to |frame_consumer_|.
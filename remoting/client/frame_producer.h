@@ -6,10 +6,15 @@
 #define REMOTING_CLIENT_FRAME_PRODUCER_H_
 
 #include "base/callback_forward.h"
+#include "base/memory/ref_counted.h"
 #include "third_party/skia/include/core/SkRect.h"
 #include "third_party/skia/include/core/SkRegion.h"
 #include "third_party/skia/include/core/SkSize.h"
 
+namespace media {
+class VideoFrame;
+}  // namespace media
+
 namespace pp {
 class ImageData;
 } // namespace pp
@@ -29,6 +34,15 @@ class FrameProducer {
   // The passed buffer must be large enough to hold the whole clipping area.
   virtual void DrawBuffer(pp::ImageData* buffer) = 0;
 
+  // Adds a YV12 |frame| to be filled with the invalidated pixels at source
+  // resolution, for consumers that convert and scale the pixels themselves.
+  // Only the invalidated pixels are written, so the consumer must keep the
+  // rest of the picture. The frame is handed back via
+  // FrameConsumer::ApplyYUVFrame() once painted, or via
+  // FrameConsumer::ReturnYUVFrame() if it no longer matches the source size
+  // or the decoder can not produce YUV output.
+  virtual void DrawYUVFrame(const scoped_refptr<media::VideoFrame>& frame) = 0;
+
   // Requests repainting of the specified |region| of the frame as soon as
   // possible. |region| is specified in output coordinates relative to
   // the beginning of the frame.
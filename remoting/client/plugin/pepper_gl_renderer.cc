@@ -0,0 +1,309 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "remoting/client/plugin/pepper_gl_renderer.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "media/base/video_frame.h"
+#include "ppapi/c/pp_errors.h"
+#include "ppapi/c/ppb_graphics_3d.h"
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/instance.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/lib/gl/include/GLES2/gl2.h"
+
+namespace remoting {
+
+namespace {
+
+const char kVertexShader[] =
+    "attribute vec2 a_position;\n"
+    "attribute vec2 a_texcoord;\n"
+    "varying vec2 v_texcoord;\n"
+    "void main() {\n"
+    "  gl_Position = vec4(a_position, 0.0, 1.0);\n"
+    "  v_texcoord = a_texcoord;\n"
+    "}\n";
+
+// Converts BT.601 studio swing YUV to RGB. The textures are as wide as the
+// strides of the planes, so the texture coordinates of the picture are scaled
+// to the visible part of each plane.
+const char kFragmentShader[] =
+    "precision mediump float;\n"
+    "varying vec2 v_texcoord;\n"
+    "uniform sampler2D y_texture;\n"
+    "uniform sampler2D u_texture;\n"
+    "uniform sampler2D v_texture;\n"
+    "uniform vec2 y_scale;\n"
+    "uniform vec2 uv_scale;\n"
+    "void main() {\n"
+    "  float y = texture2D(y_texture, v_texcoord * y_scale).x;\n"
+    "  float u = texture2D(u_texture, v_texcoord * uv_scale).x - 0.5;\n"
+    "  float v = texture2D(v_texture, v_texcoord * uv_scale).x - 0.5;\n"
+    "  y = 1.164 * (y - 0.0625);\n"
+    "  gl_FragColor = vec4(y + 1.596 * v,\n"
+    "                      y - 0.391 * u - 0.813 * v,\n"
+    "                      y + 2.018 * u,\n"
+    "                      1.0);\n"
+    "}\n";
+
+// A quad covering the whole view, as a triangle strip of x, y, s, t. The first
+// row of the textures is the top of the picture.
+const GLfloat kVertices[] = {
+  -1.0f,  1.0f, 0.0f, 0.0f,
+  -1.0f, -1.0f, 0.0f, 1.0f,
+   1.0f,  1.0f, 1.0f, 0.0f,
+   1.0f, -1.0f, 1.0f, 1.0f,
+};
+
+const char* const kTextureUniforms[] = {
+  "y_texture",
+  "u_texture",
+  "v_texture",
+};
+
+}  // namespace
+
+PepperGLRenderer::PepperGLRenderer(pp::Instance* instance)
+    : instance_(instance),
+      gles2_(static_cast<const PPB_OpenGLES2*>(
+          pp::Module::Get()->GetBrowserInterface(PPB_OPENGLES2_INTERFACE))),
+      context_(0),
+      view_size_(SkISize::Make(0, 0)),
+      frame_size_(SkISize::Make(0, 0)),
+      y_stride_(0),
+      uv_stride_(0),
+      program_(0),
+      vertex_buffer_(0),
+      y_scale_location_(-1),
+      uv_scale_location_(-1) {
+  for (size_t i = 0; i < arraysize(textures_); ++i)
+    textures_[i] = 0;
+}
+
+PepperGLRenderer::~PepperGLRenderer() {
+  if (!context_)
+    return;
+
+  gles2_->DeleteTextures(context_, arraysize(textures_), textures_);
+  gles2_->DeleteBuffers(context_, 1, &vertex_buffer_);
+  gles2_->DeleteProgram(context_, program_);
+}
+
+// static
+bool PepperGLRenderer::IsAvailable() {
+  return pp::Module::Get()->GetBrowserInterface(PPB_OPENGLES2_INTERFACE) &&
+      pp::Module::Get()->GetBrowserInterface(PPB_GRAPHICS_3D_INTERFACE);
+}
+
+bool PepperGLRenderer::SetViewSize(const SkISize& view_size) {
+  DCHECK(gles2_);
+
+  if (view_size_ == view_size)
+    return true;
+  view_size_ = view_size;
+
+  if (!graphics3d_.is_null()) {
+    if (graphics3d_.ResizeBuffers(view_size.width(),
+                                  view_size.height()) != PP_OK) {
+      LOG(ERROR) << "Failed to resize the Graphics3D context.";
+      return false;
+    }
+    gles2_->Viewport(context_, 0, 0, view_size.width(), view_size.height());
+    return true;
+  }
+
+  const int32_t attributes[] = {
+    PP_GRAPHICS3DATTRIB_ALPHA_SIZE, 0,
+    PP_GRAPHICS3DATTRIB_BLUE_SIZE, 8,
+    PP_GRAPHICS3DATTRIB_GREEN_SIZE, 8,
+    PP_GRAPHICS3DATTRIB_RED_SIZE, 8,
+    PP_GRAPHICS3DATTRIB_DEPTH_SIZE, 0,
+    PP_GRAPHICS3DATTRIB_STENCIL_SIZE, 0,
+    PP_GRAPHICS3DATTRIB_SAMPLES, 0,
+    PP_GRAPHICS3DATTRIB_SAMPLE_BUFFERS, 0,
+    PP_GRAPHICS3DATTRIB_WIDTH, view_size.width(),
+    PP_GRAPHICS3DATTRIB_HEIGHT, view_size.height(),
+    PP_GRAPHICS3DATTRIB_NONE,
+  };
+  graphics3d_ = pp::Graphics3D(instance_, attributes);
+  if (graphics3d_.is_null()) {
+    LOG(WARNING) << "Failed to create a Graphics3D context.";
+    return false;
+  }
+  context_ = graphics3d_.pp_resource();
+
+  if (!instance_->BindGraphics(graphics3d_)) {
+    LOG(ERROR) << "Couldn't bind the Graphics3D context.";
+    return false;
+  }
+
+  if (!InitializeGL())
+    return false;
+  gles2_->Viewport(context_, 0, 0, view_size.width(), view_size.height());
+  return true;
+}
+
+void PepperGLRenderer::UploadFrame(media::VideoFrame* frame,
+                                   const SkRegion& region) {
+  DCHECK(context_);
+
+  SkISize frame_size = SkISize::Make(frame->width(), frame->height());
+  int y_stride = frame->stride(media::VideoFrame::kYPlane);
+  int uv_stride = frame->stride(media::VideoFrame::kUPlane);
+  bool reallocate = frame_size_ != frame_size || y_stride_ != y_stride ||
+      uv_stride_ != uv_stride;
+  if (reallocate) {
+    frame_size_ = frame_size;
+    y_stride_ = y_stride;
+    uv_stride_ = uv_stride;
+
+    gles2_->UseProgram(context_, program_);
+    gles2_->Uniform2f(context_, y_scale_location_,
+                      static_cast<GLfloat>(frame_size.width()) / y_stride,
+                      1.0f);
+    gles2_->Uniform2f(context_, uv_scale_location_,
+                      static_cast<GLfloat>((frame_size.width() + 1) / 2) /
+                          uv_stride,
+                      1.0f);
+  }
+
+  // Textures are updated in bands of whole rows, which keeps the number of
+  // uploads down and lets each band be copied straight from the frame.
+  SkRegion rows;
+  for (SkRegion::Iterator i(region); !i.done(); i.next()) {
+    rows.op(SkIRect::MakeLTRB(0, i.rect().top(), 1, i.rect().bottom()),
+            SkRegion::kUnion_Op);
+  }
+
+  UploadPlane(frame, media::VideoFrame::kYPlane, rows, reallocate);
+  UploadPlane(frame, media::VideoFrame::kUPlane, rows, reallocate);
+  UploadPlane(frame, media::VideoFrame::kVPlane, rows, reallocate);
+}
+
+bool PepperGLRenderer::Draw(const pp::CompletionCallback& callback) {
+  DCHECK(context_);
+
+  // The color buffer is undefined after a swap, so the whole view is drawn
+  // every time.
+  gles2_->DrawArrays(context_, GL_TRIANGLE_STRIP, 0, 4);
+
+  int result = graphics3d_.SwapBuffers(callback);
+  if (result != PP_OK_COMPLETIONPENDING) {
+    LOG(ERROR) << "Graphics3D SwapBuffers failed: " << result;
+    return false;
+  }
+  return true;
+}
+
+bool PepperGLRenderer::InitializeGL() {
+  GLuint vertex_shader = CompileShader(GL_VERTEX_SHADER, kVertexShader);
+  GLuint fragment_shader = CompileShader(GL_FRAGMENT_SHADER, kFragmentShader);
+  program_ = gles2_->CreateProgram(context_);
+  gles2_->AttachShader(context_, program_, vertex_shader);
+  gles2_->AttachShader(context_, program_, fragment_shader);
+  gles2_->BindAttribLocation(context_, program_, 0, "a_position");
+  gles2_->BindAttribLocation(context_, program_, 1, "a_texcoord");
+  gles2_->LinkProgram(context_, program_);
+  gles2_->DeleteShader(context_, vertex_shader);
+  gles2_->DeleteShader(context_, fragment_shader);
+
+  GLint linked = 0;
+  gles2_->GetProgramiv(context_, program_, GL_LINK_STATUS, &linked);
+  if (!linked) {
+    LOG(ERROR) << "Failed to link the YUV conversion program.";
+    return false;
+  }
+  gles2_->UseProgram(context_, program_);
+  y_scale_location_ =
+      gles2_->GetUniformLocation(context_, program_, "y_scale");
+  uv_scale_location_ =
+      gles2_->GetUniformLocation(context_, program_, "uv_scale");
+
+  gles2_->GenBuffers(context_, 1, &vertex_buffer_);
+  gles2_->BindBuffer(context_, GL_ARRAY_BUFFER, vertex_buffer_);
+  gles2_->BufferData(context_, GL_ARRAY_BUFFER, sizeof(kVertices), kVertices,
+                     GL_STATIC_DRAW);
+  gles2_->EnableVertexAttribArray(context_, 0);
+  gles2_->VertexAttribPointer(context_, 0, 2, GL_FLOAT, GL_FALSE,
+                              4 * sizeof(GLfloat), 0);
+  gles2_->EnableVertexAttribArray(context_, 1);
+  gles2_->VertexAttribPointer(
+      context_, 1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat),
+      reinterpret_cast<const void*>(2 * sizeof(GLfloat)));
+
+  // Rows of the planes aren't padded to four bytes.
+  gles2_->PixelStorei(context_, GL_UNPACK_ALIGNMENT, 1);
+  gles2_->Disable(context_, GL_DEPTH_TEST);
+  gles2_->Disable(context_, GL_BLEND);
+
+  gles2_->GenTextures(context_, arraysize(textures_), textures_);
+  for (size_t i = 0; i < arraysize(textures_); ++i) {
+    gles2_->ActiveTexture(context_, GL_TEXTURE0 + i);
+    gles2_->BindTexture(context_, GL_TEXTURE_2D, textures_[i]);
+    gles2_->TexParameteri(context_, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                          GL_LINEAR);
+    gles2_->TexParameteri(context_, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+                          GL_LINEAR);
+    gles2_->TexParameteri(context_, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
+                          GL_CLAMP_TO_EDGE);
+    gles2_->TexParameteri(context_, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
+                          GL_CLAMP_TO_EDGE);
+    gles2_->Uniform1i(context_,
+                      gles2_->GetUniformLocation(context_, program_,
+                                                 kTextureUniforms[i]),
+                      i);
+  }
+  return true;
+}
+
+GLuint PepperGLRenderer::CompileShader(GLenum type, const char* source) {
+  GLuint shader = gles2_->CreateShader(context_, type);
+  gles2_->ShaderSource(context_, shader, 1, &source, NULL);
+  gles2_->CompileShader(context_, shader);
+
+  GLint compiled = 0;
+  gles2_->GetShaderiv(context_, shader, GL_COMPILE_STATUS, &compiled);
+  LOG_IF(ERROR, !compiled) << "Failed to compile shader " << type;
+  return shader;
+}
+
+void PepperGLRenderer::UploadPlane(media::VideoFrame* frame,
+                                   size_t plane,
+                                   const SkRegion& rows,
+                                   bool reallocate) {
+  // The textures are bound to the texture unit of the same index as the plane.
+  gles2_->ActiveTexture(context_, GL_TEXTURE0 + plane);
+
+  int stride = frame->stride(plane);
+  int height = frame_size_.height();
+  if (plane != media::VideoFrame::kYPlane)
+    height = (height + 1) / 2;
+
+  if (reallocate) {
+    gles2_->TexImage2D(context_, GL_TEXTURE_2D, 0, GL_LUMINANCE, stride,
+                       height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
+                       frame->data(plane));
+    return;
+  }
+
+  for (SkRegion::Iterator i(rows); !i.done(); i.next()) {
+    int top = i.rect().top();
+    int bottom = i.rect().bottom();
+    if (plane != media::VideoFrame::kYPlane) {
+      top /= 2;
+      bottom = (bottom + 1) / 2;
+    }
+    bottom = std::min(bottom, height);
+    if (top >= bottom)
+      continue;
+    gles2_->TexSubImage2D(context_, GL_TEXTURE_2D, 0, 0, top, stride,
+                          bottom - top, GL_LUMINANCE, GL_UNSIGNED_BYTE,
+                          frame->data(plane) + top * stride);
+  }
+}
+
+}  // namespace remoting
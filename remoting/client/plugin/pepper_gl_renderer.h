@@ -0,0 +1,87 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// PepperGLRenderer draws YV12 frames to a Graphics3D context, converting them
+// to RGB and scaling them to the view size on the GPU. Only the invalidated
+// rows of each frame are uploaded to the textures.
+
+#ifndef REMOTING_CLIENT_PLUGIN_PEPPER_GL_RENDERER_H_
+#define REMOTING_CLIENT_PLUGIN_PEPPER_GL_RENDERER_H_
+
+#include "base/basictypes.h"
+#include "ppapi/c/ppb_opengles2.h"
+#include "ppapi/cpp/graphics_3d.h"
+#include "third_party/skia/include/core/SkRegion.h"
+#include "third_party/skia/include/core/SkSize.h"
+
+namespace media {
+class VideoFrame;
+}  // namespace media
+
+namespace pp {
+class CompletionCallback;
+class Instance;
+}  // namespace pp
+
+namespace remoting {
+
+class PepperGLRenderer {
+ public:
+  explicit PepperGLRenderer(pp::Instance* instance);
+  ~PepperGLRenderer();
+
+  // Returns true if the browser supports OpenGL ES 2.0 for plugins.
+  static bool IsAvailable();
+
+  // Creates the context, or resizes it if it already exists, and binds it to
+  // the instance. Returns false if the context couldn't be created or bound.
+  bool SetViewSize(const SkISize& view_size);
+
+  // Uploads the rows of |frame| touched by |region| to the textures. The
+  // textures are reallocated, and the whole frame uploaded, if the size of
+  // |frame| has changed.
+  void UploadFrame(media::VideoFrame* frame, const SkRegion& region);
+
+  // Draws the uploaded picture scaled to the view and swaps the buffers.
+  // |callback| is called when the swap completes. Returns false if the
+  // context is lost, in which case the caller should fall back to
+  // Graphics2D.
+  bool Draw(const pp::CompletionCallback& callback);
+
+ private:
+  // Compiles the shaders and creates the textures and the vertex buffer.
+  bool InitializeGL();
+
+  GLuint CompileShader(GLenum type, const char* source);
+
+  // Uploads |rows| of |plane| of |frame| as full width bands, or the whole
+  // plane if |reallocate| is true.
+  void UploadPlane(media::VideoFrame* frame, size_t plane, const SkRegion& rows,
+                   bool reallocate);
+
+  pp::Instance* instance_;
+  const PPB_OpenGLES2* gles2_;
+  pp::Graphics3D graphics3d_;
+  PP_Resource context_;
+
+  SkISize view_size_;
+
+  // The size and strides of the frame the textures were allocated for.
+  SkISize frame_size_;
+  int y_stride_;
+  int uv_stride_;
+
+  GLuint program_;
+  GLuint vertex_buffer_;
+  // Indexed by media::VideoFrame plane.
+  GLuint textures_[3];
+  GLint y_scale_location_;
+  GLint uv_scale_location_;
+
+  DISALLOW_COPY_AND_ASSIGN(PepperGLRenderer);
+};
+
+}  // namespace remoting
+
+#endif  // REMOTING_CLIENT_PLUGIN_PEPPER_GL_RENDERER_H_
@@ -9,6 +9,7 @@
 #include "base/message_loop.h"
 #include "base/string_util.h"
 #include "base/synchronization/waitable_event.h"
+#include "media/base/video_frame.h"
 #include "ppapi/cpp/completion_callback.h"
 #include "ppapi/cpp/graphics_2d.h"
 #include "ppapi/cpp/image_data.h"
@@ -20,6 +21,7 @@
 #include "remoting/client/client_context.h"
 #include "remoting/client/frame_producer.h"
 #include "remoting/client/plugin/chromoting_instance.h"
+#include "remoting/client/plugin/pepper_gl_renderer.h"
 #include "remoting/client/plugin/pepper_util.h"
 
 using base::Passed;
@@ -78,7 +80,12 @@ PepperView::PepperView(ChromotingInstance* instance,
     clip_area_(SkIRect::MakeEmpty()),
     source_size_(SkISize::Make(0, 0)),
     flush_pending_(false),
+    yuv_frame_pending_(false),
+    swap_pending_(false),
+    redraw_needed_(false),
     is_initialized_(false) {
+  if (PepperGLRenderer::IsAvailable())
+    gl_renderer_.reset(new PepperGLRenderer(instance_));
 }
 
 PepperView::~PepperView() {
@@ -112,6 +119,7 @@ void PepperView::TearDown() {
   while (!buffers_.empty()) {
     FreeBuffer(buffers_.front());
   }
+  yuv_frame_pending_ = false;
 }
 
 void PepperView::SetConnectionState(protocol::ConnectionToHost::State state,
@@ -156,12 +164,15 @@ void PepperView::SetView(const SkISize& view_size, const SkIRect& clip_area) {
     view_changed = true;
     view_size_ = view_size;
 
-    pp::Size pp_size = pp::Size(view_size_.width(), view_size_.height());
-    graphics2d_ = pp::Graphics2D(instance_, pp_size, true);
-    bool result = instance_->BindGraphics(graphics2d_);
-
-    // There is no good way to handle this error currently.
-    DCHECK(result) << "Couldn't bind the device context.";
+    if (gl_renderer_.get()) {
+      if (gl_renderer_->SetViewSize(view_size_)) {
+        DrawGL(base::Time::Now());
+      } else {
+        FallBackToGraphics2D();
+      }
+    } else {
+      BindGraphics2D();
+    }
   }
 
   if (clip_area_ != clip_area) {
@@ -218,6 +229,46 @@ void PepperView::ReturnBuffer(pp::ImageData* buffer) {
   }
 }
 
+void PepperView::ApplyYUVFrame(const scoped_refptr<media::VideoFrame>& frame,
+                               const SkRegion& region) {
+  DCHECK(context_->main_message_loop()->BelongsToCurrentThread());
+
+  yuv_frame_pending_ = false;
+  if (!is_initialized_ || !gl_renderer_.get())
+    return;
+
+  // Drop frames of the previous source size.
+  if (frame->width() != static_cast<size_t>(source_size_.width()) ||
+      frame->height() != static_cast<size_t>(source_size_.height())) {
+    InitiateDrawing();
+    return;
+  }
+
+  base::Time start_time = base::Time::Now();
+
+  // The textures keep a copy of the pixels, so the frame can be handed back
+  // to the producer straight away.
+  gl_renderer_->UploadFrame(frame, region);
+  yuv_frame_pending_ = true;
+  producer_->DrawYUVFrame(frame);
+
+  DrawGL(start_time);
+}
+
+void PepperView::ReturnYUVFrame(const scoped_refptr<media::VideoFrame>& frame,
+                                bool yuv_supported) {
+  DCHECK(context_->main_message_loop()->BelongsToCurrentThread());
+
+  yuv_frame_pending_ = false;
+  if (!yuv_supported) {
+    FallBackToGraphics2D();
+    return;
+  }
+
+  // Allocate a frame of the new source size.
+  InitiateDrawing();
+}
+
 void PepperView::SetSourceSize(const SkISize& source_size) {
   DCHECK(context_->main_message_loop()->BelongsToCurrentThread());
 
@@ -228,6 +279,8 @@ void PepperView::SetSourceSize(const SkISize& source_size) {
 
   // Notify JavaScript of the change in source size.
   instance_->SetDesktopSize(source_size.width(), source_size.height());
+
+  InitiateDrawing();
 }
 
 pp::ImageData* PepperView::AllocateBuffer() {
@@ -262,6 +315,25 @@ void PepperView::InitiateDrawing() {
   if (!is_initialized_)
     return;
 
+  if (gl_renderer_.get()) {
+    // A single frame is enough since the pixels are copied to the textures
+    // as soon as the frame is painted.
+    if (yuv_frame_pending_ || source_size_.isEmpty())
+      return;
+
+    scoped_refptr<media::VideoFrame> frame = media::VideoFrame::CreateFrame(
+        media::VideoFrame::YV12, source_size_.width(), source_size_.height(),
+        base::TimeDelta(), base::TimeDelta());
+    yuv_frame_pending_ = true;
+    producer_->DrawYUVFrame(frame);
+
+    // The textures are reallocated from the new frame, so all of it has to be
+    // painted.
+    if (!view_size_.isEmpty())
+      producer_->InvalidateRegion(SkRegion(SkIRect::MakeSize(view_size_)));
+    return;
+  }
+
   pp::ImageData* buffer = AllocateBuffer();
   while (buffer) {
     producer_->DrawBuffer(buffer);
@@ -345,4 +417,64 @@ void PepperView::OnFlushDone(base::Time paint_start,
   }
 }
 
+void PepperView::BindGraphics2D() {
+  pp::Size pp_size = pp::Size(view_size_.width(), view_size_.height());
+  graphics2d_ = pp::Graphics2D(instance_, pp_size, true);
+  bool result = instance_->BindGraphics(graphics2d_);
+
+  // There is no good way to handle this error currently.
+  DCHECK(result) << "Couldn't bind the device context.";
+}
+
+void PepperView::FallBackToGraphics2D() {
+  if (!gl_renderer_.get())
+    return;
+
+  LOG(INFO) << "Falling back to Graphics2D.";
+  gl_renderer_.reset();
+  swap_pending_ = false;
+  redraw_needed_ = false;
+
+  if (!view_size_.isEmpty())
+    BindGraphics2D();
+
+  // Repaint the whole view into the RGB buffers.
+  if (!view_size_.isEmpty())
+    producer_->InvalidateRegion(SkRegion(SkIRect::MakeSize(view_size_)));
+  InitiateDrawing();
+}
+
+void PepperView::DrawGL(base::Time paint_start) {
+  if (swap_pending_) {
+    redraw_needed_ = true;
+    return;
+  }
+
+  if (!gl_renderer_->Draw(PpCompletionCallback(base::Bind(
+          &PepperView::OnSwapDone, AsWeakPtr(), paint_start)))) {
+    FallBackToGraphics2D();
+    return;
+  }
+  swap_pending_ = true;
+}
+
+void PepperView::OnSwapDone(base::Time paint_start, int result) {
+  DCHECK(context_->main_message_loop()->BelongsToCurrentThread());
+
+  // The swap may complete after falling back to Graphics2D.
+  if (!gl_renderer_.get())
+    return;
+
+  DCHECK(swap_pending_);
+  swap_pending_ = false;
+
+  instance_->GetStats()->video_paint_ms()->Record(
+      (base::Time::Now() - paint_start).InMilliseconds());
+
+  if (redraw_needed_) {
+    redraw_needed_ = false;
+    DrawGL(base::Time::Now());
+  }
+}
+
 }  // namespace remoting
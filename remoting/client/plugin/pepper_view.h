@@ -10,6 +10,7 @@
 
 #include <list>
 
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "ppapi/cpp/graphics_2d.h"
@@ -22,6 +23,7 @@ namespace remoting {
 class ChromotingInstance;
 class ClientContext;
 class FrameProducer;
+class PepperGLRenderer;
 
 class PepperView : public ChromotingView,
                    public FrameConsumer,
@@ -49,6 +51,10 @@ class PepperView : public ChromotingView,
                            pp::ImageData* buffer,
                            const SkRegion& region) OVERRIDE;
   virtual void ReturnBuffer(pp::ImageData* buffer) OVERRIDE;
+  virtual void ApplyYUVFrame(const scoped_refptr<media::VideoFrame>& frame,
+                             const SkRegion& region) OVERRIDE;
+  virtual void ReturnYUVFrame(const scoped_refptr<media::VideoFrame>& frame,
+                              bool yuv_supported) OVERRIDE;
   virtual void SetSourceSize(const SkISize& source_size) OVERRIDE;
 
   // Sets the display size and clipping area of this view.
@@ -83,6 +89,19 @@ class PepperView : public ChromotingView,
   // This is a completion callback for FlushGraphics().
   void OnFlushDone(base::Time paint_start, pp::ImageData* buffer, int result);
 
+  // Binds a Graphics2D context of the view size to the instance.
+  void BindGraphics2D();
+
+  // Stops drawing with |gl_renderer_| and switches to Graphics2D.
+  void FallBackToGraphics2D();
+
+  // Draws the uploaded frame with |gl_renderer_|, or schedules another draw
+  // if a swap is already in progress.
+  void DrawGL(base::Time paint_start);
+
+  // This is a completion callback for DrawGL().
+  void OnSwapDone(base::Time paint_start, int result);
+
   // Reference to the creating plugin instance. Needed for interacting with
   // pepper.  Marking explicitly as const since it must be initialized at
   // object creation, and never change.
@@ -93,6 +112,11 @@ class PepperView : public ChromotingView,
 
   pp::Graphics2D graphics2d_;
 
+  // Converts and scales YUV frames on the GPU. NULL if Graphics3D isn't
+  // available or the decoder can't produce YUV frames, in which case RGB
+  // buffers are drawn with |graphics2d_|.
+  scoped_ptr<PepperGLRenderer> gl_renderer_;
+
   FrameProducer* producer_;
 
   // List of allocated image buffers.
@@ -114,6 +138,14 @@ class PepperView : public ChromotingView,
   // True if there is already a Flush() pending on the Graphics2D context.
   bool flush_pending_;
 
+  // True if the YUV frame is with the producer.
+  bool yuv_frame_pending_;
+
+  // True if there is a SwapBuffers() pending on |gl_renderer_|, and if the
+  // view needs to be drawn again once it completes.
+  bool swap_pending_;
+  bool redraw_needed_;
+
   // True after Initialize() has been called, until TearDown().
   bool is_initialized_;
 
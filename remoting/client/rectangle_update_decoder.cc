@@ -10,6 +10,7 @@
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/message_loop_proxy.h"
+#include "media/base/video_frame.h"
 #include "ppapi/cpp/image_data.h"
 #include "remoting/base/decoder.h"
 #include "remoting/base/decoder_row_based.h"
@@ -82,6 +83,7 @@ void RectangleUpdateDecoder::DecodePacket(scoped_ptr<VideoPacket> packet,
 
   if (decoder_needs_reset) {
     decoder_->Initialize(source_size_);
+    ReturnMismatchedYUVFrames();
     consumer_->SetSourceSize(source_size_);
   }
 
@@ -107,14 +109,18 @@ void RectangleUpdateDecoder::DoPaint() {
   DCHECK(paint_scheduled_);
   paint_scheduled_ = false;
 
-  // If the view size is empty or we have no output buffers ready, return.
-  if (buffers_.empty() || view_size_.isEmpty())
-    return;
-
   // If no Decoder is initialized, or the host dimensions are empty, return.
   if (!decoder_.get() || source_size_.isEmpty())
     return;
 
+  // The consumer scales YUV frames itself, so the view size doesn't matter.
+  if (!yuv_frames_.empty() && PaintYUVFrame())
+    return;
+
+  // If the view size is empty or we have no output buffers ready, return.
+  if (buffers_.empty() || view_size_.isEmpty())
+    return;
+
   // Draw the invalidated region to the buffer.
   pp::ImageData* buffer = buffers_.front();
   SkRegion output_region;
@@ -130,6 +136,39 @@ void RectangleUpdateDecoder::DoPaint() {
   }
 }
 
+bool RectangleUpdateDecoder::PaintYUVFrame() {
+  scoped_refptr<media::VideoFrame> frame = yuv_frames_.front();
+  SkRegion output_region;
+  if (!decoder_->RenderYUVFrame(frame, &output_region)) {
+    // Let the consumer know that it has to fall back to RGB buffers.
+    while (!yuv_frames_.empty()) {
+      consumer_->ReturnYUVFrame(yuv_frames_.front(), false);
+      yuv_frames_.pop_front();
+    }
+    return false;
+  }
+
+  if (!output_region.isEmpty()) {
+    yuv_frames_.pop_front();
+    consumer_->ApplyYUVFrame(frame, output_region);
+  }
+  return true;
+}
+
+void RectangleUpdateDecoder::ReturnMismatchedYUVFrames() {
+  std::list<scoped_refptr<media::VideoFrame> >::iterator i =
+      yuv_frames_.begin();
+  while (i != yuv_frames_.end()) {
+    if ((*i)->width() != static_cast<size_t>(source_size_.width()) ||
+        (*i)->height() != static_cast<size_t>(source_size_.height())) {
+      consumer_->ReturnYUVFrame(*i, true);
+      i = yuv_frames_.erase(i);
+    } else {
+      ++i;
+    }
+  }
+}
+
 void RectangleUpdateDecoder::RequestReturnBuffers(const base::Closure& done) {
   if (!message_loop_->BelongsToCurrentThread()) {
     message_loop_->PostTask(
@@ -142,6 +181,10 @@ void RectangleUpdateDecoder::RequestReturnBuffers(const base::Closure& done) {
     consumer_->ReturnBuffer(buffers_.front());
     buffers_.pop_front();
   }
+  while (!yuv_frames_.empty()) {
+    consumer_->ReturnYUVFrame(yuv_frames_.front(), true);
+    yuv_frames_.pop_front();
+  }
 
   if (!done.is_null())
     done.Run();
@@ -162,6 +205,23 @@ void RectangleUpdateDecoder::DrawBuffer(pp::ImageData* buffer) {
   SchedulePaint();
 }
 
+void RectangleUpdateDecoder::DrawYUVFrame(
+    const scoped_refptr<media::VideoFrame>& frame) {
+  if (!message_loop_->BelongsToCurrentThread()) {
+    message_loop_->PostTask(
+        FROM_HERE, base::Bind(&RectangleUpdateDecoder::DrawYUVFrame,
+                              this, frame));
+    return;
+  }
+
+  DCHECK_EQ(media::VideoFrame::YV12, frame->format());
+
+  yuv_frames_.push_back(frame);
+  if (!source_size_.isEmpty())
+    ReturnMismatchedYUVFrames();
+  SchedulePaint();
+}
+
 void RectangleUpdateDecoder::InvalidateRegion(const SkRegion& region) {
   if (!message_loop_->BelongsToCurrentThread()) {
     message_loop_->PostTask(
@@ -18,6 +18,10 @@ namespace base {
 class MessageLoopProxy;
 }  // namespace base
 
+namespace media {
+class VideoFrame;
+}  // namespace media
+
 namespace pp {
 class ImageData;
 };
@@ -53,6 +57,8 @@ class RectangleUpdateDecoder :
   // FrameProducer implementation.  These methods may be called before we are
   // Initialize()d, or we know the source screen size.
   virtual void DrawBuffer(pp::ImageData* buffer) OVERRIDE;
+  virtual void DrawYUVFrame(
+      const scoped_refptr<media::VideoFrame>& frame) OVERRIDE;
   virtual void InvalidateRegion(const SkRegion& region) OVERRIDE;
   virtual void RequestReturnBuffers(const base::Closure& done) OVERRIDE;
   virtual void SetOutputSizeAndClip(const SkISize& view_size,
@@ -67,6 +73,13 @@ class RectangleUpdateDecoder :
   void SchedulePaint();
   void DoPaint();
 
+  // Paints the invalidated region at source resolution to the next available
+  // YUV frame. Returns false if the decoder can't produce YUV frames.
+  bool PaintYUVFrame();
+
+  // Returns YUV frames that don't match the source size to the consumer.
+  void ReturnMismatchedYUVFrames();
+
   scoped_refptr<base::MessageLoopProxy> message_loop_;
   scoped_refptr<FrameConsumerProxy> consumer_;
   scoped_ptr<Decoder> decoder_;
@@ -81,6 +94,10 @@ class RectangleUpdateDecoder :
   // The drawing buffers supplied by the frame consumer.
   std::list<pp::ImageData*> buffers_;
 
+  // The YUV frames supplied by the frame consumer. These are preferred over
+  // |buffers_| when the decoder can produce YUV frames.
+  std::list<scoped_refptr<media::VideoFrame> > yuv_frames_;
+
   // Flag used to coalesce runs of SchedulePaint()s into a single DoPaint().
   bool paint_scheduled_;
 };
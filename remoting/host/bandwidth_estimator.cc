@@ -0,0 +1,73 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "remoting/host/bandwidth_estimator.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace {
+
+// Number of frames to average the throughput over.
+const int kStatisticsWindow = 10;
+
+// Frames sent faster than this are mostly absorbed by the socket buffers and
+// say little about the link, so they are left out of the estimate.
+const int64 kMinimumSendTimeUs = 1000;
+
+}  // namespace
+
+namespace remoting {
+
+BandwidthEstimator::BandwidthEstimator()
+    : queued_bytes_(0),
+      bytes_per_second_(kStatisticsWindow) {
+}
+
+BandwidthEstimator::~BandwidthEstimator() {
+}
+
+void BandwidthEstimator::RecordFrameQueued(int bytes,
+                                           base::TimeTicks queue_time) {
+  QueuedFrame frame;
+  frame.bytes = bytes;
+  frame.queue_time = queue_time;
+  queued_frames_.push_back(frame);
+  queued_bytes_ += bytes;
+}
+
+void BandwidthEstimator::RecordFrameSent(base::TimeTicks sent_time) {
+  if (queued_frames_.empty()) {
+    NOTREACHED() << "No frame was queued.";
+    return;
+  }
+
+  QueuedFrame frame = queued_frames_.front();
+  queued_frames_.pop_front();
+  queued_bytes_ -= frame.bytes;
+
+  base::TimeTicks start_time = std::max(frame.queue_time, last_sent_time_);
+  last_sent_time_ = sent_time;
+
+  int64 send_time_us = (sent_time - start_time).InMicroseconds();
+  if (frame.bytes > 0 && send_time_us >= kMinimumSendTimeUs) {
+    bytes_per_second_.Record(
+        frame.bytes * base::Time::kMicrosecondsPerSecond / send_time_us);
+  }
+}
+
+int64 BandwidthEstimator::bytes_per_second() {
+  return static_cast<int64>(bytes_per_second_.Average());
+}
+
+base::TimeDelta BandwidthEstimator::QueueDelay() {
+  int64 rate = bytes_per_second();
+  if (rate <= 0)
+    return base::TimeDelta();
+  return base::TimeDelta::FromMicroseconds(
+      queued_bytes_ * base::Time::kMicrosecondsPerSecond / rate);
+}
+
+}  // namespace remoting
@@ -0,0 +1,58 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This class estimates the throughput of the video channel from how long the
+// network writer takes to send each frame. A frame occupies the channel from
+// when it is queued, or from when the previous frame was sent if that is
+// later, until its last packet has been written. The estimate is then used to
+// tell how long the frames still queued will take to send.
+
+#ifndef REMOTING_HOST_BANDWIDTH_ESTIMATOR_H_
+#define REMOTING_HOST_BANDWIDTH_ESTIMATOR_H_
+
+#include <deque>
+
+#include "base/basictypes.h"
+#include "base/time.h"
+#include "remoting/base/running_average.h"
+
+namespace remoting {
+
+class BandwidthEstimator {
+ public:
+  BandwidthEstimator();
+  ~BandwidthEstimator();
+
+  // Records that a frame of |bytes| was queued at |queue_time|.
+  void RecordFrameQueued(int bytes, base::TimeTicks queue_time);
+
+  // Records that the oldest queued frame was written at |sent_time|.
+  void RecordFrameSent(base::TimeTicks sent_time);
+
+  // Average throughput of the recently sent frames. Returns 0 until the
+  // first non-empty frame has been sent.
+  int64 bytes_per_second();
+
+  // Time needed to send the frames still queued at the estimated throughput.
+  base::TimeDelta QueueDelay();
+
+  int queued_bytes() const { return queued_bytes_; }
+
+ private:
+  struct QueuedFrame {
+    int bytes;
+    base::TimeTicks queue_time;
+  };
+
+  std::deque<QueuedFrame> queued_frames_;
+  int queued_bytes_;
+  base::TimeTicks last_sent_time_;
+  RunningAverage bytes_per_second_;
+
+  DISALLOW_COPY_AND_ASSIGN(BandwidthEstimator);
+};
+
+}  // namespace remoting
+
+#endif  // REMOTING_HOST_BANDWIDTH_ESTIMATOR_H_
@@ -0,0 +1,41 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "remoting/host/bandwidth_estimator.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace remoting {
+
+TEST(BandwidthEstimatorTest, EstimatesFromSendTime) {
+  BandwidthEstimator estimator;
+  EXPECT_EQ(0, estimator.bytes_per_second());
+
+  base::TimeTicks now = base::TimeTicks::Now();
+  base::TimeDelta interval = base::TimeDelta::FromMilliseconds(100);
+
+  // Two frames queued together are sent back to back, so the second one
+  // occupies the channel only from when the first was sent.
+  estimator.RecordFrameQueued(10000, now);
+  estimator.RecordFrameQueued(10000, now);
+  EXPECT_EQ(20000, estimator.queued_bytes());
+  estimator.RecordFrameSent(now + interval);
+  estimator.RecordFrameSent(now + interval * 2);
+  EXPECT_EQ(100000, estimator.bytes_per_second());
+
+  estimator.RecordFrameQueued(50000, now + interval * 3);
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(500), estimator.QueueDelay());
+}
+
+TEST(BandwidthEstimatorTest, IgnoresEmptyFrames) {
+  BandwidthEstimator estimator;
+  base::TimeTicks now = base::TimeTicks::Now();
+
+  estimator.RecordFrameQueued(0, now);
+  estimator.RecordFrameSent(now + base::TimeDelta::FromMilliseconds(100));
+  EXPECT_EQ(0, estimator.bytes_per_second());
+  EXPECT_EQ(base::TimeDelta(), estimator.QueueDelay());
+}
+
+}  // namespace remoting
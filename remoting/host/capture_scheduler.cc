@@ -16,8 +16,12 @@ namespace {
 // over.
 const int kStatisticsWindow = 3;
 
-// The hard limit is 20fps or 50ms per recording cycle.
-const int64 kMinimumRecordingDelay = 50;
+// The hard limit is 30fps or 33ms per recording cycle. Below that the rate
+// follows the CPU usage and the latency target.
+const int64 kMinimumRecordingDelay = 33;
+
+// Frames should get from the capturer to the network within this time.
+const int64 kTargetLatency = 100;
 
 // Controls how much CPU time we can use for encode and capture.
 // Range of this value is between 0 to 1. 0 means using 0% of of all CPUs
@@ -32,7 +36,8 @@ namespace remoting {
 CaptureScheduler::CaptureScheduler()
     : num_of_processors_(base::SysInfo::NumberOfProcessors()),
       capture_time_(kStatisticsWindow),
-      encode_time_(kStatisticsWindow) {
+      encode_time_(kStatisticsWindow),
+      latency_(kStatisticsWindow) {
   DCHECK(num_of_processors_);
 }
 
@@ -47,6 +52,14 @@ base::TimeDelta CaptureScheduler::NextCaptureDelay() {
       (capture_time_.Average() + encode_time_.Average()) /
       (kRecordingCpuConsumption * num_of_processors_);
 
+  // A latency above the target means frames are captured faster than the
+  // encoder or the network drains them, so capture less often in proportion.
+  double latency = latency_.Average();
+  if (latency > kTargetLatency) {
+    delay = std::max(delay,
+                     kMinimumRecordingDelay * latency / kTargetLatency);
+  }
+
   if (delay < kMinimumRecordingDelay)
     return base::TimeDelta::FromMilliseconds(kMinimumRecordingDelay);
   return base::TimeDelta::FromMilliseconds(delay);
@@ -60,4 +73,12 @@ void CaptureScheduler::RecordEncodeTime(base::TimeDelta encode_time) {
   encode_time_.Record(encode_time.InMilliseconds());
 }
 
+void CaptureScheduler::RecordCaptureToWireLatency(base::TimeDelta latency) {
+  latency_.Record(latency.InMilliseconds());
+}
+
+base::TimeDelta CaptureScheduler::AverageCaptureToWireLatency() {
+  return base::TimeDelta::FromMilliseconds(latency_.Average());
+}
+
 }  // namespace remoting
@@ -4,7 +4,9 @@
 
 // This class chooses a capture interval so as to limit CPU usage to not exceed
 // a specified %age. It bases this on the CPU usage of recent capture and encode
-// operations, and on the number of available CPUs.
+// operations, and on the number of available CPUs. The interval is stretched
+// further when frames take longer than a target latency to get from the
+// capturer to the network, since they are then queuing in the pipeline.
 
 #ifndef REMOTING_HOST_CAPTURE_SCHEDULER_H_
 #define REMOTING_HOST_CAPTURE_SCHEDULER_H_
@@ -26,10 +28,18 @@ class CaptureScheduler {
   void RecordCaptureTime(base::TimeDelta capture_time);
   void RecordEncodeTime(base::TimeDelta encode_time);
 
+  // Record the time from the start of a capture until its frame was handed
+  // to the network.
+  void RecordCaptureToWireLatency(base::TimeDelta latency);
+
+  // Average of the recent latencies passed to RecordCaptureToWireLatency().
+  base::TimeDelta AverageCaptureToWireLatency();
+
  private:
   int num_of_processors_;
   RunningAverage capture_time_;
   RunningAverage encode_time_;
+  RunningAverage latency_;
 
   DISALLOW_COPY_AND_ASSIGN(CaptureScheduler);
 };
@@ -0,0 +1,30 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "remoting/host/capture_scheduler.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace remoting {
+
+TEST(CaptureSchedulerTest, HighLatencyLowersCaptureRate) {
+  CaptureScheduler scheduler;
+  base::TimeDelta delay = scheduler.NextCaptureDelay();
+
+  // Frames within the latency target do not change the rate.
+  for (int i = 0; i < 3; ++i)
+    scheduler.RecordCaptureToWireLatency(base::TimeDelta::FromMilliseconds(50));
+  EXPECT_EQ(delay, scheduler.NextCaptureDelay());
+
+  // Frames that queue in the pipeline stretch the capture interval.
+  for (int i = 0; i < 3; ++i) {
+    scheduler.RecordCaptureToWireLatency(
+        base::TimeDelta::FromMilliseconds(400));
+  }
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(400),
+            scheduler.AverageCaptureToWireLatency());
+  EXPECT_GT(scheduler.NextCaptureDelay(), delay);
+}
+
+}  // namespace remoting
@@ -8,11 +8,21 @@
 #include <X11/Xutil.h>
 #include <X11/extensions/Xdamage.h>
 
+#include <algorithm>
 #include <set>
+#include <vector>
 
+#include "base/atomic_ref_count.h"
 #include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/location.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/sys_info.h"
+#include "base/threading/worker_pool.h"
+#include "base/time.h"
+#include "remoting/base/running_average.h"
 #include "remoting/host/capturer_helper.h"
 #include "remoting/host/differ.h"
 #include "remoting/host/x_server_pixel_buffer.h"
@@ -31,6 +41,25 @@ static bool ShouldUseXDamage() {
   return g_should_use_x_damage;
 }
 
+// When XDamage is used, each capture also fetches one of kValidationStrips
+// horizontal strips of the screen and compares it with the frame, so that the
+// whole screen is checked every kValidationStrips captures.
+static const int kValidationStrips = 32;
+
+// XDamage is abandoned for polling once a sweep over all the strips finds
+// more than this many strips that changed without being reported. A strip
+// may legitimately change between fetching the damage and the strip, so a
+// few misses are tolerated.
+static const int kMaxMissedStripsPerSweep = 4;
+
+// Rects of at least kMinRowsPerBand * 2 rows are converted in bands on the
+// worker pool, up to kMaxBands at a time.
+static const int kMinRowsPerBand = 128;
+static const int kMaxBands = 4;
+
+// Number of captures between reports of the capture time per megapixel.
+static const int kCaptureTimeReportInterval = 100;
+
 // A class representing a full-frame pixel buffer
 class VideoFrameBuffer {
  public:
@@ -115,10 +144,31 @@ class CapturerLinux : public Capturer {
 
   void DeinitXlib();
 
+  // Stop using XDamage and poll the whole screen from the next capture on.
+  // Called during a capture into the current buffer.
+  void DisableXDamage();
+
+  // Fetch the next validation strip from the X server into |capture_data|.
+  // If it differs from what the frame held, the damage reported by XDamage
+  // was incomplete, so the strip is added to |invalid_region|.
+  void ValidateDamage(CaptureData* capture_data, SkRegion* invalid_region);
+
   // Capture a rectangle from |x_server_pixel_buffer_|, and copy the data into
-  // |capture_data|.
+  // |capture_data|. Large rects are converted in bands on the worker pool.
   void CaptureRect(const SkIRect& rect, CaptureData* capture_data);
 
+  // Copy |rect| from |image| into |capture_data| with FastBlit() or
+  // SlowBlit().
+  void BlitRect(uint8* image, const SkIRect& rect, bool fast_blit,
+                CaptureData* capture_data);
+
+  // Runs BlitRect() on a worker thread, then signals |done| if this was the
+  // last of the |pending_bands|.
+  void BlitBandOnWorker(uint8* image, const SkIRect& rect, bool fast_blit,
+                        CaptureData* capture_data,
+                        base::AtomicRefCount* pending_bands,
+                        base::WaitableEvent* done);
+
   // We expose two forms of blitting to handle variations in the pixel format.
   // In FastBlit, the operation is effectively a memcpy.
   void FastBlit(uint8* image, const SkIRect& rect, CaptureData* capture_data);
@@ -161,6 +211,18 @@ class CapturerLinux : public Capturer {
   // |Differ| for use when polling for changes.
   scoped_ptr<Differ> differ_;
 
+  // The strip ValidateDamage() fetches next, and the number of strips of the
+  // current sweep that changed without being reported by XDamage.
+  int validation_strip_;
+  int missed_strips_;
+
+  // Maximum number of bands CaptureRect() converts concurrently.
+  int max_bands_;
+
+  // Recent capture times, in microseconds per megapixel of the screen.
+  RunningAverage capture_time_per_megapixel_;
+  int captures_since_report_;
+
   DISALLOW_COPY_AND_ASSIGN(CapturerLinux);
 };
 
@@ -175,7 +237,12 @@ CapturerLinux::CapturerLinux()
       damage_region_(0),
       current_buffer_(0),
       pixel_format_(media::VideoFrame::RGB32),
-      last_buffer_(NULL) {
+      last_buffer_(NULL),
+      validation_strip_(0),
+      missed_strips_(0),
+      max_bands_(std::min(base::SysInfo::NumberOfProcessors(), kMaxBands)),
+      capture_time_per_megapixel_(kCaptureTimeReportInterval),
+      captures_since_report_(0) {
   helper_.SetLogGridSize(4);
 }
 
@@ -310,7 +377,23 @@ void CapturerLinux::CaptureInvalidRegion(
                              kBytesPerPixel, current.bytes_per_row()));
   }
 
+  base::TimeTicks capture_start = base::TimeTicks::HighResNow();
   scoped_refptr<CaptureData> capture_data(CaptureFrame());
+  base::TimeDelta capture_time = base::TimeTicks::HighResNow() - capture_start;
+
+  int64 pixels = static_cast<int64>(current.size().width()) *
+      current.size().height();
+  if (pixels > 0) {
+    capture_time_per_megapixel_.Record(
+        capture_time.InMicroseconds() * 1000000 / pixels);
+  }
+  if (++captures_since_report_ == kCaptureTimeReportInterval) {
+    captures_since_report_ = 0;
+    VLOG(1) << "Capture time: "
+            << capture_time_per_megapixel_.Average() / 1000
+            << " ms per megapixel"
+            << (use_damage_ ? " with XDamage" : " polling");
+  }
 
   current_buffer_ = (current_buffer_ + 1) % kNumBuffers;
 
@@ -379,6 +462,9 @@ CaptureData* CapturerLinux::CaptureFrame() {
     for (SkRegion::Iterator it(invalid_region); !it.done(); it.next()) {
       CaptureRect(it.rect(), capture_data);
     }
+
+    // Catch changes XDamage did not report, which broken drivers do.
+    ValidateDamage(capture_data, &invalid_region);
   } else {
     // Doing full-screen polling, or this is the first capture after a
     // screen-resolution change.  In either case, need a full-screen capture.
@@ -428,6 +514,59 @@ void CapturerLinux::SynchronizeFrame() {
   }
 }
 
+void CapturerLinux::DisableXDamage() {
+  XDamageDestroy(display_, damage_handle_);
+  XFixesDestroyRegion(display_, damage_region_);
+  damage_handle_ = 0;
+  damage_region_ = 0;
+  use_damage_ = false;
+
+  // Polling diffs each full-screen capture with the previous one, which still
+  // holds what was sent to the client.
+  VideoFrameBuffer& current = buffers_[current_buffer_];
+  differ_.reset(new Differ(current.size().width(), current.size().height(),
+                           kBytesPerPixel, current.bytes_per_row()));
+}
+
+void CapturerLinux::ValidateDamage(CaptureData* capture_data,
+                                   SkRegion* invalid_region) {
+  if (validation_strip_ == 0)
+    missed_strips_ = 0;
+
+  const SkISize& size = capture_data->size();
+  int strip_height = (size.height() + kValidationStrips - 1) /
+      kValidationStrips;
+  SkIRect strip = SkIRect::MakeXYWH(0, validation_strip_ * strip_height,
+                                    size.width(), strip_height);
+  validation_strip_ = (validation_strip_ + 1) % kValidationStrips;
+  if (!strip.intersect(SkIRect::MakeSize(size)))
+    return;
+
+  // Keep what the frame holds, then overwrite it with the server's pixels.
+  DataPlanes planes = capture_data->data_planes();
+  const int stride = planes.strides[0];
+  const int row_bytes = strip.width() * kBytesPerPixel;
+  uint8* strip_start = planes.data[0] + strip.fTop * stride;
+  std::vector<uint8> expected(strip.height() * row_bytes);
+  for (int y = 0; y < strip.height(); ++y)
+    memcpy(&expected[y * row_bytes], strip_start + y * stride, row_bytes);
+
+  CaptureRect(strip, capture_data);
+
+  for (int y = 0; y < strip.height(); ++y) {
+    if (memcmp(&expected[y * row_bytes], strip_start + y * stride,
+               row_bytes) != 0) {
+      invalid_region->op(strip, SkRegion::kUnion_Op);
+      if (++missed_strips_ > kMaxMissedStripsPerSweep) {
+        LOG(WARNING) << "XDamage does not report all screen updates. "
+                     << "Falling back to polling.";
+        DisableXDamage();
+      }
+      return;
+    }
+  }
+}
+
 void CapturerLinux::DeinitXlib() {
   if (gc_) {
     XFreeGC(display_, gc_);
@@ -454,7 +593,45 @@ void CapturerLinux::CaptureRect(const SkIRect& rect,
   int depth = x_server_pixel_buffer_.GetDepth();
   int bpp = x_server_pixel_buffer_.GetBitsPerPixel();
   bool is_rgb = x_server_pixel_buffer_.IsRgb();
-  if ((depth == 24 || depth == 32) && bpp == 32 && is_rgb) {
+  bool fast_blit = (depth == 24 || depth == 32) && bpp == 32 && is_rgb;
+
+  // The X server hands out the whole screen through one connection, so only
+  // the conversion of the fetched pixels is spread over the cores.
+  int num_bands = std::min(max_bands_, rect.height() / kMinRowsPerBand);
+  if (num_bands <= 1) {
+    BlitRect(image, rect, fast_blit, capture_data);
+    return;
+  }
+
+  int src_stride = x_server_pixel_buffer_.GetStride();
+  base::AtomicRefCount pending_bands = num_bands - 1;
+  base::WaitableEvent done(true, false);
+  for (int band = 1; band < num_bands; ++band) {
+    int top = rect.fTop + band * rect.height() / num_bands;
+    int bottom = rect.fTop + (band + 1) * rect.height() / num_bands;
+    SkIRect band_rect = SkIRect::MakeLTRB(rect.fLeft, top, rect.fRight, bottom);
+    uint8* band_image = image + (top - rect.fTop) * src_stride;
+    if (!base::WorkerPool::PostTask(
+            FROM_HERE,
+            base::Bind(&CapturerLinux::BlitBandOnWorker,
+                       base::Unretained(this), band_image, band_rect,
+                       fast_blit, base::Unretained(capture_data),
+                       &pending_bands, &done),
+            false)) {
+      BlitBandOnWorker(band_image, band_rect, fast_blit, capture_data,
+                       &pending_bands, &done);
+    }
+  }
+  SkIRect first_band = SkIRect::MakeLTRB(
+      rect.fLeft, rect.fTop, rect.fRight,
+      rect.fTop + rect.height() / num_bands);
+  BlitRect(image, first_band, fast_blit, capture_data);
+  done.Wait();
+}
+
+void CapturerLinux::BlitRect(uint8* image, const SkIRect& rect,
+                             bool fast_blit, CaptureData* capture_data) {
+  if (fast_blit) {
     DVLOG(3) << "Fast blitting";
     FastBlit(image, rect, capture_data);
   } else {
@@ -463,6 +640,16 @@ void CapturerLinux::CaptureRect(const SkIRect& rect,
   }
 }
 
+void CapturerLinux::BlitBandOnWorker(uint8* image, const SkIRect& rect,
+                                     bool fast_blit,
+                                     CaptureData* capture_data,
+                                     base::AtomicRefCount* pending_bands,
+                                     base::WaitableEvent* done) {
+  BlitRect(image, rect, fast_blit, capture_data);
+  if (!base::AtomicRefCountDec(pending_bands))
+    done->Signal();
+}
+
 void CapturerLinux::FastBlit(uint8* image, const SkIRect& rect,
                              CaptureData* capture_data) {
   uint8* src_pos = image;
@@ -4,9 +4,27 @@
 
 #include "remoting/host/differ.h"
 
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/location.h"
 #include "base/logging.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/sys_info.h"
+#include "base/threading/worker_pool.h"
 #include "remoting/host/differ_block.h"
 
+namespace {
+
+// Bands are at least this many block rows high, so that small screens and
+// small captures are not worth a thread hop.
+const int kMinBlockRowsPerBand = 8;
+
+// Diffing is bound by memory bandwidth, so more bands than this do not help.
+const int kMaxBands = 4;
+
+}  // namespace
+
 namespace remoting {
 
 Differ::Differ(int width, int height, int bpp, int stride) {
@@ -22,6 +40,8 @@ Differ::Differ(int width, int height, int bpp, int stride) {
   diff_info_height_ = ((height_ + kBlockSize - 1) / kBlockSize) + 1;
   diff_info_size_ = diff_info_width_ * diff_info_height_ * sizeof(DiffInfo);
   diff_info_.reset(new DiffInfo[diff_info_size_]);
+
+  max_bands_ = std::min(base::SysInfo::NumberOfProcessors(), kMaxBands);
 }
 
 Differ::~Differ() {}
@@ -48,6 +68,47 @@ void Differ::CalcDirtyRegion(const void* prev_buffer, const void* curr_buffer,
 void Differ::MarkDirtyBlocks(const void* prev_buffer, const void* curr_buffer) {
   memset(diff_info_.get(), 0, diff_info_size_);
 
+  int block_rows = (height_ + kBlockSize - 1) / kBlockSize;
+  int num_bands = std::min(max_bands_, block_rows / kMinBlockRowsPerBand);
+  if (num_bands <= 1) {
+    MarkDirtyBlockRows(prev_buffer, curr_buffer, 0, block_rows);
+    return;
+  }
+
+  // The bands write to separate rows of |diff_info_|. This thread diffs the
+  // first band while the worker pool diffs the others.
+  base::AtomicRefCount pending_bands = num_bands - 1;
+  base::WaitableEvent done(true, false);
+  for (int band = 1; band < num_bands; ++band) {
+    int first_row = band * block_rows / num_bands;
+    int end_row = (band + 1) * block_rows / num_bands;
+    if (!base::WorkerPool::PostTask(
+            FROM_HERE,
+            base::Bind(&Differ::MarkDirtyBandOnWorker, base::Unretained(this),
+                       prev_buffer, curr_buffer, first_row, end_row,
+                       &pending_bands, &done),
+            false)) {
+      MarkDirtyBandOnWorker(prev_buffer, curr_buffer, first_row, end_row,
+                            &pending_bands, &done);
+    }
+  }
+  MarkDirtyBlockRows(prev_buffer, curr_buffer, 0, block_rows / num_bands);
+  done.Wait();
+}
+
+void Differ::MarkDirtyBandOnWorker(const void* prev_buffer,
+                                   const void* curr_buffer,
+                                   int first_row, int end_row,
+                                   base::AtomicRefCount* pending_bands,
+                                   base::WaitableEvent* done) {
+  MarkDirtyBlockRows(prev_buffer, curr_buffer, first_row, end_row);
+  if (!base::AtomicRefCountDec(pending_bands))
+    done->Signal();
+}
+
+void Differ::MarkDirtyBlockRows(const void* prev_buffer,
+                                const void* curr_buffer,
+                                int first_row, int end_row) {
   // Calc number of full blocks.
   int x_full_blocks = width_ / kBlockSize;
   int y_full_blocks = height_ / kBlockSize;
@@ -63,11 +124,15 @@ void Differ::MarkDirtyBlocks(const void* prev_buffer, const void* curr_buffer) {
   // Offset from the start of one diff_info row to the next.
   int diff_info_stride = diff_info_width_ * sizeof(DiffInfo);
 
-  const uint8* prev_block_row_start = static_cast<const uint8*>(prev_buffer);
-  const uint8* curr_block_row_start = static_cast<const uint8*>(curr_buffer);
-  DiffInfo* diff_info_row_start = static_cast<DiffInfo*>(diff_info_.get());
+  const uint8* prev_block_row_start =
+      static_cast<const uint8*>(prev_buffer) + first_row * block_y_stride;
+  const uint8* curr_block_row_start =
+      static_cast<const uint8*>(curr_buffer) + first_row * block_y_stride;
+  DiffInfo* diff_info_row_start =
+      static_cast<DiffInfo*>(diff_info_.get()) + first_row * diff_info_stride;
 
-  for (int y = 0; y < y_full_blocks; y++) {
+  int end_full_row = std::min(end_row, y_full_blocks);
+  for (int y = first_row; y < end_full_row; y++) {
     const uint8* prev_block = prev_block_row_start;
     const uint8* curr_block = curr_block_row_start;
     DiffInfo* diff_info = diff_info_row_start;
@@ -98,7 +163,7 @@ void Differ::MarkDirtyBlocks(const void* prev_buffer, const void* curr_buffer) {
   // If the screen height is not a multiple of the block size, then this
   // handles the last partial row. This situation is far more common than the
   // 'partial column' case.
-  if (partial_row_height != 0) {
+  if (partial_row_height != 0 && end_row > y_full_blocks) {
     const uint8* prev_block = prev_block_row_start;
     const uint8* curr_block = curr_block_row_start;
     DiffInfo* diff_info = diff_info_row_start;
@@ -7,10 +7,15 @@
 
 #include <vector>
 
+#include "base/atomic_ref_count.h"
 #include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
 #include "third_party/skia/include/core/SkRegion.h"
 
+namespace base {
+class WaitableEvent;
+}  // namespace base
+
 namespace remoting {
 
 typedef uint8 DiffInfo;
@@ -40,9 +45,23 @@ class Differ {
   // Allow tests to access our private parts.
   friend class DifferTest;
 
-  // Identify all of the blocks that contain changed pixels.
+  // Identify all of the blocks that contain changed pixels. Large screens are
+  // split into horizontal bands that are diffed concurrently on the worker
+  // pool.
   void MarkDirtyBlocks(const void* prev_buffer, const void* curr_buffer);
 
+  // Identify the changed blocks in the block rows [first_row, end_row). The
+  // last block row may be a partial one.
+  void MarkDirtyBlockRows(const void* prev_buffer, const void* curr_buffer,
+                          int first_row, int end_row);
+
+  // Runs MarkDirtyBlockRows() on a worker thread, then signals |done| if this
+  // was the last of the |pending_bands|.
+  void MarkDirtyBandOnWorker(const void* prev_buffer, const void* curr_buffer,
+                             int first_row, int end_row,
+                             base::AtomicRefCount* pending_bands,
+                             base::WaitableEvent* done);
+
   // After the dirty blocks have been identified, this routine merges adjacent
   // blocks into a region.
   // The goal is to minimize the region that covers the dirty blocks.
@@ -74,6 +93,9 @@ class Differ {
   int diff_info_height_;
   int diff_info_size_;
 
+  // Maximum number of bands MarkDirtyBlocks() splits the screen into.
+  int max_bands_;
+
   DISALLOW_COPY_AND_ASSIGN(Differ);
 };
 
@@ -53,6 +53,10 @@ class DifferTest : public testing::Test {
     differ_->MergeBlocks(dirty);
   }
 
+  void SetMaxBands(int max_bands) {
+    differ_->max_bands_ = max_bands;
+  }
+
   // Convenience method to count rectangles in a region.
   int RegionRectCount(const SkRegion& region) {
     int count = 0;
@@ -233,6 +237,26 @@ TEST_F(DifferTest, MarkDirtyBlocks_All) {
   }
 }
 
+// Tall screens are split into bands that are diffed on separate threads.
+// Every band, including the partial row at the bottom, must be marked.
+TEST_F(DifferTest, MarkDirtyBlocks_Bands) {
+  InitDiffer(kPartialScreenWidth, 4 * 8 * kBlockSize + 10);
+  SetMaxBands(4);
+  ClearDiffInfo();
+
+  int last_row = GetDiffInfoHeight() - 2;
+  for (int y = 0; y <= last_row; y += 3)
+    WriteBlockPixel(curr_.get(), 1, y, 1, 1, 0xff00ff);
+  WriteBlockPixel(curr_.get(), 0, last_row, 1, 1, 0xff00ff);
+
+  MarkDirtyBlocks(prev_.get(), curr_.get());
+
+  for (int y = 0; y <= last_row; y++) {
+    EXPECT_EQ(y % 3 == 0 ? 1 : 0, GetDiffInfo(1, y)) << "when y = " << y;
+    EXPECT_EQ(y == last_row ? 1 : 0, GetDiffInfo(0, y)) << "when y = " << y;
+  }
+}
+
 TEST_F(DifferTest, MarkDirtyBlocks_Sampling) {
   InitDiffer(kScreenWidth, kScreenHeight);
   ClearDiffInfo();
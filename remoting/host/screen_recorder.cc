@@ -4,6 +4,8 @@
 
 #include "remoting/host/screen_recorder.h"
 
+#include <stdlib.h>
+
 #include <algorithm>
 
 #include "base/bind.h"
@@ -30,6 +32,21 @@ namespace remoting {
 // TODO(hclam): Move this value to CaptureScheduler.
 static const int kMaxRecordings = 2;
 
+// Only one frame is recorded at a time while the frames queued on the network
+// thread would take longer than this to send.
+static const int64 kMaxQueueDelayMs = 100;
+
+// Fraction of the estimated bandwidth the encoder aims for, leaving room for
+// the other channels and for estimation error.
+static const int kBitrateHeadroomPercent = 80;
+
+// The encoder's target is only updated when the estimate moves by more than
+// this, to avoid reconfiguring it for every frame.
+static const int kBitrateUpdateThresholdPercent = 10;
+
+// Number of frames between logging the network estimates.
+static const int kStatsReportInterval = 100;
+
 ScreenRecorder::ScreenRecorder(
     MessageLoop* capture_loop,
     MessageLoop* encode_loop,
@@ -46,6 +63,11 @@ ScreenRecorder::ScreenRecorder(
       max_recordings_(kMaxRecordings),
       recordings_(0),
       frame_skipped_(false),
+      network_backlogged_(false),
+      bandwidth_estimator_(new BandwidthEstimator()),
+      frame_bytes_(0),
+      target_bitrate_kbps_(0),
+      frames_since_report_(0),
       sequence_number_(0) {
   DCHECK(capture_loop_);
   DCHECK(encode_loop_);
@@ -79,6 +101,11 @@ void ScreenRecorder::AddConnection(ConnectionToClient* connection) {
   DCHECK(network_loop_->BelongsToCurrentThread());
   connections_.push_back(connection);
 
+  // Frames queued for a previous connection are never reported as sent.
+  bandwidth_estimator_.reset(new BandwidthEstimator());
+  frame_bytes_ = 0;
+  frame_queue_time_ = base::TimeTicks();
+
   capture_loop_->PostTask(
       FROM_HERE, base::Bind(&ScreenRecorder::DoInvalidateFullScreen, this));
 }
@@ -163,7 +190,8 @@ void ScreenRecorder::DoCapture() {
   // Make sure we have at most two oustanding recordings. We can simply return
   // if we can't make a capture now, the next capture will be started by the
   // end of an encode operation.
-  if (recordings_ >= max_recordings_ || !is_recording()) {
+  if (recordings_ >= max_recordings_ ||
+      (network_backlogged_ && recordings_ > 0) || !is_recording()) {
     frame_skipped_ = true;
     return;
   }
@@ -183,6 +211,7 @@ void ScreenRecorder::DoCapture() {
                         &ScreenRecorder::DoCapture);
 
   // And finally perform one capture.
+  frame_start_times_.push_back(base::TimeTicks::Now());
   capture_start_time_ = base::Time::Now();
   capturer()->CaptureInvalidRegion(
       base::Bind(&ScreenRecorder::CaptureDoneCallback, this));
@@ -214,17 +243,26 @@ void ScreenRecorder::CaptureDoneCallback(
       FROM_HERE, base::Bind(&ScreenRecorder::DoEncode, this, capture_data));
 }
 
-void ScreenRecorder::DoFinishOneRecording() {
+void ScreenRecorder::DoFinishOneRecording(base::TimeDelta queue_delay) {
   DCHECK_EQ(capture_loop_, MessageLoop::current());
 
   if (!is_recording())
     return;
 
+  network_backlogged_ =
+      queue_delay > base::TimeDelta::FromMilliseconds(kMaxQueueDelayMs);
+
   // Decrement the number of recording in process since we have completed
   // one cycle.
   --recordings_;
   DCHECK_GE(recordings_, 0);
 
+  if (!frame_start_times_.empty()) {
+    scheduler_.RecordCaptureToWireLatency(
+        base::TimeTicks::Now() - frame_start_times_.front());
+    frame_start_times_.pop_front();
+  }
+
   // Try to do a capture again only if |frame_skipped_| is set to true by
   // capture timer.
   if (frame_skipped_)
@@ -245,9 +283,17 @@ void ScreenRecorder::DoSendVideoPacket(scoped_ptr<VideoPacket> packet) {
   if (network_stopped_ || connections_.empty())
     return;
 
+  if (frame_queue_time_.is_null())
+    frame_queue_time_ = base::TimeTicks::Now();
+  frame_bytes_ += static_cast<int>(packet->data().size());
+
   base::Closure callback;
-  if ((packet->flags() & VideoPacket::LAST_PARTITION) != 0)
+  if ((packet->flags() & VideoPacket::LAST_PARTITION) != 0) {
     callback = base::Bind(&ScreenRecorder::VideoFrameSentCallback, this);
+    bandwidth_estimator_->RecordFrameQueued(frame_bytes_, frame_queue_time_);
+    frame_bytes_ = 0;
+    frame_queue_time_ = base::TimeTicks();
+  }
 
   // TODO(sergeyu): Currently we send the data only to the first
   // connection. Send it to all connections if necessary.
@@ -261,8 +307,40 @@ void ScreenRecorder::VideoFrameSentCallback() {
   if (network_stopped_)
     return;
 
+  bandwidth_estimator_->RecordFrameSent(base::TimeTicks::Now());
+  UpdateTargetBitrate();
+
+  if (++frames_since_report_ == kStatsReportInterval) {
+    frames_since_report_ = 0;
+    VLOG(1) << "Video bandwidth: "
+            << bandwidth_estimator_->bytes_per_second() * 8 / 1000
+            << " kbps, queued: " << bandwidth_estimator_->queued_bytes()
+            << " bytes, queue delay: "
+            << bandwidth_estimator_->QueueDelay().InMilliseconds() << " ms";
+  }
+
   capture_loop_->PostTask(
-      FROM_HERE, base::Bind(&ScreenRecorder::DoFinishOneRecording, this));
+      FROM_HERE, base::Bind(&ScreenRecorder::DoFinishOneRecording, this,
+                            bandwidth_estimator_->QueueDelay()));
+}
+
+void ScreenRecorder::UpdateTargetBitrate() {
+  DCHECK(network_loop_->BelongsToCurrentThread());
+
+  int64 bytes_per_second = bandwidth_estimator_->bytes_per_second();
+  if (bytes_per_second <= 0)
+    return;
+
+  int bitrate_kbps = static_cast<int>(
+      bytes_per_second * 8 * kBitrateHeadroomPercent / 100 / 1000);
+  int change = std::abs(bitrate_kbps - target_bitrate_kbps_);
+  if (change * 100 <= target_bitrate_kbps_ * kBitrateUpdateThresholdPercent)
+    return;
+
+  target_bitrate_kbps_ = bitrate_kbps;
+  encode_loop_->PostTask(
+      FROM_HERE, base::Bind(&ScreenRecorder::DoSetTargetBitrate, this,
+                            bitrate_kbps));
 }
 
 void ScreenRecorder::DoStopOnNetworkThread(const base::Closure& done_task) {
@@ -307,6 +385,15 @@ void ScreenRecorder::DoEncode(
       base::Bind(&ScreenRecorder::EncodedDataAvailableCallback, this));
 }
 
+void ScreenRecorder::DoSetTargetBitrate(int kilobits_per_second) {
+  DCHECK_EQ(encode_loop_, MessageLoop::current());
+
+  if (encoder_stopped_)
+    return;
+
+  encoder()->SetTargetBitrate(kilobits_per_second);
+}
+
 void ScreenRecorder::DoStopOnEncodeThread(const base::Closure& done_task) {
   DCHECK_EQ(encode_loop_, MessageLoop::current());
 
@@ -5,6 +5,7 @@
 #ifndef REMOTING_HOST_SCREEN_RECORDER_H_
 #define REMOTING_HOST_SCREEN_RECORDER_H_
 
+#include <deque>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -15,6 +16,7 @@
 #include "base/time.h"
 #include "base/timer.h"
 #include "remoting/base/encoder.h"
+#include "remoting/host/bandwidth_estimator.h"
 #include "remoting/host/capturer.h"
 #include "remoting/host/capture_scheduler.h"
 #include "remoting/proto/video.pb.h"
@@ -63,6 +65,16 @@ class CaptureData;
 // | Time
 // v
 //
+// The capture of the next frame overlaps the encode of the previous one, as
+// up to |max_recordings_| frames may be in flight. The time from the start of
+// each capture until its last packet is handed to the network is reported to
+// the CaptureScheduler, which lowers the capture rate when it grows.
+//
+// The throughput of the video channel is estimated from how long each frame
+// takes to write. The encoder is asked to stay below it, and while the frames
+// already queued would take too long to send only one frame is allowed in
+// flight.
+//
 // ScreenRecorder has the following responsibilities:
 // 1. Make sure capture and encode occurs no more frequently than |rate|.
 // 2. Make sure there is at most one outstanding capture not being encoded.
@@ -123,7 +135,10 @@ class ScreenRecorder : public base::RefCountedThreadSafe<ScreenRecorder> {
 
   void DoCapture();
   void CaptureDoneCallback(scoped_refptr<CaptureData> capture_data);
-  void DoFinishOneRecording();
+
+  // |queue_delay| is the estimated time needed to send the frames still
+  // queued on the network thread.
+  void DoFinishOneRecording(base::TimeDelta queue_delay);
   void DoInvalidateFullScreen();
 
   // Network thread -----------------------------------------------------------
@@ -140,6 +155,10 @@ class ScreenRecorder : public base::RefCountedThreadSafe<ScreenRecorder> {
   // each last packet in a frame.
   void VideoFrameSentCallback();
 
+  // Asks the encoder to stay below the estimated bandwidth if it changed
+  // noticeably since the last request.
+  void UpdateTargetBitrate();
+
   // Encoder thread -----------------------------------------------------------
 
   void DoEncode(scoped_refptr<CaptureData> capture_data);
@@ -147,6 +166,8 @@ class ScreenRecorder : public base::RefCountedThreadSafe<ScreenRecorder> {
   // Perform stop operations on encode thread.
   void DoStopOnEncodeThread(const base::Closure& done_task);
 
+  void DoSetTargetBitrate(int kilobits_per_second);
+
   void EncodedDataAvailableCallback(scoped_ptr<VideoPacket> packet);
   void SendVideoPacket(VideoPacket* packet);
 
@@ -186,9 +207,31 @@ class ScreenRecorder : public base::RefCountedThreadSafe<ScreenRecorder> {
   // many pending frames.
   int frame_skipped_;
 
+  // Set when the frames queued on the network thread would take too long to
+  // send, in which case only one recording is allowed at a time. This member
+  // is always accessed on the capture thread.
+  bool network_backlogged_;
+
+  // Estimates the throughput of the video channel. Reset for each connection.
+  // These members are always accessed on the network thread.
+  scoped_ptr<BandwidthEstimator> bandwidth_estimator_;
+
+  // Size of the frame being queued and when its first packet was queued.
+  int frame_bytes_;
+  base::TimeTicks frame_queue_time_;
+
+  // The bitrate last requested from the encoder.
+  int target_bitrate_kbps_;
+
+  int frames_since_report_;
+
   // Time when capture is started.
   base::Time capture_start_time_;
 
+  // Start times of the captures in flight, oldest first, to measure the
+  // capture to wire latency. Frames complete in the order they are captured.
+  std::deque<base::TimeTicks> frame_start_times_;
+
   // Time when encode is started.
   base::Time encode_start_time_;
 
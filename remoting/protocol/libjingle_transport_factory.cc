@@ -23,20 +23,12 @@ namespace protocol {
 
 namespace {
 
-// Value is choosen to balance the extra latency against the reduced
-// load due to ACK traffic.
-const int kTcpAckDelayMilliseconds = 10;
-
-// Values for the TCP send and receive buffer size. This should be tuned to
-// accomodate high latency network but not backlog the decoding pipeline.
-const int kTcpReceiveBufferSize = 256 * 1024;
-const int kTcpSendBufferSize = kTcpReceiveBufferSize + 30 * 1024;
-
 class LibjingleStreamTransport : public StreamTransport,
                                  public sigslot::has_slots<> {
  public:
   LibjingleStreamTransport(cricket::PortAllocator* port_allocator,
-                           bool incoming_only);
+                           bool incoming_only,
+                           const TransportConfig& config);
   virtual ~LibjingleStreamTransport();
 
   // StreamTransport interface.
@@ -68,6 +60,7 @@ class LibjingleStreamTransport : public StreamTransport,
 
   cricket::PortAllocator* port_allocator_;
   bool incoming_only_;
+  TransportConfig config_;
 
   std::string name_;
   EventHandler* event_handler_;
@@ -84,9 +77,11 @@ class LibjingleStreamTransport : public StreamTransport,
 
 LibjingleStreamTransport::LibjingleStreamTransport(
     cricket::PortAllocator* port_allocator,
-    bool incoming_only)
+    bool incoming_only,
+    const TransportConfig& config)
     : port_allocator_(port_allocator),
       incoming_only_(incoming_only),
+      config_(config),
       event_handler_(NULL) {
 }
 
@@ -151,10 +146,10 @@ void LibjingleStreamTransport::Connect(
   // Configure and connect PseudoTCP adapter.
   socket_.reset(
       new jingle_glue::PseudoTcpAdapter(channel_adapter.release()));
-  socket_->SetSendBufferSize(kTcpSendBufferSize);
-  socket_->SetReceiveBufferSize(kTcpReceiveBufferSize);
-  socket_->SetNoDelay(true);
-  socket_->SetAckDelay(kTcpAckDelayMilliseconds);
+  socket_->SetSendBufferSize(config_.tcp_send_buffer_size);
+  socket_->SetReceiveBufferSize(config_.tcp_receive_buffer_size);
+  socket_->SetNoDelay(config_.tcp_no_delay);
+  socket_->SetAckDelay(config_.tcp_ack_delay_ms);
 
   // TODO(sergeyu): This is a hack to improve latency of the video
   // channel. Consider removing it once we have better flow control
@@ -318,6 +313,8 @@ LibjingleTransportFactory::~LibjingleTransportFactory() {
 
 void LibjingleTransportFactory::SetTransportConfig(
     const TransportConfig& config) {
+  config_ = config;
+
   if (http_port_allocator_) {
     std::vector<talk_base::SocketAddress> stun_hosts;
     talk_base::SocketAddress stun_address;
@@ -338,7 +335,8 @@ void LibjingleTransportFactory::SetTransportConfig(
 
 scoped_ptr<StreamTransport> LibjingleTransportFactory::CreateStreamTransport() {
   return scoped_ptr<StreamTransport>(
-      new LibjingleStreamTransport(port_allocator_.get(), incoming_only_));
+      new LibjingleStreamTransport(port_allocator_.get(), incoming_only_,
+                                   config_));
 }
 
 scoped_ptr<DatagramTransport>
@@ -6,6 +6,7 @@
 #define REMOTING_PROTOCOL_LIBJINGLE_TRANSPORT_FACTORY_H_
 
 #include "remoting/protocol/transport.h"
+#include "remoting/protocol/transport_config.h"
 
 namespace cricket {
 class HttpPortAllocatorBase;
@@ -49,6 +50,7 @@ class LibjingleTransportFactory : public TransportFactory {
   cricket::HttpPortAllocatorBase* http_port_allocator_;
   scoped_ptr<cricket::PortAllocator> port_allocator_;
   bool incoming_only_;
+  TransportConfig config_;
 
   DISALLOW_COPY_AND_ASSIGN(LibjingleTransportFactory);
 };
@@ -26,15 +26,6 @@ namespace protocol {
 
 namespace {
 
-// Value is choosen to balance the extra latency against the reduced
-// load due to ACK traffic.
-const int kTcpAckDelayMilliseconds = 10;
-
-// Values for the TCP send and receive buffer size. This should be tuned to
-// accomodate high latency network but not backlog the decoding pipeline.
-const int kTcpReceiveBufferSize = 256 * 1024;
-const int kTcpSendBufferSize = kTcpReceiveBufferSize + 30 * 1024;
-
 class PepperStreamTransport : public StreamTransport,
                               public PepperTransportSocketAdapter::Observer {
  public:
@@ -130,22 +121,23 @@ void PepperStreamTransport::Connect(
       new pp::Transport_Dev(pp_instance_, name_.c_str(),
                             PP_TRANSPORTTYPE_STREAM);
 
-  if (transport->SetProperty(PP_TRANSPORTPROPERTY_TCP_RECEIVE_WINDOW,
-                             pp::Var(kTcpReceiveBufferSize)) != PP_OK) {
+  if (transport->SetProperty(
+          PP_TRANSPORTPROPERTY_TCP_RECEIVE_WINDOW,
+          pp::Var(config_.tcp_receive_buffer_size)) != PP_OK) {
     LOG(ERROR) << "Failed to set TCP receive window";
   }
   if (transport->SetProperty(PP_TRANSPORTPROPERTY_TCP_SEND_WINDOW,
-                             pp::Var(kTcpSendBufferSize)) != PP_OK) {
+                             pp::Var(config_.tcp_send_buffer_size)) != PP_OK) {
     LOG(ERROR) << "Failed to set TCP send window";
   }
 
   if (transport->SetProperty(PP_TRANSPORTPROPERTY_TCP_NO_DELAY,
-                             pp::Var(true)) != PP_OK) {
+                             pp::Var(config_.tcp_no_delay)) != PP_OK) {
     LOG(ERROR) << "Failed to set TCP_NODELAY";
   }
 
   if (transport->SetProperty(PP_TRANSPORTPROPERTY_TCP_ACK_DELAY,
-                             pp::Var(kTcpAckDelayMilliseconds)) != PP_OK) {
+                             pp::Var(config_.tcp_ack_delay_ms)) != PP_OK) {
     LOG(ERROR) << "Failed to set TCP ACK delay.";
   }
 
@@ -7,7 +7,17 @@
 namespace remoting {
 namespace protocol {
 
-TransportConfig::TransportConfig() {
+namespace {
+
+const int kDefaultTcpReceiveBufferSize = 256 * 1024;
+
+}  // namespace
+
+TransportConfig::TransportConfig()
+    : tcp_send_buffer_size(kDefaultTcpReceiveBufferSize + 30 * 1024),
+      tcp_receive_buffer_size(kDefaultTcpReceiveBufferSize),
+      tcp_ack_delay_ms(10),
+      tcp_no_delay(true) {
 }
 
 TransportConfig::~TransportConfig() {
@@ -17,6 +17,19 @@ struct TransportConfig {
   std::string stun_server;
   std::string relay_server;
   std::string relay_token;
+
+  // Send and receive buffer sizes of the PseudoTCP stream channels. The
+  // receive buffer bounds the window, so it should cover the bandwidth-delay
+  // product of the link without backlogging the decoding pipeline.
+  int tcp_send_buffer_size;
+  int tcp_receive_buffer_size;
+
+  // How long the receiver may delay an ACK, balancing the extra latency
+  // against the reduced load due to ACK traffic.
+  int tcp_ack_delay_ms;
+
+  // Disables Nagle's algorithm, so that small messages are not held back.
+  bool tcp_no_delay;
 };
 
 }  // namespace protocol
@@ -765,6 +765,10 @@
         '../ppapi/ppapi.gyp:ppapi_cpp_objects',
         '../skia/skia.gyp:skia',
       ],
+      'include_dirs': [
+        # For the GLES2 constants used by PepperGLRenderer.
+        '../ppapi/lib/gl/include',
+      ],
       'sources': [
         'client/plugin/chromoting_instance.cc',
         'client/plugin/chromoting_instance.h',
@@ -772,6 +776,8 @@
         'client/plugin/chromoting_scriptable_object.h',
         'client/plugin/pepper_entrypoints.cc',
         'client/plugin/pepper_entrypoints.h',
+        'client/plugin/pepper_gl_renderer.cc',
+        'client/plugin/pepper_gl_renderer.h',
         'client/plugin/pepper_input_handler.cc',
         'client/plugin/pepper_input_handler.h',
         'client/plugin/pepper_network_manager.cc',
@@ -1051,6 +1057,8 @@
         'host/capturer_linux.cc',
         'host/capturer_mac.cc',
         'host/capturer_win.cc',
+        'host/bandwidth_estimator.cc',
+        'host/bandwidth_estimator.h',
         'host/capture_scheduler.cc',
         'host/capture_scheduler.h',
         'host/chromoting_host.cc',
@@ -1611,6 +1619,8 @@
         'base/base_mock_objects.h',
         'base/util_unittest.cc',
         'client/key_event_mapper_unittest.cc',
+        'host/bandwidth_estimator_unittest.cc',
+        'host/capture_scheduler_unittest.cc',
 	'host/capturer_helper_unittest.cc',
         'host/capturer_linux_unittest.cc',
         'host/capturer_mac_unittest.cc',
@@ -18,6 +18,9 @@
 // This is where we had compiler support for SSE2 instructions.
 #define SIMD_SSE2 1
 #endif
+#elif defined(__ARM_NEON__)
+// NEON is a compile time option on ARM, there is no runtime check for it.
+#define SIMD_NEON 1
 #endif
 
 // avoid confusion with Mac OS X's math library (Carbon)
@@ -160,6 +163,9 @@ class ConvolutionFilter1D {
 //
 // The layout in memory is assumed to be 4-bytes per pixel in B-G-R-A order
 // (this is ARGB when loaded into 32-bit words on a little-endian machine).
+//
+// |use_simd_if_possible| selects the SSE2 or NEON code when the binary was
+// built with it; pass false on x86 CPUs without SSE2.
 SK_API void BGRAConvolve2D(const unsigned char* source_data,
                            int source_byte_row_stride,
                            bool source_has_alpha,
@@ -167,7 +173,23 @@ SK_API void BGRAConvolve2D(const unsigned char* source_data,
                            const ConvolutionFilter1D& yfilter,
                            int output_byte_row_stride,
                            unsigned char* output,
-                           bool use_sse2);
+                           bool use_simd_if_possible);
+
+// Same as BGRAConvolve2D, but splits the output rows into up to
+// |num_threads| bands, each convolved on its own thread. The calling thread
+// does the first band and blocks until the others are done, so this must
+// not be used on threads which may not block, such as the browser's UI and
+// IO threads. Small images are convolved on the calling thread only, since
+// starting threads would cost more than it saves.
+SK_API void BGRAConvolve2DMultithreaded(const unsigned char* source_data,
+                                        int source_byte_row_stride,
+                                        bool source_has_alpha,
+                                        const ConvolutionFilter1D& xfilter,
+                                        const ConvolutionFilter1D& yfilter,
+                                        int output_byte_row_stride,
+                                        unsigned char* output,
+                                        bool use_simd_if_possible,
+                                        int num_threads);
 }  // namespace skia
 
 #endif  // SKIA_EXT_CONVOLVER_H_
@@ -4,6 +4,8 @@
 
 #include <string.h>
 #include <time.h>
+
+#include <algorithm>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -211,9 +213,11 @@ TEST(Convolver, AddFilter) {
 }
 
 TEST(Convolver, SIMDVerification) {
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
 #if defined(SIMD_SSE2)
   base::CPU cpu;
   if (!cpu.has_sse2()) return;
+#endif
 
   int source_sizes[][2] = { {1920, 1080}, {720, 480}, {1377, 523}, {325, 241} };
   int dest_sizes[][2] = { {1280, 1024}, {480, 270}, {177, 123} };
@@ -318,4 +322,48 @@ TEST(Convolver, SIMDVerification) {
 #endif
 }
 
+TEST(Convolver, MultithreadedMatchesSingleThreaded) {
+  const int kSourceWidth = 1377;
+  const int kSourceHeight = 1023;
+  const int kDestWidth = 523;
+  const int kDestHeight = 389;
+  float filter[] = { 0.05f, -0.15f, 0.6f, 0.6f, -0.15f, 0.05f };
+
+  ConvolutionFilter1D x_filter, y_filter;
+  for (int p = 0; p < kDestWidth; ++p) {
+    int offset = std::min(kSourceWidth * p / kDestWidth,
+                          kSourceWidth - static_cast<int>(arraysize(filter)));
+    x_filter.AddFilter(offset, filter, arraysize(filter));
+  }
+  for (int p = 0; p < kDestHeight; ++p) {
+    int offset = std::min(kSourceHeight * p / kDestHeight,
+                          kSourceHeight - static_cast<int>(arraysize(filter)));
+    y_filter.AddFilter(offset, filter, arraysize(filter));
+  }
+
+  std::vector<unsigned char> source(kSourceWidth * kSourceHeight * 4);
+  for (size_t i = 0; i < source.size(); ++i)
+    source[i] = static_cast<unsigned char>(i * 7 + (i >> 10));
+
+  const int output_size = kDestWidth * kDestHeight * 4;
+  for (int alpha = 0; alpha < 2; alpha++) {
+    for (int simd = 0; simd < 2; simd++) {
+      std::vector<unsigned char> expected(output_size);
+      BGRAConvolve2D(&source[0], kSourceWidth * 4, alpha != 0, x_filter,
+                     y_filter, kDestWidth * 4, &expected[0], simd != 0);
+
+      // Bands of uneven sizes must line up too.
+      for (int num_threads = 2; num_threads <= 5; num_threads++) {
+        std::vector<unsigned char> output(output_size);
+        BGRAConvolve2DMultithreaded(&source[0], kSourceWidth * 4, alpha != 0,
+                                    x_filter, y_filter, kDestWidth * 4,
+                                    &output[0], simd != 0, num_threads);
+        EXPECT_TRUE(expected == output)
+            << "alpha " << alpha << " simd " << simd
+            << " threads " << num_threads;
+      }
+    }
+  }
+}
+
 }  // namespace skia
@@ -355,7 +355,8 @@ SkBitmap ImageOperations::Resize(const SkBitmap& source,
   if (method == ImageOperations::RESIZE_SUBPIXEL)
     return ResizeSubpixel(source, dest_width, dest_height, dest_subset);
   else
-    return ResizeBasic(source, method, dest_width, dest_height, dest_subset);
+    return ResizeBasic(source, method, dest_width, dest_height, dest_subset,
+                       1);
 }
 
 // static
@@ -392,7 +393,7 @@ SkBitmap ImageOperations::ResizeSubpixel(const SkBitmap& source,
                      dest_subset.fLeft + dest_subset.width() * w,
                      dest_subset.fTop + dest_subset.height() * h };
   SkBitmap img = ResizeBasic(source, ImageOperations::RESIZE_LANCZOS3, width,
-                             height, subset);
+                             height, subset, 1);
   const int row_words = img.rowBytes() / 4;
   if (w == 1 && h == 1)
     return img;
@@ -472,7 +473,8 @@ SkBitmap ImageOperations::ResizeSubpixel(const SkBitmap& source,
 SkBitmap ImageOperations::ResizeBasic(const SkBitmap& source,
                                       ResizeMethod method,
                                       int dest_width, int dest_height,
-                                      const SkIRect& dest_subset) {
+                                      const SkIRect& dest_subset,
+                                      int num_threads) {
   TRACE_EVENT2("skia", "ImageOperations::ResizeBasic",
                "src_pixels", source.width()*source.height(),
                "dst_pixels", dest_width*dest_height);
@@ -513,8 +515,13 @@ SkBitmap ImageOperations::ResizeBasic(const SkBitmap& source,
   const uint8* source_subset =
       reinterpret_cast<const uint8*>(source.getPixels());
 
-  // Convolve into the result.
-  base::CPU cpu;
+  // Convolve into the result. SSE2 has to be checked for at runtime, while
+  // NEON is chosen when building.
+#if defined(ARCH_CPU_X86_FAMILY)
+  bool use_simd = base::CPU().has_sse2();
+#else
+  bool use_simd = true;
+#endif
   SkBitmap result;
   result.setConfig(SkBitmap::kARGB_8888_Config,
                    dest_subset.width(), dest_subset.height());
@@ -522,11 +529,13 @@ SkBitmap ImageOperations::ResizeBasic(const SkBitmap& source,
   if (!result.readyToDraw())
     return SkBitmap();
 
-  BGRAConvolve2D(source_subset, static_cast<int>(source.rowBytes()),
-                 !source.isOpaque(), filter.x_filter(), filter.y_filter(),
-                 static_cast<int>(result.rowBytes()),
-                 static_cast<unsigned char*>(result.getPixels()),
-                 cpu.has_sse2());
+  BGRAConvolve2DMultithreaded(source_subset,
+                              static_cast<int>(source.rowBytes()),
+                              !source.isOpaque(), filter.x_filter(),
+                              filter.y_filter(),
+                              static_cast<int>(result.rowBytes()),
+                              static_cast<unsigned char*>(result.getPixels()),
+                              use_simd, num_threads);
 
   // Preserve the "opaque" flag for use as an optimization later.
   result.setIsOpaque(source.isOpaque());
@@ -545,4 +554,16 @@ SkBitmap ImageOperations::Resize(const SkBitmap& source,
   return Resize(source, method, dest_width, dest_height, dest_subset);
 }
 
+// static
+SkBitmap ImageOperations::ResizeMultithreaded(const SkBitmap& source,
+                                              ResizeMethod method,
+                                              int dest_width, int dest_height,
+                                              int num_threads) {
+  SkIRect dest_subset = { 0, 0, dest_width, dest_height };
+  if (method == ImageOperations::RESIZE_SUBPIXEL)
+    return ResizeSubpixel(source, dest_width, dest_height, dest_subset);
+  return ResizeBasic(source, method, dest_width, dest_height, dest_subset,
+                     num_threads);
+}
+
 }  // namespace skia
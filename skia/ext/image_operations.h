@@ -110,6 +110,15 @@ class SK_API ImageOperations {
                          ResizeMethod method,
                          int dest_width, int dest_height);
 
+  // Same as Resize(), but convolves large images on up to |num_threads|
+  // threads. This blocks the calling thread until they are done, so it must
+  // only be used on threads which may block. RESIZE_SUBPIXEL always runs on
+  // the calling thread.
+  static SkBitmap ResizeMultithreaded(const SkBitmap& source,
+                                      ResizeMethod method,
+                                      int dest_width, int dest_height,
+                                      int num_threads);
+
  private:
   ImageOperations();  // Class for scoping only.
 
@@ -117,7 +126,8 @@ class SK_API ImageOperations {
   static SkBitmap ResizeBasic(const SkBitmap& source,
                               ResizeMethod method,
                               int dest_width, int dest_height,
-                              const SkIRect& dest_subset);
+                              const SkIRect& dest_subset,
+                              int num_threads);
 
   // Subpixel renderer.
   static SkBitmap ResizeSubpixel(const SkBitmap& source,
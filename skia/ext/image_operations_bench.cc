@@ -13,9 +13,15 @@
 // source surface + destination surface and dividing by the elapsed time.
 // This number is somewhat reasonable way to measure this, given our current
 // implementation which somewhat scales this way.
+//
+// With -matrix, it instead times a fixed set of typical resizes (favicons,
+// thumbnails, high-DPI scaling) with each resize algorithm and several thread
+// counts, printing one line per combination.
 
 #include <stdio.h>
 
+#include <algorithm>
+
 #include "base/basictypes.h"
 #include "base/command_line.h"
 #include "base/format_macros.h"
@@ -93,6 +99,72 @@ int GetBitmapSize(const SkBitmap* bitmap) {
   return bitmap->height() * bitmap->bytesPerPixel() * bitmap->width();
 }
 
+// Resizes an empty |source_width| x |source_height| bitmap |num_iterations|
+// times, and returns the throughput in MB/s. Stores the total elapsed time in
+// |elapsed_us| and the sizes of the bitmaps in |source_size| and |dest_size|.
+uint64 TimeResize(int source_width, int source_height,
+                  int dest_width, int dest_height,
+                  skia::ImageOperations::ResizeMethod method,
+                  int num_threads,
+                  int num_iterations,
+                  int64* elapsed_us,
+                  int* source_size,
+                  int* dest_size) {
+  SkBitmap source;
+  source.setConfig(SkBitmap::kARGB_8888_Config, source_width, source_height);
+  source.allocPixels();
+  source.eraseARGB(0, 0, 0, 0);
+
+  SkBitmap dest;
+
+  const base::TimeTicks start = base::TimeTicks::Now();
+
+  for (int i = 0; i < num_iterations; ++i) {
+    dest = skia::ImageOperations::ResizeMultithreaded(source,
+                                                      method,
+                                                      dest_width, dest_height,
+                                                      num_threads);
+  }
+
+  *elapsed_us = (base::TimeTicks::Now() - start).InMicroseconds();
+  *source_size = GetBitmapSize(&source);
+  *dest_size = GetBitmapSize(&dest);
+
+  const uint64 num_bytes = static_cast<uint64>(num_iterations) *
+      (*source_size + *dest_size);
+  return *elapsed_us == 0 ? 0 : num_bytes / *elapsed_us;
+}
+
+// A typical resize done by the browser.
+struct MatrixCase {
+  const char* name;
+  int source_width;
+  int source_height;
+  int dest_width;
+  int dest_height;
+};
+
+const MatrixCase kMatrixCases[] = {
+  { "favicon", 64, 64, 16, 16 },
+  { "thumbnail", 1280, 800, 212, 132 },
+  { "hidpi_down", 2560, 1600, 1280, 800 },
+  { "hidpi_up", 800, 600, 1600, 1200 },
+  { "photo", 4000, 3000, 1024, 768 },
+};
+
+const skia::ImageOperations::ResizeMethod kMatrixMethods[] = {
+  skia::ImageOperations::RESIZE_BOX,
+  skia::ImageOperations::RESIZE_HAMMING1,
+  skia::ImageOperations::RESIZE_LANCZOS2,
+  skia::ImageOperations::RESIZE_LANCZOS3,
+};
+
+const int kMatrixThreads[] = { 1, 2, 4 };
+
+// The number of source and destination pixels to process for each line of
+// the matrix, so that small and large cases take about as long.
+const int64 kMatrixPixelsPerCase = 256 * 1024 * 1024;
+
 // Simple class to represent dimensions of a bitmap (width, height).
 class Dimensions {
  public:
@@ -141,7 +213,9 @@ class Benchmark {
 
   Benchmark()
       : num_iterations_(kDefaultNumberIterations),
-        method_(kDefaultResizeMethod) {}
+        method_(kDefaultResizeMethod),
+        num_threads_(1),
+        matrix_(false) {}
 
   // Returns true if command line parsing was successful, false otherwise.
   bool ParseArgs(const CommandLine* command_line);
@@ -151,8 +225,13 @@ class Benchmark {
 
   static void Usage();
  private:
+  // Runs every combination of the matrix cases, methods and thread counts.
+  void RunMatrix() const;
+
   int num_iterations_;
   skia::ImageOperations::ResizeMethod method_;
+  int num_threads_;
+  bool matrix_;
   Dimensions source_;
   Dimensions dest_;
 };
@@ -165,7 +244,8 @@ const skia::ImageOperations::ResizeMethod Benchmark::kDefaultResizeMethod =
 // argument management
 void Benchmark::Usage() {
   printf("image_operations_bench -source wxh -destination wxh "
-         "[-iterations i] [-method m] [-help]\n"
+         "[-iterations i] [-method m] [-threads t] [-help]\n"
+         "image_operations_bench -matrix\n"
          "  -source wxh: specify source width and height\n"
          "  -destination wxh: specify destination width and height\n"
          "  -iter i: perform i iterations (default:%d)\n"
@@ -173,7 +253,10 @@ void Benchmark::Usage() {
          Benchmark::kDefaultNumberIterations,
          MethodToString(Benchmark::kDefaultResizeMethod));
   PrintMethods();
-  printf("\n  -help: prints this help and exits\n");
+  printf("\n  -threads t: resize on up to t threads (default:1)\n"
+         "  -matrix: time typical sizes with every algorithm and 1, 2 and 4 "
+         "threads\n"
+         "  -help: prints this help and exits\n");
 }
 
 bool Benchmark::ParseArgs(const CommandLine* command_line) {
@@ -203,6 +286,14 @@ bool Benchmark::ParseArgs(const CommandLine* command_line) {
         printf("Invalid method '%s' specified\n", value.c_str());
         fNeedHelp = true;
       }
+    } else if (s == "threads") {
+      if (base::StringToInt(value, &num_threads_) == false ||
+          num_threads_ <= 0) {
+        printf("Invalid number of threads '%s' specified\n", value.c_str());
+        fNeedHelp = true;
+      }
+    } else if (s == "matrix") {
+      matrix_ = true;
     } else {
       fNeedHelp = true;
     }
@@ -212,6 +303,10 @@ bool Benchmark::ParseArgs(const CommandLine* command_line) {
     printf("Invalid number of iterations: %d\n", num_iterations_);
     fNeedHelp = true;
   }
+  if (matrix_) {
+    // The matrix has its own sizes.
+    return !fNeedHelp;
+  }
   if (!source_.IsValid()) {
     printf("Invalid source dimensions specified\n");
     fNeedHelp = true;
@@ -228,35 +323,56 @@ bool Benchmark::ParseArgs(const CommandLine* command_line) {
 
 // actual benchmark.
 bool Benchmark::Run() const {
-  SkBitmap source;
-  source.setConfig(SkBitmap::kARGB_8888_Config,
-                   source_.width(), source_.height());
-  source.allocPixels();
-  source.eraseARGB(0, 0, 0, 0);
-
-  SkBitmap dest;
-
-  const base::TimeTicks start = base::TimeTicks::Now();
-
-  for (int i = 0; i < num_iterations_; ++i) {
-    dest = skia::ImageOperations::Resize(source,
-                                         method_,
-                                         dest_.width(), dest_.height());
+  if (matrix_) {
+    RunMatrix();
+    return true;
   }
 
-  const int64 elapsed_us = (base::TimeTicks::Now() - start).InMicroseconds();
-
-  const uint64 num_bytes = static_cast<uint64>(num_iterations_) *
-      (GetBitmapSize(&source) + GetBitmapSize(&dest));
+  int64 elapsed_us;
+  int source_size, dest_size;
+  uint64 speed = TimeResize(source_.width(), source_.height(),
+                            dest_.width(), dest_.height(),
+                            method_, num_threads_, num_iterations_,
+                            &elapsed_us, &source_size, &dest_size);
 
   printf("%"PRIu64" MB/s,\telapsed = %"PRIu64" source=%d dest=%d\n",
-         static_cast<uint64>(elapsed_us == 0 ? 0 : num_bytes / elapsed_us),
-         static_cast<uint64>(elapsed_us),
-         GetBitmapSize(&source), GetBitmapSize(&dest));
+         speed, static_cast<uint64>(elapsed_us), source_size, dest_size);
 
   return true;
 }
 
+void Benchmark::RunMatrix() const {
+  printf("case\tsource\tdest\tmethod\tthreads\tMB/s\tus/resize\n");
+  for (size_t c = 0; c < arraysize(kMatrixCases); ++c) {
+    const MatrixCase& matrix_case = kMatrixCases[c];
+    int64 pixels_per_resize =
+        matrix_case.source_width * matrix_case.source_height +
+        matrix_case.dest_width * matrix_case.dest_height;
+    int num_iterations = static_cast<int>(
+        std::max<int64>(1, kMatrixPixelsPerCase / pixels_per_resize));
+
+    for (size_t m = 0; m < arraysize(kMatrixMethods); ++m) {
+      for (size_t t = 0; t < arraysize(kMatrixThreads); ++t) {
+        int64 elapsed_us;
+        int source_size, dest_size;
+        uint64 speed = TimeResize(matrix_case.source_width,
+                                  matrix_case.source_height,
+                                  matrix_case.dest_width,
+                                  matrix_case.dest_height,
+                                  kMatrixMethods[m], kMatrixThreads[t],
+                                  num_iterations, &elapsed_us, &source_size,
+                                  &dest_size);
+        printf("%s\t%dx%d\t%dx%d\t%s\t%d\t%"PRIu64"\t%"PRId64"\n",
+               matrix_case.name,
+               matrix_case.source_width, matrix_case.source_height,
+               matrix_case.dest_width, matrix_case.dest_height,
+               MethodToString(kMatrixMethods[m]), kMatrixThreads[t], speed,
+               elapsed_us / num_iterations);
+      }
+    }
+  }
+}
+
 // A small class to automatically call Reset on the global command line to
 // avoid nasty valgrind complaints for the leak of the global command line.
 class CommandLineAutoReset {
@@ -0,0 +1,102 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "sql/batching_transaction.h"
+
+#include "base/logging.h"
+#include "base/metrics/histogram.h"
+#include "sql/connection.h"
+
+namespace sql {
+
+BatchingTransaction::BatchingTransaction(Connection* connection,
+                                         base::TimeDelta max_delay,
+                                         int max_writes)
+    : connection_(connection),
+      max_delay_(max_delay),
+      max_writes_(max_writes),
+      is_open_(false),
+      pending_writes_(0),
+      commit_count_(0) {
+  DCHECK_GT(max_writes_, 0);
+}
+
+BatchingTransaction::~BatchingTransaction() {
+  Close();
+}
+
+bool BatchingTransaction::Begin() {
+  DCHECK(CalledOnValidThread());
+  if (is_open_) {
+    NOTREACHED() << "Beginning a batch twice!";
+    return false;
+  }
+  is_open_ = connection_->BeginTransaction();
+  return is_open_;
+}
+
+void BatchingTransaction::DidWrite() {
+  DCHECK(CalledOnValidThread());
+  if (!is_open_)
+    return;
+
+  ++pending_writes_;
+  // Nested transactions commit with the batch, so a full batch can only be
+  // committed once they are done.
+  if (pending_writes_ >= max_writes_ &&
+      connection_->transaction_nesting() == 1) {
+    Commit();
+    return;
+  }
+  if (!commit_timer_.IsRunning()) {
+    commit_timer_.Start(FROM_HERE, max_delay_, this,
+                        &BatchingTransaction::CommitFromTimer);
+  }
+}
+
+bool BatchingTransaction::Commit() {
+  DCHECK(CalledOnValidThread());
+  if (!is_open_)
+    return false;
+  DCHECK_EQ(1, connection_->transaction_nesting())
+      << "Somebody left a transaction open";
+
+  bool succeeded = CommitInternal();
+  is_open_ = connection_->BeginTransaction();
+  return succeeded;
+}
+
+void BatchingTransaction::Close() {
+  DCHECK(CalledOnValidThread());
+  if (!is_open_)
+    return;
+  CommitInternal();
+  is_open_ = false;
+}
+
+void BatchingTransaction::CommitFromTimer() {
+  // A writer still inside a nested transaction will write again, which
+  // restarts the timer.
+  if (connection_->transaction_nesting() > 1)
+    return;
+  Commit();
+}
+
+bool BatchingTransaction::CommitInternal() {
+  commit_timer_.Stop();
+  if (pending_writes_ == 0)
+    return connection_->CommitTransaction();
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  bool succeeded = connection_->CommitTransaction();
+  UMA_HISTOGRAM_TIMES("Sqlite.BatchingTransaction.CommitTime",
+                      base::TimeTicks::Now() - start);
+  UMA_HISTOGRAM_COUNTS_10000("Sqlite.BatchingTransaction.WritesPerCommit",
+                             pending_writes_);
+  pending_writes_ = 0;
+  ++commit_count_;
+  return succeeded;
+}
+
+}  // namespace sql
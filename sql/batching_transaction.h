@@ -0,0 +1,88 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef SQL_BATCHING_TRANSACTION_H_
+#define SQL_BATCHING_TRANSACTION_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/threading/non_thread_safe.h"
+#include "base/time.h"
+#include "base/timer.h"
+#include "sql/sql_export.h"
+
+namespace sql {
+
+class Connection;
+
+// BatchingTransaction keeps a transaction open on a connection so that many
+// small writes share one commit, and so one set of fsyncs, instead of each
+// write committing on its own. The batch is committed once it has been
+// pending for a while or has grown large enough, and when the
+// BatchingTransaction is closed or destroyed.
+//
+// Writes are made on the connection as usual, and reported with DidWrite().
+// Writers may still use sql::Transaction; it nests inside the batch, and is
+// committed along with it.
+//
+// The timer needs a MessageLoop on the thread the object is used on.
+class SQL_EXPORT BatchingTransaction : public base::NonThreadSafe {
+ public:
+  // Commits at most |max_delay| after the first write of a batch, or as soon
+  // as the batch holds |max_writes| writes.
+  BatchingTransaction(Connection* connection,
+                      base::TimeDelta max_delay,
+                      int max_writes);
+
+  // Commits any pending writes.
+  ~BatchingTransaction();
+
+  // Begins the first batch. Returns false if the transaction couldn't be
+  // begun, in which case each write commits on its own.
+  bool Begin();
+
+  // Notes that a write was made on the connection, committing the batch if it
+  // is now full or scheduling a commit if it was empty.
+  void DidWrite();
+
+  // Commits the writes made so far and begins the next batch. Returns false
+  // if the commit failed. Must not be called from inside a nested
+  // transaction.
+  bool Commit();
+
+  // Commits the writes made so far and leaves no transaction open. The object
+  // must not be used afterwards, other than to be destroyed.
+  void Close();
+
+  // The number of commits that wrote something. Each one costs the
+  // connection's journal and database fsyncs.
+  int commit_count() const { return commit_count_; }
+
+  // The number of writes waiting for the next commit.
+  int pending_writes() const { return pending_writes_; }
+
+ private:
+  void CommitFromTimer();
+
+  // Commits the transaction, recording metrics if it held any writes.
+  bool CommitInternal();
+
+  Connection* connection_;
+  const base::TimeDelta max_delay_;
+  const int max_writes_;
+
+  // True while the batch's transaction is open.
+  bool is_open_;
+
+  int pending_writes_;
+  int commit_count_;
+
+  base::OneShotTimer<BatchingTransaction> commit_timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(BatchingTransaction);
+};
+
+}  // namespace sql
+
+#endif  // SQL_BATCHING_TRANSACTION_H_
@@ -0,0 +1,134 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/file_util.h"
+#include "base/message_loop.h"
+#include "base/scoped_temp_dir.h"
+#include "sql/batching_transaction.h"
+#include "sql/connection.h"
+#include "sql/statement.h"
+#include "sql/transaction.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+class SQLBatchingTransactionTest : public testing::Test {
+ public:
+  SQLBatchingTransactionTest() {}
+
+  void SetUp() {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    ASSERT_TRUE(db_.Open(db_path()));
+    ASSERT_TRUE(reader_.Open(db_path()));
+
+    ASSERT_TRUE(db().Execute("CREATE TABLE foo (a, b)"));
+  }
+
+  void TearDown() {
+    reader_.Close();
+    db_.Close();
+  }
+
+  sql::Connection& db() { return db_; }
+
+  FilePath db_path() {
+    return temp_dir_.path().AppendASCII("SQLBatchingTransactionTest.db");
+  }
+
+  // Inserts a row into "foo" and reports it to |batch|.
+  void Insert(sql::BatchingTransaction* batch) {
+    EXPECT_TRUE(db().Execute("INSERT INTO foo (a, b) VALUES (1, 2)"));
+    batch->DidWrite();
+  }
+
+  // Returns the number of committed rows in table "foo", as seen from a
+  // second connection.
+  int CountCommittedFoo() {
+    sql::Statement count(
+        reader_.GetUniqueStatement("SELECT count(*) FROM foo"));
+    count.Step();
+    return count.ColumnInt(0);
+  }
+
+ protected:
+  MessageLoop message_loop_;
+
+ private:
+  ScopedTempDir temp_dir_;
+  sql::Connection db_;
+  sql::Connection reader_;
+};
+
+TEST_F(SQLBatchingTransactionTest, CommitsFullBatch) {
+  sql::BatchingTransaction batch(&db(), base::TimeDelta::FromDays(1), 3);
+  ASSERT_TRUE(batch.Begin());
+
+  Insert(&batch);
+  Insert(&batch);
+  EXPECT_EQ(2, batch.pending_writes());
+  EXPECT_EQ(0, CountCommittedFoo());
+
+  Insert(&batch);
+  EXPECT_EQ(0, batch.pending_writes());
+  EXPECT_EQ(1, batch.commit_count());
+  EXPECT_EQ(3, CountCommittedFoo());
+
+  // The next batch is open.
+  EXPECT_EQ(1, db().transaction_nesting());
+}
+
+TEST_F(SQLBatchingTransactionTest, CommitsAfterDelay) {
+  sql::BatchingTransaction batch(&db(), base::TimeDelta(), 100);
+  ASSERT_TRUE(batch.Begin());
+
+  Insert(&batch);
+  Insert(&batch);
+  EXPECT_EQ(0, CountCommittedFoo());
+
+  message_loop_.RunAllPending();
+  EXPECT_EQ(2, CountCommittedFoo());
+  EXPECT_EQ(1, batch.commit_count());
+}
+
+TEST_F(SQLBatchingTransactionTest, CommitsOnDestruction) {
+  {
+    sql::BatchingTransaction batch(&db(), base::TimeDelta::FromDays(1), 100);
+    ASSERT_TRUE(batch.Begin());
+    Insert(&batch);
+    EXPECT_EQ(0, CountCommittedFoo());
+  }
+  EXPECT_EQ(1, CountCommittedFoo());
+  EXPECT_EQ(0, db().transaction_nesting());
+}
+
+// Nested transactions commit with the batch, and a full batch waits for them.
+TEST_F(SQLBatchingTransactionTest, NestedTransaction) {
+  sql::BatchingTransaction batch(&db(), base::TimeDelta::FromDays(1), 2);
+  ASSERT_TRUE(batch.Begin());
+
+  {
+    sql::Transaction transaction(&db());
+    ASSERT_TRUE(transaction.Begin());
+    Insert(&batch);
+    Insert(&batch);
+    EXPECT_TRUE(transaction.Commit());
+  }
+  EXPECT_EQ(0, CountCommittedFoo());
+  EXPECT_EQ(2, batch.pending_writes());
+
+  Insert(&batch);
+  EXPECT_EQ(3, CountCommittedFoo());
+  EXPECT_EQ(1, batch.commit_count());
+}
+
+// Commits with no writes in them are not counted.
+TEST_F(SQLBatchingTransactionTest, EmptyCommit) {
+  sql::BatchingTransaction batch(&db(), base::TimeDelta::FromDays(1), 100);
+  ASSERT_TRUE(batch.Begin());
+  EXPECT_TRUE(batch.Commit());
+  EXPECT_EQ(0, batch.commit_count());
+
+  Insert(&batch);
+  EXPECT_TRUE(batch.Commit());
+  EXPECT_EQ(1, batch.commit_count());
+  EXPECT_EQ(1, CountCommittedFoo());
+}
@@ -7,10 +7,12 @@
 #include <string.h>
 
 #include "base/file_path.h"
+#include "base/location.h"
 #include "base/logging.h"
 #include "base/string_util.h"
 #include "base/stringprintf.h"
 #include "base/utf_string_conversions.h"
+#include "base/values.h"
 #include "sql/statement.h"
 #include "third_party/sqlite/sqlite3.h"
 
@@ -50,6 +52,18 @@ bool StatementID::operator<(const StatementID& other) const {
   return strcmp(str_, other.str_) < 0;
 }
 
+tracked_objects::Location StatementID::ToLocation() const {
+  if (number_ < 0)
+    return tracked_objects::Location(str_, "sql", -1, NULL);
+  return tracked_objects::Location("sql::Statement", str_, number_, NULL);
+}
+
+StatementStats::StatementStats()
+    : executions(0),
+      cache_hits(0),
+      rows(0) {
+}
+
 ErrorDelegate::ErrorDelegate() {
 }
 
@@ -58,13 +72,17 @@ ErrorDelegate::~ErrorDelegate() {
 
 Connection::StatementRef::StatementRef()
     : connection_(NULL),
-      stmt_(NULL) {
+      stmt_(NULL),
+      id_(NULL),
+      stats_(NULL) {
 }
 
 Connection::StatementRef::StatementRef(Connection* connection,
                                        sqlite3_stmt* stmt)
     : connection_(connection),
-      stmt_(stmt) {
+      stmt_(stmt),
+      id_(NULL),
+      stats_(NULL) {
   connection_->StatementRefCreated(this);
 }
 
@@ -87,6 +105,7 @@ Connection::Connection()
       page_size_(0),
       cache_size_(0),
       exclusive_locking_(false),
+      statement_stats_enabled_(false),
       transaction_nesting_(0),
       needs_rollback_(false) {
 }
@@ -95,6 +114,12 @@ Connection::~Connection() {
   Close();
 }
 
+// static
+void Connection::SetSharedCacheLimit(int64 bytes) {
+  DCHECK_GE(bytes, 0);
+  sqlite3_soft_heap_limit64(bytes);
+}
+
 bool Connection::Open(const FilePath& path) {
 #if defined(OS_WIN)
   return OpenInternal(WideToUTF8(path.value()));
@@ -346,12 +371,26 @@ scoped_refptr<Connection::StatementRef> Connection::GetCachedStatement(
     // case it still has some stuff bound.
     DCHECK(i->second->is_valid());
     sqlite3_reset(i->second->stmt());
+    if (statement_stats_enabled_) {
+      StatementStatsMap::iterator stats =
+          statement_stats_.insert(std::make_pair(id, StatementStats())).first;
+      stats->second.cache_hits++;
+      i->second->set_stats(&stats->first, &stats->second);
+    } else {
+      i->second->set_stats(NULL, NULL);
+    }
     return i->second;
   }
 
   scoped_refptr<StatementRef> statement = GetUniqueStatement(sql);
-  if (statement->is_valid())
+  if (statement->is_valid()) {
     statement_cache_[id] = statement;  // Only cache valid statements.
+    if (statement_stats_enabled_) {
+      StatementStatsMap::iterator stats =
+          statement_stats_.insert(std::make_pair(id, StatementStats())).first;
+      statement->set_stats(&stats->first, &stats->second);
+    }
+  }
   return statement;
 }
 
@@ -432,6 +471,37 @@ int Connection::GetLastChangeCount() const {
   return sqlite3_changes(db_);
 }
 
+void Connection::GetStatementStats(base::ListValue* stats) const {
+  for (StatementStatsMap::const_iterator i = statement_stats_.begin();
+       i != statement_stats_.end(); ++i) {
+    tracked_objects::Location location = i->first.ToLocation();
+    base::DictionaryValue* dict = new base::DictionaryValue;
+    dict->SetString("location", location.ToString());
+    dict->SetInteger("executions", i->second.executions);
+    dict->SetInteger("cache_hits", i->second.cache_hits);
+    dict->SetDouble("rows", static_cast<double>(i->second.rows));
+    dict->SetDouble("step_time_ms", i->second.step_time.InMillisecondsF());
+    stats->Append(dict);
+  }
+}
+
+bool Connection::GetMemoryUsage(MemoryUsage* usage) const {
+  if (!db_)
+    return false;
+
+  // Only the current values are wanted, the high water marks are ignored.
+  int high_water = 0;
+  if (sqlite3_db_status(db_, SQLITE_DBSTATUS_CACHE_USED, &usage->page_cache,
+                        &high_water, 0) != SQLITE_OK ||
+      sqlite3_db_status(db_, SQLITE_DBSTATUS_SCHEMA_USED, &usage->schema,
+                        &high_water, 0) != SQLITE_OK ||
+      sqlite3_db_status(db_, SQLITE_DBSTATUS_STMT_USED, &usage->statements,
+                        &high_water, 0) != SQLITE_OK) {
+    return false;
+  }
+  return true;
+}
+
 int Connection::GetErrorCode() const {
   if (!db_)
     return SQLITE_ERROR;
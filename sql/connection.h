@@ -20,6 +20,14 @@ class FilePath;
 struct sqlite3;
 struct sqlite3_stmt;
 
+namespace base {
+class ListValue;
+}
+
+namespace tracked_objects {
+class Location;
+}
+
 namespace sql {
 
 class Statement;
@@ -63,6 +71,10 @@ class StatementID {
   // We need this to insert into our map.
   bool operator<(const StatementID& other) const;
 
+  // Returns where the statement comes from, for profiling. A statement with a
+  // user-defined name is attributed to that name, with no line number.
+  tracked_objects::Location ToLocation() const;
+
  private:
   int number_;
   const char* str_;
@@ -70,6 +82,24 @@ class StatementID {
 
 #define SQL_FROM_HERE sql::StatementID(__FILE__, __LINE__)
 
+// Counters kept for each cached statement when statement statistics are
+// enabled on its connection.
+struct SQL_EXPORT StatementStats {
+  StatementStats();
+
+  // Number of times the statement was run from the start.
+  int executions;
+
+  // Number of times GetCachedStatement() found the statement compiled.
+  int cache_hits;
+
+  // Number of result rows returned.
+  int64 rows;
+
+  // Total time spent stepping the statement.
+  base::TimeDelta step_time;
+};
+
 class Connection;
 
 // ErrorDelegate defines the interface to implement error handling and recovery
@@ -139,6 +169,30 @@ class SQL_EXPORT Connection {
   // This must be called before Open() to have an effect.
   void set_exclusive_locking() { exclusive_locking_ = true; }
 
+  // Sets the number of bytes of heap the page caches of all connections in
+  // the process may use together.  When the budget is reached, sqlite recycles
+  // the least recently used unpinned pages of any connection rather than
+  // growing, so the caches of idle databases give way to busy ones.  The limit
+  // is soft: sqlite exceeds it rather than fail an allocation.  Zero, the
+  // default, means no budget.  Call before opening any connection.
+  static void SetSharedCacheLimit(int64 bytes);
+
+  // Enables the StatementStats counters for the statements in the statement
+  // cache. Each step of a cached statement is then also tallied, against the
+  // statement's StatementID, on about:profiler.
+  void set_statement_stats_enabled(bool enabled) {
+    statement_stats_enabled_ = enabled;
+  }
+
+  // Emits a trace event, with the SQL, for each step of any statement that
+  // takes |threshold| or longer. Zero, the default, disables it.
+  void set_slow_query_threshold(base::TimeDelta threshold) {
+    slow_query_threshold_ = threshold;
+  }
+  base::TimeDelta slow_query_threshold() const {
+    return slow_query_threshold_;
+  }
+
   // Sets the object that will handle errors. Recomended that it should be set
   // before calling Open(). If not set, the default is to ignore errors on
   // release and assert on debug builds.
@@ -298,6 +352,28 @@ class SQL_EXPORT Connection {
   // is closed.
   int GetLastChangeCount() const;
 
+  // Appends a dictionary to |stats| for each cached statement executed since
+  // statement statistics were enabled, with the statement's "location",
+  // "executions", "cache_hits", "rows" and "step_time_ms", for display on an
+  // internals page.
+  void GetStatementStats(base::ListValue* stats) const;
+
+  // Bytes of heap used by this connection, as reported by sqlite.
+  struct MemoryUsage {
+    MemoryUsage() : page_cache(0), schema(0), statements(0) {}
+
+    // Pages held in this connection's cache.
+    int page_cache;
+    // The parsed schemas of the attached databases.
+    int schema;
+    // Prepared statements, including the statement cache.
+    int statements;
+  };
+
+  // Fills |usage| with the memory this connection currently uses. Returns
+  // false if the database is not open.
+  bool GetMemoryUsage(MemoryUsage* usage) const;
+
   // Errors --------------------------------------------------------------------
 
   // Returns the error code associated with the last sqlite operation.
@@ -352,6 +428,15 @@ class SQL_EXPORT Connection {
     // this will return NULL.
     sqlite3_stmt* stmt() const { return stmt_; }
 
+    // The counters and identity of a cached statement when statement
+    // statistics are enabled, NULL otherwise.
+    StatementStats* stats() const { return stats_; }
+    const StatementID* id() const { return id_; }
+    void set_stats(const StatementID* id, StatementStats* stats) {
+      id_ = id;
+      stats_ = stats;
+    }
+
     // Destroys the compiled statement and marks it NULL. The statement will
     // no longer be active.
     void Close();
@@ -364,6 +449,10 @@ class SQL_EXPORT Connection {
     Connection* connection_;
     sqlite3_stmt* stmt_;
 
+    // Owned by the connection's |statement_stats_|.
+    const StatementID* id_;
+    StatementStats* stats_;
+
     DISALLOW_COPY_AND_ASSIGN(StatementRef);
   };
   friend class StatementRef;
@@ -398,6 +487,9 @@ class SQL_EXPORT Connection {
   int cache_size_;
   bool exclusive_locking_;
 
+  bool statement_stats_enabled_;
+  base::TimeDelta slow_query_threshold_;
+
   // All cached statements. Keeping a reference to these statements means that
   // they'll remain active.
   typedef std::map<StatementID, scoped_refptr<StatementRef> >
@@ -410,6 +502,11 @@ class SQL_EXPORT Connection {
   typedef std::set<StatementRef*> StatementRefSet;
   StatementRefSet open_statements_;
 
+  // Counters for the cached statements, kept when |statement_stats_enabled_|.
+  // Entries are never removed, so StatementRefs can point to them.
+  typedef std::map<StatementID, StatementStats> StatementStatsMap;
+  StatementStatsMap statement_stats_;
+
   // Number of currently-nested transactions.
   int transaction_nesting_;
 
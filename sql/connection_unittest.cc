@@ -4,6 +4,7 @@
 
 #include "base/file_util.h"
 #include "base/scoped_temp_dir.h"
+#include "base/values.h"
 #include "sql/connection.h"
 #include "sql/statement.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -258,6 +259,109 @@ TEST_F(SQLConnectionTest, RazeLocked) {
   ASSERT_TRUE(db().Raze());
 }
 
+namespace {
+
+// Writes |rows| rows of 1KB to a new table of |db|, then reads them all back
+// so that the pages are in the cache and clean.
+void FillDatabase(sql::Connection* db, int rows) {
+  ASSERT_TRUE(db->Execute("CREATE TABLE bar (id INTEGER PRIMARY KEY, value)"));
+  ASSERT_TRUE(db->BeginTransaction());
+  for (int i = 0; i < rows; ++i) {
+    sql::Statement s(db->GetCachedStatement(
+        SQL_FROM_HERE, "INSERT INTO bar VALUES (?, zeroblob(1024))"));
+    s.BindInt(0, i);
+    ASSERT_TRUE(s.Run());
+  }
+  ASSERT_TRUE(db->CommitTransaction());
+
+  sql::Statement s(db->GetUniqueStatement("SELECT length(value) FROM bar"));
+  while (s.Step())
+    EXPECT_EQ(1024, s.ColumnInt(0));
+}
+
+}  // namespace
+
+TEST_F(SQLConnectionTest, GetMemoryUsage) {
+  sql::Connection::MemoryUsage usage;
+  ASSERT_TRUE(db().GetMemoryUsage(&usage));
+
+  FillDatabase(&db(), 100);
+  sql::Connection::MemoryUsage filled_usage;
+  ASSERT_TRUE(db().GetMemoryUsage(&filled_usage));
+  // The table's pages are cached, and the INSERT statement is.
+  EXPECT_GT(filled_usage.page_cache, usage.page_cache);
+  EXPECT_GT(filled_usage.page_cache, 100 * 1024);
+  EXPECT_GT(filled_usage.schema, 0);
+  EXPECT_GT(filled_usage.statements, 0);
+
+  db().Close();
+  EXPECT_FALSE(db().GetMemoryUsage(&usage));
+}
+
+// With a shared budget, filling the cache of one connection takes pages from
+// the cache of another.
+TEST_F(SQLConnectionTest, SharedCacheLimit) {
+  const int kRows = 2000;
+  db().Close();
+  sql::Connection::SetSharedCacheLimit(512 * 1024);
+
+  sql::Connection first_db;
+  first_db.set_cache_size(10 * kRows);
+  ASSERT_TRUE(first_db.Open(db_path()));
+  FillDatabase(&first_db, kRows);
+  sql::Connection::MemoryUsage first_usage;
+  ASSERT_TRUE(first_db.GetMemoryUsage(&first_usage));
+
+  sql::Connection second_db;
+  second_db.set_cache_size(10 * kRows);
+  ASSERT_TRUE(second_db.Open(db_path().InsertBeforeExtensionASCII("2")));
+  FillDatabase(&second_db, kRows);
+  sql::Connection::MemoryUsage usage;
+  ASSERT_TRUE(first_db.GetMemoryUsage(&usage));
+  EXPECT_LT(usage.page_cache, first_usage.page_cache);
+
+  sql::Connection::SetSharedCacheLimit(0);
+}
+
+TEST_F(SQLConnectionTest, StatementStats) {
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a, b)"));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo VALUES (1, 2)"));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo VALUES (3, 4)"));
+
+  // Statements are only counted once enabled.
+  {
+    sql::Statement s(db().GetCachedStatement(SQL_FROM_HERE,
+                                             "SELECT b FROM foo"));
+    while (s.Step()) {}
+  }
+  base::ListValue stats;
+  db().GetStatementStats(&stats);
+  EXPECT_TRUE(stats.empty());
+
+  db().set_statement_stats_enabled(true);
+  for (int i = 0; i < 3; ++i) {
+    sql::Statement s(db().GetCachedStatement(sql::StatementID("StatsTest"),
+                                             "SELECT a FROM foo"));
+    while (s.Step()) {}
+    s.Reset(true);
+    while (s.Step()) {}
+  }
+
+  db().GetStatementStats(&stats);
+  ASSERT_EQ(1u, stats.GetSize());
+  base::DictionaryValue* dict = NULL;
+  ASSERT_TRUE(stats.GetDictionary(0, &dict));
+  int executions = 0;
+  int cache_hits = 0;
+  double rows = 0;
+  EXPECT_TRUE(dict->GetInteger("executions", &executions));
+  EXPECT_TRUE(dict->GetInteger("cache_hits", &cache_hits));
+  EXPECT_TRUE(dict->GetDouble("rows", &rows));
+  EXPECT_EQ(6, executions);
+  EXPECT_EQ(2, cache_hits);
+  EXPECT_EQ(12, rows);
+}
+
 // TODO(shess): Spin up a background thread to hold other_db, to more
 // closely match real life.  That would also allow testing
 // RazeWithTimeout().
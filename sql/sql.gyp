@@ -16,6 +16,8 @@
       ],
       'defines': [ 'SQL_IMPLEMENTATION' ],
       'sources': [
+        'batching_transaction.cc',
+        'batching_transaction.h',
         'connection.cc',
         'connection.h',
         'diagnostic_error_delegate.h',
@@ -38,6 +40,7 @@
       ],
       'sources': [
         'run_all_unittests.cc',
+        'batching_transaction_unittest.cc',
         'connection_unittest.cc',
         'sqlite_features_unittest.cc',
         'statement_unittest.cc',
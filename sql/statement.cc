@@ -4,8 +4,13 @@
 
 #include "sql/statement.h"
 
+#include "base/debug/trace_event.h"
+#include "base/location.h"
 #include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/profiler/scoped_profile.h"
 #include "base/string_util.h"
+#include "base/time.h"
 #include "base/utf_string_conversions.h"
 #include "third_party/sqlite/sqlite3.h"
 
@@ -16,12 +21,14 @@ namespace sql {
 // only have to check the ref's validity bit.
 Statement::Statement()
     : ref_(new Connection::StatementRef),
-      succeeded_(false) {
+      succeeded_(false),
+      stepped_(false) {
 }
 
 Statement::Statement(scoped_refptr<Connection::StatementRef> ref)
     : ref_(ref),
-      succeeded_(false) {
+      succeeded_(false),
+      stepped_(false) {
 }
 
 Statement::~Statement() {
@@ -41,6 +48,39 @@ void Statement::Clear() {
   succeeded_ = false;
 }
 
+int Statement::StepInternal() {
+  StatementStats* stats = ref_->stats();
+  base::TimeDelta threshold = ref_->connection()->slow_query_threshold();
+  if (!stats && threshold == base::TimeDelta())
+    return CheckError(sqlite3_step(ref_->stmt()));
+
+  // Tallies the step on about:profiler against where the statement is
+  // defined.
+  scoped_ptr<tracked_objects::ScopedProfile> profile;
+  if (stats)
+    profile.reset(new tracked_objects::ScopedProfile(ref_->id()->ToLocation()));
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  int err = sqlite3_step(ref_->stmt());
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+
+  if (stats) {
+    if (!stepped_)
+      stats->executions++;
+    if (err == SQLITE_ROW)
+      stats->rows++;
+    stats->step_time += elapsed;
+  }
+  stepped_ = true;
+
+  if (threshold != base::TimeDelta() && elapsed >= threshold) {
+    TRACE_EVENT_INSTANT2("sql", "Connection::SlowQuery",
+                         "sql", TRACE_STR_COPY(sqlite3_sql(ref_->stmt())),
+                         "ms", static_cast<int>(elapsed.InMilliseconds()));
+  }
+  return CheckError(err);
+}
+
 bool Statement::CheckValid() const {
   if (!is_valid())
     DLOG(FATAL) << "Cannot call mutating statements on an invalid statement.";
@@ -51,14 +91,14 @@ bool Statement::Run() {
   if (!CheckValid())
     return false;
 
-  return CheckError(sqlite3_step(ref_->stmt())) == SQLITE_DONE;
+  return StepInternal() == SQLITE_DONE;
 }
 
 bool Statement::Step() {
   if (!CheckValid())
     return false;
 
-  return CheckError(sqlite3_step(ref_->stmt())) == SQLITE_ROW;
+  return StepInternal() == SQLITE_ROW;
 }
 
 void Statement::Reset(bool clear_bound_vars) {
@@ -72,6 +112,7 @@ void Statement::Reset(bool clear_bound_vars) {
   }
 
   succeeded_ = false;
+  stepped_ = false;
 }
 
 bool Statement::Succeeded() const {
@@ -150,6 +150,10 @@ class SQL_EXPORT Statement {
   const char* GetSQLStatement();
 
  private:
+  // Steps the statement, keeping its StatementStats up to date and tracing it
+  // if it is slow. Returns the sqlite result code, after CheckError().
+  int StepInternal();
+
   // This is intended to check for serious errors and report them to the
   // connection object. It takes a sqlite error code, and returns the same
   // code. Currently this function just updates the succeeded flag, but will be
@@ -182,6 +186,10 @@ class SQL_EXPORT Statement {
   // See Succeeded() for what this holds.
   bool succeeded_;
 
+  // Whether the statement has been stepped since it was last reset, so that
+  // executions are only counted on the first step.
+  bool stepped_;
+
   DISALLOW_COPY_AND_ASSIGN(Statement);
 };
 
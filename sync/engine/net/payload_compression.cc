@@ -0,0 +1,77 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "sync/engine/net/payload_compression.h"
+
+#include <string.h>
+
+#include "third_party/zlib/zlib.h"
+
+namespace browser_sync {
+
+namespace {
+
+// Added to the window bits, asks zlib for a gzip header and trailer rather
+// than a zlib one.
+const int kGzipWindowBitsOffset = 16;
+
+// The size of the chunks |GzipUncompress| inflates into.
+const size_t kInflateChunkSize = 16 * 1024;
+
+}  // namespace
+
+const char kGzipContentEncoding[] = "gzip";
+
+bool GzipCompress(const std::string& input, std::string* output) {
+  output->clear();
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                   MAX_WBITS + kGzipWindowBitsOffset, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+
+  // deflateBound() is large enough for a single call to deflate().
+  output->resize(deflateBound(&stream, input.size()));
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = input.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&(*output)[0]);
+  stream.avail_out = output->size();
+  int result = deflate(&stream, Z_FINISH);
+  deflateEnd(&stream);
+  if (result != Z_STREAM_END) {
+    output->clear();
+    return false;
+  }
+  output->resize(stream.total_out);
+  return true;
+}
+
+bool GzipUncompress(const std::string& input, std::string* output) {
+  output->clear();
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, MAX_WBITS + kGzipWindowBitsOffset) != Z_OK)
+    return false;
+
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = input.size();
+  char chunk[kInflateChunkSize];
+  int result = Z_OK;
+  while (result == Z_OK) {
+    stream.next_out = reinterpret_cast<Bytef*>(chunk);
+    stream.avail_out = sizeof(chunk);
+    result = inflate(&stream, Z_NO_FLUSH);
+    output->append(chunk, sizeof(chunk) - stream.avail_out);
+  }
+  inflateEnd(&stream);
+  if (result != Z_STREAM_END) {
+    output->clear();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace browser_sync
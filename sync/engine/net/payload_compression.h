@@ -0,0 +1,28 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Helpers to gzip the bodies of the requests sent to the sync server.
+
+#ifndef SYNC_ENGINE_NET_PAYLOAD_COMPRESSION_H_
+#define SYNC_ENGINE_NET_PAYLOAD_COMPRESSION_H_
+#pragma once
+
+#include <string>
+
+namespace browser_sync {
+
+// The value of the Content-Encoding header of a gzipped request.
+extern const char kGzipContentEncoding[];
+
+// Compresses |input| into a gzip stream in |output|.  Returns false, leaving
+// |output| empty, if it couldn't be compressed.
+bool GzipCompress(const std::string& input, std::string* output);
+
+// Uncompresses the gzip stream |input| into |output|.  Returns false if
+// |input| isn't a complete gzip stream.
+bool GzipUncompress(const std::string& input, std::string* output);
+
+}  // namespace browser_sync
+
+#endif  // SYNC_ENGINE_NET_PAYLOAD_COMPRESSION_H_
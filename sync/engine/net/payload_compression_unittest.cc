@@ -0,0 +1,45 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "sync/engine/net/payload_compression.h"
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace browser_sync {
+namespace {
+
+TEST(PayloadCompressionTest, RoundTrip) {
+  std::string input;
+  for (int i = 0; i < 10000; ++i)
+    input += "sync payload ";
+  std::string compressed;
+  ASSERT_TRUE(GzipCompress(input, &compressed));
+  EXPECT_LT(compressed.size(), input.size());
+
+  std::string output;
+  ASSERT_TRUE(GzipUncompress(compressed, &output));
+  EXPECT_EQ(input, output);
+}
+
+TEST(PayloadCompressionTest, Empty) {
+  std::string compressed;
+  ASSERT_TRUE(GzipCompress(std::string(), &compressed));
+  std::string output("stale");
+  ASSERT_TRUE(GzipUncompress(compressed, &output));
+  EXPECT_TRUE(output.empty());
+}
+
+TEST(PayloadCompressionTest, Truncated) {
+  std::string compressed;
+  ASSERT_TRUE(GzipCompress("sync payload", &compressed));
+  compressed.resize(compressed.size() / 2);
+  std::string output;
+  EXPECT_FALSE(GzipUncompress(compressed, &output));
+  EXPECT_TRUE(output.empty());
+}
+
+}  // namespace
+}  // namespace browser_sync
@@ -14,6 +14,7 @@
 #include "build/build_config.h"
 #include "googleurl/src/gurl.h"
 #include "net/http/http_status_code.h"
+#include "sync/engine/net/payload_compression.h"
 #include "sync/engine/net/url_translator.h"
 #include "sync/engine/syncer.h"
 #include "sync/engine/syncproto.h"
@@ -175,6 +176,7 @@ ServerConnectionManager::ServerConnectionManager(
       use_ssl_(use_ssl),
       proto_sync_path_(kSyncServerSyncPath),
       get_time_path_(kSyncServerGetTimePath),
+      server_accepts_gzip_(false),
       server_status_(HttpResponse::NONE),
       terminated_(false),
       active_connection_(NULL) {
@@ -232,6 +234,27 @@ bool ServerConnectionManager::PostBufferToPath(PostBufferParams* params,
     return false;
   }
 
+  // Requests are only compressed once the server has advertised it accepts
+  // them, so the first request of a session is always sent as is.
+  if (server_accepts_gzip_) {
+    if (PostBufferWithEncoding(params, path, auth_token, true))
+      return true;
+    if (params->response.response_code != net::HTTP_UNSUPPORTED_MEDIA_TYPE)
+      return false;
+    // The server no longer accepts compressed requests; resend this one as
+    // is.
+    server_accepts_gzip_ = false;
+  }
+  return PostBufferWithEncoding(params, path, auth_token, false);
+}
+
+bool ServerConnectionManager::PostBufferWithEncoding(
+    PostBufferParams* params, const string& path, const string& auth_token,
+    bool compress) {
+  string compressed;
+  if (compress && !GzipCompress(params->buffer_in, &compressed))
+    compress = false;
+
   // When our connection object falls out of scope, it clears itself from
   // active_connection_.
   ScopedConnectionHelper post(this, MakeActiveConnection());
@@ -243,11 +266,18 @@ bool ServerConnectionManager::PostBufferToPath(PostBufferParams* params,
   // Note that |post| may be aborted by now, which will just cause Init to fail
   // with CONNECTION_UNAVAILABLE.
   bool ok = post.get()->Init(
-      path.c_str(), auth_token, params->buffer_in, &params->response);
+      path.c_str(), auth_token, compress ? compressed : params->buffer_in,
+      compress ? kGzipContentEncoding : "", &params->response);
 
   if (params->response.server_status == HttpResponse::SYNC_AUTH_ERROR)
     InvalidateAndClearAuthToken();
 
+  if (ok) {
+    server_accepts_gzip_ =
+        params->response.accept_encoding_header.find(kGzipContentEncoding) !=
+        string::npos;
+  }
+
   if (!ok || net::HTTP_OK != params->response.response_code)
     return false;
 
@@ -83,6 +83,10 @@ struct HttpResponse {
   // Value of the Update-Client-Auth header.
   std::string update_client_auth_header;
 
+  // Value of the Accept-Encoding header, with which the server advertises the
+  // encodings it accepts for request bodies.
+  std::string accept_encoding_header;
+
   // Identifies the type of failure, if any.
   ServerConnectionCode server_status;
 
@@ -141,10 +145,12 @@ class ServerConnectionManager {
     explicit Connection(ServerConnectionManager* scm);
     virtual ~Connection();
 
-    // Called to initialize and perform an HTTP POST.
+    // Called to initialize and perform an HTTP POST.  |content_encoding| is
+    // the encoding of |payload|, or empty if it isn't encoded.
     virtual bool Init(const char* path,
                       const std::string& auth_token,
                       const std::string& payload,
+                      const std::string& content_encoding,
                       HttpResponse* response) = 0;
 
     // Immediately abandons a pending HTTP POST request and unblocks caller
@@ -305,6 +311,10 @@ class ServerConnectionManager {
   // The previous auth token that is invalid now.
   std::string previously_invalidated_token;
 
+  // True if the last response of the server advertised that it accepts
+  // gzipped requests.  Only accessed on the sync thread.
+  bool server_accepts_gzip_;
+
   ObserverList<ServerConnectionEventListener> listeners_;
 
   HttpResponse::ServerConnectionCode server_status_;
@@ -323,6 +333,13 @@ class ServerConnectionManager {
   Connection* active_connection_;
 
  private:
+  // Posts |params|, gzipping the request body if |compress| is true.  Called
+  // by PostBufferToPath().
+  bool PostBufferWithEncoding(PostBufferParams* params,
+                              const std::string& path,
+                              const std::string& auth_token,
+                              bool compress);
+
   friend class Connection;
   friend class ScopedServerStatusWatcher;
 
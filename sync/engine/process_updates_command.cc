@@ -4,7 +4,7 @@
 
 #include "sync/engine/process_updates_command.h"
 
-#include <vector>
+#include <string>
 
 #include "base/basictypes.h"
 #include "base/location.h"
@@ -16,43 +16,124 @@
 #include "sync/syncable/syncable.h"
 #include "sync/util/cryptographer.h"
 
-using std::vector;
-
 namespace browser_sync {
 
 using sessions::SyncSession;
 using sessions::StatusController;
-using sessions::UpdateProgress;
+using syncable::GET_BY_ID;
+
+namespace {
+
+// This function attempts to determine whether or not this update is genuinely
+// new, or if it is a reflection of one of our own commits.
+//
+// There is a known inaccuracy in its implementation.  If this update ends up
+// being applied to a local item with a different ID, we will count the change
+// as being a non-reflection update.  Fortunately, the server usually updates
+// our IDs correctly in its commit response, so a new ID during GetUpdate should
+// be rare.
+//
+// The only secnarios I can think of where this might happen are:
+// - We commit a  new item to the server, but we don't persist the
+// server-returned new ID to the database before we shut down.  On the GetUpdate
+// following the next restart, we will receive an update from the server that
+// updates its local ID.
+// - When two attempts to create an item with identical UNIQUE_CLIENT_TAG values
+// collide at the server.  I have seen this in testing.  When it happens, the
+// test server will send one of the clients a response to upate its local ID so
+// that both clients will refer to the item using the same ID going forward.  In
+// this case, we're right to assume that the update is not a reflection.
+//
+// For more information, see SyncerUtil::FindLocalIdToUpdate().
+bool UpdateContainsNewVersion(syncable::BaseTransaction *trans,
+                              const SyncEntity &update) {
+  int64 existing_version = -1; // The server always sends positive versions.
+  syncable::Entry existing_entry(trans, GET_BY_ID, update.id());
+  if (existing_entry.good())
+    existing_version = existing_entry.Get(syncable::BASE_VERSION);
+
+  return existing_version < update.version();
+}
+
+// In the event that IDs match, but tags differ AttemptReuniteClient tag
+// will have refused to unify the update.
+// We should not attempt to apply it at all since it violates consistency
+// rules.
+VerifyResult VerifyTagConsistency(const SyncEntity& entry,
+                                  const syncable::MutableEntry& same_id) {
+  if (entry.has_client_defined_unique_tag() &&
+      entry.client_defined_unique_tag() !=
+          same_id.Get(syncable::UNIQUE_CLIENT_TAG)) {
+    return VERIFY_FAIL;
+  }
+  return VERIFY_UNDECIDED;
+}
+
+// Returns true if the entry is still ok to process.
+bool ReverifyEntry(syncable::WriteTransaction* trans, const SyncEntity& entry,
+                   syncable::MutableEntry* same_id) {
+
+  const bool deleted = entry.has_deleted() && entry.deleted();
+  const bool is_directory = entry.IsFolder();
+  const syncable::ModelType model_type = entry.GetModelType();
+
+  return VERIFY_SUCCESS == SyncerUtil::VerifyUpdateConsistency(trans,
+                                                               entry,
+                                                               same_id,
+                                                               deleted,
+                                                               is_directory,
+                                                               model_type);
+}
+
+}  // namespace
 
 ProcessUpdatesCommand::ProcessUpdatesCommand() {}
 ProcessUpdatesCommand::~ProcessUpdatesCommand() {}
 
 std::set<ModelSafeGroup> ProcessUpdatesCommand::GetGroupsToChange(
     const sessions::SyncSession& session) const {
-  return session.GetEnabledGroupsWithVerifiedUpdates();
+  std::set<ModelSafeGroup> groups_with_updates;
+
+  const GetUpdatesResponse& updates =
+      session.status_controller().updates_response().get_updates();
+  for (int i = 0; i < updates.entries().size(); i++) {
+    groups_with_updates.insert(
+        GetGroupForModelType(syncable::GetModelType(updates.entries(i)),
+                             session.routing_info()));
+  }
+
+  return groups_with_updates;
 }
 
 SyncerError ProcessUpdatesCommand::ModelChangingExecuteImpl(
     SyncSession* session) {
   syncable::Directory* dir = session->context()->directory();
+  syncable::WriteTransaction trans(FROM_HERE, syncable::SYNCER, dir);
+  const Cryptographer* cryptographer = dir->GetCryptographer(&trans);
+  StatusController* status = session->mutable_status_controller();
+  const GetUpdatesResponse& updates = status->updates_response().get_updates();
+  int update_count = updates.entries().size();
 
-  const sessions::UpdateProgress* progress =
-      session->status_controller().update_progress();
-  if (!progress)
-    return SYNCER_OK;  // Nothing to do.
+  DVLOG(1) << update_count << " entries to verify and process";
+  for (int i = 0; i < update_count; i++) {
+    const SyncEntity& update =
+        *reinterpret_cast<const SyncEntity *>(&(updates.entries(i)));
+    ModelSafeGroup g = GetGroupForModelType(update.GetModelType(),
+                                            session->routing_info());
+    if (g != status->group_restriction())
+      continue;
 
-  syncable::WriteTransaction trans(FROM_HERE, syncable::SYNCER, dir);
-  vector<sessions::VerifiedUpdate>::const_iterator it;
-  for (it = progress->VerifiedUpdatesBegin();
-       it != progress->VerifiedUpdatesEnd();
-       ++it) {
-    const sync_pb::SyncEntity& update = it->second;
+    status->increment_num_updates_downloaded_by(1);
+    if (!UpdateContainsNewVersion(&trans, update))
+      status->increment_num_reflected_updates_downloaded_by(1);
+    if (update.deleted())
+      status->increment_num_tombstone_updates_downloaded_by(1);
 
-    if (it->first != VERIFY_SUCCESS && it->first != VERIFY_UNDELETE)
+    VerifyResult verify_result = VerifyUpdate(&trans, update);
+    if (verify_result != VERIFY_SUCCESS && verify_result != VERIFY_UNDELETE)
       continue;
-    switch (ProcessUpdate(update,
-                          dir->GetCryptographer(&trans),
-                          &trans)) {
+
+    switch (ProcessUpdate(update, cryptographer, &trans)) {
       case SUCCESS_PROCESSED:
       case SUCCESS_STORED:
         break;
@@ -62,28 +143,52 @@ SyncerError ProcessUpdatesCommand::ModelChangingExecuteImpl(
     }
   }
 
-  StatusController* status = session->mutable_status_controller();
-  status->mutable_update_progress()->ClearVerifiedUpdates();
   return SYNCER_OK;
 }
 
-namespace {
-// Returns true if the entry is still ok to process.
-bool ReverifyEntry(syncable::WriteTransaction* trans, const SyncEntity& entry,
-                   syncable::MutableEntry* same_id) {
+VerifyResult ProcessUpdatesCommand::VerifyUpdate(
+    syncable::WriteTransaction* trans, const SyncEntity& entry) {
+  syncable::Id id = entry.id();
 
   const bool deleted = entry.has_deleted() && entry.deleted();
   const bool is_directory = entry.IsFolder();
   const syncable::ModelType model_type = entry.GetModelType();
 
-  return VERIFY_SUCCESS == SyncerUtil::VerifyUpdateConsistency(trans,
-                                                               entry,
-                                                               same_id,
-                                                               deleted,
-                                                               is_directory,
-                                                               model_type);
+  if (!id.ServerKnows()) {
+    LOG(ERROR) << "Illegal negative id in received updates";
+    return VERIFY_FAIL;
+  }
+  {
+    const std::string name = SyncerProtoUtil::NameFromSyncEntity(entry);
+    if (name.empty() && !deleted) {
+      LOG(ERROR) << "Zero length name in non-deleted update";
+      return VERIFY_FAIL;
+    }
+  }
+
+  syncable::MutableEntry same_id(trans, GET_BY_ID, id);
+  VerifyResult result = SyncerUtil::VerifyNewEntry(entry, &same_id, deleted);
+
+  if (VERIFY_UNDECIDED == result)
+    result = VerifyTagConsistency(entry, same_id);
+
+  if (VERIFY_UNDECIDED == result) {
+    if (deleted)
+      result = VERIFY_SUCCESS;
+  }
+
+  // If we have an existing entry, we check here for updates that break
+  // consistency rules.
+  if (VERIFY_UNDECIDED == result) {
+    result = SyncerUtil::VerifyUpdateConsistency(trans, entry, &same_id,
+        deleted, is_directory, model_type);
+  }
+
+  if (VERIFY_UNDECIDED == result)
+    result = VERIFY_SUCCESS;  // No news is good news.
+
+  return result;  // This might be VERIFY_SUCCESS as well
 }
-}  // namespace
 
 // Process a single update. Will avoid touching global state.
 ServerUpdateProcessingResult ProcessUpdatesCommand::ProcessUpdate(
@@ -110,8 +215,8 @@ ServerUpdateProcessingResult ProcessUpdatesCommand::ProcessUpdate(
   // server fields of a local entry and then move the data to the local fields
   syncable::MutableEntry target_entry(trans, syncable::GET_BY_ID, local_id);
 
-  // We need to run the Verify checks again; the world could have changed
-  // since VerifyUpdatesCommand.
+  // We need to run the Verify checks again; FindLocalIdToUpdate may have
+  // picked a different local entry than the one that was verified.
   if (!ReverifyEntry(trans, update, &target_entry)) {
     return SUCCESS_PROCESSED;  // The entry has become irrelevant.
   }
@@ -9,6 +9,7 @@
 #include "base/compiler_specific.h"
 #include "sync/engine/model_changing_syncer_command.h"
 #include "sync/engine/syncer_types.h"
+#include "sync/engine/syncproto.h"
 
 namespace syncable {
 class WriteTransaction;
@@ -22,13 +23,16 @@ namespace browser_sync {
 
 class Cryptographer;
 
-// A syncer command for processing updates.
+// A syncer command for verifying and processing updates.
 //
-// Preconditions - updates in the SyncerSesssion have been downloaded
-//                 and verified.
+// Preconditions - updates in the SyncerSesssion have been downloaded.
 //
-// Postconditions - All of the verified SyncEntity data will be copied to
-//                  the server fields of the corresponding syncable entries.
+// Postconditions - All of the SyncEntity data that passed verification will
+//                  be copied to the server fields of the corresponding
+//                  syncable entries.
+//
+// Each update is verified and processed in the same pass over the batch, so
+// that each model safe group is visited and locked once per batch.
 // TODO(tim): This should not be ModelChanging (bug 36592).
 class ProcessUpdatesCommand : public ModelChangingSyncerCommand {
  public:
@@ -43,6 +47,8 @@ class ProcessUpdatesCommand : public ModelChangingSyncerCommand {
       sessions::SyncSession* session) OVERRIDE;
 
  private:
+  VerifyResult VerifyUpdate(syncable::WriteTransaction* trans,
+                            const SyncEntity& entry);
   ServerUpdateProcessingResult ProcessUpdate(
       const sync_pb::SyncEntity& proto_update,
       const Cryptographer* cryptographer,
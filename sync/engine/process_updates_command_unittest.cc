@@ -3,11 +3,13 @@
 // found in the LICENSE file.
 
 #include "base/basictypes.h"
+#include "base/location.h"
 #include "base/memory/ref_counted.h"
 #include "sync/engine/process_updates_command.h"
 #include "sync/sessions/session_state.h"
 #include "sync/sessions/sync_session.h"
 #include "sync/syncable/model_type.h"
+#include "sync/syncable/syncable.h"
 #include "sync/syncable/syncable_id.h"
 #include "sync/test/engine/fake_model_worker.h"
 #include "sync/test/engine/syncer_command_test.h"
@@ -15,6 +17,9 @@
 
 namespace browser_sync {
 
+using sessions::StatusController;
+using syncable::Id;
+
 namespace {
 
 class ProcessUpdatesCommandTest : public SyncerCommandTest {
@@ -32,6 +37,19 @@ class ProcessUpdatesCommandTest : public SyncerCommandTest {
     SyncerCommandTest::SetUp();
   }
 
+  void AddUpdate(const std::string& id,
+                 const std::string& name,
+                 syncable::ModelType type) {
+    sync_pb::SyncEntity* e = session()->mutable_status_controller()->
+        mutable_updates_response()->mutable_get_updates()->add_entries();
+    e->set_id_string(id);
+    e->set_parent_id_string(syncable::GetNullId().GetServerId());
+    e->set_version(10);
+    e->set_non_unique_name(name);
+    e->set_name(name);
+    AddDefaultFieldValue(type, e->mutable_specifics());
+  }
+
   ProcessUpdatesCommand command_;
 
  private:
@@ -40,11 +58,38 @@ class ProcessUpdatesCommandTest : public SyncerCommandTest {
 
 TEST_F(ProcessUpdatesCommandTest, GetGroupsToChange) {
   ExpectNoGroupsToChange(command_);
-  // Add a verified update for GROUP_DB.
-  session()->mutable_status_controller()->
-      GetUnrestrictedMutableUpdateProgressForTest(GROUP_DB)->
-      AddVerifyResult(VerifyResult(), sync_pb::SyncEntity());
+  AddUpdate("a1", "a1", syncable::AUTOFILL);
   ExpectGroupToChange(command_, GROUP_DB);
+  AddUpdate("b1", "b1", syncable::BOOKMARKS);
+  ExpectGroupsToChange(command_, GROUP_UI, GROUP_DB);
+}
+
+// Updates that pass verification are processed in the same pass, and updates
+// that fail it are counted but left alone.
+TEST_F(ProcessUpdatesCommandTest, VerifiesAndProcesses) {
+  AddUpdate("b1", "b1", syncable::BOOKMARKS);
+  AddUpdate("b2", "b2", syncable::BOOKMARKS);
+  // Non-deleted updates must have a name.
+  AddUpdate("b3", "", syncable::BOOKMARKS);
+  AddUpdate("a1", "a1", syncable::AUTOFILL);
+
+  command_.ExecuteImpl(session());
+
+  EXPECT_EQ(4, session()->status_controller().syncer_status().
+            num_updates_downloaded_total);
+
+  syncable::ReadTransaction trans(FROM_HERE, directory());
+  const char* processed_ids[] = { "b1", "b2", "a1" };
+  for (size_t i = 0; i < arraysize(processed_ids); ++i) {
+    syncable::Entry entry(&trans, syncable::GET_BY_ID,
+                          Id::CreateFromServerId(processed_ids[i]));
+    ASSERT_TRUE(entry.good());
+    EXPECT_EQ(10, entry.Get(syncable::SERVER_VERSION));
+    EXPECT_TRUE(entry.Get(syncable::IS_UNAPPLIED_UPDATE));
+  }
+  syncable::Entry rejected(&trans, syncable::GET_BY_ID,
+                           Id::CreateFromServerId("b3"));
+  EXPECT_FALSE(rejected.good());
 }
 
 }  // namespace
@@ -25,7 +25,6 @@
 #include "sync/engine/store_timestamps_command.h"
 #include "sync/engine/syncer_types.h"
 #include "sync/engine/syncproto.h"
-#include "sync/engine/verify_updates_command.h"
 #include "sync/syncable/syncable-inl.h"
 #include "sync/syncable/syncable.h"
 
@@ -61,7 +60,6 @@ const char* SyncerStepToString(const SyncerStep step)
     ENUM_CASE(CLEANUP_DISABLED_TYPES);
     ENUM_CASE(DOWNLOAD_UPDATES);
     ENUM_CASE(PROCESS_CLIENT_COMMAND);
-    ENUM_CASE(VERIFY_UPDATES);
     ENUM_CASE(PROCESS_UPDATES);
     ENUM_CASE(STORE_TIMESTAMPS);
     ENUM_CASE(APPLY_UPDATES);
@@ -137,12 +135,6 @@ void Syncer::SyncShare(sessions::SyncSession* session,
       }
       case PROCESS_CLIENT_COMMAND: {
         ProcessClientCommand(session);
-        next_step = VERIFY_UPDATES;
-        break;
-      }
-      case VERIFY_UPDATES: {
-        VerifyUpdatesCommand verify_updates;
-        verify_updates.Execute(session);
         next_step = PROCESS_UPDATES;
         break;
       }
@@ -32,7 +32,6 @@ enum SyncerStep {
   CLEANUP_DISABLED_TYPES,
   DOWNLOAD_UPDATES,
   PROCESS_CLIENT_COMMAND,
-  VERIFY_UPDATES,
   PROCESS_UPDATES,
   STORE_TIMESTAMPS,
   APPLY_UPDATES,
@@ -0,0 +1,209 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times an initial sync of many data types through the whole syncer, from
+// downloading the updates to applying them, and replays the traffic it
+// recorded to measure the bytes on the wire with each content encoding.
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "sync/engine/model_safe_worker.h"
+#include "sync/engine/net/payload_compression.h"
+#include "sync/engine/syncer.h"
+#include "sync/engine/traffic_recorder.h"
+#include "sync/sessions/sync_session.h"
+#include "sync/sessions/sync_session_context.h"
+#include "sync/syncable/model_type.h"
+#include "sync/syncable/syncable.h"
+#include "sync/test/engine/fake_model_worker.h"
+#include "sync/test/engine/mock_connection_manager.h"
+#include "sync/test/engine/test_directory_setter_upper.h"
+#include "sync/test/fake_extensions_activity_monitor.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace browser_sync {
+
+using sessions::SyncSession;
+using sessions::SyncSessionContext;
+
+namespace {
+
+// Each batch carries |kUpdatesPerTypePerBatch| updates of every type.
+const int kNumBatches = 20;
+const int kUpdatesPerTypePerBatch = 50;
+
+// Large enough to keep all the traffic of the initial sync.
+const unsigned int kMaxTrafficRecords = 1000;
+const unsigned int kMaxTrafficRecordSize = 10 * 1024 * 1024;
+
+class SyncerPerfTest : public testing::Test,
+                       public SyncSession::Delegate,
+                       public ModelSafeWorkerRegistrar {
+ protected:
+  SyncerPerfTest()
+      : traffic_recorder_(kMaxTrafficRecords, kMaxTrafficRecordSize) {}
+
+  // SyncSession::Delegate implementation.
+  virtual void OnSilencedUntil(const base::TimeTicks& silenced_until) OVERRIDE {
+  }
+  virtual bool IsSyncingCurrentlySilenced() OVERRIDE {
+    return false;
+  }
+  virtual void OnReceivedLongPollIntervalUpdate(
+      const base::TimeDelta& new_interval) OVERRIDE {
+  }
+  virtual void OnReceivedShortPollIntervalUpdate(
+      const base::TimeDelta& new_interval) OVERRIDE {
+  }
+  virtual void OnReceivedSessionsCommitDelay(
+      const base::TimeDelta& new_delay) OVERRIDE {
+  }
+  virtual void OnShouldStopSyncingPermanently() OVERRIDE {
+  }
+  virtual void OnSyncProtocolError(
+      const sessions::SyncSessionSnapshot& snapshot) OVERRIDE {
+  }
+
+  // ModelSafeWorkerRegistrar implementation.
+  virtual void GetWorkers(std::vector<ModelSafeWorker*>* out) OVERRIDE {
+    out->push_back(worker_.get());
+  }
+  virtual void GetModelSafeRoutingInfo(ModelSafeRoutingInfo* out) OVERRIDE {
+    for (syncable::ModelTypeSet::Iterator it = types_.First();
+         it.Good(); it.Inc()) {
+      (*out)[it.Get()] = GROUP_PASSIVE;
+    }
+  }
+
+  virtual void SetUp() {
+    dir_maker_.SetUp();
+    types_.Put(syncable::PREFERENCES);
+    types_.Put(syncable::AUTOFILL);
+    types_.Put(syncable::THEMES);
+    types_.Put(syncable::EXTENSIONS);
+    types_.Put(syncable::SEARCH_ENGINES);
+    types_.Put(syncable::APPS);
+    types_.Put(syncable::APP_SETTINGS);
+    types_.Put(syncable::EXTENSION_SETTINGS);
+    mock_server_.reset(new MockConnectionManager(dir_maker_.directory()));
+    mock_server_->ExpectGetUpdatesRequestTypes(types_);
+    worker_ = new FakeModelWorker(GROUP_PASSIVE);
+    context_.reset(new SyncSessionContext(
+        mock_server_.get(), dir_maker_.directory(), this,
+        &extensions_activity_monitor_,
+        std::vector<SyncEngineEventListener*>(), NULL, &traffic_recorder_));
+  }
+
+  virtual void TearDown() {
+    context_.reset();
+    mock_server_.reset();
+    dir_maker_.TearDown();
+  }
+
+  SyncSession* MakeSession() {
+    ModelSafeRoutingInfo info;
+    std::vector<ModelSafeWorker*> workers;
+    GetModelSafeRoutingInfo(&info);
+    GetWorkers(&workers);
+    syncable::ModelTypePayloadMap types =
+        syncable::ModelTypePayloadMapFromRoutingInfo(info, std::string());
+    return new SyncSession(context_.get(), this,
+        sessions::SyncSourceInfo(sync_pb::GetUpdatesCallerInfo::UNKNOWN, types),
+        info, workers);
+  }
+
+  // Queues the batches of the initial sync on the mock server.
+  void AddUpdates() {
+    int id = 1;
+    for (int batch = 0; batch < kNumBatches; ++batch) {
+      if (batch > 0)
+        mock_server_->NextUpdateBatch();
+      for (syncable::ModelTypeSet::Iterator it = types_.First();
+           it.Good(); it.Inc()) {
+        sync_pb::EntitySpecifics specifics;
+        syncable::AddDefaultFieldValue(it.Get(), &specifics);
+        for (int i = 0; i < kUpdatesPerTypePerBatch; ++i, ++id) {
+          mock_server_->AddUpdateSpecifics(id, 0, base::StringPrintf("%d", id),
+                                           10, 10, false, 0, specifics);
+        }
+      }
+      mock_server_->SetChangesRemaining(kNumBatches - batch - 1);
+    }
+  }
+
+  MessageLoop message_loop_;
+  TestDirectorySetterUpper dir_maker_;
+  scoped_ptr<MockConnectionManager> mock_server_;
+  scoped_refptr<ModelSafeWorker> worker_;
+  FakeExtensionsActivityMonitor extensions_activity_monitor_;
+  TrafficRecorder traffic_recorder_;
+  scoped_ptr<SyncSessionContext> context_;
+  syncable::ModelTypeSet types_;
+};
+
+TEST_F(SyncerPerfTest, InitialSyncManyTypes) {
+  AddUpdates();
+  Syncer syncer;
+  scoped_ptr<SyncSession> session(MakeSession());
+
+  PerfTimeLogger timer("Syncer_initial_sync_many_types");
+  syncer.SyncShare(session.get(), SYNCER_BEGIN, SYNCER_END);
+  timer.Done();
+
+  syncable::ReadTransaction trans(FROM_HERE, dir_maker_.directory());
+  std::vector<int64> handles;
+  dir_maker_.directory()->GetUnappliedUpdateMetaHandles(
+      &trans, syncable::FullModelTypeSet::All(), &handles);
+  EXPECT_TRUE(handles.empty());
+}
+
+TEST_F(SyncerPerfTest, InitialSyncManyTypesTraffic) {
+  AddUpdates();
+  Syncer syncer;
+  scoped_ptr<SyncSession> session(MakeSession());
+  syncer.SyncShare(session.get(), SYNCER_BEGIN, SYNCER_END);
+
+  size_t request_bytes = 0;
+  size_t response_bytes = 0;
+  size_t gzipped_request_bytes = 0;
+  size_t gzipped_response_bytes = 0;
+  const std::deque<TrafficRecorder::TrafficRecord>& records =
+      traffic_recorder_.records();
+  ASSERT_FALSE(records.empty());
+  {
+    PerfTimeLogger timer("Syncer_initial_sync_many_types_gzip");
+    for (std::deque<TrafficRecorder::TrafficRecord>::const_iterator it =
+             records.begin(); it != records.end(); ++it) {
+      ASSERT_FALSE(it->truncated);
+      std::string gzipped;
+      ASSERT_TRUE(GzipCompress(it->message, &gzipped));
+      if (it->message_type == TrafficRecorder::CLIENT_TO_SERVER_MESSAGE) {
+        request_bytes += it->message.size();
+        gzipped_request_bytes += gzipped.size();
+      } else {
+        response_bytes += it->message.size();
+        gzipped_response_bytes += gzipped.size();
+      }
+    }
+  }
+  LogPerfResult("Syncer_initial_sync_many_types_request_bytes",
+                request_bytes, "bytes");
+  LogPerfResult("Syncer_initial_sync_many_types_request_bytes_gzip",
+                gzipped_request_bytes, "bytes");
+  LogPerfResult("Syncer_initial_sync_many_types_response_bytes",
+                response_bytes, "bytes");
+  LogPerfResult("Syncer_initial_sync_many_types_response_bytes_gzip",
+                gzipped_response_bytes, "bytes");
+}
+
+}  // namespace
+
+}  // namespace browser_sync
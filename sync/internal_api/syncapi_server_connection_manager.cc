@@ -29,6 +29,7 @@ SyncAPIBridgedConnection::~SyncAPIBridgedConnection() {
 bool SyncAPIBridgedConnection::Init(const char* path,
                                     const std::string& auth_token,
                                     const std::string& payload,
+                                    const std::string& content_encoding,
                                     HttpResponse* response) {
   std::string sync_server;
   int sync_server_port = 0;
@@ -40,11 +41,16 @@ bool SyncAPIBridgedConnection::Init(const char* path,
   http->SetUserAgent(scm_->user_agent().c_str());
   http->SetURL(connection_url.c_str(), sync_server_port);
 
-  if (!auth_token.empty()) {
-    const std::string& headers =
-        "Authorization: GoogleLogin auth=" + auth_token;
-    http->SetExtraRequestHeaders(headers.c_str());
+  std::string headers;
+  if (!auth_token.empty())
+    headers = "Authorization: GoogleLogin auth=" + auth_token;
+  if (!content_encoding.empty()) {
+    if (!headers.empty())
+      headers += "\r\n";
+    headers += "Content-Encoding: " + content_encoding;
   }
+  if (!headers.empty())
+    http->SetExtraRequestHeaders(headers.c_str());
 
   // Must be octet-stream, or the payload may be parsed for a cookie.
   http->SetPostPayload("application/octet-stream", payload.length(),
@@ -75,6 +81,11 @@ bool SyncAPIBridgedConnection::Init(const char* path,
 
   response->update_client_auth_header =
       http->GetResponseHeaderValue("Update-Client-Auth");
+  // Compressed responses are negotiated and decoded by the network stack;
+  // compressed requests have no such negotiation, so the server advertises
+  // them in its responses.
+  response->accept_encoding_header =
+      http->GetResponseHeaderValue("Accept-Encoding");
 
   // Write the content into our buffer.
   buffer_.assign(http->GetResponseContent(), http->GetResponseContentLength());
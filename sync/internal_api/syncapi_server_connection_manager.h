@@ -31,6 +31,7 @@ class SyncAPIBridgedConnection
   virtual bool Init(const char* path,
                     const std::string& auth_token,
                     const std::string& payload,
+                    const std::string& content_encoding,
                     browser_sync::HttpResponse* response) OVERRIDE;
 
   virtual void Abort() OVERRIDE;
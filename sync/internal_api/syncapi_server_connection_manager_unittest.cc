@@ -12,6 +12,8 @@
 #include "base/threading/thread.h"
 #include "base/time.h"
 #include "net/base/net_errors.h"
+#include "net/http/http_status_code.h"
+#include "sync/engine/net/payload_compression.h"
 #include "sync/internal_api/http_post_provider_factory.h"
 #include "sync/internal_api/http_post_provider_interface.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -70,8 +72,124 @@ class BlockingHttpPostFactory : public HttpPostProviderFactory {
   }
 };
 
+// What the server saw of the last request, and how it answers.
+struct FakeServerState {
+  FakeServerState() : response_code(net::HTTP_OK) {}
+
+  std::string headers;
+  std::string payload;
+  int response_code;
+  std::string accept_encoding;
+};
+
+class RecordingHttpPost : public HttpPostProviderInterface {
+ public:
+  explicit RecordingHttpPost(FakeServerState* state)
+      : state_(state), response_("response") {}
+  virtual ~RecordingHttpPost() {}
+
+  virtual void SetUserAgent(const char* user_agent) OVERRIDE {}
+  virtual void SetExtraRequestHeaders(const char* headers) OVERRIDE {
+    state_->headers = headers;
+  }
+  virtual void SetURL(const char* url, int port) OVERRIDE {}
+  virtual void SetPostPayload(const char* content_type,
+                              int content_length,
+                              const char* content) OVERRIDE {
+    state_->payload.assign(content, content_length);
+  }
+  virtual bool MakeSynchronousPost(int* error_code, int* response_code)
+      OVERRIDE {
+    *error_code = net::OK;
+    *response_code = state_->response_code;
+    return true;
+  }
+  virtual int GetResponseContentLength() const OVERRIDE {
+    return response_.size();
+  }
+  virtual const char* GetResponseContent() const OVERRIDE {
+    return response_.data();
+  }
+  virtual const std::string GetResponseHeaderValue(
+      const std::string& name) const OVERRIDE {
+    return name == "Accept-Encoding" ? state_->accept_encoding : "";
+  }
+  virtual void Abort() OVERRIDE {}
+
+ private:
+  FakeServerState* state_;
+  std::string response_;
+};
+
+class RecordingHttpPostFactory : public HttpPostProviderFactory {
+ public:
+  explicit RecordingHttpPostFactory(FakeServerState* state) : state_(state) {}
+  virtual ~RecordingHttpPostFactory() {}
+  virtual HttpPostProviderInterface* Create() OVERRIDE {
+    return new RecordingHttpPost(state_);
+  }
+  virtual void Destroy(HttpPostProviderInterface* http) OVERRIDE {
+    delete http;
+  }
+
+ private:
+  FakeServerState* state_;
+};
+
+bool Post(ServerConnectionManager* server, const std::string& payload) {
+  ServerConnectionManager::PostBufferParams params;
+  params.buffer_in = payload;
+  ScopedServerStatusWatcher watcher(server, &params.response);
+  return server->PostBufferWithCachedAuth(&params, &watcher);
+}
+
 }  // namespace
 
+TEST(SyncAPIServerConnectionManagerTest, CompressOnceServerAccepts) {
+  FakeServerState state;
+  SyncAPIServerConnectionManager server(
+      "server", 0, true, "1", new RecordingHttpPostFactory(&state));
+  server.set_auth_token("testauth");
+
+  // Nothing is compressed until the server advertises it.
+  EXPECT_TRUE(Post(&server, "first"));
+  EXPECT_EQ("first", state.payload);
+  EXPECT_EQ(std::string::npos, state.headers.find("Content-Encoding"));
+
+  state.accept_encoding = "gzip";
+  EXPECT_TRUE(Post(&server, "second"));
+  EXPECT_EQ("second", state.payload);
+
+  EXPECT_TRUE(Post(&server, "third"));
+  EXPECT_NE(std::string::npos,
+            state.headers.find("Content-Encoding: gzip"));
+  EXPECT_NE(std::string::npos,
+            state.headers.find("Authorization: GoogleLogin auth=testauth"));
+  std::string uncompressed;
+  ASSERT_TRUE(browser_sync::GzipUncompress(state.payload, &uncompressed));
+  EXPECT_EQ("third", uncompressed);
+}
+
+TEST(SyncAPIServerConnectionManagerTest, ResendUncompressedIfRejected) {
+  FakeServerState state;
+  SyncAPIServerConnectionManager server(
+      "server", 0, true, "1", new RecordingHttpPostFactory(&state));
+  server.set_auth_token("testauth");
+  state.accept_encoding = "gzip";
+  EXPECT_TRUE(Post(&server, "first"));
+
+  // The server stops accepting compressed requests.
+  state.accept_encoding.clear();
+  state.response_code = net::HTTP_UNSUPPORTED_MEDIA_TYPE;
+  EXPECT_FALSE(Post(&server, "second"));
+  EXPECT_EQ("second", state.payload);
+  EXPECT_EQ(std::string::npos, state.headers.find("Content-Encoding"));
+
+  state.response_code = net::HTTP_OK;
+  EXPECT_TRUE(Post(&server, "third"));
+  EXPECT_EQ("third", state.payload);
+}
+
 TEST(SyncAPIServerConnectionManagerTest, EarlyAbortPost) {
   SyncAPIServerConnectionManager server(
       "server", 0, true, "1", new BlockingHttpPostFactory());
@@ -327,11 +327,6 @@ UpdateProgress::UpdateProgress() {}
 
 UpdateProgress::~UpdateProgress() {}
 
-void UpdateProgress::AddVerifyResult(const VerifyResult& verify_result,
-                                     const sync_pb::SyncEntity& entity) {
-  verified_updates_.push_back(std::make_pair(verify_result, entity));
-}
-
 void UpdateProgress::AddAppliedUpdate(const UpdateAttemptResponse& response,
     const syncable::Id& id) {
   applied_updates_.push_back(std::make_pair(response, id));
@@ -341,21 +336,11 @@ std::vector<AppliedUpdate>::iterator UpdateProgress::AppliedUpdatesBegin() {
   return applied_updates_.begin();
 }
 
-std::vector<VerifiedUpdate>::const_iterator
-UpdateProgress::VerifiedUpdatesBegin() const {
-  return verified_updates_.begin();
-}
-
 std::vector<AppliedUpdate>::const_iterator
 UpdateProgress::AppliedUpdatesEnd() const {
   return applied_updates_.end();
 }
 
-std::vector<VerifiedUpdate>::const_iterator
-UpdateProgress::VerifiedUpdatesEnd() const {
-  return verified_updates_.end();
-}
-
 int UpdateProgress::SuccessfullyAppliedUpdateCount() const {
   int count = 0;
   for (std::vector<AppliedUpdate>::const_iterator it =
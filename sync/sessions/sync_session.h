@@ -173,9 +173,6 @@ class SyncSession {
   // Returns the set of enabled groups that have conflicts.
   std::set<ModelSafeGroup> GetEnabledGroupsWithConflicts() const;
 
-  // Returns the set of enabled groups that have verified updates.
-  std::set<ModelSafeGroup> GetEnabledGroupsWithVerifiedUpdates() const;
-
  private:
   // Extend the encapsulation boundary to utilities for internal member
   // assignments. This way, the scope of these actions is explicit, they can't
@@ -95,6 +95,8 @@ class DirectoryBackingStore : public base::NonThreadSafe {
 
   // Save/update helpers for entries.  Return false if sqlite commit fails.
   bool SaveEntryToDB(const EntryKernel& entry);
+  // Saves |entries| using statements that write several rows at once.
+  bool SaveEntriesToDB(const EntryKernelSet& entries);
   bool SaveNewEntryToDB(const EntryKernel& entry);
   bool UpdateEntryToDB(const EntryKernel& entry);
 
@@ -152,6 +154,7 @@ class DirectoryBackingStore : public base::NonThreadSafe {
 
   scoped_ptr<sql::Connection> db_;
   sql::Statement save_entry_statement_;
+  sql::Statement save_entry_batch_statement_;
   std::string dir_name_;
 
   // Set to true if migration left some old columns around that need to be
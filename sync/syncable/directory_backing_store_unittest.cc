@@ -4,7 +4,9 @@
 
 #include "testing/gtest/include/gtest/gtest.h"
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "base/file_path.h"
 #include "base/file_util.h"
@@ -1978,12 +1980,16 @@ TEST_P(MigrationTest, ToCurrentVersion) {
             GetMetaProtoTimes(&connection));
   ExpectTimes(index, GetExpectedMetaTimes());
 
-  MetahandlesIndex::iterator it = index.begin();
-  ASSERT_TRUE(it != index.end());
+  // The index is not ordered; check the entries in metahandle order.
+  std::vector<EntryKernel*> entries(index.begin(), index.end());
+  std::sort(entries.begin(), entries.end(),
+            LessField<MetahandleField, META_HANDLE>());
+  std::vector<EntryKernel*>::iterator it = entries.begin();
+  ASSERT_TRUE(it != entries.end());
   ASSERT_EQ(1, (*it)->ref(META_HANDLE));
   EXPECT_TRUE((*it)->ref(ID).IsRoot());
 
-  ASSERT_TRUE(++it != index.end());
+  ASSERT_TRUE(++it != entries.end());
   ASSERT_EQ(6, (*it)->ref(META_HANDLE));
   EXPECT_TRUE((*it)->ref(IS_DIR));
   EXPECT_TRUE((*it)->ref(SERVER_IS_DIR));
@@ -1995,25 +2001,25 @@ TEST_P(MigrationTest, ToCurrentVersion) {
       (*it)->ref(SPECIFICS).bookmark().has_favicon());
   EXPECT_FALSE((*it)->ref(SERVER_SPECIFICS).bookmark().has_favicon());
 
-  ASSERT_TRUE(++it != index.end());
+  ASSERT_TRUE(++it != entries.end());
   ASSERT_EQ(7, (*it)->ref(META_HANDLE));
   EXPECT_EQ("google_chrome", (*it)->ref(UNIQUE_SERVER_TAG));
   EXPECT_FALSE((*it)->ref(SPECIFICS).has_bookmark());
   EXPECT_FALSE((*it)->ref(SERVER_SPECIFICS).has_bookmark());
 
-  ASSERT_TRUE(++it != index.end());
+  ASSERT_TRUE(++it != entries.end());
   ASSERT_EQ(8, (*it)->ref(META_HANDLE));
   EXPECT_EQ("google_chrome_bookmarks", (*it)->ref(UNIQUE_SERVER_TAG));
   EXPECT_TRUE((*it)->ref(SPECIFICS).has_bookmark());
   EXPECT_TRUE((*it)->ref(SERVER_SPECIFICS).has_bookmark());
 
-  ASSERT_TRUE(++it != index.end());
+  ASSERT_TRUE(++it != entries.end());
   ASSERT_EQ(9, (*it)->ref(META_HANDLE));
   EXPECT_EQ("bookmark_bar", (*it)->ref(UNIQUE_SERVER_TAG));
   EXPECT_TRUE((*it)->ref(SPECIFICS).has_bookmark());
   EXPECT_TRUE((*it)->ref(SERVER_SPECIFICS).has_bookmark());
 
-  ASSERT_TRUE(++it != index.end());
+  ASSERT_TRUE(++it != entries.end());
   ASSERT_EQ(10, (*it)->ref(META_HANDLE));
   EXPECT_FALSE((*it)->ref(IS_DEL));
   EXPECT_TRUE((*it)->ref(SPECIFICS).has_bookmark());
@@ -2028,7 +2034,7 @@ TEST_P(MigrationTest, ToCurrentVersion) {
   EXPECT_EQ("Other Bookmarks", (*it)->ref(NON_UNIQUE_NAME));
   EXPECT_EQ("Other Bookmarks", (*it)->ref(SERVER_NON_UNIQUE_NAME));
 
-  ASSERT_TRUE(++it != index.end());
+  ASSERT_TRUE(++it != entries.end());
   ASSERT_EQ(11, (*it)->ref(META_HANDLE));
   EXPECT_FALSE((*it)->ref(IS_DEL));
   EXPECT_FALSE((*it)->ref(IS_DIR));
@@ -2046,7 +2052,7 @@ TEST_P(MigrationTest, ToCurrentVersion) {
   EXPECT_EQ("Home (The Chromium Projects)", (*it)->ref(NON_UNIQUE_NAME));
   EXPECT_EQ("Home (The Chromium Projects)", (*it)->ref(SERVER_NON_UNIQUE_NAME));
 
-  ASSERT_TRUE(++it != index.end());
+  ASSERT_TRUE(++it != entries.end());
   ASSERT_EQ(12, (*it)->ref(META_HANDLE));
   EXPECT_FALSE((*it)->ref(IS_DEL));
   EXPECT_TRUE((*it)->ref(IS_DIR));
@@ -2062,13 +2068,13 @@ TEST_P(MigrationTest, ToCurrentVersion) {
       (*it)->ref(SPECIFICS).bookmark().has_favicon());
   EXPECT_FALSE((*it)->ref(SERVER_SPECIFICS).bookmark().has_favicon());
 
-  ASSERT_TRUE(++it != index.end());
+  ASSERT_TRUE(++it != entries.end());
   ASSERT_EQ(13, (*it)->ref(META_HANDLE));
 
-  ASSERT_TRUE(++it != index.end());
+  ASSERT_TRUE(++it != entries.end());
   ASSERT_EQ(14, (*it)->ref(META_HANDLE));
 
-  ASSERT_TRUE(++it == index.end());
+  ASSERT_TRUE(++it == entries.end());
 }
 
 INSTANTIATE_TEST_CASE_P(DirectoryBackingStore, MigrationTest,
@@ -6,8 +6,31 @@
 #define SYNC_SYNCABLE_SYNCABLE_INL_H_
 #pragma once
 
+#include <string>
+
+#include "base/basictypes.h"
+#include "build/build_config.h"
+#include "sync/syncable/syncable_id.h"
+
 namespace syncable {
 
+// Hash functions for the types of the fields that are used as keys of the
+// hashed indices.
+inline size_t HashFieldValue(int64 value) {
+  return static_cast<size_t>(value ^ (value >> 32));
+}
+
+inline size_t HashFieldValue(const std::string& value) {
+  size_t result = 0;
+  for (std::string::const_iterator i = value.begin(); i != value.end(); ++i)
+    result = (result * 131) + *i;
+  return result;
+}
+
+inline size_t HashFieldValue(const Id& value) {
+  return HashFieldValue(value.value());
+}
+
 template <typename FieldType, FieldType field_index>
 class LessField {
  public:
@@ -17,6 +40,35 @@ class LessField {
   }
 };
 
+template <typename FieldType, FieldType field_index>
+class HashField {
+ public:
+#if defined(COMPILER_MSVC)
+  // Traits required by stdext::hash_set, which also orders the elements of
+  // each bucket.
+  static const size_t bucket_size = 4;
+  static const size_t min_buckets = 8;
+
+  inline bool operator() (const syncable::EntryKernel* a,
+                          const syncable::EntryKernel* b) const {
+    return a->ref(field_index) < b->ref(field_index);
+  }
+#endif
+
+  inline size_t operator() (const syncable::EntryKernel* a) const {
+    return HashFieldValue(a->ref(field_index));
+  }
+};
+
+template <typename FieldType, FieldType field_index>
+class EqualField {
+ public:
+  inline bool operator() (const syncable::EntryKernel* a,
+                          const syncable::EntryKernel* b) const {
+    return a->ref(field_index) == b->ref(field_index);
+  }
+};
+
 }  // namespace syncable
 
 #endif  // SYNC_SYNCABLE_SYNCABLE_INL_H_
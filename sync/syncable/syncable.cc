@@ -22,6 +22,7 @@
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/metrics/histogram.h"
 #include "base/perftimer.h"
 #include "base/stl_util.h"
 #include "base/string_number_conversions.h"
@@ -288,6 +289,53 @@ EntryKernel::EntryKernel() : dirty_(false) {
 
 EntryKernel::~EntryKernel() {}
 
+void EntryKernel::SerializeSpecifics(ProtoField field,
+                                     std::string* result) const {
+  const std::string& serialized =
+      serialized_specifics_fields[field - PROTO_FIELDS_BEGIN];
+  if (!serialized.empty()) {
+    *result = serialized;
+    return;
+  }
+  specifics_fields[field - PROTO_FIELDS_BEGIN].SerializeToString(result);
+}
+
+void EntryKernel::DecodeAllSpecifics() const {
+  for (int i = PROTO_FIELDS_BEGIN; i < PROTO_FIELDS_END; ++i)
+    DecodeSpecifics(static_cast<ProtoField>(i));
+}
+
+void EntryKernel::ShareEqualFields() {
+  // Assigning a string to an equal one makes them share their buffer with
+  // copy-on-write strings.
+  std::string& name = string_fields[NON_UNIQUE_NAME - STRING_FIELDS_BEGIN];
+  const std::string& server_name =
+      string_fields[SERVER_NON_UNIQUE_NAME - STRING_FIELDS_BEGIN];
+  if (name == server_name)
+    name = server_name;
+
+  std::string& specifics =
+      serialized_specifics_fields[SPECIFICS - PROTO_FIELDS_BEGIN];
+  const std::string& server_specifics =
+      serialized_specifics_fields[SERVER_SPECIFICS - PROTO_FIELDS_BEGIN];
+  if (!specifics.empty() && specifics == server_specifics)
+    specifics = server_specifics;
+}
+
+void EntryKernel::DecodeSerializedSpecifics(ProtoField field) const {
+  std::string& serialized =
+      serialized_specifics_fields[field - PROTO_FIELDS_BEGIN];
+  sync_pb::EntitySpecifics& specifics =
+      specifics_fields[field - PROTO_FIELDS_BEGIN];
+  if (!specifics.ParseFromString(serialized)) {
+    DLOG(ERROR) << "Could not decode specifics of entry "
+                << ref(META_HANDLE);
+    specifics.Clear();
+  }
+  // Release the buffer; clear() keeps it.
+  std::string().swap(serialized);
+}
+
 syncable::ModelType EntryKernel::GetServerModelType() const {
   ModelType specifics_type = GetModelTypeFromSpecifics(ref(SERVER_SPECIFICS));
   if (specifics_type != UNSPECIFIED)
@@ -635,11 +683,9 @@ EntryKernel* Directory::GetEntryByClientTag(const string& tag) {
 EntryKernel* Directory::GetEntryByServerTag(const string& tag) {
   ScopedKernelLock lock(this);
   DCHECK(kernel_);
-  // We don't currently keep a separate index for the tags.  Since tags
-  // only exist for server created items that are the first items
-  // to be created in a store, they should have small metahandles.
-  // So, we just iterate over the items in sorted metahandle order,
-  // looking for a match.
+  // We don't currently keep a separate index for the tags.  Tags only exist
+  // for a handful of server created items, which are looked up rarely, so we
+  // just iterate over all the items looking for a match.
   MetahandlesIndex& set = *kernel_->metahandles_index;
   for (MetahandlesIndex::iterator i = set.begin(); i != set.end(); ++i) {
     if ((*i)->ref(UNIQUE_SERVER_TAG) == tag) {
@@ -813,46 +859,103 @@ bool Directory::SafeToPurgeFromMemory(WriteTransaction* trans,
   return safe;
 }
 
+// static
+const size_t Directory::kSnapshotChunkSize = 1000;
+
+// static
+const int Directory::kMaxSnapshotChunks = 100;
+
+bool Directory::CopyDirtyEntriesToSnapshot(ScopedKernelLock* lock,
+                                           size_t max_entries,
+                                           SaveChangesSnapshot* snapshot) {
+  size_t copied = 0;
+  MetahandleSet::iterator i = kernel_->dirty_metahandles->begin();
+  while (i != kernel_->dirty_metahandles->end() && copied < max_entries) {
+    EntryKernel* entry = GetEntryByHandle(*i, lock);
+    // Skip over false positives; it happens relatively infrequently.
+    if (entry && entry->is_dirty()) {
+      // Replace the copy taken by an earlier chunk if the entry has been
+      // modified since.
+      snapshot->dirty_metas.erase(*entry);
+      snapshot->dirty_metas.insert(*entry);
+      entry->clear_dirty(NULL);
+      ++copied;
+    }
+    kernel_->dirty_metahandles->erase(i++);
+  }
+  return kernel_->dirty_metahandles->empty();
+}
+
 void Directory::TakeSnapshotForSaveChanges(SaveChangesSnapshot* snapshot) {
-  ReadTransaction trans(FROM_HERE, this);
-  ScopedKernelLock lock(this);
+  base::TimeTicks start_time = base::TimeTicks::Now();
+  base::TimeDelta longest_hold;
+
+  // Copy the bulk of the dirty entries in chunks, releasing the transaction
+  // between them so that the syncer and the model associators are not
+  // blocked behind the whole copy.  The number of chunks is bounded in case
+  // entries are dirtied faster than they are copied.
+  for (int chunk = 0; chunk < kMaxSnapshotChunks; ++chunk) {
+    ReadTransaction trans(FROM_HERE, this);
+    ScopedKernelLock lock(this);
+    base::TimeTicks chunk_start_time = base::TimeTicks::Now();
+
+    // If there is an unrecoverable error then just bail out, leaving the
+    // entries copied so far dirty.
+    if (unrecoverable_error_set(&trans)) {
+      MarkEntriesDirty(lock, snapshot->dirty_metas);
+      snapshot->dirty_metas.clear();
+      return;
+    }
 
-  // If there is an unrecoverable error then just bail out.
-  if (unrecoverable_error_set(&trans))
-    return;
+    // Leave the last chunk, if it is small, to be copied together with the
+    // rest of the state below.
+    if (kernel_->dirty_metahandles->size() <= kSnapshotChunkSize)
+      break;
+    CopyDirtyEntriesToSnapshot(&lock, kSnapshotChunkSize, snapshot);
+    longest_hold = std::max(longest_hold,
+                            base::TimeTicks::Now() - chunk_start_time);
+  }
 
-  // Deep copy dirty entries from kernel_->metahandles_index into snapshot and
-  // clear dirty flags.
-  for (MetahandleSet::const_iterator i = kernel_->dirty_metahandles->begin();
-       i != kernel_->dirty_metahandles->end(); ++i) {
-    EntryKernel* entry = GetEntryByHandle(*i, &lock);
-    if (!entry)
-      continue;
-    // Skip over false positives; it happens relatively infrequently.
-    if (!entry->is_dirty())
-      continue;
-    snapshot->dirty_metas.insert(snapshot->dirty_metas.end(), *entry);
-    DCHECK_EQ(1U, kernel_->dirty_metahandles->count(*i));
-    // We don't bother removing from the index here as we blow the entire thing
-    // in a moment, and it unnecessarily complicates iteration.
-    entry->clear_dirty(NULL);
-  }
-  ClearDirtyMetahandles();
-
-  // Set purged handles.
-  DCHECK(snapshot->metahandles_to_purge.empty());
-  snapshot->metahandles_to_purge.swap(*(kernel_->metahandles_to_purge));
-
-  // Fill kernel_info_status and kernel_info.
-  snapshot->kernel_info = kernel_->persisted_info;
-  // To avoid duplicates when the process crashes, we record the next_id to be
-  // greater magnitude than could possibly be reached before the next save
-  // changes.  In other words, it's effectively impossible for the user to
-  // generate 65536 new bookmarks in 3 seconds.
-  snapshot->kernel_info.next_id -= 65536;
-  snapshot->kernel_info_status = kernel_->info_status;
-  // This one we reset on failure.
-  kernel_->info_status = KERNEL_SHARE_INFO_VALID;
+  {
+    ReadTransaction trans(FROM_HERE, this);
+    ScopedKernelLock lock(this);
+    base::TimeTicks last_chunk_start_time = base::TimeTicks::Now();
+
+    // If there is an unrecoverable error then just bail out.
+    if (unrecoverable_error_set(&trans)) {
+      MarkEntriesDirty(lock, snapshot->dirty_metas);
+      snapshot->dirty_metas.clear();
+      return;
+    }
+
+    // Deep copy the remaining dirty entries from kernel_->metahandles_index
+    // into snapshot and clear dirty flags.
+    CopyDirtyEntriesToSnapshot(&lock, std::numeric_limits<size_t>::max(),
+                               snapshot);
+    ClearDirtyMetahandles();
+
+    // Set purged handles.
+    DCHECK(snapshot->metahandles_to_purge.empty());
+    snapshot->metahandles_to_purge.swap(*(kernel_->metahandles_to_purge));
+
+    // Fill kernel_info_status and kernel_info.
+    snapshot->kernel_info = kernel_->persisted_info;
+    // To avoid duplicates when the process crashes, we record the next_id to
+    // be greater magnitude than could possibly be reached before the next save
+    // changes.  In other words, it's effectively impossible for the user to
+    // generate 65536 new bookmarks in 3 seconds.
+    snapshot->kernel_info.next_id -= 65536;
+    snapshot->kernel_info_status = kernel_->info_status;
+    // This one we reset on failure.
+    kernel_->info_status = KERNEL_SHARE_INFO_VALID;
+
+    longest_hold = std::max(longest_hold,
+                            base::TimeTicks::Now() - last_chunk_start_time);
+  }
+
+  UMA_HISTOGRAM_TIMES("Sync.DirectorySnapshotTime",
+                      base::TimeTicks::Now() - start_time);
+  UMA_HISTOGRAM_TIMES("Sync.DirectorySnapshotLockTime", longest_hold);
 }
 
 bool Directory::SaveChanges() {
@@ -862,6 +965,7 @@ bool Directory::SaveChanges() {
   base::AutoLock scoped_lock(kernel_->save_changes_mutex);
 
   // Snapshot and save.
+  base::TimeTicks start_time = base::TimeTicks::Now();
   SaveChangesSnapshot snapshot;
   TakeSnapshotForSaveChanges(&snapshot);
   success = store_->SaveChanges(snapshot);
@@ -871,6 +975,13 @@ bool Directory::SaveChanges() {
     success = VacuumAfterSaveChanges(snapshot);
   else
     HandleSaveChangesFailure(snapshot);
+
+  if (!snapshot.dirty_metas.empty()) {
+    UMA_HISTOGRAM_TIMES("Sync.DirectorySaveChangesTime",
+                        base::TimeTicks::Now() - start_time);
+    UMA_HISTOGRAM_COUNTS("Sync.DirectorySaveChangesEntries",
+                         snapshot.dirty_metas.size());
+  }
   return success;
 }
 
@@ -978,8 +1089,16 @@ void Directory::HandleSaveChangesFailure(const SaveChangesSnapshot& snapshot) {
   // cause lost data, if no other changes are made to the in-memory entries
   // that would cause the dirty bit to get set again. Setting the bit ensures
   // that SaveChanges will at least try again later.
-  for (EntryKernelSet::const_iterator i = snapshot.dirty_metas.begin();
-       i != snapshot.dirty_metas.end(); ++i) {
+  MarkEntriesDirty(lock, snapshot.dirty_metas);
+
+  kernel_->metahandles_to_purge->insert(snapshot.metahandles_to_purge.begin(),
+                                        snapshot.metahandles_to_purge.end());
+}
+
+void Directory::MarkEntriesDirty(const ScopedKernelLock& lock,
+                                 const EntryKernelSet& entries) {
+  for (EntryKernelSet::const_iterator i = entries.begin();
+       i != entries.end(); ++i) {
     kernel_->needle.put(META_HANDLE, i->ref(META_HANDLE));
     MetahandlesIndex::iterator found =
         kernel_->metahandles_index->find(&kernel_->needle);
@@ -987,9 +1106,6 @@ void Directory::HandleSaveChangesFailure(const SaveChangesSnapshot& snapshot) {
       (*found)->mark_dirty(kernel_->dirty_metahandles);
     }
   }
-
-  kernel_->metahandles_to_purge->insert(snapshot.metahandles_to_purge.begin(),
-                                        snapshot.metahandles_to_purge.end());
 }
 
 void Directory::GetDownloadProgress(
@@ -1113,6 +1229,9 @@ void Directory::GetAllEntryKernels(BaseTransaction* trans,
   result->insert(result->end(),
                  kernel_->metahandles_index->begin(),
                  kernel_->metahandles_index->end());
+  // The index is hashed; return the entries in metahandle order.
+  std::sort(result->begin(), result->end(),
+            LessField<MetahandleField, META_HANDLE>());
 }
 
 void Directory::GetUnsyncedMetaHandles(BaseTransaction* trans,
@@ -1460,6 +1579,8 @@ void WriteTransaction::SaveOriginal(const EntryKernel* entry) {
   if (it == mutations_.end() || it->first != handle) {
     EntryKernelMutation mutation;
     mutation.original = *entry;
+    // The mutations are handed to observers outside of the transaction.
+    mutation.original.DecodeAllSpecifics();
     ignore_result(mutations_.insert(it, std::make_pair(handle, mutation)));
   }
 }
@@ -1475,6 +1596,7 @@ ImmutableEntryKernelMutationMap WriteTransaction::RecordMutations() {
     }
     if (kernel->is_dirty()) {
       it->second.mutated = *kernel;
+      it->second.mutated.DecodeAllSpecifics();
       ++it;
     } else {
       DCHECK(!it->second.original.is_dirty());
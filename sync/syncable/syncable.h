@@ -21,6 +21,7 @@
 #include "base/compiler_specific.h"
 #include "base/file_path.h"
 #include "base/gtest_prod_util.h"
+#include "base/hash_tables.h"
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
@@ -262,7 +263,14 @@ enum UnlinkReason {
 struct EntryKernel {
  private:
   std::string string_fields[STRING_FIELDS_COUNT];
-  sync_pb::EntitySpecifics specifics_fields[PROTO_FIELDS_COUNT];
+  // Specifics loaded from the database are kept serialized in
+  // |serialized_specifics_fields| until they are first accessed, since most
+  // of them, and SERVER_SPECIFICS in particular, are never read again.  At
+  // most one of the two representations of a field is non-empty.  Decoding
+  // happens in const getters, which is safe because kernels are only
+  // accessed under the transaction lock.
+  mutable sync_pb::EntitySpecifics specifics_fields[PROTO_FIELDS_COUNT];
+  mutable std::string serialized_specifics_fields[PROTO_FIELDS_COUNT];
   int64 int64_fields[INT64_FIELDS_COUNT];
   base::Time time_fields[TIME_FIELDS_COUNT];
   Id id_fields[ID_FIELDS_COUNT];
@@ -332,8 +340,15 @@ struct EntryKernel {
     string_fields[field - STRING_FIELDS_BEGIN] = value;
   }
   inline void put(ProtoField field, const sync_pb::EntitySpecifics& value) {
+    serialized_specifics_fields[field - PROTO_FIELDS_BEGIN].clear();
     specifics_fields[field - PROTO_FIELDS_BEGIN].CopyFrom(value);
   }
+  // Sets |field| to the specifics serialized in |value|, which are decoded
+  // on first access.
+  inline void put_serialized(ProtoField field, const std::string& value) {
+    specifics_fields[field - PROTO_FIELDS_BEGIN].Clear();
+    serialized_specifics_fields[field - PROTO_FIELDS_BEGIN] = value;
+  }
   inline void put(BitTemp field, bool value) {
     bit_temps[field - BIT_TEMPS_BEGIN] = value;
   }
@@ -367,6 +382,7 @@ struct EntryKernel {
     return string_fields[field - STRING_FIELDS_BEGIN];
   }
   inline const sync_pb::EntitySpecifics& ref(ProtoField field) const {
+    DecodeSpecifics(field);
     return specifics_fields[field - PROTO_FIELDS_BEGIN];
   }
   inline bool ref(BitTemp field) const {
@@ -378,12 +394,26 @@ struct EntryKernel {
     return string_fields[field - STRING_FIELDS_BEGIN];
   }
   inline sync_pb::EntitySpecifics& mutable_ref(ProtoField field) {
+    DecodeSpecifics(field);
     return specifics_fields[field - PROTO_FIELDS_BEGIN];
   }
   inline Id& mutable_ref(IdField field) {
     return id_fields[field - ID_FIELDS_BEGIN];
   }
 
+  // Serializes |field| into |result|, without decoding it if it hasn't been
+  // accessed since it was loaded.
+  void SerializeSpecifics(ProtoField field, std::string* result) const;
+
+  // Decodes all the specifics fields, for copies that are handed to other
+  // threads.
+  void DecodeAllSpecifics() const;
+
+  // Makes equal string and specifics fields share their storage, where the
+  // string implementation allows it.  Used after loading from the database,
+  // where the local and server values of most entries are the same.
+  void ShareEqualFields();
+
   syncable::ModelType GetServerModelType() const;
 
   // Dumps all kernel info into a DictionaryValue and returns it.
@@ -391,6 +421,14 @@ struct EntryKernel {
   base::DictionaryValue* ToValue() const;
 
  private:
+  inline void DecodeSpecifics(ProtoField field) const {
+    std::string& serialized =
+        serialized_specifics_fields[field - PROTO_FIELDS_BEGIN];
+    if (!serialized.empty())
+      DecodeSerializedSpecifics(field);
+  }
+  void DecodeSerializedSpecifics(ProtoField field) const;
+
   // Tracks whether this entry needs to be saved to the database.
   bool dirty_;
 };
@@ -587,6 +625,8 @@ class MutableEntry : public Entry {
 };
 
 template <typename FieldType, FieldType field_index> class LessField;
+template <typename FieldType, FieldType field_index> class HashField;
+template <typename FieldType, FieldType field_index> class EqualField;
 
 class EntryKernelLessByMetaHandle {
  public:
@@ -657,22 +697,25 @@ base::ListValue* EntryKernelMutationMapToValue(
 // The syncable Directory maintains several indices on the Entries it tracks.
 // The indices follow a common pattern:
 //   (a) The index allows efficient lookup of an Entry* with particular
-//       field values.  This is done by use of a std::set<> and a custom
-//       comparator.
+//       field values.  Indices that are only used for exact lookups are
+//       base::hash_set<>s with a custom hasher; indices that are also
+//       iterated in order are std::set<>s with a custom comparator.
 //   (b) There may be conditions for inclusion in the index -- for example,
 //       deleted items might not be indexed.
 //   (c) Because the index set contains only Entry*, one must be careful
 //       to remove Entries from the set before updating the value of
 //       an indexed field.
-// The traits of an index are a Comparator (to define the set ordering) and a
-// ShouldInclude function (to define the conditions for inclusion).  For each
-// index, the traits are grouped into a class called an Indexer which
-// can be used as a template type parameter.
+// The traits of an index are either a Hasher and an Equal (to define a hashed
+// set) or a Comparator (to define the set ordering), and a ShouldInclude
+// function (to define the conditions for inclusion).  For each index, the
+// traits are grouped into a class called an Indexer which can be used as a
+// template type parameter.
 
 // Traits type for metahandle index.
 struct MetahandleIndexer {
   // This index is of the metahandle field values.
-  typedef LessField<MetahandleField, META_HANDLE> Comparator;
+  typedef HashField<MetahandleField, META_HANDLE> Hasher;
+  typedef EqualField<MetahandleField, META_HANDLE> Equal;
 
   // This index includes all entries.
   inline static bool ShouldInclude(const EntryKernel* a) {
@@ -683,7 +726,8 @@ struct MetahandleIndexer {
 // Traits type for ID field index.
 struct IdIndexer {
   // This index is of the ID field values.
-  typedef LessField<IdField, ID> Comparator;
+  typedef HashField<IdField, ID> Hasher;
+  typedef EqualField<IdField, ID> Equal;
 
   // This index includes all entries.
   inline static bool ShouldInclude(const EntryKernel* a) {
@@ -694,7 +738,8 @@ struct IdIndexer {
 // Traits type for unique client tag index.
 struct ClientTagIndexer {
   // This index is of the client-tag values.
-  typedef LessField<StringField, UNIQUE_CLIENT_TAG> Comparator;
+  typedef HashField<StringField, UNIQUE_CLIENT_TAG> Hasher;
+  typedef EqualField<StringField, UNIQUE_CLIENT_TAG> Equal;
 
   // Items are only in this index if they have a non-empty client tag value.
   static bool ShouldInclude(const EntryKernel* a);
@@ -722,6 +767,28 @@ struct Index {
   typedef std::set<EntryKernel*, typename Indexer::Comparator> Set;
 };
 
+// The hashed set type for Indexers that define a Hasher and an Equal.
+template <typename Indexer>
+struct HashIndex {
+#if defined(COMPILER_MSVC)
+  // MSVC's hash_set takes a single traits class, which the Hasher is.
+  typedef base::hash_set<EntryKernel*, typename Indexer::Hasher> Set;
+#else
+  typedef base::hash_set<EntryKernel*,
+                         typename Indexer::Hasher,
+                         typename Indexer::Equal> Set;
+#endif
+};
+
+template <>
+struct Index<MetahandleIndexer> : public HashIndex<MetahandleIndexer> {};
+
+template <>
+struct Index<IdIndexer> : public HashIndex<IdIndexer> {};
+
+template <>
+struct Index<ClientTagIndexer> : public HashIndex<ClientTagIndexer> {};
+
 // The name Directory in this case means the entire directory
 // structure within a single user account.
 //
@@ -989,6 +1056,8 @@ class Directory {
   // up by either purging entries no longer needed (this part done under a
   // WriteTransaction) or rolling back the dirty bits.  It also uses
   // internal locking to enforce SaveChanges operations are mutually exclusive.
+  // Large snapshots are copied in chunks so that other transactions are not
+  // blocked for the whole copy; see TakeSnapshotForSaveChanges().
   //
   // WARNING: THIS METHOD PERFORMS SYNCHRONOUS I/O VIA SQLITE.
   bool SaveChanges();
@@ -1045,15 +1114,32 @@ class Directory {
   virtual void PurgeEntriesWithTypeIn(ModelTypeSet types);
 
  private:
+  // The number of dirty entries copied per chunk by
+  // TakeSnapshotForSaveChanges(), and the number of chunks after which it
+  // copies all the remaining ones at once.
+  static const size_t kSnapshotChunkSize;
+  static const int kMaxSnapshotChunks;
+
   // Helper to prime ids_index, parent_id_and_names_index, unsynced_metahandles
   // and unapplied_metahandles from metahandles_index.
   void InitializeIndices();
 
   // Constructs a consistent snapshot of the current Directory state and
   // indices (by deep copy) under a ReadTransaction for use in |snapshot|.
-  // See SaveChanges() for more information.
+  // Dirty entries are copied in chunks of at most kSnapshotChunkSize, with
+  // the transaction released in between.  Entries modified after they were
+  // copied become dirty again and are copied again, and the last chunk copies
+  // every remaining dirty entry, so the snapshot is consistent as of the last
+  // chunk.  See SaveChanges() for more information.
   void TakeSnapshotForSaveChanges(SaveChangesSnapshot* snapshot);
 
+  // Moves at most |max_entries| dirty entries to |snapshot|, replacing older
+  // copies, and clears their dirty bits.  Returns true if no dirty entries
+  // are left.
+  bool CopyDirtyEntriesToSnapshot(ScopedKernelLock* lock,
+                                  size_t max_entries,
+                                  SaveChangesSnapshot* snapshot);
+
   // Purges from memory any unused, safe to remove entries that were
   // successfully deleted on disk as a result of the SaveChanges that processed
   // |snapshot|.  See SaveChanges() for more information.
@@ -1063,6 +1149,11 @@ class Directory {
   // processed |snapshot| failed, for example, due to no disk space.
   void HandleSaveChangesFailure(const SaveChangesSnapshot& snapshot);
 
+  // Sets the dirty bits of the in-memory entries that |entries| are copies
+  // of.
+  void MarkEntriesDirty(const ScopedKernelLock& lock,
+                        const EntryKernelSet& entries);
+
   // For new entry creation only
   bool InsertEntry(WriteTransaction* trans,
                    EntryKernel* entry, ScopedKernelLock* lock);
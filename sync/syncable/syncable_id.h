@@ -116,6 +116,7 @@ class Id {
  private:
   friend EntryKernel* UnpackEntry(sql::Statement* statement);
   friend void BindFields(const EntryKernel& entry,
+                         int index,
                          sql::Statement* statement);
   friend std::ostream& operator<<(std::ostream& out, const Id& id);
   friend class MockConnectionManager;
@@ -0,0 +1,184 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "sync/syncable/syncable.h"
+
+#include <string>
+#include <vector>
+
+#include "base/file_path.h"
+#include "base/location.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/perftimer.h"
+#include "base/process_util.h"
+#include "base/scoped_temp_dir.h"
+#include "base/stringprintf.h"
+#include "sync/protocol/bookmark_specifics.pb.h"
+#include "sync/test/engine/test_id_factory.h"
+#include "sync/test/fake_encryptor.h"
+#include "sync/test/null_directory_change_delegate.h"
+#include "sync/test/null_transaction_observer.h"
+#include "sync/util/test_unrecoverable_error_handler.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using browser_sync::FakeEncryptor;
+using browser_sync::TestIdFactory;
+using browser_sync::TestUnrecoverableErrorHandler;
+
+namespace syncable {
+
+namespace {
+
+// Roughly the size of the largest accounts.
+const int kNumEntries = 200000;
+
+class SyncableDirectoryPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    dir_.reset(new Directory(&encryptor_, &handler_, NULL));
+    ASSERT_EQ(OPENED, dir_->OpenInMemoryForTest("PerfTest", &delegate_,
+                                                NullTransactionObserver()));
+    for (int i = 0; i < kNumEntries; ++i)
+      ids_.push_back(TestIdFactory::FromNumber(i + 1));
+  }
+
+  virtual void TearDown() {
+    dir_.reset();
+  }
+
+  // Creates an unapplied update for each of |ids_|, the way
+  // ProcessUpdatesCommand does for a first sync.
+  void CreateUpdates() {
+    WriteTransaction trans(FROM_HERE, UNITTEST, dir_.get());
+    for (int i = 0; i < kNumEntries; ++i) {
+      MutableEntry entry(&trans, CREATE_NEW_UPDATE_ITEM, ids_[i]);
+      ASSERT_TRUE(entry.good());
+      entry.Put(SERVER_VERSION, 1);
+      entry.Put(IS_UNAPPLIED_UPDATE, true);
+    }
+  }
+
+  MessageLoop message_loop_;
+  FakeEncryptor encryptor_;
+  TestUnrecoverableErrorHandler handler_;
+  NullDirectoryChangeDelegate delegate_;
+  scoped_ptr<Directory> dir_;
+  std::vector<Id> ids_;
+};
+
+TEST_F(SyncableDirectoryPerfTest, CreateEntries) {
+  PerfTimeLogger timer("Syncable_create_200k_entries");
+  CreateUpdates();
+  timer.Done();
+}
+
+TEST_F(SyncableDirectoryPerfTest, LookUpEntries) {
+  CreateUpdates();
+  std::vector<int64> metahandles;
+  {
+    PerfTimeLogger timer("Syncable_get_200k_entries_by_id");
+    ReadTransaction trans(FROM_HERE, dir_.get());
+    for (int i = 0; i < kNumEntries; ++i) {
+      Entry entry(&trans, GET_BY_ID, ids_[i]);
+      ASSERT_TRUE(entry.good());
+      metahandles.push_back(entry.Get(META_HANDLE));
+    }
+  }
+  {
+    PerfTimeLogger timer("Syncable_get_200k_entries_by_handle");
+    ReadTransaction trans(FROM_HERE, dir_.get());
+    for (int i = 0; i < kNumEntries; ++i) {
+      Entry entry(&trans, GET_BY_HANDLE, metahandles[i]);
+      ASSERT_TRUE(entry.good());
+    }
+  }
+}
+
+TEST_F(SyncableDirectoryPerfTest, ApplyUpdates) {
+  CreateUpdates();
+  // Applying an update looks the entry up and moves it between indices.
+  PerfTimeLogger timer("Syncable_apply_200k_updates");
+  WriteTransaction trans(FROM_HERE, UNITTEST, dir_.get());
+  for (int i = 0; i < kNumEntries; ++i) {
+    MutableEntry entry(&trans, GET_BY_ID, ids_[i]);
+    ASSERT_TRUE(entry.good());
+    entry.Put(UNIQUE_CLIENT_TAG, base::StringPrintf("tag%d", i));
+    entry.Put(BASE_VERSION, 1);
+    entry.Put(IS_UNAPPLIED_UPDATE, false);
+  }
+  timer.Done();
+}
+
+// Returns the working set of this process, in bytes.
+size_t GetWorkingSetSize() {
+#if defined(OS_MACOSX)
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle(), NULL));
+#else
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle()));
+#endif
+  return metrics->GetWorkingSetSize();
+}
+
+// Measures the memory used by a directory of 100k bookmarks once it has been
+// loaded from disk.
+TEST_F(SyncableDirectoryPerfTest, LoadedMemoryUsage) {
+  const int kNumBookmarks = 100000;
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath file_path = temp_dir.path().AppendASCII("PerfTest.sqlite3");
+
+  dir_.reset(new Directory(&encryptor_, &handler_, NULL));
+  ASSERT_EQ(OPENED, dir_->Open(file_path, "PerfTest", &delegate_,
+                               NullTransactionObserver()));
+  {
+    WriteTransaction trans(FROM_HERE, UNITTEST, dir_.get());
+    for (int i = 0; i < kNumBookmarks; ++i) {
+      sync_pb::EntitySpecifics specifics;
+      specifics.mutable_bookmark()->set_url(
+          base::StringPrintf("http://www.example.com/%d", i));
+      specifics.mutable_bookmark()->set_title(
+          base::StringPrintf("Bookmark %d", i));
+      MutableEntry entry(&trans, CREATE_NEW_UPDATE_ITEM, ids_[i]);
+      ASSERT_TRUE(entry.good());
+      entry.Put(NON_UNIQUE_NAME, entry.Get(ID).value());
+      entry.Put(SERVER_NON_UNIQUE_NAME, entry.Get(ID).value());
+      entry.Put(SPECIFICS, specifics);
+      entry.Put(SERVER_SPECIFICS, specifics);
+      entry.Put(BASE_VERSION, 1);
+      entry.Put(SERVER_VERSION, 1);
+    }
+  }
+  ASSERT_TRUE(dir_->SaveChanges());
+  dir_.reset();
+
+  size_t before = GetWorkingSetSize();
+  dir_.reset(new Directory(&encryptor_, &handler_, NULL));
+  ASSERT_EQ(OPENED, dir_->Open(file_path, "PerfTest", &delegate_,
+                               NullTransactionObserver()));
+  size_t after = GetWorkingSetSize();
+  LogPerfResult("Syncable_load_100k_bookmarks_working_set",
+                (static_cast<double>(after) - before) / 1024, "kb");
+
+  // Reading the local specifics decodes them.
+  {
+    ReadTransaction trans(FROM_HERE, dir_.get());
+    for (int i = 0; i < kNumBookmarks; ++i) {
+      Entry entry(&trans, GET_BY_ID, ids_[i]);
+      ASSERT_TRUE(entry.good());
+      EXPECT_TRUE(entry.Get(SPECIFICS).has_bookmark());
+    }
+  }
+  size_t decoded = GetWorkingSetSize();
+  LogPerfResult("Syncable_decode_100k_bookmarks_working_set",
+                (static_cast<double>(decoded) - after) / 1024, "kb");
+}
+
+}  // namespace
+
+}  // namespace syncable
@@ -612,6 +612,46 @@ TEST_F(SyncableDirectoryTest, TakeSnapshotGetsAllDirtyHandlesTest) {
   }
 }
 
+TEST_F(SyncableDirectoryTest, TakeSnapshotInChunksGetsAllDirtyHandlesTest) {
+  // More entries than fit in one snapshot chunk, and not a multiple of it.
+  const int metahandles_to_create = 2500;
+  std::vector<int64> expected_dirty_metahandles;
+  {
+    WriteTransaction trans(FROM_HERE, UNITTEST, dir_.get());
+    for (int i = 0; i < metahandles_to_create; i++) {
+      MutableEntry e(&trans, CREATE, trans.root_id(), "foo");
+      expected_dirty_metahandles.push_back(e.Get(META_HANDLE));
+      e.Put(IS_UNSYNCED, true);
+    }
+  }
+  {
+    Directory::SaveChangesSnapshot snapshot;
+    base::AutoLock scoped_lock(dir_->kernel_->save_changes_mutex);
+    dir_->TakeSnapshotForSaveChanges(&snapshot);
+    ASSERT_EQ(expected_dirty_metahandles.size(), snapshot.dirty_metas.size());
+    for (std::vector<int64>::const_iterator i =
+        expected_dirty_metahandles.begin();
+        i != expected_dirty_metahandles.end(); ++i) {
+      EntryKernel query;
+      query.put(META_HANDLE, *i);
+      EntryKernelSet::const_iterator found = snapshot.dirty_metas.find(query);
+      ASSERT_TRUE(found != snapshot.dirty_metas.end());
+      EXPECT_TRUE(found->is_dirty());
+    }
+    {
+      ReadTransaction trans(FROM_HERE, dir_.get());
+      for (std::vector<int64>::const_iterator i =
+          expected_dirty_metahandles.begin();
+          i != expected_dirty_metahandles.end(); ++i) {
+        Entry e(&trans, GET_BY_HANDLE, *i);
+        ASSERT_TRUE(e.good());
+        EXPECT_FALSE(e.GetKernelCopy().is_dirty());
+      }
+    }
+    dir_->VacuumAfterSaveChanges(snapshot);
+  }
+}
+
 TEST_F(SyncableDirectoryTest, TakeSnapshotGetsOnlyDirtyHandlesTest) {
   const int metahandles_to_create = 100;
 
@@ -1279,6 +1319,76 @@ TEST_F(OnDiskSyncableDirectoryTest, TestPurgeEntriesWithTypeIn) {
   CheckPurgeEntriesWithTypeInSucceeded(types_to_purge, false);
 }
 
+TEST_F(OnDiskSyncableDirectoryTest, TestSaveManyEntries) {
+  // Enough entries for several snapshot chunks and several batched writes,
+  // plus a remainder that is written one row at a time.
+  const int entries_to_create = 2503;
+  std::vector<int64> metahandles;
+  {
+    WriteTransaction trans(FROM_HERE, UNITTEST, dir_.get());
+    for (int i = 0; i < entries_to_create; i++) {
+      MutableEntry e(&trans, CREATE, trans.root_id(),
+                     base::StringPrintf("item%d", i));
+      ASSERT_TRUE(e.good());
+      e.Put(IS_UNSYNCED, true);
+      e.Put(BASE_VERSION, i);
+      metahandles.push_back(e.Get(META_HANDLE));
+    }
+  }
+
+  SaveAndReloadDir();
+
+  {
+    ReadTransaction trans(FROM_HERE, dir_.get());
+    for (int i = 0; i < entries_to_create; i++) {
+      Entry e(&trans, GET_BY_HANDLE, metahandles[i]);
+      ASSERT_TRUE(e.good());
+      EXPECT_EQ(base::StringPrintf("item%d", i), e.Get(NON_UNIQUE_NAME));
+      EXPECT_EQ(i, e.Get(BASE_VERSION));
+      EXPECT_TRUE(e.Get(IS_UNSYNCED));
+    }
+  }
+}
+
+// Specifics are kept serialized after loading until they are accessed, and
+// equal local and server values share their storage.  Changing one of them
+// must leave the other alone.
+TEST_F(OnDiskSyncableDirectoryTest, TestSpecificsSurviveLazyDecoding) {
+  Id id = TestIdFactory::FromNumber(1);
+  sync_pb::EntitySpecifics specifics;
+  specifics.mutable_bookmark()->set_url("http://server/");
+  {
+    WriteTransaction trans(FROM_HERE, UNITTEST, dir_.get());
+    MutableEntry e(&trans, CREATE_NEW_UPDATE_ITEM, id);
+    ASSERT_TRUE(e.good());
+    e.Put(SPECIFICS, specifics);
+    e.Put(SERVER_SPECIFICS, specifics);
+  }
+
+  // Save without accessing the specifics in between.
+  SaveAndReloadDir();
+  SaveAndReloadDir();
+
+  {
+    WriteTransaction trans(FROM_HERE, UNITTEST, dir_.get());
+    MutableEntry e(&trans, GET_BY_ID, id);
+    ASSERT_TRUE(e.good());
+    sync_pb::EntitySpecifics local;
+    local.mutable_bookmark()->set_url("http://local/");
+    e.Put(SPECIFICS, local);
+  }
+
+  SaveAndReloadDir();
+
+  {
+    ReadTransaction trans(FROM_HERE, dir_.get());
+    Entry e(&trans, GET_BY_ID, id);
+    ASSERT_TRUE(e.good());
+    EXPECT_EQ("http://local/", e.Get(SPECIFICS).bookmark().url());
+    EXPECT_EQ("http://server/", e.Get(SERVER_SPECIFICS).bookmark().url());
+  }
+}
+
 TEST_F(OnDiskSyncableDirectoryTest, TestShareInfo) {
   dir_->set_initial_sync_ended_for_type(AUTOFILL, true);
   dir_->set_store_birthday("Jan 31st");
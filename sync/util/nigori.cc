@@ -99,7 +99,8 @@ bool Nigori::InitByDerivation(const std::string& hostname,
       kDerivedKeySizeInBits));
   DCHECK(mac_key_.get());
 
-  return user_key_.get() && encryption_key_.get() && mac_key_.get();
+  return user_key_.get() && encryption_key_.get() && mac_key_.get() &&
+      InitMac();
 }
 
 bool Nigori::InitByImport(const std::string& user_key,
@@ -115,7 +116,21 @@ bool Nigori::InitByImport(const std::string& user_key,
   mac_key_.reset(SymmetricKey::Import(SymmetricKey::HMAC_SHA1, mac_key));
   DCHECK(mac_key_.get());
 
-  return user_key_.get() && encryption_key_.get() && mac_key_.get();
+  return user_key_.get() && encryption_key_.get() && mac_key_.get() &&
+      InitMac();
+}
+
+bool Nigori::InitMac() {
+  std::string raw_mac_key;
+  if (!mac_key_->GetRawKey(&raw_mac_key))
+    return false;
+
+  mac_.reset(new HMAC(HMAC::SHA256));
+  if (!mac_->Init(raw_mac_key)) {
+    mac_.reset();
+    return false;
+  }
+  return true;
 }
 
 // Permute[Kenc,Kmac](type || name)
@@ -135,16 +150,8 @@ bool Nigori::Permute(Type type, const std::string& name,
   if (!encryptor.Encrypt(plaintext.str(), &ciphertext))
     return false;
 
-  std::string raw_mac_key;
-  if (!mac_key_->GetRawKey(&raw_mac_key))
-    return false;
-
-  HMAC hmac(HMAC::SHA256);
-  if (!hmac.Init(raw_mac_key))
-    return false;
-
   std::vector<unsigned char> hash(kHashSize);
-  if (!hmac.Sign(ciphertext, &hash[0], hash.size()))
+  if (!mac_->Sign(ciphertext, &hash[0], hash.size()))
     return false;
 
   std::string output;
@@ -177,16 +184,8 @@ bool Nigori::Encrypt(const std::string& value, std::string* encrypted) const {
   if (!encryptor.Encrypt(value, &ciphertext))
     return false;
 
-  std::string raw_mac_key;
-  if (!mac_key_->GetRawKey(&raw_mac_key))
-    return false;
-
-  HMAC hmac(HMAC::SHA256);
-  if (!hmac.Init(raw_mac_key))
-    return false;
-
   std::vector<unsigned char> hash(kHashSize);
-  if (!hmac.Sign(ciphertext, &hash[0], hash.size()))
+  if (!mac_->Sign(ciphertext, &hash[0], hash.size()))
     return false;
 
   std::string output;
@@ -214,21 +213,7 @@ bool Nigori::Decrypt(const std::string& encrypted, std::string* value) const {
                                       input.size() - (kIvSize + kHashSize)));
   std::string hash(input.substr(input.size() - kHashSize, kHashSize));
 
-  std::string raw_mac_key;
-  if (!mac_key_->GetRawKey(&raw_mac_key))
-    return false;
-
-  HMAC hmac(HMAC::SHA256);
-  if (!hmac.Init(raw_mac_key))
-    return false;
-
-  std::vector<unsigned char> expected(kHashSize);
-  if (!hmac.Sign(ciphertext, &expected[0], expected.size()))
-    return false;
-
-  if (hash.compare(0, hash.size(),
-                   reinterpret_cast<char *>(&expected[0]),
-                   expected.size()))
+  if (!mac_->Verify(ciphertext, hash))
     return false;
 
   Encryptor encryptor;
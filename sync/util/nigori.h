@@ -11,6 +11,7 @@
 #include "base/memory/scoped_ptr.h"
 
 namespace crypto {
+class HMAC;
 class SymmetricKey;
 }  // namespace crypto
 
@@ -76,9 +77,15 @@ class Nigori {
   static const size_t kSigningIterations = 1004;
 
  private:
+  // Sets up |mac_| from |mac_key_|.
+  bool InitMac();
+
   scoped_ptr<crypto::SymmetricKey> user_key_;
   scoped_ptr<crypto::SymmetricKey> encryption_key_;
   scoped_ptr<crypto::SymmetricKey> mac_key_;
+  // Keyed once with |mac_key_| and reused by every Permute, Encrypt and
+  // Decrypt.
+  scoped_ptr<crypto::HMAC> mac_;
 };
 
 }  // namespace browser_sync
@@ -2002,6 +2002,26 @@ typedef void (GL_APIENTRYP PFNGLCONSUMETEXTURECHROMIUM) (GLenum target, const  G
 #endif
 #endif
 
+/* GL_CHROMIUM_async_texture_upload */
+/* Uploads texture data on a separate thread. The texture contents are
+ * undefined until a GL_ASYNC_TEXTURE_UPLOADS_COMPLETED_CHROMIUM query ended
+ * after the upload reports a result.
+ */
+#ifndef GL_CHROMIUM_async_texture_upload
+#define GL_CHROMIUM_async_texture_upload 1
+#ifndef GL_ASYNC_TEXTURE_UPLOADS_COMPLETED_CHROMIUM
+#define GL_ASYNC_TEXTURE_UPLOADS_COMPLETED_CHROMIUM 0x6005
+#endif
+#ifdef GL_GLEXT_PROTOTYPES
+#define glAsyncTexImage2DCHROMIUM GLES2_GET_FUN(AsyncTexImage2DCHROMIUM)
+#if !defined(GLES2_USE_CPP_BINDINGS)
+GL_APICALL void GL_APIENTRY glAsyncTexImage2DCHROMIUM (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels);
+#endif
+#else
+typedef void (GL_APIENTRYP PFNGLASYNCTEXIMAGE2DCHROMIUM) (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels);
+#endif
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,20 +5,29 @@
 #include <deque>
 #include <errno.h>
 #include <stdio.h>
+#include <algorithm>
 #include "base/at_exit.h"
+#include "base/debug/trace_event.h"
 #include "base/file_path.h"
 #include "base/file_util.h"
+#include "base/bind.h"
 #include "base/lazy_instance.h"
+#include "base/location.h"
 #include "base/memory/ref_counted.h"
 #include "base/message_loop.h"
+#include "base/metrics/histogram.h"
 #include "base/platform_file.h"
 #include "base/process_util.h"
 #include "base/stringprintf.h"
 #include "base/synchronization/lock.h"
 #include "base/sys_info.h"
 #include "base/threading/platform_thread.h"
+#include "base/threading/sequenced_worker_pool.h"
 #include "base/threading/thread.h"
+#include "base/time.h"
 #include "base/utf_string_conversions.h"
+#include "env_chromium.h"
+#include "leveldb/cache.h"
 #include "leveldb/env.h"
 #include "leveldb/slice.h"
 #include "port/port.h"
@@ -395,6 +404,8 @@ class ChromiumEnv : public Env {
 
   virtual void Schedule(void (*function)(void*), void* arg);
 
+  void SetBackgroundWorkThrottled(bool throttled);
+
   virtual void StartThread(void (*function)(void* arg), void* arg);
 
   virtual std::string UserIdentifier() {
@@ -447,34 +458,54 @@ class ChromiumEnv : public Env {
   }
 
   virtual void SleepForMicroseconds(int micros) {
+    // LevelDB sleeps to slow down writes when compactions fall behind.
+    TRACE_EVENT1("leveldb", "ChromiumEnv::SleepForMicroseconds",
+                 "micros", micros);
     // Round up to the next millisecond.
     ::base::PlatformThread::Sleep(::base::TimeDelta::FromMicroseconds(micros));
   }
 
  private:
-  // BGThread() is the body of the background thread
-  void BGThread();
-  static void BGThreadWrapper(void* arg) {
-    reinterpret_cast<ChromiumEnv*>(arg)->BGThread();
-  }
+  // Entry per Schedule() call
+  struct BGItem {
+    void* arg;
+    void (*function)(void*);
+    ::base::TimeTicks schedule_time;
+  };
+  typedef std::deque<BGItem> BGQueue;
+
+  // Posts queued work to |pool_| while fewer than the allowed number of
+  // items are running. |mu_| must be held.
+  void StartBackgroundWorkLocked();
+
+  // Runs |item| on a worker thread.
+  void RunBackgroundWork(const BGItem& item);
 
   FilePath test_directory_;
 
   size_t page_size_;
   ::base::Lock mu_;
-  ::base::ConditionVariable bgsignal_;
-  bool started_bgthread_;
 
-  // Entry per Schedule() call
-  struct BGItem { void* arg; void (*function)(void*); };
-  typedef std::deque<BGItem> BGQueue;
+  // Work for all the databases in the process runs on this pool, so
+  // different databases compact in parallel rather than one after another.
+  // LevelDB schedules at most one item at a time per database. Leaked, as
+  // compactions may run until the process exits.
+  ::base::SequencedWorkerPool* pool_;
   BGQueue queue_;
+  int running_count_;
+  bool throttled_;
 };
 
+// The most background items which run at once, normally and while
+// throttled to leave disk bandwidth for loading pages.
+const int kMaxBackgroundWork = 2;
+const int kMaxThrottledBackgroundWork = 1;
+
 ChromiumEnv::ChromiumEnv()
     : page_size_(::base::SysInfo::VMAllocationGranularity()),
-      bgsignal_(&mu_),
-      started_bgthread_(false) {
+      pool_(NULL),
+      running_count_(0),
+      throttled_(false) {
 #if defined(OS_MACOSX)
   ::base::EnableTerminationOnHeapCorruption();
   ::base::EnableTerminationOnOutOfMemory();
@@ -501,43 +532,58 @@ class Thread : public ::base::PlatformThread::Delegate {
 };
 
 void ChromiumEnv::Schedule(void (*function)(void*), void* arg) {
-  mu_.Acquire();
-
-  // Start background thread if necessary
-  if (!started_bgthread_) {
-    started_bgthread_ = true;
-    StartThread(&ChromiumEnv::BGThreadWrapper, this);
-  }
-
-  // If the queue is currently empty, the background thread may currently be
-  // waiting.
-  if (queue_.empty()) {
-    bgsignal_.Signal();
+  ::base::AutoLock auto_lock(mu_);
+  if (!pool_) {
+    pool_ = new ::base::SequencedWorkerPool(kMaxBackgroundWork,
+                                            "LevelDBEnv");
+    pool_->AddRef();
   }
 
-  // Add to priority queue
   queue_.push_back(BGItem());
   queue_.back().function = function;
   queue_.back().arg = arg;
-
-  mu_.Release();
+  queue_.back().schedule_time = ::base::TimeTicks::Now();
+  StartBackgroundWorkLocked();
 }
 
-void ChromiumEnv::BGThread() {
-  while (true) {
-    // Wait until there is an item that is ready to run
-    mu_.Acquire();
-    while (queue_.empty()) {
-      bgsignal_.Wait();
-    }
+void ChromiumEnv::SetBackgroundWorkThrottled(bool throttled) {
+  ::base::AutoLock auto_lock(mu_);
+  throttled_ = throttled;
+  if (pool_)
+    StartBackgroundWorkLocked();
+}
 
-    void (*function)(void*) = queue_.front().function;
-    void* arg = queue_.front().arg;
+void ChromiumEnv::StartBackgroundWorkLocked() {
+  mu_.AssertAcquired();
+  int max_running = throttled_ ? kMaxThrottledBackgroundWork :
+                                 kMaxBackgroundWork;
+  while (running_count_ < max_running && !queue_.empty()) {
+    ++running_count_;
+    pool_->PostWorkerTaskWithShutdownBehavior(
+        FROM_HERE,
+        ::base::Bind(&ChromiumEnv::RunBackgroundWork,
+                     ::base::Unretained(this), queue_.front()),
+        ::base::SequencedWorkerPool::CONTINUE_ON_SHUTDOWN);
     queue_.pop_front();
+  }
+}
 
-    mu_.Release();
-    (*function)(arg);
+void ChromiumEnv::RunBackgroundWork(const BGItem& item) {
+  ::base::TimeTicks start_time = ::base::TimeTicks::Now();
+  UMA_HISTOGRAM_TIMES("LevelDBEnv.BackgroundWorkQueueTime",
+                      start_time - item.schedule_time);
+  {
+    // LevelDB only schedules compactions. |arg| is the database.
+    TRACE_EVENT1("leveldb", "ChromiumEnv::RunBackgroundWork",
+                 "db", static_cast<const void*>(item.arg));
+    (*item.function)(item.arg);
   }
+  UMA_HISTOGRAM_TIMES("LevelDBEnv.BackgroundWorkTime",
+                      ::base::TimeTicks::Now() - start_time);
+
+  ::base::AutoLock auto_lock(mu_);
+  --running_count_;
+  StartBackgroundWorkLocked();
 }
 
 void ChromiumEnv::StartThread(void (*function)(void* arg), void* arg) {
@@ -554,3 +600,44 @@ Env* Env::Default() {
 }
 
 }
+
+namespace leveldb_env {
+
+namespace {
+
+// The shared cache gets 1/256th of physical memory, within these bounds. A
+// database's own cache is 8MB by default.
+const int kMinSharedBlockCacheMB = 8;
+const int kMaxSharedBlockCacheMB = 32;
+
+class SharedBlockCacheHolder {
+ public:
+  SharedBlockCacheHolder() {
+    int cache_mb = std::max(
+        kMinSharedBlockCacheMB,
+        std::min(kMaxSharedBlockCacheMB,
+                 ::base::SysInfo::AmountOfPhysicalMemoryMB() / 256));
+    cache_ = leveldb::NewLRUCache(cache_mb * 1024 * 1024);
+  }
+
+  leveldb::Cache* cache() { return cache_; }
+
+ private:
+  // Never deleted, as databases may use it until the process exits.
+  leveldb::Cache* cache_;
+};
+
+::base::LazyInstance<SharedBlockCacheHolder>::Leaky
+    shared_block_cache = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+leveldb::Cache* SharedBlockCache() {
+  return shared_block_cache.Pointer()->cache();
+}
+
+void SetBackgroundWorkThrottled(bool throttled) {
+  leveldb::default_env.Pointer()->SetBackgroundWorkThrottled(throttled);
+}
+
+}  // namespace leveldb_env
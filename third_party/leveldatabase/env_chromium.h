@@ -0,0 +1,27 @@
+// Copyright (c) 2012 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#ifndef THIRD_PARTY_LEVELDATABASE_ENV_CHROMIUM_H_
+#define THIRD_PARTY_LEVELDATABASE_ENV_CHROMIUM_H_
+
+namespace leveldb {
+class Cache;
+}
+
+namespace leveldb_env {
+
+// Returns a block cache for databases which are opened many times over, such
+// as one per origin or extension, to share. Each database otherwise gets a
+// cache of its own, so their memory use grows with their number. Pass it as
+// leveldb::Options::block_cache; it lives for the life of the process.
+leveldb::Cache* SharedBlockCache();
+
+// While throttled, fewer compactions run at once, leaving more of the disk
+// to the foreground. They are never stopped, as LevelDB slows down and then
+// blocks writes to databases whose compactions fall behind.
+void SetBackgroundWorkThrottled(bool throttled);
+
+}  // namespace leveldb_env
+
+#endif  // THIRD_PARTY_LEVELDATABASE_ENV_CHROMIUM_H_
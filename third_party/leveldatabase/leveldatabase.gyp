@@ -62,6 +62,7 @@
         # Include and then exclude so that all files show up in IDEs, even if
         # they don't build.
         'env_chromium.cc',
+        'env_chromium.h',
         'port/port_chromium.cc',
         'port/port_chromium.h',
         'src/db/builder.cc',
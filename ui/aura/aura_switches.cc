@@ -11,6 +11,10 @@ namespace switches {
 // Enable the holding of mouse movements in order to throttle window resizing.
 const char kAuraDisableHoldMouseMoves[] = "aura-disable-hold-mouse-moves";
 
+// Coalesce consecutive mouse move, scroll and touch move events until the next
+// frame.
+const char kAuraEnableEventCoalescing[] = "aura-enable-event-coalescing";
+
 // Initial dimensions for the host window in the form "1024x768".
 const char kAuraHostWindowSize[] = "aura-host-window-size";
 
@@ -344,6 +344,13 @@ class AURA_EXPORT ScrollEvent : public MouseEvent {
   float x_offset() const { return x_offset_; }
   float y_offset() const { return y_offset_; }
 
+  // Adds the offsets of |other| to those of this event, to merge consecutive
+  // scrolls into one.
+  void AddOffsets(const ScrollEvent& other) {
+    x_offset_ += other.x_offset_;
+    y_offset_ += other.y_offset_;
+  }
+
  private:
   float x_offset_;
   float y_offset_;
@@ -11,6 +11,7 @@
 #include "base/debug/trace_event.h"
 #include "base/logging.h"
 #include "base/message_loop.h"
+#include "base/metrics/histogram.h"
 #include "ui/aura/aura_switches.h"
 #include "ui/aura/client/activation_client.h"
 #include "ui/aura/client/event_client.h"
@@ -87,6 +88,7 @@ RootWindow::RootWindow(const gfx::Rect& initial_bounds)
       host_(aura::RootWindowHost::Create(initial_bounds)),
       ALLOW_THIS_IN_INITIALIZER_LIST(schedule_paint_factory_(this)),
       ALLOW_THIS_IN_INITIALIZER_LIST(event_factory_(this)),
+      ALLOW_THIS_IN_INITIALIZER_LIST(held_event_factory_(this)),
       mouse_button_flags_(0),
       last_cursor_(ui::kCursorNull),
       cursor_shown_(true),
@@ -103,12 +105,16 @@ RootWindow::RootWindow(const gfx::Rect& initial_bounds)
       defer_draw_scheduling_(false),
       mouse_move_hold_count_(0),
       should_hold_mouse_moves_(false),
+      should_coalesce_events_(false),
+      coalesced_event_count_(0),
       compositor_lock_(NULL),
       draw_on_compositor_unlock_(false),
       draw_trace_count_(0) {
   SetName("RootWindow");
   should_hold_mouse_moves_ = !CommandLine::ForCurrentProcess()->HasSwitch(
       switches::kAuraDisableHoldMouseMoves);
+  should_coalesce_events_ = CommandLine::ForCurrentProcess()->HasSwitch(
+      switches::kAuraEnableEventCoalescing);
 
   compositor_.reset(new ui::Compositor(this, host_->GetAcceleratedWidget(),
       host_->GetBounds().size()));
@@ -149,7 +155,7 @@ void RootWindow::ShowRootWindow() {
 }
 
 void RootWindow::SetHostSize(const gfx::Size& size) {
-  DispatchHeldMouseMove();
+  DispatchHeldEvents();
   gfx::Rect bounds = host_->GetBounds();
   bounds.set_size(size);
   host_->SetBounds(bounds);
@@ -163,7 +169,7 @@ gfx::Size RootWindow::GetHostSize() const {
 }
 
 void RootWindow::SetHostBounds(const gfx::Rect& bounds) {
-  DispatchHeldMouseMove();
+  DispatchHeldEvents();
   host_->SetBounds(bounds);
   // Requery the location to constrain it within the new root window size.
   last_mouse_location_ = ConvertPointToDIP(this, host_->QueryMouseLocation());
@@ -199,6 +205,9 @@ bool RootWindow::ConfineCursorToWindow() {
 }
 
 void RootWindow::Draw() {
+  // Input held for coalescing goes out before the frame which shows it.
+  DispatchCoalescedEvents();
+
   if (waiting_on_compositing_end_) {
     draw_on_compositing_end_ = true;
     defer_draw_scheduling_ = false;
@@ -213,6 +222,9 @@ void RootWindow::Draw() {
 
   TRACE_EVENT_ASYNC_BEGIN0("ui", "RootWindow::Draw", draw_trace_count_++);
 
+  drawn_input_time_ = oldest_unpainted_input_time_;
+  oldest_unpainted_input_time_ = base::TimeTicks();
+
   compositor_->Draw(false);
   defer_draw_scheduling_ = false;
 }
@@ -222,20 +234,31 @@ void RootWindow::ScheduleFullDraw() {
 }
 
 bool RootWindow::DispatchMouseEvent(MouseEvent* event) {
+  OnInputEvent();
   if (mouse_move_hold_count_) {
     if (event->type() == ui::ET_MOUSE_DRAGGED ||
         (event->flags() & ui::EF_IS_SYNTHESIZED)) {
       held_mouse_move_.reset(new MouseEvent(*event, NULL, NULL));
       return true;
-    } else {
-      DispatchHeldMouseMove();
     }
+  } else if (should_coalesce_events_ &&
+             (event->type() == ui::ET_MOUSE_MOVED ||
+              event->type() == ui::ET_MOUSE_DRAGGED)) {
+    if (held_mouse_move_.get() && held_mouse_move_->type() == event->type())
+      ++coalesced_event_count_;
+    else
+      DispatchHeldEvents();
+    held_mouse_move_.reset(new MouseEvent(*event, NULL, NULL));
+    PostDispatchHeldEvents();
+    return true;
   }
+  DispatchHeldEvents();
   return DispatchMouseEventImpl(event);
 }
 
 bool RootWindow::DispatchKeyEvent(KeyEvent* event) {
-  DispatchHeldMouseMove();
+  OnInputEvent();
+  DispatchHeldEvents();
   KeyEvent translated_event(*event);
   if (translated_event.key_code() == ui::VKEY_UNKNOWN)
     return false;
@@ -248,7 +271,27 @@ bool RootWindow::DispatchKeyEvent(KeyEvent* event) {
 }
 
 bool RootWindow::DispatchScrollEvent(ScrollEvent* event) {
-  DispatchHeldMouseMove();
+  OnInputEvent();
+  if (should_coalesce_events_ && !mouse_move_hold_count_) {
+    scoped_ptr<ScrollEvent> scroll(
+        new ScrollEvent(*event, NULL, NULL, event->type(), event->flags()));
+    if (held_scroll_.get() && held_scroll_->type() == event->type() &&
+        held_scroll_->flags() == event->flags()) {
+      scroll->AddOffsets(*held_scroll_);
+      held_scroll_.reset();
+      ++coalesced_event_count_;
+    } else {
+      DispatchHeldEvents();
+    }
+    held_scroll_.reset(scroll.release());
+    PostDispatchHeldEvents();
+    return true;
+  }
+  DispatchHeldEvents();
+  return DispatchScrollEventImpl(event);
+}
+
+bool RootWindow::DispatchScrollEventImpl(ScrollEvent* event) {
 #if defined(ENABLE_DIP)
   float scale = GetMonitorScaleFactor(this);
   ui::Transform transform;
@@ -280,7 +323,24 @@ bool RootWindow::DispatchScrollEvent(ScrollEvent* event) {
 }
 
 bool RootWindow::DispatchTouchEvent(TouchEvent* event) {
-  DispatchHeldMouseMove();
+  OnInputEvent();
+  if (should_coalesce_events_ && !mouse_move_hold_count_ &&
+      event->type() == ui::ET_TOUCH_MOVED) {
+    if (held_touch_move_.get() &&
+        held_touch_move_->touch_id() == event->touch_id()) {
+      ++coalesced_event_count_;
+    } else {
+      DispatchHeldEvents();
+    }
+    held_touch_move_.reset(new TouchEvent(*event, NULL, NULL));
+    PostDispatchHeldEvents();
+    return true;
+  }
+  DispatchHeldEvents();
+  return DispatchTouchEventImpl(event);
+}
+
+bool RootWindow::DispatchTouchEventImpl(TouchEvent* event) {
 #if defined(ENABLE_DIP)
   float scale = GetMonitorScaleFactor(this);
   ui::Transform transform;
@@ -338,7 +398,7 @@ bool RootWindow::DispatchTouchEvent(TouchEvent* event) {
 }
 
 bool RootWindow::DispatchGestureEvent(GestureEvent* event) {
-  DispatchHeldMouseMove();
+  DispatchHeldEvents();
 
   Window* target = NULL;
   if (HasCapture(capture_window_, ui::CW_LOCK_TOUCH))
@@ -361,7 +421,7 @@ bool RootWindow::DispatchGestureEvent(GestureEvent* event) {
 }
 
 void RootWindow::OnHostResized(const gfx::Size& size) {
-  DispatchHeldMouseMove();
+  DispatchHeldEvents();
   // The compositor should have the same size as the native root window host.
   compositor_->WidgetSizeChanged(size);
   gfx::Size old(ConvertSizeToDIP(this, bounds().size()));
@@ -504,7 +564,7 @@ void RootWindow::ReleaseMouseMoves() {
     --mouse_move_hold_count_;
     DCHECK_GE(mouse_move_hold_count_, 0);
     if (!mouse_move_hold_count_)
-      DispatchHeldMouseMove();
+      DispatchHeldEvents();
   }
 }
 
@@ -560,6 +620,11 @@ void RootWindow::OnCompositingStarted(ui::Compositor*) {
 
 void RootWindow::OnCompositingEnded(ui::Compositor*) {
   TRACE_EVENT_ASYNC_END0("ui", "RootWindow::Draw", draw_trace_count_);
+  if (!drawn_input_time_.is_null()) {
+    UMA_HISTOGRAM_TIMES("Aura.InputToPaintLatency",
+                        base::TimeTicks::Now() - drawn_input_time_);
+    drawn_input_time_ = base::TimeTicks();
+  }
   waiting_on_compositing_end_ = false;
   if (draw_on_compositing_end_) {
     draw_on_compositing_end_ = false;
@@ -952,6 +1017,46 @@ void RootWindow::DispatchHeldMouseMove() {
   }
 }
 
+void RootWindow::DispatchHeldEvents() {
+  DispatchHeldMouseMove();
+  DispatchCoalescedEvents();
+}
+
+void RootWindow::DispatchCoalescedEvents() {
+  // A mouse move held by HoldMouseMoves() waits for ReleaseMouseMoves().
+  if (!mouse_move_hold_count_)
+    DispatchHeldMouseMove();
+  if (held_scroll_.get()) {
+    scoped_ptr<ScrollEvent> scroll(held_scroll_.release());
+    DispatchScrollEventImpl(scroll.get());
+  }
+  if (held_touch_move_.get()) {
+    scoped_ptr<TouchEvent> touch(held_touch_move_.release());
+    DispatchTouchEventImpl(touch.get());
+  }
+  if (coalesced_event_count_) {
+    TRACE_COUNTER1("ui", "RootWindow::CoalescedEvents",
+                   coalesced_event_count_);
+    UMA_HISTOGRAM_COUNTS_100("Aura.CoalescedEvents", coalesced_event_count_);
+    coalesced_event_count_ = 0;
+  }
+  held_event_factory_.InvalidateWeakPtrs();
+}
+
+void RootWindow::PostDispatchHeldEvents() {
+  if (held_event_factory_.HasWeakPtrs())
+    return;
+  MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&RootWindow::DispatchCoalescedEvents,
+                 held_event_factory_.GetWeakPtr()));
+}
+
+void RootWindow::OnInputEvent() {
+  if (oldest_unpainted_input_time_.is_null())
+    oldest_unpainted_input_time_ = base::TimeTicks::Now();
+}
+
 void RootWindow::PostMouseMoveEventAfterWindowChange() {
   if (synthesize_mouse_move_)
     return;
@@ -11,6 +11,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/message_loop.h"
+#include "base/time.h"
 #include "ui/aura/aura_export.h"
 #include "ui/aura/dip_util.h"
 #include "ui/aura/focus_manager.h"
@@ -138,6 +139,11 @@ class AURA_EXPORT RootWindow : public ui::CompositorDelegate,
   void ScheduleFullDraw();
 
   // Handles a mouse event. Returns true if handled.
+  //
+  // When event coalescing is enabled, mouse moves and drags, scrolls and touch
+  // moves are held until the next frame or until an event of another kind
+  // arrives, and consecutive ones of the same kind are merged so that only
+  // the latest state is dispatched. Held events are reported as handled.
   bool DispatchMouseEvent(MouseEvent* event);
 
   // Handles a key event. Returns true if handled.
@@ -331,6 +337,24 @@ class AURA_EXPORT RootWindow : public ui::CompositorDelegate,
   bool DispatchMouseEventImpl(MouseEvent* event);
   void DispatchHeldMouseMove();
 
+  // Dispatch newly incoming scroll and touch events.
+  bool DispatchScrollEventImpl(ScrollEvent* event);
+  bool DispatchTouchEventImpl(TouchEvent* event);
+
+  // Dispatches all the held events.
+  void DispatchHeldEvents();
+
+  // Dispatches the events held for coalescing, once per frame. A mouse move
+  // held by HoldMouseMoves() is kept.
+  void DispatchCoalescedEvents();
+
+  // Posts a task to run DispatchCoalescedEvents(), if there is no pending
+  // task.
+  void PostDispatchHeldEvents();
+
+  // Notes that an input event has arrived, for the input-to-paint latency.
+  void OnInputEvent();
+
   // Parses the switch describing the initial size for the host window and
   // returns bounds for the window.
   gfx::Rect GetInitialHostWindowBounds() const;
@@ -361,6 +385,9 @@ class AURA_EXPORT RootWindow : public ui::CompositorDelegate,
   // Use to post mouse move event.
   base::WeakPtrFactory<RootWindow> event_factory_;
 
+  // Used to post the dispatch of the events held for coalescing.
+  base::WeakPtrFactory<RootWindow> held_event_factory_;
+
   // Last location seen in a mouse event.
   gfx::Point last_mouse_location_;
 
@@ -400,6 +427,19 @@ class AURA_EXPORT RootWindow : public ui::CompositorDelegate,
   bool should_hold_mouse_moves_;
   scoped_ptr<MouseEvent> held_mouse_move_;
 
+  // Whether consecutive move, scroll and touch-move events are coalesced, the
+  // held scroll and touch move, and how many events were merged into the held
+  // events.
+  bool should_coalesce_events_;
+  scoped_ptr<ScrollEvent> held_scroll_;
+  scoped_ptr<TouchEvent> held_touch_move_;
+  int coalesced_event_count_;
+
+  // When the oldest input event that no frame has been drawn after arrived,
+  // and that time for the frame being drawn.
+  base::TimeTicks oldest_unpainted_input_time_;
+  base::TimeTicks drawn_input_time_;
+
   CompositorLock* compositor_lock_;
   bool draw_on_compositor_unlock_;
 
@@ -15,6 +15,7 @@
 #include "base/stl_util.h"
 #include "base/string_piece.h"
 #include "base/synchronization/lock.h"
+#include "base/time.h"
 #include "base/utf_string_conversions.h"
 #include "build/build_config.h"
 #include "third_party/skia/include/core/SkBitmap.h"
@@ -42,8 +43,24 @@ const int kMediumFontSizeDelta = 3;
 const int kLargeFontSizeDelta = 8;
 #endif
 
+// Loads the data pack at |path| into |data_packs|.
+void LoadDataPack(const FilePath& path,
+                  float scale_factor,
+                  ScopedVector<ResourceHandle>* data_packs) {
+  scoped_ptr<DataPack> data_pack(new DataPack(scale_factor));
+  if (data_pack->Load(path)) {
+    data_packs->push_back(data_pack.release());
+  } else {
+    LOG(ERROR) << "Failed to load " << path.value()
+               << "\nSome features may not be available.";
+  }
+}
+
 }  // namespace
 
+// Enough for the images of a few dialogs.
+const size_t ResourceBundle::kMaxTransientImages = 64;
+
 ResourceBundle* ResourceBundle::g_shared_instance_ = NULL;
 
 // static
@@ -90,14 +107,11 @@ bool ResourceBundle::LocaleDataPakExists(const std::string& locale) {
 }
 
 void ResourceBundle::AddDataPack(const FilePath& path, float scale_factor) {
-  scoped_ptr<DataPack> data_pack(
-      new DataPack(ResourceHandle::kScaleFactor100x));
-  if (data_pack->Load(path)) {
-    data_packs_.push_back(data_pack.release());
-  } else {
-    LOG(ERROR) << "Failed to load " << path.value()
-               << "\nSome features may not be available.";
+  if (scale_factor != ResourceHandle::kScaleFactor100x) {
+    pending_scaled_data_packs_.push_back(std::make_pair(path, scale_factor));
+    return;
   }
+  LoadDataPack(path, scale_factor, &data_packs_);
 }
 
 #if !defined(OS_MACOSX)
@@ -238,17 +252,21 @@ gfx::Image& ResourceBundle::GetImageNamed(int resource_id) {
     ImageMap::const_iterator found = images_.find(resource_id);
     if (found != images_.end())
       return *found->second;
-  }
 
-  DCHECK(!data_packs_.empty()) << "Missing call to SetResourcesDataDLL?";
-  ScopedVector<const SkBitmap> bitmaps;
-  for (size_t i = 0; i < data_packs_.size(); ++i) {
-    SkBitmap* bitmap = LoadBitmap(*data_packs_[i], resource_id);
-    if (bitmap)
-      bitmaps.push_back(bitmap);
+    // Images which turn out not to be transient after all are kept for good.
+    TransientImageCache::iterator transient =
+        transient_images_.Peek(resource_id);
+    if (transient != transient_images_.end()) {
+      gfx::Image* image = new gfx::Image(*transient->second);
+      transient_images_.Erase(transient);
+      images_[resource_id] = image;
+      return *image;
+    }
   }
 
-  if (bitmaps.empty()) {
+  size_t bytes = 0;
+  scoped_ptr<gfx::Image> image(LoadImage(resource_id, &bytes));
+  if (!image.get()) {
     LOG(WARNING) << "Unable to load image with id " << resource_id;
     NOTREACHED();  // Want to assert in debug mode.
     // The load failed to retrieve the image; show a debugging red square.
@@ -262,12 +280,56 @@ gfx::Image& ResourceBundle::GetImageNamed(int resource_id) {
   if (images_.count(resource_id))
     return *images_[resource_id];
 
-  std::vector<const SkBitmap*> tmp_bitmaps;
-  bitmaps.release(&tmp_bitmaps);
-  // Takes ownership of bitmaps.
-  gfx::Image* image = new gfx::Image(tmp_bitmaps);
-  images_[resource_id] = image;
-  return *image;
+  images_size_ += bytes;
+  images_[resource_id] = image.get();
+  return *image.release();
+}
+
+gfx::Image ResourceBundle::GetTransientImageNamed(int resource_id) {
+  {
+    base::AutoLock lock_scope(*images_and_fonts_lock_);
+    ImageMap::const_iterator found = images_.find(resource_id);
+    if (found != images_.end())
+      return *found->second;
+
+    TransientImageCache::iterator transient =
+        transient_images_.Get(resource_id);
+    if (transient != transient_images_.end())
+      return *transient->second;
+  }
+
+  size_t bytes = 0;
+  scoped_ptr<gfx::Image> image(LoadImage(resource_id, &bytes));
+  if (!image.get()) {
+    LOG(WARNING) << "Unable to load image with id " << resource_id;
+    NOTREACHED();
+    return *GetEmptyImage();
+  }
+
+  base::AutoLock lock_scope(*images_and_fonts_lock_);
+  TransientImageCache::iterator transient = transient_images_.Get(resource_id);
+  if (transient != transient_images_.end())
+    return *transient->second;
+
+  gfx::Image result(*image);
+  transient_images_.Put(resource_id, image.release());
+  return result;
+}
+
+void ResourceBundle::PreloadImages(const std::vector<int>& resource_ids) {
+  base::TimeTicks start_time = base::TimeTicks::Now();
+  for (size_t i = 0; i < resource_ids.size(); ++i)
+    GetImageNamed(resource_ids[i]);
+  UMA_HISTOGRAM_TIMES("ResourceBundle.PreloadImagesTime",
+                      base::TimeTicks::Now() - start_time);
+
+  size_t images_size;
+  {
+    base::AutoLock lock_scope(*images_and_fonts_lock_);
+    images_size = images_size_;
+  }
+  UMA_HISTOGRAM_MEMORY_KB("ResourceBundle.PreloadedImagesSize",
+                          images_size / 1024);
 }
 
 gfx::Image& ResourceBundle::GetNativeImageNamed(int resource_id) {
@@ -283,6 +345,14 @@ base::RefCountedStaticMemory* ResourceBundle::LoadDataResourceBytes(
       return bytes;
   }
 
+  LoadScaledDataPacksIfNecessary();
+  for (size_t i = 0; i < scaled_data_packs_.size(); ++i) {
+    base::RefCountedStaticMemory* bytes =
+        scaled_data_packs_[i]->GetStaticMemory(resource_id);
+    if (bytes)
+      return bytes;
+  }
+
   return NULL;
 }
 
@@ -297,6 +367,12 @@ base::StringPiece ResourceBundle::GetRawDataResource(int resource_id) const {
       return data;
   }
 
+  LoadScaledDataPacksIfNecessary();
+  for (size_t i = 0; i < scaled_data_packs_.size(); ++i) {
+    if (scaled_data_packs_[i]->GetStringPiece(resource_id, &data))
+      return data;
+  }
+
   return base::StringPiece();
 }
 
@@ -331,7 +407,9 @@ void ResourceBundle::ReloadFonts() {
 
 ResourceBundle::ResourceBundle()
     : images_and_fonts_lock_(new base::Lock),
-      locale_resources_data_lock_(new base::Lock) {
+      locale_resources_data_lock_(new base::Lock),
+      images_size_(0),
+      transient_images_(kMaxTransientImages) {
 }
 
 ResourceBundle::~ResourceBundle() {
@@ -343,6 +421,47 @@ void ResourceBundle::FreeImages() {
   STLDeleteContainerPairSecondPointers(images_.begin(),
                                        images_.end());
   images_.clear();
+  images_size_ = 0;
+  transient_images_.Clear();
+}
+
+void ResourceBundle::LoadScaledDataPacksIfNecessary() const {
+  base::AutoLock lock_scope(*images_and_fonts_lock_);
+  for (size_t i = 0; i < pending_scaled_data_packs_.size(); ++i) {
+    LoadDataPack(pending_scaled_data_packs_[i].first,
+                 pending_scaled_data_packs_[i].second,
+                 &scaled_data_packs_);
+  }
+  pending_scaled_data_packs_.clear();
+}
+
+gfx::Image* ResourceBundle::LoadImage(int resource_id, size_t* bytes) {
+  DCHECK(!data_packs_.empty()) << "Missing call to SetResourcesDataDLL?";
+  LoadScaledDataPacksIfNecessary();
+
+  base::TimeTicks start_time = base::TimeTicks::Now();
+  ScopedVector<const SkBitmap> bitmaps;
+  for (size_t i = 0; i < data_packs_.size(); ++i) {
+    SkBitmap* bitmap = LoadBitmap(*data_packs_[i], resource_id);
+    if (bitmap)
+      bitmaps.push_back(bitmap);
+  }
+  for (size_t i = 0; i < scaled_data_packs_.size(); ++i) {
+    SkBitmap* bitmap = LoadBitmap(*scaled_data_packs_[i], resource_id);
+    if (bitmap)
+      bitmaps.push_back(bitmap);
+  }
+  if (bitmaps.empty())
+    return NULL;
+  UMA_HISTOGRAM_TIMES("ResourceBundle.ImageDecodeTime",
+                      base::TimeTicks::Now() - start_time);
+
+  for (size_t i = 0; i < bitmaps.size(); ++i)
+    *bytes += bitmaps[i]->getSize();
+  std::vector<const SkBitmap*> tmp_bitmaps;
+  bitmaps.release(&tmp_bitmaps);
+  // Takes ownership of bitmaps.
+  return new gfx::Image(tmp_bitmaps);
 }
 
 void ResourceBundle::LoadFontsIfNecessary() {
@@ -10,10 +10,13 @@
 
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/file_path.h"
 #include "base/gtest_prod_util.h"
+#include "base/memory/mru_cache.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
 #include "base/string16.h"
@@ -88,8 +91,10 @@ class UI_EXPORT ResourceBundle {
   // Registers additional data pack files with the global ResourceBundle.  When
   // looking for a DataResource, we will search these files after searching the
   // main module. |scale_factor| is the scale of images in this resource pak
-  // relative to the images in the 1x resource pak. This method is not thread
-  // safe! You should call it immediately after calling InitSharedInstance.
+  // relative to the images in the 1x resource pak. Packs of other scale
+  // factors hold images, so they are not mapped until the first image (or a
+  // resource missing from the 1x packs) is loaded. This method is not thread safe! You should call it immediately
+  // after calling InitSharedInstance.
   void AddDataPack(const FilePath& path, float scale_factor);
 
   // Changes the locale for an already-initialized ResourceBundle, returning the
@@ -111,6 +116,18 @@ class UI_EXPORT ResourceBundle {
   // image in Skia format by default. The ResourceBundle owns this.
   gfx::Image& GetImageNamed(int resource_id);
 
+  // Like GetImageNamed(), for images which are seldom shown, such as those of
+  // dialogs and options pages. Only the kMaxTransientImages most recently used
+  // of these stay decoded. The returned image shares its bitmaps with the
+  // cached one, so it stays valid once that is evicted.
+  gfx::Image GetTransientImageNamed(int resource_id);
+
+  // Decodes the images with the given IDs into the cache, so that their first
+  // use doesn't have to. This is thread safe, so that the images which the
+  // first browser window paints can be decoded on a background thread during
+  // startup rather than on the UI thread as the window is painted.
+  void PreloadImages(const std::vector<int>& resource_ids);
+
   // Similar to GetImageNamed, but rather than loading the image in Skia format,
   // it will load in the native platform type. This can avoid conversion from
   // one image type to another. ResourceBundle owns the result.
@@ -150,14 +167,27 @@ class UI_EXPORT ResourceBundle {
 
  private:
   FRIEND_TEST_ALL_PREFIXES(ResourceBundle, LoadDataResourceBytes);
+  FRIEND_TEST_ALL_PREFIXES(ResourceBundle, TransientImagesAreBounded);
+
+  // The most images kept by GetTransientImageNamed().
+  static const size_t kMaxTransientImages;
 
   // Ctor/dtor are private, since we're a singleton.
   ResourceBundle();
   ~ResourceBundle();
 
-  // Free skia_images_.
+  // Free |images_| and |transient_images_|.
   void FreeImages();
 
+  // Maps the data packs of scale factors other than 1x which were deferred by
+  // AddDataPack().
+  void LoadScaledDataPacksIfNecessary() const;
+
+  // Decodes the image with the given resource id from every data pack that
+  // has it, adding the size of the decoded bitmaps to |*bytes|. Returns NULL
+  // if no data pack has the image. The caller owns the result.
+  gfx::Image* LoadImage(int resource_id, size_t* bytes);
+
   // Load the main resources.
   void LoadCommonResources();
 
@@ -190,7 +220,8 @@ class UI_EXPORT ResourceBundle {
 
   const FilePath& GetOverriddenPakPath();
 
-  // Protects |images_| and font-related members.
+  // Protects |images_|, |transient_images_|, the scaled data packs and
+  // font-related members.
   scoped_ptr<base::Lock> images_and_fonts_lock_;
 
   // Protects |locale_resources_data_|.
@@ -200,11 +231,25 @@ class UI_EXPORT ResourceBundle {
   scoped_ptr<ResourceHandle> locale_resources_data_;
   ScopedVector<ResourceHandle> data_packs_;
 
+  // The paths and scale factors of the data packs whose mapping is deferred
+  // until they are first searched, and those packs once mapped. Once mapped
+  // they don't change, so they may be read without the lock.
+  mutable std::vector<std::pair<FilePath, float> > pending_scaled_data_packs_;
+  mutable ScopedVector<ResourceHandle> scaled_data_packs_;
+
   // Cached images. The ResourceBundle caches all retrieved images and keeps
   // ownership of the pointers.
   typedef std::map<int, gfx::Image*> ImageMap;
   ImageMap images_;
 
+  // The size of the bitmaps decoded for |images_|, in bytes.
+  size_t images_size_;
+
+  // The images most recently retrieved by GetTransientImageNamed(), which
+  // aren't in |images_|.
+  typedef base::OwningMRUCache<int, gfx::Image*> TransientImageCache;
+  TransientImageCache transient_images_;
+
   // The various fonts used. Cached to avoid repeated GDI creation/destruction.
   scoped_ptr<gfx::Font> base_font_;
   scoped_ptr<gfx::Font> bold_font_;
@@ -99,10 +99,16 @@ gfx::Image& ResourceBundle::GetNativeImageNamed(int resource_id, ImageRTL rtl) {
     }
   }
 
+  LoadScaledDataPacksIfNecessary();
+  std::vector<const ResourceHandle*> image_data_packs(data_packs_.begin(),
+                                                      data_packs_.end());
+  image_data_packs.insert(image_data_packs.end(), scaled_data_packs_.begin(),
+                          scaled_data_packs_.end());
+
   scoped_nsobject<NSImage> ns_image;
-  for (size_t i = 0; i < data_packs_.size(); ++i) {
+  for (size_t i = 0; i < image_data_packs.size(); ++i) {
     scoped_refptr<base::RefCountedStaticMemory> data(
-        data_packs_[i]->GetStaticMemory(resource_id));
+        image_data_packs[i]->GetStaticMemory(resource_id));
     if (!data.get())
       continue;
 
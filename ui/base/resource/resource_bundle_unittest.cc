@@ -4,12 +4,19 @@
 
 #include "ui/base/resource/resource_bundle.h"
 
+#include <map>
+#include <vector>
+
 #include "base/base_paths.h"
 #include "base/file_path.h"
 #include "base/file_util.h"
 #include "base/path_service.h"
 #include "base/scoped_temp_dir.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/base/resource/data_pack.h"
+#include "ui/gfx/codec/png_codec.h"
+#include "ui/gfx/image/image.h"
 
 namespace ui {
 
@@ -44,6 +51,46 @@ TEST(ResourceBundle, LoadDataResourceBytes) {
   EXPECT_EQ(NULL, resource_bundle.LoadDataResourceBytes(kUnfoundResourceId));
 }
 
+TEST(ResourceBundle, TransientImagesAreBounded) {
+  ResourceBundle resource_bundle;
+
+  SkBitmap bitmap;
+  bitmap.setConfig(SkBitmap::kARGB_8888_Config, 4, 4);
+  bitmap.allocPixels();
+  bitmap.eraseARGB(255, 0, 255, 0);
+  std::vector<unsigned char> png;
+  ASSERT_TRUE(gfx::PNGCodec::EncodeBGRASkBitmap(bitmap, false, &png));
+
+  const int kNumImages = ResourceBundle::kMaxTransientImages + 1;
+  std::map<uint16, base::StringPiece> resources;
+  for (int i = 1; i <= kNumImages; ++i) {
+    resources[i] = base::StringPiece(reinterpret_cast<const char*>(&png[0]),
+                                     png.size());
+  }
+  ScopedTempDir dir;
+  ASSERT_TRUE(dir.CreateUniqueTempDir());
+  FilePath data_path = dir.path().Append(FILE_PATH_LITERAL("images.pak"));
+  ASSERT_TRUE(DataPack::WritePack(data_path, resources,
+                                  ResourceHandle::BINARY));
+  resource_bundle.LoadTestResources(data_path);
+
+  for (int i = 1; i <= kNumImages; ++i) {
+    gfx::Image image = resource_bundle.GetTransientImageNamed(i);
+    EXPECT_EQ(4, image.ToSkBitmap()->width());
+  }
+  EXPECT_EQ(ResourceBundle::kMaxTransientImages,
+            resource_bundle.transient_images_.size());
+  EXPECT_TRUE(resource_bundle.images_.empty());
+
+  // Images which are also retrieved with GetImageNamed() are kept for good.
+  resource_bundle.GetImageNamed(kNumImages);
+  EXPECT_EQ(ResourceBundle::kMaxTransientImages - 1,
+            resource_bundle.transient_images_.size());
+  EXPECT_EQ(1u, resource_bundle.images_.size());
+  gfx::Image image = resource_bundle.GetTransientImageNamed(kNumImages);
+  EXPECT_EQ(4, image.ToSkBitmap()->width());
+}
+
 TEST(ResourceBundle, LocaleDataPakExists) {
   // Check that ResourceBundle::LocaleDataPakExists returns the correct results.
   EXPECT_TRUE(ResourceBundle::LocaleDataPakExists("en-US"));
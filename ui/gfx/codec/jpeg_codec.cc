@@ -8,6 +8,8 @@
 
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/metrics/histogram.h"
+#include "base/time.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkColorPriv.h"
 
@@ -186,9 +188,45 @@ class CompressDestroyer {
 
 }  // namespace
 
+JPEGCodec::EncodeOptions::EncodeOptions()
+    : fast_dct(false),
+      optimize_coding(false) {
+}
+
+// static
+JPEGCodec::EncodeOptions JPEGCodec::EncodeOptions::Fast() {
+  EncodeOptions options;
+  options.fast_dct = true;
+  return options;
+}
+
 bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
                        int w, int h, int row_byte_width,
                        int quality, std::vector<unsigned char>* output) {
+  return EncodeWithOptions(input, format, w, h, row_byte_width, quality,
+                           EncodeOptions(), output);
+}
+
+bool JPEGCodec::EncodeSkBitmap(const SkBitmap& input, int quality,
+                               const EncodeOptions& options,
+                               std::vector<unsigned char>* output) {
+  SkAutoLockPixels lock_input(input);
+  if (!input.readyToDraw())
+    return false;
+  DCHECK_EQ(SkBitmap::kARGB_8888_Config, input.config());
+
+  return EncodeWithOptions(
+      reinterpret_cast<const unsigned char*>(input.getAddr32(0, 0)),
+      FORMAT_SkBitmap, input.width(), input.height(),
+      static_cast<int>(input.rowBytes()), quality, options, output);
+}
+
+bool JPEGCodec::EncodeWithOptions(const unsigned char* input,
+                                  ColorFormat format,
+                                  int w, int h, int row_byte_width,
+                                  int quality, const EncodeOptions& options,
+                                  std::vector<unsigned char>* output) {
+  base::TimeTicks encode_start = base::TimeTicks::Now();
   jpeg_compress_struct cinfo;
   CompressDestroyer destroyer;
   destroyer.SetManagedObject(&cinfo);
@@ -245,6 +283,9 @@ bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
 
   jpeg_set_defaults(&cinfo);
   jpeg_set_quality(&cinfo, quality, 1);  // quality here is 0-100
+  if (options.fast_dct)
+    cinfo.dct_method = JDCT_IFAST;
+  cinfo.optimize_coding = options.optimize_coding;
 
   // set up the destination manager
   jpeg_destination_mgr destmgr;
@@ -300,6 +341,8 @@ bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
 #endif
 
   jpeg_finish_compress(&cinfo);
+  UMA_HISTOGRAM_TIMES("Image.JPEGEncodeMS",
+                      base::TimeTicks::Now() - encode_start);
   return true;
 }
 
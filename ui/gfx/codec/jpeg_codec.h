@@ -38,6 +38,25 @@ class UI_EXPORT JPEGCodec {
     FORMAT_SkBitmap
   };
 
+  // Trades off encoding speed against image quality and output size. The
+  // defaults are those of Encode().
+  struct UI_EXPORT EncodeOptions {
+    EncodeOptions();
+
+    // Options for encoding on latency sensitive threads, such as thumbnails
+    // and screenshots.
+    static EncodeOptions Fast();
+
+    // Use the fast integer DCT, which libjpeg-turbo implements with SIMD
+    // instructions, instead of the slow accurate one. The difference is only
+    // visible at qualities above 90 or so.
+    bool fast_dct;
+
+    // Compute optimal Huffman tables, which makes the output a few percent
+    // smaller for an extra pass over the image.
+    bool optimize_coding;
+  };
+
   // Encodes the given raw 'input' data, with each pixel being represented as
   // given in 'format'. The encoded JPEG data will be written into the supplied
   // vector and true will be returned on success. On failure (false), the
@@ -52,6 +71,19 @@ class UI_EXPORT JPEGCodec {
                      int w, int h, int row_byte_width,
                      int quality, std::vector<unsigned char>* output);
 
+  // Same as Encode(), with the encoder settings in |options|.
+  static bool EncodeWithOptions(const unsigned char* input, ColorFormat format,
+                                int w, int h, int row_byte_width,
+                                int quality, const EncodeOptions& options,
+                                std::vector<unsigned char>* output);
+
+  // Encodes the rows of |input|, a kARGB_8888_Config bitmap, as they are
+  // stored in the bitmap. The alpha channel is ignored. During the call, an
+  // SkAutoLockPixels lock is held on |input|.
+  static bool EncodeSkBitmap(const SkBitmap& input, int quality,
+                             const EncodeOptions& options,
+                             std::vector<unsigned char>* output);
+
   // Decodes the JPEG data contained in input of length input_size. The
   // decoded data will be placed in *output with the dimensions in *w and *h
   // on success (returns true). This data will be written in the'format'
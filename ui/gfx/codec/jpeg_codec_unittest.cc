@@ -164,6 +164,42 @@ TEST(JPEGCodec, EncodeDecodeRGBA) {
   ASSERT_GE(jpeg_equality_threshold, AveragePixelDelta(original, decoded));
 }
 
+// Test the fast encoder options on BGRA input, which libjpeg-turbo reads
+// without converting it first.
+TEST(JPEGCodec, EncodeDecodeBGRAWithOptions) {
+  int w = 20, h = 20;
+
+  std::vector<unsigned char> original;
+  original.resize(w * h * 4);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      unsigned char* org_px = &original[(y * w + x) * 4];
+      org_px[0] = x * 3 + 2;  // b
+      org_px[1] = x * 3 + 1;  // g
+      org_px[2] = x * 3;      // r
+      org_px[3] = 0xFF;       // a (opaque)
+    }
+  }
+
+  JPEGCodec::EncodeOptions options = JPEGCodec::EncodeOptions::Fast();
+  options.optimize_coding = true;
+  std::vector<unsigned char> encoded;
+  EXPECT_TRUE(JPEGCodec::EncodeWithOptions(&original[0],
+                                           JPEGCodec::FORMAT_BGRA, w, h,
+                                           w * 4, jpeg_quality, options,
+                                           &encoded));
+  EXPECT_GT(original.size(), encoded.size());
+
+  std::vector<unsigned char> decoded;
+  int outw, outh;
+  EXPECT_TRUE(JPEGCodec::Decode(&encoded[0], encoded.size(),
+                                JPEGCodec::FORMAT_BGRA, &decoded,
+                                &outw, &outh));
+  ASSERT_EQ(w, outw);
+  ASSERT_EQ(h, outh);
+  ASSERT_GE(jpeg_equality_threshold, AveragePixelDelta(original, decoded));
+}
+
 // Test that corrupted data decompression causes failures.
 TEST(JPEGCodec, DecodeCorrupted) {
   int w = 20, h = 20;
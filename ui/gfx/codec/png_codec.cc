@@ -6,7 +6,9 @@
 
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/metrics/histogram.h"
 #include "base/string_util.h"
+#include "base/time.h"
 #include "ui/gfx/size.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkUnPreMultiply.h"
@@ -30,30 +32,6 @@ namespace gfx {
 
 namespace {
 
-// Converts BGRA->RGBA and RGBA->BGRA.
-void ConvertBetweenBGRAandRGBA(const unsigned char* input, int pixel_width,
-                               unsigned char* output, bool* is_opaque) {
-  for (int x = 0; x < pixel_width; x++) {
-    const unsigned char* pixel_in = &input[x * 4];
-    unsigned char* pixel_out = &output[x * 4];
-    pixel_out[0] = pixel_in[2];
-    pixel_out[1] = pixel_in[1];
-    pixel_out[2] = pixel_in[0];
-    pixel_out[3] = pixel_in[3];
-  }
-}
-
-void ConvertRGBAtoRGB(const unsigned char* rgba, int pixel_width,
-                      unsigned char* rgb, bool* is_opaque) {
-  for (int x = 0; x < pixel_width; x++) {
-    const unsigned char* pixel_in = &rgba[x * 4];
-    unsigned char* pixel_out = &rgb[x * 3];
-    pixel_out[0] = pixel_in[0];
-    pixel_out[1] = pixel_in[1];
-    pixel_out[2] = pixel_in[2];
-  }
-}
-
 void ConvertSkiatoRGB(const unsigned char* skia, int pixel_width,
                       unsigned char* rgb, bool* is_opaque) {
   for (int x = 0; x < pixel_width; x++) {
@@ -554,14 +532,32 @@ void FakeFlushCallback(png_structp png) {
   // we're required to provide this function by libpng.
 }
 
-void ConvertBGRAtoRGB(const unsigned char* bgra, int pixel_width,
-                      unsigned char* rgb, bool* is_opaque) {
-  for (int x = 0; x < pixel_width; x++) {
-    const unsigned char* pixel_in = &bgra[x * 4];
-    unsigned char* pixel_out = &rgb[x * 3];
-    pixel_out[0] = pixel_in[2];
-    pixel_out[1] = pixel_in[1];
-    pixel_out[2] = pixel_in[0];
+// Maps the encoder options to their libpng and zlib values.
+int FilterSelectionToPNGFilters(PNGCodec::FilterSelection filter) {
+  switch (filter) {
+    case PNGCodec::FILTER_NONE:
+      return PNG_FILTER_NONE;
+    case PNGCodec::FILTER_SUB:
+      return PNG_FILTER_SUB;
+    case PNGCodec::FILTER_UP:
+      return PNG_FILTER_UP;
+    case PNGCodec::FILTER_PAETH:
+      return PNG_FILTER_PAETH;
+    default:
+      return PNG_ALL_FILTERS;
+  }
+}
+
+int CompressionStrategyToZlib(PNGCodec::CompressionStrategy strategy) {
+  switch (strategy) {
+    case PNGCodec::STRATEGY_FILTERED:
+      return Z_FILTERED;
+    case PNGCodec::STRATEGY_HUFFMAN_ONLY:
+      return Z_HUFFMAN_ONLY;
+    case PNGCodec::STRATEGY_RLE:
+      return Z_RLE;
+    default:
+      return Z_DEFAULT_STRATEGY;
   }
 }
 
@@ -624,12 +620,18 @@ typedef void (*FormatConverter)(const unsigned char* in, int w,
 // libpng uses a wacky setjmp-based API, which makes the compiler nervous.
 // We constrain all of the calls we make to libpng where the setjmp() is in
 // place to this function.
+//
+// Rather than converting BGRA and RGBA rows into a separate buffer, libpng
+// is asked to swap red and blue (|swap_red_blue|) and to drop the fourth
+// byte of each pixel (|strip_alpha|) as it copies the rows in.
 // Returns true on success.
 bool DoLibpngWrite(png_struct* png_ptr, png_info* info_ptr,
                    PngEncoderState* state,
                    int width, int height, int row_byte_width,
-                   const unsigned char* input, int compression_level,
+                   const unsigned char* input,
+                   const PNGCodec::EncodeOptions& options,
                    int png_output_color_type, int output_color_components,
+                   bool swap_red_blue, bool strip_alpha,
                    FormatConverter converter,
                    const std::vector<PNGCodec::Comment>& comments) {
   // Make sure to not declare any locals here -- locals in the presence
@@ -638,7 +640,17 @@ bool DoLibpngWrite(png_struct* png_ptr, png_info* info_ptr,
   if (setjmp(png_jmpbuf(png_ptr)))
     return false;
 
-  png_set_compression_level(png_ptr, compression_level);
+  png_set_compression_level(png_ptr, options.compression_level);
+  // Otherwise libpng picks Z_FILTERED when filtering rows, and the default
+  // strategy when not.
+  if (options.strategy != PNGCodec::STRATEGY_DEFAULT) {
+    png_set_compression_strategy(png_ptr,
+                                 CompressionStrategyToZlib(options.strategy));
+  }
+  if (options.filter != PNGCodec::FILTER_ADAPTIVE) {
+    png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE,
+                   FilterSelectionToPNGFilters(options.filter));
+  }
 
   // Set our callback for libpng to give us the data.
   png_set_write_fn(png_ptr, state, EncoderWriteCallback, FakeFlushCallback);
@@ -658,6 +670,12 @@ bool DoLibpngWrite(png_struct* png_ptr, png_info* info_ptr,
 
   png_write_info(png_ptr, info_ptr);
 
+  // The filler can only be set up once libpng knows the output color type.
+  if (strip_alpha)
+    png_set_filler(png_ptr, 0, PNG_FILLER_AFTER);
+  if (swap_red_blue)
+    png_set_bgr(png_ptr);
+
   if (!converter) {
     // No conversion needed, give the data directly to libpng.
     for (int y = 0; y < height; y ++) {
@@ -686,11 +704,9 @@ bool PNGCodec::Encode(const unsigned char* input, ColorFormat format,
                       bool discard_transparency,
                       const std::vector<Comment>& comments,
                       std::vector<unsigned char>* output) {
-  return PNGCodec::EncodeWithCompressionLevel(input, format, size,
-                                              row_byte_width,
-                                              discard_transparency,
-                                              comments, Z_DEFAULT_COMPRESSION,
-                                              output);
+  return PNGCodec::EncodeWithOptions(input, format, size, row_byte_width,
+                                     discard_transparency, comments,
+                                     EncodeOptions(), output);
 }
 
 // static
@@ -701,9 +717,26 @@ bool PNGCodec::EncodeWithCompressionLevel(const unsigned char* input,
                                           const std::vector<Comment>& comments,
                                           int compression_level,
                                           std::vector<unsigned char>* output) {
+  EncodeOptions options;
+  options.compression_level = compression_level;
+  return PNGCodec::EncodeWithOptions(input, format, size, row_byte_width,
+                                     discard_transparency, comments, options,
+                                     output);
+}
+
+// static
+bool PNGCodec::EncodeWithOptions(const unsigned char* input,
+                                 ColorFormat format, const Size& size,
+                                 int row_byte_width,
+                                 bool discard_transparency,
+                                 const std::vector<Comment>& comments,
+                                 const EncodeOptions& options,
+                                 std::vector<unsigned char>* output) {
   // Run to convert an input row into the output row format, NULL means no
   // conversion is necessary.
   FormatConverter converter = NULL;
+  bool swap_red_blue = false;
+  bool strip_alpha = false;
 
   int input_color_components, output_color_components;
   int png_output_color_type;
@@ -719,7 +752,7 @@ bool PNGCodec::EncodeWithCompressionLevel(const unsigned char* input,
       if (discard_transparency) {
         output_color_components = 3;
         png_output_color_type = PNG_COLOR_TYPE_RGB;
-        converter = ConvertRGBAtoRGB;
+        strip_alpha = true;
       } else {
         output_color_components = 4;
         png_output_color_type = PNG_COLOR_TYPE_RGB_ALPHA;
@@ -729,14 +762,14 @@ bool PNGCodec::EncodeWithCompressionLevel(const unsigned char* input,
 
     case FORMAT_BGRA:
       input_color_components = 4;
+      swap_red_blue = true;
       if (discard_transparency) {
         output_color_components = 3;
         png_output_color_type = PNG_COLOR_TYPE_RGB;
-        converter = ConvertBGRAtoRGB;
+        strip_alpha = true;
       } else {
         output_color_components = 4;
         png_output_color_type = PNG_COLOR_TYPE_RGB_ALPHA;
-        converter = ConvertBetweenBGRAandRGBA;
       }
       break;
 
@@ -771,11 +804,17 @@ bool PNGCodec::EncodeWithCompressionLevel(const unsigned char* input,
     return false;
   destroyer.SetInfoStruct(&info_ptr);
 
+  base::TimeTicks encode_start = base::TimeTicks::Now();
   PngEncoderState state(output);
   bool success = DoLibpngWrite(png_ptr, info_ptr, &state,
                                size.width(), size.height(), row_byte_width,
-                               input, compression_level, png_output_color_type,
-                               output_color_components, converter, comments);
+                               input, options, png_output_color_type,
+                               output_color_components, swap_red_blue,
+                               strip_alpha, converter, comments);
+  if (success) {
+    UMA_HISTOGRAM_TIMES("Image.PNGEncodeMS",
+                        base::TimeTicks::Now() - encode_start);
+  }
 
   return success;
 }
@@ -784,15 +823,31 @@ bool PNGCodec::EncodeWithCompressionLevel(const unsigned char* input,
 bool PNGCodec::EncodeBGRASkBitmap(const SkBitmap& input,
                                   bool discard_transparency,
                                   std::vector<unsigned char>* output) {
+  return EncodeBGRASkBitmapWithOptions(input, discard_transparency,
+                                       EncodeOptions(), output);
+}
+
+// static
+bool PNGCodec::EncodeBGRASkBitmapWithOptions(
+    const SkBitmap& input,
+    bool discard_transparency,
+    const EncodeOptions& options,
+    std::vector<unsigned char>* output) {
   static const int bbp = 4;
 
   SkAutoLockPixels lock_input(input);
   DCHECK(input.empty() || input.bytesPerPixel() == bbp);
 
-  return Encode(reinterpret_cast<unsigned char*>(input.getAddr32(0, 0)),
-                FORMAT_SkBitmap, Size(input.width(), input.height()),
-                input.width() * bbp, discard_transparency,
-                std::vector<Comment>(), output);
+  // Opaque pixels are the same premultiplied or not, so when Skia stores
+  // them as BGRA they need no converting.
+  ColorFormat format = FORMAT_SkBitmap;
+  if (input.isOpaque() && SK_B32_SHIFT == 0 && SK_A32_SHIFT == 24)
+    format = FORMAT_BGRA;
+
+  return EncodeWithOptions(
+      reinterpret_cast<unsigned char*>(input.getAddr32(0, 0)), format,
+      Size(input.width(), input.height()), static_cast<int>(input.rowBytes()),
+      discard_transparency, std::vector<Comment>(), options, output);
 }
 
 PNGCodec::Comment::Comment(const std::string& k, const std::string& t)
@@ -802,4 +857,22 @@ PNGCodec::Comment::Comment(const std::string& k, const std::string& t)
 PNGCodec::Comment::~Comment() {
 }
 
+PNGCodec::EncodeOptions::EncodeOptions()
+    : compression_level(Z_DEFAULT_COMPRESSION),
+      strategy(STRATEGY_DEFAULT),
+      filter(FILTER_ADAPTIVE) {
+}
+
+// static
+PNGCodec::EncodeOptions PNGCodec::EncodeOptions::Fast() {
+  // Filtering each row with its left neighbour and run-length encoding the
+  // result does well on screenshots and other flat images, for a fraction of
+  // the time of trying every filter and searching for matches.
+  EncodeOptions options;
+  options.compression_level = Z_BEST_SPEED;
+  options.strategy = STRATEGY_RLE;
+  options.filter = FILTER_SUB;
+  return options;
+}
+
 }  // namespace gfx
@@ -52,6 +52,46 @@ class UI_EXPORT PNGCodec {
     std::string text;
   };
 
+  // The row filters the encoder may apply before compressing each row.
+  enum FilterSelection {
+    // Let libpng pick the best filter for each row. This gives the smallest
+    // output, but tries every filter on every row.
+    FILTER_ADAPTIVE,
+
+    // Always use the given filter.
+    FILTER_NONE,
+    FILTER_SUB,
+    FILTER_UP,
+    FILTER_PAETH
+  };
+
+  // The zlib compression strategy, see deflateInit2() in zlib.h.
+  enum CompressionStrategy {
+    // Z_FILTERED when rows are filtered, zlib's default strategy otherwise.
+    STRATEGY_DEFAULT,
+    STRATEGY_FILTERED,
+    STRATEGY_HUFFMAN_ONLY,
+    STRATEGY_RLE
+  };
+
+  // Trades off encoding speed against output size. The defaults are those
+  // of Encode().
+  struct UI_EXPORT EncodeOptions {
+    EncodeOptions();
+
+    // Options for encoding on latency sensitive threads, such as thumbnails
+    // and screenshots. Typically several times faster than the defaults, for
+    // output up to a third larger.
+    static EncodeOptions Fast();
+
+    // An integer between -1 and 9, corresponding to zlib's compression
+    // levels. -1 is the default.
+    int compression_level;
+
+    CompressionStrategy strategy;
+    FilterSelection filter;
+  };
+
   // Calls PNGCodec::EncodeWithCompressionLevel with the default compression
   // level.
   static bool Encode(const unsigned char* input,
@@ -90,14 +130,34 @@ class UI_EXPORT PNGCodec {
                                          int compression_level,
                                          std::vector<unsigned char>* output);
 
+  // Same as EncodeWithCompressionLevel(), with every encoder setting given in
+  // |options|.
+  static bool EncodeWithOptions(const unsigned char* input,
+                                ColorFormat format,
+                                const Size& size,
+                                int row_byte_width,
+                                bool discard_transparency,
+                                const std::vector<Comment>& comments,
+                                const EncodeOptions& options,
+                                std::vector<unsigned char>* output);
+
   // Call PNGCodec::Encode on the supplied SkBitmap |input|, which is assumed
   // to be BGRA, 32 bits per pixel. The params |discard_transparency| and
   // |output| are passed directly to Encode; refer to Encode for more
   // information. During the call, an SkAutoLockPixels lock is held on |input|.
+  //
+  // The rows are encoded straight from the bitmap's pixels. Opaque bitmaps
+  // need no unpremultiplying, so their rows are not copied at all.
   static bool EncodeBGRASkBitmap(const SkBitmap& input,
                                  bool discard_transparency,
                                  std::vector<unsigned char>* output);
 
+  // Same as EncodeBGRASkBitmap(), with the encoder settings in |options|.
+  static bool EncodeBGRASkBitmapWithOptions(const SkBitmap& input,
+                                            bool discard_transparency,
+                                            const EncodeOptions& options,
+                                            std::vector<unsigned char>* output);
+
   // Decodes the PNG data contained in input of length input_size. The
   // decoded data will be placed in *output with the dimensions in *w and *h
   // on success (returns true). This data will be written in the 'format'
@@ -1126,5 +1126,80 @@ TEST(PNGCodec, EncodeDecodeWithVaryingCompressionLevels) {
   ASSERT_TRUE(original == decoded);
 }
 
+TEST(PNGCodec, EncodeDecodeWithOptions) {
+  const int w = 20, h = 20;
+
+  // Opaque, so that discarding the transparency loses nothing.
+  std::vector<unsigned char> original;
+  MakeRGBAImage(w, h, false, &original);
+
+  PNGCodec::FilterSelection filters[] = {
+    PNGCodec::FILTER_ADAPTIVE, PNGCodec::FILTER_NONE, PNGCodec::FILTER_SUB,
+    PNGCodec::FILTER_UP, PNGCodec::FILTER_PAETH
+  };
+  PNGCodec::CompressionStrategy strategies[] = {
+    PNGCodec::STRATEGY_DEFAULT, PNGCodec::STRATEGY_FILTERED,
+    PNGCodec::STRATEGY_HUFFMAN_ONLY, PNGCodec::STRATEGY_RLE
+  };
+  for (size_t f = 0; f < arraysize(filters); ++f) {
+    for (size_t s = 0; s < arraysize(strategies); ++s) {
+      for (int discard_transparency = 0; discard_transparency < 2;
+           ++discard_transparency) {
+        PNGCodec::EncodeOptions options = PNGCodec::EncodeOptions::Fast();
+        options.filter = filters[f];
+        options.strategy = strategies[s];
+
+        std::vector<unsigned char> encoded;
+        ASSERT_TRUE(PNGCodec::EncodeWithOptions(
+            &original[0], PNGCodec::FORMAT_BGRA, Size(w, h), w * 4,
+            discard_transparency != 0, std::vector<PNGCodec::Comment>(),
+            options, &encoded));
+
+        std::vector<unsigned char> decoded;
+        int outw, outh;
+        ASSERT_TRUE(PNGCodec::Decode(&encoded[0], encoded.size(),
+                                     PNGCodec::FORMAT_BGRA, &decoded,
+                                     &outw, &outh));
+        ASSERT_EQ(w, outw);
+        ASSERT_EQ(h, outh);
+        EXPECT_TRUE(original == decoded)
+            << "filter " << filters[f] << " strategy " << strategies[s]
+            << " discard " << discard_transparency;
+      }
+    }
+  }
+}
+
+TEST(PNGCodec, EncodeOpaqueSkBitmapWithRowPadding) {
+  const int w = 20, h = 20;
+  const int row_bytes = (w + 3) * 4;
+
+  SkBitmap original_bitmap;
+  original_bitmap.setConfig(SkBitmap::kARGB_8888_Config, w, h, row_bytes);
+  original_bitmap.allocPixels();
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++)
+      *original_bitmap.getAddr32(x, y) = SkPackARGB32(255, x * 12, y * 12, 7);
+  }
+  original_bitmap.setIsOpaque(true);
+
+  std::vector<unsigned char> encoded;
+  ASSERT_TRUE(PNGCodec::EncodeBGRASkBitmapWithOptions(
+      original_bitmap, false, PNGCodec::EncodeOptions::Fast(), &encoded));
+
+  SkBitmap decoded_bitmap;
+  ASSERT_TRUE(PNGCodec::Decode(&encoded.front(), encoded.size(),
+                               &decoded_bitmap));
+  ASSERT_EQ(w, decoded_bitmap.width());
+  ASSERT_EQ(h, decoded_bitmap.height());
+
+  // Opaque pixels go through unchanged, the padding is not encoded.
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      EXPECT_EQ(*original_bitmap.getAddr32(x, y),
+                *decoded_bitmap.getAddr32(x, y));
+    }
+  }
+}
 
 }  // namespace gfx
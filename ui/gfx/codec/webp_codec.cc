@@ -0,0 +1,90 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/codec/webp_codec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/logging.h"
+#include "third_party/libwebp/webp/decode.h"
+#include "third_party/libwebp/webp/encode.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkColorPriv.h"
+
+namespace gfx {
+
+namespace {
+
+// Returns true if pixels in |format| are in RGBA order in memory, and false if
+// they are in BGRA order.
+bool IsRGBAOrder(WebPCodec::ColorFormat format) {
+  if (format == WebPCodec::FORMAT_SkBitmap)
+    return SK_R32_SHIFT == 0;
+  return format == WebPCodec::FORMAT_RGBA;
+}
+
+}  // namespace
+
+// static
+bool WebPCodec::Encode(const unsigned char* input, ColorFormat format,
+                       int w, int h, int row_byte_width,
+                       int quality, std::vector<unsigned char>* output) {
+  output->clear();
+  if (w <= 0 || h <= 0 || row_byte_width < w * 4)
+    return false;
+
+  // libwebp allocates the output with malloc().
+  uint8_t* data = NULL;
+  size_t size;
+  if (IsRGBAOrder(format)) {
+    size = WebPEncodeRGBA(input, w, h, row_byte_width,
+                          static_cast<float>(quality), &data);
+  } else {
+    size = WebPEncodeBGRA(input, w, h, row_byte_width,
+                          static_cast<float>(quality), &data);
+  }
+  if (!size) {
+    free(data);
+    return false;
+  }
+  output->assign(data, data + size);
+  free(data);
+  return true;
+}
+
+// static
+bool WebPCodec::Decode(const unsigned char* input, size_t input_size,
+                       ColorFormat format, std::vector<unsigned char>* output,
+                       int* w, int* h) {
+  uint8_t* data;
+  if (IsRGBAOrder(format))
+    data = WebPDecodeRGBA(input, static_cast<uint32_t>(input_size), w, h);
+  else
+    data = WebPDecodeBGRA(input, static_cast<uint32_t>(input_size), w, h);
+  if (!data)
+    return false;
+
+  output->assign(data, data + *w * *h * 4);
+  free(data);
+  return true;
+}
+
+// static
+SkBitmap* WebPCodec::Decode(const unsigned char* input, size_t input_size) {
+  int w, h;
+  std::vector<unsigned char> data_vector;
+  if (!Decode(input, input_size, FORMAT_SkBitmap, &data_vector, &w, &h))
+    return NULL;
+
+  SkBitmap* bitmap = new SkBitmap();
+  bitmap->setConfig(SkBitmap::kARGB_8888_Config, w, h);
+  bitmap->allocPixels();
+  memcpy(bitmap->getAddr32(0, 0), &data_vector[0], w * h * 4);
+  bitmap->setIsOpaque(true);
+
+  return bitmap;
+}
+
+}  // namespace gfx
@@ -0,0 +1,125 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <math.h>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/codec/webp_codec.h"
+
+namespace gfx {
+
+namespace {
+
+const int kWebPQuality = 90;
+
+// The threshold of average color differences where we consider two images
+// equal. WebP stores the colors at half resolution, so this is a little looser
+// than for JPEG.
+const double kWebPEqualityThreshold = 3.0;
+
+// Computes the average difference between each value in a and b.
+double AveragePixelDelta(const std::vector<unsigned char>& a,
+                         const std::vector<unsigned char>& b) {
+  if (a.size() != b.size())
+    return 255.0;
+  if (a.empty())
+    return 0;
+
+  double acc = 0.0;
+  for (size_t i = 0; i < a.size(); i++)
+    acc += fabs(static_cast<double>(a[i]) - static_cast<double>(b[i]));
+
+  return acc / static_cast<double>(a.size());
+}
+
+// Makes an opaque image, as the alpha channel is lost during compression.
+void MakeRGBAImage(int w, int h, std::vector<unsigned char>* dat) {
+  dat->resize(w * h * 4);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      unsigned char* org_px = &(*dat)[(y * w + x) * 4];
+      org_px[0] = x * 3;      // r
+      org_px[1] = x * 3 + 1;  // g
+      org_px[2] = x * 3 + 2;  // b
+      org_px[3] = 0xFF;       // a
+    }
+  }
+}
+
+}  // namespace
+
+TEST(WebPCodec, EncodeDecodeRGBA) {
+  int w = 20, h = 20;
+  std::vector<unsigned char> original;
+  MakeRGBAImage(w, h, &original);
+
+  // encode, making sure it was compressed some
+  std::vector<unsigned char> encoded;
+  EXPECT_TRUE(WebPCodec::Encode(&original[0], WebPCodec::FORMAT_RGBA, w, h,
+                                w * 4, kWebPQuality, &encoded));
+  EXPECT_GT(original.size(), encoded.size());
+
+  // decode, it should have the same size as the original
+  std::vector<unsigned char> decoded;
+  int outw, outh;
+  ASSERT_TRUE(WebPCodec::Decode(&encoded[0], encoded.size(),
+                                WebPCodec::FORMAT_RGBA, &decoded,
+                                &outw, &outh));
+  ASSERT_EQ(w, outw);
+  ASSERT_EQ(h, outh);
+  ASSERT_EQ(original.size(), decoded.size());
+  EXPECT_GE(kWebPEqualityThreshold, AveragePixelDelta(original, decoded));
+
+  // The same pixels in BGRA order decode to the same image.
+  std::vector<unsigned char> decoded_bgra;
+  ASSERT_TRUE(WebPCodec::Decode(&encoded[0], encoded.size(),
+                                WebPCodec::FORMAT_BGRA, &decoded_bgra,
+                                &outw, &outh));
+  ASSERT_EQ(decoded.size(), decoded_bgra.size());
+  for (size_t i = 0; i < decoded.size(); i += 4) {
+    EXPECT_EQ(decoded[i], decoded_bgra[i + 2]);
+    EXPECT_EQ(decoded[i + 1], decoded_bgra[i + 1]);
+    EXPECT_EQ(decoded[i + 2], decoded_bgra[i]);
+  }
+}
+
+TEST(WebPCodec, DecodeToBitmap) {
+  int w = 16, h = 8;
+  std::vector<unsigned char> original;
+  MakeRGBAImage(w, h, &original);
+  std::vector<unsigned char> encoded;
+  ASSERT_TRUE(WebPCodec::Encode(&original[0], WebPCodec::FORMAT_RGBA, w, h,
+                                w * 4, kWebPQuality, &encoded));
+
+  scoped_ptr<SkBitmap> bitmap(WebPCodec::Decode(&encoded[0], encoded.size()));
+  ASSERT_TRUE(bitmap.get());
+  EXPECT_EQ(w, bitmap->width());
+  EXPECT_EQ(h, bitmap->height());
+}
+
+// Test that corrupted data decompression causes failures.
+TEST(WebPCodec, DecodeCorrupted) {
+  int w = 20, h = 20;
+  std::vector<unsigned char> original;
+  MakeRGBAImage(w, h, &original);
+
+  // it should fail when given non-WebP data
+  std::vector<unsigned char> output;
+  int outw, outh;
+  EXPECT_FALSE(WebPCodec::Decode(&original[0], original.size(),
+                                 WebPCodec::FORMAT_RGBA, &output,
+                                 &outw, &outh));
+
+  // or just the start of a WebP file
+  std::vector<unsigned char> compressed;
+  ASSERT_TRUE(WebPCodec::Encode(&original[0], WebPCodec::FORMAT_RGBA, w, h,
+                                w * 4, kWebPQuality, &compressed));
+  EXPECT_FALSE(WebPCodec::Decode(&compressed[0], 12, WebPCodec::FORMAT_RGBA,
+                                 &output, &outw, &outh));
+}
+
+}  // namespace gfx
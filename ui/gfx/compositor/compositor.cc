@@ -5,6 +5,7 @@
 #include "ui/gfx/compositor/compositor.h"
 
 #include "base/command_line.h"
+#include "base/debug/trace_event.h"
 #include "base/threading/thread_restrictions.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/WebCompositor.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebFloatPoint.h"
@@ -135,8 +136,9 @@ Compositor::Compositor(CompositorDelegate* delegate,
       command_line->HasSwitch(switches::kUIShowLayerTree);
   settings.refreshRate = test_compositor_enabled ?
       kTestRefreshRate : kDefaultRefreshRate;
+  // The swap is only partial when the GL surface supports PostSubBuffer.
   settings.partialSwapEnabled =
-      command_line->HasSwitch(switches::kUIEnablePartialSwap);
+      !command_line->HasSwitch(switches::kUIDisablePartialSwap);
   settings.perTilePainting =
     command_line->HasSwitch(switches::kUIEnablePerTilePainting);
 
@@ -198,6 +200,7 @@ void Compositor::Draw(bool force_clear) {
   if (!root_layer_)
     return;
 
+  TRACE_EVENT0("ui", "Compositor::Draw");
   // TODO(nduca): Temporary while compositor calls
   // compositeImmediately() directly.
   layout();
@@ -271,8 +274,12 @@ void Compositor::updateAnimations(double frameBeginTime) {
 }
 
 void Compositor::layout() {
-  if (root_layer_)
-    root_layer_->SendDamagedRects();
+  if (!root_layer_)
+    return;
+  // The pixels repainted this frame. Unless a layer moved or changed opacity,
+  // only these are redrawn and, with partial swap, swapped.
+  TRACE_COUNTER1("ui", "Compositor::DamagedPixels",
+                 root_layer_->SendDamagedRects());
 }
 
 void Compositor::applyScrollAndScale(const WebKit::WebSize& scrollDelta,
@@ -10,7 +10,8 @@ const char kDisableTestCompositor[] = "disable-test-compositor";
 
 const char kDisableUIVsync[] = "disable-ui-vsync";
 
-const char kUIEnablePartialSwap[] = "ui-enable-partial-swap";
+// Swap the whole frame even where only part of it was redrawn.
+const char kUIDisablePartialSwap[] = "ui-disable-partial-swap";
 
 // Show FPS counter.
 const char kUIShowFPSCounter[] = "ui-show-fps-counter";
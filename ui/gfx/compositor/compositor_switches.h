@@ -12,7 +12,7 @@ namespace switches {
 
 COMPOSITOR_EXPORT extern const char kDisableTestCompositor[];
 COMPOSITOR_EXPORT extern const char kDisableUIVsync[];
-COMPOSITOR_EXPORT extern const char kUIEnablePartialSwap[];
+COMPOSITOR_EXPORT extern const char kUIDisablePartialSwap[];
 COMPOSITOR_EXPORT extern const char kUIShowFPSCounter[];
 COMPOSITOR_EXPORT extern const char kUIShowLayerBorders[];
 COMPOSITOR_EXPORT extern const char kUIShowLayerTree[];
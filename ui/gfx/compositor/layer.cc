@@ -29,6 +29,11 @@ namespace {
 
 const float EPSILON = 1e-3f;
 
+// The most rects the damage of a layer is kept as before it is merged into
+// their bounds. Each rect costs a paint pass over the views beneath it, so
+// many small ones are slower than one covering them all.
+const int kMaxDamagedRects = 8;
+
 bool IsApproximateMultipleOf(float value, float base) {
   float remainder = fmod(fabs(value), base);
   return remainder < EPSILON || base - remainder < EPSILON;
@@ -302,6 +307,13 @@ bool Layer::SchedulePaint(const gfx::Rect& invalid_rect) {
                      invalid_rect.right(),
                      invalid_rect.bottom(),
                      SkRegion::kUnion_Op);
+  int rect_count = 0;
+  for (SkRegion::Iterator iter(damaged_region_);
+       !iter.done() && rect_count <= kMaxDamagedRects; iter.next()) {
+    ++rect_count;
+  }
+  if (rect_count > kMaxDamagedRects)
+    damaged_region_.setRect(damaged_region_.getBounds());
   ScheduleDraw();
   return true;
 }
@@ -312,11 +324,15 @@ void Layer::ScheduleDraw() {
     compositor->ScheduleDraw();
 }
 
-void Layer::SendDamagedRects() {
+int Layer::SendDamagedRects() {
+  int damaged_pixels = 0;
   if (delegate_ && !damaged_region_.isEmpty()) {
+    damaged_region_.op(0, 0, bounds_.width(), bounds_.height(),
+                       SkRegion::kIntersect_Op);
     for (SkRegion::Iterator iter(damaged_region_);
          !iter.done(); iter.next()) {
       const SkIRect& damaged = iter.rect();
+      damaged_pixels += damaged.width() * damaged.height();
       WebKit::WebFloatRect web_rect(
           damaged.x(),
           damaged.y(),
@@ -331,7 +347,8 @@ void Layer::SendDamagedRects() {
     damaged_region_.setEmpty();
   }
   for (size_t i = 0; i < children_.size(); ++i)
-    children_[i]->SendDamagedRects();
+    damaged_pixels += children_[i]->SendDamagedRects();
+  return damaged_pixels;
 }
 
 void Layer::SuppressPaint() {
@@ -186,8 +186,10 @@ class COMPOSITOR_EXPORT Layer :
   void ScheduleDraw();
 
   // Sends damaged rectangles recorded in |damaged_region_| to
-  // |compostior_| to repaint the content.
-  void SendDamagedRects();
+  // |compostior_| to repaint the content, for this layer and its descendants.
+  // Damage outside the bounds of a layer is dropped. Returns the number of
+  // pixels damaged.
+  int SendDamagedRects();
 
   // Suppresses painting the content by disgarding damaged region and ignoring
   // new paint requests.
@@ -277,7 +279,7 @@ class COMPOSITOR_EXPORT Layer :
   bool layer_updated_externally_;
 
   // Union of damaged rects to be used when compositor is ready to
-  // paint the content.
+  // paint the content. Merged into its bounds once it has too many rects.
   SkRegion damaged_region_;
 
   float opacity_;
@@ -7,6 +7,7 @@
 #include "base/debug/trace_event.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/metrics/histogram.h"
 #include "ui/base/animation/animation_container.h"
 #include "ui/gfx/compositor/compositor.h"
 #include "ui/gfx/compositor/layer.h"
@@ -26,6 +27,11 @@ static const base::TimeDelta kDefaultTransitionDuration =
 static const base::TimeDelta kTimerInterval =
     base::TimeDelta::FromMilliseconds(10);
 
+// The frame interval of a 60Hz display, against which dropped frames are
+// counted.
+static const base::TimeDelta kFrameInterval =
+    base::TimeDelta::FromMicroseconds(16667);
+
 } // namespace;
 
 // LayerAnimator public --------------------------------------------------------
@@ -36,6 +42,8 @@ LayerAnimator::LayerAnimator(base::TimeDelta transition_duration)
       transition_duration_(transition_duration),
       tween_type_(Tween::LINEAR),
       is_started_(false),
+      has_stepped_(false),
+      dropped_frames_(0),
       disable_timer_for_test_(false) {
 }
 
@@ -248,6 +256,11 @@ bool LayerAnimator::HasAnimation(LayerAnimationSequence* sequence) const {
 void LayerAnimator::Step(base::TimeTicks now) {
   TRACE_EVENT0("ui", "LayerAnimator::Step");
 
+  // Every display frame that passed without a step showed a stale state.
+  if (has_stepped_ && now - last_step_time_ > kFrameInterval)
+    dropped_frames_ += static_cast<int>((now - last_step_time_) /
+                                        kFrameInterval);
+  has_stepped_ = true;
   last_step_time_ = now;
   // We need to make a copy of the running animations because progressing them
   // and finishing them may indirectly affect the collection of running
@@ -279,6 +292,9 @@ base::TimeDelta LayerAnimator::GetTimerInterval() const {
 }
 
 void LayerAnimator::UpdateAnimationState() {
+  if (!is_animating() && has_stepped_)
+    ReportDroppedFrames();
+
   if (disable_timer_for_test_)
     return;
 
@@ -297,6 +313,15 @@ void LayerAnimator::UpdateAnimationState() {
   is_started_ = should_start;
 }
 
+void LayerAnimator::ReportDroppedFrames() {
+  UMA_HISTOGRAM_COUNTS_100("Compositor.LayerAnimator.DroppedFrames",
+                           dropped_frames_);
+  TRACE_EVENT_INSTANT1("ui", "LayerAnimator::DroppedFrames",
+                       "frames", dropped_frames_);
+  has_stepped_ = false;
+  dropped_frames_ = 0;
+}
+
 LayerAnimationSequence* LayerAnimator::RemoveAnimation(
     LayerAnimationSequence* sequence) {
   linked_ptr<LayerAnimationSequence> to_return;
@@ -135,6 +135,7 @@ class COMPOSITOR_EXPORT LayerAnimator : public AnimationContainerElement {
     disable_timer_for_test_ = disable_timer;
   }
   base::TimeTicks last_step_time() const { return last_step_time_; }
+  int dropped_frames() const { return dropped_frames_; }
 
   // When set to true, all animations complete immediately.
   static void set_disable_animations_for_test(bool disable_animations) {
@@ -181,6 +182,10 @@ class COMPOSITOR_EXPORT LayerAnimator : public AnimationContainerElement {
   // Starts or stops stepping depending on whether thare are running animations.
   void UpdateAnimationState();
 
+  // Records the frames dropped since the animator started animating, once it
+  // stops.
+  void ReportDroppedFrames();
+
   // Removes the sequences from both the running animations and the queue.
   // Returns a pointer to the removed animation, if any. NOTE: the caller is
   // responsible for deleting the returned pointer.
@@ -265,6 +270,12 @@ class COMPOSITOR_EXPORT LayerAnimator : public AnimationContainerElement {
   // True if we are being stepped by our container.
   bool is_started_;
 
+  // True once the animator has stepped since it started animating, and the
+  // number of display frames it has missed since then because the UI thread
+  // didn't step it in time.
+  bool has_stepped_;
+  int dropped_frames_;
+
   // This prevents the animator from automatically stepping through animations
   // and allows for manual stepping.
   bool disable_timer_for_test_;
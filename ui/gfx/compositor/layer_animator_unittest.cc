@@ -215,6 +215,34 @@ TEST(LayerAnimatorTest, ScheduleAnimationThatCanRunImmediately) {
   EXPECT_FLOAT_EQ(delegate.GetOpacityForAnimation(), target_opacity);
 }
 
+// Checks that display frames missed between steps are counted until the
+// animation ends.
+TEST(LayerAnimatorTest, CountsDroppedFrames) {
+  scoped_ptr<LayerAnimator> animator(LayerAnimator::CreateDefaultAnimator());
+  AnimationContainerElement* element = animator.get();
+  animator->set_disable_timer_for_test(true);
+  TestLayerAnimationDelegate delegate;
+  animator->SetDelegate(&delegate);
+
+  animator->ScheduleAnimation(
+      new LayerAnimationSequence(
+          LayerAnimationElement::CreateOpacityElement(
+              1.0, base::TimeDelta::FromSeconds(1))));
+
+  base::TimeTicks start_time = animator->last_step_time();
+  element->Step(start_time + base::TimeDelta::FromMilliseconds(10));
+  EXPECT_EQ(0, animator->dropped_frames());
+
+  // A step 100ms late misses five frames of a 60Hz display.
+  element->Step(start_time + base::TimeDelta::FromMilliseconds(110));
+  EXPECT_EQ(5, animator->dropped_frames());
+
+  // The count is reported and reset when the animation ends.
+  element->Step(start_time + base::TimeDelta::FromMilliseconds(1000));
+  EXPECT_FALSE(animator->is_animating());
+  EXPECT_EQ(0, animator->dropped_frames());
+}
+
 // Schedule two animations on separate properties. Both animations should
 // start immediately and should progress in lock step.
 TEST(LayerAnimatorTest, ScheduleTwoAnimationsThatCanRunImmediately) {
@@ -986,6 +986,37 @@ class SchedulePaintLayerDelegate : public LayerDelegate {
 
 }  // namespace
 
+// Verifies that damage is clipped to the bounds of each layer and counted for
+// the whole tree.
+TEST_F(LayerWithDelegateTest, SendDamagedRects) {
+  scoped_ptr<Layer> root(CreateColorLayer(SK_ColorRED,
+                                          gfx::Rect(0, 0, 500, 500)));
+  scoped_ptr<Layer> child(CreateColorLayer(SK_ColorBLUE,
+                                           gfx::Rect(0, 0, 200, 200)));
+  root->Add(child.get());
+  compositor()->SetRootLayer(root.get());
+
+  root->SchedulePaint(gfx::Rect(0, 0, 10, 10));
+  child->SchedulePaint(gfx::Rect(150, 150, 100, 100));
+  EXPECT_EQ(10 * 10 + 50 * 50, root->SendDamagedRects());
+  EXPECT_EQ(0, root->SendDamagedRects());
+}
+
+// Verifies that damage made of many rects is merged into their bounds.
+TEST_F(LayerWithDelegateTest, ManyDamagedRectsAreMerged) {
+  scoped_ptr<Layer> root(CreateColorLayer(SK_ColorRED,
+                                          gfx::Rect(0, 0, 500, 500)));
+  compositor()->SetRootLayer(root.get());
+
+  for (int i = 0; i < 4; ++i)
+    root->SchedulePaint(gfx::Rect(i * 20, 0, 10, 10));
+  EXPECT_EQ(4 * 10 * 10, root->SendDamagedRects());
+
+  for (int i = 0; i < 20; ++i)
+    root->SchedulePaint(gfx::Rect(i * 20, 0, 10, 10));
+  EXPECT_EQ(390 * 10, root->SendDamagedRects());
+}
+
 // Verifies that if SchedulePaint is invoked during painting the layer is still
 // marked dirty.
 TEST_F(LayerWithDelegateTest, SchedulePaintFromOnPaintLayer) {
@@ -295,6 +295,10 @@ GL_FUNCTIONS = [
 { 'return_type': 'void',
   'names': ['glGetIntegerv'],
   'arguments': 'GLenum pname, GLint* params', },
+{ 'return_type': 'void',
+  'names': ['glGetProgramBinary', 'glGetProgramBinaryOES'],
+  'arguments': 'GLuint program, GLsizei bufSize, GLsizei* length, '
+               'GLenum* binaryFormat, GLvoid* binary', },
 { 'return_type': 'void',
   'names': ['glGetProgramiv'],
   'arguments': 'GLuint program, GLenum pname, GLint* params', },
@@ -423,6 +427,10 @@ GL_FUNCTIONS = [
 { 'return_type': 'void',
   'names': ['glQueryCounter'],
   'arguments': 'GLuint id, GLenum target', },
+{ 'return_type': 'void',
+  'names': ['glProgramBinary', 'glProgramBinaryOES'],
+  'arguments': 'GLuint program, GLenum binaryFormat, '
+               'const GLvoid* binary, GLsizei length', },
 { 'return_type': 'void',
   'names': ['glReadBuffer'],
   'arguments': 'GLenum src', },
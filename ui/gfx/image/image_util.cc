@@ -8,6 +8,7 @@
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "ui/gfx/codec/jpeg_codec.h"
 #include "ui/gfx/codec/png_codec.h"
+#include "ui/gfx/codec/webp_codec.h"
 #include "ui/gfx/image/image.h"
 
 namespace gfx {
@@ -28,15 +29,21 @@ bool PNGEncodedDataFromImage(const Image& image,
 
 bool JPEGEncodedDataFromImage(const Image& image, int quality,
                               std::vector<unsigned char>* dst) {
+  return gfx::JPEGCodec::EncodeSkBitmap(*image.ToSkBitmap(), quality,
+                                        gfx::JPEGCodec::EncodeOptions(), dst);
+}
+
+bool WebPEncodedDataFromImage(const Image& image, int quality,
+                              std::vector<unsigned char>* dst) {
   const SkBitmap& bitmap = *image.ToSkBitmap();
   SkAutoLockPixels bitmap_lock(bitmap);
 
   if (!bitmap.readyToDraw())
     return false;
 
-  return gfx::JPEGCodec::Encode(
+  return gfx::WebPCodec::Encode(
           reinterpret_cast<unsigned char*>(bitmap.getAddr32(0, 0)),
-          gfx::JPEGCodec::FORMAT_BGRA, bitmap.width(),
+          gfx::WebPCodec::FORMAT_SkBitmap, bitmap.width(),
           bitmap.height(),
           static_cast<int>(bitmap.rowBytes()), quality,
           dst);
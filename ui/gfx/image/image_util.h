@@ -34,6 +34,13 @@ UI_EXPORT bool JPEGEncodedDataFromImage(const Image& image,
                                         int quality,
                                         std::vector<unsigned char>* dst);
 
+// Fills the |dst| vector with WebP-encoded bytes based on the given Image.
+// |quality| determines the compression level, 0 == lowest, 100 == highest.
+// Returns true if the Image was encoded successfully.
+UI_EXPORT bool WebPEncodedDataFromImage(const Image& image,
+                                        int quality,
+                                        std::vector<unsigned char>* dst);
+
 }
 
 #endif  // UI_GFX_IMAGE_IMAGE_UTIL_H_
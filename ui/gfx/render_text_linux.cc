@@ -70,6 +70,18 @@ bool IsSubpixelRenderingEnabledInFontConfig() {
   return subpixel_enabled;
 }
 
+// Returns the Pango context all the layouts are created in, rather than
+// creating a context, and a Cairo surface to get it from, every time a text
+// field is laid out again.
+PangoContext* GetSharedPangoContext() {
+  static PangoContext* context = NULL;
+  if (!context) {
+    context = pango_cairo_font_map_create_context(
+        PANGO_CAIRO_FONT_MAP(pango_cairo_font_map_get_default()));
+  }
+  return context;
+}
+
 }  // namespace
 
 // TODO(xji): index saved in upper layer is utf16 index. Pango uses utf8 index.
@@ -291,13 +303,7 @@ void RenderTextLinux::ResetLayout() {
 
 void RenderTextLinux::EnsureLayout() {
   if (layout_ == NULL) {
-    cairo_surface_t* surface =
-        cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 0, 0);
-    cairo_t* cr = cairo_create(surface);
-
-    layout_ = pango_cairo_create_layout(cr);
-    cairo_destroy(cr);
-    cairo_surface_destroy(surface);
+    layout_ = pango_layout_new(GetSharedPangoContext());
     SetupPangoLayoutWithFontDescription(
         layout_,
         GetDisplayText(),
@@ -0,0 +1,84 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times the layout and painting a text field does per keystroke and per caret
+// move, with 2000 characters of mixed left-to-right and right-to-left text.
+
+#include "base/memory/scoped_ptr.h"
+#include "base/perftimer.h"
+#include "base/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/gfx/canvas.h"
+#include "ui/gfx/render_text.h"
+
+namespace gfx {
+
+namespace {
+
+const size_t kTextLength = 2000;
+const int kNumKeystrokes = 200;
+
+// Returns |length| characters of English words with a few Hebrew ones, so the
+// text is split into several runs like a typical mixed-direction field.
+string16 MakeText(size_t length) {
+  const string16 english = ASCIIToUTF16("the quick brown fox ");
+  const string16 hebrew = WideToUTF16(L"\x05e9\x05dc\x05d5\x05dd ");
+  string16 text;
+  for (int i = 0; text.length() < length; ++i)
+    text += (i % 8 == 7) ? hebrew : english;
+  return text.substr(0, length);
+}
+
+}  // namespace
+
+class RenderTextPerfTest : public testing::Test {
+ protected:
+  RenderTextPerfTest()
+      : render_text_(RenderText::CreateRenderText()),
+        canvas_(Size(400, 30), false) {
+    render_text_->SetDisplayRect(Rect(0, 0, 400, 30));
+    render_text_->SetCursorEnabled(true);
+  }
+
+  // Lays out and paints the field, as a text field does after each change.
+  void Paint() {
+    render_text_->GetUpdatedCursorBounds();
+    render_text_->Draw(&canvas_);
+  }
+
+  scoped_ptr<RenderText> render_text_;
+  Canvas canvas_;
+};
+
+TEST_F(RenderTextPerfTest, Typing) {
+  string16 text(MakeText(kTextLength));
+  render_text_->SetText(text);
+  Paint();
+
+  // Type in the middle of the text, so that edits have runs on both sides.
+  size_t cursor = kTextLength / 2;
+  PerfTimeLogger timer("RenderText_typing");
+  for (int i = 0; i < kNumKeystrokes; ++i) {
+    text.insert(cursor++, 1, 'a' + i % 26);
+    render_text_->SetText(text);
+    render_text_->SetCursorPosition(cursor);
+    Paint();
+  }
+  timer.Done();
+  EXPECT_EQ(kTextLength + kNumKeystrokes, render_text_->text().length());
+}
+
+TEST_F(RenderTextPerfTest, CaretMovement) {
+  render_text_->SetText(MakeText(kTextLength));
+  render_text_->SetCursorPosition(0);
+  Paint();
+
+  PerfTimeLogger timer("RenderText_caret_movement");
+  for (int i = 0; i < kNumKeystrokes; ++i) {
+    render_text_->MoveCursor(CHARACTER_BREAK, CURSOR_RIGHT, i % 2 == 1);
+    Paint();
+  }
+}
+
+}  // namespace gfx
@@ -8,6 +8,7 @@
 
 #include "base/i18n/break_iterator.h"
 #include "base/logging.h"
+#include "base/memory/mru_cache.h"
 #include "base/stl_util.h"
 #include "base/string_util.h"
 #include "base/threading/thread_restrictions.h"
@@ -142,6 +143,117 @@ void DeriveFontIfNecessary(int font_size,
     *font = font->DeriveFont(font_size - current_size, font_style);
 }
 
+// The most shaped runs kept for reuse by all the RenderTextWin instances.
+const size_t kMaxShapedRuns = 512;
+
+// Identifies the shaping of a run: its text, the font it is shaped with before
+// any font substitution, and its Uniscribe analysis, which holds the script
+// and the direction.
+struct ShapingKey {
+  ShapingKey(const gfx::internal::TextRun& run, const string16& text)
+      : text(text, run.range.start(), run.range.length()),
+        font_name(run.font.GetFontName()),
+        font_size(run.font.GetFontSize()),
+        font_height(run.font.GetHeight()),
+        font_style(run.font_style),
+        script_analysis(run.script_analysis) {
+  }
+
+  bool operator<(const ShapingKey& other) const {
+    if (font_size != other.font_size)
+      return font_size < other.font_size;
+    if (font_height != other.font_height)
+      return font_height < other.font_height;
+    if (font_style != other.font_style)
+      return font_style < other.font_style;
+    int analysis = memcmp(&script_analysis, &other.script_analysis,
+                          sizeof(script_analysis));
+    if (analysis != 0)
+      return analysis < 0;
+    if (font_name != other.font_name)
+      return font_name < other.font_name;
+    return text < other.text;
+  }
+
+  string16 text;
+  std::string font_name;
+  int font_size;
+  int font_height;
+  int font_style;
+  SCRIPT_ANALYSIS script_analysis;
+};
+
+// The glyphs and placement of a shaped run, and the font and analysis they
+// were found with.
+struct ShapedRun {
+  gfx::Font font;
+  SCRIPT_ANALYSIS script_analysis;
+  std::vector<WORD> glyphs;
+  std::vector<WORD> logical_clusters;
+  std::vector<SCRIPT_VISATTR> visible_attributes;
+  std::vector<int> advance_widths;
+  std::vector<GOFFSET> offsets;
+  ABC abc_widths;
+};
+
+typedef base::OwningMRUCache<ShapingKey, ShapedRun*> ShapedRunCache;
+
+ShapedRunCache* GetShapedRunCache() {
+  CR_DEFINE_STATIC_LOCAL(ShapedRunCache, cache, (kMaxShapedRuns));
+  return &cache;
+}
+
+template <typename T>
+void CopyToArray(const std::vector<T>& source, scoped_array<T>* dest) {
+  dest->reset(new T[std::max<size_t>(source.size(), 1)]);
+  std::copy(source.begin(), source.end(), dest->get());
+}
+
+template <typename T>
+void CopyToVector(const T* source, size_t count, std::vector<T>* dest) {
+  dest->assign(source, source + count);
+}
+
+// Gives |run| the glyphs of an earlier run with the same |key|, if any are
+// cached. Returns false otherwise.
+bool LoadShapedRun(const ShapingKey& key, gfx::internal::TextRun* run) {
+  ShapedRunCache* cache = GetShapedRunCache();
+  ShapedRunCache::iterator it = cache->Get(key);
+  if (it == cache->end())
+    return false;
+
+  const ShapedRun* shaped = it->second;
+  run->font = shaped->font;
+  run->script_analysis = shaped->script_analysis;
+  run->glyph_count = static_cast<int>(shaped->glyphs.size());
+  CopyToArray(shaped->glyphs, &run->glyphs);
+  CopyToArray(shaped->logical_clusters, &run->logical_clusters);
+  CopyToArray(shaped->visible_attributes, &run->visible_attributes);
+  CopyToArray(shaped->advance_widths, &run->advance_widths);
+  CopyToArray(shaped->offsets, &run->offsets);
+  run->abc_widths = shaped->abc_widths;
+  return true;
+}
+
+// Caches the glyphs of the shaped |run| under |key|.
+void SaveShapedRun(const ShapingKey& key, const gfx::internal::TextRun& run) {
+  ShapedRun* shaped = new ShapedRun;
+  shaped->font = run.font;
+  shaped->script_analysis = run.script_analysis;
+  CopyToVector(run.glyphs.get(), run.glyph_count, &shaped->glyphs);
+  CopyToVector(run.logical_clusters.get(), run.range.length(),
+               &shaped->logical_clusters);
+  CopyToVector(run.visible_attributes.get(), run.glyph_count,
+               &shaped->visible_attributes);
+  if (run.glyph_count > 0) {
+    CopyToVector(run.advance_widths.get(), run.glyph_count,
+                 &shaped->advance_widths);
+    CopyToVector(run.offsets.get(), run.glyph_count, &shaped->offsets);
+  }
+  shaped->abc_widths = run.abc_widths;
+  GetShapedRunCache()->Put(key, shaped);
+}
+
 }  // namespace
 
 namespace gfx {
@@ -605,141 +717,19 @@ void RenderTextWin::LayoutVisualText() {
   if (!cached_hdc_)
     cached_hdc_ = CreateCompatibleDC(NULL);
 
-  HRESULT hr = E_FAIL;
   string_size_.set_height(0);
   for (size_t i = 0; i < runs_.size(); ++i) {
     internal::TextRun* run = runs_[i];
-    const size_t run_length = run->range.length();
-    const wchar_t* run_text = &(text()[run->range.start()]);
-    bool tried_cached_font = false;
-    bool tried_fallback = false;
-    size_t linked_font_index = 0;
-    const std::vector<Font>* linked_fonts = NULL;
-    Font original_font = run->font;
-
-    // Select the font desired for glyph generation.
-    SelectObject(cached_hdc_, run->font.GetNativeFont());
-
-    run->logical_clusters.reset(new WORD[run_length]);
-    run->glyph_count = 0;
-    // Max glyph guess: http://msdn.microsoft.com/en-us/library/dd368564.aspx
-    size_t max_glyphs = static_cast<size_t>(1.5 * run_length + 16);
-    while (max_glyphs < kMaxGlyphs) {
-      run->glyphs.reset(new WORD[max_glyphs]);
-      run->visible_attributes.reset(new SCRIPT_VISATTR[max_glyphs]);
-      hr = ScriptShape(cached_hdc_,
-                       &run->script_cache,
-                       run_text,
-                       run_length,
-                       max_glyphs,
-                       &(run->script_analysis),
-                       run->glyphs.get(),
-                       run->logical_clusters.get(),
-                       run->visible_attributes.get(),
-                       &(run->glyph_count));
-      if (hr == E_OUTOFMEMORY) {
-        max_glyphs *= 2;
-        continue;
-      }
-
-      bool glyphs_missing = false;
-      if (hr == USP_E_SCRIPT_NOT_IN_FONT) {
-        glyphs_missing = true;
-      } else if (hr == S_OK) {
-        // If |hr| is S_OK, there could still be missing glyphs in the output,
-        // see: http://msdn.microsoft.com/en-us/library/windows/desktop/dd368564.aspx
-        glyphs_missing = HasMissingGlyphs(run);
-      }
-
-      // Skip font substitution if there are no missing glyphs.
-      if (!glyphs_missing) {
-        // Save the successful fallback font that was chosen.
-        if (tried_fallback)
-          successful_substitute_fonts_[original_font.GetFontName()] = run->font;
-        break;
-      }
-
-      // First, try the cached font from previous runs, if any.
-      if (!tried_cached_font) {
-        tried_cached_font = true;
-        std::map<std::string, Font>::const_iterator it =
-            successful_substitute_fonts_.find(original_font.GetFontName());
-        if (it != successful_substitute_fonts_.end()) {
-          ApplySubstituteFont(run, it->second);
-          continue;
-        }
-      }
-
-      // If there are missing glyphs, first try finding a fallback font using a
-      // meta file, if it hasn't yet been attempted for this run.
-      // TODO(msw|asvitkine): Support RenderText's font_list()?
-      // TODO(msw|asvitkine): Cache previous successful replacement fonts?
-      if (!tried_fallback) {
-        tried_fallback = true;
-
-        Font fallback_font;
-        if (ChooseFallbackFont(cached_hdc_, run->font, run_text, run_length,
-                               &fallback_font)) {
-          ApplySubstituteFont(run, fallback_font);
-          continue;
-        }
-      }
-
-      // The meta file approach did not yield a replacement font, try to find
-      // one using font linking. First time through, get the linked fonts list.
-      if (linked_fonts == NULL) {
-        // First, try to get the list for the original font.
-        linked_fonts = GetLinkedFonts(original_font);
-
-        // If there are no linked fonts for the original font, try querying the
-        // ones for the Uniscribe fallback font. This may happen if the first
-        // font is a custom font that has no linked fonts in the Registry.
-        //
-        // Note: One possibility would be to always merge both lists of fonts,
-        //       but it is not clear whether there are any real world scenarios
-        //       where this would actually help.
-        if (linked_fonts->empty())
-          linked_fonts = GetLinkedFonts(run->font);
-      }
-
-      // None of the linked fonts worked, break out of the loop.
-      if (linked_font_index == linked_fonts->size()) {
-        // TODO(msw): Don't use SCRIPT_UNDEFINED. Apparently Uniscribe can
-        //            crash on certain surrogate pairs with SCRIPT_UNDEFINED.
-        //            See https://bugzilla.mozilla.org/show_bug.cgi?id=341500
-        //            And http://maxradi.us/documents/uniscribe/
-        run->script_analysis.eScript = SCRIPT_UNDEFINED;
-        // Reset |hr| to 0 to not trigger the DCHECK() below when a font is
-        // not found that can display the text. This is expected behavior
-        // under Windows XP without additional language packs installed and
-        // may also happen on newer versions when trying to display text in
-        // an obscure script that the system doesn't have the right font for.
-        hr = 0;
-        break;
-      }
-
-      // Try the next linked font.
-      ApplySubstituteFont(run, linked_fonts->at(linked_font_index++));
+    // Runs left unchanged by an edit, or split only by a style which does
+    // not affect shaping such as the selection color, reuse their glyphs.
+    ShapingKey key(*run, text());
+    if (!LoadShapedRun(key, run)) {
+      ShapeRun(run);
+      SaveShapedRun(key, *run);
     }
-    DCHECK(SUCCEEDED(hr));
     string_size_.set_height(std::max(string_size_.height(),
                                      run->font.GetHeight()));
     common_baseline_ = std::max(common_baseline_, run->font.GetBaseline());
-
-    if (run->glyph_count > 0) {
-      run->advance_widths.reset(new int[run->glyph_count]);
-      run->offsets.reset(new GOFFSET[run->glyph_count]);
-      hr = ScriptPlace(cached_hdc_,
-                       &run->script_cache,
-                       run->glyphs.get(),
-                       run->glyph_count,
-                       run->visible_attributes.get(),
-                       &(run->script_analysis),
-                       run->advance_widths.get(),
-                       run->offsets.get(),
-                       &(run->abc_widths));
-      DCHECK(SUCCEEDED(hr));
-    }
   }
 
   // Build the array of bidirectional embedding levels.
@@ -750,10 +740,10 @@ void RenderTextWin::LayoutVisualText() {
   // Get the maps between visual and logical run indices.
   visual_to_logical_.reset(new int[runs_.size()]);
   logical_to_visual_.reset(new int[runs_.size()]);
-  hr = ScriptLayout(runs_.size(),
-                    levels.get(),
-                    visual_to_logical_.get(),
-                    logical_to_visual_.get());
+  HRESULT hr = ScriptLayout(runs_.size(),
+                            levels.get(),
+                            visual_to_logical_.get(),
+                            logical_to_visual_.get());
   DCHECK(SUCCEEDED(hr));
 
   // Precalculate run width information.
@@ -768,6 +758,138 @@ void RenderTextWin::LayoutVisualText() {
   string_size_.set_width(preceding_run_widths);
 }
 
+void RenderTextWin::ShapeRun(internal::TextRun* run) {
+  HRESULT hr = E_FAIL;
+  const size_t run_length = run->range.length();
+  const wchar_t* run_text = &(text()[run->range.start()]);
+  bool tried_cached_font = false;
+  bool tried_fallback = false;
+  size_t linked_font_index = 0;
+  const std::vector<Font>* linked_fonts = NULL;
+  Font original_font = run->font;
+
+  // Select the font desired for glyph generation.
+  SelectObject(cached_hdc_, run->font.GetNativeFont());
+
+  run->logical_clusters.reset(new WORD[run_length]);
+  run->glyph_count = 0;
+  // Max glyph guess: http://msdn.microsoft.com/en-us/library/dd368564.aspx
+  size_t max_glyphs = static_cast<size_t>(1.5 * run_length + 16);
+  while (max_glyphs < kMaxGlyphs) {
+    run->glyphs.reset(new WORD[max_glyphs]);
+    run->visible_attributes.reset(new SCRIPT_VISATTR[max_glyphs]);
+    hr = ScriptShape(cached_hdc_,
+                     &run->script_cache,
+                     run_text,
+                     run_length,
+                     max_glyphs,
+                     &(run->script_analysis),
+                     run->glyphs.get(),
+                     run->logical_clusters.get(),
+                     run->visible_attributes.get(),
+                     &(run->glyph_count));
+    if (hr == E_OUTOFMEMORY) {
+      max_glyphs *= 2;
+      continue;
+    }
+
+    bool glyphs_missing = false;
+    if (hr == USP_E_SCRIPT_NOT_IN_FONT) {
+      glyphs_missing = true;
+    } else if (hr == S_OK) {
+      // If |hr| is S_OK, there could still be missing glyphs in the output,
+      // see: http://msdn.microsoft.com/en-us/library/windows/desktop/dd368564.aspx
+      glyphs_missing = HasMissingGlyphs(run);
+    }
+
+    // Skip font substitution if there are no missing glyphs.
+    if (!glyphs_missing) {
+      // Save the successful fallback font that was chosen.
+      if (tried_fallback)
+        successful_substitute_fonts_[original_font.GetFontName()] = run->font;
+      break;
+    }
+
+    // First, try the cached font from previous runs, if any.
+    if (!tried_cached_font) {
+      tried_cached_font = true;
+      std::map<std::string, Font>::const_iterator it =
+          successful_substitute_fonts_.find(original_font.GetFontName());
+      if (it != successful_substitute_fonts_.end()) {
+        ApplySubstituteFont(run, it->second);
+        continue;
+      }
+    }
+
+    // If there are missing glyphs, first try finding a fallback font using a
+    // meta file, if it hasn't yet been attempted for this run.
+    // TODO(msw|asvitkine): Support RenderText's font_list()?
+    // TODO(msw|asvitkine): Cache previous successful replacement fonts?
+    if (!tried_fallback) {
+      tried_fallback = true;
+
+      Font fallback_font;
+      if (ChooseFallbackFont(cached_hdc_, run->font, run_text, run_length,
+                             &fallback_font)) {
+        ApplySubstituteFont(run, fallback_font);
+        continue;
+      }
+    }
+
+    // The meta file approach did not yield a replacement font, try to find
+    // one using font linking. First time through, get the linked fonts list.
+    if (linked_fonts == NULL) {
+      // First, try to get the list for the original font.
+      linked_fonts = GetLinkedFonts(original_font);
+
+      // If there are no linked fonts for the original font, try querying the
+      // ones for the Uniscribe fallback font. This may happen if the first
+      // font is a custom font that has no linked fonts in the Registry.
+      //
+      // Note: One possibility would be to always merge both lists of fonts,
+      //       but it is not clear whether there are any real world scenarios
+      //       where this would actually help.
+      if (linked_fonts->empty())
+        linked_fonts = GetLinkedFonts(run->font);
+    }
+
+    // None of the linked fonts worked, break out of the loop.
+    if (linked_font_index == linked_fonts->size()) {
+      // TODO(msw): Don't use SCRIPT_UNDEFINED. Apparently Uniscribe can
+      //            crash on certain surrogate pairs with SCRIPT_UNDEFINED.
+      //            See https://bugzilla.mozilla.org/show_bug.cgi?id=341500
+      //            And http://maxradi.us/documents/uniscribe/
+      run->script_analysis.eScript = SCRIPT_UNDEFINED;
+      // Reset |hr| to 0 to not trigger the DCHECK() below when a font is
+      // not found that can display the text. This is expected behavior
+      // under Windows XP without additional language packs installed and
+      // may also happen on newer versions when trying to display text in
+      // an obscure script that the system doesn't have the right font for.
+      hr = 0;
+      break;
+    }
+
+    // Try the next linked font.
+    ApplySubstituteFont(run, linked_fonts->at(linked_font_index++));
+  }
+  DCHECK(SUCCEEDED(hr));
+
+  if (run->glyph_count > 0) {
+    run->advance_widths.reset(new int[run->glyph_count]);
+    run->offsets.reset(new GOFFSET[run->glyph_count]);
+    hr = ScriptPlace(cached_hdc_,
+                     &run->script_cache,
+                     run->glyphs.get(),
+                     run->glyph_count,
+                     run->visible_attributes.get(),
+                     &(run->script_analysis),
+                     run->advance_widths.get(),
+                     run->offsets.get(),
+                     &(run->abc_widths));
+    DCHECK(SUCCEEDED(hr));
+  }
+}
+
 void RenderTextWin::ApplySubstituteFont(internal::TextRun* run,
                                         const Font& font) {
   const int font_size = run->font.GetFontSize();
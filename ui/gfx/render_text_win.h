@@ -95,6 +95,12 @@ class RenderTextWin : public RenderText {
   void ItemizeLogicalText();
   void LayoutVisualText();
 
+  // Finds the glyphs of |run|, substituting fonts for missing glyphs, and
+  // places them. LayoutVisualText() only shapes the runs whose text, font and
+  // script analysis are missing from a cache shared by all instances, so
+  // edits and selection changes reshape just the runs they touch.
+  void ShapeRun(internal::TextRun* run);
+
   // Helper function to update the font on a text run after font substitution.
   void ApplySubstituteFont(internal::TextRun* run, const Font& font);
 
@@ -77,6 +77,30 @@ class ScopedCanvas {
   DISALLOW_COPY_AND_ASSIGN(ScopedCanvas);
 };
 
+// The number of Views painted by the current paint pass, and how many
+// PaintCommon() calls of the pass are on the stack.
+int painted_view_count = 0;
+int paint_pass_depth = 0;
+
+// Counts the Views painted by a paint pass, and reports the count when the
+// outermost PaintCommon() call of the pass returns.
+class ScopedPaintPass {
+ public:
+  ScopedPaintPass() {
+    ++paint_pass_depth;
+    ++painted_view_count;
+  }
+  ~ScopedPaintPass() {
+    if (--paint_pass_depth == 0) {
+      TRACE_COUNTER1("views", "View::PaintedViews", painted_view_count);
+      painted_view_count = 0;
+    }
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ScopedPaintPass);
+};
+
 // Returns the top view in |view|'s hierarchy.
 const views::View* GetHierarchyRoot(const views::View* view) {
   const views::View* root = view;
@@ -138,6 +162,7 @@ View::View()
       registered_for_visible_bounds_notification_(false),
       clip_insets_(0, 0, 0, 0),
       needs_layout_(true),
+      paint_cache_enabled_(false),
       flip_canvas_on_paint_for_rtl_ui_(false),
       paint_to_layer_(false),
       accelerator_registration_delayed_(false),
@@ -711,6 +736,11 @@ void View::SchedulePaint() {
 }
 
 void View::SchedulePaintInRect(const gfx::Rect& rect_in_dip) {
+  if (paint_cache_.get()) {
+    paint_cache_invalid_rect_ = paint_cache_invalid_rect_.Union(
+        rect_in_dip.Intersect(GetLocalBounds()));
+  }
+
   if (!visible_ || !painting_enabled_)
     return;
 
@@ -747,7 +777,23 @@ void View::Paint(gfx::Canvas* canvas) {
   canvas->Translate(GetMirroredPosition());
   canvas->Transform(GetTransform());
 
-  PaintCommon(canvas);
+  if (paint_cache_enabled_ && !layer())
+    PaintFromCache(canvas);
+  else
+    PaintCommon(canvas);
+}
+
+void View::SetPaintCacheEnabled(bool enabled) {
+  if (enabled == paint_cache_enabled_)
+    return;
+  paint_cache_enabled_ = enabled;
+  paint_cache_.reset();
+  paint_cache_invalid_rect_ = gfx::Rect();
+  if (use_acceleration_when_possible) {
+    SetPaintToLayer(enabled);
+    if (enabled)
+      layer()->SetFillsBoundsOpaquely(false);
+  }
 }
 
 ThemeProvider* View::GetThemeProvider() const {
@@ -1536,6 +1582,8 @@ void View::PaintCommon(gfx::Canvas* canvas) {
   if (!visible_ || !painting_enabled_)
     return;
 
+  ScopedPaintPass paint_pass;
+
   {
     // If the View we are about to paint requested the canvas to be flipped, we
     // should change the transform appropriately.
@@ -1554,6 +1602,30 @@ void View::PaintCommon(gfx::Canvas* canvas) {
   PaintChildren(canvas);
 }
 
+void View::PaintFromCache(gfx::Canvas* canvas) {
+  if (!visible_ || !painting_enabled_ || bounds_.IsEmpty())
+    return;
+
+  if (!paint_cache_.get() ||
+      paint_cache_->sk_canvas()->getDevice()->width() != width() ||
+      paint_cache_->sk_canvas()->getDevice()->height() != height()) {
+    paint_cache_.reset(new gfx::Canvas(size(), false));
+    paint_cache_invalid_rect_ = GetLocalBounds();
+  }
+
+  if (!paint_cache_invalid_rect_.IsEmpty()) {
+    TRACE_EVENT0("views", "View::PaintFromCache repaint");
+    ScopedCanvas scoped_canvas(paint_cache_.get());
+    paint_cache_->ClipRect(paint_cache_invalid_rect_);
+    paint_cache_->DrawColor(SK_ColorBLACK, SkXfermode::kClear_Mode);
+    paint_cache_invalid_rect_ = gfx::Rect();
+    PaintCommon(paint_cache_.get());
+  }
+
+  canvas->DrawBitmapInt(
+      paint_cache_->sk_canvas()->getDevice()->accessBitmap(false), 0, 0);
+}
+
 // Tree operations -------------------------------------------------------------
 
 void View::DoRemoveChildView(View* view,
@@ -1621,6 +1693,10 @@ void View::ViewHierarchyChangedImpl(bool register_accelerators,
                                     bool is_add,
                                     View* parent,
                                     View* child) {
+  // The cached bitmap may show a removed View, or miss an added one.
+  if (paint_cache_.get())
+    paint_cache_invalid_rect_ = GetLocalBounds();
+
   if (register_accelerators) {
     if (is_add) {
       // If you get this registration, you are part of a subtree that has been
@@ -461,6 +461,14 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // the hierarchy beneath it.
   virtual void Paint(gfx::Canvas* canvas);
 
+  // Sets whether this View and its descendants are painted once and then
+  // reused until part of them is scheduled to paint, for subtrees which
+  // rarely change such as the toolbar and bookmark bar. With accelerated
+  // compositing the View paints to a layer; otherwise it keeps a bitmap the
+  // size of its bounds. Best for Views which paint an opaque background.
+  void SetPaintCacheEnabled(bool enabled);
+  bool paint_cache_enabled() const { return paint_cache_enabled_; }
+
   // The background object is owned by this object and may be NULL.
   void set_background(Background* b) { background_.reset(b); }
   const Background* background() const { return background_.get(); }
@@ -1147,6 +1155,10 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // invoke OnPaint() on the View.
   void PaintCommon(gfx::Canvas* canvas);
 
+  // Paints the View and its descendants from the paint cache, first
+  // repainting the cached bitmap where it was invalidated.
+  void PaintFromCache(gfx::Canvas* canvas);
+
   // Tree operations -----------------------------------------------------------
 
   // Removes |view| from the hierarchy tree.  If |update_focus_cycle| is true,
@@ -1413,6 +1425,13 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // Border.
   scoped_ptr<Border> border_;
 
+  // See SetPaintCacheEnabled(). Without a layer, |paint_cache_| holds the
+  // painted View and |paint_cache_invalid_rect_| the part of it which needs to
+  // be painted again.
+  bool paint_cache_enabled_;
+  scoped_ptr<gfx::Canvas> paint_cache_;
+  gfx::Rect paint_cache_invalid_rect_;
+
   // RTL painting --------------------------------------------------------------
 
   // Indicates whether or not the gfx::Canvas object passed to View::Paint()
@@ -661,6 +661,73 @@ TEST_F(ViewTest, DISABLED_Painting) {
 }
 */
 
+namespace {
+
+class PaintCountingView : public View {
+ public:
+  PaintCountingView() : paint_count_(0) {}
+
+  int paint_count() const { return paint_count_; }
+
+  virtual void OnPaint(gfx::Canvas* canvas) OVERRIDE {
+    ++paint_count_;
+  }
+
+ private:
+  int paint_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(PaintCountingView);
+};
+
+}  // namespace
+
+// Verifies that a View with a paint cache repaints its subtree only where it
+// was scheduled to paint.
+TEST_F(ViewTest, PaintCache) {
+  bool old_use_acceleration = View::get_use_acceleration_when_possible();
+  View::set_use_acceleration_when_possible(false);
+
+  View root;
+  root.SetBounds(0, 0, 100, 100);
+  PaintCountingView* cached = new PaintCountingView;
+  cached->SetBounds(0, 0, 100, 50);
+  cached->SetPaintCacheEnabled(true);
+  root.AddChildView(cached);
+  PaintCountingView* left = new PaintCountingView;
+  left->SetBounds(0, 0, 50, 50);
+  cached->AddChildView(left);
+  PaintCountingView* right = new PaintCountingView;
+  right->SetBounds(50, 0, 50, 50);
+  cached->AddChildView(right);
+
+  gfx::Canvas canvas(gfx::Size(100, 100), false);
+  root.Paint(&canvas);
+  EXPECT_EQ(1, cached->paint_count());
+  EXPECT_EQ(1, left->paint_count());
+  EXPECT_EQ(1, right->paint_count());
+
+  // Nothing changed, so the cached bitmap is drawn.
+  root.Paint(&canvas);
+  EXPECT_EQ(1, cached->paint_count());
+  EXPECT_EQ(1, left->paint_count());
+
+  // Only the views intersecting the invalidated rect are painted again.
+  right->SchedulePaint();
+  root.Paint(&canvas);
+  EXPECT_EQ(2, cached->paint_count());
+  EXPECT_EQ(1, left->paint_count());
+  EXPECT_EQ(2, right->paint_count());
+
+  // A new size repaints everything.
+  cached->SetBounds(0, 0, 100, 60);
+  root.Paint(&canvas);
+  EXPECT_EQ(3, cached->paint_count());
+  EXPECT_EQ(2, left->paint_count());
+  EXPECT_EQ(3, right->paint_count());
+
+  View::set_use_acceleration_when_possible(old_use_acceleration);
+}
+
 #if defined(OS_WIN)
 TEST_F(ViewTest, RemoveNotification) {
 #else
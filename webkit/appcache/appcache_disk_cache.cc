@@ -255,7 +255,8 @@ int AppCacheDiskCache::Init(net::CacheType cache_type,
   create_backend_callback_ = new CreateBackendCallbackShim(this);
 
   int rv = disk_cache::CreateCacheBackend(
-      cache_type, cache_directory, cache_size, force, cache_thread, NULL,
+      cache_type, net::CACHE_BACKEND_DEFAULT, cache_directory, cache_size,
+      force, cache_thread, NULL,
       &(create_backend_callback_->backend_ptr_),
       base::Bind(&CreateBackendCallbackShim::Callback,
                  create_backend_callback_));
@@ -21,7 +21,11 @@
 namespace appcache {
 
 static const int kBufferSize = 32768;
-static const size_t kMaxConcurrentUrlFetches = 2;
+static const size_t kMaxConcurrentUrlFetches = 6;
+static const size_t kMaxConcurrentUrlFetchesPerHost = 2;
+// How far down the list of URLs to look for one on a host that isn't already
+// at its limit.
+static const size_t kMaxUrlFetchLookahead = 64;
 static const int kMax503Retries = 3;
 
 // Helper class for collecting hosts per frontend when sending notifications
@@ -929,12 +933,24 @@ void AppCacheUpdateJob::FetchUrls() {
   DCHECK(internal_state_ == DOWNLOADING);
 
   // Fetch each URL in the list according to section 6.9.4 step 17.1-17.3.
-  // Fetch up to the concurrent limit. Other fetches will be triggered as each
-  // each fetch completes.
-  while (pending_url_fetches_.size() < kMaxConcurrentUrlFetches &&
-         !urls_to_fetch_.empty()) {
-    UrlToFetch url_to_fetch = urls_to_fetch_.front();
-    urls_to_fetch_.pop_front();
+  // Fetch up to the concurrent limits. URLs on hosts that are at their limit
+  // wait while those on other hosts go ahead, so that manifests spread over
+  // several hosts are fetched in parallel without any one host getting more
+  // than its share. Other fetches will be triggered as each fetch completes.
+  while (pending_url_fetches_.size() < kMaxConcurrentUrlFetches) {
+    std::deque<UrlToFetch>::iterator next = urls_to_fetch_.begin();
+    std::deque<UrlToFetch>::iterator last =
+        urls_to_fetch_.size() > kMaxUrlFetchLookahead ?
+            next + kMaxUrlFetchLookahead : urls_to_fetch_.end();
+    while (next != last &&
+           GetPendingUrlFetchCount(next->url.host()) >=
+               kMaxConcurrentUrlFetchesPerHost) {
+      ++next;
+    }
+    if (next == last)
+      break;
+    UrlToFetch url_to_fetch = *next;
+    urls_to_fetch_.erase(next);
 
     AppCache::EntryMap::iterator it = url_file_list_.find(url_to_fetch.url);
     DCHECK(it != url_file_list_.end());
@@ -969,6 +985,17 @@ void AppCacheUpdateJob::FetchUrls() {
   }
 }
 
+size_t AppCacheUpdateJob::GetPendingUrlFetchCount(
+    const std::string& host) const {
+  size_t count = 0;
+  for (PendingUrlFetches::const_iterator it = pending_url_fetches_.begin();
+       it != pending_url_fetches_.end(); ++it) {
+    if (it->first.host() == host)
+      ++count;
+  }
+  return count;
+}
+
 void AppCacheUpdateJob::CancelAllUrlFetches() {
   // Cancel any pending URL requests.
   for (PendingUrlFetches::iterator it = pending_url_fetches_.begin();
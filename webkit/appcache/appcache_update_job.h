@@ -191,6 +191,8 @@ class APPCACHE_EXPORT AppCacheUpdateJob : public AppCacheStorage::Delegate,
   void BuildUrlFileList(const Manifest& manifest);
   void AddUrlToFileList(const GURL& url, int type);
   void FetchUrls();
+  // Returns the number of URL fetches in progress to |host|.
+  size_t GetPendingUrlFetchCount(const std::string& host) const;
   void CancelAllUrlFetches();
   bool ShouldSkipUrlFetch(const AppCacheEntry& entry);
 
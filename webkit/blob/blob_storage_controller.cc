@@ -212,10 +212,9 @@ void BlobStorageController::ResolveBlobReferencesInUploadData(
       const BlobData::Item& item = blob_data->items().at(i - 1);
       switch (item.type) {
         case BlobData::TYPE_DATA:
-          // TODO(jianli): Figure out how to avoid copying the data.
-          // TODO(michaeln): Now that blob_data surives for the duration,
-          // maybe UploadData could take a raw ptr without having to copy.
-          iter->SetToBytes(
+          // The blob data is attached to |upload_data| above, so the upload
+          // can refer to its bytes rather than copying them.
+          iter->SetToSharedBytes(
               &item.data.at(0) + static_cast<int>(item.offset),
               static_cast<int>(item.length));
           break;
@@ -121,8 +121,8 @@ TEST(BlobStorageControllerTest, ResolveBlobReferencesInUploadData) {
   // Test no blob reference.
   scoped_refptr<UploadData> upload_data(new UploadData());
   upload_data->AppendBytes(
-      &upload_element1.bytes().at(0),
-      upload_element1.bytes().size());
+      upload_element1.bytes(),
+      upload_element1.bytes_length());
   upload_data->AppendFileRange(
       upload_element2.file_path(),
       upload_element2.file_range_offset(),
@@ -150,12 +150,17 @@ TEST(BlobStorageControllerTest, ResolveBlobReferencesInUploadData) {
   EXPECT_TRUE(upload_data->elements()->at(0) == blob_element1);
   EXPECT_TRUE(upload_data->elements()->at(1) == blob_element2);
 
+  // The in-memory data is shared with the blob rather than copied.
+  EXPECT_EQ(blob_storage_controller.GetBlobDataFromUrl(blob_url1)->
+                items().at(0).data.data(),
+            upload_data->elements()->at(0).bytes());
+
   // Test having one blob reference at the beginning.
   upload_data = new UploadData();
   upload_data->AppendBlob(blob_url1);
   upload_data->AppendBytes(
-      &upload_element1.bytes().at(0),
-      upload_element1.bytes().size());
+      upload_element1.bytes(),
+      upload_element1.bytes_length());
   upload_data->AppendFileRange(
       upload_element2.file_path(),
       upload_element2.file_range_offset(),
@@ -172,8 +177,8 @@ TEST(BlobStorageControllerTest, ResolveBlobReferencesInUploadData) {
   // Test having one blob reference at the end.
   upload_data = new UploadData();
   upload_data->AppendBytes(
-      &upload_element1.bytes().at(0),
-      upload_element1.bytes().size());
+      upload_element1.bytes(),
+      upload_element1.bytes_length());
   upload_data->AppendFileRange(
       upload_element2.file_path(),
       upload_element2.file_range_offset(),
@@ -191,8 +196,8 @@ TEST(BlobStorageControllerTest, ResolveBlobReferencesInUploadData) {
   // Test having one blob reference in the middle.
   upload_data = new UploadData();
   upload_data->AppendBytes(
-      &upload_element1.bytes().at(0),
-      upload_element1.bytes().size());
+      upload_element1.bytes(),
+      upload_element1.bytes_length());
   upload_data->AppendBlob(blob_url1);
   upload_data->AppendFileRange(
       upload_element2.file_path(),
@@ -211,8 +216,8 @@ TEST(BlobStorageControllerTest, ResolveBlobReferencesInUploadData) {
   upload_data = new UploadData();
   upload_data->AppendBlob(blob_url1);
   upload_data->AppendBytes(
-      &upload_element1.bytes().at(0),
-      upload_element1.bytes().size());
+      upload_element1.bytes(),
+      upload_element1.bytes_length());
   upload_data->AppendBlob(blob_url2);
   upload_data->AppendBlob(blob_url3);
   upload_data->AppendFileRange(
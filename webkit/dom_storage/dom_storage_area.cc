@@ -4,10 +4,13 @@
 
 #include "webkit/dom_storage/dom_storage_area.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/file_util.h"
 #include "base/location.h"
 #include "base/logging.h"
+#include "base/metrics/histogram.h"
 #include "base/time.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebString.h"
 #include "webkit/database/database_util.h"
@@ -22,13 +25,66 @@ using webkit_database::DatabaseUtil;
 
 namespace dom_storage {
 
-static const int kCommitTimerSeconds = 1;
+// Delay for a moment after a value is set in anticipation
+// of other values being set, so changes are batched.
+static const int kCommitDefaultDelaySecs = 1;
+
+// Areas which are written to heavily have their commits delayed further,
+// so as to keep to these rates over their lifetime.
+static const size_t kMaxCommitsPerHour = 120;
+static const size_t kMaxBytesPerHour = kPerAreaQuota * 2;
+
+// But changes are never held back for longer than this, nor is more than
+// this much data, to bound what is lost if the browser goes away.
+static const int kCommitMaxDelaySecs = 30;
+static const size_t kMaxBytesPendingCommit = 1024 * 1024;
+
+static size_t ValueBytes(const NullableString16& value) {
+  return value.is_null() ? 0 : value.string().length() * sizeof(char16);
+}
 
 DomStorageArea::CommitBatch::CommitBatch()
-  : clear_all_first(false) {
+  : clear_all_first(false),
+    bytes(0) {
 }
 DomStorageArea::CommitBatch::~CommitBatch() {}
 
+void DomStorageArea::CommitBatch::SetValue(const string16& key,
+                                           const NullableString16& value) {
+  ValuesMap::iterator found = changed_values.find(key);
+  if (found == changed_values.end()) {
+    bytes += key.length() * sizeof(char16);
+    found = changed_values.insert(std::make_pair(key, value)).first;
+  } else {
+    bytes -= ValueBytes(found->second);
+    found->second = value;
+  }
+  bytes += ValueBytes(value);
+}
+
+void DomStorageArea::CommitBatch::ClearAll() {
+  clear_all_first = true;
+  changed_values.clear();
+  bytes = 0;
+}
+
+DomStorageArea::RateLimiter::RateLimiter(size_t desired_rate,
+                                         base::TimeDelta time_quantum)
+    : rate_(desired_rate),
+      samples_(0),
+      time_quantum_(time_quantum) {
+  DCHECK_GT(desired_rate, 0u);
+}
+
+base::TimeDelta DomStorageArea::RateLimiter::ComputeDelayNeeded(
+    base::TimeDelta elapsed_time) const {
+  base::TimeDelta time_needed = base::TimeDelta::FromMicroseconds(
+      static_cast<int64>(time_quantum_.InMicroseconds() * samples_ / rate_));
+  if (time_needed > elapsed_time)
+    return time_needed - elapsed_time;
+  return base::TimeDelta();
+}
+
 
 // static
 const FilePath::CharType DomStorageArea::kDatabaseFileExtension[] =
@@ -60,7 +116,12 @@ DomStorageArea::DomStorageArea(
       task_runner_(task_runner),
       map_(new DomStorageMap(kPerAreaQuota)),
       is_initial_import_done_(true),
-      is_shutdown_(false) {
+      is_shutdown_(false),
+      commit_timer_id_(0),
+      is_commit_expedited_(false),
+      start_time_(base::TimeTicks::Now()),
+      commit_rate_limiter_(kMaxCommitsPerHour, base::TimeDelta::FromHours(1)),
+      data_rate_limiter_(kMaxBytesPerHour, base::TimeDelta::FromHours(1)) {
   if (namespace_id == kLocalStorageNamespaceId && !directory.empty()) {
     FilePath path = directory.Append(DatabaseFileNameFromOrigin(origin_));
     backing_.reset(new DomStorageDatabase(path));
@@ -110,7 +171,8 @@ bool DomStorageArea::SetItem(const string16& key,
   bool success = map_->SetItem(key, value, old_value);
   if (success && backing_.get()) {
     CommitBatch* commit_batch = CreateCommitBatchIfNeeded();
-    commit_batch->changed_values[key] = NullableString16(value, false);
+    commit_batch->SetValue(key, NullableString16(value, false));
+    ExpediteCommitIfNeeded();
   }
   return success;
 }
@@ -124,7 +186,7 @@ bool DomStorageArea::RemoveItem(const string16& key, string16* old_value) {
   bool success = map_->RemoveItem(key, old_value);
   if (success && backing_.get()) {
     CommitBatch* commit_batch = CreateCommitBatchIfNeeded();
-    commit_batch->changed_values[key] = NullableString16(true);
+    commit_batch->SetValue(key, NullableString16(true));
   }
   return success;
 }
@@ -140,8 +202,7 @@ bool DomStorageArea::Clear() {
 
   if (backing_.get()) {
     CommitBatch* commit_batch = CreateCommitBatchIfNeeded();
-    commit_batch->clear_all_first = true;
-    commit_batch->changed_values.clear();
+    commit_batch->ClearAll();
   }
 
   return true;
@@ -236,19 +297,22 @@ DomStorageArea::CommitBatch* DomStorageArea::CreateCommitBatchIfNeeded() {
     // Start a timer to commit any changes that accrue in the batch,
     // but only if a commit is not currently in flight. In that case
     // the timer will be started after the current commit has happened.
-    if (!in_flight_commit_batch_.get()) {
-      task_runner_->PostDelayedTask(
-          FROM_HERE,
-          base::Bind(&DomStorageArea::OnCommitTimer, this),
-          base::TimeDelta::FromSeconds(kCommitTimerSeconds));
-    }
+    if (!in_flight_commit_batch_.get())
+      ScheduleCommit(ComputeCommitDelay());
   }
   return commit_batch_.get();
 }
 
-void DomStorageArea::OnCommitTimer() {
+void DomStorageArea::ScheduleCommit(base::TimeDelta delay) {
+  task_runner_->PostDelayedTask(
+      FROM_HERE,
+      base::Bind(&DomStorageArea::OnCommitTimer, this, ++commit_timer_id_),
+      delay);
+}
+
+void DomStorageArea::OnCommitTimer(int commit_timer_id) {
   DCHECK_EQ(kLocalStorageNamespaceId, namespace_id_);
-  if (is_shutdown_)
+  if (is_shutdown_ || commit_timer_id != commit_timer_id_)
     return;
 
   DCHECK(backing_.get());
@@ -259,6 +323,18 @@ void DomStorageArea::OnCommitTimer() {
   // a task for immediate execution on the commit sequence.
   DCHECK(task_runner_->IsRunningOnPrimarySequence());
   in_flight_commit_batch_ = commit_batch_.Pass();
+  is_commit_expedited_ = false;
+  commit_rate_limiter_.add_samples(1);
+  data_rate_limiter_.add_samples(in_flight_commit_batch_->bytes);
+
+  base::TimeTicks now = base::TimeTicks::Now();
+  if (!last_commit_time_.is_null()) {
+    UMA_HISTOGRAM_LONG_TIMES("LocalStorage.TimeBetweenCommits",
+                             now - last_commit_time_);
+  }
+  last_commit_time_ = now;
+  UMA_HISTOGRAM_COUNTS("LocalStorage.CommitBatchBytes",
+                       in_flight_commit_batch_->bytes);
   bool success = task_runner_->PostShutdownBlockingTask(
       FROM_HERE,
       DomStorageTaskRunner::COMMIT_SEQUENCE,
@@ -287,10 +363,9 @@ void DomStorageArea::OnCommitComplete() {
   in_flight_commit_batch_.reset();
   if (commit_batch_.get()) {
     // More changes have accrued, restart the timer.
-    task_runner_->PostDelayedTask(
-        FROM_HERE,
-        base::Bind(&DomStorageArea::OnCommitTimer, this),
-        base::TimeDelta::FromSeconds(kCommitTimerSeconds));
+    ScheduleCommit(is_commit_expedited_ ?
+        base::TimeDelta::FromSeconds(kCommitDefaultDelaySecs) :
+        ComputeCommitDelay());
   }
 }
 
@@ -310,4 +385,27 @@ void DomStorageArea::ShutdownInCommitSequence() {
   backing_.reset();
 }
 
+base::TimeDelta DomStorageArea::ComputeCommitDelay() const {
+  base::TimeDelta elapsed_time = base::TimeTicks::Now() - start_time_;
+  base::TimeDelta delay = std::max(
+      base::TimeDelta::FromSeconds(kCommitDefaultDelaySecs),
+      std::max(commit_rate_limiter_.ComputeDelayNeeded(elapsed_time),
+               data_rate_limiter_.ComputeDelayNeeded(elapsed_time)));
+  delay = std::min(delay, base::TimeDelta::FromSeconds(kCommitMaxDelaySecs));
+  UMA_HISTOGRAM_LONG_TIMES("LocalStorage.CommitDelay", delay);
+  return delay;
+}
+
+void DomStorageArea::ExpediteCommitIfNeeded() {
+  DCHECK(commit_batch_.get());
+  if (is_commit_expedited_ || commit_batch_->bytes < kMaxBytesPendingCommit)
+    return;
+  is_commit_expedited_ = true;
+
+  // Replace the scheduled commit with a sooner one. If a commit is in
+  // flight, the next one is scheduled when it completes.
+  if (!in_flight_commit_batch_.get())
+    ScheduleCommit(base::TimeDelta::FromSeconds(kCommitDefaultDelaySecs));
+}
+
 }  // namespace dom_storage
@@ -11,6 +11,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/nullable_string16.h"
 #include "base/string16.h"
+#include "base/time.h"
 #include "googleurl/src/gurl.h"
 #include "webkit/dom_storage/dom_storage_database.h"
 #include "webkit/dom_storage/dom_storage_types.h"
@@ -77,13 +78,41 @@ class DomStorageArea
   FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, CommitChangesAtShutdown);
   FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, DeleteOrigin);
   FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, PurgeMemory);
+  FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, CommitBatchCoalescesWrites);
+  FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, RateLimiter);
+  FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, CommitDelay);
   friend class base::RefCountedThreadSafe<DomStorageArea>;
 
+  // The changes to write to the backing database. Only the last change to
+  // each key is kept.
   struct CommitBatch {
     bool clear_all_first;
     ValuesMap changed_values;
+    size_t bytes;  // The size of the keys and values in |changed_values|.
     CommitBatch();
     ~CommitBatch();
+
+    void SetValue(const string16& key, const NullableString16& value);
+    void ClearAll();
+  };
+
+  // Tracks how many samples, such as commits or bytes committed, there have
+  // been against a desired rate of them, to tell how long to wait before
+  // the next one so as not to exceed it.
+  class RateLimiter {
+   public:
+    RateLimiter(size_t desired_rate, base::TimeDelta time_quantum);
+
+    void add_samples(size_t samples) { samples_ += samples; }
+
+    // Returns how much longer to wait, |elapsed_time| after the start, for
+    // the samples so far to be within the desired rate.
+    base::TimeDelta ComputeDelayNeeded(base::TimeDelta elapsed_time) const;
+
+   private:
+    double rate_;
+    double samples_;
+    base::TimeDelta time_quantum_;
   };
 
   ~DomStorageArea();
@@ -97,12 +126,20 @@ class DomStorageArea
   // disk on the commit sequence, and to call back on the primary
   // task sequence when complete.
   CommitBatch* CreateCommitBatchIfNeeded();
-  void OnCommitTimer();
+  void ScheduleCommit(base::TimeDelta delay);
+  void OnCommitTimer(int commit_timer_id);
   void CommitChanges();
   void OnCommitComplete();
 
   void ShutdownInCommitSequence();
 
+  // Returns how long to wait before committing the batch, which grows with
+  // how often and how much the area has been committing, up to a bound.
+  base::TimeDelta ComputeCommitDelay() const;
+
+  // Commits sooner than scheduled if the batch has grown large.
+  void ExpediteCommitIfNeeded();
+
   int64 namespace_id_;
   GURL origin_;
   FilePath directory_;
@@ -113,6 +150,15 @@ class DomStorageArea
   bool is_shutdown_;
   scoped_ptr<CommitBatch> commit_batch_;
   scoped_ptr<CommitBatch> in_flight_commit_batch_;
+
+  // Only the most recently scheduled commit timer runs, the others are
+  // ignored.
+  int commit_timer_id_;
+  bool is_commit_expedited_;
+  base::TimeTicks start_time_;
+  base::TimeTicks last_commit_time_;
+  RateLimiter commit_rate_limiter_;
+  RateLimiter data_rate_limiter_;
 };
 
 }  // namespace dom_storage
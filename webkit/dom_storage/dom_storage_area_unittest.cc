@@ -403,6 +403,86 @@ TEST_F(DomStorageAreaTest, PurgeMemory) {
   EXPECT_NE(original_map, area->map_.get());
 }
 
+TEST_F(DomStorageAreaTest, CommitBatchCoalescesWrites) {
+  const size_t kKeyBytes = kKey.length() * sizeof(char16);
+  DomStorageArea::CommitBatch batch;
+  batch.SetValue(kKey, NullableString16(kValue, false));
+  batch.SetValue(kKey, NullableString16(kValue2, false));
+  EXPECT_EQ(1u, batch.changed_values.size());
+  EXPECT_EQ(kValue2, batch.changed_values[kKey].string());
+  EXPECT_EQ(kKeyBytes + kValue2.length() * sizeof(char16), batch.bytes);
+
+  batch.SetValue(kKey, NullableString16(true));
+  EXPECT_EQ(1u, batch.changed_values.size());
+  EXPECT_TRUE(batch.changed_values[kKey].is_null());
+  EXPECT_EQ(kKeyBytes, batch.bytes);
+
+  batch.ClearAll();
+  EXPECT_TRUE(batch.clear_all_first);
+  EXPECT_TRUE(batch.changed_values.empty());
+  EXPECT_EQ(0u, batch.bytes);
+}
+
+TEST_F(DomStorageAreaTest, RateLimiter) {
+  // Limit to 1000 samples per second.
+  DomStorageArea::RateLimiter rate_limiter(
+      1000, base::TimeDelta::FromSeconds(1));
+
+  // No samples have been added so no delay should be required.
+  EXPECT_EQ(base::TimeDelta(),
+            rate_limiter.ComputeDelayNeeded(base::TimeDelta()));
+
+  // Add a second's worth of samples, and see that no more delay is needed
+  // once a second has passed.
+  rate_limiter.add_samples(1000);
+  EXPECT_EQ(base::TimeDelta::FromSeconds(1),
+            rate_limiter.ComputeDelayNeeded(base::TimeDelta()));
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(250),
+            rate_limiter.ComputeDelayNeeded(
+                base::TimeDelta::FromMilliseconds(750)));
+  EXPECT_EQ(base::TimeDelta(),
+            rate_limiter.ComputeDelayNeeded(base::TimeDelta::FromSeconds(2)));
+}
+
+TEST_F(DomStorageAreaTest, CommitDelay) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  scoped_refptr<DomStorageArea> area(
+      new DomStorageArea(kLocalStorageNamespaceId, kOrigin,
+          temp_dir.path(),
+          new MockDomStorageTaskRunner(base::MessageLoopProxy::current())));
+  area->backing_.reset(new DomStorageDatabase());
+
+  // A new area commits after the default delay.
+  const base::TimeDelta kDefaultDelay = area->ComputeCommitDelay();
+  EXPECT_LE(base::TimeDelta::FromSeconds(1), kDefaultDelay);
+
+  // Areas which commit often are delayed longer, up to a bound.
+  area->commit_rate_limiter_.add_samples(1000);
+  base::TimeDelta delay = area->ComputeCommitDelay();
+  EXPECT_LT(kDefaultDelay, delay);
+  EXPECT_GE(base::TimeDelta::FromMinutes(1), delay);
+
+  // A large batch is committed without waiting for the longer delay.
+  NullableString16 old_value;
+  EXPECT_TRUE(area->SetItem(kKey, kValue, &old_value));
+  EXPECT_FALSE(area->is_commit_expedited_);
+  int commit_timer_id = area->commit_timer_id_;
+  const string16 kLargeValue(1024 * 1024, 'a');
+  EXPECT_TRUE(area->SetItem(kKey2, kLargeValue, &old_value));
+  EXPECT_TRUE(area->is_commit_expedited_);
+  EXPECT_EQ(commit_timer_id + 1, area->commit_timer_id_);
+
+  // Only the newest timer commits, the other is ignored.
+  MessageLoop::current()->RunAllPending();
+  EXPECT_FALSE(area->HasUncommittedChanges());
+  EXPECT_FALSE(area->is_commit_expedited_);
+  ValuesMap values;
+  area->backing_->ReadAllValues(&values);
+  EXPECT_EQ(2u, values.size());
+  EXPECT_EQ(kLargeValue, values[kKey2].string());
+}
+
 TEST_F(DomStorageAreaTest, DatabaseFileNames) {
   struct {
     const char* origin;
@@ -0,0 +1,179 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "webkit/dom_storage/dom_storage_cached_area.h"
+
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/logging.h"
+#include "webkit/dom_storage/dom_storage_map.h"
+#include "webkit/dom_storage/dom_storage_proxy.h"
+#include "webkit/dom_storage/dom_storage_types.h"
+
+namespace dom_storage {
+
+DomStorageCachedArea::DomStorageCachedArea(
+    int64 namespace_id, const GURL& origin, DomStorageProxy* proxy)
+    : pending_clear_count_(0),
+      namespace_id_(namespace_id),
+      origin_(origin),
+      proxy_(proxy),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
+}
+
+DomStorageCachedArea::~DomStorageCachedArea() {
+}
+
+unsigned DomStorageCachedArea::GetLength(int connection_id) {
+  PrimeIfNeeded(connection_id);
+  return map_->Length();
+}
+
+NullableString16 DomStorageCachedArea::GetKey(
+    int connection_id, unsigned index) {
+  PrimeIfNeeded(connection_id);
+  return map_->Key(index);
+}
+
+NullableString16 DomStorageCachedArea::GetItem(
+    int connection_id, const string16& key) {
+  PrimeIfNeeded(connection_id);
+  return map_->GetItem(key);
+}
+
+bool DomStorageCachedArea::SetItem(
+    int connection_id, const string16& key, const string16& value,
+    const GURL& page_url, NullableString16* old_value) {
+  // Reject obviously overbudget items without priming the cache.
+  if (key.length() + value.length() > kPerAreaQuota)
+    return false;
+
+  PrimeIfNeeded(connection_id);
+  if (!map_->SetItem(key, value, old_value))
+    return false;
+
+  // Ignore changes to |key| from other processes until the browser has
+  // applied ours.
+  ++ignore_key_mutations_[key];
+  proxy_->SetItem(
+      connection_id, key, value, page_url,
+      base::Bind(&DomStorageCachedArea::OnSetItemComplete,
+                 weak_factory_.GetWeakPtr(), key));
+  return true;
+}
+
+bool DomStorageCachedArea::RemoveItem(
+    int connection_id, const string16& key, const GURL& page_url,
+    string16* old_value) {
+  PrimeIfNeeded(connection_id);
+  if (!map_->RemoveItem(key, old_value))
+    return false;
+
+  ++ignore_key_mutations_[key];
+  proxy_->RemoveItem(
+      connection_id, key, page_url,
+      base::Bind(&DomStorageCachedArea::OnRemoveItemComplete,
+                 weak_factory_.GetWeakPtr(), key));
+  return true;
+}
+
+bool DomStorageCachedArea::Clear(int connection_id, const GURL& page_url) {
+  PrimeIfNeeded(connection_id);
+  if (!map_->Length())
+    return false;
+
+  // Ignore all changes from other processes until the browser has cleared
+  // the area.
+  map_ = new DomStorageMap(kPerAreaQuota);
+  ++pending_clear_count_;
+  proxy_->ClearArea(
+      connection_id, page_url,
+      base::Bind(&DomStorageCachedArea::OnClearComplete,
+                 weak_factory_.GetWeakPtr()));
+  return true;
+}
+
+void DomStorageCachedArea::ApplyMutation(
+    const NullableString16& key, const NullableString16& new_value) {
+  if (!map_ || should_ignore_all_mutations())
+    return;
+
+  if (key.is_null()) {
+    // The area was cleared, but the writes of our own still in flight will
+    // be applied after that, so keep their values.
+    scoped_refptr<DomStorageMap> old_map = map_;
+    map_ = new DomStorageMap(kPerAreaQuota);
+    for (std::map<string16, int>::const_iterator it =
+             ignore_key_mutations_.begin();
+         it != ignore_key_mutations_.end(); ++it) {
+      NullableString16 value = old_map->GetItem(it->first);
+      if (!value.is_null()) {
+        NullableString16 unused;
+        map_->SetItem(it->first, value.string(), &unused);
+      }
+    }
+    return;
+  }
+
+  if (should_ignore_key_mutation(key.string()))
+    return;
+
+  if (new_value.is_null()) {
+    string16 unused;
+    map_->RemoveItem(key.string(), &unused);
+    return;
+  }
+
+  // The browser lets areas which were already over budget keep their
+  // values, so don't check the quota for the values it sends.
+  NullableString16 unused;
+  map_->set_quota(kint32max);
+  map_->SetItem(key.string(), new_value.string(), &unused);
+  map_->set_quota(kPerAreaQuota);
+}
+
+void DomStorageCachedArea::Prime(int connection_id) {
+  DCHECK(!map_);
+  ValuesMap values;
+  proxy_->LoadArea(connection_id, &values);
+  map_ = new DomStorageMap(kPerAreaQuota);
+  map_->SwapValues(&values);
+}
+
+void DomStorageCachedArea::Reset() {
+  map_ = NULL;
+  weak_factory_.InvalidateWeakPtrs();
+  ignore_key_mutations_.clear();
+  pending_clear_count_ = 0;
+}
+
+void DomStorageCachedArea::OnSetItemComplete(
+    const string16& key, bool success) {
+  if (!success) {
+    // The browser refused the value, so our cache no longer matches it.
+    Reset();
+    return;
+  }
+  std::map<string16, int>::iterator found = ignore_key_mutations_.find(key);
+  DCHECK(found != ignore_key_mutations_.end());
+  if (--found->second == 0)
+    ignore_key_mutations_.erase(found);
+}
+
+void DomStorageCachedArea::OnRemoveItemComplete(
+    const string16& key, bool success) {
+  DCHECK(success);
+  std::map<string16, int>::iterator found = ignore_key_mutations_.find(key);
+  DCHECK(found != ignore_key_mutations_.end());
+  if (--found->second == 0)
+    ignore_key_mutations_.erase(found);
+}
+
+void DomStorageCachedArea::OnClearComplete(bool success) {
+  DCHECK(success);
+  DCHECK_GT(pending_clear_count_, 0);
+  --pending_clear_count_;
+}
+
+}  // namespace dom_storage
@@ -0,0 +1,94 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef WEBKIT_DOM_STORAGE_DOM_STORAGE_CACHED_AREA_H_
+#define WEBKIT_DOM_STORAGE_DOM_STORAGE_CACHED_AREA_H_
+#pragma once
+
+#include <map>
+
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/nullable_string16.h"
+#include "base/string16.h"
+#include "googleurl/src/gurl.h"
+
+namespace dom_storage {
+
+class DomStorageMap;
+class DomStorageProxy;
+
+// Renderer-side cache of the values of an area, shared by all the
+// connections in the process to the same origin and namespace. Reads are
+// served from the cache, which is primed with a single call to
+// DomStorageProxy::LoadArea() on first use. Writes are applied to the cache
+// and sent to the browser without waiting for a reply. The changes other
+// processes make are applied with ApplyMutation(), so the cache stays
+// current without having to ask the browser for values.
+class DomStorageCachedArea : public base::RefCounted<DomStorageCachedArea> {
+ public:
+  DomStorageCachedArea(int64 namespace_id, const GURL& origin,
+                       DomStorageProxy* proxy);
+
+  int64 namespace_id() const { return namespace_id_; }
+  const GURL& origin() const { return origin_; }
+
+  unsigned GetLength(int connection_id);
+  NullableString16 GetKey(int connection_id, unsigned index);
+  NullableString16 GetItem(int connection_id, const string16& key);
+  bool SetItem(int connection_id, const string16& key, const string16& value,
+               const GURL& page_url, NullableString16* old_value);
+  bool RemoveItem(int connection_id, const string16& key,
+                  const GURL& page_url, string16* old_value);
+  bool Clear(int connection_id, const GURL& page_url);
+
+  // Applies a change made to the area by another process. A null |key|
+  // means the area was cleared, and a null |new_value| that the key was
+  // removed. Changes to keys with writes of our own still in flight are
+  // ignored, as our writes will be applied after them.
+  void ApplyMutation(const NullableString16& key,
+                     const NullableString16& new_value);
+
+ private:
+  friend class DomStorageCachedAreaTest;
+  friend class base::RefCounted<DomStorageCachedArea>;
+  ~DomStorageCachedArea();
+
+  // Primes the cache, loading all values for the area.
+  void PrimeIfNeeded(int connection_id) {
+    if (!map_)
+      Prime(connection_id);
+  }
+  void Prime(int connection_id);
+
+  // Resets the object back to its newly constructed state, so the cache
+  // is primed again on the next use.
+  void Reset();
+
+  // Async completion callbacks for proxied operations.
+  void OnSetItemComplete(const string16& key, bool success);
+  void OnRemoveItemComplete(const string16& key, bool success);
+  void OnClearComplete(bool success);
+
+  bool should_ignore_all_mutations() const {
+    return pending_clear_count_ > 0;
+  }
+  bool should_ignore_key_mutation(const string16& key) const {
+    return ignore_key_mutations_.find(key) != ignore_key_mutations_.end();
+  }
+
+  // The number of writes of our own in flight for each key.
+  std::map<string16, int> ignore_key_mutations_;
+  int pending_clear_count_;
+
+  int64 namespace_id_;
+  GURL origin_;
+  scoped_refptr<DomStorageMap> map_;
+  scoped_refptr<DomStorageProxy> proxy_;
+  base::WeakPtrFactory<DomStorageCachedArea> weak_factory_;
+};
+
+}  // namespace dom_storage
+
+#endif  // WEBKIT_DOM_STORAGE_DOM_STORAGE_CACHED_AREA_H_
@@ -0,0 +1,290 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <list>
+
+#include "base/bind.h"
+#include "base/compiler_specific.h"
+#include "base/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webkit/dom_storage/dom_storage_cached_area.h"
+#include "webkit/dom_storage/dom_storage_proxy.h"
+
+namespace dom_storage {
+
+namespace {
+// A mock implementation of the DomStorageProxy interface.
+class MockProxy : public DomStorageProxy {
+ public:
+  MockProxy() {
+    ResetObservations();
+  }
+
+  // DomStorageProxy interface for use by DomStorageCachedArea.
+
+  virtual void LoadArea(int connection_id, ValuesMap* values) OVERRIDE {
+    observed_load_area_ = true;
+    observed_connection_id_ = connection_id;
+    *values = load_area_return_values_;
+  }
+
+  virtual void SetItem(int connection_id, const string16& key,
+                       const string16& value, const GURL& page_url,
+                       const CompletionCallback& callback) OVERRIDE {
+    pending_callbacks_.push_back(callback);
+    observed_set_item_ = true;
+    observed_connection_id_ = connection_id;
+    observed_key_ = key;
+    observed_value_ = value;
+    observed_page_url_ = page_url;
+  }
+
+  virtual void RemoveItem(int connection_id, const string16& key,
+                          const GURL& page_url,
+                          const CompletionCallback& callback) OVERRIDE {
+    pending_callbacks_.push_back(callback);
+    observed_remove_item_ = true;
+    observed_connection_id_ = connection_id;
+    observed_key_ = key;
+    observed_page_url_ = page_url;
+  }
+
+  virtual void ClearArea(int connection_id,
+                         const GURL& page_url,
+                         const CompletionCallback& callback) OVERRIDE {
+    pending_callbacks_.push_back(callback);
+    observed_clear_area_ = true;
+    observed_connection_id_ = connection_id;
+    observed_page_url_ = page_url;
+  }
+
+  // Methods and members for use by test fixtures.
+
+  void ResetObservations() {
+    observed_load_area_ = false;
+    observed_set_item_ = false;
+    observed_remove_item_ = false;
+    observed_clear_area_ = false;
+    observed_connection_id_ = 0;
+    observed_key_.clear();
+    observed_value_.clear();
+    observed_page_url_ = GURL();
+  }
+
+  void CompleteAllPendingCallbacks() {
+    while (!pending_callbacks_.empty())
+      CompleteOnePendingCallback(true);
+  }
+
+  void CompleteOnePendingCallback(bool success) {
+    ASSERT_TRUE(!pending_callbacks_.empty());
+    pending_callbacks_.front().Run(success);
+    pending_callbacks_.pop_front();
+  }
+
+  typedef std::list<CompletionCallback> CallbackList;
+
+  ValuesMap load_area_return_values_;
+  CallbackList pending_callbacks_;
+  bool observed_load_area_;
+  bool observed_set_item_;
+  bool observed_remove_item_;
+  bool observed_clear_area_;
+  int observed_connection_id_;
+  string16 observed_key_;
+  string16 observed_value_;
+  GURL observed_page_url_;
+
+ private:
+  virtual ~MockProxy() {}
+};
+
+}  // namespace
+
+class DomStorageCachedAreaTest : public testing::Test {
+ public:
+  DomStorageCachedAreaTest()
+    : kNamespaceId(10),
+      kOrigin("http://dom_storage/"),
+      kKey(ASCIIToUTF16("key")),
+      kValue(ASCIIToUTF16("value")),
+      kPageUrl("http://dom_storage/page"),
+      kConnectionId(7),
+      mock_proxy_(new MockProxy()) {
+  }
+
+  const int64 kNamespaceId;
+  const GURL kOrigin;
+  const string16 kKey;
+  const string16 kValue;
+  const GURL kPageUrl;
+  const int kConnectionId;
+
+  virtual void SetUp() {
+    mock_proxy_->load_area_return_values_[kKey] =
+        NullableString16(kValue, false);
+  }
+
+  bool IsPrimed(DomStorageCachedArea* cached_area) {
+    return cached_area->map_.get();
+  }
+
+  bool IsIgnoringAllMutations(DomStorageCachedArea* cached_area) {
+    return cached_area->should_ignore_all_mutations();
+  }
+
+  bool IsIgnoringKeyMutations(DomStorageCachedArea* cached_area,
+                              const string16& key) {
+    return cached_area->should_ignore_key_mutation(key);
+  }
+
+ protected:
+  scoped_refptr<MockProxy> mock_proxy_;
+};
+
+TEST_F(DomStorageCachedAreaTest, Basics) {
+  scoped_refptr<DomStorageCachedArea> cached_area =
+      new DomStorageCachedArea(kNamespaceId, kOrigin, mock_proxy_);
+  EXPECT_EQ(kNamespaceId, cached_area->namespace_id());
+  EXPECT_EQ(kOrigin, cached_area->origin());
+  EXPECT_FALSE(IsPrimed(cached_area));
+
+  // Reading primes the cache once.
+  EXPECT_EQ(1u, cached_area->GetLength(kConnectionId));
+  EXPECT_TRUE(mock_proxy_->observed_load_area_);
+  EXPECT_EQ(kConnectionId, mock_proxy_->observed_connection_id_);
+  EXPECT_TRUE(IsPrimed(cached_area));
+  mock_proxy_->ResetObservations();
+  EXPECT_EQ(kKey, cached_area->GetKey(kConnectionId, 0).string());
+  EXPECT_EQ(kValue, cached_area->GetItem(kConnectionId, kKey).string());
+  EXPECT_TRUE(cached_area->GetKey(kConnectionId, 1).is_null());
+  EXPECT_FALSE(mock_proxy_->observed_load_area_);
+}
+
+TEST_F(DomStorageCachedAreaTest, SetItem) {
+  const string16 kNewValue(ASCIIToUTF16("new"));
+  scoped_refptr<DomStorageCachedArea> cached_area =
+      new DomStorageCachedArea(kNamespaceId, kOrigin, mock_proxy_);
+  NullableString16 old_value;
+  EXPECT_TRUE(cached_area->SetItem(kConnectionId, kKey, kNewValue, kPageUrl,
+                                   &old_value));
+  EXPECT_EQ(kValue, old_value.string());
+  EXPECT_TRUE(mock_proxy_->observed_load_area_);
+  EXPECT_TRUE(mock_proxy_->observed_set_item_);
+  EXPECT_EQ(kKey, mock_proxy_->observed_key_);
+  EXPECT_EQ(kNewValue, mock_proxy_->observed_value_);
+  EXPECT_EQ(kPageUrl, mock_proxy_->observed_page_url_);
+  EXPECT_EQ(kNewValue, cached_area->GetItem(kConnectionId, kKey).string());
+
+  // Changes from other processes are ignored until ours completes.
+  EXPECT_TRUE(IsIgnoringKeyMutations(cached_area, kKey));
+  cached_area->ApplyMutation(NullableString16(kKey, false),
+                             NullableString16(kValue, false));
+  EXPECT_EQ(kNewValue, cached_area->GetItem(kConnectionId, kKey).string());
+  mock_proxy_->CompleteAllPendingCallbacks();
+  EXPECT_FALSE(IsIgnoringKeyMutations(cached_area, kKey));
+
+  // Items larger than the quota are rejected without priming the cache.
+  scoped_refptr<DomStorageCachedArea> unprimed_area =
+      new DomStorageCachedArea(kNamespaceId, kOrigin, mock_proxy_);
+  mock_proxy_->ResetObservations();
+  EXPECT_FALSE(unprimed_area->SetItem(
+      kConnectionId, kKey, string16(kPerAreaQuota, 'a'), kPageUrl,
+      &old_value));
+  EXPECT_FALSE(mock_proxy_->observed_load_area_);
+  EXPECT_FALSE(mock_proxy_->observed_set_item_);
+}
+
+TEST_F(DomStorageCachedAreaTest, SetItemFailure) {
+  scoped_refptr<DomStorageCachedArea> cached_area =
+      new DomStorageCachedArea(kNamespaceId, kOrigin, mock_proxy_);
+  NullableString16 old_value;
+  EXPECT_TRUE(cached_area->SetItem(kConnectionId, kKey, kKey, kPageUrl,
+                                   &old_value));
+
+  // When the browser refuses a value, the cache is loaded again.
+  mock_proxy_->CompleteOnePendingCallback(false);
+  EXPECT_FALSE(IsPrimed(cached_area));
+  EXPECT_FALSE(IsIgnoringKeyMutations(cached_area, kKey));
+  EXPECT_EQ(kValue, cached_area->GetItem(kConnectionId, kKey).string());
+}
+
+TEST_F(DomStorageCachedAreaTest, RemoveItem) {
+  scoped_refptr<DomStorageCachedArea> cached_area =
+      new DomStorageCachedArea(kNamespaceId, kOrigin, mock_proxy_);
+  string16 old_value;
+  EXPECT_TRUE(cached_area->RemoveItem(kConnectionId, kKey, kPageUrl,
+                                      &old_value));
+  EXPECT_EQ(kValue, old_value);
+  EXPECT_TRUE(mock_proxy_->observed_remove_item_);
+  EXPECT_EQ(kKey, mock_proxy_->observed_key_);
+  EXPECT_EQ(0u, cached_area->GetLength(kConnectionId));
+  EXPECT_TRUE(IsIgnoringKeyMutations(cached_area, kKey));
+
+  // Removing a key which isn't there doesn't go to the browser.
+  mock_proxy_->ResetObservations();
+  EXPECT_FALSE(cached_area->RemoveItem(kConnectionId, kKey, kPageUrl,
+                                       &old_value));
+  EXPECT_FALSE(mock_proxy_->observed_remove_item_);
+
+  mock_proxy_->CompleteAllPendingCallbacks();
+  EXPECT_FALSE(IsIgnoringKeyMutations(cached_area, kKey));
+}
+
+TEST_F(DomStorageCachedAreaTest, Clear) {
+  scoped_refptr<DomStorageCachedArea> cached_area =
+      new DomStorageCachedArea(kNamespaceId, kOrigin, mock_proxy_);
+  EXPECT_TRUE(cached_area->Clear(kConnectionId, kPageUrl));
+  EXPECT_TRUE(mock_proxy_->observed_clear_area_);
+  EXPECT_EQ(kPageUrl, mock_proxy_->observed_page_url_);
+  EXPECT_EQ(0u, cached_area->GetLength(kConnectionId));
+
+  // All changes from other processes are ignored until the clear completes.
+  EXPECT_TRUE(IsIgnoringAllMutations(cached_area));
+  cached_area->ApplyMutation(NullableString16(kKey, false),
+                             NullableString16(kValue, false));
+  EXPECT_EQ(0u, cached_area->GetLength(kConnectionId));
+  mock_proxy_->CompleteAllPendingCallbacks();
+  EXPECT_FALSE(IsIgnoringAllMutations(cached_area));
+
+  mock_proxy_->ResetObservations();
+  EXPECT_FALSE(cached_area->Clear(kConnectionId, kPageUrl));
+  EXPECT_FALSE(mock_proxy_->observed_clear_area_);
+}
+
+TEST_F(DomStorageCachedAreaTest, ApplyMutation) {
+  const string16 kKey2(ASCIIToUTF16("key2"));
+  scoped_refptr<DomStorageCachedArea> cached_area =
+      new DomStorageCachedArea(kNamespaceId, kOrigin, mock_proxy_);
+
+  // Nothing is cached before the cache is primed.
+  cached_area->ApplyMutation(NullableString16(kKey2, false),
+                             NullableString16(kValue, false));
+  EXPECT_EQ(1u, cached_area->GetLength(kConnectionId));
+
+  // Set and remove.
+  cached_area->ApplyMutation(NullableString16(kKey2, false),
+                             NullableString16(kValue, false));
+  EXPECT_EQ(kValue, cached_area->GetItem(kConnectionId, kKey2).string());
+  cached_area->ApplyMutation(NullableString16(kKey2, false),
+                             NullableString16(true));
+  EXPECT_TRUE(cached_area->GetItem(kConnectionId, kKey2).is_null());
+
+  // Values over the quota the browser has allowed are kept.
+  const string16 kBigValue(kPerAreaQuota, 'a');
+  cached_area->ApplyMutation(NullableString16(kKey2, false),
+                             NullableString16(kBigValue, false));
+  EXPECT_EQ(kBigValue, cached_area->GetItem(kConnectionId, kKey2).string());
+
+  // A clear keeps the values of our own writes in flight.
+  NullableString16 old_value;
+  EXPECT_TRUE(cached_area->SetItem(kConnectionId, kKey, kKey, kPageUrl,
+                                   &old_value));
+  cached_area->ApplyMutation(NullableString16(true), NullableString16(true));
+  EXPECT_EQ(1u, cached_area->GetLength(kConnectionId));
+  EXPECT_EQ(kKey, cached_area->GetItem(kConnectionId, kKey).string());
+  mock_proxy_->CompleteAllPendingCallbacks();
+}
+
+}  // namespace dom_storage
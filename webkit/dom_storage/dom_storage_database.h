@@ -64,6 +64,7 @@ class DomStorageDatabase {
                            TestCanOpenFileThatIsNotADatabase);
   FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, BackingDatabaseOpened);
   FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, CommitTasks);
+  FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, CommitDelay);
   FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, PurgeMemory);
 
   enum SchemaVersion {
@@ -4,6 +4,8 @@
 
 #include "webkit/dom_storage/dom_storage_map.h"
 
+#include <iterator>
+
 #include "base/logging.h"
 
 namespace {
@@ -27,8 +29,16 @@ size_t CountBytes(const dom_storage::ValuesMap& values) {
 
 namespace dom_storage {
 
+// static
+const size_t DomStorageMap::kMaxChunkLength = 64;
+
+DomStorageMap::Chunk::Chunk() {}
+
+DomStorageMap::Chunk::~Chunk() {}
+
 DomStorageMap::DomStorageMap(size_t quota)
-    : bytes_used_(0),
+    : length_(0),
+      bytes_used_(0),
       quota_(quota) {
   ResetKeyIterator();
 }
@@ -36,12 +46,27 @@ DomStorageMap::DomStorageMap(size_t quota)
 DomStorageMap::~DomStorageMap() {}
 
 unsigned DomStorageMap::Length() const {
-  return values_.size();
+  return length_;
 }
 
 NullableString16 DomStorageMap::Key(unsigned index) {
-  if (index >= values_.size())
+  if (index >= length_)
     return NullableString16(true);
+
+  // Move to the chunk holding |index|, then to the key within it.
+  while (index < key_chunk_start_) {
+    --key_chunk_index_;
+    key_chunk_start_ -= chunks_[key_chunk_index_]->values.size();
+    key_iterator_ = chunks_[key_chunk_index_]->values.begin();
+    last_key_index_ = key_chunk_start_;
+  }
+  while (index >= key_chunk_start_ +
+                  chunks_[key_chunk_index_]->values.size()) {
+    key_chunk_start_ += chunks_[key_chunk_index_]->values.size();
+    ++key_chunk_index_;
+    key_iterator_ = chunks_[key_chunk_index_]->values.begin();
+    last_key_index_ = key_chunk_start_;
+  }
   while (last_key_index_ != index) {
     if (last_key_index_ > index) {
       --key_iterator_;
@@ -55,8 +80,11 @@ NullableString16 DomStorageMap::Key(unsigned index) {
 }
 
 NullableString16 DomStorageMap::GetItem(const string16& key) const {
-  ValuesMap::const_iterator found = values_.find(key);
-  if (found == values_.end())
+  if (chunks_.empty())
+    return NullableString16(true);
+  const ValuesMap& values = chunks_[FindChunk(key)]->values;
+  ValuesMap::const_iterator found = values.find(key);
+  if (found == values.end())
     return NullableString16(true);
   return found->second;
 }
@@ -64,11 +92,7 @@ NullableString16 DomStorageMap::GetItem(const string16& key) const {
 bool DomStorageMap::SetItem(
     const string16& key, const string16& value,
     NullableString16* old_value) {
-  ValuesMap::const_iterator found = values_.find(key);
-  if (found == values_.end())
-    *old_value = NullableString16(true);
-  else
-    *old_value = found->second;
+  *old_value = GetItem(key);
 
   size_t old_item_size = old_value->is_null() ?
       0 : size_of_item(key, old_value->string());
@@ -80,7 +104,24 @@ bool DomStorageMap::SetItem(
   if (new_item_size > old_item_size && new_bytes_used > quota_)
     return false;
 
-  values_[key] = NullableString16(value, false);
+  if (chunks_.empty())
+    chunks_.push_back(new Chunk);
+  size_t index = FindChunk(key);
+  Chunk* chunk = GetWritableChunk(index);
+  chunk->values[key] = NullableString16(value, false);
+  if (old_value->is_null())
+    ++length_;
+
+  // Split a chunk which has grown too long in two.
+  if (chunk->values.size() > kMaxChunkLength) {
+    scoped_refptr<Chunk> upper(new Chunk);
+    ValuesMap::iterator middle = chunk->values.begin();
+    std::advance(middle, chunk->values.size() / 2);
+    upper->values.insert(middle, chunk->values.end());
+    chunk->values.erase(middle, chunk->values.end());
+    chunks_.insert(chunks_.begin() + index + 1, upper);
+  }
+
   ResetKeyIterator();
   bytes_used_ = new_bytes_used;
   return true;
@@ -89,11 +130,19 @@ bool DomStorageMap::SetItem(
 bool DomStorageMap::RemoveItem(
     const string16& key,
     string16* old_value) {
-  ValuesMap::iterator found = values_.find(key);
-  if (found == values_.end())
+  if (chunks_.empty())
+    return false;
+  size_t index = FindChunk(key);
+  if (chunks_[index]->values.find(key) == chunks_[index]->values.end())
     return false;
+
+  Chunk* chunk = GetWritableChunk(index);
+  ValuesMap::iterator found = chunk->values.find(key);
   *old_value = found->second.string();
-  values_.erase(found);
+  chunk->values.erase(found);
+  if (chunk->values.empty())
+    chunks_.erase(chunks_.begin() + index);
+  --length_;
   ResetKeyIterator();
   bytes_used_ -= size_of_item(key, *old_value);
   return true;
@@ -101,21 +150,69 @@ bool DomStorageMap::RemoveItem(
 
 void DomStorageMap::SwapValues(ValuesMap* values) {
   // Note: A pre-existing file may be over the quota budget.
-  values_.swap(*values);
-  bytes_used_ = CountBytes(values_);
+  ValuesMap old_values;
+  ExtractValues(&old_values);
+
+  chunks_.clear();
+  for (ValuesMap::const_iterator it = values->begin(); it != values->end();
+       ++it) {
+    if (chunks_.empty() || chunks_.back()->values.size() == kMaxChunkLength)
+      chunks_.push_back(new Chunk);
+    ValuesMap& chunk_values = chunks_.back()->values;
+    chunk_values.insert(chunk_values.end(), *it);
+  }
+  length_ = values->size();
+  bytes_used_ = CountBytes(*values);
+  values->swap(old_values);
   ResetKeyIterator();
 }
 
+void DomStorageMap::ExtractValues(ValuesMap* map) const {
+  map->clear();
+  for (Chunks::const_iterator it = chunks_.begin(); it != chunks_.end();
+       ++it) {
+    map->insert((*it)->values.begin(), (*it)->values.end());
+  }
+}
+
 DomStorageMap* DomStorageMap::DeepCopy() const {
   DomStorageMap* copy = new DomStorageMap(quota_);
-  copy->values_ = values_;
+  copy->chunks_ = chunks_;
+  copy->length_ = length_;
   copy->bytes_used_ = bytes_used_;
   copy->ResetKeyIterator();
   return copy;
 }
 
+size_t DomStorageMap::FindChunk(const string16& key) const {
+  DCHECK(!chunks_.empty());
+  // Find the last chunk whose first key is not after |key|.
+  size_t low = 0;
+  size_t high = chunks_.size();
+  while (high - low > 1) {
+    size_t middle = low + (high - low) / 2;
+    if (key < chunks_[middle]->values.begin()->first)
+      high = middle;
+    else
+      low = middle;
+  }
+  return low;
+}
+
+DomStorageMap::Chunk* DomStorageMap::GetWritableChunk(size_t index) {
+  if (!chunks_[index]->HasOneRef()) {
+    scoped_refptr<Chunk> copy(new Chunk);
+    copy->values = chunks_[index]->values;
+    chunks_[index] = copy;
+  }
+  return chunks_[index].get();
+}
+
 void DomStorageMap::ResetKeyIterator() {
-  key_iterator_ = values_.begin();
+  key_chunk_index_ = 0;
+  key_chunk_start_ = 0;
+  key_iterator_ = chunks_.empty() ?
+      ValuesMap::const_iterator() : chunks_[0]->values.begin();
   last_key_index_ = 0;
 }
 
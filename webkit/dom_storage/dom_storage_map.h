@@ -7,6 +7,7 @@
 #pragma once
 
 #include <map>
+#include <vector>
 
 #include "base/memory/ref_counted.h"
 #include "base/nullable_string16.h"
@@ -15,9 +16,14 @@
 
 namespace dom_storage {
 
-// A wrapper around a std::map that adds refcounting and
+// A sorted map of keys to values that adds refcounting and
 // tracks the size in bytes of the keys/values, enforcing a quota.
 // See class comments for DomStorageContext for a larger overview.
+//
+// The values are kept in chunks of up to a few dozen keys each, ordered by
+// key. Copies of a map share its chunks, and a write to either copies only
+// the chunk it changes, so cloning a session storage namespace doesn't copy
+// the values of its areas.
 class DomStorageMap
     : public base::RefCountedThreadSafe<DomStorageMap> {
  public:
@@ -35,24 +41,62 @@ class DomStorageMap
   // this method does not do quota checking.
   void SwapValues(ValuesMap* map);
 
-  // Writes a copy of the current set of values_ to the |map|.
-  void ExtractValues(ValuesMap* map) const { *map = values_; }
+  // Writes a copy of the current set of values to the |map|.
+  void ExtractValues(ValuesMap* map) const;
 
-  // Creates a new instance of DomStorageMap containing
-  // a deep copy of values_.
+  // Creates a new instance of DomStorageMap containing the same values,
+  // which shares the chunks of values with this instance until either
+  // is written to.
   DomStorageMap* DeepCopy() const;
 
   size_t bytes_used() const { return bytes_used_; }
+  size_t quota() const { return quota_; }
+  void set_quota(size_t quota) { quota_ = quota; }
+
+  // The most keys a chunk holds. Chunks are split in two when they grow
+  // past this. Exposed for testing.
+  static const size_t kMaxChunkLength;
 
  private:
   friend class base::RefCountedThreadSafe<DomStorageMap>;
+
+  // A run of the map's values, shared between copies of the map.
+  class Chunk : public base::RefCountedThreadSafe<Chunk> {
+   public:
+    Chunk();
+
+    ValuesMap values;
+
+   private:
+    friend class base::RefCountedThreadSafe<Chunk>;
+    ~Chunk();
+
+    DISALLOW_COPY_AND_ASSIGN(Chunk);
+  };
+  // Non-empty chunks, in order of their keys.
+  typedef std::vector<scoped_refptr<Chunk> > Chunks;
+
   ~DomStorageMap();
 
+  // Returns the index of the chunk which holds |key| if it is in the map, or
+  // would hold it if it were added. |chunks_| must not be empty.
+  size_t FindChunk(const string16& key) const;
+
+  // Returns the chunk at |index|, first copying it if it is shared with
+  // another map.
+  Chunk* GetWritableChunk(size_t index);
+
   void ResetKeyIterator();
 
-  ValuesMap values_;
+  Chunks chunks_;
+  unsigned length_;
+
+  // The position of the last key returned by Key(), for iterating.
+  size_t key_chunk_index_;
+  unsigned key_chunk_start_;  // The index of the chunk's first key.
   ValuesMap::const_iterator key_iterator_;
   unsigned last_key_index_;
+
   size_t bytes_used_;
   size_t quota_;
 };
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/stringprintf.h"
 #include "base/utf_string_conversions.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webkit/dom_storage/dom_storage_map.h"
@@ -121,4 +122,50 @@ TEST(DomStorageMapTest, EnforcesQuota) {
   EXPECT_EQ(kValue, old_nullable_value.string());
 }
 
+TEST(DomStorageMapTest, CopiesSpanningChunks) {
+  // Enough keys to fill several chunks.
+  const int kNumKeys = static_cast<int>(DomStorageMap::kMaxChunkLength) * 5;
+  const size_t kQuota = 1024 * 1024;
+  NullableString16 old_nullable_value;
+  string16 old_value;
+
+  scoped_refptr<DomStorageMap> map(new DomStorageMap(kQuota));
+  // Add the keys out of order, so chunks are split in the middle.
+  for (int i = 0; i < kNumKeys; ++i) {
+    string16 key =
+        ASCIIToUTF16(base::StringPrintf("%04d", (i * 7) % kNumKeys));
+    EXPECT_TRUE(map->SetItem(key, key, &old_nullable_value));
+  }
+  EXPECT_EQ(static_cast<unsigned>(kNumKeys), map->Length());
+  for (int i = 0; i < kNumKeys; ++i)
+    EXPECT_EQ(ASCIIToUTF16(base::StringPrintf("%04d", i)),
+              map->Key(i).string());
+  EXPECT_TRUE(map->Key(kNumKeys).is_null());
+
+  // Writes to a copy are not seen by the original, nor the other way round.
+  scoped_refptr<DomStorageMap> copy(map->DeepCopy());
+  const string16 kFirstKey(ASCIIToUTF16("0000"));
+  const string16 kLastKey(
+      ASCIIToUTF16(base::StringPrintf("%04d", kNumKeys - 1)));
+  const string16 kNewValue(ASCIIToUTF16("new"));
+  EXPECT_TRUE(copy->SetItem(kFirstKey, kNewValue, &old_nullable_value));
+  EXPECT_EQ(kFirstKey, old_nullable_value.string());
+  EXPECT_TRUE(map->RemoveItem(kLastKey, &old_value));
+  EXPECT_EQ(kNewValue, copy->GetItem(kFirstKey).string());
+  EXPECT_EQ(kFirstKey, map->GetItem(kFirstKey).string());
+  EXPECT_EQ(kLastKey, copy->GetItem(kLastKey).string());
+  EXPECT_TRUE(map->GetItem(kLastKey).is_null());
+  EXPECT_EQ(static_cast<unsigned>(kNumKeys), copy->Length());
+  EXPECT_EQ(static_cast<unsigned>(kNumKeys - 1), map->Length());
+  const size_t kLastItemBytes = kLastKey.size() * 2 * sizeof(char16);
+  EXPECT_EQ(map->bytes_used() + kLastItemBytes +
+                kNewValue.size() * sizeof(char16),
+            copy->bytes_used() + kFirstKey.size() * sizeof(char16));
+
+  ValuesMap values;
+  copy->ExtractValues(&values);
+  EXPECT_EQ(static_cast<size_t>(kNumKeys), values.size());
+  EXPECT_EQ(kNewValue, values[kFirstKey].string());
+}
+
 }  // namespace dom_storage
@@ -13,6 +13,7 @@
 #include "base/pickle.h"
 #include "base/string_number_conversions.h"
 #include "base/string_util.h"
+#include "third_party/leveldatabase/env_chromium.h"
 #include "third_party/leveldatabase/src/include/leveldb/db.h"
 #include "third_party/leveldatabase/src/include/leveldb/write_batch.h"
 #include "webkit/fileapi/file_system_usage_cache.h"
@@ -675,6 +676,8 @@ bool FileSystemDirectoryDatabase::Init(RecoveryOption recovery_option) {
           kDirectoryDatabaseName));
   leveldb::Options options;
   options.create_if_missing = true;
+  // There is a database per origin, so share one cache between them.
+  options.block_cache = leveldb_env::SharedBlockCache();
   leveldb::DB* db;
   leveldb::Status status = leveldb::DB::Open(options, path, &db);
   ReportInitStatus(status);
@@ -5,14 +5,54 @@
 #include "webkit/fileapi/file_system_operation_context.h"
 
 #include "webkit/fileapi/file_system_context.h"
+#include "webkit/fileapi/file_system_quota_util.h"
 
 namespace fileapi {
 
 FileSystemOperationContext::FileSystemOperationContext(
     FileSystemContext* context)
     : file_system_context_(context),
-      allowed_bytes_growth_(0) {}
+      allowed_bytes_growth_(0),
+      usage_batch_depth_(0) {}
 
-FileSystemOperationContext::~FileSystemOperationContext() {}
+FileSystemOperationContext::~FileSystemOperationContext() {
+  DCHECK_EQ(0, usage_batch_depth_);
+}
+
+void FileSystemOperationContext::UpdateUsage(
+    const GURL& origin, FileSystemType type, int64 growth) {
+  if (usage_batch_depth_) {
+    pending_usage_[std::make_pair(origin, type)] += growth;
+    return;
+  }
+  ReportUsage(origin, type, growth);
+}
+
+void FileSystemOperationContext::BeginUsageBatch() {
+  ++usage_batch_depth_;
+}
+
+void FileSystemOperationContext::EndUsageBatch() {
+  DCHECK_GT(usage_batch_depth_, 0);
+  if (--usage_batch_depth_)
+    return;
+  UsageMap pending_usage;
+  pending_usage.swap(pending_usage_);
+  for (UsageMap::const_iterator iter = pending_usage.begin();
+       iter != pending_usage.end(); ++iter) {
+    if (iter->second)
+      ReportUsage(iter->first.first, iter->first.second, iter->second);
+  }
+}
+
+void FileSystemOperationContext::ReportUsage(
+    const GURL& origin, FileSystemType type, int64 growth) {
+  FileSystemQuotaUtil* quota_util =
+      file_system_context_->GetQuotaUtil(type);
+  if (quota_util) {
+    quota_util->UpdateOriginUsageOnFileThread(
+        file_system_context_->quota_manager_proxy(), origin, type, growth);
+  }
+}
 
 }  // namespace fileapi
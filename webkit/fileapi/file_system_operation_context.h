@@ -5,6 +5,9 @@
 #ifndef WEBKIT_FILEAPI_FILE_SYSTEM_OPERATION_CONTEXT_H_
 #define WEBKIT_FILEAPI_FILE_SYSTEM_OPERATION_CONTEXT_H_
 
+#include <map>
+#include <utility>
+
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
 #include "googleurl/src/gurl.h"
@@ -29,10 +32,27 @@ class FileSystemOperationContext {
   }
   int64 allowed_bytes_growth() const { return allowed_bytes_growth_; }
 
+  // Reports |growth| bytes of usage by |origin| and |type| to the quota util,
+  // or, within a usage batch, adds it to the batch's total.
+  void UpdateUsage(const GURL& origin, FileSystemType type, int64 growth);
+
+  // Recursive operations batch usage updates, so that the usage cache is
+  // rewritten and the quota manager notified once per operation rather than
+  // once per entry. Batches nest; the outermost EndUsageBatch() reports the
+  // totals.
+  void BeginUsageBatch();
+  void EndUsageBatch();
+
  private:
+  typedef std::map<std::pair<GURL, FileSystemType>, int64> UsageMap;
+
+  void ReportUsage(const GURL& origin, FileSystemType type, int64 growth);
+
   scoped_refptr<FileSystemContext> file_system_context_;
 
   int64 allowed_bytes_growth_;
+  int usage_batch_depth_;
+  UsageMap pending_usage_;
 };
 
 }  // namespace fileapi
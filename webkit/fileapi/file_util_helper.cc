@@ -16,6 +16,23 @@ namespace fileapi {
 
 namespace {
 
+// Batches the usage updates of a recursive operation for its duration.
+class ScopedUsageBatch {
+ public:
+  explicit ScopedUsageBatch(FileSystemOperationContext* context)
+      : context_(context) {
+    context_->BeginUsageBatch();
+  }
+  ~ScopedUsageBatch() {
+    context_->EndUsageBatch();
+  }
+
+ private:
+  FileSystemOperationContext* context_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedUsageBatch);
+};
+
 // A helper class for cross-FileUtil Copy/Move operations.
 class CrossFileUtilHelper {
  public:
@@ -93,8 +110,10 @@ base::PlatformFileError CrossFileUtilHelper::DoWork() {
   base::PlatformFileError error = PerformErrorCheckAndPreparation();
   if (error != base::PLATFORM_FILE_OK)
     return error;
-  if (src_util_->DirectoryExists(context_, src_root_path_))
+  if (src_util_->DirectoryExists(context_, src_root_path_)) {
+    ScopedUsageBatch usage_batch(context_);
     return CopyOrMoveDirectory(src_root_path_, dest_root_path_);
+  }
   return CopyOrMoveFile(src_root_path_, dest_root_path_);
 }
 
@@ -315,7 +334,7 @@ base::PlatformFileError FileUtilHelper::DeleteDirectoryRecursive(
     FileSystemOperationContext* context,
     FileSystemFileUtil* file_util,
     const FileSystemPath& path) {
-
+  ScopedUsageBatch usage_batch(context);
   scoped_ptr<FileSystemFileUtil::AbstractFileEnumerator> file_enum(
       file_util->CreateFileEnumerator(context, path, true /* recursive */));
   FilePath file_path_each;
@@ -71,12 +71,7 @@ void UpdateUsage(
     const GURL& origin,
     FileSystemType type,
     int64 growth) {
-  FileSystemQuotaUtil* quota_util =
-      context->file_system_context()->GetQuotaUtil(type);
-  quota::QuotaManagerProxy* quota_manager_proxy =
-      context->file_system_context()->quota_manager_proxy();
-  quota_util->UpdateOriginUsageOnFileThread(
-      quota_manager_proxy, origin, type, growth);
+  context->UpdateUsage(origin, type, growth);
 }
 
 void TouchDirectory(FileSystemDirectoryDatabase* db,
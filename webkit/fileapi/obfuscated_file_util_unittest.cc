@@ -1272,6 +1272,30 @@ TEST_F(ObfuscatedFileUtilTest, TestEnumerator) {
   EXPECT_FALSE(ofu()->DirectoryExists(context.get(), dest_path));
 }
 
+TEST_F(ObfuscatedFileUtilTest, TestRecursiveOperationUsage) {
+  scoped_ptr<FileSystemOperationContext> context(NewContext(NULL));
+  FileSystemPath src_path = CreatePathFromUTF8("source dir");
+  ASSERT_EQ(base::PLATFORM_FILE_OK, ofu()->CreateDirectory(
+      context.get(), src_path, true /* exclusive */, false /* recursive */));
+  std::set<FilePath::StringType> files;
+  std::set<FilePath::StringType> directories;
+  FillTestDirectory(src_path, &files, &directories);
+  int64 usage = SizeInUsageFile();
+
+  // The usage of the whole tree is reported when the copy completes.
+  FileSystemPath dest_path = CreatePathFromUTF8("destination dir");
+  context.reset(NewContext(NULL));
+  ASSERT_EQ(base::PLATFORM_FILE_OK,
+            test_helper().SameFileUtilCopy(context.get(), src_path, dest_path));
+  EXPECT_LT(usage, SizeInUsageFile());
+
+  context.reset(NewContext(NULL));
+  ASSERT_EQ(base::PLATFORM_FILE_OK,
+            FileUtilHelper::Delete(context.get(), ofu(), dest_path,
+                                   true /* recursive */));
+  EXPECT_EQ(usage, SizeInUsageFile());
+}
+
 TEST_F(ObfuscatedFileUtilTest, TestMigration) {
   ScopedTempDir source_dir;
   ASSERT_TRUE(source_dir.CreateUniqueTempDir());
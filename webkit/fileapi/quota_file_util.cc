@@ -8,11 +8,7 @@
 #include "base/logging.h"
 #include "webkit/fileapi/file_system_context.h"
 #include "webkit/fileapi/file_system_operation_context.h"
-#include "webkit/fileapi/file_system_quota_util.h"
 #include "webkit/fileapi/native_file_util.h"
-#include "webkit/quota/quota_manager.h"
-
-using quota::QuotaManagerProxy;
 
 namespace fileapi {
 
@@ -55,16 +51,9 @@ void NotifyUpdate(FileSystemOperationContext* operation_context,
   DCHECK(operation_context->file_system_context());
   DCHECK(type != kFileSystemTypeUnknown);
 
-  FileSystemQuotaUtil* quota_util =
-      operation_context->file_system_context()->GetQuotaUtil(type);
-  QuotaManagerProxy* quota_manager_proxy =
-      operation_context->file_system_context()->quota_manager_proxy();
-
   operation_context->set_allowed_bytes_growth(
       operation_context->allowed_bytes_growth() - growth);
-  if (quota_util)
-    quota_util->UpdateOriginUsageOnFileThread(
-        quota_manager_proxy, origin, type, growth);
+  operation_context->UpdateUsage(origin, type, growth);
 }
 
 }  // namespace (anonymous)
@@ -22,6 +22,11 @@ static const int kInitialReadBufferSize = 32768;
 // error.
 static const int kNumCacheMissRetries = 3;
 
+// A seek that comes less than this many reads after the previous one
+// switches to the random read pattern, and as many reads in a row without a
+// seek switch back to sequential.
+static const int kSequentialReadsAfterSeek = 16;
+
 BufferedDataSource::BufferedDataSource(
     MessageLoop* render_loop,
     WebFrame* frame,
@@ -45,6 +50,9 @@ BufferedDataSource::BufferedDataSource(
       cache_miss_retries_left_(kNumCacheMissRetries),
       bitrate_(0),
       playback_rate_(0.0),
+      read_pattern_(BufferedResourceLoader::kSequentialReads),
+      sequential_reads_(0),
+      last_read_end_(kPositionNotSpecified),
       media_log_(media_log) {
 }
 
@@ -61,13 +69,11 @@ BufferedResourceLoader* BufferedDataSource::CreateResourceLoader(
       BufferedResourceLoader::kReadThenDefer :
       BufferedResourceLoader::kThresholdDefer;
 
-  return new BufferedResourceLoader(url_,
-                                    first_byte_position,
-                                    last_byte_position,
-                                    strategy,
-                                    bitrate_,
-                                    playback_rate_,
-                                    media_log_);
+  BufferedResourceLoader* loader = new BufferedResourceLoader(
+      url_, first_byte_position, last_byte_position, strategy, bitrate_,
+      playback_rate_, media_log_);
+  loader->SetReadPattern(read_pattern_);
+  return loader;
 }
 
 void BufferedDataSource::set_host(media::DataSourceHost* host) {
@@ -212,6 +218,8 @@ void BufferedDataSource::ReadTask(
   read_buffer_ = buffer;
   cache_miss_retries_left_ = kNumCacheMissRetries;
 
+  UpdateReadPattern(position, read_size);
+
   // Call to read internal to perform the actual read.
   ReadInternal();
 }
@@ -300,6 +308,26 @@ void BufferedDataSource::SetBitrateTask(int bitrate) {
   loader_->SetBitrate(bitrate);
 }
 
+void BufferedDataSource::UpdateReadPattern(int64 position, int read_size) {
+  DCHECK(MessageLoop::current() == render_loop_);
+
+  BufferedResourceLoader::ReadPattern read_pattern = read_pattern_;
+  if (last_read_end_ != kPositionNotSpecified && position != last_read_end_) {
+    if (sequential_reads_ < kSequentialReadsAfterSeek)
+      read_pattern = BufferedResourceLoader::kRandomReads;
+    sequential_reads_ = 0;
+  } else if (++sequential_reads_ >= kSequentialReadsAfterSeek) {
+    read_pattern = BufferedResourceLoader::kSequentialReads;
+  }
+  last_read_end_ = position + read_size;
+
+  if (read_pattern == read_pattern_)
+    return;
+  read_pattern_ = read_pattern;
+  if (loader_.get())
+    loader_->SetReadPattern(read_pattern_);
+}
+
 // This method is the place where actual read happens, |loader_| must be valid
 // prior to make this method call.
 void BufferedDataSource::ReadInternal() {
@@ -101,6 +101,10 @@ class BufferedDataSource : public media::DataSource {
   // Tells |loader_| the bitrate of the media.
   void SetBitrateTask(int bitrate);
 
+  // Updates |read_pattern_| with a read of |read_size| bytes at |position|,
+  // and hints |loader_| about changes.
+  void UpdateReadPattern(int64 position, int read_size);
+
   // The method that performs actual read. This method can only be executed on
   // the render thread.
   void ReadInternal();
@@ -214,6 +218,13 @@ class BufferedDataSource : public media::DataSource {
   // Current playback rate.
   float playback_rate_;
 
+  // How the media has been read recently: |sequential_reads_| reads
+  // followed each other since the last seek, the last one ending at
+  // |last_read_end_|.
+  BufferedResourceLoader::ReadPattern read_pattern_;
+  int sequential_reads_;
+  int64 last_read_end_;
+
   scoped_refptr<media::MediaLog> media_log_;
 
   DISALLOW_COPY_AND_ASSIGN(BufferedDataSource);
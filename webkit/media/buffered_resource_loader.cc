@@ -4,8 +4,12 @@
 
 #include "webkit/media/buffered_resource_loader.h"
 
+#include <set>
+
 #include "base/callback_helpers.h"
 #include "base/format_macros.h"
+#include "base/lazy_instance.h"
+#include "base/metrics/histogram.h"
 #include "base/string_number_conversions.h"
 #include "base/string_util.h"
 #include "base/stringprintf.h"
@@ -51,17 +55,39 @@ static const int kMaxBufferCapacity = 20 * kMegabyte;
 // location and will instead reset the request.
 static const int kForwardWaitThreshold = 2 * kMegabyte;
 
+// The buffers of all the loaders in a renderer share this budget, so that a
+// page with many videos does not use a multiple of the memory of one.
+static const int kRendererBufferBudget = 64 * kMegabyte;
+
+// All the loaders of the renderer. Only used on the render thread.
+typedef std::set<BufferedResourceLoader*> LoaderSet;
+static base::LazyInstance<LoaderSet> g_loaders = LAZY_INSTANCE_INITIALIZER;
+
+// Set by BufferedResourceLoader::SetLowMemory().
+static bool g_low_memory = false;
+
 // Computes the suggested backward and forward capacity for the buffer
 // if one wants to play at |playback_rate| * the natural playback speed.
-// Use a value of 0 for |bitrate| if it is unknown.
+// Use a value of 0 for |bitrate| if it is unknown and a negative
+// |download_rate| (in bytes per second) if that is unknown. |random_reads|
+// keeps as much data behind the read position as ahead of it, since seeking
+// back is then as likely as reading forward.
 static void ComputeTargetBufferWindow(float playback_rate, int bitrate,
+                                      float download_rate, bool random_reads,
                                       int* out_backward_capacity,
                                       int* out_forward_capacity) {
   static const int kDefaultBitrate = 200 * 1024 * 8;  // 200 Kbps.
   static const int kMaxBitrate = 20 * kMegabyte * 8;  // 20 Mbps.
   static const float kMaxPlaybackRate = 25.0;
-  static const int kTargetSecondsBufferedAhead = 10;
   static const int kTargetSecondsBufferedBehind = 2;
+  static const int kDefaultSecondsBufferedAhead = 10;
+  // Used when the download is at least kFastDownloadFactor times faster than
+  // playback, since the buffer then refills quickly.
+  static const int kFastDownloadFactor = 4;
+  static const int kFastSecondsBufferedAhead = 4;
+  // Used when the download is slower than playback, to ride out more of the
+  // stalls.
+  static const int kSlowSecondsBufferedAhead = 30;
 
   // Use a default bit rate if unknown and clamp to prevent overflow.
   if (bitrate <= 0)
@@ -81,15 +107,24 @@ static void ComputeTargetBufferWindow(float playback_rate, int bitrate,
 
   int bytes_per_second = (bitrate / 8.0) * playback_rate;
 
+  int seconds_buffered_ahead = kDefaultSecondsBufferedAhead;
+  if (download_rate >= kFastDownloadFactor * bytes_per_second)
+    seconds_buffered_ahead = kFastSecondsBufferedAhead;
+  else if (download_rate >= 0 && download_rate < bytes_per_second)
+    seconds_buffered_ahead = kSlowSecondsBufferedAhead;
+
   // Clamp between kMinBufferCapacity and kMaxBufferCapacity.
   *out_forward_capacity = std::max(
-      kTargetSecondsBufferedAhead * bytes_per_second, kMinBufferCapacity);
+      seconds_buffered_ahead * bytes_per_second, kMinBufferCapacity);
   *out_backward_capacity = std::max(
       kTargetSecondsBufferedBehind * bytes_per_second, kMinBufferCapacity);
 
   *out_forward_capacity = std::min(*out_forward_capacity, kMaxBufferCapacity);
   *out_backward_capacity = std::min(*out_backward_capacity, kMaxBufferCapacity);
 
+  if (random_reads)
+    *out_backward_capacity = *out_forward_capacity;
+
   if (backward_playback)
     std::swap(*out_forward_capacity, *out_backward_capacity);
 }
@@ -119,16 +154,18 @@ BufferedResourceLoader::BufferedResourceLoader(
       last_offset_(0),
       bitrate_(bitrate),
       playback_rate_(playback_rate),
+      read_pattern_(kSequentialReads),
+      bytes_received_(0),
       media_log_(media_log) {
-
-  int backward_capacity;
-  int forward_capacity;
-  ComputeTargetBufferWindow(
-      playback_rate_, bitrate_, &backward_capacity, &forward_capacity);
-  buffer_.reset(new media::SeekableBuffer(backward_capacity, forward_capacity));
+  buffer_.reset(new media::SeekableBuffer(0, 0));
+  g_loaders.Get().insert(this);
+  UpdateAllBufferWindows();
 }
 
-BufferedResourceLoader::~BufferedResourceLoader() {}
+BufferedResourceLoader::~BufferedResourceLoader() {
+  g_loaders.Get().erase(this);
+  UpdateAllBufferWindows();
+}
 
 void BufferedResourceLoader::Start(
     const StartCB& start_cb,
@@ -183,6 +220,9 @@ void BufferedResourceLoader::Start(
   // Start the resource loading.
   loader->loadAsynchronously(request, this);
   active_loader_.reset(new ActiveLoader(loader.Pass()));
+
+  download_rate_monitor_.Start(base::Closure(), bitrate_, false, false);
+  download_rate_monitor_.SetNetworkActivity(true);
 }
 
 void BufferedResourceLoader::Stop() {
@@ -375,6 +415,9 @@ void BufferedResourceLoader::didReceiveResponse(
     bool ok_response = (response.httpStatusCode() == kHttpOK);
 
     if (IsRangeRequest()) {
+      UMA_HISTOGRAM_BOOLEAN("Media.RangeRequestServedFromCache",
+                            response.wasCached());
+
       // Check to see whether the server supports byte ranges.
       std::string accept_ranges =
           response.httpHeaderField("Accept-Ranges").utf8();
@@ -435,6 +478,11 @@ void BufferedResourceLoader::didReceiveData(
   // Writes more data to |buffer_|.
   buffer_->Append(reinterpret_cast<const uint8*>(data), data_length);
 
+  // Resize the buffer window as the download rate becomes known or changes.
+  bytes_received_ += data_length;
+  download_rate_monitor_.SetBufferedBytes(bytes_received_, base::Time::Now());
+  UpdateBufferWindow();
+
   // If there is an active read request, try to fulfill the request.
   if (HasPendingRead() && CanFulfillRead())
     ReadInternal();
@@ -563,6 +611,19 @@ void BufferedResourceLoader::SetBitrate(int bitrate) {
   UpdateBufferWindow();
 }
 
+void BufferedResourceLoader::SetReadPattern(ReadPattern read_pattern) {
+  read_pattern_ = read_pattern;
+  UpdateBufferWindow();
+}
+
+// static
+void BufferedResourceLoader::SetLowMemory(bool low_memory) {
+  if (g_low_memory == low_memory)
+    return;
+  g_low_memory = low_memory;
+  UpdateAllBufferWindows();
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // Helper methods.
 
@@ -570,16 +631,50 @@ void BufferedResourceLoader::UpdateBufferWindow() {
   if (!buffer_.get())
     return;
 
-  int backward_capacity;
-  int forward_capacity;
-  ComputeTargetBufferWindow(
-      playback_rate_, bitrate_, &backward_capacity, &forward_capacity);
+  int backward_capacity = kMinBufferCapacity;
+  int forward_capacity = kMinBufferCapacity;
+  if (!g_low_memory) {
+    ComputeTargetBufferWindow(
+        playback_rate_, bitrate_,
+        download_rate_monitor_.ApproximateDownloadByteRate(),
+        read_pattern_ == kRandomReads, &backward_capacity, &forward_capacity);
+
+    // Shrink the window to this loader's share of the renderer's budget.
+    int budget = kRendererBufferBudget / g_loaders.Get().size();
+    int capacity = backward_capacity + forward_capacity;
+    if (capacity > budget) {
+      backward_capacity = std::max(
+          static_cast<int>(static_cast<int64>(backward_capacity) * budget /
+                           capacity),
+          kMinBufferCapacity);
+      forward_capacity = std::max(
+          static_cast<int>(static_cast<int64>(forward_capacity) * budget /
+                           capacity),
+          kMinBufferCapacity);
+    }
+  }
 
   // This does not evict data from the buffer if the new capacities are less
   // than the current capacities; the new limits will be enforced after the
-  // existing excess buffered data is consumed.
+  // existing excess buffered data is consumed. Under low memory the data
+  // behind the read position is dropped right away.
   buffer_->set_backward_capacity(backward_capacity);
-  buffer_->set_forward_capacity(forward_capacity);
+  if (g_low_memory)
+    buffer_->EvictBackwardBuffers();
+
+  // Keep the forward capacity of a read in progress that extended it; it is
+  // restored to the new value once the read is done.
+  if (saved_forward_capacity_)
+    saved_forward_capacity_ = forward_capacity;
+  else
+    buffer_->set_forward_capacity(forward_capacity);
+}
+
+// static
+void BufferedResourceLoader::UpdateAllBufferWindows() {
+  LoaderSet* loaders = g_loaders.Pointer();
+  for (LoaderSet::iterator it = loaders->begin(); it != loaders->end(); ++it)
+    (*it)->UpdateBufferWindow();
 }
 
 void BufferedResourceLoader::UpdateDeferBehavior() {
@@ -594,6 +689,7 @@ void BufferedResourceLoader::UpdateDeferBehavior() {
 
 void BufferedResourceLoader::SetDeferred(bool deferred) {
   active_loader_->SetDeferred(deferred);
+  download_rate_monitor_.SetNetworkActivity(!deferred);
   NotifyNetworkEvent();
 }
 
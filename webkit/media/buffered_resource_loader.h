@@ -11,6 +11,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/timer.h"
 #include "googleurl/src/gurl.h"
+#include "media/base/download_rate_monitor.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/WebFrame.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebURLLoader.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebURLLoaderClient.h"
@@ -45,6 +46,13 @@ class BufferedResourceLoader : public WebKit::WebURLLoaderClient {
     kThresholdDefer,
   };
 
+  // kSequentialReads - The media is mostly read forward, as during playback.
+  // kRandomReads - The media is read around seeks, as while scrubbing.
+  enum ReadPattern {
+    kSequentialReads,
+    kRandomReads,
+  };
+
   // Status codes for start/read operations on BufferedResourceLoader.
   enum Status {
     // Everything went as planned.
@@ -179,6 +187,14 @@ class BufferedResourceLoader : public WebKit::WebURLLoaderClient {
   // accordingly.
   void SetBitrate(int bitrate);
 
+  // Sets the expected read pattern and updates buffer window accordingly.
+  void SetReadPattern(ReadPattern read_pattern);
+
+  // While |low_memory| is true, the buffers of all the loaders in the renderer
+  // are shrunk to their minimum and the data behind the read position is
+  // dropped. Called on the render thread.
+  static void SetLowMemory(bool low_memory);
+
   // Parse a Content-Range header into its component pieces and return true if
   // each of the expected elements was found & parsed correctly.
   // |*instance_size| may be set to kPositionNotSpecified if the range ends in
@@ -197,6 +213,10 @@ class BufferedResourceLoader : public WebKit::WebURLLoaderClient {
   // Updates the |buffer_|'s forward and backward capacities.
   void UpdateBufferWindow();
 
+  // Calls UpdateBufferWindow() on every loader in the renderer, since they
+  // share a memory budget.
+  static void UpdateAllBufferWindows();
+
   // Returns true if we should defer resource loading based on the current
   // buffering scheme.
   bool ShouldEnableDefer() const;
@@ -303,6 +323,14 @@ class BufferedResourceLoader : public WebKit::WebURLLoaderClient {
   // Playback rate of the media.
   float playback_rate_;
 
+  // How the media is expected to be read.
+  ReadPattern read_pattern_;
+
+  // Measures how fast data arrives; the buffer window grows on slow networks
+  // and shrinks on fast ones.
+  media::DownloadRateMonitor download_rate_monitor_;
+  int64 bytes_received_;
+
   scoped_refptr<media::MediaLog> media_log_;
 
   DISALLOW_COPY_AND_ASSIGN(BufferedResourceLoader);
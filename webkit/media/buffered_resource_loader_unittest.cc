@@ -1116,6 +1116,40 @@ TEST_F(BufferedResourceLoaderTest, BufferWindow_PlaybackRate_AboveUpperBound) {
   StopWhenLoad();
 }
 
+TEST_F(BufferedResourceLoaderTest, BufferWindow_ReadPattern) {
+  Initialize(kHttpUrl, -1, -1);
+  Start();
+  loader_->SetBitrate(2 * 1024 * 1024 * 8);  // 2 Mbps.
+  int forward_capacity = loader_->buffer_->forward_capacity();
+  EXPECT_LT(loader_->buffer_->backward_capacity(), forward_capacity);
+
+  // Seeking around keeps as much data behind the read position as ahead.
+  loader_->SetReadPattern(BufferedResourceLoader::kRandomReads);
+  CheckBufferWindowBounds();
+  ConfirmLoaderBufferBackwardCapacity(forward_capacity);
+  ConfirmLoaderBufferForwardCapacity(forward_capacity);
+
+  loader_->SetReadPattern(BufferedResourceLoader::kSequentialReads);
+  EXPECT_LT(loader_->buffer_->backward_capacity(), forward_capacity);
+  StopWhenLoad();
+}
+
+TEST_F(BufferedResourceLoaderTest, BufferWindow_LowMemory) {
+  Initialize(kHttpUrl, -1, -1);
+  Start();
+  loader_->SetBitrate(2 * 1024 * 1024 * 8);  // 2 Mbps.
+  int forward_capacity = loader_->buffer_->forward_capacity();
+
+  // Low memory shrinks the window to the minimum until it is lifted.
+  BufferedResourceLoader::SetLowMemory(true);
+  ConfirmLoaderBufferBackwardCapacity(2 * 1024 * 1024);
+  ConfirmLoaderBufferForwardCapacity(2 * 1024 * 1024);
+
+  BufferedResourceLoader::SetLowMemory(false);
+  ConfirmLoaderBufferForwardCapacity(forward_capacity);
+  StopWhenLoad();
+}
+
 static void ExpectContentRange(
     const std::string& str, bool expect_success,
     int64 expected_first, int64 expected_last, int64 expected_size) {
@@ -77,7 +77,9 @@ bool BuildMediaSourceCollection(
   if (media_source_url.isEmpty() || url != media_source_url)
     return false;
 
-  filter_collection->SetDemuxer(new media::ChunkDemuxer(client));
+  scoped_refptr<media::ChunkDemuxer> demuxer(new media::ChunkDemuxer(client));
+  demuxer->StartParserThread();
+  filter_collection->SetDemuxer(demuxer);
 
   AddDefaultDecodersToCollection(message_loop_factory, filter_collection,
                                  video_decoder);
@@ -51,6 +51,34 @@ static bool IsEitherYV12OrYV16(media::VideoFrame::Format format) {
   return format == media::VideoFrame::YV12 || format == media::VideoFrame::YV16;
 }
 
+// Projects |dest_rect| to device coordinates as |local_dest_irect| and stores
+// the part of it inside the clip rect in |clipped_dest_irect|. Returns false
+// if nothing of |dest_rect| is visible.
+static bool GetLocalDestRects(SkCanvas* canvas,
+                              const gfx::Rect& dest_rect,
+                              SkIRect* local_dest_irect,
+                              SkIRect* clipped_dest_irect) {
+  // Create a rectangle backed by SkScalar.
+  SkRect scalar_dest_rect;
+  scalar_dest_rect.iset(dest_rect.x(), dest_rect.y(),
+                        dest_rect.right(), dest_rect.bottom());
+
+  // Transform the destination rectangle to local coordinates.
+  const SkMatrix& local_matrix = canvas->getTotalMatrix();
+  SkRect local_dest_rect;
+  local_matrix.mapRect(&local_dest_rect, scalar_dest_rect);
+
+  // After projecting the destination rectangle to local coordinates, round
+  // the projected rectangle to integer values, this will give us pixel values
+  // of the rectangle.
+  local_dest_rect.round(local_dest_irect);
+  local_dest_rect.round(clipped_dest_irect);
+
+  // No point painting if the destination rect doesn't intersect with the
+  // clip rect.
+  return clipped_dest_irect->intersect(canvas->getTotalClip().getBounds());
+}
+
 // Fast paint does YUV => RGB, scaling, blitting all in one step into the
 // canvas. It's not always safe and appropriate to perform fast paint.
 // CanFastPaint() is used to determine the conditions.
@@ -67,27 +95,11 @@ static void FastPaint(
                             media::YV12 : media::YV16;
   int y_shift = yuv_type;  // 1 for YV12, 0 for YV16.
 
-  // Create a rectangle backed by SkScalar.
-  SkRect scalar_dest_rect;
-  scalar_dest_rect.iset(dest_rect.x(), dest_rect.y(),
-                        dest_rect.right(), dest_rect.bottom());
-
-  // Transform the destination rectangle to local coordinates.
-  const SkMatrix& local_matrix = canvas->getTotalMatrix();
-  SkRect local_dest_rect;
-  local_matrix.mapRect(&local_dest_rect, scalar_dest_rect);
-
-  // After projecting the destination rectangle to local coordinates, round
-  // the projected rectangle to integer values, this will give us pixel values
-  // of the rectangle.
   SkIRect local_dest_irect, local_dest_irect_saved;
-  local_dest_rect.round(&local_dest_irect);
-  local_dest_rect.round(&local_dest_irect_saved);
-
-  // No point painting if the destination rect doesn't intersect with the
-  // clip rect.
-  if (!local_dest_irect.intersect(canvas->getTotalClip().getBounds()))
+  if (!GetLocalDestRects(canvas, dest_rect, &local_dest_irect_saved,
+                         &local_dest_irect)) {
     return;
+  }
 
   // At this point |local_dest_irect| contains the rect that we should draw
   // to within the clipping rect.
@@ -198,8 +210,61 @@ static void ConvertVideoFrameToBitmap(
   bitmap->unlockPixels();
 }
 
+// Converts |video_frame| to RGB and scales it to the size of |bitmap|.
+static void ConvertAndScaleVideoFrame(
+    const scoped_refptr<media::VideoFrame>& video_frame,
+    SkBitmap* bitmap) {
+  DCHECK(IsEitherYV12OrYV16(video_frame->format())) << video_frame->format();
+  DCHECK_EQ(video_frame->stride(media::VideoFrame::kUPlane),
+            video_frame->stride(media::VideoFrame::kVPlane));
+
+  bitmap->lockPixels();
+  media::YUVType yuv_type = (video_frame->format() == media::VideoFrame::YV12) ?
+                            media::YV12 : media::YV16;
+  media::ScaleYUVToRGB32(video_frame->data(media::VideoFrame::kYPlane),
+                         video_frame->data(media::VideoFrame::kUPlane),
+                         video_frame->data(media::VideoFrame::kVPlane),
+                         static_cast<uint8*>(bitmap->getPixels()),
+                         video_frame->width(),
+                         video_frame->height(),
+                         bitmap->width(),
+                         bitmap->height(),
+                         video_frame->stride(media::VideoFrame::kYPlane),
+                         video_frame->stride(media::VideoFrame::kUPlane),
+                         bitmap->rowBytes(),
+                         yuv_type,
+                         media::ROTATE_0,
+                         media::FILTER_BILINEAR);
+  bitmap->notifyPixelsChanged();
+  bitmap->unlockPixels();
+}
+
+// Copies the part of |scaled_frame| that is visible in |clipped_dest_irect|
+// to |canvas|. |scaled_frame| covers |local_dest_irect|, in device
+// coordinates. This has the same preconditions as FastPaint().
+static void PaintScaledFrame(const SkBitmap& scaled_frame,
+                             SkCanvas* canvas,
+                             const SkIRect& local_dest_irect,
+                             const SkIRect& clipped_dest_irect) {
+  const SkBitmap& bitmap = canvas->getDevice()->accessBitmap(true);
+  bitmap.lockPixels();
+  scaled_frame.lockPixels();
+  size_t row_bytes = clipped_dest_irect.width() * 4;
+  for (int y = clipped_dest_irect.fTop; y < clipped_dest_irect.fBottom; ++y) {
+    memcpy(bitmap.getAddr32(clipped_dest_irect.fLeft, y),
+           scaled_frame.getAddr32(
+               clipped_dest_irect.fLeft - local_dest_irect.fLeft,
+               y - local_dest_irect.fTop),
+           row_bytes);
+  }
+  scaled_frame.unlockPixels();
+  bitmap.unlockPixels();
+}
+
 SkCanvasVideoRenderer::SkCanvasVideoRenderer()
-    : last_frame_timestamp_(media::kNoTimestamp()) {
+    : last_frame_timestamp_(media::kNoTimestamp()),
+      last_fast_painted_frame_(NULL),
+      last_fast_painted_timestamp_(media::kNoTimestamp()) {
 }
 
 SkCanvasVideoRenderer::~SkCanvasVideoRenderer() {}
@@ -229,7 +294,36 @@ void SkCanvasVideoRenderer::Paint(media::VideoFrame* video_frame,
 
   // Scale and convert to RGB in one step if we can.
   if (CanFastPaint(canvas, dest_rect, alpha)) {
-    FastPaint(video_frame, canvas, dest_rect);
+    // A frame that is painted again, e.g. while paused or scrolling, is
+    // converted and scaled once to |scaled_frame_| and then only copied. The
+    // first paint of every frame only converts the visible part, so playback
+    // does not pay for the cache.
+    if (video_frame != last_fast_painted_frame_ ||
+        video_frame->GetTimestamp() != last_fast_painted_timestamp_) {
+      last_fast_painted_frame_ = video_frame;
+      last_fast_painted_timestamp_ = video_frame->GetTimestamp();
+      scaled_frame_.reset();
+      FastPaint(video_frame, canvas, dest_rect);
+      return;
+    }
+
+    SkIRect local_dest_irect, clipped_dest_irect;
+    if (!GetLocalDestRects(canvas, dest_rect, &local_dest_irect,
+                           &clipped_dest_irect)) {
+      return;
+    }
+    if (scaled_frame_.isNull() ||
+        scaled_frame_.width() != local_dest_irect.width() ||
+        scaled_frame_.height() != local_dest_irect.height()) {
+      scaled_frame_.setConfig(SkBitmap::kARGB_8888_Config,
+                              local_dest_irect.width(),
+                              local_dest_irect.height());
+      scaled_frame_.allocPixels();
+      scaled_frame_.setIsVolatile(true);
+      ConvertAndScaleVideoFrame(video_frame, &scaled_frame_);
+    }
+    PaintScaledFrame(scaled_frame_, canvas, local_dest_irect,
+                     clipped_dest_irect);
     return;
   }
 
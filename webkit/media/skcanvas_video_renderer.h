@@ -39,6 +39,15 @@ class SkCanvasVideoRenderer {
   SkBitmap last_frame_;
   base::TimeDelta last_frame_timestamp_;
 
+  // The frame the fast path painted last. Only used to recognize repaints of
+  // the same frame, never dereferenced.
+  const media::VideoFrame* last_fast_painted_frame_;
+  base::TimeDelta last_fast_painted_timestamp_;
+
+  // |last_fast_painted_frame_| converted to RGB and scaled to the size of the
+  // destination in device coordinates, once it has been painted twice.
+  SkBitmap scaled_frame_;
+
   DISALLOW_COPY_AND_ASSIGN(SkCanvasVideoRenderer);
 };
 
@@ -188,6 +188,44 @@ TEST_F(SkCanvasVideoRendererTest, FastPaint_SameVideoFrame) {
   EXPECT_EQ(SK_ColorBLUE, GetColor(fast_path_canvas()));
 }
 
+TEST_F(SkCanvasVideoRendererTest, FastPaint_RepaintedVideoFrameIsCached) {
+  Paint(natural_frame(), fast_path_canvas(), kRed);
+  Paint(natural_frame(), fast_path_canvas(), kBlue);
+  EXPECT_EQ(SK_ColorBLUE, GetColor(fast_path_canvas()));
+
+  // The second paint of the same frame cached the scaled frame, expect the
+  // old color value.
+  FillCanvas(fast_path_canvas(), SK_ColorBLACK);
+  Paint(natural_frame(), fast_path_canvas(), kRed);
+  EXPECT_EQ(SK_ColorBLUE, GetColor(fast_path_canvas()));
+
+  // A new timestamp is a new frame.
+  natural_frame()->SetTimestamp(base::TimeDelta::FromMilliseconds(4));
+  Paint(natural_frame(), fast_path_canvas(), kRed);
+  EXPECT_EQ(SK_ColorRED, GetColor(fast_path_canvas()));
+}
+
+TEST_F(SkCanvasVideoRendererTest, FastPaint_CachedVideoFrameIsClipped) {
+  Paint(natural_frame(), fast_path_canvas(), kRed);
+  Paint(natural_frame(), fast_path_canvas(), kRed);
+
+  // Only the clipped part of the canvas is painted from the cache, as when
+  // scrolling.
+  FillCanvas(fast_path_canvas(), SK_ColorBLACK);
+  fast_path_canvas()->save();
+  fast_path_canvas()->clipRect(SkRect::MakeXYWH(
+      SkIntToScalar(kWidth / 2), 0,
+      SkIntToScalar(kWidth / 2), SkIntToScalar(kHeight)));
+  Paint(natural_frame(), fast_path_canvas(), kRed);
+  fast_path_canvas()->restore();
+
+  const SkBitmap& bitmap = fast_path_canvas()->getDevice()->accessBitmap(false);
+  bitmap.lockPixels();
+  EXPECT_EQ(SK_ColorBLACK, bitmap.getColor(0, 0));
+  EXPECT_EQ(SK_ColorRED, bitmap.getColor(kWidth - 1, kHeight - 1));
+  bitmap.unlockPixels();
+}
+
 TEST_F(SkCanvasVideoRendererTest, SlowPaint_SameVideoFrame) {
   Paint(natural_frame(), slow_path_canvas(), kRed);
   EXPECT_EQ(SK_ColorRED, GetColor(slow_path_canvas()));
@@ -26,6 +26,16 @@ ArrayBufferVar* HostVarTracker::CreateArrayBuffer(uint32 size_in_bytes) {
   return new HostArrayBufferVar(size_in_bytes);
 }
 
+ArrayBufferVar* HostVarTracker::CreateShmArrayBuffer(
+    uint32 size_in_bytes,
+    base::SharedMemory* shm) {
+  // Plugins can't create shared memory, so they send array buffers in the
+  // message or in a PPB_Buffer of this instance, never in a handle.
+  NOTREACHED();
+  delete shm;
+  return NULL;
+}
+
 void HostVarTracker::AddNPObjectVar(NPObjectVar* object_var) {
   DCHECK(CalledOnValidThread());
 
@@ -65,6 +65,9 @@ class HostVarTracker : public ::ppapi::VarTracker {
   // VarTracker implementation.
   virtual ::ppapi::ArrayBufferVar* CreateArrayBuffer(
       uint32 size_in_bytes) OVERRIDE;
+  virtual ::ppapi::ArrayBufferVar* CreateShmArrayBuffer(
+      uint32 size_in_bytes,
+      base::SharedMemory* shm) OVERRIDE;
 
   // Clear the reference count of the given object and remove it from
   // live_vars_.
@@ -59,6 +59,14 @@ void MockStorageClient::ModifyOriginAndNotify(
       id(), origin_url, type, delta, IncrementMockTime());
 }
 
+void MockStorageClient::ModifyOrigin(
+    const GURL& origin_url, StorageType type, int64 delta) {
+  OriginDataMap::iterator find = origin_data_.find(make_pair(origin_url, type));
+  DCHECK(find != origin_data_.end());
+  find->second += delta;
+  DCHECK_GE(find->second, 0);
+}
+
 void MockStorageClient::TouchAllOriginsAndNotify() {
   for (OriginDataMap::const_iterator itr = origin_data_.begin();
        itr != origin_data_.end();
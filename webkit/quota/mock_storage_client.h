@@ -40,6 +40,9 @@ class MockStorageClient : public QuotaClient {
       const GURL& origin_url, StorageType type, int64 size);
   void ModifyOriginAndNotify(
       const GURL& origin_url, StorageType type, int64 delta);
+  // Modifies the data without notifying the quota manager, as a client whose
+  // notifications have drifted from its real usage would.
+  void ModifyOrigin(const GURL& origin_url, StorageType type, int64 delta);
   void TouchAllOriginsAndNotify();
 
   void AddOriginToErrorSet(const GURL& origin_url, StorageType type);
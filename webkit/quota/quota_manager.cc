@@ -37,6 +37,7 @@ const int kMinutesInMilliSeconds = 60 * 1000;
 
 const int64 kIncognitoDefaultTemporaryQuota = 50 * kMBytes;
 const int64 kReportHistogramInterval = 60 * 60 * 1000;  // 1 hour
+const int64 kReconcileUsageInterval = 6 * 60 * 60 * 1000;  // 6 hours
 const double kTemporaryQuotaRatioToAvail = 0.5;  // 50%
 
 void CountOriginType(const std::set<GURL>& origins,
@@ -1628,6 +1629,11 @@ void QuotaManager::StartEviction() {
   temporary_storage_evictor_->Start();
 }
 
+void QuotaManager::ReconcileUsage() {
+  temporary_usage_tracker_->ReconcileUsage();
+  persistent_usage_tracker_->ReconcileUsage();
+}
+
 void QuotaManager::ReportHistogram() {
   GetGlobalUsage(kStorageTypeTemporary,
                  base::Bind(
@@ -1690,6 +1696,10 @@ void QuotaManager::DidRunInitializeTask() {
                          base::TimeDelta::FromMilliseconds(
                              kReportHistogramInterval),
                          this, &QuotaManager::ReportHistogram);
+  reconcile_usage_timer_.Start(FROM_HERE,
+                               base::TimeDelta::FromMilliseconds(
+                                   kReconcileUsageInterval),
+                               this, &QuotaManager::ReconcileUsage);
 
   DCHECK(temporary_quota_initialized_);
 
@@ -319,6 +319,11 @@ class QuotaManager : public QuotaTaskObserver,
                                             int64 quota,
                                             int64 available_space);
 
+  // The usage trackers are kept up to date by the usage deltas the clients
+  // report, so that usage is known without asking the clients.  This
+  // periodically asks them again to correct any drift.
+  void ReconcileUsage();
+
   void ReportHistogram();
   void DidGetTemporaryGlobalUsageForHistogram(StorageType type,
                                               int64 usage,
@@ -385,6 +390,7 @@ class QuotaManager : public QuotaTaskObserver,
 
   base::WeakPtrFactory<QuotaManager> weak_factory_;
   base::RepeatingTimer<QuotaManager> histogram_timer_;
+  base::RepeatingTimer<QuotaManager> reconcile_usage_timer_;
 
   DISALLOW_COPY_AND_ASSIGN(QuotaManager);
 };
@@ -154,6 +154,10 @@ class QuotaManagerTest : public testing::Test {
                    weak_factory_.GetWeakPtr()));
   }
 
+  void ReconcileUsage() {
+    quota_manager_->ReconcileUsage();
+  }
+
   void RunAdditionalUsageAndQuotaTask(const GURL& origin, StorageType type) {
     quota_manager_->GetUsageAndQuota(
         origin, type,
@@ -1101,6 +1105,47 @@ TEST_F(QuotaManagerTest, GetUsage_WithModification) {
   EXPECT_EQ(usage(), 4000 + 50000 + 900000000);
 }
 
+TEST_F(QuotaManagerTest, ReconcileUsage) {
+  static const MockOriginData kData[] = {
+    { "http://foo.com/",   kTemp,  10 },
+    { "http://foo.com:1/", kTemp,  20 },
+    { "http://bar.com/",   kTemp,  40 },
+  };
+  MockStorageClient* client = CreateClient(kData, ARRAYSIZE_UNSAFE(kData),
+      QuotaClient::kFileSystem);
+  RegisterClient(client);
+
+  GetGlobalUsage(kTemp);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(10 + 20 + 40, usage());
+
+  // Changes the client doesn't report are not seen in the cached usage...
+  client->ModifyOrigin(GURL("http://foo.com/"), kTemp, 5);
+  client->ModifyOrigin(GURL("http://bar.com/"), kTemp, -40);
+  GetHostUsage("foo.com", kTemp);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(10 + 20, usage());
+
+  // ...until the usage is reconciled.
+  ReconcileUsage();
+  MessageLoop::current()->RunAllPending();
+  GetGlobalUsage(kTemp);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(15 + 20, usage());
+  GetHostUsage("foo.com", kTemp);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(15 + 20, usage());
+  GetHostUsage("bar.com", kTemp);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(0, usage());
+
+  // Reported changes are still applied incrementally.
+  client->ModifyOriginAndNotify(GURL("http://foo.com:1/"), kTemp, 100);
+  GetHostUsage("foo.com", kTemp);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(15 + 120, usage());
+}
+
 TEST_F(QuotaManagerTest, GetUsage_WithDeleteOrigin) {
   static const MockOriginData kData[] = {
     { "http://foo.com/",   kTemp,     1 },
@@ -27,12 +27,16 @@ bool SortByHost(const GURL& lhs, const GURL& rhs) {
 // origins.  This class is self-destructed.
 class ClientUsageTracker::GatherUsageTaskBase : public QuotaTask {
  public:
+  // Unless |refresh_cached_origins| is set, origins whose usage is already
+  // cached are not asked for again.
   GatherUsageTaskBase(
       UsageTracker* tracker,
-      QuotaClient* client)
+      QuotaClient* client,
+      bool refresh_cached_origins)
       : QuotaTask(tracker),
         client_(client),
         tracker_(tracker),
+        refresh_cached_origins_(refresh_cached_origins),
         weak_factory_(ALLOW_THIS_IN_INITIALIZER_LIST(this)) {
     DCHECK(tracker_);
     DCHECK(client_);
@@ -47,7 +51,8 @@ class ClientUsageTracker::GatherUsageTaskBase : public QuotaTask {
     // We do not get usage for origins for which we have valid usage cache.
     std::vector<GURL> origins_to_gather;
     std::set<GURL> cached_origins;
-    client_tracker()->GetCachedOrigins(&cached_origins);
+    if (!refresh_cached_origins_)
+      client_tracker()->GetCachedOrigins(&cached_origins);
     std::set<GURL> already_added;
     for (std::set<GURL>::const_iterator iter = origins.begin();
          iter != origins.end(); ++iter) {
@@ -122,6 +127,7 @@ class ClientUsageTracker::GatherUsageTaskBase : public QuotaTask {
   QuotaClient* client_;
   UsageTracker* tracker_;
   ClientUsageTracker* client_tracker_;
+  const bool refresh_cached_origins_;
   std::deque<GURL> pending_origins_;
   std::map<GURL, int64> origin_usage_map_;
   base::WeakPtrFactory<GatherUsageTaskBase> weak_factory_;
@@ -137,7 +143,7 @@ class ClientUsageTracker::GatherGlobalUsageTask
   GatherGlobalUsageTask(
       UsageTracker* tracker,
       QuotaClient* client)
-      : GatherUsageTaskBase(tracker, client),
+      : GatherUsageTaskBase(tracker, client, false),
         client_(client),
         weak_factory_(ALLOW_THIS_IN_INITIALIZER_LIST(this)) {
     DCHECK(tracker);
@@ -172,7 +178,7 @@ class ClientUsageTracker::GatherHostUsageTask
       UsageTracker* tracker,
       QuotaClient* client,
       const std::string& host)
-      : GatherUsageTaskBase(tracker, client),
+      : GatherUsageTaskBase(tracker, client, false),
         client_(client),
         host_(host),
         weak_factory_(ALLOW_THIS_IN_INITIALIZER_LIST(this)) {
@@ -199,6 +205,51 @@ class ClientUsageTracker::GatherHostUsageTask
   DISALLOW_COPY_AND_ASSIGN(GatherHostUsageTask);
 };
 
+// A task class for asking a client for the usage of all of its origins again
+// to correct any drift in the cached usage.  This class is self-destructed.
+class ClientUsageTracker::ReconcileUsageTask
+    : public GatherUsageTaskBase {
+ public:
+  ReconcileUsageTask(
+      UsageTracker* tracker,
+      QuotaClient* client)
+      : GatherUsageTaskBase(tracker, client, true),
+        client_(client),
+        weak_factory_(ALLOW_THIS_IN_INITIALIZER_LIST(this)) {
+    DCHECK(client_);
+  }
+  virtual ~ReconcileUsageTask() {}
+
+ protected:
+  virtual void Run() OVERRIDE {
+    client_->GetOriginsForType(tracker()->type(),
+        base::Bind(&ReconcileUsageTask::DidGetOrigins,
+                   weak_factory_.GetWeakPtr()));
+  }
+
+  virtual void Completed() OVERRIDE {
+    client_tracker()->ReconcileUsageComplete();
+  }
+
+ private:
+  void DidGetOrigins(const std::set<GURL>& origins, StorageType type) {
+    // Origins the client no longer has use nothing.
+    std::set<GURL> cached_origins;
+    client_tracker()->GetCachedOrigins(&cached_origins);
+    for (std::set<GURL>::const_iterator iter = cached_origins.begin();
+         iter != cached_origins.end(); ++iter) {
+      if (origins.find(*iter) == origins.end())
+        client_tracker()->AddCachedOrigin(*iter, 0);
+    }
+    GetUsageForOrigins(origins, type);
+  }
+
+  QuotaClient* client_;
+  base::WeakPtrFactory<ReconcileUsageTask> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReconcileUsageTask);
+};
+
 // UsageTracker ----------------------------------------------------------
 
 UsageTracker::UsageTracker(const QuotaClientList& clients, StorageType type,
@@ -294,6 +345,13 @@ void UsageTracker::GetCachedOrigins(std::set<GURL>* origins) const {
   }
 }
 
+void UsageTracker::ReconcileUsage() {
+  for (ClientTrackerMap::iterator iter = client_tracker_map_.begin();
+       iter != client_tracker_map_.end(); ++iter) {
+    iter->second->ReconcileUsage();
+  }
+}
+
 void UsageTracker::DidGetClientGlobalUsage(StorageType type,
                                            int64 usage,
                                            int64 unlimited_usage) {
@@ -348,6 +406,7 @@ ClientUsageTracker::ClientUsageTracker(
       global_usage_retrieved_(false),
       global_unlimited_usage_is_valid_(true),
       global_usage_task_(NULL),
+      reconcile_usage_task_(NULL),
       special_storage_policy_(special_storage_policy) {
   DCHECK(tracker_);
   DCHECK(client_);
@@ -391,6 +450,7 @@ void ClientUsageTracker::UpdateUsageCache(
   std::string host = net::GetHostOrSpecFromURL(origin);
   if (cached_hosts_.find(host) != cached_hosts_.end()) {
     cached_usage_[host][origin] += delta;
+    cached_host_usage_[host] += delta;
     global_usage_ += delta;
     if (global_unlimited_usage_is_valid_ && IsStorageUnlimited(origin))
       global_unlimited_usage_ += delta;
@@ -427,6 +487,15 @@ void ClientUsageTracker::GetCachedOrigins(std::set<GURL>* origins) const {
   }
 }
 
+void ClientUsageTracker::ReconcileUsage() {
+  // Until the global usage has been gathered there is nothing to reconcile,
+  // and a gathering in progress will produce fresh values anyway.
+  if (!global_usage_retrieved_ || global_usage_task_ || reconcile_usage_task_)
+    return;
+  reconcile_usage_task_ = new ReconcileUsageTask(tracker_, client_);
+  reconcile_usage_task_->Start();
+}
+
 void ClientUsageTracker::AddCachedOrigin(
     const GURL& origin, int64 usage) {
   std::string host = net::GetHostOrSpecFromURL(origin);
@@ -436,6 +505,7 @@ void ClientUsageTracker::AddCachedOrigin(
   iter->second = usage;
   int64 delta = usage - old_usage;
   if (delta) {
+    cached_host_usage_[host] += delta;
     global_usage_ += delta;
     if (global_unlimited_usage_is_valid_ && IsStorageUnlimited(origin))
       global_unlimited_usage_ += delta;
@@ -471,18 +541,17 @@ void ClientUsageTracker::GatherHostUsageComplete(const std::string& host) {
   host_usage_callbacks_.Run(host, host, type_, GetCachedHostUsage(host));
 }
 
+void ClientUsageTracker::ReconcileUsageComplete() {
+  DCHECK(reconcile_usage_task_ != NULL);
+  reconcile_usage_task_ = NULL;
+}
+
 int64 ClientUsageTracker::GetCachedHostUsage(const std::string& host) const {
-  HostUsageMap::const_iterator found = cached_usage_.find(host);
-  if (found == cached_usage_.end())
+  std::map<std::string, int64>::const_iterator found =
+      cached_host_usage_.find(host);
+  if (found == cached_host_usage_.end())
     return 0;
-
-  int64 usage = 0;
-  const UsageMap& map = found->second;
-  for (UsageMap::const_iterator iter = map.begin();
-       iter != map.end(); ++iter) {
-    usage += iter->second;
-  }
-  return usage;
+  return found->second;
 }
 
 int64 ClientUsageTracker::GetCachedGlobalUnlimitedUsage() {
@@ -44,6 +44,12 @@ class UsageTracker : public QuotaTaskObserver {
                         int64 delta);
   void GetCachedHostsUsage(std::map<std::string, int64>* host_usage) const;
   void GetCachedOrigins(std::set<GURL>* origins) const;
+
+  // Asks each client for the usage of its origins again and corrects the
+  // cached usage, which is otherwise only kept up to date by the deltas the
+  // clients report.
+  void ReconcileUsage();
+
   bool IsWorking() const {
     return global_usage_callbacks_.HasCallbacks() ||
            host_usage_callbacks_.HasAnyCallbacks();
@@ -94,6 +100,7 @@ class ClientUsageTracker : public SpecialStoragePolicy::Observer,
   void UpdateUsageCache(const GURL& origin, int64 delta);
   void GetCachedHostsUsage(std::map<std::string, int64>* host_usage) const;
   void GetCachedOrigins(std::set<GURL>* origins) const;
+  void ReconcileUsage();
 
  private:
   typedef std::set<std::string> HostSet;
@@ -103,6 +110,7 @@ class ClientUsageTracker : public SpecialStoragePolicy::Observer,
   class GatherUsageTaskBase;
   class GatherGlobalUsageTask;
   class GatherHostUsageTask;
+  class ReconcileUsageTask;
 
   // Methods used by our GatherUsage tasks, as a task makes progress
   // origins and hosts are added incrementally to the cache.
@@ -110,6 +118,7 @@ class ClientUsageTracker : public SpecialStoragePolicy::Observer,
   void AddCachedHost(const std::string& host);
   void GatherGlobalUsageComplete();
   void GatherHostUsageComplete(const std::string& host);
+  void ReconcileUsageComplete();
 
   int64 GetCachedHostUsage(const std::string& host) const;
   int64 GetCachedGlobalUnlimitedUsage();
@@ -128,8 +137,11 @@ class ClientUsageTracker : public SpecialStoragePolicy::Observer,
   bool global_unlimited_usage_is_valid_;
   HostSet cached_hosts_;
   HostUsageMap cached_usage_;
+  // The sum of |cached_usage_| for each host.
+  std::map<std::string, int64> cached_host_usage_;
 
   GatherGlobalUsageTask* global_usage_task_;
+  ReconcileUsageTask* reconcile_usage_task_;
   GlobalUsageCallbackQueue global_usage_callback_;
   std::map<std::string, GatherHostUsageTask*> host_usage_tasks_;
   HostUsageCallbackMap host_usage_callbacks_;